@@ -88,6 +88,13 @@ struct clap_juce_audio_processor_capabilities
     virtual bool supportsVoiceInfo() { return false; }
     virtual bool voiceInfoGet(clap_voice_info * /*info*/) { return false; }
 
+    /** Plugins should call this method when the voice info they report has changed. */
+    void voiceInfoChanged()
+    {
+        if (voiceInfoChangedSignal != nullptr)
+            voiceInfoChangedSignal();
+    }
+
     /*
      * Do you want to receive note expression messages? Note that if you return true
      * here and don't implement supportsDirectProcess, the note expression messages will
@@ -290,6 +297,41 @@ struct clap_juce_audio_processor_capabilities
             onPresetLoadError(location_kind, location, load_key, os_error, message);
     }
 
+    /**
+     * If your plugin can spread its processing over the host's thread pool, override
+     * supportsThreadPool to return true. From within clap_direct_process you may then call
+     * threadPoolRequestExec, which returns once the host has called threadPoolExec for every
+     * task index on its own threads, or returns false if the host won't, in which case you
+     * have to do the work yourself.
+     */
+    virtual bool supportsThreadPool() const noexcept { return false; }
+    virtual void threadPoolExec(uint32_t /*taskIndex*/) noexcept {}
+
+    bool threadPoolRequestExec(uint32_t numTasks)
+    {
+        if (requestThreadPoolExec != nullptr)
+            return requestThreadPoolExec(numTasks);
+        return false;
+    }
+
+    /*
+     * Plugins which return CLAP_PROCESS_SLEEP from clap_direct_process may call requestProcess
+     * from any thread to have the host resume processing, for instance when work for the audio
+     * thread has been queued from somewhere other than the host. Call tailChanged when the
+     * value returned by getTailLengthSeconds has changed.
+     */
+    void requestProcess()
+    {
+        if (requestProcessSignal != nullptr)
+            requestProcessSignal();
+    }
+
+    void tailChanged()
+    {
+        if (tailChangedSignal != nullptr)
+            tailChangedSignal();
+    }
+
     /*
      * If you are working with a host that chooses to not implement cookies you will
      * need to look up parameters by param_id. Use this method to do so.
@@ -321,6 +363,10 @@ struct clap_juce_audio_processor_capabilities
                        int32_t os_error, const juce::String &msg)>
         onPresetLoadError = nullptr;
     std::function<const void *(const char *)> extensionGet = nullptr;
+    std::function<bool(uint32_t)> requestThreadPoolExec = nullptr;
+    std::function<void()> voiceInfoChangedSignal = nullptr;
+    std::function<void()> tailChangedSignal = nullptr;
+    std::function<void()> requestProcessSignal = nullptr;
 
     friend const clap_plugin *ClapAdapter::clap_create_plugin(const struct clap_plugin_factory *,
                                                               const clap_host *, const char *);
@@ -445,6 +445,31 @@ class ClapJuceWrapper : public clap::helpers::Plugin<
             processorAsClapExtensions->extensionGet = [this](const char *name) {
                 return _host.host()->get_extension(_host.host(), name);
             };
+            processorAsClapExtensions->requestThreadPoolExec = [this](uint32_t numTasks) {
+                return _host.canUseThreadPool() && _host.threadPoolRequestExec(numTasks);
+            };
+            processorAsClapExtensions->voiceInfoChangedSignal = [this]() {
+                runOnMainThread([this] {
+                    if (isBeingDestroyed())
+                        return;
+
+                    if (_host.canUseVoiceInfo())
+                        _host.voiceInfoChanged();
+                });
+            };
+            processorAsClapExtensions->tailChangedSignal = [this]() {
+                runOnMainThread([this] {
+                    if (isBeingDestroyed())
+                        return;
+
+                    if (_host.canUseTail())
+                        _host.tailChanged();
+                });
+            };
+            processorAsClapExtensions->requestProcessSignal = [this]() {
+                // clap_host::request_process is thread safe
+                _host.requestProcess();
+            };
         }
 
         const bool forceLegacyParamIDs = false;
@@ -1111,6 +1136,19 @@ class ClapJuceWrapper : public clap::helpers::Plugin<
         return false;
     }
 
+    bool implementsThreadPool() const noexcept override
+    {
+        if (processorAsClapExtensions)
+            return processorAsClapExtensions->supportsThreadPool();
+        return false;
+    }
+
+    void threadPoolExec(uint32_t taskIndex) noexcept override
+    {
+        if (processorAsClapExtensions)
+            processorAsClapExtensions->threadPoolExec(taskIndex);
+    }
+
   public:
     bool implementsParams() const noexcept override { return true; }
     bool isValidParamId(clap_id paramId) const noexcept override
@@ -1320,8 +1358,12 @@ class ClapJuceWrapper : public clap::helpers::Plugin<
             return 0;
         }
 
-        return uint32_t(
-            juce::roundToIntAccurate((double)sampleRate() * processor->getTailLengthSeconds()));
+        // anything at or past INT32_MAX means an infinite tail, as does JUCE's infinity
+        auto tail = (double)sampleRate() * processor->getTailLengthSeconds();
+        if (!std::isfinite(tail) || tail >= (double)INT32_MAX)
+            return INT32_MAX;
+
+        return uint32_t(juce::roundToIntAccurate(tail));
     }
 
     bool implementsRender() const noexcept override { return true; }
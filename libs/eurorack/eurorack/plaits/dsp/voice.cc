@@ -52,11 +52,11 @@ void Voice::Init(BufferAllocator* allocator) {
   engines_.RegisterInstance(&bass_drum_engine_, true, 0.8f, 0.8f);
   engines_.RegisterInstance(&snare_drum_engine_, true, 0.8f, 0.8f);
   engines_.RegisterInstance(&hi_hat_engine_, true, 0.8f, 0.8f);
-  for (int i = 0; i < engines_.size(); ++i) {
-    // All engines will share the same RAM space.
-    allocator->Free();
-    engines_.get(i)->Init(allocator);
-  }
+  // All engines will share the same RAM space, and each one's Reset() restores
+  // its part of it, so in surge we only Init an engine the first time it is
+  // selected rather than all of them on every note.
+  allocator_ = allocator;
+  initialized_engines_ = 0;
   
   engine_quantizer_.Init();
   previous_engine_index_ = -1;
@@ -116,6 +116,11 @@ void Voice::Render(
   Engine* e = engines_.get(engine_index);
   
   if (engine_index != previous_engine_index_) {
+    if (!(initialized_engines_ & (1 << engine_index))) {
+      allocator_->Free();
+      e->Init(allocator_);
+      initialized_engines_ |= 1 << engine_index;
+    }
     e->Reset();
     out_post_processor_.Reset();
     previous_engine_index_ = engine_index;
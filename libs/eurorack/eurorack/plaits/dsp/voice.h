@@ -224,6 +224,8 @@ class Voice {
   ChannelPostProcessor aux_post_processor_;
   
   EngineRegistry<kMaxEngines> engines_;
+  stmlib::BufferAllocator* allocator_;
+  uint32_t initialized_engines_;
   
   float out_buffer_[kMaxBlockSize];
   float aux_buffer_[kMaxBlockSize];
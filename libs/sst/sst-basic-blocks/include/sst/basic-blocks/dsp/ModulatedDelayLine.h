@@ -0,0 +1,200 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_MODULATEDDELAYLINE_H
+#define INCLUDE_SST_BASIC_BLOCKS_DSP_MODULATEDDELAYLINE_H
+
+#include <cassert>
+#include <cstring>
+
+#include "sst/basic-blocks/simd/setup.h"
+#include "sst/basic-blocks/tables/SincTableProvider.h"
+
+namespace sst::basic_blocks::dsp
+{
+enum struct ModulatedDelayInterpolation
+{
+    LINEAR,  // two taps
+    HERMITE, // four taps, Catmull-Rom
+    SINC     // twelve taps of SurgeSincTableProvider::sinctable1X
+};
+
+/*
+ * A delay line for the moving reads of choruses, flangers and dopplers. Each read takes four
+ * fractional delays, one a lane, so four voices or combs cost about what one did reading alone.
+ *
+ * Delays count back from the write head, so 1 is the sample written last. LINEAR reads need
+ * 1 <= d <= size - 2 and HERMITE ones 2 <= d <= size - 2. SINC reads the twelve samples from
+ * floor(d) + 1 back, as the Surge chorus always has, so it centres about six samples later than
+ * d and needs 0 <= d <= size - padding - 1. The first padding samples are mirrored past the end
+ * of the buffer so no read has to wrap, which is why the memory has to be size + padding long.
+ *
+ * The memory is either the line's own, in FixedModulatedDelayLine, or the owner's, in attach().
+ * SINC reads need sinctable1X pointed at a table which outlives the line.
+ */
+struct ModulatedDelayLine
+{
+    using stp = tables::SurgeSincTableProvider;
+    static constexpr int padding = stp::FIRipol_N;
+
+    float *buffer{nullptr};
+    int size{0}, mask{0}, wp{0};
+    const float *sinctable1X{nullptr};
+
+    // sizePowerOfTwo + padding floats
+    void attach(float *memory, int sizePowerOfTwo)
+    {
+        assert(!(sizePowerOfTwo & (sizePowerOfTwo - 1)));
+        buffer = memory;
+        size = sizePowerOfTwo;
+        mask = size - 1;
+        clear();
+    }
+
+    void clear()
+    {
+        memset(buffer, 0, (size + padding) * sizeof(float));
+        wp = 0;
+    }
+
+    inline void write(float f)
+    {
+        buffer[wp] = f;
+        if (wp < padding)
+            buffer[wp + size] = f;
+        wp = (wp + 1) & mask;
+    }
+
+    inline void writeBlock(const float *f, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            write(f[i]);
+    }
+
+    template <ModulatedDelayInterpolation q> inline SIMD_M128 read4(SIMD_M128 delay) const
+    {
+        auto iDelay = SIMD_MM(cvttps_epi32)(delay);
+        auto frac = SIMD_MM(sub_ps)(delay, SIMD_MM(cvtepi32_ps)(iDelay));
+
+        int id alignas(16)[4];
+        SIMD_MM(store_si128)((SIMD_M128I *)id, iDelay);
+
+        if constexpr (q == ModulatedDelayInterpolation::SINC)
+        {
+            assert(sinctable1X);
+
+            // the table rows run from a whole sample late to just after the sample itself
+            const auto M = SIMD_MM(set1_ps)(stp::FIRipol_M);
+            auto row = SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(SIMD_MM(set1_ps)(1.f), frac), M);
+            row = SIMD_MM(min_ps)(row, SIMD_MM(set1_ps)(stp::FIRipol_M - 1));
+            int ir alignas(16)[4];
+            SIMD_MM(store_si128)((SIMD_M128I *)ir, SIMD_MM(cvttps_epi32)(row));
+
+            SIMD_M128 acc[4];
+            for (int l = 0; l < 4; ++l)
+            {
+                auto b = &buffer[(wp - id[l] - stp::FIRipol_N) & mask];
+                auto s = &sinctable1X[ir[l] * stp::FIRipol_N];
+
+                auto o = SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(b), SIMD_MM(load_ps)(s));
+                o = SIMD_MM(add_ps)(o, SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(b + 4),
+                                                       SIMD_MM(load_ps)(s + 4)));
+                acc[l] = SIMD_MM(add_ps)(o, SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(b + 8),
+                                                            SIMD_MM(load_ps)(s + 8)));
+            }
+            transpose(acc);
+            return SIMD_MM(add_ps)(SIMD_MM(add_ps)(acc[0], acc[1]),
+                                   SIMD_MM(add_ps)(acc[2], acc[3]));
+        }
+        else
+        {
+            // p[0] to p[3] are the samples at i + 2, i + 1, i and i - 1 back, oldest first
+            SIMD_M128 p[4];
+            for (int l = 0; l < 4; ++l)
+                p[l] = SIMD_MM(loadu_ps)(&buffer[(wp - id[l] - 2) & mask]);
+            transpose(p);
+
+            if constexpr (q == ModulatedDelayInterpolation::LINEAR)
+            {
+                return SIMD_MM(add_ps)(p[2], SIMD_MM(mul_ps)(frac, SIMD_MM(sub_ps)(p[1], p[2])));
+            }
+            else
+            {
+                // the spline runs from p[1] at t = 0 to p[2] at t = 1
+                const auto half = SIMD_MM(set1_ps)(0.5f);
+                auto t = SIMD_MM(sub_ps)(SIMD_MM(set1_ps)(1.f), frac);
+
+                auto c1 = SIMD_MM(mul_ps)(half, SIMD_MM(sub_ps)(p[2], p[0]));
+                auto c2 = SIMD_MM(sub_ps)(
+                    SIMD_MM(add_ps)(p[0], SIMD_MM(mul_ps)(SIMD_MM(set1_ps)(2.f), p[2])),
+                    SIMD_MM(add_ps)(SIMD_MM(mul_ps)(SIMD_MM(set1_ps)(2.5f), p[1]),
+                                    SIMD_MM(mul_ps)(half, p[3])));
+                auto c3 = SIMD_MM(add_ps)(
+                    SIMD_MM(mul_ps)(half, SIMD_MM(sub_ps)(p[3], p[0])),
+                    SIMD_MM(mul_ps)(SIMD_MM(set1_ps)(1.5f), SIMD_MM(sub_ps)(p[1], p[2])));
+
+                auto r = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(c3, t), c2);
+                r = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(r, t), c1);
+                return SIMD_MM(add_ps)(SIMD_MM(mul_ps)(r, t), p[1]);
+            }
+        }
+    }
+
+    // one delay, in the first lane
+    template <ModulatedDelayInterpolation q> inline float read(float delay) const
+    {
+        float res;
+        SIMD_MM(store_ss)(&res, read4<q>(SIMD_MM(set1_ps)(delay)));
+        return res;
+    }
+
+  private:
+    static inline void transpose(SIMD_M128 r[4])
+    {
+        auto t0 = SIMD_MM(unpacklo_ps)(r[0], r[1]), t1 = SIMD_MM(unpacklo_ps)(r[2], r[3]);
+        auto t2 = SIMD_MM(unpackhi_ps)(r[0], r[1]), t3 = SIMD_MM(unpackhi_ps)(r[2], r[3]);
+        r[0] = SIMD_MM(movelh_ps)(t0, t1);
+        r[1] = SIMD_MM(movehl_ps)(t1, t0);
+        r[2] = SIMD_MM(movelh_ps)(t2, t3);
+        r[3] = SIMD_MM(movehl_ps)(t3, t2);
+    }
+};
+
+template <int SIZE> struct FixedModulatedDelayLine : ModulatedDelayLine
+{
+    static_assert(!(SIZE & (SIZE - 1)));
+
+    float memory alignas(16)[SIZE + padding];
+
+    FixedModulatedDelayLine() { attach(memory, SIZE); }
+
+    // the base points into memory, so a copy would write to the original
+    FixedModulatedDelayLine(const FixedModulatedDelayLine &) = delete;
+    FixedModulatedDelayLine &operator=(const FixedModulatedDelayLine &) = delete;
+};
+} // namespace sst::basic_blocks::dsp
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_DSP_MODULATEDDELAYLINE_H
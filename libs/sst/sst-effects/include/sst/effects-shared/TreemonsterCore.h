@@ -238,78 +238,100 @@ void TreemonsterCore<BaseClass, BiquadType, addHPLP>::processWithoutMixOrWith(
     }
 
     auto twoToPitch = powf(2.0, this->floatValue(tm_pitch) * (1 / 12.f));
-    oscL.set_rate((2.0 * M_PI / std::max(2.f, length_smooth[0])) * twoToPitch);
-    oscR.set_rate((2.0 * M_PI / std::max(2.f, length_smooth[1])) * twoToPitch);
+    float rate[2];
+    rate[0] = (2.0 * M_PI / std::max(2.f, length_smooth[0])) * twoToPitch;
+    rate[1] = (2.0 * M_PI / std::max(2.f, length_smooth[1])) * twoToPitch;
+    oscL.set_rate(rate[0]);
+    oscR.set_rate(rate[1]);
 
-    for (int k = 0; k < FXConfig::blockSize; k++)
+    /*
+     * Pitch detection. This only counts samples between positive zero crossings, and what
+     * it finds reaches the oscillators once a block, so each channel runs through on its
+     * own rather than being interleaved with the oscillators and followers below.
+     */
+    for (int c = 0; c < 2; ++c)
     {
-        // envelope detection
-        for (int c = 0; c < 2; ++c)
+        auto lv = lastval[c];
+        auto len = length[c];
+
+        for (int k = 0; k < FXConfig::blockSize; k++)
         {
-            auto v = (c == 0 ? dataL[k] : dataR[k]);
-            auto e = envV[c];
+            auto v = tbuf[c][k];
 
-            if (v > e)
-            {
-                e = envA * (e - v) + v;
-            }
-            else
+            if ((lv < 0.f) && (v >= 0.f))
             {
-                e = envR * (e - v) + v;
+                if (v > thres && len > smallest_wavelength)
+                {
+                    length_target[c] = (len > length_smooth[c] * 10 ? length_smooth[c] : len);
+                    if (first_thresh[c])
+                        length_smooth[c] = len;
+                    first_thresh[c] = false;
+                }
+
+                len = 0.0; // (0.0-lastval[c]) / ( tbuf[c][k] - lastval[c]);
             }
 
-            envV[c] = e;
-            envelopeOut[c][k] = e;
+            // track positive zero crossings
+            len += 1.0f;
+            lv = v;
         }
 
-        // pitch detection
-        if ((lastval[0] < 0.f) && (tbuf[0][k] >= 0.f))
-        {
-            if (tbuf[0][k] > thres && length[0] > smallest_wavelength)
-            {
-                length_target[0] =
-                    (length[0] > length_smooth[0] * 10 ? length_smooth[0] : length[0]);
-                if (first_thresh[0])
-                    length_smooth[0] = length[0];
-                first_thresh[0] = false;
-            }
+        lastval[c] = lv;
+        length[c] = len;
+    }
 
-            length[0] = 0.0; // (0.0-lastval[0]) / ( tbuf[0][k] - lastval[0]);
-        }
+    // envelope followers and oscillators, L in the first lane and R in the second
+    const auto eA = SIMD_MM(set1_ps)((float)envA), eR = SIMD_MM(set1_ps)((float)envR);
+    const auto dr = SIMD_MM(setr_ps)(std::cos(rate[0]), std::cos(rate[1]), 0.f, 0.f);
+    const auto di = SIMD_MM(setr_ps)(std::sin(rate[0]), std::sin(rate[1]), 0.f, 0.f);
 
-        if ((lastval[1] < 0.f) && (tbuf[1][k] >= 0.f))
-        {
-            if (tbuf[1][k] > thres && length[1] > smallest_wavelength)
-            {
-                length_target[1] =
-                    (length[1] > length_smooth[1] * 10 ? length_smooth[1] : length[1]);
-                if (first_thresh[1])
-                    length_smooth[1] = length[1];
-                first_thresh[1] = false;
-            }
+    auto env = SIMD_MM(setr_ps)(envV[0], envV[1], 0.f, 0.f);
+    auto re = SIMD_MM(setr_ps)(oscL.r, oscR.r, 0.f, 0.f);
+    auto im = SIMD_MM(setr_ps)(oscL.i, oscR.i, 0.f, 0.f);
 
-            length[1] = 0.0; // (0.0-lastval[1]) / ( tbuf[1][k] - lastval[1]);
-        }
+    float osc alignas(16)[4], envs alignas(16)[4], scaled alignas(16)[4];
+
+    for (int k = 0; k < FXConfig::blockSize; k++)
+    {
+        auto v = SIMD_MM(setr_ps)(dataL[k], dataR[k], 0.f, 0.f);
+        auto rising = SIMD_MM(cmpgt_ps)(v, env);
+        auto coef = SIMD_MM(or_ps)(SIMD_MM(and_ps)(rising, eA), SIMD_MM(andnot_ps)(rising, eR));
+        env = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(coef, SIMD_MM(sub_ps)(env, v)), v);
+
+        auto lr = re;
+        re = SIMD_MM(sub_ps)(SIMD_MM(mul_ps)(dr, re), SIMD_MM(mul_ps)(di, im));
+        im = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(dr, im), SIMD_MM(mul_ps)(di, lr));
+
+        // both channels have always been scaled by the left envelope
+        auto sc = SIMD_MM(mul_ps)(re, SIMD_MM(shuffle_ps)(env, env, SIMD_MM_SHUFFLE(0, 0, 0, 0)));
 
-        oscL.process();
-        oscR.process();
+        SIMD_MM(store_ps)(osc, re);
+        SIMD_MM(store_ps)(envs, env);
+        SIMD_MM(store_ps)(scaled, sc);
 
         // do not apply followed envelope to sine oscillator - we need full freight sine for RM
-        L[k] = oscL.r;
-        R[k] = oscR.r;
+        L[k] = osc[0];
+        R[k] = osc[1];
 
         // but we need to store the scaled for mix
-        envscaledSineWave[0][k] = oscL.r * envV[0];
-        envscaledSineWave[1][k] = oscR.r * envV[0];
+        envscaledSineWave[0][k] = scaled[0];
+        envscaledSineWave[1][k] = scaled[1];
 
-        // track positive zero crossings
-        length[0] += 1.0f;
-        length[1] += 1.0f;
-
-        lastval[0] = tbuf[0][k];
-        lastval[1] = tbuf[1][k];
+        envelopeOut[0][k] = envs[0];
+        envelopeOut[1][k] = envs[1];
     }
 
+    SIMD_MM(store_ps)(envs, env);
+    envV[0] = envs[0];
+    envV[1] = envs[1];
+
+    SIMD_MM(store_ps)(osc, re);
+    oscL.r = osc[0];
+    oscR.r = osc[1];
+    SIMD_MM(store_ps)(osc, im);
+    oscL.i = osc[0];
+    oscR.i = osc[1];
+
     // do dry signal * pitch tracked signal ringmod
     // store to pitch detection buffer
     mech::mul_block<FXConfig::blockSize>(L, dataL, tbuf[0]);
@@ -25,6 +25,8 @@
 #include "sst/basic-blocks/params/ParamMetadata.h"
 #include "sst/basic-blocks/dsp/Lag.h"
 #include "sst/basic-blocks/dsp/BlockInterpolators.h"
+#include "sst/basic-blocks/dsp/ModulatedDelayLine.h"
+#include "sst/basic-blocks/mechanics/simd-ops.h"
 
 namespace sst::effects::flanger
 {
@@ -156,31 +158,17 @@ template <typename FXConfig> struct Flanger : core::EffectTemplateBase<FXConfig>
     }
 
   protected:
+    // the combs of a channel are read together, one a lane
     static constexpr int COMBS_PER_CHANNEL = 4;
-    struct InterpDelay
-    {
-        // OK so lets say we want lowest tunable frequency to be 23.5hz at 96k
-        // 96000/23.5 = 4084
-        // And lets future proof a bit and make it a power of 2 so we can use & properly
-        static constexpr int DELAY_SIZE = 32768, DELAY_SIZE_MASK = DELAY_SIZE - 1;
-        float line[DELAY_SIZE];
-        int k = 0;
-        InterpDelay() { reset(); }
-        void reset()
-        {
-            memset(line, 0, DELAY_SIZE * sizeof(float));
-            k = 0;
-        }
-        float value(float delayBy);
-        void push(float nv)
-        {
-            k = (k + 1) & DELAY_SIZE_MASK;
-            line[k] = nv;
-        }
-    };
+    static_assert(COMBS_PER_CHANNEL == 4);
+
+    // OK so lets say we want lowest tunable frequency to be 23.5hz at 96k
+    // 96000/23.5 = 4084
+    // And lets future proof a bit and make it a power of 2 so we can use & properly
+    static constexpr int DELAY_SIZE = 32768;
 
     int ringout_value = -1;
-    InterpDelay idels[2];
+    sdsp::FixedModulatedDelayLine<DELAY_SIZE> idels[2];
 
     float lfophase[2][COMBS_PER_CHANNEL], longphase[2];
     float lpaL = 0.f, lpaR = 0.f; // state for the onepole LP filter
@@ -192,7 +180,7 @@ template <typename FXConfig> struct Flanger : core::EffectTemplateBase<FXConfig>
     sdsp::lipol<float, FXConfig::blockSize, true> feedback, fb_hf_damping;
     sdsp::SurgeLag<float> vzeropitch;
     float lfosandhtarget[2][COMBS_PER_CHANNEL];
-    float vweights[2][COMBS_PER_CHANNEL];
+    float vweights alignas(16)[2][COMBS_PER_CHANNEL];
 
     sdsp::lipol_sse<FXConfig::blockSize, false> width;
     bool haveProcessed{false};
@@ -231,19 +219,6 @@ template <typename FXConfig> inline void Flanger<FXConfig>::initialize()
     haveProcessed = false;
 }
 
-template <typename FXConfig> inline float Flanger<FXConfig>::InterpDelay::value(float delayBy)
-{
-    // so if delayBy is 19.2
-    int itap = (int)std::min(delayBy, (float)(DELAY_SIZE - 2)); // this is 19
-    float fractap = delayBy - itap;                             // this is .2
-    int k0 = (k + DELAY_SIZE - itap - 1) & DELAY_SIZE_MASK;     // this is 20 back
-    int k1 = (k + DELAY_SIZE - itap) & DELAY_SIZE_MASK;         // this is 19 back
-    float result =
-        line[k0] * fractap + line[k1] * (1.0 - fractap); // FIXME move to the one mul form
-
-    return result;
-}
-
 template <typename FXConfig>
 inline void Flanger<FXConfig>::processBlock(float *__restrict dataL, float *__restrict dataR)
 {
@@ -396,9 +371,9 @@ inline void Flanger<FXConfig>::processBlock(float *__restrict dataL, float *__re
             // OK so biggest tap = delaybase[c][i].v * ( 1.0 + lfoval[c][i].v * depth.v ) + 1;
             // Assume lfoval is [-1,1] and depth is known
             float maxtap = nv * (1.0 + depth_val) + 1;
-            if (maxtap >= InterpDelay::DELAY_SIZE)
+            if (maxtap >= DELAY_SIZE)
             {
-                nv = nv * 0.999 * InterpDelay::DELAY_SIZE / maxtap;
+                nv = nv * 0.999 * DELAY_SIZE / maxtap;
             }
             delaybase[c][i].newValue(nv);
 
@@ -514,19 +489,20 @@ inline void Flanger<FXConfig>::processBlock(float *__restrict dataL, float *__re
     {
         for (int c = 0; c < 2; ++c)
         {
-            combs[c][b] = 0;
+            // a tap of t is t samples before the one last pushed, so t + 1 back on the line
+            float taps alignas(16)[COMBS_PER_CHANNEL];
             for (int i = 0; i < COMBS_PER_CHANNEL; ++i)
             {
-                if (vweights[c][i] > 0)
-                {
-                    auto tap = delaybase[c][i].v * (1.0 + lfoval[c][i].v * depth.v) + 1;
-                    auto v = idels[c].value(tap);
-                    combs[c][b] += vweights[c][i] * v;
-                }
+                taps[i] = delaybase[c][i].v * (1.0 + lfoval[c][i].v * depth.v) + 2;
 
                 lfoval[c][i].process();
                 delaybase[c][i].process();
             }
+
+            auto d = SIMD_MM(min_ps)(SIMD_MM(load_ps)(taps), SIMD_MM(set1_ps)(DELAY_SIZE - 2));
+            auto v = idels[c].template read4<sdsp::ModulatedDelayInterpolation::LINEAR>(d);
+            combs[c][b] = sst::basic_blocks::mechanics::sum_ps_to_float(
+                SIMD_MM(mul_ps)(v, SIMD_MM(load_ps)(vweights[c])));
         }
         // softclip the feedback to avoid explosive runaways
         float fbl = 0.f;
@@ -550,8 +526,8 @@ inline void Flanger<FXConfig>::processBlock(float *__restrict dataL, float *__re
 
         auto vl = dataL[b] - fbl;
         auto vr = dataR[b] - fbr;
-        idels[0].push(vl);
-        idels[1].push(vr);
+        idels[0].write(vl);
+        idels[1].write(vr);
 
         auto origw = 1.f;
         if (mode == flm_doppler || mode == flm_arp_solo)
@@ -63,6 +63,7 @@ template <typename FXConfig> struct Reverb2 : core::EffectTemplateBase<FXConfig>
     static constexpr int NUM_INPUT_ALLPASSES = 4;
     static constexpr int NUM_ALLPASSES_PER_BLOCK = 2;
     static constexpr int MAX_ALLPASS_LEN = 16384 * 8;
+    static constexpr int ALLPASS_LEN_MASK = MAX_ALLPASS_LEN - 1;
     static constexpr int MAX_DELAY_LEN = 16384 * 8;
     static constexpr int DELAY_LEN_MASK = MAX_DELAY_LEN - 1;
     static constexpr int DELAY_SUBSAMPLE_BITS = 8;
@@ -72,31 +73,18 @@ template <typename FXConfig> struct Reverb2 : core::EffectTemplateBase<FXConfig>
     static constexpr int PREDELAY_BUFFER_SIZE_LIMIT =
         48000 * 8 * 3; // allow for one second of diffusion
 
+    // runs a block at a time, four samples per step, so it has to be at least four long
     class allpass
     {
       public:
         allpass();
-        float process(float x, float coeff);
+        void processBlock(float *__restrict x, const float *__restrict coeff);
         void setLen(int len);
 
       private:
         int _len;
         int _k;
-        float _data[MAX_ALLPASS_LEN];
-    };
-
-    class delay
-    {
-      public:
-        delay();
-        float process(float x, int tap1, float &tap_out1, int tap2, float &tap_out2,
-                      int modulation);
-        void setLen(int len);
-
-      private:
-        int _len;
-        int _k;
-        float _data[MAX_DELAY_LEN];
+        float _data alignas(16)[MAX_ALLPASS_LEN + 4];
     };
 
     class predelay
@@ -121,17 +109,6 @@ template <typename FXConfig> struct Reverb2 : core::EffectTemplateBase<FXConfig>
         float _data[PREDELAY_BUFFER_SIZE];
     };
 
-    class onepole_filter
-    {
-      public:
-        onepole_filter();
-        float process_lowpass(float x, float c0);
-        float process_highpass(float x, float c0);
-
-      private:
-        float a0;
-    };
-
     Reverb2(typename FXConfig::GlobalStorage *s, typename FXConfig::EffectStorage *e,
             typename FXConfig::ValueStorage *p);
 
@@ -205,11 +182,55 @@ template <typename FXConfig> struct Reverb2 : core::EffectTemplateBase<FXConfig>
 
     int ringout_time;
     allpass _input_allpass[NUM_INPUT_ALLPASSES];
-    allpass _allpass[NUM_BLOCKS][NUM_ALLPASSES_PER_BLOCK];
-    onepole_filter _hf_damper[NUM_BLOCKS];
-    onepole_filter _lf_damper[NUM_BLOCKS];
-    delay _delay[NUM_BLOCKS];
     predelay _predelay;
+
+    /*
+     * The tank is a loop of four blocks, each two allpasses, a damper and a delay, and each
+     * fed by the one before. Every block starts from its delay output though, which only
+     * depends on what was written before this sample, so once those are read the four blocks
+     * are independent and run side by side, one per SIMD lane.
+     *
+     * Better still, everything the tank reads is at least a block old, so a whole block of
+     * delay outputs and taps can be read up front, and the allpass lines can be read and
+     * written four samples at a time (transposed into and out of the lanes). Each line keeps
+     * its own buffer, because the lanes read at different offsets and interleaving them would
+     * only spread every read over more cache lines. The lines all write at one position,
+     * which advances a block at a time, and each carries a copy of its first four samples past
+     * the end so an unaligned read of four never has to wrap.
+     */
+    float _tank_allpass alignas(16)[NUM_ALLPASSES_PER_BLOCK][NUM_BLOCKS][MAX_ALLPASS_LEN + 4];
+    float _tank_delay alignas(16)[NUM_BLOCKS][MAX_DELAY_LEN + 4];
+    int _tank_allpass_len[NUM_ALLPASSES_PER_BLOCK][NUM_BLOCKS];
+    int _tank_delay_len[NUM_BLOCKS];
+    int _tank_allpass_pos{0}, _tank_delay_pos{0};
+    SIMD_M128 _hf_damper, _lf_damper;
+
+    static inline void transpose4(SIMD_M128 *v)
+    {
+        auto t0 = SIMD_MM(unpacklo_ps)(v[0], v[1]);
+        auto t1 = SIMD_MM(unpacklo_ps)(v[2], v[3]);
+        auto t2 = SIMD_MM(unpackhi_ps)(v[0], v[1]);
+        auto t3 = SIMD_MM(unpackhi_ps)(v[2], v[3]);
+        v[0] = SIMD_MM(movelh_ps)(t0, t1);
+        v[1] = SIMD_MM(movehl_ps)(t1, t0);
+        v[2] = SIMD_MM(movelh_ps)(t2, t3);
+        v[3] = SIMD_MM(movehl_ps)(t3, t2);
+    }
+
+    // write four samples of each lane at pos, which is always a multiple of four
+    template <int N>
+    static inline void storeLanes(float (*lines)[N], int pos, SIMD_M128 *samples)
+    {
+        transpose4(samples);
+
+        for (int b = 0; b < NUM_BLOCKS; b++)
+        {
+            SIMD_MM(store_ps)(&lines[b][pos], samples[b]);
+
+            if (pos == 0)
+                SIMD_MM(store_ps)(&lines[b][N - 4], samples[b]);
+        }
+    }
     int _tap_timeL[NUM_BLOCKS];
     int _tap_timeR[NUM_BLOCKS];
     float _tap_gainL[NUM_BLOCKS];
@@ -255,80 +276,41 @@ Reverb2<FXConfig>::Reverb2(typename FXConfig::GlobalStorage *s, typename FXConfi
     : core::EffectTemplateBase<FXConfig>(s, e, p)
 {
     _state = 0.f;
+    memset(_tank_allpass, 0, sizeof(_tank_allpass));
+    memset(_tank_delay, 0, sizeof(_tank_delay));
+    _hf_damper = SIMD_MM(setzero_ps)();
+    _lf_damper = SIMD_MM(setzero_ps)();
 }
 
 template <typename FXConfig> Reverb2<FXConfig>::allpass::allpass()
 {
     _k = 0;
-    _len = 1;
-    memset(_data, 0, MAX_ALLPASS_LEN * sizeof(float));
+    _len = 4;
+    memset(_data, 0, sizeof(_data));
 }
 
 template <typename FXConfig> void Reverb2<FXConfig>::allpass::setLen(int len)
 {
-    _len = std::clamp(len, 0, MAX_ALLPASS_LEN - 1);
-}
-
-template <typename FXConfig> float Reverb2<FXConfig>::allpass::process(float in, float coeff)
-{
-    _k++;
-    if (_k >= _len)
-        _k = 0;
-    float delay_in = in - coeff * _data[_k];
-    float result = _data[_k] + coeff * delay_in;
-    _data[_k] = delay_in;
-    return result;
-}
-
-template <typename FXConfig> Reverb2<FXConfig>::delay::delay()
-{
-    _k = 0;
-    _len = 1;
-    memset(_data, 0, MAX_DELAY_LEN * sizeof(float));
-}
-
-template <typename FXConfig> void Reverb2<FXConfig>::delay::setLen(int len)
-{
-    _len = std::clamp(len, 0, MAX_DELAY_LEN - 1);
+    _len = std::clamp(len, 4, MAX_ALLPASS_LEN - 1);
 }
 
 template <typename FXConfig>
-float Reverb2<FXConfig>::delay::process(float in, int tap1, float &tap_out1, int tap2,
-                                        float &tap_out2, int modulation)
+void Reverb2<FXConfig>::allpass::processBlock(float *__restrict x, const float *__restrict coeff)
 {
-    _k = (_k + 1) & DELAY_LEN_MASK;
-
-    tap_out1 = _data[(_k - tap1) & DELAY_LEN_MASK];
-    tap_out2 = _data[(_k - tap2) & DELAY_LEN_MASK];
-
-    int modulation_int = modulation >> DELAY_SUBSAMPLE_BITS;
-    int modulation_frac1 = modulation & (DELAY_SUBSAMPLE_RANGE - 1);
-    int modulation_frac2 = DELAY_SUBSAMPLE_RANGE - modulation_frac1;
-
-    float d1 = _data[(_k - _len + modulation_int + 1) & DELAY_LEN_MASK];
-    float d2 = _data[(_k - _len + modulation_int) & DELAY_LEN_MASK];
-    const float multiplier = 1.f / (float)(DELAY_SUBSAMPLE_RANGE);
-
-    float result = (d1 * (float)modulation_frac1 + d2 * (float)modulation_frac2) * multiplier;
-    _data[_k] = in;
-
-    return result;
-}
-
-template <typename FXConfig> Reverb2<FXConfig>::onepole_filter::onepole_filter() { a0 = 0.f; }
-
-template <typename FXConfig>
-float Reverb2<FXConfig>::onepole_filter::process_lowpass(float x, float c0)
-{
-    a0 = a0 * c0 + x * (1.f - c0);
-    return a0;
-}
+    // _k is where this block starts writing, always a multiple of four
+    for (int k = 0; k < FXConfig::blockSize; k += 4)
+    {
+        auto d = SIMD_MM(loadu_ps)(&_data[(_k + k - _len) & ALLPASS_LEN_MASK]);
+        auto c = SIMD_MM(load_ps)(coeff + k);
+        auto delay_in = SIMD_MM(sub_ps)(SIMD_MM(load_ps)(x + k), SIMD_MM(mul_ps)(c, d));
+        SIMD_MM(store_ps)(x + k, SIMD_MM(add_ps)(d, SIMD_MM(mul_ps)(c, delay_in)));
+        SIMD_MM(store_ps)(&_data[_k + k], delay_in);
+
+        if (_k + k == 0)
+            SIMD_MM(store_ps)(&_data[MAX_ALLPASS_LEN], delay_in);
+    }
 
-template <typename FXConfig>
-float Reverb2<FXConfig>::onepole_filter::process_highpass(float x, float c0)
-{
-    a0 = a0 * (1.f - c0) + x * c0;
-    return x - a0;
+    _k = (_k + FXConfig::blockSize) & ALLPASS_LEN_MASK;
 }
 
 template <typename FXConfig> void Reverb2<FXConfig>::update_rtime()
@@ -361,21 +343,26 @@ template <typename FXConfig> void Reverb2<FXConfig>::calc_size(float scale)
     _input_allpass[2].setLen(msToSamples(10.13, m, sr));
     _input_allpass[3].setLen(msToSamples(16.72, m, sr));
 
-    _allpass[0][0].setLen(msToSamples(38.2, m, sr));
-    _allpass[0][1].setLen(msToSamples(53.4, m, sr));
-    _delay[0].setLen(msToSamples(178.8, m, sr));
-
-    _allpass[1][0].setLen(msToSamples(44.0, m, sr));
-    _allpass[1][1].setLen(msToSamples(41, m, sr));
-    _delay[1].setLen(msToSamples(126.5, m, sr));
-
-    _allpass[2][0].setLen(msToSamples(48.3, m, sr));
-    _allpass[2][1].setLen(msToSamples(60.5, m, sr));
-    _delay[2].setLen(msToSamples(106.1, m, sr));
+    /*
+     * The tank reads a block at a time, so nothing may reach back less than a block. That
+     * includes the delays at their full modulation depth of 5 ms; none of these get anywhere
+     * near the limits at any sample rate we run at.
+     */
+    constexpr int bs = FXConfig::blockSize;
+    const int minDelay = bs + (int)(sr * 0.005f) + 2;
+
+    auto setTank = [&](int b, float allpass0, float allpass1, float delay) {
+        _tank_allpass_len[0][b] = std::clamp(msToSamples(allpass0, m, sr), bs, MAX_ALLPASS_LEN - 1);
+        _tank_allpass_len[1][b] = std::clamp(msToSamples(allpass1, m, sr), bs, MAX_ALLPASS_LEN - 1);
+        _tank_delay_len[b] = std::clamp(msToSamples(delay, m, sr), minDelay, MAX_DELAY_LEN - 1);
+        _tap_timeL[b] = std::clamp(_tap_timeL[b], bs, MAX_DELAY_LEN - 1);
+        _tap_timeR[b] = std::clamp(_tap_timeR[b], bs, MAX_DELAY_LEN - 1);
+    };
 
-    _allpass[3][0].setLen(msToSamples(38.9, m, sr));
-    _allpass[3][1].setLen(msToSamples(42.2, m, sr));
-    _delay[3].setLen(msToSamples(139.4, m, sr));
+    setTank(0, 38.2, 53.4, 178.8);
+    setTank(1, 44.0, 41, 126.5);
+    setTank(2, 48.3, 60.5, 106.1);
+    setTank(3, 38.9, 42.2, 139.4);
 }
 
 template <typename FXConfig> void Reverb2<FXConfig>::setvars(bool init)
@@ -413,73 +400,165 @@ template <typename FXConfig> void Reverb2<FXConfig>::processBlock(float *dataL,
     _buildup.newValue(0.7f * this->floatValue(rev2_buildup));
     _hf_damp_coefficent.newValue(0.8 * this->floatValue(rev2_hf_damping));
     _lf_damp_coefficent.newValue(0.2 * this->floatValue(rev2_lf_damping));
-    _modulation.newValue(this->floatValue(rev2_modulation) * this->sampleRate() * 0.001f * 5.f);
+    // clamped, since the tank can't read any closer than calc_size allows for
+    _modulation.newValue(std::clamp(this->floatValue(rev2_modulation), 0.f, 1.f) *
+                         this->sampleRate() * 0.001f * 5.f);
 
     this->setWidthTarget(width, rev2_width);
 
     mix.set_target_smoothed(this->floatValue(rev2_mix));
 
-    _lfo.set_rate(2.0 * M_PI * powf(2, -2.f) / this->sampleRate());
+    /*
+     * The tank LFO turns a fraction of a degree over a block, so it steps once per block and
+     * each block's phase is swept linearly across it.
+     */
+    _lfo.set_rate(2.0 * M_PI * powf(2, -2.f) * FXConfig::blockSize / this->sampleRate());
+
+    auto lfo = SIMD_MM(setr_ps)(_lfo.r, _lfo.i, -_lfo.r, -_lfo.i);
+    _lfo.process();
+    auto lfoStep = SIMD_MM(mul_ps)(
+        SIMD_MM(sub_ps)(SIMD_MM(setr_ps)(_lfo.r, _lfo.i, -_lfo.r, -_lfo.i), lfo),
+        SIMD_MM(set1_ps)(1.f / FXConfig::blockSize));
 
     int pdt = std::clamp((int)(this->sampleRate() * pow(2.f, this->floatValue(rev2_predelay)) *
                                this->temposyncRatioInv(rev2_predelay)),
                          1, PREDELAY_BUFFER_SIZE_LIMIT - 1);
 
+    /*
+     * Each input allpass only sees its own past a few milliseconds back, so taking them one
+     * whole block at a time gives the same result as running the chain sample by sample,
+     * without every sample waiting on all four in turn, and lets each take four at once.
+     */
+    float input alignas(16)[FXConfig::blockSize], diffusion alignas(16)[FXConfig::blockSize];
+
     for (int k = 0; k < FXConfig::blockSize; k++)
     {
-        float in = (dataL[k] + dataR[k]) * 0.5f;
+        input[k] = _predelay.process((dataL[k] + dataR[k]) * 0.5f, pdt);
+        diffusion[k] = _diffusion.v;
+        _diffusion.process();
+    }
 
-        in = _predelay.process(in, pdt);
+    for (auto &ap : _input_allpass)
+        ap.processBlock(input, diffusion);
 
-        in = _input_allpass[0].process(in, _diffusion.v);
-        in = _input_allpass[1].process(in, _diffusion.v);
-        in = _input_allpass[2].process(in, _diffusion.v);
-        in = _input_allpass[3].process(in, _diffusion.v);
-        float x = _state;
+    constexpr int bs = FXConfig::blockSize;
+    const int dp0 = _tank_delay_pos, ap0 = _tank_allpass_pos;
 
-        float outL = 0.f;
-        float outR = 0.f;
+    // the taps all reach back past the start of the block
+    mech::clear_block<bs>(wetL);
+    mech::clear_block<bs>(wetR);
 
-        float lfos[NUM_BLOCKS];
-        lfos[0] = _lfo.r;
-        lfos[1] = _lfo.i;
-        lfos[2] = -_lfo.r;
-        lfos[3] = -_lfo.i;
+    auto addTap = [this, dp0](float *wet, int b, int tap, float gain) {
+        auto g = SIMD_MM(set1_ps)(gain);
 
-        auto hdc = std::clamp(_hf_damp_coefficent.v, 0.01f, 0.99f);
-        auto ldc = std::clamp(_lf_damp_coefficent.v, 0.01f, 0.99f);
-        for (int b = 0; b < NUM_BLOCKS; b++)
+        for (int k = 0; k < bs; k += 4)
+        {
+            auto d = SIMD_MM(loadu_ps)(&_tank_delay[b][(dp0 + k - tap) & DELAY_LEN_MASK]);
+            SIMD_MM(store_ps)(wet + k, SIMD_MM(add_ps)(SIMD_MM(load_ps)(wet + k),
+                                                       SIMD_MM(mul_ps)(d, g)));
+        }
+    };
+
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        addTap(wetL, b, _tap_timeL[b], _tap_gainL[b]);
+        addTap(wetR, b, _tap_timeR[b], _tap_gainR[b]);
+    }
+
+    // and so do the modulated delay outputs, interpolated between two neighbouring samples
+    SIMD_M128 delayed[bs];
+    const auto subsampleMask = SIMD_MM(set1_epi32)(DELAY_SUBSAMPLE_RANGE - 1);
+    const auto subsampleRange = SIMD_MM(set1_ps)((float)DELAY_SUBSAMPLE_RANGE);
+    const auto subsampleRangeInv = SIMD_MM(set1_ps)(1.f / (float)(DELAY_SUBSAMPLE_RANGE));
+
+    for (int k = 0; k < bs; k++)
+    {
+        auto modulation = SIMD_MM(cvttps_epi32)(
+            SIMD_MM(mul_ps)(SIMD_MM(mul_ps)(SIMD_MM(set1_ps)(_modulation.v), lfo), subsampleRange));
+        int modInt alignas(16)[NUM_BLOCKS];
+        SIMD_MM(store_si128)((SIMD_M128I *)modInt, modulation);
+
+        auto readAt = [this, dp = dp0 + k, &modInt](int b, int plus) {
+            int offset = _tank_delay_len[b] - (modInt[b] >> DELAY_SUBSAMPLE_BITS) - plus;
+            return _tank_delay[b][(dp - offset) & DELAY_LEN_MASK];
+        };
+
+        auto d1 = SIMD_MM(setr_ps)(readAt(0, 1), readAt(1, 1), readAt(2, 1), readAt(3, 1));
+        auto d2 = SIMD_MM(setr_ps)(readAt(0, 0), readAt(1, 0), readAt(2, 0), readAt(3, 0));
+
+        auto frac1 = SIMD_MM(cvtepi32_ps)(SIMD_MM(and_si128)(modulation, subsampleMask));
+        auto frac2 = SIMD_MM(sub_ps)(subsampleRange, frac1);
+        auto d = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(d1, frac1), SIMD_MM(mul_ps)(d2, frac2));
+        d = SIMD_MM(mul_ps)(d, subsampleRangeInv);
+        delayed[k] = SIMD_MM(mul_ps)(d, SIMD_MM(set1_ps)(_decay_multiply.v));
+
+        lfo = SIMD_MM(add_ps)(lfo, lfoStep);
+        _decay_multiply.process();
+        _modulation.process();
+    }
+
+    // then the four blocks run side by side, four samples at a time
+    const auto one = SIMD_MM(set1_ps)(1.f);
+    const auto ldc = SIMD_MM(set1_ps)(std::clamp(_lf_damp_coefficent.v, 0.01f, 0.99f));
+
+    for (int k = 0; k < bs; k += 4)
+    {
+        SIMD_M128 allpassData[NUM_ALLPASSES_PER_BLOCK][4];
+
+        for (int c = 0; c < NUM_ALLPASSES_PER_BLOCK; c++)
+        {
+            for (int b = 0; b < NUM_BLOCKS; b++)
+            {
+                auto rp = (ap0 + k - _tank_allpass_len[c][b]) & ALLPASS_LEN_MASK;
+                allpassData[c][b] = SIMD_MM(loadu_ps)(&_tank_allpass[c][b][rp]);
+            }
+            transpose4(allpassData[c]);
+        }
+
+        SIMD_M128 out[4];
+
+        for (int j = 0; j < 4; j++)
         {
-            x = x + in;
+            auto del = delayed[k + j];
+
+            // block b takes what block b - 1 just put out, block 0 what block 3 did last sample
+            auto x = SIMD_MM(shuffle_ps)(del, del, SIMD_MM_SHUFFLE(2, 1, 0, 3));
+            x = SIMD_MM(move_ss)(x, SIMD_MM(set_ss)(_state));
+            x = SIMD_MM(add_ps)(x, SIMD_MM(set1_ps)(input[k + j]));
+            _state = SIMD_MM(cvtss_f32)(SIMD_MM(shuffle_ps)(del, del, SIMD_MM_SHUFFLE(3, 3, 3, 3)));
+
+            const auto buildup = SIMD_MM(set1_ps)(_buildup.v);
+
             for (int c = 0; c < NUM_ALLPASSES_PER_BLOCK; c++)
             {
-                x = _allpass[b][c].process(x, _buildup.v);
+                auto d = allpassData[c][j];
+                auto delay_in = SIMD_MM(sub_ps)(x, SIMD_MM(mul_ps)(buildup, d));
+                x = SIMD_MM(add_ps)(d, SIMD_MM(mul_ps)(buildup, delay_in));
+                allpassData[c][j] = delay_in;
             }
 
-            x = _hf_damper[b].process_lowpass(x, hdc);
-            x = _lf_damper[b].process_highpass(x, ldc);
+            auto hdc = SIMD_MM(set1_ps)(std::clamp(_hf_damp_coefficent.v, 0.01f, 0.99f));
 
-            int modulation = (int)(_modulation.v * lfos[b] * (float)DELAY_SUBSAMPLE_RANGE);
-            float tap_outL = 0.f;
-            float tap_outR = 0.f;
-            x = _delay[b].process(x, _tap_timeL[b], tap_outL, _tap_timeR[b], tap_outR, modulation);
-            outL += tap_outL * _tap_gainL[b];
-            outR += tap_outR * _tap_gainR[b];
+            _hf_damper = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(_hf_damper, hdc),
+                                         SIMD_MM(mul_ps)(x, SIMD_MM(sub_ps)(one, hdc)));
+            x = _hf_damper;
+            _lf_damper = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(_lf_damper, SIMD_MM(sub_ps)(one, ldc)),
+                                         SIMD_MM(mul_ps)(x, ldc));
+            out[j] = SIMD_MM(sub_ps)(x, _lf_damper);
 
-            x *= _decay_multiply.v;
+            _buildup.process();
+            _hf_damp_coefficent.process();
         }
 
-        wetL[k] = outL;
-        wetR[k] = outR;
-        _state = x;
-        _decay_multiply.process();
-        _diffusion.process();
-        _buildup.process();
-        _hf_damp_coefficent.process();
-        _lfo.process();
-        _modulation.process();
+        for (int c = 0; c < NUM_ALLPASSES_PER_BLOCK; c++)
+            storeLanes(_tank_allpass[c], ap0 + k, allpassData[c]);
+
+        storeLanes(_tank_delay, dp0 + k, out);
     }
 
+    _tank_delay_pos = (dp0 + bs) & DELAY_LEN_MASK;
+    _tank_allpass_pos = (ap0 + bs) & ALLPASS_LEN_MASK;
+
     // scale width
     this->applyWidth(wetL, wetR, width);
 
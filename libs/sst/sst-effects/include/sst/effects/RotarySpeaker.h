@@ -31,6 +31,7 @@
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/mechanics/simd-ops.h"
 #include "sst/basic-blocks/dsp/QuadratureOscillators.h"
+#include "sst/basic-blocks/dsp/ModulatedDelayLine.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
 
 namespace sst::effects::rotaryspeaker
@@ -129,8 +130,7 @@ template <typename FXConfig> struct RotarySpeaker : core::EffectTemplateBase<FXC
 
   protected:
     static constexpr int maxDelayLength{1 << 18};
-    float buffer[maxDelayLength];
-    int wpos;
+    sst::basic_blocks::dsp::FixedModulatedDelayLine<maxDelayLength> line;
     // filter *lp[2],*hp[2];
     // biquadunit rotor_lpL,rotor_lpR;
     BiquadFilter xover, lowbass;
@@ -157,9 +157,8 @@ template <typename FXConfig> struct RotarySpeaker : core::EffectTemplateBase<FXC
 
 template <typename FXConfig> inline void RotarySpeaker<FXConfig>::initialize()
 {
-    memset(buffer, 0, maxDelayLength * sizeof(float));
-
-    wpos = 0;
+    line.clear();
+    line.sinctable1X = sincTable.sinctable1X;
 
     xover.suspend();
     lowbass.suspend();
@@ -364,40 +363,26 @@ inline void RotarySpeaker<FXConfig>::processBlock(float *__restrict dataL, float
 
     xover.process_block(lower);
 
+    namespace sdsp = sst::basic_blocks::dsp;
+    const float minDelay = FXConfig::blockSize;
+    const float maxDelay = maxDelayLength - line.padding - 2;
+
     for (k = 0; k < FXConfig::blockSize; k++)
     {
         // feed delay input
-        int wp = (wpos + k) & (maxDelayLength - 1);
         lower_sub[k] = lower[k];
         upper[k] -= lower[k];
-        buffer[wp] = upper[k];
-
-        int i_dtimeL = std::max<int>(FXConfig::blockSize,
-                                     std::min((int)dL.v, maxDelayLength - sincTable.FIRipol_N - 1));
-        int i_dtimeR = std::max<int>(FXConfig::blockSize,
-                                     std::min((int)dR.v, maxDelayLength - sincTable.FIRipol_N - 1));
-
-        int rpL = (wpos - i_dtimeL + k);
-        int rpR = (wpos - i_dtimeR + k);
-
-        assert(sincTable.FIRipol_M - 1 > 0);
-        int sincL = sincTable.FIRipol_N *
-                    std::clamp((int)(sincTable.FIRipol_M * (float(i_dtimeL + 1) - dL.v)), 0,
-                               sincTable.FIRipol_M - 1);
-        int sincR = sincTable.FIRipol_N *
-                    std::clamp((int)(sincTable.FIRipol_M * (float(i_dtimeR + 1) - dR.v)), 0,
-                               sincTable.FIRipol_M - 1);
-
-        // get delay output
-        tbufferL[k] = 0;
-        tbufferR[k] = 0;
-        for (int i = 0; i < sincTable.FIRipol_N; i++)
-        {
-            tbufferL[k] += buffer[(rpL - i) & (maxDelayLength - 1)] *
-                           sincTable.sinctable1X[sincL + sincTable.FIRipol_N - i];
-            tbufferR[k] += buffer[(rpR - i) & (maxDelayLength - 1)] *
-                           sincTable.sinctable1X[sincR + sincTable.FIRipol_N - i];
-        }
+        line.write(upper[k]);
+
+        // get delay output, both ears at once; the write above puts the line a sample further on
+        auto tL = std::clamp(dL.v, minDelay, maxDelay) + 1;
+        auto tR = std::clamp(dR.v, minDelay, maxDelay) + 1;
+        float out alignas(16)[4];
+        SIMD_MM(store_ps)(out, line.read4<sdsp::ModulatedDelayInterpolation::SINC>(
+                                   SIMD_MM(setr_ps)(tL, tR, tL, tR)));
+        tbufferL[k] = out[0];
+        tbufferR[k] = out[1];
+
         dL.process();
         dR.process();
     }
@@ -422,9 +407,6 @@ inline void RotarySpeaker<FXConfig>::processBlock(float *__restrict dataL, float
     this->applyWidth(wbL, wbR, width);
 
     mix.fade_2_blocks_inplace(dataL, wbL, dataR, wbR, FXConfig::blockSize >> 2);
-
-    wpos += FXConfig::blockSize;
-    wpos = wpos & (maxDelayLength - 1);
 }
 } // namespace sst::effects::rotaryspeaker
 #endif // INCLUDE_SST_EFFECTS_ROTARYSPEAKER_H
@@ -158,104 +158,39 @@ class alignas(16) HalfRateFilter
             oldout = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(3, 3, 1, 1));
         }
     }
+    /*
+     * The resampling variants run the allpass cascades polyphase. Every section is an allpass
+     * in z^-2, so at the high rate the even and odd samples run through it as two independent
+     * chains. Decimating only ever reads the B branch on even samples and the A branch on odd
+     * ones, and upsampling feeds zeros into the odd chain, so the other half of the work is
+     * never heard. Instead each step at the low rate lines the lanes up as
+     *
+     * A_L, B_L, A_R, B_R
+     *
+     * matching the coefficient order in va, and runs every section as a first order step on
+     * the previous low rate sample. This is the same arithmetic as the full rate cascade on the
+     * samples that matter, at half the cost. The state is kept in vx0 and vy0.
+     */
     void process_block_D2(float *floatL, float *floatR, int nsamples, float *outL = 0,
                           float *outR = 0) // process in-place. the new block will be half the size
     {
         auto *L = (SIMD_M128 *)floatL;
         auto *R = (SIMD_M128 *)floatR;
-        SIMD_M128 o[hr_BLOCK_SIZE];
+        SIMD_M128 o[hr_BLOCK_SIZE / 2];
 
         /*
-         * fill the buffer with interleaved stereo samples by rotating the
-         * input simd-in-time a bit
-         *
-         * SIMD_MM(shuffle_ps)(a,b,SIMD_MM_SHUFFLE(i,j,k,l)) returns a[i], a[j], b[k], b[l]
-         *
-         * So this loop makes o look like the rotation of L and R. That is
+         * SIMD_MM(shuffle_ps)(a,b,SIMD_MM_SHUFFLE(i,j,k,l)) returns a[l], a[k], b[j], b[i]
          *
-         * o[n] = {L[n],L[n],R[n],R[n]}
-         *
-         * for n in 0..nsamples leading o to being LLRR pairs of the input
+         * so o[n] = {L[2n+1], L[2n], R[2n+1], R[2n]}, the odd samples going to the A branch
          */
         for (int k = 0; k < nsamples; k += 4)
         {
-            o[k] = SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(0, 0, 0, 0));
-            o[k + 1] = SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            o[k + 2] = SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(2, 2, 2, 2));
-            o[k + 3] = SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(3, 3, 3, 3));
+            o[k >> 1] = SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(0, 1, 0, 1));
+            o[(k >> 1) + 1] =
+                SIMD_MM(shuffle_ps)(L[k >> 2], R[k >> 2], SIMD_MM_SHUFFLE(2, 3, 2, 3));
         }
 
-        /*
-         * Process filters. We have a cascade of M three point filters we need to run.
-         * Each has a state vx0..2 and vy0..2 indexed by the filter M. We also have coefficients
-         * for each filter A_M and B_M. which are loaded into ta in set_coefficients in order
-         * B A B A in SIMD space
-         *
-         * The filter step is x2 = x1; x1 = x0; x0 = o. Which means the X have the LL RR form.
-         *
-         * Then y2 = y1, y1 = y0 and y0 = x2 + (x0-y2) * a
-         *
-         * Then o = y0. Fine. But what's that filter step doing. Basically it is saying for each
-         * L and R pair we get two AllPass updates. So expanding the vector you get
-         *
-         * 0: y0_0 = x2_0 + (L - y2_0) + B
-         * 1: y0_0 = x2_0 + (L - y2_0) + A
-         *
-         * etc... - basically we have done a pair of all passes at each M.
-         *
-         * So at the end of this loop for each order, the 'o' array will be filled
-         * with the cascade of coefficient B or A all passes and will be in order
-         *
-         * o_i: AllPassCascade_B(L_i), AllPassCascade_A(L_i), AllPassCascade_B(R_i),
-         * AllPassCascade_A(R_i)
-         */
-        for (auto j = 0U; j < M; j++)
-        {
-            auto tx0 = vx0[j];
-            auto tx1 = vx1[j];
-            auto tx2 = vx2[j];
-            auto ty0 = vy0[j];
-            auto ty1 = vy1[j];
-            auto ty2 = vy2[j];
-            auto ta = va[j];
-
-            // Why is this loop hand-unrolled?
-            for (int k = 0; k < nsamples; k += 2)
-            {
-                // shuffle inputs
-                tx2 = tx1;
-                tx1 = tx0;
-                tx0 = o[k];
-                // shuffle outputs
-                ty2 = ty1;
-                ty1 = ty0;
-                // allpass filter 1
-                ty0 = SIMD_MM(add_ps)(tx2, SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(tx0, ty2), ta));
-                o[k] = ty0;
-
-                // shuffle inputs
-                tx2 = tx1;
-                tx1 = tx0;
-                tx0 = o[k + 1];
-                // shuffle outputs
-                ty2 = ty1;
-                ty1 = ty0;
-                // allpass filter 1
-                ty0 = SIMD_MM(add_ps)(tx2, SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(tx0, ty2), ta));
-                o[k + 1] = ty0;
-            }
-            vx0[j] = tx0;
-            vx1[j] = tx1;
-            vx2[j] = tx2;
-            vy0[j] = ty0;
-            vy1[j] = ty1;
-            vy2[j] = ty2;
-        }
-
-        auto aR = SIMD_MM(setzero_ps)();
-        auto bR = SIMD_MM(setzero_ps)();
-        auto cR = SIMD_MM(setzero_ps)();
-        auto dR = SIMD_MM(setzero_ps)();
+        processPolyphase(o, nsamples >> 1);
 
         if (outL)
             L = (SIMD_M128 *)outL;
@@ -263,122 +198,26 @@ class alignas(16) HalfRateFilter
             R = (SIMD_M128 *)outR;
 
         /*
-         * OK so now we have all the filtered signals we want to reconstruct the output.
-         * This is basically the sample selection stage. To read this code you need
-         * to remember that SIMD_MM(movehl_ps)(a,b) results in b[3], b[4], a[3], a[4] as the
-         * simd output.
-         *
-         * The code had this comment
-         *
-         *  const double output=(filter_a.process(input)+oldout)*0.5;
-         *  oldout=filter_b.process(input);
-         *
-         * atop this code
-         *
-         * auto tL0 = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-         * auto tR0 = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-         * auto aL = SIMD_MM(add_ss)(tL0, o[k + 1]);
-         * aR = SIMD_MM(movehl_ps)(aR, o[k + 1]);
-         * aR = SIMD_MM(add_ss)(aR, tR0);
-         *
-         * So can we make that tie out? Remembering o now has the for B_L A_L, B_R, A_R
-         *
-         * So tL0 = SIMD_MM(shuffle_ps)(o[k], o[k], 11111)
-         * or tL0 = o[k][1] in every slot or tl0 is A_L across the board at sample k.
-         * Similarly tR0 = A_R across the board at sample K.
-         *
-         * Now recall SIMD_MM(add_ss)(a,b) gives you (a[0]+b[0], a[1], a[2], a[3]) so now we do
-         *
-         * auto aL = SIMD_MM(add_ss)(tL0, o[k + 1]);
-         * aL = (A_L[k] + B_L[k+1], A_L[k],  A_L[k], A_L[k]);
-         *
-         * Now
-         *
-         * aR = SIMD_MM(movehl_ps)(aR, o[k + 1]);
-         * aR = B_R[k+1], A_R[k+1], aR[3], aR[4]
-         *
-         * aR = SIMD_MM(add_ss)(aR, tR0) or
-         * aR = (A_R[k] + B_R[k+1], A_R[k+1], aR[3], aR[4])
-         *
-         * (At this point I'm suspecting that the rest of the SIMD registeres in A wont matter)
-         *
-         * Now similarly bL and bR, cL and cR, dL and dR are constructed with the same code just
-         * at index k+2/3, k+4/5, k+6/7
-         *
-         * So once those stages are assembled we do this
-         *
-         * aL = SIMD_MM(movelh_ps)(aL, bL);
-         * cL = SIMD_MM(movelh_ps)(cL, dL);
-         * L[k >> 3] = SIMD_MM(shuffle_ps)(aL, cL, SIMD_MM_SHUFFLE(2, 0, 2, 0));
-         *
-         * And similarly for R. So what's that doing. So first of all _mm_novelh_ps [note lh
-         * not hl] has signatlre
-         *
-         * SIMD_MM(movelh_ps)(a,b) = a[0],a[1],b[0],b[1]
-         *
-         * so this sets
-         *
-         * aL = aL[0],aL[1],bL[0],bL[1]
-         * cL = cL[0], cL[1], dL[0], dL[1]
-         *
-         * and then that shuffle says
+         * Each output is half the sum of the two branches of one step, that is
          *
-         * L = aL[2],aL[0],cL[2],cL[0]
-         *
-         * which looks a lot to me like I have a bit flip somewhere wrong in my
-         * comments (like that should be 0202 not 2020 but leave that for now)
-         * because essentially all this complexity is resulting in
-         *
-         * L[i] = A_L[2*i] + B_L[2+i+1]
-         *
-         * Namely all this code does two things
-         *
-         * 1. Run a cascade of all pass filters
-         * 2. Interleave the output with offset samples for the downsample between
-         *    the two filter sides
+         * L[n] = (A_L[2n+1] + B_L[2n]) * 0.5
          *
+         * so pair up the lanes of two steps and add them, then split out L and R
          */
-        for (int k = 0; k < nsamples; k += 8)
+        for (int n = 0; n < (nsamples >> 1); n += 4)
         {
-            /*	const double output=(filter_a.process(input)+oldout)*0.5;
-            oldout=filter_b.process(input);*/
-
-            auto tL0 = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            auto tR0 = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-            auto aL = SIMD_MM(add_ss)(tL0, o[k + 1]);
-            aR = SIMD_MM(movehl_ps)(aR, o[k + 1]);
-            aR = SIMD_MM(add_ss)(aR, tR0);
-
-            tL0 = SIMD_MM(shuffle_ps)(o[k + 2], o[k + 2], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            tR0 = SIMD_MM(shuffle_ps)(o[k + 2], o[k + 2], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-            auto bL = SIMD_MM(add_ss)(tL0, o[k + 3]);
-            bR = SIMD_MM(movehl_ps)(aR, o[k + 3]);
-            bR = SIMD_MM(add_ss)(bR, tR0);
-
-            tL0 = SIMD_MM(shuffle_ps)(o[k + 4], o[k + 4], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            tR0 = SIMD_MM(shuffle_ps)(o[k + 4], o[k + 4], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-            auto cL = SIMD_MM(add_ss)(tL0, o[k + 5]);
-            cR = SIMD_MM(movehl_ps)(cR, o[k + 5]);
-            cR = SIMD_MM(add_ss)(cR, tR0);
-
-            tL0 = SIMD_MM(shuffle_ps)(o[k + 6], o[k + 6], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            tR0 = SIMD_MM(shuffle_ps)(o[k + 6], o[k + 6], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-            auto dL = SIMD_MM(add_ss)(tL0, o[k + 7]);
-            dR = SIMD_MM(movehl_ps)(dR, o[k + 7]);
-            dR = SIMD_MM(add_ss)(dR, tR0);
-
-            aL = SIMD_MM(movelh_ps)(aL, bL);
-            cL = SIMD_MM(movelh_ps)(cL, dL);
-            aR = SIMD_MM(movelh_ps)(aR, bR);
-            cR = SIMD_MM(movelh_ps)(cR, dR);
-
-            L[k >> 3] = SIMD_MM(shuffle_ps)(aL, cL, SIMD_MM_SHUFFLE(2, 0, 2, 0));
-            R[k >> 3] = SIMD_MM(shuffle_ps)(aR, cR, SIMD_MM_SHUFFLE(2, 0, 2, 0));
-
-            // optional: *=0.5;
-            const auto half = SIMD_MM(set_ps1)(0.5f);
-            L[k >> 3] = SIMD_MM(mul_ps)(L[k >> 3], half);
-            R[k >> 3] = SIMD_MM(mul_ps)(R[k >> 3], half);
+            auto a01 = SIMD_MM(add_ps)(
+                SIMD_MM(shuffle_ps)(o[n], o[n + 1], SIMD_MM_SHUFFLE(2, 0, 2, 0)),
+                SIMD_MM(shuffle_ps)(o[n], o[n + 1], SIMD_MM_SHUFFLE(3, 1, 3, 1)));
+            auto a23 = SIMD_MM(add_ps)(
+                SIMD_MM(shuffle_ps)(o[n + 2], o[n + 3], SIMD_MM_SHUFFLE(2, 0, 2, 0)),
+                SIMD_MM(shuffle_ps)(o[n + 2], o[n + 3], SIMD_MM_SHUFFLE(3, 1, 3, 1)));
+
+            // a01 is L[n], R[n], L[n+1], R[n+1] and similarly a23
+            L[n >> 2] = SIMD_MM(mul_ps)(
+                SIMD_MM(shuffle_ps)(a01, a23, SIMD_MM_SHUFFLE(2, 0, 2, 0)), half);
+            R[n >> 2] = SIMD_MM(mul_ps)(
+                SIMD_MM(shuffle_ps)(a01, a23, SIMD_MM_SHUFFLE(3, 1, 3, 1)), half);
         }
     }
 
@@ -390,107 +229,53 @@ class alignas(16) HalfRateFilter
         auto *L_in = (SIMD_M128 *)floatL_in;
         auto *R_in = (SIMD_M128 *)floatR_in;
 
-        SIMD_M128 o[hr_BLOCK_SIZE];
-        // fill the buffer with interleaved stereo samples
-        for (int k = 0; k < nsamples; k += 8)
-        {
-            //[o3,o2,o1,o0] = [L0,L0,R0,R0]
-            o[k] = SIMD_MM(shuffle_ps)(L_in[k >> 3], R_in[k >> 3], SIMD_MM_SHUFFLE(0, 0, 0, 0));
-            o[k + 1] = SIMD_MM(setzero_ps)();
-            o[k + 2] = SIMD_MM(shuffle_ps)(L_in[k >> 3], R_in[k >> 3], SIMD_MM_SHUFFLE(1, 1, 1, 1));
-            o[k + 3] = SIMD_MM(setzero_ps)();
-            o[k + 4] = SIMD_MM(shuffle_ps)(L_in[k >> 3], R_in[k >> 3], SIMD_MM_SHUFFLE(2, 2, 2, 2));
-            o[k + 5] = SIMD_MM(setzero_ps)();
-            o[k + 6] = SIMD_MM(shuffle_ps)(L_in[k >> 3], R_in[k >> 3], SIMD_MM_SHUFFLE(3, 3, 3, 3));
-            o[k + 7] = SIMD_MM(setzero_ps)();
-        }
+        SIMD_M128 o[hr_BLOCK_SIZE / 2];
 
-        // process filters
-        for (auto j = 0U; j < M; j++)
+        // both branches of a channel hear every input sample, o[n] = {L[n], L[n], R[n], R[n]}
+        for (int k = 0; k < (nsamples >> 1); k += 4)
         {
-            auto tx0 = vx0[j];
-            auto tx1 = vx1[j];
-            auto tx2 = vx2[j];
-            auto ty0 = vy0[j];
-            auto ty1 = vy1[j];
-            auto ty2 = vy2[j];
-            auto ta = va[j];
-
-            for (int k = 0; k < nsamples; k += 2)
-            {
-                // shuffle inputs
-                tx2 = tx1;
-                tx1 = tx0;
-                tx0 = o[k];
-                // shuffle outputs
-                ty2 = ty1;
-                ty1 = ty0;
-                // allpass filter 1
-                ty0 = SIMD_MM(add_ps)(tx2, SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(tx0, ty2), ta));
-                o[k] = ty0;
-
-                // shuffle inputs
-                tx2 = tx1;
-                tx1 = tx0;
-                tx0 = o[k + 1];
-                // shuffle outputs
-                ty2 = ty1;
-                ty1 = ty0;
-                // allpass filter 1
-                ty0 = SIMD_MM(add_ps)(tx2, SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(tx0, ty2), ta));
-                o[k + 1] = ty0;
-            }
-            vx0[j] = tx0;
-            vx1[j] = tx1;
-            vx2[j] = tx2;
-            vy0[j] = ty0;
-            vy1[j] = ty1;
-            vy2[j] = ty2;
+            o[k] = SIMD_MM(shuffle_ps)(L_in[k >> 2], R_in[k >> 2], SIMD_MM_SHUFFLE(0, 0, 0, 0));
+            o[k + 1] =
+                SIMD_MM(shuffle_ps)(L_in[k >> 2], R_in[k >> 2], SIMD_MM_SHUFFLE(1, 1, 1, 1));
+            o[k + 2] =
+                SIMD_MM(shuffle_ps)(L_in[k >> 2], R_in[k >> 2], SIMD_MM_SHUFFLE(2, 2, 2, 2));
+            o[k + 3] =
+                SIMD_MM(shuffle_ps)(L_in[k >> 2], R_in[k >> 2], SIMD_MM_SHUFFLE(3, 3, 3, 3));
         }
 
-        /*auto aR = SIMD_MM(setzero_ps)();
-        auto bR = SIMD_MM(setzero_ps)();
-        auto cR = SIMD_MM(setzero_ps)();
-        auto dR = SIMD_MM(setzero_ps)();*/
-
-        float *fL = (float *)L;
-        float *fR = (float *)R;
-        auto faR = SIMD_MM(setzero_ps)();
-        auto fbR = SIMD_MM(setzero_ps)();
+        processPolyphase(o, nsamples >> 1);
 
-        for (int k = 0; k < nsamples; k++)
+        // the A branch gives the even outputs and the B branch the odd ones
+        for (int n = 0; n < (nsamples >> 1); n += 2)
         {
-            //	const double output=(filter_a.process(input)+oldout)*0.5;
-            //	oldout=filter_b.process(input);
-
-            auto vL = SIMD_MM(add_ss)(o[k], oldout);
-            vL = SIMD_MM(mul_ss)(vL, half);
-            SIMD_MM(store_ss)(&fL[k], vL);
-
-            faR = SIMD_MM(movehl_ps)(faR, o[k]);
-            fbR = SIMD_MM(movehl_ps)(fbR, oldout);
-
-            auto vR = SIMD_MM(add_ss)(faR, fbR);
-            vR = SIMD_MM(mul_ss)(vR, half);
-            SIMD_MM(store_ss)(&fR[k], vR);
+            auto a = SIMD_MM(mul_ps)(o[n], half);
+            auto b = SIMD_MM(mul_ps)(o[n + 1], half);
 
-            oldout = SIMD_MM(shuffle_ps)(o[k], o[k], SIMD_MM_SHUFFLE(3, 3, 1, 1));
+            L[n >> 1] = SIMD_MM(shuffle_ps)(a, b, SIMD_MM_SHUFFLE(1, 0, 1, 0));
+            R[n >> 1] = SIMD_MM(shuffle_ps)(a, b, SIMD_MM_SHUFFLE(3, 2, 3, 2));
         }
+    }
 
-        // If you want to avoid downsampling, do this
-        /*float oldout_f = 0.f;
-        for(unsigned int k=0; k<nsamples; k++)
+    // run the cascade a step at a time at the low rate, see the comment on process_block_D2
+    void processPolyphase(SIMD_M128 *o, int nsteps)
+    {
+        for (auto j = 0U; j < M; j++)
         {
+            auto tx = vx0[j];
+            auto ty = vy0[j];
+            auto ta = va[j];
 
-        float *of = (float*)o;
-        float out_a = of[(k<<2)];
-        float out_b = of[(k<<2)+1];
-
+            for (int n = 0; n < nsteps; n++)
+            {
+                auto x = o[n];
+                ty = SIMD_MM(add_ps)(tx, SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(x, ty), ta));
+                tx = x;
+                o[n] = ty;
+            }
 
-        float *fL = (float*)L;
-        fL[k] = (out_a + oldout_f) * 0.5f;
-        oldout_f = out_b;
-        }		*/
+            vx0[j] = tx;
+            vy0[j] = ty;
+        }
     }
 
     void load_coefficients()
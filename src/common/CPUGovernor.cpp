@@ -0,0 +1,144 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "CPUGovernor.h"
+
+#include <algorithm>
+
+namespace Surge
+{
+namespace Profiling
+{
+int CPUGovernor::update(float load, float blockSeconds, const BlockProfile &lastBlock)
+{
+    blocks++;
+
+    auto l = level.load(std::memory_order_relaxed);
+
+    if (load > overloadedLoad)
+    {
+        overloadedFor += blockSeconds;
+        comfortableFor = 0.f;
+
+        if (overloadedFor >= stepDownSeconds && l < n_governor_levels - 1)
+            step(l + 1, load, lastBlock);
+    }
+    else if (load < comfortableLoad)
+    {
+        comfortableFor += blockSeconds;
+        overloadedFor = 0.f;
+
+        if (comfortableFor >= stepUpSeconds && l > gov_full_quality)
+            step(l - 1, load, lastBlock);
+    }
+    else
+    {
+        // in between, neither step gets any closer
+        overloadedFor = 0.f;
+        comfortableFor = 0.f;
+    }
+
+    return level.load(std::memory_order_relaxed);
+}
+
+void CPUGovernor::reset()
+{
+    if (level.load(std::memory_order_relaxed) != gov_full_quality)
+        step(gov_full_quality, 0.f, BlockProfile());
+
+    overloadedFor = 0.f;
+    comfortableFor = 0.f;
+}
+
+void CPUGovernor::step(int to, float load, const BlockProfile &lastBlock)
+{
+    Transition t;
+    t.block = blocks;
+    t.from = (int8_t)level.load(std::memory_order_relaxed);
+    t.to = (int8_t)to;
+    t.load = load;
+    t.voicesUsec = lastBlock.usec[ps_voices] + lastBlock.usec[ps_filters];
+    for (int i = ps_fx_first; i <= ps_fx_last; ++i)
+        t.effectsUsec += lastBlock.usec[i];
+
+    auto w = written.load(std::memory_order_relaxed);
+    history[w % historySize] = t;
+    written.store(w + 1, std::memory_order_release);
+
+    level.store(to, std::memory_order_relaxed);
+    overloadedFor = 0.f;
+    comfortableFor = 0.f;
+}
+
+std::vector<CPUGovernor::Transition> CPUGovernor::getRecentTransitions(int maxTransitions) const
+{
+    auto end = written.load(std::memory_order_acquire);
+    auto n = (int)std::min<uint64_t>({(uint64_t)std::max(maxTransitions, 0), end, historySize});
+
+    std::vector<Transition> res(n);
+    for (int i = 0; i < n; ++i)
+    {
+        res[i] = history[(end - 1 - i) % historySize];
+    }
+
+    // as in ProcessProfiler::getRecentBlocks, drop whatever the audio thread may have replaced
+    auto after = written.load(std::memory_order_acquire);
+    auto safe = (int64_t)historySize - 1 - (int64_t)(after - end);
+    res.resize((size_t)std::clamp<int64_t>(safe, 0, n));
+
+    return res;
+}
+
+std::string CPUGovernor::levelName(int level)
+{
+    switch (level)
+    {
+    case gov_full_quality:
+        return "Full Quality";
+    case gov_reduced_antialiasing:
+        return "Reduced Oscillator Anti-Aliasing";
+    case gov_polyphony_cap:
+        return "Polyphony Capped";
+    case gov_eco_effect_oversampling:
+        return "Eco Effect Oversampling";
+    }
+
+    return "Unknown";
+}
+
+std::string CPUGovernor::levelShortName(int level)
+{
+    switch (level)
+    {
+    case gov_reduced_antialiasing:
+        return "AA";
+    case gov_polyphony_cap:
+        return "POLY";
+    case gov_eco_effect_oversampling:
+        return "FX OS";
+    }
+
+    return "";
+}
+} // namespace Profiling
+} // namespace Surge
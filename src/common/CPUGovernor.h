@@ -0,0 +1,107 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_CPUGOVERNOR_H
+#define SURGE_SRC_COMMON_CPUGOVERNOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ProcessProfiler.h"
+
+namespace Surge
+{
+namespace Profiling
+{
+/*
+ * What the governor gives up when an instance can't keep up with the host, in the order it
+ * gives them up. Each level includes everything before it.
+ */
+enum GovernorLevel
+{
+    gov_full_quality = 0,
+    gov_reduced_antialiasing,    // unison BLIT oscillators skip the sub-phase interpolation
+    gov_polyphony_cap,           // new notes steal down to fewer voices than the patch allows
+    gov_eco_effect_oversampling, // effects stop oversampling, which restarts them
+    n_governor_levels
+};
+
+/*
+ * Watches the audio thread's load against its realtime budget, and steps down a level when
+ * it has been overloaded for stepDownSeconds and back up a level once it has been
+ * comfortable for stepUpSeconds. The two thresholds and the much longer recovery time keep
+ * it from flapping between levels. After a step either way the timers start again, so the
+ * engine gets a chance to show what the new level costs before the next one.
+ *
+ * The synth calls update() once a block on the audio thread, with the smoothed load it shows
+ * on the CPU meter and the profile of the block it just finished. Anything else can read the
+ * level and the recent transitions at any time.
+ */
+struct CPUGovernor
+{
+    static constexpr float overloadedLoad = 0.9f;
+    static constexpr float comfortableLoad = 0.6f;
+    static constexpr float stepDownSeconds = 0.05f;
+    static constexpr float stepUpSeconds = 3.f;
+    static constexpr int historySize = 32;
+
+    struct Transition
+    {
+        uint64_t block{0};
+        int8_t from{0}, to{0};
+        float load{0.f};
+        float voicesUsec{0.f}, effectsUsec{0.f}; // what the last block before it spent
+    };
+
+    // audio thread. Returns the level for the next block
+    int update(float load, float blockSeconds, const BlockProfile &lastBlock);
+    // audio thread. Back to full quality at once, like when a bounce starts
+    void reset();
+
+    // any thread
+    int getLevel() const { return level.load(std::memory_order_relaxed); }
+    uint64_t getTransitionCount() const { return written.load(std::memory_order_acquire); }
+
+    // Up to maxTransitions of the most recent level changes, newest first
+    std::vector<Transition> getRecentTransitions(int maxTransitions = historySize) const;
+
+    static std::string levelName(int level);
+    // a few letters for the CPU meter, empty at full quality
+    static std::string levelShortName(int level);
+
+  private:
+    void step(int to, float load, const BlockProfile &lastBlock);
+
+    std::atomic<int> level{gov_full_quality};
+    float overloadedFor{0.f}, comfortableFor{0.f};
+    uint64_t blocks{0};
+
+    Transition history[historySize];
+    std::atomic<uint64_t> written{0};
+};
+} // namespace Profiling
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_CPUGOVERNOR_H
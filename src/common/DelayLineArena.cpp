@@ -0,0 +1,152 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "DelayLineArena.h"
+
+#include <cassert>
+#include <new>
+
+namespace Surge
+{
+namespace Memory
+{
+// Buffers are rounded up to this many floats, so recycled ones fit similar requests
+static constexpr size_t granularity = 1024;
+static constexpr std::align_val_t alignment{64};
+
+// A recycled buffer may be at most this much bigger than the request it serves
+static constexpr size_t maxReuseSlack = 2;
+
+DelayLineArena::DelayLineArena(size_t rf) : reserveFloats(rf)
+{
+    // enough that handing a buffer back never has to grow these
+    freeSpans.reserve(256);
+    heapSpans.reserve(256);
+}
+
+DelayLineArena::~DelayLineArena()
+{
+    assert(inUse == 0);
+
+    for (auto &s : heapSpans)
+        ::operator delete[](s.ptr, alignment);
+}
+
+DelayLineArena::Buffer DelayLineArena::acquire(size_t nFloats)
+{
+    nFloats = (nFloats + granularity - 1) / granularity * granularity;
+
+    Buffer res;
+    res.arena = this;
+    res.length = nFloats;
+
+    std::lock_guard<std::mutex> g(lock);
+    inUse += nFloats;
+
+    // the smallest recycled buffer which is big enough, but not wastefully so
+    int best = -1;
+    for (int i = 0; i < (int)freeSpans.size(); ++i)
+    {
+        auto &s = freeSpans[i];
+        if (s.length >= nFloats && s.length <= nFloats * maxReuseSlack &&
+            (best < 0 || s.length < freeSpans[best].length))
+        {
+            best = i;
+        }
+    }
+
+    if (best >= 0)
+    {
+        res.ptr = freeSpans[best].ptr;
+        res.length = freeSpans[best].length;
+        inUse += res.length - nFloats;
+        freeSpans[best] = freeSpans.back();
+        freeSpans.pop_back();
+        return res;
+    }
+
+    if (!block && reserveFloats > 0)
+    {
+        blockMemory = LargeBlock(reserveFloats * sizeof(float));
+        block = static_cast<float *>(blockMemory.data());
+    }
+
+    if (block && blockUsed + nFloats <= reserveFloats)
+    {
+        res.ptr = block + blockUsed;
+        blockUsed += nFloats;
+        return res;
+    }
+
+    res.ptr = static_cast<float *>(::operator new[](nFloats * sizeof(float), alignment));
+    heapSpans.push_back({res.ptr, nFloats});
+    return res;
+}
+
+void DelayLineArena::release(float *ptr, size_t length)
+{
+    std::lock_guard<std::mutex> g(lock);
+    assert(inUse >= length);
+    inUse -= length;
+    freeSpans.push_back({ptr, length});
+}
+
+size_t DelayLineArena::floatsReserved() const
+{
+    std::lock_guard<std::mutex> g(lock);
+    size_t res = block ? reserveFloats : 0;
+    for (auto &s : heapSpans)
+        res += s.length;
+    return res;
+}
+
+size_t DelayLineArena::floatsInUse() const
+{
+    std::lock_guard<std::mutex> g(lock);
+    return inUse;
+}
+
+DelayLineArena::Buffer &DelayLineArena::Buffer::operator=(Buffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        arena = other.arena;
+        ptr = other.ptr;
+        length = other.length;
+        other.arena = nullptr;
+        other.ptr = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+void DelayLineArena::Buffer::reset()
+{
+    if (arena && ptr)
+        arena->release(ptr, length);
+    arena = nullptr;
+    ptr = nullptr;
+    length = 0;
+}
+} // namespace Memory
+} // namespace Surge
@@ -0,0 +1,110 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DELAYLINEARENA_H
+#define SURGE_SRC_COMMON_DELAYLINEARENA_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "LargePageAllocator.h"
+
+namespace Surge
+{
+namespace Memory
+{
+/*
+ * Delay based effects used to carry their delay memory inline, sized for the worst case
+ * sample rate and time, so every instance of them cost megabytes whether it was used or not.
+ * Instead they take a buffer sized for what they need right now from this per synth arena.
+ *
+ * The arena carves buffers out of one block, reserved the first time anything asks, and
+ * keeps buffers handed back when an effect goes away so the next effect of a similar size
+ * reuses them. Once the block is used up it falls back to the heap, and those buffers are
+ * recycled the same way.
+ *
+ * Effects are built and freed on the UI thread, and sometimes the audio thread, so the
+ * bookkeeping is behind a mutex. Nothing allocates while it is held other than the fallback.
+ * Buffers are 64 byte aligned but not cleared; effects clear them in init as they always have.
+ * The block is a LargeBlock, so it can sit in large pages.
+ */
+struct DelayLineArena
+{
+    static constexpr size_t defaultReserveFloats = 1 << 21; // 8mb
+
+    explicit DelayLineArena(size_t reserveFloats = defaultReserveFloats);
+    ~DelayLineArena();
+
+    DelayLineArena(const DelayLineArena &) = delete;
+    DelayLineArena &operator=(const DelayLineArena &) = delete;
+
+    struct Buffer
+    {
+        Buffer() = default;
+        ~Buffer() { reset(); }
+        Buffer(Buffer &&other) noexcept { *this = std::move(other); }
+        Buffer &operator=(Buffer &&other) noexcept;
+
+        float *data() const { return ptr; }
+        size_t size() const { return length; }
+        explicit operator bool() const { return ptr != nullptr; }
+
+        // hands the buffer back to the arena
+        void reset();
+
+      private:
+        friend struct DelayLineArena;
+        DelayLineArena *arena{nullptr};
+        float *ptr{nullptr};
+        size_t length{0};
+    };
+
+    // a buffer of at least nFloats, which goes back to the arena when it is reset or destroyed
+    Buffer acquire(size_t nFloats);
+
+    size_t floatsReserved() const;
+    size_t floatsInUse() const;
+
+  private:
+    struct Span
+    {
+        float *ptr;
+        size_t length;
+    };
+
+    void release(float *ptr, size_t length);
+
+    mutable std::mutex lock;
+
+    size_t reserveFloats;
+    LargeBlock blockMemory;
+    float *block{nullptr};
+    size_t blockUsed{0};
+
+    std::vector<Span> freeSpans, heapSpans;
+    size_t inUse{0};
+};
+} // namespace Memory
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DELAYLINEARENA_H
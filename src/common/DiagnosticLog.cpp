@@ -0,0 +1,302 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "DiagnosticLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+#include "fmt/core.h"
+
+namespace Surge
+{
+namespace Debug
+{
+namespace
+{
+struct EventInfo
+{
+    const char *name;
+    DiagnosticSeverity severity;
+    const char *format;
+};
+
+const EventInfo eventInfo[n_diagnostic_events] = {
+    {"Diagnostics Dropped", diag_warning,
+     "{0} diagnostic events were dropped because the log was full"},
+    {"Formula Evaluator Error", diag_error, "{4}"},
+    {"Formula Display Error", diag_info, "{4}"},
+    {"Formula Evaluator Error", diag_warning,
+     "The formula's state is not a table, so its envelope and outputs can't be read"},
+    {"Formula Evaluator Error", diag_warning,
+     "The formula's Lua state has no math.randomseed, so it can't be seeded"},
+    {"Voice Still Gated", diag_warning,
+     "A voice on channel {0}, key {1} is still gated after all notes off"},
+};
+
+/*
+ * One thread delivers every log, so a session with many instances doesn't have as many
+ * threads doing next to nothing. Delivery is under the mutex, which is how stopDelivering()
+ * knows nothing is still being handed to a listener it's about to lose.
+ */
+struct Drainer
+{
+    static constexpr auto interval = std::chrono::milliseconds(50);
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<DiagnosticLog *> logs;
+    std::thread thread;
+    bool running{false};
+
+    ~Drainer()
+    {
+        {
+            std::lock_guard<std::mutex> g(m);
+            logs.clear();
+        }
+        cv.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void add(DiagnosticLog *log)
+    {
+        std::unique_lock<std::mutex> g(m);
+        logs.push_back(log);
+
+        if (running)
+            return;
+
+        // the last thread stopped when its logs ran out, but has to be joined by someone
+        running = true;
+        auto old = std::move(thread);
+        thread = std::thread([this]() { run(); });
+        g.unlock();
+
+        if (old.joinable())
+            old.join();
+    }
+
+    void remove(DiagnosticLog *log)
+    {
+        {
+            std::lock_guard<std::mutex> g(m);
+            logs.erase(std::remove(logs.begin(), logs.end(), log), logs.end());
+        }
+        cv.notify_all();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> g(m);
+
+        while (!logs.empty())
+        {
+            for (auto *log : logs)
+                log->deliverPending();
+
+            cv.wait_for(g, interval);
+        }
+
+        running = false;
+    }
+};
+
+Drainer &drainer()
+{
+    static Drainer d;
+    return d;
+}
+} // namespace
+
+const char *diagnosticName(DiagnosticEvent e)
+{
+    return e < n_diagnostic_events ? eventInfo[e].name : "Unknown Diagnostic";
+}
+
+DiagnosticSeverity diagnosticSeverity(DiagnosticEvent e)
+{
+    return e < n_diagnostic_events ? eventInfo[e].severity : diag_warning;
+}
+
+std::string formatDiagnostic(const DiagnosticRecord &r)
+{
+    if (r.event >= n_diagnostic_events)
+        return fmt::format("Unknown diagnostic event {}", (int)r.event);
+
+    const auto &a = r.args;
+    std::string_view text(r.text, strnlen(r.text, DiagnosticRecord::maxText));
+
+    try
+    {
+        return fmt::format(fmt::runtime(eventInfo[r.event].format), a[0], a[1], a[2], a[3], text);
+    }
+    catch (const std::exception &)
+    {
+        return eventInfo[r.event].format;
+    }
+}
+
+DiagnosticLog::DiagnosticLog()
+{
+    for (uint32_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+DiagnosticLog::~DiagnosticLog() { stopDelivering(); }
+
+template <typename Fill> bool DiagnosticLog::pushWith(DiagnosticEvent e, Fill &&fill)
+{
+    // claim a slot the drainer is done with, as a bounded MPMC queue does, or give up
+    auto pos = writePos.load(std::memory_order_relaxed);
+    Slot *s;
+
+    while (true)
+    {
+        s = &slots[pos & mask];
+        auto diff = (int32_t)(s->sequence.load(std::memory_order_acquire) - pos);
+
+        if (diff == 0)
+        {
+            if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = writePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto &r = s->record;
+    r.event = e;
+    r.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
+    fill(r);
+
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool DiagnosticLog::push(DiagnosticEvent e, double a0, double a1, double a2, double a3)
+{
+    return pushWith(e, [&](DiagnosticRecord &r) {
+        r.args[0] = a0;
+        r.args[1] = a1;
+        r.args[2] = a2;
+        r.args[3] = a3;
+        r.text[0] = 0;
+    });
+}
+
+bool DiagnosticLog::pushText(DiagnosticEvent e, const char *text, size_t len, double a0,
+                             double a1)
+{
+    return pushWith(e, [&](DiagnosticRecord &r) {
+        r.args[0] = a0;
+        r.args[1] = a1;
+        r.args[2] = 0;
+        r.args[3] = 0;
+
+        len = std::min(len, (size_t)DiagnosticRecord::maxText - 1);
+        if (len)
+            memcpy(r.text, text, len);
+        r.text[len] = 0;
+    });
+}
+
+bool DiagnosticLog::pop(DiagnosticRecord &r)
+{
+    auto &s = slots[readPos & mask];
+
+    if (s.sequence.load(std::memory_order_acquire) != readPos + 1)
+        return false;
+
+    r = s.record;
+    s.sequence.store(readPos + capacity, std::memory_order_release);
+    readPos++;
+    return true;
+}
+
+void DiagnosticLog::addListener(Listener *l)
+{
+    std::lock_guard<std::mutex> g(listenerMutex);
+    if (std::find(listeners.begin(), listeners.end(), l) == listeners.end())
+        listeners.push_back(l);
+}
+
+void DiagnosticLog::removeListener(Listener *l)
+{
+    std::lock_guard<std::mutex> g(listenerMutex);
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), l), listeners.end());
+}
+
+int DiagnosticLog::deliverPending()
+{
+    std::lock_guard<std::mutex> g(listenerMutex);
+
+    return drain([this](const DiagnosticRecord &r) {
+        auto s = formatDiagnostic(r);
+
+        if (toStdout)
+            std::cout << "Surge [" << diagnosticName(r.event) << "] " << s << std::endl;
+
+        for (auto *l : listeners)
+            l->onDiagnostic(r, s);
+    });
+}
+
+void DiagnosticLog::startDelivering()
+{
+    if (delivering)
+        return;
+
+    delivering = true;
+    drainer().add(this);
+}
+
+void DiagnosticLog::stopDelivering()
+{
+    if (!delivering)
+        return;
+
+    drainer().remove(this);
+    delivering = false;
+
+    // whatever was raised on the way out still gets said
+    deliverPending();
+}
+} // namespace Debug
+} // namespace Surge
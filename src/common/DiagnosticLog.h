@@ -0,0 +1,179 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DIAGNOSTICLOG_H
+#define SURGE_SRC_COMMON_DIAGNOSTICLOG_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Debug
+{
+/*
+ * Diagnostics the audio thread can raise without printing, allocating or locking. Each event
+ * is an id, up to four numbers and an optional short text, which is truncated rather than
+ * allocated. The meaning of an event lives in the table in DiagnosticLog.cpp, which is also
+ * where a new one gets its name, severity and format.
+ */
+enum DiagnosticEvent : uint16_t
+{
+    // raised by the drainer: {0} is how many the ring had no room for
+    diag_events_dropped = 0,
+
+    // the text is the Lua error, from the audio thread's state or a display evaluation
+    diag_formula_error,
+    diag_formula_display_error,
+    diag_formula_state_not_table,
+    diag_formula_missing_math,
+
+    // {0} is the channel, {1} the key
+    diag_voice_gated_after_all_notes_off,
+
+    n_diagnostic_events
+};
+
+enum DiagnosticSeverity
+{
+    diag_info = 0,
+    diag_warning,
+    diag_error,
+};
+
+struct DiagnosticRecord
+{
+    static constexpr int maxArgs = 4;
+    static constexpr int maxText = 240; // enough for most Lua errors
+
+    DiagnosticEvent event{diag_events_dropped};
+    int64_t timeNs{0}; // steady_clock, when it was pushed
+    double args[maxArgs]{};
+    char text[maxText]{};
+};
+
+const char *diagnosticName(DiagnosticEvent e);
+DiagnosticSeverity diagnosticSeverity(DiagnosticEvent e);
+
+// the event's format with the record's arguments as {0} to {3} and its text as {4}
+std::string formatDiagnostic(const DiagnosticRecord &r);
+
+/*
+ * A bounded ring any number of threads can push into and one thread drains. A push which
+ * finds the ring full is dropped and counted, and the drainer reports the count, so a
+ * runaway producer costs us messages rather than time on the audio thread.
+ *
+ * Delivery is the shared drainer thread's, which every log between startDelivering() and
+ * stopDelivering() gets a turn of a few times a second. Delivering formats each record and
+ * hands it to stdout, if toStdout is set, and to each listener, on the drainer thread.
+ */
+struct DiagnosticLog
+{
+    static constexpr uint32_t capacity = 256;
+
+    DiagnosticLog();
+    ~DiagnosticLog();
+
+    DiagnosticLog(const DiagnosticLog &) = delete;
+    DiagnosticLog &operator=(const DiagnosticLog &) = delete;
+
+    // from any thread
+    bool push(DiagnosticEvent e, double a0 = 0, double a1 = 0, double a2 = 0, double a3 = 0);
+    bool pushText(DiagnosticEvent e, const char *text, size_t len, double a0 = 0,
+                  double a1 = 0);
+    bool pushText(DiagnosticEvent e, const std::string &text, double a0 = 0, double a1 = 0)
+    {
+        return pushText(e, text.data(), text.size(), a0, a1);
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    // only ever from one thread at a time; calls f(const DiagnosticRecord &) for each record
+    template <typename F> int drain(F &&f)
+    {
+        int n = 0;
+        DiagnosticRecord r;
+        while (pop(r))
+        {
+            f(r);
+            n++;
+        }
+
+        auto d = dropped.load(std::memory_order_relaxed);
+        if (d != droppedReported)
+        {
+            r = DiagnosticRecord();
+            r.event = diag_events_dropped;
+            r.args[0] = (double)(d - droppedReported);
+            droppedReported = d;
+            f(r);
+            n++;
+        }
+        return n;
+    }
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void onDiagnostic(const DiagnosticRecord &r, const std::string &formatted) = 0;
+    };
+    void addListener(Listener *l);
+    void removeListener(Listener *l);
+    std::atomic<bool> toStdout{true};
+
+    // drains and delivers whatever is queued now, on the calling thread
+    int deliverPending();
+
+    void startDelivering();
+    void stopDelivering();
+
+  private:
+    bool pop(DiagnosticRecord &r);
+    template <typename Fill> bool pushWith(DiagnosticEvent e, Fill &&fill);
+
+    static constexpr uint32_t mask = capacity - 1;
+    static_assert(!(capacity & mask));
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence{0};
+        DiagnosticRecord record;
+    };
+    std::array<Slot, capacity> slots;
+    std::atomic<uint32_t> writePos{0};
+    uint32_t readPos{0};
+    std::atomic<uint64_t> dropped{0};
+    uint64_t droppedReported{0};
+
+    std::mutex listenerMutex;
+    std::vector<Listener *> listeners;
+    bool delivering{false};
+};
+} // namespace Debug
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DIAGNOSTICLOG_H
@@ -0,0 +1,146 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "FPUState.h"
+
+#include <sstream>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define SURGE_FPUSTATE_X86 1
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define SURGE_FPUSTATE_ARM64 1
+#endif
+
+#if SURGE_DENORMAL_AUDIT
+#include <atomic>
+#endif
+
+namespace Surge
+{
+namespace FPUState
+{
+bool flushesDenormals()
+{
+#if SURGE_FPUSTATE_X86
+    return (_mm_getcsr() & 0x8040) == 0x8040; // FTZ | DAZ
+#elif SURGE_FPUSTATE_ARM64
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr & (1ULL << 24); // FZ
+#else
+    return false;
+#endif
+}
+
+#if SURGE_DENORMAL_AUDIT
+namespace
+{
+std::atomic<uint64_t> blocks{0}, blocksWithoutFlushToZero{0};
+std::atomic<uint64_t> stages[Surge::Profiling::n_process_stages];
+
+#if SURGE_FPUSTATE_X86
+static constexpr uint32_t auditedFlags = 0x12; // UE | DE
+#elif SURGE_FPUSTATE_ARM64
+static constexpr uint32_t auditedFlags = 0x88; // IDC | UFC
+#else
+static constexpr uint32_t auditedFlags = 0;
+#endif
+} // namespace
+
+uint32_t takeFlags()
+{
+#if SURGE_FPUSTATE_X86
+    auto csr = _mm_getcsr();
+    _mm_setcsr(csr & ~auditedFlags);
+    return csr & auditedFlags;
+#elif SURGE_FPUSTATE_ARM64
+    uint64_t fpsr;
+    __asm__ __volatile__("mrs %0, fpsr" : "=r"(fpsr));
+    __asm__ __volatile__("msr fpsr, %0" : : "r"(fpsr & ~(uint64_t)auditedFlags));
+    return (uint32_t)(fpsr & auditedFlags);
+#else
+    return 0;
+#endif
+}
+
+void raiseFlags(uint32_t flags)
+{
+    if (!flags)
+        return;
+#if SURGE_FPUSTATE_X86
+    _mm_setcsr(_mm_getcsr() | flags);
+#elif SURGE_FPUSTATE_ARM64
+    uint64_t fpsr;
+    __asm__ __volatile__("mrs %0, fpsr" : "=r"(fpsr));
+    __asm__ __volatile__("msr fpsr, %0" : : "r"(fpsr | flags));
+#endif
+}
+
+void noteStage(int stage, uint32_t flags)
+{
+    if (flags)
+        stages[stage].fetch_add(1, std::memory_order_relaxed);
+}
+
+void noteBlock()
+{
+    blocks.fetch_add(1, std::memory_order_relaxed);
+    if (!flushesDenormals())
+        blocksWithoutFlushToZero.fetch_add(1, std::memory_order_relaxed);
+}
+
+void resetAudit()
+{
+    blocks = 0;
+    blocksWithoutFlushToZero = 0;
+    for (auto &s : stages)
+        s = 0;
+}
+
+AuditReport auditReport()
+{
+    AuditReport r;
+    r.blocks = blocks;
+    r.blocksWithoutFlushToZero = blocksWithoutFlushToZero;
+    for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+        r.stages[i] = stages[i];
+    return r;
+}
+#endif // SURGE_DENORMAL_AUDIT
+
+std::string AuditReport::toString() const
+{
+    std::ostringstream oss;
+    oss << blocks << " blocks, " << blocksWithoutFlushToZero << " without flush-to-zero\n";
+
+    for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+    {
+        if (stages[i])
+            oss << "  " << Surge::Profiling::ProcessProfiler::stageName(i) << ": " << stages[i]
+                << " with denormals\n";
+    }
+    return oss.str();
+}
+} // namespace FPUState
+} // namespace Surge
@@ -0,0 +1,110 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_FPUSTATE_H
+#define SURGE_SRC_COMMON_FPUSTATE_H
+
+#include <cstdint>
+#include <string>
+
+#include "sst/plugininfra/cpufeatures.h"
+#include "ProcessProfiler.h"
+
+/*
+ * How every thread which runs DSP sets up the FPU. That's the audio thread, our worker pools,
+ * a host's thread pool, the patch and wavetable loaders, the GUI preview renderers and anything
+ * offline like surgepy and the CLI. Each holds a DSPThreadGuard while it works, which turns on
+ * flush-to-zero and denormals-are-zero (FZ on ARM) and puts back what was there before when
+ * it goes. SurgeSynthesizer::process() holds one itself, so whoever calls it gets the same
+ * state as a plugin host's audio thread does, and a decaying tail costs what silence does.
+ */
+namespace Surge
+{
+namespace FPUState
+{
+typedef sst::plugininfra::cpufeatures::FPUStateGuard DSPThreadGuard;
+
+// Whether the calling thread flushes denormal results and operands to zero
+bool flushesDenormals();
+
+/*
+ * Opt-in counts of which stages of process() produce or read denormals. Build with
+ * SURGE_DENORMAL_AUDIT=1 (the CMake option of the same name) to turn it on; otherwise every
+ * call here is an empty inline. A StageAudit watches the FPU's sticky underflow and denormal
+ * operand flags while it exists, so it sees results which would have been denormal even with
+ * flush-to-zero on. The stages are the ones ProcessProfiler times; they nest, and may run on
+ * any thread.
+ */
+struct AuditReport
+{
+    uint64_t blocks{0};
+    uint64_t blocksWithoutFlushToZero{0};
+    uint64_t stages[Surge::Profiling::n_process_stages]{}; // how many runs of each underflowed
+
+    std::string toString() const;
+};
+
+#if SURGE_DENORMAL_AUDIT
+static constexpr bool auditEnabled = true;
+
+// the sticky flags raised so far on this thread, which are then cleared
+uint32_t takeFlags();
+void raiseFlags(uint32_t flags);
+
+void noteStage(int stage, uint32_t flags);
+// once per call to process(), from the thread calling it
+void noteBlock();
+
+struct StageAudit
+{
+    explicit StageAudit(int s) : stage(s), outer(takeFlags()) {}
+    ~StageAudit()
+    {
+        auto f = takeFlags();
+        noteStage(stage, f);
+        raiseFlags(outer | f);
+    }
+
+    int stage;
+    uint32_t outer;
+};
+
+void resetAudit();
+AuditReport auditReport();
+#else
+static constexpr bool auditEnabled = false;
+
+struct StageAudit
+{
+    explicit StageAudit(int) {}
+};
+
+inline void noteBlock() {}
+inline void resetAudit() {}
+inline AuditReport auditReport() { return {}; }
+#endif
+
+} // namespace FPUState
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_FPUSTATE_H
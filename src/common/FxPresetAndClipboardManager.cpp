@@ -24,6 +24,7 @@
 #include "StringOps.h"
 #include "Effect.h"
 #include "DebugHelpers.h"
+#include "SharedPresetLibrary.h"
 
 namespace Surge
 {
@@ -35,146 +36,173 @@ std::unordered_map<int, std::vector<FxUserPreset::Preset>> FxUserPreset::getPres
     return scannedPresets;
 }
 
-void FxUserPreset::doPresetRescan(SurgeStorage *storage, bool forceRescan)
+namespace
 {
-    if (haveScannedPresets && !forceRescan)
-        return;
+typedef SharedPresetLibrary<std::unordered_map<int, std::vector<FxUserPreset::Preset>>>
+    FxPresetLibrary;
+typedef FxUserPreset::Preset Preset;
 
-    // auto tb = Surge::Debug::TimeBlock(__func__);
-    scannedPresets.clear();
-    haveScannedPresets = true;
+std::string libraryKey(SurgeStorage *storage)
+{
+    return path_to_string(storage->userFXPath) + "\n" + path_to_string(storage->datapath);
+}
 
+FxPresetLibrary::scanner_t scannerFor(SurgeStorage *storage)
+{
     auto ud = storage->userFXPath;
     auto fd = storage->datapath / "fx_presets";
 
-    std::vector<std::pair<fs::path, bool>> sfxfiles;
+    return [ud, fd]() {
+        auto scan = std::make_shared<FxPresetLibrary::Scan>();
 
-    std::deque<std::pair<fs::path, bool>> workStack;
-    workStack.emplace_back(fs::path(ud), false);
-    workStack.emplace_back(fd, true);
+        std::vector<std::pair<fs::path, bool>> sfxfiles;
 
-    try
-    {
-        while (!workStack.empty())
+        std::deque<std::pair<fs::path, bool>> workStack;
+        workStack.emplace_back(fs::path(ud), false);
+        workStack.emplace_back(fd, true);
+
+        try
         {
-            auto top = workStack.front();
-            workStack.pop_front();
-            if (fs::is_directory(top.first))
+            while (!workStack.empty())
             {
-                for (auto &d : fs::directory_iterator(top.first))
+                auto top = workStack.front();
+                workStack.pop_front();
+                scan->noteDirectory(top.first);
+                if (fs::is_directory(top.first))
                 {
-                    if (fs::is_directory(d))
-                    {
-                        workStack.emplace_back(d, top.second);
-                    }
-                    else if (path_to_string(d.path().extension()) == ".srgfx")
+                    for (auto &d : fs::directory_iterator(top.first))
                     {
-                        sfxfiles.emplace_back(d.path(), top.second);
+                        if (fs::is_directory(d))
+                        {
+                            workStack.emplace_back(d, top.second);
+                        }
+                        else if (path_to_string(d.path().extension()) == ".srgfx")
+                        {
+                            sfxfiles.emplace_back(d.path(), top.second);
+                        }
                     }
                 }
             }
-        }
 
-        for (const auto &f : sfxfiles)
-        {
+            for (const auto &f : sfxfiles)
             {
-                Preset preset;
-                preset.file = path_to_string(f.first);
+                {
+                    Preset preset;
+                    preset.file = path_to_string(f.first);
 
-                TiXmlDocument d;
-                int t;
+                    TiXmlDocument d;
+                    int t;
 
-                if (!d.LoadFile(f.first))
-                    goto badPreset;
+                    if (!d.LoadFile(f.first))
+                        goto badPreset;
 
-                auto r = TINYXML_SAFE_TO_ELEMENT(d.FirstChild("single-fx"));
+                    auto r = TINYXML_SAFE_TO_ELEMENT(d.FirstChild("single-fx"));
 
-                if (!r)
-                    goto badPreset;
+                    if (!r)
+                        goto badPreset;
 
-                preset.streamingVersion = ff_revision;
-                int sv;
-                if (r->QueryIntAttribute("streaming_version", &sv) == TIXML_SUCCESS)
-                {
-                    preset.streamingVersion = sv;
-                }
+                    preset.streamingVersion = ff_revision;
+                    int sv;
+                    if (r->QueryIntAttribute("streaming_version", &sv) == TIXML_SUCCESS)
+                    {
+                        preset.streamingVersion = sv;
+                    }
 
-                auto s = TINYXML_SAFE_TO_ELEMENT(r->FirstChild("snapshot"));
+                    auto s = TINYXML_SAFE_TO_ELEMENT(r->FirstChild("snapshot"));
 
-                if (!s)
-                    goto badPreset;
+                    if (!s)
+                        goto badPreset;
 
-                if (s->QueryIntAttribute("type", &t) != TIXML_SUCCESS)
-                    goto badPreset;
+                    if (s->QueryIntAttribute("type", &t) != TIXML_SUCCESS)
+                        goto badPreset;
 
-                preset.type = t;
-                preset.isFactory = f.second;
+                    preset.type = t;
+                    preset.isFactory = f.second;
 
-                fs::path rpath;
+                    fs::path rpath;
 
-                if (f.second)
-                    rpath = f.first.lexically_relative(fd).parent_path();
-                else
-                    rpath = f.first.lexically_relative(storage->userFXPath).parent_path();
+                    if (f.second)
+                        rpath = f.first.lexically_relative(fd).parent_path();
+                    else
+                        rpath = f.first.lexically_relative(ud).parent_path();
 
-                auto startCatPath = rpath.begin();
-                if (*(startCatPath) == fx_type_shortnames[t])
-                {
-                    startCatPath++;
-                }
+                    auto startCatPath = rpath.begin();
+                    if (*(startCatPath) == fx_type_shortnames[t])
+                    {
+                        startCatPath++;
+                    }
 
-                while (startCatPath != rpath.end())
-                {
-                    preset.subPath /= *startCatPath;
-                    startCatPath++;
-                }
+                    while (startCatPath != rpath.end())
+                    {
+                        preset.subPath /= *startCatPath;
+                        startCatPath++;
+                    }
 
-                if (!readFromXMLSnapshot(preset, s))
-                    goto badPreset;
+                    if (!FxUserPreset::readFromXMLSnapshot(preset, s))
+                        goto badPreset;
 
-                if (scannedPresets.find(preset.type) == scannedPresets.end())
-                {
-                    scannedPresets[preset.type] = std::vector<Preset>();
+                    scan->presets[preset.type].push_back(preset);
                 }
 
-                scannedPresets[preset.type].push_back(preset);
+            badPreset:;
             }
 
-        badPreset:;
-        }
-
-        for (auto &a : scannedPresets)
-        {
-            std::sort(a.second.begin(), a.second.end(), [](const Preset &a, const Preset &b) {
-                if (a.type == b.type)
-                {
-                    if (a.isFactory != b.isFactory)
+            for (auto &a : scan->presets)
+            {
+                std::sort(a.second.begin(), a.second.end(), [](const Preset &a, const Preset &b) {
+                    if (a.type == b.type)
                     {
-                        return a.isFactory;
-                    }
+                        if (a.isFactory != b.isFactory)
+                        {
+                            return a.isFactory;
+                        }
+
+                        if (a.subPath != b.subPath)
+                        {
+                            return a.subPath < b.subPath;
+                        }
 
-                    if (a.subPath != b.subPath)
+                        return _stricmp(a.name.c_str(), b.name.c_str()) < 0;
+                    }
+                    else
                     {
-                        return a.subPath < b.subPath;
+                        return a.type < b.type;
                     }
+                });
+            }
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::ostringstream oss;
+            oss << "Experienced file system error when scanning user FX. " << e.what();
 
-                    return _stricmp(a.name.c_str(), b.name.c_str()) < 0;
-                }
-                else
-                {
-                    return a.type < b.type;
-                }
-            });
+            scan->error = oss.str();
         }
-    }
-    catch (const fs::filesystem_error &e)
+
+        return std::shared_ptr<const FxPresetLibrary::Scan>(scan);
+    };
+}
+} // namespace
+
+void FxUserPreset::doPresetRescan(SurgeStorage *storage, bool forceRescan)
+{
+    auto scan = FxPresetLibrary::get(libraryKey(storage), scannerFor(storage), forceRescan);
+
+    if (scan != heldScan)
     {
-        std::ostringstream oss;
-        oss << "Experienced file system error when scanning user FX. " << e.what();
+        heldScan = scan;
+        scannedPresets = scan->presets;
 
-        if (storage)
-            storage->reportError(oss.str(), "FileSystem Error");
+        if (!scan->error.empty())
+            storage->reportError(scan->error, "FileSystem Error");
     }
+
+    haveScannedPresets = true;
+}
+
+void FxUserPreset::startPresetScan(SurgeStorage *storage)
+{
+    FxPresetLibrary::prefetch(libraryKey(storage), scannerFor(storage));
 }
 
 bool FxUserPreset::readFromXMLSnapshot(Preset &preset, TiXmlElement *s)
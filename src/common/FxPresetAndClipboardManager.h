@@ -25,6 +25,7 @@
 
 #include "SurgeStorage.h"
 
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -65,12 +66,17 @@ struct FxUserPreset
 
     std::unordered_map<int, std::vector<Preset>> scannedPresets;
     bool haveScannedPresets{false};
+    // the shared scan scannedPresets was copied from, see SharedPresetLibrary
+    std::shared_ptr<const void> heldScan;
 
+    // picks up the shared scan, walking the folders again if they moved or forceRescan is set
     void doPresetRescan(SurgeStorage *storage, bool forceRescan = false);
+    // start the walk in the background, so the first doPresetRescan doesn't have to
+    void startPresetScan(SurgeStorage *storage);
     std::unordered_map<int, std::vector<Preset>> getPresetsByType();
     std::vector<Preset> getPresetsForSingleType(int type_id);
     bool hasPresetsForSingleType(int type_id);
-    bool readFromXMLSnapshot(Preset &p, TiXmlElement *);
+    static bool readFromXMLSnapshot(Preset &p, TiXmlElement *);
 
     void saveFxIn(SurgeStorage *s, FxStorage *fxdata, const std::string &fn);
 
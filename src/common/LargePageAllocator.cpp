@@ -0,0 +1,180 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "LargePageAllocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if WINDOWS
+#include <windows.h>
+#elif LINUX
+#include <sys/mman.h>
+#endif
+
+namespace Surge
+{
+namespace Memory
+{
+namespace
+{
+std::atomic<LargePageMode> currentMode{LargePageMode::Off};
+std::atomic<size_t> largePageBytes{0};
+
+constexpr std::align_val_t heapAlignment{64};
+
+size_t roundUp(size_t n, size_t to) { return (n + to - 1) / to * to; }
+} // namespace
+
+void setLargePageMode(LargePageMode m) { currentMode.store(m, std::memory_order_relaxed); }
+LargePageMode getLargePageMode() { return currentMode.load(std::memory_order_relaxed); }
+
+size_t bytesInLargePages() { return largePageBytes.load(std::memory_order_relaxed); }
+
+LargeBlock::LargeBlock(size_t n) : bytes(n)
+{
+    if (n == 0)
+        return;
+
+    auto mode = getLargePageMode();
+
+    if (mode != LargePageMode::Off && n >= largePageThreshold)
+    {
+#if LINUX
+        auto len = roundUp(n, largePageSize);
+
+        if (mode == LargePageMode::Explicit)
+        {
+            auto p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                ptr = p;
+                mappedBytes = len;
+                source = mapped;
+                largePages = true;
+            }
+        }
+
+        if (!ptr)
+        {
+            // map a page extra and trim, so the block starts on a boundary the kernel can back
+            auto span = len + largePageSize;
+            auto p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                auto base = (uintptr_t)p;
+                auto start = roundUp(base, largePageSize);
+                if (start > base)
+                    munmap(p, start - base);
+                if (base + span > start + len)
+                    munmap((void *)(start + len), base + span - (start + len));
+
+                ptr = (void *)start;
+                mappedBytes = len;
+                source = mapped;
+#ifdef MADV_HUGEPAGE
+                largePages = madvise(ptr, len, MADV_HUGEPAGE) == 0;
+#endif
+            }
+        }
+#elif WINDOWS
+        auto minimum = GetLargePageMinimum();
+
+        if (mode == LargePageMode::Explicit && minimum > 0)
+        {
+            auto len = roundUp(n, minimum);
+            auto p = VirtualAlloc(nullptr, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                  PAGE_READWRITE);
+            if (p)
+            {
+                ptr = p;
+                mappedBytes = len;
+                source = mapped;
+                largePages = true;
+            }
+        }
+#endif
+    }
+
+    if (ptr)
+    {
+        // fresh mappings are already zeroed
+        if (largePages)
+            largePageBytes += mappedBytes;
+        return;
+    }
+
+    ptr = ::operator new(n, heapAlignment);
+    memset(ptr, 0, n);
+    source = heap;
+}
+
+LargeBlock &LargeBlock::operator=(LargeBlock &&other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        ptr = other.ptr;
+        bytes = other.bytes;
+        mappedBytes = other.mappedBytes;
+        source = other.source;
+        largePages = other.largePages;
+
+        other.ptr = nullptr;
+        other.bytes = 0;
+        other.mappedBytes = 0;
+        other.source = none;
+        other.largePages = false;
+    }
+    return *this;
+}
+
+void LargeBlock::reset()
+{
+    switch (source)
+    {
+    case heap:
+        ::operator delete(ptr, heapAlignment);
+        break;
+    case mapped:
+        if (largePages)
+            largePageBytes -= mappedBytes;
+#if LINUX
+        munmap(ptr, mappedBytes);
+#elif WINDOWS
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#endif
+        break;
+    case none:
+        break;
+    }
+
+    ptr = nullptr;
+    bytes = 0;
+    mappedBytes = 0;
+    source = none;
+    largePages = false;
+}
+} // namespace Memory
+} // namespace Surge
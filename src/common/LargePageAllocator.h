@@ -0,0 +1,151 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_LARGEPAGEALLOCATOR_H
+#define SURGE_SRC_COMMON_LARGEPAGEALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace Surge
+{
+namespace Memory
+{
+/*
+ * The engine's long lived hot buffers (the voices, the filter chain states, wavetable data and
+ * the effect delay arena) are walked every block and spread over thousands of 4kb pages, so
+ * with dozens of instances in a process the TLB misses show. When enabled, blocks of at least
+ * largePageThreshold bytes are placed in 2mb pages instead:
+ *
+ * - Transparent maps the block on a 2mb boundary and asks Linux to back it with transparent
+ *   huge pages
+ * - Explicit takes pages from the reserved hugetlbfs pool on Linux, or large pages on Windows
+ *   (which only works if the process already holds the lock pages in memory privilege)
+ *
+ * Anything which can't be satisfied falls back, explicit to transparent to the heap, so this
+ * never fails an allocation the heap would have made. Elsewhere it is always the heap. The mode
+ * is process wide and applies to blocks allocated after it is set; it is read from the user
+ * defaults when a SurgeStorage is made.
+ */
+enum class LargePageMode
+{
+    Off = 0,
+    Transparent = 1,
+    Explicit = 2,
+};
+
+void setLargePageMode(LargePageMode m);
+LargePageMode getLargePageMode();
+
+static constexpr size_t largePageSize = 2 * 1024 * 1024;
+// below this a partly used large page wastes more than the TLB saves
+static constexpr size_t largePageThreshold = largePageSize / 2;
+
+// The bytes currently held in blocks which got large pages, across the process
+size_t bytesInLargePages();
+
+/*
+ * A zeroed, 64 byte aligned block of memory, freed when it goes away, which may live in large
+ * pages depending on the mode when it was made
+ */
+struct LargeBlock
+{
+    LargeBlock() = default;
+    explicit LargeBlock(size_t bytes);
+    ~LargeBlock() { reset(); }
+
+    LargeBlock(const LargeBlock &) = delete;
+    LargeBlock &operator=(const LargeBlock &) = delete;
+    LargeBlock(LargeBlock &&other) noexcept { *this = std::move(other); }
+    LargeBlock &operator=(LargeBlock &&other) noexcept;
+
+    void *data() const { return ptr; }
+    size_t size() const { return bytes; }
+    bool inLargePages() const { return largePages; }
+
+    void reset();
+
+  private:
+    enum Source
+    {
+        none,
+        heap,
+        mapped
+    };
+
+    void *ptr{nullptr};
+    size_t bytes{0}, mappedBytes{0};
+    Source source{none};
+    bool largePages{false};
+};
+
+// count value initialised Ts in a LargeBlock, destroyed along with it
+template <typename T> struct LargeArray
+{
+    static_assert(alignof(T) <= 64, "LargeBlocks are 64 byte aligned");
+
+    LargeArray() = default;
+    explicit LargeArray(size_t n) : block(n * sizeof(T)), count(n)
+    {
+        for (size_t i = 0; i < count; ++i)
+            new (data() + i) T();
+    }
+    ~LargeArray() { reset(); }
+
+    LargeArray(const LargeArray &) = delete;
+    LargeArray &operator=(const LargeArray &) = delete;
+    LargeArray(LargeArray &&other) noexcept { *this = std::move(other); }
+    LargeArray &operator=(LargeArray &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            block = std::move(other.block);
+            count = other.count;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    T *data() const { return static_cast<T *>(block.data()); }
+    size_t size() const { return count; }
+    T &operator[](size_t i) const { return data()[i]; }
+    bool inLargePages() const { return block.inLargePages(); }
+
+    void reset()
+    {
+        for (size_t i = 0; i < count; ++i)
+            data()[i].~T();
+        count = 0;
+        block.reset();
+    }
+
+  private:
+    LargeBlock block;
+    size_t count{0};
+};
+} // namespace Memory
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_LARGEPAGEALLOCATOR_H
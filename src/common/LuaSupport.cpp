@@ -26,6 +26,7 @@
 #include <vector>
 #include <sstream>
 #include <cstring>
+#include <cstdlib>
 #include "basic_dsp.h"
 #if HAS_JUCE
 #include "SurgeSharedBinary.h"
@@ -42,32 +43,40 @@ bool Surge::LuaSupport::parseStringDefiningFunction(lua_State *L, const std::str
     return true;
 }
 
+#if HAS_LUA
+static std::string loadErrorMessage(lua_State *L, int lerr)
+{
+    std::ostringstream oss;
+    switch (lerr)
+    {
+    case LUA_ERRSYNTAX:
+        oss << "Lua Syntax Error: ";
+        break;
+    case LUA_ERRMEM:
+        oss << "Lua Memory Allocation Error: ";
+        break;
+    default:
+        // The default case should never get called unless the underlying Lua library source
+        // gets modified, but we can handle it anyway
+        oss << "Lua Unknown Error: ";
+        break;
+    }
+    oss << lua_tostring(L, -1);
+    return oss.str();
+}
+#endif
+
 int Surge::LuaSupport::parseStringDefiningMultipleFunctions(
     lua_State *L, const std::string &definition, const std::vector<std::string> functions,
     std::string &errorMessage)
 {
 #if HAS_LUA
+    // use the string's size, since this may be bytecode which has embedded zeros
     const char *lua_script = definition.c_str();
-    auto lerr = luaL_loadbuffer(L, lua_script, strlen(lua_script), "lua-script");
+    auto lerr = luaL_loadbuffer(L, lua_script, definition.size(), "lua-script");
     if (lerr != LUA_OK)
     {
-        std::ostringstream oss;
-        switch (lerr)
-        {
-        case LUA_ERRSYNTAX:
-            oss << "Lua Syntax Error: ";
-            break;
-        case LUA_ERRMEM:
-            oss << "Lua Memory Allocation Error: ";
-            break;
-        default:
-            // The default case should never get called unless the underlying Lua library source
-            // gets modified, but we can handle it anyway
-            oss << "Lua Unknown Error: ";
-            break;
-        }
-        oss << lua_tostring(L, -1);
-        errorMessage = oss.str();
+        errorMessage = loadErrorMessage(L, lerr);
         lua_pop(L, 1);
         for (const auto &f : functions)
             lua_pushnil(L);
@@ -124,6 +133,35 @@ int Surge::LuaSupport::parseStringDefiningMultipleFunctions(
 #endif
 }
 
+bool Surge::LuaSupport::checkSyntax(lua_State *L, const std::string &definition,
+                                    std::string &errorMessage, int &errorLine)
+{
+    errorLine = -1;
+#if HAS_LUA
+    auto lerr = luaL_loadbuffer(L, definition.c_str(), definition.size(), "lua-script");
+    if (lerr == LUA_OK)
+    {
+        lua_pop(L, 1);
+        return true;
+    }
+
+    errorMessage = loadErrorMessage(L, lerr);
+    lua_pop(L, 1);
+
+    // messages read [string "lua-script"]:12: unexpected symbol near 'x'
+    auto lpos = errorMessage.find("]:");
+    if (lpos != std::string::npos)
+    {
+        auto line = std::atoi(errorMessage.c_str() + lpos + 2);
+        if (line > 0)
+            errorLine = line;
+    }
+    return false;
+#else
+    return true;
+#endif
+}
+
 int lua_limitRange(lua_State *L)
 {
 #if HAS_LUA
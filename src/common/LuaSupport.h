@@ -76,6 +76,14 @@ int parseStringDefiningMultipleFunctions(lua_State *s, const std::string &defini
                                          const std::vector<std::string> functions,
                                          std::string &errorMessage);
 
+/*
+ * Compile the code without running it, so as to report syntax errors while someone is
+ * still typing. Leaves the stack as it found it. On failure errorMessage is populated and
+ * errorLine is the 1-based line Lua complained about, or -1 if there isn't one.
+ */
+bool checkSyntax(lua_State *s, const std::string &definition, std::string &errorMessage,
+                 int &errorLine);
+
 /*
  * Call this function with the top of your stack being a
  * lua_function and the function will get wrapped in the standard
@@ -0,0 +1,169 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_MIDIEVENTCOALESCER_H
+#define SURGE_SRC_COMMON_MIDIEVENTCOALESCER_H
+
+#include <cstdint>
+
+namespace Surge
+{
+namespace MIDI
+{
+/*
+ * Holds the MIDI messages which get applied together before a block renders, and when they
+ * are handed back drops controller updates which a later message in the same batch would
+ * overwrite anyway. A 14 bit controller or a pitch bend sweep can send dozens of those per
+ * block, and each one goes on to retarget smoothers and walk the parameter list.
+ *
+ * Only pitch bend, channel and poly pressure and the plain value CCs are coalesced. Notes and
+ * every other message are barriers: an update is only dropped in favour of one for the same
+ * channel and controller (or key) with no barrier in between, so where a note lands relative
+ * to the controllers around it never changes. Bank select, data entry, the (N)RPN selectors,
+ * sustain and the channel mode messages are all barriers, since what they do depends on each
+ * message arriving.
+ *
+ * Messages are held by pointer, so their storage must outlive the flush. If the batch fills
+ * up, add() returns false and the caller should flush and add again.
+ */
+struct MIDIEventCoalescer
+{
+    static constexpr int maxBatch = 512;
+
+    struct Event
+    {
+        const uint8_t *data;
+        int size;
+        int samplePosition;
+    };
+
+    bool add(const uint8_t *data, int size, int samplePosition)
+    {
+        if (count == maxBatch)
+            return false;
+
+        events[count++] = {data, size, samplePosition};
+        return true;
+    }
+
+    bool empty() const { return count == 0; }
+
+    // Calls apply(const Event &) for each message we keep, in the order they were added
+    template <typename F> void flush(F &&apply)
+    {
+        generation++;
+
+        for (int i = count - 1; i >= 0; --i)
+        {
+            auto k = keyFor(events[i]);
+
+            if (k < 0)
+            {
+                generation++;
+                redundant[i] = false;
+            }
+            else
+            {
+                redundant[i] = lastSeen[k] == generation;
+                lastSeen[k] = generation;
+            }
+        }
+
+        // reset first, so apply is free to add more for the next flush
+        auto n = count;
+        count = 0;
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (!redundant[i])
+                apply(events[i]);
+        }
+    }
+
+    static bool coalescableCC(int cc)
+    {
+        switch (cc)
+        {
+        case 0:  // bank select
+        case 6:  // data entry
+        case 32: // bank select LSB
+        case 38: // data entry LSB
+        case 64: // sustain, which releases held notes
+        case 96:
+        case 97:
+        case 98:
+        case 99:
+        case 100:
+        case 101: // (N)RPN increment, decrement and selectors
+            return false;
+        default:
+            return cc < 120;
+        }
+    }
+
+  private:
+    enum KeyBase
+    {
+        kb_pitchbend = 0,
+        kb_channel_pressure = kb_pitchbend + 16,
+        kb_poly_pressure = kb_channel_pressure + 16,
+        kb_cc = kb_poly_pressure + 16 * 128,
+        n_keys = kb_cc + 16 * 128
+    };
+
+    static int keyFor(const Event &e)
+    {
+        if (e.size < 2)
+            return -1;
+
+        auto ch = e.data[0] & 0x0F;
+
+        switch (e.data[0] & 0xF0)
+        {
+        case 0xE0:
+            return kb_pitchbend + ch;
+        case 0xD0:
+            return kb_channel_pressure + ch;
+        case 0xA0:
+            return e.size < 3 ? -1 : kb_poly_pressure + ch * 128 + (e.data[1] & 0x7F);
+        case 0xB0:
+            if (e.size < 3 || !coalescableCC(e.data[1] & 0x7F))
+                return -1;
+            return kb_cc + ch * 128 + (e.data[1] & 0x7F);
+        default:
+            return -1;
+        }
+    }
+
+    Event events[maxBatch];
+    bool redundant[maxBatch];
+    int count{0};
+
+    // a key was seen later in the batch, with no barrier since, if it holds the generation
+    uint32_t lastSeen[n_keys]{};
+    uint32_t generation{0};
+};
+} // namespace MIDI
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_MIDIEVENTCOALESCER_H
@@ -0,0 +1,119 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#if WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Surge
+{
+namespace Storage
+{
+MappedFile::MappedFile(const fs::path &path)
+{
+#if WINDOWS
+    auto file = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER sz;
+        if (GetFileSizeEx(file, &sz) && sz.QuadPart > 0)
+        {
+            mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappingHandle)
+            {
+                mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+                if (mapping)
+                {
+                    length = (size_t)sz.QuadPart;
+                }
+                else
+                {
+                    CloseHandle(mappingHandle);
+                    mappingHandle = nullptr;
+                }
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    auto fd = open(path.native().c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            auto m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED)
+            {
+                mapping = m;
+                length = (size_t)st.st_size;
+            }
+        }
+        // the mapping holds its own reference to the file
+        close(fd);
+    }
+#endif
+
+    if (mapping)
+    {
+        bytes = static_cast<const char *>(mapping);
+        opened = true;
+        return;
+    }
+
+    // empty files, and ones which live somewhere which can't be mapped
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return;
+
+    fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes = fallback.data();
+    length = fallback.size();
+    opened = true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (!mapping)
+        return;
+
+#if WINDOWS
+    UnmapViewOfFile(mapping);
+    CloseHandle(mappingHandle);
+#else
+    munmap(mapping, length);
+#endif
+}
+} // namespace Storage
+} // namespace Surge
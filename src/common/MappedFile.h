@@ -0,0 +1,70 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+
+#ifndef SURGE_SRC_COMMON_MAPPEDFILE_H
+#define SURGE_SRC_COMMON_MAPPEDFILE_H
+
+#include "filesystem/import.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A whole file as one read only span of bytes. Where the OS lets us it is memory mapped, so
+ * only the pages actually read come off the disk; otherwise it is read into memory. Either way
+ * the bytes stay put until this goes away.
+ */
+class MappedFile
+{
+  public:
+    explicit MappedFile(const fs::path &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return opened; }
+    bool isMapped() const { return mapping != nullptr; }
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+  private:
+    bool opened{false};
+    const char *bytes{nullptr};
+    size_t length{0};
+
+    void *mapping{nullptr};
+#if WINDOWS
+    void *mappingHandle{nullptr};
+#endif
+    std::vector<char> fallback;
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_MAPPEDFILE_H
@@ -19,74 +19,171 @@
  * All source for Surge XT is available at
  * https://github.com/surge-synthesizer/surge
  */
-
 #ifndef SURGE_SRC_COMMON_MEMORYPOOL_H
 #define SURGE_SRC_COMMON_MEMORYPOOL_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#include "RealtimeSafety.h"
+#include "ThreadPolicy.h"
+
 namespace Surge
 {
 namespace Memory
 {
+/*
+ * A pool of preallocated items for the audio thread. getItem and returnItem are called from
+ * one thread (the audio thread) and never allocate or free unless the pool has run completely
+ * dry before the refill thread could catch up.
+ *
+ * Each pool has a refill thread which keeps at least preAlloc free items ready, or more if
+ * requestPoolSize has asked for it, and frees any the audio thread no longer wants. Items
+ * travel between the two threads through a pair of single producer, single consumer queues,
+ * so neither side ever waits on the other.
+ */
 // pre-alloc must be at least one
 template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> struct MemoryPool
 {
     template <typename... Args> MemoryPool(Args &&...args)
     {
+        // the refill thread builds items with the same constructor arguments as the pool
+        makeItem = [this, argTuple = std::make_tuple(args...)]() {
+            alive++;
+            return std::apply([](const auto &...a) { return new T(a...); }, argTuple);
+        };
+
         while (position < preAlloc)
             refreshPool(std::forward<Args>(args)...);
+        published = position;
+
+        refillThread = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Helper,
+                                                    [this]() { refillLoop(); });
     }
     ~MemoryPool()
     {
+        {
+            std::lock_guard<std::mutex> g(refillMutex);
+            keepRunning = false;
+        }
+        refillCV.notify_one();
+        refillThread.join();
+
         for (size_t i = 0; i < position; ++i)
-            delete pool[i];
+            destroy(pool[i]);
+        while (auto t = incoming.pop())
+            destroy(t);
+        while (auto t = outgoing.pop())
+            destroy(t);
     }
+
+    MemoryPool(const MemoryPool &) = delete;
+    MemoryPool &operator=(const MemoryPool &) = delete;
+
     template <typename... Args> T *getItem(Args &&...args)
     {
+        collectRefills();
+
         if (position == 0)
         {
+            // The refill thread hasn't kept up, and we can't return nothing
+            Surge::RealtimeSafety::noteBlockingCall("MemoryPool::refreshPool");
             refreshPool(std::forward<Args>(args)...);
         }
         auto q = pool[position - 1];
         pool[position - 1] = nullptr; // just to flag bugs
         position--;
+        publish();
         return q;
     }
     void returnItem(T *t)
     {
-        pool[position] = t;
-        position++;
+        if (position >= capacity)
+        {
+            // only the refill thread's extras could fill the pool, so let it free this one
+            discard(t);
+        }
+        else
+        {
+            pool[position] = t;
+            position++;
+        }
+        publish();
     }
     template <typename... Args> void refreshPool(Args &&...args)
     {
-        // In an ideal world, this grow would be off thread.
-        // For XT 1 leave it here and have a reasonable prealloc
-        assert(position < (growBy + capacity));
+        assert(position + growBy <= capacity);
         for (size_t i = 0; i < growBy; ++i)
         {
             pool[position] = new T(std::forward<Args>(args)...);
             position++;
+            alive++;
         }
     }
 
+    /*
+     * Ask the refill thread to keep upTo free items ready (but never fewer than preAlloc),
+     * handing any beyond that back to it to free. Unlike setupPoolToSize, this returns right
+     * away and the items arrive over the next few blocks, so it is safe on the audio thread.
+     * Call it from the thread which gets and returns items.
+     */
+    void requestPoolSize(size_t upTo)
+    {
+        upTo = std::clamp(upTo, preAlloc, capacity);
+        target.store(upTo, std::memory_order_relaxed);
+
+        collectRefills();
+        while (position > upTo)
+        {
+            discard(pool[position - 1]);
+            pool[position - 1] = nullptr;
+            position--;
+        }
+        publish();
+        wakeRefillThread();
+    }
+
+    // These allocate and free on the calling thread and complete before they return
     template <typename... Args> void setupPoolToSize(size_t upTo, Args &&...args)
     {
+        collectRefills();
         while (position < upTo)
         {
             pool[position] = new T(std::forward<Args>(args)...);
             position++;
+            alive++;
         }
+        publish();
     }
 
     void returnToPreAllocSize()
     {
+        target.store(preAlloc, std::memory_order_relaxed);
+        collectRefills();
         while (position > preAlloc)
         {
-            delete pool[position - 1];
+            destroy(pool[position - 1]);
             pool[position - 1] = nullptr;
             position--;
         }
+        publish();
     }
 
+    /*
+     * How many items this pool has made and not yet freed, whether they are waiting in the
+     * pool or out in use. Safe to read from any thread.
+     */
+    size_t itemsAlive() const { return alive.load(std::memory_order_relaxed); }
+    size_t bytesAlive() const { return itemsAlive() * sizeof(T); }
+
     std::array<T *, capacity> pool;
 
     /*
@@ -95,6 +192,117 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
      * position -1. position == 0 is a sentinel to rebuild.
      */
     size_t position{0};
+
+  private:
+    struct Handoff
+    {
+        std::array<T *, capacity> items;
+        std::atomic<size_t> writePos{0}, readPos{0};
+
+        bool push(T *t)
+        {
+            auto w = writePos.load(std::memory_order_relaxed);
+            if (w - readPos.load(std::memory_order_acquire) >= capacity)
+                return false;
+            items[w % capacity] = t;
+            writePos.store(w + 1, std::memory_order_release);
+            return true;
+        }
+        T *pop()
+        {
+            auto r = readPos.load(std::memory_order_relaxed);
+            if (r == writePos.load(std::memory_order_acquire))
+                return nullptr;
+            auto t = items[r % capacity];
+            readPos.store(r + 1, std::memory_order_release);
+            return t;
+        }
+        size_t size() const
+        {
+            return writePos.load(std::memory_order_acquire) -
+                   readPos.load(std::memory_order_acquire);
+        }
+    };
+
+    void collectRefills()
+    {
+        while (position < capacity)
+        {
+            auto t = incoming.pop();
+            if (!t)
+                break;
+            pool[position] = t;
+            position++;
+        }
+    }
+
+    void discard(T *t)
+    {
+        if (outgoing.push(t))
+            wakeRefillThread();
+        else
+            destroy(t); // only if the refill thread is hopelessly behind
+    }
+
+    void destroy(T *t)
+    {
+        delete t;
+        alive--;
+    }
+
+    void publish()
+    {
+        published.store(position, std::memory_order_release);
+        if (position < target.load(std::memory_order_relaxed))
+            wakeRefillThread();
+    }
+
+    void wakeRefillThread()
+    {
+        /*
+         * We don't take the mutex here, since this is the audio thread. A wakeup which races
+         * the refill thread going to sleep is caught by its timeout instead.
+         */
+        if (!wakeRequested.exchange(true, std::memory_order_acq_rel))
+            refillCV.notify_one();
+    }
+
+    void refillLoop()
+    {
+        while (keepRunning)
+        {
+            while (auto t = outgoing.pop())
+                destroy(t);
+
+            auto have = published.load(std::memory_order_acquire) + incoming.size();
+
+            while (keepRunning && have < target.load(std::memory_order_relaxed))
+            {
+                auto t = makeItem();
+                if (!incoming.push(t))
+                {
+                    destroy(t);
+                    break;
+                }
+                have++;
+            }
+
+            std::unique_lock<std::mutex> lk(refillMutex);
+            refillCV.wait_for(lk, std::chrono::milliseconds(50), [this]() {
+                return !keepRunning || wakeRequested.load(std::memory_order_acquire);
+            });
+            wakeRequested = false;
+        }
+    }
+
+    Handoff incoming, outgoing;
+    std::atomic<size_t> published{0}, target{preAlloc}, alive{0};
+
+    std::function<T *()> makeItem;
+    std::atomic<bool> keepRunning{true}, wakeRequested{false};
+    std::mutex refillMutex;
+    std::condition_variable refillCV;
+    std::thread refillThread;
 };
 } // namespace Memory
 } // namespace Surge
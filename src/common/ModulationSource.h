@@ -342,10 +342,12 @@ class ModulationSource
         samplerate_inv = sri;
     }
 
+    // the most outputs a source can have; a source_index at or past this reads nothing
+    static constexpr int vecsize = 16;
+
   protected:
     float samplerate{0}, samplerate_inv{0};
     int active_outputs{0};
-    static constexpr int vecsize = 16;
     float output, voutput[vecsize];
 };
 
@@ -558,6 +560,24 @@ template <int NDX = 1> class ControllerModulationSourceVector : public Modulatio
                          smoothingMode == Modulator::SmoothingMode::FAST_EXP ? 0.005f : 0.0025f);
     }
 
+    /*
+     * set_target(f) and then process_block(), except that when we have already settled on f
+     * neither would change anything, so we skip them. Voices call this every block for
+     * expressions which mostly sit still.
+     */
+    inline void smooth_towards(float f)
+    {
+        assert(NDX == 1);
+
+        if (value[0] == f && target[0] == f)
+        {
+            return;
+        }
+
+        set_target(0, f);
+        process_block();
+    }
+
     virtual bool process_block_until_close(float sigma)
     {
         assert(samplerate > 1000);
@@ -594,6 +614,7 @@ using ControllerModulationSource = ControllerModulationSourceVector<1>;
 
 struct MacroModulationSource : ControllerModulationSource
 {
+    MacroModulationSource() : MacroModulationSource(Modulator::SmoothingMode::LEGACY) {}
     MacroModulationSource(Modulator::SmoothingMode mode)
         : ControllerModulationSource(mode), modunderlyer(mode)
     {
@@ -649,6 +670,8 @@ class RandomModulationSource : public ModulationSource
         }
     }
 
+    void seed(uint32_t s) { gen = std::minstd_rand(s); }
+
     int get_active_outputs() override
     {
         return 2; // bipolar can't support lognormal obvs
@@ -26,6 +26,7 @@
 #include "SurgeStorage.h"
 #include "tinyxml/tinyxml.h"
 #include "sst/plugininfra/strnatcmp.h"
+#include "SharedPresetLibrary.h"
 
 namespace Surge
 {
@@ -241,117 +242,140 @@ void ModulatorPreset::loadPresetFrom(const fs::path &location, SurgeStorage *s,
     }
 }
 
+namespace
+{
+typedef SharedPresetLibrary<std::vector<ModulatorPreset::Category>> ModulatorPresetLibrary;
+
+std::string libraryKey(SurgeStorage *s)
+{
+    return path_to_string(s->datapath) + "\n" + path_to_string(s->userDataPath);
+}
+
 /*
  * Note: Clients rely on this being sorted by category path if you change it
  */
-std::vector<ModulatorPreset::Category> ModulatorPreset::getPresets(SurgeStorage *s)
+ModulatorPresetLibrary::scanner_t scannerFor(SurgeStorage *s)
 {
-    if (haveScanedPresets)
-        return scanedPresets;
-
     // Do a dual directory traversal of factory and user data with the fs::directory_iterator stuff
     // looking for .lfopreset
     auto factoryPath = s->datapath / fs::path{"modulator_presets"};
     auto userPath = s->userDataPath / fs::path{PresetDir};
 
-    std::map<std::string, Category> resMap; // handy it is sorted!
+    return [factoryPath, userPath]() {
+        auto scan = std::make_shared<ModulatorPresetLibrary::Scan>();
 
-    for (int i = 0; i < 2; ++i)
-    {
-        auto p = (i ? userPath : factoryPath);
-        bool isU = i;
-        try
+        std::map<std::string, ModulatorPreset::Category> resMap; // handy it is sorted!
+
+        for (int i = 0; i < 2; ++i)
         {
-            std::string currentCategoryName = "";
-            Category currentCategory;
-            for (auto &d : fs::recursive_directory_iterator(p))
+            auto p = (i ? userPath : factoryPath);
+            scan->noteDirectory(p);
+
+            try
             {
-                auto dp = fs::path(d);
-                auto base = dp.stem();
-                auto fn = dp.filename();
-                auto ext = dp.extension();
-                if (path_to_string(ext) != ".modpreset")
+                for (auto &d : fs::recursive_directory_iterator(p))
                 {
-                    continue;
-                }
-                auto rd = path_to_string(dp.replace_filename(fs::path()));
-                rd = rd.substr(path_to_string(p).length() + 1);
-                rd = rd.substr(0, rd.length() - 1);
-
-                auto catName = rd;
-                auto ppos = rd.rfind(fs::path::preferred_separator);
-                auto pd = std::string();
-                if (ppos != std::string::npos)
-                {
-                    pd = rd.substr(0, ppos);
-                    catName = rd.substr(ppos + 1);
-                }
-                if (resMap.find(rd) == resMap.end())
-                {
-                    resMap[rd] = Category();
-                    resMap[rd].name = catName;
-                    resMap[rd].parentPath = pd;
-                    resMap[rd].path = rd;
-
-                    /*
-                     * We only create categories if we find a preset. So that means parent
-                     * directories with just subdirs need categories made. This recurses up as far
-                     * as we need to go
-                     */
-                    while (pd != "" && resMap.find(pd) == resMap.end())
+                    if (d.is_directory())
                     {
-                        auto cd = pd;
-                        catName = cd;
-                        ppos = cd.rfind(fs::path::preferred_separator);
+                        scan->noteDirectory(d.path());
+                        continue;
+                    }
 
-                        if (ppos != std::string::npos)
-                        {
-                            pd = cd.substr(0, ppos);
-                            catName = cd.substr(ppos + 1);
-                        }
-                        else
+                    auto dp = fs::path(d);
+                    auto base = dp.stem();
+                    auto fn = dp.filename();
+                    auto ext = dp.extension();
+                    if (path_to_string(ext) != ".modpreset")
+                    {
+                        continue;
+                    }
+                    auto rd = path_to_string(dp.replace_filename(fs::path()));
+                    rd = rd.substr(path_to_string(p).length() + 1);
+                    rd = rd.substr(0, rd.length() - 1);
+
+                    auto catName = rd;
+                    auto ppos = rd.rfind(fs::path::preferred_separator);
+                    auto pd = std::string();
+                    if (ppos != std::string::npos)
+                    {
+                        pd = rd.substr(0, ppos);
+                        catName = rd.substr(ppos + 1);
+                    }
+                    if (resMap.find(rd) == resMap.end())
+                    {
+                        resMap[rd] = ModulatorPreset::Category();
+                        resMap[rd].name = catName;
+                        resMap[rd].parentPath = pd;
+                        resMap[rd].path = rd;
+
+                        /*
+                         * We only create categories if we find a preset. So that means
+                         * parent directories with just subdirs need categories made. This
+                         * recurses up as far as we need to go
+                         */
+                        while (pd != "" && resMap.find(pd) == resMap.end())
                         {
-                            pd = "";
+                            auto cd = pd;
+                            catName = cd;
+                            ppos = cd.rfind(fs::path::preferred_separator);
+
+                            if (ppos != std::string::npos)
+                            {
+                                pd = cd.substr(0, ppos);
+                                catName = cd.substr(ppos + 1);
+                            }
+                            else
+                            {
+                                pd = "";
+                            }
+
+                            resMap[cd] = ModulatorPreset::Category();
+                            resMap[cd].name = catName;
+                            resMap[cd].parentPath = pd;
+                            resMap[cd].path = cd;
                         }
-
-                        resMap[cd] = Category();
-                        resMap[cd].name = catName;
-                        resMap[cd].parentPath = pd;
-                        resMap[cd].path = cd;
                     }
-                }
 
-                Preset prs;
-                prs.name = path_to_string(base);
-                prs.path = fs::path(d);
-                resMap[rd].presets.push_back(prs);
+                    ModulatorPreset::Preset prs;
+                    prs.name = path_to_string(base);
+                    prs.path = fs::path(d);
+                    resMap[rd].presets.push_back(prs);
+                }
+            }
+            catch (const fs::filesystem_error &e)
+            {
+                // That's OK!
             }
         }
-        catch (const fs::filesystem_error &e)
+
+        for (auto &m : resMap)
         {
-            // That's OK!
+            std::sort(m.second.presets.begin(), m.second.presets.end(),
+                      [](const ModulatorPreset::Preset &a, const ModulatorPreset::Preset &b) {
+                          return strnatcasecmp(a.name.c_str(), b.name.c_str()) < 0;
+                      });
+
+            scan->presets.push_back(m.second);
         }
-    }
 
-    std::vector<Category> res;
-    for (auto &m : resMap)
-    {
-        std::sort(m.second.presets.begin(), m.second.presets.end(),
-                  [](const Preset &a, const Preset &b) {
-                      return strnatcasecmp(a.name.c_str(), b.name.c_str()) < 0;
-                  });
+        return std::shared_ptr<const ModulatorPresetLibrary::Scan>(scan);
+    };
+}
+} // namespace
 
-        res.push_back(m.second);
-    }
-    scanedPresets = res;
-    haveScanedPresets = true;
-    return res;
+std::vector<ModulatorPreset::Category> ModulatorPreset::getPresets(SurgeStorage *s)
+{
+    auto scan = ModulatorPresetLibrary::get(libraryKey(s), scannerFor(s), rescanNeeded);
+    rescanNeeded = false;
+
+    return scan->presets;
 }
 
-void ModulatorPreset::forcePresetRescan()
+void ModulatorPreset::startPresetScan(SurgeStorage *s)
 {
-    haveScanedPresets = false;
-    scanedPresets.clear();
+    ModulatorPresetLibrary::prefetch(libraryKey(s), scannerFor(s));
 }
+
+void ModulatorPreset::forcePresetRescan() { rescanNeeded = true; }
 } // namespace Storage
 } // namespace Surge
@@ -61,11 +61,14 @@ struct ModulatorPreset
         std::vector<Preset> presets;
     };
 
+    // shared with every other instance, see SharedPresetLibrary
     std::vector<Category> getPresets(SurgeStorage *s);
+    // start walking the preset folders in the background, so getPresets doesn't have to
+    void startPresetScan(SurgeStorage *s);
+    // walk them again on the next getPresets, for every instance
     void forcePresetRescan();
 
-    std::vector<Category> scanedPresets;
-    bool haveScanedPresets{false};
+    bool rescanNeeded{false};
 };
 } // namespace Storage
 } // namespace Surge
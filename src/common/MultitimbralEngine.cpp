@@ -0,0 +1,161 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "MultitimbralEngine.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+namespace Surge
+{
+MultitimbralEngine::MultitimbralEngine(SurgeSynthesizer::PluginLayer *parent, int numParts,
+                                       const std::string &suppliedDataPath)
+{
+    assert(numParts >= 1 && numParts <= max_parts);
+    numParts = std::clamp(numParts, 1, (int)max_parts);
+
+    parts.reserve(numParts);
+    for (int p = 0; p < numParts; ++p)
+        parts.push_back(std::make_unique<SurgeSynthesizer>(parent, suppliedDataPath));
+
+    for (int c = 0; c < n_midi_channels; ++c)
+        channelToPart[c] = c < numParts ? c : -1;
+
+    memset(output, 0, sizeof(output));
+}
+
+void MultitimbralEngine::setPartForChannel(int channel, int part)
+{
+    channelToPart[channel & 15] = (part >= 0 && part < numParts()) ? part : -1;
+}
+
+void MultitimbralEngine::setSamplerate(float sr)
+{
+    for (auto &p : parts)
+        p->setSamplerate(sr);
+}
+
+void MultitimbralEngine::playNote(char channel, char key, char velocity, char detune,
+                                  int32_t host_noteid)
+{
+    if (auto s = partFor(channel))
+        s->playNote(channel, key, velocity, detune, host_noteid);
+}
+
+void MultitimbralEngine::releaseNote(char channel, char key, char velocity, int32_t host_noteid)
+{
+    if (auto s = partFor(channel))
+        s->releaseNote(channel, key, velocity, host_noteid);
+}
+
+void MultitimbralEngine::pitchBend(char channel, int value)
+{
+    if (auto s = partFor(channel))
+        s->pitchBend(channel, value);
+}
+
+void MultitimbralEngine::polyAftertouch(char channel, int key, int value)
+{
+    if (auto s = partFor(channel))
+        s->polyAftertouch(channel, key, value);
+}
+
+void MultitimbralEngine::channelAftertouch(char channel, int value)
+{
+    if (auto s = partFor(channel))
+        s->channelAftertouch(channel, value);
+}
+
+void MultitimbralEngine::channelController(char channel, int cc, int value)
+{
+    if (auto s = partFor(channel))
+        s->channelController(channel, cc, value);
+}
+
+void MultitimbralEngine::programChange(char channel, int value)
+{
+    if (auto s = partFor(channel))
+        s->programChange(channel, value);
+}
+
+void MultitimbralEngine::allNotesOff()
+{
+    for (auto &p : parts)
+        p->allNotesOff();
+}
+
+void MultitimbralEngine::setParallelParts(bool b)
+{
+    if (b && !scheduler)
+        scheduler = Surge::Threading::SharedScheduler::acquire();
+
+    parallelParts = b;
+}
+
+void MultitimbralEngine::setHostCallbackDeadline(int numSamples)
+{
+    for (auto &p : parts)
+        p->setHostCallbackDeadline(numSamples);
+
+    hostCallbackDeadline =
+        Surge::Threading::SharedScheduler::clock_t::now() +
+        std::chrono::nanoseconds(
+            (int64_t)(numSamples * parts[0]->storage.dsamplerate_inv * 1e9));
+}
+
+void MultitimbralEngine::process()
+{
+    auto n = numParts();
+
+    if (parallelParts && n > 1 && scheduler && scheduler->numWorkers() > 0)
+    {
+        auto deadline = hostCallbackDeadline;
+        if (deadline.time_since_epoch().count() == 0)
+            deadline = Surge::Threading::SharedScheduler::clock_t::now() +
+                       std::chrono::nanoseconds(
+                           (int64_t)(BLOCK_SIZE * parts[0]->storage.dsamplerate_inv * 1e9));
+
+        auto f = [this](int p) { parts[p]->process(); };
+        scheduler->parallelFor(n, f, deadline);
+    }
+    else
+    {
+        for (auto &p : parts)
+            p->process();
+    }
+
+    // summed in part order, so the mix doesn't depend on which thread ran which part
+    memcpy(output, parts[0]->output, sizeof(output));
+    for (int p = 1; p < n; ++p)
+    {
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            auto *src = parts[p]->output[c];
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                output[c][i] += src[i];
+        }
+    }
+}
+} // namespace Surge
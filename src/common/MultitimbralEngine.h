@@ -0,0 +1,114 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_MULTITIMBRALENGINE_H
+#define SURGE_SRC_COMMON_MULTITIMBRALENGINE_H
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SurgeSynthesizer.h"
+#include "WorkerPool.h"
+
+namespace Surge
+{
+/*
+ * Several independent Surges in one process, for multi-part arrangements which would
+ * otherwise load one plugin per part. Each part is a full SurgeSynthesizer with its own
+ * patch, voices, scenes and effects, played by the MIDI channels routed to it.
+ *
+ * What doesn't depend on the patch is shared between the parts: the constant and sample
+ * rate tables, configuration, the patch and wavetable lists, the preset scans and the patch
+ * database are all per process, and every part renders on the process wide SharedScheduler.
+ *
+ * After process() each part's output holds that part's block, for a host with a bus per
+ * part, and output here holds the sum of them all.
+ */
+struct MultitimbralEngine
+{
+    static constexpr int max_parts = 16;
+    static constexpr int n_midi_channels = 16;
+
+    // part n starts out playing MIDI channel n, and any channels past the last part play none
+    MultitimbralEngine(SurgeSynthesizer::PluginLayer *parent, int numParts,
+                       const std::string &suppliedDataPath = "");
+
+    MultitimbralEngine(const MultitimbralEngine &) = delete;
+    MultitimbralEngine &operator=(const MultitimbralEngine &) = delete;
+
+    int numParts() const { return (int)parts.size(); }
+    SurgeSynthesizer *part(int p) { return parts[p].get(); }
+
+    // -1 leaves the channel unplayed. Call this between blocks, not during process()
+    void setPartForChannel(int channel, int part);
+    int partForChannel(int channel) const { return channelToPart[channel & 15]; }
+
+    void setSamplerate(float sr);
+
+    // these go to the channel's part, with the channel unchanged, so MPE and channel split
+    // patches behave as they would in a plugin of their own
+    void playNote(char channel, char key, char velocity, char detune = 0,
+                  int32_t host_noteid = -1);
+    void releaseNote(char channel, char key, char velocity, int32_t host_noteid = -1);
+    void pitchBend(char channel, int value);
+    void polyAftertouch(char channel, int key, int value);
+    void channelAftertouch(char channel, int value);
+    void channelController(char channel, int cc, int value);
+    void programChange(char channel, int value);
+    void allNotesOff();
+
+    /*
+     * With parallel parts on, process() renders the parts across the shared workers, the
+     * calling thread among them. Each part's own multithreaded rendering still applies and
+     * submits to the same workers. Call this from a non-audio thread, since the first enable
+     * in the process starts the workers.
+     */
+    void setParallelParts(bool b);
+    bool getParallelParts() const { return parallelParts; }
+
+    // as SurgeSynthesizer::setHostCallbackDeadline, for the parts batch and every part
+    void setHostCallbackDeadline(int numSamples);
+
+    void process();
+
+    float output alignas(16)[N_OUTPUTS][BLOCK_SIZE];
+
+  private:
+    SurgeSynthesizer *partFor(char channel)
+    {
+        auto p = channelToPart[channel & 15];
+        return p < 0 ? nullptr : parts[p].get();
+    }
+
+    std::vector<std::unique_ptr<SurgeSynthesizer>> parts;
+    std::array<int, n_midi_channels> channelToPart;
+
+    bool parallelParts{false};
+    std::shared_ptr<Surge::Threading::SharedScheduler> scheduler;
+    Surge::Threading::SharedScheduler::clock_t::time_point hostCallbackDeadline{};
+};
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_MULTITIMBRALENGINE_H
@@ -381,7 +381,11 @@ bool Parameter::has_deformoptions() const
     case ct_filter_feedback:
     case ct_osc_feedback_negative:
     case ct_countedset_percent_extendable_wtdeform:
+    case ct_wstype:
         return true;
+    case ct_distortion_waveshape:
+        // the rotary speaker has these models too, but comes from sst-effects and can't antialias
+        return !basicBlocksParamMetaData.has_value();
     default:
         break;
     }
@@ -1321,6 +1325,7 @@ void Parameter::set_type(int ctrltype)
 
     case ct_comp_attack_ms:
     case ct_comp_release_ms:
+    case ct_conditioner_lookahead:
         valtype = vt_float;
         val_min.f = 0.f;
         val_max.f = 1.f;
@@ -1681,6 +1686,13 @@ void Parameter::set_type(int ctrltype)
         snprintf(displayInfo.unit, DISPLAYINFO_TXT_SIZE, "ms");
         break;
 
+    case ct_conditioner_lookahead:
+        displayType = ATwoToTheBx;
+        displayInfo.a = 0.5f;
+        displayInfo.b = std::log2(8.0f / 0.5f);
+        snprintf(displayInfo.unit, DISPLAYINFO_TXT_SIZE, "ms");
+        break;
+
     case ct_ensemble_clockrate:
         displayType = LinearWithScale;
         displayInfo.scale = 1.f;
@@ -3436,12 +3448,102 @@ void Parameter::get_display_alt(char *txt, bool external, float ef) const
 
 void Parameter::get_display(char *txt, bool external, float ef) const
 {
-    auto str = get_display(external, ef);
+    DisplayCache::Key key;
+
+    if (readDisplayCache(txt, TXT_SIZE, external, ef, key))
+    {
+        return;
+    }
+
+    auto str = format_display(external, ef);
+    writeDisplayCache(str, external, key);
 
     strncpy(txt, str.c_str(), TXT_SIZE - 1);
 }
 
 std::string Parameter::get_display(bool external, float ef) const
+{
+    char txt[TXT_SIZE];
+    DisplayCache::Key key;
+
+    if (readDisplayCache(txt, TXT_SIZE, external, ef, key))
+    {
+        return txt;
+    }
+
+    auto str = format_display(external, ef);
+    writeDisplayCache(str, external, key);
+
+    return str;
+}
+
+bool Parameter::displayIsCacheable() const
+{
+    // these read other parameters, or whatever their user data points at, to make their text
+    return storage && !user_data && ctrltype != ct_filtersubtype &&
+           ctrltype != ct_midikey_or_channel;
+}
+
+bool Parameter::readDisplayCache(char *txt, size_t n, bool external, float ef,
+                                 DisplayCache::Key &key) const
+{
+    if (!displayIsCacheable())
+    {
+        return false;
+    }
+
+    if (external)
+        memcpy(&key.value, &ef, sizeof(key.value));
+    else if (valtype == vt_float)
+        memcpy(&key.value, &val.f, sizeof(key.value));
+    else if (valtype == vt_int)
+        key.value = (uint32_t)val.i;
+    else
+        key.value = val.b ? 1 : 0;
+
+    key.generation = storage->displayGeneration.load(std::memory_order_relaxed);
+    key.ctrltype = ctrltype;
+    key.deform = deform_type;
+    key.flags = (temposync ? 1 : 0) | (absolute ? 2 : 0) | (extend_range ? 4 : 0) |
+                (deactivated ? 8 : 0) | (valtype << 4);
+
+    if (displayCache.busy.exchange(true, std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    auto &slot = displayCache.slots[external ? 1 : 0];
+    auto hit = slot.valid && slot.key == key && strlen(slot.text) < n;
+
+    if (hit)
+    {
+        strcpy(txt, slot.text);
+    }
+
+    displayCache.busy.store(false, std::memory_order_release);
+
+    return hit;
+}
+
+void Parameter::writeDisplayCache(const std::string &txt, bool external,
+                                  const DisplayCache::Key &key) const
+{
+    auto &slot = displayCache.slots[external ? 1 : 0];
+
+    if (!displayIsCacheable() || txt.size() >= sizeof(slot.text) ||
+        displayCache.busy.exchange(true, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    memcpy(slot.text, txt.c_str(), txt.size() + 1);
+    slot.key = key;
+    slot.valid = true;
+
+    displayCache.busy.store(false, std::memory_order_release);
+}
+
+std::string Parameter::format_display(bool external, float ef) const
 {
     std::string txt{""};
 
@@ -4495,6 +4597,7 @@ bool Parameter::can_setvalue_from_string() const
     case ct_chow_ratio:
     case ct_comp_attack_ms:
     case ct_comp_release_ms:
+    case ct_conditioner_lookahead:
     case ct_freq_ringmod:
     case ct_modern_trimix:
     case ct_ensemble_clockrate:
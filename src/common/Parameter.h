@@ -216,6 +216,7 @@ enum ctrltypes
     ct_floaty_warp_time,
     ct_floaty_delay_time,
     ct_floaty_delay_playrate,
+    ct_conditioner_lookahead,
 
     num_ctrltypes,
 };
@@ -443,11 +444,60 @@ class Parameter
     const char *get_storage_name() const;
     const wchar_t *getUnit() const;
 
-    /* this is now deprecated and will be removed in favor of std::string variant */
+    // fills txt (TXT_SIZE long), and doesn't allocate when the cached text is still good
     void get_display(char *txt, bool external = false, float ef = 0.f) const;
 
     std::string get_display(bool external = false, float ef = 0.f) const;
 
+    /*
+     * What get_display last made, one slot for the current value and one for a value a host
+     * asked about. Hosts ask for the text of every parameter on each redraw, so while nothing
+     * that goes into the text has moved we hand back the last one. Anything outside the
+     * parameter itself which changes the text bumps SurgeStorage::displayGeneration. The
+     * slots are only touched while holding busy; a thread which finds it held formats afresh.
+     */
+    struct DisplayCache
+    {
+        struct Key
+        {
+            uint32_t value{0}, generation{0};
+            int ctrltype{0}, deform{0}, flags{0};
+
+            bool operator==(const Key &o) const
+            {
+                return value == o.value && generation == o.generation &&
+                       ctrltype == o.ctrltype && deform == o.deform && flags == o.flags;
+            }
+        };
+        struct Slot
+        {
+            Key key;
+            bool valid{false};
+            char text[64]{};
+        } slots[2];
+        std::atomic<bool> busy{false};
+
+        DisplayCache() = default;
+        // a copied parameter starts out with nothing cached
+        DisplayCache(const DisplayCache &) {}
+        DisplayCache &operator=(const DisplayCache &)
+        {
+            slots[0].valid = slots[1].valid = false;
+            return *this;
+        }
+    };
+
+  private:
+    std::string format_display(bool external, float ef) const;
+    bool displayIsCacheable() const;
+    bool readDisplayCache(char *txt, size_t n, bool external, float ef,
+                          DisplayCache::Key &key) const;
+    void writeDisplayCache(const std::string &txt, bool external,
+                           const DisplayCache::Key &key) const;
+    mutable DisplayCache displayCache;
+
+  public:
+
     enum ModulationDisplayMode
     {
         TypeIn,
@@ -0,0 +1,118 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_PARAMETERCHANGELOG_H
+#define SURGE_SRC_COMMON_PARAMETERCHANGELOG_H
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * A single producer, single consumer log of parameter values which coalesces as it goes:
+ * a parameter which changes again before the consumer gets to it just has its value
+ * replaced, so however fast the producer sets things the consumer sees each parameter at
+ * most once per drain, with its latest value. Neither side locks or allocates.
+ *
+ * Each index is in the ring at most once while it is queued, and at most once more while
+ * the consumer is working on it, so a ring of twice the parameter count can't overflow.
+ *
+ * push() returns true when the consumer needs waking, which is only on the first push
+ * after a drain starts, so the producer can schedule a drain without flooding whatever
+ * it schedules it with.
+ */
+template <size_t N> struct ParameterChangeLog
+{
+    // on the producer thread
+    bool push(int index, float value)
+    {
+        if (index < 0 || index >= (int)N)
+            return false;
+
+        values[index].store(value, std::memory_order_relaxed);
+
+        if (!queued[index].exchange(true, std::memory_order_acq_rel))
+        {
+            auto w = writePos.load(std::memory_order_relaxed);
+            ring[w & mask] = index;
+            writePos.store(w + 1, std::memory_order_release);
+        }
+
+        return !wakeRequested.exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool empty() const
+    {
+        return readPos.load(std::memory_order_acquire) ==
+               writePos.load(std::memory_order_acquire);
+    }
+
+    // on the consumer thread; calls f(index, value) for each changed parameter
+    template <typename F> int drain(F &&f)
+    {
+        wakeRequested.store(false, std::memory_order_seq_cst);
+
+        int n = 0;
+        auto r = readPos.load(std::memory_order_relaxed);
+        auto w = writePos.load(std::memory_order_acquire);
+
+        for (; r != w; ++r)
+        {
+            auto index = ring[r & mask];
+
+            // take the value after unqueueing, so a set we race with is either seen or queued
+            queued[index].exchange(false, std::memory_order_acq_rel);
+            f(index, values[index].load(std::memory_order_relaxed));
+            readPos.store(r + 1, std::memory_order_release);
+            n++;
+        }
+
+        return n;
+    }
+
+  private:
+    static constexpr size_t ringSizeFor(size_t n)
+    {
+        size_t s = 1;
+        while (s < 2 * n)
+            s <<= 1;
+        return s;
+    }
+    static constexpr size_t ringSize = ringSizeFor(N);
+    static constexpr size_t mask = ringSize - 1;
+
+    std::array<std::atomic<float>, N> values{};
+    std::array<std::atomic<bool>, N> queued{};
+    std::array<int, ringSize> ring{};
+    std::atomic<uint32_t> writePos{0}, readPos{0};
+    std::atomic<bool> wakeRequested{false};
+};
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PARAMETERCHANGELOG_H
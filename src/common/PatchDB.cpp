@@ -22,14 +22,23 @@
 
 #include "PatchDB.h"
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
 #include <sstream>
+#include <thread>
 #include <iterator>
 #include <chrono>
 #include <functional>
+#include <list>
+#include <map>
 
 #include "sqlite3.h"
 #include "SurgeStorage.h"
 #include "DebugHelpers.h"
+#include "WorkerPool.h"
+#include "SurgeTrace.h"
+#include "ThreadPolicy.h"
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 #include "PatchFileHeaderStructs.h"
@@ -198,6 +207,21 @@ struct Statement
     sqlite3 *h;
 };
 
+/*
+ * Statements we keep prepared get reset on the way out of each use, so an early return
+ * or an exception doesn't leave them holding a read transaction open against the writer
+ */
+struct ResetGuard
+{
+    explicit ResetGuard(Statement &st) : st(st) {}
+    ~ResetGuard()
+    {
+        sqlite3_reset(st.s);
+        sqlite3_clear_bindings(st.s);
+    }
+    Statement &st;
+};
+
 /*
  * RAII on transactions
  */
@@ -240,7 +264,7 @@ struct TxnGuard
 
 struct PatchDB::WriterWorker
 {
-    static constexpr const char *schema_version = "14"; // I will rebuild if this is not my version
+    static constexpr const char *schema_version = "16"; // I will rebuild if this is not my version
 
     static constexpr const char *setup_sql = R"SQL(
 DROP TABLE IF EXISTS "Patches";
@@ -254,8 +278,9 @@ CREATE TABLE "Version" (
 );
 CREATE TABLE "Patches" (
       id integer primary key,
-      path varchar(2048),
+      path varchar(2048) COLLATE NOCASE,
       name varchar(256),
+      author varchar(256),
       search_over varchar(1024),
       category varchar(2048),
       category_type int,
@@ -280,7 +305,9 @@ CREATE TABLE Category (
 CREATE TABLE DebugJunk (
     id integer primary key,
     junk varchar(2048)
-)
+);
+CREATE INDEX patches_by_path ON Patches (path);
+CREATE INDEX features_by_patch ON PatchFeature (patch_id);
     )SQL";
 
     // language=SQL
@@ -289,6 +316,11 @@ CREATE TABLE IF NOT EXISTS Favorites (
     id integer primary key,
     path varchar(2048)
 );
+CREATE TABLE IF NOT EXISTS Previews (
+    id integer primary key,
+    path varchar(2048) COLLATE NOCASE UNIQUE,
+    preview_path varchar(2048)
+);
 )SQL";
     struct EnQAble
     {
@@ -296,6 +328,28 @@ CREATE TABLE IF NOT EXISTS Favorites (
         virtual void go(WriterWorker &) = 0;
     };
 
+    // FIXME features should be an enum or something
+
+    enum FeatureType
+    {
+        INT,
+        STRING
+    };
+    typedef std::tuple<std::string, FeatureType, int, std::string> feature;
+
+    /*
+     * Everything parseFXPIntoDB needs from the file itself. Reading it doesn't touch the
+     * database, so a batch of these is read in parallel before the batch is written.
+     */
+    struct ParsedFXP
+    {
+        bool exists{false};
+        int64_t lastWriteTime{0};
+        std::string searchOver; // the name and folders; tags are added as they're written
+        bool hasFeatures{false};
+        std::vector<feature> features;
+    };
+
     struct EnQPatch : public EnQAble
     {
         EnQPatch(const fs::path &p, const std::string &n, const std::string &cn, const CatType t)
@@ -306,8 +360,14 @@ CREATE TABLE IF NOT EXISTS Favorites (
         std::string name;
         std::string catname;
         CatType type;
+        std::unique_ptr<ParsedFXP> parsed;
 
-        void go(WriterWorker &w) override { w.parseFXPIntoDB(*this); }
+        void go(WriterWorker &w) override
+        {
+            if (!parsed)
+                parsed = std::make_unique<ParsedFXP>(w.parseFXP(*this));
+            w.parseFXPIntoDB(*this);
+        }
     };
 
     struct EnQDebugMsg : public EnQAble
@@ -336,6 +396,13 @@ CREATE TABLE IF NOT EXISTS Favorites (
         void go(WriterWorker &w) override { w.setFavorite(path, value); }
     };
 
+    struct EnQPreview : public EnQAble
+    {
+        std::string path, previewPath;
+        EnQPreview(const std::string &p, const std::string &pp) : path(p), previewPath(pp) {}
+        void go(WriterWorker &w) override { w.setPreview(path, previewPath); }
+    };
+
     struct EnQDelete : public EnQAble
     {
         int id;
@@ -386,7 +453,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
             std::ostringstream oss;
             oss << "An error occurred opening sqlite file '" << dbname << "'. The error was '"
                 << sqlite3_errmsg(dbh) << "'.";
-            storage->reportError(oss.str(), "Surge Patch Database Error");
+            db->reportError(oss.str(), "Surge Patch Database Error");
             if (dbh)
             {
                 // even if opening fails we still need to close the database
@@ -395,6 +462,20 @@ CREATE TABLE IF NOT EXISTS Favorites (
             dbh = nullptr;
             return;
         }
+
+        /*
+         * WAL lets the read connections carry on while a batch commits, rather than the
+         * search going quiet for the length of an index. This has to happen outside a
+         * transaction, so here rather than in setup, and is a no-op once the file is in WAL.
+         */
+        try
+        {
+            SQL::Exec(dbh, "PRAGMA journal_mode=WAL");
+        }
+        catch (const SQL::Exception &)
+        {
+            // the default journal still works, with readers waiting on the writer
+        }
     }
 
     void closeDb()
@@ -410,7 +491,9 @@ CREATE TABLE IF NOT EXISTS Favorites (
     std::string dbname;
     fs::path dbpath;
 
-    explicit WriterWorker(SurgeStorage *storage) : storage(storage)
+    // the paths are copied since the storage may go before the database does
+    WriterWorker(PatchDB *db, SurgeStorage *storage)
+        : db(db), userPatchesPath(storage->userPatchesPath), datapath(storage->datapath)
     {
         dbpath = storage->userDataPath / fs::path{"SurgePatches.db"};
         dbname = path_to_string(dbpath);
@@ -468,7 +551,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
              * In this case, we choose to not report the error since it means
              * that we just need to rebuild everything
              */
-            // storage->reportError(e.what(), "SQLLite3 Startup Error");
+            // db->reportError(e.what(), "SQLLite3 Startup Error");
         }
 
         char *emsg;
@@ -489,7 +572,20 @@ CREATE TABLE IF NOT EXISTS Favorites (
             }
             catch (const SQL::Exception &e)
             {
-                storage->reportError(e.what(), "PatchDB Setup Error");
+                db->reportError(e.what(), "PatchDB Setup Error");
+            }
+        }
+        else
+        {
+            // the user tables survive a rebuild, so one added since this database was made
+            // has to be created here
+            try
+            {
+                SQL::Exec(dbh, setup_user);
+            }
+            catch (const SQL::Exception &e)
+            {
+                db->reportError(e.what(), "PatchDB Setup Error");
             }
         }
 
@@ -503,7 +599,8 @@ CREATE TABLE IF NOT EXISTS Favorites (
             return;
         // We know this is called in the lock so can manipulate pathQ properly
         haveOpenedForWriteOnce = true;
-        qThread = std::thread([this]() { this->loadQueueFunction(); });
+        qThread = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Loader,
+                                               [this]() { this->loadQueueFunction(); });
 
         {
             std::lock_guard<std::mutex> g(qLock);
@@ -517,6 +614,8 @@ CREATE TABLE IF NOT EXISTS Favorites (
 
     ~WriterWorker()
     {
+        closeReadConnections();
+
         if (haveOpenedForWriteOnce)
         {
             keepRunning = false;
@@ -527,23 +626,9 @@ CREATE TABLE IF NOT EXISTS Favorites (
                 sqlite3_close(dbh);
             dbh = nullptr;
         }
-
-        if (rodbh)
-        {
-            sqlite3_close(rodbh);
-            rodbh = nullptr;
-        }
     }
 
-    // FIXME features should be an enum or something
-
-    enum FeatureType
-    {
-        INT,
-        STRING
-    };
-    typedef std::tuple<std::string, FeatureType, int, std::string> feature;
-    std::vector<feature> extractFeaturesFromXML(const char *xml)
+    std::vector<feature> extractFeaturesFromXML(const char *xml) const
     {
         std::vector<feature> res;
         TiXmlDocument doc;
@@ -649,7 +734,9 @@ CREATE TABLE IF NOT EXISTS Favorites (
     std::atomic<bool> waiting{false};
     void loadQueueFunction()
     {
-        static constexpr auto transChunkSize = 10; // How many FXP to load in a single txn
+        SURGE_TRACE_THREAD_NAME("Surge PatchDB Writer");
+
+        static constexpr auto transChunkSize = 256; // How many FXP to load in a single txn
         int lock_retries{0};
         while (keepRunning)
         {
@@ -668,15 +755,31 @@ CREATE TABLE IF NOT EXISTS Favorites (
 
                 if (keepRunning)
                 {
+                    /*
+                     * Whoever queued a lambda wants everything before it written, so a lambda
+                     * ends a batch and runs in one of its own
+                     */
                     auto b = pathQ.begin();
-                    auto e = (pathQ.size() < transChunkSize) ? pathQ.end()
-                                                             : pathQ.begin() + transChunkSize;
+                    auto e = b;
+                    while (e != pathQ.end() && (e - b) < transChunkSize)
+                    {
+                        if (dynamic_cast<EnQLambda *>(*e))
+                        {
+                            if (e == b)
+                                ++e;
+                            break;
+                        }
+                        ++e;
+                    }
                     std::copy(b, e, std::back_inserter(doThis));
                     pathQ.erase(b, e);
                 }
             }
             if (!doThis.empty())
             {
+                SURGE_TRACE_ZONE("PatchDB::WriterWorker batch");
+                parseFXPs(doThis);
+
                 if (!dbh)
                     openDb();
                 if (dbh == nullptr)
@@ -695,6 +798,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
                         }
 
                         tg.end();
+                        writeGeneration++;
                     }
                     catch (SQL::LockedException &le)
                     {
@@ -705,7 +809,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
                                "writing up to 10 more times. "
                                "Please dismiss this error in the meantime!\n\n Attempt: "
                             << lock_retries;
-                        storage->reportError(oss.str(), "Patch Database Locked");
+                        db->reportError(oss.str(), "Patch Database Locked");
                         // OK so in this case, we reload doThis onto the front of the queue and
                         // sleep
                         lock_retries++;
@@ -723,42 +827,177 @@ CREATE TABLE IF NOT EXISTS Favorites (
                         }
                         else
                         {
-                            storage->reportError(
+                            db->reportError(
                                 "Database is locked and unwritable after multiple attempts!",
                                 "Patch Database Locked");
                         }
                     }
                     catch (SQL::Exception &e)
                     {
-                        storage->reportError(e.what(), "Patch DB");
+                        db->reportError(e.what(), "Patch DB");
                     }
                 }
             }
         }
     }
 
-    void parseFXPIntoDB(const EnQPatch &p)
+    /*
+     * Read the patches in a batch ahead of writing them, spread over a few threads when
+     * there are enough of them to be worth it
+     */
+    void parseFXPs(const std::vector<EnQAble *> &batch)
+    {
+        std::vector<EnQPatch *> toParse;
+        for (auto *q : batch)
+        {
+            auto ep = dynamic_cast<EnQPatch *>(q);
+            if (ep && !ep->parsed)
+                toParse.push_back(ep);
+        }
+
+        auto parseOne = [this, &toParse](int i) {
+            toParse[i]->parsed = std::make_unique<ParsedFXP>(parseFXP(*toParse[i]));
+        };
+
+        if (toParse.size() >= minParallelParse && !parsers)
+        {
+            auto hw = (int)std::thread::hardware_concurrency();
+            auto n = std::min(hw - 1, maxParseThreads);
+            if (n > 0)
+                parsers = std::make_unique<Surge::Threading::WorkerPool>(n);
+        }
+
+        if (parsers && toParse.size() >= minParallelParse)
+        {
+            parsers->parallelFor((int)toParse.size(), parseOne);
+        }
+        else
+        {
+            for (int i = 0; i < (int)toParse.size(); ++i)
+                parseOne(i);
+        }
+    }
+
+    static constexpr size_t minParallelParse = 8;
+    static constexpr int maxParseThreads = 7;
+    std::unique_ptr<Surge::Threading::WorkerPool> parsers;
+
+    // this runs on the parser threads, so only reads the file and the storage paths
+    ParsedFXP parseFXP(const EnQPatch &p) const
     {
-        sqlite3_stmt *insertStmt = nullptr, *insfeatureStmt = nullptr, *dropIdStmt = nullptr;
+        ParsedFXP res;
 
-        if (!fs::exists(p.path))
+        std::error_code ec;
+        if (!fs::exists(p.path, ec))
         {
 #if TRACE_DB
             std::cout << "    - Warning: Non existent " << path_to_string(p.path) << std::endl;
 #endif
-            return;
+            return res;
         }
         // Check with
-        auto qtime = fs::last_write_time(p.path);
-        int64_t qtimeInt =
+        auto qtime = fs::last_write_time(p.path, ec);
+        if (ec)
+            return res;
+
+        res.exists = true;
+        res.lastWriteTime =
             std::chrono::duration_cast<std::chrono::seconds>(qtime.time_since_epoch()).count();
 
+        std::ostringstream searchName;
+        searchName << p.name << " ";
+
+        if (!datapath.empty())
+        {
+            auto pTmp = p.path.parent_path();
+            std::vector<fs::path> parentFiles;
+            int maxItForSafety{0};
+            while ((pTmp != userPatchesPath) &&
+                   (pTmp != datapath / "patches_factory") &&
+                   (pTmp != datapath / "patches_3rdparty") && !pTmp.empty() &&
+                   (pTmp != pTmp.root_directory()) && maxItForSafety < 10)
+            {
+                parentFiles.push_back(pTmp.filename());
+                pTmp = pTmp.parent_path();
+                maxItForSafety++;
+            }
+
+            if (pTmp == datapath / "patches_3rdparty")
+            {
+                parentFiles.erase(parentFiles.end() - 1);
+            }
+
+            for (auto pf : parentFiles)
+            {
+                searchName << pf.u8string() << " ";
+            }
+        }
+
+        res.searchOver = searchName.str();
+
+        std::ifstream stream(p.path, std::ios::in | std::ios::binary);
+
+        std::vector<char> fxChunk;
+        fxChunk.resize(sizeof(sst::io::fxChunkSetCustom));
+        stream.read(fxChunk.data(), fxChunk.size());
+        if (!stream)
+        {
+            return res;
+        }
+
+        auto *fxp = (sst::io::fxChunkSetCustom *)(fxChunk.data());
+        if ((mech::endian_read_int32BE(fxp->chunkMagic) != 'CcnK') ||
+            (mech::endian_read_int32BE(fxp->fxMagic) != 'FPCh') ||
+            (mech::endian_read_int32BE(fxp->fxID) != 'cjs3'))
+        {
+            return res;
+        }
+
+        std::vector<char> patchHeaderChunk;
+        patchHeaderChunk.resize(sizeof(sst::io::patch_header));
+        stream.read(patchHeaderChunk.data(), patchHeaderChunk.size());
+        if (!stream)
+        {
+            return res;
+        }
+        auto *ph = (sst::io::patch_header *)(patchHeaderChunk.data());
+        auto xmlSz = mech::endian_read_int32LE(ph->xmlsize);
+
+        if (!memcpy(ph->tag, "sub3", 4) || xmlSz < 0 || xmlSz > 1024 * 1024 * 1024)
+        {
+            std::cerr << "Skipping invalid patch : [" << p.path.u8string() << "]" << std::endl;
+            return res;
+        }
+
+        // one more for the terminator the XML parser looks for
+        std::vector<char> xmlData(xmlSz + 1, 0);
+        stream.read(xmlData.data(), xmlSz);
+        if (!stream)
+            return res;
+
+        res.features = extractFeaturesFromXML(xmlData.data());
+        res.hasFeatures = true;
+        return res;
+    }
+
+    void parseFXPIntoDB(const EnQPatch &p)
+    {
+        assert(p.parsed);
+        auto &parsed = *p.parsed;
+
+        if (!parsed.exists)
+        {
+            return;
+        }
+
+        int64_t qtimeInt = parsed.lastWriteTime;
+
         bool patchLoaded = false;
         std::vector<int> dropIds;
         try
         {
-            auto exists = SQL::Statement(
-                dbh, "SELECT id, last_write_time from Patches WHERE Patches.Path LIKE ?1");
+            auto exists =
+                SQL::Statement(dbh, "SELECT id, last_write_time from Patches WHERE path = ?1");
             const auto path(p.path.u8string());
             exists.bind(1, path);
 
@@ -803,7 +1042,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Load Check");
+            db->reportError(e.what(), "PatchDB - Load Check");
             return;
         }
 
@@ -832,86 +1071,27 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Insert Patch");
+            db->reportError(e.what(), "PatchDB - Insert Patch");
             return;
         }
 
-        std::ostringstream searchName;
-        searchName << p.name << " ";
-
-        if (storage)
-        {
-            auto pTmp = p.path.parent_path();
-            std::vector<fs::path> parentFiles;
-            int maxItForSafety{0};
-            while ((pTmp != storage->userPatchesPath) &&
-                   (pTmp != storage->datapath / "patches_factory") &&
-                   (pTmp != storage->datapath / "patches_3rdparty") && !pTmp.empty() &&
-                   (pTmp != pTmp.root_directory()) && maxItForSafety < 10)
-            {
-                parentFiles.push_back(pTmp.filename());
-                pTmp = pTmp.parent_path();
-                maxItForSafety++;
-            }
-
-            if (pTmp == storage->datapath / "patches_3rdparty")
-            {
-                parentFiles.erase(parentFiles.end() - 1);
-            }
-
-            for (auto pf : parentFiles)
-            {
-                searchName << pf.u8string() << " ";
-            }
-        }
-
-        std::ifstream stream(p.path, std::ios::in | std::ios::binary);
-
-        std::vector<char> fxChunk;
-        fxChunk.resize(sizeof(sst::io::fxChunkSetCustom));
-        stream.read(fxChunk.data(), fxChunk.size());
-        if (!stream)
-        {
-            return;
-        }
-
-        auto *fxp = (sst::io::fxChunkSetCustom *)(fxChunk.data());
-        if ((mech::endian_read_int32BE(fxp->chunkMagic) != 'CcnK') ||
-            (mech::endian_read_int32BE(fxp->fxMagic) != 'FPCh') ||
-            (mech::endian_read_int32BE(fxp->fxID) != 'cjs3'))
+        if (!parsed.hasFeatures)
         {
             return;
         }
 
-        std::vector<char> patchHeaderChunk;
-        patchHeaderChunk.resize(sizeof(sst::io::patch_header));
-        stream.read(patchHeaderChunk.data(), patchHeaderChunk.size());
-        if (!stream)
-        {
-            return;
-        }
-        auto *ph = (sst::io::patch_header *)(patchHeaderChunk.data());
-        auto xmlSz = mech::endian_read_int32LE(ph->xmlsize);
-
-        if (!memcpy(ph->tag, "sub3", 4) || xmlSz < 0 || xmlSz > 1024 * 1024 * 1024)
-        {
-            std::cerr << "Skipping invalid patch : [" << p.path.u8string() << "]" << std::endl;
-            return;
-        }
+        std::ostringstream searchName;
+        searchName << parsed.searchOver;
+        bool hasAuthor{false};
+        std::string author;
 
-        std::vector<char> xmlData;
-        xmlData.resize(xmlSz);
-        stream.read(xmlData.data(), xmlData.size());
-        if (!stream)
-            return;
         try
         {
             auto ins =
                 SQL::Statement(dbh, "INSERT INTO PATCHFEATURE ( \"patch_id\", \"feature\", "
                                     "\"feature_type\", \"feature_ivalue\", \"feature_svalue\" ) "
                                     "VALUES ( ?1, ?2, ?3, ?4, ?5 )");
-            auto feat = extractFeaturesFromXML(xmlData.data());
-            for (auto f : feat)
+            for (auto f : parsed.features)
             {
                 auto ftype = std::get<0>(f);
                 ins.bindi64(1, patchid);
@@ -928,29 +1108,40 @@ CREATE TABLE IF NOT EXISTS Favorites (
                 {
                     searchName << " " << std::get<3>(f);
                 }
+                if (ftype == "AUTHOR" && !hasAuthor)
+                {
+                    hasAuthor = true;
+                    author = std::get<3>(f);
+                }
             }
 
             ins.finalize();
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - FXP Features");
+            db->reportError(e.what(), "PatchDB - FXP Features");
             return;
         }
 
         auto sns = searchName.str();
         try
         {
-            auto ins = SQL::Statement(dbh, "UPDATE PATCHES SET search_over=?1 WHERE id=?2");
+            // the author is kept on the patch too, so the searches don't have to join features
+            auto ins = SQL::Statement(dbh, hasAuthor
+                                               ? "UPDATE PATCHES SET search_over=?1, author=?3 "
+                                                 "WHERE id=?2"
+                                               : "UPDATE PATCHES SET search_over=?1 WHERE id=?2");
             ins.bind(1, sns);
             ins.bind(2, patchid);
+            if (hasAuthor)
+                ins.bind(3, author);
 
             ins.step();
             ins.finalize();
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - FXP Features");
+            db->reportError(e.what(), "PatchDB - FXP Features");
             return;
         }
     }
@@ -976,7 +1167,24 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Junk gave Junk");
+            db->reportError(e.what(), "PatchDB - Junk gave Junk");
+        }
+    }
+
+    void setPreview(const std::string &p, const std::string &pp)
+    {
+        try
+        {
+            auto there = SQL::Statement(dbh, "INSERT OR REPLACE INTO Previews "
+                                             "(\"path\", \"preview_path\") VALUES (?1, ?2)");
+            there.bind(1, p);
+            there.bind(2, pp);
+            there.step();
+            there.finalize();
+        }
+        catch (const SQL::Exception &e)
+        {
+            db->reportError(e.what(), "PatchDB - Recording Preview");
         }
     }
 
@@ -996,7 +1204,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Junk gave Junk");
+            db->reportError(e.what(), "PatchDB - Junk gave Junk");
         }
     }
 
@@ -1011,7 +1219,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Junk gave Junk");
+            db->reportError(e.what(), "PatchDB - Junk gave Junk");
         }
     }
     void addRootCategory(const std::string &name, CatType type)
@@ -1032,7 +1240,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Category Query");
+            db->reportError(e.what(), "PatchDB - Category Query");
         }
 
         try
@@ -1048,7 +1256,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Category Root Insert");
+            db->reportError(e.what(), "PatchDB - Category Root Insert");
         }
     }
 
@@ -1072,7 +1280,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Category Query");
+            db->reportError(e.what(), "PatchDB - Category Query");
         }
 
         try
@@ -1099,7 +1307,7 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - Category Root Insert");
+            db->reportError(e.what(), "PatchDB - Category Root Insert");
         }
     }
 
@@ -1124,46 +1332,412 @@ CREATE TABLE IF NOT EXISTS Favorites (
         qCV.notify_all();
     }
 
-    sqlite3 *getReadOnlyConn(bool notifyOnError = true)
+    /*
+     * Reads lease a connection from a small pool, each with the fixed statements prepared on
+     * it once and kept, so the UI reader, the message thread and anyone else reading don't
+     * queue behind one connection. A lease opens another connection when all are busy, up to
+     * maxReadConnections, and then waits for one to come back.
+     */
+    struct ReadConnection
     {
-        if (!rodbh)
-        {
-            auto flag = SQLITE_OPEN_NOMUTEX; // basically lock
-            flag |= SQLITE_OPEN_READONLY;
+        sqlite3 *conn{nullptr};
+        std::unordered_map<std::string, std::unique_ptr<SQL::Statement>> statements;
+        // as of the last cache check on this connection; see checkQueryCacheIsCurrent
+        int64_t lastDataVersion{-1};
 
-            // std::cout << ">>>RO> Opening r/o DB" << std::endl;
-            auto ec = sqlite3_open_v2(dbname.c_str(), &rodbh, flag, nullptr);
-
-            if (ec != SQLITE_OK)
+        ~ReadConnection()
+        {
+            for (auto &[sql, st] : statements)
             {
-                if (notifyOnError)
+                try
+                {
+                    st->finalize();
+                }
+                catch (const SQL::Exception &)
                 {
-                    std::ostringstream oss;
-                    oss << "An error occurred opening r/o sqlite file '" << dbname
-                        << "'. The error was '" << sqlite3_errmsg(dbh) << "'.";
-                    storage->reportError(oss.str(), "Surge Patch Database Error");
                 }
-                if (rodbh)
-                    sqlite3_close(rodbh);
-                rodbh = nullptr;
             }
+            statements.clear();
+            if (conn)
+                sqlite3_close(conn);
         }
-        return rodbh;
+    };
+
+    struct ReadLease
+    {
+        ReadLease(WriterWorker &w, bool notifyOnError = true) : w(w)
+        {
+            rc = w.leaseReadConnection(notifyOnError);
+        }
+        ~ReadLease()
+        {
+            if (rc)
+                w.returnReadConnection(rc);
+        }
+        ReadLease(const ReadLease &) = delete;
+        ReadLease &operator=(const ReadLease &) = delete;
+
+        // null if the database can't be opened
+        sqlite3 *conn() const { return rc ? rc->conn : nullptr; }
+
+        SQL::Statement *statement(const std::string &sql)
+        {
+            if (!rc)
+                return nullptr;
+
+            auto it = rc->statements.find(sql);
+            if (it != rc->statements.end())
+                return it->second.get();
+
+            auto st = std::make_unique<SQL::Statement>(rc->conn, sql);
+            auto res = st.get();
+            rc->statements[sql] = std::move(st);
+            return res;
+        }
+
+        WriterWorker &w;
+        ReadConnection *rc{nullptr};
+    };
+
+    static constexpr size_t maxReadConnections = 4;
+
+    ReadConnection *leaseReadConnection(bool notifyOnError)
+    {
+        std::unique_lock<std::mutex> lk(readPoolLock);
+
+        while (idleReadConnections.empty() && readConnections.size() >= maxReadConnections)
+            readPoolCV.wait(lk);
+
+        if (!idleReadConnections.empty())
+        {
+            auto res = idleReadConnections.back();
+            idleReadConnections.pop_back();
+            return res;
+        }
+
+        auto flag = SQLITE_OPEN_NOMUTEX; // basically lock
+        flag |= SQLITE_OPEN_READONLY;
+
+        sqlite3 *h{nullptr};
+        auto ec = sqlite3_open_v2(dbname.c_str(), &h, flag, nullptr);
+
+        if (ec != SQLITE_OK)
+        {
+            if (notifyOnError)
+            {
+                std::ostringstream oss;
+                oss << "An error occurred opening r/o sqlite file '" << dbname
+                    << "'. The error was '" << sqlite3_errmsg(h) << "'.";
+                db->reportError(oss.str(), "Surge Patch Database Error");
+            }
+            if (h)
+                sqlite3_close(h);
+            return nullptr;
+        }
+
+        readConnections.push_back(std::make_unique<ReadConnection>());
+        readConnections.back()->conn = h;
+        return readConnections.back().get();
+    }
+
+    void returnReadConnection(ReadConnection *rc)
+    {
+        {
+            std::lock_guard<std::mutex> g(readPoolLock);
+            idleReadConnections.push_back(rc);
+        }
+        readPoolCV.notify_one();
+    }
+
+    void closeReadConnections()
+    {
+        std::lock_guard<std::mutex> g(readPoolLock);
+        idleReadConnections.clear();
+        readConnections.clear();
+    }
+
+    /*
+     * The type-ahead asks for the same handful of queries over and over as someone types and
+     * deletes, so the results of the last few searches are remembered. These are only touched
+     * with cacheLock held, and copied out under it.
+     */
+    std::mutex cacheLock;
+
+    static constexpr size_t maxCachedQueries = 64;
+    std::atomic<uint64_t> writeGeneration{0};
+
+    bool cachedQuery(ReadLease &lease, const std::string &key, std::vector<patchRecord> &out)
+    {
+        std::lock_guard<std::mutex> g(cacheLock);
+        checkQueryCacheIsCurrent(lease);
+
+        for (auto it = cachedQueries.begin(); it != cachedQueries.end(); ++it)
+        {
+            if (it->first == key)
+            {
+                cachedQueries.splice(cachedQueries.begin(), cachedQueries, it);
+                out = cachedQueries.front().second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void cacheQuery(const std::string &key, const std::vector<patchRecord> &res)
+    {
+        std::lock_guard<std::mutex> g(cacheLock);
+        cachedQueries.emplace_front(key, res);
+        if (cachedQueries.size() > maxCachedQueries)
+            cachedQueries.pop_back();
+    }
+
+    /*
+     * The category tree only changes when the database does, and the browser asks for the same
+     * levels every time it's opened, so those are kept too (there are few enough not to bound).
+     */
+    bool cachedCategories(ReadLease &lease, const std::string &query, int arg,
+                          std::vector<catRecord> &out)
+    {
+        std::lock_guard<std::mutex> g(cacheLock);
+        checkQueryCacheIsCurrent(lease);
+
+        auto it = cachedCategoryLevels.find({query, arg});
+        if (it != cachedCategoryLevels.end())
+        {
+            out = it->second;
+            return true;
+        }
+        return false;
+    }
+
+    void cacheCategories(const std::string &query, int arg, const std::vector<catRecord> &res)
+    {
+        std::lock_guard<std::mutex> g(cacheLock);
+        cachedCategoryLevels[{query, arg}] = res;
     }
 
   private:
-    sqlite3 *rodbh{nullptr};
+    /*
+     * Our own writer bumps the generation when it commits; data_version catches commits
+     * from anyone else, like another process sharing the database file. data_version only
+     * means something per connection, so each connection keeps the last one it saw, and
+     * whichever first sees a change clears the cache for all of them.
+     */
+    void checkQueryCacheIsCurrent(ReadLease &lease)
+    {
+        int64_t dataVersion = -1;
+        try
+        {
+            auto *dv = lease.statement("PRAGMA data_version");
+            if (dv)
+            {
+                SQL::ResetGuard rg(*dv);
+                if (dv->step())
+                    dataVersion = dv->col_int64(0);
+            }
+        }
+        catch (const SQL::Exception &)
+        {
+        }
+
+        auto gen = writeGeneration.load();
+        auto seen = lease.rc ? lease.rc->lastDataVersion : -1;
+        if (dataVersion < 0 || dataVersion != seen || gen != cachedGeneration)
+        {
+            cachedQueries.clear();
+            cachedCategoryLevels.clear();
+            cachedGeneration = gen;
+            if (lease.rc)
+                lease.rc->lastDataVersion = dataVersion;
+        }
+    }
+
+    std::list<std::pair<std::string, std::vector<patchRecord>>> cachedQueries; // newest first
+    std::map<std::pair<std::string, int>, std::vector<catRecord>> cachedCategoryLevels;
+    uint64_t cachedGeneration{0};
+
+    std::mutex readPoolLock;
+    std::condition_variable readPoolCV;
+    std::vector<std::unique_ptr<ReadConnection>> readConnections;
+    std::vector<ReadConnection *> idleReadConnections;
+
     sqlite3 *dbh{nullptr};
-    SurgeStorage *storage;
+    PatchDB *db;
+    fs::path userPatchesPath, datapath;
+};
+/*
+ * A single thread which runs queries for the UI. Each channel holds at most one request, so a
+ * burst of keystrokes collapses to the last one, and a generation per channel lets us discard
+ * the result of a query which was superseded while it ran.
+ */
+struct PatchDB::ReaderWorker
+{
+    struct Request
+    {
+        std::function<std::vector<patchRecord>()> query;
+        asyncQueryCallback_t onDone;
+        uint64_t generation{0};
+    };
+
+    ReaderWorker() : qThread([this]() { loop(); }) {}
+
+    ~ReaderWorker()
+    {
+        {
+            std::lock_guard<std::mutex> g(qLock);
+            keepRunning = false;
+        }
+        qCV.notify_all();
+        qThread.join();
+    }
+
+    void enqueue(const std::string &channel, Request r)
+    {
+        {
+            std::lock_guard<std::mutex> g(qLock);
+            r.generation = ++generations[channel];
+            pending[channel] = std::move(r);
+        }
+        qCV.notify_all();
+    }
+
+    void cancel(const std::string &channel)
+    {
+        std::lock_guard<std::mutex> g(qLock);
+        ++generations[channel];
+        pending.erase(channel);
+    }
+
+    void loop()
+    {
+        while (true)
+        {
+            std::string channel;
+            Request r;
+
+            {
+                std::unique_lock<std::mutex> lk(qLock);
+                qCV.wait(lk, [this]() { return !keepRunning || !pending.empty(); });
+
+                if (!keepRunning)
+                    return;
+
+                auto it = pending.begin();
+                channel = it->first;
+                r = std::move(it->second);
+                pending.erase(it);
+            }
+
+            auto res = r.query();
+
+            {
+                std::lock_guard<std::mutex> g(qLock);
+                if (!keepRunning)
+                    return;
+                if (generations[channel] != r.generation)
+                    continue;
+            }
+
+            r.onDone(std::move(res));
+        }
+    }
+
+    std::mutex qLock;
+    std::condition_variable qCV;
+    std::map<std::string, Request> pending;
+    std::map<std::string, uint64_t> generations;
+    bool keepRunning{true};
+    std::thread qThread; // last, so everything above exists before the thread starts
+};
+
+namespace
+{
+struct PatchDBRegistry
+{
+    std::mutex lock;
+    std::map<std::string, std::weak_ptr<PatchDB>> byKey;
+
+    static PatchDBRegistry &get()
+    {
+        static PatchDBRegistry instance;
+        return instance;
+    }
 };
-PatchDB::PatchDB(SurgeStorage *s) : storage(s) { initialize(); }
+} // namespace
+
+std::shared_ptr<PatchDB> PatchDB::acquire(SurgeStorage *s)
+{
+    // a database indexes one set of factory libraries into one user's file
+    auto key = path_to_string(s->userDataPath) + "\n" + path_to_string(s->datapath);
+
+    auto &reg = PatchDBRegistry::get();
+    std::lock_guard<std::mutex> g(reg.lock);
+
+    auto res = reg.byKey[key].lock();
+    if (res)
+    {
+        std::lock_guard<std::mutex> sg(res->storagesLock);
+        res->storages.push_back(s);
+    }
+    else
+    {
+        res = std::make_shared<PatchDB>(s);
+        reg.byKey[key] = res;
+    }
+    return res;
+}
+
+void PatchDB::detachStorage(SurgeStorage *s)
+{
+    std::lock_guard<std::mutex> g(storagesLock);
+    storages.erase(std::remove(storages.begin(), storages.end(), s), storages.end());
+}
 
-PatchDB::~PatchDB() = default;
+bool PatchDB::claimIndexing(bool force)
+{
+    if (force)
+    {
+        indexed = true;
+        return true;
+    }
+    return !indexed.exchange(true);
+}
+
+void PatchDB::reportError(const std::string &msg, const std::string &title)
+{
+    // held throughout, so the storage can't detach and go while we're using it
+    std::lock_guard<std::mutex> g(storagesLock);
+    if (storages.empty())
+    {
+        std::cerr << title << ": " << msg << std::endl;
+        return;
+    }
+    storages.front()->reportError(msg, title);
+}
+
+std::string PatchDB::channelFor(const SurgeStorage *s, const std::string &name)
+{
+    std::ostringstream oss;
+    oss << name << "-" << (const void *)s;
+    return oss.str();
+}
+
+PatchDB::PatchDB(SurgeStorage *s)
+{
+    storages.push_back(s);
+    initialize();
+}
+
+PatchDB::~PatchDB()
+{
+    // The reader uses the worker's read connection, so make sure it has stopped first
+    reader.reset();
+}
 
 void PatchDB::initialize()
 {
     if (!worker)
-        worker = std::make_unique<WriterWorker>(storage);
+        worker = std::make_unique<WriterWorker>(this, storages.front());
 }
 void PatchDB::prepareForWrites() { worker->openForWrite(); }
 
@@ -1200,16 +1774,20 @@ std::vector<std::pair<std::string, int>> PatchDB::readAllFeatures()
     std::string query = "SELECT DISTINCT feature, feature_type from PatchFeature order by feature";
     try
     {
-        auto q = SQL::Statement(worker->getReadOnlyConn(), query);
-        while (q.step())
+        WriterWorker::ReadLease lease(*worker);
+        auto *q = lease.statement(query);
+        if (!q)
+            return res;
+
+        SQL::ResetGuard rg(*q);
+        while (q->step())
         {
-            res.emplace_back(q.col_str(0), q.col_int(1));
+            res.emplace_back(q->col_str(0), q->col_int(1));
         }
-        q.finalize();
     }
     catch (SQL::Exception &e)
     {
-        storage->reportError(e.what(), "PatchDB - readFeatures");
+        reportError(e.what(), "PatchDB - readFeatures");
     }
     return res;
 }
@@ -1224,17 +1802,21 @@ std::vector<std::string> PatchDB::readAllFeatureValueString(const std::string &f
                         " order by feature_svalue";
     try
     {
-        auto q = SQL::Statement(worker->getReadOnlyConn(), query);
-        q.bind(1, feature);
-        while (q.step())
+        WriterWorker::ReadLease lease(*worker);
+        auto *q = lease.statement(query);
+        if (!q)
+            return res;
+
+        SQL::ResetGuard rg(*q);
+        q->bind(1, feature);
+        while (q->step())
         {
-            res.emplace_back(q.col_str(0));
+            res.emplace_back(q->col_str(0));
         }
-        q.finalize();
     }
     catch (SQL::Exception &e)
     {
-        storage->reportError(e.what(), "PatchDB - readFeatures");
+        reportError(e.what(), "PatchDB - readFeatures");
     }
     return res;
 }
@@ -1249,52 +1831,59 @@ std::vector<int> PatchDB::readAllFeatureValueInt(const std::string &feature)
                         " order by feature_ivalue";
     try
     {
-        auto q = SQL::Statement(worker->getReadOnlyConn(), query);
-        q.bind(1, feature);
-        while (q.step())
+        WriterWorker::ReadLease lease(*worker);
+        auto *q = lease.statement(query);
+        if (!q)
+            return res;
+
+        SQL::ResetGuard rg(*q);
+        q->bind(1, feature);
+        while (q->step())
         {
-            res.emplace_back(q.col_int(0));
+            res.emplace_back(q->col_int(0));
         }
-        q.finalize();
     }
     catch (SQL::Exception &e)
     {
-        storage->reportError(e.what(), "PatchDB - readFeatures");
+        reportError(e.what(), "PatchDB - readFeatures");
     }
     return res;
 }
 
-// FIXME - push to worker perhaps?
 std::vector<PatchDB::patchRecord> PatchDB::rawQueryForNameLike(const std::string &nameLikeThisP)
 {
     std::vector<PatchDB::patchRecord> res;
 
-    // FIXME - cache this by pushing it to the worker
-    std::string query = "select p.id, p.path, p.category, p.name, pf.feature_svalue from Patches "
-                        "as p, PatchFeature as pf where pf.patch_id == p.id and pf.feature LIKE "
-                        "'AUTHOR' and p.name LIKE ? ORDER BY p.category_type, p.category, p.name";
+    std::string query = "select p.id, p.path, p.category, p.name, p.author from Patches as p "
+                        "where p.author IS NOT NULL and p.name LIKE ? "
+                        "ORDER BY p.category_type, p.category, p.name";
 
     try
     {
-        auto conn = worker->getReadOnlyConn(false);
-        if (!conn)
+        WriterWorker::ReadLease lease(*worker, false);
+        auto key = "NAME=" + nameLikeThisP;
+        if (worker->cachedQuery(lease, key, res))
             return res;
 
-        auto q = SQL::Statement(conn, query);
+        auto *q = lease.statement(query);
+        if (!q)
+            return res;
+
+        SQL::ResetGuard rg(*q);
         std::string nameLikeThis = "%" + nameLikeThisP + "%";
-        q.bind(1, nameLikeThis);
+        q->bind(1, nameLikeThis);
 
-        while (q.step())
+        while (q->step())
         {
-            int id = q.col_int(0);
-            auto path = q.col_str(1);
-            auto cat = q.col_str(2);
-            auto name = q.col_str(3);
-            auto auth = q.col_str(4);
+            int id = q->col_int(0);
+            auto path = q->col_str(1);
+            auto cat = q->col_str(2);
+            auto name = q->col_str(3);
+            auto auth = q->col_str(4);
             res.emplace_back(id, path, cat, name, auth);
         }
 
-        q.finalize();
+        worker->cacheQuery(key, res);
     }
     catch (SQL::Exception &e)
     {
@@ -1304,7 +1893,7 @@ std::vector<PatchDB::patchRecord> PatchDB::rawQueryForNameLike(const std::string
         }
         else
         {
-            storage->reportError(e.what(), "PatchDB - rawQueryForNameLike");
+            reportError(e.what(), "PatchDB - rawQueryForNameLike");
         }
     }
 
@@ -1320,7 +1909,6 @@ std::vector<PatchDB::catRecord> PatchDB::rootCategoriesForType(const CatType t)
 
 std::vector<PatchDB::catRecord> PatchDB::childCategoriesOf(int catId)
 {
-    // FIXME - cache this by pushing it to the worker
     std::string query = "select c.id, c.name, c.leaf_name, c.isroot, c.type from Category "
                         "as c where c.parent_id = ?";
     return internalCategories((int)catId, query);
@@ -1332,42 +1920,48 @@ std::vector<PatchDB::catRecord> PatchDB::internalCategories(int t, const std::st
 
     try
     {
-        auto q = SQL::Statement(worker->getReadOnlyConn(), query);
-        q.bind(1, t);
+        WriterWorker::ReadLease lease(*worker);
+        if (worker->cachedCategories(lease, query, t, res))
+            return res;
+
+        auto *q = lease.statement(query);
+        if (!q)
+            return res;
 
-        while (q.step())
         {
-            auto cr = catRecord();
-            cr.id = q.col_int(0);
-            cr.name = q.col_str(1);
-            cr.leaf_name = q.col_str(2);
-            cr.isroot = q.col_int(3);
-            cr.type = (CatType)q.col_int(4);
-            cr.isleaf = false;
+            SQL::ResetGuard rg(*q);
+            q->bind(1, t);
 
-            res.push_back(cr);
+            while (q->step())
+            {
+                auto cr = catRecord();
+                cr.id = q->col_int(0);
+                cr.name = q->col_str(1);
+                cr.leaf_name = q->col_str(2);
+                cr.isroot = q->col_int(3);
+                cr.type = (CatType)q->col_int(4);
+                cr.isleaf = false;
+
+                res.push_back(cr);
+            }
         }
 
-        q.finalize();
-
-        auto par = SQL::Statement(worker->getReadOnlyConn(),
-                                  "select COUNT(id) from category where category.parent_id = ?");
+        auto *par = lease.statement("select COUNT(id) from category where category.parent_id = ?");
         for (auto &cr : res)
         {
-            par.bind(1, cr.id);
-            if (par.step())
+            SQL::ResetGuard rg(*par);
+            par->bind(1, cr.id);
+            if (par->step())
             {
-                cr.isleaf = (par.col_int(0) == 0);
+                cr.isleaf = (par->col_int(0) == 0);
             }
-            par.clearBindings();
-            par.reset();
         }
 
-        par.finalize();
+        worker->cacheCategories(query, t, res);
     }
     catch (SQL::Exception &e)
     {
-        storage->reportError(e.what(), "PatchDB - Loading Categories");
+        reportError(e.what(), "PatchDB - Loading Categories");
     }
 
     return res;
@@ -1379,6 +1973,12 @@ void PatchDB::setUserFavorite(const std::string &path, bool isIt)
     worker->enqueueWorkItem(new WriterWorker::EnQFavorite(path, isIt));
 }
 
+void PatchDB::setPatchPreview(const std::string &path, const std::string &previewPath)
+{
+    prepareForWrites();
+    worker->enqueueWorkItem(new WriterWorker::EnQPreview(path, previewPath));
+}
+
 void PatchDB::erasePatchByID(int id)
 {
     prepareForWrites();
@@ -1387,7 +1987,8 @@ void PatchDB::erasePatchByID(int id)
 
 std::vector<std::string> PatchDB::readUserFavorites()
 {
-    auto conn = worker->getReadOnlyConn(false);
+    WriterWorker::ReadLease lease(*worker, false);
+    auto conn = lease.conn();
     if (!conn)
         return std::vector<std::string>();
     try
@@ -1416,17 +2017,44 @@ std::vector<std::string> PatchDB::readUserFavorites()
     catch (SQL::Exception &e)
     {
         // This error really doesn't matter most of the time
-        storage->reportError(e.what(), "PatchDB - Loading Favorites");
+        reportError(e.what(), "PatchDB - Loading Favorites");
     }
     return std::vector<std::string>();
 }
 
+std::string PatchDB::readPatchPreview(const std::string &path)
+{
+    WriterWorker::ReadLease lease(*worker, false);
+    auto conn = lease.conn();
+    if (!conn)
+        return {};
+
+    try
+    {
+        std::string res;
+        auto st = SQL::Statement(conn, "select preview_path from Previews where path = ?1;");
+        st.bind(1, path);
+        while (st.step())
+        {
+            res = st.col_str(0);
+        }
+        st.finalize();
+        return res;
+    }
+    catch (SQL::Exception &)
+    {
+        // a database from before previews has no table for them, which just means no preview
+    }
+    return {};
+}
+
 std::unordered_map<std::string, std::pair<int, int64_t>>
 PatchDB::readAllPatchPathsWithIdAndModTime()
 {
     std::unordered_map<std::string, std::pair<int, int64_t>> res;
 
-    auto conn = worker->getReadOnlyConn(false);
+    WriterWorker::ReadLease lease(*worker, false);
+    auto conn = lease.conn();
     if (!conn)
         return res;
 
@@ -1445,7 +2073,7 @@ PatchDB::readAllPatchPathsWithIdAndModTime()
     catch (SQL::Exception &e)
     {
         // This error really doesn't matter most of the time
-        storage->reportError(e.what(), "PatchDB - Loading Favorites");
+        reportError(e.what(), "PatchDB - Loading Favorites");
     }
     return res;
 }
@@ -1456,6 +2084,8 @@ int PatchDB::numberOfJobsOutstanding()
     return worker->pathQ.size();
 }
 
+int64_t PatchDB::memoryInUse() { return sqlite3_memory_used(); }
+
 int PatchDB::waitForJobsOutstandingComplete(int maxWaitInMS)
 {
     int maxIts = maxWaitInMS / 10;
@@ -1536,17 +2166,23 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
 {
     std::vector<PatchDB::patchRecord> res;
 
-    // FIXME - cache this by pushing it to the worker
-    std::string query = "select p.id, p.path, p.category as category, p.name, pf.feature_svalue as "
-                        "author, p.search_over from Patches "
-                        "as p, PatchFeature as pf where pf.patch_id == p.id and pf.feature LIKE "
-                        "'AUTHOR' and " +
-                        sqlWhereClauseFor(t) + " ORDER BY p.category_type, p.category, p.name";
+    /*
+     * The where clause has the search terms in it, so there's nothing to gain keeping these
+     * prepared; the results are what we keep instead, keyed by the clause
+     */
+    auto where = sqlWhereClauseFor(t);
+    std::string query = "select p.id, p.path, p.category as category, p.name, p.author as "
+                        "author, p.search_over from Patches as p where p.author IS NOT NULL and " +
+                        where + " ORDER BY p.category_type, p.category, p.name";
 
     // std::cout << "QUERY IS \n" << query << "\n";
     try
     {
-        auto conn = worker->getReadOnlyConn(false);
+        WriterWorker::ReadLease lease(*worker, false);
+        if (worker->cachedQuery(lease, where, res))
+            return res;
+
+        auto conn = lease.conn();
         if (!conn)
             return res;
 
@@ -1563,6 +2199,7 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
         }
 
         q.finalize();
+        worker->cacheQuery(where, res);
     }
     catch (SQL::Exception &e)
     {
@@ -1572,12 +2209,46 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
         }
         else
         {
-            storage->reportError(e.what(), "PatchDB - rawQueryForNameLike");
+            reportError(e.what(), "PatchDB - rawQueryForNameLike");
         }
     }
 
     return res;
 }
 
+void PatchDB::enqueueAsyncQuery(const std::string &channel,
+                                std::function<std::vector<patchRecord>()> query,
+                                asyncQueryCallback_t onDone)
+{
+    if (!reader)
+        reader = std::make_unique<ReaderWorker>();
+
+    auto r = ReaderWorker::Request();
+    r.query = std::move(query);
+    r.onDone = std::move(onDone);
+    reader->enqueue(channel, std::move(r));
+}
+
+void PatchDB::queryFromQueryStringAsync(const std::string &channel, const std::string &query,
+                                        asyncQueryCallback_t onDone)
+{
+    enqueueAsyncQuery(
+        channel, [this, query]() { return queryFromQueryString(query); }, std::move(onDone));
+}
+
+void PatchDB::rawQueryForNameLikeAsync(const std::string &channel, const std::string &nameLikeThis,
+                                       asyncQueryCallback_t onDone)
+{
+    enqueueAsyncQuery(
+        channel, [this, nameLikeThis]() { return rawQueryForNameLike(nameLikeThis); },
+        std::move(onDone));
+}
+
+void PatchDB::cancelAsyncQueries(const std::string &channel)
+{
+    if (reader)
+        reader->cancel(channel);
+}
+
 } // namespace PatchStorage
 } // namespace Surge
@@ -31,6 +31,9 @@
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 class SurgeStorage;
 
@@ -68,6 +71,7 @@ struct PatchDBQueryParser
 struct PatchDB
 {
     struct WriterWorker;
+    struct ReaderWorker;
     struct patchRecord
     {
         patchRecord(int i, const std::string &f, const std::string &c, const std::string &n,
@@ -100,15 +104,31 @@ struct PatchDB
         CatType type;
     };
 
+    /*
+     * Every storage in the process with the same user and factory data gets the same PatchDB,
+     * so forty instances share one writer thread and one set of connections rather than
+     * each starting their own and fighting over the file's write lock. The database runs in
+     * WAL mode, so reads carry on while the writer commits. Errors go to the longest
+     * attached storage still around.
+     */
+    static std::shared_ptr<PatchDB> acquire(SurgeStorage *);
+    // a storage calls this as it goes away, since the others may keep the database open
+    void detachStorage(SurgeStorage *);
+
+    // true once per database, or on every forced rescan, for whoever should index the patches
+    bool claimIndexing(bool force);
+
+    // use acquire() rather than making one of these yourself
     explicit PatchDB(SurgeStorage *);
     ~PatchDB();
 
     void initialize();
     void prepareForWrites();
 
-    SurgeStorage *storage;
+    void reportError(const std::string &msg, const std::string &title);
 
     std::unique_ptr<WriterWorker> worker;
+    std::unique_ptr<ReaderWorker> reader;
 
     // Write APIs
     void considerFXPForLoad(const fs::path &fxp, const std::string &name,
@@ -117,6 +137,8 @@ struct PatchDB
     void addSubCategory(const std::string &name, const std::string &parent, CatType type);
     void addDebugMessage(const std::string &debug);
     void setUserFavorite(const std::string &path, bool isIt);
+    // see PatchPreview.h; these survive a rebuild of the database, as favorites do
+    void setPatchPreview(const std::string &path, const std::string &previewPath);
     void erasePatchByID(int id);
     void doAfterCurrentQueueDrained(std::function<void()> op);
 
@@ -131,11 +153,19 @@ struct PatchDB
      */
     int waitForJobsOutstandingComplete(int maxWaitInMS);
 
+    /*
+     * The bytes sqlite holds for its connections and page caches. sqlite keeps the one heap for
+     * the whole process, so with several instances loaded this is every instance's database.
+     */
+    static int64_t memoryInUse();
+
     // Query APIs
     std::vector<std::pair<std::string, int>> readAllFeatures();
     std::vector<std::string> readAllFeatureValueString(const std::string &feature);
     std::vector<int> readAllFeatureValueInt(const std::string &feature);
     std::vector<std::string> readUserFavorites();
+    // the preview file recorded for a patch, or empty
+    std::string readPatchPreview(const std::string &path);
 
     std::unordered_map<std::string, std::pair<int, int64_t>> readAllPatchPathsWithIdAndModTime();
 
@@ -153,8 +183,33 @@ struct PatchDB
     std::vector<catRecord> rootCategoriesForType(const CatType t);
     std::vector<catRecord> childCategoriesOf(int catId);
 
+    /*
+     * The same queries, run on the PatchDB's reader thread so a big library never stalls the
+     * caller. Requests are made on a named channel (one per search box, say) and a new request
+     * supersedes whatever that channel had outstanding: one that hasn't started is dropped, and
+     * one already running has its result thrown away. onDone is called on the reader thread,
+     * so UI callers need to bounce back to their own thread and should still check they want
+     * the answer when they get there. Every instance shares the reader, so make the channel
+     * with channelFor, which keeps one instance's searches from superseding another's.
+     */
+    static std::string channelFor(const SurgeStorage *, const std::string &name);
+    typedef std::function<void(std::vector<patchRecord> &&)> asyncQueryCallback_t;
+    void queryFromQueryStringAsync(const std::string &channel, const std::string &query,
+                                   asyncQueryCallback_t onDone);
+    void rawQueryForNameLikeAsync(const std::string &channel, const std::string &nameLikeThis,
+                                  asyncQueryCallback_t onDone);
+    void cancelAsyncQueries(const std::string &channel);
+
   private:
+    void enqueueAsyncQuery(const std::string &channel,
+                           std::function<std::vector<patchRecord>()> query,
+                           asyncQueryCallback_t onDone);
+
     std::vector<catRecord> internalCategories(int arg, const std::string &query);
+
+    std::mutex storagesLock;
+    std::vector<SurgeStorage *> storages; // in the order they attached
+    std::atomic<bool> indexed{false};
 };
 
 } // namespace PatchStorage
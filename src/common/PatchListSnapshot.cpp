@@ -0,0 +1,390 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "PatchListSnapshot.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace Surge
+{
+namespace Storage
+{
+namespace
+{
+constexpr char snapshotTag[4] = {'s', 'p', 'l', 's'};
+constexpr uint32_t snapshotVersion = 1;
+
+// anything bigger than these is a damaged file rather than a big library
+constexpr uint64_t maxSnapshotEntries = 1ULL << 24;
+constexpr uint64_t maxSnapshotString = 1ULL << 16;
+constexpr int maxCategoryDepth = 64;
+
+struct Writer
+{
+    std::string out;
+
+    void bytes(const void *d, size_t n) { out.append(reinterpret_cast<const char *>(d), n); }
+    template <typename T> void value(T v) { bytes(&v, sizeof(T)); }
+    void string(const std::string &s)
+    {
+        value((uint64_t)s.size());
+        bytes(s.data(), s.size());
+    }
+    void path(const fs::path &p) { string(path_to_string(p)); }
+
+    void category(const PatchCategory &c)
+    {
+        string(c.name);
+        value((int32_t)c.order);
+        value((uint8_t)c.isRoot);
+        value((uint8_t)c.isFactory);
+        value((int32_t)c.internalid);
+        value((int32_t)c.numberOfPatchesInCategory);
+        value((int32_t)c.numberOfPatchesInCategoryAndChildren);
+        value((uint64_t)c.children.size());
+        for (const auto &k : c.children)
+            category(k);
+    }
+};
+
+struct Reader
+{
+    const std::string &in;
+    size_t pos{0};
+    bool ok{true};
+
+    explicit Reader(const std::string &s) : in(s) {}
+
+    bool bytes(void *d, size_t n)
+    {
+        if (!ok || n > in.size() - pos)
+            return ok = false;
+        memcpy(d, in.data() + pos, n);
+        pos += n;
+        return true;
+    }
+    template <typename T> T value()
+    {
+        T v{};
+        bytes(&v, sizeof(T));
+        return v;
+    }
+    uint64_t count(uint64_t limit)
+    {
+        auto n = value<uint64_t>();
+        if (n > limit)
+            ok = false;
+        return ok ? n : 0;
+    }
+    std::string string()
+    {
+        std::string s(count(maxSnapshotString), '\0');
+        bytes(s.data(), s.size());
+        return s;
+    }
+    fs::path path() { return string_to_path(string()); }
+
+    void category(PatchCategory &c, int depth)
+    {
+        if (depth > maxCategoryDepth)
+        {
+            ok = false;
+            return;
+        }
+
+        c.name = string();
+        c.order = value<int32_t>();
+        c.isRoot = value<uint8_t>() != 0;
+        c.isFactory = value<uint8_t>() != 0;
+        c.internalid = value<int32_t>();
+        c.numberOfPatchesInCategory = value<int32_t>();
+        c.numberOfPatchesInCategoryAndChildren = value<int32_t>();
+        c.children.resize(count(maxSnapshotEntries));
+        for (auto &k : c.children)
+        {
+            if (!ok)
+                break;
+            category(k, depth + 1);
+        }
+    }
+};
+
+struct SharedSnapshots
+{
+    std::mutex lock;
+    std::map<std::string, std::shared_ptr<const PatchListSnapshot>> byKey;
+};
+
+SharedSnapshots &sharedSnapshots()
+{
+    static SharedSnapshots s;
+    return s;
+}
+} // namespace
+
+int64_t directoryModTime(const fs::path &p)
+{
+    std::error_code ec;
+
+    if (!fs::is_directory(p, ec) || ec)
+        return PatchListSnapshot::absentDirectory;
+
+    auto t = (int64_t)fs::last_write_time(p, ec).time_since_epoch().count();
+
+    if (ec || t == PatchListSnapshot::unreadableDirectory)
+        return PatchListSnapshot::absentDirectory;
+
+    return t;
+}
+
+bool PatchListSnapshot::isCurrent() const
+{
+    for (const auto &[p, t] : directories)
+    {
+        if (t == unreadableDirectory || directoryModTime(p) != t)
+            return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const PatchListSnapshot> findPatchListSnapshot(const std::string &key,
+                                                               const fs::path &file)
+{
+    auto &shared = sharedSnapshots();
+    std::shared_ptr<const PatchListSnapshot> res;
+
+    {
+        std::lock_guard<std::mutex> g(shared.lock);
+        auto it = shared.byKey.find(key);
+        if (it != shared.byKey.end())
+            res = it->second;
+    }
+
+    if (res)
+        return res->isCurrent() ? res : nullptr;
+
+    if (file.empty())
+        return nullptr;
+
+    auto s = std::make_shared<PatchListSnapshot>();
+
+    if (!readPatchListSnapshot(file, key, *s) || !s->isCurrent())
+        return nullptr;
+
+    {
+        // someone may have walked the folders while we were reading, and theirs is newer
+        std::lock_guard<std::mutex> g(shared.lock);
+        auto &slot = shared.byKey[key];
+        if (!slot)
+            slot = s;
+        res = slot;
+    }
+
+    return res;
+}
+
+void publishPatchListSnapshot(const std::string &key,
+                              const std::shared_ptr<const PatchListSnapshot> &snapshot,
+                              const fs::path &file)
+{
+    if (!snapshot)
+        return;
+
+    {
+        auto &shared = sharedSnapshots();
+        std::lock_guard<std::mutex> g(shared.lock);
+        shared.byKey[key] = snapshot;
+    }
+
+    if (!file.empty())
+        writePatchListSnapshot(file, key, *snapshot);
+}
+
+bool readPatchListSnapshot(const fs::path &file, const std::string &key, PatchListSnapshot &s)
+{
+    std::string data;
+    {
+        std::ifstream f(file, std::ios::binary);
+        if (!f)
+            return false;
+
+        std::ostringstream oss;
+        oss << f.rdbuf();
+        data = oss.str();
+    }
+
+    Reader r(data);
+
+    char tag[4];
+    r.bytes(tag, sizeof(tag));
+    auto version = r.value<uint32_t>();
+
+    if (!r.ok || memcmp(tag, snapshotTag, sizeof(tag)) != 0 || version != snapshotVersion ||
+        r.string() != key || !r.ok)
+    {
+        return false;
+    }
+
+    s.directories.resize(r.count(maxSnapshotEntries));
+    for (auto &[p, t] : s.directories)
+    {
+        p = r.path();
+        t = r.value<int64_t>();
+    }
+
+    s.items.resize(r.count(maxSnapshotEntries));
+    for (auto &e : s.items)
+    {
+        e.name = r.string();
+        e.path = r.path();
+        e.lastModTime = r.value<uint64_t>();
+        e.category = r.value<int32_t>();
+        e.order = r.value<int32_t>();
+        e.isFavorite = false;
+    }
+
+    s.categories.resize(r.count(maxSnapshotEntries));
+    for (auto &c : s.categories)
+        r.category(c, 0);
+
+    s.firstThirdPartyCategory = r.value<int32_t>();
+    s.firstUserCategory = r.value<int32_t>();
+
+    s.ordering.resize(r.count(maxSnapshotEntries));
+    for (auto &o : s.ordering)
+        o = r.value<int32_t>();
+
+    s.categoryOrdering.resize(r.count(maxSnapshotEntries));
+    for (auto &o : s.categoryOrdering)
+        o = r.value<int32_t>();
+
+    if (!r.ok || r.pos != data.size())
+        return false;
+
+    // the rest of SurgeStorage indexes with these without checking, so make sure they fit
+    int ni = s.items.size(), nc = s.categories.size();
+
+    if (s.ordering.size() != s.items.size() || s.categoryOrdering.size() != s.categories.size() ||
+        s.firstThirdPartyCategory < 0 || s.firstThirdPartyCategory > s.firstUserCategory ||
+        s.firstUserCategory > nc)
+    {
+        return false;
+    }
+
+    for (const auto &e : s.items)
+        if (e.category < 0 || e.category >= nc || e.order < 0 || e.order >= ni)
+            return false;
+    for (const auto &c : s.categories)
+        if (c.internalid < 0 || c.internalid >= nc || c.order < 0 || c.order >= nc)
+            return false;
+    for (auto o : s.ordering)
+        if (o < 0 || o >= ni)
+            return false;
+    for (auto o : s.categoryOrdering)
+        if (o < 0 || o >= nc)
+            return false;
+
+    return true;
+}
+
+bool writePatchListSnapshot(const fs::path &file, const std::string &key,
+                            const PatchListSnapshot &s)
+{
+    Writer w;
+
+    w.bytes(snapshotTag, sizeof(snapshotTag));
+    w.value(snapshotVersion);
+    w.string(key);
+
+    w.value((uint64_t)s.directories.size());
+    for (const auto &[p, t] : s.directories)
+    {
+        w.path(p);
+        w.value((int64_t)t);
+    }
+
+    w.value((uint64_t)s.items.size());
+    for (const auto &e : s.items)
+    {
+        w.string(e.name);
+        w.path(e.path);
+        w.value((uint64_t)e.lastModTime);
+        w.value((int32_t)e.category);
+        w.value((int32_t)e.order);
+    }
+
+    w.value((uint64_t)s.categories.size());
+    for (const auto &c : s.categories)
+        w.category(c);
+
+    w.value((int32_t)s.firstThirdPartyCategory);
+    w.value((int32_t)s.firstUserCategory);
+
+    w.value((uint64_t)s.ordering.size());
+    for (auto o : s.ordering)
+        w.value((int32_t)o);
+
+    w.value((uint64_t)s.categoryOrdering.size());
+    for (auto o : s.categoryOrdering)
+        w.value((int32_t)o);
+
+    /*
+     * As with the wavetable cache, write a file of our own and move it into place so that
+     * another instance starting up never reads half a snapshot
+     */
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto temp = file;
+    temp += "." + std::to_string((uint64_t)stamp ^ (uint64_t)(uintptr_t)&s) + ".tmp";
+
+    bool ok = false;
+    {
+        std::filebuf f;
+
+        if (!f.open(temp, std::ios::binary | std::ios::out | std::ios::trunc))
+            return false;
+
+        ok = f.sputn(w.out.data(), w.out.size()) == (std::streamsize)w.out.size();
+        ok = f.close() && ok;
+    }
+
+    std::error_code ec;
+
+    if (ok)
+    {
+        fs::rename(temp, file, ec);
+        ok = !ec;
+    }
+
+    if (!ok)
+        fs::remove(temp, ec);
+
+    return ok;
+}
+} // namespace Storage
+} // namespace Surge
@@ -0,0 +1,93 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_PATCHLISTSNAPSHOT_H
+#define SURGE_SRC_COMMON_PATCHLISTSNAPSHOT_H
+
+#include "filesystem/import.h"
+#include "SurgeStorage.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * The result of walking the patch or wavetable folders, kept so that the next instance
+ * doesn't have to walk and sort them again. A DAW opening a project with dozens of Surges
+ * otherwise scans the same few thousand files once per instance.
+ *
+ * A snapshot remembers every directory the walk went through along with its modification
+ * time. Adding, removing or renaming anything in a directory moves its time, so if all of
+ * them still match, a new walk would find exactly what the snapshot holds. A root which
+ * didn't exist is remembered as absent, so that creating it also invalidates.
+ *
+ * Snapshots are shared by every SurgeStorage in the process and, if given a file, also
+ * written to disk so that the first instance of the next session can start from one. The
+ * file is native byte order and versioned; anything that doesn't read back cleanly or is
+ * for another set of folders is ignored and we just walk the folders.
+ */
+struct PatchListSnapshot
+{
+    // absentDirectory if the path wasn't a directory, unreadableDirectory if the walk failed
+    static constexpr int64_t absentDirectory = -1;
+    static constexpr int64_t unreadableDirectory = INT64_MIN;
+
+    std::vector<std::pair<fs::path, int64_t>> directories;
+
+    std::vector<Patch> items;
+    std::vector<PatchCategory> categories;
+    int firstThirdPartyCategory{0}, firstUserCategory{0};
+    std::vector<int> ordering, categoryOrdering;
+
+    // one stat per directory
+    bool isCurrent() const;
+};
+
+// never unreadableDirectory, so a failed walk never validates
+int64_t directoryModTime(const fs::path &p);
+
+/*
+ * The current snapshot for key, from this process if someone has published one and
+ * otherwise from file if that is non-empty. Returns nullptr if there is none or it no
+ * longer matches the folders.
+ */
+std::shared_ptr<const PatchListSnapshot> findPatchListSnapshot(const std::string &key,
+                                                               const fs::path &file);
+// replaces the snapshot for key in this process and writes it to file if that is non-empty
+void publishPatchListSnapshot(const std::string &key,
+                              const std::shared_ptr<const PatchListSnapshot> &snapshot,
+                              const fs::path &file);
+
+bool readPatchListSnapshot(const fs::path &file, const std::string &key, PatchListSnapshot &s);
+bool writePatchListSnapshot(const fs::path &file, const std::string &key,
+                            const PatchListSnapshot &s);
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PATCHLISTSNAPSHOT_H
@@ -0,0 +1,237 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "PatchParameterBlock.h"
+#include "sst/basic-blocks/mechanics/endian-ops.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace mech = sst::basic_blocks::mechanics;
+
+namespace Surge
+{
+namespace Storage
+{
+namespace
+{
+constexpr char blockTag[4] = {'s', 'b', 'p', 'b'};
+constexpr uint32_t blockVersion = 1;
+
+constexpr char parametersOpen[] = "<parameters>";
+constexpr char parametersClose[] = "</parameters>";
+constexpr size_t parametersOpenBytes = sizeof(parametersOpen) - 1;
+constexpr size_t parametersCloseBytes = sizeof(parametersClose) - 1;
+
+/*
+ * Everything is little endian 32 bit words, like the rest of the patch container. After
+ * the tag, the header is version, revision, the table hash in two words, the XML range and
+ * the two counts. A parameter is its value, type and deform type and then the one byte
+ * attributes packed four to a word; a routing is one word per field.
+ */
+constexpr size_t headerWords = 8;
+constexpr size_t parameterWords = 6;
+constexpr size_t routingWords = 6;
+
+// well past the few thousand parameters and routings a patch can have
+constexpr uint32_t maxBlockEntries = 1 << 20;
+
+struct Writer
+{
+    std::string &out;
+
+    void word(uint32_t w)
+    {
+        uint32_t le = mech::endian_write_int32LE(w);
+        out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+    }
+    void signedWord(int32_t w) { word((uint32_t)w); }
+};
+
+struct Reader
+{
+    const char *d;
+    size_t pos{0};
+
+    uint32_t word()
+    {
+        uint32_t le;
+        memcpy(&le, d + pos, sizeof(le));
+        pos += sizeof(le);
+        return mech::endian_read_int32LE(le);
+    }
+    int32_t signedWord() { return (int32_t)word(); }
+};
+
+// four attributes which each fit a byte, absent included
+uint32_t packAttributes(int a, int b, int c, int d)
+{
+    auto byte = [](int v) { return (uint32_t)(uint8_t)(int8_t)v; };
+    return byte(a) | byte(b) << 8 | byte(c) << 16 | byte(d) << 24;
+}
+int unpackAttribute(uint32_t w, int which) { return (int8_t)(uint8_t)(w >> (which * 8)); }
+} // namespace
+
+void ParameterBlock::write(std::string &out, int revision, uint64_t tableHash) const
+{
+    Writer w{out};
+
+    out.reserve(out.size() + sizeof(blockTag) +
+                sizeof(uint32_t) * (headerWords + parameterWords * parameters.size() +
+                                    routingWords * routings.size()));
+
+    out.append(blockTag, sizeof(blockTag));
+    w.word(blockVersion);
+    w.signedWord(revision);
+    w.word((uint32_t)tableHash);
+    w.word((uint32_t)(tableHash >> 32));
+    w.word(xmlBegin);
+    w.word(xmlEnd);
+    w.word((uint32_t)parameters.size());
+    w.word((uint32_t)routings.size());
+
+    for (const auto &p : parameters)
+    {
+        w.word((uint32_t)p.value.i);
+        w.signedWord(p.type);
+        w.signedWord(p.deformType);
+        w.word(packAttributes(p.present, p.hasValue, p.temposync, p.portaConstRate));
+        w.word(packAttributes(p.portaGliss, p.portaRetrigger, p.portaCurve, p.deactivated));
+        w.word(packAttributes(p.extendRange, p.absolute, 0, 0));
+    }
+
+    for (const auto &r : routings)
+    {
+        uint32_t depth;
+        memcpy(&depth, &r.depth, sizeof(depth));
+
+        w.signedWord(r.param);
+        w.signedWord(r.source);
+        w.word(depth);
+        w.signedWord(r.sourceScene);
+        w.signedWord(r.muted);
+        w.signedWord(r.sourceIndex);
+    }
+}
+
+bool ParameterBlock::read(const char *data, size_t size, int revision, uint64_t tableHash)
+{
+    auto headerBytes = sizeof(blockTag) + sizeof(uint32_t) * headerWords;
+
+    if (!data || size < headerBytes || memcmp(data, blockTag, sizeof(blockTag)) != 0)
+        return false;
+
+    Reader r{data, sizeof(blockTag)};
+
+    if (r.word() != blockVersion || r.signedWord() != revision)
+        return false;
+
+    uint64_t hash = r.word();
+    hash |= (uint64_t)r.word() << 32;
+    if (hash != tableHash)
+        return false;
+
+    auto begin = r.word(), end = r.word();
+    auto np = r.word(), nr = r.word();
+
+    if (np > maxBlockEntries || nr > maxBlockEntries ||
+        size != headerBytes + sizeof(uint32_t) * ((size_t)np * parameterWords +
+                                                  (size_t)nr * routingWords))
+    {
+        return false;
+    }
+
+    std::vector<StreamedParameter> ps(np);
+    for (auto &p : ps)
+    {
+        p.value.i = (int)r.word();
+        p.type = r.signedWord();
+        p.deformType = r.signedWord();
+
+        auto a = r.word(), b = r.word(), c = r.word();
+        p.present = unpackAttribute(a, 0) != 0;
+        p.hasValue = unpackAttribute(a, 1) != 0;
+        p.temposync = unpackAttribute(a, 2);
+        p.portaConstRate = unpackAttribute(a, 3);
+        p.portaGliss = unpackAttribute(b, 0);
+        p.portaRetrigger = unpackAttribute(b, 1);
+        p.portaCurve = unpackAttribute(b, 2);
+        p.deactivated = unpackAttribute(b, 3);
+        p.extendRange = unpackAttribute(c, 0);
+        p.absolute = unpackAttribute(c, 1);
+    }
+
+    std::vector<StreamedRouting> rs(nr);
+    int lastParam = 0;
+    for (auto &q : rs)
+    {
+        q.param = r.signedWord();
+        q.source = r.signedWord();
+        auto depth = r.word();
+        memcpy(&q.depth, &depth, sizeof(depth));
+        q.sourceScene = r.signedWord();
+        q.muted = r.signedWord();
+        q.sourceIndex = r.signedWord();
+
+        // load_xml walks these alongside the parameters, so they have to be in order
+        if (q.param < lastParam || q.param >= (int)np)
+            return false;
+        lastParam = q.param;
+    }
+
+    parameters = std::move(ps);
+    routings = std::move(rs);
+    xmlBegin = begin;
+    xmlEnd = end;
+    return true;
+}
+
+bool ParameterBlock::locateInXML(const char *xml, size_t size)
+{
+    /*
+     * Attribute values and text are escaped, so the only place these can turn up is the
+     * element itself, and parameter names never look like the closing tag
+     */
+    std::string_view x(xml, size);
+    auto b = x.find(parametersOpen);
+    if (b == std::string_view::npos)
+        return false;
+
+    auto e = x.find(parametersClose, b + parametersOpenBytes);
+    if (e == std::string_view::npos)
+        return false;
+
+    xmlBegin = (uint32_t)b;
+    xmlEnd = (uint32_t)(e + parametersCloseBytes);
+    return true;
+}
+
+bool ParameterBlock::matchesXML(const char *xml, size_t size) const
+{
+    return xmlBegin + parametersOpenBytes + parametersCloseBytes <= xmlEnd && xmlEnd <= size &&
+           memcmp(xml + xmlBegin, parametersOpen, parametersOpenBytes) == 0 &&
+           memcmp(xml + xmlEnd - parametersCloseBytes, parametersClose, parametersCloseBytes) ==
+               0;
+}
+} // namespace Storage
+} // namespace Surge
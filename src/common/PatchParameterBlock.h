@@ -0,0 +1,98 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_PATCHPARAMETERBLOCK_H
+#define SURGE_SRC_COMMON_PATCHPARAMETERBLOCK_H
+
+#include "Parameter.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * Everything the <parameters> element of a patch says about one parameter, with an
+ * attribute which isn't there left as absent. Both the XML and the binary parameter block
+ * below read into this, and SurgePatch::load_xml applies it to the patch with the same
+ * rules either way.
+ */
+struct StreamedParameter
+{
+    // porta_log is -1, so that can't be it; this fits the byte the block packs it into
+    static constexpr int absent = -128;
+
+    bool present{false}; // false for the parameters the XML leaves out, like those of empty FX
+    int type{absent};
+    bool hasValue{false};
+    pdata value{};
+    int temposync{absent}, portaConstRate{absent}, portaGliss{absent}, portaRetrigger{absent},
+        portaCurve{absent}, deformType{absent}, deactivated{absent}, extendRange{absent},
+        absolute{absent};
+};
+
+// a <modrouting> child of the parameter with index param in param_ptr
+struct StreamedRouting
+{
+    static constexpr int absent = StreamedParameter::absent;
+
+    int param{0}, source{0};
+    float depth{0.f};
+    int sourceScene{absent}, muted{absent}, sourceIndex{absent};
+};
+
+/*
+ * The <parameters> element in a compact binary form, which a DAW state or undo snapshot
+ * carries after its wavetables. The XML in front of it stays complete, so older versions
+ * and anything else reading the patch never notice; on load we cut the <parameters> text
+ * out of the XML before parsing it and take the values from here instead. That section is
+ * nearly all of a patch, and here it's fixed size records rather than thousands of
+ * elements whose attributes need parsing back into numbers.
+ *
+ * A block is only good for the build which wrote it. It records the patch revision and a
+ * hash of the parameter table (every parameter's storage name and type, in order), and a
+ * block which doesn't match is ignored in favour of the XML.
+ */
+struct ParameterBlock
+{
+    std::vector<StreamedParameter> parameters; // one per entry of param_ptr
+    std::vector<StreamedRouting> routings;     // in parameter order
+    // the bytes of the <parameters> element, start and one past its end, in the XML
+    uint32_t xmlBegin{0}, xmlEnd{0};
+
+    void write(std::string &out, int revision, uint64_t tableHash) const;
+    // reads a whole block from exactly these bytes, leaving this untouched on failure
+    bool read(const char *data, size_t size, int revision, uint64_t tableHash);
+
+    // finds the <parameters> element in XML as save_xml writes it
+    bool locateInXML(const char *xml, size_t size);
+    // checks xmlBegin and xmlEnd still land on the element in this XML
+    bool matchesXML(const char *xml, size_t size) const;
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PATCHPARAMETERBLOCK_H
@@ -0,0 +1,351 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "PatchPreview.h"
+
+#include <sst/filters/HalfRateFilter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace Surge
+{
+namespace Storage
+{
+namespace
+{
+constexpr char previewTag[4] = {'s', 'p', 'v', 'w'};
+constexpr uint32_t previewVersion = 1;
+
+struct PreviewHeader
+{
+    char tag[4];
+    uint32_t version;
+    uint64_t patchSize;
+    int64_t patchTime;
+    int32_t sampleRate, frames;
+    uint32_t pathBytes;
+    uint32_t reserved;
+};
+
+uint64_t hashPath(const std::string &s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (auto c : s)
+        h = (h ^ (unsigned char)c) * 0x100000001b3ULL;
+    return h;
+}
+
+bool patchStamp(const fs::path &patch, uint64_t &size, int64_t &time)
+{
+    std::error_code ec;
+
+    size = (uint64_t)fs::file_size(patch, ec);
+    if (ec)
+        return false;
+
+    time = (int64_t)fs::last_write_time(patch, ec).time_since_epoch().count();
+    return !ec;
+}
+
+// IMA ADPCM, the nibbles of each channel packed low one first
+constexpr int adpcmIndex[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+constexpr int adpcmStep[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,
+    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,
+    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,   230,   253,   279,
+    307,   337,   371,   408,   449,   494,   544,   598,   658,   724,   796,   876,   963,
+    1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,
+    3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+struct ADPCMState
+{
+    int predicted{0}, index{0};
+
+    // both directions step the state the same way, from the code alone
+    void apply(int code)
+    {
+        auto step = adpcmStep[index];
+        auto delta = step >> 3;
+        if (code & 4)
+            delta += step;
+        if (code & 2)
+            delta += step >> 1;
+        if (code & 1)
+            delta += step >> 2;
+
+        predicted = std::clamp(predicted + ((code & 8) ? -delta : delta), -32768, 32767);
+        index = std::clamp(index + adpcmIndex[code], 0, 88);
+    }
+
+    int encode(float f)
+    {
+        auto s = (int)std::clamp(f * 32767.f, -32768.f, 32767.f);
+        auto diff = s - predicted;
+        auto step = adpcmStep[index];
+        int code = 0;
+
+        if (diff < 0)
+        {
+            code = 8;
+            diff = -diff;
+        }
+        for (int bit = 4; bit; bit >>= 1, step >>= 1)
+        {
+            if (diff >= step)
+            {
+                code |= bit;
+                diff -= step;
+            }
+        }
+
+        apply(code);
+        return code;
+    }
+
+    float decode(int code)
+    {
+        apply(code);
+        return predicted * (1.f / 32768.f);
+    }
+};
+} // namespace
+
+void decimatePatchPreview(const float *L, const float *R, int renderFrames, PatchPreview &p)
+{
+    static constexpr int chunk = 64;
+    renderFrames = std::clamp(renderFrames, 0, 2 * PatchPreview::maxFrames);
+
+    sst::filters::HalfRate::HalfRateFilter halfband(6, true);
+    float cL alignas(16)[chunk], cR alignas(16)[chunk];
+
+    p.L.clear();
+    p.R.clear();
+
+    for (int pos = 0; pos < renderFrames; pos += chunk)
+    {
+        auto n = std::min(chunk, renderFrames - pos);
+        std::fill(std::begin(cL), std::end(cL), 0.f);
+        std::fill(std::begin(cR), std::end(cR), 0.f);
+        std::copy(L + pos, L + pos + n, cL);
+        std::copy(R + pos, R + pos + n, cR);
+
+        halfband.process_block_D2(cL, cR, chunk);
+
+        p.L.insert(p.L.end(), cL, cL + n / 2);
+        p.R.insert(p.R.end(), cR, cR + n / 2);
+    }
+}
+
+fs::path patchPreviewPath(const fs::path &cacheDir, const fs::path &patch)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hashPath(path_to_string(patch))
+        << ".spv";
+    return cacheDir / oss.str();
+}
+
+bool loadPatchPreview(const fs::path &cacheDir, const fs::path &patch, PatchPreview &p)
+{
+    uint64_t patchSize;
+    int64_t patchTime;
+
+    if (!patchStamp(patch, patchSize, patchTime))
+        return false;
+
+    std::filebuf f;
+
+    if (!f.open(patchPreviewPath(cacheDir, patch), std::ios::binary | std::ios::in))
+        return false;
+
+    PreviewHeader h;
+
+    if (f.sgetn(reinterpret_cast<char *>(&h), sizeof(h)) != sizeof(h) ||
+        memcmp(h.tag, previewTag, sizeof(previewTag)) != 0 || h.version != previewVersion ||
+        h.patchSize != patchSize || h.patchTime != patchTime ||
+        h.sampleRate != PatchPreview::sampleRate || h.frames < 0 ||
+        h.frames > PatchPreview::maxFrames)
+    {
+        return false;
+    }
+
+    // two patches can share a hashed file name, so check it really is ours
+    auto name = path_to_string(patch);
+    std::string previewName(h.pathBytes, '\0');
+
+    if (h.pathBytes != name.size() ||
+        f.sgetn(previewName.data(), h.pathBytes) != (std::streamsize)h.pathBytes ||
+        previewName != name)
+    {
+        return false;
+    }
+
+    auto bytes = (h.frames + 1) / 2;
+    std::vector<uint8_t> packed(bytes);
+
+    for (auto *c : {&p.L, &p.R})
+    {
+        if (f.sgetn(reinterpret_cast<char *>(packed.data()), bytes) != bytes)
+            return false;
+
+        ADPCMState st;
+        c->resize(h.frames);
+
+        for (int i = 0; i < h.frames; ++i)
+            (*c)[i] = st.decode((packed[i >> 1] >> ((i & 1) * 4)) & 0xF);
+    }
+
+    return true;
+}
+
+bool storePatchPreview(const fs::path &cacheDir, const fs::path &patch, const PatchPreview &p)
+{
+    if (p.R.size() != p.L.size() || p.frames() > PatchPreview::maxFrames)
+        return false;
+
+    PreviewHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.tag, previewTag, sizeof(previewTag));
+    h.version = previewVersion;
+
+    if (!patchStamp(patch, h.patchSize, h.patchTime))
+        return false;
+
+    auto name = path_to_string(patch);
+    h.sampleRate = PatchPreview::sampleRate;
+    h.frames = p.frames();
+    h.pathBytes = (uint32_t)name.size();
+
+    auto bytes = (h.frames + 1) / 2;
+    std::vector<uint8_t> packed[2];
+
+    for (int c = 0; c < 2; ++c)
+    {
+        auto &src = c == 0 ? p.L : p.R;
+        ADPCMState st;
+        packed[c].assign(bytes, 0);
+
+        for (int i = 0; i < h.frames; ++i)
+            packed[c][i >> 1] |= st.encode(src[i]) << ((i & 1) * 4);
+    }
+
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    if (ec)
+        return false;
+
+    // as with the wavetable cache, write to a file of our own and move it into place
+    auto dest = patchPreviewPath(cacheDir, patch);
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto temp = dest;
+    temp += "." + std::to_string((uint64_t)stamp ^ (uint64_t)(uintptr_t)&p) + ".tmp";
+
+    bool ok = false;
+    {
+        std::filebuf f;
+
+        if (!f.open(temp, std::ios::binary | std::ios::out | std::ios::trunc))
+            return false;
+
+        ok = f.sputn(reinterpret_cast<const char *>(&h), sizeof(h)) == sizeof(h) &&
+             f.sputn(name.data(), h.pathBytes) == (std::streamsize)h.pathBytes &&
+             f.sputn(reinterpret_cast<const char *>(packed[0].data()), bytes) == bytes &&
+             f.sputn(reinterpret_cast<const char *>(packed[1].data()), bytes) == bytes;
+
+        ok = f.close() && ok;
+    }
+
+    if (ok)
+    {
+        fs::rename(temp, dest, ec);
+        ok = !ec;
+    }
+
+    if (!ok)
+        fs::remove(temp, ec);
+
+    return ok;
+}
+
+void PatchPreviewPlayer::play(std::shared_ptr<const PatchPreview> p)
+{
+    requestCount++;
+    requested.store(p.get());
+
+    if (p)
+        held.push_back(std::move(p));
+
+    auto r = requested.load();
+    auto u = inUse.load();
+    held.erase(std::remove_if(held.begin(), held.end(),
+                              [r, u](const auto &q) { return q.get() != r && q.get() != u; }),
+               held.end());
+}
+
+void PatchPreviewPlayer::mixInto(float *L, float *R, int n, double hostSampleRate)
+{
+    /*
+     * Say what we're reading and then check it's still what was asked for. Either the message
+     * thread sees us holding it and keeps it, or we see its newer request and take that.
+     */
+    auto p = requested.load();
+    while (true)
+    {
+        inUse.store(p);
+        auto again = requested.load();
+        if (again == p)
+            break;
+        p = again;
+    }
+
+    auto rc = requestCount.load();
+    if (rc != playingRequest)
+    {
+        playingRequest = rc;
+        position = 0;
+    }
+
+    if (!p)
+        return;
+
+    auto step = PatchPreview::sampleRate / hostSampleRate;
+    auto last = p->frames() - 1;
+
+    for (int i = 0; i < n && position < last; ++i)
+    {
+        auto i0 = (int)position;
+        auto f = (float)(position - i0);
+
+        L[i] += p->L[i0] + f * (p->L[i0 + 1] - p->L[i0]);
+        R[i] += p->R[i0] + f * (p->R[i0 + 1] - p->R[i0]);
+        position += step;
+    }
+}
+} // namespace Storage
+} // namespace Surge
@@ -0,0 +1,99 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_PATCHPREVIEW_H
+#define SURGE_SRC_COMMON_PATCHPREVIEW_H
+
+#include "filesystem/import.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A short clip of a patch, rendered ahead of time, so the patch browsers can let you hear a
+ * patch without loading it into the engine. Every clip is the same audition: middle C at
+ * velocity 100 held for noteSeconds and then tailSeconds of release, rendered offline at
+ * renderSampleRate by surge-xt-cli --render-previews and halved to sampleRate.
+ *
+ * The clips sit one per patch in the cache directory, much as the wavetable cache does, as
+ * IMA ADPCM at four bits a sample, which is about 44kB a patch. The PatchDB records which
+ * patches have one. An entry is keyed by the patch's path, size and modification time, so
+ * saving over a patch simply misses until its preview is rendered again. Every failure here
+ * is quiet and just means there's no preview to play.
+ */
+struct PatchPreview
+{
+    static constexpr int sampleRate = 22050;
+    static constexpr int renderSampleRate = 2 * sampleRate;
+    static constexpr int note = 60, velocity = 100;
+    static constexpr double noteSeconds = 1.5, tailSeconds = 0.5;
+    static constexpr int maxFrames = (int)((noteSeconds + tailSeconds) * sampleRate);
+
+    std::vector<float> L, R;
+    int frames() const { return (int)L.size(); }
+};
+
+inline fs::path patchPreviewCacheDir(const fs::path &userDataPath)
+{
+    return userDataPath / "Patch Previews";
+}
+
+// from a stereo render at renderSampleRate, of which up to maxFrames worth are kept
+void decimatePatchPreview(const float *L, const float *R, int renderFrames, PatchPreview &p);
+
+fs::path patchPreviewPath(const fs::path &cacheDir, const fs::path &patch);
+bool loadPatchPreview(const fs::path &cacheDir, const fs::path &patch, PatchPreview &p);
+bool storePatchPreview(const fs::path &cacheDir, const fs::path &patch, const PatchPreview &p);
+
+/*
+ * Plays one preview at a time over a synth's output, apart from its voices and everything
+ * else the patch does. play and stop are for the message thread, and mixInto for the audio
+ * thread, which never frees a preview: the message thread holds on to each one until it can
+ * see the audio thread has let go of it.
+ */
+struct PatchPreviewPlayer
+{
+    void play(std::shared_ptr<const PatchPreview> p);
+    void stop() { play(nullptr); }
+
+    void mixInto(float *L, float *R, int n, double hostSampleRate);
+
+  private:
+    std::atomic<const PatchPreview *> requested{nullptr}, inUse{nullptr};
+    std::atomic<uint32_t> requestCount{0};
+    std::vector<std::shared_ptr<const PatchPreview>> held;
+
+    // the audio thread's
+    uint32_t playingRequest{0};
+    double position{0};
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PATCHPREVIEW_H
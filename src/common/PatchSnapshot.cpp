@@ -0,0 +1,235 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "PatchSnapshot.h"
+#include "ModulationSource.h"
+
+#include <cstring>
+
+namespace Surge
+{
+namespace Storage
+{
+void PatchSnapshot::capture(const SurgePatch &patch)
+{
+    auto n = patch.param_ptr.size();
+    parameters.resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto *p = patch.param_ptr[i];
+        auto &s = parameters[i];
+
+        s.val = p->val;
+        s.temposync = p->temposync;
+        s.extend_range = p->extend_range;
+        s.absolute = p->absolute;
+        s.deactivated = p->deactivated;
+        s.porta_constrate = p->porta_constrate;
+        s.porta_gliss = p->porta_gliss;
+        s.porta_retrigger = p->porta_retrigger;
+        s.porta_curve = p->porta_curve;
+        s.deform_type = p->deform_type;
+    }
+
+    modulation_global = patch.modulation_global;
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        auto &scn = patch.scene[sc];
+
+        modulation_scene[sc] = scn.modulation_scene;
+        modulation_voice[sc] = scn.modulation_voice;
+
+        for (int o = 0; o < n_oscs; ++o)
+        {
+            auto &os = scn.osc[o];
+            auto &ss = osc[sc][o];
+
+            if (uses_wavetabledata(os.type.val.i))
+            {
+                if (!ss.wt)
+                    ss.wt = std::make_unique<Wavetable>();
+                ss.wt->Copy(const_cast<Wavetable *>(&os.wt));
+            }
+            else
+            {
+                ss.wt.reset();
+            }
+
+            ss.wavetable_display_name = os.wavetable_display_name;
+            ss.wavetable_formula = os.wavetable_formula;
+            ss.wavetable_formula_res_base = os.wavetable_formula_res_base;
+            ss.wavetable_formula_nframes = os.wavetable_formula_nframes;
+            ss.extraConfig = os.extraConfig;
+        }
+
+        scene[sc].monoVoicePriorityMode = scn.monoVoicePriorityMode;
+        scene[sc].monoVoiceEnvelopeMode = scn.monoVoiceEnvelopeMode;
+        scene[sc].polyVoiceRepeatedKeyMode = scn.polyVoiceRepeatedKeyMode;
+        scene[sc].polyVoiceStealingMode = scn.polyVoiceStealingMode;
+
+        for (int l = 0; l < n_lfos; ++l)
+        {
+            scene[sc].lfoExtraAmplitude[l] = scn.lfo[l].lfoExtraAmplitude;
+            stepsequences[sc][l] = patch.stepsequences[sc][l];
+            msegs[sc][l] = patch.msegs[sc][l];
+            formulamods[sc][l] = patch.formulamods[sc][l];
+        }
+
+        sceneHardclipMode[sc] = patch.storage->sceneHardclipMode[sc];
+    }
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        impulseResponsePath[i] = patch.fx[i].impulseResponsePath;
+
+    for (int i = 0; i < n_customcontrollers; ++i)
+    {
+        auto *cms = (ControllerModulationSource *)patch.scene[0].modsources[ms_ctrl1 + i];
+        customController[i].bipolar = cms->is_bipolar();
+        customController[i].target = cms->target[0];
+    }
+
+    memcpy(CustomControllerLabel, patch.CustomControllerLabel, sizeof(CustomControllerLabel));
+    memcpy(LFOBankLabel, patch.LFOBankLabel, sizeof(LFOBankLabel));
+
+    name = patch.name;
+    category = patch.category;
+    author = patch.author;
+    license = patch.license;
+    comment = patch.comment;
+    tags = patch.tags;
+    patchTuning = patch.patchTuning;
+
+    hardclipMode = patch.storage->hardclipMode;
+    streamingRevision = patch.streamingRevision;
+    correctlyTuneCombFilter = patch.correctlyTuneCombFilter;
+}
+
+void PatchSnapshot::restore(SurgePatch &patch) const
+{
+    auto n = std::min(patch.param_ptr.size(), parameters.size());
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto *p = patch.param_ptr[i];
+        const auto &s = parameters[i];
+
+        p->val = s.val;
+        p->temposync = s.temposync;
+        p->extend_range = s.extend_range;
+        p->absolute = s.absolute;
+        p->deactivated = s.deactivated;
+        p->porta_constrate = s.porta_constrate;
+        p->porta_gliss = s.porta_gliss;
+        p->porta_retrigger = s.porta_retrigger;
+        p->porta_curve = s.porta_curve;
+        p->deform_type = s.deform_type;
+    }
+
+    patch.modulation_global = modulation_global;
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        auto &scn = patch.scene[sc];
+
+        scn.modulation_scene = modulation_scene[sc];
+        scn.modulation_voice = modulation_voice[sc];
+
+        for (int o = 0; o < n_oscs; ++o)
+        {
+            auto &os = scn.osc[o];
+            const auto &ss = osc[sc][o];
+
+            if (ss.wt)
+                os.wt.Copy(ss.wt.get());
+
+            os.wavetable_display_name = ss.wavetable_display_name;
+            os.wavetable_formula = ss.wavetable_formula;
+            os.wavetable_formula_res_base = ss.wavetable_formula_res_base;
+            os.wavetable_formula_nframes = ss.wavetable_formula_nframes;
+            os.extraConfig = ss.extraConfig;
+        }
+
+        scn.monoVoicePriorityMode = scene[sc].monoVoicePriorityMode;
+        scn.monoVoiceEnvelopeMode = scene[sc].monoVoiceEnvelopeMode;
+        scn.polyVoiceRepeatedKeyMode = scene[sc].polyVoiceRepeatedKeyMode;
+        scn.polyVoiceStealingMode = scene[sc].polyVoiceStealingMode;
+
+        for (int l = 0; l < n_lfos; ++l)
+        {
+            scn.lfo[l].lfoExtraAmplitude = scene[sc].lfoExtraAmplitude[l];
+            patch.stepsequences[sc][l] = stepsequences[sc][l];
+            patch.msegs[sc][l] = msegs[sc][l];
+            patch.formulamods[sc][l] = formulamods[sc][l];
+        }
+
+        patch.storage->sceneHardclipMode[sc] = sceneHardclipMode[sc];
+    }
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        patch.fx[i].impulseResponsePath = impulseResponsePath[i];
+
+    for (int i = 0; i < n_customcontrollers; ++i)
+    {
+        auto *cms = (ControllerModulationSource *)patch.scene[0].modsources[ms_ctrl1 + i];
+        cms->set_bipolar(customController[i].bipolar);
+        cms->init(customController[i].target);
+    }
+
+    memcpy(patch.CustomControllerLabel, CustomControllerLabel, sizeof(CustomControllerLabel));
+    memcpy(patch.LFOBankLabel, LFOBankLabel, sizeof(LFOBankLabel));
+
+    patch.name = name;
+    patch.category = category;
+    patch.author = author;
+    patch.license = license;
+    patch.comment = comment;
+    patch.tags = tags;
+    patch.patchTuning = patchTuning;
+
+    patch.storage->hardclipMode = hardclipMode;
+    patch.streamingRevision = streamingRevision;
+    patch.correctlyTuneCombFilter = correctlyTuneCombFilter;
+
+    /*
+     * The oscillator types are back, so give their parameters the matching control types,
+     * then set the extended ranges again now that they know what they are ranges of. The
+     * values were already converted when the snapshot's patch was loaded, so this is not
+     * a streaming update.
+     */
+    patch.update_controls(false);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto *p = patch.param_ptr[i];
+
+        if (p->ctrlgroup != cg_FX)
+        {
+            p->set_extend_range(parameters[i].extend_range);
+            p->val = parameters[i].val;
+        }
+    }
+}
+} // namespace Storage
+} // namespace Surge
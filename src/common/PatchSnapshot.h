@@ -0,0 +1,118 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_PATCHSNAPSHOT_H
+#define SURGE_SRC_COMMON_PATCHSNAPSHOT_H
+
+#include "SurgeStorage.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * Everything a patch file would record about a SurgePatch, held as plain copies of the
+ * patch's own structures rather than as XML. Capturing and restoring one is a few memcpys
+ * and vector copies, where save_patch and load_patch serialize and parse the whole patch,
+ * which matters when something resets to the same base patch thousands of times.
+ *
+ * Wavetables are kept by reference (Wavetable::Copy shares the built table data), so a
+ * snapshot costs little more than its parameters. DAW extra state is not part of a patch
+ * and isn't captured. A snapshot is only good for the build which took it, since it
+ * records parameters by position in param_ptr; it can be restored into any patch of that
+ * build, though, including one belonging to another synth.
+ *
+ * SurgeSynthesizer::restorePatchSnapshot is the way to restore into a running synth; the
+ * restore here only brings the patch data itself back.
+ */
+struct PatchSnapshot
+{
+    struct ParameterState
+    {
+        pdata val;
+        bool temposync, extend_range, absolute, deactivated;
+        bool porta_constrate, porta_gliss, porta_retrigger;
+        int porta_curve, deform_type;
+    };
+    std::vector<ParameterState> parameters;
+
+    std::vector<ModulationRouting> modulation_global;
+    std::vector<ModulationRouting> modulation_scene[n_scenes], modulation_voice[n_scenes];
+
+    struct OscillatorState
+    {
+        std::unique_ptr<Wavetable> wt; // only for oscillators which use one
+        std::string wavetable_display_name, wavetable_formula;
+        int wavetable_formula_res_base, wavetable_formula_nframes;
+        OscillatorStorage::ExtraConfigurationData extraConfig;
+    };
+    OscillatorState osc[n_scenes][n_oscs];
+
+    struct SceneState
+    {
+        MonoVoicePriorityMode monoVoicePriorityMode;
+        MonoVoiceEnvelopeMode monoVoiceEnvelopeMode;
+        PolyVoiceRepeatedKeyMode polyVoiceRepeatedKeyMode;
+        PolyVoiceStealingMode polyVoiceStealingMode;
+        LFOStorage::LFOExtraOutputAmplitude lfoExtraAmplitude[n_lfos];
+    };
+    SceneState scene[n_scenes];
+
+    StepSequencerStorage stepsequences[n_scenes][n_lfos];
+    MSEGStorage msegs[n_scenes][n_lfos];
+    FormulaModulatorStorage formulamods[n_scenes][n_lfos];
+
+    std::string impulseResponsePath[n_fx_slots];
+
+    struct CustomControllerState
+    {
+        bool bipolar;
+        float target;
+    };
+    CustomControllerState customController[n_customcontrollers];
+    char CustomControllerLabel[n_customcontrollers][CUSTOM_CONTROLLER_LABEL_SIZE];
+    char LFOBankLabel[n_scenes][n_lfos][max_lfo_indices][CUSTOM_CONTROLLER_LABEL_SIZE];
+
+    std::string name, category, author, license, comment;
+    std::vector<SurgePatch::Tag> tags;
+    PatchTuningStorage patchTuning;
+
+    SurgeStorage::HardClipMode hardclipMode, sceneHardclipMode[n_scenes];
+    int streamingRevision;
+    bool correctlyTuneCombFilter;
+
+    void capture(const SurgePatch &patch);
+    /*
+     * Puts the snapshot back into patch, and brings its oscillator control types in line
+     * with the restored oscillator types. The FX are left to the synth to reload.
+     */
+    void restore(SurgePatch &patch) const;
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PATCHSNAPSHOT_H
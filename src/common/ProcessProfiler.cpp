@@ -0,0 +1,247 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "ProcessProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include "SurgeStorage.h"
+
+namespace Surge
+{
+namespace Profiling
+{
+static_assert(ps_fx_last - ps_fx_first + 1 == n_fx_slots, "One profiling stage per FX slot");
+
+std::string ProcessProfiler::stageName(int stage)
+{
+    if (stage >= ps_fx_first && stage <= ps_fx_last)
+        return fxslot_shortnames[stage - ps_fx_first];
+
+    switch (stage)
+    {
+    case ps_control:
+        return "Control";
+    case ps_voices:
+        return "Voices";
+    case ps_filters:
+        return "Filters";
+    case ps_halfband:
+        return "Halfband";
+    case ps_total:
+        return "Total";
+    }
+
+    return "Unknown";
+}
+
+int ProcessProfiler::getRecentBlocks(BlockProfile *dest, int maxBlocks) const
+{
+    auto end = written.load(std::memory_order_acquire);
+    auto n = (int)std::min<uint64_t>({(uint64_t)std::max(maxBlocks, 0), end, historySize});
+
+    for (int i = 0; i < n; ++i)
+    {
+        dest[i] = history[(end - 1 - i) % historySize];
+    }
+
+    /*
+     * Anything the audio thread wrote while we were copying, or is writing now, has replaced
+     * an entry from the oldest end of the ring, so only keep the ones which can't have been.
+     */
+    auto after = written.load(std::memory_order_acquire);
+    auto safe = (int64_t)historySize - 1 - (int64_t)(after - end);
+
+    return (int)std::clamp<int64_t>(safe, 0, n);
+}
+
+BlockProfile ProcessProfiler::getAverage(int nBlocks) const
+{
+    BlockProfile recent[historySize];
+    auto n = getRecentBlocks(recent, std::min(nBlocks, historySize));
+
+    BlockProfile res;
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int s = 0; s < n_process_stages; ++s)
+        {
+            res.usec[s] += recent[i].usec[s];
+        }
+    }
+
+    if (n > 0)
+    {
+        for (auto &u : res.usec)
+        {
+            u /= n;
+        }
+    }
+
+    return res;
+}
+
+BlockProfile ProcessProfiler::getPeak(int nBlocks) const
+{
+    BlockProfile recent[historySize];
+    auto n = getRecentBlocks(recent, std::min(nBlocks, historySize));
+
+    BlockProfile res;
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int s = 0; s < n_process_stages; ++s)
+        {
+            res.usec[s] = std::max(res.usec[s], recent[i].usec[s]);
+        }
+    }
+
+    return res;
+}
+
+std::vector<WorstBlock> ProcessProfiler::getWorstBlocks() const
+{
+    WorstBlock copy[nWorstBlocks];
+
+    for (int tries = 0; tries < 8; ++tries)
+    {
+        auto before = worstSequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        std::copy(std::begin(worst), std::end(worst), std::begin(copy));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (worstSequence.load(std::memory_order_relaxed) == before)
+            break;
+    }
+
+    std::vector<WorstBlock> res;
+    for (const auto &w : copy)
+    {
+        if (w.profile.usec[ps_total] > 0.f)
+            res.push_back(w);
+    }
+
+    std::sort(res.begin(), res.end(), [](const auto &a, const auto &b) {
+        return a.profile.usec[ps_total] > b.profile.usec[ps_total];
+    });
+    return res;
+}
+
+void ProcessProfiler::recordWorst(uint64_t blockIndex)
+{
+    worstSequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto &w = worst[worstMin];
+    w.profile = current;
+    w.blockIndex = blockIndex;
+    w.wallClockMS = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+
+    for (int i = 0; i < nWorstBlocks; ++i)
+    {
+        if (worst[i].profile.usec[ps_total] < worst[worstMin].profile.usec[ps_total])
+            worstMin = i;
+    }
+
+    worstSequence.fetch_add(1, std::memory_order_release);
+}
+
+void ProcessProfiler::clearLatencyStats()
+{
+    histogram.clear();
+
+    worstSequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (auto &w : worst)
+        w = WorstBlock();
+    worstMin = 0;
+    worstSequence.fetch_add(1, std::memory_order_release);
+}
+
+std::string ProcessProfiler::blockEventNames(uint32_t events)
+{
+    std::string res;
+    auto add = [&](uint32_t e, const char *n) {
+        if (events & e)
+            res += (res.empty() ? "" : ", ") + std::string(n);
+    };
+    add(be_patch_load, "patch load");
+    add(be_fx_spawn, "FX spawn");
+    add(be_wavetable_load, "wavetable load");
+    add(be_note_on_burst, "note on burst");
+    return res;
+}
+
+int LatencyHistogram::bucketFor(float usec)
+{
+    if (!(usec >= 1.f))
+        return 0;
+
+    // usec = m * 2^e with m in [0.5, 1)
+    int e;
+    auto m = std::frexp(usec, &e);
+    auto sub = (int)((m * 2.f - 1.f) * subBuckets);
+
+    return std::min(1 + (e - 1) * subBuckets + sub, nBuckets - 1);
+}
+
+float LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket <= 0)
+        return 1.f;
+
+    auto octave = (bucket - 1) / subBuckets;
+    auto sub = (bucket - 1) % subBuckets;
+    return std::ldexp(1.f + (sub + 1.f) / subBuckets, octave);
+}
+
+void LatencyHistogram::clear()
+{
+    for (auto &c : counts)
+        c.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    maxUsec.store(0.f, std::memory_order_relaxed);
+}
+
+float LatencyHistogram::percentile(double pct) const
+{
+    auto n = count();
+    if (n == 0)
+        return 0.f;
+
+    auto target = (uint64_t)std::ceil(std::clamp(pct, 0.0, 100.0) / 100.0 * n);
+    uint64_t seen = 0;
+
+    for (int b = 0; b < nBuckets; ++b)
+    {
+        seen += countInBucket(b);
+        if (seen >= std::max(target, (uint64_t)1))
+            return std::min(bucketUpperBound(b), max());
+    }
+    return max();
+}
+} // namespace Profiling
+} // namespace Surge
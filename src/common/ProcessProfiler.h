@@ -0,0 +1,252 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_PROCESSPROFILER_H
+#define SURGE_SRC_COMMON_PROCESSPROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Profiling
+{
+/*
+ * The parts of SurgeSynthesizer::process() we keep separate timings for. The FX stages are
+ * in slot index order (the fxslot_* enum), not display order.
+ */
+enum ProcessStage
+{
+    ps_control = 0, // processControl and the modulation routing pickup
+    ps_voices,      // voice oscillators and modulators
+    ps_filters,     // the scene filter chains
+    ps_halfband,    // scene hardclip and halfband decimation
+    ps_fx_first,
+    ps_fx_last = ps_fx_first + 15,
+    ps_total, // all of process(), including anything not broken out above
+    n_process_stages
+};
+
+/*
+ * Things which happened on or just before a block that are likely to explain a slow one.
+ * They are or'ed together in BlockProfile::events.
+ */
+enum BlockEvent : uint32_t
+{
+    be_patch_load = 1 << 0,
+    be_fx_spawn = 1 << 1,
+    be_wavetable_load = 1 << 2,
+    be_note_on_burst = 1 << 3, // at least noteOnBurstSize note ons since the last block
+};
+
+static constexpr int noteOnBurstSize = 8;
+
+/*
+ * The time spent in each stage during one call to process(), in microseconds, and what the
+ * engine was up to at the time.
+ */
+struct BlockProfile
+{
+    float usec[n_process_stages]{};
+    uint32_t events{0};
+    uint16_t voices{0};
+    uint16_t noteOns{0};
+};
+
+/*
+ * A histogram of whole block times. Buckets are spaced logarithmically, eight to an octave
+ * from 1 us, in the manner of an HDR histogram, so a percentile read from it is within one
+ * bucket (about 9%) of the true value however long the tail. The audio thread is the only
+ * writer.
+ */
+struct LatencyHistogram
+{
+    static constexpr int subBuckets = 8;
+    static constexpr int octaves = 20;
+    static constexpr int nBuckets = subBuckets * octaves + 1; // bucket 0 is under 1 us
+
+    static int bucketFor(float usec);
+    static float bucketUpperBound(int bucket);
+
+    // audio thread
+    void record(float usec)
+    {
+        auto &c = counts[bucketFor(usec)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (usec > maxUsec.load(std::memory_order_relaxed))
+            maxUsec.store(usec, std::memory_order_relaxed);
+    }
+    void clear();
+
+    // any thread
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t countInBucket(int bucket) const
+    {
+        return counts[bucket].load(std::memory_order_relaxed);
+    }
+    float max() const { return maxUsec.load(std::memory_order_relaxed); }
+
+    // The block time, in us, which pct percent of blocks came in under
+    float percentile(double pct) const;
+
+  private:
+    std::atomic<uint64_t> counts[nBuckets]{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<float> maxUsec{0.f};
+};
+
+/*
+ * One of the slowest blocks since the statistics were last reset. blockIndex counts calls to
+ * endBlock() and wallClockMS is milliseconds since the epoch, for lining up with a host's
+ * xrun log.
+ */
+struct WorstBlock
+{
+    BlockProfile profile;
+    uint64_t blockIndex{0};
+    int64_t wallClockMS{0};
+};
+
+/*
+ * An always-on profiler for the audio thread. It costs a couple of clock reads per stage
+ * per block. process() measures each stage into the current block's profile and pushes
+ * it onto a ring buffer of recent blocks when it is done.
+ *
+ * There is a single writer, the audio thread, and any number of readers. Readers copy out
+ * of the ring without a lock, and check the write position afterwards to drop any entries
+ * the audio thread may have overwritten during the copy.
+ *
+ * When voices are rendered on several threads the oscillators and filters are interleaved
+ * in each task, so the wall clock time for the lot is reported as ps_voices.
+ */
+struct ProcessProfiler
+{
+    typedef std::chrono::steady_clock clock_t;
+
+    static constexpr int historySize = 256;
+    static constexpr int nWorstBlocks = 16;
+
+    static std::string stageName(int stage);
+
+    // audio thread
+    void beginBlock()
+    {
+        if (resetRequested.exchange(false, std::memory_order_acquire))
+            clearLatencyStats();
+
+        current = BlockProfile();
+        blockStart = clock_t::now();
+    }
+
+    clock_t::time_point mark() const { return clock_t::now(); }
+
+    void add(int stage, clock_t::time_point since) { current.usec[stage] += elapsed(since); }
+
+    // for stages timed on another thread, which report back here once joined
+    void addElapsed(int stage, float usec) { current.usec[stage] += usec; }
+
+    // any thread
+    float elapsed(clock_t::time_point since) const
+    {
+        return std::chrono::duration<float, std::micro>(clock_t::now() - since).count();
+    }
+
+    void endBlock(int voices = 0)
+    {
+        add(ps_total, blockStart);
+
+        current.events |= pendingEvents.exchange(0, std::memory_order_relaxed);
+        auto ons = pendingNoteOns.exchange(0, std::memory_order_relaxed);
+        current.noteOns = (uint16_t)std::min(ons, 0xFFFFu);
+        if (ons >= noteOnBurstSize)
+            current.events |= be_note_on_burst;
+        current.voices = (uint16_t)std::max(voices, 0);
+
+        auto w = written.load(std::memory_order_relaxed);
+        history[w % historySize] = current;
+        written.store(w + 1, std::memory_order_release);
+
+        histogram.record(current.usec[ps_total]);
+        if (current.usec[ps_total] > worst[worstMin].profile.usec[ps_total])
+            recordWorst(w);
+    }
+
+    // any thread; folded into the next block to finish
+    void noteEvent(uint32_t e) { pendingEvents.fetch_or(e, std::memory_order_relaxed); }
+    void noteOn() { pendingNoteOns.fetch_add(1, std::memory_order_relaxed); }
+
+    const BlockProfile &currentBlock() const { return current; }
+
+    // any thread
+    /*
+     * Copy up to maxBlocks of the most recent profiles into dest, newest first, and return
+     * how many were copied.
+     */
+    int getRecentBlocks(BlockProfile *dest, int maxBlocks) const;
+
+    // The average over up to the last nBlocks blocks
+    BlockProfile getAverage(int nBlocks = historySize / 2) const;
+
+    // The largest value each stage saw over up to the last nBlocks blocks
+    BlockProfile getPeak(int nBlocks = historySize / 2) const;
+
+    // The histogram of every block time since the last reset
+    const LatencyHistogram &getHistogram() const { return histogram; }
+
+    // Up to nWorstBlocks of the slowest blocks since the last reset, slowest first
+    std::vector<WorstBlock> getWorstBlocks() const;
+
+    // Ask the audio thread to clear the histogram and worst blocks before its next block
+    void resetLatencyStats() { resetRequested.store(true, std::memory_order_release); }
+
+    static std::string blockEventNames(uint32_t events);
+
+  private:
+    void recordWorst(uint64_t blockIndex);
+    void clearLatencyStats();
+
+    BlockProfile current;
+    clock_t::time_point blockStart;
+
+    std::atomic<uint32_t> pendingEvents{0};
+    std::atomic<uint32_t> pendingNoteOns{0};
+    std::atomic<bool> resetRequested{false};
+
+    LatencyHistogram histogram;
+
+    // written under a sequence count so readers can tell if they raced the audio thread
+    WorstBlock worst[nWorstBlocks];
+    int worstMin{0};
+    std::atomic<uint64_t> worstSequence{0};
+
+    BlockProfile history[historySize];
+    std::atomic<uint64_t> written{0};
+};
+} // namespace Profiling
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PROCESSPROFILER_H
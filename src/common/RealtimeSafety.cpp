@@ -0,0 +1,214 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "RealtimeSafety.h"
+
+#include <sstream>
+
+#if SURGE_RT_SAFETY_CHECKS
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if __GLIBC__ || MAC
+#include <execinfo.h>
+#define SURGE_RT_SAFETY_HAS_BACKTRACE 1
+#else
+#define SURGE_RT_SAFETY_HAS_BACKTRACE 0
+#endif
+
+namespace Surge
+{
+namespace RealtimeSafety
+{
+namespace
+{
+/*
+ * Everything the audio thread records into is allocated up front, since recording an
+ * allocation mustn't itself allocate. Only the audio thread writes here while armed, and
+ * report() is meant to be called once it has stopped.
+ */
+static constexpr int maxFrames = 24;
+static constexpr int maxSites = 256;
+
+struct RawSite
+{
+    ViolationKind kind;
+    const char *what;
+    void *frames[maxFrames];
+    int nFrames;
+    uint64_t count;
+};
+
+RawSite sites[maxSites];
+int nSites{0};
+std::atomic<uint64_t> counts[n_rt_violation_kinds];
+std::atomic<bool> armed{false};
+std::atomic<std::thread::id> audioThread{std::thread::id()};
+thread_local bool inRecord{false};
+
+void record(ViolationKind kind, const char *what)
+{
+    if (!armed.load(std::memory_order_relaxed) || inRecord ||
+        std::this_thread::get_id() != audioThread.load(std::memory_order_relaxed))
+        return;
+
+    inRecord = true;
+    counts[kind]++;
+
+    void *frames[maxFrames];
+    int nFrames = 0;
+#if SURGE_RT_SAFETY_HAS_BACKTRACE
+    nFrames = backtrace(frames, maxFrames);
+#endif
+
+    for (int i = 0; i < nSites; ++i)
+    {
+        auto &s = sites[i];
+        if (s.kind == kind && s.what == what && s.nFrames == nFrames &&
+            memcmp(s.frames, frames, nFrames * sizeof(void *)) == 0)
+        {
+            s.count++;
+            inRecord = false;
+            return;
+        }
+    }
+
+    if (nSites < maxSites)
+    {
+        auto &s = sites[nSites++];
+        s.kind = kind;
+        s.what = what;
+        s.nFrames = nFrames;
+        memcpy(s.frames, frames, nFrames * sizeof(void *));
+        s.count = 1;
+    }
+    inRecord = false;
+}
+} // namespace
+
+void setAudioThread(std::thread::id id) { audioThread.store(id, std::memory_order_relaxed); }
+
+void arm()
+{
+#if SURGE_RT_SAFETY_HAS_BACKTRACE
+    // The first backtrace can load the unwinder, which allocates. Get that out of the way.
+    void *frames[2];
+    backtrace(frames, 2);
+#endif
+    nSites = 0;
+    for (auto &c : counts)
+        c = 0;
+    armed = true;
+}
+
+void disarm() { armed = false; }
+
+void noteAllocation(size_t) { record(rt_allocation, nullptr); }
+void noteDeallocation() { record(rt_deallocation, nullptr); }
+void noteLock(const char *what) { record(rt_lock, what); }
+void noteBlockingCall(const char *what) { record(rt_blocking_call, what); }
+
+Report report()
+{
+    // Building the report allocates; make sure we don't count ourselves if still armed
+    auto wasIn = inRecord;
+    inRecord = true;
+
+    Report res;
+    for (int k = 0; k < n_rt_violation_kinds; ++k)
+        res.counts[k] = counts[k];
+
+    for (int i = 0; i < nSites; ++i)
+    {
+        const auto &s = sites[i];
+        Site site;
+        site.kind = s.kind;
+        site.what = s.what ? s.what : "";
+        site.count = s.count;
+
+#if SURGE_RT_SAFETY_HAS_BACKTRACE
+        if (auto strs = backtrace_symbols((void *const *)s.frames, s.nFrames))
+        {
+            std::ostringstream oss;
+            // frame 0 is record() and 1 the note function; skip them
+            for (int f = 2; f < s.nFrames; ++f)
+                oss << "    " << strs[f] << "\n";
+            site.stack = oss.str();
+            free(strs);
+        }
+#endif
+        res.sites.push_back(site);
+    }
+
+    inRecord = wasIn;
+    return res;
+}
+
+} // namespace RealtimeSafety
+} // namespace Surge
+
+#endif // SURGE_RT_SAFETY_CHECKS
+
+namespace Surge
+{
+namespace RealtimeSafety
+{
+std::string kindName(ViolationKind k)
+{
+    switch (k)
+    {
+    case rt_allocation:
+        return "allocation";
+    case rt_deallocation:
+        return "deallocation";
+    case rt_lock:
+        return "lock";
+    case rt_blocking_call:
+        return "blocking call";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+std::string Report::toString() const
+{
+    std::ostringstream oss;
+    oss << "Audio thread: ";
+    for (int k = 0; k < n_rt_violation_kinds; ++k)
+        oss << (k ? ", " : "") << counts[k] << " " << kindName((ViolationKind)k);
+    oss << "\n";
+
+    for (const auto &s : sites)
+    {
+        oss << "  " << s.count << " x " << kindName(s.kind);
+        if (!s.what.empty())
+            oss << " '" << s.what << "'";
+        oss << "\n" << s.stack;
+    }
+    return oss.str();
+}
+} // namespace RealtimeSafety
+} // namespace Surge
@@ -0,0 +1,113 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_REALTIMESAFETY_H
+#define SURGE_SRC_COMMON_REALTIMESAFETY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Opt-in checks that the audio thread neither allocates, frees, takes a lock nor does
+ * anything else that can block. Build with SURGE_RT_SAFETY_CHECKS=1 (the CMake option of the
+ * same name) to turn them on; otherwise every call here is an empty inline.
+ *
+ * SurgeSynthesizer::process() records which thread is the audio thread. Lock sites the audio
+ * thread can reach call noteLock(), and calls which might touch the disk call
+ * noteBlockingCall(). Allocations are reported by whoever owns operator new, which in
+ * practice means the testrunner. While armed, each of these on the audio thread is
+ * counted against the call stack it came from, so a report can say where it happened.
+ */
+namespace Surge
+{
+namespace RealtimeSafety
+{
+enum ViolationKind
+{
+    rt_allocation = 0,
+    rt_deallocation,
+    rt_lock,
+    rt_blocking_call,
+    n_rt_violation_kinds
+};
+
+struct Site
+{
+    ViolationKind kind;
+    std::string what;  // the lock or call name, empty for allocations
+    std::string stack; // symbolized, one frame per line, where the platform allows
+    uint64_t count{0};
+};
+
+struct Report
+{
+    uint64_t counts[n_rt_violation_kinds]{};
+    std::vector<Site> sites;
+
+    uint64_t total() const
+    {
+        uint64_t res = 0;
+        for (auto c : counts)
+            res += c;
+        return res;
+    }
+    std::string toString() const;
+};
+
+#if SURGE_RT_SAFETY_CHECKS
+static constexpr bool checksEnabled = true;
+
+void setAudioThread(std::thread::id);
+
+// Counting only happens while armed. arm() clears everything counted so far.
+void arm();
+void disarm();
+
+void noteAllocation(size_t size);
+void noteDeallocation();
+void noteLock(const char *what);
+void noteBlockingCall(const char *what);
+
+Report report();
+#else
+static constexpr bool checksEnabled = false;
+
+inline void setAudioThread(std::thread::id) {}
+inline void arm() {}
+inline void disarm() {}
+inline void noteAllocation(size_t) {}
+inline void noteDeallocation() {}
+inline void noteLock(const char *) {}
+inline void noteBlockingCall(const char *) {}
+inline Report report() { return {}; }
+#endif
+
+std::string kindName(ViolationKind k);
+
+} // namespace RealtimeSafety
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_REALTIMESAFETY_H
@@ -0,0 +1,139 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_RETUNINGCACHE_H
+#define SURGE_SRC_COMMON_RETUNINGCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A small memo of the tuning lookups each voice makes when it works out its pitch, which
+ * lives for one block. In MIDI-only tuning mode each of those is two scale lookups, but a
+ * chord with unison stacks or layered scenes asks the same question many times a block.
+ * MTS-ESP lookups go through the longer lived MTSRetuningTable below instead.
+ *
+ * Entries are tagged with the block they were computed in, so nextBlock() invalidates
+ * everything at once, and any tuning, mapping, mode or MTS-ESP change is picked up at the
+ * next block just as it was when each voice asked for itself. Collisions simply overwrite.
+ *
+ * This is not thread safe; SurgeStorage only hands it out on the audio thread.
+ */
+struct RetuningCache
+{
+    enum Lookup : uint8_t
+    {
+        mtsRetuningInSemitones = 1,
+        midiOnlyKeyRemap,
+    };
+
+    void nextBlock() { epoch++; }
+
+    template <typename F> float get(Lookup what, float key, int channel, F &&compute)
+    {
+        uint32_t keyBits;
+        memcpy(&keyBits, &key, sizeof(keyBits));
+
+        auto h = (keyBits * 2654435761u) ^ ((uint32_t)channel * 40503u) ^ ((uint32_t)what << 7);
+        auto &e = entries[(h >> 16) & (nEntries - 1)];
+
+        if (e.epoch == epoch && e.keyBits == keyBits && e.channel == channel && e.what == what)
+            return e.value;
+
+        e.epoch = epoch;
+        e.keyBits = keyBits;
+        e.channel = channel;
+        e.what = what;
+        e.value = compute();
+        return e.value;
+    }
+
+  private:
+    static constexpr int nEntries = 64;
+
+    struct Entry
+    {
+        uint32_t epoch{0}, keyBits{0};
+        int channel{0};
+        Lookup what{};
+        float value{0.f};
+    } entries[nEntries];
+
+    // entries start out at epoch 0, so they are never valid
+    uint32_t epoch{1};
+};
+
+/*
+ * The MTS-ESP retuning of every MIDI note and channel, kept for all voices to read. The MTS
+ * client can't tell us when the master changes its tuning, so each entry is asked for again
+ * the first time it is read after refreshBlocks blocks have gone by. That makes the cost
+ * scale with the notes in use rather than with the voices playing them, while a change on
+ * the master still reaches held notes within a few milliseconds.
+ *
+ * invalidate() may be called from any thread and takes effect at the next block; everything
+ * else belongs to the audio thread, as with RetuningCache.
+ */
+struct MTSRetuningTable
+{
+    static constexpr uint32_t refreshBlocks = 16;
+
+    void nextBlock()
+    {
+        block++;
+        if (invalidated.exchange(false))
+            block += refreshBlocks;
+    }
+
+    void invalidate() { invalidated = true; }
+
+    template <typename F> float get(int note, int channel, F &&compute)
+    {
+        auto &e = entries[channel & 15][note & 127];
+
+        if (block - e.block < refreshBlocks)
+            return e.value;
+
+        e.block = block;
+        e.value = compute();
+        return e.value;
+    }
+
+  private:
+    struct Entry
+    {
+        uint32_t block{0};
+        float value{0.f};
+    } entries[16][128];
+
+    // entries start out refreshBlocks behind, so they are never valid
+    uint32_t block{refreshBlocks};
+    std::atomic<bool> invalidated{false};
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_RETUNINGCACHE_H
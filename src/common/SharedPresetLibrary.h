@@ -0,0 +1,142 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_SHAREDPRESETLIBRARY_H
+#define SURGE_SRC_COMMON_SHAREDPRESETLIBRARY_H
+
+#include "filesystem/import.h"
+#include "PatchListSnapshot.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A preset library (the FX or the modulator presets) walked once per process and shared by
+ * every SurgeStorage, so a DAW with forty Surges doesn't parse the same files forty times.
+ * SurgeStorage starts the walk in the background as it comes up, and whoever first opens a
+ * menu waits for it only if it hasn't finished yet.
+ *
+ * Like a PatchListSnapshot, a scan remembers the modification time of every directory it
+ * went through, and a reader which finds one of them has moved walks again. That catches
+ * presets being added, removed or renamed, by us or anyone else; writing over a preset in
+ * place doesn't move its directory, so whoever does that forces a rescan.
+ *
+ * Scanners run off the thread which asked for them and may outlive the storage, so they take
+ * copies of the paths they need and leave any error in the scan for the reader to report.
+ */
+template <typename T> struct SharedPresetLibrary
+{
+    struct Scan
+    {
+        std::vector<std::pair<fs::path, int64_t>> directories;
+        T presets;
+        std::string error;
+
+        // every directory the walk enters, and each root whether it exists or not
+        void noteDirectory(const fs::path &p) { directories.emplace_back(p, directoryModTime(p)); }
+
+        bool isCurrent() const
+        {
+            for (const auto &[p, t] : directories)
+            {
+                if (directoryModTime(p) != t)
+                    return false;
+            }
+            return true;
+        }
+    };
+    typedef std::function<std::shared_ptr<const Scan>()> scanner_t;
+
+    // start walking for key in the background, unless somebody already has
+    static void prefetch(const std::string &key, const scanner_t &scanner)
+    {
+        auto &s = shared();
+        std::lock_guard<std::mutex> g(s.lock);
+
+        if (s.byKey.find(key) == s.byKey.end())
+        {
+            s.byKey[key] = std::async(std::launch::async, scanner).share();
+        }
+    }
+
+    // the scan for key, waiting for one in flight and walking again if it is stale or forced
+    static std::shared_ptr<const Scan> get(const std::string &key, const scanner_t &scanner,
+                                           bool force = false)
+    {
+        auto &s = shared();
+        std::shared_future<std::shared_ptr<const Scan>> inFlight;
+
+        if (!force)
+        {
+            std::lock_guard<std::mutex> g(s.lock);
+            auto it = s.byKey.find(key);
+            if (it != s.byKey.end())
+                inFlight = it->second;
+        }
+
+        if (inFlight.valid())
+        {
+            auto res = inFlight.get();
+            if (res && res->isCurrent())
+                return res;
+        }
+
+        auto res = scanner();
+
+        std::promise<std::shared_ptr<const Scan>> done;
+        done.set_value(res);
+
+        std::lock_guard<std::mutex> g(s.lock);
+        s.byKey[key] = done.get_future().share();
+
+        return res;
+    }
+
+  private:
+    struct Shared
+    {
+        std::mutex lock;
+        std::map<std::string, std::shared_future<std::shared_ptr<const Scan>>> byKey;
+    };
+
+    static Shared &shared()
+    {
+        static Shared s;
+        return s;
+    }
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_SHAREDPRESETLIBRARY_H
@@ -25,7 +25,9 @@
 
 #include "SurgeStorage.h"
 #include "MemoryPool.h"
+#include "DelayLineArena.h"
 #include "SSESincDelayLine.h"
+#include "TwistOscillator.h"
 
 namespace Surge
 {
@@ -33,7 +35,13 @@ namespace Memory
 {
 struct SurgeMemoryPools
 {
-    SurgeMemoryPools(SurgeStorage *s) : stringDelayLines(s->sinctable) {}
+    SurgeMemoryPools(SurgeStorage *s)
+        : stringDelayLines(s->sinctable), shortStringDelayLines(s->sinctable)
+    {
+        // The Lanczos kernel tables are built by the first resampler made, so make that happen
+        // here rather than on the audio thread when the first twist note plays
+        auto warm = std::make_unique<TwistOscillator::resamp_t>(48000, 48000);
+    }
 
     /*
      * The largest number of oscillator instances of a particular
@@ -42,14 +50,28 @@ struct SurgeMemoryPools
     static constexpr int maxosc = n_scenes * n_oscs * (MAX_VOICES + 8);
 
     /*
-     * The string needs 2 delay lines per oscillator
+     * The string needs 2 delay lines per oscillator, either long or (for notes
+     * comfortably above the bottom of the range) short ones
      */
     MemoryPool<SSESincDelayLine<16384>, 8, 4, 2 * maxosc + 100> stringDelayLines;
+    MemoryPool<SSESincDelayLine<4096>, 8, 4, 2 * maxosc + 100> shortStringDelayLines;
+
+    /*
+     * The twist needs one plaits voice and resampler pair per oscillator
+     */
+    MemoryPool<TwistOscillator::PlaitsState, 4, 4, maxosc + 100> twistStates;
+
+    /*
+     * Delay memory for the effects, sized per instance for the sample rate rather than
+     * held inline at the worst case
+     */
+    DelayLineArena effectDelayLines;
+
     void resetAllPools(SurgeStorage *storage) { resetOscillatorPools(storage); }
     void resetOscillatorPools(SurgeStorage *storage)
     {
         bool hasString{false}, hasTwist{false};
-        int nString{0};
+        int nString{0}, nTwist{0};
         for (int s = 0; s < n_scenes; ++s)
         {
             for (int os = 0; os < n_oscs; ++os)
@@ -61,18 +83,38 @@ struct SurgeMemoryPools
                     hasString = true;
                     nString++;
                 }
-                hasTwist |= (ot == ot_twist);
+                if (ot == ot_twist)
+                {
+                    hasTwist = true;
+                    nTwist++;
+                }
             }
         }
 
+        /*
+         * This runs on the audio thread when an oscillator type changes, so the pool grows
+         * and shrinks on its refill thread rather than here
+         */
         if (hasString)
         {
             int maxUsed = nString * 2 * storage->getPatch().polylimit.val.i;
-            stringDelayLines.setupPoolToSize((int)(maxUsed * 0.5), storage->sinctable);
+            stringDelayLines.requestPoolSize((size_t)(maxUsed * 0.5));
+            shortStringDelayLines.requestPoolSize((size_t)(maxUsed * 0.5));
+        }
+        else
+        {
+            stringDelayLines.requestPoolSize(0);
+            shortStringDelayLines.requestPoolSize(0);
+        }
+
+        if (hasTwist)
+        {
+            int maxUsed = nTwist * storage->getPatch().polylimit.val.i;
+            twistStates.requestPoolSize((size_t)(maxUsed * 0.5));
         }
         else
         {
-            stringDelayLines.returnToPreAllocSize();
+            twistStates.requestPoolSize(0);
         }
     }
 };
@@ -28,6 +28,7 @@
 #include "MSEGModulationHelper.h"
 #include "FormulaModulationHelper.h"
 #include "DebugHelpers.h"
+#include "SurgeTrace.h"
 #include "StringOps.h"
 #include "SkinModel.h"
 #include "UserDefaults.h"
@@ -39,6 +40,7 @@
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 #include "PatchFileHeaderStructs.h"
+#include "PatchParameterBlock.h"
 
 namespace mech = sst::basic_blocks::mechanics;
 
@@ -805,10 +807,13 @@ SurgePatch::SurgePatch(SurgeStorage *storage)
             Surge::Formula::createInitFormula(fs);
         }
 
-    // Build table of param_ptr -- osc name
-    for (auto *p : param_ptr)
+    // Build table of param_ptr -- osc name, and of param_ptr index -- storage name
+    param_index_by_storage_name.reserve(param_ptr.size());
+
+    for (int i = 0; i < (int)param_ptr.size(); i++)
     {
-        param_ptr_by_oscname[p->get_osc_name()] = p;
+        param_ptr_by_oscname[param_ptr[i]->get_osc_name()] = param_ptr[i];
+        param_index_by_storage_name.emplace(param_ptr[i]->get_storage_name(), i);
     }
 }
 
@@ -982,11 +987,19 @@ void SurgePatch::copy_scenedata(pdata *d, pdata *dUnmod, int scene)
 {
 
     int s = scene_start[scene];
+    auto &changes = scenedataChanges[scene];
+    changes.begin();
+
     for (int i = 0; i < n_scene_params; i++)
     {
         // if (param_ptr[i+s]->valtype == vt_float)
         // d[i].f = param_ptr[i+s]->val.f;
-        d[i].i = param_ptr[i + s]->val.i;
+        auto v = param_ptr[i + s]->val.i;
+        if (d[i].i != v)
+        {
+            d[i].i = v;
+            changes.mark(i);
+        }
 
         if (param_ptr[i + s]->ctrlgroup == cg_OSC)
             dUnmod[i].f = d[i].f;
@@ -997,6 +1010,7 @@ void SurgePatch::copy_scenedata(pdata *d, pdata *dUnmod, int scene)
         auto &pm = monophonicParamModulations[i];
         if (pm.param_id >= s && pm.param_id < s + n_scene_params)
         {
+            changes.mark(pm.param_id - s);
             switch (pm.vt_type)
             {
             case vt_float:
@@ -1062,6 +1076,8 @@ void SurgePatch::update_controls(
     bool from_streaming // we are loading from a patch
 )
 {
+    storage->displayGeneration++;
+
     int sn = 0;
     for (auto &sc : scene)
     {
@@ -1204,7 +1220,8 @@ std::string base64_decode(std::string const &encoded_string)
     return ret;
 }
 
-void SurgePatch::load_patch(const void *data, int datasize, bool preset)
+void SurgePatch::load_patch(const void *data, int datasize, bool preset,
+                            Wavetable *const prebuiltWT[n_scenes][n_oscs])
 {
     using namespace sst::io;
 
@@ -1219,7 +1236,28 @@ void SurgePatch::load_patch(const void *data, int datasize, bool preset)
     if (!memcmp(ph->tag, "sub3", 4))
     {
         char *dr = (char *)data + sizeof(patch_header);
-        load_xml(dr, ph->xmlsize, preset);
+
+        /*
+         * A parameter block, if there is one, is whatever follows the wavetables, and is only
+         * any use if it was written by this build
+         */
+        Surge::Storage::ParameterBlock block;
+        bool hasBlock = false;
+        {
+            size_t used = sizeof(patch_header) + (size_t)ph->xmlsize;
+
+            for (int sc = 0; sc < n_scenes; sc++)
+                for (int osc = 0; osc < n_oscs; osc++)
+                    used += (uint32_t)mech::endian_read_int32LE(ph->wtsize[sc][osc]);
+
+            if (used < (size_t)datasize)
+            {
+                hasBlock = block.read((char *)data + used, datasize - used, ff_revision,
+                                      parameterTableHash());
+            }
+        }
+
+        load_xml(dr, ph->xmlsize, preset, hasBlock ? &block : nullptr);
         dr += ph->xmlsize;
 
         for (int sc = 0; sc < n_scenes; sc++)
@@ -1241,7 +1279,14 @@ void SurgePatch::load_patch(const void *data, int datasize, bool preset)
                     void *d = (void *)((char *)dr + sizeof(wt_header));
 
                     storage->waveTableDataMutex.lock();
-                    scene[sc].osc[osc].wt.BuildWT(d, *wth, false);
+                    if (prebuiltWT && prebuiltWT[sc][osc])
+                    {
+                        scene[sc].osc[osc].wt.Copy(prebuiltWT[sc][osc]);
+                    }
+                    else
+                    {
+                        scene[sc].osc[osc].wt.BuildWT(d, *wth, false);
+                    }
 
                     bool hadName{true};
 
@@ -1286,7 +1331,7 @@ void SurgePatch::load_patch(const void *data, int datasize, bool preset)
     }
 }
 
-unsigned int SurgePatch::save_patch(void **data)
+unsigned int SurgePatch::save_patch(void **data, bool withParameterBlock)
 {
     using namespace sst::io;
 
@@ -1296,7 +1341,15 @@ unsigned int SurgePatch::save_patch(void **data)
     patch_header header;
 
     memcpy(header.tag, "sub3", 4);
-    size_t xmlsize = save_xml(&xmldata);
+    Surge::Storage::ParameterBlock block;
+    size_t xmlsize = save_xml(&xmldata, withParameterBlock ? &block : nullptr);
+
+    std::string blockData;
+    if (withParameterBlock && !block.parameters.empty())
+    {
+        block.write(blockData, ff_revision, parameterTableHash());
+    }
+
     header.xmlsize = mech::endian_write_int32LE(xmlsize);
     wt_header wth[n_scenes][n_oscs];
     for (int sc = 0; sc < n_scenes; sc++)
@@ -1320,7 +1373,7 @@ unsigned int SurgePatch::save_patch(void **data)
                 header.wtsize[sc][osc] = 0;
         }
     }
-    psize += xmlsize + sizeof(patch_header);
+    psize += xmlsize + sizeof(patch_header) + blockData.size();
     if (patchptr)
         free(patchptr);
     patchptr = malloc(psize);
@@ -1360,9 +1413,28 @@ unsigned int SurgePatch::save_patch(void **data)
             }
         }
     }
+
+    // anything reading the container by its header never gets this far
+    memcpy(dw, blockData.data(), blockData.size());
     return psize;
 }
 
+uint64_t SurgePatch::parameterTableHash() const
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](unsigned char c) { h = (h ^ c) * 0x100000001b3ULL; };
+
+    for (const auto *p : param_ptr)
+    {
+        for (auto c = p->get_storage_name(); *c; ++c)
+            mix(*c);
+        mix(0);
+        mix((unsigned char)p->valtype);
+    }
+
+    return h;
+}
+
 Parameter *SurgePatch::parameterFromOSCName(std::string oscName)
 {
     auto ot = param_ptr_by_oscname.find(oscName);
@@ -1375,6 +1447,18 @@ Parameter *SurgePatch::parameterFromOSCName(std::string oscName)
     return nullptr;
 }
 
+int SurgePatch::parameterIndexFromStorageName(const std::string &storageName) const
+{
+    auto it = param_index_by_storage_name.find(storageName);
+
+    if (it != param_index_by_storage_name.end())
+    {
+        return it->second;
+    }
+
+    return -1;
+}
+
 float convert_v11_reso_to_v12_2P(float reso)
 {
     float Qinv =
@@ -1384,8 +1468,11 @@ float convert_v11_reso_to_v12_2P(float reso)
 
 float convert_v11_reso_to_v12_4P(float reso) { return reso * (0.99f / 1.05f); }
 
-void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
+void SurgePatch::load_xml(const void *data, int datasize, bool is_preset,
+                          const Surge::Storage::ParameterBlock *block)
 {
+    SURGE_TRACE_ZONE("SurgePatch::load_xml");
+
     TiXmlDocument doc;
     int j;
     double d;
@@ -1404,11 +1491,29 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
         return;
     }
 
+    if (block && !(datasize && block->matchesXML((const char *)data, datasize)))
+    {
+        block = nullptr;
+    }
+
     if (datasize)
     {
         char *temp = (char *)malloc(datasize + 1);
-        memcpy(temp, data, datasize);
-        *(temp + datasize) = 0;
+
+        if (block)
+        {
+            // the block has the parameters, so leave their element out of what we parse
+            auto tail = datasize - block->xmlEnd;
+            memcpy(temp, data, block->xmlBegin);
+            memcpy(temp + block->xmlBegin, (const char *)data + block->xmlEnd, tail);
+            *(temp + block->xmlBegin + tail) = 0;
+        }
+        else
+        {
+            memcpy(temp, data, datasize);
+            *(temp + datasize) = 0;
+        }
+
         doc.Parse(temp, nullptr, TIXML_ENCODING_LEGACY);
         free(temp);
     }
@@ -1516,348 +1621,423 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
     }
 
     TiXmlElement *parameters = TINYXML_SAFE_TO_ELEMENT(patch->FirstChild("parameters"));
-    if (!parameters)
+    if (!parameters && !block)
     {
         return;
     }
     int n = param_ptr.size();
 
-    // delete volume (below streaming version 17) & fx_bypass if it's a preset
-    if (is_preset)
-    {
-        if (revision < 17)
-        {
-            TiXmlElement *tp = TINYXML_SAFE_TO_ELEMENT(parameters->FirstChild("volume"));
+    using Surge::Storage::StreamedParameter;
+    using Surge::Storage::StreamedRouting;
+    constexpr int absent = StreamedParameter::absent;
 
-            if (tp)
+    /*
+     * Everything below applies what <parameters> said about param_ptr[i] and the routings
+     * targeting it, whether that was read from the XML or from a parameter block
+     */
+    auto applyParameter = [&](int i, const StreamedParameter &sp, const StreamedRouting *mr,
+                              const StreamedRouting *mrEnd) {
+        bool hasStreamedType = sp.type != absent;
+        int type = hasStreamedType ? sp.type : param_ptr[i]->valtype;
+
+        if (type == (valtypes)vt_float)
+        {
+            if (sp.hasValue)
             {
-                parameters->RemoveChild(tp);
+                param_ptr[i]->set_storage_value(sp.value.f);
+            }
+            else
+            {
+                param_ptr[i]->val.f = param_ptr[i]->val_default.f;
             }
         }
-
-        auto tp = TINYXML_SAFE_TO_ELEMENT(parameters->FirstChild("fx_bypass"));
-
-        if (tp)
+        else
         {
-            parameters->RemoveChild(tp);
+            if (sp.hasValue)
+            {
+                param_ptr[i]->set_storage_value(sp.value.i);
+            }
+            else
+            {
+                param_ptr[i]->val.i = param_ptr[i]->val_default.i;
+            }
         }
-    }
 
-    TiXmlElement *p;
+        if (sp.temposync == 1)
+        {
+            param_ptr[i]->temposync = true;
+        }
 
-    for (int i = 0; i < n; i++)
-    {
-        if (!i)
+        if (sp.portaConstRate != absent)
         {
-            p = TINYXML_SAFE_TO_ELEMENT(parameters->FirstChild(param_ptr[i]->get_storage_name()));
+            param_ptr[i]->porta_constrate = (sp.portaConstRate == 1);
         }
         else
         {
-            if (p)
+            if (param_ptr[i]->has_portaoptions())
             {
-                p = TINYXML_SAFE_TO_ELEMENT(p->NextSibling(param_ptr[i]->get_storage_name()));
+                param_ptr[i]->porta_constrate = false;
             }
+        }
 
-            if (!p)
+        if (sp.portaGliss != absent)
+        {
+            param_ptr[i]->porta_gliss = (sp.portaGliss == 1);
+        }
+        else
+        {
+            if (param_ptr[i]->has_portaoptions())
             {
-                p = TINYXML_SAFE_TO_ELEMENT(
-                    parameters->FirstChild(param_ptr[i]->get_storage_name()));
+                param_ptr[i]->porta_gliss = false;
             }
         }
 
-        if (p)
+        if (sp.portaRetrigger != absent)
+        {
+            param_ptr[i]->porta_retrigger = (sp.portaRetrigger == 1);
+        }
+        else
         {
-            int type;
-            bool hasStreamedType = true;
+            if (param_ptr[i]->has_portaoptions())
+            {
+                param_ptr[i]->porta_retrigger = false;
+            }
+        }
 
-            if (!(p->QueryIntAttribute("type", &type) == TIXML_SUCCESS))
+        if (sp.portaCurve != absent)
+        {
+            switch (sp.portaCurve)
             {
-                hasStreamedType = false;
-                type = param_ptr[i]->valtype;
+            case porta_log:
+            case porta_lin:
+            case porta_exp:
+                param_ptr[i]->porta_curve = sp.portaCurve;
+                break;
             }
+        }
+        else
+        {
+            if (param_ptr[i]->has_portaoptions())
+            {
+                param_ptr[i]->porta_curve = porta_lin;
+            }
+        }
 
-            if (type == (valtypes)vt_float)
+        if (sp.deformType != absent)
+            param_ptr[i]->deform_type = sp.deformType;
+        else
+        {
+            if (param_ptr[i]->has_deformoptions())
             {
-                if (p->QueryDoubleAttribute("value", &d) == TIXML_SUCCESS)
+                if (param_ptr[i]->ctrltype == ct_noise_color)
                 {
-                    param_ptr[i]->set_storage_value((float)d);
+                    param_ptr[i]->deform_type = NoiseColorChannels::STEREO;
                 }
                 else
                 {
-                    param_ptr[i]->val.f = param_ptr[i]->val_default.f;
+                    param_ptr[i]->deform_type = type_1;
                 }
             }
-            else
+        }
+
+        if (sp.deactivated != absent)
+        {
+            param_ptr[i]->deactivated = (sp.deactivated == 1);
+        }
+        else
+        {
+            /*
+             * This code runs when there is no deactivated streaming. This can happen
+             * in, say, nightlies when we toggle can_deactivate half way through the
+             * dev cycle so half the patches have it true and half false. But there is
+             * no good default so just maintain this nasty list.
+             */
+            if (param_ptr[i]->can_deactivate())
             {
-                if (p->QueryIntAttribute("value", &j) == TIXML_SUCCESS)
+                auto cg = param_ptr[i]->ctrlgroup;
+                auto ct = param_ptr[i]->ctrltype;
+
+                // Do we want to taggle to default deactivated on or off?
+                if ((cg == cg_LFO) || // this is the LFO rate and env special case
+                    (cg == cg_GLOBAL &&
+                     ct == ct_freq_hpf) || // this is the global highpass special case
+                    (ct == ct_filtertype || ct == ct_wstype) || // filter bypass
+                    (ct == ct_amplitude_clipper)                // scene volume
+                )
                 {
-                    param_ptr[i]->set_storage_value(j);
+                    param_ptr[i]->deactivated = false;
                 }
                 else
                 {
-                    param_ptr[i]->val.i = param_ptr[i]->val_default.i;
+                    param_ptr[i]->deactivated = true;
                 }
             }
-
-            if ((p->QueryIntAttribute("temposync", &j) == TIXML_SUCCESS) && (j == 1))
+            else if (revision == 16 && param_ptr[i]->ctrlgroup == cg_FX)
             {
-                param_ptr[i]->temposync = (j == 1);
+                /*
+                 * So, alas, we added deactivatable FX filters and stuff very late in the 1.9
+                 * cycle. The handle streaming handles 15 versions and stuff but 16s with no POV
+                 * get the random default. Now, you may ask, why not put this inside the
+                 * can_deactivate block? Well since we haven't created the FX yet we don't
+                 * know the type and so we don't know if it is deactivatble.
+                 *
+                 * So what we do is, for revision 16 patches where we don't know if they
+                 * were saved during the 4 months of nightlies or 9 days before release,
+                 * we assume if there is no statement they were saved in the 4 months and
+                 * clobber any unknown deactivated state to false here.
+                 */
+                param_ptr[i]->deactivated = false;
             }
+        }
 
-            if ((p->QueryIntAttribute("porta_const_rate", &j) == TIXML_SUCCESS))
-            {
-                param_ptr[i]->porta_constrate = (j == 1);
-            }
-            else
-            {
-                if (param_ptr[i]->has_portaoptions())
-                {
-                    param_ptr[i]->porta_constrate = false;
-                }
-            }
+        if (sp.extendRange != absent)
+        {
+            param_ptr[i]->set_extend_range((sp.extendRange == 1));
+        }
+        else
+        {
+            param_ptr[i]->set_extend_range(false);
 
-            if ((p->QueryIntAttribute("porta_gliss", &j) == TIXML_SUCCESS))
+            if (revision >= 16 && param_ptr[i]->ctrltype == ct_percent_oscdrift)
             {
-                param_ptr[i]->porta_gliss = (j == 1);
+                param_ptr[i]->set_extend_range(true);
             }
-            else
+        }
+
+        if (sp.absolute != absent)
+        {
+            param_ptr[i]->absolute = (sp.absolute == 1);
+        }
+
+        int sceneId = param_ptr[i]->scene;
+        int paramIdInScene = param_ptr[i]->param_id_in_scene;
+
+        /*
+         * Note when we make int modulation work we will have to remove this conditional here
+         */
+        /*
+        if( mr && hasStreamedType && type != vt_float )
+            std::cout << "Dropping modulations for param " << p->Value()
+            << hasStreamedType << " " << type << " " << vt_float << std::endl;
+            */
+
+        for (; mr != mrEnd && (!hasStreamedType || type == vt_float); ++mr)
+        {
+            int modsource = mr->source;
+
+            if (revision < 9)
             {
-                if (param_ptr[i]->has_portaoptions())
+                // make room for ctrl8 in old patches
+                if (modsource > ms_ctrl7)
                 {
-                    param_ptr[i]->porta_gliss = false;
+                    modsource++;
                 }
             }
 
-            if ((p->QueryIntAttribute("porta_retrigger", &j) == TIXML_SUCCESS))
-            {
-                param_ptr[i]->porta_retrigger = (j == 1);
-            }
-            else
+            // see GitHub issue #6424
+            if (revision < 21 && param_ptr[i] == &volume)
             {
-                if (param_ptr[i]->has_portaoptions())
-                {
-                    param_ptr[i]->porta_retrigger = false;
-                }
+                continue;
             }
 
-            if ((p->QueryIntAttribute("porta_curve", &j) == TIXML_SUCCESS))
+            vector<ModulationRouting> *modlist = nullptr;
+
+            if (sceneId != 0)
             {
-                switch (j)
+                if (isScenelevel((modsources)modsource))
                 {
-                case porta_log:
-                case porta_lin:
-                case porta_exp:
-                    param_ptr[i]->porta_curve = j;
-                    break;
+                    modlist = &scene[sceneId - 1].modulation_scene;
                 }
-            }
-            else
-            {
-                if (param_ptr[i]->has_portaoptions())
+                else
                 {
-                    param_ptr[i]->porta_curve = porta_lin;
+                    modlist = &scene[sceneId - 1].modulation_voice;
                 }
             }
-
-            if ((p->QueryIntAttribute("deform_type", &j) == TIXML_SUCCESS))
-                param_ptr[i]->deform_type = j;
             else
             {
-                if (param_ptr[i]->has_deformoptions())
-                {
-                    if (param_ptr[i]->ctrltype == ct_noise_color)
-                    {
-                        param_ptr[i]->deform_type = NoiseColorChannels::STEREO;
-                    }
-                    else
-                    {
-                        param_ptr[i]->deform_type = type_1;
-                    }
-                }
+                modlist = &modulation_global;
             }
 
-            if ((p->QueryIntAttribute("deactivated", &j) == TIXML_SUCCESS))
+            ModulationRouting t;
+            t.depth = mr->depth;
+            t.source_id = modsource;
+
+            if (sceneId != 0)
             {
-                param_ptr[i]->deactivated = (j == 1);
+                t.source_scene = sceneId - 1;
             }
             else
             {
-                /*
-                 * This code runs when there is no deactivated streaming. This can happen
-                 * in, say, nightlies when we toggle can_deactivate half way through the
-                 * dev cycle so half the patches have it true and half false. But there is
-                 * no good default so just maintain this nasty list.
-                 */
-                if (param_ptr[i]->can_deactivate())
+                if (mr->sourceScene != absent)
                 {
-                    auto cg = param_ptr[i]->ctrlgroup;
-                    auto ct = param_ptr[i]->ctrltype;
-
-                    // Do we want to taggle to default deactivated on or off?
-                    if ((cg == cg_LFO) || // this is the LFO rate and env special case
-                        (cg == cg_GLOBAL &&
-                         ct == ct_freq_hpf) || // this is the global highpass special case
-                        (ct == ct_filtertype || ct == ct_wstype) || // filter bypass
-                        (ct == ct_amplitude_clipper)                // scene volume
-                    )
-                    {
-                        param_ptr[i]->deactivated = false;
-                    }
-                    else
-                    {
-                        param_ptr[i]->deactivated = true;
-                    }
+                    t.source_scene = mr->sourceScene;
                 }
-                else if (revision == 16 && param_ptr[i]->ctrlgroup == cg_FX)
+                else
                 {
-                    /*
-                     * So, alas, we added deactivatable FX filters and stuff very late in the 1.9
-                     * cycle. The handle streaming handles 15 versions and stuff but 16s with no POV
-                     * get the random default. Now, you may ask, why not put this inside the
-                     * can_deactivate block? Well since we haven't created the FX yet we don't
-                     * know the type and so we don't know if it is deactivatble.
-                     *
-                     * So what we do is, for revision 16 patches where we don't know if they
-                     * were saved during the 4 months of nightlies or 9 days before release,
-                     * we assume if there is no statement they were saved in the 4 months and
-                     * clobber any unknown deactivated state to false here.
-                     */
-                    param_ptr[i]->deactivated = false;
+                    // Explicitly set scene to A. See #2285
+                    t.source_scene = 0;
                 }
             }
 
-            if (p->QueryIntAttribute("extend_range", &j) == TIXML_SUCCESS)
+            t.muted = mr->muted != absent ? mr->muted : false;
+            t.source_index = mr->sourceIndex != absent ? mr->sourceIndex : 0;
+
+            if (sceneId != 0)
             {
-                param_ptr[i]->set_extend_range((j == 1));
+                t.destination_id = paramIdInScene;
             }
             else
             {
-                param_ptr[i]->set_extend_range(false);
-
-                if (revision >= 16 && param_ptr[i]->ctrltype == ct_percent_oscdrift)
-                {
-                    param_ptr[i]->set_extend_range(true);
-                }
+                t.destination_id = i;
             }
 
-            if (p->QueryIntAttribute("absolute", &j) == TIXML_SUCCESS)
-            {
-                param_ptr[i]->absolute = (j == 1);
-            }
+            modlist->push_back(t);
+        }
+    };
 
-            int sceneId = param_ptr[i]->scene;
-            int paramIdInScene = param_ptr[i]->param_id_in_scene;
-            TiXmlElement *mr = TINYXML_SAFE_TO_ELEMENT(p->FirstChild("modrouting"));
+    TiXmlElement *p;
 
-            /*
-             * Note when we make int modulation work we will have to remove this conditional here
-             */
-            /*
-            if( mr && hasStreamedType && type != vt_float )
-                std::cout << "Dropping modulations for param " << p->Value()
-                << hasStreamedType << " " << type << " " << vt_float << std::endl;
-                */
+    if (block)
+    {
+        auto mr = block->routings.data(), mrEnd = mr + block->routings.size();
+
+        for (int i = 0; i < n; i++)
+        {
+            auto mrFirst = mr;
+            while (mr != mrEnd && mr->param == i)
+                ++mr;
 
-            while (mr && (!hasStreamedType || type == vt_float))
+            // as the preset removal of these elements does for the XML below
+            bool dropped = is_preset && (param_ptr[i] == &fx_bypass ||
+                                         (revision < 17 && param_ptr[i] == &volume));
+
+            if (block->parameters[i].present && !dropped)
+            {
+                applyParameter(i, block->parameters[i], mrFirst, mr);
+            }
+        }
+    }
+    else
+    {
+        // delete volume (below streaming version 17) & fx_bypass if it's a preset
+        if (is_preset)
+        {
+            if (revision < 17)
             {
-                int modsource;
-                double depth;
+                TiXmlElement *tp = TINYXML_SAFE_TO_ELEMENT(parameters->FirstChild("volume"));
 
-                if ((mr->QueryIntAttribute("source", &modsource) == TIXML_SUCCESS) &&
-                    (mr->QueryDoubleAttribute("depth", &depth) == TIXML_SUCCESS))
+                if (tp)
                 {
-                    if (revision < 9)
-                    {
-                        // make room for ctrl8 in old patches
-                        if (modsource > ms_ctrl7)
-                        {
-                            modsource++;
-                        }
-                    }
+                    parameters->RemoveChild(tp);
+                }
+            }
 
-                    // see GitHub issue #6424
-                    if (revision < 21 && param_ptr[i] == &volume)
-                    {
-                        mr = TINYXML_SAFE_TO_ELEMENT(mr->NextSibling("modrouting"));
-                        continue;
-                    }
+            auto tp = TINYXML_SAFE_TO_ELEMENT(parameters->FirstChild("fx_bypass"));
 
-                    vector<ModulationRouting> *modlist = nullptr;
+            if (tp)
+            {
+                parameters->RemoveChild(tp);
+            }
+        }
 
-                    if (sceneId != 0)
-                    {
-                        if (isScenelevel((modsources)modsource))
-                        {
-                            modlist = &scene[sceneId - 1].modulation_scene;
-                        }
-                        else
-                        {
-                            modlist = &scene[sceneId - 1].modulation_voice;
-                        }
-                    }
-                    else
-                    {
-                        modlist = &modulation_global;
-                    }
+        std::vector<StreamedRouting> routings;
 
-                    ModulationRouting t;
-                    t.depth = (float)depth;
-                    t.source_id = modsource;
+        /*
+         * Resolve every element under <parameters> to its parameter in one pass, rather than
+         * searching the siblings per parameter, which goes quadratic as soon as the patch is
+         * missing parameters (empty FX slots, older revisions). First occurrence wins, the
+         * same as FirstChild would have.
+         */
+        std::vector<TiXmlElement *> elementForParam(n, nullptr);
 
-                    if (sceneId != 0)
-                    {
-                        t.source_scene = sceneId - 1;
-                    }
-                    else
-                    {
-                        int sourcescene = 0;
+        for (auto *c = parameters->FirstChildElement(); c; c = c->NextSiblingElement())
+        {
+            auto idx = parameterIndexFromStorageName(c->Value());
 
-                        if (mr->QueryIntAttribute("source_scene", &sourcescene) == TIXML_SUCCESS)
-                        {
-                            t.source_scene = sourcescene;
-                        }
-                        else
-                        {
-                            // Explicitly set scene to A. See #2285
-                            t.source_scene = 0;
-                        }
-                    }
+            if (idx >= 0 && idx < n && !elementForParam[idx])
+            {
+                elementForParam[idx] = c;
+            }
+        }
 
-                    int muted = 0;
+        for (int i = 0; i < n; i++)
+        {
+            p = elementForParam[i];
 
-                    if (mr->QueryIntAttribute("muted", &muted) == TIXML_SUCCESS)
-                    {
-                        t.muted = muted;
-                    }
-                    else
-                    {
-                        t.muted = false;
-                    }
+            if (p)
+            {
+                StreamedParameter sp;
+                sp.present = true;
 
-                    int source_index = 0;
+                if (p->QueryIntAttribute("type", &j) == TIXML_SUCCESS)
+                {
+                    sp.type = j;
+                }
+
+                int type = (sp.type != absent) ? sp.type : param_ptr[i]->valtype;
 
-                    if (mr->QueryIntAttribute("source_index", &source_index) == TIXML_SUCCESS)
+                if (type == (valtypes)vt_float)
+                {
+                    if (p->QueryDoubleAttribute("value", &d) == TIXML_SUCCESS)
                     {
-                        t.source_index = source_index;
+                        sp.hasValue = true;
+                        sp.value.f = (float)d;
                     }
-                    else
+                }
+                else
+                {
+                    if (p->QueryIntAttribute("value", &j) == TIXML_SUCCESS)
                     {
-                        t.source_index = 0;
+                        sp.hasValue = true;
+                        sp.value.i = j;
                     }
+                }
 
-                    if (sceneId != 0)
-                    {
-                        t.destination_id = paramIdInScene;
-                    }
-                    else
+                auto attribute = [p](const char *name, int &onto) {
+                    int v;
+                    if (p->QueryIntAttribute(name, &v) == TIXML_SUCCESS)
+                        onto = v;
+                };
+
+                attribute("temposync", sp.temposync);
+                attribute("porta_const_rate", sp.portaConstRate);
+                attribute("porta_gliss", sp.portaGliss);
+                attribute("porta_retrigger", sp.portaRetrigger);
+                attribute("porta_curve", sp.portaCurve);
+                attribute("deform_type", sp.deformType);
+                attribute("deactivated", sp.deactivated);
+                attribute("extend_range", sp.extendRange);
+                attribute("absolute", sp.absolute);
+
+                routings.clear();
+                TiXmlElement *mr = TINYXML_SAFE_TO_ELEMENT(p->FirstChild("modrouting"));
+
+                while (mr)
+                {
+                    StreamedRouting r;
+                    double depth;
+
+                    if ((mr->QueryIntAttribute("source", &r.source) == TIXML_SUCCESS) &&
+                        (mr->QueryDoubleAttribute("depth", &depth) == TIXML_SUCCESS))
                     {
-                        t.destination_id = i;
+                        r.param = i;
+                        r.depth = (float)depth;
+
+                        int v;
+                        if (mr->QueryIntAttribute("source_scene", &v) == TIXML_SUCCESS)
+                            r.sourceScene = v;
+                        if (mr->QueryIntAttribute("muted", &v) == TIXML_SUCCESS)
+                            r.muted = v;
+                        if (mr->QueryIntAttribute("source_index", &v) == TIXML_SUCCESS)
+                            r.sourceIndex = v;
+
+                        routings.push_back(r);
                     }
 
-                    modlist->push_back(t);
+                    mr = TINYXML_SAFE_TO_ELEMENT(mr->NextSibling("modrouting"));
                 }
 
-                mr = TINYXML_SAFE_TO_ELEMENT(mr->NextSibling("modrouting"));
+                applyParameter(i, sp, routings.data(), routings.data() + routings.size());
             }
         }
     }
@@ -1949,6 +2129,25 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
                     }
                 }
             }
+
+            {
+                std::string mvname = "polyVoiceStealingMode_" + std::to_string(sc);
+                auto *mv1 = TINYXML_SAFE_TO_ELEMENT(nonparamconfig->FirstChild(mvname));
+                storage->getPatch().scene[sc].polyVoiceStealingMode = STEAL_OLDEST;
+
+                if (mv1)
+                {
+                    // Get value
+                    int mvv;
+
+                    if (mv1->QueryIntAttribute("v", &mvv) == TIXML_SUCCESS &&
+                        mvv >= STEAL_OLDEST && mvv <= STEAL_HIGHEST)
+                    {
+                        storage->getPatch().scene[sc].polyVoiceStealingMode =
+                            (PolyVoiceStealingMode)mvv;
+                    }
+                }
+            }
         }
 
         auto *tam = TINYXML_SAFE_TO_ELEMENT(nonparamconfig->FirstChild("tuningApplicationMode"));
@@ -2252,6 +2451,7 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
         {
             sc.monoVoiceEnvelopeMode = RESTART_FROM_ZERO;
             sc.polyVoiceRepeatedKeyMode = NEW_VOICE_EVERY_NOTEON;
+            sc.polyVoiceStealingMode = STEAL_OLDEST;
         }
     }
 
@@ -2538,6 +2738,28 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
         p = TINYXML_SAFE_TO_ELEMENT(p->NextSibling("formula"));
     }
 
+    for (auto &f : fx)
+    {
+        f.impulseResponsePath.clear();
+    }
+
+    TiXmlElement *irs = TINYXML_SAFE_TO_ELEMENT(patch->FirstChild("impulseresponses"));
+    p = irs ? TINYXML_SAFE_TO_ELEMENT(irs->FirstChild("ir")) : nullptr;
+
+    while (p)
+    {
+        int slot;
+        auto *path = p->Attribute("path");
+
+        if (p->QueryIntAttribute("slot", &slot) == TIXML_SUCCESS && slot >= 0 &&
+            slot < n_fx_slots && path)
+        {
+            fx[slot].impulseResponsePath = path;
+        }
+
+        p = TINYXML_SAFE_TO_ELEMENT(p->NextSibling("ir"));
+    }
+
     for (int i = 0; i < n_customcontrollers; i++)
     {
         scene[0].modsources[ms_ctrl1 + i]->reset();
@@ -2973,6 +3195,7 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
                         node->QueryFloatAttribute("noise_floor", &oos->noise_floor);
                         node->QueryFloatAttribute("max_db", &oos->max_db);
                         node->QueryFloatAttribute("decay_rate", &oos->decay_rate);
+                        node->QueryIntAttribute("spectrum_overlap", &oos->spectrum_overlap);
                     }
                 }
             } // end of editor populated block
@@ -3082,6 +3305,14 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
                 dawExtraState.tuningApplicationMode = 1; // RETUNE_MIDI_ONLY
             }
 
+            p = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("bounceQualityWhenOffline"));
+            dawExtraState.bounceQualityWhenOffline = true;
+
+            if (p && p->QueryIntAttribute("v", &ival) == TIXML_SUCCESS)
+            {
+                dawExtraState.bounceQualityWhenOffline = (ival != 0);
+            }
+
             auto mts_main = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("oddsound_mts_active_as_main"));
             if (mts_main)
             {
@@ -3295,7 +3526,8 @@ struct srge_header
     int revision;
 };
 
-unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed by the callee
+// allocates mem, must be freed by the callee
+unsigned int SurgePatch::save_xml(void **data, Surge::Storage::ParameterBlock *block)
 {
     assert(data);
 
@@ -3334,6 +3566,18 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
 
     TiXmlElement parameters("parameters");
 
+    using Surge::Storage::StreamedParameter;
+    using Surge::Storage::StreamedRouting;
+    constexpr int absent = StreamedParameter::absent;
+
+    if (block)
+    {
+        block->parameters.assign(n, StreamedParameter());
+        block->routings.clear();
+    }
+
+    std::vector<StreamedRouting> routings;
+
     for (int i = 0; i < n; i++)
     {
         TiXmlElement p(param_ptr[i]->get_storage_name());
@@ -3352,6 +3596,8 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
 
         if (!skip)
         {
+            routings.clear();
+
             if (s_id > 0)
             {
                 for (int a = 0; a < 2; a++)
@@ -3366,12 +3612,13 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
                         {
                             // if you add something here make sure to replicated it in the global
                             // below
-                            TiXmlElement mr("modrouting");
-                            mr.SetAttribute("source", r->at(b).source_id);
-                            mr.SetAttribute("depth", float_to_clocalestr(r->at(b).depth));
-                            mr.SetAttribute("muted", r->at(b).muted);
-                            mr.SetAttribute("source_index", r->at(b).source_index);
-                            p.InsertEndChild(mr);
+                            StreamedRouting mr;
+                            mr.param = i;
+                            mr.source = r->at(b).source_id;
+                            mr.depth = r->at(b).depth;
+                            mr.muted = r->at(b).muted;
+                            mr.sourceIndex = r->at(b).source_index;
+                            routings.push_back(mr);
                         }
                     }
                 }
@@ -3384,49 +3631,93 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
                 {
                     if (r->at(b).destination_id == i)
                     {
-                        TiXmlElement mr("modrouting");
-                        mr.SetAttribute("source", r->at(b).source_id);
-                        mr.SetAttribute("depth", float_to_clocalestr(r->at(b).depth));
-                        mr.SetAttribute("muted", r->at(b).muted);
-                        mr.SetAttribute("source_index", r->at(b).source_index);
-                        mr.SetAttribute("source_scene", r->at(b).source_scene);
-                        p.InsertEndChild(mr);
+                        StreamedRouting mr;
+                        mr.param = i;
+                        mr.source = r->at(b).source_id;
+                        mr.depth = r->at(b).depth;
+                        mr.muted = r->at(b).muted;
+                        mr.sourceIndex = r->at(b).source_index;
+                        mr.sourceScene = r->at(b).source_scene;
+                        routings.push_back(mr);
                     }
                 }
             }
 
+            for (const auto &r : routings)
+            {
+                TiXmlElement mr("modrouting");
+                mr.SetAttribute("source", r.source);
+                mr.SetAttribute("depth", float_to_clocalestr(r.depth));
+                mr.SetAttribute("muted", r.muted);
+                mr.SetAttribute("source_index", r.sourceIndex);
+                if (r.sourceScene != absent)
+                    mr.SetAttribute("source_scene", r.sourceScene);
+                p.InsertEndChild(mr);
+            }
+
+            StreamedParameter sp;
+            sp.present = true;
+            sp.hasValue = true;
+
             if (param_ptr[i]->valtype == (valtypes)vt_float)
             {
+                sp.type = vt_float;
+                sp.value.f = param_ptr[i]->val.f;
                 p.SetAttribute("type", vt_float);
                 p.SetAttribute("value", param_ptr[i]->get_storage_value(tempstr));
             }
             else
             {
+                sp.type = vt_int;
+                sp.value.i = param_ptr[i]->valtype == vt_bool ? (param_ptr[i]->val.b ? 1 : 0)
+                                                               : param_ptr[i]->val.i;
                 p.SetAttribute("type", vt_int);
                 p.SetAttribute("value", param_ptr[i]->get_storage_value(tempstr));
             }
 
             if (param_ptr[i]->temposync)
-                p.SetAttribute("temposync", "1");
+                sp.temposync = 1;
 
             if (param_ptr[i]->extend_range)
-                p.SetAttribute("extend_range", "1");
+                sp.extendRange = 1;
             else if (param_ptr[i]->can_extend_range())
-                p.SetAttribute("extend_range", "0");
+                sp.extendRange = 0;
 
             if (param_ptr[i]->absolute)
-                p.SetAttribute("absolute", "1");
+                sp.absolute = 1;
             if (param_ptr[i]->can_deactivate())
-                p.SetAttribute("deactivated", param_ptr[i]->deactivated ? "1" : "0");
+                sp.deactivated = param_ptr[i]->deactivated ? 1 : 0;
             if (param_ptr[i]->has_portaoptions())
             {
-                p.SetAttribute("porta_const_rate", param_ptr[i]->porta_constrate ? "1" : "0");
-                p.SetAttribute("porta_gliss", param_ptr[i]->porta_gliss ? "1" : "0");
-                p.SetAttribute("porta_retrigger", param_ptr[i]->porta_retrigger ? "1" : "0");
-                p.SetAttribute("porta_curve", param_ptr[i]->porta_curve);
+                sp.portaConstRate = param_ptr[i]->porta_constrate ? 1 : 0;
+                sp.portaGliss = param_ptr[i]->porta_gliss ? 1 : 0;
+                sp.portaRetrigger = param_ptr[i]->porta_retrigger ? 1 : 0;
+                sp.portaCurve = param_ptr[i]->porta_curve;
             }
             if (param_ptr[i]->has_deformoptions())
-                p.SetAttribute("deform_type", param_ptr[i]->deform_type);
+                sp.deformType = param_ptr[i]->deform_type;
+
+            // the XML writes exactly what the block records
+            auto attribute = [&p](const char *name, int v) {
+                if (v != absent)
+                    p.SetAttribute(name, v);
+            };
+
+            attribute("temposync", sp.temposync);
+            attribute("extend_range", sp.extendRange);
+            attribute("absolute", sp.absolute);
+            attribute("deactivated", sp.deactivated);
+            attribute("porta_const_rate", sp.portaConstRate);
+            attribute("porta_gliss", sp.portaGliss);
+            attribute("porta_retrigger", sp.portaRetrigger);
+            attribute("porta_curve", sp.portaCurve);
+            attribute("deform_type", sp.deformType);
+
+            if (block)
+            {
+                block->parameters[i] = sp;
+                block->routings.insert(block->routings.end(), routings.begin(), routings.end());
+            }
 
             // param_ptr[i]->val.i;
             parameters.InsertEndChild(p);
@@ -3459,6 +3750,14 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
         nonparamconfig.InsertEndChild(mvv);
     }
 
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        std::string mvname = "polyVoiceStealingMode_" + std::to_string(sc);
+        TiXmlElement mvv(mvname);
+        mvv.SetAttribute("v", storage->getPatch().scene[sc].polyVoiceStealingMode);
+        nonparamconfig.InsertEndChild(mvv);
+    }
+
     TiXmlElement hcs("hardclipmodes");
     hcs.SetAttribute("global", (int)(storage->hardclipMode));
     for (int sc = 0; sc < n_scenes; ++sc)
@@ -3580,6 +3879,19 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
     }
     patch.InsertEndChild(formulae);
 
+    TiXmlElement irs("impulseresponses");
+    for (int i = 0; i < n_fx_slots; i++)
+    {
+        if (fx[i].type.val.i == fxt_convolution && !fx[i].impulseResponsePath.empty())
+        {
+            TiXmlElement p("ir");
+            p.SetAttribute("slot", i);
+            p.SetAttribute("path", fx[i].impulseResponsePath);
+            irs.InsertEndChild(p);
+        }
+    }
+    patch.InsertEndChild(irs);
+
     TiXmlElement extralfo("extralfo");
     for (int sc = 0; sc < n_scenes; sc++)
     {
@@ -3680,6 +3992,29 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
     tempoOnSave.SetDoubleAttribute("v", storage->temposyncratio * 120.0);
     patch.InsertEndChild(tempoOnSave);
 
+    dawExtraStateToXMLElement(patch);
+
+    doc.InsertEndChild(decl);
+    doc.InsertEndChild(patch);
+
+    std::string s;
+    s << doc;
+
+    if (block && !block->locateInXML(s.data(), s.size()))
+    {
+        // nothing to point the block at, so leave it empty and unwritten
+        block->parameters.clear();
+        block->routings.clear();
+    }
+
+    void *d = malloc(s.size());
+    memcpy(d, s.data(), s.size());
+    *data = d;
+    return s.size();
+}
+
+void SurgePatch::dawExtraStateToXMLElement(TiXmlElement &parent) const
+{
     TiXmlElement dawExtraXML("dawExtraState");
     dawExtraXML.SetAttribute("populated", dawExtraState.isPopulated ? 1 : 0);
 
@@ -3791,6 +4126,8 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
         scope.SetDoubleAttribute("max_db", dawExtraState.editor.oscilloscopeOverlayState.max_db);
         scope.SetDoubleAttribute("decay_rate",
                                  dawExtraState.editor.oscilloscopeOverlayState.decay_rate);
+        scope.SetAttribute("spectrum_overlap",
+                           dawExtraState.editor.oscilloscopeOverlayState.spectrum_overlap);
         eds.InsertEndChild(scope);
 
         dawExtraXML.InsertEndChild(eds);
@@ -3847,6 +4184,10 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
         tam.SetAttribute("v", dawExtraState.tuningApplicationMode);
         dawExtraXML.InsertEndChild(tam);
 
+        TiXmlElement bqo("bounceQualityWhenOffline");
+        bqo.SetAttribute("v", dawExtraState.bounceQualityWhenOffline ? 1 : 0);
+        dawExtraXML.InsertEndChild(bqo);
+
         TiXmlElement tun("hasTuning"); // see comment: Keep this name here for legacy compat
         tun.SetAttribute("v", dawExtraState.hasScale ? 1 : 0);
         dawExtraXML.InsertEndChild(tun);
@@ -3934,18 +4275,93 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
         }
         dawExtraXML.InsertEndChild(cchm);
     }
-    patch.InsertEndChild(dawExtraXML);
+    parent.InsertEndChild(dawExtraXML);
+}
 
-    doc.InsertEndChild(decl);
-    doc.InsertEndChild(patch);
+SurgePatch::StreamedStateKey SurgePatch::streamedStateKey() const
+{
+    StreamedStateKey key;
+    key.dirtyGeneration = isDirty.generation;
+
+    // FNV-1a, which is plenty to notice that something changed
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const void *d, size_t n) {
+        auto c = static_cast<const unsigned char *>(d);
+        for (size_t i = 0; i < n; ++i)
+            h = (h ^ c[i]) * 1099511628211ULL;
+    };
+    auto mixInt = [&mix](int v) { mix(&v, sizeof(v)); };
 
-    std::string s;
-    s << doc;
+    for (const auto *p : param_ptr)
+    {
+        mix(&p->val, sizeof(p->val));
+        mixInt(p->temposync | p->extend_range << 1 | p->absolute << 2 | p->deactivated << 3 |
+               p->porta_constrate << 4 | p->porta_gliss << 5 | p->porta_retrigger << 6);
+        mixInt(p->porta_curve);
+        mixInt(p->deform_type);
+    }
 
-    void *d = malloc(s.size());
-    memcpy(d, s.data(), s.size());
-    *data = d;
-    return s.size();
+    auto mixRoutings = [&](const std::vector<ModulationRouting> &routings) {
+        mixInt(routings.size());
+        for (const auto &r : routings)
+        {
+            mixInt(r.source_id);
+            mixInt(r.source_scene);
+            mixInt(r.source_index);
+            mixInt(r.destination_id);
+            mixInt(r.muted);
+            mix(&r.depth, sizeof(r.depth));
+        }
+    };
+
+    mixRoutings(modulation_global);
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        mixRoutings(scene[sc].modulation_scene);
+        mixRoutings(scene[sc].modulation_voice);
+        mixInt(scene[sc].monoVoicePriorityMode);
+        mixInt(scene[sc].monoVoiceEnvelopeMode);
+        mixInt(scene[sc].polyVoiceRepeatedKeyMode);
+        mixInt(scene[sc].polyVoiceStealingMode);
+        mixInt(storage->sceneHardclipMode[sc]);
+
+        for (int os = 0; os < n_oscs; ++os)
+        {
+            const auto &wt = scene[sc].osc[os].wt;
+            mixInt(wt.size);
+            mixInt(wt.n_tables);
+            mixInt(wt.flags);
+            key.tables[sc][os] = wt.builtTableData();
+        }
+    }
+
+    mixInt(storage->hardclipMode);
+    mixInt(storage->tuningApplicationMode);
+    mixInt(storage->patchStoredTuningApplicationMode);
+    mixInt(storage->oddsound_mts_active_as_client);
+    mix(&storage->temposyncratio, sizeof(storage->temposyncratio));
+    key.hash = h;
+
+    TiXmlElement des("des");
+    dawExtraStateToXMLElement(des);
+    key.dawExtraState << des;
+
+    return key;
+}
+
+bool SurgePatch::StreamedStateKey::matches(const StreamedStateKey &other) const
+{
+    if (dirtyGeneration != other.dirtyGeneration || hash != other.hash ||
+        dawExtraState != other.dawExtraState)
+        return false;
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+        for (int os = 0; os < n_oscs; ++os)
+            if (tables[sc][os].lock() != other.tables[sc][os].lock())
+                return false;
+
+    return true;
 }
 
 void SurgePatch::msegToXMLElement(MSEGStorage *ms, TiXmlElement &p) const
@@ -4200,4 +4616,6 @@ void SurgePatch::formulaFromXMLElement(FormulaModulatorStorage *fs, TiXmlElement
     {
         fs->interpreter = (FormulaModulatorStorage::Interpreter)(interp);
     }
+
+    Surge::Formula::precompileFormula(storage, fs);
 }
@@ -50,6 +50,13 @@
 #include "FxPresetAndClipboardManager.h"
 #include "ModulatorPresetManager.h"
 #include "SurgeMemoryPools.h"
+#include "LargePageAllocator.h"
+#include "RealtimeSafety.h"
+#include "SurgeTrace.h"
+#include "ThreadPolicy.h"
+#include "PatchListSnapshot.h"
+#include "WavetableCacheFile.h"
+#include "WaveshaperADAA.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
 
 // FIXME probably remove this when we remove the hardcoded hack below
@@ -62,10 +69,125 @@ namespace mech = sst::basic_blocks::mechanics;
 
 using namespace std;
 
+struct SurgeStorage::RateTables
+{
+    float note_omega alignas(16)[2][tuning_table_size];
+    float envrate_linear alignas(16)[512], envrate_lpf alignas(16)[512];
+
+    void build(double dsamplerate_os, const float *pitch)
+    {
+        double dsamplerate_os_inv = 1.0 / dsamplerate_os;
+        float db60 = powf(10.f, 0.05f * -60.f);
+
+        for (int i = 0; i < tuning_table_size; i++)
+        {
+            note_omega[0][i] = (float)sin(2 * M_PI * min(0.5, 440 * pitch[i] * dsamplerate_os_inv));
+            note_omega[1][i] = (float)cos(2 * M_PI * min(0.5, 440 * pitch[i] * dsamplerate_os_inv));
+            double k =
+                dsamplerate_os * pow(2.0, (((double)i - 256.0) / 16.0)) / (double)BLOCK_SIZE_OS;
+            envrate_linear[i] = (float)(1.f / k);
+            envrate_lpf[i] = (float)(1.f - exp(log(db60) / k));
+        }
+    }
+};
+
+struct SurgeStorage::SharedTables
+{
+    float dB alignas(16)[512], glide_exp alignas(16)[512], glide_log alignas(16)[512];
+    float pitch alignas(16)[tuning_table_size], pitch_inv alignas(16)[tuning_table_size];
+    float two_to_the alignas(16)[1001], two_to_the_minus alignas(16)[1001];
+
+    sst::basic_blocks::tables::SurgeSincTableProvider sinc;
+
+    /*
+     * The tables which depend on the sample rate only, not the tuning, kept per rate. Hosts
+     * re-prepare far more often than they change rate, and usually bounce between the same few
+     * rates, so the common ones are built up front and any other is built on first use.
+     */
+    std::mutex rateLock;
+    std::map<double, std::unique_ptr<RateTables>> rates;
+
+    const RateTables *forSamplerate(float sr)
+    {
+        // the same arithmetic setSamplerate uses, so the tables come out bit identical
+        double os = (double)sr * OSC_OVERSAMPLING;
+
+        std::lock_guard<std::mutex> g(rateLock);
+        auto &r = rates[os];
+        if (!r)
+        {
+            r = std::make_unique<RateTables>();
+            r->build(os, pitch);
+        }
+        return r.get();
+    }
+
+    SharedTables()
+    {
+        float _512th = 1.f / 512.f;
+
+        for (int i = 0; i < tuning_table_size; i++)
+        {
+            dB[i] = powf(10.f, 0.05f * ((float)i - 384.f));
+            pitch[i] = powf(2.f, ((float)i - 256.f) * (1.f / 12.f));
+            pitch_inv[i] = 1.f / pitch[i];
+            glide_log[i] = log2(1.0 + (i * _512th * 10.f)) / log2(1.f + 10.f);
+            glide_exp[511 - i] = 1.0 - glide_log[i];
+        }
+
+        for (int i = 0; i < 1001; ++i)
+        {
+            double twelths = i * 1.0 / 12.0 / 1000.0;
+            two_to_the[i] = pow(2.0, twelths);
+            two_to_the_minus[i] = pow(2.0, -twelths);
+        }
+
+        for (auto sr : {44100.f, 48000.f, 88200.f, 96000.f, 192000.f})
+        {
+            forSamplerate(sr);
+        }
+    }
+
+    // the sinc provider is handed out as non-const pointers, so this is too
+    static SharedTables &get()
+    {
+        static SharedTables instance;
+        return instance;
+    }
+};
+
+namespace
+{
+/*
+ * The window wavetable and configuration.xml compiled into the binary are also the same for
+ * everyone, so the first instance decodes and parses them and the rest copy the result. A
+ * copied wavetable shares its data, and copying a document is much cheaper than parsing it.
+ */
+struct SharedResources
+{
+    std::mutex lock;
+    bool windowLoaded{false}, windowValid{false};
+    Wavetable window;
+    bool configurationParsed{false}, configurationValid{false};
+    TiXmlDocument configuration;
+    std::string configurationError;
+
+    static SharedResources &get()
+    {
+        static SharedResources instance;
+        return instance;
+    }
+};
+} // namespace
+
 std::string SurgeStorage::skipPatchLoadDataPathSentinel = "<SKIP-PATCH-SENTINEL>";
 
 SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : otherscene_clients(0)
 {
+    diagnosticErrorForwarder.storage = this;
+    diagnostics.addListener(&diagnosticErrorForwarder);
+    diagnostics.startDelivering();
+
     auto suppliedDataPath = config.suppliedDataPath;
     bool loadWtAndPatch = true;
     loadWtAndPatch = !skipLoadWtAndPatch && suppliedDataPath != skipPatchLoadDataPathSentinel &&
@@ -74,6 +196,15 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     if (suppliedDataPath == skipPatchLoadDataPathSentinel)
         suppliedDataPath = "";
 
+    auto &shared = SharedTables::get();
+    table_dB = shared.dB;
+    table_glide_exp = shared.glide_exp;
+    table_glide_log = shared.glide_log;
+    table_pitch_ignoring_tuning = shared.pitch;
+    table_pitch_inv_ignoring_tuning = shared.pitch_inv;
+    table_two_to_the = shared.two_to_the;
+    table_two_to_the_minus = shared.two_to_the_minus;
+
     if (samplerate == 0)
     {
         setSamplerate(48000);
@@ -93,9 +224,10 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     }
 
     _patch.reset(new SurgePatch(this));
+    audioRoutings = new Surge::Storage::ModulationRoutingSnapshot();
 
     namespace tabl = sst::basic_blocks::tables;
-    sincTableProvider = std::make_unique<tabl::SurgeSincTableProvider>();
+    sincTableProvider = &shared.sinc;
     static_assert(tabl::SurgeSincTableProvider::FIRipol_M == FIRipol_M);
     static_assert(tabl::SurgeSincTableProvider::FIRipol_N == FIRipol_N);
     static_assert(tabl::SurgeSincTableProvider::FIRipolI16_N == FIRipolI16_N);
@@ -116,6 +248,8 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
                     getPatch().scene[s].osc[o].wt.TableF32WeakPointers[i][j] = 0;
                     getPatch().scene[s].osc[o].wt.TableI16WeakPointers[i][j] = 0;
                 }
+            getPatch().scene[s].osc[o].wt.mipmapBuilder = &wavetableMipmapBuilder;
+            getPatch().scene[s].osc[o].wt.buildCompact = &compactWavetables;
             getPatch().scene[s].osc[o].extraConfig.nData = 0;
             memset(getPatch().scene[s].osc[0].extraConfig.data, 0,
                    sizeof(float) * OscillatorStorage::ExtraConfigurationData::max_config);
@@ -143,6 +277,7 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     }
 
     init_tables();
+    prepareAntialiasedWaveshapers();
 
     pitch_bend = 0;
     last_key[0] = 60;
@@ -369,6 +504,23 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
         userDataPath = fs::path{userSpecifiedDataPath};
     }
 
+    // This is process wide and needs to be set before the big buffers get made
+    Surge::Memory::setLargePageMode(
+        (Surge::Memory::LargePageMode)Surge::Storage::getUserDefaultValue(
+            this, Surge::Storage::LargePageAllocation, (int)Surge::Memory::LargePageMode::Off));
+
+    // As is this, and the patch database below already starts a loader
+    {
+        Surge::Threading::ThreadPolicy tp;
+        tp.realtimePriority =
+            Surge::Storage::getUserDefaultValue(this, Surge::Storage::ThreadRealtimePriority, 0);
+        tp.realtimeCores = Surge::Threading::parseCoreList(
+            Surge::Storage::getUserDefaultValue(this, Surge::Storage::ThreadRealtimeCores, ""));
+        tp.loaderNice =
+            Surge::Storage::getUserDefaultValue(this, Surge::Storage::ThreadLoaderNice, 0);
+        Surge::Threading::setThreadPolicy(tp);
+    }
+
     // append separator if not present
     userPatchesPath = userDataPath / "Patches";
     userPatchesMidiProgramChangePath = userPatchesPath / midiProgramChangePatchesSubdir;
@@ -386,11 +538,32 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
         createUserDirectory();
     }
 
-    // TIXML requires a newline at end.
 #if HAS_JUCE
-    auto cxmlData = std::string(SurgeSharedBinary::configuration_xml,
-                                SurgeSharedBinary::configuration_xmlSize) +
-                    "\n";
+    {
+        auto &res = SharedResources::get();
+        std::lock_guard<std::mutex> g(res.lock);
+
+        if (!res.configurationParsed)
+        {
+            // TIXML requires a newline at end.
+            auto cxmlData = std::string(SurgeSharedBinary::configuration_xml,
+                                        SurgeSharedBinary::configuration_xmlSize) +
+                            "\n";
+            res.configurationParsed = true;
+            res.configurationValid = res.configuration.Parse(cxmlData.c_str()) != nullptr;
+            if (!res.configurationValid)
+                res.configurationError = res.configuration.ErrorDesc();
+        }
+
+        snapshotloader = res.configuration;
+
+        if (!res.configurationValid)
+        {
+            std::cout << res.configurationError << std::endl;
+            reportError("Cannot parse 'configuration.xml' from memory. Internal Software Error.",
+                        "Surge Incorrectly Built");
+        }
+    }
 #else
     std::string cxmlData;
 
@@ -406,28 +579,40 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
         cxmlData = std::string(
             "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\" ?><midictrl/>");
     }
+
+    snapshotloader.Parse(cxmlData.c_str());
 #endif
-    if (!snapshotloader.Parse(cxmlData.c_str()))
-    {
-#if HAS_JUCE
-        std::cout << snapshotloader.ErrorDesc() << std::endl;
-        reportError("Cannot parse 'configuration.xml' from memory. Internal Software Error.",
-                    "Surge Incorrectly Built");
-#endif
-    }
 
     load_midi_controllers();
 
-    patchDB = std::make_unique<Surge::PatchStorage::PatchDB>(this);
+    patchDB = Surge::PatchStorage::PatchDB::acquire(this);
     if (loadWtAndPatch)
     {
-        refresh_wtlist();
-        refresh_patchlist();
+        if (!restore_wtlist())
+            refresh_wtlist();
+        if (!restore_patchlist())
+            refresh_patchlist();
     }
 
 #if HAS_JUCE
-    if (!load_wt_wt_mem(SurgeSharedBinary::windows_wt, SurgeSharedBinary::windows_wtSize,
-                        &WindowWT))
+    bool windowValid = false;
+    {
+        auto &res = SharedResources::get();
+        std::lock_guard<std::mutex> g(res.lock);
+
+        if (!res.windowLoaded)
+        {
+            res.windowLoaded = true;
+            res.windowValid = load_wt_wt_mem(SurgeSharedBinary::windows_wt,
+                                             SurgeSharedBinary::windows_wtSize, &res.window);
+        }
+
+        windowValid = res.windowValid;
+        if (windowValid)
+            WindowWT.Copy(&res.window);
+    }
+
+    if (!windowValid)
     {
         WindowWT.size = 0;
         std::ostringstream oss;
@@ -599,7 +784,7 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     try
     {
         fxUserPreset = std::make_unique<Surge::Storage::FxUserPreset>();
-        fxUserPreset->doPresetRescan(this);
+        fxUserPreset->startPresetScan(this);
     }
     catch (fs::filesystem_error &e)
     {
@@ -609,7 +794,7 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     try
     {
         modulatorPreset = std::make_unique<Surge::Storage::ModulatorPreset>();
-        modulatorPreset->forcePresetRescan();
+        modulatorPreset->startPresetScan(this);
     }
     catch (fs::filesystem_error &e)
     {
@@ -683,10 +868,17 @@ void SurgeStorage::initializePatchDb(bool force)
 
     patchDBInitialized = true;
 
+    // the first storage to get here indexes the libraries for every one sharing the database
+    if (!patchDB->claimIndexing(force))
+        return;
+
     // We do this here, because if there is a schema upgrade we need to do it before we do a patch
     // read, even though our next activity is a read
     patchDB->prepareForWrites();
 
+    if (patchModTimesStale)
+        refreshPatchModTimes();
+
     auto awid = patchDB->readAllPatchPathsWithIdAndModTime();
     std::vector<Patch> addThese;
     for (const auto p : patch_list)
@@ -763,6 +955,7 @@ void SurgeStorage::refresh_patchlist()
 {
     patch_category.clear();
     patch_list.clear();
+    scannedDirectories.clear();
 
     refreshPatchlistAddDir(false, "patches_factory");
     firstThirdPartyCategory = patch_category.size();
@@ -805,6 +998,97 @@ void SurgeStorage::refresh_patchlist()
         patch_category[patchCategoryOrdering[i]].order = i;
     }
 
+    refreshPatchModTimes();
+
+    auto snap = std::make_shared<Surge::Storage::PatchListSnapshot>();
+    snap->directories = std::move(scannedDirectories);
+    snap->items = patch_list;
+    snap->categories = patch_category;
+    snap->firstThirdPartyCategory = firstThirdPartyCategory;
+    snap->firstUserCategory = firstUserCategory;
+    snap->ordering = patchOrdering;
+    snap->categoryOrdering = patchCategoryOrdering;
+    Surge::Storage::publishPatchListSnapshot(patchListSnapshotKey(), snap,
+                                             listSnapshotFile("SurgePatchList.cache"));
+    scannedDirectories.clear();
+
+    applyPatchFavoritesAndProgramChanges();
+}
+
+bool SurgeStorage::restore_patchlist()
+{
+    auto snap = Surge::Storage::findPatchListSnapshot(patchListSnapshotKey(),
+                                                      listSnapshotFile("SurgePatchList.cache"));
+
+    if (!snap)
+        return false;
+
+    patch_list = snap->items;
+    patch_category = snap->categories;
+    firstThirdPartyCategory = snap->firstThirdPartyCategory;
+    firstUserCategory = snap->firstUserCategory;
+    patchOrdering = snap->ordering;
+    patchCategoryOrdering = snap->categoryOrdering;
+
+    /*
+     * Saving over a patch in place doesn't touch its directory, so the times we were handed
+     * can be behind. Nothing but the patch DB reads them, so leave the stat of every patch
+     * until that starts rather than paying for it here.
+     */
+    patchModTimesStale = true;
+
+    applyPatchFavoritesAndProgramChanges();
+    return true;
+}
+
+std::string SurgeStorage::patchListSnapshotKey() const
+{
+    return "patches\n" + path_to_string(datapath) + "\n" + path_to_string(userDataPath);
+}
+
+std::string SurgeStorage::wtListSnapshotKey() const
+{
+    return "wavetables\n" + path_to_string(datapath) + "\n" + path_to_string(userDataPath) +
+           "\n" + path_to_string(extraThirdPartyWavetablesPath) + "\n" +
+           path_to_string(extraUserWavetablesPath);
+}
+
+fs::path SurgeStorage::listSnapshotFile(const std::string &name) const
+{
+    // without a user folder we still share between instances, just not with the next session
+    if (!userDataPathValid)
+        return {};
+
+    return userDataPath / fs::path{name};
+}
+
+void SurgeStorage::refreshPatchModTimes()
+{
+    patchModTimesStale = false;
+
+    for (auto &p : patch_list)
+    {
+        try
+        {
+            auto qtime = fs::last_write_time(p.path);
+            p.lastModTime =
+                std::chrono::duration_cast<std::chrono::seconds>(qtime.time_since_epoch()).count();
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::ostringstream erross;
+            erross << "Unable to determine the modification time of '" << p.path.u8string() << ". "
+                   << "This usually means the file can't be opened, or is a broken symlink, or "
+                      "some such. Underlying error: "
+                   << e.what();
+            reportError(erross.str(), "Unable to Read File Time");
+            p.lastModTime = 0;
+        }
+    }
+}
+
+void SurgeStorage::applyPatchFavoritesAndProgramChanges()
+{
     auto favorites = patchDB->readUserFavorites();
     auto pathToTrunc = [](const std::string &s) -> std::string {
         auto pf = s.find("patches_factory");
@@ -832,22 +1116,6 @@ void SurgeStorage::refresh_patchlist()
     }
     for (auto &p : patch_list)
     {
-        try
-        {
-            auto qtime = fs::last_write_time(p.path);
-            p.lastModTime =
-                std::chrono::duration_cast<std::chrono::seconds>(qtime.time_since_epoch()).count();
-        }
-        catch (const fs::filesystem_error &e)
-        {
-            std::ostringstream erross;
-            erross << "Unable to determine the modification time of '" << p.path.u8string() << ". "
-                   << "This usually means the file can't be opened, or is a broken symlink, or "
-                      "some such. Underlying error: "
-                   << e.what();
-            reportError(erross.str(), "Unable to Read File Time");
-            p.lastModTime = 0;
-        }
         auto ps = p.path.u8string();
         auto pf = pathToTrunc(ps);
 
@@ -941,14 +1209,15 @@ void SurgeStorage::refreshPatchlistAddDir(bool userDir, string subdir)
     refreshPatchOrWTListAddDir(
         userDir, userDir ? userDataPath : datapath, subdir,
         [](std::string s) -> bool { return _stricmp(s.c_str(), ".fxp") == 0; }, patch_list,
-        patch_category);
+        patch_category, scannedDirectories);
 }
 
 void SurgeStorage::refreshPatchOrWTListAddDir(bool userDir, const fs::path &initialPatchPath,
                                               string subdir,
                                               std::function<bool(std::string)> filterOp,
                                               std::vector<Patch> &items,
-                                              std::vector<PatchCategory> &categories)
+                                              std::vector<PatchCategory> &categories,
+                                              std::vector<std::pair<fs::path, int64_t>> &directories)
 {
     int category = categories.size();
 
@@ -961,6 +1230,8 @@ void SurgeStorage::refreshPatchOrWTListAddDir(bool userDir, const fs::path &init
         if (!subdir.empty())
             patchpath /= subdir;
 
+        directories.emplace_back(patchpath, Surge::Storage::directoryModTime(patchpath));
+
         if (!fs::is_directory(patchpath))
         {
             return;
@@ -988,6 +1259,8 @@ void SurgeStorage::refreshPatchOrWTListAddDir(bool userDir, const fs::path &init
                 {
                     alldirs.push_back(d);
                     workStack.push_back(d);
+                    directories.emplace_back(d.path(),
+                                             Surge::Storage::directoryModTime(d.path()));
                 }
             }
         }
@@ -1040,6 +1313,10 @@ void SurgeStorage::refreshPatchOrWTListAddDir(bool userDir, const fs::path &init
         std::ostringstream oss;
         oss << "Experienced filesystem error when building patches. " << e.what();
         reportError(oss.str(), "Filesystem Error");
+
+        // don't let a snapshot of this partial walk stand in for a good one
+        directories.emplace_back(initialPatchPath,
+                                 Surge::Storage::PatchListSnapshot::unreadableDirectory);
     }
 
     /*
@@ -1125,6 +1402,7 @@ void SurgeStorage::refresh_wtlist()
 {
     wt_category.clear();
     wt_list.clear();
+    scannedDirectories.clear();
 
     refresh_wtlistAddDir(false, "wavetables");
 
@@ -1231,6 +1509,35 @@ void SurgeStorage::refresh_wtlist()
 
     for (int i = 0; i < wt_list.size(); i++)
         wt_list[wtOrdering[i]].order = i;
+
+    auto snap = std::make_shared<Surge::Storage::PatchListSnapshot>();
+    snap->directories = std::move(scannedDirectories);
+    snap->items = wt_list;
+    snap->categories = wt_category;
+    snap->firstThirdPartyCategory = firstThirdPartyWTCategory;
+    snap->firstUserCategory = firstUserWTCategory;
+    snap->ordering = wtOrdering;
+    snap->categoryOrdering = wtCategoryOrdering;
+    Surge::Storage::publishPatchListSnapshot(wtListSnapshotKey(), snap,
+                                             listSnapshotFile("SurgeWavetableList.cache"));
+    scannedDirectories.clear();
+}
+
+bool SurgeStorage::restore_wtlist()
+{
+    auto snap = Surge::Storage::findPatchListSnapshot(
+        wtListSnapshotKey(), listSnapshotFile("SurgeWavetableList.cache"));
+
+    if (!snap)
+        return false;
+
+    wt_list = snap->items;
+    wt_category = snap->categories;
+    firstThirdPartyWTCategory = snap->firstThirdPartyCategory;
+    firstUserWTCategory = snap->firstUserCategory;
+    wtOrdering = snap->ordering;
+    wtCategoryOrdering = snap->categoryOrdering;
+    return true;
 }
 
 void SurgeStorage::refresh_wtlistAddDir(bool userDir, const std::string &subdir)
@@ -1254,11 +1561,12 @@ void SurgeStorage::refresh_wtlistFrom(bool isUser, const fs::path &p, const std:
             }
             return false;
         },
-        wt_list, wt_category);
+        wt_list, wt_category, scannedDirectories);
 }
 
-void SurgeStorage::perform_queued_wtloads()
+bool SurgeStorage::perform_queued_wtloads()
 {
+    bool loaded = false;
     SurgePatch &patch =
         getPatch(); // Change here is for performance and ease of debugging, simply not calling
                     // getPatch so many times. Code should behave identically.
@@ -1268,6 +1576,8 @@ void SurgeStorage::perform_queued_wtloads()
         {
             if (patch.scene[sc].osc[o].wt.queue_id != -1)
             {
+                Surge::RealtimeSafety::noteBlockingCall("perform_queued_wtloads");
+                loaded = true;
                 if (patch.scene[sc].osc[o].wt.everBuilt)
                     patch.isDirty = true;
                 load_wt(patch.scene[sc].osc[o].wt.queue_id, &patch.scene[sc].osc[o].wt,
@@ -1277,6 +1587,8 @@ void SurgeStorage::perform_queued_wtloads()
             }
             else if (patch.scene[sc].osc[o].wt.queue_filename[0])
             {
+                Surge::RealtimeSafety::noteBlockingCall("perform_queued_wtloads");
+                loaded = true;
                 if (!(uses_wavetabledata(patch.scene[sc].osc[o].type.val.i)))
                 {
                     patch.scene[sc].osc[o].queue_type = ot_wavetable;
@@ -1301,10 +1613,13 @@ void SurgeStorage::perform_queued_wtloads()
             }
         }
     }
+    return loaded;
 }
 
 void SurgeStorage::load_wt(int id, Wavetable *wt, OscillatorStorage *osc)
 {
+    SURGE_TRACE_ZONE("SurgeStorage::load_wt");
+
     wt->current_id = id;
     wt->queue_id = -1;
 
@@ -1347,6 +1662,9 @@ void SurgeStorage::load_wt(int id, Wavetable *wt, OscillatorStorage *osc)
 
 void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *osc)
 {
+    SURGE_TRACE_ZONE("SurgeStorage::load_wt");
+    SURGE_TRACE_ZONE_TEXT(filename.c_str());
+
     wt->current_filename = wt->queue_filename;
     wt->queue_filename = "";
 
@@ -1359,7 +1677,27 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
 
     bool loaded = false;
 
-    if (extension.compare(".wt") == 0)
+    /*
+     * A frame size override changes how a .wav is cut up, so those loads always go the long
+     * way round
+     */
+    bool useCache = cacheBuiltWavetables && !compactWavetables && userDataPathValid &&
+                    wt->frame_size_if_absent <= 0 &&
+                    (extension.compare(".wt") == 0 || extension.compare(".wav") == 0);
+    auto cacheDir = userDataPath / "Wavetable Cache";
+
+    if (useCache)
+    {
+        std::lock_guard<std::mutex> g(waveTableDataMutex);
+        loaded = Surge::Storage::loadCachedWavetable(cacheDir, string_to_path(filename), wt);
+        useCache = !loaded;
+    }
+
+    if (loaded)
+    {
+        // the cached block is already in place
+    }
+    else if (extension.compare(".wt") == 0)
     {
         loaded = load_wt_wt(filename, wt);
     }
@@ -1375,6 +1713,18 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
         reportError(oss.str(), "Error");
     }
 
+    if (useCache && loaded && wt->builtTableData())
+    {
+        // the entry is written once the mipmaps are done, which may be on the builder thread
+        auto source = string_to_path(filename);
+        auto key = wt->buildKey;
+        auto data = wt->builtTableData();
+
+        wavetableMipmapBuilder.whenBuilt(data, [cacheDir, source, key, data]() {
+            Surge::Storage::storeCachedWavetable(cacheDir, source, key, data);
+        });
+    }
+
     if (osc && loaded)
     {
         auto fn = filename.substr(filename.find_last_of(PATH_SEPARATOR) + 1, filename.npos);
@@ -2204,6 +2554,7 @@ void SurgeStorage::clipboard_paste(
         }
     }
 
+    publishModulationRoutings();
     modRoutingMutex.unlock();
 }
 
@@ -2272,6 +2623,12 @@ void SurgeStorage::write_midi_controllers_to_user_default()
 
 void SurgeStorage::setSamplerate(float sr)
 {
+    // hosts re-prepare at the rate they're already running at all the time; nothing to redo
+    if (rateTables && sr == samplerate)
+    {
+        return;
+    }
+
     // If I am changing my sample rate I will change my internal tables, so this
     // needs to be tuning aware and reapply tuning if needed
     auto s = currentScale;
@@ -2283,6 +2640,7 @@ void SurgeStorage::setSamplerate(float sr)
     dsamplerate_inv = 1.0 / sr;
     dsamplerate_os = dsamplerate * OSC_OVERSAMPLING;
     dsamplerate_os_inv = 1.0 / dsamplerate_os;
+    rateTables = SharedTables::get().forSamplerate(sr);
     init_tables();
 
     if (!wasST)
@@ -2381,52 +2739,138 @@ void SurgeStorage::load_midi_controllers()
 
         entry = TINYXML_SAFE_TO_ELEMENT(entry->NextSibling("entry"));
     }
+
+    midiMappingGeneration++;
 }
 
 SurgeStorage::~SurgeStorage()
 {
+    diagnostics.stopDelivering();
+
+    // other storages may keep the database going, so it needs to stop reporting to us now
+    if (patchDB)
+        patchDB->detachStorage(this);
+
 #ifndef SURGE_SKIP_ODDSOUND_MTS
     if (oddsound_mts_active_as_main)
         disconnect_as_oddsound_main();
 
     deinitialize_oddsound();
 #endif
+
+    freeRetiredModulationRoutings();
+    delete pendingRoutings.exchange(nullptr);
+    delete audioRoutings;
 }
 
-double shafted_tanh(double x) { return (exp(x) - exp(-x * 1.2)) / (exp(x) + exp(-x)); }
+void SurgeStorage::publishModulationRoutings()
+{
+    std::lock_guard<std::recursive_mutex> g(modRoutingMutex);
 
-void SurgeStorage::init_tables()
+    auto snap = new Surge::Storage::ModulationRoutingSnapshot();
+    snap->epoch = ++modulationRoutingEpoch;
+    snap->global = getPatch().modulation_global;
+
+    for (int s = 0; s < n_scenes; s++)
+    {
+        snap->scene[s] = getPatch().scene[s].modulation_scene;
+        snap->voice[s] = getPatch().scene[s].modulation_voice;
+        snap->voicePlan[s].compile(snap->voice[s], snap->scene[s]);
+    }
+
+    // if the audio thread never picked up the last one it's ours to free
+    delete pendingRoutings.exchange(snap, std::memory_order_acq_rel);
+
+    freeRetiredModulationRoutings();
+}
+
+void SurgeStorage::acquireModulationRoutings()
 {
-    isStandardTuning = true;
-    float db60 = powf(10.f, 0.05f * -60.f);
-    float _512th = 1.f / 512.f;
+    auto snap = pendingRoutings.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (!snap)
+        return;
+
+    auto old = audioRoutings;
+    audioRoutings = snap;
+
+    old->nextRetired = retiredRoutings.load(std::memory_order_relaxed);
+    while (!retiredRoutings.compare_exchange_weak(old->nextRetired, old, std::memory_order_release,
+                                                  std::memory_order_relaxed))
+    {
+    }
+}
+
+SurgeStorage::TuningTables &SurgeStorage::beginTuningTables()
+{
+    /*
+     * Take back any tables the audio thread hasn't picked up yet. Afterwards nothing is pending,
+     * so the live buffer can't change under us and the other one is ours to fill.
+     */
+    auto live = tuningState.fetch_and(1, std::memory_order_acq_rel) & 1;
+    return tuningBuffers[1 - live];
+}
+
+void SurgeStorage::publishTuningTables()
+{
+    auto live = tuningState.load(std::memory_order_relaxed) & 1;
 
-    for (int i = 0; i < tuning_table_size; i++)
+    if (swapTuningAtBlockStart)
     {
-        table_dB[i] = powf(10.f, 0.05f * ((float)i - 384.f));
-        table_pitch[i] = powf(2.f, ((float)i - 256.f) * (1.f / 12.f));
-        table_pitch_ignoring_tuning[i] = table_pitch[i];
-        table_pitch_inv[i] = 1.f / table_pitch[i];
-        table_pitch_inv_ignoring_tuning[i] = table_pitch_inv[i];
-        table_note_omega[0][i] =
-            (float)sin(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
-        table_note_omega[1][i] =
-            (float)cos(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
-        table_note_omega_ignoring_tuning[0][i] = table_note_omega[0][i];
-        table_note_omega_ignoring_tuning[1][i] = table_note_omega[1][i];
-        double k = dsamplerate_os * pow(2.0, (((double)i - 256.0) / 16.0)) / (double)BLOCK_SIZE_OS;
-        table_envrate_linear[i] = (float)(1.f / k);
-        table_envrate_lpf[i] = (float)(1.f - exp(log(db60) / k));
-        table_glide_log[i] = log2(1.0 + (i * _512th * 10.f)) / log2(1.f + 10.f);
-        table_glide_exp[511 - i] = 1.0 - table_glide_log[i];
+        tuningState.store(live | 2, std::memory_order_release);
     }
+    else
+    {
+        tuningState.store(1 - live, std::memory_order_release);
+        pointAtTuningTables(1 - live);
+    }
+}
+
+void SurgeStorage::acquireTuningTables()
+{
+    auto s = tuningState.load(std::memory_order_acquire);
 
-    for (int i = 0; i < 1001; ++i)
+    if ((s & 2) && tuningState.compare_exchange_strong(s, 1 - (s & 1), std::memory_order_acq_rel))
+        pointAtTuningTables(1 - (s & 1));
+}
+
+void SurgeStorage::pointAtTuningTables(int buffer)
+{
+    table_pitch = tuningBuffers[buffer].pitch;
+    table_pitch_inv = tuningBuffers[buffer].pitch_inv;
+    table_note_omega = tuningBuffers[buffer].note_omega;
+}
+
+void SurgeStorage::freeRetiredModulationRoutings()
+{
+    auto r = retiredRoutings.exchange(nullptr, std::memory_order_acquire);
+
+    while (r)
     {
-        double twelths = i * 1.0 / 12.0 / 1000.0;
-        table_two_to_the[i] = pow(2.0, twelths);
-        table_two_to_the_minus[i] = pow(2.0, -twelths);
+        auto n = r->nextRetired;
+        delete r;
+        r = n;
     }
+}
+
+double shafted_tanh(double x) { return (exp(x) - exp(-x * 1.2)) / (exp(x) + exp(-x)); }
+
+void SurgeStorage::init_tables()
+{
+    isStandardTuning = true;
+
+    {
+        std::lock_guard<std::mutex> g(tuningBuildMutex);
+        auto &tt = beginTuningTables();
+        memcpy(tt.pitch, table_pitch_ignoring_tuning, sizeof(tt.pitch));
+        memcpy(tt.pitch_inv, table_pitch_inv_ignoring_tuning, sizeof(tt.pitch_inv));
+        memcpy(tt.note_omega, rateTables->note_omega, sizeof(tt.note_omega));
+        publishTuningTables();
+    }
+    memcpy(table_note_omega_ignoring_tuning, rateTables->note_omega,
+           sizeof(table_note_omega_ignoring_tuning));
+    memcpy(table_envrate_linear, rateTables->envrate_linear, sizeof(table_envrate_linear));
+    memcpy(table_envrate_lpf, rateTables->envrate_lpf, sizeof(table_envrate_lpf));
 
     // include some margin for error (and to avoid denormals in IIR filter clamping)
     nyquist_pitch =
@@ -2477,6 +2921,102 @@ float SurgeStorage::note_to_pitch_inv(float x)
     }
 }
 
+namespace
+{
+// (1 - a) * lo + a * hi in the same order as the scalar lookups, so the results agree
+inline SIMD_M128 lerpLanes(SIMD_M128 a, SIMD_M128 lo, SIMD_M128 hi)
+{
+    const auto one = SIMD_MM(set1_ps)(1.f);
+    return SIMD_MM(add_ps)(SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(one, a), lo), SIMD_MM(mul_ps)(a, hi));
+}
+
+inline SIMD_M128 gatherLanes(const float *table, const int *idx, int plus = 0, int mask = ~0)
+{
+    return SIMD_MM(setr_ps)(table[(idx[0] + plus) & mask], table[(idx[1] + plus) & mask],
+                            table[(idx[2] + plus) & mask], table[(idx[3] + plus) & mask]);
+}
+
+// The four wide body of note_to_pitch(_inv) with a retuned table; returns how many it did
+int tunedNotesToPitches(const float *table, const float *notes, float *out, int n)
+{
+    const auto off = SIMD_MM(set1_ps)(256.f);
+    const auto lo = SIMD_MM(setzero_ps)();
+    const auto hi = SIMD_MM(set1_ps)(SurgeStorage::tuning_table_size - (float)1.e-4);
+    int e alignas(16)[4];
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = SIMD_MM(add_ps)(SIMD_MM(loadu_ps)(notes + i), off);
+        x = SIMD_MM(min_ps)(SIMD_MM(max_ps)(x, lo), hi);
+        auto ei = SIMD_MM(cvttps_epi32)(x);
+        auto a = SIMD_MM(sub_ps)(x, SIMD_MM(cvtepi32_ps)(ei));
+        SIMD_MM(store_si128)((SIMD_M128I *)e, ei);
+
+        SIMD_MM(storeu_ps)
+        (out + i, lerpLanes(a, gatherLanes(table, e), gatherLanes(table, e, 1, 0x1ff)));
+    }
+    return i;
+}
+
+// and the same for the 12-TET tables, which interpolate an octave table with a 2^x table
+int untunedNotesToPitches(const float *table, const float *pow2table, float lowest,
+                          const float *notes, float *out, int n)
+{
+    const auto off = SIMD_MM(set1_ps)(256.f);
+    const auto lo = SIMD_MM(set1_ps)(lowest);
+    const auto hi = SIMD_MM(set1_ps)(SurgeStorage::tuning_table_size - (float)1.e-4);
+    const auto thousand = SIMD_MM(set1_ps)(1000.f);
+    int e alignas(16)[4], p2 alignas(16)[4];
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = SIMD_MM(add_ps)(SIMD_MM(loadu_ps)(notes + i), off);
+        x = SIMD_MM(min_ps)(SIMD_MM(max_ps)(x, lo), hi);
+        auto ei = SIMD_MM(cvttps_epi32)(x);
+        auto a = SIMD_MM(sub_ps)(x, SIMD_MM(cvtepi32_ps)(ei));
+        SIMD_MM(store_si128)((SIMD_M128I *)e, ei);
+
+        auto pow2pos = SIMD_MM(mul_ps)(a, thousand);
+        auto pow2idx = SIMD_MM(cvttps_epi32)(pow2pos);
+        auto pow2frac = SIMD_MM(sub_ps)(pow2pos, SIMD_MM(cvtepi32_ps)(pow2idx));
+        SIMD_MM(store_si128)((SIMD_M128I *)p2, pow2idx);
+
+        auto pow2v =
+            lerpLanes(pow2frac, gatherLanes(pow2table, p2), gatherLanes(pow2table, p2, 1));
+        SIMD_MM(storeu_ps)(out + i, SIMD_MM(mul_ps)(gatherLanes(table, e), pow2v));
+    }
+    return i;
+}
+} // namespace
+
+void SurgeStorage::note_to_pitch_block(const float *notes, float *pitches, int n)
+{
+    int done;
+    if (tuningTableIs12TET())
+        done = untunedNotesToPitches(table_pitch_ignoring_tuning, table_two_to_the, 1.e-4f, notes,
+                                     pitches, n);
+    else
+        done = tunedNotesToPitches(table_pitch, notes, pitches, n);
+
+    for (int i = done; i < n; ++i)
+        pitches[i] = note_to_pitch(notes[i]);
+}
+
+void SurgeStorage::note_to_pitch_inv_block(const float *notes, float *pitches, int n)
+{
+    int done;
+    if (tuningTableIs12TET())
+        done = untunedNotesToPitches(table_pitch_inv_ignoring_tuning, table_two_to_the_minus, 0.f,
+                                     notes, pitches, n);
+    else
+        done = tunedNotesToPitches(table_pitch_inv, notes, pitches, n);
+
+    for (int i = done; i < n; ++i)
+        pitches[i] = note_to_pitch_inv(notes[i]);
+}
+
 float SurgeStorage::note_to_pitch_ignoring_tuning(float x)
 {
     x = limit_range(x + 256, 1.e-4f, tuning_table_size - (float)1.e-4);
@@ -2646,14 +3186,21 @@ bool SurgeStorage::resetToCurrentScaleAndMapping()
         tuningPitchInv = 1.0 / tuningPitch;
     }
 
-    for (int i = 0; i < 512; ++i)
     {
-        table_pitch[i] = t.frequencyForMidiNoteScaledByMidi0(i - 256);
-        table_pitch_inv[i] = 1.f / table_pitch[i];
-        table_note_omega[0][i] =
-            (float)sin(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
-        table_note_omega[1][i] =
-            (float)cos(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
+        std::lock_guard<std::mutex> g(tuningBuildMutex);
+        auto &tt = beginTuningTables();
+
+        for (int i = 0; i < 512; ++i)
+        {
+            tt.pitch[i] = t.frequencyForMidiNoteScaledByMidi0(i - 256);
+            tt.pitch_inv[i] = 1.f / tt.pitch[i];
+            tt.note_omega[0][i] =
+                (float)sin(2 * M_PI * min(0.5, 440 * tt.pitch[i] * dsamplerate_os_inv));
+            tt.note_omega[1][i] =
+                (float)cos(2 * M_PI * min(0.5, 440 * tt.pitch[i] * dsamplerate_os_inv));
+        }
+
+        publishTuningTables();
     }
 
 #ifndef SURGE_SKIP_ODDSOUND_MTS
@@ -2842,6 +3389,8 @@ void SurgeStorage::loadMidiMappingByName(std::string name)
             ctrl = ctrl->NextSiblingElement("ctrl");
         }
     }
+
+    midiMappingGeneration++;
 }
 
 void SurgeStorage::storeMidiMappingToName(std::string name)
@@ -2905,6 +3454,7 @@ void SurgeStorage::initialize_oddsound()
         deinitialize_oddsound();
     }
     oddsound_mts_client = MTS_RegisterClient();
+    mtsRetuningTable.invalidate();
     if (oddsound_mts_client)
     {
         setOddsoundMTSActiveTo(MTS_HasMaster(oddsound_mts_client));
@@ -2925,6 +3475,11 @@ void SurgeStorage::setOddsoundMTSActiveTo(bool b)
 {
     bool poa = oddsound_mts_active_as_client;
     oddsound_mts_active_as_client = b;
+    if (b != poa)
+    {
+        // a master came or went, so whatever we remembered of its tuning is gone too
+        mtsRetuningTable.invalidate();
+    }
     if (b && b != poa)
     {
         // Oddsound right now is MIDI_ONLY so force that to avoid lingering problems
@@ -3059,6 +3614,15 @@ void SurgeStorage::reportError(const std::string &msg, const std::string &title,
     }
 }
 
+void SurgeStorage::DiagnosticErrorForwarder::onDiagnostic(const Surge::Debug::DiagnosticRecord &r,
+                                                           const std::string &formatted)
+{
+    // the log has already printed it, if it prints at all
+    if (Surge::Debug::diagnosticSeverity(r.event) == Surge::Debug::diag_error)
+        storage->reportError(formatted, Surge::Debug::diagnosticName(r.event), GENERAL_ERROR,
+                             false);
+}
+
 float SurgeStorage::remapKeyInMidiOnlyMode(float res)
 {
     if (!isStandardTuning && tuningApplicationMode == RETUNE_MIDI_ONLY)
@@ -3076,6 +3640,46 @@ namespace Surge
 {
 namespace Storage
 {
+void CompiledVoiceModulation::compile(const std::vector<ModulationRouting> &voiceRoutings,
+                                      const std::vector<ModulationRouting> &sceneRoutings)
+{
+    std::vector<int> slotFor(maxSlots, -1);
+
+    for (const auto &r : voiceRoutings)
+    {
+        // an index past the end of a source's outputs reads nothing
+        if (r.muted || r.source_id < 0 || r.source_id >= n_modsources || r.source_index < 0 ||
+            r.source_index >= ModulationSource::vecsize)
+        {
+            continue;
+        }
+
+        auto &sl = slotFor[r.source_id * ModulationSource::vecsize + r.source_index];
+
+        if (sl < 0)
+        {
+            sl = (int)slotSource.size();
+            slotSource.push_back(r.source_id);
+            slotIndex.push_back(r.source_index);
+        }
+
+        destination.push_back(r.destination_id);
+        slot.push_back(sl);
+        depth.push_back(r.depth);
+    }
+
+    for (const auto &r : sceneRoutings)
+    {
+        // we don't think global parameters land in the voice localcopy span, but check
+        if (r.source_id == ms_aftertouch && !r.muted && r.destination_id >= 0 &&
+            r.destination_id < n_scene_params)
+        {
+            mpeAftertouchDestination.push_back(r.destination_id);
+            mpeAftertouchDepth.push_back(r.depth);
+        }
+    }
+}
+
 bool isValidName(const std::string &patchName)
 {
     bool valid = false;
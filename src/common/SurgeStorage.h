@@ -33,6 +33,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 #include <mutex>
 #include <atomic>
 #include <cstdint>
@@ -50,6 +51,8 @@
 #include "PatchDB.h"
 #include <unordered_set>
 #include "UserDefaults.h"
+#include "RetuningCache.h"
+#include "DiagnosticLog.h"
 
 /*
  * Porting to c++20 and hit this a year or two from now? Check out the fix
@@ -138,9 +141,10 @@ const int FIRoffsetI16 = FIRipolI16_N >> 1;
 //                                     (old patches load with extend disabled even if they had it enabled)
 // 24 -> 25 (XT 1.3.4 nightlies) added storing of Wavetable Script Editor window state
 // 25 -> 26 (XT 1.4.* nightlies) added WT Deform for new WT features
+// 26 -> 27 (XT 1.4.* nightlies) added Lookahead parameter to Conditioner effect
 // clang-format on
 
-const int ff_revision = 26;
+const int ff_revision = 27;
 
 const int n_scene_params = 273;
 const int n_global_params = 11 + n_fx_slots * (n_fx_params + 1); // each param plus a type
@@ -339,6 +343,13 @@ static int constexpr fxslot_order[n_fx_slots] =
      fxslot_bins1,   fxslot_bins2,   fxslot_bins3,   fxslot_bins4,
      fxslot_send1,   fxslot_send2,   fxslot_send3,   fxslot_send4,
      fxslot_global1, fxslot_global2, fxslot_global3, fxslot_global4};
+
+// each chain in processing order
+static int constexpr fxslot_scene_inserts[n_scenes][4] =
+    {{fxslot_ains1, fxslot_ains2, fxslot_ains3, fxslot_ains4},
+     {fxslot_bins1, fxslot_bins2, fxslot_bins3, fxslot_bins4}};
+static int constexpr fxslot_sends[n_send_slots] =
+    {fxslot_send1, fxslot_send2, fxslot_send3, fxslot_send4};
 // clang-format on
 
 enum fxchains
@@ -417,6 +428,7 @@ enum fx_type
     fxt_bonsai,
     fxt_audio_input,
     fxt_floaty_delay,
+    fxt_convolution,
 
     n_fx_types,
 };
@@ -451,7 +463,8 @@ const char fx_type_names[n_fx_types][32] = {"Off",
                                             "Spring Reverb",
                                             "Bonsai",
                                             "Audio Input",
-                                            "Floaty Delay"};
+                                            "Floaty Delay",
+                                            "Convolution"};
 
 const char fx_type_shortnames[n_fx_types][16] = {
     "Off",         "Delay",      "Reverb 1",      "Phaser",        "Rotary",     "Distortion",
@@ -459,12 +472,12 @@ const char fx_type_shortnames[n_fx_types][16] = {
     "Flanger",     "Ring Mod",   "Airwindows",    "Neuron",        "Graphic EQ", "Resonator",
     "CHOW",        "Exciter",    "Ensemble",      "Combulator",    "Nimbus",     "Tape",
     "Treemonster", "Waveshaper", "Mid-Side Tool", "Spring Reverb", "Bonsai",     "Audio In",
-    "Floaty Delay"};
+    "Floaty Delay", "Convolution"};
 
 const char fx_type_acronyms[n_fx_types][8] = {
     "OFF", "DLY",  "RV1", "PH", "ROT", "DIST", "EQ",  "FRQ", "DYN", "CH",  "VOC",
     "RV2", "FL",   "RM",  "AW", "NEU", "GEQ",  "RES", "CHW", "XCT", "ENS", "CMB",
-    "NIM", "TAPE", "TM",  "WS", "M-S", "SRV",  "BON", "IN",  "FDL"};
+    "NIM", "TAPE", "TM",  "WS", "M-S", "SRV",  "BON", "IN",  "FDL", "CNV"};
 
 enum fx_bypass
 {
@@ -612,6 +625,16 @@ enum PolyVoiceRepeatedKeyMode
     ONE_VOICE_PER_KEY, // aka "piano mode"
 };
 
+// Which voice gives way when a new note arrives at the polyphony limit. Released voices always
+// go before held ones; this picks among them.
+enum PolyVoiceStealingMode
+{
+    STEAL_OLDEST, // The legacy mode
+    STEAL_QUIETEST,
+    STEAL_LOWEST,
+    STEAL_HIGHEST,
+};
+
 struct MidiKeyState
 {
     int keystate;
@@ -717,6 +740,9 @@ struct FxStorage
 
     // like this one!
     fxslot_positions fxslot;
+
+    // The file an effect like the convolution reverb loads its data from. Empty for none.
+    std::string impulseResponsePath;
 };
 
 struct SurgeSceneStorage
@@ -756,9 +782,31 @@ struct SurgeSceneStorage
 
     bool modsource_doprocess[n_modsources];
 
+    /*
+     * When a voice LFO provably comes out the same in every voice, the synth runs it once
+     * per block for the scene and points this at the result, which voices read instead of
+     * running their own. Otherwise nullptr.
+     */
+    ModulationSource *sharedVoiceLFO[n_lfos_voice]{};
+
+    /*
+     * Raw filter coefficients the synth has made this block from the cutoff and resonance a
+     * voice comes to when neither keytracking nor the filter envelope moves them and no voice
+     * modulation lands on them. Voices which arrive at exactly these inputs pass them through
+     * their own smoother instead of making their own. Not valid when there are none.
+     */
+    struct SharedFilterCoeffs
+    {
+        bool valid{false};
+        float cutoff{0.f}, reso{0.f};
+        int type{-1}, subtype{-1};
+        float C[sst::filters::n_cm_coeffs]{};
+    } sharedFilterCoeffs[n_filterunits_per_scene];
+
     MonoVoicePriorityMode monoVoicePriorityMode = ALWAYS_LATEST;
     MonoVoiceEnvelopeMode monoVoiceEnvelopeMode = RESTART_FROM_ZERO;
     PolyVoiceRepeatedKeyMode polyVoiceRepeatedKeyMode = NEW_VOICE_EVERY_NOTEON;
+    PolyVoiceStealingMode polyVoiceStealingMode = STEAL_OLDEST;
 };
 
 const int n_stepseqsteps = 16;
@@ -845,6 +893,17 @@ struct MSEGStorage
     float durationLoopStartToLoopEnd;
     float envelopeModeDuration = -1, envelopeModeNV1 = -2; // -2 as sentinel since NV1 is -1/1
 
+    // The parts of each segment's curve which only depend on its control point value. These
+    // are refreshed by MSEGModulationHelper::rebuildCache for segments whose cpv has changed,
+    // and valueAt recomputes them on the fly if the cpv they were made for is stale
+    struct segmentCurve
+    {
+        float cpv = -100; // sentinel, since cpv is -1/1
+        float cpExponent = 0;
+        int oscillations = 0, stairs = 2;
+    };
+    std::array<segmentCurve, max_msegs> segmentCurves;
+
     /*
      * These "UI" type things we decided, late in 1.8, are actually a critical part of
      * the modelling experience, so even if they aren't required to actually evaluate
@@ -974,6 +1033,7 @@ struct DAWExtraStateStorage
             float noise_floor = 0.f;
             float max_db = 1.f;
             float decay_rate = 1.f;
+            int spectrum_overlap = 1; // FFTs per fftSize samples: 1, 2, 4 or 8.
         } oscilloscopeOverlayState;
 
         struct TuningOverlayState
@@ -1004,6 +1064,8 @@ struct DAWExtraStateStorage
 
     int tuningApplicationMode = 1; // RETUNE_MIDI_ONLY
 
+    bool bounceQualityWhenOffline{true};
+
     bool isDirty{false};
 
     bool disconnectFromOddSoundMTS{false};
@@ -1027,6 +1089,14 @@ struct PatchTuningStorage
 
 class SurgeStorage;
 
+namespace Surge
+{
+namespace Storage
+{
+struct ParameterBlock;
+}
+} // namespace Surge
+
 class SurgePatch
 {
   public:
@@ -1041,8 +1111,14 @@ class SurgePatch
     // load/save
     // void load_xml();
     // void save_xml();
-    void load_xml(const void *data, int size, bool preset);
-    unsigned int save_xml(void **data);
+    /*
+     * With a block, the parameter values come from it and the <parameters> element it
+     * records is skipped rather than parsed. Saving with one fills it in alongside the XML.
+     */
+    void load_xml(const void *data, int size, bool preset,
+                  const Surge::Storage::ParameterBlock *block = nullptr);
+    unsigned int save_xml(void **data, Surge::Storage::ParameterBlock *block = nullptr);
+    void dawExtraStateToXMLElement(TiXmlElement &parent) const;
     unsigned int save_RIFF(void **data);
 
     // Factor these so the LFO preset mechanism can use them as well
@@ -1053,9 +1129,39 @@ class SurgePatch
     void formulaToXMLElement(FormulaModulatorStorage *ms, TiXmlElement &parent) const;
     void formulaFromXMLElement(FormulaModulatorStorage *ms, TiXmlElement *parent) const;
 
-    void load_patch(const void *data, int size, bool preset);
-    unsigned int save_patch(void **data);
+    /*
+     * Any non-null entry of prebuiltWT is the wavetable for that oscillator, already built
+     * from this same patch data, and is copied into place rather than built again.
+     */
+    void load_patch(const void *data, int size, bool preset,
+                    Wavetable *const prebuiltWT[n_scenes][n_oscs] = nullptr);
+    /*
+     * State the DAW or the undo stack keeps, rather than a patch file, adds a parameter
+     * block after the wavetables so that loading it back can skip most of the XML
+     */
+    unsigned int save_patch(void **data, bool withParameterBlock = false);
+
+    /*
+     * What a DAW state save depends on: the isDirty generation, which the editor bumps for
+     * every edit it makes, plus everything which can change without the editor knowing -
+     * parameters and routings set by the host, OSC or MIDI, the tables the oscillators
+     * hold, storage wide settings and the DAW extra state as it would be streamed. Two saves
+     * with matching keys write the same bytes.
+     */
+    struct StreamedStateKey
+    {
+        uint64_t dirtyGeneration{0};
+        uint64_t hash{0};
+        std::string dawExtraState;
+        std::weak_ptr<Wavetable::TableData> tables[n_scenes][n_oscs];
+
+        bool matches(const StreamedStateKey &other) const;
+    };
+    StreamedStateKey streamedStateKey() const;
+    // what a parameter block has to match to be read back here
+    uint64_t parameterTableHash() const;
     Parameter *parameterFromOSCName(std::string stName);
+    int parameterIndexFromStorageName(const std::string &storageName) const;
 
     // data
     SurgeSceneStorage scene[n_scenes], morphscene;
@@ -1070,6 +1176,7 @@ class SurgePatch
     int scene_start[n_scenes], scene_size;
 
     std::unordered_map<std::string, Parameter *> param_ptr_by_oscname;
+    std::unordered_map<std::string, int> param_index_by_storage_name;
 
     // streaming name for splitpoint is splitkey (due to legacy)
     Parameter scene_active, scenemode, splitpoint;
@@ -1091,6 +1198,37 @@ class SurgePatch
     std::vector<ModulationRouting> modulation_global;
     pdata scenedata[n_scenes][n_scene_params];
     pdata scenedataOrig[n_scenes][n_scene_params];
+
+    /*
+     * Which scenedata entries copy_scenedata and the scene modulation after it changed this
+     * block, so each voice only has to refresh those in its local copy. A voice which didn't
+     * see the previous generation, or a list marked all, copies everything instead.
+     */
+    struct ScenedataChanges
+    {
+        uint64_t generation{0};
+        bool all{true};
+        int count{0};
+        std::array<int16_t, n_scene_params> ids;
+        std::array<bool, n_scene_params> listed{};
+
+        void begin()
+        {
+            for (int i = 0; i < count; ++i)
+                listed[ids[i]] = false;
+            count = 0;
+            all = false;
+            ++generation;
+        }
+        void mark(int id)
+        {
+            if (!listed[id])
+            {
+                listed[id] = true;
+                ids[count++] = id;
+            }
+        }
+    } scenedataChanges[n_scenes];
     pdata globaldata[n_global_params];
     void *patchptr;
     SurgeStorage *storage;
@@ -1106,7 +1244,24 @@ class SurgePatch
     };
     std::vector<Tag> tags;
 
-    std::atomic<bool> isDirty{false};
+    /*
+     * Reads and assigns like a plain atomic bool, but also counts every assignment, so that
+     * anything cached from the patch can tell it may have changed since
+     */
+    struct DirtyFlag
+    {
+        DirtyFlag &operator=(bool b)
+        {
+            value = b;
+            generation++;
+            return *this;
+        }
+        operator bool() const { return value; }
+
+        std::atomic<bool> value{false};
+        std::atomic<uint64_t> generation{0};
+    };
+    DirtyFlag isDirty;
 
     // macro controllers
 #define CUSTOM_CONTROLLER_LABEL_SIZE 20
@@ -1142,6 +1297,8 @@ class SurgePatch
     int32_t paramModulationCount{0};
     static constexpr int maxMonophonicParamModulations = 256;
     std::array<MonophonicParamModulation, maxMonophonicParamModulations> monophonicParamModulations;
+    // index + 1 into monophonicParamModulations by parameter id; zero if unmodulated
+    std::array<uint16_t, n_total_params> monophonicParamModulationSlot{};
 };
 
 struct Patch
@@ -1203,6 +1360,46 @@ struct ScenesOutputData
     bool thereAreClients(int scene) const;
 };
 
+/*
+ * A scene's voice routings laid out the way SurgeVoice applies them each block. Muted
+ * routings are dropped and every distinct source output gets a slot, so a voice calls
+ * get_output once per slot rather than once per routing. The routings keep their patch
+ * order, so the sums into localcopy come out the same as walking the routing list.
+ */
+struct CompiledVoiceModulation
+{
+    static constexpr int maxSlots = n_modsources * ModulationSource::vecsize;
+
+    // one entry per distinct (source, index)
+    std::vector<int> slotSource, slotIndex;
+
+    // one entry per unmuted routing
+    std::vector<int> destination, slot;
+    std::vector<float> depth;
+
+    // scene routings from channel aftertouch, which MPE mode applies per voice
+    std::vector<int> mpeAftertouchDestination;
+    std::vector<float> mpeAftertouchDepth;
+
+    void compile(const std::vector<ModulationRouting> &voiceRoutings,
+                 const std::vector<ModulationRouting> &sceneRoutings);
+};
+
+/*
+ * An immutable copy of the patch's modulation routings, which is what the audio thread
+ * reads. See SurgeStorage::publishModulationRoutings.
+ */
+struct ModulationRoutingSnapshot
+{
+    uint64_t epoch{0};
+    std::vector<ModulationRouting> global;
+    std::vector<ModulationRouting> scene[n_scenes], voice[n_scenes];
+    CompiledVoiceModulation voicePlan[n_scenes];
+
+    // links snapshots the audio thread has finished with until they are freed
+    ModulationRoutingSnapshot *nextRetired{nullptr};
+};
+
 struct FxUserPreset;
 struct ModulatorPreset;
 } // namespace Storage
@@ -1229,13 +1426,22 @@ class alignas(16) SurgeStorage
     // this will be a pointer to an aligned 2 x BLOCK_SIZE_OS array
     float audio_otherscene alignas(16)[2][BLOCK_SIZE_OS];
 
-    std::unique_ptr<sst::basic_blocks::tables::SurgeSincTableProvider> sincTableProvider;
+    /*
+     * The tables which depend on neither the sample rate nor the tuning come out the same in
+     * every instance, so they're built once per process and every instance points at them.
+     * Nobody writes to them.
+     */
+    struct SharedTables;
+    // The sample rate dependent part of init_tables(), shared between instances at a rate
+    struct RateTables;
+    const RateTables *rateTables{nullptr};
+
+    sst::basic_blocks::tables::SurgeSincTableProvider *sincTableProvider{nullptr};
     float *sinctable, *sinctable1X;
     int16_t *sinctableI16;
 
-    float table_dB alignas(16)[512], table_envrate_lpf alignas(16)[512],
-        table_envrate_linear alignas(16)[512], table_glide_exp alignas(16)[512],
-        table_glide_log alignas(16)[512];
+    const float *table_dB{nullptr}, *table_glide_exp{nullptr}, *table_glide_log{nullptr};
+    float table_envrate_lpf alignas(16)[512], table_envrate_linear alignas(16)[512];
     float samplerate{0}, samplerate_inv{1};
     double dsamplerate{0}, dsamplerate_inv{1};
     double dsamplerate_os{0}, dsamplerate_os_inv{1};
@@ -1297,6 +1503,23 @@ class alignas(16) SurgeStorage
     }
     void removeErrorListener(ErrorListener *l) { errorListeners.erase(l); }
 
+    /*
+     * Where the audio thread reports things, instead of reportError or std::cout. Events of
+     * error severity come back out of reportError, off the audio thread, so the error
+     * listeners see them as they always have; see DiagnosticLog.h for the rest.
+     */
+    Surge::Debug::DiagnosticLog diagnostics;
+
+  private:
+    struct DiagnosticErrorForwarder : Surge::Debug::DiagnosticLog::Listener
+    {
+        SurgeStorage *storage{nullptr};
+        void onDiagnostic(const Surge::Debug::DiagnosticRecord &r,
+                          const std::string &formatted) override;
+    } diagnosticErrorForwarder;
+
+  public:
+
     enum OkCancel
     {
         OK,
@@ -1317,19 +1540,27 @@ class alignas(16) SurgeStorage
         initPatchCategoryType{"Factory"};
 
     static constexpr int tuning_table_size = 512;
-    float table_pitch alignas(16)[tuning_table_size];
-    float table_pitch_inv alignas(16)[tuning_table_size];
-    float table_note_omega alignas(16)[2][tuning_table_size];
-    float table_pitch_ignoring_tuning alignas(16)[tuning_table_size];
-    float table_pitch_inv_ignoring_tuning alignas(16)[tuning_table_size];
+    struct TuningTables
+    {
+        float pitch alignas(16)[tuning_table_size];
+        float pitch_inv alignas(16)[tuning_table_size];
+        float note_omega alignas(16)[2][tuning_table_size];
+    };
+    // these point into whichever of tuningBuffers is live, see acquireTuningTables
+    float *table_pitch{nullptr};
+    float *table_pitch_inv{nullptr};
+    float (*table_note_omega)[tuning_table_size]{nullptr};
+    const float *table_pitch_ignoring_tuning{nullptr};
+    const float *table_pitch_inv_ignoring_tuning{nullptr};
     float table_note_omega_ignoring_tuning alignas(16)[2][tuning_table_size];
     // 2^0 -> 2^+/-1/12th. See comment in note_to_pitch
-    float table_two_to_the alignas(16)[1001];
-    float table_two_to_the_minus alignas(16)[1001];
+    const float *table_two_to_the{nullptr};
+    const float *table_two_to_the_minus{nullptr};
 
     ~SurgeStorage();
 
-    std::unique_ptr<Surge::PatchStorage::PatchDB> patchDB;
+    // shared with every storage in the process on the same user and factory data
+    std::shared_ptr<Surge::PatchStorage::PatchDB> patchDB;
     bool patchDBInitialized{false};
     void initializePatchDb(bool forcePatchRescan = false);
 
@@ -1356,6 +1587,16 @@ class alignas(16) SurgeStorage
     void save_snapshots();
     int controllers[n_customcontrollers];
     int controllers_chan[n_customcontrollers];
+    /*
+     * Bumped by anything which changes controllers, controllers_chan or a parameter's midictrl
+     * or midichan, so SurgeSynthesizer knows to rebuild its controller lookup.
+     */
+    std::atomic<uint32_t> midiMappingGeneration{0};
+    /*
+     * Bumped by anything outside a parameter which can change its text, such as the types
+     * which pick other parameters' formats or the readout precision; see Parameter::DisplayCache
+     */
+    std::atomic<uint32_t> displayGeneration{0};
     float poly_aftertouch[2][16][128]; // TODO: FIX SCENE ASSUMPTION
     float modsource_vu[n_modsources];
     void setSamplerate(float sr);
@@ -1380,9 +1621,23 @@ class alignas(16) SurgeStorage
     void refreshPatchOrWTListAddDir(bool userDir, const fs::path &fromPath, std::string subdir,
                                     std::function<bool(std::string)> filterOp,
                                     std::vector<Patch> &items,
-                                    std::vector<PatchCategory> &categories);
+                                    std::vector<PatchCategory> &categories,
+                                    std::vector<std::pair<fs::path, int64_t>> &directories);
+
+    /*
+     * The constructor takes the lists from a PatchListSnapshot when the folders haven't
+     * changed since one was made, and only walks them if that fails. The refresh calls
+     * above always walk, and publish what they find for the next instance.
+     */
+    bool restore_wtlist();
+    bool restore_patchlist();
+    std::string patchListSnapshotKey() const;
+    std::string wtListSnapshotKey() const;
+    fs::path listSnapshotFile(const std::string &name) const;
+    void refreshPatchModTimes();
+    void applyPatchFavoritesAndProgramChanges();
 
-    void perform_queued_wtloads();
+    bool perform_queued_wtloads(); // true if anything was loaded
 
     void load_wt(int id, Wavetable *wt, OscillatorStorage *);
     void load_wt(std::string filename, Wavetable *wt, OscillatorStorage *);
@@ -1413,6 +1668,10 @@ class alignas(16) SurgeStorage
     std::vector<int> patchOrdering;
     std::vector<int> patchCategoryOrdering;
     std::array<std::array<int, 128>, 128> patchIdToMidiBankAndProgram;
+    // the lists came from a snapshot, so refresh the times before the patch DB compares them
+    bool patchModTimesStale{false};
+    // what the refresh in progress has walked, for its snapshot
+    std::vector<std::pair<fs::path, int64_t>> scannedDirectories;
 
     // The in-memory wavetable database
     std::vector<Patch> wt_list;
@@ -1450,9 +1709,121 @@ class alignas(16) SurgeStorage
     void storeMidiMappingToName(std::string name);
 
     std::mutex waveTableDataMutex;
+    // the patch's wavetables hand their mipmaps to this, so loads only build level 0
+    WavetableMipmapBuilder wavetableMipmapBuilder;
+    // keep built wavetables in the user data directory so the next load skips the build
+    std::atomic<bool> cacheBuiltWavetables{true};
+    /*
+     * Build the patch's wavetables compact, with int16 data only (see Wavetable::TableData).
+     * Compact tables aren't written to or read from that cache, which holds floats too.
+     */
+    std::atomic<bool> compactWavetables{false};
     std::recursive_mutex modRoutingMutex;
+
+    /*
+     * The audio thread never reads the routing vectors in the patch, or takes modRoutingMutex,
+     * since the UI edits them continuously while you drag a modulation depth. Instead anything
+     * which changes a routing calls publishModulationRoutings afterwards, which copies them into
+     * a new snapshot with the next epoch. The audio thread picks up the latest snapshot at the
+     * top of each block with acquireModulationRoutings and retires the one it was using, and
+     * retired snapshots are freed by the next publish, so the audio thread neither blocks nor
+     * frees memory. Snapshots which are replaced before the audio thread sees them are freed
+     * right away.
+     */
+    void publishModulationRoutings();
+    void acquireModulationRoutings();
+
+    /*
+     * Retuning builds the pitch tables in whichever of the two buffers isn't live. Once a
+     * realtime host sets swapTuningAtBlockStart, the built tables wait there until the audio
+     * thread takes them with acquireTuningTables at the top of its next block, so a voice never
+     * sees half a scale. A rebuild which comes along before then simply takes the buffer back.
+     * Otherwise, offline and in the tests, where retuning and rendering take turns on one thread,
+     * the new tables go live as soon as they are built.
+     */
+    std::atomic<bool> swapTuningAtBlockStart{false};
+    void acquireTuningTables();
+    const Surge::Storage::ModulationRoutingSnapshot &audioModulationRoutings() const
+    {
+        return *audioRoutings;
+    }
+
+  private:
+    void freeRetiredModulationRoutings();
+
+    std::atomic<Surge::Storage::ModulationRoutingSnapshot *> pendingRoutings{nullptr},
+        retiredRoutings{nullptr};
+    Surge::Storage::ModulationRoutingSnapshot *audioRoutings{nullptr};
+    uint64_t modulationRoutingEpoch{0};
+
+    TuningTables tuningBuffers[2];
+    // bit 0 is the live buffer, and bit 1 is set while the other one waits for the audio thread
+    std::atomic<int> tuningState{0};
+    std::mutex tuningBuildMutex;
+    // with tuningBuildMutex held
+    TuningTables &beginTuningTables();
+    void publishTuningTables();
+    void pointAtTuningTables(int buffer);
+
+  public:
     Wavetable WindowWT;
 
+    /*
+     * How far the effects which support it oversample their nonlinear stages. Effects pick
+     * this up in init(), so it only changes on the audio thread, through
+     * SurgeSynthesizer::setEffectOversampling, which re-initialises them.
+     */
+    enum EffectOversampling
+    {
+        EFFECT_OVERSAMPLING_ECO = 0, // none at all, for big sessions
+        EFFECT_OVERSAMPLING_STANDARD, // each effect's own choice
+        EFFECT_OVERSAMPLING_HIGH,     // double that, for rendering
+    } effectOversampling = EFFECT_OVERSAMPLING_STANDARD;
+
+    // the oversampling factor (as a power of two) for an effect which normally uses standard
+    int effectOversamplingFactor(int standard) const
+    {
+        switch (effectOversampling)
+        {
+        case EFFECT_OVERSAMPLING_ECO:
+            return 0;
+        case EFFECT_OVERSAMPLING_HIGH:
+            return standard + 1;
+        default:
+            return standard;
+        }
+    }
+
+    /*
+     * How much of its time the audio thread spent on the last few blocks (smoothed, 1 is all
+     * of it), which the synth updates at the end of every block. When adaptEffectsToLoad is
+     * on, effects which can trade detail for time, like Nimbus thinning out its grains, use it
+     * to back off before the host runs out of time.
+     */
+    float audioThreadLoad{0.f};
+    std::atomic<bool> adaptEffectsToLoad{false};
+
+    /*
+     * Set on the audio thread while SurgeSynthesizer's CPU governor has stepped down to
+     * reduced anti-aliasing, which unison oscillators check as they render.
+     */
+    bool reducedAntiAliasing{false};
+
+    /*
+     * Set by the synth while the host renders offline with this instance's bounce quality on,
+     * see SurgeSynthesizer::setOfflineRendering. There's no deadline then, so nothing should
+     * trade quality for time.
+     */
+    bool renderingForBounce{false};
+
+    /*
+     * A released voice whose output stays below this level (linear, 0 turns it off) for
+     * silentVoiceHoldSeconds is ended then rather than when its release envelope finishes.
+     * Set through SurgeSynthesizer::setSilentVoiceThresholdDb.
+     */
+    std::atomic<float> silentVoiceThreshold{0.f};
+    static constexpr float silentVoiceHoldSeconds = 0.05f;
+
     // hardclip
     enum HardClipMode
     {
@@ -1470,6 +1841,13 @@ class alignas(16) SurgeStorage
     float note_to_pitch_inv(float x);
     float note_to_pitch_ignoring_tuning(float x);
     float note_to_pitch_inv_ignoring_tuning(float x);
+    /*
+     * note_to_pitch and note_to_pitch_inv for n notes at once, giving the same values as
+     * calling them one by one. The tuning check is made once and the interpolation runs four
+     * notes wide, which suits oscillators working out all their unison pitches for a block.
+     */
+    void note_to_pitch_block(const float *notes, float *pitches, int n);
+    void note_to_pitch_inv_block(const float *notes, float *pitches, int n);
     inline float note_to_pitch_tuningctr(float x)
     {
         return note_to_pitch(x + scaleConstantNote()) * scaleConstantPitchInv();
@@ -1676,6 +2054,11 @@ class alignas(16) SurgeStorage
     float mpePitchBendRange = -1.0f;
 
     std::atomic<int> otherscene_clients;
+    /*
+     * How many oscillators and effects which can read audio_in, and audio_in_nonOS, are alive.
+     * The synth leaves the input alone, and doesn't upsample it, while nobody could look.
+     */
+    std::atomic<int> audio_in_clients{0}, audio_in_nonOS_clients{0};
 
     Surge::Storage::ScenesOutputData scenesOutputData;
 
@@ -1738,12 +2121,37 @@ class alignas(16) SurgeStorage
         std::uniform_int_distribution<uint32_t> u32;
     } rngGen;
 
+    /*
+     * Worker threads which render voices alongside the audio thread (see
+     * SurgeSynthesizer::setMultithreadedSceneRendering) can't share rngGen, so they
+     * point this at a generator of their own when they start.
+     */
+    static inline thread_local RNGGen *workerThreadRNG{nullptr};
+    inline RNGGen &currentRNG() { return workerThreadRNG ? *workerThreadRNG : rngGen; }
+
+    /*
+     * The tuning memos for voice pitches: per block for scale lookups, and the MTS-ESP
+     * retuning table. Only the audio thread uses it; voices
+     * rendering on a worker thread (which is when workerThreadRNG is set) get nullptr and
+     * do their own lookups.
+     */
+    Surge::Storage::RetuningCache retuningCache;
+    inline Surge::Storage::RetuningCache *currentRetuningCache()
+    {
+        return workerThreadRNG ? nullptr : &retuningCache;
+    }
+    Surge::Storage::MTSRetuningTable mtsRetuningTable;
+    inline Surge::Storage::MTSRetuningTable *currentMTSRetuningTable()
+    {
+        return workerThreadRNG ? nullptr : &mtsRetuningTable;
+    }
+
 #define DEBUG_RNG_THREADING 0
 #if DEBUG_RNG_THREADING
     std::thread::id audioThreadID{0};
     inline void runningOnAudioThread()
     {
-        if (audioThreadID && std::this_thread::get_id() != audioThreadID)
+        if (audioThreadID && !workerThreadRNG && std::this_thread::get_id() != audioThreadID)
         {
             std::cout << "BUM CALL ON NON AUDIO THREAD" << std::endl;
         }
@@ -1760,25 +2168,56 @@ class alignas(16) SurgeStorage
     inline int rand()
     {
         runningOnAudioThread();
-        return rngGen.d(rngGen.g);
+        auto &r = currentRNG();
+        return r.d(r.g);
     }
     inline uint32_t rand_u32()
     {
         runningOnAudioThread();
-        return rngGen.u32(rngGen.g);
+        auto &r = currentRNG();
+        return r.u32(r.g);
     }
     inline float rand_pm1()
     {
         runningOnAudioThread();
-        return rngGen.pm1(rngGen.g);
+        auto &r = currentRNG();
+        return r.pm1(r.g);
     }
     inline float rand_01()
     {
         runningOnAudioThread();
-        return rngGen.z1(rngGen.g);
+        auto &r = currentRNG();
+        return r.z1(r.g);
+    }
+
+    /*
+     * Deterministic rendering, for checking an optimised path renders bit for bit the same
+     * as the reference. Once seeded, rngGen restarts from the seed and anything which builds
+     * a generator of its own should take its seed from seedForNewGenerator(), which draws
+     * from rngGen rather than the clock or std::random_device. SurgeSynthesizer::
+     * setDeterministicRendering reseeds the synth's other generators as well.
+     */
+    bool deterministicRendering{false};
+    void setDeterministicSeed(uint32_t seed)
+    {
+        deterministicRendering = true;
+        rngGen.g.seed(seed);
+    }
+    uint32_t seedForNewGenerator()
+    {
+        if (deterministicRendering)
+            return rand_u32();
+        std::random_device rd;
+        return rd();
     }
-// void seed_rand(int s) { rngGen.g.seed(s); }
 #else
+    bool deterministicRendering{false};
+    void setDeterministicSeed(uint32_t seed)
+    {
+        deterministicRendering = true;
+        std::srand(seed);
+    }
+    uint32_t seedForNewGenerator() { return std::rand(); }
     inline int rand() { return std::rand(); }
     inline uint32_t rand_u32() { return (uint32_t)(rand_01() * (float)(0xFFFFFFFF)); }
     inline float rand_pm1() { return rand_01() * 2 - 1; }
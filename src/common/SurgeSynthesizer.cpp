@@ -35,11 +35,21 @@
 #include <algorithm>
 #include <thread>
 #include <set>
+#if WINDOWS
+#include <intrin.h>
+#endif
 #ifndef SURGE_SKIP_ODDSOUND_MTS
 #include "libMTSClient.h"
 #endif
 
 #include "SurgeMemoryPools.h"
+#include "FormulaModulationHelper.h"
+#include "PatchDB.h"
+#include "FPUState.h"
+#include "RealtimeSafety.h"
+#include "SurgeTrace.h"
+#include "ThreadPolicy.h"
+#include "WaveshaperADAA.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/dsp/Clippers.h"
@@ -52,11 +62,38 @@ namespace cutl = sst::cpputils;
 
 using CMSKey = ControllerModulationSourceVector<1>; // sigh see #4286 for failed first try
 
+namespace
+{
+inline int lowestSetBit(uint64_t bits)
+{
+#if WINDOWS
+    unsigned long res;
+    _BitScanForward64(&res, bits);
+    return (int)res;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+} // namespace
+
 SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppliedDataPath)
-    : storage(suppliedDataPath), hpA{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)},
-      hpB{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)}, _parent(parent), halfbandA(6, true),
-      halfbandB(6, true), halfbandIN(6, true), mpeEnabled(storage.mpeEnabled)
+    : SurgeSynthesizer(parent, SurgeStorage::SurgeStorageConfig::fromDataPath(suppliedDataPath))
+{
+}
+
+SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent,
+                                   const SurgeStorage::SurgeStorageConfig &config)
+    : storage(config), voiceStorage(1), voices_array(voiceStorage[0]),
+      sceneLowCut{cutl::make_array<BiquadBank<2 * n_scenes>, n_hpBQ>(&storage)}, _parent(parent),
+      halfbandA(6, true),
+      halfbandB(6, true), halfbandIN(6, true), halfbandHighRateA(3, false),
+      halfbandHighRateB(3, false), mpeEnabled(storage.mpeEnabled)
 {
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        voices[sc].setVoiceArray(voices_array[sc].data());
+    }
+
     switch_toggled_queued = false;
     audio_processing_active = false;
     halt_engine = false;
@@ -92,7 +129,7 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
     memset(storage.getPatch().scenedataOrig[1], 0, sizeof(pdata) * n_scene_params);
 
     memset(storage.getPatch().globaldata, 0, sizeof(pdata) * n_global_params);
-    memset(mControlInterpolatorUsed, 0, sizeof(bool) * num_controlinterpolators);
+    ResetControlInterpolators();
 
     for (int i = 0; i < n_fx_slots; i++)
     {
@@ -108,10 +145,17 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
         voices_usedby[0][i] = 0;
         voices_usedby[1][i] = 0;
     }
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        freeVoiceSlots[sc] = MAX_VOICES == 64 ? ~(uint64_t)0 : ((uint64_t)1 << MAX_VOICES) - 1;
+    }
+
+    filterChainStates =
+        Surge::Memory::LargeArray<QuadFilterChainState>(n_scenes * (MAX_VOICES >> 2));
 
     for (int sc = 0; sc < n_scenes; sc++)
     {
-        FBQ[sc] = new QuadFilterChainState[MAX_VOICES >> 2]();
+        FBQ[sc] = filterChainStates.data() + sc * (MAX_VOICES >> 2);
 
         for (int i = 0; i < (MAX_VOICES >> 2); ++i)
         {
@@ -128,6 +172,29 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
 
     midiSoftTakeover =
         (bool)Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::MIDISoftTakeover, 0);
+    sampleAccurateNoteOns = (bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::SampleAccurateNoteOns, 0);
+
+    setMultithreadedSceneRendering((bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::MultithreadedSceneRendering, 0));
+    setMultithreadedVoiceRendering((bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::MultithreadedVoiceRendering, 0));
+    setMultithreadedEffectRendering((bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::MultithreadedEffectRendering, 0));
+    setEffectOversampling((SurgeStorage::EffectOversampling)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::EffectOversampling, SurgeStorage::EFFECT_OVERSAMPLING_STANDARD));
+    storage.adaptEffectsToLoad =
+        (bool)Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::AdaptEffectsToLoad, 0);
+    degradeQualityUnderLoad = (bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::DegradeQualityUnderLoad, 0);
+    storage.cacheBuiltWavetables = (bool)Surge::Storage::getUserDefaultValue(
+        &storage, Surge::Storage::CacheBuiltWavetables, 1);
+    storage.compactWavetables =
+        (bool)Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::CompactWavetables, 0);
+    setSilentVoiceThresholdDb(
+        Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::SilentVoiceThreshold, 0));
+    setFreezeVoicesBudgetMB(
+        Surge::Storage::getUserDefaultValue(&storage, Surge::Storage::FreezeVoicesBudget, 0));
 
     patch.polylimit.val.i = DEFAULT_POLYLIMIT;
 
@@ -141,24 +208,29 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
             scene.modsources[i] = 0;
         }
 
-        scene.modsources[ms_modwheel] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_breath] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_expression] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_sustain] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_aftertouch] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_pitchbend] = new ControllerModulationSource(storage.smoothingMode);
-        scene.modsources[ms_lowest_key] = new CMSKey(storage.smoothingMode);
-        scene.modsources[ms_highest_key] = new CMSKey(storage.smoothingMode);
-        scene.modsources[ms_latest_key] = new CMSKey(storage.smoothingMode);
+        auto &mods = sceneModulators[sc];
+        using SM = SceneModulators;
+
+        for (int i = 0; i < std::size(SM::controllerIds); i++)
+        {
+            mods.controllers[i] = ControllerModulationSource(storage.smoothingMode);
+            scene.modsources[SM::controllerIds[i]] = &mods.controllers[i];
+        }
+
+        mods.pitchbend = ControllerModulationSource(storage.smoothingMode);
+        scene.modsources[ms_pitchbend] = &mods.pitchbend;
 
-        ((CMSKey *)scene.modsources[ms_lowest_key])->init(0, 0.f);
-        ((CMSKey *)scene.modsources[ms_highest_key])->init(0, 0.f);
-        ((CMSKey *)scene.modsources[ms_latest_key])->init(0, 0.f);
+        for (int i = 0; i < std::size(SM::keyIds); i++)
+        {
+            mods.keys[i] = CMSKey(storage.smoothingMode);
+            mods.keys[i].init(0, 0.f);
+            scene.modsources[SM::keyIds[i]] = &mods.keys[i];
+        }
 
-        scene.modsources[ms_random_bipolar] = new RandomModulationSource(true);
-        scene.modsources[ms_random_unipolar] = new RandomModulationSource(false);
-        scene.modsources[ms_alternate_bipolar] = new AlternateModulationSource(true);
-        scene.modsources[ms_alternate_unipolar] = new AlternateModulationSource(false);
+        for (int i = 0; i < std::size(SM::randomIds); i++)
+            scene.modsources[SM::randomIds[i]] = &mods.randoms[i];
+        for (int i = 0; i < std::size(SM::alternateIds); i++)
+            scene.modsources[SM::alternateIds[i]] = &mods.alternates[i];
 
         for (int osc = 0; osc < n_oscs; osc++)
         {
@@ -176,13 +248,21 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
 
         for (int l = 0; l < n_lfos_scene; l++)
         {
-            scene.modsources[ms_slfo1 + l] = new LFOModulationSource();
-            ((LFOModulationSource *)scene.modsources[ms_slfo1 + l])
-                ->assign(&storage, &scene.lfo[n_lfos_voice + l], storage.getPatch().scenedata[sc],
-                         0, &patch.stepsequences[sc][n_lfos_voice + l],
-                         &patch.msegs[sc][n_lfos_voice + l],
-                         &patch.formulamods[sc][n_lfos_voice + l]);
-            ((LFOModulationSource *)scene.modsources[ms_slfo1 + l])->setIsVoice(false);
+            auto &lfo = sceneModulators[sc].lfos[l];
+            scene.modsources[ms_slfo1 + l] = &lfo;
+            lfo.assign(&storage, &scene.lfo[n_lfos_voice + l], storage.getPatch().scenedata[sc], 0,
+                       &patch.stepsequences[sc][n_lfos_voice + l],
+                       &patch.msegs[sc][n_lfos_voice + l],
+                       &patch.formulamods[sc][n_lfos_voice + l]);
+            lfo.setIsVoice(false);
+        }
+
+        for (int l = 0; l < n_lfos_voice; l++)
+        {
+            sharedVoiceLFOs[sc][l].assign(&storage, &scene.lfo[l], storage.getPatch().scenedata[sc],
+                                          0, &patch.stepsequences[sc][l], &patch.msegs[sc][l],
+                                          &patch.formulamods[sc][l]);
+            sharedVoiceLFOs[sc][l].setIsVoice(true);
         }
 
         for (int k = 0; k < 128; ++k)
@@ -193,7 +273,8 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
 
     for (int i = 0; i < n_customcontrollers; i++)
     {
-        patch.scene[0].modsources[ms_ctrl1 + i] = new MacroModulationSource(storage.smoothingMode);
+        macros[i] = MacroModulationSource(storage.smoothingMode);
+        patch.scene[0].modsources[ms_ctrl1 + i] = &macros[i];
 
         for (int j = 1; j < n_scenes; j++)
         {
@@ -313,40 +394,18 @@ SurgeSynthesizer::~SurgeSynthesizer()
             patchLoadThread->join();
     }
 
-    stopSound();
-
-    for (int sc = 0; sc < n_scenes; sc++)
-    {
-        delete[] FBQ[sc];
-    }
-
-    for (int sc = 0; sc < n_scenes; sc++)
-    {
-        delete storage.getPatch().scene[sc].modsources[ms_modwheel];
-        delete storage.getPatch().scene[sc].modsources[ms_breath];
-        delete storage.getPatch().scene[sc].modsources[ms_expression];
-        delete storage.getPatch().scene[sc].modsources[ms_sustain];
-        delete storage.getPatch().scene[sc].modsources[ms_aftertouch];
-        delete storage.getPatch().scene[sc].modsources[ms_pitchbend];
-        delete storage.getPatch().scene[sc].modsources[ms_lowest_key];
-        delete storage.getPatch().scene[sc].modsources[ms_highest_key];
-        delete storage.getPatch().scene[sc].modsources[ms_latest_key];
+    if (patchPrefetchThread)
+        patchPrefetchThread->join();
 
-        delete storage.getPatch().scene[sc].modsources[ms_random_bipolar];
-        delete storage.getPatch().scene[sc].modsources[ms_random_unipolar];
-        delete storage.getPatch().scene[sc].modsources[ms_alternate_bipolar];
-        delete storage.getPatch().scene[sc].modsources[ms_alternate_unipolar];
+    patchPreloadStop = true;
+    if (patchPreloadThread)
+        patchPreloadThread->join();
 
-        for (int i = 0; i < n_lfos_scene; i++)
-        {
-            delete storage.getPatch().scene[sc].modsources[ms_slfo1 + i];
-        }
-    }
+    stopSound();
 
-    for (int i = 0; i < n_customcontrollers; i++)
-    {
-        delete storage.getPatch().scene[0].modsources[ms_ctrl1 + i];
-    }
+    freeRetiredEffects();
+    for (auto &box : prespawnedFx)
+        delete box.fx;
 }
 
 // A voice is routed to a particular scene if channelmask & n.
@@ -428,6 +487,8 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
         return;
     }
 
+    processProfiler.noteOn();
+
 #ifndef SURGE_SKIP_ODDSOUND_MTS
     if (storage.oddsound_mts_client && storage.oddsound_mts_active_as_client)
     {
@@ -461,6 +522,7 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
     }
 
     midiNoteEvents++;
+    markUIChanged(uic_midi);
 
     if (!storage.isStandardTuning)
     {
@@ -515,8 +577,10 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
     {
         for (int sc = 0; sc < n_scenes; ++sc)
         {
-            for (auto &h : holdbuffer[sc])
-            {
+            if (!holdbuffer[sc].isWaiting(channel, key))
+                continue;
+
+            holdbuffer[sc].retain([channel, key](HoldBufferItem &h) {
                 if (h.channel == channel && h.key == key)
                 {
                     h.channel = -1;
@@ -524,7 +588,8 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
                     h.originalChannel = channel;
                     h.originalKey = key;
                 }
-            }
+                return true;
+            });
         }
     }
 }
@@ -542,46 +607,77 @@ void SurgeSynthesizer::playNoteByFrequency(float freq, char velocity, int32_t id
     this->setNoteExpression(SurgeVoice::PITCH, id, mk, 0, off); // since PITCH is in semitones
 }
 
-void SurgeSynthesizer::softkillVoice(int s)
+void SurgeSynthesizer::softkillExcessVoices(int s)
 {
-    list<SurgeVoice *>::iterator iter, max_playing, max_released;
-    int max_age = -1, max_age_release = -1;
-    iter = voices[s].begin();
+    /*
+     * Score every voice which isn't already on its way out in one pass and uber-release as
+     * many of the best candidates as it takes to get under the limit. Released voices always
+     * go first, then the scene's stealing mode picks among each group, with ties going to the
+     * voice which started first.
+     */
+    struct Candidate
+    {
+        SurgeVoice *v;
+        bool held;
+        float score; // higher is stolen sooner
+        int order;
+    };
+    std::array<Candidate, MAX_VOICES> candidates;
+    int n = 0;
 
-    while (iter != voices[s].end())
+    auto mode = storage.getPatch().scene[s].polyVoiceStealingMode;
+    for (auto v : voices[s])
     {
-        SurgeVoice *v = *iter;
-        assert(v);
-        if (v->state.gate)
+        if (v->state.uberrelease)
+            continue;
+
+        float score = 0;
+        switch (mode)
         {
-            if (v->age > max_age)
-            {
-                max_age = v->age;
-                max_playing = iter;
-            }
-        }
-        else if (!v->state.uberrelease)
+        case STEAL_OLDEST:
+            score = v->state.gate ? v->age : v->age_release;
+            break;
+        case STEAL_QUIETEST:
         {
-            if (v->age_release > max_age_release)
-            {
-                max_age_release = v->age_release;
-                max_released = iter;
-            }
+            float aeg, feg;
+            v->getAEGFEGLevel(aeg, feg);
+            score = -aeg;
         }
-        iter++;
+        break;
+        case STEAL_LOWEST:
+            score = -v->state.key;
+            break;
+        case STEAL_HIGHEST:
+            score = v->state.key;
+            break;
+        }
+        candidates[n] = {v, v->state.gate, score, n};
+        n++;
     }
-    if (max_age_release >= 0)
-        (*max_released)->uber_release();
-    else if (max_age >= 0)
-        (*max_playing)->uber_release();
+
+    int excess = std::min(n, n - effectivePolyLimit() + 1);
+    if (excess <= 0)
+        return;
+
+    auto stealSooner = [](const Candidate &a, const Candidate &b) {
+        if (a.held != b.held)
+            return !a.held;
+        if (a.score != b.score)
+            return a.score > b.score;
+        return a.order < b.order;
+    };
+    std::nth_element(candidates.begin(), candidates.begin() + excess - 1,
+                     candidates.begin() + n, stealSooner);
+    for (int i = 0; i < excess; ++i)
+        candidates[i].v->uber_release();
 }
 
 // only allow 'margin' number of voices to be softkilled simultaneously
 void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
 {
-    list<SurgeVoice *>::iterator iter;
+    voiceList_t::iterator iter;
 
-    int paddedPoly = std::min((storage.getPatch().polylimit.val.i + margin), MAX_VOICES - 1);
+    int paddedPoly = std::min((effectivePolyLimit() + margin), MAX_VOICES - 1);
     if (voices[s].size() > paddedPoly)
     {
         int excess_voices = max(0, (int)voices[s].size() - paddedPoly);
@@ -605,6 +701,39 @@ void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
     }
 }
 
+int SurgeSynthesizer::effectivePolyLimit() const
+{
+    return std::min(storage.getPatch().polylimit.val.i, governorPolyLimit);
+}
+
+void SurgeSynthesizer::applyCPUGovernorLevel(int level)
+{
+    storage.reducedAntiAliasing = level >= Surge::Profiling::gov_reduced_antialiasing;
+
+    if (level >= Surge::Profiling::gov_polyphony_cap)
+    {
+        if (governorPolyLimit == MAX_VOICES)
+        {
+            // a quarter fewer than the busiest scene is playing now, not what the patch allows
+            int playing = 0;
+            for (int s = 0; s < n_scenes; ++s)
+                playing = std::max(playing, getNonUltrareleaseVoices(s));
+
+            governorPolyLimit = std::max(governorMinPolyphony, playing * 3 / 4);
+
+            for (int s = 0; s < n_scenes; ++s)
+                softkillExcessVoices(s);
+        }
+    }
+    else
+    {
+        governorPolyLimit = MAX_VOICES;
+    }
+
+    // the effect oversampling is picked up with the rest of processControl's changes
+    markUIChanged(uic_levels);
+}
+
 int SurgeSynthesizer::getNonUltrareleaseVoices(int s) const
 {
     int count = 0;
@@ -641,31 +770,44 @@ int SurgeSynthesizer::getNonReleasedVoices(int s) const
 
 SurgeVoice *SurgeSynthesizer::getUnusedVoice(int scene)
 {
-    for (int i = 0; i < MAX_VOICES; i++)
+    if (!freeVoiceSlots[scene])
+        return 0;
+
+    auto i = lowestSetBit(freeVoiceSlots[scene]);
+    assert(!voices_usedby[scene][i]);
+    freeVoiceSlots[scene] &= ~((uint64_t)1 << i);
+    voices_usedby[scene][i] = scene + 1;
+    voiceLookup.dirty = true;
+    return &voices_array[scene][i];
+}
+
+void SurgeSynthesizer::freeVoice(SurgeVoice *v)
+{
+    int foundScene{-1}, foundIndex{-1};
+    for (int sc = 0; sc < n_scenes; sc++)
     {
-        if (!voices_usedby[scene][i])
+        if (v >= voices_array[sc].data() && v < voices_array[sc].data() + MAX_VOICES)
         {
-            voices_usedby[scene][i] = scene + 1;
-            return &voices_array[scene][i];
+            foundScene = sc;
+            foundIndex = (int)voices[sc].indexOf(v);
+            break;
         }
     }
-    return 0;
-}
+    assert(foundScene >= 0);
+
+    if (voiceLookup.dirty)
+        rebuildVoiceLookup();
+    voiceLookup.remove(v->host_note_id, v->state.channel, v->state.key, foundScene, foundIndex);
 
-void SurgeSynthesizer::freeVoice(SurgeVoice *v)
-{
     if (v->host_note_id >= 0)
     {
-        bool used_away = false;
         // does any other voice have this voiceid
+        bool used_away = false;
         for (int s = 0; s < n_scenes; ++s)
         {
-            for (auto vo : voices[s])
+            if (voiceLookup.voicesFor(v->host_note_id, s))
             {
-                if (vo != v && vo->host_note_id == v->host_note_id)
-                {
-                    used_away = true;
-                }
+                used_away = true;
             }
         }
         if (!used_away)
@@ -674,26 +816,9 @@ void SurgeSynthesizer::freeVoice(SurgeVoice *v)
         }
     }
 
-    int foundScene{-1}, foundIndex{-1};
-    for (int i = 0; i < MAX_VOICES; i++)
-    {
-        if (voices_usedby[0][i] && (v == &voices_array[0][i]))
-        {
-            assert(foundScene == -1);
-            assert(foundIndex == -1);
-            foundScene = 0;
-            foundIndex = i;
-            voices_usedby[0][i] = 0;
-        }
-        if (voices_usedby[1][i] && (v == &voices_array[1][i]))
-        {
-            assert(foundScene == -1);
-            assert(foundIndex == -1);
-            foundScene = 1;
-            foundIndex = i;
-            voices_usedby[1][i] = 0;
-        }
-    }
+    assert(voices_usedby[foundScene][foundIndex]);
+    voices_usedby[foundScene][foundIndex] = 0;
+    freeVoiceSlots[foundScene] |= (uint64_t)1 << foundIndex;
     v->freeAllocatedElements();
 
     /*
@@ -772,13 +897,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
         storage.getPatch().scene[scene].modsources[i]->attack();
     }
 
-    int excessVoices =
-        max(0, (int)getNonUltrareleaseVoices(scene) - storage.getPatch().polylimit.val.i + 1);
-
-    for (int i = 0; i < excessVoices; i++)
-    {
-        softkillVoice(scene);
-    }
+    softkillExcessVoices(scene);
     enforcePolyphonyLimit(scene, 3);
 
     int lowkey = 0, hikey = 127;
@@ -843,6 +962,8 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                     &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                     &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                     host_originating_key, host_originating_channel, 0.f, 0.f);
+                nvoice->startSampleOffset = noteOnSampleOffset;
+                attachFrozenHit(nvoice, scene, velocity, detune);
             }
         }
         break;
@@ -851,7 +972,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
     case pm_mono_fp:
     case pm_latch:
     {
-        list<SurgeVoice *>::const_iterator iter;
+        voiceList_t::const_iterator iter;
         bool glide = false;
 
         int primode = storage.getPatch().scene[scene].monoVoicePriorityMode;
@@ -988,6 +1109,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         detune, &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegReuse, fegReuse);
+                    nvoice->startSampleOffset = noteOnSampleOffset;
 
                     if (wasGated && pkeyToReuse > 0)
                     {
@@ -1077,7 +1199,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
         if (createVoice)
         {
-            list<SurgeVoice *>::const_iterator iter;
+            voiceList_t::const_iterator iter;
             SurgeVoice *recycleThis{nullptr};
             float aegStart{0.}, fegStart{0.};
             for (iter = voices[scene].begin(); iter != voices[scene].end(); iter++)
@@ -1086,6 +1208,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                 if ((v->state.scene_id == scene) && (v->state.gate))
                 {
                     v->legato(key, velocity, detune);
+                    voiceLookup.dirty = true;
                     found_one = true;
                     if (mpeEnabled || storage.mapChannelToOctave)
                     {
@@ -1133,6 +1256,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         detune, &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegStart, fegStart);
+                    nvoice->startSampleOffset = noteOnSampleOffset;
                 }
             }
             else
@@ -1173,24 +1297,28 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
 void SurgeSynthesizer::releaseScene(int s)
 {
-    list<SurgeVoice *>::const_iterator iter;
+    voiceList_t::const_iterator iter;
     for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
     {
         freeVoice(*iter);
     }
     voices[s].clear();
 
-    for (int i = 0; i < n_hpBQ; ++i)
+    for (auto &hp : sceneLowCut)
     {
-        if (s == 0)
-            hpA[i].suspend();
-        else
-            hpB[i].suspend();
+        hp.suspend(2 * s);
+        hp.suspend(2 * s + 1);
     }
     if (s == 0)
+    {
         halfbandA.reset();
+        halfbandHighRateA.reset();
+    }
     if (s == 1)
+    {
         halfbandB.reset();
+        halfbandHighRateB.reset();
+    }
     halfbandIN.reset();
 }
 
@@ -1219,6 +1347,7 @@ void SurgeSynthesizer::chokeNote(int16_t channel, int16_t key, char velocity, in
 void SurgeSynthesizer::releaseNote(char channel, char key, char velocity, int32_t host_noteid)
 {
     midiNoteEvents++;
+    markUIChanged(uic_midi);
     bool foundVoice[n_scenes];
     for (int sc = 0; sc < n_scenes; ++sc)
     {
@@ -1307,11 +1436,10 @@ void SurgeSynthesizer::releaseNote(char channel, char key, char velocity, int32_
             }
         }
 
-        if (sceneNoHold)
+        // hold pedal is down, add to buffer (or release now if that is somehow full)
+        auto ch8 = (int8_t)channel, key8 = (int8_t)key;
+        if (sceneNoHold || !holdbuffer[sc].push(HoldBufferItem{ch8, key8, ch8, key8, host_noteid}))
             releaseNotePostHoldCheck(sc, channel, key, velocity, host_noteid);
-        else
-            holdbuffer[sc].push_back(HoldBufferItem{
-                channel, key, channel, key, host_noteid}); // hold pedal is down, add to buffer
     }
 }
 
@@ -1319,8 +1447,26 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                                                 int32_t host_noteid)
 {
     channelState[channel].keyState[key].keystate = 0;
-    list<SurgeVoice *>::const_iterator iter;
-    for (int s = 0; s < n_scenes; s++)
+
+    // In poly mode only the voices on this channel and key can be affected, so go to them directly
+    bool releasedFromLookup{false};
+    if (storage.getPatch().scene[scene].polymode.val.i == pm_poly)
+    {
+        auto mask = candidateVoices(scene, channel, key, host_noteid);
+        for (int i = 0; mask; ++i, mask >>= 1)
+        {
+            auto v = &voices_array[scene][i];
+            if ((mask & 1) && (v->state.key == key) && (v->state.channel == channel) &&
+                (v->state.gate) && (host_noteid < 0 || v->host_note_id == host_noteid))
+            {
+                v->release();
+            }
+        }
+        releasedFromLookup = true;
+    }
+
+    voiceList_t::const_iterator iter;
+    for (int s = 0; s < n_scenes && !releasedFromLookup; s++)
     {
         bool do_switch = false;
         int k = 0;
@@ -1653,6 +1799,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                         if (k >= 0)
                         {
                             v->legato(k, velocity, channelState[channel].keyState[k].lastdetune);
+                            voiceLookup.dirty = true;
                             do_release = false;
                         }
                     }
@@ -1718,6 +1865,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                         if (k >= 0)
                         {
                             v->legato(k, velocity, channelState[ch].keyState[k].lastdetune);
+                            voiceLookup.dirty = true;
                             do_release = false;
 
                             v->state.channel = ch;
@@ -1779,6 +1927,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                         if (k >= 0)
                         {
                             v->legato(k, velocity, channelState[kchan].keyState[k].lastdetune);
+                            voiceLookup.dirty = true;
                             do_release = false;
                             // See the comment above at the other _st legato spot
                             v->state.channel = kchan;
@@ -1824,9 +1973,11 @@ void SurgeSynthesizer::releaseNoteByHostNoteID(int32_t host_noteid, char velocit
         // note also
         bool recycleNoteID =
             ptS.polymode.val.i == pm_mono_st_fp || ptS.polymode.val.i == pm_mono_st;
-        for (auto v : voices[s])
+        auto mask = candidateVoices(s, -1, -1, host_noteid);
+        for (int i = 0; mask; ++i, mask >>= 1)
         {
-            if (v->host_note_id == host_noteid)
+            auto v = &voices_array[s][i];
+            if ((mask & 1) && v->host_note_id == host_noteid)
             {
                 found = true;
                 done[v->state.key] |= 1 << v->state.channel;
@@ -1873,9 +2024,11 @@ void SurgeSynthesizer::setNoteExpression(SurgeVoice::NoteExpressionType net, int
 {
     for (int sc = 0; sc < n_scenes; sc++)
     {
-        for (auto v : voices[sc])
+        auto mask = candidateVoices(sc, channel, key, note_id);
+        for (int i = 0; mask; ++i, mask >>= 1)
         {
-            if (v->matchesChannelKeyId(channel, key, note_id))
+            auto v = &voices_array[sc][i];
+            if ((mask & 1) && v->matchesChannelKeyId(channel, key, note_id))
             {
                 v->applyNoteExpression(net, value);
             }
@@ -1949,6 +2102,7 @@ void SurgeSynthesizer::resetPitchBend(int8_t channel)
     storage.pitch_bend = 0.f;
     pitchbendMIDIVal = 0;
     hasUpdatedMidiCC = true;
+    markUIChanged(uic_midi);
 
     if (channel > -1)
     {
@@ -2001,6 +2155,7 @@ void SurgeSynthesizer::pitchBend(char channel, int value)
 
         pitchbendMIDIVal = value;
         hasUpdatedMidiCC = true;
+        markUIChanged(uic_midi);
 
         for (int sc = 0; sc < n_scenes; sc++)
         {
@@ -2036,6 +2191,7 @@ void SurgeSynthesizer::polyAftertouch(char channel, int key, int value)
 void SurgeSynthesizer::programChange(char channel, int value)
 {
     PCH = value;
+    programChangeReceived = true;
 
     auto pid = storage.patchIdToMidiBankAndProgram[CC0][PCH];
     if (pid >= 0)
@@ -2138,6 +2294,7 @@ void SurgeSynthesizer::channelController(char channel, int cc, int value)
 
         modwheelCC = value;
         hasUpdatedMidiCC = true;
+        markUIChanged(uic_midi);
         break;
     case 2:
         for (int sc = 0; sc < n_scenes; sc++)
@@ -2197,6 +2354,7 @@ void SurgeSynthesizer::channelController(char channel, int cc, int value)
 
         sustainpedalCC = value;
         hasUpdatedMidiCC = true;
+        markUIChanged(uic_midi);
 
         if (storage.mapChannelToOctave)
         {
@@ -2313,6 +2471,7 @@ void SurgeSynthesizer::channelController(char channel, int cc, int value)
             storage.getPatch().param_ptr[learn_param_from_cc]->midictrl = cc_encoded;
             storage.getPatch().param_ptr[learn_param_from_cc]->midichan = channel;
             storage.getPatch().param_ptr[learn_param_from_cc]->miditakeover_status = sts_locked;
+            storage.midiMappingGeneration++;
 
             learn_param_from_cc = -1;
         }
@@ -2324,114 +2483,162 @@ void SurgeSynthesizer::channelController(char channel, int cc, int value)
         {
             storage.controllers[learn_macro_from_cc] = cc_encoded;
             storage.controllers_chan[learn_macro_from_cc] = channel;
+            storage.midiMappingGeneration++;
 
             learn_macro_from_cc = -1;
         }
     }
 
-    for (int i = 0; i < n_customcontrollers; i++)
+    if (midiControlIndex.builtGeneration != storage.midiMappingGeneration)
+        rebuildMidiControlIndex();
+
+    auto [firstTarget, lastTarget] = midiControlIndex.targetsFor(cc_encoded);
+
+    for (auto t = firstTarget; t != lastTarget; ++t)
     {
-        if (storage.controllers[i] == cc_encoded &&
-            (storage.controllers_chan[i] == channel || storage.controllers_chan[i] == -1))
+        if (t->channel != channel && t->channel != -1)
+            continue;
+
+        if (t->isMacro)
         {
-            ((ControllerModulationSource *)storage.getPatch().scene[0].modsources[ms_ctrl1 + i])
-                ->set_target01(0, fval);
+            auto ms = storage.getPatch().scene[0].modsources[ms_ctrl1 + t->index];
+            ((ControllerModulationSource *)ms)->set_target01(0, fval);
+            continue;
         }
-    }
 
-    for (int i = 0; i < (n_global_params + (n_scene_params * n_scenes)); i++)
-    {
+        auto i = t->index;
         auto p = storage.getPatch().param_ptr[i];
 
-        if (p->midictrl == cc_encoded && (p->midichan == channel || p->midichan == -1))
+        bool applyControl{true};
+        if (midiSoftTakeover && p->miditakeover_status != sts_locked)
         {
-            bool applyControl{true};
-            if (midiSoftTakeover && p->miditakeover_status != sts_locked)
-            {
-                const auto pval = p->get_value_f01();
-                /*
-                std::cout << "Takeover " << p->get_full_name() << " " << pval << " " << fval
-                          << " " << p->miditakeover_status
-                          << std::endl;
-                          */
+            const auto pval = p->get_value_f01();
+            /*
+            std::cout << "Takeover " << p->get_full_name() << " " << pval << " " << fval
+                      << " " << p->miditakeover_status
+                      << std::endl;
+                      */
 
-                static constexpr float buffer = {1.5f / 127.f}; // 1.5 midi CCs away
+            static constexpr float buffer = {1.5f / 127.f}; // 1.5 midi CCs away
 
-                switch (p->miditakeover_status)
+            switch (p->miditakeover_status)
+            {
+            case sts_waiting_for_first_look:
+                if (fval < pval - buffer)
                 {
-                case sts_waiting_for_first_look:
-                    if (fval < pval - buffer)
-                    {
-                        // printf("wait for val below\n");
-                        p->miditakeover_status = sts_waiting_below;
-                    }
-                    else if (fval > pval + buffer)
-                    {
-                        // printf("wait for val above\n");
-                        p->miditakeover_status = sts_waiting_above;
-                    }
-                    else
-                    {
-                        // printf("wait for val locked\n");
-                        p->miditakeover_status = sts_locked;
-                    }
-                    break;
-                case sts_waiting_below:
-                    if (fval > pval - buffer)
-                    {
-                        // printf("waiting below locked\n");
-                        p->miditakeover_status = sts_locked;
-                    }
-                    break;
-                case sts_waiting_above:
-                    if (fval < pval + buffer)
-                    {
-                        // printf("waiting above locked\n");
-                        p->miditakeover_status = sts_locked;
-                    }
-                    break;
-                default:
-                    break;
+                    // printf("wait for val below\n");
+                    p->miditakeover_status = sts_waiting_below;
                 }
-
-                if (p->miditakeover_status != sts_locked)
+                else if (fval > pval + buffer)
+                {
+                    // printf("wait for val above\n");
+                    p->miditakeover_status = sts_waiting_above;
+                }
+                else
+                {
+                    // printf("wait for val locked\n");
+                    p->miditakeover_status = sts_locked;
+                }
+                break;
+            case sts_waiting_below:
+                if (fval > pval - buffer)
+                {
+                    // printf("waiting below locked\n");
+                    p->miditakeover_status = sts_locked;
+                }
+                break;
+            case sts_waiting_above:
+                if (fval < pval + buffer)
                 {
-                    // printf("not locked\n");
-                    applyControl = false;
+                    // printf("waiting above locked\n");
+                    p->miditakeover_status = sts_locked;
                 }
+                break;
+            default:
+                break;
             }
 
-            if (applyControl)
+            if (p->miditakeover_status != sts_locked)
             {
-                // std::cout << "About to set parameter to " << fval << std::endl;
+                // printf("not locked\n");
+                applyControl = false;
+            }
+        }
 
-                this->setParameterSmoothed(i, fval);
+        if (applyControl)
+        {
+            // std::cout << "About to set parameter to " << fval << std::endl;
 
-                // Notify audio thread param change listeners (OSC, e.g.)
-                // (which run on juce messenger thread)
-                for (const auto &it : audioThreadParamListeners)
-                    (it.second)(storage.getPatch().param_ptr[i]->oscName, fval, "");
+            this->setParameterSmoothed(i, fval);
+
+            // Log for the audio thread param change consumers (OSC, e.g.)
+            // (which drain on juce messenger thread)
+            if (!audioThreadParamLogListeners.empty() &&
+                audioThreadParamChanges.push(i, fval))
+            {
+                for (const auto &it : audioThreadParamLogListeners)
+                    (it.second)();
+            }
 
-                int j = 0;
-                while (j < 7)
+            int j = 0;
+            while (j < 7)
+            {
+                if ((refresh_ctrl_queue[j] > -1) && (refresh_ctrl_queue[j] != i))
                 {
-                    if ((refresh_ctrl_queue[j] > -1) && (refresh_ctrl_queue[j] != i))
-                    {
-                        j++;
-                    }
-                    else
-                    {
-                        break;
-                    }
+                    j++;
+                }
+                else
+                {
+                    break;
                 }
-
-                refresh_ctrl_queue[j] = i;
-                refresh_ctrl_queue_value[j] = fval;
             }
+
+            refresh_ctrl_queue[j] = i;
+            refresh_ctrl_queue_value[j] = fval;
+            markUIChanged(uic_params);
         }
     }
 }
 
+void SurgeSynthesizer::rebuildMidiControlIndex()
+{
+    auto &idx = midiControlIndex;
+    idx.builtGeneration = storage.midiMappingGeneration;
+    idx.nTargets = 0;
+
+    for (int i = 0; i < n_customcontrollers; i++)
+    {
+        if (storage.controllers[i] >= 0)
+            idx.targets[idx.nTargets++] = {storage.controllers[i], storage.controllers_chan[i],
+                                           true, i};
+    }
+
+    for (int i = 0; i < (n_global_params + (n_scene_params * n_scenes)); i++)
+    {
+        auto p = storage.getPatch().param_ptr[i];
+
+        if (p->midictrl >= 0)
+            idx.targets[idx.nTargets++] = {p->midictrl, p->midichan, false, i};
+    }
+
+    // each controller keeps its macros first and both in index order
+    std::sort(idx.targets, idx.targets + idx.nTargets, [](const auto &a, const auto &b) {
+        if (a.ccEncoded != b.ccEncoded)
+            return a.ccEncoded < b.ccEncoded;
+        if (a.isMacro != b.isMacro)
+            return a.isMacro;
+        return a.index < b.index;
+    });
+
+    int t = 0;
+    for (int cc = 0; cc <= 128; ++cc)
+    {
+        while (t < idx.nTargets && idx.targets[t].ccEncoded < cc)
+            t++;
+        idx.ccStart[cc] = t;
+    }
+}
+
 void SurgeSynthesizer::allSoundOff()
 {
     approachingAllSoundOff = true;
@@ -2495,8 +2702,8 @@ void SurgeSynthesizer::allNotesOff()
         {
             if (v->state.gate)
             {
-                std::cout << "After all notes off voice is still gated " << (int)v->state.channel
-                          << " " << (int)v->state.key << std::endl;
+                storage.diagnostics.push(Surge::Debug::diag_voice_gated_after_all_notes_off,
+                                         v->state.channel, v->state.key);
             }
         }
     }
@@ -2505,10 +2712,7 @@ void SurgeSynthesizer::allNotesOff()
 
 void SurgeSynthesizer::purgeHoldbuffer(int scene)
 {
-    std::list<HoldBufferItem> retainBuffer;
-
-    for (auto hp : holdbuffer[scene])
-    {
+    holdbuffer[scene].retain([this, scene](const HoldBufferItem &hp) {
         auto channel = hp.channel;
         auto key = hp.key;
 
@@ -2525,20 +2729,16 @@ void SurgeSynthesizer::purgeHoldbuffer(int scene)
                 // The mpe and mono modes and latch have a variety of very difficult handlings
                 purgeDuplicateHeldVoicesInPolyMode(scene, hp.originalChannel, hp.originalKey);
             }
+            return false;
         }
-        else
+
+        if (!channelState[0].hold && !channelState[channel].hold)
         {
-            if (!channelState[0].hold && !channelState[channel].hold)
-            {
-                releaseNotePostHoldCheck(scene, channel, key, 127, hp.host_noteid);
-            }
-            else
-            {
-                retainBuffer.push_back(hp);
-            }
+            releaseNotePostHoldCheck(scene, channel, key, 127, hp.host_noteid);
+            return false;
         }
-    }
-    holdbuffer[scene] = retainBuffer;
+        return true;
+    });
 }
 
 void SurgeSynthesizer::purgeDuplicateHeldVoicesInPolyMode(int scene, int channel, int key)
@@ -2547,7 +2747,7 @@ void SurgeSynthesizer::purgeDuplicateHeldVoicesInPolyMode(int scene, int channel
      * channel probably
      */
     std::vector<SurgeVoice *> candidates;
-    for (const auto &v : voices[scene])
+    for (auto v : voices[scene])
     {
         if (v->state.key == key && v->state.channel == channel && v->state.gate)
         {
@@ -2586,7 +2786,7 @@ void SurgeSynthesizer::stopSound()
 
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::const_iterator iter;
+        voiceList_t::const_iterator iter;
         for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
         {
             freeVoice(*iter);
@@ -2597,13 +2797,12 @@ void SurgeSynthesizer::stopSound()
     holdbuffer[1].clear();
     halfbandA.reset();
     halfbandB.reset();
+    halfbandHighRateA.reset();
+    halfbandHighRateB.reset();
     halfbandIN.reset();
 
-    for (int i = 0; i < n_hpBQ; i++)
-    {
-        hpA[i].suspend();
-        hpB[i].suspend();
-    }
+    for (auto &hp : sceneLowCut)
+        hp.suspend();
 
     for (int i = 0; i < n_fx_slots; i++)
     {
@@ -2613,13 +2812,31 @@ void SurgeSynthesizer::stopSound()
         }
     }
 
-    memset(mControlInterpolatorUsed, 0, sizeof(bool) * num_controlinterpolators);
+    ResetControlInterpolators();
 }
 
 void SurgeSynthesizer::setSamplerate(float sr)
 {
+    /*
+     * Hosts call prepare again for block size changes, transport resets and so on without the
+     * rate moving. Resetting every effect and voice then only throws their state away.
+     */
+    if (sr == preparedSamplerate)
+    {
+        return;
+    }
+    preparedSamplerate = sr;
+
     storage.setSamplerate(sr);
 
+    /*
+     * The scene decimators only have to remove what would fold back into the audible band.
+     * From 88.2k up that starts 20k below the oversampled Nyquist, so a short, gentle halfband
+     * does the job of the steep one we need at 44.1k and 48k for half the work. The input
+     * upsampler keeps the steep filter since its images feed the oscillators.
+     */
+    useHighRateDecimators = sr >= 88200;
+
     for (const auto &f : fx)
     {
         if (f)
@@ -2640,42 +2857,80 @@ void SurgeSynthesizer::setSamplerate(float sr)
 
 //-------------------------------------------------------------------------------------------------
 
-int SurgeSynthesizer::GetFreeControlInterpolatorIndex()
+void SurgeSynthesizer::ResetControlInterpolators()
 {
+    mControlInterpolatorActiveCount = 0;
+    mControlInterpolatorFreeCount = num_controlinterpolators;
+
+    // hand the low slots out first, like the scan used to
     for (int i = 0; i < num_controlinterpolators; i++)
     {
-        if (!mControlInterpolatorUsed[i])
-        {
-            return i;
-        }
+        mControlInterpolatorFree[i] = num_controlinterpolators - 1 - i;
+        mControlInterpolatorActivePos[i] = -1;
     }
-    assert(0);
-    return -1;
 }
 
 //-------------------------------------------------------------------------------------------------
 
-int SurgeSynthesizer::GetControlInterpolatorIndex(int Id)
+int SurgeSynthesizer::GetFreeControlInterpolatorIndex()
 {
-    for (int i = 0; i < num_controlinterpolators; i++)
+    if (mControlInterpolatorFreeCount == 0)
     {
-        if (mControlInterpolatorUsed[i] && mControlInterpolator[i].id == Id)
-        {
-            return i;
-        }
+        assert(0);
+        return -1;
     }
-    return -1;
+
+    int Index = mControlInterpolatorFree[--mControlInterpolatorFreeCount];
+
+    mControlInterpolatorActivePos[Index] = mControlInterpolatorActiveCount;
+    mControlInterpolatorActive[mControlInterpolatorActiveCount++] = Index;
+
+    return Index;
 }
 
 //-------------------------------------------------------------------------------------------------
 
-void SurgeSynthesizer::ReleaseControlInterpolator(int Id)
+void SurgeSynthesizer::FreeControlInterpolatorIndex(int Index)
 {
-    int Index = GetControlInterpolatorIndex(Id);
-    if (Index >= 0)
-    {
-        assert(Index < num_controlinterpolators);
-        mControlInterpolatorUsed[Index] = false;
+    int Pos = mControlInterpolatorActivePos[Index];
+
+    if (Pos < 0)
+        return;
+
+    // move the last active slot into the hole
+    int Last = mControlInterpolatorActive[--mControlInterpolatorActiveCount];
+    mControlInterpolatorActive[Pos] = Last;
+    mControlInterpolatorActivePos[Last] = Pos;
+
+    mControlInterpolatorActivePos[Index] = -1;
+    mControlInterpolatorFree[mControlInterpolatorFreeCount++] = Index;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int SurgeSynthesizer::GetControlInterpolatorIndex(int Id)
+{
+    for (int i = 0; i < mControlInterpolatorActiveCount; i++)
+    {
+        int Index = mControlInterpolatorActive[i];
+
+        if (mControlInterpolator[Index].id == Id)
+        {
+            return Index;
+        }
+    }
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void SurgeSynthesizer::ReleaseControlInterpolator(int Id)
+{
+    int Index = GetControlInterpolatorIndex(Id);
+    if (Index >= 0)
+    {
+        assert(Index < num_controlinterpolators);
+        FreeControlInterpolatorIndex(Index);
     }
 }
 
@@ -2713,7 +2968,6 @@ ControllerModulationSource *SurgeSynthesizer::AddControlInterpolator(int Id, boo
     {
         // Add new
         mControlInterpolator[Index].id = Id;
-        mControlInterpolatorUsed[Index] = true;
 
         mControlInterpolator[Index].set_samplerate(storage.samplerate, storage.samplerate_inv);
         mControlInterpolator[Index].smoothingMode = storage.smoothingMode; // IMPLEMENT THIS HERE
@@ -2766,6 +3020,10 @@ bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bo
             if (p->val.i != oldval.i)
             {
                 storage.getPatch().isDirty = true;
+
+                // types and modes decide how other parameters read
+                if (p->valtype != vt_float)
+                    storage.displayGeneration++;
             }
         }
 
@@ -2794,7 +3052,7 @@ bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bo
                     // The release if latched initiates a release scene
                     // which kills all voices but doesn't clear up the
                     // keyboard state. So
-                    for (auto &v : voices[s])
+                    for (auto v : voices[s])
                     {
                         const auto &st = v->state;
                         channelState[st.channel].keyState[st.key].keystate = 0;
@@ -2980,13 +3238,14 @@ void SurgeSynthesizer::queueForRefresh(int param_index)
     }
     if (!got)
         refresh_overflow = true;
+    markUIChanged(uic_params);
 }
 
 void SurgeSynthesizer::switch_toggled()
 {
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::iterator iter;
+        voiceList_t::iterator iter;
         for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
         {
             SurgeVoice *v = *iter;
@@ -2995,8 +3254,210 @@ void SurgeSynthesizer::switch_toggled()
     }
 }
 
+void SurgeSynthesizer::prepareFxSwap(int slot)
+{
+    freeRetiredEffects();
+
+    auto &box = prespawnedFx[slot];
+    int expected = PrespawnedEffect::empty;
+
+    if (!box.state.compare_exchange_strong(expected, PrespawnedEffect::writing))
+    {
+        // one built for an earlier change the audio thread hasn't picked up yet
+        if (expected != PrespawnedEffect::ready ||
+            !box.state.compare_exchange_strong(expected, PrespawnedEffect::writing))
+            return;
+
+        delete box.fx;
+        box.fx = nullptr;
+    }
+
+    box.type = fxsync[slot].type.val.i;
+    box.fx = spawn_effect(box.type, &storage, &storage.getPatch().fx[slot],
+                          storage.getPatch().globaldata);
+
+    box.state.store(box.fx ? PrespawnedEffect::ready : PrespawnedEffect::empty,
+                    std::memory_order_release);
+}
+
+Effect *SurgeSynthesizer::takePrespawnedFx(int slot, int type)
+{
+    auto &box = prespawnedFx[slot];
+    int expected = PrespawnedEffect::ready;
+
+    if (!box.state.compare_exchange_strong(expected, PrespawnedEffect::taking,
+                                           std::memory_order_acquire))
+        return nullptr;
+
+    Effect *res = box.fx;
+    box.fx = nullptr;
+
+    if (box.type != type)
+    {
+        // the slot changed again some other way since, so this one is no use
+        fx[slot].reset(res);
+        retireFx(slot);
+        res = nullptr;
+    }
+
+    box.state.store(PrespawnedEffect::empty, std::memory_order_release);
+    return res;
+}
+
+void SurgeSynthesizer::retireFx(int slot)
+{
+    auto *old = fx[slot].release();
+
+    if (!old)
+        return;
+
+    if (auto *uncollected = retiredFx[slot].exchange(old, std::memory_order_acq_rel))
+    {
+        // nobody has been by to free the last one, so we have to do it here after all
+        delete uncollected;
+    }
+}
+
+void SurgeSynthesizer::freeRetiredEffects()
+{
+    for (auto &r : retiredFx)
+    {
+        delete r.exchange(nullptr, std::memory_order_acq_rel);
+    }
+}
+
+double SurgeSynthesizer::getTailLengthSeconds() const
+{
+    auto &patch = storage.getPatch();
+
+    // The digital envelope falls linearly over 2^r seconds and the analog one is at a small
+    // fraction of the way by then, which is the best we can say without running it
+    double release = 0.0;
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        auto &r = patch.scene[sc].adsr[0].r;
+        auto t = std::pow(2.0, (double)r.val.f);
+        if (r.temposync)
+            t /= storage.temposyncratio;
+        release = std::max(release, t);
+    }
+
+    int ringoutBlocks = 0;
+    for (int i = 0; i < n_fx_slots; ++i)
+    {
+        if (!fx[i] || (patch.fx_disable.val.i & (1 << i)))
+            continue;
+
+        auto d = fx[i]->get_ringout_decay();
+        if (d < 0)
+            return -1.0;
+        ringoutBlocks += d;
+    }
+
+    return release + ringoutBlocks * BLOCK_SIZE * storage.dsamplerate_inv;
+}
+
+size_t SurgeSynthesizer::MemoryReport::total() const
+{
+    auto res = voices + oscillatorBuffers + filterStates + wavetables + memoryPools + lua + patchDB;
+    for (auto f : fxSlots)
+        res += f;
+    return res;
+}
+
+SurgeSynthesizer::MemoryReport SurgeSynthesizer::memoryReport()
+{
+    MemoryReport res;
+
+    res.oscillatorBuffers = n_scenes * MAX_VOICES * n_oscs * oscillator_buffer_size;
+    res.voices = sizeof(voices_array) - res.oscillatorBuffers;
+    res.filterStates = n_scenes * (MAX_VOICES >> 2) * sizeof(QuadFilterChainState);
+
+    {
+        std::lock_guard<std::mutex> g(fxSpawnMutex);
+        for (int i = 0; i < n_fx_slots; ++i)
+            res.fxSlots[i] = fx[i] ? fx[i]->memoryFootprint() : 0;
+    }
+
+    // oscillators playing the same table share one block, so count each block once
+    std::set<const void *> seen;
+    for (auto &sc : storage.getPatch().scene)
+    {
+        for (auto &o : sc.osc)
+        {
+            auto &d = o.wt.builtTableData();
+            if (d && seen.insert(d.get()).second)
+                res.wavetables +=
+                    d->dataSizes * ((d->compact ? 0 : sizeof(float)) + sizeof(short));
+        }
+    }
+
+    if (storage.memoryPools)
+    {
+        auto &mp = *storage.memoryPools;
+        res.memoryPools = mp.stringDelayLines.bytesAlive() + mp.shortStringDelayLines.bytesAlive() +
+                          mp.twistStates.bytesAlive();
+
+        // the delay memory the effects are using is already in their slots
+        auto reserved = mp.effectDelayLines.floatsReserved();
+        auto lent = std::min(reserved, mp.effectDelayLines.floatsInUse());
+        res.memoryPools += (reserved - lent) * sizeof(float);
+    }
+
+    if (frozenHitsReady)
+        res.memoryPools += frozenHits->bytesInUse();
+
+    res.lua = Surge::Formula::luaBytesInUse(&storage);
+    res.patchDB = Surge::PatchStorage::PatchDB::memoryInUse();
+
+    return res;
+}
+
+bool SurgeSynthesizer::processEffect(int slot, float *dataL, float *dataR, bool indata_present,
+                                     bool isSend)
+{
+    SURGE_TRACE_ZONE("Effect::process");
+    SURGE_TRACE_ZONE_TEXT(fx_type_names[storage.getPatch().fx[slot].type.val.i]);
+    Surge::FPUState::StageAudit audit(Surge::Profiling::ps_fx_first + slot);
+
+    if (fxSwapFade[slot] <= 0)
+        return fx[slot]->process_ringout(dataL, dataR, indata_present);
+
+    /*
+     * The effect we replaced is gone, so fade the new one in from what we'd have with no
+     * effect here: the dry signal for an insert, or nothing at all for a send
+     */
+    float dryL alignas(16)[BLOCK_SIZE], dryR alignas(16)[BLOCK_SIZE];
+
+    if (isSend)
+    {
+        mech::clear_block<BLOCK_SIZE>(dryL);
+        mech::clear_block<BLOCK_SIZE>(dryR);
+    }
+    else
+    {
+        mech::copy_from_to<BLOCK_SIZE>(dataL, dryL);
+        mech::copy_from_to<BLOCK_SIZE>(dataR, dryR);
+    }
+
+    auto res = fx[slot]->process_ringout(dataL, dataR, indata_present);
+
+    for (int i = 0; i < BLOCK_SIZE; i++)
+    {
+        auto dry = std::max(fxSwapFade[slot] - i, 0) * (1.f / fxSwapFadeSamples);
+        dataL[i] = dry * dryL[i] + (1.f - dry) * dataL[i];
+        dataR[i] = dry * dryR[i] + (1.f - dry) * dataR[i];
+    }
+
+    fxSwapFade[slot] = std::max(fxSwapFade[slot] - BLOCK_SIZE, 0);
+
+    return res;
+}
+
 bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
 {
+    SURGE_TRACE_ZONE("SurgeSynthesizer::loadFx");
+
     load_fx_needed = false;
     bool localSendFX[n_fx_slots];
     for (int s = 0; s < n_fx_slots; s++)
@@ -3010,9 +3471,10 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
             storage.getPatch().isDirty = true;
             fx_reload[s] = false;
 
+            Surge::RealtimeSafety::noteLock("fxSpawnMutex");
             std::lock_guard<std::mutex> g(fxSpawnMutex);
 
-            fx[s].reset();
+            retireFx(s);
             /*if (!force_reload_all)*/ storage.getPatch().fx[s].type.val.i = fxsync[s].type.val.i;
             // else fxsync[s].type.val.i = storage.getPatch().fx[s].type.val.i;
 
@@ -3032,8 +3494,17 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
                           std::begin(storage.getPatch().fx[s].p));
             }
 
-            fx[s].reset(spawn_effect(storage.getPatch().fx[s].type.val.i, &storage,
-                                     &storage.getPatch().fx[s], storage.getPatch().globaldata));
+            auto newType = storage.getPatch().fx[s].type.val.i;
+            auto *built = takePrespawnedFx(s, newType);
+            processProfiler.noteEvent(Surge::Profiling::be_fx_spawn);
+
+            fx[s].reset(built ? built
+                              : spawn_effect(newType, &storage, &storage.getPatch().fx[s],
+                                             storage.getPatch().globaldata));
+
+            // a patch load resets everything anyway, but a single slot change keeps playing
+            fxSwapFade[s] = (fx[s] && !force_reload_all) ? fxSwapFadeSamples : 0;
+
             if (fx[s])
             {
                 fx[s]->init_ctrltypes();
@@ -3165,6 +3636,7 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
                           std::begin(storage.getPatch().fx[s].p));
             if (fx[s])
             {
+                Surge::RealtimeSafety::noteLock("fxSpawnMutex");
                 std::lock_guard<std::mutex> g(fxSpawnMutex);
                 fx[s]->suspend();
                 fx[s]->init();
@@ -3175,6 +3647,11 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
             something_changed = true;
         }
 
+        if (something_changed)
+        {
+            storage.displayGeneration++;
+        }
+
         if (fx[s] && something_changed)
         {
             fx[s]->updateAfterReload();
@@ -3618,20 +4095,22 @@ void SurgeSynthesizer::prepareModsourceDoProcess(int scenemask)
                 }
             }
 
+            auto &routings = storage.audioModulationRoutings();
+
             for (int j = 0; j < 3; j++)
             {
-                vector<ModulationRouting> *modlist;
+                const vector<ModulationRouting> *modlist;
 
                 switch (j)
                 {
                 case 0:
-                    modlist = &storage.getPatch().modulation_global;
+                    modlist = &routings.global;
                     break;
                 case 1:
-                    modlist = &storage.getPatch().scene[scene].modulation_scene;
+                    modlist = &routings.scene[scene];
                     break;
                 case 2:
-                    modlist = &storage.getPatch().scene[scene].modulation_voice;
+                    modlist = &routings.voice[scene];
                     break;
                 }
 
@@ -3690,6 +4169,7 @@ void SurgeSynthesizer::muteModulation(long ptag, modsources modsource, int modso
     {
         r->muted = mute;
         storage.getPatch().isDirty = true;
+        storage.publishModulationRoutings();
 
         for (auto l : modListeners)
             l->modMuted(ptag, modsource, modsourceScene, index, mute);
@@ -3699,57 +4179,35 @@ void SurgeSynthesizer::muteModulation(long ptag, modsources modsource, int modso
 void SurgeSynthesizer::applyParameterMonophonicModulation(Parameter *p, float depth)
 {
     auto &pt = storage.getPatch();
-    if (pt.paramModulationCount >= pt.maxMonophonicParamModulations)
-    {
-        // hmmm ... what to do here?
-        return;
-    }
-    // This linear search will become, i think, quite tiresome at size
-    for (int i = 0; i < pt.paramModulationCount; ++i)
+    auto slot = pt.monophonicParamModulationSlot[p->id];
+    if (!slot)
     {
-        if (pt.monophonicParamModulations[i].param_id == p->id)
+        if (pt.paramModulationCount >= pt.maxMonophonicParamModulations)
         {
-            pt.monophonicParamModulations[i].vt_type = (valtypes)p->valtype;
-            switch (p->valtype)
-            {
-            case vt_float:
-                pt.monophonicParamModulations[i].value = depth * (p->val_max.f - p->val_min.f);
-                break;
-            case vt_int:
-                pt.monophonicParamModulations[i].value = depth * (p->val_max.i - p->val_min.i);
-                pt.monophonicParamModulations[i].imin = p->val_min.i;
-                pt.monophonicParamModulations[i].imax = p->val_max.i;
-
-                break;
-            case vt_bool:
-                pt.monophonicParamModulations[i].value = depth;
-                break;
-            }
+            // hmmm ... what to do here?
             return;
         }
+        slot = ++pt.paramModulationCount;
+        pt.monophonicParamModulationSlot[p->id] = slot;
+        pt.monophonicParamModulations[slot - 1].param_id = p->id;
     }
 
-    assert(pt.paramModulationCount < pt.maxMonophonicParamModulations);
-    pt.monophonicParamModulations[pt.paramModulationCount].param_id = p->id;
-    pt.monophonicParamModulations[pt.paramModulationCount].vt_type = (valtypes)p->valtype;
+    auto &pm = pt.monophonicParamModulations[slot - 1];
+    pm.vt_type = (valtypes)p->valtype;
     switch (p->valtype)
     {
     case vt_float:
-        pt.monophonicParamModulations[pt.paramModulationCount].value =
-            depth * (p->val_max.f - p->val_min.f);
+        pm.value = depth * (p->val_max.f - p->val_min.f);
         break;
     case vt_int:
-        pt.monophonicParamModulations[pt.paramModulationCount].value =
-            depth * (p->val_max.i - p->val_min.i);
-        pt.monophonicParamModulations[pt.paramModulationCount].imin = p->val_min.i;
-        pt.monophonicParamModulations[pt.paramModulationCount].imax = p->val_max.i;
+        pm.value = depth * (p->val_max.i - p->val_min.i);
+        pm.imin = p->val_min.i;
+        pm.imax = p->val_max.i;
         break;
     case vt_bool:
-        pt.monophonicParamModulations[pt.paramModulationCount].value = depth;
+        pm.value = depth;
         break;
     }
-    pt.paramModulationCount++;
-    return;
 }
 
 void SurgeSynthesizer::applyParameterPolyphonicModulation(Parameter *p, int32_t note_id,
@@ -3767,22 +4225,63 @@ void SurgeSynthesizer::applyParameterPolyphonicModulation(Parameter *p, int32_t
      */
     float underlyingMonoMod{0};
     auto &pt = storage.getPatch();
-    // This linear search will become, i think, quite tiresome at size
-    for (int i = 0; i < pt.paramModulationCount; ++i)
+    if (auto slot = pt.monophonicParamModulationSlot[p->id])
+    {
+        underlyingMonoMod = pt.monophonicParamModulations[slot - 1].value;
+    }
+
+    auto sc = p->scene - 1;
+    auto mask = candidateVoices(sc, channel, key, note_id);
+    for (int i = 0; mask; ++i, mask >>= 1)
     {
-        if (pt.monophonicParamModulations[i].param_id == p->id)
+        auto v = &voices_array[sc][i];
+        if ((mask & 1) && v->matchesChannelKeyId(channel, key, note_id))
         {
-            underlyingMonoMod = pt.monophonicParamModulations[i].value;
+            v->applyPolyphonicParamModulation(p, depth, underlyingMonoMod);
         }
     }
+}
 
-    for (auto v : voices[p->scene - 1])
+void SurgeSynthesizer::rebuildVoiceLookup()
+{
+    voiceLookup.clear();
+    for (int sc = 0; sc < n_scenes; ++sc)
     {
-        if (v->matchesChannelKeyId(channel, key, note_id))
+        for (auto v : voices[sc])
         {
-            v->applyPolyphonicParamModulation(p, depth, underlyingMonoMod);
+            auto idx = (int)(v - voices_array[sc].data());
+            // releaseScene frees voices before it clears the list
+            if (!voices_usedby[sc][idx])
+                continue;
+            if (v->host_note_id >= 0)
+                voiceLookup.add(v->host_note_id, sc, idx);
+            voiceLookup.addChannelKey(v->state.channel, v->state.key, sc, idx);
         }
     }
+    voiceLookup.dirty = false;
+}
+
+uint64_t SurgeSynthesizer::candidateVoices(int scene, int16_t channel, int16_t key,
+                                           int32_t noteId)
+{
+    if (noteId < 0 && (channel < 0 || key < 0))
+    {
+        uint64_t all{0};
+        for (auto v : voices[scene])
+            all |= (uint64_t)1 << (v - voices_array[scene].data());
+        return all;
+    }
+
+    if (voiceLookup.dirty)
+        rebuildVoiceLookup();
+
+    if (noteId < 0)
+        return voiceLookup.voicesFor(channel, key, scene);
+
+    auto mask = voiceLookup.voicesFor(noteId, scene);
+    if (channel >= 0 && key >= 0)
+        mask &= voiceLookup.voicesFor(channel, key, scene);
+    return mask;
 }
 
 void SurgeSynthesizer::clear_osc_modulation(int scene, int entry)
@@ -3811,6 +4310,7 @@ void SurgeSynthesizer::clear_osc_modulation(int scene, int entry)
         else
             iter++;
     }
+    storage.publishModulationRoutings();
     storage.modRoutingMutex.unlock();
 }
 
@@ -3894,6 +4394,7 @@ void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, int mods
         {
             storage.modRoutingMutex.lock();
             modlist->erase(modlist->begin() + i);
+            storage.publishModulationRoutings();
             storage.modRoutingMutex.unlock();
             storage.getPatch().isDirty = true;
 
@@ -3972,6 +4473,7 @@ bool SurgeSynthesizer::setModDepth01(long ptag, modsources modsource, int modsou
             modlist->at(found_id).depth = value;
         }
     }
+    storage.publishModulationRoutings();
     storage.modRoutingMutex.unlock();
 
     for (auto l : modListeners)
@@ -4185,6 +4687,10 @@ bool SurgeSynthesizer::stringToNormalizedValue(const ID &index, std::string s, f
 
 void loadPatchInBackgroundThread(SurgeSynthesizer *sy)
 {
+    SURGE_TRACE_THREAD_NAME("Surge Patch Load");
+    Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Loader);
+    auto fpuguard = Surge::FPUState::DSPThreadGuard();
+
     fs::path ppath;
     int patchid = -1;
     bool had_patchid_file = false;
@@ -4227,8 +4733,15 @@ void loadPatchInBackgroundThread(SurgeSynthesizer *sy)
 
     synth->storage.getPatch().isDirty = false;
     synth->patchChanged = true;
+
+    // free whatever prefetchQueuedPatch built, and come back in gently
+    synth->clearPatchPrefetch();
+    synth->masterfade = 0.f;
+    synth->fadeInAfterPatchLoad = true;
     synth->halt_engine = false;
 
+    synth->schedulePatchPreload();
+
     // Notify the 'patch loaded' listener(s)
     // Note that this is not an if/else for good reason: both cases may occur simultaneously
     if (patchid >= 0)
@@ -4303,7 +4816,8 @@ void SurgeSynthesizer::processAudioThreadOpsWhenAudioEngineUnavailable(bool dang
 
         loadOscalgos();
 
-        storage.perform_queued_wtloads();
+        if (storage.perform_queued_wtloads())
+            processProfiler.noteEvent(Surge::Profiling::be_wavetable_load);
     }
 }
 
@@ -4336,9 +4850,12 @@ void SurgeSynthesizer::enqueueFXOff(int whichFX)
 
 void SurgeSynthesizer::processControl()
 {
+    SURGE_TRACE_ZONE("SurgeSynthesizer::processControl");
+
     processEnqueuedPatchIfNeeded();
 
-    storage.perform_queued_wtloads();
+    if (storage.perform_queued_wtloads())
+        processProfiler.noteEvent(Surge::Profiling::be_wavetable_load);
     int sm = storage.getPatch().scenemode.val.i;
     // TODO: FIX SCENE ASSUMPTION
     bool playA = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) ||
@@ -4366,19 +4883,17 @@ void SurgeSynthesizer::processControl()
         release_anyway[1] = false;
     }
 
-    // interpolate MIDI controllers
-    for (int i = 0; i < num_controlinterpolators; i++)
+    // interpolate MIDI controllers, walking backwards so a finished one can be swapped out
+    for (int i = mControlInterpolatorActiveCount - 1; i >= 0; i--)
     {
-        if (mControlInterpolatorUsed[i])
+        int Index = mControlInterpolatorActive[i];
+        ControllerModulationSource *mc = &mControlInterpolator[Index];
+        bool cont = mc->process_block_until_close(0.001f);
+        int id = mc->id;
+        storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
+        if (!cont)
         {
-            ControllerModulationSource *mc = &mControlInterpolator[i];
-            bool cont = mc->process_block_until_close(0.001f);
-            int id = mc->id;
-            storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
-            if (!cont)
-            {
-                mControlInterpolatorUsed[i] = false;
-            }
+            FreeControlInterpolatorIndex(Index);
         }
     }
 
@@ -4420,53 +4935,41 @@ void SurgeSynthesizer::processControl()
     {
         if (((s == 0) && playA) || ((s == 1) && playB))
         {
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_modwheel])
-                storage.getPatch().scene[s].modsources[ms_modwheel]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_breath])
-                storage.getPatch().scene[s].modsources[ms_breath]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_expression])
-                storage.getPatch().scene[s].modsources[ms_expression]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_sustain])
-                storage.getPatch().scene[s].modsources[ms_sustain]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_aftertouch])
-                storage.getPatch().scene[s].modsources[ms_aftertouch]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_lowest_key])
-                storage.getPatch().scene[s].modsources[ms_lowest_key]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_highest_key])
-                storage.getPatch().scene[s].modsources[ms_highest_key]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_latest_key])
-                storage.getPatch().scene[s].modsources[ms_latest_key]->process_block();
-
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_random_unipolar])
-                storage.getPatch().scene[s].modsources[ms_random_unipolar]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_random_bipolar])
-                storage.getPatch().scene[s].modsources[ms_random_bipolar]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_bipolar])
-                storage.getPatch().scene[s].modsources[ms_alternate_bipolar]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_unipolar])
-                storage.getPatch().scene[s].modsources[ms_alternate_unipolar]->process_block();
-
-            storage.getPatch().scene[s].modsources[ms_pitchbend]->process_block();
-
-            for (int i = 0; i < n_customcontrollers; i++)
-                storage.getPatch().scene[s].modsources[ms_ctrl1 + i]->process_block();
+            auto &mods = sceneModulators[s];
+            auto *doprocess = storage.getPatch().scene[s].modsource_doprocess;
+            using SM = SceneModulators;
+
+            for (int i = 0; i < std::size(SM::controllerIds); i++)
+                if (doprocess[SM::controllerIds[i]])
+                    mods.controllers[i].process_block();
+            for (int i = 0; i < std::size(SM::keyIds); i++)
+                if (doprocess[SM::keyIds[i]])
+                    mods.keys[i].process_block();
+            for (int i = 0; i < std::size(SM::randomIds); i++)
+                if (doprocess[SM::randomIds[i]])
+                    mods.randoms[i].process_block();
+            for (int i = 0; i < std::size(SM::alternateIds); i++)
+                if (doprocess[SM::alternateIds[i]])
+                    mods.alternates[i].process_block();
+
+            mods.pitchbend.process_block();
+
+            for (auto &m : macros)
+                m.process_block();
 
             // for(int i=0; i<n_lfos_scene; i++)
             // storage.getPatch().scene[s].modsources[ms_slfo1+i]->process_block();
 
-            int n = storage.getPatch().scene[s].modulation_scene.size();
-            for (int i = 0; i < n; i++)
+            for (const auto &r : storage.audioModulationRoutings().scene[s])
             {
-                int src_id = storage.getPatch().scene[s].modulation_scene[i].source_id;
-                int src_index = storage.getPatch().scene[s].modulation_scene[i].source_index;
-                if (storage.getPatch().scene[s].modsources[src_id])
+                if (storage.getPatch().scene[s].modsources[r.source_id])
                 {
-                    int dst_id = storage.getPatch().scene[s].modulation_scene[i].destination_id;
-                    float depth = storage.getPatch().scene[s].modulation_scene[i].depth;
-                    storage.getPatch().scenedata[s][dst_id].f +=
-                        depth *
-                        storage.getPatch().scene[s].modsources[src_id]->get_output(src_index) *
-                        (1.0 - storage.getPatch().scene[s].modulation_scene[i].muted);
+                    storage.getPatch().scenedataChanges[s].mark(r.destination_id);
+                    storage.getPatch().scenedata[s][r.destination_id].f +=
+                        r.depth *
+                        storage.getPatch().scene[s].modsources[r.source_id]->get_output(
+                            r.source_index) *
+                        (1.0 - r.muted);
                 }
             }
 
@@ -4474,34 +4977,26 @@ void SurgeSynthesizer::processControl()
             {
                 if (storage.getPatch().scene[s].lfo[n_lfos_voice + i].shape.val.i == lt_formula)
                 {
-                    auto lms = dynamic_cast<LFOModulationSource *>(
-                        storage.getPatch().scene[s].modsources[ms_slfo1 + i]);
-                    if (lms)
-                    {
-                        Surge::Formula::setupEvaluatorStateFrom(lms->formulastate,
-                                                                storage.getPatch(), s);
-                    }
+                    Surge::Formula::setupEvaluatorStateFrom(mods.lfos[i].formulastate,
+                                                            storage.getPatch(), s);
                 }
-                storage.getPatch().scene[s].modsources[ms_slfo1 + i]->process_block();
+                mods.lfos[i].process_block();
             }
+
+            processSharedVoiceLFOs(s);
+            processSharedFilterCoeffs(s);
         }
     }
 
     loadOscalgos();
 
-    int n = storage.getPatch().modulation_global.size();
-    for (int i = 0; i < n; i++)
+    for (const auto &r : storage.audioModulationRoutings().global)
     {
-        int src_id = storage.getPatch().modulation_global[i].source_id;
-        int src_index = storage.getPatch().modulation_global[i].source_index;
-        int dst_id = storage.getPatch().modulation_global[i].destination_id;
-        float depth = storage.getPatch().modulation_global[i].depth;
-        int source_scene = storage.getPatch().modulation_global[i].source_scene;
-
-        storage.getPatch().globaldata[dst_id].f +=
-            depth *
-            storage.getPatch().scene[source_scene].modsources[src_id]->get_output(src_index) *
-            (1 - storage.getPatch().modulation_global[i].muted);
+        storage.getPatch().globaldata[r.destination_id].f +=
+            r.depth *
+            storage.getPatch().scene[r.source_scene].modsources[r.source_id]->get_output(
+                r.source_index) *
+            (1 - r.muted);
     }
 
     if (switch_toggled_queued)
@@ -4513,6 +5008,32 @@ void SurgeSynthesizer::processControl()
     if (load_fx_needed)
         loadFx(false, false);
 
+    storage.renderingForBounce = offlineRendering && bounceQualityWhenOffline;
+
+    auto effectOversampling =
+        storage.renderingForBounce
+            ? SurgeStorage::EFFECT_OVERSAMPLING_HIGH
+            : (SurgeStorage::EffectOversampling)requestedEffectOversampling.load();
+
+    if (cpuGovernor.getLevel() >= Surge::Profiling::gov_eco_effect_oversampling)
+        effectOversampling = SurgeStorage::EFFECT_OVERSAMPLING_ECO;
+
+    if (effectOversampling != storage.effectOversampling)
+    {
+        Surge::RealtimeSafety::noteLock("fxSpawnMutex");
+        std::lock_guard<std::mutex> g(fxSpawnMutex);
+        storage.effectOversampling = effectOversampling;
+
+        for (auto &f : fx)
+        {
+            if (f)
+            {
+                f->suspend();
+                f->init();
+            }
+        }
+    }
+
     if (fx_suspend_bitmask)
     {
         for (int i = 0; i < n_fx_slots; i++)
@@ -4559,58 +5080,717 @@ void SurgeSynthesizer::processControl()
 #endif
 }
 
-void SurgeSynthesizer::process()
+void SurgeSynthesizer::setDeterministicRendering(uint32_t seed)
 {
-#if DEBUG_RNG_THREADING
-    storage.audioThreadID = std::this_thread::get_id();
-#endif
-    processRunning = 0;
+    storage.setDeterministicSeed(seed);
+    std::srand(seed);
 
-#if DEBUG
-    memset(endedHostNoteIds, 0, 512 * sizeof(int32_t));
-#endif
+    for (auto &r : effectChainRNGs)
+        r.g.seed(storage.seedForNewGenerator());
+    for (auto &r : sceneWorkerRNGs)
+        r->g.seed(storage.seedForNewGenerator());
 
-    auto process_start = std::chrono::high_resolution_clock::now();
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        for (auto m : {ms_random_bipolar, ms_random_unipolar})
+        {
+            if (auto rms = dynamic_cast<RandomModulationSource *>(
+                    storage.getPatch().scene[s].modsources[m]))
+                rms->seed(storage.seedForNewGenerator());
+        }
+    }
+}
 
-    if (hostNoteEndedToPushToNextBlock)
+void SurgeSynthesizer::acquireScheduler()
+{
+    if (!scheduler)
+        scheduler = Surge::Threading::SharedScheduler::acquire();
+}
+
+void SurgeSynthesizer::setHostCallbackDeadline(int numSamples)
+{
+    hostCallbackDeadline =
+        Surge::Threading::SharedScheduler::clock_t::now() +
+        std::chrono::nanoseconds((int64_t)(numSamples * storage.dsamplerate_inv * 1e9));
+}
+
+Surge::Threading::SharedScheduler::clock_t::time_point SurgeSynthesizer::batchDeadline() const
+{
+    // a late callback's deadline stays in the past, which is what puts it first
+    if (hostCallbackDeadline.time_since_epoch().count() != 0)
+        return hostCallbackDeadline;
+
+    return Surge::Threading::SharedScheduler::clock_t::now() +
+           std::chrono::nanoseconds((int64_t)(BLOCK_SIZE * storage.dsamplerate_inv * 1e9));
+}
+
+void SurgeSynthesizer::setMultithreadedSceneRendering(bool b)
+{
+    if (b && sceneWorkerRNGs.empty())
     {
-        for (int i = 0; i < hostNoteEndedToPushToNextBlock; ++i)
+        // the audio thread's scene uses the storage generator, the others one each of these
+        for (int i = 0; i < n_scenes - 1; ++i)
         {
-            endedHostNoteIds[i] = nextBlockEndedHostNoteIds[i];
-            endedHostNoteOriginalKey[i] = nextBlockEndedHostNoteOriginalKey[i];
-            endedHostNoteOriginalChannel[i] = nextBlockEndedHostNoteOriginalChannel[i];
+            sceneWorkerRNGs.push_back(std::make_unique<SurgeStorage::RNGGen>());
+            if (storage.deterministicRendering)
+                sceneWorkerRNGs.back()->g.seed(storage.seedForNewGenerator());
         }
-        hostNoteEndedDuringBlockCount = hostNoteEndedToPushToNextBlock;
-        hostNoteEndedToPushToNextBlock = 0;
     }
-    else
+    if (b)
+        acquireScheduler();
+
+    multithreadedSceneRendering = b;
+}
+
+bool SurgeSynthesizer::canRenderScenesConcurrently() const
+{
+    if (!multithreadedSceneRendering || !scheduler || scheduler->numWorkers() == 0)
+        return false;
+
+    // nothing to gain unless both scenes have something to render
+    for (int s = 0; s < n_scenes; s++)
     {
-        hostNoteEndedToPushToNextBlock = 0;
-        hostNoteEndedDuringBlockCount = 0;
+        if (voices[s].empty())
+            return false;
     }
 
-    float mfade = 1.f;
+    // scene B reads scene A's output as an audio input, so A has to finish first
+    if (storage.otherscene_clients > 0)
+        return false;
 
-    if (halt_engine)
+    // formula modulators share a single audio thread lua state, so only one scene may use them
+    int scenesWithFormulas = 0;
+    for (int s = 0; s < n_scenes; s++)
     {
-        mech::clear_block<BLOCK_SIZE>(output[0]);
-        mech::clear_block<BLOCK_SIZE>(output[1]);
-        return;
+        for (int l = 0; l < n_lfos_voice; l++)
+        {
+            if (storage.getPatch().scene[s].lfo[l].shape.val.i == lt_formula)
+            {
+                scenesWithFormulas++;
+                break;
+            }
+        }
     }
-    else if (patchid_queue >= 0 || has_patchid_file)
+
+    return scenesWithFormulas < 2;
+}
+
+int SurgeSynthesizer::processSceneVoices(int s, bool deferVoiceFree)
+{
+    Surge::FPUState::StageAudit audit(Surge::Profiling::ps_voices);
+    int entry = 0;
+    auto iter = voices[s].begin();
+
+    while (iter != voices[s].end())
     {
-        masterfade = max(0.f, masterfade - 0.05f);
-        mfade = masterfade * masterfade;
+        // a quad at a time, so its voices' outputs go into the filter lanes together
+        SurgeVoice *quad[4];
+        bool resume[4];
+        int n = 0;
 
-        if (masterfade < 0.0001f)
+        for (auto it = iter; it != voices[s].end() && n < 4; ++it, ++n)
         {
-            std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
-            // spawn patch-loading thread
-            stopSound();
-            halt_engine = true;
+            quad[n] = *it;
+            assert(quad[n]);
+            resume[n] = quad[n]->process_block(FBQ[s][entry >> 2], n);
+        }
+        SurgeVoice::storeQuadInputs(FBQ[s][entry >> 2], quad, n);
 
+        for (int e = 0; e < n; ++e)
+        {
             /*
-             * In theory, since we only spawn under a lock and the loading thread
+             * freeVoice looks at the voices in both scenes and reports ended notes, so when
+             * the other scene is rendering at the same time we leave the voice in place and
+             * free it with freeFinishedVoices once both scenes are done
+             */
+            if (deferVoiceFree)
+            {
+                voiceFinished[s][entry] = !resume[e];
+                iter++;
+            }
+            else if (!resume[e])
+            {
+                freeVoice(quad[e]);
+                iter = voices[s].erase(iter);
+            }
+            else
+            {
+                iter++;
+            }
+
+            entry++;
+        }
+    }
+
+    return entry;
+}
+
+void SurgeSynthesizer::freeFinishedVoices(int s)
+{
+    int entry = 0;
+    auto iter = voices[s].begin();
+
+    while (iter != voices[s].end())
+    {
+        if (voiceFinished[s][entry])
+        {
+            freeVoice(*iter);
+            iter = voices[s].erase(iter);
+        }
+        else
+        {
+            iter++;
+        }
+
+        entry++;
+    }
+}
+
+FBQFPtr SurgeSynthesizer::prepareSceneFilterChain(int s, fbq_global &g)
+{
+    using sst::filters::FilterType, sst::filters::FilterSubType;
+    if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
+    {
+        g.FU1ptr = nullptr;
+    }
+    else
+    {
+        g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[0].subtype.val.i));
+    }
+    if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
+    {
+        g.FU2ptr = nullptr;
+    }
+    else
+    {
+        g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[1].subtype.val.i));
+    }
+
+    if (storage.getPatch().scene[s].wsunit.type.deactivated)
+    {
+        g.WSptr = nullptr;
+    }
+    else
+    {
+        auto &wst = storage.getPatch().scene[s].wsunit.type;
+        auto type = static_cast<sst::waveshapers::WaveshaperType>(wst.val.i);
+
+        g.WSptr = GetAntialiasedQuadWaveshaper(type, wst.deform_type);
+        if (!g.WSptr)
+            g.WSptr = sst::waveshapers::GetQuadWaveshaper(type);
+    }
+
+    auto config = storage.getPatch().scene[s].filterblock_configuration.val.i;
+
+    if (auto fused = GetFusedFBQPointer(config, g))
+        return fused;
+
+    return GetFBQPointer(config, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+}
+
+void SurgeSynthesizer::processSceneFilterChains(int s, int nVoices)
+{
+    Surge::FPUState::StageAudit audit(Surge::Profiling::ps_filters);
+    fbq_global g;
+    FBQFPtr ProcessQuadFB = prepareSceneFilterChain(s, g);
+
+    for (int e = 0; e < nVoices; e += 4)
+    {
+        int units = nVoices - e;
+        for (int i = units; i < 4; i++)
+        {
+            FBQ[s][e >> 2].FU[0].active[i] = 0;
+            FBQ[s][e >> 2].FU[1].active[i] = 0;
+            FBQ[s][e >> 2].FU[2].active[i] = 0;
+            FBQ[s][e >> 2].FU[3].active[i] = 0;
+        }
+        ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
+    }
+
+    for (auto v : voices[s])
+    {
+        v->GetQFB(); // save filter state in voices after quad processing is done
+    }
+
+    finishSceneFilterChains(s);
+}
+
+void SurgeSynthesizer::finishSceneFilterChains(int s)
+{
+    if (s == 0 && storage.otherscene_clients > 0)
+    {
+        // Make available for scene B
+        mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
+        mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
+    }
+
+    // mute scene
+    if (storage.getPatch().scene[s].volume.deactivated)
+    {
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
+    }
+}
+
+void SurgeSynthesizer::setSilentVoiceThresholdDb(int db)
+{
+    silentVoiceThresholdDb = std::min(db, 0);
+    storage.silentVoiceThreshold = db < 0 ? powf(10.f, db * 0.05f) : 0.f;
+}
+
+void SurgeSynthesizer::setFreezeVoicesBudgetMB(int mb)
+{
+    freezeVoicesBudgetMB = std::max(mb, 0);
+
+    if (freezeVoicesBudgetMB > 0 && !frozenHits)
+    {
+        frozenHits = std::make_unique<Surge::Voice::FrozenHitCache>(&storage);
+        frozenHitsReady = true;
+    }
+
+    // turning it off leaves the cache in place, for the audio thread to empty
+    if (frozenHits)
+        frozenHits->setBudgetBytes((size_t)freezeVoicesBudgetMB * 1024 * 1024);
+}
+
+void SurgeSynthesizer::attachFrozenHit(SurgeVoice *v, int scene, int velocity, float detune)
+{
+    if (!frozenHitsReady || freezeVoicesBudgetMB == 0 || detune != 0.f)
+        return;
+
+    auto check = Surge::Voice::FrozenHitCache::checkScene(&storage, scene, mpeEnabled);
+    if (!check.deterministic)
+        return;
+
+    frozenHits->prepareScene(scene, check);
+
+    auto vel = check.readsVelocity ? velocity : -1;
+    if (auto hit = frozenHits->replayFor(scene, v->state.pkey, vel))
+    {
+        v->replayFrozenHit(frozenHits.get(), hit);
+        return;
+    }
+
+    auto length = v->oneShotLengthBlocks();
+    if (length <= 0)
+        return;
+
+    if (auto hit = frozenHits->beginRecording(scene, v->state.pkey, vel, length))
+        v->recordFrozenHit(frozenHits.get(), hit);
+}
+
+void SurgeSynthesizer::setMultithreadedVoiceRendering(bool b)
+{
+    if (b)
+        acquireScheduler();
+
+    multithreadedVoiceRendering = b;
+}
+
+bool SurgeSynthesizer::canShareVoiceLFO(int s, int l) const
+{
+    auto &lf = storage.getPatch().scene[s].lfo[l];
+
+    // the song position sets a free running LFO's phase, rather than the voice's start
+    if (lf.trigmode.val.i != lm_freerun)
+        return false;
+
+    // the noise shapes have a generator per voice, and the others keep per voice state
+    switch (lf.shape.val.i)
+    {
+    case lt_sine:
+    case lt_tri:
+    case lt_square:
+    case lt_ramp:
+    case lt_envelope:
+        break;
+    default:
+        return false;
+    }
+
+    // and the envelope has to be flat, so a voice's age and gate don't show
+    if (lf.delay.val.f != lf.delay.val_min.f || lf.attack.val.f != lf.attack.val_min.f ||
+        lf.hold.val.f != lf.hold.val_min.f || lf.sustain.val.f != lf.sustain.val_max.f ||
+        lf.release.val.f != lf.release.val_max.f)
+        return false;
+
+    auto isEnvelopeParam = [&lf](int id) {
+        return id == lf.delay.param_id_in_scene || id == lf.attack.param_id_in_scene ||
+               id == lf.hold.param_id_in_scene || id == lf.decay.param_id_in_scene ||
+               id == lf.sustain.param_id_in_scene || id == lf.release.param_id_in_scene;
+    };
+
+    auto isLFOParam = [&lf, &isEnvelopeParam](int id) {
+        return isEnvelopeParam(id) || id == lf.rate.param_id_in_scene ||
+               id == lf.shape.param_id_in_scene || id == lf.start_phase.param_id_in_scene ||
+               id == lf.magnitude.param_id_in_scene || id == lf.deform.param_id_in_scene ||
+               id == lf.trigmode.param_id_in_scene || id == lf.unipolar.param_id_in_scene;
+    };
+
+    auto &routings = storage.audioModulationRoutings();
+
+    // scene modulation is the same in every voice, but could still unflatten the envelope
+    for (const auto &r : routings.scene[s])
+    {
+        if (isEnvelopeParam(r.destination_id))
+            return false;
+    }
+
+    for (const auto &r : routings.voice[s])
+    {
+        if (isLFOParam(r.destination_id))
+            return false;
+    }
+
+    return true;
+}
+
+void SurgeSynthesizer::processSharedVoiceLFOs(int s)
+{
+    auto &scene = storage.getPatch().scene[s];
+
+    for (int l = 0; l < n_lfos_voice; l++)
+    {
+        // LFO 1 is always processed, the others only when something reads them
+        bool used = l == 0 || scene.modsource_doprocess[ms_lfo1 + l];
+
+        if (voices[s].empty() || !used || !canShareVoiceLFO(s, l))
+        {
+            scene.sharedVoiceLFO[l] = nullptr;
+            sharedVoiceLFOAttacked[s][l] = false;
+            continue;
+        }
+
+        // pick up the phase from the song position, as a voice starting now would
+        if (!sharedVoiceLFOAttacked[s][l])
+        {
+            sharedVoiceLFOs[s][l].attack();
+            sharedVoiceLFOAttacked[s][l] = true;
+        }
+
+        sharedVoiceLFOs[s][l].process_block();
+        scene.sharedVoiceLFO[l] = &sharedVoiceLFOs[s][l];
+    }
+}
+
+void SurgeSynthesizer::processSharedFilterCoeffs(int s)
+{
+    using namespace sst::filters;
+
+    auto &scene = storage.getPatch().scene[s];
+    auto *sd = storage.getPatch().scenedata[s];
+    auto at = [sd](const Parameter &p) { return sd[p.param_id_in_scene].f; };
+
+    // a lone voice gains nothing, and an idle scene needs nothing
+    if (voices[s].size() < 2)
+    {
+        for (auto &c : scene.sharedFilterCoeffs)
+            c.valid = false;
+        return;
+    }
+
+    bool rateChanged = sharedFilterCoeffsRate != storage.dsamplerate_os;
+    sharedFilterCoeffsRate = storage.dsamplerate_os;
+
+    // SurgeVoice::SetQFB, for a voice whose keytrack and envelope amounts come to zero
+    auto &fa = scene.filterunit[0], &fb = scene.filterunit[1];
+    bool shared[n_filterunits_per_scene];
+    float cutoff[n_filterunits_per_scene], reso[n_filterunits_per_scene];
+
+    shared[0] = at(fa.keytrack) == 0.f && at(fa.envmod) == 0.f;
+    cutoff[0] = at(fa.cutoff);
+    reso[0] = at(fa.resonance);
+
+    shared[1] = at(fb.keytrack) == 0.f && at(fb.envmod) == 0.f;
+    cutoff[1] = at(fb.cutoff);
+    reso[1] = scene.f2_link_resonance.val.b ? reso[0] : at(fb.resonance);
+    if (scene.f2_cutoff_is_offset.val.b)
+    {
+        shared[1] = shared[1] && shared[0];
+        cutoff[1] += cutoff[0];
+    }
+
+    for (int u = 0; u < n_filterunits_per_scene; ++u)
+    {
+        auto &fu = scene.filterunit[u];
+        auto &c = scene.sharedFilterCoeffs[u];
+        auto type = fu.type.val.i, subtype = fu.subtype.val.i;
+
+        if (!shared[u] || type == fut_none)
+        {
+            c.valid = false;
+            continue;
+        }
+
+        bool retuned =
+            fu.cutoff.extend_range && storage.tuningApplicationMode == SurgeStorage::RETUNE_ALL;
+        if (c.valid && !rateChanged && !retuned && c.cutoff == cutoff[u] && c.reso == reso[u] &&
+            c.type == type && c.subtype == subtype)
+            continue;
+
+        // after a reset the maker keeps the first coefficients it is handed as they are, and
+        // zeroes dC as it does, so a dC left at one means this type hands it none
+        sharedFilterCM.Reset();
+        sharedFilterCM.setSampleRateAndBlockSize((float)storage.dsamplerate_os, BLOCK_SIZE_OS);
+        sharedFilterCM.dC[0] = 1.f;
+        sharedFilterCM.MakeCoeffs(cutoff[u], reso[u], static_cast<FilterType>(type),
+                                  static_cast<FilterSubType>(subtype), &storage,
+                                  fu.cutoff.extend_range);
+
+        c.valid = sharedFilterCM.dC[0] == 0.f;
+        c.cutoff = cutoff[u];
+        c.reso = reso[u];
+        c.type = type;
+        c.subtype = subtype;
+        memcpy(c.C, sharedFilterCM.C, sizeof(c.C));
+    }
+}
+
+bool SurgeSynthesizer::canRenderVoiceQuadsConcurrently() const
+{
+    if (!multithreadedVoiceRendering || !scheduler || scheduler->numWorkers() == 0)
+        return false;
+
+    // a single group is no better off on a worker
+    if (voices[0].size() + voices[1].size() <= 4)
+        return false;
+
+    // formula modulators share a single audio thread lua state
+    for (int s = 0; s < n_scenes; s++)
+    {
+        for (int l = 0; l < n_lfos_voice; l++)
+        {
+            if (storage.getPatch().scene[s].lfo[l].shape.val.i == lt_formula)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void SurgeSynthesizer::processVoiceQuad(int task)
+{
+    // the oscillators and filters are interleaved here, as they are in the profile
+    Surge::FPUState::StageAudit audit(Surge::Profiling::ps_voices);
+    auto &t = voiceQuadTasks[task];
+    auto &Q = FBQ[t.scene][t.quad];
+    int first = t.quad << 2;
+    int last = std::min(first + 4, (int)voices[t.scene].size());
+
+    /*
+     * Whichever thread we land on, draw random numbers from this group's generator so
+     * the render doesn't depend on the schedule
+     */
+    auto priorRNG = SurgeStorage::workerThreadRNG;
+    SurgeStorage::workerThreadRNG = &t.rng;
+
+    SurgeVoice *quad[4];
+    for (int e = first; e < last; e++)
+    {
+        quad[e - first] = voices[t.scene][e];
+        voiceFinished[t.scene][e] = !quad[e - first]->process_block(Q, e & 3);
+    }
+    SurgeVoice::storeQuadInputs(Q, quad, last - first);
+
+    for (int i = last - first; i < 4; i++)
+    {
+        Q.FU[0].active[i] = 0;
+        Q.FU[1].active[i] = 0;
+        Q.FU[2].active[i] = 0;
+        Q.FU[3].active[i] = 0;
+    }
+
+    mech::clear_block<BLOCK_SIZE_OS>(voiceQuadOut[task][0]);
+    mech::clear_block<BLOCK_SIZE_OS>(voiceQuadOut[task][1]);
+    t.processQuad(Q, t.g, voiceQuadOut[task][0], voiceQuadOut[task][1]);
+
+    for (int e = first; e < last; e++)
+    {
+        voices[t.scene][e]->GetQFB();
+    }
+
+    SurgeStorage::workerThreadRNG = priorRNG;
+}
+
+int SurgeSynthesizer::renderVoiceQuadsConcurrently(int firstScene, int lastScene)
+{
+    int nTasks = 0, vcount = 0;
+
+    for (int s = firstScene; s <= lastScene; s++)
+    {
+        fbq_global g;
+        auto fbq = prepareSceneFilterChain(s, g);
+        int nVoices = (int)voices[s].size();
+
+        for (int q = 0; q < (nVoices + 3) >> 2; q++)
+        {
+            auto &t = voiceQuadTasks[nTasks++];
+            t.scene = s;
+            t.quad = q;
+            t.g = g;
+            t.processQuad = fbq;
+            t.rng.g.seed(storage.rand_u32());
+        }
+
+        vcount += nVoices;
+    }
+
+    auto renderQuad = [this](int task) { processVoiceQuad(task); };
+    runBatch(nTasks, renderQuad);
+
+    // sum in task order, which is voice order, so the result is the same every time
+    for (int i = 0; i < nTasks; i++)
+    {
+        auto s = voiceQuadTasks[i].scene;
+        mech::accumulate_from_to<BLOCK_SIZE_OS>(voiceQuadOut[i][0], sceneout[s][0]);
+        mech::accumulate_from_to<BLOCK_SIZE_OS>(voiceQuadOut[i][1], sceneout[s][1]);
+    }
+
+    for (int s = firstScene; s <= lastScene; s++)
+    {
+        finishSceneFilterChains(s);
+        freeFinishedVoices(s);
+    }
+
+    return vcount;
+}
+
+void SurgeSynthesizer::setMultithreadedEffectRendering(bool b)
+{
+    if (b)
+        acquireScheduler();
+
+    multithreadedEffectRendering = b;
+}
+
+bool SurgeSynthesizer::canRenderEffectsConcurrently() const
+{
+    return multithreadedEffectRendering && scheduler && scheduler->numWorkers() > 0;
+}
+
+bool SurgeSynthesizer::processInsertChain(int sc, bool state)
+{
+    for (auto v : fxslot_scene_inserts[sc])
+    {
+        if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
+        {
+            auto fxStart = processProfiler.mark();
+            state = processEffect(v, sceneout[sc][0], sceneout[sc][1], state, false);
+            effectUsec[v] = processProfiler.elapsed(fxStart);
+        }
+    }
+
+    return state;
+}
+
+bool SurgeSynthesizer::processSendEffect(int idx, bool state, const bool *sceneSilent)
+{
+    auto slot = fxslot_sends[idx];
+
+    if (!fx[slot] || (storage.getPatch().fx_disable.val.i & (1 << slot)))
+        return false;
+
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        if (!sceneSilent[sc])
+            send[idx][sc].MAC_2_blocks_to(sceneout[sc][0], sceneout[sc][1], fxsendout[idx][0],
+                                          fxsendout[idx][1], BLOCK_SIZE_QUAD);
+    }
+
+    auto fxStart = processProfiler.mark();
+    auto used = processEffect(slot, fxsendout[idx][0], fxsendout[idx][1], state, true);
+    effectUsec[slot] = processProfiler.elapsed(fxStart);
+
+    return used;
+}
+
+void SurgeSynthesizer::process()
+{
+    SURGE_TRACE_ZONE("SurgeSynthesizer::process");
+    // offline callers like surgepy and the CLI don't set the FPU up, so do it for everyone
+    auto fpuguard = Surge::FPUState::DSPThreadGuard();
+    Surge::FPUState::noteBlock();
+    Surge::FPUState::StageAudit blockAudit(Surge::Profiling::ps_total);
+#if DEBUG_RNG_THREADING
+    storage.audioThreadID = std::this_thread::get_id();
+#endif
+#if SURGE_RT_SAFETY_CHECKS
+    Surge::RealtimeSafety::setAudioThread(std::this_thread::get_id());
+#endif
+    processRunning = 0;
+
+#if DEBUG
+    memset(endedHostNoteIds, 0, 512 * sizeof(int32_t));
+#endif
+
+    auto process_start = std::chrono::high_resolution_clock::now();
+    auto &prof = processProfiler;
+    prof.beginBlock();
+
+    if (hostNoteEndedToPushToNextBlock)
+    {
+        for (int i = 0; i < hostNoteEndedToPushToNextBlock; ++i)
+        {
+            endedHostNoteIds[i] = nextBlockEndedHostNoteIds[i];
+            endedHostNoteOriginalKey[i] = nextBlockEndedHostNoteOriginalKey[i];
+            endedHostNoteOriginalChannel[i] = nextBlockEndedHostNoteOriginalChannel[i];
+        }
+        hostNoteEndedDuringBlockCount = hostNoteEndedToPushToNextBlock;
+        hostNoteEndedToPushToNextBlock = 0;
+    }
+    else
+    {
+        hostNoteEndedToPushToNextBlock = 0;
+        hostNoteEndedDuringBlockCount = 0;
+    }
+
+    if (frozenHitsReady)
+        frozenHits->trimToBudget();
+
+    float mfade = 1.f;
+
+    if (halt_engine)
+    {
+        mech::clear_block<BLOCK_SIZE>(output[0]);
+        mech::clear_block<BLOCK_SIZE>(output[1]);
+        return;
+    }
+    else if ((patchid_queue >= 0 || has_patchid_file) && !patchPrefetchReady)
+    {
+        // keep playing the current patch while the next one is read in
+        if (!patchPrefetchRunning)
+        {
+            if (patchPrefetchThread)
+                patchPrefetchThread->join();
+
+            patchPrefetchRunning = true;
+            patchPrefetchThread = std::make_unique<std::thread>([this]() {
+                SURGE_TRACE_THREAD_NAME("Surge Patch Prefetch");
+                Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Loader);
+                auto fpuguard = Surge::FPUState::DSPThreadGuard();
+                prefetchQueuedPatch();
+            });
+        }
+    }
+    else if (patchid_queue >= 0 || has_patchid_file)
+    {
+        masterfade = max(0.f, masterfade - 0.125f); // fade over 8 blocks
+        mfade = masterfade * masterfade;
+
+        if (masterfade < 0.0001f)
+        {
+            Surge::RealtimeSafety::noteLock("patchLoadSpawnMutex");
+            std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
+            // spawn patch-loading thread
+            stopSound();
+            halt_engine = true;
+
+            /*
+             * In theory, since we only spawn under a lock and the loading thread
              * also holds that lock, this should "never" happen - namely the patch
              * load thread should be null always, and we null it out with a move
              * at the end of the thread operation.
@@ -4637,27 +5817,63 @@ void SurgeSynthesizer::process()
             approachingAllSoundOff = false;
         }
     }
+    else if (fadeInAfterPatchLoad)
+    {
+        masterfade = min(1.f, masterfade + 0.125f);
+        mfade = masterfade * masterfade;
+
+        if (masterfade >= 1.f)
+            fadeInAfterPatchLoad = false;
+    }
+
+    if (patchPrefetchReady && patchid_queue < 0 && !has_patchid_file)
+    {
+        // the load we prefetched for was withdrawn; the next prefetch frees it
+        patchPrefetchReady = false;
+    }
+
+    /*
+     * Process inputs (upsample & halfrate), but only the buffers something could read. One
+     * nobody reads is cleared once on the way out, so whatever next starts reading it finds
+     * silence rather than old input, and the upsampler starts over from silence too.
+     */
+    bool wantInput = process_input && storage.audio_in_clients > 0;
+    bool wantInputNonOS = process_input && storage.audio_in_nonOS_clients > 0;
 
-    // process inputs (upsample & halfrate)
-    if (process_input)
+    if (wantInput || wantInputNonOS)
     {
         sdsp::hardclip_block8<BLOCK_SIZE>(input[0]);
         sdsp::hardclip_block8<BLOCK_SIZE>(input[1]);
+    }
+
+    if (wantInputNonOS)
+    {
         mech::copy_from_to<BLOCK_SIZE>(input[0], storage.audio_in_nonOS[0]);
         mech::copy_from_to<BLOCK_SIZE>(input[1], storage.audio_in_nonOS[1]);
+        inputNonOSCleared = false;
+    }
+    else if (!inputNonOSCleared)
+    {
+        mech::clear_block<BLOCK_SIZE>(storage.audio_in_nonOS[0]);
+        mech::clear_block<BLOCK_SIZE>(storage.audio_in_nonOS[1]);
+        inputNonOSCleared = true;
+    }
+
+    if (wantInput)
+    {
         halfbandIN.process_block_U2(input[0], input[1], storage.audio_in[0], storage.audio_in[1],
                                     BLOCK_SIZE_OS);
+        inputCleared = false;
     }
-    else
+    else if (!inputCleared)
     {
         mech::clear_block<BLOCK_SIZE_OS>(storage.audio_in[0]);
         mech::clear_block<BLOCK_SIZE_OS>(storage.audio_in[1]);
-        mech::clear_block<BLOCK_SIZE>(storage.audio_in_nonOS[1]);
-        mech::clear_block<BLOCK_SIZE>(storage.audio_in_nonOS[1]);
+        halfbandIN.reset();
+        inputCleared = true;
     }
 
     // TODO: FIX SCENE ASSUMPTION
-    float fxsendout alignas(16)[n_send_slots][2][BLOCK_SIZE];
     bool play_scene[n_scenes];
 
     {
@@ -4673,8 +5889,14 @@ void SurgeSynthesizer::process()
         }
     }
 
-    storage.modRoutingMutex.lock();
+    auto controlStart = prof.mark();
+    // pick up any routing edits; the snapshot stays put until the next block
+    storage.acquireModulationRoutings();
+    storage.acquireTuningTables();
+    storage.retuningCache.nextBlock();
+    storage.mtsRetuningTable.nextBlock();
     processControl();
+    prof.add(Surge::Profiling::ps_control, controlStart);
 
     amp.set_target_smoothed(
         storage.db_to_linear(storage.getPatch().globaldata[storage.getPatch().volume.id].f));
@@ -4707,8 +5929,6 @@ void SurgeSynthesizer::process()
         }
     }
 
-    list<SurgeVoice *>::iterator iter;
-
     for (int sc = 0; sc < n_scenes; sc++)
     {
         play_scene[sc] = (!voices[sc].empty());
@@ -4716,115 +5936,68 @@ void SurgeSynthesizer::process()
 
     int FBentry[n_scenes];
     int vcount = 0;
+    auto voicesStart = prof.mark();
 
-    for (int s = 0; s < n_scenes; s++)
+    if (canRenderVoiceQuadsConcurrently())
     {
-        FBentry[s] = 0;
-        iter = voices[s].begin();
-        while (iter != voices[s].end())
-        {
-            SurgeVoice *v = *iter;
-            assert(v);
-            bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
-            FBentry[s]++;
-
-            vcount++;
-
-            if (!resume)
-            {
-                freeVoice(v);
-                iter = voices[s].erase(iter);
-            }
-            else
-                iter++;
-        }
-
-        storage.modRoutingMutex.unlock();
-
-        using sst::filters::FilterType, sst::filters::FilterSubType;
-        fbq_global g;
-        if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
-        {
-            g.FU1ptr = nullptr;
-        }
-        else
-        {
-            g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[0].subtype.val.i));
-        }
-        if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
-        {
-            g.FU2ptr = nullptr;
-        }
-        else
-        {
-            g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[1].subtype.val.i));
-        }
-
-        if (storage.getPatch().scene[s].wsunit.type.deactivated)
+        if (storage.otherscene_clients > 0)
         {
-            g.WSptr = nullptr;
+            // scene B reads scene A's output, so A's groups have to finish first
+            for (int s = 0; s < n_scenes; s++)
+                vcount += renderVoiceQuadsConcurrently(s, s);
         }
         else
         {
-            g.WSptr =
-                sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
-                    storage.getPatch().scene[s].wsunit.type.val.i));
+            vcount = renderVoiceQuadsConcurrently(0, n_scenes - 1);
         }
 
-        FBQFPtr ProcessQuadFB =
-            GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
-                          g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
-
-        for (int e = 0; e < FBentry[s]; e += 4)
-        {
-            int units = FBentry[s] - e;
-            for (int i = units; i < 4; i++)
-            {
-                FBQ[s][e >> 2].FU[0].active[i] = 0;
-                FBQ[s][e >> 2].FU[1].active[i] = 0;
-                FBQ[s][e >> 2].FU[2].active[i] = 0;
-                FBQ[s][e >> 2].FU[3].active[i] = 0;
-            }
-            ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
-        }
+        prof.add(Surge::Profiling::ps_voices, voicesStart);
+    }
+    else if (canRenderScenesConcurrently())
+    {
+        /*
+         * Scene A draws from the storage generator and the others from one each of their
+         * own, whichever thread renders them, since the shared workers and a host's threads
+         * belong to no instance in particular
+         */
+        auto renderScene = [this, &FBentry](int s) {
+            auto priorRNG = SurgeStorage::workerThreadRNG;
+            SurgeStorage::workerThreadRNG = s == 0 ? nullptr : sceneWorkerRNGs[s - 1].get();
+            FBentry[s] = processSceneVoices(s, true);
+            processSceneFilterChains(s, FBentry[s]);
+            SurgeStorage::workerThreadRNG = priorRNG;
+        };
+        runBatch(n_scenes, renderScene);
 
-        if (s == 0 && storage.otherscene_clients > 0)
+        for (int s = 0; s < n_scenes; s++)
         {
-            // Make available for scene B
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
+            freeFinishedVoices(s);
+            vcount += FBentry[s];
         }
 
-        iter = voices[s].begin();
-
-        while (iter != voices[s].end())
+        prof.add(Surge::Profiling::ps_voices, voicesStart);
+    }
+    else
+    {
+        for (int s = 0; s < n_scenes; s++)
         {
-            SurgeVoice *v = *iter;
-            assert(v);
-            v->GetQFB(); // save filter state in voices after quad processing is done
-            iter++;
-        }
-
-        storage.modRoutingMutex.lock();
+            auto sceneStart = prof.mark();
+            FBentry[s] = processSceneVoices(s, false);
+            vcount += FBentry[s];
+            prof.add(Surge::Profiling::ps_voices, sceneStart);
 
-        // mute scene
-        if (storage.getPatch().scene[s].volume.deactivated)
-        {
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
+            auto filtersStart = prof.mark();
+            processSceneFilterChains(s, FBentry[s]);
+            prof.add(Surge::Profiling::ps_filters, filtersStart);
         }
     }
 
-    storage.modRoutingMutex.unlock();
-    polydisplay = vcount;
+    if (polydisplay.exchange(vcount) != vcount)
+        markUIChanged(uic_polyphony);
     storage.voiceCount = vcount;
 
+    auto halfbandStart = prof.mark();
+
     // TODO: FIX SCENE ASSUMPTION
     if (play_scene[0])
     {
@@ -4842,7 +6015,8 @@ void SurgeSynthesizer::process()
             break;
         }
 
-        halfbandA.process_block_D2(sceneout[0][0], sceneout[0][1], BLOCK_SIZE_OS);
+        (useHighRateDecimators ? halfbandHighRateA : halfbandA)
+            .process_block_D2(sceneout[0][0], sceneout[0][1], BLOCK_SIZE_OS);
     }
 
     if (play_scene[1])
@@ -4861,44 +6035,80 @@ void SurgeSynthesizer::process()
             break;
         }
 
-        halfbandB.process_block_D2(sceneout[1][0], sceneout[1][1], BLOCK_SIZE_OS);
+        (useHighRateDecimators ? halfbandHighRateB : halfbandB)
+            .process_block_D2(sceneout[1][0], sceneout[1][1], BLOCK_SIZE_OS);
     }
 
+    prof.add(Surge::Profiling::ps_halfband, halfbandStart);
+
     /*
      * ABOVE: Oversampled, Below, Regular sample. So BLOCK_SIZE_OS above BLOCK_SIZE below
      */
 
-    // TODO: FIX SCENE ASSUMPTION
-    if (storage.getPatch().scene[0].lowcut.deactivated == false)
+    /*
+     * An idle scene's output is known to be zero: it was cleared above and no voice wrote to
+     * it. Everything from here to the output keeps track of that, so we can skip filtering,
+     * clipping and mixing buffers of zeros.
+     */
+    bool sceneSilent[n_scenes];
+
+    for (int sc = 0; sc < n_scenes; sc++)
     {
-        auto freq =
-            storage.getPatch().scenedata[0][storage.getPatch().scene[0].lowcut.param_id_in_scene].f;
+        sceneSilent[sc] = !play_scene[sc];
+    }
 
-        auto slope = storage.getPatch().scene[0].lowcut.deform_type;
+    bool anyLowCut = false;
 
-        for (int i = 0; i <= slope; i++)
+    for (int sc = 0; sc < n_scenes; sc++)
+    {
+        auto &lowcut = storage.getPatch().scene[sc].lowcut;
+        bool on = !sceneSilent[sc] && !lowcut.deactivated;
+        BiquadCoefficients hp;
+
+        if (on)
         {
-            hpA[i].coeff_HP(hpA[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpA[i].process_block(sceneout[0][0], sceneout[0][1]); // TODO: quadify
+            auto freq = storage.getPatch().scenedata[sc][lowcut.param_id_in_scene].f;
+            hp = BiquadCoefficients::highpass(sceneLowCut[0].calc_omega(freq / 12.0),
+                                              0.4); // var 0.707
         }
-    }
 
-    if (storage.getPatch().scene[1].lowcut.deactivated == false)
-    {
-        auto freq =
-            storage.getPatch().scenedata[1][storage.getPatch().scene[1].lowcut.param_id_in_scene].f;
+        for (int i = 0; i < n_hpBQ; i++)
+        {
+            bool run = on && i <= lowcut.deform_type;
 
-        auto slope = storage.getPatch().scene[1].lowcut.deform_type;
+            for (int lane = 2 * sc; lane < 2 * sc + 2; lane++)
+            {
+                // starting clean when the scene next plays is better than a tail of zeros
+                if (sceneSilent[sc])
+                    sceneLowCut[i].suspend(lane);
 
-        for (int i = 0; i <= slope; i++)
-        {
-            hpB[i].coeff_HP(hpB[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpB[i].process_block(sceneout[1][0], sceneout[1][1]); // TODO: quadify
+                sceneLowCut[i].setActive(lane, run);
+                if (run)
+                    sceneLowCut[i].setCoefficients(lane, hp);
+            }
+
+            anyLowCut = anyLowCut || run;
         }
     }
 
+    if (anyLowCut)
+    {
+        // TODO: FIX SCENE ASSUMPTION
+        float *const lanes[2 * n_scenes] = {sceneout[0][0], sceneout[0][1], sceneout[1][0],
+                                            sceneout[1][1]};
+        double frames alignas(16)[BLOCK_SIZE * 2 * n_scenes];
+
+        BiquadBank<2 * n_scenes>::interleave(lanes, frames);
+        for (auto &hp : sceneLowCut)
+            hp.processFrames(frames);
+        BiquadBank<2 * n_scenes>::deinterleave(frames, lanes);
+    }
+
     for (int cls = 0; cls < n_scenes; ++cls)
     {
+        if (sceneSilent[cls])
+            continue;
+
         switch (storage.sceneHardclipMode[cls])
         {
         case SurgeStorage::HARDCLIP_TO_18DBFS:
@@ -4926,28 +6136,72 @@ void SurgeSynthesizer::process()
         for (int channel = 0; channel < N_OUTPUTS; channel++)
             storage.scenesOutputData.provideSceneData(i, channel, sceneout[i][channel]);
 
+    bool threadedEffects = canRenderEffectsConcurrently();
+    std::fill(std::begin(effectUsec), std::end(effectUsec), 0.f);
+
+    /*
+     * Runs chain(i) for each of n independent effect chains, on the worker pool when it's
+     * enabled and at least two of them have something to do
+     */
+    auto runEffectChains = [this, threadedEffects](int n, int busy, auto &chain) {
+        if (!threadedEffects || busy < 2)
+        {
+            for (int i = 0; i < n; i++)
+                chain(i);
+            return;
+        }
+
+        // each chain keeps its own generator, whichever thread picks it up
+        auto onWorker = [this, &chain](int i) {
+            auto priorRNG = SurgeStorage::workerThreadRNG;
+            SurgeStorage::workerThreadRNG = &effectChainRNGs[i];
+            chain(i);
+            SurgeStorage::workerThreadRNG = priorRNG;
+        };
+        runBatch(n, onWorker);
+    };
+
+    auto fxEnabled = [this](int slot) {
+        return fx[slot] && !(storage.getPatch().fx_disable.val.i & (1 << slot));
+    };
+
     // apply insert effects
     if (fx_bypass != fxb_no_fx)
     {
-        for (auto v : {fxslot_ains1, fxslot_ains2, fxslot_ains3, fxslot_ains4})
+        int busy = 0;
+        for (int sc = 0; sc < n_scenes; sc++)
         {
-            if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
+            for (auto v : fxslot_scene_inserts[sc])
             {
-                sc_state[0] = fx[v]->process_ringout(sceneout[0][0], sceneout[0][1], sc_state[0]);
+                if (fxEnabled(v))
+                {
+                    busy++;
+                    break;
+                }
             }
         }
 
-        for (auto v : {fxslot_bins1, fxslot_bins2, fxslot_bins3, fxslot_bins4})
-        {
-            if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
-            {
-                sc_state[1] = fx[v]->process_ringout(sceneout[1][0], sceneout[1][1], sc_state[1]);
-            }
-        }
+        // the two scenes' insert chains don't touch each other's buffers
+        auto insertChain = [this, &sc_state](int sc) {
+            sc_state[sc] = processInsertChain(sc, sc_state[sc]);
+        };
+        runEffectChains(n_scenes, busy, insertChain);
+    }
+
+    /*
+     * An insert which has rung out leaves its buffer alone, so a scene whose chain reports
+     * nothing is still all zeros.
+     */
+    for (int i = 0; i < n_scenes; i++)
+    {
+        sceneSilent[i] = !sc_state[i];
     }
 
     for (int cls = 0; cls < n_scenes; ++cls)
     {
+        if (sceneSilent[cls])
+            continue;
+
         switch (storage.sceneHardclipMode[cls])
         {
         case SurgeStorage::HARDCLIP_TO_18DBFS:
@@ -4965,76 +6219,143 @@ void SurgeSynthesizer::process()
 
     // sum scenes
     // TODO: FIX SCENE ASSUMPTION
-    mech::copy_from_to<BLOCK_SIZE>(sceneout[0][0], output[0]);
-    mech::copy_from_to<BLOCK_SIZE>(sceneout[0][1], output[1]);
-    mech::accumulate_from_to<BLOCK_SIZE>(sceneout[1][0], output[0]);
-    mech::accumulate_from_to<BLOCK_SIZE>(sceneout[1][1], output[1]);
+    if (sceneSilent[0] && sceneSilent[1])
+    {
+        mech::clear_block<BLOCK_SIZE>(output[0]);
+        mech::clear_block<BLOCK_SIZE>(output[1]);
+    }
+    else if (sceneSilent[1])
+    {
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[0][0], output[0]);
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[0][1], output[1]);
+    }
+    else if (sceneSilent[0])
+    {
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[1][0], output[0]);
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[1][1], output[1]);
+    }
+    else
+    {
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[0][0], output[0]);
+        mech::copy_from_to<BLOCK_SIZE>(sceneout[0][1], output[1]);
+        mech::accumulate_from_to<BLOCK_SIZE>(sceneout[1][0], output[0]);
+        mech::accumulate_from_to<BLOCK_SIZE>(sceneout[1][1], output[1]);
+    }
 
     bool sendused[4] = {false, false, false, false};
     // add send effects
     // TODO: FIX SCENE ASSUMPTION
     if (fx_bypass == fxb_all_fx)
     {
-        for (auto si : sendToIndex)
-        {
-            auto slot = si[0];
-            auto idx = si[1];
+        int busy = 0;
+        for (auto slot : fxslot_sends)
+            busy += fxEnabled(slot);
 
-            if (fx[slot] && !(storage.getPatch().fx_disable.val.i & (1 << slot)))
-            {
-                send[idx][0].MAC_2_blocks_to(sceneout[0][0], sceneout[0][1], fxsendout[idx][0],
-                                             fxsendout[idx][1], BLOCK_SIZE_QUAD);
-                send[idx][1].MAC_2_blocks_to(sceneout[1][0], sceneout[1][1], fxsendout[idx][0],
-                                             fxsendout[idx][1], BLOCK_SIZE_QUAD);
-                sendused[idx] = fx[slot]->process_ringout(fxsendout[idx][0], fxsendout[idx][1],
-                                                          sc_state[0] || sc_state[1]);
-                FX[idx].MAC_2_blocks_to(fxsendout[idx][0], fxsendout[idx][1], output[0], output[1],
-                                        BLOCK_SIZE_QUAD);
-            }
+        // each send reads the scene outputs and writes only its own buffer
+        bool sendState = sc_state[0] || sc_state[1];
+        auto sendChain = [this, &sendused, &sceneSilent, sendState](int idx) {
+            sendused[idx] = processSendEffect(idx, sendState, sceneSilent);
+        };
+        runEffectChains(n_send_slots, busy, sendChain);
+
+        // then return them in send order, so the sum is the same however they were scheduled
+        for (int idx = 0; idx < n_send_slots; idx++)
+        {
+            // a rung out send leaves its cleared buffer alone, so there's nothing to return
+            if (sendused[idx])
+                FX[idx].MAC_2_blocks_to(fxsendout[idx][0], fxsendout[idx][1], output[0],
+                                        output[1], BLOCK_SIZE_QUAD);
         }
     }
 
+    // the insert and send chains time themselves, since they may have run on another thread
+    for (int v = 0; v < n_fx_slots; v++)
+    {
+        if (effectUsec[v] > 0.f)
+            prof.addElapsed(Surge::Profiling::ps_fx_first + v, effectUsec[v]);
+    }
+
     // apply global effects
+    bool glob = sc_state[0] || sc_state[1];
+    for (int i = 0; i < n_send_slots; ++i)
+        glob = glob || sendused[i];
+
     if ((fx_bypass == fxb_all_fx) || (fx_bypass == fxb_no_sends))
     {
-        bool glob = sc_state[0] || sc_state[1];
-        for (int i = 0; i < n_send_slots; ++i)
-            glob = glob || sendused[i];
-
         for (auto v : {fxslot_global1, fxslot_global2, fxslot_global3, fxslot_global4})
         {
             if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
             {
-                glob = fx[v]->process_ringout(output[0], output[1], glob);
+                auto fxStart = prof.mark();
+                glob = processEffect(v, output[0], output[1], glob, false);
+                prof.add(Surge::Profiling::ps_fx_first + v, fxStart);
+            }
+        }
+    }
+
+    // with no scene, send or global effect producing anything the output is still cleared
+    outputSilent = !glob;
+
+    int insertLatency = 0, globalLatency = 0;
+
+    if (fx_bypass != fxb_no_fx)
+    {
+        for (int sc = 0; sc < n_scenes; sc++)
+        {
+            int chain = 0;
+
+            for (auto v : fxslot_scene_inserts[sc])
+            {
+                if (fxEnabled(v))
+                    chain += fx[v]->get_latency_samples();
             }
+
+            insertLatency = std::max(insertLatency, chain);
+        }
+    }
+
+    if ((fx_bypass == fxb_all_fx) || (fx_bypass == fxb_no_sends))
+    {
+        for (auto v : {fxslot_global1, fxslot_global2, fxslot_global3, fxslot_global4})
+        {
+            if (fxEnabled(v))
+                globalLatency += fx[v]->get_latency_samples();
         }
     }
 
-    amp.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
-    amp_mute.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
+    fxLatencySamples.store(insertLatency + globalLatency, std::memory_order_relaxed);
 
     // VU falloff
     float a = storage.vu_falloff;
     vu_peak[0] = min(2.f, a * vu_peak[0]);
     vu_peak[1] = min(2.f, a * vu_peak[1]);
-    vu_peak[0] = max(vu_peak[0], mech::blockAbsMax<BLOCK_SIZE>(output[0]));
-    vu_peak[1] = max(vu_peak[1], mech::blockAbsMax<BLOCK_SIZE>(output[1]));
 
-    switch (storage.hardclipMode)
+    if (!outputSilent)
     {
-    case SurgeStorage::HARDCLIP_TO_18DBFS:
-        sdsp::hardclip_block8<BLOCK_SIZE>(output[0]);
-        sdsp::hardclip_block8<BLOCK_SIZE>(output[1]);
-        break;
+        amp.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
+        amp_mute.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
 
-    case SurgeStorage::HARDCLIP_TO_0DBFS:
-        sdsp::hardclip_block<BLOCK_SIZE>(output[0]);
-        sdsp::hardclip_block<BLOCK_SIZE>(output[1]);
-        break;
-    case SurgeStorage::BYPASS_HARDCLIP:
-        break;
+        vu_peak[0] = max(vu_peak[0], mech::blockAbsMax<BLOCK_SIZE>(output[0]));
+        vu_peak[1] = max(vu_peak[1], mech::blockAbsMax<BLOCK_SIZE>(output[1]));
+
+        switch (storage.hardclipMode)
+        {
+        case SurgeStorage::HARDCLIP_TO_18DBFS:
+            sdsp::hardclip_block8<BLOCK_SIZE>(output[0]);
+            sdsp::hardclip_block8<BLOCK_SIZE>(output[1]);
+            break;
+
+        case SurgeStorage::HARDCLIP_TO_0DBFS:
+            sdsp::hardclip_block<BLOCK_SIZE>(output[0]);
+            sdsp::hardclip_block<BLOCK_SIZE>(output[1]);
+            break;
+        case SurgeStorage::BYPASS_HARDCLIP:
+            break;
+        }
     }
 
+    patchPreviewPlayer.mixInto(output[0], output[1], BLOCK_SIZE, storage.dsamplerate);
+
     // Send output to the oscilloscope, if anyone is listening.
     if (storage.audioOut.subscribed())
     {
@@ -5044,9 +6365,13 @@ void SurgeSynthesizer::process()
     // since the sceneout is now routable we also need to mute it
     for (int sc = 0; sc < n_scenes; ++sc)
     {
-        amp_mute.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], BLOCK_SIZE_QUAD);
+        if (!sceneSilent[sc])
+            amp_mute.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], BLOCK_SIZE_QUAD);
     }
 
+    prof.endBlock(storage.voiceCount);
+    SURGE_TRACE_FRAME_MARK("Audio Block");
+
     // Calculate how close we are to overloading the CPU
     // (how close is the process() duration to duration)
     auto process_end = std::chrono::high_resolution_clock::now();
@@ -5059,6 +6384,40 @@ void SurgeSynthesizer::process()
     auto smoothed_ratio = (c * (window - 1) + ratio) / window;
     c = c * storage.cpu_falloff;
     cpu_level.store(max(c, smoothed_ratio));
+    storage.audioThreadLoad = max(c, smoothed_ratio);
+
+    // step quality down while we can't keep up, and back up once we can
+    auto priorLevel = cpuGovernor.getLevel();
+
+    if (degradeQualityUnderLoad && !storage.renderingForBounce)
+        cpuGovernor.update(storage.audioThreadLoad, BLOCK_SIZE * storage.dsamplerate_inv,
+                           prof.currentBlock());
+    else
+        cpuGovernor.reset();
+
+    if (cpuGovernor.getLevel() != priorLevel)
+        applyCPUGovernorLevel(cpuGovernor.getLevel());
+
+    // formula garbage is collected here, between blocks, and put off while this one was heavy
+    Surge::Formula::stepGarbageCollection(&storage, ratio > 0.5f);
+
+    // the meters only need the editor's attention while there is output or they are falling
+    float levels[3] = {vu_peak[0], vu_peak[1], cpu_level.load()};
+    bool levelsMoved = !outputSilent;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (std::fabs(levels[i] - uiPublishedLevels[i]) > 0.001f)
+        {
+            levelsMoved = true;
+        }
+    }
+
+    if (levelsMoved)
+    {
+        std::copy(std::begin(levels), std::end(levels), std::begin(uiPublishedLevels));
+        markUIChanged(uic_levels);
+    }
 }
 
 SurgeSynthesizer::PluginLayer *SurgeSynthesizer::getParent()
@@ -5081,6 +6440,7 @@ void SurgeSynthesizer::populateDawExtraState()
 
     des.mpeEnabled = mpeEnabled;
     des.mpePitchBendRange = storage.mpePitchBendRange;
+    des.bounceQualityWhenOffline = bounceQualityWhenOffline;
 
     des.isDirty = storage.getPatch().isDirty;
 
@@ -5139,6 +6499,7 @@ void SurgeSynthesizer::loadFromDawExtraState()
     }
 
     mpeEnabled = des.mpeEnabled;
+    bounceQualityWhenOffline = des.bounceQualityWhenOffline;
 
     storage.oscPortIn = des.oscPortIn;
     storage.oscPortOut = des.oscPortOut;
@@ -5240,6 +6601,7 @@ void SurgeSynthesizer::loadFromDawExtraState()
         }
     }
 
+    storage.midiMappingGeneration++;
     storage.lastLoadedPatch = des.lastLoadedPatch;
 }
 
@@ -5303,6 +6665,7 @@ void SurgeSynthesizer::swapMetaControllers(int c1, int c2)
         }
     }
 
+    storage.publishModulationRoutings();
     storage.modRoutingMutex.unlock();
 
     refresh_editor = true;
@@ -5407,6 +6770,16 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
         cp(fxsync[target].p[i], so.p[i]);
     }
 
+    // the impulse response isn't a param, and the effects read it straight from the patch
+    auto &pfx = storage.getPatch().fx;
+
+    if (m == FXReorderMode::SWAP)
+        pfx[source].impulseResponsePath = to.impulseResponsePath;
+    else if (m == FXReorderMode::MOVE)
+        pfx[source].impulseResponsePath.clear();
+
+    pfx[target].impulseResponsePath = so.impulseResponsePath;
+
     // Now swap the routings. FX routings are always global
     std::vector<ModulationRouting> *mv = nullptr;
     mv = &(storage.getPatch().modulation_global);
@@ -5489,6 +6862,8 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
         mv->erase(mv->begin() + *dt);
     }
 
+    storage.publishModulationRoutings();
+
     if (m != FXReorderMode::COPY)
     {
         fx_reload[source] = true;
@@ -5551,13 +6926,18 @@ void SurgeSynthesizer::reclaimVoiceFor(SurgeVoice *v, char key, char channel, ch
     auto priorChannel = v->originating_host_channel;
     auto priorKey = v->originating_host_key;
 
+    // a new note on the same voice is nothing like its hit
+    v->detachFrozenHit();
+
     v->state.gate = true;
     v->state.key = key;
     v->state.uberrelease = false;
+    v->silentBlocks = 0;
     v->state.channel = (unsigned char)channel;
     v->state.voiceChannelState = &channelState[channel];
 
     v->host_note_id = host_noteid;
+    voiceLookup.dirty = true;
     v->originating_host_channel = host_originating_channel;
     v->originating_host_key = host_originating_key;
 
@@ -25,16 +25,32 @@
 #include "SurgeStorage.h"
 #include "SurgeVoice.h"
 #include "Effect.h"
-#include "BiquadFilter.h"
+#include "BiquadBank.h"
+#include "ActiveVoiceList.h"
+#include "WorkerPool.h"
+#include "ParameterChangeLog.h"
+#include "ProcessProfiler.h"
+#include "CPUGovernor.h"
+#include "LargePageAllocator.h"
+#include "PatchPreview.h"
 #include <set>
 #include <sst/filters/HalfRateFilter.h>
 
 struct QuadFilterChainState;
 
+namespace Surge
+{
+namespace Storage
+{
+struct PatchSnapshot;
+}
+} // namespace Surge
+
 #include <list>
 #include <utility>
 #include <atomic>
 #include <cstdio>
+#include <algorithm>
 #include <bitset>
 #include <vector>
 
@@ -58,6 +74,8 @@ class alignas(16) SurgeSynthesizer
     float sceneout alignas(
         16)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS]; // this is blocksize_os but has been downsampled by
                                                  // the end of process into block_size
+    // the input to each send effect, and its output once the send has run
+    float fxsendout alignas(16)[n_send_slots][2][BLOCK_SIZE];
 
     float input alignas(16)[N_INPUTS][BLOCK_SIZE];
     timedata time_data;
@@ -81,6 +99,7 @@ class alignas(16) SurgeSynthesizer
         virtual void surgeMacroUpdated(long macroNum, float) = 0;
     };
     SurgeSynthesizer(PluginLayer *parent, const std::string &suppliedDataPath = "");
+    SurgeSynthesizer(PluginLayer *parent, const SurgeStorage::SurgeStorageConfig &config);
     virtual ~SurgeSynthesizer();
 
     // Also see setNoteExpression() which allows you to control all note parameters polyphonically
@@ -113,6 +132,114 @@ class alignas(16) SurgeSynthesizer
     int getMpeMainChannel(int voiceChannel, int key);
     void process();
 
+    /*
+     * When enabled, process() renders the voices and filter chains of scene A and scene B
+     * concurrently, one on the audio thread and one on a worker of the process wide
+     * SharedScheduler, and joins before the scene outputs are mixed. It falls back to serial
+     * rendering for any block where that can't help or isn't safe; see
+     * canRenderScenesConcurrently. Call this from a non-audio thread, since the first enable
+     * of any of these in the process starts the workers.
+     */
+    void setMultithreadedSceneRendering(bool b);
+    bool getMultithreadedSceneRendering() const { return multithreadedSceneRendering; }
+
+    /*
+     * When enabled, process() splits the voices of each scene into groups of four, one per
+     * quad filter chain, and renders the groups across the shared workers. Each group
+     * writes into its own buffer and these are summed into sceneout in voice order, and each
+     * group draws random numbers from a generator seeded on the audio thread, so the output
+     * doesn't depend on which thread picked up which group. This takes precedence over
+     * multithreaded scene rendering, and the same threading rules apply.
+     */
+    void setMultithreadedVoiceRendering(bool b);
+    bool getMultithreadedVoiceRendering() const { return multithreadedVoiceRendering; }
+
+    /*
+     * When enabled, process() runs the independent parts of the effect section on the shared
+     * workers: the scene A and scene B insert chains alongside each other, then the
+     * send effects alongside each other. Send returns are still summed into the output in
+     * send order on the audio thread, and each chain draws random numbers from a generator
+     * of its own, so the output doesn't depend on the schedule. The global chain reads the
+     * sum of all of these and runs afterwards, on the audio thread.
+     */
+    void setMultithreadedEffectRendering(bool b);
+    bool getMultithreadedEffectRendering() const { return multithreadedEffectRendering; }
+
+    /*
+     * Seed every random number generator the engine owns - storage's, the scene random
+     * modulators, the worker and effect chain generators, std::rand, and the MSEG and LFO
+     * states assigned from now on - from one value, so two synths given the same seed, patch
+     * and events render the same samples. Call it before playing, from a non-audio thread.
+     */
+    void setDeterministicRendering(uint32_t seed);
+
+    /*
+     * While this is set, the multithreaded renders above hand their batches to it rather
+     * than to the shared workers, and use those only if it declines a batch. A plugin layer
+     * sets it around process() when its host lends us a thread pool.
+     */
+    Surge::Threading::ExternalBatchRunner *externalBatchRunner{nullptr};
+
+    /*
+     * A plugin layer calls this at the top of each host callback with the callback's length.
+     * The batches process() hands the shared workers are then due by the end of the callback,
+     * so an instance with more of it left to render is helped before one with time to spare.
+     * Without it each batch is due a block after it is handed over. Audio thread only.
+     */
+    void setHostCallbackDeadline(int numSamples);
+
+    /*
+     * Auditions from the patch browsers play through this, over the top of whatever the synth
+     * is doing and after the master volume, so browsing never touches the patch. Use it from
+     * the message thread; see PatchPreview.h.
+     */
+    Surge::Storage::PatchPreviewPlayer patchPreviewPlayer;
+
+    /*
+     * Picks the effect oversampling quality, see SurgeStorage::EffectOversampling. This can
+     * be called from any thread; the audio thread picks it up at the next block and
+     * re-initialises the effects.
+     */
+    void setEffectOversampling(SurgeStorage::EffectOversampling q) { requestedEffectOversampling = q; }
+    SurgeStorage::EffectOversampling getEffectOversampling() const
+    {
+        return (SurgeStorage::EffectOversampling)requestedEffectOversampling.load();
+    }
+
+    /*
+     * Released voices quieter than this many dB for a short while are ended early, see
+     * SurgeStorage::silentVoiceThreshold. 0 (or anything above it) turns that off.
+     */
+    void setSilentVoiceThresholdDb(int db);
+    int getSilentVoiceThresholdDb() const { return silentVoiceThresholdDb; }
+
+    /*
+     * Freeze voices: in scenes which make the same oscillator output on every hit of a key,
+     * replay the first hit's rather than running the oscillators again, keeping up to this
+     * many MB of hits. See Surge::Voice::FrozenHitCache for which scenes qualify. 0 turns it
+     * off. Call it from a non-audio thread, since the first call builds the cache.
+     */
+    void setFreezeVoicesBudgetMB(int mb);
+    int getFreezeVoicesBudgetMB() const { return freezeVoicesBudgetMB; }
+    std::unique_ptr<Surge::Voice::FrozenHitCache> frozenHits;
+
+    /*
+     * Hosts tell us when they render offline. Unless bounceQualityWhenOffline is turned off
+     * for this instance (it is kept in the DAW state), that switches to a bounce profile with
+     * the best quality we have, whatever the live settings: high effect oversampling and no
+     * effect backing off under load. Both can be set from any thread and are picked up by the
+     * audio thread at the next block.
+     */
+    void setOfflineRendering(bool offline) { offlineRendering = offline; }
+    std::atomic<bool> offlineRendering{false}, bounceQualityWhenOffline{true};
+
+    /*
+     * With this on, cpuGovernor steps quality down when the audio thread can't keep up and
+     * back up once it can, in the order of Surge::Profiling::GovernorLevel. It stays at full
+     * quality while bouncing. Can be set from any thread.
+     */
+    std::atomic<bool> degradeQualityUnderLoad{false};
+
     PluginLayer *getParent();
 
     // protected:
@@ -120,6 +247,50 @@ class alignas(16) SurgeSynthesizer
     void onRPN(int channel, int lsbRPN, int msbRPN, int lsbValue, int msbValue);
     void onNRPN(int channel, int lsbNRPN, int msbNRPN, int lsbValue, int msbValue);
 
+    /*
+     * Which macros and parameters each controller is bound to, so channelController only visits
+     * the targets of the controller it got rather than every parameter. Targets are kept sorted
+     * by encoded controller (plain CCs, then (N)RPNs), macros before parameters and each in index
+     * order, which is the order the full scan used to apply them in. A target's own channel, or
+     * -1 for omni, is checked as it is visited.
+     *
+     * It is rebuilt on the audio thread the first time a controller arrives after
+     * SurgeStorage::midiMappingGeneration moves, which anything that edits a mapping bumps.
+     */
+    struct MidiControlIndex
+    {
+        static constexpr int maxTargets =
+            n_customcontrollers + n_global_params + n_scene_params * n_scenes;
+        struct Target
+        {
+            int ccEncoded;
+            int channel;
+            bool isMacro;
+            int index; // into storage.controllers or param_ptr
+        };
+        Target targets[maxTargets];
+        int nTargets{0};
+        // plain CC c has targets[ccStart[c]] up to targets[ccStart[c + 1]]; (N)RPNs follow
+        int ccStart[129]{};
+        uint32_t builtGeneration{~0u};
+
+        std::pair<const Target *, const Target *> targetsFor(int ccEncoded) const
+        {
+            if (ccEncoded >= 0 && ccEncoded < 128)
+                return {targets + ccStart[ccEncoded], targets + ccStart[ccEncoded + 1]};
+
+            auto r = std::equal_range(
+                targets + ccStart[128], targets + nTargets, ccEncoded,
+                [](const auto &a, const auto &b) { return ccOf(a) < ccOf(b); });
+            return {r.first, r.second};
+        }
+
+      private:
+        static int ccOf(const Target &t) { return t.ccEncoded; }
+        static int ccOf(int cc) { return cc; }
+    } midiControlIndex;
+    void rebuildMidiControlIndex();
+
     void resetStateFromTimeData();
     void processControl();
     /*
@@ -132,6 +303,16 @@ class alignas(16) SurgeSynthesizer
     void
     processAudioThreadOpsWhenAudioEngineUnavailable(bool doItEvenIfAudioIsRunningDANGER = false);
     bool loadFx(bool initp, bool force_reload_all);
+
+    /*
+     * Call from the UI thread once fxsync[slot] holds a new effect type. This builds the new
+     * effect here, since some allocate and clear large buffers when constructed, and leaves
+     * it for the loadFx on the audio thread to swap in at the next block. When the audio
+     * thread replaces an effect it hands the old one back, and this (or
+     * freeRetiredEffects) deletes it.
+     */
+    void prepareFxSwap(int slot);
+    void freeRetiredEffects();
     void enqueueFXOff(int whichFX);
     bool loadOscalgos();
     std::atomic<bool> resendOscParam[n_scenes][n_oscs]{};
@@ -160,7 +341,10 @@ class alignas(16) SurgeSynthesizer
                    int32_t host_noteid, int16_t okey = -1, int16_t ochan = -1);
     void releaseScene(int s);
     int calculateChannelMask(int channel, int key);
-    void softkillVoice(int scene);
+    // uber-releases enough voices, chosen by the scene's stealing mode, to make room for one more
+    void softkillExcessVoices(int scene);
+    // the patch's polyphony limit, or the CPU governor's if that is lower
+    int effectivePolyLimit() const;
     void enforcePolyphonyLimit(int scene, int margin);
     int getNonUltrareleaseVoices(int scene) const;
     int getNonReleasedVoices(int scene) const;
@@ -171,9 +355,119 @@ class alignas(16) SurgeSynthesizer
                          int host_note_id, int host_originating_channel, int host_originating_key,
                          bool envFromZero = false);
     void notifyEndedNote(int32_t nid, int16_t key, int16_t chan, bool thisBlock = true);
-    std::array<std::array<SurgeVoice, MAX_VOICES>, 2> voices_array;
+    // the voices live in a LargeArray, so they can sit in large pages
+    using VoiceArray = std::array<std::array<SurgeVoice, MAX_VOICES>, 2>;
+    Surge::Memory::LargeArray<VoiceArray> voiceStorage;
+    VoiceArray &voices_array;
     // TODO: FIX SCENE ASSUMPTION!
     unsigned int voices_usedby[2][MAX_VOICES]; // 0 indicates no user, 1 is scene A, 2 is scene B
+    static_assert(MAX_VOICES <= 64, "free voice masks are 64 bits");
+    uint64_t freeVoiceSlots[n_scenes]; // bit i set when voices_array[scene][i] is unclaimed
+
+    /*
+     * CLAP hosts address polyphonic modulation and note expressions by note id and MPE
+     * controllers send per-note events at a high rate, so rather than walk the voice lists for
+     * each one we keep a map from note id, and from (channel, key), to a mask of voice slots per
+     * scene. It is rebuilt the first time it is needed after a voice is claimed or given a new
+     * note id, key or channel, and freeVoice takes its voice out directly.
+     */
+    struct VoiceLookupIndex
+    {
+        static_assert(MAX_VOICES <= 64, "voice masks are 64 bits");
+        // open addressed; every voice of both scenes can have a distinct id and stay half full
+        static constexpr int tableSize = 4 * MAX_VOICES;
+        static constexpr int channelKeySize = 16 * 128;
+        struct Entry
+        {
+            int32_t noteId{-1};
+            uint64_t voiceMask[n_scenes]{};
+        };
+        std::array<Entry, tableSize> entries;
+        std::array<int16_t, n_scenes * MAX_VOICES> usedSlots;
+        int usedCount{0};
+        uint64_t channelKeyMask[n_scenes][channelKeySize]{};
+        std::array<int16_t, n_scenes * MAX_VOICES> usedChannelKeys;
+        int usedChannelKeyCount{0};
+        bool dirty{true};
+
+        static int firstSlotFor(int32_t noteId)
+        {
+            return (int)(((uint32_t)noteId * 2654435761U) & (tableSize - 1));
+        }
+        static int channelKeyFor(int channel, int key)
+        {
+            return (channel & 15) * 128 + (key & 127);
+        }
+        void clear()
+        {
+            for (int i = 0; i < usedCount; ++i)
+                entries[usedSlots[i]] = Entry();
+            usedCount = 0;
+            for (int i = 0; i < usedChannelKeyCount; ++i)
+                channelKeyMask[usedChannelKeys[i] / channelKeySize]
+                              [usedChannelKeys[i] % channelKeySize] = 0;
+            usedChannelKeyCount = 0;
+        }
+        void add(int32_t noteId, int scene, int voiceIndex)
+        {
+            auto slot = firstSlotFor(noteId);
+            while (entries[slot].noteId >= 0 && entries[slot].noteId != noteId)
+                slot = (slot + 1) & (tableSize - 1);
+            if (entries[slot].noteId < 0)
+            {
+                entries[slot].noteId = noteId;
+                usedSlots[usedCount++] = (int16_t)slot;
+            }
+            entries[slot].voiceMask[scene] |= (uint64_t)1 << voiceIndex;
+        }
+        void addChannelKey(int channel, int key, int scene, int voiceIndex)
+        {
+            auto &m = channelKeyMask[scene][channelKeyFor(channel, key)];
+            if (!m)
+                usedChannelKeys[usedChannelKeyCount++] =
+                    (int16_t)(scene * channelKeySize + channelKeyFor(channel, key));
+            m |= (uint64_t)1 << voiceIndex;
+        }
+        void remove(int32_t noteId, int channel, int key, int scene, int voiceIndex)
+        {
+            auto bit = ~((uint64_t)1 << voiceIndex);
+            // an emptied channel/key stays in usedChannelKeys, which is harmless for clear
+            channelKeyMask[scene][channelKeyFor(channel, key)] &= bit;
+            if (noteId < 0)
+                return;
+            auto slot = firstSlotFor(noteId);
+            while (entries[slot].noteId >= 0)
+            {
+                if (entries[slot].noteId == noteId)
+                {
+                    entries[slot].voiceMask[scene] &= bit;
+                    return;
+                }
+                slot = (slot + 1) & (tableSize - 1);
+            }
+        }
+        uint64_t voicesFor(int32_t noteId, int scene) const
+        {
+            auto slot = firstSlotFor(noteId);
+            while (entries[slot].noteId >= 0)
+            {
+                if (entries[slot].noteId == noteId)
+                    return entries[slot].voiceMask[scene];
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            return 0;
+        }
+        uint64_t voicesFor(int channel, int key, int scene) const
+        {
+            return channelKeyMask[scene][channelKeyFor(channel, key)];
+        }
+    } voiceLookup;
+    void rebuildVoiceLookup();
+    /*
+     * The voice slots of a scene which might match a (channel, key, note id) triple, any of which
+     * can be -1 for 'any'. This is a superset; callers still confirm with matchesChannelKeyId.
+     */
+    uint64_t candidateVoices(int scene, int16_t channel, int16_t key, int32_t noteId);
 
     int64_t voiceCounter = 1L;
 
@@ -424,13 +718,69 @@ class alignas(16) SurgeSynthesizer
     void enqueuePatchForLoad(const void *data, int size); // safe from any thread
     void processEnqueuedPatchIfNeeded();                  // only safe from audio thread
 
-    void loadRaw(const void *data, int size, bool preset = false);
+    void loadRaw(const void *data, int size, bool preset = false,
+                 Wavetable *const prebuiltWT[n_scenes][n_oscs] = nullptr);
+    /*
+     * Bring the patch back to a snapshot captured from this synth or another one, the way
+     * loadRaw would have loaded that same patch, but straight from memory. Like loadRaw, not
+     * to be called while the audio thread is inside process().
+     */
+    void restorePatchSnapshot(const Surge::Storage::PatchSnapshot &snapshot);
     void loadPatch(int id);
     bool loadPatchByPath(const char *fxpPath, int categoryId, const char *name,
                          bool forceIsPreset = true);
     void selectRandomPatch();
     std::unique_ptr<std::thread> patchLoadThread;
 
+  private:
+    // what loadRaw and restorePatchSnapshot do either side of replacing the patch data
+    void beginPatchLoad();
+    void finishPatchLoad(bool fromStreaming);
+
+  public:
+
+    /*
+     * When a patch load is queued, process() first has prefetchQueuedPatch read the patch
+     * file and build its wavetables on another thread while the current patch keeps playing.
+     * Only then does it fade out and hand over to loadPatchInBackgroundThread, which picks
+     * up the prefetched data in loadPatchByPath, so the engine is only silent for the time it
+     * takes to apply the patch. The new patch then fades in.
+     */
+    struct PatchPrefetch
+    {
+        std::string path;
+        std::unique_ptr<char[]> data;
+        int size{0};
+        std::unique_ptr<Wavetable> wavetables[n_scenes][n_oscs];
+    } patchPrefetch;
+    void prefetchQueuedPatch();
+    void clearPatchPrefetch();
+    std::atomic<bool> patchPrefetchRunning{false}, patchPrefetchReady{false};
+    std::unique_ptr<std::thread> patchPrefetchThread;
+
+    /*
+     * The patches a browse is likely to ask for next, read and with their wavetables built
+     * ahead of time: the neighbours of the loaded patch in its category, in browse order, and
+     * the programs either side of the last program change. prefetchQueuedPatch takes its patch
+     * from here when it can, so stepping through patches with jogPatch or a foot controller
+     * doesn't wait on the disk or the wavetable build. Filled nearest first on a background
+     * thread, up to patchPreloadBudget bytes.
+     */
+    static constexpr int patchPreloadNeighbours = 2;
+    static constexpr size_t patchPreloadBudget = 64 * 1024 * 1024;
+    std::vector<std::unique_ptr<PatchPrefetch>> patchPreloads; // all three under patchPreloadMutex
+    std::vector<std::string> patchPreloadWanted;
+    bool patchPreloadRunning{false};
+    std::mutex patchPreloadMutex;
+    std::atomic<bool> patchPreloadStop{false}, programChangeReceived{false};
+    std::unique_ptr<std::thread> patchPreloadThread;
+    // works out what to preload around patchid; called by the loader with patchLoadSpawnMutex
+    void schedulePatchPreload();
+    void runPatchPreload();
+    // moves a preloaded into.path into into, if there is one
+    bool takePatchPreload(PatchPrefetch &into);
+    std::atomic<bool> fadeInAfterPatchLoad{false};
+
     // if increment is true, we go to next patch, else go to previous patch
     void jogCategory(bool increment);
     void jogPatch(bool increment, bool insideCategory = true);
@@ -442,7 +792,16 @@ class alignas(16) SurgeSynthesizer
     void savePatch(bool factoryInPlace = false, bool skipOverwrite = false);
     void updateUsedState();
     void prepareModsourceDoProcess(int scenemask);
+    /*
+     * The patch as DAW state. Hosts ask for this far more often than it changes, so while
+     * the patch's streamed state key still matches, the last one is handed back as it was.
+     */
     unsigned int saveRaw(void **data);
+    struct
+    {
+        SurgePatch::StreamedStateKey key;
+        std::vector<char> data;
+    } savedRawState;
 
     //==============================================================================
     // --- 'patch loaded' listener(s) ----
@@ -473,6 +832,22 @@ class alignas(16) SurgeSynthesizer
     }
     void deleteAudioParamListener(std::string key) { audioThreadParamListeners.erase(key); }
 
+    /*
+     * Values set on the audio thread from MIDI-learned controls go through this log rather
+     * than to the listeners above one at a time, so a fast controller sweep reaches its
+     * consumer as one batch of the latest values. Log listeners are called on the audio
+     * thread when there's something to drain, at most once per drain; the one consumer
+     * should drain from its own thread.
+     */
+    Surge::Threading::ParameterChangeLog<n_total_params> audioThreadParamChanges;
+    std::unordered_map<std::string, std::function<void()>> audioThreadParamLogListeners;
+
+    void addAudioParamLogListener(std::string key, std::function<void()> const &l)
+    {
+        audioThreadParamLogListeners.insert({key, l});
+    }
+    void deleteAudioParamLogListener(std::string key) { audioThreadParamLogListeners.erase(key); }
+
     //==============================================================================
     // synth -> editor variables
     bool refresh_editor, refresh_vkb, patch_loaded;
@@ -482,6 +857,8 @@ class alignas(16) SurgeSynthesizer
     bool refresh_overflow = false;
     float refresh_ctrl_queue_value[8];
     bool process_input;
+    // storage.audio_in and audio_in_nonOS are silent since nobody wanted them; see process()
+    bool inputCleared{false}, inputNonOSCleared{false};
     std::atomic<bool> has_patchid_file;
     char patchid_file[FILENAME_MAX];
     std::atomic<int> patchid_queue;
@@ -492,9 +869,81 @@ class alignas(16) SurgeSynthesizer
     std::atomic<int> modwheelCC, pitchbendMIDIVal, sustainpedalCC;
     std::atomic<bool> midiSoftTakeover;
 
+    /*
+     * The engine renders in whole blocks, so events land on a block boundary. With
+     * sampleAccurateNoteOns set, the plugin wrappers apply all events for a block before
+     * rendering it, and set noteOnSampleOffset to each event's position in that block while
+     * they do. Voices started then stay silent until that sample of their first block.
+     */
+    std::atomic<bool> sampleAccurateNoteOns{false};
+    int noteOnSampleOffset{0};
+
     float vu_peak[8];
     std::atomic<float> cpu_level{0.f};
 
+    /*
+     * What the engine changed since the editor last looked, so its idle only checks (and
+     * repaints) the widgets showing it. Whatever writes one of the synth -> editor variables
+     * above marks the matching bit, and the editor takes the whole set once per idle.
+     */
+    enum UIChanges : uint32_t
+    {
+        uic_params = 1 << 0,    // refresh_ctrl_queue, refresh_parameter_queue, refresh_overflow
+        uic_levels = 1 << 1,    // vu_peak, cpu_level and the effect VUs
+        uic_polyphony = 1 << 2, // polydisplay
+        uic_midi = 1 << 3,      // hasUpdatedMidiCC, midiNoteEvents
+        uic_all = 0xFFFFFFFF
+    };
+    std::atomic<uint32_t> uiChanges{uic_all};
+    void markUIChanged(uint32_t c) { uiChanges.fetch_or(c, std::memory_order_release); }
+    uint32_t takeUIChanges() { return uiChanges.exchange(0, std::memory_order_acquire); }
+    // the levels as of the last uic_levels, so still meters don't keep marking it
+    float uiPublishedLevels[3]{};
+    Surge::Profiling::ProcessProfiler processProfiler;
+    Surge::Profiling::CPUGovernor cpuGovernor;
+
+    /*
+     * Set by process() when the block it just rendered is known to be all zeros because no
+     * scene had voices and every effect had rung out, so none of it was actually computed.
+     */
+    bool outputSilent{false};
+
+    /*
+     * The delay the effects in the dry path add, set by process() for the plugin to report:
+     * the slower of the two insert chains plus the global chain. Sends are mixed in parallel
+     * with the dry signal, so there's nothing to compensate them against and they don't count.
+     */
+    std::atomic<int> fxLatencySamples{0};
+
+    /*
+     * How long the output can keep sounding once every note has been released: the longer
+     * amp envelope release plus the ring outs of the enabled effects, which may be in series.
+     * Returns a negative value if some effect can ring indefinitely. This looks at the effect
+     * instances so only call it from the audio thread.
+     */
+    double getTailLengthSeconds() const;
+
+    /*
+     * Where an instance's memory goes, in bytes, by subsystem. Wavetables are shared between
+     * instances holding the same table, and sqlite has one heap for the process, so those two
+     * overlap across instances; the rest is this instance's alone. The effect slots are read
+     * under fxSpawnMutex, so don't call this from the audio thread.
+     */
+    struct MemoryReport
+    {
+        size_t voices{0};            // the voices themselves, less their oscillator buffers
+        size_t oscillatorBuffers{0}; // the buffers each voice builds its oscillators into
+        size_t filterStates{0};      // the quad filter chain states
+        size_t fxSlots[n_fx_slots]{};
+        size_t wavetables{0};  // the mipmapped tables of every oscillator, counted once each
+        size_t memoryPools{0}; // pool items, frozen hits and the delay arena not lent out
+        size_t lua{0};
+        size_t patchDB{0};
+
+        size_t total() const;
+    };
+    MemoryReport memoryReport();
+
     void populateDawExtraState();
 
     void loadFromDawExtraState();
@@ -505,8 +954,66 @@ class alignas(16) SurgeSynthesizer
     bool approachingAllSoundOff{false};
     // TODO: FIX SCENE ASSUMPTION (for halfbandA/B - use std::array)
     sst::filters::HalfRate::HalfRateFilter halfbandA, halfbandB, halfbandIN;
-    std::list<SurgeVoice *> voices[n_scenes];
+    // gentler scene decimators which do at high sample rates, see setSamplerate
+    sst::filters::HalfRate::HalfRateFilter halfbandHighRateA, halfbandHighRateB;
+    bool useHighRateDecimators{false};
+    // the rate the effects and voices were last reset for; 0 so the first prepare always runs
+    float preparedSamplerate{0};
+    using voiceList_t = Surge::Voice::ActiveVoiceList<SurgeVoice, MAX_VOICES>;
+    voiceList_t voices[n_scenes];
     std::unique_ptr<Effect> fx[n_fx_slots];
+
+    /*
+     * The scene level modulation sources, grouped by type and held here rather than in a heap
+     * block each, so the ones process() runs every block sit together and are called on their
+     * concrete type. scene.modsources points into these. The macros are shared by the scenes.
+     */
+    struct SceneModulators
+    {
+        static constexpr int controllerIds[] = {ms_modwheel, ms_breath, ms_expression, ms_sustain,
+                                                ms_aftertouch};
+        static constexpr int keyIds[] = {ms_lowest_key, ms_highest_key, ms_latest_key};
+        static constexpr int randomIds[] = {ms_random_unipolar, ms_random_bipolar};
+        static constexpr int alternateIds[] = {ms_alternate_bipolar, ms_alternate_unipolar};
+
+        ControllerModulationSource controllers[std::size(controllerIds)];
+        ControllerModulationSource pitchbend;
+        ControllerModulationSource keys[std::size(keyIds)];
+        RandomModulationSource randoms[std::size(randomIds)]{RandomModulationSource(false),
+                                                             RandomModulationSource(true)};
+        AlternateModulationSource alternates[std::size(alternateIds)]{
+            AlternateModulationSource(true), AlternateModulationSource(false)};
+        LFOModulationSource lfos[n_lfos_scene];
+    } sceneModulators[n_scenes];
+    std::array<MacroModulationSource, n_customcontrollers> macros;
+
+    /*
+     * A mailbox per slot for the effect built by prepareFxSwap. The UI thread only writes it
+     * from empty or ready and the audio thread only takes it from ready, so neither waits.
+     */
+    struct PrespawnedEffect
+    {
+        enum State
+        {
+            empty,
+            writing,
+            ready,
+            taking
+        };
+        std::atomic<int> state{empty};
+        Effect *fx{nullptr};
+        int type{0};
+    } prespawnedFx[n_fx_slots];
+    Effect *takePrespawnedFx(int slot, int type);
+
+    // effects the audio thread has swapped out, for the UI thread to delete
+    std::atomic<Effect *> retiredFx[n_fx_slots]{};
+    void retireFx(int slot);
+
+    // effects swapped in while playing crossfade from the dry signal over this many samples
+    static constexpr int fxSwapFadeSamples = 4 * BLOCK_SIZE;
+    int fxSwapFade[n_fx_slots]{};
+    bool processEffect(int slot, float *dataL, float *dataR, bool indata_present, bool isSend);
     std::atomic<bool> halt_engine;
     MidiChannelState channelState[16];
     bool &mpeEnabled;
@@ -527,8 +1034,8 @@ class alignas(16) SurgeSynthesizer
 
     static constexpr int n_hpBQ = 4;
 
-    // TODO: FIX SCENE ASSUMPTION (use std::array)
-    std::array<BiquadFilter, n_hpBQ> hpA, hpB;
+    // each stage of the scene low cut, with scene A left and right in lanes 0 and 1, B in 2 and 3
+    std::array<BiquadBank<2 * n_scenes>, n_hpBQ> sceneLowCut;
 
     bool fx_reload[n_fx_slots]; // if true, reload new effect parameters from fxsync
     FxStorage fxsync[n_fx_slots]{
@@ -555,18 +1062,111 @@ class alignas(16) SurgeSynthesizer
     // hold pedal stuff
     struct HoldBufferItem
     {
-        int channel;
-        int key;
-        int originalChannel;
-        int originalKey;
+        int8_t channel; // channel and key are -1 once the note is played again, see playNote
+        int8_t key;
+        int8_t originalChannel;
+        int8_t originalKey;
         int32_t host_noteid;
     };
-    std::list<HoldBufferItem> holdbuffer[n_scenes];
+
+    /*
+     * The notes released while the pedal is down, in the order they were released. A long
+     * pedal in MPE can gather a lot of these, so rather than a list, which allocates on the
+     * audio thread, this is a fixed block. An item which is already waiting isn't added again,
+     * which bounds the contents to about one live and one replayed item per channel and key,
+     * and liveCount lets a note on skip the walk when nothing on its channel and key waits.
+     */
+    struct HoldBuffer
+    {
+        static constexpr int capacity = 2 * 16 * 128;
+        std::array<HoldBufferItem, capacity> items;
+        int count{0};
+        std::array<uint16_t, 16 * 128> liveCount{};
+        std::bitset<16 * 128> replayed;
+
+        static int channelKey(int channel, int key) { return (channel & 15) * 128 + (key & 127); }
+        static bool isLive(const HoldBufferItem &h) { return h.channel >= 0 && h.key >= 0; }
+
+        HoldBufferItem *begin() { return items.data(); }
+        HoldBufferItem *end() { return items.data() + count; }
+        bool empty() const { return count == 0; }
+
+        bool isWaiting(int channel, int key) const { return liveCount[channelKey(channel, key)]; }
+
+        // false if there is no room, in which case the caller should release the note now
+        bool push(const HoldBufferItem &h)
+        {
+            assert(isLive(h));
+            if (isWaiting(h.channel, h.key))
+            {
+                for (auto &o : *this)
+                {
+                    if (o.channel == h.channel && o.key == h.key && o.host_noteid == h.host_noteid)
+                        return true;
+                }
+            }
+            if (count == capacity)
+                return false;
+            items[count++] = h;
+            liveCount[channelKey(h.channel, h.key)]++;
+            return true;
+        }
+
+        /*
+         * Keep the items for which keep(item) is true, in order, and forget the rest. keep may
+         * rewrite the item it is handed. A replayed item for a note which already has one is
+         * dropped, since purging a note's duplicates twice does nothing more.
+         */
+        template <typename F> void retain(F keep)
+        {
+            forgetCounts();
+            int w = 0;
+            for (int r = 0; r < count; ++r)
+            {
+                auto h = items[r];
+                if (!keep(h))
+                    continue;
+                if (isLive(h))
+                {
+                    liveCount[channelKey(h.channel, h.key)]++;
+                }
+                else
+                {
+                    auto ck = channelKey(h.originalChannel, h.originalKey);
+                    if (replayed[ck])
+                        continue;
+                    replayed[ck] = true;
+                }
+                items[w++] = h;
+            }
+            count = w;
+        }
+
+        void clear()
+        {
+            forgetCounts();
+            count = 0;
+        }
+
+      private:
+        void forgetCounts()
+        {
+            for (auto &h : *this)
+            {
+                if (isLive(h))
+                    liveCount[channelKey(h.channel, h.key)] = 0;
+                else
+                    replayed[channelKey(h.originalChannel, h.originalKey)] = false;
+            }
+        }
+    };
+    HoldBuffer holdbuffer[n_scenes];
     void purgeHoldbuffer(int scene);
     void purgeDuplicateHeldVoicesInPolyMode(int scehe, int channel, int key);
     void stopSound();
 
-    QuadFilterChainState *FBQ[n_scenes];
+    QuadFilterChainState *FBQ[n_scenes]; // each scene's run of filterChainStates
+    Surge::Memory::LargeArray<QuadFilterChainState> filterChainStates;
 
     std::string hostProgram = "Unknown Host";
     std::string juceWrapperType = "Unknown Wrapper Type";
@@ -580,14 +1180,103 @@ class alignas(16) SurgeSynthesizer
   private:
     PluginLayer *_parent = nullptr;
 
+    // Scene rendering, split so the scenes can run on separate threads
+    int processSceneVoices(int scene, bool deferVoiceFree);
+    void processSceneFilterChains(int scene, int nVoices);
+    void freeFinishedVoices(int scene);
+    bool canRenderScenesConcurrently() const;
+
+    template <typename F> void runBatch(int nTasks, F &f)
+    {
+        if (externalBatchRunner &&
+            externalBatchRunner->runBatch(
+                nTasks, [](void *ctx, int i) { (*static_cast<F *>(ctx))(i); }, &f))
+        {
+            return;
+        }
+
+        scheduler->parallelFor(nTasks, f, batchDeadline());
+    }
+
+    // shared by every instance in the process, and held once any multithreading is enabled
+    void acquireScheduler();
+    Surge::Threading::SharedScheduler::clock_t::time_point batchDeadline() const;
+    std::shared_ptr<Surge::Threading::SharedScheduler> scheduler;
+    Surge::Threading::SharedScheduler::clock_t::time_point hostCallbackDeadline{};
+
+    std::atomic<bool> multithreadedSceneRendering{false};
+    bool voiceFinished[n_scenes][MAX_VOICES]{};
+    std::vector<std::unique_ptr<SurgeStorage::RNGGen>> sceneWorkerRNGs;
+
+    // Voice rendering in quad sized groups, so the groups can run on separate threads
+    static constexpr int maxVoiceQuadTasks = n_scenes * (MAX_VOICES >> 2);
+    FBQFPtr prepareSceneFilterChain(int scene, fbq_global &g);
+    void processVoiceQuad(int task);
+    bool canRenderVoiceQuadsConcurrently() const;
+    int renderVoiceQuadsConcurrently(int firstScene, int lastScene);
+    void finishSceneFilterChains(int scene);
+
+    std::atomic<bool> multithreadedVoiceRendering{false};
+
+    // Effect chains, split so the independent ones can run on separate threads
+    bool processInsertChain(int scene, bool state);
+    bool processSendEffect(int send, bool state, const bool *sceneSilent);
+    bool canRenderEffectsConcurrently() const;
+
+    std::atomic<bool> multithreadedEffectRendering{false};
+    std::atomic<int> requestedEffectOversampling{SurgeStorage::EFFECT_OVERSAMPLING_STANDARD};
+    int silentVoiceThresholdDb{0};
+
+    // playVoice's side of freeze voices, for a voice it has just made
+    void attachFrozenHit(SurgeVoice *v, int scene, int velocity, float detune);
+    std::atomic<bool> frozenHitsReady{false};
+    std::atomic<int> freezeVoicesBudgetMB{0};
+
+    // the audio thread's side of cpuGovernor
+    void applyCPUGovernorLevel(int level);
+    static constexpr int governorMinPolyphony = 4;
+    int governorPolyLimit{MAX_VOICES};
+
+    float effectUsec[n_fx_slots]{};
+    SurgeStorage::RNGGen effectChainRNGs[std::max(n_scenes, n_send_slots)];
+
+    // Voice LFOs which come out the same in every voice run once per scene instead
+    bool canShareVoiceLFO(int scene, int lfo) const;
+    void processSharedVoiceLFOs(int scene);
+    void processSharedFilterCoeffs(int scene);
+    sst::filters::FilterCoefficientMaker<SurgeStorage> sharedFilterCM;
+    double sharedFilterCoeffsRate{0};
+    LFOModulationSource sharedVoiceLFOs[n_scenes][n_lfos_voice];
+    bool sharedVoiceLFOAttacked[n_scenes][n_lfos_voice]{};
+
+    struct VoiceQuadTask
+    {
+        int scene{0}, quad{0};
+        fbq_global g{};
+        FBQFPtr processQuad{nullptr};
+        SurgeStorage::RNGGen rng;
+    } voiceQuadTasks[maxVoiceQuadTasks];
+    float voiceQuadOut alignas(16)[maxVoiceQuadTasks][N_OUTPUTS][BLOCK_SIZE_OS];
+
     void switch_toggled();
 
     // MIDI control interpolators
     static constexpr int num_controlinterpolators = 128;
     ControllerModulationSource mControlInterpolator[num_controlinterpolators];
-    bool mControlInterpolatorUsed[num_controlinterpolators];
 
+    /*
+     * The slots in use are kept packed at the front of mControlInterpolatorActive, so the
+     * per block smoothing only walks what is actually moving, and the free slots sit on a stack.
+     * mControlInterpolatorActivePos maps a slot back to its place in the active list, or -1.
+     */
+    int mControlInterpolatorActive[num_controlinterpolators];
+    int mControlInterpolatorActivePos[num_controlinterpolators];
+    int mControlInterpolatorFree[num_controlinterpolators];
+    int mControlInterpolatorActiveCount{0}, mControlInterpolatorFreeCount{0};
+
+    void ResetControlInterpolators();
     int GetFreeControlInterpolatorIndex();
+    void FreeControlInterpolatorIndex(int Index);
     int GetControlInterpolatorIndex(int Idx);
     void ReleaseControlInterpolator(int Idx);
     ControllerModulationSource *ControlInterpolator(int Idx);
@@ -30,9 +30,14 @@
 #include <fstream>
 #include <iterator>
 #include "SurgeMemoryPools.h"
+#include "FPUState.h"
+#include "RealtimeSafety.h"
+#include "SurgeTrace.h"
+#include "ThreadPolicy.h"
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 #include "PatchFileHeaderStructs.h"
+#include "PatchSnapshot.h"
 
 namespace mech = sst::basic_blocks::mechanics;
 
@@ -211,61 +216,78 @@ bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, cons
 {
     using namespace sst::io;
 
-    std::filebuf f;
-    if (!f.open(string_to_path(fxpPath), std::ios::binary | std::ios::in))
+    int cs{0};
+    std::unique_ptr<char[]> data;
+    Wavetable *prebuiltWT[n_scenes][n_oscs]{};
+
+    if (patchPrefetchReady && patchPrefetch.data && patchPrefetch.path == fxpPath)
     {
-        storage.reportError(std::string() + "Unable to open file " + std::string(fxpPath),
-                            "Unable to open file");
-        return false;
+        // prefetchQueuedPatch already read this one and built its wavetables
+        cs = patchPrefetch.size;
+        data = std::move(patchPrefetch.data);
+
+        for (int sc = 0; sc < n_scenes; sc++)
+            for (int o = 0; o < n_oscs; o++)
+                prebuiltWT[sc][o] = patchPrefetch.wavetables[sc][o].get();
     }
-    fxChunkSetCustom fxp;
-    auto read = f.sgetn(reinterpret_cast<char *>(&fxp), sizeof(fxp));
-    // FIXME - error if read != chunk size
-    if ((mech::endian_read_int32BE(fxp.chunkMagic) != 'CcnK') ||
-        (mech::endian_read_int32BE(fxp.fxMagic) != 'FPCh') ||
-        (mech::endian_read_int32BE(fxp.fxID) != 'cjs3'))
+    else
     {
+        std::filebuf f;
+        if (!f.open(string_to_path(fxpPath), std::ios::binary | std::ios::in))
+        {
+            storage.reportError(std::string() + "Unable to open file " + std::string(fxpPath),
+                                "Unable to open file");
+            return false;
+        }
+        fxChunkSetCustom fxp;
+        auto read = f.sgetn(reinterpret_cast<char *>(&fxp), sizeof(fxp));
+        // FIXME - error if read != chunk size
+        if ((mech::endian_read_int32BE(fxp.chunkMagic) != 'CcnK') ||
+            (mech::endian_read_int32BE(fxp.fxMagic) != 'FPCh') ||
+            (mech::endian_read_int32BE(fxp.fxID) != 'cjs3'))
+        {
+            f.close();
+            auto cm = mech::endian_read_int32BE(fxp.chunkMagic);
+            auto fm = mech::endian_read_int32BE(fxp.fxMagic);
+            auto id = mech::endian_read_int32BE(fxp.fxID);
+
+            std::ostringstream oss;
+            oss << "Unable to load " << patchName << ".fxp!";
+            // if( cm != 'CcnK' )
+            //{
+            //   oss << "ChunkMagic is not 'CcnK'. ";
+            //}
+            // if( fm != 'FPCh' )
+            //{
+            //   oss << "FxMagic is not 'FPCh'. ";
+            //}
+            // if( id != 'cjs3' )
+            //{
+            //   union {
+            //      char c[4];
+            //      int id;
+            //   } q;
+            //   q.id = id;
+            //   oss << "Synth ID is '" << q.c[0] << q.c[1] << q.c[2] << q.c[3]
+            //       << "'; Surge expected 'cjs3'. ";
+            //}
+            oss << "This error usually occurs when you attempt to load an .fxp that belongs to "
+                   "another plugin into Surge XT.";
+            storage.reportError(oss.str(), "Unknown FXP File");
+            return false;
+        }
+
+        cs = mech::endian_read_int32BE(fxp.chunkSize);
+        data.reset(new char[cs]);
+
+        if (f.sgetn(data.get(), cs) != cs)
+        {
+            perror("Error while loading patch!");
+        }
+
         f.close();
-        auto cm = mech::endian_read_int32BE(fxp.chunkMagic);
-        auto fm = mech::endian_read_int32BE(fxp.fxMagic);
-        auto id = mech::endian_read_int32BE(fxp.fxID);
-
-        std::ostringstream oss;
-        oss << "Unable to load " << patchName << ".fxp!";
-        // if( cm != 'CcnK' )
-        //{
-        //   oss << "ChunkMagic is not 'CcnK'. ";
-        //}
-        // if( fm != 'FPCh' )
-        //{
-        //   oss << "FxMagic is not 'FPCh'. ";
-        //}
-        // if( id != 'cjs3' )
-        //{
-        //   union {
-        //      char c[4];
-        //      int id;
-        //   } q;
-        //   q.id = id;
-        //   oss << "Synth ID is '" << q.c[0] << q.c[1] << q.c[2] << q.c[3] << "'; Surge expected
-        //   'cjs3'. ";
-        //}
-        oss << "This error usually occurs when you attempt to load an .fxp that belongs to another "
-               "plugin into Surge XT.";
-        storage.reportError(oss.str(), "Unknown FXP File");
-        return false;
-    }
-
-    int cs = mech::endian_read_int32BE(fxp.chunkSize);
-    std::unique_ptr<char[]> data{new char[cs]};
-
-    if (f.sgetn(data.get(), cs) != cs)
-    {
-        perror("Error while loading patch!");
     }
 
-    f.close();
-
     storage.getPatch().comment = "";
     storage.getPatch().author = "";
 
@@ -281,7 +303,7 @@ bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, cons
     current_category_id = categoryId;
     storage.getPatch().name = patchName;
 
-    loadRaw(data.get(), cs, forceIsPreset);
+    loadRaw(data.get(), cs, forceIsPreset, prebuiltWT);
     data.reset();
 
     // OK so at this point we may have loaded a patch with a tuning override
@@ -376,6 +398,275 @@ bool SurgeSynthesizer::loadPatchByPath(const char *fxpPath, int categoryId, cons
     return true;
 }
 
+namespace
+{
+/*
+ * Read and check the file at p.path as loadPatchByPath does, but quietly, and build its
+ * wavetables. If anything is off we leave p empty and loadPatchByPath goes to disk and
+ * reports the problem.
+ */
+void readPatchPrefetch(SurgeSynthesizer::PatchPrefetch &patchPrefetch,
+                       const std::atomic<bool> *buildCompact)
+{
+    using namespace sst::io;
+
+    std::filebuf f;
+    if (!patchPrefetch.path.empty() &&
+        f.open(string_to_path(patchPrefetch.path), std::ios::binary | std::ios::in))
+    {
+        fxChunkSetCustom fxp;
+        auto cs = 0;
+
+        if (f.sgetn(reinterpret_cast<char *>(&fxp), sizeof(fxp)) == sizeof(fxp) &&
+            mech::endian_read_int32BE(fxp.chunkMagic) == 'CcnK' &&
+            mech::endian_read_int32BE(fxp.fxMagic) == 'FPCh' &&
+            mech::endian_read_int32BE(fxp.fxID) == 'cjs3')
+        {
+            cs = mech::endian_read_int32BE(fxp.chunkSize);
+        }
+
+        if (cs > 0)
+        {
+            patchPrefetch.data.reset(new char[cs]);
+
+            if (f.sgetn(patchPrefetch.data.get(), cs) == cs)
+                patchPrefetch.size = cs;
+            else
+                patchPrefetch.data.reset();
+        }
+
+        f.close();
+    }
+
+    // now the expensive part, built from a copy of the header so the data stays as read
+    patch_header ph;
+
+    if (patchPrefetch.data && patchPrefetch.size > (int)sizeof(ph))
+    {
+        memcpy(&ph, patchPrefetch.data.get(), sizeof(ph));
+    }
+
+    if (patchPrefetch.data && patchPrefetch.size > (int)sizeof(ph) && !memcmp(ph.tag, "sub3", 4))
+    {
+        auto end = patchPrefetch.data.get() + patchPrefetch.size;
+        auto dr = patchPrefetch.data.get() + sizeof(ph) + mech::endian_read_int32LE(ph.xmlsize);
+
+        for (int sc = 0; sc < n_scenes; sc++)
+        {
+            for (int o = 0; o < n_oscs; o++)
+            {
+                auto wtsize = mech::endian_read_int32LE(ph.wtsize[sc][o]);
+
+                if (!wtsize)
+                    continue;
+
+                if (dr + sizeof(wt_header) > end)
+                    break;
+
+                wt_header wth;
+                memcpy(&wth, dr, sizeof(wth));
+
+                auto wt = std::make_unique<Wavetable>();
+                wt->buildCompact = buildCompact;
+
+                if (wt->BuildWT(dr + sizeof(wt_header), wth, false))
+                    patchPrefetch.wavetables[sc][o] = std::move(wt);
+
+                dr += wtsize;
+            }
+        }
+    }
+}
+
+size_t patchPrefetchBytes(const SurgeSynthesizer::PatchPrefetch &p)
+{
+    size_t res = p.size;
+
+    for (auto &s : p.wavetables)
+        for (auto &w : s)
+            if (w)
+                res += w->dataSizes * (sizeof(float) + sizeof(short));
+
+    return res;
+}
+} // namespace
+
+void SurgeSynthesizer::prefetchQueuedPatch()
+{
+    clearPatchPrefetch();
+
+    {
+        std::lock_guard<std::mutex> mg(patchLoadSpawnMutex);
+
+        // the background loader does the id first and then the file, so the file wins
+        if (has_patchid_file)
+        {
+            patchPrefetch.path = patchid_file;
+        }
+        else if (patchid_queue >= 0 && patchid_queue < storage.patch_list.size())
+        {
+            patchPrefetch.path = path_to_string(storage.patch_list[patchid_queue].path);
+        }
+    }
+
+    if (!takePatchPreload(patchPrefetch))
+        readPatchPrefetch(patchPrefetch, &storage.compactWavetables);
+
+    patchPrefetchReady = true;
+    patchPrefetchRunning = false;
+}
+
+void SurgeSynthesizer::schedulePatchPreload()
+{
+    std::vector<std::string> want;
+    int np = storage.patch_list.size();
+
+    auto add = [&](int id) {
+        if (id < 0 || id >= np)
+            return;
+
+        auto path = path_to_string(storage.patch_list[id].path);
+
+        if (std::find(want.begin(), want.end(), path) == want.end())
+            want.push_back(path);
+    };
+
+    if (patchid >= 0 && patchid < np)
+    {
+        // the order jogPatch walks in
+        std::vector<int> inCategory;
+        int pos = 0;
+
+        for (auto i : storage.patchOrdering)
+        {
+            if (storage.patch_list[i].category == storage.patch_list[patchid].category)
+            {
+                if (i == patchid)
+                    pos = inCategory.size();
+                inCategory.push_back(i);
+            }
+        }
+
+        int n = inCategory.size();
+
+        for (int d = 1; d <= patchPreloadNeighbours && d < n; ++d)
+        {
+            add(inCategory[(pos + d) % n]);
+            add(inCategory[(pos - d + n) % n]);
+        }
+    }
+
+    // and once program changes are in use, the programs either side in the current bank
+    if (programChangeReceived)
+    {
+        auto &bank = storage.patchIdToMidiBankAndProgram[std::clamp(CC0, 0, 127)];
+
+        for (int d = 1; d <= patchPreloadNeighbours; ++d)
+        {
+            if (PCH + d < 128)
+                add(bank[PCH + d]);
+            if (PCH - d >= 0)
+                add(bank[PCH - d]);
+        }
+    }
+
+    std::lock_guard<std::mutex> g(patchPreloadMutex);
+    patchPreloadWanted = std::move(want);
+
+    if (!patchPreloadRunning)
+    {
+        if (patchPreloadThread)
+            patchPreloadThread->join();
+
+        patchPreloadRunning = true;
+        patchPreloadThread = std::make_unique<std::thread>([this]() {
+            SURGE_TRACE_THREAD_NAME("Surge Patch Preload");
+            Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Loader);
+            auto fpuguard = Surge::FPUState::DSPThreadGuard();
+            runPatchPreload();
+        });
+    }
+}
+
+void SurgeSynthesizer::runPatchPreload()
+{
+    while (!patchPreloadStop)
+    {
+        auto next = std::make_unique<PatchPrefetch>();
+
+        {
+            std::lock_guard<std::mutex> g(patchPreloadMutex);
+            auto &want = patchPreloadWanted;
+
+            // let go of what the last patch wanted and this one doesn't
+            patchPreloads.erase(std::remove_if(patchPreloads.begin(), patchPreloads.end(),
+                                               [&](auto &p) {
+                                                   return std::find(want.begin(), want.end(),
+                                                                    p->path) == want.end();
+                                               }),
+                                patchPreloads.end());
+
+            size_t bytes = 0;
+            for (auto &p : patchPreloads)
+                bytes += patchPrefetchBytes(*p);
+
+            for (auto &w : want)
+            {
+                if (std::none_of(patchPreloads.begin(), patchPreloads.end(),
+                                 [&](auto &p) { return p->path == w; }))
+                {
+                    next->path = w;
+                    break;
+                }
+            }
+
+            if (next->path.empty() || bytes >= patchPreloadBudget)
+            {
+                patchPreloadRunning = false;
+                return;
+            }
+        }
+
+        // a file which won't read is kept, empty, so we don't go back to it
+        readPatchPrefetch(*next, &storage.compactWavetables);
+
+        std::lock_guard<std::mutex> g(patchPreloadMutex);
+        patchPreloads.push_back(std::move(next));
+    }
+
+    std::lock_guard<std::mutex> g(patchPreloadMutex);
+    patchPreloadRunning = false;
+}
+
+bool SurgeSynthesizer::takePatchPreload(PatchPrefetch &into)
+{
+    std::lock_guard<std::mutex> g(patchPreloadMutex);
+
+    for (auto it = patchPreloads.begin(); it != patchPreloads.end(); ++it)
+    {
+        if ((*it)->path == into.path && (*it)->data)
+        {
+            into = std::move(**it);
+            patchPreloads.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SurgeSynthesizer::clearPatchPrefetch()
+{
+    patchPrefetchReady = false;
+    patchPrefetch.path.clear();
+    patchPrefetch.data.reset();
+    patchPrefetch.size = 0;
+
+    for (auto &s : patchPrefetch.wavetables)
+        for (auto &w : s)
+            w.reset();
+}
+
 void SurgeSynthesizer::enqueuePatchForLoad(const void *data, int size)
 {
     {
@@ -401,6 +692,7 @@ void SurgeSynthesizer::processEnqueuedPatchIfNeeded()
     bool expected = true;
     if (rawLoadEnqueued.compare_exchange_weak(expected, true) && expected)
     {
+        Surge::RealtimeSafety::noteBlockingCall("processEnqueuedPatchIfNeeded");
         {
             // If we are forcing values on, we don't want to do any enqueued loads
             // or want to wait for them to complete
@@ -418,17 +710,36 @@ void SurgeSynthesizer::processEnqueuedPatchIfNeeded()
     }
 }
 
-void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset)
+void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset,
+                               Wavetable *const prebuiltWT[n_scenes][n_oscs])
+{
+    beginPatchLoad();
+    storage.getPatch().init_default_values();
+    storage.getPatch().load_patch(data, size, preset, prebuiltWT);
+    finishPatchLoad(true);
+}
+
+void SurgeSynthesizer::restorePatchSnapshot(const Surge::Storage::PatchSnapshot &snapshot)
 {
+    beginPatchLoad();
+    snapshot.restore(storage.getPatch());
+    finishPatchLoad(false);
+}
+
+void SurgeSynthesizer::beginPatchLoad()
+{
+    processProfiler.noteEvent(Surge::Profiling::be_patch_load);
     halt_engine = true;
     stopSound();
     for (int s = 0; s < n_scenes; s++)
         for (int i = 0; i < n_customcontrollers; i++)
             storage.getPatch().scene[s].modsources[ms_ctrl1 + i]->reset();
+}
 
-    storage.getPatch().init_default_values();
-    storage.getPatch().load_patch(data, size, preset);
-    storage.getPatch().update_controls(false, nullptr, true);
+void SurgeSynthesizer::finishPatchLoad(bool fromStreaming)
+{
+    storage.publishModulationRoutings();
+    storage.getPatch().update_controls(false, nullptr, fromStreaming);
     for (int i = 0; i < n_fx_slots; i++)
     {
         fxsync[i] = storage.getPatch().fx[i];
@@ -680,4 +991,25 @@ void SurgeSynthesizer::savePatchToPath(fs::path filename, bool refreshPatchList)
     }
 }
 
-unsigned int SurgeSynthesizer::saveRaw(void **data) { return storage.getPatch().save_patch(data); }
+unsigned int SurgeSynthesizer::saveRaw(void **data)
+{
+    auto &patch = storage.getPatch();
+    auto key = patch.streamedStateKey();
+
+    if (!savedRawState.data.empty() && key.matches(savedRawState.key))
+    {
+        *data = savedRawState.data.data();
+        return savedRawState.data.size();
+    }
+
+    // this is DAW state rather than a patch file, so it carries the fast parameter block
+    void *built = nullptr;
+    auto size = patch.save_patch(&built, true);
+
+    auto bytes = static_cast<const char *>(built);
+    savedRawState.data.assign(bytes, bytes + size);
+    savedRawState.key = std::move(key);
+
+    *data = savedRawState.data.data();
+    return size;
+}
@@ -0,0 +1,56 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_SURGETRACE_H
+#define SURGE_SRC_COMMON_SURGETRACE_H
+
+/*
+ * Optional Tracy trace zones for timelines of the audio, loader and GUI threads. Configure
+ * with -DSURGE_ENABLE_TRACY=ON (and a Tracy install findable by CMake) to turn them on;
+ * otherwise every macro here expands to nothing.
+ *
+ * Zone and thread names must be string literals, since Tracy keeps the pointer. Zone text is
+ * copied, so it can be anything, but only goes on a zone opened in the same scope.
+ */
+#if SURGE_TRACY
+#include <cstring>
+#include <tracy/Tracy.hpp>
+
+#define SURGE_TRACE_ZONE(name) ZoneScopedN(name)
+#define SURGE_TRACE_ZONE_TEXT(text)                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        const char *surgeTraceText_ = (text);                                                      \
+        if (surgeTraceText_)                                                                       \
+            ZoneText(surgeTraceText_, std::strlen(surgeTraceText_));                               \
+    } while (0)
+#define SURGE_TRACE_FRAME_MARK(name) FrameMarkNamed(name)
+#define SURGE_TRACE_THREAD_NAME(name) tracy::SetThreadName(name)
+#else
+#define SURGE_TRACE_ZONE(name)
+#define SURGE_TRACE_ZONE_TEXT(text)
+#define SURGE_TRACE_FRAME_MARK(name)
+#define SURGE_TRACE_THREAD_NAME(name)
+#endif
+
+#endif // SURGE_SRC_COMMON_SURGETRACE_H
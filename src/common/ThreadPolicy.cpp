@@ -0,0 +1,242 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "ThreadPolicy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#if WINDOWS
+#include <windows.h>
+#elif MAC
+#include <pthread.h>
+#include <pthread/qos.h>
+#include <sys/sysctl.h>
+#elif LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Surge
+{
+namespace Threading
+{
+namespace
+{
+std::mutex policyMutex;
+ThreadPolicy currentPolicy;
+bool setFromCommandLine{false};
+
+#if LINUX && !MAC
+void pinTo(const std::vector<int> &cores)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    bool any{false};
+    for (auto c : cores)
+    {
+        if (c >= 0 && c < CPU_SETSIZE)
+        {
+            CPU_SET(c, &set);
+            any = true;
+        }
+    }
+    if (any)
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#endif
+
+// Every online core but the realtime ones, or nothing if that would leave none
+std::vector<int> otherCores(const std::vector<int> &realtimeCores)
+{
+    std::vector<int> res;
+    auto n = (int)std::thread::hardware_concurrency();
+    for (int c = 0; c < n; ++c)
+        if (std::find(realtimeCores.begin(), realtimeCores.end(), c) == realtimeCores.end())
+            res.push_back(c);
+    return res;
+}
+} // namespace
+
+void setThreadPolicy(const ThreadPolicy &p)
+{
+    std::lock_guard<std::mutex> g(policyMutex);
+    if (!setFromCommandLine)
+        currentPolicy = p;
+}
+
+void setThreadPolicyFromCommandLine(const ThreadPolicy &p)
+{
+    std::lock_guard<std::mutex> g(policyMutex);
+    currentPolicy = p;
+    setFromCommandLine = true;
+}
+
+ThreadPolicy getThreadPolicy()
+{
+    std::lock_guard<std::mutex> g(policyMutex);
+    return currentPolicy;
+}
+
+void applyThreadRole(ThreadRole role, int index)
+{
+    auto p = getThreadPolicy();
+    if (p.isDefault())
+        return;
+
+    std::vector<int> cores;
+    if (role == ThreadRole::Realtime && !p.realtimeCores.empty())
+        cores.push_back(p.realtimeCores[index % p.realtimeCores.size()]);
+    else if (role != ThreadRole::Realtime && !p.realtimeCores.empty())
+        cores = otherCores(p.realtimeCores);
+
+#if WINDOWS
+    auto self = GetCurrentThread();
+    if (role == ThreadRole::Realtime && p.realtimePriority > 0)
+        SetThreadPriority(self, THREAD_PRIORITY_TIME_CRITICAL);
+    if (role == ThreadRole::Loader && p.loaderNice > 0)
+        SetThreadPriority(self, p.loaderNice >= 10 ? THREAD_PRIORITY_LOWEST
+                                                   : THREAD_PRIORITY_BELOW_NORMAL);
+
+    DWORD_PTR mask{0};
+    for (auto c : cores)
+        if (c >= 0 && c < (int)sizeof(DWORD_PTR) * 8)
+            mask |= (DWORD_PTR)1 << c;
+    if (mask)
+        SetThreadAffinityMask(self, mask);
+#elif MAC
+    // macOS has no way to pin a thread, so the cores are left to it
+    if (role == ThreadRole::Realtime && p.realtimePriority > 0)
+        pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+    if (role == ThreadRole::Loader && p.loaderNice > 0)
+        pthread_set_qos_class_self_np(
+            p.loaderNice >= 10 ? QOS_CLASS_BACKGROUND : QOS_CLASS_UTILITY, 0);
+#elif LINUX
+    if (role == ThreadRole::Realtime && p.realtimePriority > 0)
+    {
+        sched_param sp{};
+        sp.sched_priority =
+            std::clamp(p.realtimePriority, sched_get_priority_min(SCHED_FIFO),
+                       sched_get_priority_max(SCHED_FIFO));
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    }
+    // Linux niceness is per thread, when given the thread's own id
+    if (role == ThreadRole::Loader && p.loaderNice > 0)
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), std::min(p.loaderNice, 19));
+
+    pinTo(cores);
+#endif
+}
+
+int physicalCoreCount()
+{
+    auto logical = std::max(1, (int)std::thread::hardware_concurrency());
+    int res{0};
+
+#if WINDOWS
+    DWORD len{0};
+    GetLogicalProcessorInformation(nullptr, &len);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(
+        len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &len))
+        for (auto &i : info)
+            if (i.Relationship == RelationProcessorCore)
+                res++;
+#elif MAC
+    int n{0};
+    size_t len = sizeof(n);
+    if (sysctlbyname("hw.physicalcpu", &n, &len, nullptr, 0) == 0)
+        res = n;
+#elif LINUX
+    // siblings share a core id within their package
+    std::set<std::pair<int, int>> cores;
+    for (int c = 0; c < logical; ++c)
+    {
+        auto dir = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        std::ifstream pkg(dir + "physical_package_id"), core(dir + "core_id");
+        int p{-1}, i{-1};
+        if (pkg >> p && core >> i)
+            cores.insert({p, i});
+    }
+    res = (int)cores.size();
+#endif
+
+    return res > 0 ? std::min(res, logical) : logical;
+}
+
+std::vector<int> parseCoreList(const std::string &s)
+{
+    std::vector<int> res;
+    std::istringstream iss(s);
+    std::string item;
+
+    while (std::getline(iss, item, ','))
+    {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty() || !std::all_of(item.begin(), item.end(), [](char c) {
+                return std::isdigit((unsigned char)c) || c == '-';
+            }))
+            continue;
+
+        auto dash = item.find('-');
+        try
+        {
+            if (dash == std::string::npos)
+            {
+                res.push_back(std::stoi(item));
+            }
+            else
+            {
+                auto from = std::stoi(item.substr(0, dash));
+                auto to = std::stoi(item.substr(dash + 1));
+                // a range longer than any machine has cores is a typo
+                for (int c = from; c <= to && c - from < 1024; ++c)
+                    res.push_back(c);
+            }
+        }
+        catch (const std::exception &)
+        {
+        }
+    }
+
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+std::string coreListToString(const std::vector<int> &cores)
+{
+    std::ostringstream oss;
+    for (size_t i = 0; i < cores.size(); ++i)
+        oss << (i ? "," : "") << cores[i];
+    return oss.str();
+}
+} // namespace Threading
+} // namespace Surge
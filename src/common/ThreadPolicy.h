@@ -0,0 +1,103 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+
+#ifndef SURGE_SRC_COMMON_THREADPOLICY_H
+#define SURGE_SRC_COMMON_THREADPOLICY_H
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * Every thread Surge starts for itself takes one of these roles, and applies it first thing:
+ *
+ * - Realtime threads are the worker pool ones which render voices and effects for the audio
+ *   thread, and the command line's offline renderers. The audio thread itself belongs to the
+ *   host, which has set it up already
+ * - Loaders read and parse patches, wavetables and impulse responses and write settings, the
+ *   work which can happily wait behind the audio
+ * - Helpers do the GUI's analysis and drawing sums and feed the recorders
+ *
+ * By default all of it is left to the OS. The policy can instead run realtime threads on the
+ * SCHED_FIFO priority given (or the nearest the OS has), pin them round robin to a list of
+ * cores, keep everything else off those cores, and lower the loaders by a nice amount. Anything
+ * the OS refuses, like realtime priority without the rights to it, is quietly skipped. The
+ * policy is process wide and applies to threads started after it is set; it is read from the
+ * user defaults when a SurgeStorage is made, unless the command line set it first.
+ */
+enum class ThreadRole
+{
+    Realtime,
+    Loader,
+    Helper,
+};
+
+struct ThreadPolicy
+{
+    // 0 leaves realtime threads at the OS default, otherwise 1 to 99
+    int realtimePriority{0};
+    std::vector<int> realtimeCores;
+    // 0 leaves loaders at the OS default, otherwise 1 to 19
+    int loaderNice{0};
+
+    bool isDefault() const
+    {
+        return realtimePriority == 0 && realtimeCores.empty() && loaderNice == 0;
+    }
+};
+
+void setThreadPolicy(const ThreadPolicy &p);
+// which the user defaults can't then change
+void setThreadPolicyFromCommandLine(const ThreadPolicy &p);
+ThreadPolicy getThreadPolicy();
+
+// Sets the calling thread up for its role. index picks the core of a pinned realtime thread.
+void applyThreadRole(ThreadRole role, int index = 0);
+
+template <typename F> std::thread makeThread(ThreadRole role, F &&body)
+{
+    return std::thread([role, body = std::forward<F>(body)]() mutable {
+        applyThreadRole(role);
+        body();
+    });
+}
+
+/*
+ * Cores rather than hardware threads, since two busy SMT siblings barely beat one, or
+ * hardware_concurrency when the OS won't say. Always at least 1.
+ */
+int physicalCoreCount();
+
+// "2,3,6-7" to {2, 3, 6, 7}, skipping anything which isn't a core number or a range of them
+std::vector<int> parseCoreList(const std::string &s);
+std::string coreListToString(const std::vector<int> &cores);
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_THREADPOLICY_H
@@ -21,8 +21,10 @@
  */
 #include "UserDefaults.h"
 #include "SurgeStorage.h"
+#include "ThreadPolicy.h"
 
 #include <string>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <map>
@@ -31,6 +33,14 @@
 
 #include "filesystem/import.h"
 
+#if WINDOWS
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
 namespace Surge
 {
 namespace Storage
@@ -66,6 +76,9 @@ std::string defaultKeyToString(DefaultKey k)
     case MIDISoftTakeover:
         r = "MIDISoftTakeover";
         break;
+    case SampleAccurateNoteOns:
+        r = "sampleAccurateNoteOns";
+        break;
     case RestoreMSEGSnapFromPatch:
         r = "restoreMSEGSnapFromPatch";
         break;
@@ -118,6 +131,9 @@ std::string defaultKeyToString(DefaultKey k)
     case RetainPatchSearchboxAfterLoad:
         r = "retainPatchSearchboxAfterLoad";
         break;
+    case PlayPatchPreviewsInSearch:
+        r = "playPatchPreviewsInSearch";
+        break;
     case OverrideTuningOnPatchLoad:
         r = "overrideTuningOnPatchLoad";
         break;
@@ -172,6 +188,9 @@ std::string defaultKeyToString(DefaultKey k)
     case LastWavetablePath:
         r = "lastWavetablePath";
         break;
+    case LastImpulseResponsePath:
+        r = "lastImpulseResponsePath";
+        break;
     // TODO: remove in XT2
     case TabKeyArmsModulators:
         r = "tabKeyArmsModulators";
@@ -374,6 +393,18 @@ std::string defaultKeyToString(DefaultKey k)
         r = "openSoundControlIPAddrOut";
         break;
 
+    case OSCOutCoalesceMS:
+        r = "openSoundControlOutCoalesceMS";
+        break;
+
+    case OSCOutBundleBytes:
+        r = "openSoundControlOutBundleBytes";
+        break;
+
+    case OSCOutMaxPacketsPerSecond:
+        r = "openSoundControlOutMaxPacketsPerSecond";
+        break;
+
     case StartOSCIn:
         r = "startOSCIn";
         break;
@@ -382,12 +413,514 @@ std::string defaultKeyToString(DefaultKey k)
         r = "startOSCOut";
         break;
 
+    case MultithreadedSceneRendering:
+        r = "multithreadedSceneRendering";
+        break;
+    case MultithreadedVoiceRendering:
+        r = "multithreadedVoiceRendering";
+        break;
+    case MultithreadedEffectRendering:
+        r = "multithreadedEffectRendering";
+        break;
+    case EffectOversampling:
+        r = "effectOversampling";
+        break;
+    case AdaptEffectsToLoad:
+        r = "adaptEffectsToLoad";
+        break;
+    case DegradeQualityUnderLoad:
+        r = "degradeQualityUnderLoad";
+        break;
+    case CacheBuiltWavetables:
+        r = "cacheBuiltWavetables";
+        break;
+    case CompactWavetables:
+        r = "compactWavetables";
+        break;
+    case SilentVoiceThreshold:
+        r = "silentVoiceThreshold";
+        break;
+    case LargePageAllocation:
+        r = "largePageAllocation";
+        break;
+    case FreezeVoicesBudget:
+        r = "freezeVoicesBudget";
+        break;
+    case ThreadRealtimePriority:
+        r = "threadRealtimePriority";
+        break;
+    case ThreadRealtimeCores:
+        r = "threadRealtimeCores";
+        break;
+    case ThreadLoaderNice:
+        r = "threadLoaderNice";
+        break;
+
     case nKeys:
         break;
     }
     return r;
 }
 
+namespace
+{
+// held for the length of a save, so only one instance writes the defaults at a time
+struct DefaultsFileLock
+{
+    explicit DefaultsFileLock(const fs::path &p)
+    {
+#if WINDOWS
+        handle = CreateFileW(p.wstring().c_str(), GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle != INVALID_HANDLE_VALUE)
+        {
+            OVERLAPPED ov{};
+            if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov))
+            {
+                CloseHandle(handle);
+                handle = INVALID_HANDLE_VALUE;
+            }
+        }
+#else
+        fd = open(p.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd >= 0 && flock(fd, LOCK_EX) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+    ~DefaultsFileLock()
+    {
+#if WINDOWS
+        if (handle != INVALID_HANDLE_VALUE)
+        {
+            OVERLAPPED ov{};
+            UnlockFileEx(handle, 0, 1, 0, &ov);
+            CloseHandle(handle);
+        }
+#else
+        if (fd >= 0)
+        {
+            flock(fd, LOCK_UN);
+            close(fd);
+        }
+#endif
+    }
+
+    /*
+     * Where locking isn't possible (a read-only or network directory, say) we still save,
+     * just without protection from the other instances, which is what we always did
+     */
+#if WINDOWS
+    HANDLE handle{INVALID_HANDLE_VALUE};
+#else
+    int fd{-1};
+#endif
+};
+
+} // namespace
+
+UserDefaultsProvider::UserDefaultsProvider(const fs::path &defaultsDirectory,
+                                           const std::string &productName,
+                                           const keyToString_t &keyToString,
+                                           const errorHandler_t &errorHandler)
+    : defaultsDirectory(defaultsDirectory), productName(productName), errorHandler(errorHandler)
+{
+    defaultsFile = defaultsDirectory / (productName + "UserDefaults.xml");
+    lockFile = defaultsDirectory / (productName + "UserDefaults.lock");
+
+    for (int k = 0; k < nKeys; ++k)
+    {
+        keysToStrings[(DefaultKey)k] = keyToString((DefaultKey)k);
+    }
+
+    for (const auto &p : keysToStrings)
+    {
+        stringsToKeys[p.second] = p.first;
+    }
+
+    contents = readDefaultsFile();
+}
+
+UserDefaultsProvider::~UserDefaultsProvider()
+{
+    {
+        std::lock_guard<std::mutex> g(dataMutex);
+        stopSaver = true;
+    }
+    saverCV.notify_all();
+
+    if (saver.joinable())
+    {
+        saver.join();
+    }
+
+    if (hasUnsavedChanges())
+    {
+        flush();
+    }
+}
+
+std::string UserDefaultsProvider::getUserDefaultValue(const DefaultKey &key,
+                                                      const std::string &valueIfMissing,
+                                                      bool potentiallyRead)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+
+    auto o = overrides.find(key);
+    if (o != overrides.end())
+    {
+        return o->second.second;
+    }
+
+    auto c = contents.find(key);
+    if (c == contents.end() || c->second.type != Value::ud_string)
+    {
+        return valueIfMissing;
+    }
+
+    return c->second.value;
+}
+
+int UserDefaultsProvider::getUserDefaultValue(const DefaultKey &key, int valueIfMissing,
+                                              bool potentiallyRead)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+
+    auto o = overrides.find(key);
+    if (o != overrides.end())
+    {
+        return o->second.first;
+    }
+
+    auto c = contents.find(key);
+    if (c == contents.end() || c->second.type != Value::ud_int)
+    {
+        return valueIfMissing;
+    }
+
+    return std::atoi(c->second.value.c_str());
+}
+
+std::pair<int, int> UserDefaultsProvider::getUserDefaultValue(
+    const DefaultKey &key, const std::pair<int, int> &valueIfMissing, bool potentiallyRead)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+
+    auto c = contents.find(key);
+    if (c == contents.end() || c->second.type != Value::ud_pair)
+    {
+        return valueIfMissing;
+    }
+
+    return c->second.vpair;
+}
+
+bool UserDefaultsProvider::updateUserDefaultValue(const DefaultKey &key, const std::string &value)
+{
+    Value v;
+    v.type = Value::ud_string;
+    v.value = value;
+    return store(key, v);
+}
+
+bool UserDefaultsProvider::updateUserDefaultValue(const DefaultKey &key, int value)
+{
+    Value v;
+    v.type = Value::ud_int;
+    v.value = std::to_string(value);
+    return store(key, v);
+}
+
+bool UserDefaultsProvider::updateUserDefaultValue(const DefaultKey &key,
+                                                  const std::pair<int, int> &value)
+{
+    Value v;
+    v.type = Value::ud_pair;
+    v.vpair = value;
+    return store(key, v);
+}
+
+void UserDefaultsProvider::addOverride(DefaultKey key, const std::string &s)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+    overrides[key] = {0, s};
+}
+
+void UserDefaultsProvider::addOverride(DefaultKey key, int i)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+    overrides[key] = {i, ""};
+}
+
+void UserDefaultsProvider::clearOverride(DefaultKey key)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+    overrides.erase(key);
+}
+
+bool UserDefaultsProvider::store(const DefaultKey &key, const Value &v)
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    if (unsaved.empty())
+    {
+        firstUnsavedUpdate = now;
+    }
+    lastUpdate = now;
+
+    contents[key] = v;
+    unsaved.insert(key);
+    saveFailed = false;
+
+    if (!saver.joinable() && !stopSaver)
+    {
+        saver = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Loader,
+                                             [this]() { saverLoop(); });
+    }
+
+    saverCV.notify_all();
+    return true;
+}
+
+void UserDefaultsProvider::saverLoop()
+{
+    std::unique_lock<std::mutex> g(dataMutex);
+
+    while (!stopSaver)
+    {
+        if (unsaved.empty() || saveFailed)
+        {
+            saverCV.wait(g);
+            continue;
+        }
+
+        auto due = std::min(lastUpdate + std::chrono::milliseconds(saveDebounceMs),
+                            firstUnsavedUpdate + std::chrono::milliseconds(saveAtLeastEveryMs));
+
+        if (std::chrono::steady_clock::now() < due)
+        {
+            saverCV.wait_until(g, due);
+            continue;
+        }
+
+        g.unlock();
+        flush();
+        g.lock();
+    }
+}
+
+bool UserDefaultsProvider::hasUnsavedChanges()
+{
+    std::lock_guard<std::mutex> g(dataMutex);
+    return !unsaved.empty();
+}
+
+bool UserDefaultsProvider::flush()
+{
+    std::lock_guard<std::mutex> sg(saveMutex);
+
+    std::map<DefaultKey, Value> changes;
+    {
+        std::lock_guard<std::mutex> g(dataMutex);
+        for (auto k : unsaved)
+        {
+            changes[k] = contents[k];
+        }
+        unsaved.clear();
+    }
+
+    if (changes.empty())
+    {
+        return true;
+    }
+
+    std::map<DefaultKey, Value> merged;
+    bool ok = false;
+
+    try
+    {
+        fs::create_directories(defaultsDirectory);
+
+        DefaultsFileLock lock(lockFile);
+
+        // another instance may have saved since we last looked
+        merged = readDefaultsFile();
+        for (const auto &c : changes)
+        {
+            merged[c.first] = c.second;
+        }
+
+        ok = writeDefaultsFile(merged);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        errorHandler(e.what(), "UserDefaults");
+    }
+
+    std::lock_guard<std::mutex> g(dataMutex);
+
+    if (ok)
+    {
+        // take what the other instances saved, but not over anything updated meanwhile
+        for (const auto &m : merged)
+        {
+            if (unsaved.find(m.first) == unsaved.end())
+            {
+                contents[m.first] = m.second;
+            }
+        }
+    }
+    else
+    {
+        for (const auto &c : changes)
+        {
+            unsaved.insert(c.first);
+        }
+        saveFailed = true;
+    }
+
+    return ok;
+}
+
+std::map<DefaultKey, UserDefaultsProvider::Value> UserDefaultsProvider::readDefaultsFile()
+{
+    std::map<DefaultKey, Value> res;
+
+    if (!fs::exists(defaultsFile))
+    {
+        return res;
+    }
+
+    TiXmlDocument defaultsLoader;
+    defaultsLoader.LoadFile(defaultsFile);
+    TiXmlElement *e = TINYXML_SAFE_TO_ELEMENT(defaultsLoader.FirstChild("defaults"));
+
+    if (!e)
+    {
+        return res;
+    }
+
+    const char *version = e->Attribute("version");
+    if (!version || strcmp(version, "1") != 0)
+    {
+        std::ostringstream oss;
+        oss << "This version of " << productName
+            << " reads only version 1 defaults. Your user defaults version is "
+            << (version ? version : "missing") << ". Defaults will be ignored!";
+        errorHandler(oss.str(), "File Version Error");
+        return res;
+    }
+
+    TiXmlElement *def = TINYXML_SAFE_TO_ELEMENT(e->FirstChild("default"));
+    while (def)
+    {
+        Value v;
+        int vt = 0;
+        def->Attribute("type", &vt);
+        v.type = (Value::Type)vt;
+
+        auto keyString = def->Attribute("key");
+
+        if (v.type == Value::ud_pair)
+        {
+            auto first = def->Attribute("firstvalue"), second = def->Attribute("secondvalue");
+            v.vpair.first = first ? std::atoi(first) : 0;
+            v.vpair.second = second ? std::atoi(second) : 0;
+        }
+        else if (auto value = def->Attribute("value"))
+        {
+            v.value = value;
+        }
+
+        // silently disregard default keys we don't recognize
+        auto k = keyString ? stringsToKeys.find(keyString) : stringsToKeys.end();
+        if (k != stringsToKeys.end())
+        {
+            res[k->second] = v;
+        }
+
+        def = TINYXML_SAFE_TO_ELEMENT(def->NextSibling("default"));
+    }
+
+    return res;
+}
+
+bool UserDefaultsProvider::writeDefaultsFile(const std::map<DefaultKey, Value> &from)
+{
+    /*
+     * For now, the format of our defaults file is so simple that we don't need to mess
+     * around with tinyxml to create it, just to parse it
+     */
+    auto temp = defaultsFile;
+    temp += ".tmp";
+
+    {
+        std::ofstream dFile(temp);
+        if (!dFile.is_open())
+        {
+            std::ostringstream emsg;
+            emsg << "Unable to open defaults file '" << defaultsFile.u8string()
+                 << "' for writing.";
+            errorHandler(emsg.str(), "Defaults Not Saved");
+            return false;
+        }
+
+        dFile << "<?xml version = \"1.0\" encoding = \"UTF-8\" ?>\n"
+              << "<!-- User Defaults for Surge XT Synthesizer -->\n"
+              << "<defaults version=\"1\">" << std::endl;
+
+        for (const auto &el : from)
+        {
+            if (el.second.type == Value::ud_pair)
+            {
+                dFile << "  <default key=\"" << keysToStrings[el.first] << "\" firstvalue=\""
+                      << el.second.vpair.first << "\" secondvalue=\"" << el.second.vpair.second
+                      << "\" type=\"" << (int)el.second.type << "\"/>\n";
+            }
+            else
+            {
+                dFile << "  <default key=\"" << keysToStrings[el.first] << "\" value=\""
+                      << el.second.value << "\" type=\"" << (int)el.second.type << "\"/>\n";
+            }
+        }
+
+        dFile << "</defaults>" << std::endl;
+
+        if (!dFile.good())
+        {
+            errorHandler("Unable to write defaults file '" + path_to_string(defaultsFile) + "'.",
+                         "Defaults Not Saved");
+            dFile.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+
+    // someone reading the file as we rename may hold it open on Windows, so try a few times
+    std::error_code ec;
+    for (int attempt = 0; attempt < 5; ++attempt)
+    {
+        fs::rename(temp, defaultsFile, ec);
+        if (!ec)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    errorHandler("Unable to replace defaults file '" + path_to_string(defaultsFile) +
+                     "': " + ec.message(),
+                 "Defaults Not Saved");
+    fs::remove(temp, ec);
+    return false;
+}
+
 /*
 ** Functions from the header
 */
@@ -22,10 +22,16 @@
 #ifndef SURGE_SRC_COMMON_USERDEFAULTS_H
 #define SURGE_SRC_COMMON_USERDEFAULTS_H
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <filesystem/import.h>
-#include "sst/plugininfra/userdefaults.h"
 
 /*
 ** Surge has a variety of settings which users can update and save across sessions.
@@ -80,6 +86,7 @@ enum DefaultKey
     ActivateExtraOutputs, // TODO: remove in XT2
     PatchJogWraparound,
     RetainPatchSearchboxAfterLoad,
+    PlayPatchPreviewsInSearch,
     PromptToLoadOverDirtyPatch,
     TabKeyArmsModulators, // TODO: remove in XT2
     UseKeyboardShortcuts_Plugin,
@@ -98,6 +105,7 @@ enum DefaultKey
     UseCh2Ch3ToPlayScenesIndividually,
     MenuBasedMIDILearnChannel,
     MIDISoftTakeover,
+    SampleAccurateNoteOns,
 
     SmoothingMode,
     MonoPedalMode,
@@ -112,6 +120,7 @@ enum DefaultKey
     LastKBMPath,
     LastWavetablePath,
     LastPatchPath,
+    LastImpulseResponsePath,
 
     PromptToActivateShortcutsOnAccKeypress,
     PromptToActivateCategoryAndPatchOnKeypress,
@@ -178,12 +187,121 @@ enum DefaultKey
     OSCPortIn,
     OSCPortOut,
     OSCIPOut,
+    OSCOutCoalesceMS,
+    OSCOutBundleBytes,
+    OSCOutMaxPacketsPerSecond,
+
+    // engine performance options
+    MultithreadedSceneRendering,
+    MultithreadedVoiceRendering,
+    MultithreadedEffectRendering,
+    EffectOversampling,
+    AdaptEffectsToLoad,
+    DegradeQualityUnderLoad,
+    CacheBuiltWavetables,
+    CompactWavetables,
+    SilentVoiceThreshold,
+    LargePageAllocation,
+    FreezeVoicesBudget,
+    ThreadRealtimePriority,
+    ThreadRealtimeCores,
+    ThreadLoaderNice,
 
     nKeys
 };
 
 std::string defaultKeyToString(DefaultKey k);
-typedef sst::plugininfra::defaults::Provider<DefaultKey, DefaultKey::nKeys> UserDefaultsProvider;
+
+/*
+ * Holds the user defaults for a SurgeStorage and keeps <product>UserDefaults.xml up to date.
+ * An update lands in memory straight away, and a writer thread saves once updates have stopped
+ * coming for saveDebounceMs, so a burst of them (dragging the zoom, say) costs one write and
+ * none of it happens on the thread that made the change.
+ *
+ * Several instances share the file. A save takes a lock on a file next to it, re-reads it to
+ * pick up what the others saved, lays the keys this instance changed over that, and renames
+ * the result into place, so nobody loses their changes to another instance or reads half a
+ * file.
+ */
+class UserDefaultsProvider
+{
+  public:
+    typedef std::function<std::string(DefaultKey)> keyToString_t;
+    typedef std::function<void(const std::string &, const std::string &)> errorHandler_t;
+
+    UserDefaultsProvider(const fs::path &defaultsDirectory, const std::string &productName,
+                         const keyToString_t &keyToString, const errorHandler_t &errorHandler);
+    // saves whatever is still waiting
+    ~UserDefaultsProvider();
+
+    /*
+     * The file is read when the provider is made and again at each save, so potentiallyRead
+     * no longer does anything; it stays for the callers.
+     */
+    std::string getUserDefaultValue(const DefaultKey &key, const std::string &valueIfMissing,
+                                    bool potentiallyRead = true);
+    int getUserDefaultValue(const DefaultKey &key, int valueIfMissing,
+                            bool potentiallyRead = true);
+    std::pair<int, int> getUserDefaultValue(const DefaultKey &key,
+                                            const std::pair<int, int> &valueIfMissing,
+                                            bool potentiallyRead = true);
+
+    bool updateUserDefaultValue(const DefaultKey &key, const std::string &value);
+    bool updateUserDefaultValue(const DefaultKey &key, int value);
+    bool updateUserDefaultValue(const DefaultKey &key, const std::pair<int, int> &value);
+
+    // answer with these rather than what is stored, without storing anything
+    void addOverride(DefaultKey key, const std::string &s);
+    void addOverride(DefaultKey key, int i);
+    void clearOverride(DefaultKey key);
+
+    // save what is waiting now, on this thread. False if the file couldn't be written
+    bool flush();
+    bool hasUnsavedChanges();
+
+    const fs::path &getDefaultsFile() const { return defaultsFile; }
+
+    static constexpr int saveDebounceMs = 250;
+    // a steady stream of updates still gets saved at least this often
+    static constexpr int saveAtLeastEveryMs = 2000;
+
+  private:
+    struct Value
+    {
+        enum Type
+        {
+            ud_string = 1,
+            ud_int = 2,
+            ud_pair = 3
+        } type{ud_string};
+
+        std::string value;
+        std::pair<int, int> vpair{0, 0};
+    };
+
+    std::map<DefaultKey, Value> readDefaultsFile();
+    bool writeDefaultsFile(const std::map<DefaultKey, Value> &from);
+    bool store(const DefaultKey &key, const Value &v);
+    void saverLoop();
+
+    fs::path defaultsDirectory, defaultsFile, lockFile;
+    std::string productName;
+    errorHandler_t errorHandler;
+    std::map<DefaultKey, std::string> keysToStrings;
+    std::map<std::string, DefaultKey> stringsToKeys;
+
+    std::mutex dataMutex, saveMutex;
+    std::map<DefaultKey, Value> contents;
+    std::map<DefaultKey, std::pair<int, std::string>> overrides;
+    std::set<DefaultKey> unsaved;
+    std::chrono::steady_clock::time_point lastUpdate, firstUnsavedUpdate;
+    // a save failed, so wait for another update (or a flush) rather than retrying in a loop
+    bool saveFailed{false};
+
+    std::condition_variable saverCV;
+    std::thread saver; // started by the first update
+    bool stopSaver{false};
+};
 
 /**
  * getUserDefaultValue
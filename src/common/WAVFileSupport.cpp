@@ -29,6 +29,7 @@
 #include <cstring>
 
 #include "filesystem/import.h"
+#include "MappedFile.h"
 
 // Sigh - lets write a portable ntol by hand
 unsigned int pl_int(char *d)
@@ -44,6 +45,16 @@ bool four_chars(char *v, char a, char b, char c, char d)
     return v[0] == a && v[1] == b && v[2] == c && v[3] == d;
 }
 
+// Every stride'th sample from src, which may be unaligned, into dst, which is not
+template <typename T> void firstChannel(const char *src, char *dst, size_t n, int stride)
+{
+    auto d = reinterpret_cast<T *>(dst);
+    auto step = stride * sizeof(T);
+
+    for (size_t i = 0; i < n; ++i)
+        std::memcpy(&d[i], src + i * step, sizeof(T));
+}
+
 bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
 {
     std::string uitag = "Wavetable Import Error";
@@ -53,9 +64,13 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
     std::cout << "  fn = '" << fn << "'" << std::endl;
 #endif
 
-    std::filebuf fp;
+    /*
+     * The file is mapped rather than read, and the chunks are parsed where they lie, so the
+     * chunks we skip are never even paged in and a mono data chunk goes to BuildWT untouched.
+     */
+    Surge::Storage::MappedFile file(string_to_path(fn));
 
-    if (!fp.open(string_to_path(fn), std::ios::binary | std::ios::in))
+    if (!file.isOpen())
     {
         std::ostringstream oss;
         oss << "Unable to open file '" << fn << "'!";
@@ -63,13 +78,7 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
         return false;
     }
 
-    char riff[4], szd[4], wav[4];
-    auto hds = fp.sgetn(riff, sizeof(riff));
-
-    hds += fp.sgetn(szd, sizeof(szd));
-    hds += fp.sgetn(wav, sizeof(wav));
-
-    if (hds != 12)
+    if (file.size() < 12)
     {
         std::ostringstream oss;
         oss << "'" << fn << "' does not contain a valid RIFF header chunk!";
@@ -77,6 +86,9 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
         return false;
     }
 
+    auto riff = const_cast<char *>(file.data());
+    auto wav = riff + 8;
+
     if (!four_chars(riff, 'R', 'I', 'F', 'F') && !four_chars(wav, 'W', 'A', 'V', 'E'))
     {
         std::ostringstream oss;
@@ -87,9 +99,9 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
     }
 
     // WAV HEADER
-    unsigned short audioFormat, numChannels{1};
+    unsigned short audioFormat{0}, numChannels{1};
     unsigned int sampleRate, byteRate;
-    unsigned short blockAlign, bitsPerSample;
+    unsigned short blockAlign, bitsPerSample{0};
 
     // Result of data read
     bool hasSMPL = false;
@@ -102,25 +114,16 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
     int cueLEN = 0;
     int srgeLEN = 0;
 
-    // Now start reading chunks
-    int tbr = 4;
-    char *wavdata{nullptr};
-    int datasz{0}, datasamples{0};
+    // Now walk the chunks in place
+    const char *wavdata{nullptr};
+    size_t datasz{0};
+    int datasamples{0};
 
-    while (true)
+    size_t pos = 12;
+    while (pos + 8 <= file.size())
     {
-        char chunkType[4], chunkSzD[4];
-        int br;
-
-        if (fp.sgetn(chunkType, sizeof(chunkType)) != sizeof(chunkType))
-        {
-            break;
-        }
-
-        br = fp.sgetn(chunkSzD, sizeof(chunkSzD));
-
-        // FIXME - deal with br
-        int cs = pl_int(chunkSzD);
+        auto chunkType = riff + pos;
+        size_t cs = pl_int(chunkType + 4);
 
         // RIFF requires all chunks to be in 2 byte sizes
         if (cs % 2 == 1)
@@ -133,19 +136,14 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
         std::cout << "\'  sz = " << cs << std::endl;
 #endif
 
-        tbr += 8 + cs;
-
-        char *data = (char *)malloc(cs);
-        br = fp.sgetn(data, cs);
-
-        if (br != cs)
-        {
-            free(data);
-
+        // a truncated chunk ends the file, as a short read always has
+        if (cs > file.size() - pos - 8)
             break;
-        }
 
-        if (four_chars(chunkType, 'f', 'm', 't', ' '))
+        char *data = chunkType + 8;
+        pos += 8 + cs;
+
+        if (four_chars(chunkType, 'f', 'm', 't', ' ') && cs >= 16)
         {
             char *dp = data;
             audioFormat = pl_short(dp);
@@ -166,11 +164,10 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                       << bitsPerSample << " bits" << std::endl;
 #endif
 
-            free(data);
-
             // Do a format check here to bail out
             if (!((((audioFormat == 1 /* WAVE_FORMAT_PCM */) && (bitsPerSample == 16)) ||
-                   ((audioFormat == 3 /* IEEE_FLOAT */) && (bitsPerSample == 32)))))
+                   ((audioFormat == 3 /* IEEE_FLOAT */) && (bitsPerSample == 32)))) ||
+                numChannels == 0)
             {
                 std::string formname = "Unknown (" + std::to_string(audioFormat) + ")";
 
@@ -190,7 +187,7 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                 return false;
             }
         }
-        else if (four_chars(chunkType, 'c', 'l', 'm', ' '))
+        else if (four_chars(chunkType, 'c', 'l', 'm', ' ') && cs >= 7)
         {
             // These all begin '<!>dddd' where d is 2048 it seems
             char *dp = data + 3;
@@ -200,38 +197,33 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                 hasCLM = true;
                 clmLEN = 2048;
             }
-            free(data);
         }
         else if (four_chars(chunkType, 'u', 'h', 'W', 'T'))
         {
             // This is HIVE metadata so treat it just like CLM / Serum
             hasCLM = true;
             clmLEN = 2048;
-
-            free(data);
         }
-        else if (four_chars(chunkType, 's', 'r', 'g', 'e'))
+        else if (four_chars(chunkType, 's', 'r', 'g', 'e') && cs >= 8)
         {
             hasSRGE = true;
             char *dp = data;
             int version = pl_int(dp);
             dp += 4;
             srgeLEN = pl_int(dp);
-            free(data);
         }
-        else if (four_chars(chunkType, 's', 'r', 'g', 'o'))
+        else if (four_chars(chunkType, 's', 'r', 'g', 'o') && cs >= 8)
         {
             hasSRGO = true;
             char *dp = data;
             int version = pl_int(dp);
             dp += 4;
             srgeLEN = pl_int(dp);
-            free(data);
         }
-        else if (four_chars(chunkType, 'c', 'u', 'e', ' '))
+        else if (four_chars(chunkType, 'c', 'u', 'e', ' ') && cs >= 4)
         {
             char *dp = data;
-            int numCues = pl_int(dp);
+            size_t numCues = std::min((size_t)pl_int(dp), (cs - 4) / 24);
 
             dp += 4;
 
@@ -270,16 +262,13 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                 hasCUE = true;
                 cueLEN = d;
             }
-
-            free(data);
         }
         else if (four_chars(chunkType, 'd', 'a', 't', 'a'))
         {
             datasz = cs;
-            datasamples = cs * 8 / bitsPerSample / numChannels;
             wavdata = data;
         }
-        else if (four_chars(chunkType, 's', 'm', 'p', 'l'))
+        else if (four_chars(chunkType, 's', 'm', 'p', 'l') && cs >= 36)
         {
             char *dp = data;
             unsigned int samplechunk[9];
@@ -310,7 +299,7 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                 // FIXME
             }
 
-            for (int i = 0; i < nloops && i < 1; ++i)
+            for (int i = 0; i < nloops && i < 1 && cs >= 36 + 24; ++i)
             {
                 unsigned int loopdata[6];
 
@@ -331,19 +320,23 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
                     smplLEN = 2048;
             }
         }
+#if WAV_STDOUT_INFO
         else
         {
-#if WAV_STDOUT_INFO
             std::cout << "Default Dump\n";
 
             for (int i = 0; i < cs; ++i)
                 std::cout << data[i] << std::endl;
-#endif
-
-            free(data);
         }
+#endif
     }
 
+    // the fmt chunk is allowed to come after the data
+    if (wavdata && bitsPerSample > 0)
+        datasamples = datasz * 8 / bitsPerSample / numChannels;
+    else
+        wavdata = nullptr;
+
 #if WAV_STDOUT_INFO
     std::cout << "  hasCLM  = " << hasCLM << " / " << clmLEN << std::endl;
     std::cout << "  hasCUE  = " << hasCUE << " / " << cueLEN << std::endl;
@@ -371,9 +364,6 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
 
         reportError(oss.str(), uitag);
 
-        if (wavdata)
-            free(wavdata);
-
         return false;
     }
 
@@ -452,9 +442,6 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
             << " samples. '" << fn << "'";
         reportError(oss.str(), uitag);
 
-        if (wavdata)
-            free(wavdata);
-
         return false;
     }
 
@@ -496,11 +483,6 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
 
         reportError(oss.str(), uitag);
 
-        if (wavdata)
-        {
-            free(wavdata);
-        }
-
         return false;
     }
 
@@ -510,35 +492,27 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
         {
             wh.flags |= wtf_int16_is_16;
         }
-        if (numChannels == 1)
-        {
-            waveTableDataMutex.lock();
-            wt->BuildWT(wavdata, wh, wh.flags & wtf_is_sample);
-            waveTableDataMutex.unlock();
-        }
-        else
-        {
-            char *leftChannel;
-            auto memsize = datasamples * bitsPerSample / 8;
-
-            leftChannel = (char *)malloc(memsize * sizeof(char));
 
-            for (size_t i = 0; i < datasamples; ++i)
-            {
-                size_t destAddr = i * bitsPerSample / 8;
-                size_t srcAddr = i * bitsPerSample / 8 * numChannels;
+        // BuildWT only reads its source, so a mono chunk can go straight from the mapping
+        auto bytesPerSample = bitsPerSample / 8;
+        auto source = wavdata;
+        std::vector<char> leftChannel;
 
-                std::memcpy(leftChannel + destAddr, wavdata + srcAddr, bitsPerSample / 8);
-            }
+        if (numChannels > 1 || (uintptr_t)wavdata % bytesPerSample != 0)
+        {
+            leftChannel.resize((size_t)datasamples * bytesPerSample);
 
-            waveTableDataMutex.lock();
-            wt->BuildWT(leftChannel, wh, wh.flags & wtf_is_sample);
-            waveTableDataMutex.unlock();
+            if (bytesPerSample == 2)
+                firstChannel<int16_t>(wavdata, leftChannel.data(), datasamples, numChannels);
+            else
+                firstChannel<int32_t>(wavdata, leftChannel.data(), datasamples, numChannels);
 
-            free(leftChannel);
+            source = leftChannel.data();
         }
 
-        free(wavdata);
+        waveTableDataMutex.lock();
+        wt->BuildWT(const_cast<char *>(source), wh, wh.flags & wtf_is_sample);
+        waveTableDataMutex.unlock();
     }
 
     return true;
@@ -646,10 +620,20 @@ std::string SurgeStorage::export_wt_wav_portable(std::string fbase, Wavetable *w
         wfp.sputn("data", 4);
         w4i(tableSize);
 
+        std::vector<float> widened(wt->isCompact() ? wt->size : 0);
+
         for (int i = 0; i < wt->n_tables; ++i)
         {
-            wfp.sputn(reinterpret_cast<char *>(wt->TableF32WeakPointers[0][i]),
-                      wt->size * bitsPerSample / 8);
+            auto *table = wt->TableF32WeakPointers[0][i];
+
+            if (wt->isCompact())
+            {
+                for (int s = 0; s < wt->size; ++s)
+                    widened[s] = wt->sampleAt(0, i, s);
+                table = widened.data();
+            }
+
+            wfp.sputn(reinterpret_cast<char *>(table), wt->size * bitsPerSample / 8);
         }
     }
 
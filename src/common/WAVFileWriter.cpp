@@ -0,0 +1,297 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "WAVFileWriter.h"
+#include "ThreadPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Surge
+{
+namespace Storage
+{
+namespace
+{
+void putLE(std::vector<char> &out, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.push_back((char)(v & 255));
+        v >>= 8;
+    }
+}
+
+// everything in front of the audio, with the sizes filled in for dataBytes of it
+std::vector<char> wavHeader(int numChannels, int sampleRate, int bytesPerSample, bool isFloat,
+                            uint64_t dataBytes)
+{
+    std::vector<char> h;
+    h.reserve(44);
+    h.insert(h.end(), {'R', 'I', 'F', 'F'});
+    putLE(h, (uint32_t)(36 + dataBytes), 4);
+    h.insert(h.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    putLE(h, 16, 4);
+    putLE(h, isFloat ? 3 : 1, 2);
+    putLE(h, numChannels, 2);
+    putLE(h, sampleRate, 4);
+    putLE(h, sampleRate * numChannels * bytesPerSample, 4);
+    putLE(h, numChannels * bytesPerSample, 2);
+    putLE(h, bytesPerSample * 8, 2);
+    h.insert(h.end(), {'d', 'a', 't', 'a'});
+    putLE(h, (uint32_t)dataBytes, 4);
+    return h;
+}
+
+constexpr uint64_t maxDataBytes = 0xFFFFFFFFull - 36;
+} // namespace
+
+WAVFileWriter::~WAVFileWriter()
+{
+    if (isOpen())
+    {
+        std::string ignored;
+        close(ignored);
+    }
+}
+
+bool WAVFileWriter::open(const fs::path &path, int nch, int sampleRate, Format fmt,
+                         std::string &errorMessage)
+{
+    if (isOpen() || nch <= 0 || sampleRate <= 0)
+    {
+        errorMessage = "Unable to start a WAV file with these settings!";
+        return false;
+    }
+
+    file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        errorMessage = "Unable to open file " + path.u8string() + "! ";
+        errorMessage += std::strerror(errno);
+        return false;
+    }
+
+    numChannels = nch;
+    format = fmt;
+    bytesPerSample = (fmt == FLOAT32) ? 4 : (fmt == PCM24 ? 3 : 2);
+    dataBytes = 0;
+
+    // the real sizes go in at close
+    auto h = wavHeader(numChannels, sampleRate, bytesPerSample, format == FLOAT32, 0);
+    file.write(h.data(), h.size());
+
+    for (auto &c : chunks)
+    {
+        c.interleaved.assign(chunkFrames * numChannels, 0.f);
+        c.frames = 0;
+    }
+
+    produced = 0;
+    consumed = 0;
+    finishing = false;
+    failed = false;
+    writeError.clear();
+
+    writerThread = std::thread([this, sampleRate]() {
+        Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Helper);
+        writerLoop();
+
+        if (!failed)
+        {
+            auto hdr =
+                wavHeader(numChannels, sampleRate, bytesPerSample, format == FLOAT32, dataBytes);
+            file.seekp(0);
+            file.write(hdr.data(), hdr.size());
+        }
+    });
+
+    return true;
+}
+
+void WAVFileWriter::write(const float *const *channels, int nFrames)
+{
+    int done = 0;
+
+    while (done < nFrames && !failed.load(std::memory_order_relaxed))
+    {
+        auto slot = produced.load(std::memory_order_relaxed);
+
+        if (slot - consumed.load(std::memory_order_acquire) >= numChunks)
+        {
+            std::unique_lock<std::mutex> lk(waitMutex);
+            waitCV.wait(lk, [this, slot]() {
+                return slot - consumed.load(std::memory_order_acquire) < numChunks || failed;
+            });
+            continue;
+        }
+
+        auto &c = chunks[slot % numChunks];
+        auto n = std::min(nFrames - done, chunkFrames - c.frames);
+        auto *dest = c.interleaved.data() + c.frames * numChannels;
+
+        for (int i = 0; i < n; ++i)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                *dest++ = channels[ch][done + i];
+            }
+        }
+
+        c.frames += n;
+        done += n;
+
+        if (c.frames == chunkFrames)
+        {
+            publishChunk();
+        }
+    }
+}
+
+void WAVFileWriter::publishChunk()
+{
+    produced.fetch_add(1, std::memory_order_release);
+    std::lock_guard<std::mutex> g(waitMutex);
+    waitCV.notify_all();
+}
+
+bool WAVFileWriter::close(std::string &errorMessage)
+{
+    if (!isOpen())
+    {
+        errorMessage = "No WAV file is open!";
+        return false;
+    }
+
+    // a partly filled chunk still has to go out
+    if (chunks[produced % numChunks].frames > 0)
+    {
+        publishChunk();
+    }
+
+    {
+        std::lock_guard<std::mutex> g(waitMutex);
+        finishing = true;
+        waitCV.notify_all();
+    }
+
+    writerThread.join();
+    file.close();
+
+    if (failed || file.fail())
+    {
+        errorMessage = writeError.empty() ? "Unable to write the WAV file!" : writeError;
+        return false;
+    }
+
+    return true;
+}
+
+void WAVFileWriter::writerLoop()
+{
+    while (true)
+    {
+        auto next = consumed.load(std::memory_order_relaxed);
+
+        if (next == produced.load(std::memory_order_acquire))
+        {
+            std::unique_lock<std::mutex> lk(waitMutex);
+
+            if (finishing && next == produced.load(std::memory_order_acquire))
+                return;
+
+            waitCV.wait(lk, [this, next]() {
+                return finishing || next != produced.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+
+        auto &c = chunks[next % numChunks];
+
+        if (!failed)
+        {
+            writeChunk(c);
+        }
+
+        c.frames = 0;
+        consumed.fetch_add(1, std::memory_order_release);
+
+        std::lock_guard<std::mutex> g(waitMutex);
+        waitCV.notify_all();
+    }
+}
+
+void WAVFileWriter::writeChunk(const Chunk &c)
+{
+    auto nSamples = (size_t)c.frames * numChannels;
+    auto nBytes = nSamples * bytesPerSample;
+
+    if (dataBytes + nBytes > maxDataBytes)
+    {
+        writeError = "The render is longer than a WAV file can hold!";
+        failed = true;
+        std::lock_guard<std::mutex> g(waitMutex);
+        waitCV.notify_all();
+        return;
+    }
+
+    if (format == FLOAT32)
+    {
+        // WAV is little endian, as is everything we build for
+        file.write(reinterpret_cast<const char *>(c.interleaved.data()), nBytes);
+    }
+    else
+    {
+        std::vector<char> out(nBytes);
+        auto *o = out.data();
+        const float scale = (format == PCM24) ? 8388607.f : 32767.f;
+
+        for (size_t i = 0; i < nSamples; ++i)
+        {
+            auto v = (int32_t)std::lrint(std::clamp(c.interleaved[i], -1.f, 1.f) * scale);
+
+            for (int b = 0; b < bytesPerSample; ++b)
+            {
+                *o++ = (char)(v & 255);
+                v >>= 8;
+            }
+        }
+
+        file.write(out.data(), nBytes);
+    }
+
+    dataBytes += nBytes;
+
+    if (file.fail())
+    {
+        writeError = "Unable to write to the WAV file! ";
+        writeError += std::strerror(errno);
+        failed = true;
+        std::lock_guard<std::mutex> g(waitMutex);
+        waitCV.notify_all();
+    }
+}
+} // namespace Storage
+} // namespace Surge
@@ -0,0 +1,108 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_WAVFILEWRITER_H
+#define SURGE_SRC_COMMON_WAVFILEWRITER_H
+
+#include "filesystem/import.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * Writes a WAV file as audio is produced, with the encoding and the disk writes done on a
+ * thread of its own, so a long render keeps constant memory and overlaps synthesis with
+ * I/O. The producer fills fixed size chunks and hands each over with an atomic counter;
+ * it only ever waits when the writer has fallen a whole ring of chunks behind.
+ *
+ * One thread writes, and the same thread opens and closes. Like every RIFF WAV, the file
+ * tops out at 4 GB of audio; writing further fails the file rather than wrapping.
+ */
+class WAVFileWriter
+{
+  public:
+    enum Format
+    {
+        FLOAT32,
+        PCM24,
+        PCM16
+    };
+
+    WAVFileWriter() = default;
+    ~WAVFileWriter();
+
+    WAVFileWriter(const WAVFileWriter &) = delete;
+    WAVFileWriter &operator=(const WAVFileWriter &) = delete;
+
+    bool open(const fs::path &path, int numChannels, int sampleRate, Format format,
+              std::string &errorMessage);
+    // Queues nFrames from each of numChannels separate channel buffers
+    void write(const float *const *channels, int nFrames);
+    // Writes whatever is queued, fills in the header and stops the writer thread
+    bool close(std::string &errorMessage);
+
+    bool isOpen() const { return writerThread.joinable(); }
+
+  private:
+    static constexpr int chunkFrames = 8192, numChunks = 16;
+
+    struct Chunk
+    {
+        std::vector<float> interleaved;
+        int frames{0};
+    };
+    std::array<Chunk, numChunks> chunks;
+    // chunks handed over and chunks written; the writer owns [consumed, produced)
+    std::atomic<uint64_t> produced{0}, consumed{0};
+    std::atomic<bool> finishing{false}, failed{false};
+
+    std::mutex waitMutex;
+    std::condition_variable waitCV;
+
+    std::thread writerThread;
+    std::ofstream file;
+    std::string writeError;
+
+    int numChannels{0}, bytesPerSample{0};
+    Format format{FLOAT32};
+    uint64_t dataBytes{0};
+
+    void publishChunk();
+    void writerLoop();
+    void writeChunk(const Chunk &c);
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_WAVFILEWRITER_H
@@ -0,0 +1,249 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "WavetableCacheFile.h"
+#include "Wavetable.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace Surge
+{
+namespace Storage
+{
+namespace
+{
+constexpr char cacheTag[4] = {'s', 'w', 't', 'c'};
+constexpr uint32_t cacheVersion = 1;
+constexpr size_t cacheAlignment = 64;
+
+// well beyond the largest table RequiredWTSize can ask for
+constexpr uint64_t maxCachedDataSizes = 1ULL << 26;
+
+struct CacheHeader
+{
+    char tag[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t hash;
+    int32_t size, sourceTables, flags, appendSilence;
+    uint64_t dataSizes;
+    uint32_t pathBytes;
+    uint32_t reserved;
+};
+static_assert(sizeof(CacheHeader) == cacheAlignment, "The table data follows the header aligned");
+
+uint64_t hashPath(const std::string &s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (auto c : s)
+        h = (h ^ (unsigned char)c) * 0x100000001b3ULL;
+    return h;
+}
+
+size_t dataOffset(uint32_t pathBytes)
+{
+    auto o = sizeof(CacheHeader) + pathBytes;
+    return (o + cacheAlignment - 1) & ~(cacheAlignment - 1);
+}
+
+bool sourceStamp(const fs::path &source, uint64_t &size, int64_t &time)
+{
+    std::error_code ec;
+
+    size = (uint64_t)fs::file_size(source, ec);
+    if (ec)
+        return false;
+
+    time = (int64_t)fs::last_write_time(source, ec).time_since_epoch().count();
+    return !ec;
+}
+} // namespace
+
+fs::path cachedWavetablePath(const fs::path &cacheDir, const fs::path &source)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hashPath(path_to_string(source))
+        << ".wtc";
+    return cacheDir / oss.str();
+}
+
+bool loadCachedWavetable(const fs::path &cacheDir, const fs::path &source, Wavetable *wt)
+{
+    if (!wt)
+        return false;
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+
+    if (!sourceStamp(source, sourceSize, sourceTime))
+        return false;
+
+    std::filebuf f;
+
+    if (!f.open(cachedWavetablePath(cacheDir, source), std::ios::binary | std::ios::in))
+        return false;
+
+    CacheHeader h;
+
+    if (f.sgetn(reinterpret_cast<char *>(&h), sizeof(h)) != sizeof(h) ||
+        memcmp(h.tag, cacheTag, sizeof(cacheTag)) != 0 || h.version != cacheVersion ||
+        h.sourceSize != sourceSize || h.sourceTime != sourceTime)
+    {
+        return false;
+    }
+
+    // two sources can share a hashed file name, so check it really is ours
+    auto name = path_to_string(source);
+    std::string cachedName(h.pathBytes, '\0');
+
+    if (h.pathBytes != name.size() ||
+        f.sgetn(cachedName.data(), h.pathBytes) != (std::streamsize)h.pathBytes ||
+        cachedName != name)
+    {
+        return false;
+    }
+
+    Wavetable::BuildKey key;
+    key.hash = h.hash;
+    key.size = h.size;
+    key.sourceTables = h.sourceTables;
+    key.flags = h.flags;
+    key.appendSilence = h.appendSilence != 0;
+
+    if (wt->AdoptSharedWT(key))
+        return true;
+
+    if (h.dataSizes == 0 || h.dataSizes > maxCachedDataSizes)
+        return false;
+
+    auto off = (std::streamoff)dataOffset(h.pathBytes);
+
+    if (f.pubseekoff(off, std::ios::beg, std::ios::in) != std::streampos(off))
+        return false;
+
+    auto data = std::make_shared<Wavetable::TableData>((size_t)h.dataSizes);
+    auto f32Bytes = (std::streamsize)(h.dataSizes * sizeof(float));
+    auto i16Bytes = (std::streamsize)(h.dataSizes * sizeof(short));
+
+    if (f.sgetn(reinterpret_cast<char *>(data->f32), f32Bytes) != f32Bytes ||
+        f.sgetn(reinterpret_cast<char *>(data->i16), i16Bytes) != i16Bytes)
+    {
+        return false;
+    }
+
+    return wt->AdoptBuiltWT(key, std::move(data));
+}
+
+bool storeCachedWavetable(const fs::path &cacheDir, const fs::path &source, const Wavetable *wt)
+{
+    if (!wt || !wt->everBuilt || !wt->builtTableData())
+        return false;
+
+    return storeCachedWavetable(cacheDir, source, wt->buildKey, wt->builtTableData());
+}
+
+bool storeCachedWavetable(const fs::path &cacheDir, const fs::path &source,
+                          const Wavetable::BuildKey &key,
+                          const std::shared_ptr<Wavetable::TableData> &data)
+{
+    // an entry has to hold every mipmap, so one still building has to wait
+    if (!data || !data->isBuilt())
+        return false;
+
+    // the file holds both kinds of data, which a compact table doesn't have
+    if (data->compact)
+        return false;
+
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.tag, cacheTag, sizeof(cacheTag));
+    h.version = cacheVersion;
+
+    if (!sourceStamp(source, h.sourceSize, h.sourceTime))
+        return false;
+
+    auto name = path_to_string(source);
+
+    h.hash = key.hash;
+    h.size = key.size;
+    h.sourceTables = key.sourceTables;
+    h.flags = key.flags;
+    h.appendSilence = key.appendSilence ? 1 : 0;
+    h.dataSizes = data->dataSizes;
+    h.pathBytes = (uint32_t)name.size();
+
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    if (ec)
+        return false;
+
+    /*
+     * Write to a file of our own and move it into place, so another instance loading the
+     * same source never sees half an entry
+     */
+    auto dest = cachedWavetablePath(cacheDir, source);
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto temp = dest;
+    temp += "." + std::to_string((uint64_t)stamp ^ (uint64_t)(uintptr_t)data.get()) + ".tmp";
+
+    bool ok = false;
+    {
+        std::filebuf f;
+
+        if (!f.open(temp, std::ios::binary | std::ios::out | std::ios::trunc))
+            return false;
+
+        auto pad = dataOffset(h.pathBytes) - sizeof(h) - h.pathBytes;
+        const char zeros[cacheAlignment] = {};
+        auto f32Bytes = (std::streamsize)(data->dataSizes * sizeof(float));
+        auto i16Bytes = (std::streamsize)(data->dataSizes * sizeof(short));
+
+        ok = f.sputn(reinterpret_cast<const char *>(&h), sizeof(h)) == sizeof(h) &&
+             f.sputn(name.data(), h.pathBytes) == (std::streamsize)h.pathBytes &&
+             f.sputn(zeros, pad) == (std::streamsize)pad &&
+             f.sputn(reinterpret_cast<const char *>(data->f32), f32Bytes) == f32Bytes &&
+             f.sputn(reinterpret_cast<const char *>(data->i16), i16Bytes) == i16Bytes;
+
+        ok = f.close() && ok;
+    }
+
+    if (ok)
+    {
+        fs::rename(temp, dest, ec);
+        ok = !ec;
+    }
+
+    if (!ok)
+        fs::remove(temp, ec);
+
+    return ok;
+}
+} // namespace Storage
+} // namespace Surge
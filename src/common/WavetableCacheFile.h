@@ -0,0 +1,64 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_WAVETABLECACHEFILE_H
+#define SURGE_SRC_COMMON_WAVETABLECACHEFILE_H
+
+#include "filesystem/import.h"
+#include "Wavetable.h"
+
+#include <memory>
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * An on-disk cache of built wavetables. Decoding a .wav or .wt and painting its mipmaps
+ * with the halfband filter is most of the cost of loading a wavetable, so once a file has
+ * been built we write the finished block, which is what the oscillators actually read, to
+ * one file per source in the cache directory. The next load of that source, in this or any
+ * other instance, reads the block back in one pass and does no decoding or filtering.
+ *
+ * An entry is keyed by the source's path, size and modification time, so editing or
+ * replacing the source simply misses and rewrites. The entry also carries the wavetable's
+ * build key, so a load first looks for the table among those already built in this
+ * process, and only reads the block from disk if nobody has it.
+ *
+ * Entries are written in native byte order with the table data 64 byte aligned. They stay
+ * on the machine that wrote them; anything which doesn't match is ignored and rebuilt.
+ * Every failure here is quiet and just means we decode the source as usual.
+ */
+bool loadCachedWavetable(const fs::path &cacheDir, const fs::path &source, Wavetable *wt);
+bool storeCachedWavetable(const fs::path &cacheDir, const fs::path &source, const Wavetable *wt);
+// the block has to have all its mipmaps; see WavetableMipmapBuilder::whenBuilt
+bool storeCachedWavetable(const fs::path &cacheDir, const fs::path &source,
+                          const Wavetable::BuildKey &key,
+                          const std::shared_ptr<Wavetable::TableData> &data);
+
+// the file an entry for this source lives in
+fs::path cachedWavetablePath(const fs::path &cacheDir, const fs::path &source);
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_WAVETABLECACHEFILE_H
@@ -0,0 +1,359 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "WorkerPool.h"
+#include "SurgeTrace.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace Surge
+{
+namespace Threading
+{
+// How long an idle worker keeps polling for the next batch before going to sleep
+static constexpr auto workerSpinTime = std::chrono::milliseconds(2);
+
+WorkerPool::WorkerPool(int numWorkers, std::function<void(int)> ots)
+    : onThreadStart(std::move(ots))
+{
+    threads.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        threads.emplace_back([this, i]() {
+            SURGE_TRACE_THREAD_NAME("Surge Worker");
+            applyThreadRole(ThreadRole::Realtime, i);
+            auto fpuguard = Surge::FPUState::DSPThreadGuard();
+            workerLoop(i);
+        });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> g(sleepMutex);
+        keepRunning = false;
+    }
+    sleepCV.notify_all();
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+void WorkerPool::run(int nTasks, taskFn_t fn, void *ctx)
+{
+    if (nTasks <= 0)
+        return;
+
+    if (threads.empty() || nTasks == 1)
+    {
+        for (int i = 0; i < nTasks; ++i)
+            fn(ctx, i);
+        return;
+    }
+
+    auto generation = (uint32_t)(work.load(std::memory_order_relaxed) >> 32) + 1;
+    auto &b = batches[generation % nBatchSlots];
+    b.fn = fn;
+    b.ctx = ctx;
+    b.count.store(nTasks, std::memory_order_relaxed);
+    tasksDone.store(0, std::memory_order_relaxed);
+
+    work.store((uint64_t)generation << 32, std::memory_order_seq_cst);
+
+    if (sleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> g(sleepMutex);
+        }
+        sleepCV.notify_all();
+    }
+
+    drain(generation);
+
+    while (tasksDone.load(std::memory_order_acquire) < nTasks)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void WorkerPool::drain(uint32_t generation)
+{
+    auto &b = batches[generation % nBatchSlots];
+    auto w = work.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        if ((uint32_t)(w >> 32) != generation)
+            return;
+
+        auto idx = (uint32_t)(w & 0xFFFFFFFF);
+
+        /*
+         * If this batch has been retired and its slot reused, count may be garbage,
+         * but then work has moved on and the exchange below fails.
+         */
+        if (idx >= (uint32_t)b.count.load(std::memory_order_relaxed))
+            return;
+
+        if (work.compare_exchange_weak(w, w + 1, std::memory_order_acq_rel))
+        {
+            b.fn(b.ctx, (int)idx);
+            tasksDone.fetch_add(1, std::memory_order_release);
+            w = work.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void WorkerPool::workerLoop(int index)
+{
+    if (onThreadStart)
+        onThreadStart(index);
+
+    uint32_t seen = (uint32_t)(work.load(std::memory_order_acquire) >> 32);
+    auto lastWork = std::chrono::steady_clock::now();
+
+    while (keepRunning)
+    {
+        auto generation = (uint32_t)(work.load(std::memory_order_acquire) >> 32);
+
+        if (generation != seen)
+        {
+            seen = generation;
+            drain(generation);
+            lastWork = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() - lastWork < workerSpinTime)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(sleepMutex);
+        sleepers++;
+        sleepCV.wait(lk, [this, seen]() {
+            return !keepRunning || (uint32_t)(work.load(std::memory_order_seq_cst) >> 32) != seen;
+        });
+        sleepers--;
+        lastWork = std::chrono::steady_clock::now();
+    }
+}
+std::shared_ptr<SharedScheduler> SharedScheduler::acquire()
+{
+    static std::mutex m;
+    static std::weak_ptr<SharedScheduler> current;
+
+    std::lock_guard<std::mutex> g(m);
+    auto res = current.lock();
+    if (!res)
+    {
+        // pinned realtime threads would only queue up behind each other on a shared core
+        auto cores = physicalCoreCount();
+        auto pinned = getThreadPolicy().realtimeCores;
+        if (!pinned.empty())
+            cores = std::min(cores, (int)pinned.size());
+
+        res = std::shared_ptr<SharedScheduler>(new SharedScheduler(std::max(1, cores - 1)));
+        current = res;
+    }
+    return res;
+}
+
+SharedScheduler::SharedScheduler(int numWorkers)
+{
+    threads.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        threads.emplace_back([this, i]() {
+            SURGE_TRACE_THREAD_NAME("Surge Shared Worker");
+            applyThreadRole(ThreadRole::Realtime, i);
+            auto fpuguard = Surge::FPUState::DSPThreadGuard();
+            workerLoop();
+        });
+    }
+}
+
+SharedScheduler::~SharedScheduler()
+{
+    {
+        std::lock_guard<std::mutex> g(sleepMutex);
+        keepRunning = false;
+    }
+    sleepCV.notify_all();
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+void SharedScheduler::run(int nTasks, WorkerPool::taskFn_t fn, void *ctx,
+                          clock_t::time_point deadline)
+{
+    if (nTasks <= 0)
+        return;
+
+    int slot{-1};
+    if (!threads.empty() && nTasks > 1)
+    {
+        for (int s = 0; s < maxBatches && slot < 0; ++s)
+        {
+            bool expected{false};
+            if (batches[s].inUse.compare_exchange_strong(expected, true))
+                slot = s;
+        }
+    }
+
+    if (slot < 0)
+    {
+        for (int i = 0; i < nTasks; ++i)
+            fn(ctx, i);
+        return;
+    }
+
+    auto &b = batches[slot];
+    auto generation = (uint32_t)(b.work.load(std::memory_order_relaxed) >> 32) + 1;
+    b.fn = fn;
+    b.ctx = ctx;
+    b.count.store(nTasks, std::memory_order_relaxed);
+    b.deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    b.tasksDone.store(0, std::memory_order_relaxed);
+    b.work.store((uint64_t)generation << 32, std::memory_order_seq_cst);
+
+    pending.fetch_or((uint64_t)1 << slot, std::memory_order_seq_cst);
+
+    if (sleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> g(sleepMutex);
+        }
+        sleepCV.notify_all();
+    }
+
+    // our own batch first, and only ours, since someone else's task could outlast our stragglers
+    while (runOne(slot, b.work.load(std::memory_order_acquire)))
+    {
+    }
+
+    while (b.tasksDone.load(std::memory_order_acquire) < nTasks)
+    {
+        std::this_thread::yield();
+    }
+
+    /*
+     * Every task is done, so nobody is inside fn. Parking the counter past any count means a
+     * worker still holding the old value can't claim from whatever batch takes the slot next.
+     */
+    b.work.store(((uint64_t)generation << 32) | 0xFFFFFFFF, std::memory_order_release);
+    pending.fetch_and(~((uint64_t)1 << slot), std::memory_order_release);
+    b.inUse.store(false, std::memory_order_release);
+}
+
+int SharedScheduler::soonestBatch(uint64_t &w) const
+{
+    int res{-1};
+    int64_t soonest{0};
+
+    auto p = pending.load(std::memory_order_acquire);
+    while (p)
+    {
+        int s{0};
+        while (!(p & ((uint64_t)1 << s)))
+            s++;
+        p &= ~((uint64_t)1 << s);
+
+        auto &b = batches[s];
+        auto sw = b.work.load(std::memory_order_acquire);
+        if ((uint32_t)(sw & 0xFFFFFFFF) >= (uint32_t)b.count.load(std::memory_order_relaxed))
+            continue;
+
+        auto d = b.deadline.load(std::memory_order_relaxed);
+        if (res < 0 || d < soonest)
+        {
+            res = s;
+            soonest = d;
+            w = sw;
+        }
+    }
+
+    return res;
+}
+
+bool SharedScheduler::runOne(int slot, uint64_t w)
+{
+    auto &b = batches[slot];
+    auto idx = (uint32_t)(w & 0xFFFFFFFF);
+    auto count = (uint32_t)b.count.load(std::memory_order_relaxed);
+
+    // as in WorkerPool::drain, a stale count only matters if the exchange succeeds, and it can't
+    if (idx >= count || !b.work.compare_exchange_strong(w, w + 1, std::memory_order_acq_rel))
+        return idx < count;
+
+    if (idx + 1 == count)
+        pending.fetch_and(~((uint64_t)1 << slot), std::memory_order_relaxed);
+
+    b.fn(b.ctx, (int)idx);
+    b.tasksDone.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void SharedScheduler::workerLoop()
+{
+    auto lastWork = std::chrono::steady_clock::now();
+
+    while (keepRunning)
+    {
+        uint64_t w{0};
+        auto slot = soonestBatch(w);
+
+        if (slot >= 0)
+        {
+            runOne(slot, w);
+            lastWork = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() - lastWork < workerSpinTime)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(sleepMutex);
+        sleepers++;
+        sleepCV.wait(lk, [this]() {
+            return !keepRunning || pending.load(std::memory_order_seq_cst) != 0;
+        });
+        sleepers--;
+        lastWork = std::chrono::steady_clock::now();
+    }
+}
+} // namespace Threading
+} // namespace Surge
@@ -0,0 +1,192 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_WORKERPOOL_H
+#define SURGE_SRC_COMMON_WORKERPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * A small persistent pool of threads which the audio thread can hand a batch of
+ * independent tasks to and then join before moving on. The calling thread works
+ * on the batch too, so a pool with one worker gives you two cores.
+ *
+ * Tasks are claimed one at a time from a shared counter, so a slow task doesn't
+ * hold up the others. The counter is tagged with the batch generation so a worker
+ * which wakes late can never claim a task from a batch other than the one it saw.
+ *
+ * Workers spin briefly after a batch, since on the audio thread the next batch is
+ * usually one block away, and then sleep until woken. parallelFor does not allocate.
+ */
+struct WorkerPool
+{
+    /*
+     * onThreadStart is called once on each worker thread, with the worker index,
+     * before it takes any work. Use it to set up thread local state.
+     */
+    explicit WorkerPool(int numWorkers, std::function<void(int)> onThreadStart = nullptr);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    int numWorkers() const { return (int)threads.size(); }
+
+    /*
+     * Run f(i) for i in [0, nTasks) and return once all of them are complete.
+     * Only one thread may call this at a time.
+     */
+    template <typename F> void parallelFor(int nTasks, F &f)
+    {
+        run(
+            nTasks, [](void *ctx, int i) { (*static_cast<F *>(ctx))(i); },
+            static_cast<void *>(&f));
+    }
+
+    typedef void (*taskFn_t)(void *, int);
+
+  private:
+    void run(int nTasks, taskFn_t fn, void *ctx);
+    void drain(uint32_t generation);
+    void workerLoop(int index);
+
+    struct Batch
+    {
+        taskFn_t fn{nullptr};
+        void *ctx{nullptr};
+        std::atomic<int> count{0};
+    };
+    static constexpr int nBatchSlots = 4;
+    Batch batches[nBatchSlots];
+
+    // high 32 bits are the batch generation, low 32 bits the next unclaimed task
+    std::atomic<uint64_t> work{0};
+    std::atomic<int> tasksDone{0};
+
+    std::atomic<bool> keepRunning{true};
+    std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCV;
+
+    std::function<void(int)> onThreadStart;
+    std::vector<std::thread> threads;
+};
+
+/*
+ * One pool for every Surge in the process, so forty instances in a session share a worker per
+ * physical core (less one, for the submitting thread) rather than each starting their own.
+ *
+ * Any number of threads may submit batches at once. Each batch carries a deadline, and an idle
+ * worker takes its next task from whichever pending batch is due soonest, so an instance which
+ * is behind in its host callback gets helped first. As with WorkerPool, the submitter works on
+ * its own batch and then waits for it, tasks are claimed through generation tagged counters,
+ * and nothing allocates once the pool is running.
+ *
+ * acquire() hands out the pool, starting it if nobody holds it. It winds down when the last
+ * holder lets go, on that holder's thread rather than at static destruction.
+ */
+struct SharedScheduler
+{
+    typedef std::chrono::steady_clock clock_t;
+
+    static std::shared_ptr<SharedScheduler> acquire();
+    ~SharedScheduler();
+
+    SharedScheduler(const SharedScheduler &) = delete;
+    SharedScheduler &operator=(const SharedScheduler &) = delete;
+
+    int numWorkers() const { return (int)threads.size(); }
+
+    /*
+     * Run f(i) for i in [0, nTasks) and return once all of them are complete. Any thread may
+     * call this, including several at once.
+     */
+    template <typename F> void parallelFor(int nTasks, F &f, clock_t::time_point deadline)
+    {
+        run(
+            nTasks, [](void *ctx, int i) { (*static_cast<F *>(ctx))(i); },
+            static_cast<void *>(&f), deadline);
+    }
+
+    // batches in flight at once; a submitter which finds no free slot runs its batch itself
+    static constexpr int maxBatches = 64;
+
+  private:
+    explicit SharedScheduler(int numWorkers);
+
+    struct Batch
+    {
+        std::atomic<bool> inUse{false};
+        WorkerPool::taskFn_t fn{nullptr};
+        void *ctx{nullptr};
+        std::atomic<int> count{0};
+        std::atomic<int64_t> deadline{0};
+        // as in WorkerPool, the generation and then the next unclaimed task
+        std::atomic<uint64_t> work{0};
+        std::atomic<int> tasksDone{0};
+    };
+
+    void run(int nTasks, WorkerPool::taskFn_t fn, void *ctx, clock_t::time_point deadline);
+    int soonestBatch(uint64_t &w) const;
+    bool runOne(int slot, uint64_t w);
+    void workerLoop();
+
+    Batch batches[maxBatches];
+    // a bit for each slot which still has tasks to hand out
+    std::atomic<uint64_t> pending{0};
+    static_assert(maxBatches <= 64);
+
+    std::atomic<bool> keepRunning{true};
+    std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCV;
+
+    std::vector<std::thread> threads;
+};
+
+/*
+ * Somewhere other than a pool of our own to run a batch, like a plugin host's thread pool.
+ * runBatch calls fn(ctx, i) for each i in [0, nTasks) and returns true once they've all
+ * completed, or returns false without running any of them if it can't right now, in which
+ * case the caller runs the batch itself.
+ */
+struct ExternalBatchRunner
+{
+    virtual ~ExternalBatchRunner() = default;
+    virtual bool runBatch(int nTasks, WorkerPool::taskFn_t fn, void *ctx) = 0;
+};
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_WORKERPOOL_H
@@ -0,0 +1,140 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
+#define SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace Surge
+{
+namespace Voice
+{
+/*
+ * The synth keeps its voices in a fixed array per scene (voices_array) and this
+ * is the ordered set of which of those are currently sounding. Rather than
+ * a std::list of pointers we store a packed run of small indices into the voice
+ * array, so a walk over the active voices touches one cache line and a note-on
+ * or note-off doesn't do any node allocation.
+ *
+ * Entries stay in note-on order. The voice stealing and polyphony limit code walks
+ * from the front looking for the oldest candidate, and the quad filter lanes are
+ * handed out in list order, so removal shifts the (at most MAX_VOICES byte) tail
+ * rather than swapping with the end.
+ *
+ * The interface is the subset of std::list we used, so iteration dereferences to
+ * a V * and erase returns the next iterator, plus indexed access by position.
+ */
+template <typename V, size_t capacity> struct ActiveVoiceList
+{
+    static_assert(capacity <= 256, "Voice indices are stored as uint8_t");
+
+    struct iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = V *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V **;
+        using reference = V *;
+
+        const uint8_t *pos{nullptr};
+        V *base{nullptr};
+
+        V *operator*() const { return base + *pos; }
+        iterator &operator++()
+        {
+            pos++;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            auto r = *this;
+            pos++;
+            return r;
+        }
+        bool operator==(const iterator &other) const { return pos == other.pos; }
+        bool operator!=(const iterator &other) const { return pos != other.pos; }
+    };
+    using const_iterator = iterator;
+
+    void setVoiceArray(V *b) { base = b; }
+
+    iterator begin() const { return {&idx[0], base}; }
+    iterator end() const { return {&idx[count], base}; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    V *operator[](size_t i) const
+    {
+        assert(i < count);
+        return base + idx[i];
+    }
+
+    V *front() const
+    {
+        assert(count > 0);
+        return base + idx[0];
+    }
+    V *back() const
+    {
+        assert(count > 0);
+        return base + idx[count - 1];
+    }
+
+    size_t indexOf(const V *v) const
+    {
+        assert(v >= base && v < base + capacity);
+        return (size_t)(v - base);
+    }
+
+    void push_back(V *v)
+    {
+        assert(count < capacity);
+        idx[count++] = (uint8_t)indexOf(v);
+    }
+
+    iterator erase(iterator it)
+    {
+        auto at = (size_t)(it.pos - &idx[0]);
+        assert(at < count);
+        if (at + 1 < count)
+            memmove(&idx[at], &idx[at + 1], count - at - 1);
+        count--;
+        return {&idx[at], base};
+    }
+
+    void clear() { count = 0; }
+
+  private:
+    V *base{nullptr};
+    uint8_t idx[capacity]{};
+    size_t count{0};
+};
+} // namespace Voice
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
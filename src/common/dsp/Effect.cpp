@@ -54,9 +54,20 @@
 #include "DebugHelpers.h"
 #include "AudioInputEffect.h"
 #include "FloatyDelayEffect.h"
+#include "ConvolutionEffect.h"
 
 using namespace std;
 
+namespace
+{
+template <typename T> Effect *make(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
+{
+    auto e = new T(storage, fxdata, pd);
+    e->instanceBytes = sizeof(T);
+    return e;
+}
+} // namespace
+
 Effect *spawn_effect(int id, SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
 {
     // std::cout << "Spawn Effect " << _D(id) << std::endl;
@@ -64,69 +75,71 @@ Effect *spawn_effect(int id, SurgeStorage *storage, FxStorage *fxdata, pdata *pd
     switch (id)
     {
     case fxt_delay:
-        return new DelayEffect(storage, fxdata, pd);
+        return make<DelayEffect>(storage, fxdata, pd);
     case fxt_eq:
-        return new ParametricEQ3BandEffect(storage, fxdata, pd);
+        return make<ParametricEQ3BandEffect>(storage, fxdata, pd);
     case fxt_phaser:
-        return new PhaserEffect(storage, fxdata, pd);
+        return make<PhaserEffect>(storage, fxdata, pd);
     case fxt_rotaryspeaker:
-        return new RotarySpeakerEffect(storage, fxdata, pd);
+        return make<RotarySpeakerEffect>(storage, fxdata, pd);
     case fxt_distortion:
-        return new DistortionEffect(storage, fxdata, pd);
+        return make<DistortionEffect>(storage, fxdata, pd);
     case fxt_reverb:
-        return new Reverb1Effect(storage, fxdata, pd);
+        return make<Reverb1Effect>(storage, fxdata, pd);
     case fxt_reverb2:
-        return new Reverb2Effect(storage, fxdata, pd);
+        return make<Reverb2Effect>(storage, fxdata, pd);
     case fxt_freqshift:
-        return new FrequencyShifterEffect(storage, fxdata, pd);
+        return make<FrequencyShifterEffect>(storage, fxdata, pd);
     case fxt_conditioner:
-        return new ConditionerEffect(storage, fxdata, pd);
+        return make<ConditionerEffect>(storage, fxdata, pd);
     case fxt_chorus4:
-        return new ChorusEffect<4>(storage, fxdata, pd);
+        return make<ChorusEffect<4>>(storage, fxdata, pd);
     case fxt_vocoder:
-        return new VocoderEffect(storage, fxdata, pd);
+        return make<VocoderEffect>(storage, fxdata, pd);
     case fxt_flanger:
-        return new FlangerEffect(storage, fxdata, pd);
+        return make<FlangerEffect>(storage, fxdata, pd);
     case fxt_ringmod:
-        return new RingModulatorEffect(storage, fxdata, pd);
+        return make<RingModulatorEffect>(storage, fxdata, pd);
     case fxt_airwindows:
-        return new AirWindowsEffect(storage, fxdata, pd);
+        return make<AirWindowsEffect>(storage, fxdata, pd);
     case fxt_neuron:
-        return new chowdsp::NeuronEffect(storage, fxdata, pd);
+        return make<chowdsp::NeuronEffect>(storage, fxdata, pd);
     case fxt_geq11:
-        return new GraphicEQ11BandEffect(storage, fxdata, pd);
+        return make<GraphicEQ11BandEffect>(storage, fxdata, pd);
     case fxt_resonator:
-        return new ResonatorEffect(storage, fxdata, pd);
+        return make<ResonatorEffect>(storage, fxdata, pd);
     case fxt_combulator:
-        return new CombulatorEffect(storage, fxdata, pd);
+        return make<CombulatorEffect>(storage, fxdata, pd);
     case fxt_chow:
-        return new chowdsp::CHOWEffect(storage, fxdata, pd);
+        return make<chowdsp::CHOWEffect>(storage, fxdata, pd);
     case fxt_nimbus:
-        return new NimbusEffect(storage, fxdata, pd);
+        return make<NimbusEffect>(storage, fxdata, pd);
     case fxt_exciter:
-        return new chowdsp::ExciterEffect(storage, fxdata, pd);
+        return make<chowdsp::ExciterEffect>(storage, fxdata, pd);
     case fxt_tape:
-        return new chowdsp::TapeEffect(storage, fxdata, pd);
+        return make<chowdsp::TapeEffect>(storage, fxdata, pd);
     case fxt_ensemble:
 #if defined(_M_ARM64EC)
         return nullptr;
 #else
-        return new BBDEnsembleEffect(storage, fxdata, pd);
+        return make<BBDEnsembleEffect>(storage, fxdata, pd);
 #endif
     case fxt_treemonster:
-        return new TreemonsterEffect(storage, fxdata, pd);
+        return make<TreemonsterEffect>(storage, fxdata, pd);
     case fxt_waveshaper:
-        return new WaveShaperEffect(storage, fxdata, pd);
+        return make<WaveShaperEffect>(storage, fxdata, pd);
     case fxt_mstool:
-        return new MSToolEffect(storage, fxdata, pd);
+        return make<MSToolEffect>(storage, fxdata, pd);
     case fxt_spring_reverb:
-        return new chowdsp::SpringReverbEffect(storage, fxdata, pd);
+        return make<chowdsp::SpringReverbEffect>(storage, fxdata, pd);
     case fxt_bonsai:
-        return new BonsaiEffect(storage, fxdata, pd);
+        return make<BonsaiEffect>(storage, fxdata, pd);
     case fxt_audio_input:
-        return new AudioInputEffect(storage, fxdata, pd);
+        return make<AudioInputEffect>(storage, fxdata, pd);
     case fxt_floaty_delay:
-        return new FloatyDelayEffect(storage, fxdata, pd);
+        return make<FloatyDelayEffect>(storage, fxdata, pd);
+    case fxt_convolution:
+        return make<ConvolutionEffect>(storage, fxdata, pd);
 
     default:
         return 0;
@@ -153,14 +166,47 @@ Effect::Effect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
 bool Effect::process_ringout(float *dataL, float *dataR, bool indata_present)
 {
     if (indata_present)
+    {
         ringout = 0;
+        silentTailBlocks = 0;
+        tailCleared = false;
+    }
     else
+    {
         ringout++;
+    }
+
+    if (tailCleared)
+    {
+        process_only_control();
+        return false;
+    }
 
     int d = get_ringout_decay();
     if ((d < 0) || (ringout < d) || (ringout == 0))
     {
         process(dataL, dataR);
+
+        int w = indata_present ? -1 : get_silent_tail_window();
+        if (w > 0)
+        {
+            float e = 0.f;
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                e += dataL[k] * dataL[k] + dataR[k] * dataR[k];
+            }
+
+            if (e < silentTailLevel * silentTailLevel * 2 * BLOCK_SIZE)
+                silentTailBlocks++;
+            else
+                silentTailBlocks = 0;
+
+            if (silentTailBlocks >= w)
+            {
+                clear_tail();
+                tailCleared = true;
+            }
+        }
         return true;
     }
     else
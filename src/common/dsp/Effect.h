@@ -68,6 +68,20 @@ class alignas(16) Effect
     {
         return -1;
     } // number of blocks it takes for the effect to 'ring out'
+
+    // samples the effect delays its input by, which the plugins add to the latency they report
+    virtual int get_latency_samples() { return 0; }
+
+    /*
+     * Effects with long or unbounded ringouts can opt into an energy based tail detector
+     * by returning the number of blocks their longest internal path takes to reach the
+     * output. Once the input is gone and the output has stayed below silentTailLevel for
+     * that many blocks nothing left in the effect can become audible, so process_ringout
+     * calls clear_tail() and stops processing until input returns.
+     */
+    virtual int get_silent_tail_window() { return -1; }
+    virtual void clear_tail() { suspend(); }
+    static constexpr float silentTailLevel = 1e-6f; // -120 dBFS
     int groupIndexForParamIndex(int paramIndex)
     {
         int fpos = fxdata->p[paramIndex].posy / 10 + fxdata->p[paramIndex].posy_offset;
@@ -106,6 +120,14 @@ class alignas(16) Effect
         // No-op here.
     }
 
+    /*
+     * Roughly how much memory this effect holds: the object itself, which is nearly all of it
+     * for the effects with inline delay lines, plus any delay memory taken from the arena.
+     * What the libraries some effects wrap allocate for themselves isn't counted.
+     */
+    virtual size_t memoryFootprint() const { return instanceBytes; }
+    size_t instanceBytes{0}; // set by spawn_effect
+
     inline bool checkHasInvalidatedUI()
     {
         auto x = hasInvalidated;
@@ -132,6 +154,8 @@ class alignas(16) Effect
     FxStorage *fxdata;
     pdata *pd;
     int ringout;
+    int silentTailBlocks{0};
+    bool tailCleared{false};
     bool hasInvalidated{false};
 };
 
@@ -0,0 +1,350 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "FrozenHitCache.h"
+
+#include <algorithm>
+
+namespace Surge
+{
+namespace Voice
+{
+FrozenHitCache::FrozenHitCache(SurgeStorage *storage) : storage(storage)
+{
+    // room for the longest hit at 192k, so beginRecording never grows a page list
+    auto perHit = (size_t)(maxHitSeconds * 192000 / BLOCK_SIZE) / blocksPerPage + 1;
+    for (auto &h : hits)
+        h.pages.reserve(perHit);
+}
+
+bool FrozenHitCache::shapesHit(const SurgeSceneStorage &scene, const Parameter &p)
+{
+    if (p.ctrlgroup == cg_OSC || p.ctrlgroup == cg_MIX)
+        return true;
+
+    // the amp envelope sets how long a recording runs
+    if (p.ctrlgroup == cg_ENV && p.ctrlgroup_entry == 0)
+        return true;
+
+    for (auto *q : {&scene.pitch, &scene.octave, &scene.fm_depth, &scene.fm_switch, &scene.drift,
+                    &scene.noise_colour, &scene.keytrack_root, &scene.polymode, &scene.portamento,
+                    &scene.filterblock_configuration})
+    {
+        if (&p == q)
+            return true;
+    }
+    return false;
+}
+
+FrozenHitCache::SceneCheck FrozenHitCache::checkScene(SurgeStorage *storage, int sc,
+                                                      bool mpeEnabled)
+{
+    SceneCheck res;
+    auto &patch = storage->getPatch();
+    auto &scene = patch.scene[sc];
+
+    if (mpeEnabled || !storage->isStandardTuning || storage->oddsound_mts_active_as_client)
+        return res;
+
+    if (scene.polymode.val.i != pm_poly ||
+        scene.polyVoiceRepeatedKeyMode != NEW_VOICE_EVERY_NOTEON)
+        return res;
+
+    // glide, drift and the noise generator would each make every hit different
+    if (scene.portamento.val.f > scene.portamento.val_min.f || scene.drift.val.f != 0.f ||
+        !scene.mute_noise.val.b)
+        return res;
+
+    // a recording has no bend in it
+    if (scene.modsources[ms_pitchbend]->get_output(0) != 0.f)
+        return res;
+
+    if (scene.solo_o1.val.b || scene.solo_o2.val.b || scene.solo_o3.val.b ||
+        scene.solo_noise.val.b || scene.solo_ring_12.val.b || scene.solo_ring_23.val.b)
+        return res;
+
+    // step sequencers, MSEGs and formulas can retrigger the amp envelope
+    for (int l = 0; l < n_lfos_voice; ++l)
+    {
+        auto sh = scene.lfo[l].shape.val.i;
+        if (sh == lt_stepseq || sh == lt_mseg || sh == lt_formula)
+            return res;
+    }
+
+    const bool ring12 = !scene.mute_ring_12.val.b, ring23 = !scene.mute_ring_23.val.b;
+    const bool fm = scene.fm_switch.val.i != fm_off;
+    const Parameter *mutes[n_oscs] = {&scene.mute_o1, &scene.mute_o2, &scene.mute_o3};
+
+    for (int o = 0; o < n_oscs; ++o)
+    {
+        bool used =
+            !mutes[o]->val.b || (ring12 && o < 2) || (ring23 && o > 0) || (fm && o > 0);
+        if (!used)
+            continue;
+
+        switch (scene.osc[o].type.val.i)
+        {
+        case ot_classic:
+        case ot_sine:
+        case ot_wavetable:
+        case ot_window:
+        case ot_FM2:
+        case ot_FM3:
+        case ot_modern:
+            break;
+        default:
+            return res;
+        }
+
+        // without retrigger these start from a random phase
+        if (!scene.osc[o].retrigger.val.b)
+            return res;
+
+        res.tables[o] = &scene.osc[o].wt.builtTableData();
+    }
+    res.tables[n_oscs] = &storage->WindowWT.builtTableData();
+
+    // FNV-1a, as for the streamed state key
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const void *d, size_t n) {
+        auto c = static_cast<const unsigned char *>(d);
+        for (size_t i = 0; i < n; ++i)
+            h = (h ^ c[i]) * 1099511628211ULL;
+    };
+    auto mixInt = [&mix](int v) { mix(&v, sizeof(v)); };
+
+    bool shaping[n_scene_params];
+    for (int id = 0; id < n_scene_params; ++id)
+    {
+        auto *p = patch.param_ptr[patch.scene_start[sc] + id];
+        shaping[id] = shapesHit(scene, *p);
+
+        if (!shaping[id])
+            continue;
+
+        if (p->temposync)
+            return res;
+
+        mix(&p->val, sizeof(p->val));
+        mixInt(p->extend_range | p->absolute << 1 | p->deactivated << 2);
+        mixInt(p->deform_type);
+
+        // a host's monophonic modulation moves it for every voice
+        if (auto slot = patch.monophonicParamModulationSlot[p->id])
+            mix(&patch.monophonicParamModulations[slot - 1].value, sizeof(double));
+    }
+
+    // the classic and wavetable oscillators run their output through the character filter
+    mix(&patch.character.val, sizeof(patch.character.val));
+
+    // only the voice's own key and velocity may move what the oscillators do
+    auto &snapshot = storage->audioModulationRoutings();
+    for (auto *routings : {&snapshot.voice[sc], &snapshot.scene[sc]})
+    {
+        for (const auto &r : *routings)
+        {
+            if (r.destination_id < 0 || r.destination_id >= n_scene_params ||
+                !shaping[r.destination_id])
+                continue;
+
+            mixInt(r.source_id);
+            mixInt(r.source_index);
+            mixInt(r.destination_id);
+            mixInt(r.muted);
+            mix(&r.depth, sizeof(r.depth));
+
+            if (r.muted)
+                continue;
+
+            if (r.source_id == ms_velocity)
+                res.readsVelocity = true;
+            else if (r.source_id != ms_keytrack)
+                return res;
+        }
+    }
+
+    for (auto *t : res.tables)
+    {
+        auto d = t ? t->get() : nullptr;
+        mix(&d, sizeof(d));
+    }
+    mix(&storage->samplerate, sizeof(storage->samplerate));
+
+    res.fingerprint = h;
+    res.deterministic = true;
+    return res;
+}
+
+void FrozenHitCache::setBudgetBytes(size_t bytes)
+{
+    budgetPages = std::min(bytes / pageBytes, maxPages);
+}
+
+void FrozenHitCache::trimToBudget()
+{
+    auto budget = budgetPages.load(std::memory_order_relaxed);
+
+    if (pagesInUse > budget)
+        makeRoom(0);
+
+    // keep the longest hit's pages ready, so a recording doesn't wait for the refill thread
+    if (budget != poolSizedFor)
+    {
+        poolSizedFor = budget;
+        pool.requestPoolSize(std::min(budget, hits[0].pages.capacity()));
+    }
+}
+
+void FrozenHitCache::prepareScene(int sc, const SceneCheck &check)
+{
+    bool same = fingerprints[sc] == check.fingerprint;
+    for (int t = 0; t < n_oscs + 1 && same; ++t)
+        same = tables[sc][t].lock() == (check.tables[t] ? *check.tables[t] : nullptr);
+
+    if (same)
+        return;
+
+    fingerprints[sc] = check.fingerprint;
+    for (int t = 0; t < n_oscs + 1; ++t)
+        tables[sc][t] = check.tables[t] ? *check.tables[t] : nullptr;
+
+    for (auto &h : hits)
+    {
+        if (h.scene != sc)
+            continue;
+
+        // voices still playing a hit keep it until they are done
+        if (h.users == 0)
+            release(h);
+        else
+            h.stale = true;
+    }
+}
+
+FrozenHitCache::Hit *FrozenHitCache::replayFor(int sc, float pkey, int velocity)
+{
+    for (auto &h : hits)
+    {
+        if (h.scene == sc && h.complete && !h.stale && h.pkey == pkey && h.velocity == velocity)
+        {
+            h.users++;
+            h.lastUsed = ++useCounter;
+            replays++;
+            return &h;
+        }
+    }
+    return nullptr;
+}
+
+FrozenHitCache::Hit *FrozenHitCache::beginRecording(int sc, float pkey, int velocity,
+                                                    int lengthBlocks)
+{
+    for (auto &h : hits)
+    {
+        // someone is recording this one already
+        if (h.scene == sc && !h.stale && h.pkey == pkey && h.velocity == velocity)
+            return nullptr;
+    }
+
+    if (lengthBlocks <= 0 || lengthBlocks * BLOCK_SIZE > maxHitSeconds * storage->samplerate)
+        return nullptr;
+
+    auto need = (size_t)(lengthBlocks + blocksPerPage - 1) / blocksPerPage;
+    if (need > hits[0].pages.capacity() || !makeRoom(need))
+        return nullptr;
+
+    Hit *slot{nullptr};
+    for (auto &h : hits)
+    {
+        if (h.scene < 0)
+        {
+            slot = &h;
+            break;
+        }
+        if (h.users == 0 && (!slot || h.lastUsed < slot->lastUsed))
+            slot = &h;
+    }
+    if (!slot)
+        return nullptr;
+    if (slot->scene >= 0)
+        release(*slot);
+
+    for (size_t i = 0; i < need; ++i)
+        slot->pages.push_back(pool.getItem());
+    pagesInUse += need;
+
+    slot->scene = sc;
+    slot->pkey = pkey;
+    slot->velocity = velocity;
+    slot->lengthBlocks = lengthBlocks;
+    slot->complete = false;
+    slot->stale = false;
+    slot->users = 1;
+    slot->lastUsed = ++useCounter;
+    recordings++;
+    return slot;
+}
+
+void FrozenHitCache::endHit(Hit *h)
+{
+    assert(h->users > 0);
+    h->users--;
+
+    // an abandoned recording, or one from before a change, is no use to anyone
+    if (h->users == 0 && (!h->complete || h->stale))
+        release(*h);
+}
+
+void FrozenHitCache::release(Hit &h)
+{
+    for (auto *p : h.pages)
+        pool.returnItem(p);
+    pagesInUse -= h.pages.size();
+    h.pages.clear();
+
+    h.scene = -1;
+    h.complete = false;
+    h.stale = false;
+    h.users = 0;
+}
+
+bool FrozenHitCache::makeRoom(size_t need)
+{
+    auto budget = budgetPages.load(std::memory_order_relaxed);
+
+    while (pagesInUse + need > budget)
+    {
+        Hit *oldest{nullptr};
+        for (auto &h : hits)
+        {
+            if (h.scene >= 0 && h.users == 0 && (!oldest || h.lastUsed < oldest->lastUsed))
+                oldest = &h;
+        }
+        if (!oldest)
+            return false;
+        release(*oldest);
+    }
+    return true;
+}
+} // namespace Voice
+} // namespace Surge
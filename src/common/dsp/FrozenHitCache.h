@@ -0,0 +1,150 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+
+#ifndef SURGE_SRC_COMMON_DSP_FROZENHITCACHE_H
+#define SURGE_SRC_COMMON_DSP_FROZENHITCACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "SurgeStorage.h"
+#include "MemoryPool.h"
+#include "Wavetable.h"
+
+namespace Surge
+{
+namespace Voice
+{
+/*
+ * The "freeze voices" mode. A drum patch with no randomness, no drift, no glide and a one-shot
+ * amp envelope (no attack, no sustain) makes exactly the same oscillator and mixer output every
+ * time a key is hit at a velocity, so the first hit records that pre-filter block stream and
+ * later ones play it back instead of running their oscillators. The filters, waveshaper,
+ * amp envelope and everything after them still run live in every voice, so their modulation,
+ * the note's length and the effects all behave as before.
+ *
+ * A recording covers the longest the amp envelope can sound for: its whole decay, plus a full
+ * release in case the note ends just before that. Past that the amp is closed, so the voice
+ * reads silence. The recording voice is kept running until it has that much, even after its
+ * note is gone.
+ *
+ * checkScene says whether a scene qualifies and fingerprints everything the recorded blocks
+ * depend on. A hit is only replayed while the fingerprint, and the wavetables, are the ones it
+ * was recorded with, so any change to an oscillator, mixer, pitch or amp envelope parameter,
+ * or to a routing onto one, drops the scene's recordings. Filter and effect changes do not.
+ *
+ * Recordings live in pages from a pool whose refill thread does the allocating, held to a
+ * budget and evicted least recently used first. Everything here runs on the audio thread
+ * between blocks, apart from the voices reading and writing their own hit's pages.
+ */
+struct FrozenHitCache
+{
+    static constexpr int blocksPerPage = 64;
+    struct Page
+    {
+        float data alignas(16)[blocksPerPage][2][BLOCK_SIZE_OS];
+    };
+    static constexpr size_t pageBytes = sizeof(Page);
+    static constexpr size_t maxPages = 16384;
+
+    static constexpr float maxHitSeconds = 4.f;
+    static constexpr int maxHits = 256;
+
+    struct Hit
+    {
+        int scene{-1};
+        float pkey{0.f};
+        int velocity{-1}; // -1 when nothing the recording depends on reads the velocity
+        int lengthBlocks{0};
+        bool complete{false}, stale{false};
+        int users{0};
+        uint64_t lastUsed{0};
+        std::vector<Page *> pages;
+
+        float *block(int b, int channel)
+        {
+            return pages[b / blocksPerPage]->data[b % blocksPerPage][channel];
+        }
+    };
+
+    /*
+     * Whether a scene's voices can be frozen right now, and what a recording of them depends
+     * on. The tables point at the oscillators' wavetables (and the window table) as of now.
+     */
+    struct SceneCheck
+    {
+        bool deterministic{false};
+        bool readsVelocity{false};
+        uint64_t fingerprint{0};
+        std::array<const std::shared_ptr<Wavetable::TableData> *, n_oscs + 1> tables{};
+    };
+    static SceneCheck checkScene(SurgeStorage *storage, int scene, bool mpeEnabled);
+
+    // true for the scene parameters a recording depends on
+    static bool shapesHit(const SurgeSceneStorage &scene, const Parameter &p);
+
+    explicit FrozenHitCache(SurgeStorage *storage);
+
+    // how many bytes of recordings to keep; 0 stops recording. Safe from any thread.
+    void setBudgetBytes(size_t bytes);
+    // let go of recordings beyond the budget, once a block
+    void trimToBudget();
+
+    /*
+     * Drop an older fingerprint's recordings for this scene, then hand out a finished
+     * recording of this key and velocity, or a fresh one to record into if nobody is
+     * recording it already and there is room. Either way the caller is a user of the hit
+     * until endHit.
+     */
+    void prepareScene(int scene, const SceneCheck &check);
+    Hit *replayFor(int scene, float pkey, int velocity);
+    Hit *beginRecording(int scene, float pkey, int velocity, int lengthBlocks);
+    void endHit(Hit *h);
+
+    size_t bytesInUse() const { return pool.bytesAlive(); }
+
+    // counters for the tests
+    size_t recordings{0}, replays{0};
+
+  private:
+    void release(Hit &h);
+    bool makeRoom(size_t pages);
+
+    SurgeStorage *storage;
+    Memory::MemoryPool<Page, 1, 8, maxPages> pool;
+    std::array<Hit, maxHits> hits;
+    std::atomic<size_t> budgetPages{0};
+    size_t pagesInUse{0}, poolSizedFor{0};
+    uint64_t useCounter{0};
+
+    uint64_t fingerprints[n_scenes]{};
+    std::weak_ptr<Wavetable::TableData> tables[n_scenes][n_oscs + 1];
+};
+} // namespace Voice
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_FROZENHITCACHE_H
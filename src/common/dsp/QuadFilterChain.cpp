@@ -30,26 +30,18 @@ namespace mech = sst::basic_blocks::mechanics;
 namespace sdsp = sst::basic_blocks::dsp;
 
 #define MWriteOutputs(x)                                                                           \
-    d.OutL = SIMD_MM(add_ps)(d.OutL, d.dOutL);                                                     \
-    d.OutR = SIMD_MM(add_ps)(d.OutR, d.dOutR);                                                     \
-    auto outL = SIMD_MM(mul_ps)(x, d.OutL);                                                        \
-    auto outR = SIMD_MM(mul_ps)(x, d.OutR);                                                        \
-    SIMD_MM(store_ss)                                                                              \
-    (&OutL[k], SIMD_MM(add_ss)(SIMD_MM(load_ss)(&OutL[k]), mech::sum_ps_to_ss(outL)));             \
-    SIMD_MM(store_ss)                                                                              \
-    (&OutR[k], SIMD_MM(add_ss)(SIMD_MM(load_ss)(&OutR[k]), mech::sum_ps_to_ss(outR)));
+    advance<Ramp>(d.OutL, d.dOutL);                                                                \
+    advance<Ramp>(d.OutR, d.dOutR);                                                                \
+    laneOutL[k] = SIMD_MM(mul_ps)(x, d.OutL);                                                      \
+    laneOutR[k] = SIMD_MM(mul_ps)(x, d.OutR);
 
 #define MWriteOutputsDual(x, y)                                                                    \
-    d.OutL = SIMD_MM(add_ps)(d.OutL, d.dOutL);                                                     \
-    d.OutR = SIMD_MM(add_ps)(d.OutR, d.dOutR);                                                     \
-    d.Out2L = SIMD_MM(add_ps)(d.Out2L, d.dOut2L);                                                  \
-    d.Out2R = SIMD_MM(add_ps)(d.Out2R, d.dOut2R);                                                  \
-    auto outL = vMAdd(x, d.OutL, vMul(y, d.Out2L));                                                \
-    auto outR = vMAdd(x, d.OutR, vMul(y, d.Out2R));                                                \
-    SIMD_MM(store_ss)                                                                              \
-    (&OutL[k], SIMD_MM(add_ss)(SIMD_MM(load_ss)(&OutL[k]), mech::sum_ps_to_ss(outL)));             \
-    SIMD_MM(store_ss)                                                                              \
-    (&OutR[k], SIMD_MM(add_ss)(SIMD_MM(load_ss)(&OutR[k]), mech::sum_ps_to_ss(outR)));
+    advance<Ramp>(d.OutL, d.dOutL);                                                                \
+    advance<Ramp>(d.OutR, d.dOutR);                                                                \
+    advance<Ramp>(d.Out2L, d.dOut2L);                                                              \
+    advance<Ramp>(d.Out2R, d.dOut2R);                                                              \
+    laneOutL[k] = vMAdd(x, d.OutL, vMul(y, d.Out2L));                                              \
+    laneOutR[k] = vMAdd(x, d.OutR, vMul(y, d.Out2R));
 
 #if 0 // DEBUG
 #define AssertReasonableAudioFloat(x) assert(x<32.f && x> - 32.f);
@@ -57,9 +49,89 @@ namespace sdsp = sst::basic_blocks::dsp;
 #define AssertReasonableAudioFloat(x)
 #endif
 
-template <int config, bool A, bool WS, bool B>
-void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+/*
+ * Add the sum of the four voice lanes of each sample in lanes into out. Summing lanes one
+ * sample at a time is a shuffle chain per sample, so instead we take four samples at once
+ * and transpose them as we add. The pairs are added in the same order as sum_ps_to_ss, so
+ * the result is identical.
+ */
+static inline void accumulateLaneSums(const SIMD_M128 *lanes, float *out)
+{
+    for (int k = 0; k < BLOCK_SIZE_OS; k += 4)
+    {
+        auto p01 = SIMD_MM(add_ps)(SIMD_MM(movelh_ps)(lanes[k], lanes[k + 1]),
+                                   SIMD_MM(movehl_ps)(lanes[k + 1], lanes[k]));
+        auto p23 = SIMD_MM(add_ps)(SIMD_MM(movelh_ps)(lanes[k + 2], lanes[k + 3]),
+                                   SIMD_MM(movehl_ps)(lanes[k + 3], lanes[k + 2]));
+        auto sums =
+            SIMD_MM(add_ps)(SIMD_MM(shuffle_ps)(p01, p23, SIMD_MM_SHUFFLE(2, 0, 2, 0)),
+                            SIMD_MM(shuffle_ps)(p01, p23, SIMD_MM_SHUFFLE(3, 1, 3, 1)));
+
+        SIMD_MM(storeu_ps)(&out[k], SIMD_MM(add_ps)(SIMD_MM(loadu_ps)(&out[k]), sums));
+    }
+}
+
+using sst::filters::FilterUnitQFPtr;
+using sst::waveshapers::QuadWaveshaperPtr;
+
+/*
+ * ProcessFBQuad calls its filter units and waveshaper through the pointers in fbq_global,
+ * unless it is instantiated with the functions themselves, in which case they are called
+ * directly and can be inlined into the sample loop. See GetFusedFBQPointer.
+ */
+template <FilterUnitQFPtr F>
+inline SIMD_M128 runFilterUnit(FilterUnitQFPtr f, sst::filters::QuadFilterUnitState *__restrict s,
+                               SIMD_M128 in)
+{
+    if constexpr (F != nullptr)
+        return F(s, in);
+    else
+        return f(s, in);
+}
+
+template <QuadWaveshaperPtr F>
+inline SIMD_M128 runWaveshaper(QuadWaveshaperPtr f,
+                               sst::waveshapers::QuadWaveshaperState *__restrict s, SIMD_M128 in,
+                               SIMD_M128 drive)
+{
+    if constexpr (F != nullptr)
+        return F(s, in, drive);
+    else
+        return f(s, in, drive);
+}
+
+/*
+ * Gain, drive, feedback, mix and output level are ramped across the block from their
+ * deltas. On a held note these usually don't move at all, so each quad checks once per
+ * block and, if every delta is zero, runs a copy of the chain without the ramps.
+ */
+template <bool Ramp> inline void advance(SIMD_M128 &v, const SIMD_M128 &dv)
+{
+    if constexpr (Ramp)
+        v = SIMD_MM(add_ps)(v, dv);
+}
+
+inline bool hasRamps(const QuadFilterChainState &d)
 {
+    const auto z = SIMD_MM(setzero_ps)();
+    auto nz = SIMD_MM(or_ps)(SIMD_MM(cmpneq_ps)(d.dGain, z), SIMD_MM(cmpneq_ps)(d.dFB, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dMix1, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dMix2, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dDrive, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dOutL, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dOutR, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dOut2L, z));
+    nz = SIMD_MM(or_ps)(nz, SIMD_MM(cmpneq_ps)(d.dOut2R, z));
+    return SIMD_MM(movemask_ps)(nz) != 0;
+}
+
+template <int config, bool A, bool WS, bool B, bool Ramp, FilterUnitQFPtr F1, QuadWaveshaperPtr W,
+          FilterUnitQFPtr F2>
+void ProcessFBQuadBlock(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+{
+    // the per-voice output of each sample, summed across voices once the block is done
+    SIMD_M128 laneOutL[BLOCK_SIZE_OS], laneOutR[BLOCK_SIZE_OS];
+
     const auto hb_c = SIMD_MM(set1_ps)(0.5f); // If this is changed from 0.5, make sure to change
                                               // this in the code because it is assumed to be half
     const auto one = SIMD_MM(set1_ps)(1.0f);
@@ -74,17 +146,17 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, SIMD_MM(and_ps)(mask, x)));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], d.wsLPF, d.Drive);
             }
 
             if (A || WS)
             {
-                d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
+                advance<Ramp>(d.Mix1, d.dMix1);
                 x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(input, SIMD_MM(sub_ps)(one, d.Mix1)),
                                     SIMD_MM(mul_ps)(x, d.Mix1));
             }
@@ -92,12 +164,12 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             y = SIMD_MM(add_ps)(x, y);
 
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, SIMD_MM(sub_ps)(one, d.Mix2)),
                                 SIMD_MM(mul_ps)(y, d.Mix2));
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             auto out = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
 
             // output stage
@@ -107,24 +179,24 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_serial2:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto input = vMul(d.FB, d.FBlineL);
             input = vAdd(d.DL[k], sdsp::softclip_ps(input));
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
             auto x = input, y = d.DR[k];
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, SIMD_MM(and_ps)(mask, x)));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], d.wsLPF, d.Drive);
             }
 
             if (A || WS)
             {
-                d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
+                advance<Ramp>(d.Mix1, d.dMix1);
                 x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(input, SIMD_MM(sub_ps)(one, d.Mix1)),
                                     SIMD_MM(mul_ps)(x, d.Mix1));
             }
@@ -132,12 +204,12 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             y = SIMD_MM(add_ps)(x, y);
 
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, SIMD_MM(sub_ps)(one, d.Mix2)),
                                 SIMD_MM(mul_ps)(y, d.Mix2));
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             auto out = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             d.FBlineL = out;
 
@@ -149,30 +221,30 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
                      // with comb as f2
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto input = vMul(d.FB, d.FBlineL);
             input = vAdd(d.DL[k], sdsp::softclip_ps(input));
             auto x = input, y = d.DR[k];
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, SIMD_MM(and_ps)(mask, x)));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], d.wsLPF, d.Drive);
             }
 
             if (A || WS)
             {
-                d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
+                advance<Ramp>(d.Mix1, d.dMix1);
                 x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(input, SIMD_MM(sub_ps)(one, d.Mix1)),
                                     SIMD_MM(mul_ps)(x, d.Mix1));
             }
 
             // output stage
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             x = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
 
             MWriteOutputs(x)
@@ -180,9 +252,9 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
                 y = SIMD_MM(add_ps)(x, y);
 
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, SIMD_MM(sub_ps)(one, d.Mix2)),
                                 SIMD_MM(mul_ps)(y, d.Mix2));
 
@@ -192,7 +264,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_dual1:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto fb = SIMD_MM(mul_ps)(d.FB, d.FBlineL);
             fb = sdsp::softclip_ps(fb);
             auto x = SIMD_MM(add_ps)(d.DL[k], fb);
@@ -200,22 +272,22 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix1, d.dMix1);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, d.Mix1), SIMD_MM(mul_ps)(y, d.Mix2));
 
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, SIMD_MM(and_ps)(mask, x)));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], d.wsLPF, d.Drive);
             }
 
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             auto out = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             d.FBlineL = out;
             // output stage
@@ -225,7 +297,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_dual2:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto fb = SIMD_MM(mul_ps)(d.FB, d.FBlineL);
             fb = sdsp::softclip_ps(fb);
             auto x = SIMD_MM(add_ps)(d.DL[k], fb);
@@ -233,22 +305,22 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, SIMD_MM(and_ps)(mask, x)));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], d.wsLPF, d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], d.wsLPF, d.Drive);
             }
 
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix1, d.dMix1);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, d.Mix1), SIMD_MM(mul_ps)(y, d.Mix2));
 
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             auto out = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             d.FBlineL = out;
             // output stage
@@ -258,7 +330,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_ring:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto fb = SIMD_MM(mul_ps)(d.FB, d.FBlineL);
             fb = sdsp::softclip_ps(fb);
             auto x = SIMD_MM(add_ps)(d.DL[k], fb);
@@ -266,12 +338,12 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
-            d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix1, d.dMix1);
+            advance<Ramp>(d.Mix2, d.dMix2);
 
             x = SIMD_MM(mul_ps)(SIMD_MM(add_ps)(SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(one, d.Mix1), y),
                                                 SIMD_MM(mul_ps)(x, d.Mix1)),
@@ -281,11 +353,11 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             if (WS)
             {
                 d.wsLPF = SIMD_MM(mul_ps)(hb_c, SIMD_MM(add_ps)(d.wsLPF, x));
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], SIMD_MM(and_ps)(mask, d.wsLPF), d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], SIMD_MM(and_ps)(mask, d.wsLPF), d.Drive);
             }
 
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             auto out = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             d.FBlineL = out;
             // output stage
@@ -295,7 +367,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_stereo:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto fb = SIMD_MM(mul_ps)(d.FB, d.FBlineL);
             fb = sdsp::softclip_ps(fb);
             auto x = SIMD_MM(add_ps)(d.DL[k], fb);
@@ -303,23 +375,23 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             auto mask = SIMD_MM(load_ps)((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
             if (B)
-                y = g.FU2ptr(&d.FU[1], y);
+                y = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], y);
 
             if (WS)
             {
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], SIMD_MM(and_ps)(mask, x), d.Drive);
-                y = g.WSptr(&d.WSS[1], SIMD_MM(and_ps)(mask, y), d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], SIMD_MM(and_ps)(mask, x), d.Drive);
+                y = runWaveshaper<W>(g.WSptr, &d.WSS[1], SIMD_MM(and_ps)(mask, y), d.Drive);
             }
 
-            d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
-            d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+            advance<Ramp>(d.Mix1, d.dMix1);
+            advance<Ramp>(d.Mix2, d.dMix2);
             x = SIMD_MM(mul_ps)(x, d.Mix1);
             y = SIMD_MM(mul_ps)(y, d.Mix2);
 
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             x = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             y = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(y, d.Gain));
             d.FBlineL = SIMD_MM(add_ps)(x, y);
@@ -332,7 +404,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     case fc_wide:
         for (int k = 0; k < BLOCK_SIZE_OS; k++)
         {
-            d.FB = SIMD_MM(add_ps)(d.FB, d.dFB);
+            advance<Ramp>(d.FB, d.dFB);
             auto fbL = SIMD_MM(mul_ps)(d.FB, d.FBlineL);
             auto fbR = SIMD_MM(mul_ps)(d.FB, d.FBlineR);
             auto xin = SIMD_MM(add_ps)(d.DL[k], sdsp::softclip_ps(fbL));
@@ -344,20 +416,20 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
 
             if (A)
             {
-                x = g.FU1ptr(&d.FU[0], x);
-                y = g.FU1ptr(&d.FU[2], y);
+                x = runFilterUnit<F1>(g.FU1ptr, &d.FU[0], x);
+                y = runFilterUnit<F1>(g.FU1ptr, &d.FU[2], y);
             }
 
             if (WS)
             {
-                d.Drive = SIMD_MM(add_ps)(d.Drive, d.dDrive);
-                x = g.WSptr(&d.WSS[0], SIMD_MM(and_ps)(mask, x), d.Drive);
-                y = g.WSptr(&d.WSS[1], SIMD_MM(and_ps)(mask, y), d.Drive);
+                advance<Ramp>(d.Drive, d.dDrive);
+                x = runWaveshaper<W>(g.WSptr, &d.WSS[0], SIMD_MM(and_ps)(mask, x), d.Drive);
+                y = runWaveshaper<W>(g.WSptr, &d.WSS[1], SIMD_MM(and_ps)(mask, y), d.Drive);
             }
 
             if (A || WS)
             {
-                d.Mix1 = SIMD_MM(add_ps)(d.Mix1, d.dMix1);
+                advance<Ramp>(d.Mix1, d.dMix1);
                 auto t = SIMD_MM(sub_ps)(one, d.Mix1);
                 x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(xin, t), SIMD_MM(mul_ps)(x, d.Mix1));
                 y = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(yin, t), SIMD_MM(mul_ps)(y, d.Mix1));
@@ -365,16 +437,16 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
 
             if (B)
             {
-                auto z = g.FU2ptr(&d.FU[1], x);
-                auto w = g.FU2ptr(&d.FU[3], y);
+                auto z = runFilterUnit<F2>(g.FU2ptr, &d.FU[1], x);
+                auto w = runFilterUnit<F2>(g.FU2ptr, &d.FU[3], y);
 
-                d.Mix2 = SIMD_MM(add_ps)(d.Mix2, d.dMix2);
+                advance<Ramp>(d.Mix2, d.dMix2);
                 auto t = SIMD_MM(sub_ps)(one, d.Mix2);
                 x = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(x, t), SIMD_MM(mul_ps)(z, d.Mix2));
                 y = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(y, t), SIMD_MM(mul_ps)(w, d.Mix2));
             }
 
-            d.Gain = SIMD_MM(add_ps)(d.Gain, d.dGain);
+            advance<Ramp>(d.Gain, d.dGain);
             x = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(x, d.Gain));
             y = SIMD_MM(and_ps)(mask, SIMD_MM(mul_ps)(y, d.Gain));
             d.FBlineL = x;
@@ -386,6 +458,27 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
         }
         break;
     }
+
+    accumulateLaneSums(laneOutL, OutL);
+    accumulateLaneSums(laneOutR, OutR);
+
+    const auto absMask = SIMD_MM(castsi128_ps)(SIMD_MM(set1_epi32)(0x7FFFFFFF));
+    auto peak = SIMD_MM(setzero_ps)();
+    for (int k = 0; k < BLOCK_SIZE_OS; k++)
+    {
+        peak = vMax(peak, vMax(vAnd(laneOutL[k], absMask), vAnd(laneOutR[k], absMask)));
+    }
+    d.LanePeak = peak;
+}
+
+template <int config, bool A, bool WS, bool B, FilterUnitQFPtr F1 = nullptr,
+          QuadWaveshaperPtr W = nullptr, FilterUnitQFPtr F2 = nullptr>
+void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+{
+    if (hasRamps(d))
+        ProcessFBQuadBlock<config, A, WS, B, true, F1, W, F2>(d, g, OutL, OutR);
+    else
+        ProcessFBQuadBlock<config, A, WS, B, false, F1, W, F2>(d, g, OutL, OutR);
 }
 
 template <int config> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
@@ -451,6 +544,62 @@ FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B)
     return 0;
 }
 
+/*
+ * The combinations we build fused kernels for. These are the ones the factory patches
+ * lean on most: a standard LP12 or LP24 first, optionally into soft saturation, and then
+ * either nothing or a standard LP12.
+ */
+template <int config, FilterUnitQFPtr F1, QuadWaveshaperPtr W>
+FBQFPtr GetFusedFBQPointerForSecondUnit(FilterUnitQFPtr f2)
+{
+    using namespace sst::filters;
+
+    if (!f2)
+        return ProcessFBQuad<config, true, W != nullptr, false, F1, W, nullptr>;
+    if (f2 == SVFLP12Aquad)
+        return ProcessFBQuad<config, true, W != nullptr, true, F1, W, SVFLP12Aquad>;
+
+    return nullptr;
+}
+
+template <int config, FilterUnitQFPtr F1> FBQFPtr GetFusedFBQPointerForWaveshaper(fbq_global &g)
+{
+    if (!g.WSptr)
+        return GetFusedFBQPointerForSecondUnit<config, F1, nullptr>(g.FU2ptr);
+    if (g.WSptr == sst::waveshapers::TANH)
+        return GetFusedFBQPointerForSecondUnit<config, F1, sst::waveshapers::TANH>(g.FU2ptr);
+
+    return nullptr;
+}
+
+template <int config> FBQFPtr GetFusedFBQPointer2(fbq_global &g)
+{
+    using namespace sst::filters;
+
+    if (g.FU1ptr == SVFLP24Aquad)
+        return GetFusedFBQPointerForWaveshaper<config, SVFLP24Aquad>(g);
+    if (g.FU1ptr == SVFLP12Aquad)
+        return GetFusedFBQPointerForWaveshaper<config, SVFLP12Aquad>(g);
+
+    return nullptr;
+}
+
+FBQFPtr GetFusedFBQPointer(int config, fbq_global &g)
+{
+    switch (config)
+    {
+    case fc_serial1:
+        return GetFusedFBQPointer2<fc_serial1>(g);
+    case fc_serial2:
+        return GetFusedFBQPointer2<fc_serial2>(g);
+    case fc_dual1:
+        return GetFusedFBQPointer2<fc_dual1>(g);
+    case fc_stereo:
+        return GetFusedFBQPointer2<fc_stereo>(g);
+    }
+    return nullptr;
+}
+
 void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
 {
     Q->Gain = SIMD_MM(setzero_ps)();
@@ -482,4 +631,5 @@ void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
     Q->Out2R = SIMD_MM(setzero_ps)();
     Q->dOut2L = SIMD_MM(setzero_ps)();
     Q->dOut2R = SIMD_MM(setzero_ps)();
+    Q->LanePeak = SIMD_MM(setzero_ps)();
 }
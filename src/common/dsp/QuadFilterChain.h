@@ -85,8 +85,10 @@
  * bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
  *
  * that is for a given voice number (which is basically FBentry) modulo it by 3 and update that
- * point in the filter bank. And that FBQ is created aligned all the way at the
- * outset of SurgeSynth.
+ * point in the filter bank. The audio itself is the exception: each voice leaves its mix in its
+ * output buffer, and once the four voices of a quad have run SurgeVoice::storeQuadInputs
+ * transposes them into the DL and DR lanes together. And that FBQ is created aligned all the way
+ * at the outset of SurgeSynth.
  *
  * So cool. We now know how we go from synth to filter. The synth creates QaudFilterChainStates. It
  * then assigns a particular voice to update the input data of that chain state in a block. That
@@ -139,6 +141,8 @@ struct QuadFilterChainState
 
     SIMD_M128 OutL, OutR, dOutL, dOutR;
     SIMD_M128 Out2L, Out2R, dOut2L, dOut2R; // fc_stereo only
+
+    SIMD_M128 LanePeak; // largest absolute output of each voice over the last block
 };
 
 /*
@@ -158,4 +162,10 @@ typedef void (*FBQFPtr)(QuadFilterChainState &, fbq_global &, float *, float *);
 
 FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B);
 
+/*
+ * A kernel with the filter units and waveshaper in g compiled in, or nullptr if that
+ * combination has none and you should use GetFBQPointer.
+ */
+FBQFPtr GetFusedFBQPointer(int config, fbq_global &g);
+
 #endif // SURGE_SRC_COMMON_DSP_QUADFILTERCHAIN_H
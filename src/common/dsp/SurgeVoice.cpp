@@ -34,6 +34,7 @@
 #include "sst/basic-blocks/dsp/Clippers.h"
 #include "sst/basic-blocks/dsp/CorrelatedNoise.h"
 #include "CXOR.h"
+#include "SurgeTrace.h"
 
 using namespace std;
 namespace mech = sst::basic_blocks::mechanics;
@@ -73,8 +74,19 @@ float SurgeVoiceState::getPitch(SurgeStorage *storage)
             key != keyRetuningForKey)
         {
             keyRetuningForKey = key;
-            keyRetuning = MTS_RetuningInSemitones(storage->oddsound_mts_client, key + mpeBend,
-                                                  mtsUseChannelWhenRetuning ? 0 : channel);
+
+            // MTS-ESP retunes whole MIDI notes, so voices on the same note share an answer
+            char mtsNote = key + mpeBend;
+            char mtsChannel = mtsUseChannelWhenRetuning ? 0 : channel;
+            auto retune = [storage, mtsNote, mtsChannel]() {
+                return (float)MTS_RetuningInSemitones(storage->oddsound_mts_client, mtsNote,
+                                                      mtsChannel);
+            };
+
+            if (auto table = storage->currentMTSRetuningTable())
+                keyRetuning = table->get(mtsNote, mtsChannel, retune);
+            else
+                keyRetuning = retune();
         }
         auto rkey = keyRetuning;
 
@@ -85,7 +97,11 @@ float SurgeVoiceState::getPitch(SurgeStorage *storage)
         if (!storage->isStandardTuning &&
             storage->tuningApplicationMode == SurgeStorage::RETUNE_MIDI_ONLY)
     {
-        res = storage->remapKeyInMidiOnlyMode(res);
+        if (auto cache = storage->currentRetuningCache())
+            res = cache->get(Surge::Storage::RetuningCache::midiOnlyKeyRemap, res, 0,
+                             [storage, res]() { return storage->remapKeyInMidiOnlyMode(res); });
+        else
+            res = storage->remapKeyInMidiOnlyMode(res);
     }
 
     res = SurgeVoice::channelKeyEquvialent(res, channel, mpeEnabled, storage, false);
@@ -190,6 +206,7 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
 
     age = 0;
     age_release = 0;
+    silentBlocks = 0;
 
     state.key = key;
     state.keyRetuningForKey = -1000;
@@ -238,10 +255,12 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
     // init subcomponents
     for (int i = 0; i < n_oscs; i++)
     {
+        osc[i] = nullptr;
         osctype[i] = -1;
     }
 
     memset(&FBP, 0, sizeof(FBP));
+    memset(combDelay, 0, sizeof(combDelay));
     sampleRateReset();
 
     polyAftertouchSource = ControllerModulationSource(storage->smoothingMode);
@@ -279,14 +298,6 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
                       &storage->getPatch().msegs[state.scene_id][i],
                       &storage->getPatch().formulamods[state.scene_id][i]);
         lfo[i].setIsVoice(true);
-
-        if (scene->lfo[i].shape.val.i == lt_formula)
-        {
-            Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, storage->getPatch(),
-                                                    scene_id);
-            Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, this);
-        }
-
         modsources[ms_lfo1 + i] = &lfo[i];
     }
 
@@ -370,11 +381,7 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
     ampEGSource.attackFrom(aegStart);
     filterEGSource.attackFrom(fegStart);
 
-    for (int i = 0; i < n_lfos_voice; i++)
-    {
-        lfo[i].attack();
-    }
-
+    // this also starts the voice LFOs which are in use; the rest wait until they are
     calc_ctrldata<true>(0, 0); // init interpolators
     SetQFB(0, 0);              // init Quad Filter Block parameter interpolators
 
@@ -507,9 +514,10 @@ void SurgeVoice::switch_toggled()
     /*
      * Since we have updated the keytrack output here we need to re-update the localcopy modulators
      */
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    auto &voiceRoutings = storage->audioModulationRoutings().voice[state.scene_id];
+    vector<ModulationRouting>::const_iterator iter;
+    iter = voiceRoutings.begin();
+    while (iter != voiceRoutings.end())
     {
         int src_id = iter->source_id;
         int dst_id = iter->destination_id;
@@ -527,6 +535,11 @@ void SurgeVoice::switch_toggled()
         if (osctype[i] != scene->osc[i].type.val.i)
         {
             bool nzid = scene->drift.extend_range;
+
+            // hand the old oscillator's pooled state back before its replacement asks for some
+            if (osc[i])
+                osc[i]->~Oscillator();
+
             osc[i] = spawn_osc(scene->osc[i].type.val.i, storage, &scene->osc[i], localcopy,
                                this->paramptrUnmod, oscbuffer[i]);
             if (osc[i])
@@ -620,6 +633,7 @@ void SurgeVoice::switch_toggled()
             }
 
             CM[u].Reset();
+            lastFilterCoeffInputs[u].settled = false;
         }
     }
 }
@@ -631,7 +645,8 @@ void SurgeVoice::release()
 
     for (int i = 0; i < n_lfos_voice; i++)
     {
-        lfo[i].release();
+        if (lfoStarted[i])
+            lfo[i].release();
     }
 
     state.gate = false;
@@ -640,6 +655,8 @@ void SurgeVoice::release()
 
 void SurgeVoice::uber_release()
 {
+    // a stolen voice won't live long enough to finish a recording
+    detachFrozenHit();
     ampEGSource.uber_release();
     state.gate = false;
     state.uberrelease = true;
@@ -729,12 +746,34 @@ int SurgeVoice::routefilter(int r)
 
 template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, int e)
 {
-    // Always process LFO1 so the gate retrigger always work
-    lfo[0].process_block();
     velocitySource.process_block();
 
     for (int i = 0; i < n_lfos_voice; i++)
     {
+        /*
+         * If the synth has found this LFO comes out the same in every voice it has run it
+         * once for the scene, so read that instead. Polyphonic parameter modulation could
+         * land on the LFO, so we only do this with none.
+         */
+        auto *shared = scene->sharedVoiceLFO[i];
+
+        if (shared && paramModulationCount == 0)
+        {
+            modsources[ms_lfo1 + i] = shared;
+            lfo[i].retrigger_AEG = false;
+            lfo[i].retrigger_FEG = false;
+            lfoUsedShared[i] = true;
+            continue;
+        }
+
+        modsources[ms_lfo1 + i] = &lfo[i];
+
+        // Always process LFO1 so the gate retrigger always work
+        if (i != 0 && !scene->modsource_doprocess[ms_lfo1 + i])
+        {
+            continue;
+        }
+
         if (scene->lfo[i].shape.val.i == lt_formula)
         {
             Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, storage->getPatch(),
@@ -742,10 +781,23 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, in
             Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, this);
         }
 
-        if (i != 0 && scene->modsource_doprocess[ms_lfo1 + i])
+        /*
+         * An LFO nothing uses isn't started at note on, which for a formula means not preparing
+         * its Lua state, so start it here the first time it is used. A free running LFO takes
+         * its phase from the song position, so this also catches up one which was shared.
+         */
+        if (!lfoStarted[i] || lfoUsedShared[i])
         {
-            lfo[i].process_block();
+            lfo[i].attack();
+
+            if (!lfoStarted[i] && !state.gate)
+                lfo[i].release();
+
+            lfoStarted[i] = true;
+            lfoUsedShared[i] = false;
         }
+
+        lfo[i].process_block();
     }
 
     auto pm = scene->polymode.val.i;
@@ -773,20 +825,46 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, in
         }
     }
 
-    modsources[ms_ampeg]->process_block();
-    modsources[ms_filtereg]->process_block();
+    // these are always our own envelopes, so skip the virtual dispatch
+    ampEGSource.process_block();
+    filterEGSource.process_block();
 
-    if (((ADSRModulationSource *)modsources[ms_ampeg])->is_idle())
+    if (ampEGSource.is_idle())
     {
         state.keep_playing = false;
     }
 
-    // TODO: memcpy is bottleneck
-    // don't actually need to copy everything
-    // LFOs could be ignored when unused
-    // same for FX & OSCs
-    // also ignore integer parameters
-    memcpy(localcopy, paramptr, sizeof(localcopy));
+    /*
+     * Our copy differs from the scene's only where last block's modulation landed, and the
+     * scene's only moved where it says it did, so refreshing just those entries brings us
+     * back to a plain copy. Anything out of step gets the whole copy.
+     */
+    auto &changes = storage->getPatch().scenedataChanges[state.scene_id];
+    auto &routings = storage->audioModulationRoutings();
+
+    if (first || changes.all || changes.generation != localcopyGeneration + 1 ||
+        routings.epoch != localcopyEpoch)
+    {
+        memcpy(localcopy, paramptr, sizeof(localcopy));
+    }
+    else
+    {
+        auto &plan = routings.voicePlan[state.scene_id];
+
+        for (int i = 0; i < changes.count; ++i)
+            localcopy[changes.ids[i]] = paramptr[changes.ids[i]];
+        for (auto id : plan.destination)
+            localcopy[id] = paramptr[id];
+        if (mpeEnabled)
+            for (auto id : plan.mpeAftertouchDestination)
+                localcopy[id] = paramptr[id];
+        // this list only ever grows, so it covers whatever we modulated last block
+        for (int i = 0; i < paramModulationCount; ++i)
+            localcopy[polyphonicParamModulations[i].param_id] =
+                paramptr[polyphonicParamModulations[i].param_id];
+    }
+    localcopyGeneration = changes.generation;
+    localcopyEpoch = routings.epoch;
 
     applyModulationToLocalcopy();
     update_portamento();
@@ -908,6 +986,9 @@ void SurgeVoice::sampleRateReset()
 {
     for (auto &cm : CM)
         cm.setSampleRateAndBlockSize((float)storage->dsamplerate_os, BLOCK_SIZE_OS);
+
+    for (auto &fi : lastFilterCoeffInputs)
+        fi.settled = false;
 }
 
 inline void all_ring_modes_block(float *__restrict src1_l, float *__restrict src2_l,
@@ -1024,9 +1105,21 @@ inline void all_ring_modes_block(float *__restrict src1_l, float *__restrict src
 
 bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 {
-    calc_ctrldata<0>(&Q, Qe);
+    SURGE_TRACE_ZONE("SurgeVoice::process_block");
+
+    // set_path picks the instantiation, this just catches a filter configuration change
+    // which hasn't been through switch_toggled yet
+    if ((scene->filterblock_configuration.val.i == fc_wide) != processBlockWide)
+    {
+        selectProcessBlock();
+    }
+
+    return (this->*processBlockFn)(Q, Qe);
+}
 
-    bool is_wide = scene->filterblock_configuration.val.i == fc_wide;
+template <bool isWide, int fmMode> void SurgeVoice::renderOscillators()
+{
+    constexpr bool is_wide = isWide;
     float tblock alignas(16)[BLOCK_SIZE_OS], tblock2 alignas(16)[BLOCK_SIZE_OS];
     float *tblockR = is_wide ? tblock2 : tblock;
 
@@ -1047,8 +1140,8 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
         }
     }
 
-    if (osc3 || ring23 || ((osc1 || osc2 || ring12) && (FMmode == fm_3to2to1)) ||
-        ((osc1 || ring12) && (FMmode == fm_2and3to1)))
+    if (osc3 || ring23 || ((osc1 || osc2 || ring12) && (fmMode == fm_3to2to1)) ||
+        ((osc1 || ring12) && (fmMode == fm_2and3to1)))
     {
         osc[2]->process_block(
             noteShiftFromPitchParam(
@@ -1059,7 +1152,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
         if (osc3)
         {
-            if (is_wide)
+            if constexpr (is_wide)
             {
                 osclevels[le_osc3].multiply_2_blocks_to(osc[2]->output, osc[2]->outputR, tblock,
                                                         tblockR, BLOCK_SIZE_OS_QUAD);
@@ -1080,9 +1173,9 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
         }
     }
 
-    if (osc2 || ring12 || ring23 || (FMmode && osc1))
+    if (osc2 || ring12 || ring23 || (fmMode != fm_off && osc1))
     {
-        if (FMmode == fm_3to2to1)
+        if constexpr (fmMode == fm_3to2to1)
         {
             osc[1]->process_block(
                 noteShiftFromPitchParam(
@@ -1104,7 +1197,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
         if (osc2)
         {
-            if (is_wide)
+            if constexpr (is_wide)
             {
                 osclevels[le_osc2].multiply_2_blocks_to(osc[1]->output, osc[1]->outputR, tblock,
                                                         tblockR, BLOCK_SIZE_OS_QUAD);
@@ -1127,7 +1220,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
     if (osc1 || ring12)
     {
-        if (FMmode == fm_2and3to1)
+        if constexpr (fmMode == fm_2and3to1)
         {
             mech::add_block<BLOCK_SIZE_OS>(osc[1]->output, osc[2]->output, fmbuffer);
             osc[0]->process_block(
@@ -1138,7 +1231,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
                 drift, is_wide, true,
                 storage->db_to_linear(localcopy[scene->fm_depth.param_id_in_scene].f));
         }
-        else if (FMmode)
+        else if constexpr (fmMode != fm_off)
         {
             osc[0]->process_block(
                 noteShiftFromPitchParam(
@@ -1160,7 +1253,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
         if (osc1)
         {
-            if (is_wide)
+            if constexpr (is_wide)
             {
                 osclevels[le_osc1].multiply_2_blocks_to(osc[0]->output, osc[0]->outputR, tblock,
                                                         tblockR, BLOCK_SIZE_OS_QUAD);
@@ -1222,7 +1315,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
             ((float *)tblock)[i] = sdsp::correlated_noise_o2mk2_supplied_value(
                 noisegenL[0], noisegenL[1], noisecol, storage->rand_pm1());
             ((float *)tblock)[i + 1] = ((float *)tblock)[i];
-            if (is_wide)
+            if constexpr (is_wide)
             {
                 if (is_stereo_noise)
                 {
@@ -1238,7 +1331,7 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
             }
         }
 
-        if (is_wide)
+        if constexpr (is_wide)
         {
             osclevels[le_noise].multiply_2_blocks(tblock, tblockR, BLOCK_SIZE_OS_QUAD);
         }
@@ -1259,40 +1352,137 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
     // pre-filter gain
     osclevels[le_pfg].multiply_2_blocks(output[0], output[1], BLOCK_SIZE_OS_QUAD);
+}
+
+template <bool isWide, int fmMode>
+bool SurgeVoice::processBlockFor(QuadFilterChainState &Q, int Qe)
+{
+    calc_ctrldata<0>(&Q, Qe);
+
+    // a bend or retune since note on means the oscillators no longer match the hit
+    if ((frozenReplay || frozenRecording) && state.pitch != frozenPitch)
+        detachFrozenHit();
+
+    if (frozenReplay)
+    {
+        if (frozenBlock < frozenHit->lengthBlocks)
+        {
+            memcpy(output[0], frozenHit->block(frozenBlock, 0), sizeof(output[0]));
+            memcpy(output[1], frozenHit->block(frozenBlock, 1), sizeof(output[1]));
+        }
+        else
+        {
+            // the amp envelope has closed by now, so this is never heard
+            mech::clear_block<BLOCK_SIZE_OS>(output[0]);
+            mech::clear_block<BLOCK_SIZE_OS>(output[1]);
+        }
+        frozenBlock++;
+    }
+    else
+    {
+        renderOscillators<isWide, fmMode>();
 
-    for (int i = 0; i < BLOCK_SIZE_OS; i++)
+        if (frozenRecording)
+        {
+            memcpy(frozenHit->block(frozenBlock, 0), output[0], sizeof(output[0]));
+            memcpy(frozenHit->block(frozenBlock, 1), output[1], sizeof(output[1]));
+
+            if (++frozenBlock == frozenHit->lengthBlocks)
+            {
+                frozenHit->complete = true;
+                frozenRecording = false;
+            }
+        }
+    }
+
+    if (startSampleOffset > 0)
     {
-        SIMD_MM(store_ss)(((float *)&Q.DL[i] + Qe), SIMD_MM(load_ss)(&output[0][i]));
-        SIMD_MM(store_ss)(((float *)&Q.DR[i] + Qe), SIMD_MM(load_ss)(&output[1][i]));
+        // the note arrived part way through the block, so don't sound before it did
+        auto n = std::min(startSampleOffset * (BLOCK_SIZE_OS / BLOCK_SIZE), BLOCK_SIZE_OS);
+        memset(output[0], 0, n * sizeof(float));
+        memset(output[1], 0, n * sizeof(float));
+        startSampleOffset = 0;
     }
+
     SetQFB(&Q, Qe);
 
     age++;
     if (!state.gate)
         age_release++;
 
+    /*
+     * A long release can sit far below anything audible for seconds. Once this voice's
+     * output (after the filters, feedback and amp envelope) has stayed under the user's
+     * threshold for long enough, end it as if the envelope had finished.
+     */
+    // a recording runs for its whole length, even once the note has finished
+    if (frozenRecording)
+        return true;
+
+    if (!state.gate && silentBlocks * BLOCK_SIZE * storage->samplerate_inv >=
+                           SurgeStorage::silentVoiceHoldSeconds)
+        return false;
+
     return state.keep_playing;
 }
 
+void SurgeVoice::storeQuadInputs(QuadFilterChainState &Q, SurgeVoice *const *v, int n)
+{
+    static const float silence alignas(16)[BLOCK_SIZE_OS]{};
+
+    for (int c = 0; c < 2; ++c)
+    {
+        const float *src[4];
+        for (int e = 0; e < 4; ++e)
+            src[e] = e < n ? v[e]->output[c] : silence;
+
+        auto dst = c == 0 ? Q.DL : Q.DR;
+
+        for (int i = 0; i < BLOCK_SIZE_OS; i += 4)
+        {
+            auto r0 = SIMD_MM(load_ps)(src[0] + i), r1 = SIMD_MM(load_ps)(src[1] + i);
+            auto r2 = SIMD_MM(load_ps)(src[2] + i), r3 = SIMD_MM(load_ps)(src[3] + i);
+
+            auto t0 = SIMD_MM(unpacklo_ps)(r0, r1), t1 = SIMD_MM(unpacklo_ps)(r2, r3);
+            auto t2 = SIMD_MM(unpackhi_ps)(r0, r1), t3 = SIMD_MM(unpackhi_ps)(r2, r3);
+            dst[i] = SIMD_MM(movelh_ps)(t0, t1);
+            dst[i + 1] = SIMD_MM(movehl_ps)(t1, t0);
+            dst[i + 2] = SIMD_MM(movelh_ps)(t2, t3);
+            dst[i + 3] = SIMD_MM(movehl_ps)(t3, t2);
+        }
+    }
+}
+
 template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
 {
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    auto &plan = storage->audioModulationRoutings().voicePlan[state.scene_id];
+
+    // read each source output the plan uses once, then apply the routings in order
+    float slotValues alignas(16)[Surge::Storage::CompiledVoiceModulation::maxSlots];
+    auto nSlots = plan.slotSource.size();
+
+    for (size_t i = 0; i < nSlots; ++i)
     {
-        int src_id = iter->source_id;
-        int dst_id = iter->destination_id;
-        float depth = iter->depth;
+        auto src_id = plan.slotSource[i];
 
-        if (noLFOSources && isLFO((::modsources)src_id))
+        if ((noLFOSources && isLFO((::modsources)src_id)) || !modsources[src_id])
         {
+            slotValues[i] = 0.f;
         }
-        else if (modsources[src_id])
+        else
         {
-            localcopy[dst_id].f +=
-                depth * modsources[src_id]->get_output(iter->source_index) * (1.0 - iter->muted);
+            slotValues[i] = modsources[src_id]->get_output(plan.slotIndex[i]);
         }
-        iter++;
+    }
+
+    auto nRoutings = plan.destination.size();
+    auto *dst = plan.destination.data();
+    auto *slot = plan.slot.data();
+    auto *depth = plan.depth.data();
+
+    for (size_t i = 0; i < nRoutings; ++i)
+    {
+        localcopy[dst[i]].f += depth[i] * slotValues[slot[i]];
     }
 
     if (mpeEnabled)
@@ -1300,38 +1490,31 @@ template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
         // See github issue 1214. This basically compensates for
         // channel AT being per-voice in MPE mode (since it is per channel)
         // vs per-scene (since it is per keyboard in non MPE mode).
-        iter = scene->modulation_scene.begin();
-        while (iter != scene->modulation_scene.end())
+        if (modsources[ms_aftertouch])
         {
-            int src_id = iter->source_id;
-            if (src_id == ms_aftertouch && modsources[src_id])
+            auto at = modsources[ms_aftertouch]->get_output(0);
+            auto nAT = plan.mpeAftertouchDestination.size();
+
+            for (size_t i = 0; i < nAT; ++i)
             {
-                int dst_id = iter->destination_id;
-                // I don't THINK we need this but am not sure the global params are in my localcopy
-                // span
-                if (dst_id >= 0 && dst_id < n_scene_params)
-                {
-                    float depth = iter->depth;
-                    localcopy[dst_id].f +=
-                        depth * modsources[src_id]->get_output(0) * (1.0 - iter->muted);
-                }
+                localcopy[plan.mpeAftertouchDestination[i]].f += plan.mpeAftertouchDepth[i] * at;
             }
-            iter++;
         }
 
-        monoAftertouchSource.set_target(state.voiceChannelState->pressure +
-                                        noteExpressions[PRESSURE]);
-        timbreSource.set_target(state.voiceChannelState->timbre + noteExpressions[TIMBRE]);
+        auto pressure = state.voiceChannelState->pressure + noteExpressions[PRESSURE];
 
         if (scene->modsource_doprocess[ms_aftertouch])
         {
-            monoAftertouchSource.process_block();
+            monoAftertouchSource.smooth_towards(pressure);
+        }
+        else
+        {
+            monoAftertouchSource.set_target(pressure);
         }
-        timbreSource.process_block();
+        timbreSource.smooth_towards(state.voiceChannelState->timbre + noteExpressions[TIMBRE]);
 
         float bendNormalized = state.voiceChannelState->pitchBend / 8192.f;
-        state.mpePitchBend.set_target(bendNormalized);
-        state.mpePitchBend.process_block();
+        state.mpePitchBend.smooth_towards(bendNormalized);
     }
     else
     {
@@ -1342,8 +1525,7 @@ template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
 
         // TimbreSource used to be ignored in non-MPE mode; now it just echose the
         // note expression
-        timbreSource.set_target(noteExpressions[TIMBRE]);
-        timbreSource.process_block();
+        timbreSource.smooth_towards(noteExpressions[TIMBRE]);
     }
 
     for (int i = 0; i < paramModulationCount; ++i)
@@ -1381,6 +1563,30 @@ void SurgeVoice::set_path(bool osc1, bool osc2, bool osc3, int FMmode, bool ring
     this->ring12 = ring12;
     this->ring23 = ring23;
     this->noise = noise;
+
+    selectProcessBlock();
+}
+
+template <bool isWide> SurgeVoice::ProcessBlockFn SurgeVoice::processBlockForFM(int fmMode)
+{
+    switch (fmMode)
+    {
+    case fm_2to1:
+        return &SurgeVoice::processBlockFor<isWide, fm_2to1>;
+    case fm_3to2to1:
+        return &SurgeVoice::processBlockFor<isWide, fm_3to2to1>;
+    case fm_2and3to1:
+        return &SurgeVoice::processBlockFor<isWide, fm_2and3to1>;
+    default:
+        return &SurgeVoice::processBlockFor<isWide, fm_off>;
+    }
+}
+
+void SurgeVoice::selectProcessBlock()
+{
+    processBlockWide = scene->filterblock_configuration.val.i == fc_wide;
+    processBlockFn =
+        processBlockWide ? processBlockForFM<true>(FMmode) : processBlockForFM<false>(FMmode);
 }
 
 void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ialise)
@@ -1473,15 +1679,10 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
         if (scene->f2_cutoff_is_offset.val.b)
             cutoffB += cutoffA;
 
-        CM[0].MakeCoeffs(cutoffA, localcopy[id_resoa].f,
-                         static_cast<FilterType>(scene->filterunit[0].type.val.i),
-                         static_cast<FilterSubType>(scene->filterunit[0].subtype.val.i), storage,
-                         scene->filterunit[0].cutoff.extend_range);
-        CM[1].MakeCoeffs(
-            cutoffB, scene->f2_link_resonance.val.b ? localcopy[id_resoa].f : localcopy[id_resob].f,
-            static_cast<FilterType>(scene->filterunit[1].type.val.i),
-            static_cast<FilterSubType>(scene->filterunit[1].subtype.val.i), storage,
-            scene->filterunit[1].cutoff.extend_range);
+        makeFilterCoeffs(0, cutoffA, localcopy[id_resoa].f);
+        makeFilterCoeffs(1, cutoffB,
+                         scene->f2_link_resonance.val.b ? localcopy[id_resoa].f
+                                                        : localcopy[id_resob].f);
 
         for (int u = 0; u < n_filterunits_per_scene; u++)
         {
@@ -1493,7 +1694,7 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
                     set1f(Q->FU[u].R[i], e, FBP.FU[u].R[i]);
                 }
 
-                Q->FU[u].DB[e] = FBP.Delay[u];
+                Q->FU[u].DB[e] = combDelay[u];
                 Q->FU[u].WP[e] = FBP.FU[u].WP;
 
                 if (scene->filterblock_configuration.val.i == fc_wide)
@@ -1504,7 +1705,7 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
                         set1f(Q->FU[u + 2].R[i], e, FBP.FU[u + 2].R[i]);
                     }
 
-                    Q->FU[u + 2].DB[e] = FBP.Delay[u + 2];
+                    Q->FU[u + 2].DB[e] = combDelay[u + 2];
                     Q->FU[u + 2].WP[e] = FBP.FU[u].WP;
                 }
             }
@@ -1512,6 +1713,56 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
     }
 }
 
+void SurgeVoice::makeFilterCoeffs(int u, float cutoff, float reso)
+{
+    using namespace sst::filters;
+
+    auto &fu = scene->filterunit[u];
+    auto &last = lastFilterCoeffInputs[u];
+    auto type = fu.type.val.i;
+    auto subtype = fu.subtype.val.i;
+
+    // a retuned cutoff also depends on the tuning, which can change under us
+    bool retuned =
+        fu.cutoff.extend_range && storage->tuningApplicationMode == SurgeStorage::RETUNE_ALL;
+
+    if (last.settled && !retuned && last.cutoff == cutoff && last.reso == reso &&
+        last.type == type && last.subtype == subtype)
+    {
+        // this is what FromDirect would do with an unchanged target
+        for (int i = 0; i < n_cm_coeffs; i++)
+        {
+            CM[u].dC[i] = (CM[u].tC[i] - CM[u].C[i]) * BLOCK_SIZE_OS_INV;
+        }
+
+        return;
+    }
+
+    float priorTarget[n_cm_coeffs];
+    memcpy(priorTarget, CM[u].tC, sizeof(priorTarget));
+
+    // the synth has already made these for the scene, see processSharedFilterCoeffs
+    auto &shared = scene->sharedFilterCoeffs[u];
+    if (shared.valid && shared.cutoff == cutoff && shared.reso == reso && shared.type == type &&
+        shared.subtype == subtype)
+    {
+        CM[u].FromDirect(shared.C);
+    }
+    else
+    {
+        CM[u].MakeCoeffs(cutoff, reso, static_cast<FilterType>(type),
+                         static_cast<FilterSubType>(subtype), storage, fu.cutoff.extend_range);
+    }
+
+    last.cutoff = cutoff;
+    last.reso = reso;
+    last.type = type;
+    last.subtype = subtype;
+
+    // the smoother is at its fixed point once a step leaves the target where it was
+    last.settled = memcmp(priorTarget, CM[u].tC, sizeof(priorTarget)) == 0;
+}
+
 void SurgeVoice::GetQFB()
 {
     using namespace sst::filters;
@@ -1550,13 +1801,21 @@ void SurgeVoice::GetQFB()
     FBP.FBlineL = get1f(fbq->FBlineL, fbqi);
     FBP.FBlineR = get1f(fbq->FBlineR, fbqi);
     FBP.wsLPF = get1f(fbq->wsLPF, fbqi);
+
+    // count how long this voice's output has stayed inaudible in release, see process_block
+    auto threshold = storage->silentVoiceThreshold.load(std::memory_order_relaxed);
+    if (threshold > 0.f && !state.gate && get1f(fbq->LanePeak, fbqi) < threshold)
+        silentBlocks++;
+    else
+        silentBlocks = 0;
 }
 
 void SurgeVoice::freeAllocatedElements()
 {
     for (int i = 0; i < n_oscs; ++i)
     {
-        osc[i]->~Oscillator();
+        if (osc[i])
+            osc[i]->~Oscillator();
         osc[i] = nullptr;
         osctype[i] = -1;
     }
@@ -1564,6 +1823,40 @@ void SurgeVoice::freeAllocatedElements()
     {
         lfo[i].completedModulation();
     }
+    if (frozenHit)
+    {
+        frozenHits->endHit(frozenHit);
+        frozenHit = nullptr;
+    }
+    frozenReplay = false;
+    frozenRecording = false;
+}
+
+void SurgeVoice::replayFrozenHit(Surge::Voice::FrozenHitCache *cache,
+                                 Surge::Voice::FrozenHitCache::Hit *hit)
+{
+    frozenHits = cache;
+    frozenHit = hit;
+    frozenReplay = true;
+    frozenBlock = 0;
+    frozenPitch = state.pitch;
+}
+
+void SurgeVoice::recordFrozenHit(Surge::Voice::FrozenHitCache *cache,
+                                 Surge::Voice::FrozenHitCache::Hit *hit)
+{
+    frozenHits = cache;
+    frozenHit = hit;
+    frozenRecording = true;
+    frozenBlock = 0;
+    frozenPitch = state.pitch;
+}
+
+void SurgeVoice::detachFrozenHit()
+{
+    // this can run on a voice thread, so the hit itself is handed back in freeAllocatedElements
+    frozenReplay = false;
+    frozenRecording = false;
 }
 
 void SurgeVoice::applyPolyphonicParamModulation(Parameter *p, double value,
@@ -1572,31 +1865,31 @@ void SurgeVoice::applyPolyphonicParamModulation(Parameter *p, double value,
     // For a discussion of underlyingMonoMod please see the comment in
     // SurgeSynthesizer::applyParameterPolyphonicModulation
 
-    // quickly do a search to see if i'm there
+    if (frozenHit && Surge::Voice::FrozenHitCache::shapesHit(*scene, *p))
+        detachFrozenHit();
+
     int param_id = p->param_id_in_scene;
-    for (int i = 0; i < paramModulationCount; ++i)
+    auto slot = polyphonicParamModulationSlot[param_id];
+    if (slot)
     {
-        if (polyphonicParamModulations[i].param_id == param_id)
+        auto &pp = polyphonicParamModulations[slot - 1];
+        pp.vt_type = (valtypes)p->valtype;
+        switch (pp.vt_type)
         {
-            auto &pp = polyphonicParamModulations[i];
-            pp.vt_type = (valtypes)p->valtype;
-            switch (pp.vt_type)
-            {
-            case vt_float:
-                pp.value = value * (p->val_max.f - p->val_min.f);
-                break;
-            case vt_int:
-                pp.value = value * (p->val_max.i - p->val_min.i);
-                pp.imin = p->val_min.i;
-                pp.imax = p->val_max.i;
-                break;
-            case vt_bool:
-                pp.value = value;
-            }
-
-            pp.value -= underlyingMonoMod;
-            return;
+        case vt_float:
+            pp.value = value * (p->val_max.f - p->val_min.f);
+            break;
+        case vt_int:
+            pp.value = value * (p->val_max.i - p->val_min.i);
+            pp.imin = p->val_min.i;
+            pp.imax = p->val_max.i;
+            break;
+        case vt_bool:
+            pp.value = value;
         }
+
+        pp.value -= underlyingMonoMod;
+        return;
     }
     int idx = paramModulationCount;
     assert(paramModulationCount < maxPolyphonicParamModulations);
@@ -1621,6 +1914,7 @@ void SurgeVoice::applyPolyphonicParamModulation(Parameter *p, double value,
 
         pp.value -= underlyingMonoMod;
         paramModulationCount++;
+        polyphonicParamModulationSlot[param_id] = (uint8_t)paramModulationCount;
     }
 }
 
@@ -1638,6 +1932,10 @@ void SurgeVoice::retriggerLFOEnvelopes()
         auto &anLfo = lfo[i];
         auto &lfoData = scene->lfo[i];
 
+        // one which hasn't started yet gets a fresh attack when it does
+        if (!lfoStarted[i])
+            continue;
+
         if (lfoData.trigmode.val.i == lm_keytrigger)
         {
             anLfo.attack();
@@ -1673,7 +1971,14 @@ void SurgeVoice::resetPortamentoFrom(int key, int channel)
 #ifndef SURGE_SKIP_ODDSOUND_MTS
         if (storage->oddsound_mts_client && storage->oddsound_mts_active_as_client)
         {
-            lk += MTS_RetuningInSemitones(storage->oddsound_mts_client, lk, channel);
+            auto retune = [this, key, channel]() {
+                return (float)MTS_RetuningInSemitones(storage->oddsound_mts_client, key, channel);
+            };
+
+            if (auto table = storage->currentMTSRetuningTable())
+                lk += table->get(key, channel, retune);
+            else
+                lk += retune();
             state.portasrc_key = lk;
         }
         else
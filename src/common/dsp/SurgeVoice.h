@@ -29,17 +29,32 @@
 #include "LFOModulationSource.h"
 #include <vembertech/lipol.h>
 #include "QuadFilterChain.h"
+#include "FrozenHitCache.h"
 #include <array>
 
 struct QuadFilterChainState;
 
-class alignas(16) SurgeVoice
+/*
+ * Voices sit next to each other in SurgeSynthesizer::voices_array and get walked every block,
+ * sometimes from several threads at once. So each starts on its own cache line, the state the
+ * voice management reads comes first, the block rate working data follows, and the bulky
+ * scratch (oscillator storage and the comb delay lines, some 80k) is kept at the very end,
+ * out of the way of all of it.
+ */
+class alignas(64) SurgeVoice
 {
   public:
+    int osctype[n_oscs];
+    SurgeVoiceState state;
+    int age, age_release;
+    int silentBlocks{0}; // released blocks in a row below storage->silentVoiceThreshold
+
+    // samples into the first block at which this voice starts; see noteOnSampleOffset
+    int startSampleOffset{0};
+
     float output alignas(16)[2][BLOCK_SIZE_OS];
     lipol_ps osclevels alignas(16)[7];
     pdata localcopy alignas(16)[n_scene_params];
-    pdata localcopy2 alignas(16)[n_scene_params];
     float fmbuffer alignas(16)[BLOCK_SIZE_OS];
 
     // used for the 2>1<3 FM-mode (Needs the pointer earlier)
@@ -58,13 +73,16 @@ class alignas(16) SurgeVoice
 
     void sampleRateReset();
     bool process_block(QuadFilterChainState &, int);
+    /*
+     * process_block leaves the oscillator mix in output. Once all of a quad's voices have run,
+     * this moves the n of them into Q's input lanes four samples at a time, silencing the
+     * lanes without one.
+     */
+    static void storeQuadInputs(QuadFilterChainState &Q, SurgeVoice *const *v, int n);
     void GetQFB(); // Get the updated registers from the QuadFB
     void legato(int key, int velocity, char detune);
     void switch_toggled();
     void freeAllocatedElements();
-    int osctype[n_oscs];
-    SurgeVoiceState state;
-    int age, age_release;
 
     bool matchesChannelKeyId(int16_t channel, int16_t key, int32_t host_noteid);
 
@@ -86,6 +104,11 @@ class alignas(16) SurgeVoice
     int32_t paramModulationCount{0};
     static constexpr int maxPolyphonicParamModulations = 64;
     std::array<PolyphonicParamModulation, maxPolyphonicParamModulations> polyphonicParamModulations;
+    // Where each scene parameter lives in polyphonicParamModulations, plus one so the zero
+    // initialized table means 'not modulated'. Hosts can send hundreds of poly mod events a
+    // block so we don't want to search the list for every one.
+    std::array<uint8_t, n_scene_params> polyphonicParamModulationSlot{};
+    static_assert(maxPolyphonicParamModulations < 256);
     // See comment in SurgeSynthesizer::applyParameterPolyphonicModulation for why this has 2 args
     void applyPolyphonicParamModulation(Parameter *, double value, double underlyingMonoMod);
 
@@ -212,6 +235,22 @@ class alignas(16) SurgeVoice
     static float channelKeyEquvialent(float key, int channel, bool isMpeEnabled,
                                       SurgeStorage *storage, bool remapKeyForTuning = true);
 
+    bool filterCoefficientsSettled(int u) const { return lastFilterCoeffInputs[u].settled; }
+
+    /*
+     * Freeze voices, see Surge::Voice::FrozenHitCache. Right after construction the synth
+     * either hands this voice a finished hit to play back in place of its oscillators, or a
+     * fresh one to record them into. Either way it is ours until freeAllocatedElements.
+     * Detaching goes back to running the oscillators and is safe from the voice's own thread.
+     */
+    void replayFrozenHit(Surge::Voice::FrozenHitCache *cache,
+                         Surge::Voice::FrozenHitCache::Hit *hit);
+    void recordFrozenHit(Surge::Voice::FrozenHitCache *cache,
+                         Surge::Voice::FrozenHitCache::Hit *hit);
+    void detachFrozenHit();
+    // how many blocks a recording of this note needs, or -1 if its amp envelope isn't one shot
+    int oneShotLengthBlocks() const { return ampEGSource.oneShotBlocks(); }
+
   private:
     template <bool first> void calc_ctrldata(QuadFilterChainState *, int);
 
@@ -228,14 +267,32 @@ class alignas(16) SurgeVoice
      * calc_ctrldata)
      */
     template <bool noLFOSources = false> void applyModulationToLocalcopy();
+    // the scenedata change generation and routing epoch localcopy was last brought up to
+    uint64_t localcopyGeneration{0}, localcopyEpoch{0};
 
     void update_portamento();
     void set_path(bool osc1, bool osc2, bool osc3, int FMmode, bool ring12, bool ring23,
                   bool noise);
+
+    /*
+     * process_block for one filter block width and FM routing, so the mixing and the FM
+     * plumbing carry no checks on either. set_path points processBlockFn at the one the
+     * scene uses, much like GetFBQPointer does for the filter chain.
+     */
+    template <bool isWide, int fmMode> bool processBlockFor(QuadFilterChainState &, int);
+    typedef bool (SurgeVoice::*ProcessBlockFn)(QuadFilterChainState &, int);
+    template <bool isWide> static ProcessBlockFn processBlockForFM(int fmMode);
+    // oscillators, ring modulators and noise through the mixer into output
+    template <bool isWide, int fmMode> void renderOscillators();
+    void selectProcessBlock();
     int routefilter(int);
     void retriggerPortaIfKeyChanged();
 
     LFOModulationSource lfo[n_lfos_voice];
+    // reading the scene's shared copy of this LFO last block, so our own one is stale
+    bool lfoUsedShared[n_lfos_voice]{};
+    // attacked yet; LFOs nothing modulates from wait for their first use, see calc_ctrldata
+    bool lfoStarted[n_lfos_voice]{};
 
     // Filterblock state storage
     void SetQFB(QuadFilterChainState *, int); // Set the parameters & registers
@@ -245,8 +302,6 @@ class alignas(16) SurgeVoice
     struct
     {
         float Gain, FB, Mix1, Mix2, OutL, OutR, Out2L, Out2R, Drive, wsLPF, FBlineL, FBlineR;
-        float Delay[4][sst::filters::utilities::MAX_FB_COMB +
-                       sst::filters::utilities::SincTable::FIRipol_N];
         struct
         {
             float C[sst::filters::n_cm_coeffs], R[sst::filters::n_filter_registers];
@@ -260,6 +315,20 @@ class alignas(16) SurgeVoice
     } FBP;
     sst::filters::FilterCoefficientMaker<SurgeStorage> CM[2];
 
+    /*
+     * What each filter unit's coefficients were last made from. A static pad holds its
+     * cutoff and resonance for block after block, and once the coefficient smoother has
+     * settled, remaking them from the same inputs would return exactly what we already
+     * have, so makeFilterCoeffs then only refreshes the per-sample delta.
+     */
+    struct FilterCoeffInputs
+    {
+        float cutoff{0.f}, reso{0.f};
+        int type{-1}, subtype{-1};
+        bool settled{false};
+    } lastFilterCoeffInputs[n_filterunits_per_scene];
+    void makeFilterCoeffs(int u, float cutoff, float reso);
+
     // data
     int lag_id[8], pitch_id, octave_id, volume_id, pan_id, width_id;
     SurgeSceneStorage *scene;
@@ -271,10 +340,17 @@ class alignas(16) SurgeVoice
 
     bool osc1, osc2, osc3, ring12, ring23, noise;
     int FMmode;
+    ProcessBlockFn processBlockFn{nullptr};
+    bool processBlockWide{false};
     float noisegenL[2], noisegenR[2];
 
     Oscillator *osc[n_oscs];
-    unsigned char oscbuffer alignas(16)[n_oscs][oscillator_buffer_size];
+
+    Surge::Voice::FrozenHitCache *frozenHits{nullptr};
+    Surge::Voice::FrozenHitCache::Hit *frozenHit{nullptr};
+    bool frozenReplay{false}, frozenRecording{false};
+    int frozenBlock{0};
+    float frozenPitch{0.f};
 
   public: // this is public, but only for the regtests
     std::array<ModulationSource *, n_modsources> modsources;
@@ -297,6 +373,12 @@ class alignas(16) SurgeVoice
 
     // MPE special cases
     bool mpeEnabled;
+
+  private:
+    // the cold bulk storage, see the comment at the top
+    unsigned char oscbuffer alignas(16)[n_oscs][oscillator_buffer_size];
+    float combDelay alignas(16)[4][sst::filters::utilities::MAX_FB_COMB +
+                                   sst::filters::utilities::SincTable::FIRipol_N];
 };
 
 void all_ring_modes_block(float *__restrict src1_l, float *__restrict src2_l,
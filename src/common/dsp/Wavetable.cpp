@@ -24,6 +24,16 @@
 #include "DSPUtils.h"
 #include <vembertech/basic_dsp.h>
 #include "SurgeStorage.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 namespace mech = sst::basic_blocks::mechanics;
@@ -61,6 +71,8 @@ const int HRFilterI16[64] = {
 
 int min_F32_tables = 3;
 
+static_assert(Wavetable::i16SampleOffset == FIRoffsetI16, "sampleAt skips the int16 padding");
+
 #if MAC || LINUX
 bool _BitScanReverse(unsigned int *result, unsigned int bits)
 {
@@ -97,13 +109,126 @@ int GetWTIndex(int WaveIdx, int WaveSize, int NumWaves, int MipMap, int Padding
     return Index;
 }
 
+/*
+ * The process wide cache of built tables. It only holds weak references, so a table lives
+ * exactly as long as some Wavetable uses it. Tables are keyed by their header and a hash of
+ * their source data, which is all that goes into building them.
+ */
+namespace
+{
+struct TableCache
+{
+    std::mutex lock;
+    std::map<Wavetable::BuildKey, std::weak_ptr<Wavetable::TableData>> tables;
+
+    static TableCache &get()
+    {
+        static TableCache instance;
+        return instance;
+    }
+
+    std::shared_ptr<Wavetable::TableData> find(const Wavetable::BuildKey &k)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        auto it = tables.find(k);
+        if (it == tables.end())
+            return nullptr;
+
+        auto res = it->second.lock();
+        if (!res)
+            tables.erase(it);
+        return res;
+    }
+
+    void insert(const Wavetable::BuildKey &k, const std::shared_ptr<Wavetable::TableData> &d)
+    {
+        std::lock_guard<std::mutex> g(lock);
+
+        // sweep out the tables nobody uses any more while we are here
+        for (auto it = tables.begin(); it != tables.end();)
+        {
+            if (it->second.expired())
+                it = tables.erase(it);
+            else
+                ++it;
+        }
+        tables[k] = d;
+    }
+};
+
+// FNV-1a over 64 bit words, with the tail bytes folded in at the end
+uint64_t hashTableSource(const void *data, size_t bytes)
+{
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    uint64_t h = 0xcbf29ce484222325ULL ^ bytes;
+
+    auto p = static_cast<const unsigned char *>(data);
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * prime;
+    }
+    for (; i < bytes; ++i)
+        h = (h ^ p[i]) * prime;
+
+    return h;
+}
+
+// a table which has never been built reads silence from here
+constexpr size_t defaultDataSizes = 35000;
+
+std::shared_ptr<Wavetable::TableData> emptyTableData()
+{
+    static auto empty = std::make_shared<Wavetable::TableData>(defaultDataSizes);
+    return empty;
+}
+} // namespace
+
+bool Wavetable::BuildKey::operator<(const BuildKey &o) const
+{
+    return std::tie(hash, size, sourceTables, flags, appendSilence, compact) <
+           std::tie(o.hash, o.size, o.sourceTables, o.flags, o.appendSilence, o.compact);
+}
+
+Wavetable::TableData::TableData(size_t n, bool c) : dataSizes(n), compact(c)
+{
+    // the int16 data starts on a cache line of its own after the floats
+    auto f32Bytes = compact ? 0 : (dataSizes * sizeof(float) + 63) / 64 * 64;
+    memory = Surge::Memory::LargeBlock(f32Bytes + dataSizes * sizeof(short));
+
+    auto base = static_cast<char *>(memory.data());
+    f32 = compact ? nullptr : reinterpret_cast<float *>(base);
+    i16 = reinterpret_cast<short *>(base + f32Bytes);
+}
+
+size_t Wavetable::sharedTableCount()
+{
+    auto &c = TableCache::get();
+    std::lock_guard<std::mutex> g(c.lock);
+
+    size_t res = 0;
+    for (auto &[k, t] : c.tables)
+        res += t.expired() ? 0 : 1;
+    return res;
+}
+
+size_t Wavetable::sharedTableFloats()
+{
+    auto &c = TableCache::get();
+    std::lock_guard<std::mutex> g(c.lock);
+
+    size_t res = 0;
+    for (auto &[k, t] : c.tables)
+        if (auto d = t.lock())
+            res += d->dataSizes;
+    return res;
+}
+
 Wavetable::Wavetable()
 {
-    dataSizes = 35000;
-    TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-    TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-    memset(TableF32Data, 0, dataSizes * sizeof(float));
-    memset(TableI16Data, 0, dataSizes * sizeof(short));
+    useTableData(emptyTableData());
     memset(TableF32WeakPointers, 0, sizeof(TableF32WeakPointers));
     memset(TableI16WeakPointers, 0, sizeof(TableI16WeakPointers));
     current_id = -1;
@@ -112,21 +237,38 @@ Wavetable::Wavetable()
     refresh_display = true; // I have never been drawn so assume I need refresh if asked
 }
 
-Wavetable::~Wavetable()
+Wavetable::~Wavetable() {}
+
+void Wavetable::describeTableData()
+{
+    auto &d = *tableData;
+    d.size = size;
+    d.n_tables = n_tables;
+    d.flags = flags;
+
+    d.levels = 1;
+    while (((1 << d.levels) < size) & (d.levels < max_mipmap_levels))
+        d.levels++;
+
+    // a full range int16 source keeps its range in the int16 data, see WindowOscillator
+    bool fullRange = (flags & wtf_int16) && (flags & wtf_int16_is_16);
+    d.i16Scale = fullRange ? 1.f / 32768.f : 1.f / 16384.f;
+    i16Scale = d.i16Scale;
+}
+
+void Wavetable::useTableData(std::shared_ptr<TableData> d)
 {
-    free(TableF32Data);
-    free(TableI16Data);
+    tableData = std::move(d);
+    dataSizes = tableData->dataSizes;
+    TableF32Data = tableData->f32;
+    TableI16Data = tableData->i16;
+    compact = tableData->compact;
+    i16Scale = tableData->i16Scale;
 }
 
-void Wavetable::allocPointers(size_t newSize)
+void Wavetable::allocPointers(size_t newSize, bool compactData)
 {
-    free(TableF32Data);
-    free(TableI16Data);
-    dataSizes = newSize;
-    TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-    TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-    memset(TableF32Data, 0, dataSizes * sizeof(float));
-    memset(TableI16Data, 0, dataSizes * sizeof(short));
+    useTableData(std::make_shared<TableData>(newSize, compactData));
 }
 
 void Wavetable::Copy(Wavetable *wt)
@@ -141,57 +283,68 @@ void Wavetable::Copy(Wavetable *wt)
     queue_id = -1;
     everBuilt = wt->everBuilt;
 
-    if (dataSizes < wt->dataSizes)
-    {
-        allocPointers(wt->dataSizes);
-    }
+    // the data is never written once built, so the copy shares it along with its layout
+    buildKey = wt->buildKey;
+    useTableData(wt->tableData);
+    memcpy(TableF32WeakPointers, wt->TableF32WeakPointers, sizeof(TableF32WeakPointers));
+    memcpy(TableI16WeakPointers, wt->TableI16WeakPointers, sizeof(TableI16WeakPointers));
 
-    memcpy(TableF32Data, wt->TableF32Data, dataSizes * sizeof(float));
-    memcpy(TableI16Data, wt->TableI16Data, dataSizes * sizeof(short));
+    current_id = wt->current_id;
+}
 
+void Wavetable::assignTablePointers()
+{
+    /*
+     * Anything past this table points at silence rather than at whichever block the slot
+     * last held, since that block may now be gone
+     */
+    auto empty = emptyTableData();
     for (int i = 0; i < max_mipmap_levels; i++)
     {
         for (int j = 0; j < max_subtables; j++)
         {
-            if (wt->TableF32WeakPointers[i][j])
-            {
-                size_t Offset = wt->TableF32WeakPointers[i][j] - wt->TableF32Data;
-                TableF32WeakPointers[i][j] = TableF32Data + Offset;
-            }
-            else
-                TableF32WeakPointers[i][j] = NULL;
-
-            if (wt->TableI16WeakPointers[i][j])
-            {
-                size_t Offset = wt->TableI16WeakPointers[i][j] - wt->TableI16Data;
-                TableI16WeakPointers[i][j] = TableI16Data + Offset;
-            }
-            else
-                TableI16WeakPointers[i][j] = NULL;
+            TableF32WeakPointers[i][j] = empty->f32;
+            TableI16WeakPointers[i][j] = empty->i16;
         }
     }
 
-    current_id = wt->current_id;
-}
-
-bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
-{
-    assert(wdata);
-
-    flags = mech::endian_read_int16LE(wh.flags);
-    n_tables = mech::endian_read_int16LE(wh.n_tables);
-    size = mech::endian_read_int32LE(wh.n_samples);
+    int levels = 1;
+    while (((1 << levels) < size) & (levels < max_mipmap_levels))
+        levels++;
 
-    size_t req_size = RequiredWTSize(size, n_tables);
+    for (int j = 0; j < (int)n_tables; j++)
+    {
+        for (int l = 0; l < levels; l++)
+        {
+            if (TableF32Data)
+                TableF32WeakPointers[l][j] = TableF32Data + GetWTIndex(j, size, n_tables, l);
+            // + padding for a non-wrapping interpolator
+            TableI16WeakPointers[l][j] =
+                TableI16Data + GetWTIndex(j, size, n_tables, l, FIRipolI16_N);
+        }
+    }
 
-    if (req_size > dataSizes)
+    for (int j = n_tables; j < min_F32_tables && TableF32Data; j++)
     {
-        allocPointers(req_size);
+        unsigned int s = size;
+        int l = 0;
+
+        while (s && (l < max_mipmap_levels))
+        {
+            TableF32WeakPointers[l][j] = TableF32Data + GetWTIndex(j, size, n_tables, l);
+            s = s >> 1;
+            l++;
+        }
     }
+}
 
-    int wdata_tables = n_tables;
+void Wavetable::setLayout(const BuildKey &key)
+{
+    flags = key.flags;
+    size = key.size;
+    n_tables = key.sourceTables;
 
-    if (AppendSilence)
+    if (key.appendSilence)
     {
         n_tables += 3; // this "3" should match the "3" in RequiredWTSize
     }
@@ -208,38 +361,97 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
 
     dt = 1.0f / size;
 
-    for (int i = 0; i < max_mipmap_levels; i++)
+    buildKey = key;
+}
+
+bool Wavetable::AdoptSharedWT(const BuildKey &key)
+{
+    auto cached = TableCache::get().find(key);
+
+    if (!cached)
     {
-        for (int j = 0; j < max_subtables; j++)
-        {
-            // TODO WARNING: Crashes here with patchbyte!
-            /*free(wt->TableF32WeakPointers[i][j]);
-            free(wt->TableI16WeakPointers[i][j]);
-            wt->TableF32WeakPointers[i][j] = 0;
-            wt->TableI16WeakPointers[i][j] = 0;*/
-        }
+        return false;
     }
-    for (int j = 0; j < this->n_tables; j++)
+
+    setLayout(key);
+    useTableData(std::move(cached));
+    assignTablePointers();
+    everBuilt = true;
+    return true;
+}
+
+bool Wavetable::AdoptBuiltWT(const BuildKey &key, std::shared_ptr<TableData> data)
+{
+    // these usually come off disk, so make sure the layout fits before trusting it
+    auto tables = key.sourceTables + (key.appendSilence ? 3 : 0);
+
+    if (!data || key.size <= 0 || key.size > max_wtable_size || key.sourceTables <= 0 ||
+        tables > max_subtables || data->dataSizes < RequiredWTSize(key.size, key.sourceTables))
     {
-        TableF32WeakPointers[0][j] = TableF32Data + GetWTIndex(j, size, n_tables, 0);
-        // + padding for a non-wrapping interpolator
-        TableI16WeakPointers[0][j] = TableI16Data + GetWTIndex(j, size, n_tables, 0, FIRipolI16_N);
+        return false;
     }
-    for (int j = this->n_tables; j < min_F32_tables; j++)
+
+    setLayout(key);
+    useTableData(std::move(data));
+    describeTableData();
+    tableData->levelsReady.store(tableData->levels, std::memory_order_release);
+    assignTablePointers();
+    TableCache::get().insert(key, tableData);
+    everBuilt = true;
+    return true;
+}
+
+bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
+{
+    assert(wdata);
+
+    BuildKey key;
+    key.flags = mech::endian_read_int16LE(wh.flags);
+    key.sourceTables = mech::endian_read_int16LE(wh.n_tables);
+    key.size = mech::endian_read_int32LE(wh.n_samples);
+    key.appendSilence = AppendSilence;
+    key.compact = buildCompact && buildCompact->load();
+
+    auto sourceBytes = (size_t)key.size * key.sourceTables * ((key.flags & wtf_int16) ? 2 : 4);
+    key.hash = hashTableSource(wdata, sourceBytes);
+
+    // somebody in this process has already built exactly this, so there's nothing to do
+    if (AdoptSharedWT(key))
     {
-        unsigned int s = this->size;
-        int l = 0;
+        return true;
+    }
 
-        while (s && (l < max_mipmap_levels))
+    setLayout(key);
+
+    int wdata_tables = key.sourceTables;
+    size_t req_size = RequiredWTSize(size, wdata_tables);
+
+    // a fresh block comes zeroed, which covers the padding tables and the appended silence
+    allocPointers(std::max(req_size, defaultDataSizes), key.compact);
+    describeTableData();
+    assignTablePointers();
+
+    if (compact)
+    {
+        std::vector<float> source(this->flags & wtf_int16 ? 0 : this->size);
+
+        for (int j = 0; j < wdata_tables; j++)
         {
-            TableF32WeakPointers[l][j] = TableF32Data + GetWTIndex(j, size, n_tables, l);
-            memset(TableF32WeakPointers[l][j], 0, s * sizeof(float));
-            s = s >> 1;
-            l++;
+            auto dst = &this->TableI16WeakPointers[0][j][FIRoffsetI16];
+
+            if (this->flags & wtf_int16)
+            {
+                mech::endian_copyblock16LE(dst, &((short *)wdata)[this->size * j], this->size);
+            }
+            else
+            {
+                mech::endian_copyblock32LE((int32_t *)source.data(),
+                                           &((int32_t *)wdata)[this->size * j], this->size);
+                float2i15_block(source.data(), dst, this->size);
+            }
         }
     }
-
-    if (this->flags & wtf_int16)
+    else if (this->flags & wtf_int16)
     {
         for (int j = 0; j < wdata_tables; j++)
         {
@@ -271,7 +483,8 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
     // clear any appended tables (not read, but included in table for post-silence)
     for (int j = wdata_tables; j < this->n_tables; j++)
     {
-        memset(this->TableF32WeakPointers[0][j], 0, this->size * sizeof(float));
+        if (!compact)
+            memset(this->TableF32WeakPointers[0][j], 0, this->size * sizeof(float));
         memset(this->TableI16WeakPointers[0][j], 0, (this->size + FIRoffsetI16) * sizeof(short));
     }
 
@@ -283,86 +496,360 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
                FIRoffsetI16 * sizeof(short));
     }
 
-    MipMapWT();
+    tableData->levelsReady.store(1, std::memory_order_release);
+
+    if (mipmapBuilder && tableData->levels > 1)
+    {
+        mipmapBuilder->enqueue(tableData);
+    }
+    else
+    {
+        MipMapWT();
+    }
+
+    TableCache::get().insert(key, tableData);
 
     everBuilt = true;
     return true;
 }
 
-void Wavetable::MipMapWT()
+namespace
 {
-    int levels = 1;
-    while (((1 << levels) < size) & (levels < max_mipmap_levels))
-        levels++;
-    int ns = this->n_tables;
+constexpr int hrFilterSize = 63;
+constexpr int hrFilterCentre = (hrFilterSize - 1) >> 1;
+
+/*
+ * Run f(s) for each table s in [0, n). A big wavetable is spread over a few short lived
+ * threads; starting them is cheap next to the filtering.
+ */
+template <typename F> void forEachTable(int n, size_t work, F &&f)
+{
+    constexpr size_t minWorkPerThread = 1 << 16;
+
+    int hw = (int)std::thread::hardware_concurrency();
+    int nThreads = std::min({std::min(hw, 8), n, (int)(work / minWorkPerThread)});
+
+    std::atomic<int> next{0};
+    auto drain = [&]() {
+        // the same results whichever thread builds which level
+        auto fpuguard = Surge::FPUState::DSPThreadGuard();
+        int s;
+        while ((s = next.fetch_add(1)) < n)
+            f(s);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < nThreads; ++t)
+    {
+        try
+        {
+            threads.push_back(Surge::Threading::makeThread(Surge::Threading::ThreadRole::Loader,
+                                                           drain));
+        }
+        catch (const std::system_error &)
+        {
+            // whatever we couldn't start, this thread picks up
+            break;
+        }
+    }
+
+    drain();
 
-    const int filter_size = 63;
-    const int filter_id_of = (filter_size - 1) >> 1;
+    for (auto &t : threads)
+        t.join();
+}
+
+/*
+ * One level of the halfband decimator. The previous level is unwrapped so that tap a of
+ * output i is sample 2 * i + a, and split into its even and odd samples so that four
+ * neighbouring outputs read four neighbouring floats for every tap. The taps are summed in
+ * the same order as the scalar filter always has.
+ */
+void decimateF32(const float *even, const float *odd, float *dst, int n)
+{
+    int i = 0;
 
-    for (int l = 1; l < levels; l++)
+    for (; i + 4 <= n; i += 4)
     {
-        int psize = size >> (l - 1);
-        int lsize = size >> l;
+        auto acc = SIMD_MM(setzero_ps)();
 
-        for (int s = 0; s < ns; s++)
+        for (int a = 0; a < hrFilterSize; ++a)
         {
-            this->TableF32WeakPointers[l][s] = TableF32Data + GetWTIndex(s, size, n_tables, l);
-            this->TableI16WeakPointers[l][s] =
-                TableI16Data + GetWTIndex(s, size, n_tables, l, FIRipolI16_N);
+            auto x = SIMD_MM(loadu_ps)(((a & 1) ? odd : even) + i + (a >> 1));
+            acc = SIMD_MM(add_ps)(acc, SIMD_MM(mul_ps)(SIMD_MM(set1_ps)(hrfilter[a]), x));
+        }
 
-            if (this->flags & wtf_is_sample)
-            {
-                for (int i = 0; i < lsize; i++)
-                {
-                    this->TableF32WeakPointers[l][s][i] = 0;
-                    for (int a = 0; a < filter_size; a++)
-                    {
-                        int srcindex = (i << 1) + a - filter_id_of;
-                        int srctable = max(0, s + (srcindex / psize));
-                        srcindex = srcindex & (psize - 1);
-                        if (srctable < ns)
-                            this->TableF32WeakPointers[l][s][i] +=
-                                hrfilter[a] * this->TableF32WeakPointers[l - 1][srctable][srcindex];
-                    }
-                    this->TableI16WeakPointers[l][s][i + FIRoffsetI16] =
-                        0; // not supported in int16 atm
-                }
-            }
-            else
+        SIMD_MM(storeu_ps)(dst + i, acc);
+    }
+
+    for (; i < n; ++i)
+    {
+        float acc = 0.f;
+
+        for (int a = 0; a < hrFilterSize; ++a)
+            acc += hrfilter[a] * (((a & 1) ? odd : even)[i + (a >> 1)]);
+
+        dst[i] = acc;
+    }
+}
+
+// as above for the int16 tables, with the taps padded to 64 so each output is 8 madds
+void decimateI16(const short *src, const short *taps, short *dst, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        auto acc = SIMD_MM(setzero_si128)();
+
+        for (int c = 0; c < 64; c += 8)
+        {
+            auto x = SIMD_MM(loadu_si128)((const SIMD_M128I *)(src + 2 * i + c));
+            auto t = SIMD_MM(load_si128)((const SIMD_M128I *)(taps + c));
+            acc = SIMD_MM(add_epi32)(acc, SIMD_MM(madd_epi16)(x, t));
+        }
+
+        acc = SIMD_MM(add_epi32)(acc, SIMD_MM(shuffle_epi32)(acc, SIMD_MM_SHUFFLE(1, 0, 3, 2)));
+        acc = SIMD_MM(add_epi32)(acc, SIMD_MM(shuffle_epi32)(acc, SIMD_MM_SHUFFLE(2, 3, 0, 1)));
+        dst[i] = (short)(SIMD_MM(cvtsi128_si32)(acc) >> 16);
+    }
+}
+
+// the int16 tables carry FIRoffsetI16 samples of wrap around either side for the interpolator
+void padI16(short *dst, int lsize)
+{
+    auto toCopy = std::min(FIRoffsetI16, lsize);
+    memcpy(&dst[lsize + FIRoffsetI16], &dst[FIRoffsetI16], toCopy * sizeof(short));
+    memcpy(&dst[0], &dst[lsize], toCopy * sizeof(short));
+}
+} // namespace
+
+void Wavetable::TableData::buildMipmapLevel(int l)
+{
+    if (compact)
+    {
+        buildCompactMipmapLevel(l);
+        return;
+    }
+
+    int psize = size >> (l - 1);
+    int lsize = size >> l;
+    int mask = psize - 1;
+    int ns = n_tables;
+
+    auto f32At = [this](int level, int s) { return f32 + GetWTIndex(s, size, n_tables, level); };
+    auto i16At = [this](int level, int s) {
+        return i16 + GetWTIndex(s, size, n_tables, level, FIRipolI16_N);
+    };
+
+    alignas(16) short tapsI16[64];
+    for (int a = 0; a < 64; a++)
+        tapsI16[a] = (a < hrFilterSize) ? (short)HRFilterI16[a] : 0;
+
+    forEachTable(ns, (size_t)psize * ns, [&](int s) {
+        std::vector<float> even(lsize + 32), odd(lsize + 32);
+        auto dstI16 = i16At(l, s);
+
+        if (flags & wtf_is_sample)
+        {
+            // a sample runs on from one table into the next, so each table reads its neighbours
+            for (int k = 0; k < 2 * (lsize + 32); k++)
             {
-                for (int i = 0; i < lsize; i++)
-                {
-                    this->TableF32WeakPointers[l][s][i] = 0;
-                    for (int a = 0; a < filter_size; a++)
-                    {
-                        this->TableF32WeakPointers[l][s][i] +=
-                            hrfilter[a] * this->TableF32WeakPointers[l - 1][s][(
-                                              ((i << 1) + a - filter_id_of) & (psize - 1))];
-                    }
-                    int ival = 0;
-                    for (int a = 0; a < filter_size; a++)
-                    {
-                        ival += HRFilterI16[a] *
-                                this->TableI16WeakPointers[l - 1][s]
-                                                          [(((i << 1) + a - 31) & (psize - 1)) +
-                                                           FIRoffsetI16];
-                    }
-                    this->TableI16WeakPointers[l][s][i + FIRoffsetI16] = ival >> 16;
-                }
+                int srcindex = k - hrFilterCentre;
+                int srctable = max(0, s + (srcindex / psize));
+                srcindex = srcindex & mask;
+
+                float v = 0.f;
+                if (srctable < ns)
+                    v = f32At(l - 1, srctable)[srcindex];
+
+                ((k & 1) ? odd : even)[k >> 1] = v;
             }
-            // float2i16_block(this->TableF32WeakPointers[l][s],this->TableI16WeakPointers[l][s],lsize);
-            auto toCopy = std::min(FIRoffsetI16, lsize);
-            memcpy(&this->TableI16WeakPointers[l][s][lsize + FIRoffsetI16],
-                   &this->TableI16WeakPointers[l][s][FIRoffsetI16], toCopy * sizeof(short));
-            memcpy(&this->TableI16WeakPointers[l][s][0], &this->TableI16WeakPointers[l][s][lsize],
-                   toCopy * sizeof(short));
+
+            decimateF32(even.data(), odd.data(), f32At(l, s), lsize);
+
+            // not supported in int16 atm
+            memset(&dstI16[FIRoffsetI16], 0, lsize * sizeof(short));
         }
-        // fwrite(this->TableI16WeakPointers[l][0],lsize*sizeof(short),1,F);
-    }
-    // fclose(F);
+        else
+        {
+            auto prevF32 = f32At(l - 1, s);
+            auto prevI16 = i16At(l - 1, s) + FIRoffsetI16;
+            std::vector<short> srcI16(psize + 64);
+
+            for (int k = 0; k < 2 * (lsize + 32); k++)
+                ((k & 1) ? odd : even)[k >> 1] = prevF32[(k - hrFilterCentre) & mask];
+
+            for (int k = 0; k < psize + 64; k++)
+                srcI16[k] = prevI16[(k - hrFilterCentre) & mask];
+
+            decimateF32(even.data(), odd.data(), f32At(l, s), lsize);
+            decimateI16(srcI16.data(), tapsI16, &dstI16[FIRoffsetI16], lsize);
+        }
+
+        padI16(dstI16, lsize);
+    });
 
     // TODO I16 mipmaps end up out of phase
     // The click/knot/bug probably results from the fact that there is no padding in the beginning,
     // so it becomes out of phase at mipmap switch - makes sense because as they were off by a whole
     // sample at the mipmap switch, which cannot be explained by the half rate filter
 }
+
+void Wavetable::TableData::buildCompactMipmapLevel(int l)
+{
+    int psize = size >> (l - 1);
+    int lsize = size >> l;
+    int mask = psize - 1;
+    int ns = n_tables;
+    float toI16 = 1.f / i16Scale;
+
+    auto i16At = [this](int level, int s) {
+        return i16 + GetWTIndex(s, size, n_tables, level, FIRipolI16_N);
+    };
+
+    // the same filter as the float tables use, on the level above widened to float
+    forEachTable(ns, (size_t)psize * ns, [&](int s) {
+        std::vector<float> even(lsize + 32), odd(lsize + 32), res(lsize);
+
+        for (int k = 0; k < 2 * (lsize + 32); k++)
+        {
+            int srcindex = k - hrFilterCentre;
+            int srctable = s;
+
+            // a sample runs on from one table into the next, so each table reads its neighbours
+            if (flags & wtf_is_sample)
+                srctable = max(0, s + (srcindex / psize));
+
+            float v = 0.f;
+            if (srctable < ns)
+                v = i16At(l - 1, srctable)[FIRoffsetI16 + (srcindex & mask)] * i16Scale;
+
+            ((k & 1) ? odd : even)[k >> 1] = v;
+        }
+
+        decimateF32(even.data(), odd.data(), res.data(), lsize);
+
+        auto dst = i16At(l, s);
+        for (int i = 0; i < lsize; i++)
+            dst[FIRoffsetI16 + i] = (short)limit_range((int)(res[i] * toI16), -32768, 32767);
+
+        padI16(dst, lsize);
+    });
+}
+
+void Wavetable::TableData::buildRemainingMipmaps()
+{
+    for (int l = levelsReady.load(std::memory_order_acquire); l < levels; l++)
+    {
+        buildMipmapLevel(l);
+        levelsReady.store(l + 1, std::memory_order_release);
+    }
+}
+
+void Wavetable::MipMapWT() { tableData->buildRemainingMipmaps(); }
+
+WavetableMipmapBuilder::~WavetableMipmapBuilder()
+{
+    {
+        std::lock_guard<std::mutex> g(lock);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void WavetableMipmapBuilder::enqueue(std::shared_ptr<Wavetable::TableData> data)
+{
+    if (!buildInBackground)
+    {
+        data->buildRemainingMipmaps();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> g(lock);
+
+        if (!worker.joinable())
+        {
+            try
+            {
+                worker = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Loader,
+                                                      [this]() { run(); });
+            }
+            catch (const std::system_error &)
+            {
+                data->buildRemainingMipmaps();
+                return;
+            }
+        }
+
+        jobs.push_back({std::move(data), {}});
+    }
+    cv.notify_all();
+}
+
+void WavetableMipmapBuilder::whenBuilt(const std::shared_ptr<Wavetable::TableData> &data,
+                                       std::function<void()> f)
+{
+    {
+        std::lock_guard<std::mutex> g(lock);
+
+        for (auto &j : jobs)
+        {
+            if (j.data == data)
+            {
+                j.onBuilt.push_back(std::move(f));
+                return;
+            }
+        }
+    }
+
+    // not queued, so it was built in place
+    if (data->isBuilt())
+        f();
+}
+
+void WavetableMipmapBuilder::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lk(lock);
+    cv.wait(lk, [this]() { return jobs.empty() && !busy; });
+}
+
+void WavetableMipmapBuilder::run()
+{
+    // so a table built here matches one built in place
+    auto fpuguard = Surge::FPUState::DSPThreadGuard();
+    std::unique_lock<std::mutex> lk(lock);
+
+    while (true)
+    {
+        cv.wait(lk, [this]() { return stopping || !jobs.empty(); });
+
+        if (jobs.empty())
+            return;
+
+        auto data = jobs.front().data;
+        busy = true;
+        lk.unlock();
+
+        /*
+         * Even a table nobody holds any more gets finished, since the process cache could
+         * hand it out again at any moment
+         */
+        data->buildRemainingMipmaps();
+
+        lk.lock();
+        auto onBuilt = std::move(jobs.front().onBuilt);
+        jobs.pop_front();
+        busy = false;
+        lk.unlock();
+
+        if (data->isBuilt())
+            for (auto &f : onBuilt)
+                f();
+
+        cv.notify_all();
+        lk.lock();
+    }
+}
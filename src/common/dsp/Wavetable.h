@@ -21,8 +21,20 @@
  */
 #ifndef SURGE_SRC_COMMON_DSP_WAVETABLE_H
 #define SURGE_SRC_COMMON_DSP_WAVETABLE_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <StringOps.h>
+#include "LargePageAllocator.h"
 const int max_wtable_size = 4096;
 const int max_subtables = 512;
 const int max_mipmap_levels = 16;
@@ -48,9 +60,116 @@ class Wavetable
     bool BuildWT(void *wdata, wt_header &wh, bool AppendSilence);
     void MipMapWT();
 
-    void allocPointers(size_t newSize);
+    void allocPointers(size_t newSize, bool compactData = false);
+
+    /*
+     * The converted and mipmapped sample data. Once built a block is never written to again:
+     * building a table either picks up an identical block which some table in this process
+     * has already built, or builds into a fresh one. So tables share blocks freely, Copy just
+     * takes another reference, and a block goes away with the last table using it.
+     *
+     * The one exception is the mipmaps, which a WavetableMipmapBuilder may still be filling
+     * in after the block is in use. They are built in order and levels below levelsReady are
+     * finished; nobody reads the others.
+     *
+     * A compact block keeps only the int16 data, with no floats at all, so it takes a third
+     * of the memory. Everything reads it through sampleAt, which widens by i16Scale. Its
+     * mipmaps are filtered in float from the level above and stored back as int16.
+     */
+    struct TableData
+    {
+        explicit TableData(size_t dataSizes, bool compact = false);
+
+        TableData(const TableData &) = delete;
+        TableData &operator=(const TableData &) = delete;
+
+        size_t dataSizes;
+        Surge::Memory::LargeBlock memory; // f32, then i16
+        float *f32; // null in a compact block
+        short *i16;
+        bool compact{false};
+        float i16Scale{1.f / 16384.f};
+
+        // a block nobody has built into is all silence, and as built as it will ever be
+        int size{0}, n_tables{0}, flags{0}, levels{1};
+        std::atomic<int> levelsReady{max_mipmap_levels};
+
+        bool isBuilt() const { return levelsReady.load(std::memory_order_acquire) >= levels; }
+        // mipmap level l for every table, from level l - 1
+        void buildMipmapLevel(int l);
+        void buildRemainingMipmaps();
+
+      private:
+        void buildCompactMipmapLevel(int l);
+    };
+
+    /*
+     * The mipmap level to read in place of m. That's m itself unless this table's mipmaps are
+     * still being built, in which case it's the nearest finished one below.
+     */
+    int builtMipmap(int m) const
+    {
+        return std::min(m, tableData->levelsReady.load(std::memory_order_acquire) - 1);
+    }
+
+    // when set, BuildWT leaves the mipmaps above level 0 to this
+    class WavetableMipmapBuilder *mipmapBuilder{nullptr};
+    // when set and true, BuildWT keeps the table compact, see TableData
+    const std::atomic<bool> *buildCompact{nullptr};
+
+    bool isCompact() const { return compact; }
+
+    /*
+     * Sample i of table t at mipmap level l, however the table is kept. The float pointers
+     * of a compact table all point at silence, so anything which might be handed one reads
+     * through here.
+     */
+    float sampleAt(int l, int t, int i) const
+    {
+        if (compact)
+            return TableI16WeakPointers[l][t][i + i16SampleOffset] * i16Scale;
+        return TableF32WeakPointers[l][t][i];
+    }
+
+    // how many process wide blocks are alive, and how many floats they hold
+    static size_t sharedTableCount();
+    static size_t sharedTableFloats();
+
+    /*
+     * Everything which goes into building a table: its header and a hash of the source data.
+     * Two builds with the same key produce the same block, which is what lets tables be shared
+     * in memory and cached on disk.
+     */
+    struct BuildKey
+    {
+        uint64_t hash{0};
+        int size{0}, sourceTables{0}, flags{0};
+        bool appendSilence{false};
+        // a compact build of the same source is a different block
+        bool compact{false};
+
+        bool operator<(const BuildKey &o) const;
+    };
+    BuildKey buildKey;
+
+    // pick up a block which some other table in this process has built from this key
+    bool AdoptSharedWT(const BuildKey &key);
+    // take a block laid out exactly as BuildWT would have built it from this key
+    bool AdoptBuiltWT(const BuildKey &key, std::shared_ptr<TableData> data);
+    const std::shared_ptr<TableData> &builtTableData() const { return tableData; }
+
+  private:
+    void setLayout(const BuildKey &key);
+    void useTableData(std::shared_ptr<TableData> d);
+    void describeTableData();
+    void assignTablePointers();
+    std::shared_ptr<TableData> tableData;
+    bool compact{false};
+    float i16Scale{1.f / 16384.f};
 
   public:
+    // FIRoffsetI16, which lives in SurgeStorage.h
+    static constexpr int i16SampleOffset = 4;
     bool everBuilt = false;
     int size;
     unsigned int n_tables;
@@ -72,6 +191,52 @@ class Wavetable
     int frame_size_if_absent{-1};
 };
 
+/*
+ * Builds wavetable mipmaps on a background thread, so a load only has to convert level 0
+ * before the table can play. Until a level is ready, oscillators read the nearest level
+ * below it through Wavetable::builtMipmap, which costs a little aliasing for a moment at
+ * high pitches rather than the whole filter pass on the loading thread.
+ *
+ * The thread starts with the first table and works through tables in the order they come.
+ * A table nobody holds any more is dropped, and anything still pending when the builder
+ * goes away is finished first, since other instances may be sharing those blocks.
+ */
+class WavetableMipmapBuilder
+{
+  public:
+    WavetableMipmapBuilder() = default;
+    ~WavetableMipmapBuilder();
+
+    WavetableMipmapBuilder(const WavetableMipmapBuilder &) = delete;
+    WavetableMipmapBuilder &operator=(const WavetableMipmapBuilder &) = delete;
+
+    void enqueue(std::shared_ptr<Wavetable::TableData> data);
+
+    // run f on the builder thread once data is built, or right now if it already is
+    void whenBuilt(const std::shared_ptr<Wavetable::TableData> &data, std::function<void()> f);
+
+    // block until everything queued so far is built
+    void waitUntilIdle();
+
+    // when cleared, tables are built in full on the loading thread, so renders are repeatable
+    std::atomic<bool> buildInBackground{true};
+
+  private:
+    struct Job
+    {
+        std::shared_ptr<Wavetable::TableData> data;
+        std::vector<std::function<void()>> onBuilt;
+    };
+
+    void run();
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    bool busy{false}, stopping{false};
+    std::thread worker;
+};
+
 enum wtflags
 {
     wtf_is_sample = 1,
@@ -22,24 +22,49 @@
 
 #include "WavetableScriptEvaluator.h"
 #include "LuaSupport.h"
+#include "WorkerPool.h"
 #include "lua/LuaSources.h"
 
+#include <algorithm>
+#include <mutex>
+
 namespace Surge
 {
 namespace WavetableScript
 {
-
-std::vector<float> evaluateScriptAtFrame(SurgeStorage *storage, const std::string &eqn,
-                                         int resolution, int frame, int nFrames)
+namespace
+{
+/*
+ * One Lua state to run generate() in. Each frame gets the prelude, the script and a fresh
+ * environment exactly as before, so frames can't see each other except through the shared
+ * table; the state is only reused to save opening it.
+ */
+struct FrameEvaluator
 {
 #if HAS_LUA
-    static lua_State *L = nullptr;
-    if (L == nullptr)
+    lua_State *L{nullptr};
+
+    FrameEvaluator()
     {
         L = lua_open();
         luaL_openlibs(L);
     }
+    ~FrameEvaluator() { lua_close(L); }
+#endif
+
+    FrameEvaluator(const FrameEvaluator &) = delete;
+    FrameEvaluator &operator=(const FrameEvaluator &) = delete;
 
+    // On failure this returns no values and sets errorTitle and errorMessage
+    std::vector<float> evaluate(const std::string &eqn, int resolution, int frame, int nFrames,
+                                std::string &errorTitle, std::string &errorMessage);
+};
+
+std::vector<float> FrameEvaluator::evaluate(const std::string &eqn, int resolution, int frame,
+                                            int nFrames, std::string &errorTitle,
+                                            std::string &errorMessage)
+{
+#if HAS_LUA
     auto values = std::vector<float>();
 
     auto wg = Surge::LuaSupport::SGLD("WavetableScript::evaluate", L);
@@ -101,20 +126,15 @@ std::vector<float> evaluateScriptAtFrame(SurgeStorage *storage, const std::strin
         else
         {
             // If pcr is not LUA_OK then lua pushes an error string onto the stack. Show this error
-            std::string luaerr = lua_tostring(L, -1);
-            if (storage)
-                storage->reportError(luaerr, "Wavetable Evaluator Runtime Error");
-            else
-                std::cerr << luaerr;
+            errorTitle = "Wavetable Evaluator Runtime Error";
+            errorMessage = lua_tostring(L, -1);
         }
         lua_pop(L, 1); // Error string or pcall result
     }
     else
     {
-        if (storage)
-            storage->reportError(emsg, "Wavetable Evaluator Syntax Error");
-        else
-            std::cerr << emsg;
+        errorTitle = "Wavetable Evaluator Syntax Error";
+        errorMessage = emsg;
         lua_pop(L, 1);
     }
     return values;
@@ -123,6 +143,85 @@ std::vector<float> evaluateScriptAtFrame(SurgeStorage *storage, const std::strin
 #endif
 }
 
+void reportError(SurgeStorage *storage, const std::string &title, const std::string &message)
+{
+    if (storage)
+        storage->reportError(message, title);
+    else
+        std::cerr << message;
+}
+
+/*
+ * The frames most recently generated or previewed, so stepping through frames in the editor
+ * after generating, or generating after previewing, doesn't run the script again. Every
+ * frame depends on the script, the resolution and the frame count (as config.xs and
+ * config.nTables), so a change to any of those starts it over.
+ */
+struct FrameCache
+{
+    std::mutex mutex;
+    size_t scriptHash{0};
+    std::string script;
+    int resolution{0}, nFrames{0};
+    std::vector<std::vector<float>> frames;
+
+    // call with the mutex held
+    void useFor(const std::string &eqn, int res, int nfr)
+    {
+        auto h = std::hash<std::string>{}(eqn);
+
+        if (h == scriptHash && res == resolution && nfr == nFrames && eqn == script)
+            return;
+
+        scriptHash = h;
+        script = eqn;
+        resolution = res;
+        nFrames = nfr;
+        frames.assign(std::max(nfr, 0), {});
+    }
+
+    bool has(int frame) const
+    {
+        return frame >= 0 && frame < (int)frames.size() && !frames[frame].empty();
+    }
+};
+
+FrameCache &frameCache()
+{
+    static FrameCache cache;
+    return cache;
+}
+
+// Only the GUI previews and single threaded generation use this one
+FrameEvaluator &sharedEvaluator()
+{
+    static FrameEvaluator evaluator;
+    return evaluator;
+}
+} // namespace
+
+std::vector<float> evaluateScriptAtFrame(SurgeStorage *storage, const std::string &eqn,
+                                         int resolution, int frame, int nFrames)
+{
+    auto &cache = frameCache();
+    std::lock_guard<std::mutex> g(cache.mutex);
+
+    cache.useFor(eqn, resolution, nFrames);
+
+    if (cache.has(frame))
+        return cache.frames[frame];
+
+    std::string title, message;
+    auto values = sharedEvaluator().evaluate(eqn, resolution, frame, nFrames, title, message);
+
+    if (!message.empty())
+        reportError(storage, title, message);
+    else if (frame >= 0 && frame < (int)cache.frames.size())
+        cache.frames[frame] = values;
+
+    return values;
+}
+
 bool constructWavetable(SurgeStorage *storage, const std::string &eqn, int resolution, int frames,
                         wt_header &wh, float **wavdata)
 {
@@ -132,10 +231,85 @@ bool constructWavetable(SurgeStorage *storage, const std::string &eqn, int resol
     wh.flags = 0;
     *wavdata = wd;
 
+    auto &cache = frameCache();
+    std::lock_guard<std::mutex> g(cache.mutex);
+
+    cache.useFor(eqn, resolution, frames);
+
+    std::vector<int> missing;
+    for (int i = 0; i < frames; ++i)
+    {
+        if (!cache.has(i))
+            missing.push_back(i);
+    }
+
+    /*
+     * Frames are independent unless the script passes state between them through the shared
+     * table, so split what's missing into contiguous runs, one per thread, each run with its
+     * own Lua state. A script which mentions shared runs in order on one thread as it always
+     * did.
+     */
+    static constexpr int minFramesPerThread = 8;
+    int nThreads = std::clamp((int)std::thread::hardware_concurrency(), 1, 8);
+    nThreads = std::min(nThreads, (int)missing.size() / minFramesPerThread);
+
+    if (eqn.find("shared") != std::string::npos)
+        nThreads = 1;
+
+    std::vector<std::string> errorTitles(std::max(nThreads, 1)), errors(std::max(nThreads, 1));
+
+    if (nThreads <= 1)
+    {
+        for (auto f : missing)
+        {
+            cache.frames[f] =
+                sharedEvaluator().evaluate(eqn, resolution, f, frames, errorTitles[0], errors[0]);
+
+            if (!errors[0].empty())
+                break;
+        }
+    }
+    else
+    {
+        auto runFrames = [&](int t) {
+            FrameEvaluator evaluator;
+            auto b = missing.size() * t / nThreads, e = missing.size() * (t + 1) / nThreads;
+
+            for (auto i = b; i < e && errors[t].empty(); ++i)
+            {
+                auto f = missing[i];
+                cache.frames[f] =
+                    evaluator.evaluate(eqn, resolution, f, frames, errorTitles[t], errors[t]);
+            }
+        };
+
+        Surge::Threading::WorkerPool pool(nThreads - 1);
+        pool.parallelFor(nThreads, runFrames);
+    }
+
+    for (int i = 0; i < (int)errors.size(); ++i)
+    {
+        if (!errors[i].empty())
+        {
+            // one report will do; the rest are almost certainly the same mistake
+            reportError(storage, errorTitles[i], errors[i]);
+            break;
+        }
+    }
+
     for (int i = 0; i < frames; ++i)
     {
-        auto v = evaluateScriptAtFrame(storage, eqn, resolution, i, frames);
-        memcpy(&(wd[i * resolution]), &(v[0]), resolution * sizeof(float));
+        auto &v = cache.frames[i];
+        auto n = std::min((int)v.size(), resolution);
+
+        if (n > 0)
+            memcpy(&(wd[i * resolution]), v.data(), n * sizeof(float));
+
+        std::fill(wd + i * resolution + n, wd + (i + 1) * resolution, 0.f);
+
+        // a frame which failed part way isn't kept, so the next try runs it again
+        if (n < resolution)
+            v.clear();
     }
     return true;
 }
@@ -33,15 +33,17 @@ namespace WavetableScript
 {
 /*
  * Unlike the LFO modulator this is called at render time of the wavetable
- * not at the evaluation or synthesis time. As such I expect you call it from
- * one thread at a time and just you know generally be careful.
+ * not at the evaluation or synthesis time. It is safe to call from any thread,
+ * but calls are serialized. The frames of the most recent script, resolution and
+ * frame count are remembered, so asking for one again doesn't rerun the script.
  */
 std::vector<float> evaluateScriptAtFrame(SurgeStorage *storage, const std::string &eqn,
                                          int resolution, int frame, int nFrames);
 
 /*
  * Generate all the data required to call BuildWT. The wavdata here is data you
- * must free with delete[]
+ * must free with delete[]. Frames not already remembered from evaluateScriptAtFrame
+ * or an earlier call are spread over several threads, each with its own Lua state.
  */
 bool constructWavetable(SurgeStorage *storage, const std::string &eqn, int resolution, int frames,
                         wt_header &wh, float **wavdata);
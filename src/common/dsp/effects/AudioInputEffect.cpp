@@ -28,8 +28,11 @@ namespace mech = sst::basic_blocks::mechanics;
 AudioInputEffect::AudioInputEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
     : Effect(storage, fxdata, pd)
 {
+    storage->audio_in_nonOS_clients++;
 }
 
+AudioInputEffect::~AudioInputEffect() { storage->audio_in_nonOS_clients--; }
+
 void AudioInputEffect::init()
 {
     Effect::init();
@@ -52,7 +52,7 @@ class AudioInputEffect : public Effect
         in_num_params
     };
     AudioInputEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
-    ~AudioInputEffect() = default;
+    ~AudioInputEffect();
     void init_ctrltypes() override;
     void init_default_values() override;
     void process(float *dataL, float *dataR) override;
@@ -367,9 +367,10 @@ void BBDEnsembleEffect::process(float *dataL, float *dataR)
             float t2 = del1 * modlfos[0][1].value() + del2 * modlfos[1][1].value() + del0;
             float t3 = del1 * modlfos[0][2].value() + del2 * modlfos[1][2].value() + del0;
 
+            // the middle tap feeds both channels, so its clock is only worked out once
             delL1.setDelayTime(t1);
             delL2.setDelayTime(t2);
-            delR1.setDelayTime(t2);
+            delR1.setDelayTime(delL2);
             delR2.setDelayTime(t3);
 
             float delayOuts alignas(16)[4];
@@ -26,14 +26,31 @@
 #include "BiquadFilter.h"
 #include "DSPUtils.h"
 
+#include "DelayLineArena.h"
+
 #include <vembertech/lipol.h>
+#include "sst/basic-blocks/dsp/ModulatedDelayLine.h"
 
 template <int v> class ChorusEffect : public Effect
 {
+    // the voices are read four at a time, one a lane
+    static constexpr int voiceGroups = (v + 3) / 4;
+
     lipol_ps_blocksz feedback alignas(16), mix alignas(16), width alignas(16);
-    SIMD_M128 voicepanL4 alignas(16)[v], voicepanR4 alignas(16)[v];
-    float buffer alignas(16)[max_delay_length + FIRipol_N]; // Includes padding so we can use SSE
-                                                            // interpolation without wrapping
+    SIMD_M128 voicepanL4 alignas(16)[voiceGroups], voicepanR4 alignas(16)[voiceGroups];
+
+    /*
+     * The longest chorus time is 125ms, doubled at full depth, and we leave room for it to be
+     * tempo synced down to 30 bpm. The line is a power of two of at least that, padded so we can
+     * use SSE interpolation without wrapping.
+     */
+    static constexpr float maxTimeSeconds = 1.f;
+    Surge::Memory::DelayLineArena::Buffer delayMemory;
+    sst::basic_blocks::dsp::ModulatedDelayLine line;
+    void sizeBuffer();
+
+    template <sst::basic_blocks::dsp::ModulatedDelayInterpolation q>
+    void readVoices(float *__restrict L, float *__restrict R);
 
   public:
     enum chorus_params
@@ -56,6 +73,11 @@ template <int v> class ChorusEffect : public Effect
     virtual void init() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual void suspend() override;
+    virtual void sampleRateReset() override;
+    virtual size_t memoryFootprint() const override
+    {
+        return instanceBytes + delayMemory.size() * sizeof(float);
+    }
     void setvars(bool init);
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
@@ -69,7 +91,6 @@ template <int v> class ChorusEffect : public Effect
     lag<float, true> time[v];
     float voicepan[v][2];
     float envf;
-    int wpos;
     BiquadFilter lp, hp;
     double lfophase[v];
 };
@@ -24,6 +24,7 @@
 #define SURGE_SRC_COMMON_DSP_EFFECTS_CHORUSEFFECTIMPL_H
 
 #include "ChorusEffect.h"
+#include "SurgeMemoryPools.h"
 #include <algorithm>
 
 #include "globals.h"
@@ -40,17 +41,44 @@ ChorusEffect<v>::ChorusEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *p
 {
     mix.set_blocksize(BLOCK_SIZE);
     feedback.set_blocksize(BLOCK_SIZE);
+    sizeBuffer();
 }
 
 template <int v> ChorusEffect<v>::~ChorusEffect() {}
 
+template <int v> void ChorusEffect<v>::sizeBuffer()
+{
+    using mdl = sst::basic_blocks::dsp::ModulatedDelayLine;
+
+    int len = BLOCK_SIZE;
+    while (len < max_delay_length &&
+           len < storage->samplerate * maxTimeSeconds + BLOCK_SIZE + mdl::padding + 1)
+        len <<= 1;
+
+    // a line which is already long enough (from a higher rate) is kept rather than swapped
+    if (len > line.size)
+    {
+        delayMemory.reset();
+        delayMemory = storage->memoryPools->effectDelayLines.acquire(len + mdl::padding);
+        line.attach(delayMemory.data(), len);
+    }
+    line.sinctable1X = storage->sinctable1X;
+}
+
+template <int v> void ChorusEffect<v>::sampleRateReset()
+{
+    sizeBuffer();
+    init();
+}
+
 template <int v> void ChorusEffect<v>::init()
 {
-    memset(buffer, 0, (max_delay_length + FIRipol_N) * sizeof(float));
-    wpos = 0;
+    line.clear();
     envf = 0;
     const float gainscale = 1 / sqrt((float)v);
 
+    float panL alignas(16)[voiceGroups * 4] = {}, panR alignas(16)[voiceGroups * 4] = {};
+
     for (int i = 0; i < v; i++)
     {
         time[i].setRate(0.001);
@@ -60,8 +88,14 @@ template <int v> void ChorusEffect<v>::init()
         x = 2.f * x - 1.f;
         voicepan[i][0] = sqrt(0.5 - 0.5 * x) * gainscale;
         voicepan[i][1] = sqrt(0.5 + 0.5 * x) * gainscale;
-        voicepanL4[i] = SIMD_MM(set1_ps)(voicepan[i][0]);
-        voicepanR4[i] = SIMD_MM(set1_ps)(voicepan[i][1]);
+        panL[i] = voicepan[i][0];
+        panR[i] = voicepan[i][1];
+    }
+
+    for (int g = 0; g < voiceGroups; ++g)
+    {
+        voicepanL4[g] = SIMD_MM(load_ps)(&panL[g * 4]);
+        voicepanR4[g] = SIMD_MM(load_ps)(&panR[g * 4]);
     }
 
     setvars(true);
@@ -102,51 +136,65 @@ template <int v> void ChorusEffect<v>::setvars(bool init)
     }
 }
 
-template <int v> void ChorusEffect<v>::process(float *dataL, float *dataR)
+/*
+ * The block is written after it is read, so for sample k the write head is k samples behind and
+ * the delays come down by k to match. Times below a block would read what isn't written yet;
+ * the Hermite spline looks one sample further ahead than the sinc does.
+ */
+template <int v>
+template <sst::basic_blocks::dsp::ModulatedDelayInterpolation q>
+void ChorusEffect<v>::readVoices(float *__restrict tbufferL, float *__restrict tbufferR)
 {
     namespace mech = sst::basic_blocks::mechanics;
-    namespace sdsp = sst::basic_blocks::dsp;
-
-    setvars(false);
 
-    float tbufferL alignas(16)[BLOCK_SIZE];
-    float tbufferR alignas(16)[BLOCK_SIZE];
-    float fbblock alignas(16)[BLOCK_SIZE];
+    constexpr float minTime =
+        BLOCK_SIZE + (q == sst::basic_blocks::dsp::ModulatedDelayInterpolation::HERMITE);
+    const float maxTime = line.size - line.padding - 1;
 
-    mech::clear_block<BLOCK_SIZE>(tbufferL);
-    mech::clear_block<BLOCK_SIZE>(tbufferR);
+    float dtime alignas(16)[voiceGroups * 4];
+    for (int j = v; j < voiceGroups * 4; ++j)
+        dtime[j] = minTime;
 
     for (int k = 0; k < BLOCK_SIZE; k++)
     {
-        auto L = SIMD_MM(setzero_ps)(), R = SIMD_MM(setzero_ps)();
-
         for (int j = 0; j < v; j++)
         {
             time[j].process();
-            float vtime = time[j].v;
-            int i_dtime = max(BLOCK_SIZE, min((int)vtime, max_delay_length - FIRipol_N - 1));
-            int rp = ((wpos - i_dtime + k) - FIRipol_N) & (max_delay_length - 1);
-            int sinc = FIRipol_N * limit_range((int)(FIRipol_M * (float(i_dtime + 1) - vtime)), 0,
-                                               FIRipol_M - 1);
-
-            SIMD_M128 vo;
-            vo = SIMD_MM(mul_ps)(SIMD_MM(load_ps)(&storage->sinctable1X[sinc]),
-                                 SIMD_MM(loadu_ps)(&buffer[rp]));
-            vo = SIMD_MM(add_ps)(vo,
-                                 SIMD_MM(mul_ps)(SIMD_MM(load_ps)(&storage->sinctable1X[sinc + 4]),
-                                                 SIMD_MM(loadu_ps)(&buffer[rp + 4])));
-            vo = SIMD_MM(add_ps)(vo,
-                                 SIMD_MM(mul_ps)(SIMD_MM(load_ps)(&storage->sinctable1X[sinc + 8]),
-                                                 SIMD_MM(loadu_ps)(&buffer[rp + 8])));
-
-            L = SIMD_MM(add_ps)(L, SIMD_MM(mul_ps)(vo, voicepanL4[j]));
-            R = SIMD_MM(add_ps)(R, SIMD_MM(mul_ps)(vo, voicepanR4[j]));
+            dtime[j] = limit_range(time[j].v, minTime, maxTime) - k;
+        }
+
+        auto L = SIMD_MM(setzero_ps)(), R = SIMD_MM(setzero_ps)();
+
+        for (int g = 0; g < voiceGroups; g++)
+        {
+            auto vo = line.read4<q>(SIMD_MM(load_ps)(&dtime[g * 4]));
+
+            L = SIMD_MM(add_ps)(L, SIMD_MM(mul_ps)(vo, voicepanL4[g]));
+            R = SIMD_MM(add_ps)(R, SIMD_MM(mul_ps)(vo, voicepanR4[g]));
         }
         L = mech::sum_ps_to_ss(L);
         R = mech::sum_ps_to_ss(R);
         SIMD_MM(store_ss)(&tbufferL[k], L);
         SIMD_MM(store_ss)(&tbufferR[k], R);
     }
+}
+
+template <int v> void ChorusEffect<v>::process(float *dataL, float *dataR)
+{
+    namespace mech = sst::basic_blocks::mechanics;
+    namespace sdsp = sst::basic_blocks::dsp;
+
+    setvars(false);
+
+    float tbufferL alignas(16)[BLOCK_SIZE];
+    float tbufferR alignas(16)[BLOCK_SIZE];
+    float fbblock alignas(16)[BLOCK_SIZE];
+
+    // without oversampling to spare, the voices make do with the cheaper spline
+    if (storage->effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_ECO)
+        readVoices<sdsp::ModulatedDelayInterpolation::HERMITE>(tbufferL, tbufferR);
+    else
+        readVoices<sdsp::ModulatedDelayInterpolation::SINC>(tbufferL, tbufferR);
 
     if (!fxdata->p[ch_highcut].deactivated)
     {
@@ -164,30 +212,12 @@ template <int v> void ChorusEffect<v>::process(float *dataL, float *dataR)
     mech::accumulate_from_to<BLOCK_SIZE>(dataL, fbblock);
     mech::accumulate_from_to<BLOCK_SIZE>(dataR, fbblock);
 
-    if (wpos + BLOCK_SIZE >= max_delay_length)
-    {
-        for (int k = 0; k < BLOCK_SIZE; k++)
-        {
-            buffer[(wpos + k) & (max_delay_length - 1)] = fbblock[k];
-        }
-    }
-    else
-    {
-        mech::copy_from_to<BLOCK_SIZE>(fbblock, &buffer[wpos]);
-    }
-
-    if (wpos == 0)
-        for (int k = 0; k < FIRipol_N; k++)
-            buffer[k + max_delay_length] =
-                buffer[k]; // copy buffer so FIR-core doesn't have to wrap
+    line.writeBlock(fbblock, BLOCK_SIZE);
 
     // scale width
     applyWidth(tbufferL, tbufferR, width);
 
     mix.fade_2_blocks_inplace(dataL, tbufferL, dataR, tbufferR, BLOCK_SIZE_QUAD);
-
-    wpos += BLOCK_SIZE;
-    wpos = wpos & (max_delay_length - 1);
 }
 
 template <int v> void ChorusEffect<v>::suspend() { init(); }
@@ -22,6 +22,7 @@
 
 #include "CombulatorEffect.h"
 #include "DebugHelpers.h"
+#include "SurgeMemoryPools.h"
 #include "fmt/core.h"
 #include "sst/basic-blocks/dsp/CorrelatedNoise.h"
 #include "sst/basic-blocks/mechanics/block-ops.h"
@@ -34,22 +35,14 @@ CombulatorEffect::CombulatorEffect(SurgeStorage *storage, FxStorage *fxdata, pda
     hp.setBlockSize(BLOCK_SIZE);
     mix.set_blocksize(BLOCK_SIZE);
 
-    qfus = new sst::filters::QuadFilterUnitState[2]();
-
     for (int e = 0; e < 3; ++e)
     {
         for (int c = 0; c < 2; ++c)
         {
-            for (int q = 0; q < sst::filters::n_filter_registers; ++q)
-            {
-                Reg[e][c][q] = 0;
-            }
-            WP[e][c] = 0;
+            filterDelay[e][c] = nullptr;
         }
     }
 
-    memset(filterDelay, 0, 3 * 2 * (MAX_FB_COMB_EXTENDED + FIRipol_N) * sizeof(float));
-
     // http://www.cs.cmu.edu/~music/icm-online/readings/panlaws/
     for (int i = 0; i < PANLAW_SIZE; ++i)
     {
@@ -72,7 +65,57 @@ CombulatorEffect::CombulatorEffect(SurgeStorage *storage, FxStorage *fxdata, pda
     noiseGen[1][1] = 0.f;
 }
 
-CombulatorEffect::~CombulatorEffect() { delete[] qfus; }
+CombulatorEffect::~CombulatorEffect() {}
+
+// the shortest power of 2 comb line which holds delayTime samples and the sinc interpolator
+static int combLengthFor(float delayTime)
+{
+    int len = 1024;
+
+    while (len < MAX_FB_COMB_EXTENDED && len < delayTime + FIRipol_N)
+        len <<= 1;
+
+    return len;
+}
+
+void CombulatorEffect::sizeCombs(int length, bool preserve)
+{
+    if (length == combLength)
+        return;
+
+    if (!preserve)
+    {
+        delayMemory.reset();
+        WP = 0;
+    }
+
+    auto stride = length + FIRipol_N;
+    auto memory = storage->memoryPools->effectDelayLines.acquire(3 * 2 * stride);
+    memset(memory.data(), 0, 3 * 2 * stride * sizeof(float));
+
+    for (int e = 0; e < 3; ++e)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            auto line = memory.data() + (e * 2 + c) * stride;
+
+            if (preserve && combLength > 0)
+            {
+                // keep every sample the same distance behind the write position
+                auto prior = filterDelay[e][c];
+                memcpy(line, prior, WP * sizeof(float));
+                memcpy(line + length - combLength + WP, prior + WP,
+                       (combLength - WP) * sizeof(float));
+                memcpy(line + length, line, FIRipol_N * sizeof(float));
+            }
+
+            filterDelay[e][c] = line;
+        }
+    }
+
+    delayMemory = std::move(memory);
+    combLength = length;
+}
 
 void CombulatorEffect::init()
 {
@@ -82,7 +125,19 @@ void CombulatorEffect::init()
     bi = 0;
     lp.suspend();
 
-    memset(filterDelay, 0, 3 * 2 * (MAX_FB_COMB_EXTENDED + FIRipol_N) * sizeof(float));
+    // size the combs for the notes they are set to now, process grows them if that goes lower
+    float longest = 0.f;
+
+    for (int e = 0; e < 3; ++e)
+    {
+        longest = std::max(longest, (float)(storage->dsamplerate_os / 440.0 *
+                                            storage->note_to_pitch_inv_ignoring_tuning(
+                                                smoothed.value(sm_freq1 + e))));
+    }
+
+    sizeCombs(combLengthFor(longest), false);
+    memset(delayMemory.data(), 0, 3 * 2 * (combLength + FIRipol_N) * sizeof(float));
+    WP = 0;
 
     envV[0] = 0.f;
     envV[1] = 0.f;
@@ -99,45 +154,36 @@ void CombulatorEffect::setvars(bool init)
     {
         if (i == 0)
         {
-            freq[i].newValue(*pd_float[combulator_freq1]);
+            smoothed.setTarget(sm_freq1, *pd_float[combulator_freq1]);
         }
         else
         {
             if (fxdata->p[combulator_freq1 + i].extend_range)
             {
-                freq[i].newValue(*pd_float[combulator_freq1 + i]);
+                smoothed.setTarget(sm_freq1 + i, *pd_float[combulator_freq1 + i]);
             }
             else
             {
-                freq[i].newValue(*pd_float[combulator_freq1] + *pd_float[combulator_freq1 + i]);
+                smoothed.setTarget(sm_freq1 + i,
+                                   *pd_float[combulator_freq1] + *pd_float[combulator_freq1 + i]);
             }
         }
 
-        gain[i].newValue(amp_to_linear(limit_range(*pd_float[combulator_gain1 + i], 0.f, 2.f)));
+        smoothed.setTarget(sm_gain1 + i,
+                           amp_to_linear(limit_range(*pd_float[combulator_gain1 + i], 0.f, 2.f)));
     }
 
-    noisemix.newValue(clamp01(*pd_float[combulator_noise_mix]));
-    feedback.newValue(*pd_float[combulator_feedback]);
-    tone.newValue(clamp1bp(*pd_float[combulator_tone]));
-    pan2.newValue(clamp1bp(*pd_float[combulator_pan2]));
-    pan3.newValue(clamp1bp(*pd_float[combulator_pan3]));
+    smoothed.setTarget(sm_noisemix, clamp01(*pd_float[combulator_noise_mix]));
+    smoothed.setTarget(sm_feedback, *pd_float[combulator_feedback]);
+    smoothed.setTarget(sm_tone, clamp1bp(*pd_float[combulator_tone]));
+    smoothed.setTarget(sm_pan2, clamp1bp(*pd_float[combulator_pan2]));
+    smoothed.setTarget(sm_pan3, clamp1bp(*pd_float[combulator_pan3]));
 
     negone.set_target(-1.f);
 
     if (init)
     {
-        for (int i = 0; i < 3; ++i)
-        {
-            freq[i].instantize();
-            gain[i].instantize();
-        }
-
-        feedback.instantize();
-
-        pan2.instantize();
-        pan3.instantize();
-        tone.instantize();
-        noisemix.instantize();
+        smoothed.instantize();
 
         mix.set_target(1.f);
         mix.instantize();
@@ -159,15 +205,16 @@ void CombulatorEffect::setvars(bool init)
         float hpCutoff = chi;
         float lpCutoff = cmid;
 
-        if (tone.v > 0)
+        auto tv = smoothed.value(sm_tone);
+
+        if (tv > 0)
         {
             // OK so cool scale the hp cutoff
-            auto tv = tone.v;
             hpCutoff = tv * (cmid - chi) + chi;
         }
         else
         {
-            auto tv = -tone.v;
+            tv = -tv;
             lpCutoff = tv * (clo - cmid) + cmid;
         }
 
@@ -180,14 +227,26 @@ inline void set1f(SIMD_M128 &m, int i, float f) { *((float *)&m + i) = f; }
 
 inline float get1f(SIMD_M128 m, int i) { return *((float *)&m + i); }
 
+// the sum of each of the three comb taps in one lane apiece, added in the order sum_ps_to_ss does
+inline SIMD_M128 sumLanes(const SIMD_M128 (&taps)[3])
+{
+    auto z = SIMD_MM(setzero_ps)();
+    auto t0 = SIMD_MM(unpacklo_ps)(taps[0], taps[1]);
+    auto t1 = SIMD_MM(unpacklo_ps)(taps[2], z);
+    auto t2 = SIMD_MM(unpackhi_ps)(taps[0], taps[1]);
+    auto t3 = SIMD_MM(unpackhi_ps)(taps[2], z);
+
+    auto even = SIMD_MM(add_ps)(SIMD_MM(movelh_ps)(t0, t1), SIMD_MM(movelh_ps)(t2, t3));
+    auto odd = SIMD_MM(add_ps)(SIMD_MM(movehl_ps)(t1, t0), SIMD_MM(movehl_ps)(t3, t2));
+
+    return SIMD_MM(add_ps)(even, odd);
+}
+
 void CombulatorEffect::sampleRateReset()
 {
     for (int e = 0; e < 3; ++e)
     {
-        for (int c = 0; c < 2; ++c)
-        {
-            coeff[e][c].setSampleRateAndBlockSize((float)storage->dsamplerate_os, BLOCK_SIZE_OS);
-        }
+        coeff[e].setSampleRateAndBlockSize((float)storage->dsamplerate_os, BLOCK_SIZE_OS);
     }
 }
 
@@ -209,42 +268,51 @@ void CombulatorEffect::process(float *dataL, float *dataR)
 
     int type = fut_comb_pos, subtype = 1;
 
-    auto filtptr =
-        GetQFPtrFilterUnit(static_cast<FilterType>(type),
-                           static_cast<FilterSubType>(subtype | QFUSubtypeMasks::EXTENDED_COMB));
-
-    auto fbscaled = (feedback.v < 0.f ? -1.f : 1.f) * sqrt(abs(feedback.v));
+    auto fb = smoothed.value(sm_feedback);
+    auto fbscaled = (fb < 0.f ? -1.f : 1.f) * sqrt(abs(fb));
 
     /*
-     * So now set up across the voices (e for 'entry' to match SurgeVoice) and the channels (c)
+     * So now set up the three combs (e for 'entry' to match SurgeVoice), which are the lanes of
+     * the left and right registers alike
      */
     bool useTuning = fxdata->p[combulator_freq1].extend_range;
+    SIMD_M128 C[4], dC[4];
+    float longest = 0.f;
 
-    for (int e = 0; e < 3; ++e)
+    for (int i = 0; i < 4; ++i)
     {
-        for (int c = 0; c < 2; ++c)
-        {
-            coeff[e][c].MakeCoeffs(
-                freq[e].v, fbscaled, static_cast<FilterType>(type),
-                static_cast<FilterSubType>(subtype | QFUSubtypeMasks::EXTENDED_COMB), storage,
-                useTuning);
+        C[i] = SIMD_MM(setzero_ps)();
+        dC[i] = SIMD_MM(setzero_ps)();
+    }
 
-            coeff[e][c].updateState(qfus[c], e);
+    for (int e = 0; e < 3; ++e)
+    {
+        coeff[e].MakeCoeffs(smoothed.value(sm_freq1 + e), fbscaled, static_cast<FilterType>(type),
+                            static_cast<FilterSubType>(subtype | QFUSubtypeMasks::EXTENDED_COMB),
+                            storage, useTuning);
 
-            for (int i = 0; i < n_filter_registers; i++)
-            {
-                set1f(qfus[c].R[i], e, Reg[e][c][i]);
-            }
+        for (int i = 0; i < 4; ++i)
+        {
+            set1f(C[i], e, coeff[e].C[i]);
+            set1f(dC[i], e, coeff[e].dC[i]);
+        }
 
-            qfus[c].DB[e] = filterDelay[e][c];
-            qfus[c].WP[e] = WP[e][c];
+        // the delay time slides linearly across the block, so it is longest at one end
+        longest = std::max(longest, std::max(coeff[e].C[0],
+                                             coeff[e].C[0] + BLOCK_SIZE_OS * coeff[e].dC[0]));
+    }
 
-            qfus[c].active[e] = 0xFFFFFFFF;
-            qfus[c].active[3] = 0;
-        }
+    if (combLengthFor(longest) > combLength)
+    {
+        sizeCombs(combLengthFor(longest), true);
     }
 
     /* Run the filters */
+    static_assert(utilities::SincTable::FIRipol_M == 256,
+                  "changing the constant requires updating the code below");
+    const auto m256 = SIMD_MM(set1_ps)(256.f);
+    const auto m0xff = SIMD_MM(set1_epi32)(0xff);
+    const auto mask = combLength - 1;
     float noise[2];
 
     for (int s = 0; s < BLOCK_SIZE_OS; ++s)
@@ -265,31 +333,77 @@ void CombulatorEffect::process(float *dataL, float *dataR)
             }
 
             envV[c] = e;
-            noise[c] = noisemix.v * 3.f * envV[c] *
+            noise[c] = smoothed.value(sm_noisemix) * 3.f * envV[c] *
                        sst::basic_blocks::dsp::correlated_noise_o2mk2_supplied_value(
                            noiseGen[c][0], noiseGen[c][1], 0, storage->rand_pm1());
         }
 
-        auto l128 = SIMD_MM(setzero_ps)();
-        auto r128 = SIMD_MM(setzero_ps)();
-
         // FIXME - we want to interpolate the non-integral part if we like this
-        int panIndex2 = (int)((limit_range(pan2.v, -1.f, 1.f) + 1) * ((PANLAW_SIZE - 1) / 2)) &
+        int panIndex2 = (int)((limit_range(smoothed.value(sm_pan2), -1.f, 1.f) + 1) * ((PANLAW_SIZE - 1) / 2)) &
                         (PANLAW_SIZE - 1);
-        int panIndex3 = (int)((limit_range(pan3.v, -1.f, 1.f) + 1) * ((PANLAW_SIZE - 1) / 2)) &
+        int panIndex3 = (int)((limit_range(smoothed.value(sm_pan3), -1.f, 1.f) + 1) * ((PANLAW_SIZE - 1) / 2)) &
                         (PANLAW_SIZE - 1);
 
-        if (filtptr)
+        C[0] = SIMD_MM(add_ps)(C[0], dC[0]);
+        C[1] = SIMD_MM(add_ps)(C[1], dC[1]);
+
+        // the whole and fractional part of each comb's delay, the latter picking the sinc row
+        auto dt = SIMD_MM(cvtps_epi32)(SIMD_MM(mul_ps)(C[0], m256));
+        int DTi alignas(16)[4], SEi alignas(16)[4];
+        SIMD_MM(store_si128)((SIMD_M128I *)DTi, SIMD_MM(srli_epi32)(dt, 8));
+        SIMD_MM(store_si128)((SIMD_M128I *)SEi,
+                             SIMD_MM(sub_epi32)(m0xff, SIMD_MM(and_si128)(dt, m0xff)));
+
+        SIMD_M128 tapL[3], tapR[3];
+
+        for (int e = 0; e < 3; ++e)
         {
-            l128 = filtptr(&(qfus[0]), SIMD_MM(set1_ps)(dataOS[0][s] + noise[0]));
-            r128 = filtptr(&(qfus[1]), SIMD_MM(set1_ps)(dataOS[1][s] + noise[1]));
+            int RP = (WP - DTi[e] - FIRoffset) & mask;
+            auto *sinc = &utilities::globalSincTable.sinctable[SEi[e] * (FIRipol_N << 1)];
+            auto *dl = &filterDelay[e][0][RP], *dr = &filterDelay[e][1][RP];
+
+            auto k0 = SIMD_MM(load_ps)(sinc);
+            auto k1 = SIMD_MM(load_ps)(sinc + 4);
+            auto k2 = SIMD_MM(load_ps)(sinc + 8);
+
+            tapL[e] = SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dl), k0);
+            tapL[e] = SIMD_MM(add_ps)(tapL[e], SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dl + 4), k1));
+            tapL[e] = SIMD_MM(add_ps)(tapL[e], SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dl + 8), k2));
+            tapR[e] = SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dr), k0);
+            tapR[e] = SIMD_MM(add_ps)(tapR[e], SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dr + 4), k1));
+            tapR[e] = SIMD_MM(add_ps)(tapR[e], SIMD_MM(mul_ps)(SIMD_MM(loadu_ps)(dr + 8), k2));
         }
-        else
+
+        auto readL = sumLanes(tapL), readR = sumLanes(tapR);
+        auto inL = SIMD_MM(set1_ps)(dataOS[0][s] + noise[0]);
+        auto inR = SIMD_MM(set1_ps)(dataOS[1][s] + noise[1]);
+
+        namespace sdsp = sst::basic_blocks::dsp;
+        auto fbL = sdsp::softclip_ps(SIMD_MM(add_ps)(inL, SIMD_MM(mul_ps)(readL, C[1])));
+        auto fbR = sdsp::softclip_ps(SIMD_MM(add_ps)(inR, SIMD_MM(mul_ps)(readR, C[1])));
+
+        float wl alignas(16)[4], wr alignas(16)[4];
+        SIMD_MM(store_ps)(wl, fbL);
+        SIMD_MM(store_ps)(wr, fbR);
+
+        for (int e = 0; e < 3; ++e)
         {
-            l128 = SIMD_MM(set1_ps)(dataOS[0][s]);
-            r128 = SIMD_MM(set1_ps)(dataOS[1][s]);
+            // Write to delaybuffer (with "anti-wrapping")
+            filterDelay[e][0][WP] = wl[e];
+            filterDelay[e][1][WP] = wr[e];
+
+            if (WP < FIRipol_N)
+            {
+                filterDelay[e][0][WP + combLength] = wl[e];
+                filterDelay[e][1][WP + combLength] = wr[e];
+            }
         }
 
+        WP = (WP + 1) & mask;
+
+        auto l128 = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(C[3], readL), SIMD_MM(mul_ps)(C[2], inL));
+        auto r128 = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(C[3], readR), SIMD_MM(mul_ps)(C[2], inR));
+
         float mixl = 0, mixr = 0;
         float tl[4], tr[4];
 
@@ -312,8 +426,9 @@ void CombulatorEffect::process(float *dataL, float *dataR)
                 panr = panR[panIndex3];
             }
 
-            mixl += tl[i] * gain[i].v * panl / 0.59;
-            mixr += tr[i] * gain[i].v * panr / 0.59;
+            auto g = smoothed.value(sm_gain1 + i);
+            mixl += tl[i] * g * panl / 0.59;
+            mixr += tr[i] * g * panr / 0.59;
         }
 
         // soft-clip output for good measure
@@ -323,52 +438,20 @@ void CombulatorEffect::process(float *dataL, float *dataR)
         dataOS[0][s] = mixl;
         dataOS[1][s] = mixr;
 
-        // lag class only works at BLOCK_SIZE time, not BLOCK_SIZE_OS,
+        // the smoothing rate is set for BLOCK_SIZE time, not BLOCK_SIZE_OS,
         // so call process every other sample
         if (s % 2 == 0)
         {
-            for (auto i = 0; i < 3; ++i)
-            {
-                freq[i].process();
-                gain[i].process();
-
-                if (i == 0)
-                {
-                    feedback.process();
-                    pan2.process();
-                    pan3.process();
-                    tone.process();
-                    noisemix.process();
-                }
-            }
+            smoothed.process();
         }
     }
 
-    /* preserve those registers and stuff */
-    for (int c = 0; c < 2; ++c)
+    /* preserve the smoothed coefficients */
+    for (int i = 0; i < 4; i++)
     {
-        for (int i = 0; i < n_cm_coeffs; i++)
-        {
-            for (int e = 0; e < 3; ++e)
-            {
-                coeff[e][c].C[i] = get1f(qfus[c].C[i], e);
-            }
-        }
-
-        for (int i = 0; i < n_filter_registers; i++)
-        {
-            for (int e = 0; e < 3; ++e)
-            {
-                Reg[e][c][i] = get1f(qfus[c].R[i], e);
-            }
-        }
-    }
-
-    for (int e = 0; e < 3; ++e)
-    {
-        for (int c = 0; c < 2; ++c)
+        for (int e = 0; e < 3; ++e)
         {
-            WP[e][c] = qfus[c].WP[e];
+            coeff[e].C[i] = get1f(C[i], e);
         }
     }
 
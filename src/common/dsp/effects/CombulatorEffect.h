@@ -25,6 +25,8 @@
 #include "Effect.h"
 #include "BiquadFilter.h"
 #include "DSPUtils.h"
+#include "DelayLineArena.h"
+#include "SurgeSSTFXAdapter.h"
 #include <sst/filters/HalfRateFilter.h>
 
 #include <vembertech/lipol.h>
@@ -66,6 +68,10 @@ class CombulatorEffect : public Effect
     virtual void process(float *dataL, float *dataR) override;
     virtual int get_ringout_decay() override { return -1; }
     virtual void suspend() override;
+    virtual size_t memoryFootprint() const override
+    {
+        return instanceBytes + delayMemory.size() * sizeof(float);
+    }
     void setvars(bool init);
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
@@ -74,14 +80,36 @@ class CombulatorEffect : public Effect
     virtual void handleStreamingMismatches(int streamingRevision,
                                            int currentSynthStreamingRevision) override;
 
-    sst::filters::QuadFilterUnitState *qfus = nullptr;
     sst::filters::HalfRate::HalfRateFilter halfbandOUT, halfbandIN;
-    sst::filters::FilterCoefficientMaker<SurgeStorage> coeff[3][2];
+    // both channels of a comb are tuned the same, so one coefficient maker serves the pair
+    sst::filters::FilterCoefficientMaker<SurgeStorage> coeff[3];
     BiquadFilter lp, hp;
-    lag<float, true> freq[3], feedback, gain[3], pan2, pan3, tone, noisemix;
-    float filterDelay[3][2][MAX_FB_COMB_EXTENDED + FIRipol_N];
-    float WP[3][2];
-    float Reg[3][2][sst::filters::n_filter_registers];
+
+    enum smoothed_values
+    {
+        sm_freq1 = 0,
+        sm_gain1 = sm_freq1 + 3,
+        sm_feedback = sm_gain1 + 3,
+        sm_tone,
+        sm_pan2,
+        sm_pan3,
+        sm_noisemix,
+
+        sm_num_values,
+    };
+    surge::sstfx::SmoothedParamBank<sm_num_values> smoothed;
+    /*
+     * The six comb lines (three combs, two channels) run as two four lane registers, one per
+     * channel, and since the channels share delay times every tap position and set of sinc
+     * weights is worked out once per comb. The lines are sized for the lowest note they are
+     * tuned to, a power of 2 up to MAX_FB_COMB_EXTENDED, and grow if the combs are tuned lower.
+     */
+    int combLength{0};
+    Surge::Memory::DelayLineArena::Buffer delayMemory;
+    float *filterDelay[3][2];
+    int WP{0};
+
+    void sizeCombs(int length, bool preserve);
 
     static constexpr int PANLAW_SIZE = 4096; // power of 2 please
     float panL[PANLAW_SIZE], panR[PANLAW_SIZE];
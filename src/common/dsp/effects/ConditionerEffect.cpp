@@ -39,6 +39,7 @@ ConditionerEffect::ConditionerEffect(SurgeStorage *storage, FxStorage *fxdata, p
     : Effect(storage, fxdata, pd), band1(storage), band2(storage), hp(storage)
 {
     bufpos = 0;
+    lookaheadSamples = 1;
 
     ampL.set_blocksize(BLOCK_SIZE);
     ampR.set_blocksize(BLOCK_SIZE);
@@ -56,9 +57,11 @@ void ConditionerEffect::init()
     filtered_lamax = 1.f;
     filtered_lamax2 = 1.f;
     gain = 1.f;
-    memset(lamax, 0, sizeof(float) * (lookahead << 1));
-    memset(delayed[0], 0, sizeof(float) * lookahead);
-    memset(delayed[1], 0, sizeof(float) * lookahead);
+    memset(delayed[0], 0, sizeof(float) * max_lookahead);
+    memset(delayed[1], 0, sizeof(float) * max_lookahead);
+    peakFront = 0;
+    peakBack = 0;
+    now = 0;
 
     vu[0] = 0.f;
     vu[1] = 0.f;
@@ -74,6 +77,11 @@ void ConditionerEffect::setvars(bool init)
     band2.coeff_peakEQ(band2.calc_omega(4.75), 2, *pd_float[cond_treble]);
     hp.coeff_HP(hp.calc_omega(*pd_float[cond_hpwidth] / 12.0), 0.4);
 
+    // ct_conditioner_lookahead runs from 0.5 to 8 ms
+    float lookaheadMs = 0.5f * powf(2.f, 4.f * fxdata->p[cond_lookahead].val.f);
+    lookaheadSamples = std::clamp((int)(0.001f * lookaheadMs * storage->samplerate + 0.5f), 1,
+                                  max_lookahead - 2);
+
     if (init)
     {
     }
@@ -154,14 +162,29 @@ void ConditionerEffect::process(float *dataL, float *dataR)
     vu[0] = max(vu[0], mech::blockAbsMax<BLOCK_SIZE>(dataL));
     vu[1] = max(vu[1], mech::blockAbsMax<BLOCK_SIZE>(dataR));
 
+    const int mask = max_lookahead - 1;
+
     for (int k = 0; k < BLOCK_SIZE; k++)
     {
-        float dL = delayed[0][bufpos];
-        float dR = delayed[1][bufpos];
+        float peak = max(fabsf(dataL[k]), fabsf(dataR[k]));
+        peak = peak * peak; // RMS
 
-        float la = lamax[lookahead - 2];
+        while (peakBack != peakFront && peakValue[(peakBack - 1) & mask] <= peak)
+        {
+            peakBack = (peakBack - 1) & mask;
+        }
+
+        peakValue[peakBack] = peak;
+        peakTime[peakBack] = now;
+        peakBack = (peakBack + 1) & mask;
+
+        // the peak we just pushed is never too old, so this can't empty the deque
+        while (now - peakTime[peakFront] > (uint32_t)lookaheadSamples)
+        {
+            peakFront = (peakFront + 1) & mask;
+        }
 
-        la = sqrt(2.f * la); // RMS test
+        float la = sqrt(2.f * peakValue[peakFront]); // RMS test
 
         la = max(1.f, la); // * outscale_inv);
         filtered_lamax = (1 - attack) * filtered_lamax + attack * la;
@@ -174,21 +197,12 @@ void ConditionerEffect::process(float *dataL, float *dataR)
         delayed[0][bufpos] = dataL[k];
         delayed[1][bufpos] = dataR[k];
 
-        lamax[bufpos] = max(fabsf(dataL[k]), fabsf(dataR[k]));
-        lamax[bufpos] = lamax[bufpos] * lamax[bufpos]; // RMS
-
-        int of = 0;
-        for (int i = 0; i < (lookahead_bits); i++)
-        {
-            int nextof = of + (lookahead >> i);
-            lamax[nextof + (bufpos >> (i + 1))] =
-                max(lamax[of + (bufpos >> i)], lamax[of + ((bufpos >> i) ^ 0x1)]);
-            of = nextof;
-        }
-        dataL[k] = (gain)*dL;
-        dataR[k] = (gain)*dR;
+        int rp = (bufpos - lookaheadSamples) & mask;
+        dataL[k] = (gain)*delayed[0][rp];
+        dataR[k] = (gain)*delayed[1][rp];
 
-        bufpos = (bufpos + 1) & (lookahead - 1);
+        bufpos = (bufpos + 1) & mask;
+        now++;
     }
 
     postamp.multiply_2_blocks(dataL, dataR, BLOCK_SIZE_QUAD);
@@ -254,7 +268,7 @@ int ConditionerEffect::group_label_ypos(int id)
     case 2:
         return 15;
     case 3:
-        return 29;
+        return 31;
     }
     return 0;
 }
@@ -285,6 +299,9 @@ void ConditionerEffect::init_ctrltypes()
     fxdata->p[cond_release].set_type(ct_percent_bipolar);
     fxdata->p[cond_gain].set_name("Gain");
     fxdata->p[cond_gain].set_type(ct_decibel_attenuation);
+    fxdata->p[cond_lookahead].set_name("Lookahead");
+    fxdata->p[cond_lookahead].set_type(ct_conditioner_lookahead);
+    fxdata->p[cond_lookahead].modulateable = false;
 
     fxdata->p[cond_bass].posy_offset = 1;
     fxdata->p[cond_treble].posy_offset = 1;
@@ -296,7 +313,8 @@ void ConditionerEffect::init_ctrltypes()
     fxdata->p[cond_threshold].posy_offset = 13;
     fxdata->p[cond_attack].posy_offset = 13;
     fxdata->p[cond_release].posy_offset = 13;
-    fxdata->p[cond_gain].posy_offset = 15;
+    fxdata->p[cond_lookahead].posy_offset = 9;
+    fxdata->p[cond_gain].posy_offset = 17;
 }
 
 void ConditionerEffect::init_default_values()
@@ -321,4 +339,9 @@ void ConditionerEffect::handleStreamingMismatches(int streamingRevision,
         fxdata->p[cond_hpwidth].val.f = -60;
         fxdata->p[cond_hpwidth].deactivated = true;
     }
+
+    if (streamingRevision <= 26)
+    {
+        fxdata->p[cond_lookahead].val.f = fxdata->p[cond_lookahead].val_default.f;
+    }
 }
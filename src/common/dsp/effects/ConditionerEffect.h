@@ -28,8 +28,8 @@
 
 #include <vembertech/lipol.h>
 
-const int lookahead_bits = 7;
-const int lookahead = 1 << 7;
+// room for the longest lookahead (8 ms) at 192 kHz, with a couple of samples to spare
+const int max_lookahead = 1 << 11;
 
 class ConditionerEffect : public Effect
 {
@@ -43,6 +43,7 @@ class ConditionerEffect : public Effect
     virtual void process_only_control() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual int get_ringout_decay() override { return 100; }
+    virtual int get_latency_samples() override { return lookaheadSamples; }
     virtual void suspend() override;
     void setvars(bool init);
     virtual void init_ctrltypes() override;
@@ -65,15 +66,24 @@ class ConditionerEffect : public Effect
         cond_release,
         cond_gain,
         cond_hpwidth,
+        cond_lookahead,
     };
 
   private:
     BiquadFilter band1, band2, hp;
     float ef;
     lipol<float, true> a_rate, r_rate;
-    float lamax[lookahead << 1];
-    float delayed[2][lookahead];
-    int bufpos;
+    float delayed[2][max_lookahead];
+    int bufpos, lookaheadSamples;
+
+    /*
+     * The peaks still inside the lookahead window, kept as a monotonic deque: each new peak
+     * drops every older one it's at least as loud as, so the front is always the window max.
+     */
+    float peakValue[max_lookahead];
+    uint32_t peakTime[max_lookahead];
+    int peakFront, peakBack;
+    uint32_t now;
     float filtered_lamax, filtered_lamax2, gain;
 };
 
@@ -0,0 +1,425 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "ConvolutionEffect.h"
+#include "PartitionedConvolver.h"
+#include "globals.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
+
+#include "sst/basic-blocks/mechanics/block-ops.h"
+
+#include "juce_audio_formats/juce_audio_formats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace mech = sst::basic_blocks::mechanics;
+
+struct ConvolutionEffect::Kernel
+{
+    std::string path;
+    float samplerate{0.f};
+    int length{0};
+    PartitionedConvolver conv[2];
+};
+
+/*
+ * Shared by the effect and any loader threads it has started, so a load which
+ * finishes after the effect has gone away has somewhere safe to land.
+ */
+struct ConvolutionEffect::Loader
+{
+    std::atomic<Kernel *> ready{nullptr};
+    std::atomic<Kernel *> retired{nullptr};
+    std::atomic<uint32_t> latestRequest{0};
+
+    ~Loader()
+    {
+        delete ready.load();
+        delete retired.load();
+    }
+};
+
+namespace
+{
+bool readImpulseResponse(const std::string &path, std::vector<float> ch[2], double &fileRate)
+{
+    auto file = juce::File(juce::String::fromUTF8(path.c_str()));
+
+    if (!file.existsAsFile())
+        return false;
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    // map the file rather than stream it where the format allows
+    juce::WavAudioFormat wav;
+    juce::AiffAudioFormat aiff;
+
+    for (juce::AudioFormat *fmt : {(juce::AudioFormat *)&wav, (juce::AudioFormat *)&aiff})
+    {
+        if (!fmt->canHandleFile(file))
+            continue;
+
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mm(fmt->createMemoryMappedReader(file));
+
+        if (mm && mm->mapEntireFile())
+        {
+            reader = std::move(mm);
+            break;
+        }
+    }
+
+    if (!reader)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        reader.reset(formats.createReaderFor(file));
+    }
+
+    if (!reader || reader->sampleRate <= 0 || reader->numChannels == 0)
+        return false;
+
+    fileRate = reader->sampleRate;
+
+    auto len = (int)std::min<juce::int64>(
+        reader->lengthInSamples,
+        (juce::int64)(fileRate * ConvolutionEffect::maxImpulseLengthSeconds));
+
+    if (len <= 0)
+        return false;
+
+    auto nch = std::min((int)reader->numChannels, 2);
+    juce::AudioBuffer<float> buffer(nch, len);
+
+    if (!reader->read(&buffer, 0, len, 0, true, nch > 1))
+        return false;
+
+    for (int c = 0; c < 2; ++c)
+    {
+        auto *src = buffer.getReadPointer(std::min(c, nch - 1));
+        ch[c].assign(src, src + len);
+    }
+
+    return true;
+}
+
+// Windowed sinc resampling, low passed at the lower of the two Nyquist frequencies
+std::vector<float> resample(const std::vector<float> &in, double ratio)
+{
+    const double cutoff = std::min(1.0, ratio);
+    const int halfTaps = (int)std::ceil(16.0 / cutoff);
+    const auto inLen = (int)in.size();
+
+    std::vector<float> out((size_t)std::ceil(inLen * ratio));
+
+    for (size_t n = 0; n < out.size(); ++n)
+    {
+        double t = n / ratio;
+        int c = (int)std::floor(t);
+        double s = 0.0;
+
+        for (int i = std::max(0, c - halfTaps + 1); i <= std::min(inLen - 1, c + halfTaps); ++i)
+        {
+            double x = t - i;
+            double arg = M_PI * x * cutoff;
+            double sinc = std::fabs(arg) < 1e-9 ? 1.0 : std::sin(arg) / arg;
+            double window = 0.5 + 0.5 * std::cos(M_PI * x / halfTaps);
+
+            s += in[i] * cutoff * sinc * window;
+        }
+
+        out[n] = (float)s;
+    }
+
+    return out;
+}
+
+ConvolutionEffect::Kernel *buildKernel(const std::string &path, float samplerate)
+{
+    auto k = std::make_unique<ConvolutionEffect::Kernel>();
+    k->path = path;
+    k->samplerate = samplerate;
+
+    std::vector<float> ch[2];
+    double fileRate{0};
+
+    if (path.empty() || !readImpulseResponse(path, ch, fileRate))
+        return k.release();
+
+    if (std::fabs(fileRate - samplerate) > 0.5)
+    {
+        for (auto &c : ch)
+            c = resample(c, samplerate / fileRate);
+    }
+
+    // there is no point paying to convolve with a silent tail
+    size_t len = 0;
+    float energy = 0.f;
+
+    for (auto &c : ch)
+    {
+        float e = 0.f;
+
+        for (size_t i = 0; i < c.size(); ++i)
+        {
+            if (std::fabs(c[i]) > 1e-6f)
+                len = std::max(len, i + 1);
+            e += c[i] * c[i];
+        }
+
+        energy = std::max(energy, e);
+    }
+
+    if (len == 0 || energy <= 0.f)
+        return k.release();
+
+    // normalize to unit energy, so a loud and a quiet file sit at about the same level
+    auto norm = 1.f / std::sqrt(energy);
+
+    for (int c = 0; c < 2; ++c)
+    {
+        ch[c].resize(len);
+
+        for (auto &f : ch[c])
+            f *= norm;
+
+        k->conv[c].prepare(ch[c].data(), (int)len);
+    }
+
+    k->length = (int)len;
+
+    return k.release();
+}
+} // namespace
+
+ConvolutionEffect::ConvolutionEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
+    : Effect(storage, fxdata, pd), loader(std::make_shared<Loader>()), lp(storage), hp(storage)
+{
+    gain.set_blocksize(BLOCK_SIZE);
+    width.set_blocksize(BLOCK_SIZE);
+    mix.set_blocksize(BLOCK_SIZE);
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+    // make sure a load still in flight doesn't get handed to a loader nobody reads
+    loader->latestRequest++;
+}
+
+void ConvolutionEffect::init()
+{
+    if (kernel)
+    {
+        kernel->conv[0].reset();
+        kernel->conv[1].reset();
+    }
+
+    setvars(true);
+}
+
+void ConvolutionEffect::setvars(bool init)
+{
+    if (init)
+    {
+        lp.suspend();
+        hp.suspend();
+
+        hp.coeff_HP(hp.calc_omega(*pd_float[conv_lowcut] / 12.0), 0.707);
+        hp.coeff_instantize();
+
+        lp.coeff_LP2B(lp.calc_omega(*pd_float[conv_highcut] / 12.0), 0.707);
+        lp.coeff_instantize();
+
+        gain.set_target(storage->db_to_linear(*pd_float[conv_gain]));
+        width.set_target(storage->db_to_linear(*pd_float[conv_width]));
+        mix.set_target(clamp01(*pd_float[conv_mix]));
+
+        gain.instantize();
+        width.instantize();
+        mix.instantize();
+    }
+    else
+    {
+        hp.coeff_HP(hp.calc_omega(*pd_float[conv_lowcut] / 12.0), 0.707);
+        lp.coeff_LP2B(lp.calc_omega(*pd_float[conv_highcut] / 12.0), 0.707);
+
+        gain.set_target_smoothed(storage->db_to_linear(*pd_float[conv_gain]));
+        width.set_target_smoothed(storage->db_to_linear(*pd_float[conv_width]));
+        mix.set_target_smoothed(clamp01(*pd_float[conv_mix]));
+    }
+}
+
+void ConvolutionEffect::requestKernel()
+{
+    requestedPath = fxdata->impulseResponsePath;
+    requestedSampleRate = storage->samplerate;
+
+    auto id = ++loader->latestRequest;
+
+    if (requestedPath.empty())
+    {
+        delete loader->retired.exchange(kernel.release(), std::memory_order_acq_rel);
+        ringout_value = identityRingout;
+        return;
+    }
+
+    // This only happens when the file or the sample rate changes, so a thread per load is fine
+
+    std::thread([l = loader, path = requestedPath, sr = requestedSampleRate, id]() {
+        Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Loader);
+        auto fpuguard = Surge::FPUState::DSPThreadGuard();
+        auto *k = buildKernel(path, sr);
+
+        if (l->latestRequest != id)
+        {
+            // superseded while we were working
+            delete k;
+            return;
+        }
+
+        delete l->ready.exchange(k, std::memory_order_acq_rel);
+        delete l->retired.exchange(nullptr, std::memory_order_acq_rel);
+    }).detach();
+}
+
+void ConvolutionEffect::takeReadyKernel()
+{
+    auto *k = loader->ready.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (!k)
+        return;
+
+    // the next load frees the old one, so it doesn't happen here on the audio thread
+    delete loader->retired.exchange(kernel.release(), std::memory_order_acq_rel);
+    kernel.reset(k);
+
+    ringout_value = (kernel->length + PartitionedConvolver::tailPartition) / BLOCK_SIZE + 32;
+}
+
+int ConvolutionEffect::getImpulseLength() const { return kernel ? kernel->length : 0; }
+
+void ConvolutionEffect::process(float *dataL, float *dataR)
+{
+    if (fxdata->impulseResponsePath != requestedPath ||
+        storage->samplerate != requestedSampleRate)
+    {
+        requestKernel();
+    }
+
+    takeReadyKernel();
+
+    setvars(false);
+
+    float wetL alignas(16)[BLOCK_SIZE], wetR alignas(16)[BLOCK_SIZE];
+
+    if (kernel && kernel->length > 0)
+    {
+        kernel->conv[0].process(dataL, wetL);
+        kernel->conv[1].process(dataR, wetR);
+    }
+    else
+    {
+        mech::copy_from_to<BLOCK_SIZE>(dataL, wetL);
+        mech::copy_from_to<BLOCK_SIZE>(dataR, wetR);
+    }
+
+    gain.multiply_2_blocks(wetL, wetR, BLOCK_SIZE_QUAD);
+
+    if (!fxdata->p[conv_lowcut].deactivated)
+    {
+        hp.process_block(wetL, wetR);
+    }
+
+    if (!fxdata->p[conv_highcut].deactivated)
+    {
+        lp.process_block(wetL, wetR);
+    }
+
+    applyWidth(wetL, wetR, width);
+
+    mix.fade_2_blocks_inplace(dataL, wetL, dataR, wetR, BLOCK_SIZE_QUAD);
+}
+
+void ConvolutionEffect::suspend() { init(); }
+
+const char *ConvolutionEffect::group_label(int id)
+{
+    switch (id)
+    {
+    case 0:
+        return "EQ";
+    case 1:
+        return "Output";
+    }
+    return 0;
+}
+
+int ConvolutionEffect::group_label_ypos(int id)
+{
+    switch (id)
+    {
+    case 0:
+        return 1;
+    case 1:
+        return 7;
+    }
+    return 0;
+}
+
+void ConvolutionEffect::init_ctrltypes()
+{
+    Effect::init_ctrltypes();
+
+    fxdata->p[conv_lowcut].set_name("Low Cut");
+    fxdata->p[conv_lowcut].set_type(ct_freq_audible_deactivatable_hp);
+    fxdata->p[conv_highcut].set_name("High Cut");
+    fxdata->p[conv_highcut].set_type(ct_freq_audible_deactivatable_lp);
+
+    fxdata->p[conv_gain].set_name("Gain");
+    fxdata->p[conv_gain].set_type(ct_decibel);
+    fxdata->p[conv_width].set_name("Width");
+    fxdata->p[conv_width].set_type(ct_decibel_narrow);
+    fxdata->p[conv_mix].set_name("Mix");
+    fxdata->p[conv_mix].set_type(ct_percent);
+
+    for (int i = conv_lowcut; i < conv_num_params; ++i)
+    {
+        fxdata->p[i].posy_offset = (i >= conv_gain) ? 3 : 1;
+    }
+}
+
+void ConvolutionEffect::init_default_values()
+{
+    fxdata->p[conv_lowcut].val.f = fxdata->p[conv_lowcut].val_min.f;
+    fxdata->p[conv_lowcut].deactivated = true;
+    fxdata->p[conv_highcut].val.f = fxdata->p[conv_highcut].val_max.f;
+    fxdata->p[conv_highcut].deactivated = true;
+
+    fxdata->p[conv_gain].val.f = 0.f;
+    fxdata->p[conv_width].val.f = 0.f;
+    fxdata->p[conv_mix].val.f = 0.5f;
+}
@@ -0,0 +1,99 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
+#define SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
+#include "Effect.h"
+#include "BiquadFilter.h"
+#include "DSPUtils.h"
+
+#include <vembertech/lipol.h>
+
+#include <memory>
+#include <string>
+
+/*
+ * A convolution reverb. The impulse response comes from the file named in the slot's
+ * FxStorage::impulseResponsePath. When that or the sample rate changes, a loader thread
+ * reads, resamples and transforms the response and hands it over to the audio thread,
+ * which keeps running the previous one until the new one is ready. With no response
+ * loaded the wet path is the dry signal, so the EQ and width still apply.
+ */
+class ConvolutionEffect : public Effect
+{
+  public:
+    // responses longer than this are cut short
+    static constexpr float maxImpulseLengthSeconds = 10.f;
+
+    enum conv_params
+    {
+        conv_lowcut = 0,
+        conv_highcut,
+
+        conv_gain,
+        conv_width,
+        conv_mix,
+
+        conv_num_params,
+    };
+
+    ConvolutionEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
+    virtual ~ConvolutionEffect();
+    virtual const char *get_effectname() override { return "convolution"; }
+    virtual void init() override;
+    virtual void process(float *dataL, float *dataR) override;
+    virtual void suspend() override;
+    void setvars(bool init);
+    virtual void init_ctrltypes() override;
+    virtual void init_default_values() override;
+    virtual const char *group_label(int id) override;
+    virtual int group_label_ypos(int id) override;
+
+    virtual int get_ringout_decay() override { return ringout_value; }
+
+    // Length in samples of the response currently in use, or 0 if there isn't one
+    int getImpulseLength() const;
+
+    struct Kernel;
+    struct Loader;
+
+  private:
+    void requestKernel();
+    void takeReadyKernel();
+
+    std::unique_ptr<Kernel> kernel;
+    std::shared_ptr<Loader> loader;
+
+    // what the loader was last asked for, so we only ask again when it changes
+    std::string requestedPath;
+    float requestedSampleRate{0.f};
+
+    // with no response loaded only the EQ needs to ring out
+    static constexpr int identityRingout = 32;
+    int ringout_value = identityRingout;
+
+    BiquadFilter lp, hp;
+    lipol_ps_blocksz gain alignas(16), width alignas(16), mix alignas(16);
+};
+
+#endif // SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
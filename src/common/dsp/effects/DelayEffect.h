@@ -43,6 +43,9 @@ class DelayEffect
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
 
+    // the feedback path can't be longer than the delay buffer
+    virtual int get_silent_tail_window() override { return max_delay_length / BLOCK_SIZE; }
+
     virtual void handleStreamingMismatches(int streamingRevision,
                                            int currentSynthStreamingRevision) override;
 };
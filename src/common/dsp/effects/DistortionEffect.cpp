@@ -21,6 +21,7 @@
  */
 #include "DistortionEffect.h"
 #include "DebugHelpers.h"
+#include "WaveshaperADAA.h"
 
 // feedback can get tricky with packed SSE
 
@@ -118,6 +119,17 @@ void DistortionEffect::process(float *dataL, float *dataR)
     // FX waveshapers have value at wst_soft for 0; so don't add wst_soft here (like we did in 1.9)
     bool useSSEShaper = (ws >= sst::waveshapers::WaveshaperType::wst_sine);
     auto wsop = sst::waveshapers::GetQuadWaveshaper(ws);
+
+    // the antialiased version of either, which keeps its history in the waveshaper registers
+    auto aaop = GetAntialiasedLookupWaveshaper(ws, fxdata->p[dist_model].deform_type);
+    if (aaop != lastAntialiasedOp)
+    {
+        for (int i = 0; i < sst::waveshapers::n_waveshaper_registers; ++i)
+            wsState.R[i] = SIMD_MM(setzero_ps)();
+
+        lastAntialiasedOp = aaop;
+    }
+
     float dD = 0.f;
     float dNow = dS;
 
@@ -144,7 +156,25 @@ void DistortionEffect::process(float *dataL, float *dataR)
                 lp1.process_sample_nolag(L, R);
             }
 
-            if (useSSEShaper)
+            if (aaop)
+            {
+                // the lookup shapes take the driven signal as it is, like lookup_waveshape
+                float sb alignas(16)[4] = {0, 0, 0, 0};
+                auto d = useSSEShaper ? dNow : 1.f;
+                auto dInv = 1.f / d;
+
+                sb[0] = L * dInv;
+                sb[1] = R * dInv;
+                auto lr128 = SIMD_MM(load_ps)(sb);
+                auto wsres = aaop(&wsState, lr128, SIMD_MM(set1_ps)(d));
+                SIMD_MM(store_ps)(sb, wsres);
+                L = sb[0];
+                R = sb[1];
+
+                if (useSSEShaper)
+                    dNow += dD;
+            }
+            else if (useSSEShaper)
             {
                 float sb alignas(16)[4];
                 auto dInv = 1.f / dNow;
@@ -25,8 +25,7 @@ using namespace std;
 
 FrequencyShifterEffect::FrequencyShifterEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
     : Effect(storage, fxdata, pd), time(0.0001), shiftL(0.01),
-      shiftR(0.01), // fiL(true), frL(true), fiR(true), frR(true)
-      fr(6, true), fi(6, true)
+      shiftR(0.01)
 {
 }
 
@@ -36,8 +35,7 @@ void FrequencyShifterEffect::init()
 {
     memset(buffer, 0, 2 * max_delay_length * sizeof(float));
     wpos = 0;
-    fr.reset();
-    fi.reset();
+    hilbert.reset();
     ringout = 10000000;
 
     // See issue #1444 and the fix for this stuff
@@ -72,23 +70,19 @@ void FrequencyShifterEffect::setvars(bool init)
     // 1000 Hz, this increases far too much (from 100 Hz to 10 kHz)!
     double shift = *pd_float[freq_shift] * (fxdata->p[freq_shift].extend_range ? 1000.0 : 10.0);
     double omega = shift * M_PI * 2.0 * storage->dsamplerate_inv;
-    o1L.set_rate(M_PI * 0.5 - min(0.0, omega));
-    o2L.set_rate(M_PI * 0.5 + max(0.0, omega));
+    oL.set_rate(omega);
 
     // phase lock oscillators
     if (*pd_float[freq_rmult] == 1.f)
     {
         const double a = 0.01;
-        o1R.r = a * o1L.r + (1 - a) * o1R.r;
-        o1R.i = a * o1L.i + (1 - a) * o1R.i;
-        o2R.r = a * o2L.r + (1 - a) * o2R.r;
-        o2R.i = a * o2L.i + (1 - a) * o2R.i;
+        oR.r = a * oL.r + (1 - a) * oR.r;
+        oR.i = a * oL.i + (1 - a) * oR.i;
     }
     else
         omega *= *pd_float[freq_rmult];
 
-    o1R.set_rate(M_PI * 0.5 - min(0.0, omega));
-    o2R.set_rate(M_PI * 0.5 + max(0.0, omega));
+    oR.set_rate(omega);
 
     const float db96 = powf(10.f, 0.05f * -96.f);
     float maxfb = max(db96, feedback.v);
@@ -134,29 +128,17 @@ void FrequencyShifterEffect::process(float *dataL, float *dataR)
                     storage->sinctable1X[sinc + FIRipol_N - i];
         }
 
-        // do freqshift (part I)
-        o1L.process();
-        Lr[k] = L[k] * o1L.r;
-        Li[k] = L[k] * o1L.i;
-        o1R.process();
-        Rr[k] = R[k] * o1R.r;
-        Ri[k] = R[k] * o1R.i;
     }
 
-    fr.process_block(Lr, Rr, BLOCK_SIZE);
-    fi.process_block(Li, Ri, BLOCK_SIZE);
+    // analytic signal, then single sideband shift
+    hilbert.process_block(L, R, Lr, Li, Rr, Ri, BLOCK_SIZE);
 
     for (k = 0; k < BLOCK_SIZE; k++)
     {
-        o2L.process();
-        Lr[k] *= o2L.r;
-        Li[k] *= o2L.i;
-        o2R.process();
-        Rr[k] *= o2R.r;
-        Ri[k] *= o2R.i;
-
-        L[k] = 2 * (Lr[k] + Li[k]);
-        R[k] = 2 * (Rr[k] + Ri[k]);
+        oL.process();
+        L[k] = Lr[k] * oL.r - Li[k] * oL.i;
+        oR.process();
+        R[k] = Rr[k] * oR.r - Ri[k] * oR.i;
 
         int wp = (wpos + k) & (max_delay_length - 1);
 
@@ -27,13 +27,13 @@
 #include "DSPUtils.h"
 
 #include <vembertech/lipol.h>
-#include <sst/filters/HalfRateFilter.h>
+#include "StereoHilbertTransform.h"
 #include "sst/basic-blocks/dsp/QuadratureOscillators.h"
 
 class FrequencyShifterEffect : public Effect
 {
   public:
-    sst::filters::HalfRate::HalfRateFilter fr alignas(16), fi alignas(16);
+    StereoHilbertTransform hilbert;
     lipol_ps_blocksz mix alignas(16);
     FrequencyShifterEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
     virtual ~FrequencyShifterEffect();
@@ -65,10 +65,8 @@ class FrequencyShifterEffect : public Effect
     bool inithadtempo;
     float buffer[2][max_delay_length];
     int wpos;
-    // CHalfBandFilter<6> frL,fiL,frR,fiR;
-
     using quadr_osc = sst::basic_blocks::dsp::SurgeQuadrOsc<float>;
-    quadr_osc o1L, o2L, o1R, o2R;
+    quadr_osc oL, oR;
     int ringout_time;
 };
 
@@ -31,20 +31,12 @@ namespace sdsp = sst::basic_blocks::dsp;
 namespace mech = sst::basic_blocks::mechanics;
 
 MSToolEffect::MSToolEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
-    : Effect(storage, fxdata, pd), hpm(storage), hps(storage), lpm(storage), lps(storage),
-      bandm(storage), bands(storage)
+    : Effect(storage, fxdata, pd), lowCut(storage), band(storage), highCut(storage)
 {
     ampM.set_blocksize(BLOCK_SIZE);
     ampS.set_blocksize(BLOCK_SIZE);
     postampL.set_blocksize(BLOCK_SIZE);
     postampR.set_blocksize(BLOCK_SIZE);
-
-    hpm.setBlockSize(BLOCK_SIZE * slowrate);
-    bandm.setBlockSize(BLOCK_SIZE * slowrate);
-    lpm.setBlockSize(BLOCK_SIZE * slowrate);
-    hps.setBlockSize(BLOCK_SIZE * slowrate);
-    bands.setBlockSize(BLOCK_SIZE * slowrate);
-    lps.setBlockSize(BLOCK_SIZE * slowrate);
 }
 
 MSToolEffect::~MSToolEffect() {}
@@ -52,28 +44,28 @@ MSToolEffect::~MSToolEffect() {}
 void MSToolEffect::init()
 {
     setvars(true);
-    hpm.suspend();
-    bandm.suspend();
-    lpm.suspend();
-    hps.suspend();
-    bands.suspend();
-    lps.suspend();
+    lowCut.suspend();
+    band.suspend();
+    highCut.suspend();
 }
 
 void MSToolEffect::setvars(bool init)
 {
+    // BiquadFilter::coeff_peakEQ
+    auto peakEQ = [this](int f, float gain) {
+        return BiquadCoefficients::peakEQ(band.calc_omega(*pd_float[f] * (1.f / 12.f)), 1,
+                                          storage->db_to_linear(gain),
+                                          storage->db_to_linear(gain * 0.5), 1);
+    };
 
     if (init)
     {
-        bandm.coeff_peakEQ(bandm.calc_omega(*pd_float[mstl_freqm] * (1.f / 12.f)), 1, 1.f);
-        bands.coeff_peakEQ(bands.calc_omega(*pd_float[mstl_freqs] * (1.f / 12.f)), 1, 1.f);
+        band.setCoefficients(0, peakEQ(mstl_freqm, 1.f));
+        band.setCoefficients(1, peakEQ(mstl_freqs, 1.f));
 
-        hpm.coeff_instantize();
-        bandm.coeff_instantize();
-        lpm.coeff_instantize();
-        hps.coeff_instantize();
-        bands.coeff_instantize();
-        lps.coeff_instantize();
+        lowCut.instantize();
+        band.instantize();
+        highCut.instantize();
 
         ampM.set_target(1.f);
         ampS.set_target(1.f);
@@ -87,14 +79,16 @@ void MSToolEffect::setvars(bool init)
     }
     else
     {
-        hpm.coeff_HP(hpm.calc_omega(*pd_float[mstl_hpm] / 12.0), 0.4);
-        bandm.coeff_peakEQ(bandm.calc_omega(*pd_float[mstl_freqm] * (1.f / 12.f)), 1,
-                           *pd_float[mstl_pqm]);
-        lpm.coeff_LP(lpm.calc_omega(*pd_float[mstl_lpm] / 12.0), 0.4);
-        hps.coeff_HP(hps.calc_omega(*pd_float[mstl_hps] / 12.0), 0.4);
-        bands.coeff_peakEQ(bands.calc_omega(*pd_float[mstl_freqs] * (1.f / 12.f)), 1,
-                           *pd_float[mstl_pqs]);
-        lps.coeff_LP(lps.calc_omega(*pd_float[mstl_lps] / 12.0), 0.4);
+        lowCut.setCoefficients(0, BiquadCoefficients::highpass(
+                                      lowCut.calc_omega(*pd_float[mstl_hpm] / 12.0), 0.4));
+        band.setCoefficients(0, peakEQ(mstl_freqm, *pd_float[mstl_pqm]));
+        highCut.setCoefficients(0, BiquadCoefficients::lowpass(
+                                       highCut.calc_omega(*pd_float[mstl_lpm] / 12.0), 0.4));
+        lowCut.setCoefficients(1, BiquadCoefficients::highpass(
+                                      lowCut.calc_omega(*pd_float[mstl_hps] / 12.0), 0.4));
+        band.setCoefficients(1, peakEQ(mstl_freqs, *pd_float[mstl_pqs]));
+        highCut.setCoefficients(1, BiquadCoefficients::lowpass(
+                                       highCut.calc_omega(*pd_float[mstl_lps] / 12.0), 0.4));
     }
 }
 
@@ -124,19 +118,24 @@ void MSToolEffect::process(float *dataL, float *dataR)
         break;
     }
 
-    if (!fxdata->p[mstl_hpm].deactivated)
-        hpm.process_block(M);
-    if (!fxdata->p[mstl_pqm].deactivated)
-        bandm.process_block(M);
-    if (!fxdata->p[mstl_lpm].deactivated)
-        lpm.process_block(M);
-
-    if (!fxdata->p[mstl_hps].deactivated)
-        hps.process_block(S);
-    if (!fxdata->p[mstl_pqs].deactivated)
-        bands.process_block(S);
-    if (!fxdata->p[mstl_lps].deactivated)
-        lps.process_block(S);
+    lowCut.setActive(0, !fxdata->p[mstl_hpm].deactivated);
+    band.setActive(0, !fxdata->p[mstl_pqm].deactivated);
+    highCut.setActive(0, !fxdata->p[mstl_lpm].deactivated);
+    lowCut.setActive(1, !fxdata->p[mstl_hps].deactivated);
+    band.setActive(1, !fxdata->p[mstl_pqs].deactivated);
+    highCut.setActive(1, !fxdata->p[mstl_lps].deactivated);
+
+    if (lowCut.anyActive() || band.anyActive() || highCut.anyActive())
+    {
+        float *const ms[2] = {M, S};
+        double frames alignas(16)[BLOCK_SIZE * 2];
+
+        BiquadBank<2>::interleave(ms, frames);
+        lowCut.processFrames(frames);
+        band.processFrames(frames);
+        highCut.processFrames(frames);
+        BiquadBank<2>::deinterleave(frames, ms);
+    }
 
     ampM.multiply_block(M, BLOCK_SIZE_QUAD);
     ampS.multiply_block(S, BLOCK_SIZE_QUAD);
@@ -23,7 +23,7 @@
 #ifndef SURGE_SRC_COMMON_DSP_EFFECTS_MSTOOLEFFECT_H
 #define SURGE_SRC_COMMON_DSP_EFFECTS_MSTOOLEFFECT_H
 #include "Effect.h"
-#include "BiquadFilter.h"
+#include "BiquadBank.h"
 #include "DSPUtils.h"
 #include <vembertech/lipol.h>
 
@@ -64,7 +64,8 @@ class MSToolEffect : public Effect
     };
 
   private:
-    BiquadFilter hpm, hps, lpm, lps, bandm, bands;
+    // mid in lane 0 and side in lane 1 of each
+    BiquadBank<2> lowCut, band, highCut;
 };
 
 #endif // SURGE_SRC_COMMON_DSP_EFFECTS_MSTOOLEFFECT_H
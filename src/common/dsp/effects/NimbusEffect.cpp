@@ -33,6 +33,33 @@ NimbusEffect::NimbusEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
     sampleRateReset();
 }
 
+void NimbusEffect::process(float *dataL, float *dataR)
+{
+    float target = 1.f;
+
+    if (storage->adaptEffectsToLoad && !storage->renderingForBounce && *pd_int[nmb_mode] == 0)
+    {
+        auto over = (storage->audioThreadLoad - loadThreshold) / (1.f - loadThreshold);
+        target = std::clamp(1.f - over * (1.f - minDensityCap), minDensityCap, 1.f);
+    }
+
+    // move slowly so the grain rate doesn't audibly step
+    densityCap += std::clamp(target - densityCap, -densityCapSlew, densityCapSlew);
+
+    if (densityCap >= 1.f)
+    {
+        parent_t::process(dataL, dataR);
+        return;
+    }
+
+    auto &density = *pd_float[nmb_density];
+    auto requested = density;
+
+    density = std::clamp(density, -densityCap, densityCap);
+    parent_t::process(dataL, dataR);
+    density = requested;
+}
+
 const char *NimbusEffect::group_label(int id)
 {
     switch (id)
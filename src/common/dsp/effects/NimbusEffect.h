@@ -43,9 +43,18 @@ struct NimbusEffect
         surge::sstfx::SurgeSSTFXBase<sst::effects::nimbus::Nimbus<surge::sstfx::SurgeFXConfig>>;
 
     NimbusEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
+    virtual void process(float *dataL, float *dataR) override;
     virtual void init_ctrltypes() override;
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
+
+    /*
+     * In granular mode the grain rate grows with the distance of density from its centre,
+     * and so does the cost of rendering them. If the synth is asked to adapt effects to load,
+     * past loadThreshold we ease that distance in towards minDensityCap.
+     */
+    static constexpr float loadThreshold = 0.7f, minDensityCap = 0.5f, densityCapSlew = 0.005f;
+    float densityCap{1.f};
 };
 
 #endif // SURGE_NIMBUSEFFECT_H
@@ -25,12 +25,8 @@
 
 ParametricEQ3BandEffect::ParametricEQ3BandEffect(SurgeStorage *storage, FxStorage *fxdata,
                                                  pdata *pd)
-    : Effect(storage, fxdata, pd), band1(storage), band2(storage), band3(storage)
+    : Effect(storage, fxdata, pd), bands(storage)
 {
-    band1.setBlockSize(BLOCK_SIZE * slowrate); // does not matter ATM as they're smoothed
-    band2.setBlockSize(BLOCK_SIZE * slowrate);
-    band3.setBlockSize(BLOCK_SIZE * slowrate);
-
     gain.set_blocksize(BLOCK_SIZE);
     mix.set_blocksize(BLOCK_SIZE);
 }
@@ -40,27 +36,25 @@ ParametricEQ3BandEffect::~ParametricEQ3BandEffect() {}
 void ParametricEQ3BandEffect::init()
 {
     setvars(true);
-    band1.suspend();
-    band2.suspend();
-    band3.suspend();
+    bands.reset();
     bi = 0;
 }
 
 void ParametricEQ3BandEffect::setvars(bool init)
 {
+    static constexpr int gainOf[3] = {eq3_gain1, eq3_gain2, eq3_gain3};
+
     if (init)
     {
         // Set the bands to 0dB so the EQ fades in init
-        band1.coeff_peakEQ(band1.calc_omega(fxdata->p[eq3_freq1].val.f * (1.f / 12.f)),
-                           fxdata->p[eq3_bw1].val.f, 1.f);
-        band2.coeff_peakEQ(band2.calc_omega(fxdata->p[eq3_freq2].val.f * (1.f / 12.f)),
-                           fxdata->p[eq3_bw2].val.f, 1.f);
-        band3.coeff_peakEQ(band3.calc_omega(fxdata->p[eq3_freq3].val.f * (1.f / 12.f)),
-                           fxdata->p[eq3_bw3].val.f, 1.f);
+        for (int i = 0; i < 3; ++i)
+        {
+            auto g = gainOf[i];
+            bands.setPeakEQ(i, bands.calc_omega(fxdata->p[g + 1].val.f * (1.f / 12.f)),
+                            fxdata->p[g + 2].val.f, 1.f);
+        }
 
-        band1.coeff_instantize();
-        band2.coeff_instantize();
-        band3.coeff_instantize();
+        bands.instantize();
 
         gain.set_target(1.f);
         mix.set_target(1.f);
@@ -70,12 +64,13 @@ void ParametricEQ3BandEffect::setvars(bool init)
     }
     else
     {
-        band1.coeff_peakEQ(band1.calc_omega(*pd_float[eq3_freq1] * (1.f / 12.f)),
-                           *pd_float[eq3_bw1], *pd_float[eq3_gain1]);
-        band2.coeff_peakEQ(band2.calc_omega(*pd_float[eq3_freq2] * (1.f / 12.f)),
-                           *pd_float[eq3_bw2], *pd_float[eq3_gain2]);
-        band3.coeff_peakEQ(band3.calc_omega(*pd_float[eq3_freq3] * (1.f / 12.f)),
-                           *pd_float[eq3_bw3], *pd_float[eq3_gain3]);
+        // the cascade only redesigns the bands whose settings have moved
+        for (int i = 0; i < 3; ++i)
+        {
+            auto g = gainOf[i];
+            bands.setPeakEQ(i, bands.calc_omega(*pd_float[g + 1] * (1.f / 12.f)), *pd_float[g + 2],
+                            *pd_float[g]);
+        }
     }
 }
 
@@ -89,12 +84,10 @@ void ParametricEQ3BandEffect::process(float *dataL, float *dataR)
     mech::copy_from_to<BLOCK_SIZE>(dataL, L);
     mech::copy_from_to<BLOCK_SIZE>(dataR, R);
 
-    if (!fxdata->p[eq3_gain1].deactivated)
-        band1.process_block(L, R);
-    if (!fxdata->p[eq3_gain2].deactivated)
-        band2.process_block(L, R);
-    if (!fxdata->p[eq3_gain3].deactivated)
-        band3.process_block(L, R);
+    bands.setActive(0, !fxdata->p[eq3_gain1].deactivated);
+    bands.setActive(1, !fxdata->p[eq3_gain2].deactivated);
+    bands.setActive(2, !fxdata->p[eq3_gain3].deactivated);
+    bands.processBlock(L, R);
 
     gain.set_target_smoothed(storage->db_to_linear(*pd_float[eq3_gain]));
     gain.multiply_2_blocks(L, R, BLOCK_SIZE_QUAD);
@@ -94,8 +94,7 @@ inline float get1f(SIMD_M128 m, int i) { return *((float *)&m + i); }
 void ResonatorEffect::sampleRateReset()
 {
     for (int e = 0; e < 3; ++e)
-        for (int c = 0; c < 2; ++c)
-            coeff[e][c].setSampleRateAndBlockSize((float)storage->dsamplerate_os, BLOCK_SIZE_OS);
+        coeff[e].setSampleRateAndBlockSize((float)storage->dsamplerate_os, BLOCK_SIZE_OS);
 }
 
 void ResonatorEffect::process(float *dataL, float *dataR)
@@ -175,16 +174,17 @@ void ResonatorEffect::process(float *dataL, float *dataR)
     }
 
     /*
-     * So now set up across the voices (e for 'entry' to match SurgeVoice) and the channels (c)
+     * So now set up across the voices (e for 'entry' to match SurgeVoice) and the channels (c),
+     * making the coefficients once for both channels
      */
     for (int e = 0; e < 3; ++e)
     {
+        coeff[e].MakeCoeffs(cutoff[e].v, resonance[e].v * rescomp[whichModel], type, subtype,
+                            storage, false);
+
         for (int c = 0; c < 2; ++c)
         {
-            coeff[e][c].MakeCoeffs(cutoff[e].v, resonance[e].v * rescomp[whichModel], type, subtype,
-                                   storage, false);
-
-            coeff[e][c].updateState(qfus[c], e);
+            coeff[e].updateState(qfus[c], e);
 
             for (int i = 0; i < n_filter_registers; i++)
             {
@@ -258,15 +258,16 @@ void ResonatorEffect::process(float *dataL, float *dataR)
     }
 
     /* preserve those registers and stuff */
-    for (int c = 0; c < 2; ++c)
+    for (int i = 0; i < n_cm_coeffs; i++)
     {
-        for (int i = 0; i < n_cm_coeffs; i++)
+        for (int e = 0; e < 3; ++e)
         {
-            for (int e = 0; e < 3; ++e)
-            {
-                coeff[e][c].C[i] = get1f(qfus[c].C[i], e);
-            }
+            coeff[e].C[i] = get1f(qfus[0].C[i], e);
         }
+    }
+
+    for (int c = 0; c < 2; ++c)
+    {
         for (int i = 0; i < n_filter_registers; i++)
         {
             for (int e = 0; e < 3; ++e)
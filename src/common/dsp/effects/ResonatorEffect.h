@@ -83,7 +83,8 @@ class ResonatorEffect : public Effect
 
     sst::filters::QuadFilterUnitState *qfus = nullptr;
     sst::filters::HalfRate::HalfRateFilter halfbandOUT, halfbandIN;
-    sst::filters::FilterCoefficientMaker<SurgeStorage> coeff[3][2];
+    // both channels of a band are tuned the same, so one coefficient maker serves the pair
+    sst::filters::FilterCoefficientMaker<SurgeStorage> coeff[3];
     lag<float, true> cutoff[3], resonance[3], bandGain[3];
     // float filterDelay[3][2][MAX_FB_COMB + FIRipol_N];
     // float WP[3][2];
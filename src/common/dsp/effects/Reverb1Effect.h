@@ -41,6 +41,8 @@ class Reverb1Effect : public surge::sstfx::SurgeSSTFXBase<
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
     virtual int get_ringout_decay() override { return ringout_time; }
+    // predelay then one pass round the tap delay lines
+    virtual int get_silent_tail_window() override { return 2 * max_rev_dly / BLOCK_SIZE; }
     virtual void handleStreamingMismatches(int streamingRevision,
                                            int currentSynthStreamingRevision) override;
 };
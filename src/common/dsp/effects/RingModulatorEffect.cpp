@@ -34,9 +34,11 @@ RingModulatorEffect::RingModulatorEffect(SurgeStorage *storage, FxStorage *fxdat
       hp(storage)
 {
     mix.set_blocksize(BLOCK_SIZE);
+    // for the audio in carrier
+    storage->audio_in_clients++;
 }
 
-RingModulatorEffect::~RingModulatorEffect() {}
+RingModulatorEffect::~RingModulatorEffect() { storage->audio_in_clients--; }
 
 void RingModulatorEffect::init() { setvars(true); }
 
@@ -148,6 +148,89 @@ struct SurgeFXConfig
     static inline float dbToLinear(GlobalStorage *s, float f) { return s->db_to_linear(f); }
 };
 
+/*
+ * SmoothedParamBank
+ *
+ * Most effects smooth a handful of their parameters with a separate one pole lag each,
+ * ticked once per sample. This keeps all of an effect's smoothed values side by side so a
+ * single process() call moves them towards their targets four at a time, and once every one
+ * of them has arrived it stops doing anything until a target changes again.
+ *
+ * Effects declare an enum of the values they smooth and index the bank with it, setting
+ * targets when they read their parameters and reading value(i) wherever they used lag::v.
+ * The smoothing matches lag<float> with the same rate.
+ */
+template <int N> struct SmoothedParamBank
+{
+    static constexpr int nRegisters = (N + 3) / 4;
+
+    // values within this of their target snap to it, which is well below anything audible
+    static constexpr float settleDistance = 1e-4f;
+
+    SmoothedParamBank() { setRate(0.004f); }
+
+    void setRate(float lp)
+    {
+        rate = lp;
+        rateInv = 1.f - lp;
+    }
+
+    void setTarget(int i, float f)
+    {
+        assert(i >= 0 && i < N);
+        if (target[i] != f)
+        {
+            target[i] = f;
+            settled = false;
+        }
+    }
+
+    void instantize()
+    {
+        for (int i = 0; i < N; ++i)
+            v[i] = target[i];
+        settled = true;
+    }
+
+    float value(int i) const
+    {
+        assert(i >= 0 && i < N);
+        return v[i];
+    }
+
+    bool isSettled() const { return settled; }
+
+    void process()
+    {
+        if (settled)
+            return;
+
+        auto lp = SIMD_MM(set1_ps)(rate), lpinv = SIMD_MM(set1_ps)(rateInv);
+        auto dist = SIMD_MM(set1_ps)(settleDistance);
+        auto signmask = SIMD_MM(castsi128_ps)(SIMD_MM(set1_epi32)(0x7FFFFFFF));
+
+        int moving = 0;
+        for (int r = 0; r < nRegisters; ++r)
+        {
+            auto t = SIMD_MM(load_ps)(&target[r << 2]);
+            auto nv = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(SIMD_MM(load_ps)(&v[r << 2]), lpinv),
+                                      SIMD_MM(mul_ps)(t, lp));
+            auto away = SIMD_MM(cmpgt_ps)(SIMD_MM(and_ps)(SIMD_MM(sub_ps)(nv, t), signmask), dist);
+            moving |= SIMD_MM(movemask_ps)(away);
+            SIMD_MM(store_ps)(&v[r << 2], nv);
+        }
+
+        if (!moving)
+            instantize();
+    }
+
+  private:
+    float v alignas(16)[nRegisters << 2]{};
+    float target alignas(16)[nRegisters << 2]{};
+    float rate{0.f}, rateInv{1.f};
+    bool settled{true};
+};
+
 template <typename T> class Has_processControlOnly
 {
     using No = uint8_t;
@@ -61,11 +61,13 @@ VocoderEffect::VocoderEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd
         mEnvF[i] = vZero;
         mEnvFR[i] = vZero;
     }
+
+    storage->audio_in_nonOS_clients++;
 }
 
 //------------------------------------------------------------------------------------------------
 
-VocoderEffect::~VocoderEffect() {}
+VocoderEffect::~VocoderEffect() { storage->audio_in_nonOS_clients--; }
 
 //------------------------------------------------------------------------------------------------
 
@@ -240,81 +242,101 @@ void VocoderEffect::process(float *dataL, float *dataR)
             dataR[i] = rand11;
          }*/
 
-    if (modulator_mode == vim_mono || modulator_mode == vim_left || modulator_mode == vim_right)
-    {
-        float *input;
+    /*
+     * The band bank runs in two passes. First the modulator filters and envelope
+     * followers run over the whole block for each group of four bands, keeping the
+     * per sample envelope. Then the carrier filters run, but only for groups where
+     * some band is audible this block or whose carrier is still ringing out. Most
+     * of a vocal's spectrum is silent at any moment, so this skips a good part of
+     * the carrier work, and a skipped group contributes nothing to the output.
+     */
+    const bool stereoMod = (modulator_mode == vim_stereo);
+    float *input = (modulator_mode == vim_right) ? modulator_inR : modulator_in;
+    const int groups = std::min(active_bands >> 2, voc_vector_size);
 
-        if (modulator_mode == vim_mono || modulator_mode == vim_left)
-        {
-            input = modulator_in;
-        }
-        else
-        {
-            input = modulator_inR;
-        }
+    vFloat envL alignas(16)[voc_vector_size][BLOCK_SIZE];
+    vFloat envR alignas(16)[voc_vector_size][BLOCK_SIZE];
+    bool liveL[voc_vector_size], liveR[voc_vector_size];
+
+    const vFloat CullLevel = vLoad1(cullThreshold);
+
+    auto followEnvelope = [&](VectorizedSVFilter &mod, vFloat &envF, float *in, vFloat *env) {
+        vFloat peak = vZero;
 
         for (int k = 0; k < BLOCK_SIZE; k++)
         {
-            vFloat In = vLoad1(input[k]);
-
-            vFloat Left = vLoad1(dataL[k]);
-            vFloat Right = vLoad1(dataR[k]);
+            vFloat Mod = mod.CalcBPF(vLoad1(in[k]));
+            Mod = vMin(vMul(Mod, Mod), MaxLevel);
+            Mod = vAnd(Mod, vCmpGE(Mod, GateLevel));
+            envF = vMAdd(envF, Ratem1, vMul(Rate, Mod));
+            env[k] = vSqrtFast(envF);
+            peak = vMax(peak, env[k]);
+        }
 
-            vFloat LeftSum = vZero;
-            vFloat RightSum = vZero;
+        return SIMD_MM(movemask_ps)(vCmpGE(peak, CullLevel)) != 0;
+    };
 
-            for (int j = 0; (j < (active_bands >> 2)) && (j < voc_vector_size); j++)
-            {
-                vFloat Mod = mModulator[j].CalcBPF(In);
-                Mod = vMin(vMul(Mod, Mod), MaxLevel);
-                Mod = vAnd(Mod, vCmpGE(Mod, GateLevel));
-                mEnvF[j] = vMAdd(mEnvF[j], Ratem1, vMul(Rate, Mod));
-                Mod = vSqrtFast(mEnvF[j]);
-
-                LeftSum = vAdd(LeftSum, mCarrierL[j].CalcBPF(vMul(Left, Mod)));
-                RightSum = vAdd(RightSum, mCarrierR[j].CalcBPF(vMul(Right, Mod)));
-            }
+    for (int j = 0; j < groups; j++)
+    {
+        bool audible = followEnvelope(mModulator[j], mEnvF[j], stereoMod ? modulator_in : input,
+                                      envL[j]);
+        bool audibleR = audible;
 
-            float inMul = 1.0 - wet;
-            dataL[k] = dataL[k] * inMul + wet * vSum(LeftSum) * 4.f;
-            dataR[k] = dataR[k] * inMul + wet * vSum(RightSum) * 4.f;
+        if (stereoMod)
+        {
+            audibleR = followEnvelope(mModulatorR[j], mEnvFR[j], modulator_inR, envR[j]);
         }
+
+        liveL[j] = audible || !mCarrierL[j].IsQuiet(cullThreshold);
+        liveR[j] = audibleR || !mCarrierR[j].IsQuiet(cullThreshold);
+
+        // clear what's left so a group coming back starts from silence, not denormals
+        if (!liveL[j])
+            mCarrierL[j].ClearState();
+        if (!liveR[j])
+            mCarrierR[j].ClearState();
     }
-    else if (modulator_mode == vim_stereo)
+
+    vFloat LeftSum alignas(16)[BLOCK_SIZE];
+    vFloat RightSum alignas(16)[BLOCK_SIZE];
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
     {
-        for (int k = 0; k < BLOCK_SIZE; k++)
-        {
-            vFloat InL = vLoad1(modulator_in[k]);
-            vFloat InR = vLoad1(modulator_inR[k]);
-            vFloat Left = vLoad1(dataL[k]);
-            vFloat Right = vLoad1(dataR[k]);
+        LeftSum[k] = vZero;
+        RightSum[k] = vZero;
+    }
 
-            vFloat LeftSum = vZero;
-            vFloat RightSum = vZero;
+    for (int j = 0; j < groups; j++)
+    {
+        const vFloat *eL = envL[j];
+        const vFloat *eR = stereoMod ? envR[j] : envL[j];
 
-            for (int j = 0; j < (active_bands >> 2) && j < (n_vocoder_bands >> 2); j++)
+        if (liveL[j])
+        {
+            for (int k = 0; k < BLOCK_SIZE; k++)
             {
-                vFloat ModL = mModulator[j].CalcBPF(InL);
-                vFloat ModR = mModulatorR[j].CalcBPF(InR);
-                ModL = vMin(vMul(ModL, ModL), MaxLevel);
-                ModR = vMin(vMul(ModR, ModR), MaxLevel);
-
-                ModL = vAnd(ModL, vCmpGE(ModL, GateLevel));
-                ModR = vAnd(ModR, vCmpGE(ModR, GateLevel));
-
-                mEnvF[j] = vMAdd(mEnvF[j], Ratem1, vMul(Rate, ModL));
-                mEnvFR[j] = vMAdd(mEnvFR[j], Ratem1, vMul(Rate, ModR));
-                ModL = vSqrtFast(mEnvF[j]);
-                ModR = vSqrtFast(mEnvFR[j]);
-                LeftSum = vAdd(LeftSum, mCarrierL[j].CalcBPF(vMul(Left, ModL)));
-                RightSum = vAdd(RightSum, mCarrierR[j].CalcBPF(vMul(Right, ModR)));
+                LeftSum[k] =
+                    vAdd(LeftSum[k], mCarrierL[j].CalcBPF(vMul(vLoad1(dataL[k]), eL[k])));
             }
+        }
 
-            float inMul = 1.0 - wet;
-            dataL[k] = dataL[k] * inMul + wet * vSum(LeftSum) * 4.f;
-            dataR[k] = dataR[k] * inMul + wet * vSum(RightSum) * 4.f;
+        if (liveR[j])
+        {
+            for (int k = 0; k < BLOCK_SIZE; k++)
+            {
+                RightSum[k] =
+                    vAdd(RightSum[k], mCarrierR[j].CalcBPF(vMul(vLoad1(dataR[k]), eR[k])));
+            }
         }
     }
+
+    float inMul = 1.0 - wet;
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
+    {
+        dataL[k] = dataL[k] * inMul + wet * vSum(LeftSum[k]) * 4.f;
+        dataR[k] = dataR[k] * inMul + wet * vSum(RightSum[k]) * 4.f;
+    }
 }
 
 //------------------------------------------------------------------------------------------------
@@ -98,6 +98,9 @@ class VocoderEffect : public Effect
     int mBI; // block increment (to keep track of events not occurring every n blocks)
     int active_bands;
 
+    // bands whose envelope and carrier ringing stay below this (about -100 dB) skip the carrier
+    static constexpr float cullThreshold = 1e-5f;
+
     /*
     float mVoicedLevel;
     float mUnvoicedLevel;
@@ -22,6 +22,7 @@
 
 #include "WaveShaperEffect.h"
 #include "DebugHelpers.h"
+#include "WaveshaperADAA.h"
 #include "sst/basic-blocks/dsp/FastMath.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
@@ -124,8 +125,18 @@ void WaveShaperEffect::process(float *dataL, float *dataR)
     }
 
     const auto newShape = static_cast<sst::waveshapers::WaveshaperType>(*pd_int[ws_shaper]);
-    if (newShape != lastShape)
+    auto aaptr = GetAntialiasedQuadWaveshaper(newShape, fxdata->p[ws_shaper].deform_type);
+
+    if (newShape != lastShape || (aaptr != nullptr) != antialiased)
     {
+        // the halfbands sit out while the shape is antialiased, so start them again from silence
+        if ((aaptr != nullptr) != antialiased)
+        {
+            halfbandIN.reset();
+            halfbandOUT.reset();
+            antialiased = aaptr != nullptr;
+        }
+
         lastShape = newShape;
 
         float R[sst::waveshapers::n_waveshaper_registers];
@@ -139,42 +150,74 @@ void WaveShaperEffect::process(float *dataL, float *dataR)
         wss.init = SIMD_MM(cmpneq_ps)(SIMD_MM(setzero_ps)(), SIMD_MM(setzero_ps)());
     }
 
-    auto wsptr = sst::waveshapers::GetQuadWaveshaper(lastShape);
-
-    // Now upsample
-    float dataOS alignas(16)[2][BLOCK_SIZE_OS];
-    halfbandIN.process_block_U2(wetL, wetR, dataOS[0], dataOS[1], BLOCK_SIZE_OS);
-
-    if (wsptr)
+    if (aaptr)
     {
+        /*
+         * The antialiased shapes keep their aliasing down without the oversampling, so they run
+         * at the base rate, and with no halfband to make up for.
+         */
         float din alignas(16)[4] = {0, 0, 0, 0};
 
-        for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+        for (int i = 0; i < BLOCK_SIZE; ++i)
         {
-            din[0] = hbfComp * scalef * dataOS[0][i] + bias.v;
-            din[1] = hbfComp * scalef * dataOS[1][i] + bias.v;
+            din[0] = scalef * wetL[i] + bias.v;
+            din[1] = scalef * wetR[i] + bias.v;
 
             auto dat = SIMD_MM(load_ps)(din);
             auto drv = SIMD_MM(set1_ps)(drive.v);
 
-            dat = wsptr(&wss, dat, drv);
+            dat = aaptr(&wss, dat, drv);
 
             float res alignas(16)[4];
 
             SIMD_MM(store_ps)(res, dat);
 
-            dataOS[0][i] = res[0] * oscalef;
-            dataOS[1][i] = res[1] * oscalef;
+            wetL[i] = res[0] * oscalef;
+            wetR[i] = res[1] * oscalef;
 
             bias.process();
             drive.process();
         }
     }
+    else
+    {
+        auto wsptr = sst::waveshapers::GetQuadWaveshaper(lastShape);
+
+        // Now upsample
+        float dataOS alignas(16)[2][BLOCK_SIZE_OS];
+        halfbandIN.process_block_U2(wetL, wetR, dataOS[0], dataOS[1], BLOCK_SIZE_OS);
+
+        if (wsptr)
+        {
+            float din alignas(16)[4] = {0, 0, 0, 0};
 
-    halfbandOUT.process_block_D2(dataOS[0], dataOS[1], BLOCK_SIZE_OS);
+            for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+            {
+                din[0] = hbfComp * scalef * dataOS[0][i] + bias.v;
+                din[1] = hbfComp * scalef * dataOS[1][i] + bias.v;
 
-    mech::copy_from_to<BLOCK_SIZE>(dataOS[0], wetL);
-    mech::copy_from_to<BLOCK_SIZE>(dataOS[1], wetR);
+                auto dat = SIMD_MM(load_ps)(din);
+                auto drv = SIMD_MM(set1_ps)(drive.v);
+
+                dat = wsptr(&wss, dat, drv);
+
+                float res alignas(16)[4];
+
+                SIMD_MM(store_ps)(res, dat);
+
+                dataOS[0][i] = res[0] * oscalef;
+                dataOS[1][i] = res[1] * oscalef;
+
+                bias.process();
+                drive.process();
+            }
+        }
+
+        halfbandOUT.process_block_D2(dataOS[0], dataOS[1], BLOCK_SIZE_OS);
+
+        mech::copy_from_to<BLOCK_SIZE>(dataOS[0], wetL);
+        mech::copy_from_to<BLOCK_SIZE>(dataOS[1], wetR);
+    }
 
     // Apply the filters
     hpPost.coeff_HP(hpPre.calc_omega(*pd_float[ws_postlowcut] / 12.0), 0.707);
@@ -64,6 +64,7 @@ class WaveShaperEffect : public Effect
 
   private:
     sst::waveshapers::WaveshaperType lastShape{sst::waveshapers::WaveshaperType::wst_none};
+    bool antialiased{false};
     sst::waveshapers::QuadWaveshaperState wss;
     sst::filters::HalfRate::HalfRateFilter halfbandOUT, halfbandIN;
     BiquadFilter lpPre, hpPre, lpPost, hpPost;
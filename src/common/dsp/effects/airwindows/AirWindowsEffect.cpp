@@ -28,6 +28,9 @@ namespace mech = sst::basic_blocks::mechanics;
 
 constexpr int subblock_factor = 3; // divide block by 2^this
 
+// a parameter whose lag is this close to its target is treated as having arrived
+constexpr float settledParamDistance = 1e-5f;
+
 std::vector<AirWinBaseClass::Registration> AirWindowsEffect::fxreg;
 std::vector<int> AirWindowsEffect::fxregOrdering;
 AirWindowsEffect::AWFxSelectorMapper AirWindowsEffect::mapper;
@@ -47,6 +50,7 @@ AirWindowsEffect::AirWindowsEffect(SurgeStorage *storage, FxStorage *fxdata, pda
         param_lags[i].instantize();
         param_lags[i].setRate(0.004 * (BLOCK_SIZE >> subblock_factor));
     }
+    invalidateSetParams();
 }
 
 AirWindowsEffect::~AirWindowsEffect() {}
@@ -236,31 +240,87 @@ void AirWindowsEffect::process(float *dataL, float *dataR)
     // See #4900
     if (airwin->denormBeforeProcess)
     {
-        for (int i = 0; i < BLOCK_SIZE; ++i)
+        auto tiny = SIMD_MM(set1_ps)(2e-15f);
+        auto absmask = SIMD_MM(castsi128_ps)(SIMD_MM(set1_epi32)(0x7FFFFFFF));
+
+        for (int i = 0; i < BLOCK_SIZE; i += 4)
         {
-            if (fabs(dataL[i]) <= 2e-15)
-                dataL[i] = 0;
-            if (fabs(dataR[i]) <= 2e-15)
-                dataR[i] = 0;
+            auto l = SIMD_MM(load_ps)(dataL + i), r = SIMD_MM(load_ps)(dataR + i);
+            l = SIMD_MM(and_ps)(l, SIMD_MM(cmpgt_ps)(SIMD_MM(and_ps)(l, absmask), tiny));
+            r = SIMD_MM(and_ps)(r, SIMD_MM(cmpgt_ps)(SIMD_MM(and_ps)(r, absmask), tiny));
+            SIMD_MM(store_ps)(dataL + i, l);
+            SIMD_MM(store_ps)(dataR + i, r);
         }
     }
 
-    constexpr int QBLOCK = BLOCK_SIZE >> subblock_factor;
     float outL alignas(16)[BLOCK_SIZE], outR alignas(16)[BLOCK_SIZE];
 
+    int nParams = std::min(airwin->paramCount, n_fx_params - 1);
+    bool settled = true;
+
+    for (int i = 0; i < nParams; ++i)
+    {
+        param_lags[i].newValue(clamp01(*pd_float[i + 1]));
+
+        if (fxdata->p[i + 1].ctrltype != ct_airwindows_param_integral &&
+            std::fabs(param_lags[i].v - param_lags[i].target_v) > settledParamDistance)
+        {
+            settled = false;
+        }
+    }
+
+    /*
+     * Most ports recompute their coefficients, often with a pow or two, at the top of every
+     * processReplacing, so we only cut the block into sub blocks while a parameter is moving.
+     * Otherwise one call does the whole block and we skip the setParameter calls which
+     * wouldn't change anything.
+     */
+    if (settled)
+    {
+        for (int i = 0; i < nParams; ++i)
+        {
+            float v;
+            if (fxdata->p[i + 1].ctrltype == ct_airwindows_param_integral)
+            {
+                v = fxdata->p[i + 1].get_value_f01();
+            }
+            else
+            {
+                param_lags[i].instantize();
+                v = param_lags[i].v;
+            }
+
+            if (v != lastSetParam[i])
+            {
+                airwin->setParameter(i, v);
+                lastSetParam[i] = v;
+            }
+        }
+
+        float *in[2]{dataL, dataR};
+        float *out[2]{outL, outR};
+        airwin->processReplacing(in, out, BLOCK_SIZE);
+
+        mech::copy_from_to<BLOCK_SIZE>(outL, dataL);
+        mech::copy_from_to<BLOCK_SIZE>(outR, dataR);
+        return;
+    }
+
+    constexpr int QBLOCK = BLOCK_SIZE >> subblock_factor;
+
     for (int subb = 0; subb < 1 << subblock_factor; ++subb)
     {
-        for (int i = 0; i < airwin->paramCount && i < n_fx_params - 1; ++i)
+        for (int i = 0; i < nParams; ++i)
         {
-            param_lags[i].newValue(clamp01(*pd_float[i + 1]));
             if (fxdata->p[i + 1].ctrltype == ct_airwindows_param_integral)
             {
-                airwin->setParameter(i, fxdata->p[i + 1].get_value_f01());
+                lastSetParam[i] = fxdata->p[i + 1].get_value_f01();
             }
             else
             {
-                airwin->setParameter(i, param_lags[i].v);
+                lastSetParam[i] = param_lags[i].v;
             }
+            airwin->setParameter(i, lastSetParam[i]);
             param_lags[i].process();
         }
 
@@ -291,6 +351,7 @@ void AirWindowsEffect::setupSubFX(int sfx, bool useStreamedValues)
     int dp = (detailedMode ? 6 : 2);
 
     airwin = r.create(r.id, storage->dsamplerate, dp); // FIXME
+    invalidateSetParams();
     airwin->storage = storage;
 
     char fxname[1024];
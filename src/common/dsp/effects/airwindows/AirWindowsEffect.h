@@ -67,6 +67,9 @@ class alignas(16) AirWindowsEffect : public Effect
     }
 
     lag<float, true> param_lags[n_fx_params - 1];
+    // what we last handed the airwindows setParameter, so unchanged values can skip it
+    float lastSetParam[n_fx_params - 1];
+    void invalidateSetParams() { std::fill(lastSetParam, lastSetParam + n_fx_params - 1, -1.f); }
 
     void setupSubFX(int awfx, bool useStreamedValues);
     std::unique_ptr<AirWinBaseClass> airwin;
@@ -132,6 +135,7 @@ class alignas(16) AirWindowsEffect : public Effect
                     if (fx->fxdata->p[0].deactivated)
                     {
                         fx->airwin->setParameter(idx, value);
+                        fx->lastSetParam[idx] = -1.f;
                     }
 
                     if (fx->storage)
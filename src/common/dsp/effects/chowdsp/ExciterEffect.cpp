@@ -51,7 +51,11 @@ void ExciterEffect::init()
     toneFilter.coeff_HP(M_PI, q_val);
     toneFilter.coeff_instantize();
 
-    levelDetector.reset(storage->samplerate);
+    os.setOSFactor(storage->effectOversamplingFactor(1));
+    os.reset();
+
+    // the detector has always been set up for half the 2x rate it runs at, so keep its times
+    levelDetector.reset(storage->samplerate * 0.5f * os.getOSRatio());
 
     drive_gain.set_target(1.0f);
     wet_gain.set_target(0.0f);
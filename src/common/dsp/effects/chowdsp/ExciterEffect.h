@@ -77,7 +77,7 @@ class ExciterEffect : public Effect
         r = std::tanh(r) * levelR;
     }
 
-    Oversampling<1, BLOCK_SIZE> os;
+    Oversampling<2, BLOCK_SIZE> os; // 2x normally, see SurgeStorage::effectOversampling
     BiquadFilter toneFilter;
     LevelDetector levelDetector;
 
@@ -46,6 +46,7 @@ void NeuronEffect::init()
     delay1Smooth.reset(numSteps);
     delay2Smooth.reset(numSteps);
 
+    os.setOSFactor(storage->effectOversamplingFactor(2));
     os.reset();
 
     delay1.prepare({storage->dsamplerate * os.getOSRatio(), BLOCK_SIZE, 2});
@@ -87,20 +88,55 @@ void NeuronEffect::process(float *dataL, float *dataR)
 
 void NeuronEffect::process_internal(float *dataL, float *dataR, const int numSamples)
 {
-    for (int k = 0; k < numSamples; k++)
+    // the smoothers are linear, so ramping between where they stand now and where they'll
+    // be after the block is the same as stepping them every sample, bar the corner where
+    // one lands on its target mid-block
+    const auto invN = 1.f / numSamples;
+    decltype(&Wf) weights[gru_num_weights] = {&Wf, &Uf, &bf, &Wh, &Uh};
+    SIMD_M128 w[gru_num_weights], dw[gru_num_weights];
+
+    for (int i = 0; i < gru_num_weights; ++i)
     {
-        dataL[k] = processSample(dataL[k], y1[0]);
-        dataR[k] = processSample(dataR[k], y1[1]);
+        auto from = weights[i]->getCurrentValue();
+        auto to = weights[i]->skip(numSamples);
+
+        w[i] = SIMD_MM(set1_ps)(from);
+        dw[i] = SIMD_MM(set1_ps)((to - from) * invN);
+    }
+
+    // the LFO only moves once a block
+    const auto lfo_val = 1.0f + 0.5f * modLFO.value();
+    auto d1 = delay1Smooth.getCurrentValue() * lfo_val;
+    auto d2 = delay2Smooth.getCurrentValue() * lfo_val;
+    const auto dd1 = (delay1Smooth.skip(numSamples) * lfo_val - d1) * invN;
+    const auto dd2 = (delay2Smooth.skip(numSamples) * lfo_val - d2) * invN;
 
-        auto lfo_val = 1.0f + 0.5f * modLFO.value();
-        delay1.setDelay(delay1Smooth.getNextValue() * lfo_val);
-        delay2.setDelay(delay2Smooth.getNextValue() * lfo_val);
-        delay1.pushSample(0, dataL[k]);
-        delay2.pushSample(1, dataR[k]);
+    auto y = SIMD_MM(setr_ps)(y1[0], y1[1], 0.f, 0.f);
+    float out alignas(16)[4];
 
-        y1[0] = delay1.popSample(0);
-        y1[1] = delay2.popSample(1);
+    for (int k = 0; k < numSamples; k++)
+    {
+        for (int i = 0; i < gru_num_weights; ++i)
+            w[i] = SIMD_MM(add_ps)(w[i], dw[i]);
+
+        auto x = SIMD_MM(setr_ps)(dataL[k], dataR[k], 0.f, 0.f);
+        SIMD_MM(store_ps)(out, processSample(x, y, w));
+        dataL[k] = out[0];
+        dataR[k] = out[1];
+
+        d1 += dd1;
+        d2 += dd2;
+        delay1.setDelay(d1);
+        delay2.setDelay(d2);
+        delay1.pushSample(0, out[0]);
+        delay2.pushSample(1, out[1]);
+
+        y = SIMD_MM(setr_ps)(delay1.popSample(0), delay2.popSample(1), 0.f, 0.f);
     }
+
+    SIMD_MM(store_ps)(out, y);
+    y1[0] = out[0];
+    y1[1] = out[1];
 }
 
 void NeuronEffect::set_params()
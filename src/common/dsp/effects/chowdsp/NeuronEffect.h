@@ -29,6 +29,8 @@
 
 #include <vembertech/lipol.h>
 
+#include "sst/basic-blocks/dsp/FastMath.h"
+
 #include "shared/chowdsp_DelayLine.h"
 #include "shared/Oversampling.h"
 #include "shared/SmoothedValue.h"
@@ -87,14 +89,49 @@ class NeuronEffect : public Effect
     void set_params();
     void process_internal(float *dataL, float *dataR, const int numSamples);
 
-    inline float processSample(float x, float yPrev) noexcept
+    enum gru_weights
+    {
+        gru_wf = 0,
+        gru_uf,
+        gru_bf,
+        gru_wh,
+        gru_uh,
+
+        gru_num_weights,
+    };
+
+    /*
+    ** One step of the cell for both channels, L in the first lane and R in the second.
+    ** The comb feeds each output back into the next input, so the lanes can't run
+    ** across time instead.
+    */
+    static inline SIMD_M128 processSample(SIMD_M128 x, SIMD_M128 yPrev,
+                                          const SIMD_M128 *w) noexcept
     {
-        float f = sigmoid(Wf.getNextValue() * x + Uf.getNextValue() * yPrev + bf.getNextValue());
-        return f * yPrev +
-               (1.0f - f) * std::tanh(Wh.getNextValue() * x + Uh.getNextValue() * f * yPrev);
+        auto f = fastSigmoid(SIMD_MM(add_ps)(
+            SIMD_MM(add_ps)(SIMD_MM(mul_ps)(w[gru_wf], x), SIMD_MM(mul_ps)(w[gru_uf], yPrev)),
+            w[gru_bf]));
+        auto fy = SIMD_MM(mul_ps)(f, yPrev);
+        auto h = fastTanh(
+            SIMD_MM(add_ps)(SIMD_MM(mul_ps)(w[gru_wh], x), SIMD_MM(mul_ps)(w[gru_uh], fy)));
+
+        return SIMD_MM(add_ps)(fy,
+                               SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(SIMD_MM(set1_ps)(1.f), f), h));
     }
 
-    inline float sigmoid(float x) const noexcept { return 1.0f / (1.0f + std::exp(-x)); }
+    // within 1e-4 of tanh; the rational overshoots 1 a touch at the clamp, which would let
+    // f * yPrev creep up through the feedback, so it is clipped back into range
+    static inline SIMD_M128 fastTanh(SIMD_M128 x) noexcept
+    {
+        auto t = sst::basic_blocks::dsp::fasttanhSSEclamped(x);
+        return SIMD_MM(min_ps)(SIMD_MM(set1_ps)(1.f), SIMD_MM(max_ps)(SIMD_MM(set1_ps)(-1.f), t));
+    }
+
+    static inline SIMD_M128 fastSigmoid(SIMD_M128 x) noexcept
+    {
+        const auto half = SIMD_MM(set1_ps)(0.5f);
+        return SIMD_MM(add_ps)(half, SIMD_MM(mul_ps)(half, fastTanh(SIMD_MM(mul_ps)(half, x))));
+    }
 
     enum
     {
@@ -115,7 +152,7 @@ class NeuronEffect : public Effect
     lipol_ps_blocksz makeup alignas(16), width alignas(16), outgain alignas(16);
     chowdsp::DelayLine<float, chowdsp::DelayLineInterpolationTypes::Linear> delay1{1 << 18};
     chowdsp::DelayLine<float, chowdsp::DelayLineInterpolationTypes::Linear> delay2{1 << 18};
-    Oversampling<2, BLOCK_SIZE> os;
+    Oversampling<3, BLOCK_SIZE> os; // 4x normally, see SurgeStorage::effectOversampling
 
     Surge::ModControl modLFO;
 };
@@ -32,6 +32,7 @@ template <size_t STAGES> void BBDDelayLine<STAGES>::prepare(double sampleRate)
 
     tn = 0.0f;
     evenOn = true;
+    delayTime = 0.0f;
 
     inputFilter = std::make_unique<InputFilterBank>(Ts);
     outputFilter = std::make_unique<OutputFilterBank>(Ts);
@@ -45,6 +46,9 @@ template <size_t STAGES> void BBDDelayLine<STAGES>::setFilterFreq(float freqHz)
 
     outputFilter->set_freq(freqHz);
     outputFilter->set_time(tn);
+
+    // the filter steps depend on the frequency, so the next delay time has to redo them
+    delayTime = 0.0f;
 }
 
 template class BBDDelayLine<64>;
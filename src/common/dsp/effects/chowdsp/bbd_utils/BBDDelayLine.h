@@ -40,6 +40,12 @@ template <size_t STAGES> class BBDDelayLine
 
     inline void setDelayTime(float delaySec) noexcept
     {
+        // the filter steps cost two complex exponentials, so don't redo them for the same time
+        if (delaySec == delayTime)
+            return;
+
+        delayTime = delaySec;
+
         const auto clock_rate_hz = (2.0f * (float)STAGES) / delaySec;
         Ts_bbd = 1.0f / clock_rate_hz;
 
@@ -48,6 +54,17 @@ template <size_t STAGES> class BBDDelayLine
         outputFilter->set_delta(doubleTs);
     }
 
+    // clock this line the same as another one with the same filter frequency, taking the
+    // filter steps from it rather than working them out again
+    inline void setDelayTime(const BBDDelayLine &other) noexcept
+    {
+        delayTime = other.delayTime;
+        Ts_bbd = other.Ts_bbd;
+
+        inputFilter->copy_delta(*other.inputFilter);
+        outputFilter->copy_delta(*other.outputFilter);
+    }
+
     inline float process(float u) noexcept
     {
         SSEComplex xOutAccum;
@@ -84,6 +101,7 @@ template <size_t STAGES> class BBDDelayLine
     float FS = 48000.0f;
     float Ts = 1.0f / FS;
     float Ts_bbd = Ts;
+    float delayTime = 0.0f; // 0 until the filter steps are worked out for the current frequency
 
     std::unique_ptr<InputFilterBank> inputFilter;
     std::unique_ptr<OutputFilterBank> outputFilter;
@@ -102,6 +102,7 @@ struct InputFilterBank
     }
 
     inline void set_delta(float delta) { Aplus = fast_complex_pow(pole_corr_angle, delta); }
+    inline void copy_delta(const InputFilterBank &other) { Aplus = other.Aplus; }
 
     inline void calcG() noexcept { Gcalc = Aplus * Gcalc; }
 
@@ -171,6 +172,7 @@ struct OutputFilterBank
     }
 
     inline void set_delta(float delta) { Aplus = fast_complex_pow(pole_corr_angle, -delta); }
+    inline void copy_delta(const OutputFilterBank &other) { Aplus = other.Aplus; }
 
     inline void calcG() noexcept { Gcalc = Aplus * Gcalc; }
 
@@ -37,7 +37,8 @@ namespace chowdsp
 ** filters for downsampling. Most of the oversampling parameters
 ** are set as template parameters:
 **
-** @param: OSFactor     sets the oversampling ratio as a power of two. i.e. Ratio = 2^OSFactor
+** @param: OSFactor     sets the largest oversampling ratio as a power of two. i.e.
+**                      Ratio = 2^OSFactor. A lower factor can be picked with setOSFactor
 ** @param: block_size   size of the blocks of audio before upsampling
 ** @param: FilterOrd    sets the order of the anti-imaging/anti-aliasing filters
 ** @param: steep        sets whether to use the filters in "steep" mode (see
@@ -54,6 +55,9 @@ namespace chowdsp
 **     os.downsample(dataL, dataR);
 ** }
 ** @endcode
+**
+** The filters for every stage up to OSFactor are made up front, so changing the factor
+** doesn't allocate, but take care to re-prepare anything which depends on the rate.
 */
 template <size_t OSFactor, size_t block_size, size_t FilterOrd = 3, bool steep = false>
 class Oversampling
@@ -61,10 +65,12 @@ class Oversampling
     std::unique_ptr<sst::filters::HalfRate::HalfRateFilter> hr_filts_up alignas(16)[OSFactor];
     std::unique_ptr<sst::filters::HalfRate::HalfRateFilter> hr_filts_down alignas(16)[OSFactor];
 
-    static constexpr size_t osRatio = 1 << OSFactor;
-    static constexpr size_t up_block_size = block_size * osRatio;
+    static constexpr size_t maxOSRatio = 1 << OSFactor;
+    static constexpr size_t max_up_block_size = block_size * maxOSRatio;
     static constexpr size_t block_size_quad = block_size / 4;
 
+    size_t activeOSFactor = OSFactor;
+
   public:
     Oversampling()
     {
@@ -86,17 +92,21 @@ class Oversampling
             hr_filts_down[i]->reset();
         }
 
-        std::fill(leftUp, &leftUp[up_block_size], 0.0f);
-        std::fill(rightUp, &rightUp[up_block_size], 0.0f);
+        std::fill(leftUp, &leftUp[max_up_block_size], 0.0f);
+        std::fill(rightUp, &rightUp[max_up_block_size], 0.0f);
     }
 
+    /** Sets the ratio used from here on to 2^factor, at most 2^OSFactor. Call reset after. */
+    void setOSFactor(size_t factor) noexcept { activeOSFactor = std::min(factor, OSFactor); }
+    inline size_t getOSFactor() const noexcept { return activeOSFactor; }
+
     /** Upsamples the audio in the input arrays, and stores the upsampled audio internally */
     inline void upsample(float *leftIn, float *rightIn) noexcept
     {
         sst::basic_blocks::mechanics::copy_from_to<block_size>(leftIn, leftUp);
         sst::basic_blocks::mechanics::copy_from_to<block_size>(rightIn, rightUp);
 
-        for (size_t i = 0; i < OSFactor; ++i)
+        for (size_t i = 0; i < activeOSFactor; ++i)
         {
             auto numSamples = block_size * (1 << (i + 1));
             hr_filts_up[i]->process_block_U2(leftUp, rightUp, leftUp, rightUp, numSamples);
@@ -107,7 +117,7 @@ class Oversampling
      * input arrays */
     inline void downsample(float *leftOut, float *rightOut) noexcept
     {
-        for (size_t i = OSFactor; i > 0; --i)
+        for (size_t i = activeOSFactor; i > 0; --i)
         {
             auto numSamples = block_size * (1 << i);
             hr_filts_down[i - 1]->process_block_D2(leftUp, rightUp, numSamples);
@@ -118,13 +128,16 @@ class Oversampling
     }
 
     /** Returns the size of the upsampled blocks */
-    static inline constexpr size_t getUpBlockSize() { return up_block_size; }
+    inline size_t getUpBlockSize() const noexcept { return block_size << activeOSFactor; }
+
+    /** Returns the size of the upsampled blocks at the largest ratio */
+    static inline constexpr size_t getMaxUpBlockSize() { return max_up_block_size; }
 
     /** Returns the oversampling ratio */
-    inline constexpr size_t getOSRatio() const noexcept { return osRatio; }
+    inline size_t getOSRatio() const noexcept { return (size_t)1 << activeOSFactor; }
 
-    float leftUp alignas(16)[up_block_size];
-    float rightUp alignas(16)[up_block_size];
+    float leftUp alignas(16)[max_up_block_size];
+    float rightUp alignas(16)[max_up_block_size];
 };
 
 } // namespace chowdsp
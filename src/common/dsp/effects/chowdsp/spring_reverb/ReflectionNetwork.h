@@ -23,46 +23,90 @@
 #ifndef SURGE_SRC_COMMON_DSP_EFFECTS_CHOWDSP_SPRING_REVERB_REFLECTIONNETWORK_H
 #define SURGE_SRC_COMMON_DSP_EFFECTS_CHOWDSP_SPRING_REVERB_REFLECTIONNETWORK_H
 
-#include <array>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "globals.h"
 #include "UnitConversions.h"
 #include <vembertech/portable_intrinsics.h>
 
-#include "../shared/chowdsp_DelayLine.h"
 #include "../shared/Shelf.h"
 
 namespace chowdsp
 {
+/*
+ * Four reflections per channel, mixed through a householder matrix. Every reflection of a
+ * channel is fed the same signal, so rather than four delay lines each channel keeps one
+ * buffer, sized for the longest reflection, which the four reflections read as taps and which
+ * is written once per sample. The taps are interpolated together, a lane each, like the
+ * Lagrange3rd DelayLine they replace.
+ */
 class ReflectionNetwork
 {
   public:
     ReflectionNetwork() = default;
 
-    void prepare(float sampleRate, int samplesPerBlock)
+    void prepare(float sampleRate, int /* samplesPerBlock */)
     {
         fs = sampleRate;
 
-        for (auto &d : delays)
-            d.prepare({sampleRate, (juce::uint32)samplesPerBlock, 2});
+        // the longest reflection at the largest size, and the four samples interpolated over
+        auto longest = (int)std::ceil(baseDelaysSec[3] * fs) + 4;
+        size = 4;
+        while (size < longest)
+            size <<= 1;
+        mask = size - 1;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            // the second half mirrors the first, so the taps never have to wrap
+            buffer[ch].assign(2 * (size_t)size, 0.f);
+            pos[ch] = 0;
+        }
 
         shelfFilter.reset();
     }
 
     void setParams(float reverbSize, float t60, float mix, float damping)
     {
-        constexpr float baseDelaysSec[4] = {0.07f, 0.17f, 0.23f, 0.29f};
-
         float feedbackArr alignas(16)[4];
+        float c1Arr alignas(16)[4], c2Arr alignas(16)[4], c3Arr alignas(16)[4],
+            c4Arr alignas(16)[4], fracArr alignas(16)[4];
         for (int i = 0; i < 4; ++i)
         {
             auto delaySamples = baseDelaysSec[i] * reverbSize * fs;
-            delays[i].setDelay(delaySamples);
             feedbackArr[i] = std::pow(0.001f, delaySamples / (t60 * fs));
             feedbackArr[i] *= 0.23f * mix * (0.735f + 0.235f * reverbSize);
+
+            // as DelayLineInterpolationTypes::Lagrange3rd does
+            delaySamples = std::clamp(delaySamples, 0.f, (float)(size - 4));
+            auto delayInt = (int)std::floor(delaySamples);
+            auto delayFrac = delaySamples - (float)delayInt;
+            if (delayInt >= 1)
+            {
+                delayFrac++;
+                delayInt--;
+            }
+
+            auto d1 = delayFrac - 1.0f;
+            auto d2 = delayFrac - 2.0f;
+            auto d3 = delayFrac - 3.0f;
+
+            taps[i] = delayInt;
+            c1Arr[i] = -d1 * d2 * d3 / 6.0f;
+            c2Arr[i] = d2 * d3 * 0.5f;
+            c3Arr[i] = -d1 * d3 * 0.5f;
+            c4Arr[i] = d1 * d2 / 6.0f;
+            fracArr[i] = delayFrac;
         }
 
         feedback = SIMD_MM(load_ps)(feedbackArr);
+        c1 = SIMD_MM(load_ps)(c1Arr);
+        c2 = SIMD_MM(load_ps)(c2Arr);
+        c3 = SIMD_MM(load_ps)(c3Arr);
+        c4 = SIMD_MM(load_ps)(c4Arr);
+        frac = SIMD_MM(load_ps)(fracArr);
 
         float dampDB = -1.0f - 9.0f * damping;
         shelfFilter.calcCoefs(1.0f, (float)dB_to_linear((double)dampDB), 800.0f, fs);
@@ -70,11 +114,16 @@ class ReflectionNetwork
 
     inline float popSample(int ch) noexcept
     {
-        float output alignas(16)[4];
-        for (int i = 0; i < 4; ++i)
-            output[i] = delays[i].popSample(ch);
+        // position pos + n holds the sample n old
+        const auto *b = buffer[ch].data() + pos[ch];
+        auto tap = [&](int n) {
+            return SIMD_MM(setr_ps)(b[taps[0] + n], b[taps[1] + n], b[taps[2] + n],
+                                    b[taps[3] + n]);
+        };
 
-        auto outVec = SIMD_MM(load_ps)(output);
+        auto outVec = vAdd(vMul(tap(0), c1),
+                           vMul(frac, vAdd(vAdd(vMul(tap(1), c2), vMul(tap(2), c3)),
+                                           vMul(tap(3), c4))));
 
         // householder matrix
         constexpr auto householderFactor = -2.0f / (float)4;
@@ -87,18 +136,21 @@ class ReflectionNetwork
 
     inline void pushSample(int ch, float x) noexcept
     {
-        for (auto &d : delays)
-            d.pushSample(ch, x);
+        buffer[ch][pos[ch]] = x;
+        buffer[ch][pos[ch] + size] = x;
+        pos[ch] = (pos[ch] + mask) & mask;
     }
 
   private:
+    static constexpr float baseDelaysSec[4] = {0.07f, 0.17f, 0.23f, 0.29f};
+
     float fs = 48000.0f;
 
-    using ReflectionDelay = DelayLine<float, chowdsp::DelayLineInterpolationTypes::Lagrange3rd>;
-    std::array<ReflectionDelay, 4> delays{ReflectionDelay{1 << 18}, ReflectionDelay{1 << 18},
-                                          ReflectionDelay{1 << 18}, ReflectionDelay{1 << 18}};
+    std::vector<float> buffer[2];
+    int size = 4, mask = 3, pos[2] = {0, 0};
+    int taps[4] = {0, 0, 0, 0};
 
-    SIMD_M128 feedback;
+    SIMD_M128 feedback, c1, c2, c3, c4, frac;
 
     chowdsp::ShelfFilter<> shelfFilter;
 };
@@ -22,7 +22,11 @@
 #ifndef SURGE_SRC_COMMON_DSP_EFFECTS_CHOWDSP_SPRING_REVERB_SCHROEDERALLPASS_H
 #define SURGE_SRC_COMMON_DSP_EFFECTS_CHOWDSP_SPRING_REVERB_SCHROEDERALLPASS_H
 
-#include "../shared/chowdsp_DelayLine.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <vembertech/portable_intrinsics.h>
 
 #ifdef __GNUC__ // GCC doesn't like "ignored-attributes"...
 #pragma GCC diagnostic push
@@ -32,70 +36,95 @@
 namespace chowdsp
 {
 
-template <typename T = float, int order = 1> class SchroederAllpass
+/*
+ * A chain of nested second order Schroeder allpasses which all share one delay and feedback,
+ * running four lanes at a time. Each stage has an outer and a nested Thiran interpolated delay,
+ * and as all of those are the same length they share one circular buffer and index. A row of
+ * the buffer holds one sample of every delay in the chain, so each sample reads two rows and
+ * writes one, where separate DelayLines would each have been touching their own 2^18 sample
+ * buffer.
+ */
+template <int stages> class SchroederAllpassCascade
 {
   public:
-    SchroederAllpass() = default;
+    SchroederAllpassCascade() = default;
 
-    void prepare(float sampleRate)
+    // maxDelaySamples is the longest delay setParams will be asked for
+    void prepare(int maxDelaySamples)
     {
-        delay.prepare({(double)sampleRate, 256, 1});
-        nestedAllpass.prepare(sampleRate);
+        size = 4;
+        while (size < maxDelaySamples + 2)
+            size <<= 1;
+        mask = size - 1;
+
+        buffer.resize((size_t)size * nDelays);
+        reset();
     }
 
     void reset()
     {
-        delay.reset();
-        nestedAllpass.reset();
+        std::fill(buffer.begin(), buffer.end(), SIMD_MM(setzero_ps)());
+        std::fill(state, state + nDelays, SIMD_MM(setzero_ps)());
+        pos = 0;
     }
 
-    void setParams(float delaySamp, T feedback)
+    void setParams(float delaySamp, SIMD_M128 feedback)
     {
-        delay.setDelay(delaySamp);
+        delaySamp = std::clamp(delaySamp, 0.f, (float)(size - 2));
+        delayInt = (int)std::floor(delaySamp);
+        auto delayFrac = delaySamp - (float)delayInt;
+
+        // as DelayLineInterpolationTypes::Thiran does
+        if (delayFrac < 0.618f && delayInt >= 1)
+        {
+            delayFrac++;
+            delayInt--;
+        }
+
+        alpha = SIMD_MM(set1_ps)((float)double((1 - delayFrac) / (1 + delayFrac)));
         g = feedback;
-        nestedAllpass.setParams(delaySamp, feedback);
     }
 
-    inline T processSample(T x) noexcept
+    inline SIMD_M128 processSample(SIMD_M128 x) noexcept
     {
-        auto delayOut = nestedAllpass.processSample(delay.popSample(0));
-        x += g * delayOut;
-        delay.pushSample(0, x);
-        return delayOut - g * x;
+        // row pos is written this sample, and row pos + n holds the samples n old
+        auto *w = &buffer[(size_t)pos * nDelays];
+        const auto *r1 = &buffer[(size_t)((pos + delayInt) & mask) * nDelays];
+        const auto *r2 = &buffer[(size_t)((pos + delayInt + 1) & mask) * nDelays];
+
+        auto thiran = [&](int d) {
+            auto out = vAdd(r2[d], vMul(alpha, vSub(r1[d], state[d])));
+            state[d] = out;
+            return out;
+        };
+
+        for (int s = 0; s < stages; ++s)
+        {
+            const int outer = 2 * s, nested = 2 * s + 1;
+
+            // the nested allpass, fed from the outer delay
+            auto nx = thiran(outer);
+            auto nestedOut = thiran(nested);
+            nx = vAdd(nx, vMul(g, nestedOut));
+            w[nested] = nx;
+            auto delayOut = vSub(nestedOut, vMul(g, nx));
+
+            x = vAdd(x, vMul(g, delayOut));
+            w[outer] = x;
+            x = vSub(delayOut, vMul(g, x));
+        }
+
+        pos = (pos + mask) & mask;
+        return x;
     }
 
   private:
-    DelayLine<T, DelayLineInterpolationTypes::Thiran> delay{1 << 18};
-    SchroederAllpass<T, order - 1> nestedAllpass;
-    T g;
-};
-
-template <typename T> class SchroederAllpass<T, 1>
-{
-  public:
-    SchroederAllpass() = default;
-
-    void prepare(float sampleRate) { delay.prepare({(double)sampleRate, 256, 1}); }
+    static constexpr int nDelays = 2 * stages;
 
-    void reset() { delay.reset(); }
-
-    void setParams(float delaySamp, T feedback)
-    {
-        delay.setDelay(delaySamp);
-        g = feedback;
-    }
-
-    inline T processSample(T x) noexcept
-    {
-        auto delayOut = delay.popSample(0);
-        x += g * delayOut;
-        delay.pushSample(0, x);
-        return delayOut - g * x;
-    }
-
-  private:
-    DelayLine<T, DelayLineInterpolationTypes::Thiran> delay{1 << 18};
-    T g;
+    std::vector<SIMD_M128> buffer;
+    SIMD_M128 state[nDelays];
+    int size = 4, mask = 3, pos = 0, delayInt = 0;
+    SIMD_M128 alpha = SIMD_MM(setzero_ps)(), g = SIMD_MM(setzero_ps)();
 };
 } // namespace chowdsp
 
@@ -49,8 +49,8 @@ void SpringReverbProc::prepare(float sampleRate, int samplesPerBlock)
     dcBlocker.prepare(sampleRate, 2);
     dcBlocker.setCutoffFrequency(40.0f);
 
-    for (auto &apf : vecAPFs)
-        apf.prepare(sampleRate);
+    // the allpass delay at the largest size, see setParams
+    vecAPFs.prepare((int)std::ceil((0.35f + 3.0f) / 1000.0f * fs) + 1);
 
     lpf.prepare(sampleRate, 2);
 
@@ -102,12 +102,8 @@ void SpringReverbProc::setParams(const Params &params, int numSamples)
     feedbackGain = std::pow(0.001f, delaySamples / (t60Seconds * fs));
 
     auto apfG = 0.5f - 0.4f * params.spin;
-    float apfGVec alignas(16)[4] = {apfG, -apfG, apfG, -apfG};
-    VecType apfGVecAsVecType = 0;
-    for (int i = 0; i < 4; ++i)
-        apfGVecAsVecType[i] = apfGVec[i];
-    for (auto &apf : vecAPFs)
-        apf.setParams(msToSamples(0.35f + 3.0f * params.size), apfGVecAsVecType);
+    vecAPFs.setParams(msToSamples(0.35f + 3.0f * params.size),
+                      SIMD_MM(setr_ps)(apfG, -apfG, apfG, -apfG));
 
     constexpr float dampFreqLow = 4000.0f;
     constexpr float dampFreqHigh = 18000.0f;
@@ -138,10 +134,9 @@ void SpringReverbProc::processBlock(float *left, float *right, const int numSamp
     };
 
     auto doAPFProcess = [&]() {
-        auto yVec = VecType::fromRawArray(simdState);
-        for (auto &apf : vecAPFs)
-            yVec = apf.processSample(yVec);
-        yVec.copyToRawArray(simdState);
+        auto yVec = SIMD_MM(load_ps)(simdState);
+        yVec = vecAPFs.processSample(yVec);
+        SIMD_MM(store_ps)(simdState, yVec);
     };
 
     auto doSpringOutput = [&](int ch) {
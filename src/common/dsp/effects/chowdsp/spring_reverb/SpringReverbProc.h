@@ -25,6 +25,7 @@
 
 #include <functional>
 
+#include "../shared/chowdsp_DelayLine.h"
 #include "../shared/SmoothedValue.h"
 #include "../shared/StateVariableFilter.h"
 
@@ -60,9 +61,7 @@ class SpringReverbProc
     StateVariableFilter<float> dcBlocker;
 
     static constexpr int allpassStages = 16;
-    using VecType = juce::dsp::SIMDRegister<float>;
-    using APFCascade = std::array<SchroederAllpass<VecType, 2>, allpassStages>;
-    APFCascade vecAPFs;
+    SchroederAllpassCascade<allpassStages> vecAPFs;
 
     std::function<float()> urng01; // A uniform 0,1 RNG
     SmoothedValue<float, ValueSmoothingTypes::Linear> chaosSmooth;
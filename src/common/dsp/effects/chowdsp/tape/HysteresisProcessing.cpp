@@ -30,6 +30,7 @@ void HysteresisProcessing::reset()
     M_n1 = SIMD_MM(set1_pd)(0.0);
     H_n1 = SIMD_MM(set1_pd)(0.0);
     H_d_n1 = SIMD_MM(set1_pd)(0.0);
+    diff_n1 = SIMD_MM(set1_pd)(0.0);
 
     hpState.coth = SIMD_MM(set1_pd)(0.0);
     hpState.nearZero = SIMD_MM(set1_pd)(0.0);
@@ -37,6 +38,7 @@ void HysteresisProcessing::reset()
     M_n1 = 0.0;
     H_n1 = 0.0;
     H_d_n1 = 0.0;
+    diff_n1 = 0.0;
 
     hpState.coth = 0.0;
     hpState.nearZero = false;
@@ -67,6 +69,9 @@ void HysteresisProcessing::cook(float drive, float width, float sat, bool v1)
         upperLim = 100000.0;
     }
 
+    // the adaptive solver's per sample error budget, in units of the saturation level
+    adaptiveTolerance = 1.0e-5 * hpState.M_s;
+
     hpState.nc = 1.0 - hpState.c;
     hpState.M_s_oa = hpState.M_s / hpState.a;
     hpState.M_s_oa_talpha = hpState.alpha * hpState.M_s_oa;
@@ -30,6 +30,7 @@ enum SolverType
     RK4,
     NR4,
     NR8,
+    ADAPTIVE,
     NUM_SOLVERS
 };
 
@@ -72,6 +73,9 @@ class HysteresisProcessing
         case NR8:
             M = NRSolver<8>(H, H_d);
             break;
+        case ADAPTIVE:
+            M = AdaptiveSolver(H, H_d);
+            break;
         default:
 #if CHOWTAPE_HYSTERESIS_USE_SIMD
             M = SIMD_MM(set1_pd)(0.0);
@@ -167,6 +171,13 @@ class HysteresisProcessing
 
     // newton-raphson solvers
     template <int nIterations, typename Float> inline Float NRSolver(Float H, Float H_d) noexcept
+    {
+        const auto last_dMdt = HysteresisOps::hysteresisFunc(M_n1, H_n1, H_d_n1, hpState);
+        return NRIterate<nIterations>(H, H_d, last_dMdt);
+    }
+
+    template <int nIterations, typename Float>
+    inline Float NRIterate(Float H, Float H_d, Float last_dMdt) noexcept
     {
 #if CHOWTAPE_HYSTERESIS_USE_SIMD
 #define F(a) SIMD_MM(set1_pd)(a)
@@ -175,7 +186,6 @@ class HysteresisProcessing
 #define A(a, b) SIMD_MM(add_pd)(a, b)
 #define S(a, b) SIMD_MM(sub_pd)(a, b)
         auto _M = M_n1;
-        const auto last_dMdt = HysteresisOps::hysteresisFunc(M_n1, H_n1, H_d_n1, hpState);
 
         SIMD_M128D dMdt, dMdtPrime, deltaNR, num, den;
         for (int n = 0; n < nIterations; ++n)
@@ -197,7 +207,6 @@ class HysteresisProcessing
 #undef S
 #else
         Float M = M_n1;
-        const Float last_dMdt = HysteresisOps::hysteresisFunc(M_n1, H_n1, H_d_n1, hpState);
 
         Float dMdt;
         Float dMdtPrime;
@@ -215,21 +224,103 @@ class HysteresisProcessing
 #endif
     }
 
+    /*
+     * Take an explicit midpoint (RK2) step, and use how far it lands from the Euler step it
+     * starts from as an estimate of its error. Most of the time the tape sits in the mild part
+     * of the curve where that is tiny, and the step stands. Where it isn't we go on to RK4,
+     * whose first two slopes are the ones we already have, so the same ODE is being solved
+     * either way and switching between them can't step the output. Only a sample the explicit
+     * steps blow up on falls back to Newton-Raphson, where the other solvers would output zero.
+     * With SIMD each channel decides for itself, though we only pay for the extra work when
+     * either needs it.
+     */
+    template <typename Float> inline Float AdaptiveSolver(Float H, Float H_d) noexcept
+    {
+#if CHOWTAPE_HYSTERESIS_USE_SIMD
+#define F(a) SIMD_MM(set1_pd)(a)
+#define M(a, b) SIMD_MM(mul_pd)(a, b)
+#define A(a, b) SIMD_MM(add_pd)(a, b)
+#define S(a, b) SIMD_MM(sub_pd)(a, b)
+#define BLEND(m, a, b) SIMD_MM(or_pd)(SIMD_MM(and_pd)(m, a), SIMD_MM(andnot_pd)(m, b))
+        const auto H_1_2 = M(A(H, H_n1), F(0.5));
+        const auto H_d_1_2 = M(A(H_d, H_d_n1), F(0.5));
+
+        const auto last_dMdt = HysteresisOps::hysteresisFunc(M_n1, H_n1, H_d_n1, hpState);
+        const auto k1 = M(last_dMdt, F(T));
+        const auto k2 =
+            M(HysteresisOps::hysteresisFunc(A(M_n1, M(k1, F(0.5))), H_1_2, H_d_1_2, hpState), F(T));
+        auto res = A(M_n1, k2);
+
+        // NaNs compare as not less or equal, so they escalate too
+        const auto diff = S(k2, k1);
+        const auto err = SIMD_MM(andnot_pd)(F(-0.0), S(diff, diff_n1));
+        diff_n1 = diff;
+        const auto escalate = SIMD_MM(cmpnle_pd)(err, F(adaptiveTolerance));
+        if (SIMD_MM(movemask_pd)(escalate) == 0)
+            return res;
+
+        const auto k3 =
+            M(HysteresisOps::hysteresisFunc(A(M_n1, M(k2, F(0.5))), H_1_2, H_d_1_2, hpState), F(T));
+        const auto k4 = M(HysteresisOps::hysteresisFunc(A(M_n1, k3), H, H_d, hpState), F(T));
+        const auto M_rk4 = A(M_n1, A(M(A(k1, k4), F(1.0 / 6.0)), M(A(k2, k3), F(1.0 / 3.0))));
+        res = BLEND(escalate, M_rk4, res);
+
+        const auto illCondition =
+            SIMD_MM(or_pd)(SIMD_MM(cmpunord_pd)(res, res), SIMD_MM(cmpgt_pd)(res, F(upperLim)));
+        if (SIMD_MM(movemask_pd)(illCondition) == 0)
+            return res;
+
+        return BLEND(illCondition, NRIterate<4>(H, H_d, last_dMdt), res);
+#undef F
+#undef M
+#undef A
+#undef S
+#undef BLEND
+#else
+        const Float H_1_2 = (H + H_n1) * 0.5;
+        const Float H_d_1_2 = (H_d + H_d_n1) * 0.5;
+
+        const Float last_dMdt = HysteresisOps::hysteresisFunc(M_n1, H_n1, H_d_n1, hpState);
+        const Float k1 = last_dMdt * T;
+        const Float k2 =
+            HysteresisOps::hysteresisFunc(M_n1 + (k1 * 0.5), H_1_2, H_d_1_2, hpState) * T;
+
+        const Float diff = k2 - k1;
+        const Float err = std::abs(diff - diff_n1);
+        diff_n1 = diff;
+        if (err <= adaptiveTolerance)
+            return M_n1 + k2;
+
+        const Float k3 =
+            HysteresisOps::hysteresisFunc(M_n1 + (k2 * 0.5), H_1_2, H_d_1_2, hpState) * T;
+        const Float k4 = HysteresisOps::hysteresisFunc(M_n1 + k3, H, H_d, hpState) * T;
+        const Float res = M_n1 + (k1 + k4) * (1.0 / 6.0) + (k2 + k3) * (1.0 / 3.0);
+
+        if (std::isnan(res) || res > upperLim)
+            return NRIterate<4>(H, H_d, last_dMdt);
+
+        return res;
+#endif
+    }
+
     // parameter values
     double fs = 48000.0;
     double T = 1.0 / fs;
     double Talpha = T / 1.9;
     double upperLim = 20.0;
+    double adaptiveTolerance = 1.0e-5;
 
     // state variables
 #if CHOWTAPE_HYSTERESIS_USE_SIMD
     SIMD_M128D M_n1;
     SIMD_M128D H_n1;
     SIMD_M128D H_d_n1;
+    SIMD_M128D diff_n1;
 #else
     double M_n1 = 0.0;
     double H_n1 = 0.0;
     double H_d_n1 = 0.0;
+    double diff_n1 = 0.0;
 #endif
 
     HysteresisOps::HysteresisState hpState;
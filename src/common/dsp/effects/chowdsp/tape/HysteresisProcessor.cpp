@@ -108,7 +108,7 @@ void HysteresisProcessor::process_block(float *dataL, float *dataR)
 
     // upsample
     os.upsample(dataL, dataR);
-    static constexpr int blockSizeUp = (int)Oversampling<2, BLOCK_SIZE>::getUpBlockSize();
+    static constexpr int blockSizeUp = (int)Oversampling<2, BLOCK_SIZE>::getMaxUpBlockSize();
 
     // convert from double to float
     double leftUp_d[blockSizeUp];
@@ -147,6 +147,12 @@ void HysteresisProcessor::process_block(float *dataL, float *dataR)
         else
             process_internal_simd<NR8>(dataInterleaved, blockSizeUp);
         break;
+    case ADAPTIVE:
+        if (needsSmoothing)
+            process_internal_smooth_simd<ADAPTIVE>(dataInterleaved, blockSizeUp);
+        else
+            process_internal_simd<ADAPTIVE>(dataInterleaved, blockSizeUp);
+        break;
     default:
         break;
     }
@@ -180,6 +186,12 @@ void HysteresisProcessor::process_block(float *dataL, float *dataR)
         else
             process_internal<NR8>(leftUp_d, rightUp_d, blockSizeUp);
         break;
+    case ADAPTIVE:
+        if (needsSmoothing)
+            process_internal_smooth<ADAPTIVE>(leftUp_d, rightUp_d, blockSizeUp);
+        else
+            process_internal<ADAPTIVE>(leftUp_d, rightUp_d, blockSizeUp);
+        break;
     default:
         break;
     }
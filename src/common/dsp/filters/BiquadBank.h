@@ -0,0 +1,385 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_FILTERS_BIQUADBANK_H
+#define SURGE_SRC_COMMON_DSP_FILTERS_BIQUADBANK_H
+
+#include "BiquadFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Normalised (a0 = 1) biquad coefficients, designed the way the BiquadFilter coeff_ calls
+ * design them, for the filters which don't run through a BiquadFilter of their own.
+ */
+struct BiquadCoefficients
+{
+    double a1{0}, a2{0}, b0{1}, b1{0}, b2{0};
+
+    static BiquadCoefficients normalised(double a0, double a1, double a2, double b0, double b1,
+                                         double b2)
+    {
+        double a0inv = 1 / a0;
+        return {a1 * a0inv, a2 * a0inv, b0 * a0inv, b1 * a0inv, b2 * a0inv};
+    }
+
+    // BiquadFilter::coeff_LP
+    static BiquadCoefficients lowpass(double omega, double Q)
+    {
+        if (omega > M_PI)
+            return {};
+
+        double cosi = cos(omega), sinu = sin(omega), alpha = sinu / (2 * Q);
+        return normalised(1 + alpha, -2 * cosi, 1 - alpha, (1 - cosi) * 0.5, 1 - cosi,
+                          (1 - cosi) * 0.5);
+    }
+
+    // BiquadFilter::coeff_HP
+    static BiquadCoefficients highpass(double omega, double Q)
+    {
+        if (omega > M_PI)
+            return {0, 0, 0, 0, 0};
+
+        double cosi = cos(omega), sinu = sin(omega), alpha = sinu / (2 * Q);
+        return normalised(1 + alpha, -2 * cosi, 1 - alpha, (1 + cosi) * 0.5, -(1 + cosi),
+                          (1 + cosi) * 0.5);
+    }
+
+    // BiquadFilter::coeff_orfanidisEQ, so coeff_peakEQ is peakEQ(omega, BW, G, sqrt(G), 1)
+    static BiquadCoefficients peakEQ(double omega, double BW, double G, double GB, double G0)
+    {
+        auto square = [](double x) { return x * x; };
+
+        double w0 = omega;
+        BW = std::max(0.0001, BW);
+        double Dww = 2 * w0 * sinh((log(2.0) / 2.0) * BW);
+
+        if (std::fabs(G - G0) <= 0.00001)
+            return {};
+
+        double F = std::fabs(G * G - GB * GB);
+        double G00 = std::fabs(G * G - G0 * G0);
+        double F00 = std::fabs(GB * GB - G0 * G0);
+        double num =
+            G0 * G0 * square(w0 * w0 - (M_PI * M_PI)) + G * G * F00 * (M_PI * M_PI) * Dww * Dww / F;
+        double den = square(w0 * w0 - M_PI * M_PI) + F00 * M_PI * M_PI * Dww * Dww / F;
+        double G1 = sqrt(num / den);
+
+        if (omega > M_PI)
+        {
+            G = G1 * 0.9999;
+            w0 = M_PI - 0.00001;
+            G00 = std::fabs(G * G - G0 * G0);
+            F00 = std::fabs(GB * GB - G0 * G0);
+        }
+
+        double G01 = std::fabs(G * G - G0 * G1);
+        double G11 = std::fabs(G * G - G1 * G1);
+        double F01 = std::fabs(GB * GB - G0 * G1);
+        double F11 = std::fabs(GB * GB - G1 * G1);
+        double W2 = sqrt(G11 / G00) * square(tan(w0 / 2));
+        double w_lower = w0 * powf(2, -0.5 * BW);
+        double w_upper =
+            2 * atan(sqrt(F00 / F11) * sqrt(G11 / G00) * square(tan(w0 / 2)) / tan(w_lower / 2));
+        double Dw = std::fabs(w_upper - w_lower);
+        double DW = (1 + sqrt(F00 / F11) * W2) * tan(Dw / 2);
+
+        double C = F11 * DW * DW - 2 * W2 * (F01 - sqrt(F00 * F11));
+        double D = 2 * W2 * (G01 - sqrt(G00 * G11));
+        double A = sqrt((C + D) / F);
+        double B = sqrt((G * G * C + GB * GB * D) / F);
+
+        return normalised(1 + W2 + A, -2 * (1 - W2), 1 + W2 - A, G1 + G0 * W2 + B,
+                          -2 * (G1 - G0 * W2), G1 - B + G0 * W2);
+    }
+
+    bool operator==(const BiquadCoefficients &o) const
+    {
+        return a1 == o.a1 && a2 == o.a2 && b0 == o.b0 && b1 == o.b1 && b2 == o.b2;
+    }
+};
+
+// The register a BiquadBank of floats or of doubles works in
+template <typename T> struct BiquadBankRegister;
+
+template <> struct BiquadBankRegister<float>
+{
+    typedef SIMD_M128 reg;
+    static constexpr int width = 4;
+
+    static reg load(const float *p) { return SIMD_MM(load_ps)(p); }
+    static void store(float *p, reg r) { SIMD_MM(store_ps)(p, r); }
+    static reg set1(float f) { return SIMD_MM(set1_ps)(f); }
+    static reg add(reg a, reg b) { return SIMD_MM(add_ps)(a, b); }
+    static reg sub(reg a, reg b) { return SIMD_MM(sub_ps)(a, b); }
+    static reg mul(reg a, reg b) { return SIMD_MM(mul_ps)(a, b); }
+    static reg nonZero(reg a) { return SIMD_MM(cmpneq_ps)(a, SIMD_MM(setzero_ps)()); }
+    // a where mask is set and b elsewhere
+    static reg select(reg mask, reg a, reg b)
+    {
+        return SIMD_MM(or_ps)(SIMD_MM(and_ps)(mask, a), SIMD_MM(andnot_ps)(mask, b));
+    }
+    static reg flushDenormals(reg a)
+    {
+        auto mag = SIMD_MM(andnot_ps)(SIMD_MM(set1_ps)(-0.f), a);
+        return SIMD_MM(and_ps)(a, SIMD_MM(cmpge_ps)(mag, SIMD_MM(set1_ps)(1e-30f)));
+    }
+};
+
+template <> struct BiquadBankRegister<double>
+{
+    typedef SIMD_M128D reg;
+    static constexpr int width = 2;
+
+    static reg load(const double *p) { return SIMD_MM(load_pd)(p); }
+    static void store(double *p, reg r) { SIMD_MM(store_pd)(p, r); }
+    static reg set1(double f) { return SIMD_MM(set1_pd)(f); }
+    static reg add(reg a, reg b) { return SIMD_MM(add_pd)(a, b); }
+    static reg sub(reg a, reg b) { return SIMD_MM(sub_pd)(a, b); }
+    static reg mul(reg a, reg b) { return SIMD_MM(mul_pd)(a, b); }
+    static reg nonZero(reg a) { return SIMD_MM(cmpneq_pd)(a, SIMD_MM(setzero_pd)()); }
+    static reg select(reg mask, reg a, reg b)
+    {
+        return SIMD_MM(or_pd)(SIMD_MM(and_pd)(mask, a), SIMD_MM(andnot_pd)(mask, b));
+    }
+    static reg flushDenormals(reg a)
+    {
+        auto mag = SIMD_MM(andnot_pd)(SIMD_MM(set1_pd)(-0.0), a);
+        return SIMD_MM(and_pd)(a, SIMD_MM(cmpge_pd)(mag, SIMD_MM(set1_pd)(1e-30)));
+    }
+};
+
+/*
+ * Lanes independent biquads, each with its own coefficients and registers, run side by side
+ * in float or double SIMD registers, so that the filters of several channels (both scenes'
+ * left and right, or mid and side) cost about what one of them used to. Lanes has to be a
+ * multiple of the register width, so 4, 8 or 16 lanes work for either precision.
+ *
+ * The bank works on a block of lane-interleaved frames, so a chain of banks interleaves its
+ * channels once at the start and once at the end rather than at every filter. Coefficients
+ * glide to a new setting with the BiquadFilter lag, stopping once every lane has arrived. As
+ * with a BiquadFilter, the first setting after a suspend takes effect at once, and a lane which
+ * isn't active keeps its registers and coefficients and passes its input through untouched.
+ */
+template <int Lanes, typename T = double> class BiquadBank
+{
+    typedef BiquadBankRegister<T> R;
+    static_assert(Lanes % R::width == 0, "A BiquadBank fills whole registers");
+    static constexpr int nregs = Lanes / R::width;
+
+  public:
+    static constexpr int lanes = Lanes;
+
+    explicit BiquadBank(SurgeStorage *storage) : omegas(storage)
+    {
+        for (int l = 0; l < Lanes; ++l)
+        {
+            for (int i = 0; i < ncoeffs; ++i)
+                coeff[i][l] = target[i][l] = (i == b0 ? 1 : 0);
+
+            setActive(l, true);
+            suspend(l);
+        }
+    }
+
+    double calc_omega(double scfreq) { return omegas.calc_omega(scfreq); }
+    double calc_omega_from_Hz(double Hz) { return omegas.calc_omega_from_Hz(Hz); }
+
+    void setCoefficients(int lane, const BiquadCoefficients &c)
+    {
+        const double n[ncoeffs] = {c.a1, c.a2, c.b0, c.b1, c.b2};
+
+        for (int i = 0; i < ncoeffs; ++i)
+        {
+            target[i][lane] = (T)n[i];
+            if (jump[lane])
+                coeff[i][lane] = target[i][lane];
+            settled = settled && coeff[i][lane] == target[i][lane];
+        }
+        jump[lane] = false;
+    }
+
+    void setActive(int lane, bool a) { active[lane] = a ? 1 : 0; }
+    bool isActive(int lane) const { return active[lane] != 0; }
+    bool anyActive() const
+    {
+        return std::any_of(active, active + Lanes, [](auto a) { return a != 0; });
+    }
+
+    // Clear the lane's registers and have its next setting take effect at once
+    void suspend(int lane)
+    {
+        reg0[lane] = 0;
+        reg1[lane] = 0;
+        jump[lane] = true;
+    }
+
+    void suspend()
+    {
+        for (int l = 0; l < Lanes; ++l)
+            suspend(l);
+    }
+
+    // Jump every lane straight to its target
+    void instantize()
+    {
+        for (int i = 0; i < ncoeffs; ++i)
+            std::copy(target[i], target[i] + Lanes, coeff[i]);
+        settled = true;
+    }
+
+    // frames holds BLOCK_SIZE frames of Lanes values each, and is filtered in place
+    void processFrames(T *frames)
+    {
+        if (!anyActive())
+            return;
+
+        if (settled)
+            run<false>(frames);
+        else
+            run<true>(frames);
+    }
+
+    static void interleave(const float *const *from, T *frames)
+    {
+        for (int k = 0; k < BLOCK_SIZE; ++k)
+            for (int l = 0; l < Lanes; ++l)
+                frames[k * Lanes + l] = from[l][k];
+    }
+
+    static void deinterleave(const T *frames, float *const *to)
+    {
+        for (int k = 0; k < BLOCK_SIZE; ++k)
+            for (int l = 0; l < Lanes; ++l)
+                to[l][k] = frames[k * Lanes + l];
+    }
+
+  private:
+    enum
+    {
+        a1,
+        a2,
+        b0,
+        b1,
+        b2,
+        ncoeffs
+    };
+
+    template <bool glide> void run(T *frames)
+    {
+        typedef typename R::reg reg;
+        constexpr int W = R::width;
+
+        // the BiquadFilter lag
+        const reg lp = R::set1((T)0.004), lpinv = R::set1((T)(1.0 - 0.004));
+
+        reg on[nregs], r0[nregs], r1[nregs], c[ncoeffs][nregs], t[ncoeffs][nregs];
+
+        for (int r = 0; r < nregs; ++r)
+        {
+            on[r] = R::nonZero(R::load(active + r * W));
+            r0[r] = R::load(reg0 + r * W);
+            r1[r] = R::load(reg1 + r * W);
+
+            for (int i = 0; i < ncoeffs; ++i)
+            {
+                c[i][r] = R::load(coeff[i] + r * W);
+                t[i][r] = R::load(target[i] + r * W);
+            }
+        }
+
+        for (int k = 0; k < BLOCK_SIZE; ++k)
+        {
+            auto *f = frames + k * Lanes;
+
+            for (int r = 0; r < nregs; ++r)
+            {
+                if constexpr (glide)
+                {
+                    for (int i = 0; i < ncoeffs; ++i)
+                    {
+                        auto g = R::add(R::mul(c[i][r], lpinv), R::mul(t[i][r], lp));
+                        c[i][r] = R::select(on[r], g, c[i][r]);
+                    }
+                }
+
+                auto in = R::load(f + r * W);
+                auto op = R::add(R::mul(in, c[b0][r]), r0[r]);
+                auto n0 = R::add(R::sub(R::mul(in, c[b1][r]), R::mul(c[a1][r], op)), r1[r]);
+                auto n1 = R::sub(R::mul(in, c[b2][r]), R::mul(c[a2][r], op));
+
+                r0[r] = R::select(on[r], n0, r0[r]);
+                r1[r] = R::select(on[r], n1, r1[r]);
+                R::store(f + r * W, R::select(on[r], op, in));
+            }
+        }
+
+        // flush denormals, as BiquadFilter does at the end of each block
+        for (int r = 0; r < nregs; ++r)
+        {
+            R::store(reg0 + r * W, R::flushDenormals(r0[r]));
+            R::store(reg1 + r * W, R::flushDenormals(r1[r]));
+        }
+
+        if constexpr (glide)
+        {
+            for (int r = 0; r < nregs; ++r)
+                for (int i = 0; i < ncoeffs; ++i)
+                    R::store(coeff[i] + r * W, c[i][r]);
+
+            settled = true;
+            for (int l = 0; l < Lanes; ++l)
+            {
+                T dist = 0;
+                for (int i = 0; i < ncoeffs; ++i)
+                    dist = std::max(dist, (T)std::fabs(coeff[i][l] - target[i][l]));
+
+                if (dist < settledDistance)
+                {
+                    for (int i = 0; i < ncoeffs; ++i)
+                        coeff[i][l] = target[i][l];
+                }
+                else
+                {
+                    settled = false;
+                }
+            }
+        }
+    }
+
+    /*
+     * close enough that the rest of the glide can't be heard. A float lag stalls a few ulps
+     * short of its target, so that has to be let go of sooner.
+     */
+    static constexpr T settledDistance{sizeof(T) == sizeof(float) ? (T)1e-4 : (T)1e-9};
+
+    T reg0 alignas(16)[Lanes], reg1 alignas(16)[Lanes];
+    T coeff alignas(16)[ncoeffs][Lanes], target alignas(16)[ncoeffs][Lanes];
+    T active alignas(16)[Lanes];
+    bool jump[Lanes];
+    bool settled{true};
+    BiquadFilter omegas; // just for its omega calculations
+};
+
+#endif // SURGE_SRC_COMMON_DSP_FILTERS_BIQUADBANK_H
@@ -0,0 +1,209 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_FILTERS_STEREOBIQUADCASCADE_H
+#define SURGE_SRC_COMMON_DSP_FILTERS_STEREOBIQUADCASCADE_H
+
+#include "BiquadBank.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * A chain of N stereo biquads, which the EQs run in place of N separate BiquadFilters. Each
+ * band keeps left and right in the two lanes of one double register, and its coefficients glide
+ * to a new setting the same way the BiquadFilter lags do. Unlike those lags though, a band
+ * stops gliding once it has arrived, a band whose settings didn't change isn't redesigned, and
+ * a band which has arrived at 0 dB (exactly the identity) drops out of the cascade altogether.
+ */
+template <int N> class StereoBiquadCascade
+{
+  public:
+    explicit StereoBiquadCascade(SurgeStorage *storage) : storage(storage), omegas(storage)
+    {
+        reset();
+    }
+
+    double calc_omega(double scfreq) { return omegas.calc_omega(scfreq); }
+    double calc_omega_from_Hz(double Hz) { return omegas.calc_omega_from_Hz(Hz); }
+
+    // Same arguments and response as BiquadFilter::coeff_peakEQ
+    void setPeakEQ(int n, double omega, double BW, double gain)
+    {
+        auto &b = bands[n];
+        if (!b.jump && omega == b.omega && BW == b.BW && gain == b.gain)
+            return;
+
+        b.omega = omega;
+        b.BW = BW;
+        b.gain = gain;
+
+        auto c = BiquadCoefficients::peakEQ(omega, BW, storage->db_to_linear(gain),
+                                            storage->db_to_linear(gain * 0.5), 1);
+        b.target[a1] = c.a1;
+        b.target[a2] = c.a2;
+        b.target[b0] = c.b0;
+        b.target[b1] = c.b1;
+        b.target[b2] = c.b2;
+
+        if (b.jump)
+        {
+            std::copy(b.target, b.target + ncoeffs, b.coeff);
+            b.jump = false;
+        }
+        b.settled = std::equal(b.target, b.target + ncoeffs, b.coeff);
+        b.identity = b.target[a1] == 0 && b.target[a2] == 0 && b.target[b0] == 1 &&
+                     b.target[b1] == 0 && b.target[b2] == 0;
+    }
+
+    // Inactive bands are passed over and keep their state, like a BiquadFilter we don't run
+    void setActive(int n, bool active) { bands[n].active = active; }
+
+    // Jump every band straight to its target
+    void instantize()
+    {
+        for (auto &b : bands)
+        {
+            std::copy(b.target, b.target + ncoeffs, b.coeff);
+            b.settled = true;
+        }
+    }
+
+    // Clear the registers, and have the next setting of each band take effect at once
+    void reset()
+    {
+        for (auto &b : bands)
+        {
+            b.reg0 = SIMD_MM(setzero_pd)();
+            b.reg1 = SIMD_MM(setzero_pd)();
+            b.jump = true;
+        }
+    }
+
+    void processBlock(float *dataL, float *dataR)
+    {
+        for (auto &b : bands)
+        {
+            if (!b.active)
+                continue;
+
+            if (b.settled && b.identity)
+            {
+                // an identity band's registers are zero after two samples anyway
+                b.reg0 = SIMD_MM(setzero_pd)();
+                b.reg1 = SIMD_MM(setzero_pd)();
+                continue;
+            }
+
+            if (b.settled)
+                processBand<false>(b, dataL, dataR);
+            else
+                processBand<true>(b, dataL, dataR);
+        }
+    }
+
+  private:
+    enum
+    {
+        a1,
+        a2,
+        b0,
+        b1,
+        b2,
+        ncoeffs
+    };
+
+    struct Band
+    {
+        SIMD_M128D reg0, reg1;
+        double coeff[ncoeffs]{0, 0, 1, 0, 0}, target[ncoeffs]{0, 0, 1, 0, 0};
+        double omega{-1}, BW{-1}, gain{-1};
+        bool jump{true}, settled{true}, identity{true}, active{true};
+    };
+
+    template <bool glide> static void processBand(Band &b, float *dataL, float *dataR)
+    {
+        // the BiquadFilter lag
+        static constexpr double lp = 0.004, lpinv = 1.0 - 0.004;
+
+        auto r0 = b.reg0, r1 = b.reg1;
+        auto ca1 = SIMD_MM(set1_pd)(b.coeff[a1]), ca2 = SIMD_MM(set1_pd)(b.coeff[a2]);
+        auto cb0 = SIMD_MM(set1_pd)(b.coeff[b0]), cb1 = SIMD_MM(set1_pd)(b.coeff[b1]);
+        auto cb2 = SIMD_MM(set1_pd)(b.coeff[b2]);
+
+        for (int k = 0; k < BLOCK_SIZE; ++k)
+        {
+            if constexpr (glide)
+            {
+                for (int i = 0; i < ncoeffs; ++i)
+                    b.coeff[i] = b.coeff[i] * lpinv + b.target[i] * lp;
+
+                ca1 = SIMD_MM(set1_pd)(b.coeff[a1]);
+                ca2 = SIMD_MM(set1_pd)(b.coeff[a2]);
+                cb0 = SIMD_MM(set1_pd)(b.coeff[b0]);
+                cb1 = SIMD_MM(set1_pd)(b.coeff[b1]);
+                cb2 = SIMD_MM(set1_pd)(b.coeff[b2]);
+            }
+
+            auto in = SIMD_MM(setr_pd)(dataL[k], dataR[k]);
+            auto op = SIMD_MM(add_pd)(SIMD_MM(mul_pd)(in, cb0), r0);
+            r0 = SIMD_MM(add_pd)(
+                SIMD_MM(sub_pd)(SIMD_MM(mul_pd)(in, cb1), SIMD_MM(mul_pd)(ca1, op)), r1);
+            r1 = SIMD_MM(sub_pd)(SIMD_MM(mul_pd)(in, cb2), SIMD_MM(mul_pd)(ca2, op));
+
+            double out alignas(16)[2];
+            SIMD_MM(store_pd)(out, op);
+            dataL[k] = out[0];
+            dataR[k] = out[1];
+        }
+
+        // flush denormals, as BiquadFilter does at the end of each block
+        auto tiny = SIMD_MM(set1_pd)(1e-30);
+        auto sign = SIMD_MM(set1_pd)(-0.0);
+        r0 = SIMD_MM(and_pd)(r0, SIMD_MM(cmpge_pd)(SIMD_MM(andnot_pd)(sign, r0), tiny));
+        r1 = SIMD_MM(and_pd)(r1, SIMD_MM(cmpge_pd)(SIMD_MM(andnot_pd)(sign, r1), tiny));
+        b.reg0 = r0;
+        b.reg1 = r1;
+
+        if constexpr (glide)
+        {
+            double dist = 0;
+            for (int i = 0; i < ncoeffs; ++i)
+                dist = std::max(dist, std::fabs(b.coeff[i] - b.target[i]));
+
+            if (dist < settledDistance)
+            {
+                std::copy(b.target, b.target + ncoeffs, b.coeff);
+                b.settled = true;
+            }
+        }
+    }
+
+    // close enough that the rest of the glide can't be heard
+    static constexpr double settledDistance{1e-9};
+
+    Band bands[N];
+    SurgeStorage *storage;
+    BiquadFilter omegas; // just for its omega calculations
+};
+
+#endif // SURGE_SRC_COMMON_DSP_FILTERS_STEREOBIQUADCASCADE_H
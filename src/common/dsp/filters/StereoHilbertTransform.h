@@ -0,0 +1,133 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_FILTERS_STEREOHILBERTTRANSFORM_H
+#define SURGE_SRC_COMMON_DSP_FILTERS_STEREOHILBERTTRANSFORM_H
+
+#include "globals.h"
+
+/*
+ * Turns a stereo signal into a pair of analytic signals with one polyphase allpass pair per
+ * channel. The pair is the steep 12th order halfband of sst::filters::HalfRateFilter moved up
+ * by a quarter of the sample rate, which negates the z^-2 terms of each section
+ *
+ *     y[n] = a * (x[n] + y[n-2]) - x[n-2]
+ *
+ * and leaves the two branches 90 degrees apart over the same passband (104 dB image rejection,
+ * 0.01 transition band at either end). Both channels and both branches share a register as
+ * [L re, L im, R re, R im], so the whole transform is one pass of six 4-lane sections, where the
+ * halfband Weaver shifter needed two HalfRateFilters and a second pair of oscillators.
+ *
+ * re and im come out at unity gain, so shifting by w is just re * cos(w n) - im * sin(w n).
+ */
+class alignas(16) StereoHilbertTransform
+{
+  public:
+    static constexpr int stages = 6;
+
+    StereoHilbertTransform()
+    {
+        static constexpr float re[stages] = {0.036681502163648017f, 0.2746317593794541f,
+                                             0.56109896978791948f,  0.769741833862266f,
+                                             0.8922608180038789f,   0.962094548378084f};
+        static constexpr float im[stages] = {0.13654762463195771f, 0.42313861743656667f,
+                                             0.6775400499741616f,  0.839889624849638f,
+                                             0.9315419599631839f,  0.9878163707328971f};
+
+        for (int j = 0; j < stages; j++)
+        {
+            coeff[j] = SIMD_MM(setr_ps)(re[j], im[j], re[j], im[j]);
+        }
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (int j = 0; j < stages; j++)
+        {
+            x1[j] = SIMD_MM(setzero_ps)();
+            x2[j] = SIMD_MM(setzero_ps)();
+            y1[j] = SIMD_MM(setzero_ps)();
+            y2[j] = SIMD_MM(setzero_ps)();
+        }
+
+        lastL = 0.f;
+        lastR = 0.f;
+    }
+
+    // nsamples may be at most BLOCK_SIZE
+    void process_block(const float *L, const float *R, float *Lre, float *Lim, float *Rre,
+                       float *Rim, int nsamples)
+    {
+        SIMD_M128 o[BLOCK_SIZE];
+
+        // the imaginary branch runs one sample behind
+        for (int k = 0; k < nsamples; k++)
+        {
+            o[k] = SIMD_MM(setr_ps)(L[k], lastL, R[k], lastR);
+            lastL = L[k];
+            lastR = R[k];
+        }
+
+        for (int j = 0; j < stages; j++)
+        {
+            auto a = coeff[j];
+            auto tx1 = x1[j], tx2 = x2[j], ty1 = y1[j], ty2 = y2[j];
+
+            for (int k = 0; k < nsamples; k++)
+            {
+                auto x = o[k];
+                auto y = SIMD_MM(sub_ps)(SIMD_MM(mul_ps)(a, SIMD_MM(add_ps)(x, ty2)), tx2);
+
+                tx2 = tx1;
+                tx1 = x;
+                ty2 = ty1;
+                ty1 = y;
+                o[k] = y;
+            }
+
+            x1[j] = tx1;
+            x2[j] = tx2;
+            y1[j] = ty1;
+            y2[j] = ty2;
+        }
+
+        for (int k = 0; k < nsamples; k++)
+        {
+            float v alignas(16)[4];
+            SIMD_MM(store_ps)(v, o[k]);
+
+            Lre[k] = v[0];
+            Lim[k] = v[1];
+            Rre[k] = v[2];
+            Rim[k] = v[3];
+        }
+    }
+
+  private:
+    SIMD_M128 coeff[stages], x1[stages], x2[stages], y1[stages], y2[stages];
+    float lastL, lastR;
+};
+
+#endif // SURGE_SRC_COMMON_DSP_FILTERS_STEREOHILBERTTRANSFORM_H
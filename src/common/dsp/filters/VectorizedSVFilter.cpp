@@ -76,6 +76,24 @@ void VectorizedSVFilter::CopyCoeff(const VectorizedSVFilter &SVF)
 
 //------------------------------------------------------------------------------------------------
 
+void VectorizedSVFilter::ClearState()
+{
+    L1 = vZero;
+    L2 = vZero;
+    B1 = vZero;
+    B2 = vZero;
+}
+
+//------------------------------------------------------------------------------------------------
+
+bool VectorizedSVFilter::IsQuiet(float threshold) const
+{
+    vFloat m = vMax(vMax(vMul(L1, L1), vMul(B1, B1)), vMax(vMul(L2, L2), vMul(B2, B2)));
+    return SIMD_MM(movemask_ps)(vCmpGE(m, vLoad1(threshold * threshold))) == 0;
+}
+
+//------------------------------------------------------------------------------------------------
+
 float VectorizedSVFilter::CalcF(float Omega) { return 2.0 * sin(M_PI * Omega); }
 
 //------------------------------------------------------------------------------------------------
@@ -38,6 +38,12 @@ class VectorizedSVFilter
 
     void CopyCoeff(const VectorizedSVFilter &SVF);
 
+    // Zero the filter registers but keep the coefficients
+    void ClearState();
+
+    // True when every register in every lane is below threshold in magnitude
+    bool IsQuiet(float threshold) const;
+
     inline vFloat CalcBPF(vFloat In)
     {
         L1 = vMAdd(F1, B1, L1);
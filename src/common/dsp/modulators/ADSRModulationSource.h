@@ -29,6 +29,8 @@
 #include "ModulationSource.h"
 #include "DebugHelpers.h"
 
+#include <limits>
+
 enum ADSRState
 {
     s_attack = 0,
@@ -150,6 +152,22 @@ class ADSRModulationSource : public ModulationSource
 
     bool is_idle() { return (envstate == s_idle) && (idlecount > 0); }
 
+    /*
+     * For a digital envelope with no attack or sustain, at current settings, the most blocks
+     * it can be open for: its whole decay then its whole release. -1 for any other envelope.
+     */
+    int oneShotBlocks() const
+    {
+        if (lc[mode].b || (lc[a].f - adsr->a.val_min.f) >= 0.01 || lc[s].f > 0.f ||
+            adsr->d.temposync || adsr->r.temposync)
+            return -1;
+
+        auto blocksFor = [this](float t) {
+            return (int)std::ceil(1.f / std::max(storage->envelope_rate_linear_nowrap(t), 1e-9f));
+        };
+        return blocksFor(lc[d].f) + blocksFor(lc[r].f) + 2;
+    }
+
     bool correctAnalogMode{false};
 
     virtual void process_block() override
@@ -214,25 +232,18 @@ class ADSRModulationSource : public ModulationSource
                 SIMD_MM(min_ss)(SIMD_MM(setzero_ps)(), SIMD_MM(sub_ss)(v_release, v_c1));
 
             // calculate coefficients for envelope
-            const float shortest = 6.f;
-            const float longest = -2.f;
-            const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
-
-            float coef_A =
-                powf(2.f, std::min(0.f, coeff_offset - lc[a].f * (adsr->a.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
-            float coef_D =
-                powf(2.f, std::min(0.f, coeff_offset - lc[d].f * (adsr->d.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
+            const float coeff_offset = analogCoeffOffset();
+
+            float coef_A = analogCoeff(
+                coefA, coeff_offset - lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f));
+            float coef_D = analogCoeff(
+                coefD, coeff_offset - lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f));
             float coef_R =
                 envstate == s_uberrelease
                     ? 6.f
-                    : powf(2.f,
-                           std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
+                    : analogCoeff(coefR, coeff_offset - lc[r].f * (adsr->r.temposync
                                                                        ? storage->temposyncratio
-                                                                       : 1.f)));
+                                                                       : 1.f));
 
             v_c1 = SIMD_MM(add_ss)(v_c1, SIMD_MM(mul_ss)(diff_v_a, SIMD_MM(load_ss)(&coef_A)));
             v_c1 = SIMD_MM(add_ss)(v_c1, SIMD_MM(mul_ss)(diff_v_d, SIMD_MM(load_ss)(&coef_D)));
@@ -409,20 +420,18 @@ class ADSRModulationSource : public ModulationSource
 
     void doCorrectAnalogMode()
     {
-        const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
-
-        float coef_A = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f)));
-        float coef_D = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f)));
+        const float coeff_offset = analogCoeffOffset();
+
+        float coef_A = analogCoeff(
+            coefA, coeff_offset - lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f));
+        float coef_D = analogCoeff(
+            coefD, coeff_offset - lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f));
         float coef_R =
             envstate == s_uberrelease
                 ? 6.f
-                : powf(2.f, std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
-                                                                        ? storage->temposyncratio
-                                                                        : 1.f)));
+                : analogCoeff(coefR, coeff_offset - lc[r].f * (adsr->r.temposync
+                                                                   ? storage->temposyncratio
+                                                                   : 1.f));
 
         const float v_cc = 1.01f;
         auto gate = (envstate == s_attack) || (envstate == s_decay);
@@ -462,6 +471,44 @@ class ADSRModulationSource : public ModulationSource
     int getEnvState() { return envstate; }
 
   private:
+    /*
+     * The analog mode coefficients are 2^min(0, x) of the stage times, which only move
+     * when the envelope is modulated or the sample rate changes, so rather than a log and
+     * three powf per voice per block we keep the last of each and only redo the ones which
+     * changed.
+     */
+    struct AnalogCoeff
+    {
+        float x{std::numeric_limits<float>::quiet_NaN()};
+        float coeff{0.f};
+    };
+
+    float analogCoeffOffset()
+    {
+        if (storage->samplerate != coeffOffsetSampleRate)
+        {
+            coeffOffsetSampleRate = storage->samplerate;
+            coeffOffset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
+        }
+
+        return coeffOffset;
+    }
+
+    static float analogCoeff(AnalogCoeff &c, float x)
+    {
+        if (x != c.x)
+        {
+            c.x = x;
+            c.coeff = powf(2.f, std::min(0.f, x));
+        }
+
+        return c.coeff;
+    }
+
+    AnalogCoeff coefA, coefD, coefR;
+    float coeffOffsetSampleRate{0.f};
+    float coeffOffset{0.f};
+
     ADSRStorage *adsr = nullptr;
     SurgeVoiceState *state = nullptr;
     SurgeStorage *storage = nullptr;
@@ -0,0 +1,862 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "FormulaExpression.h"
+#include "FormulaModulationHelper.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace Surge
+{
+namespace Formula
+{
+namespace
+{
+enum Field
+{
+    f_phase,
+    f_intphase,
+    f_voice_count,
+    f_delay,
+    f_attack,
+    f_hold,
+    f_decay,
+    f_sustain,
+    f_release,
+    f_rate,
+    f_startphase,
+    f_amplitude,
+    f_deform,
+    f_tempo,
+    f_songpos,
+    f_pb,
+    f_pb_range_up,
+    f_pb_range_dn,
+    f_chan_at,
+    f_cc_mw,
+    f_cc_breath,
+    f_cc_expr,
+    f_cc_sus,
+    f_lowest_key,
+    f_highest_key,
+    f_latest_key,
+    f_poly_limit,
+    f_scene_mode,
+    f_play_mode,
+    f_split_point,
+
+    // these are only set in voices
+    f_key,
+    f_velocity,
+    f_rel_velocity,
+    f_channel,
+    f_poly_at,
+    f_mpe_bend,
+    f_mpe_bendrange,
+    f_mpe_timbre,
+    f_mpe_pressure,
+    f_voice_id,
+};
+
+struct FieldName
+{
+    const char *name;
+    Field field;
+} fieldNames[] = {
+    {"phase", f_phase},
+    {"intphase", f_intphase},
+    {"cycle", f_intphase},
+    {"voice_count", f_voice_count},
+    {"delay", f_delay},
+    {"attack", f_attack},
+    {"hold", f_hold},
+    {"decay", f_decay},
+    {"sustain", f_sustain},
+    {"release", f_release},
+    {"rate", f_rate},
+    {"startphase", f_startphase},
+    {"amplitude", f_amplitude},
+    {"deform", f_deform},
+    {"tempo", f_tempo},
+    {"songpos", f_songpos},
+    {"pb", f_pb},
+    {"pb_range_up", f_pb_range_up},
+    {"pb_range_dn", f_pb_range_dn},
+    {"chan_at", f_chan_at},
+    {"cc_mw", f_cc_mw},
+    {"cc_breath", f_cc_breath},
+    {"cc_expr", f_cc_expr},
+    {"cc_sus", f_cc_sus},
+    {"lowest_key", f_lowest_key},
+    {"highest_key", f_highest_key},
+    {"latest_key", f_latest_key},
+    {"poly_limit", f_poly_limit},
+    {"scene_mode", f_scene_mode},
+    {"play_mode", f_play_mode},
+    {"split_point", f_split_point},
+    {"key", f_key},
+    {"velocity", f_velocity},
+    {"rel_velocity", f_rel_velocity},
+    {"channel", f_channel},
+    {"poly_at", f_poly_at},
+    {"mpe_bend", f_mpe_bend},
+    {"mpe_bendrange", f_mpe_bendrange},
+    {"mpe_timbre", f_mpe_timbre},
+    {"mpe_pressure", f_mpe_pressure},
+    {"voice_id", f_voice_id},
+};
+
+enum Function
+{
+    fn_sin,
+    fn_cos,
+    fn_tan,
+    fn_asin,
+    fn_acos,
+    fn_atan,
+    fn_atan2,
+    fn_sinh,
+    fn_cosh,
+    fn_tanh,
+    fn_abs,
+    fn_floor,
+    fn_ceil,
+    fn_sqrt,
+    fn_exp,
+    fn_log,
+    fn_log10,
+    fn_fmod,
+    fn_pow,
+    fn_deg,
+    fn_rad,
+    fn_min,
+    fn_max,
+};
+
+struct FunctionName
+{
+    const char *name;
+    Function fn;
+    int nargs; // -1 for one or more
+} functionNames[] = {
+    {"sin", fn_sin, 1},     {"cos", fn_cos, 1},     {"tan", fn_tan, 1},
+    {"asin", fn_asin, 1},   {"acos", fn_acos, 1},   {"atan", fn_atan, 1},
+    {"atan2", fn_atan2, 2}, {"sinh", fn_sinh, 1},   {"cosh", fn_cosh, 1},
+    {"tanh", fn_tanh, 1},   {"abs", fn_abs, 1},     {"floor", fn_floor, 1},
+    {"ceil", fn_ceil, 1},   {"sqrt", fn_sqrt, 1},   {"exp", fn_exp, 1},
+    {"log", fn_log, 1},     {"log10", fn_log10, 1}, {"fmod", fn_fmod, 2},
+    {"pow", fn_pow, 2},     {"deg", fn_deg, 1},     {"rad", fn_rad, 1},
+    {"min", fn_min, -1},    {"max", fn_max, -1},
+};
+
+// Lua's % is floored, unlike fmod
+inline double luaMod(double a, double b) { return a - std::floor(a / b) * b; }
+} // namespace
+
+/*
+ * A recursive descent parser over just enough of Lua's grammar, which emits code as it goes
+ * and gives up (returns false) at the first thing it doesn't understand.
+ */
+struct ArithmeticFormulaCompiler
+{
+    enum TokenType
+    {
+        t_end,
+        t_name,
+        t_number,
+        t_symbol,
+    };
+
+    struct Token
+    {
+        TokenType type{t_end};
+        std::string text;
+        double number{0};
+    };
+
+    std::vector<Token> tokens;
+    size_t pos{0};
+
+    ArithmeticFormula &result;
+    std::vector<std::string> locals;
+    std::string param;
+    int depth{0}, maxDepth{0};
+    bool assignsOutput{false};
+
+    explicit ArithmeticFormulaCompiler(ArithmeticFormula &r) : result(r) {}
+
+    bool tokenize(const std::string &src)
+    {
+        size_t i = 0, n = src.size();
+
+        while (i < n)
+        {
+            auto c = src[i];
+
+            if (std::isspace((unsigned char)c) || c == ';')
+            {
+                i++;
+                continue;
+            }
+
+            if (src.compare(i, 2, "--") == 0)
+            {
+                if (src.compare(i, 4, "--[[") == 0)
+                {
+                    auto e = src.find("]]", i + 4);
+                    if (e == std::string::npos)
+                        return false;
+                    i = e + 2;
+                }
+                else if (src.compare(i, 3, "--[") == 0 && i + 3 < n &&
+                         (src[i + 3] == '=' || src[i + 3] == '['))
+                {
+                    // long comments with a level; rare enough not to bother
+                    return false;
+                }
+                else
+                {
+                    while (i < n && src[i] != '\n')
+                        i++;
+                }
+                continue;
+            }
+
+            Token t;
+
+            if (std::isalpha((unsigned char)c) || c == '_')
+            {
+                auto s = i;
+                while (i < n && (std::isalnum((unsigned char)src[i]) || src[i] == '_'))
+                    i++;
+                t.type = t_name;
+                t.text = src.substr(s, i - s);
+            }
+            else if (std::isdigit((unsigned char)c) ||
+                     (c == '.' && i + 1 < n && std::isdigit((unsigned char)src[i + 1])))
+            {
+                if (src.compare(i, 2, "0x") == 0 || src.compare(i, 2, "0X") == 0)
+                    return false;
+
+                char *e = nullptr;
+                t.type = t_number;
+                t.number = std::strtod(src.c_str() + i, &e);
+                i = e - src.c_str();
+
+                // a name running straight on from a number isn't Lua we know
+                if (i < n && (std::isalpha((unsigned char)src[i]) || src[i] == '_'))
+                    return false;
+            }
+            else if (std::strchr("+-*/%^(),.=", c))
+            {
+                // reject == and .. rather than misreading them
+                if (i + 1 < n && ((c == '=' && src[i + 1] == '=') || (c == '.' && src[i + 1] == '.')))
+                    return false;
+
+                t.type = t_symbol;
+                t.text = std::string(1, c);
+                i++;
+            }
+            else
+            {
+                return false;
+            }
+
+            tokens.push_back(std::move(t));
+        }
+
+        tokens.push_back(Token());
+        return true;
+    }
+
+    const Token &peek(size_t ahead = 0) const { return tokens[std::min(pos + ahead, tokens.size() - 1)]; }
+    bool isName(const char *s, size_t ahead = 0) const
+    {
+        return peek(ahead).type == t_name && peek(ahead).text == s;
+    }
+    bool isSymbol(char c, size_t ahead = 0) const
+    {
+        return peek(ahead).type == t_symbol && peek(ahead).text[0] == c;
+    }
+    bool expectName(const char *s)
+    {
+        if (!isName(s))
+            return false;
+        pos++;
+        return true;
+    }
+    bool expectSymbol(char c)
+    {
+        if (!isSymbol(c))
+            return false;
+        pos++;
+        return true;
+    }
+
+    static bool isKeyword(const std::string &s)
+    {
+        static const char *keywords[] = {"and",   "break", "do",     "else", "elseif", "end",
+                                         "false", "for",   "function", "goto", "if",   "in",
+                                         "local", "nil",   "not",    "or",   "repeat", "return",
+                                         "then",  "true",  "until",  "while"};
+        for (auto k : keywords)
+            if (s == k)
+                return true;
+        return false;
+    }
+
+    void emit(ArithmeticFormula::Op op, int index = 0, int nargs = 0, double value = 0)
+    {
+        result.code.push_back({op, index, nargs, value});
+    }
+
+    bool push()
+    {
+        depth++;
+        maxDepth = std::max(maxDepth, depth);
+        return depth <= ArithmeticFormula::maxStack;
+    }
+
+    int localIndex(const std::string &name) const
+    {
+        // the latest declaration shadows any earlier one
+        for (int i = (int)locals.size() - 1; i >= 0; --i)
+            if (locals[i] == name)
+                return i;
+        return -1;
+    }
+
+    bool primary()
+    {
+        auto &t = peek();
+
+        if (t.type == t_number)
+        {
+            emit(ArithmeticFormula::pushConst, 0, 0, t.number);
+            pos++;
+            return push();
+        }
+
+        if (expectSymbol('('))
+        {
+            return expression() && expectSymbol(')');
+        }
+
+        if (t.type != t_name)
+            return false;
+
+        if (t.text == param)
+        {
+            pos++;
+            if (!expectSymbol('.') || peek().type != t_name)
+                return false;
+
+            auto &fn = peek().text;
+            for (auto &f : fieldNames)
+            {
+                if (fn == f.name)
+                {
+                    pos++;
+                    result.usesVoiceFields = result.usesVoiceFields || f.field >= f_key;
+                    emit(ArithmeticFormula::pushField, f.field);
+                    return push();
+                }
+            }
+            return false;
+        }
+
+        if (t.text == "math" && localIndex("math") < 0)
+        {
+            pos++;
+            if (!expectSymbol('.') || peek().type != t_name)
+                return false;
+
+            auto name = peek().text;
+            pos++;
+
+            if (name == "pi" || name == "huge")
+            {
+                emit(ArithmeticFormula::pushConst, 0, 0, name == "pi" ? M_PI : HUGE_VAL);
+                return push();
+            }
+
+            for (auto &f : functionNames)
+            {
+                if (name == f.name)
+                {
+                    if (!expectSymbol('('))
+                        return false;
+
+                    int nargs = 0;
+                    if (!isSymbol(')'))
+                    {
+                        do
+                        {
+                            if (!expression())
+                                return false;
+                            nargs++;
+                        } while (expectSymbol(','));
+                    }
+
+                    if (!expectSymbol(')'))
+                        return false;
+                    if (f.nargs >= 0 ? nargs != f.nargs : nargs < 1)
+                        return false;
+
+                    emit(ArithmeticFormula::call, f.fn, nargs);
+                    depth -= nargs - 1;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        auto li = localIndex(t.text);
+        if (li < 0)
+            return false;
+
+        pos++;
+        emit(ArithmeticFormula::pushLocal, li);
+        return push();
+    }
+
+    // Lua's ^ is right associative and binds tighter than a unary minus on its left
+    bool power()
+    {
+        if (!primary())
+            return false;
+
+        if (expectSymbol('^'))
+        {
+            if (!unary())
+                return false;
+            emit(ArithmeticFormula::pow);
+            depth--;
+        }
+        return true;
+    }
+
+    bool unary()
+    {
+        if (expectSymbol('-'))
+        {
+            if (!unary())
+                return false;
+            emit(ArithmeticFormula::neg);
+            return true;
+        }
+        return power();
+    }
+
+    bool multiplicative()
+    {
+        if (!unary())
+            return false;
+
+        while (isSymbol('*') || isSymbol('/') || isSymbol('%'))
+        {
+            auto c = peek().text[0];
+            pos++;
+            if (!unary())
+                return false;
+            emit(c == '*' ? ArithmeticFormula::mul
+                          : (c == '/' ? ArithmeticFormula::div : ArithmeticFormula::mod));
+            depth--;
+        }
+        return true;
+    }
+
+    bool expression()
+    {
+        if (!multiplicative())
+            return false;
+
+        while (isSymbol('+') || isSymbol('-'))
+        {
+            auto c = peek().text[0];
+            pos++;
+            if (!multiplicative())
+                return false;
+            emit(c == '+' ? ArithmeticFormula::add : ArithmeticFormula::sub);
+            depth--;
+        }
+        return true;
+    }
+
+    bool assignedExpression()
+    {
+        return expectSymbol('=') && expression() && (depth--, true);
+    }
+
+    bool defineFunction(std::string &name, std::string &arg)
+    {
+        if (!expectName("function") || peek().type != t_name)
+            return false;
+        name = peek().text;
+        pos++;
+
+        if (!expectSymbol('(') || peek().type != t_name)
+            return false;
+        arg = peek().text;
+        pos++;
+
+        return expectSymbol(')') && !isKeyword(arg);
+    }
+
+    bool initBody(const std::string &arg)
+    {
+        // init must hand back its state untouched
+        return expectName("return") && expectName(arg.c_str()) && expectName("end");
+    }
+
+    bool processBody()
+    {
+        while (!isName("return"))
+        {
+            if (expectName("local"))
+            {
+                if (peek().type != t_name || isKeyword(peek().text))
+                    return false;
+
+                auto name = peek().text;
+                pos++;
+
+                if (name == param)
+                    return false;
+
+                // the name isn't in scope in its own initialiser
+                if (!assignedExpression() || (int)locals.size() >= ArithmeticFormula::maxLocals)
+                    return false;
+
+                locals.push_back(name);
+                emit(ArithmeticFormula::storeLocal, (int)locals.size() - 1);
+            }
+            else if (isName(param.c_str()) && isSymbol('.', 1) && isName("output", 2))
+            {
+                pos += 3;
+                if (!assignedExpression())
+                    return false;
+                emit(ArithmeticFormula::storeOutput);
+                assignsOutput = true;
+            }
+            else if (peek().type == t_name && localIndex(peek().text) >= 0)
+            {
+                auto li = localIndex(peek().text);
+                pos++;
+                if (!assignedExpression())
+                    return false;
+                emit(ArithmeticFormula::storeLocal, li);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return expectName("return") && expectName(param.c_str()) && expectName("end");
+    }
+
+    bool compile(const std::string &src)
+    {
+        if (!tokenize(src))
+            return false;
+
+        bool haveProcess = false, haveInit = false;
+
+        while (peek().type != t_end)
+        {
+            std::string name, arg;
+            if (!defineFunction(name, arg))
+                return false;
+
+            if (name == "init" && !haveInit)
+            {
+                haveInit = true;
+                if (!initBody(arg))
+                    return false;
+            }
+            else if (name == "process" && !haveProcess)
+            {
+                haveProcess = true;
+                param = arg;
+                if (!processBody())
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return haveProcess && assignsOutput && maxDepth <= ArithmeticFormula::maxStack;
+    }
+};
+
+std::unique_ptr<ArithmeticFormula> ArithmeticFormula::compile(const std::string &formula)
+{
+    auto res = std::make_unique<ArithmeticFormula>();
+    ArithmeticFormulaCompiler c(*res);
+
+    if (!c.compile(formula))
+        return nullptr;
+
+    return res;
+}
+
+double ArithmeticFormula::evaluate(int phaseIntPart, float phaseFracPart, int voiceCount,
+                                   const EvaluatorState &s) const
+{
+    double stack[maxStack], locals[maxLocals];
+    double output = 0;
+    int sp = 0;
+
+    // the Lua path pushes all of these as floats, so we round them the same way
+    auto field = [&](int f) -> double {
+        switch ((Field)f)
+        {
+        case f_phase:
+            return phaseFracPart;
+        case f_intphase:
+            return phaseIntPart;
+        case f_voice_count:
+            return voiceCount;
+        case f_delay:
+            return s.del;
+        case f_attack:
+            return s.a;
+        case f_hold:
+            return s.h;
+        case f_decay:
+            return s.dec;
+        case f_sustain:
+            return s.s;
+        case f_release:
+            return s.r;
+        case f_rate:
+            return s.rate;
+        case f_startphase:
+            return s.phase;
+        case f_amplitude:
+            return s.amp;
+        case f_deform:
+            return s.deform;
+        case f_tempo:
+            return s.tempo;
+        case f_songpos:
+            return s.songpos;
+        case f_pb:
+            return s.pitchbend;
+        case f_pb_range_up:
+            return s.pbrange_up;
+        case f_pb_range_dn:
+            return s.pbrange_dn;
+        case f_chan_at:
+            return s.aftertouch;
+        case f_cc_mw:
+            return s.modwheel;
+        case f_cc_breath:
+            return s.breath;
+        case f_cc_expr:
+            return s.expression;
+        case f_cc_sus:
+            return s.sustain;
+        case f_lowest_key:
+            return s.lowest_key;
+        case f_highest_key:
+            return s.highest_key;
+        case f_latest_key:
+            return s.latest_key;
+        case f_poly_limit:
+            return s.polylimit;
+        case f_scene_mode:
+            return s.scenemode;
+        case f_play_mode:
+            return s.polymode;
+        case f_split_point:
+            return s.splitpoint;
+        case f_key:
+            return s.key;
+        case f_velocity:
+            return s.velocity;
+        case f_rel_velocity:
+            return s.releasevelocity;
+        case f_channel:
+            return s.channel;
+        case f_poly_at:
+            return s.polyat;
+        case f_mpe_bend:
+            return s.mpebend;
+        case f_mpe_bendrange:
+            return (float)s.mpebendrange;
+        case f_mpe_timbre:
+            return s.mpetimbre;
+        case f_mpe_pressure:
+            return s.mpepressure;
+        case f_voice_id:
+            return (float)s.voiceOrderAtCreate;
+        }
+        return 0;
+    };
+
+    for (const auto &in : code)
+    {
+        switch (in.op)
+        {
+        case pushConst:
+            stack[sp++] = in.value;
+            break;
+        case pushField:
+            stack[sp++] = field(in.index);
+            break;
+        case pushLocal:
+            stack[sp++] = locals[in.index];
+            break;
+        case storeLocal:
+            locals[in.index] = stack[--sp];
+            break;
+        case storeOutput:
+            output = stack[--sp];
+            break;
+        case add:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] + stack[sp];
+            break;
+        case sub:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] - stack[sp];
+            break;
+        case mul:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] * stack[sp];
+            break;
+        case div:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] / stack[sp];
+            break;
+        case mod:
+            sp--;
+            stack[sp - 1] = luaMod(stack[sp - 1], stack[sp]);
+            break;
+        case pow:
+            sp--;
+            stack[sp - 1] = std::pow(stack[sp - 1], stack[sp]);
+            break;
+        case neg:
+            stack[sp - 1] = -stack[sp - 1];
+            break;
+        case call:
+        {
+            auto *a = &stack[sp - in.nargs];
+            double r = 0;
+
+            switch ((Function)in.index)
+            {
+            case fn_sin:
+                r = std::sin(a[0]);
+                break;
+            case fn_cos:
+                r = std::cos(a[0]);
+                break;
+            case fn_tan:
+                r = std::tan(a[0]);
+                break;
+            case fn_asin:
+                r = std::asin(a[0]);
+                break;
+            case fn_acos:
+                r = std::acos(a[0]);
+                break;
+            case fn_atan:
+                r = std::atan(a[0]);
+                break;
+            case fn_atan2:
+                r = std::atan2(a[0], a[1]);
+                break;
+            case fn_sinh:
+                r = std::sinh(a[0]);
+                break;
+            case fn_cosh:
+                r = std::cosh(a[0]);
+                break;
+            case fn_tanh:
+                r = std::tanh(a[0]);
+                break;
+            case fn_abs:
+                r = std::fabs(a[0]);
+                break;
+            case fn_floor:
+                r = std::floor(a[0]);
+                break;
+            case fn_ceil:
+                r = std::ceil(a[0]);
+                break;
+            case fn_sqrt:
+                r = std::sqrt(a[0]);
+                break;
+            case fn_exp:
+                r = std::exp(a[0]);
+                break;
+            case fn_log:
+                r = std::log(a[0]);
+                break;
+            case fn_log10:
+                r = std::log10(a[0]);
+                break;
+            case fn_fmod:
+                r = std::fmod(a[0], a[1]);
+                break;
+            case fn_pow:
+                r = std::pow(a[0], a[1]);
+                break;
+            case fn_deg:
+                r = a[0] * (180.0 / M_PI);
+                break;
+            case fn_rad:
+                r = a[0] * (M_PI / 180.0);
+                break;
+            case fn_min:
+                r = a[0];
+                for (int i = 1; i < in.nargs; ++i)
+                    r = a[i] < r ? a[i] : r;
+                break;
+            case fn_max:
+                r = a[0];
+                for (int i = 1; i < in.nargs; ++i)
+                    r = a[i] > r ? a[i] : r;
+                break;
+            }
+
+            sp -= in.nargs;
+            stack[sp++] = r;
+            break;
+        }
+        }
+    }
+
+    return output;
+}
+} // namespace Formula
+} // namespace Surge
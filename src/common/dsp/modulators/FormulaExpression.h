@@ -0,0 +1,95 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSION_H
+#define SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSION_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Formula
+{
+struct EvaluatorState;
+
+/*
+ * Most formulas people write are a line or two of arithmetic on the phase and a few
+ * state fields, and for those the cost of a block is almost all in marshalling the state
+ * table in and out of Lua. So when a formula is a trivial init() and a process() which
+ * only assigns locals and state.output from arithmetic, numbers, state fields and the
+ * math library, we compile it to a small stack program and evaluate that natively.
+ *
+ * The program computes in double, as Lua does, so it gives the same result as the Lua
+ * path. Anything outside the subset (conditionals, loops, other state fields, globals,
+ * strings, multiple outputs, subscriptions...) fails to compile and stays on Lua.
+ */
+struct ArithmeticFormula
+{
+    // nullptr if the formula isn't in the subset we handle
+    static std::unique_ptr<ArithmeticFormula> compile(const std::string &formula);
+
+    double evaluate(int phaseIntPart, float phaseFracPart, int voiceCount,
+                    const EvaluatorState &s) const;
+
+    // key, velocity and so on are nil outside a voice, which the Lua path reports as an error
+    bool usesVoiceFields{false};
+
+    enum Op : uint8_t
+    {
+        pushConst,
+        pushField,
+        pushLocal,
+        storeLocal,
+        storeOutput,
+        add,
+        sub,
+        mul,
+        div,
+        mod,
+        pow,
+        neg,
+        call,
+    };
+
+    struct Instruction
+    {
+        Op op;
+        int index{0}; // field, local or function; for call, also the argument count in nargs
+        int nargs{0};
+        double value{0};
+    };
+
+    static constexpr int maxStack = 32, maxLocals = 32;
+
+  private:
+    friend struct ArithmeticFormulaCompiler;
+
+    std::vector<Instruction> code;
+};
+} // namespace Formula
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_MODULATORS_FORMULAEXPRESSION_H
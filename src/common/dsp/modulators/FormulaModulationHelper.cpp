@@ -26,6 +26,7 @@
 #include "SurgeStorage.h"
 #include <thread>
 #include <functional>
+#include <chrono>
 #include "fmt/core.h"
 #include "lua/LuaSources.h"
 
@@ -34,13 +35,246 @@ namespace Surge
 namespace Formula
 {
 
-void setupStorage(SurgeStorage *s) { s->formulaGlobalData = std::make_unique<GlobalData>(); }
+/*
+ * These state fields are the same for every voice in a scene, so rather than setting each of
+ * them through the C API on every voice's state, we write them to one shared table when they
+ * change and copy them across on the Lua side just before process() runs.
+ */
+static constexpr const char *sceneInputsTableName{"surge_reserved_formula_scene_inputs"};
+static constexpr const char *copySceneInputsName{"surge_reserved_formula_copy_scene_inputs"};
+static constexpr const char *processWithSceneInputsName{
+    "surge_reserved_formula_process_with_scene_inputs"};
+
+static constexpr const char *sceneInputNames[] = {
+    "voice_count", "tempo",       "songpos",     "pb",          "pb_range_up",
+    "pb_range_dn", "chan_at",     "cc_mw",       "cc_breath",   "cc_expr",
+    "cc_sus",      "lowest_key",  "highest_key", "latest_key",  "poly_limit",
+    "scene_mode",  "play_mode",   "split_point"};
+static constexpr int nSceneInputs = sizeof(sceneInputNames) / sizeof(sceneInputNames[0]);
+
+static void gatherSceneInputs(const EvaluatorState &s, int voiceCount, float *into)
+{
+    int i = 0;
+    for (auto v : {(float)voiceCount, s.tempo, s.songpos, s.pitchbend, s.pbrange_up, s.pbrange_dn,
+                   s.aftertouch, s.modwheel, s.breath, s.expression, s.sustain, s.lowest_key,
+                   s.highest_key, s.latest_key, (float)s.polylimit, (float)s.scenemode,
+                   (float)s.polymode, (float)s.splitpoint})
+    {
+        into[i++] = v;
+    }
+}
+
+#if HAS_LUA
+static void defineSceneInputFunctions(lua_State *L)
+{
+    std::ostringstream oss;
+    oss << "local keys = {";
+    for (auto n : sceneInputNames)
+        oss << " \"" << n << "\",";
+    oss << R"FN( }
+
+function )FN" << copySceneInputsName << R"FN((state, inputs)
+    for i = 1, #keys do
+        local k = keys[i]
+        state[k] = inputs[k]
+    end
+    return state
+end
+
+function )FN" << processWithSceneInputsName << R"FN((process, state, inputs)
+    return process()FN" << copySceneInputsName << R"FN((state, inputs))
+end
+)FN";
+
+    std::string emsg;
+    auto res = Surge::LuaSupport::parseStringDefiningMultipleFunctions(
+        L, oss.str(), {copySceneInputsName, processWithSceneInputsName}, emsg);
+    lua_pop(L, 2);
+    if (res != 2)
+        std::cout << "Unable to define formula scene input functions: " << emsg << std::endl;
+}
+
+/*
+ * Everything a lua state needs before it can run any formula. This is a full library open and
+ * a prelude compile, so we do it for the audio state when the storage is set up rather than on
+ * the audio thread the first time a formula shows up.
+ */
+static void initialiseState(lua_State *L)
+{
+    auto lg = Surge::LuaSupport::SGLD("initialiseState", L);
+
+    luaL_openlibs(L);
+
+    // Setup shared table
+    lua_newtable(L);
+    lua_setglobal(L, sharedTableName);
+
+    lua_newtable(L);
+    lua_setglobal(L, sceneInputsTableName);
+    defineSceneInputFunctions(L);
+
+    // Load the Formula prelude
+    Surge::LuaSupport::loadSurgePrelude(L, Surge::LuaSources::formula_prelude);
+
+    auto reserved0 = std::string(R"FN(
+function surge_reserved_formula_error_stub(m)
+    return 0;
+end
+)FN");
+    std::string emsg;
+    bool r0 = Surge::LuaSupport::parseStringDefiningFunction(
+        L, reserved0, "surge_reserved_formula_error_stub", emsg);
+    if (r0)
+    {
+        lua_setglobal(L, "surge_reserved_formula_error_stub");
+    }
+}
+
+/*
+ * The count hook which stops a formula once it has used up its instruction budget. A
+ * counting BudgetGuard installs it for the length of one call and removes it after, so code
+ * outside those calls runs without the per instruction hook.
+ *
+ * LuaJIT never calls hooks from compiled code, so anything we want to be able to stop has to
+ * run interpreted. New formulas are on probation: their functions run with the JIT off, and
+ * only get it turned on once they have made it through probationCalls calls in budget.
+ */
+static thread_local bool budgetArmed{false}, budgetTripped{false};
+
+static void budgetHook(lua_State *L, lua_Debug *)
+{
+    if (!budgetArmed)
+        return;
+
+    budgetArmed = false;
+    budgetTripped = true;
+    luaL_error(L, "it ran for more than %d instructions", GlobalData::instructionBudget);
+}
+
+struct BudgetGuard
+{
+    BudgetGuard(lua_State *L, bool counted)
+        : L(L), counted(counted), start(std::chrono::steady_clock::now())
+    {
+        if (counted)
+            lua_sethook(L, budgetHook, LUA_MASKCOUNT, GlobalData::instructionBudget);
+        budgetArmed = counted;
+        budgetTripped = false;
+    }
+    ~BudgetGuard()
+    {
+        budgetArmed = false;
+        if (counted)
+            lua_sethook(L, nullptr, 0, 0);
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    lua_State *L;
+    bool counted;
+    std::chrono::steady_clock::time_point start;
+};
+
+static void setJITFor(lua_State *L, const char *funcName, bool on)
+{
+    lua_getglobal(L, "jit");
+    if (lua_istable(L, -1))
+    {
+        lua_getfield(L, -1, on ? "on" : "off");
+        lua_getglobal(L, funcName);
+        lua_pushboolean(L, true); // and for the functions it defines
+        if (lua_pcall(L, 2, 0, 0) != LUA_OK)
+            lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+}
+
+static int appendToString(lua_State *, const void *p, size_t sz, void *ud)
+{
+    static_cast<std::string *>(ud)->append(static_cast<const char *>(p), sz);
+    return 0;
+}
+
+static void updateSceneInputs(GlobalData &stateData, const EvaluatorState &s, int voiceCount)
+{
+    auto &last = s.L == (lua_State *)stateData.audioState ? stateData.audioSceneInputs
+                                                          : stateData.displaySceneInputs;
+    float now[nSceneInputs];
+    gatherSceneInputs(s, voiceCount, now);
+
+    if (last.size() == nSceneInputs && memcmp(last.data(), now, sizeof(now)) == 0)
+        return;
+
+    lua_getglobal(s.L, sceneInputsTableName);
+    for (int i = 0; i < nSceneInputs; ++i)
+    {
+        lua_pushnumber(s.L, now[i]);
+        lua_setfield(s.L, -2, sceneInputNames[i]);
+    }
+    lua_pop(s.L, 1);
+
+    last.assign(now, now + nSceneInputs);
+}
+#endif
+
+void setupStorage(SurgeStorage *s)
+{
+    s->formulaGlobalData = std::make_unique<GlobalData>();
+#if HAS_LUA
+    auto L = lua_open();
+    initialiseState(L);
+    lua_gc(L, LUA_GCSTOP, 0);
+    s->formulaGlobalData->audioState = L;
+    s->formulaGlobalData->audioHeapKB = lua_gc(L, LUA_GCCOUNT, 0);
+#endif
+}
+
+void precompileFormula(SurgeStorage *storage, FormulaModulatorStorage *fs)
+{
+#if HAS_LUA
+    if (!storage || !storage->formulaGlobalData || fs->interpreter != FormulaModulatorStorage::LUA)
+        return;
+
+    auto &stateData = *storage->formulaGlobalData;
+    {
+        std::lock_guard<std::mutex> g(stateData.bytecodeMutex);
+        auto it = stateData.bytecode.find(fs->formulaHash);
+        if (it != stateData.bytecode.end() && it->second.source == fs->formulaString)
+            return;
+    }
+
+    // Compile in a scratch state, so nothing here ever touches the one the audio thread runs
+    auto L = lua_open();
+    std::string code;
+    const char *src = fs->formulaString.c_str();
+    if (luaL_loadbuffer(L, src, fs->formulaString.size(), "lua-script") == LUA_OK)
+        lua_dump(L, appendToString, &code);
+    lua_close(L);
+
+    // leave things which don't compile to the audio thread, which reports the error as usual
+    if (code.empty())
+        return;
+
+    std::lock_guard<std::mutex> g(stateData.bytecodeMutex);
+    if (stateData.bytecode.size() >= GlobalData::maxBytecodeEntries)
+        stateData.bytecode.clear();
+    auto &e = stateData.bytecode[fs->formulaHash];
+    e.source = fs->formulaString;
+    e.code = std::move(code);
+#endif
+}
 
 bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
                           bool is_display)
 {
     auto &stateData = *storage->formulaGlobalData;
     bool firstTimeThrough = false;
+    s.overBudget = false;
+    s.slowCalls = 0;
+    s.probationCallsLeft = 0;
     if (!is_display)
     {
         static int aid = 1;
@@ -48,7 +282,6 @@ bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, Ev
         {
 #if HAS_LUA
             stateData.audioState = lua_open();
-            luaL_openlibs((lua_State *)(stateData.audioState));
 #endif
             firstTimeThrough = true;
         }
@@ -65,7 +298,6 @@ bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, Ev
         {
 #if HAS_LUA
             stateData.displayState = lua_open();
-            luaL_openlibs((lua_State *)(stateData.displayState));
 #endif
             firstTimeThrough = true;
         }
@@ -82,25 +314,7 @@ bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, Ev
 
     if (firstTimeThrough)
     {
-        // Setup shared table
-        lua_newtable(s.L);
-        lua_setglobal(s.L, sharedTableName);
-
-        // Load the Formula prelude
-        Surge::LuaSupport::loadSurgePrelude(s.L, Surge::LuaSources::formula_prelude);
-
-        auto reserved0 = std::string(R"FN(
-function surge_reserved_formula_error_stub(m)
-    return 0;
-end
-)FN");
-        std::string emsg;
-        bool r0 = Surge::LuaSupport::parseStringDefiningFunction(
-            s.L, reserved0, "surge_reserved_formula_error_stub", emsg);
-        if (r0)
-        {
-            lua_setglobal(s.L, "surge_reserved_formula_error_stub");
-        }
+        initialiseState(s.L);
     }
 
     // OK so now evaluate the formula. This is a mistake - the loading and
@@ -142,12 +356,35 @@ end
         {
             s.isvalid = false;
         }
+
+        if (stateData.functionsOnProbation.find(s.funcName) !=
+            stateData.functionsOnProbation.end())
+        {
+            s.probationCallsLeft = GlobalData::probationCalls;
+        }
     }
     else
     {
+        /*
+         * If the patch loader already compiled this formula we only have to load its bytecode.
+         * Never wait for the lock on the audio thread though; compiling the source is no worse
+         * than what we always used to do.
+         */
+        std::string bytecode;
+        if (!is_display)
+        {
+            std::unique_lock<std::mutex> lk(stateData.bytecodeMutex, std::try_to_lock);
+            if (lk.owns_lock())
+            {
+                auto bc = stateData.bytecode.find(h);
+                if (bc != stateData.bytecode.end() && bc->second.source == fs->formulaString)
+                    bytecode = bc->second.code;
+            }
+        }
+
         std::string emsg;
         int res = Surge::LuaSupport::parseStringDefiningMultipleFunctions(
-            s.L, fs->formulaString, {"process", "init"}, emsg);
+            s.L, bytecode.empty() ? fs->formulaString : bytecode, {"process", "init"}, emsg);
 
         if (res >= 1)
         {
@@ -173,6 +410,12 @@ end
             stateData.functionsPerFMS[fs].insert(s.funcName);
             stateData.functionsPerFMS[fs].insert(s.funcNameInit);
 
+            // init runs once per voice, so it can always run where the budget can stop it
+            setJITFor(s.L, s.funcName, false);
+            setJITFor(s.L, s.funcNameInit, false);
+            stateData.functionsOnProbation.insert(s.funcName);
+            s.probationCallsLeft = GlobalData::probationCalls;
+
             s.isvalid = true;
         }
         else
@@ -244,7 +487,11 @@ end
             addb("is_rendering_to_ui", s.is_display);
             addb("clamp_output", true);
 
-            auto cres = lua_pcall(s.L, 1, 1, 0);
+            auto cres = LUA_OK;
+            {
+                BudgetGuard bg(s.L, true);
+                cres = lua_pcall(s.L, 1, 1, 0);
+            }
             if (cres == LUA_OK)
             {
                 if (!lua_istable(s.L, -1))
@@ -281,7 +528,7 @@ end
             if (!lua_istable(s.L, -1))
             {
                 lua_pop(s.L, -1);
-                std::cout << "Not a table" << std::endl;
+                storage->diagnostics.push(Surge::Debug::diag_formula_state_not_table);
             }
             else
             {
@@ -340,7 +587,24 @@ end
         }
     }
 
-    if (is_display)
+    s.native = nullptr;
+    if (s.isvalid && !is_display)
+    {
+        auto nf = stateData.nativeFormulas.find(h);
+        if (nf == stateData.nativeFormulas.end())
+        {
+            auto &e = stateData.nativeFormulas[h];
+            e.source = fs->formulaString;
+            e.formula = ArithmeticFormula::compile(fs->formulaString);
+            s.native = e.formula.get();
+        }
+        else if (nf->second.source == fs->formulaString)
+        {
+            s.native = nf->second.formula.get();
+        }
+    }
+
+    if (is_display || storage->deterministicRendering)
     {
         // Move to support
         auto dg = Surge::LuaSupport::SGLD("set RNG", s.L);
@@ -349,7 +613,7 @@ end
         // > math
         if (lua_isnil(s.L, -1))
         {
-            std::cout << "NIL MATH " << std::endl;
+            storage->diagnostics.push(Surge::Debug::diag_formula_missing_math);
         }
         else
         {
@@ -357,12 +621,12 @@ end
             // > math > randomseed
             if (lua_isnil(s.L, -1))
             {
-                std::cout << "NUL randomseed" << std::endl;
+                storage->diagnostics.push(Surge::Debug::diag_formula_missing_math);
                 lua_pop(s.L, -1);
             }
             else
             {
-                lua_pushnumber(s.L, 8675309);
+                lua_pushnumber(s.L, is_display ? 8675309 : storage->seedForNewGenerator());
                 lua_pcall(s.L, 1, 0, 0);
             }
         }
@@ -386,8 +650,9 @@ end
     if (is_display)
         s.is_display = true;
 
-    if (s.raisedError)
-        std::cout << "ERROR: " << *(s.error) << std::endl;
+    // the modulator reports errors from the audio state itself, once it has run
+    if (s.raisedError && is_display && s.error)
+        storage->diagnostics.pushText(Surge::Debug::diag_formula_display_error, *(s.error));
 #endif
 
     return true;
@@ -416,6 +681,53 @@ void removeFunctionsAssociatedWith(SurgeStorage *storage, FormulaModulatorStorag
 #endif
 }
 
+size_t luaBytesInUse(SurgeStorage *storage)
+{
+    size_t res = 0;
+#if HAS_LUA
+    if (!storage->formulaGlobalData)
+        return 0;
+
+    auto &stateData = *storage->formulaGlobalData;
+    for (auto S : {stateData.audioState, stateData.displayState})
+    {
+        if (!S)
+            continue;
+
+        auto L = (lua_State *)S;
+        res += (size_t)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    }
+#endif
+    return res;
+}
+
+void stepGarbageCollection(SurgeStorage *storage, bool blockWasBusy)
+{
+#if HAS_LUA
+    if (!storage->formulaGlobalData || !storage->formulaGlobalData->audioState)
+        return;
+
+    auto &stateData = *storage->formulaGlobalData;
+    auto L = (lua_State *)stateData.audioState;
+
+    auto kb = lua_gc(L, LUA_GCCOUNT, 0);
+    stateData.audioGarbageDebtKB += std::max(0, kb - stateData.audioHeapKB);
+    stateData.audioHeapKB = kb;
+
+    if (stateData.audioGarbageDebtKB == 0 ||
+        (blockWasBusy && stateData.audioGarbageDebtKB < GlobalData::maxDeferredGarbageKB))
+        return;
+
+    // do twice the work we were allocated, so collection keeps ahead of allocation
+    lua_gc(L, LUA_GCSTEP, 2 * stateData.audioGarbageDebtKB);
+    // a step leaves the collector running again, so stop it
+    lua_gc(L, LUA_GCSTOP, 0);
+
+    stateData.audioGarbageDebtKB = 0;
+    stateData.audioHeapKB = lua_gc(L, LUA_GCCOUNT, 0);
+#endif
+}
+
 bool cleanEvaluatorState(EvaluatorState &s)
 {
 #if HAS_LUA
@@ -448,9 +760,39 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
     if (s->L == nullptr)
         return;
 
+    if (s->overBudget)
+    {
+        s->activeoutputs = s->lastActiveOutputs;
+        memcpy(output, s->lastOutput, max_formula_outputs * sizeof(float));
+        return;
+    }
+
     if (!s->isvalid)
         return;
 
+    // Fake a voice count of one for display calls
+    int voiceCount = storage->voiceCount;
+    if (voiceCount == 0)
+        voiceCount = 1;
+
+    if (s->native && !justSetup && !s->is_display && (s->isVoice || !s->native->usesVoiceFields))
+    {
+        // the state table is untouched here, just as init() left it, so the defaults hold
+        s->isFinite = true;
+        auto r = (float)s->native->evaluate(phaseIntPart, phaseFracPart, voiceCount, *s);
+        if (!std::isfinite(r))
+        {
+            s->isFinite = false;
+            r = 0.f;
+        }
+        output[0] = limitpm1(r);
+
+        s->useEnvelope = true;
+        s->retrigger_AEG = false;
+        s->retrigger_FEG = false;
+        return;
+    }
+
     auto gs = Surge::LuaSupport::SGLD("valueAt", s->L);
     struct OnErrorReplaceWithZero
     {
@@ -473,11 +815,15 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
      * So: make the stack my evaluation func then my table; then push my table
      * values; then call my function; then update my global
      */
+    auto &stateData = *storage->formulaGlobalData;
+    updateSceneInputs(stateData, *s, voiceCount);
+
+    lua_getglobal(s->L, processWithSceneInputsName);
     lua_getglobal(s->L, s->funcName);
     if (!lua_isfunction(s->L, -1))
     {
         s->isvalid = false;
-        lua_pop(s->L, 1);
+        lua_pop(s->L, 2);
         return;
     }
     lua_getglobal(s->L, s->stateName);
@@ -502,16 +848,10 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
         lua_setfield(s->L, -2, q);
     };
 
-    // Stack is now func > table so we can update the table
+    // Stack is now driver > func > table so we can update the table
     addi("intphase", phaseIntPart);
     addi("cycle", phaseIntPart); // Alias cycle for intphase
 
-    // Fake a voice count of one for display calls
-    int voiceCount = storage->voiceCount;
-    if (voiceCount == 0)
-        voiceCount = 1;
-    addi("voice_count", voiceCount);
-
     addn("delay", s->del);
     addn("decay", s->dec);
     addn("attack", s->a);
@@ -525,25 +865,6 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
     addn("deform", s->deform);
 
     addn("phase", phaseFracPart);
-    addn("tempo", s->tempo);
-    addn("songpos", s->songpos);
-
-    addn("pb", s->pitchbend);
-    addn("pb_range_up", s->pbrange_up);
-    addn("pb_range_dn", s->pbrange_dn);
-    addn("chan_at", s->aftertouch);
-    addn("cc_mw", s->modwheel);
-    addn("cc_breath", s->breath);
-    addn("cc_expr", s->expression);
-    addn("cc_sus", s->sustain);
-    addn("lowest_key", s->lowest_key);
-    addn("highest_key", s->highest_key);
-    addn("latest_key", s->latest_key);
-
-    addi("poly_limit", s->polylimit);
-    addi("scene_mode", s->scenemode);
-    addi("play_mode", s->polymode);
-    addi("split_point", s->splitpoint);
 
     addb("released", s->released);
     addb("is_rendering_to_ui", s->is_display);
@@ -593,12 +914,57 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
 
     if (justSetup)
     {
-        // Don't call but still clear me from the stack
-        lua_pop(s->L, 2);
+        // Don't call process, but do fill in the scene inputs, then clear me from the stack
+        lua_getglobal(s->L, copySceneInputsName);
+        lua_pushvalue(s->L, -2);
+        lua_getglobal(s->L, sceneInputsTableName);
+        if (lua_pcall(s->L, 2, 0, 0) != LUA_OK)
+            lua_pop(s->L, 1);
+        lua_pop(s->L, 3);
         return;
     }
 
-    auto lres = lua_pcall(s->L, 1, 1, 0);
+    lua_getglobal(s->L, sceneInputsTableName);
+    auto lres = LUA_OK;
+    auto tooSlow = false;
+    {
+        BudgetGuard bg(s->L, s->probationCallsLeft > 0);
+        lres = lua_pcall(s->L, 3, 1, 0);
+
+        if (!s->is_display)
+        {
+            s->slowCalls = bg.elapsed() > GlobalData::wallClockBudgetSeconds ? s->slowCalls + 1 : 0;
+            tooSlow = s->slowCalls >= GlobalData::slowCallsBeforeStopping;
+        }
+    }
+
+    if (budgetTripped || tooSlow)
+    {
+        // stop it here for good and hold the last value, rather than keep paying for it
+        std::ostringstream oss;
+        oss << "The 'process' function was stopped because ";
+        if (budgetTripped)
+            oss << "it ran for more than " << GlobalData::instructionBudget << " instructions.";
+        else
+            oss << "it took longer than " << GlobalData::wallClockBudgetSeconds * 1000
+                << " ms for " << GlobalData::slowCallsBeforeStopping << " calls in a row.";
+        oss << " It holds its last value until you edit it.";
+        s->adderror(oss.str());
+
+        lua_pop(s->L, 1); // the result or the error
+        s->overBudget = true;
+        stateData.knownBadFunctions.insert(s->funcName);
+        s->activeoutputs = s->lastActiveOutputs;
+        memcpy(output, s->lastOutput, max_formula_outputs * sizeof(float));
+        return;
+    }
+
+    if (lres == LUA_OK && s->probationCallsLeft > 0 && --s->probationCallsLeft == 0)
+    {
+        setJITFor(s->L, s->funcName, true);
+        stateData.functionsOnProbation.erase(s->funcName);
+    }
+
     // stack is now just the result
     if (lres == LUA_OK)
     {
@@ -618,6 +984,8 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             auto r = lua_tonumber(s->L, -1);
             lua_pop(s->L, 1);
             output[0] = checkFinite(r);
+            s->lastActiveOutputs = s->activeoutputs;
+            memcpy(s->lastOutput, output, max_formula_outputs * sizeof(float));
             return;
         }
         if (!lua_istable(s->L, -1))
@@ -664,7 +1032,6 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
                     if (idx > max_formula_outputs)
                         oss << " which means your result is too long.";
                     s->adderror(oss.str());
-                    auto &stateData = *storage->formulaGlobalData;
                     stateData.knownBadFunctions.insert(s->funcName);
                     s->isvalid = false;
 
@@ -681,8 +1048,6 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
         }
         else
         {
-            auto &stateData = *storage->formulaGlobalData;
-
             if (stateData.knownBadFunctions.find(s->funcName) != stateData.knownBadFunctions.end())
                 s->adderror(
                     "You must define the 'output' field in the returned table as a number or "
@@ -720,6 +1085,9 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
         // Finally pop the table result
         lua_pop(s->L, 1);
         onerr.replace = false;
+
+        s->lastActiveOutputs = s->activeoutputs;
+        memcpy(s->lastOutput, output, max_formula_outputs * sizeof(float));
         return;
     }
     else
@@ -28,6 +28,8 @@
 #include "LuaSupport.h"
 #include <variant>
 #include <memory>
+#include <mutex>
+#include "FormulaExpression.h"
 
 class SurgeVoice;
 
@@ -41,6 +43,46 @@ struct GlobalData
     std::unordered_set<std::string> knownBadFunctions; // these are functions which cause an error
     std::unordered_map<FormulaModulatorStorage *, std::unordered_set<std::string>> functionsPerFMS;
     void *audioState{nullptr}, *displayState{nullptr};
+
+    // formulas simple enough to skip Lua on the audio thread, by hash; nullptr if not
+    struct NativeFormula
+    {
+        std::string source;
+        std::unique_ptr<ArithmeticFormula> formula;
+    };
+    std::unordered_map<size_t, NativeFormula> nativeFormulas;
+
+    // the scene inputs last written to each lua state, so we only write them on a change
+    std::vector<float> audioSceneInputs, displaySceneInputs;
+
+    // the display state is shared by everything which evaluates formulas for the UI, some of
+    // which does so off the message thread, so hold this around any use of it
+    std::mutex displayStateMutex;
+
+    // formula bytecode compiled off the audio thread by precompileFormula, by hash
+    struct CompiledFormula
+    {
+        std::string source, code;
+    };
+    static constexpr size_t maxBytecodeEntries{256};
+    std::unordered_map<size_t, CompiledFormula> bytecode;
+    std::mutex bytecodeMutex;
+
+    /*
+     * What one call of a formula may cost before we stop it. The instruction count only sees
+     * interpreted code, so it covers formulas on probation, and on the audio thread we also stop
+     * formulas which keep running over a wall clock budget; one slow call could just be the OS
+     * taking the thread away.
+     */
+    static constexpr int instructionBudget{1 << 20};
+    static constexpr int probationCalls{64};
+    std::unordered_set<std::string> functionsOnProbation;
+    static constexpr double wallClockBudgetSeconds{0.001};
+    static constexpr int slowCallsBeforeStopping{16};
+
+    // the audio state collects its garbage in stepGarbageCollection, not while formulas run
+    static constexpr int maxDeferredGarbageKB{1024};
+    int audioHeapKB{0}, audioGarbageDebtKB{0};
 };
 
 static constexpr int max_formula_outputs{max_lfo_indices};
@@ -92,11 +134,38 @@ struct EvaluatorState
 
     int activeoutputs;
 
+    // what process() last returned, which we hold if it ever runs over its budget
+    float lastOutput[max_formula_outputs]{};
+    int lastActiveOutputs{1};
+    bool overBudget{false};
+    int slowCalls{0}, probationCallsLeft{0};
+
     lua_State *L{nullptr}; // This is assigned by prepareForEvaluation to be one per thread
+
+    // set by prepareForEvaluation if the audio thread can evaluate this without Lua
+    const ArithmeticFormula *native{nullptr};
 };
 
 void setupStorage(SurgeStorage *s);
 
+/*
+ * Compile a formula to bytecode so that the audio thread only has to load it. Call this from
+ * wherever a formula is set off the audio thread, like the patch loader or the editor.
+ */
+void precompileFormula(SurgeStorage *storage, FormulaModulatorStorage *fs);
+
+/*
+ * The bytes the Lua heaps of the audio and display states hold, as Lua counts them. The audio
+ * state's count is read without stopping the audio thread, so treat it as approximate.
+ */
+size_t luaBytesInUse(SurgeStorage *s);
+
+/*
+ * Do the garbage collection the audio state's formulas have built up. The synth calls this
+ * once per block; if the block was busy we put it off, until the debt gets too large.
+ */
+void stepGarbageCollection(SurgeStorage *s, bool blockWasBusy);
+
 bool initEvaluatorState(EvaluatorState &s);
 bool cleanEvaluatorState(EvaluatorState &s);
 void removeFunctionsAssociatedWith(SurgeStorage *,
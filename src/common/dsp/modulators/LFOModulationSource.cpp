@@ -47,6 +47,9 @@ void LFOModulationSource::assign(SurgeStorage *storage, LFOStorage *lfo, pdata *
     this->fs = fs;
     this->is_display = is_display;
 
+    if (storage && storage->deterministicRendering && !is_display)
+        msegstate.seed(storage->seedForNewGenerator());
+
     Surge::Formula::cleanEvaluatorState(formulastate);
     if (is_display)
         msegstate = Surge::MSEG::EvaluatorState();
@@ -562,8 +565,13 @@ void LFOModulationSource::process_block()
         ** envrate is blocksize / samplerate 2^-x
         ** so let's just do that
         */
-        frate = (double)BLOCK_SIZE_OS * storage->dsamplerate_os_inv *
-                pow(2.0, localcopy[rate].f); // since x = -localcopy, -x == localcopy
+        if (localcopy[rate].f != syncedRateIn)
+        {
+            syncedRateIn = localcopy[rate].f;
+            syncedRateOut = pow(2.0, syncedRateIn); // since x = -localcopy, -x == localcopy
+        }
+
+        frate = (double)BLOCK_SIZE_OS * storage->dsamplerate_os_inv * syncedRateOut;
     }
 
     if (lfo->rate.deactivated)
@@ -1228,11 +1236,12 @@ void LFOModulationSource::process_block()
 
         if (formulastate.raisedError)
         {
-            auto em = *formulastate.error;
+            // we're on the audio thread, so the log takes it from here
+            if (formulastate.error)
+                storage->diagnostics.pushText(Surge::Debug::diag_formula_error,
+                                              *formulastate.error);
             formulastate.error.reset();
             formulastate.raisedError = false;
-            storage->reportError(em, "Formula Evaluator Error");
-            std::cout << "ERROR: " << em << std::endl;
         }
 
         // Since I'm (right now) the only vector valued modulator just do a little
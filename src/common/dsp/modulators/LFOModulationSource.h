@@ -30,6 +30,7 @@
 #include "MSEGModulationHelper.h" // We need this for the MSEGEvalatorState member
 #include "FormulaModulationHelper.h"
 #include <functional>
+#include <limits>
 #include "sst/basic-blocks/dsp/QuadratureOscillators.h"
 
 enum LFOEG_state
@@ -143,6 +144,10 @@ class LFOModulationSource : public ModulationSource
 
     float onepoleState[3];
 
+    // 2^rate for the exact tempo synced rate, which only moves when the rate does
+    float syncedRateIn{std::numeric_limits<float>::quiet_NaN()};
+    double syncedRateOut{0.0};
+
     std::default_random_engine gen;
     std::uniform_real_distribution<float> distro;
     std::function<float()> urng;
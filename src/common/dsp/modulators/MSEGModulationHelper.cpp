@@ -21,6 +21,7 @@
  */
 
 #include "MSEGModulationHelper.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "DebugHelpers.h"
@@ -32,6 +33,47 @@ namespace Surge
 namespace MSEG
 {
 
+static void computeSegmentCurve(float cpv, MSEGStorage::segmentCurve &c)
+{
+    c.cpv = cpv;
+
+    // The exponent of the (e^ax-1)/(e^a-1) curve through the control point, see valueAt
+    float V = 0.5 * cpv + 0.5;
+    float amul = 1;
+
+    if (V < 0.5)
+    {
+        amul = -1;
+        V = 1 - V;
+    }
+
+    float disc = (1 - 4 * V * (1 - V));
+    float a = 0;
+
+    if (fabs(V) > 1e-3)
+    {
+        float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
+        a = amul * 2 * log(Q);
+    }
+
+    c.cpExponent = a;
+
+    // The oscillating shapes do this in float and the stairs in double, so keep both
+    {
+        float pct = (cpv + 1) * 0.5;
+        float as = 5.0;
+        float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+        c.oscillations = (int)(scaledpct * 100);
+    }
+
+    {
+        auto pct = (cpv + 1) * 0.5;
+        auto as = 5.0;
+        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+        c.stairs = (int)(scaledpct * 100) + 2;
+    }
+}
+
 void rebuildCache(MSEGStorage *ms)
 {
     forceToConstrainedNormalForm(ms);
@@ -98,6 +140,11 @@ void rebuildCache(MSEGStorage *ms)
     for (int i = 0; i < ms->n_activeSegments; ++i)
     {
         constrainControlPointAt(ms, i);
+
+        if (ms->segmentCurves[i].cpv != ms->segments[i].cpv)
+        {
+            computeSegmentCurve(ms->segments[i].cpv, ms->segmentCurves[i]);
+        }
     }
 
     ms->durationToLoopEnd = ms->totalDuration;
@@ -212,6 +259,13 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     auto r = ms->segments[idx];
     bool segInit = false;
 
+    auto curve = ms->segmentCurves[idx];
+
+    if (curve.cpv != r.cpv)
+    {
+        computeSegmentCurve(r.cpv, curve);
+    }
+
     if (idx != es->lastEval || es->has_triggered)
     {
         segInit = true;
@@ -349,25 +403,10 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
          *
          * a = 2 * log(Q)
          *
+         * which only depends on the control point, so computeSegmentCurve does it for us.
          */
 
-        float V = 0.5 * r.cpv + 0.5;
-        float amul = 1;
-
-        if (V < 0.5)
-        {
-            amul = -1;
-            V = 1 - V;
-        }
-
-        float disc = (1 - 4 * V * (1 - V));
-        float a = 0;
-
-        if (fabs(V) > 1e-3)
-        {
-            float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
-            a = amul * 2 * log(Q);
-        }
+        float a = curve.cpExponent;
 
         // OK so frac is the 0,1 line point
         auto cpline = frac;
@@ -504,10 +543,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     case MSEGStorage::segment::TRIANGLE:
     case MSEGStorage::segment::SQUARE:
     {
-        float pct = (r.cpv + 1) * 0.5;
-        float as = 5.0;
-        float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        int steps = (int)(scaledpct * 100);
+        int steps = curve.oscillations;
         auto frac = timeAlongSegment / r.duration;
         float kernel = 0;
 
@@ -577,10 +613,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
 
     case MSEGStorage::segment::STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = curve.stairs;
         auto frac = (float)((int)(steps * timeAlongSegment / r.duration)) / (steps - 1);
 
         if (df < 0)
@@ -598,10 +631,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     }
     case MSEGStorage::segment::SMOOTH_STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = curve.stairs;
         auto frac = timeAlongSegment / r.duration;
 
         auto c = df < 0.f ? 1.0 + df * 0.7 : 1.0 + df * 3.0;
@@ -728,6 +758,35 @@ int timeToSegment(MSEGStorage *ms, double t)
     return timeToSegment(ms, t, true, x);
 }
 
+/*
+ * The first segment with segmentStart <= t < segmentEnd, or <= segmentEnd if includeEnd.
+ * The segment ends never decrease, so we can bisect for the first end past t, which long
+ * MSEGs are glad of since we do this for every voice every block.
+ */
+static int findSegment(MSEGStorage *ms, double t, bool includeEnd)
+{
+    auto b = ms->segmentEnd.begin(), e = b + ms->n_activeSegments;
+    auto it = includeEnd ? std::lower_bound(b, e, t) : std::upper_bound(b, e, t);
+    int i = (int)(it - b);
+
+    if (i < ms->n_activeSegments && t >= ms->segmentStart[i])
+    {
+        return i;
+    }
+
+    // before the first segment or past the last, or the ends are out of order somehow
+    for (i = 0; i < ms->n_activeSegments; ++i)
+    {
+        if (t >= ms->segmentStart[i] &&
+            (includeEnd ? t <= ms->segmentEnd[i] : t < ms->segmentEnd[i]))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlongSegment)
 {
     if (ms->totalDuration < MSEGStorage::minimumDuration)
@@ -749,17 +808,11 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             }
         }
 
-        int idx = -1;
+        int idx = findSegment(ms, t, false);
 
-        for (int i = 0; i < ms->n_activeSegments; ++i)
+        if (idx >= 0)
         {
-            if (t >= ms->segmentStart[i] && t < ms->segmentEnd[i])
-            {
-                idx = i;
-                amountAlongSegment = t - ms->segmentStart[i];
-
-                break;
-            }
+            amountAlongSegment = t - ms->segmentStart[idx];
         }
 
         return idx;
@@ -773,13 +826,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
         // So are we before the first loop end point
         if (t <= ms->durationToLoopEnd)
         {
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (t >= ms->segmentStart[i] && t <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = t - ms->segmentStart[i];
+            int i = findSegment(ms, t, true);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = t - ms->segmentStart[i];
+
+                return i;
+            }
         }
         else if (ms->loop_start > ms->loop_end && ms->loop_start >= 0 && ms->loop_end >= 0)
         {
@@ -807,13 +861,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             // and we need to offset it by the starting point
             nt += ms->segmentStart[ls];
 
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (nt >= ms->segmentStart[i] && nt <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = nt - ms->segmentStart[i];
+            int i = findSegment(ms, nt, true);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = nt - ms->segmentStart[i];
+
+                return i;
+            }
         }
 
         return 0;
@@ -24,6 +24,7 @@
 
 #include "AliasOscillator.h"
 #include "SineOscillator.h"
+#include <vembertech/portable_intrinsics.h>
 
 // This linear representation is required for VST3 automation and the like and needs to
 // match the param ID the UI is driven by the remapper code in init_ctrltypes
@@ -75,13 +76,21 @@ void AliasOscillator::init(float pitch, bool is_display, bool nonzero_init_drift
     }
 
     n_unison = is_display ? 1 : oscdata->p[ao_unison_voices].val.i;
+    n_lanes = (n_unison + 3) & ~3;
 
-    auto us = Surge::Oscillator::UnisonSetup<float>(n_unison);
+    unison = &Surge::Oscillator::UnisonTable::forVoices(n_unison);
+
+    for (int u = n_unison; u < n_lanes; ++u)
+    {
+        mixL[u] = 0.f;
+        mixR[u] = 0.f;
+        phase[u] = 0;
+    }
 
     for (int u = 0; u < n_unison; ++u)
     {
-        unisonOffsets[u] = us.detune(u);
-        us.attenuatedPanLaw(u, mixL[u], mixR[u]);
+        mixL[u] = unison->attenuatedPanL[u];
+        mixR[u] = unison->attenuatedPanR[u];
 
         phase[u] = oscdata->retrigger.val.b || is_display ? 0.f : storage->rand_u32();
 
@@ -99,6 +108,19 @@ template <typename T> inline T localClamp(const T &a, const T &l, const T &h)
     return std::max(l, std::min(a, h));
 }
 
+// There's no unsigned conversion in SSE2, but both halves convert exactly so this rounds once
+inline SIMD_M128 u32ToFloat(SIMD_M128I x)
+{
+    auto hi = SIMD_MM(cvtepi32_ps)(SIMD_MM(srli_epi32)(x, 16));
+    auto lo = SIMD_MM(cvtepi32_ps)(SIMD_MM(and_si128)(x, SIMD_MM(set1_epi32)(0xFFFF)));
+    return SIMD_MM(add_ps)(SIMD_MM(mul_ps)(hi, SIMD_MM(set1_ps)(65536.f)), lo);
+}
+
+inline SIMD_M128I selectInt(SIMD_M128I mask, SIMD_M128I a, SIMD_M128I b)
+{
+    return SIMD_MM(or_si128)(SIMD_MM(and_si128)(mask, a), SIMD_MM(andnot_si128)(mask, b));
+}
+
 // this templating makes the bool ifs etc faster
 template <bool do_FM, bool do_bitcrush, AliasOscillator::ao_waves wavetype>
 void AliasOscillator::process_block_internal(const float pitch, const float drift,
@@ -282,17 +304,31 @@ void AliasOscillator::process_block_internal(const float pitch, const float drif
     const float dequant = do_bitcrush ? 1.f / quant : 0.f;
 
     // compute once for each unison voice here, then apply per sample
-    uint32_t phase_increments[MAX_UNISON];
+    uint32_t phase_increments alignas(16)[MAX_UNISON] = {};
+    float notes[MAX_UNISON], offsets[MAX_UNISON];
+    double dphase[MAX_UNISON];
 
     for (int u = 0; u < n_unison; ++u)
     {
         const float lfodrift = drift * driftLFO[u].next();
-        phase_increments[u] =
-            pitch_to_dphase_with_absolute_offset(pitch + lfodrift + ud * unisonOffsets[u],
-                                                 absOff * unisonOffsets[u]) *
-            two32;
+        notes[u] = pitch + lfodrift + ud * unison->detune[u];
+        offsets[u] = absOff * unison->detune[u];
+    }
+
+    pitch_to_dphase_with_absolute_offset_block(notes, offsets, dphase, n_unison);
+    for (int u = 0; u < n_unison; ++u)
+    {
+        phase_increments[u] = dphase[u] * two32;
     }
 
+    const auto bytes = SIMD_MM(set1_epi32)(bit_mask);
+    const auto maskV = SIMD_MM(set1_epi32)(mask);
+    const auto thresholdV = SIMD_MM(set1_epi32)(threshold);
+    const auto wrapV = SIMD_MM(set1_ps)(wrap);
+    const auto zeroOffset = SIMD_MM(set1_ps)((float)0x7F);
+    const auto invBitMask = SIMD_MM(set1_ps)(inv_bit_mask);
+    const auto quantV = SIMD_MM(set1_ps)(quant), dequantV = SIMD_MM(set1_ps)(dequant);
+
     for (int i = 0; i < BLOCK_SIZE_OS; ++i)
     {
         // int64_t since I can span +/- two32 or beyond
@@ -303,86 +339,120 @@ void AliasOscillator::process_block_internal(const float pitch, const float drif
             fmPhaseShift = (int64_t)(fmdepth.v * master_osc[i] * two32);
         }
 
-        float vL = 0.f, vR = 0.f;
+        // the phases wrap, so only the bottom 32 bits of the shift matter
+        const auto fmShift = SIMD_MM(set1_epi32)((int32_t)(uint32_t)fmPhaseShift);
+        auto accL = SIMD_MM(setzero_ps)(), accR = SIMD_MM(setzero_ps)();
 
-        for (int u = 0; u < n_unison; ++u)
+        for (int u = 0; u < n_lanes; u += 4)
         {
-            uint32_t _phase = phase[u]; // default to this
+            auto ph = SIMD_MM(load_si128)((const SIMD_M128I *)(phase + u));
+
+            SIMD_M128I upper; // upper 8 bits
             if (wavetype == aow_pulse)
-            { // but for pulse...
-                // fake hardsync
-                _phase = (uint32_t)((float)phase[u] * wrap);
+            {
+                // fake hardsync: (uint32_t)((float)phase * wrap), which wraps (on x86-64 anyway)
+                // rather than saturating, but since we only want the upper byte we can take it
+                // straight from the float
+                auto synced = SIMD_MM(mul_ps)(u32ToFloat(ph), wrapV);
+                upper = SIMD_MM(and_si128)(
+                    SIMD_MM(cvttps_epi32)(SIMD_MM(mul_ps)(synced, SIMD_MM(set1_ps)(0x1p-24f))),
+                    bytes);
+            }
+            else
+            {
+                upper = SIMD_MM(srli_epi32)(ph, 24);
             }
-            const uint8_t upper = _phase >> 24; // upper 8 bits
-            const uint8_t masked = upper ^ mask;
 
-            uint8_t result = masked; // default to this
+            const auto masked = SIMD_MM(xor_si128)(upper, maskV);
+
+            auto result = masked; // default to this
 
             if (wavetype == aow_ramp)
             {
                 // flip wave to make a triangle shape (n.b. has a DC offset)
-                if (upper > threshold)
-                {
-                    if (ramp_unmasked_after_threshold)
-                    {
-                        result = bit_mask - upper;
-                    }
-                    else
-                    {
-                        result = bit_mask - masked;
-                    }
-                }
+                auto flipped = SIMD_MM(sub_epi32)(bytes, ramp_unmasked_after_threshold ? upper
+                                                                                       : masked);
+                result = selectInt(SIMD_MM(cmpgt_epi32)(upper, thresholdV), flipped, masked);
             }
             else if (wavetype == aow_pulse)
             {
-                result = (masked > threshold) ? bit_mask : 0x00;
+                result = SIMD_MM(and_si128)(SIMD_MM(cmpgt_epi32)(masked, thresholdV), bytes);
             }
             else if (wavetype == aow_noise)
             {
-                result = urng8[u].stepTo((upper & 0xFF), threshold | 8U);
-                // OK so we want to wrap towards 255/0 so
-                int32_t shapes = result - 0x7F;
-                shapes = localClamp((int32_t)(shapes * wrap), -0x7F, 0x7F - 1);
-                result = (uint8_t)(shapes + 0x7F);
+                // the generators step at their own pace, so these go one voice at a time
+                int32_t lanes alignas(16)[4];
+                SIMD_MM(store_si128)((SIMD_M128I *)lanes, upper);
+
+                for (int l = 0; l < 4; ++l)
+                {
+                    if (u + l >= n_unison)
+                    {
+                        lanes[l] = 0x7F;
+                        continue;
+                    }
+
+                    uint8_t r = urng8[u + l].stepTo((lanes[l] & 0xFF), threshold | 8U);
+                    // OK so we want to wrap towards 255/0 so
+                    int32_t shapes = r - 0x7F;
+                    shapes = localClamp((int32_t)(shapes * wrap), -0x7F, 0x7F - 1);
+                    lanes[l] = shapes + 0x7F;
+                }
+
+                result = SIMD_MM(load_si128)((const SIMD_M128I *)lanes);
             }
 
             if (wavetype != aow_noise && wavetype != aow_pulse)
             {
                 // wraparound. scales the result by a float, then casts back down to a byte
-                result = (uint8_t)((float)result * wrap);
+                result = SIMD_MM(and_si128)(
+                    SIMD_MM(cvttps_epi32)(SIMD_MM(mul_ps)(SIMD_MM(cvtepi32_ps)(result), wrapV)),
+                    bytes);
             }
 
-            // default to this
-            float out = ((float)result - (float)0x7F) * inv_bit_mask;
+            SIMD_M128 out;
 
-            // but for wavetable modes, index a table instead
-            if (wavetable_mode) // TODO: maybe move this bool into the template?
+            // for wavetable modes, index a table
+            if (wavetable_mode)
             {
-                if (result > threshold)
-                {
-                    result += 0x7F - threshold;
-                }
-
-                out = ((float)wavetable[0xFF - result] - (float)0x7F) * inv_bit_mask;
+                auto shifted = SIMD_MM(and_si128)(
+                    SIMD_MM(add_epi32)(result, SIMD_MM(set1_epi32)(0x7F - threshold)), bytes);
+                result = selectInt(SIMD_MM(cmpgt_epi32)(result, thresholdV), shifted, result);
+
+                int32_t lanes alignas(16)[4];
+                SIMD_MM(store_si128)((SIMD_M128I *)lanes, SIMD_MM(sub_epi32)(bytes, result));
+                out = SIMD_MM(setr_ps)(wavetable[lanes[0]], wavetable[lanes[1]],
+                                       wavetable[lanes[2]], wavetable[lanes[3]]);
+            }
+            else
+            {
+                out = SIMD_MM(cvtepi32_ps)(result);
             }
 
+            out = SIMD_MM(mul_ps)(SIMD_MM(sub_ps)(out, zeroOffset), invBitMask);
+
             if (do_bitcrush)
             {
                 // bitcrush
-                out = dequant * (int)(out * quant);
+                out = SIMD_MM(mul_ps)(
+                    dequantV,
+                    SIMD_MM(cvtepi32_ps)(SIMD_MM(cvttps_epi32)(SIMD_MM(mul_ps)(out, quantV))));
             }
 
-            vL += out * mixL[u];
-            vR += out * mixR[u];
+            accL = SIMD_MM(add_ps)(accL, SIMD_MM(mul_ps)(out, SIMD_MM(load_ps)(mixL + u)));
+            accR = SIMD_MM(add_ps)(accR, SIMD_MM(mul_ps)(out, SIMD_MM(load_ps)(mixR + u)));
 
-            // this order actually kinda matters in 32-bit especially
             if (do_FM)
             {
-                phase[u] += fmPhaseShift;
+                ph = SIMD_MM(add_epi32)(ph, fmShift);
             }
-            phase[u] += phase_increments[u];
+            ph = SIMD_MM(add_epi32)(
+                ph, SIMD_MM(load_si128)((const SIMD_M128I *)(phase_increments + u)));
+            SIMD_MM(store_si128)((SIMD_M128I *)(phase + u), ph);
         }
 
+        float vL = vSum(accL), vR = vSum(accR);
+
         output[i] = vL;
         outputR[i] = vR;
 
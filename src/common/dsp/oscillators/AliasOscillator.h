@@ -78,6 +78,15 @@ class AliasOscillator : public Oscillator
             mixL[u] = 1.f;
             mixR[u] = 1.f;
         }
+
+        // for the audio in wave
+        if (storage)
+            storage->audio_in_clients++;
+    }
+    ~AliasOscillator()
+    {
+        if (storage)
+            storage->audio_in_clients--;
     }
 
     virtual void init(float pitch, bool is_display = false, bool nonzero_init_drift = true);
@@ -101,10 +110,12 @@ class AliasOscillator : public Oscillator
     // character filter
     Surge::Oscillator::CharacterFilter<float> charFilt;
 
-    int n_unison = 1;
-    uint32_t phase[MAX_UNISON];
-    float unisonOffsets[MAX_UNISON];
-    float mixL[MAX_UNISON], mixR[MAX_UNISON];
+    // The unison voices are rendered four to a register; n_lanes rounds n_unison up to whole
+    // registers and the spare lanes are mixed at zero.
+    int n_unison = 1, n_lanes = 4;
+    uint32_t phase alignas(16)[MAX_UNISON];
+    const Surge::Oscillator::UnisonTable *unison{&Surge::Oscillator::UnisonTable::forVoices(1)};
+    float mixL alignas(16)[MAX_UNISON], mixR alignas(16)[MAX_UNISON];
     uint8_t dynamic_wavetable[256];
     unsigned dynamic_wavetable_sleep = 0; // blocks to wait before recalculating dynamic wavetable
 
@@ -127,15 +138,25 @@ class AliasOscillator : public Oscillator
             a = a ^ (a >> 5U) ^ (t ^ (t >> 2U));
             return a;
         }
+        // Counts stepCount up (wrapping) to sc, stepping at every count divisible by every. Rather
+        // than walk each count, jump between the multiples: up to 255, then from 0 past the wrap.
         inline uint8_t stepTo(uint8_t sc, uint8_t every)
         {
             uint8_t r = a;
-            while (stepCount != sc)
+            if (stepCount == sc)
+                return r;
+
+            int end = sc < stepCount ? 255 : sc;
+            for (int c = (stepCount / every + 1) * every; c <= end; c += every)
+                r = step();
+
+            if (sc < stepCount)
             {
-                stepCount++;
-                if (stepCount % every == 0)
+                for (int c = 0; c <= sc; c += every)
                     r = step();
             }
+
+            stepCount = sc;
             return r;
         }
     };
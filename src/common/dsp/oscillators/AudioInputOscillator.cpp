@@ -31,6 +31,7 @@ AudioInputOscillator::AudioInputOscillator(SurgeStorage *storage, OscillatorStor
     if (storage)
     {
         storage->otherscene_clients++;
+        storage->audio_in_clients++;
         bool isSB = false;
         for (int i = 0; i < n_oscs; ++i)
             if (&(storage->getPatch().scene[1].osc[i]) == oscdata)
@@ -53,7 +54,10 @@ void AudioInputOscillator::init(float pitch, bool is_display, bool nonzero_init_
 AudioInputOscillator::~AudioInputOscillator()
 {
     if (storage)
+    {
         storage->otherscene_clients--;
+        storage->audio_in_clients--;
+    }
 }
 
 void AudioInputOscillator::init_ctrltypes(int scene, int osc)
@@ -0,0 +1,225 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "BlitConvolution.h"
+
+#include "SurgeStorage.h"
+#include "sst/plugininfra/cpufeatures.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define SURGE_BLIT_AVX_KERNEL 1
+#if defined(__GNUC__) || defined(__clang__)
+#define SURGE_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SURGE_TARGET_AVX
+#endif
+#endif
+
+namespace Surge
+{
+namespace Oscillator
+{
+namespace BlitConvolution
+{
+static_assert(FIRipol_N % 4 == 0, "The kernels work four samples at a time");
+
+static void monoSSE(float *ob, const float *sinc, float lipol, float g)
+{
+    auto l = SIMD_MM(set1_ps)(lipol);
+    auto g128 = SIMD_MM(set1_ps)(g);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto o = SIMD_MM(loadu_ps)(ob + k);
+        auto st = SIMD_MM(load_ps)(sinc + k);
+        auto so = SIMD_MM(load_ps)(sinc + k + FIRipol_N);
+        so = SIMD_MM(mul_ps)(so, l);
+        st = SIMD_MM(add_ps)(st, so);
+        st = SIMD_MM(mul_ps)(st, g128);
+        o = SIMD_MM(add_ps)(o, st);
+        SIMD_MM(storeu_ps)(ob + k, o);
+    }
+}
+
+static void stereoSSE(float *obL, float *obR, const float *sinc, float lipol, float gL, float gR)
+{
+    auto l = SIMD_MM(set1_ps)(lipol);
+    auto g128L = SIMD_MM(set1_ps)(gL);
+    auto g128R = SIMD_MM(set1_ps)(gR);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto oL = SIMD_MM(loadu_ps)(obL + k);
+        auto oR = SIMD_MM(loadu_ps)(obR + k);
+        auto st = SIMD_MM(load_ps)(sinc + k);
+        auto so = SIMD_MM(load_ps)(sinc + k + FIRipol_N);
+        so = SIMD_MM(mul_ps)(so, l);
+        st = SIMD_MM(add_ps)(st, so);
+        oL = SIMD_MM(add_ps)(oL, SIMD_MM(mul_ps)(st, g128L));
+        SIMD_MM(storeu_ps)(obL + k, oL);
+        oR = SIMD_MM(add_ps)(oR, SIMD_MM(mul_ps)(st, g128R));
+        SIMD_MM(storeu_ps)(obR + k, oR);
+    }
+}
+
+// lipol is ignored; see the header
+static void monoCoarseSSE(float *ob, const float *sinc, float, float g)
+{
+    auto g128 = SIMD_MM(set1_ps)(g);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto o = SIMD_MM(loadu_ps)(ob + k);
+        auto st = SIMD_MM(mul_ps)(SIMD_MM(load_ps)(sinc + k), g128);
+        SIMD_MM(storeu_ps)(ob + k, SIMD_MM(add_ps)(o, st));
+    }
+}
+
+static void stereoCoarseSSE(float *obL, float *obR, const float *sinc, float, float gL, float gR)
+{
+    auto g128L = SIMD_MM(set1_ps)(gL);
+    auto g128R = SIMD_MM(set1_ps)(gR);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto st = SIMD_MM(load_ps)(sinc + k);
+        auto oL = SIMD_MM(loadu_ps)(obL + k);
+        auto oR = SIMD_MM(loadu_ps)(obR + k);
+        SIMD_MM(storeu_ps)(obL + k, SIMD_MM(add_ps)(oL, SIMD_MM(mul_ps)(st, g128L)));
+        SIMD_MM(storeu_ps)(obR + k, SIMD_MM(add_ps)(oR, SIMD_MM(mul_ps)(st, g128R)));
+    }
+}
+
+#if SURGE_BLIT_AVX_KERNEL
+/*
+ * FIRipol_N is 12, so these do eight samples in one go and the last four with 128-bit ops.
+ * Wider registers would spend most of their lanes on nothing.
+ */
+static constexpr int avxWidth = 8;
+static constexpr int avxEnd = FIRipol_N - FIRipol_N % avxWidth;
+
+SURGE_TARGET_AVX static void monoAVX(float *ob, const float *sinc, float lipol, float g)
+{
+    int k = 0;
+
+    {
+        auto l = _mm256_set1_ps(lipol);
+        auto g256 = _mm256_set1_ps(g);
+
+        for (; k < avxEnd; k += avxWidth)
+        {
+            auto o = _mm256_loadu_ps(ob + k);
+            auto st = _mm256_loadu_ps(sinc + k);
+            auto so = _mm256_loadu_ps(sinc + k + FIRipol_N);
+            so = _mm256_mul_ps(so, l);
+            st = _mm256_add_ps(st, so);
+            st = _mm256_mul_ps(st, g256);
+            o = _mm256_add_ps(o, st);
+            _mm256_storeu_ps(ob + k, o);
+        }
+    }
+
+    auto l = _mm_set1_ps(lipol);
+    auto g128 = _mm_set1_ps(g);
+
+    for (; k < FIRipol_N; k += 4)
+    {
+        auto o = _mm_loadu_ps(ob + k);
+        auto st = _mm_loadu_ps(sinc + k);
+        auto so = _mm_loadu_ps(sinc + k + FIRipol_N);
+        so = _mm_mul_ps(so, l);
+        st = _mm_add_ps(st, so);
+        st = _mm_mul_ps(st, g128);
+        o = _mm_add_ps(o, st);
+        _mm_storeu_ps(ob + k, o);
+    }
+
+    _mm256_zeroupper();
+}
+
+SURGE_TARGET_AVX static void stereoAVX(float *obL, float *obR, const float *sinc, float lipol,
+                                       float gL, float gR)
+{
+    int k = 0;
+
+    {
+        auto l = _mm256_set1_ps(lipol);
+        auto g256L = _mm256_set1_ps(gL);
+        auto g256R = _mm256_set1_ps(gR);
+
+        for (; k < avxEnd; k += avxWidth)
+        {
+            auto oL = _mm256_loadu_ps(obL + k);
+            auto oR = _mm256_loadu_ps(obR + k);
+            auto st = _mm256_loadu_ps(sinc + k);
+            auto so = _mm256_loadu_ps(sinc + k + FIRipol_N);
+            so = _mm256_mul_ps(so, l);
+            st = _mm256_add_ps(st, so);
+            oL = _mm256_add_ps(oL, _mm256_mul_ps(st, g256L));
+            _mm256_storeu_ps(obL + k, oL);
+            oR = _mm256_add_ps(oR, _mm256_mul_ps(st, g256R));
+            _mm256_storeu_ps(obR + k, oR);
+        }
+    }
+
+    auto l = _mm_set1_ps(lipol);
+    auto g128L = _mm_set1_ps(gL);
+    auto g128R = _mm_set1_ps(gR);
+
+    for (; k < FIRipol_N; k += 4)
+    {
+        auto oL = _mm_loadu_ps(obL + k);
+        auto oR = _mm_loadu_ps(obR + k);
+        auto st = _mm_loadu_ps(sinc + k);
+        auto so = _mm_loadu_ps(sinc + k + FIRipol_N);
+        so = _mm_mul_ps(so, l);
+        st = _mm_add_ps(st, so);
+        oL = _mm_add_ps(oL, _mm_mul_ps(st, g128L));
+        _mm_storeu_ps(obL + k, oL);
+        oR = _mm_add_ps(oR, _mm_mul_ps(st, g128R));
+        _mm_storeu_ps(obR + k, oR);
+    }
+
+    _mm256_zeroupper();
+}
+#endif
+
+static Kernels selectKernels()
+{
+#if SURGE_BLIT_AVX_KERNEL
+    if (sst::plugininfra::cpufeatures::hasAVX())
+        return {monoAVX, stereoAVX, monoCoarseSSE, stereoCoarseSSE, "AVX"};
+#endif
+
+    // on ARM this is NEON through SIMDE, which is as wide as NEON gets
+    return {monoSSE, stereoSSE, monoCoarseSSE, stereoCoarseSSE, "SSE"};
+}
+
+const Kernels &kernels()
+{
+    static const Kernels k = selectKernels();
+    return k;
+}
+} // namespace BlitConvolution
+} // namespace Oscillator
+} // namespace Surge
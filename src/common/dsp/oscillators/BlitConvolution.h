@@ -0,0 +1,67 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_BLITCONVOLUTION_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_BLITCONVOLUTION_H
+
+namespace Surge
+{
+namespace Oscillator
+{
+/*
+ * The inner loop of the BLIT oscillators' convolute: add an impulse of height g, smeared by
+ * the windowed sinc at our fractional position, into the oscillator buffer.
+ *
+ *    ob[i] += g * (sinc[i] + lipol * sinc[i + FIRipol_N])   for i in [0, FIRipol_N)
+ *
+ * where sinc points at the window and derivative pair in SurgeStorage::sinctable. The
+ * buffer pointer needs no particular alignment.
+ *
+ * We pick the widest implementation the CPU supports once, at startup. Every version does
+ * the same multiplies and adds in the same order, with no fused multiply-add, so they all
+ * give bit identical output.
+ *
+ * The coarse pair leaves out the lipol term, so each impulse lands on the sinc phase just
+ * before its position rather than between two of them. That saves a third of the arithmetic
+ * for a little more aliasing, which the CPU governor trades for under heavy load.
+ */
+namespace BlitConvolution
+{
+typedef void (*monoKernel_t)(float *ob, const float *sinc, float lipol, float g);
+typedef void (*stereoKernel_t)(float *obL, float *obR, const float *sinc, float lipol, float gL,
+                               float gR);
+
+struct Kernels
+{
+    monoKernel_t mono;
+    stereoKernel_t stereo;
+    monoKernel_t monoCoarse;
+    stereoKernel_t stereoCoarse;
+    const char *name;
+};
+
+const Kernels &kernels();
+} // namespace BlitConvolution
+} // namespace Oscillator
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_BLITCONVOLUTION_H
@@ -158,23 +158,16 @@ AbstractBlitOscillator::AbstractBlitOscillator(SurgeStorage *storage, Oscillator
 
 void AbstractBlitOscillator::prepare_unison(int voices)
 {
-    auto us = Surge::Oscillator::UnisonSetup<float>(voices);
+    unison = &Surge::Oscillator::UnisonTable::forVoices(voices);
 
-    out_attenuation_inv = us.attenuation_inv();
-    ;
+    out_attenuation_inv = unison->attenuation_inv;
     out_attenuation = 1.0f / out_attenuation_inv;
-
-    detune_bias = us.detuneBias();
-    detune_offset = us.detuneOffset();
-    for (int v = 0; v < voices; ++v)
-    {
-        us.panLaw(v, panL[v], panR[v]);
-    }
 }
 
 ClassicOscillator::ClassicOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
                                      pdata *localcopy)
-    : AbstractBlitOscillator(storage, oscdata, localcopy), charFilt(storage)
+    : AbstractBlitOscillator(storage, oscdata, localcopy), charFilt(storage),
+      blit(Surge::Oscillator::BlitConvolution::kernels())
 {
 }
 
@@ -237,7 +230,7 @@ void ClassicOscillator::init(float pitch, bool is_display, bool nonzero_init_dri
         {
             double drand = (double)storage->rand_01();
             double detune = oscdata->p[co_unison_detune].get_extended(localcopy[id_detune].f) *
-                            (detune_bias * float(i) + detune_offset);
+                            unison->detune[i];
             double st = 0.5 * drand * storage->note_to_pitch_inv_tuningctr(detune);
             oscstate[i] = st;
             syncstate[i] = st;
@@ -298,7 +291,7 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
     if (n_unison > 1)
     {
         detune += oscdata->p[co_unison_detune].get_extended(localcopy[id_detune].f) *
-                  (detune_bias * (float)voice + detune_offset);
+                  unison->detune[voice];
     }
 
     float wf = l_shape.v;
@@ -383,11 +376,8 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
     */
     unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
     unsigned int lipolui16 = (ipos & 0xffff);
-    auto lipol128 = SIMD_MM(setzero_ps)();
-    lipol128 = SIMD_MM(cvtsi32_ss)(lipol128, lipolui16);
-    lipol128 = SIMD_MM(shuffle_ps)(lipol128, lipol128, SIMD_MM_SHUFFLE(0, 0, 0, 0));
+    float lipol = (float)lipolui16;
 
-    int k;
     const float s = 0.99952f;
     float sync = min((float)l_sync.v, (12 + 72 + 72) - pitch);
     float t;
@@ -489,55 +479,29 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
 
     if (stereo)
     {
-        gR = g * panR[voice];
-        g *= panL[voice];
+        gR = g * unison->panR[voice];
+        g *= unison->panL[voice];
     }
 
+    /*
+    ** This is the convolution described above: oscbuffer[bufpos + delay + k] gets g times the
+    ** sinctable for our fractional position, plus lipol times its derivative. See
+    ** BlitConvolution.h for the SIMD kernels which do it.
+    */
+    const float *sinc = &storage->sinctable[m];
+
+    // under heavy load the governor has unison give up the sub-phase interpolation
+    bool coarse = storage->reducedAntiAliasing && n_unison > 1;
+
     if (stereo)
     {
-        auto g128L = SIMD_MM(load_ss)(&g);
-        g128L = SIMD_MM(shuffle_ps)(g128L, g128L, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-        auto g128R = SIMD_MM(load_ss)(&gR);
-        g128R = SIMD_MM(shuffle_ps)(g128R, g128R, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obfL = &oscbuffer[bufpos + k + delay];
-            float *obfR = &oscbufferR[bufpos + k + delay];
-            auto obL = SIMD_MM(loadu_ps)(obfL);
-            auto obR = SIMD_MM(loadu_ps)(obfR);
-            auto st = SIMD_MM(load_ps)(&storage->sinctable[m + k]);
-            auto so = SIMD_MM(load_ps)(&storage->sinctable[m + k + FIRipol_N]);
-            so = SIMD_MM(mul_ps)(so, lipol128);
-            st = SIMD_MM(add_ps)(st, so);
-            obL = SIMD_MM(add_ps)(obL, SIMD_MM(mul_ps)(st, g128L));
-            SIMD_MM(storeu_ps)(obfL, obL);
-            obR = SIMD_MM(add_ps)(obR, SIMD_MM(mul_ps)(st, g128R));
-            SIMD_MM(storeu_ps)(obfR, obR);
-        }
+        auto kernel = coarse ? blit.stereoCoarse : blit.stereo;
+        kernel(&oscbuffer[bufpos + delay], &oscbufferR[bufpos + delay], sinc, lipol, g, gR);
     }
     else
     {
-        /*
-        ** This is SSE for the convolution described above
-        */
-        auto g128 = SIMD_MM(load_ss)(&g);
-        g128 = SIMD_MM(shuffle_ps)(g128, g128, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obf = &oscbuffer[bufpos + k + delay]; // Get buffer[pos + delay + k ]
-            auto ob = SIMD_MM(loadu_ps)(obf);
-            auto st = SIMD_MM(load_ps)(
-                &storage->sinctable[m + k]); // get the sinctable for our fractional position
-            auto so =
-                SIMD_MM(load_ps)(&storage->sinctable[m + k + FIRipol_N]); // get the sinctable deriv
-            so = SIMD_MM(mul_ps)(so, lipol128); // scale the deriv by the lipol fractional time
-            st = SIMD_MM(add_ps)(st, so);       // this is now st = sinctable + dt * dsinctable
-            st = SIMD_MM(mul_ps)(st, g128); // so this is now the convolved difference, g * kernel
-            ob = SIMD_MM(add_ps)(ob, st);   // which we add back onto the buffer
-            SIMD_MM(storeu_ps)(obf, ob);    // and store.
-        }
+        auto kernel = coarse ? blit.monoCoarse : blit.mono;
+        kernel(&oscbuffer[bufpos + delay], sinc, lipol, g);
     }
 
     float olddc = dc_uni[voice];
@@ -27,6 +27,7 @@
 #include "DSPUtils.h"
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
+#include "BlitConvolution.h"
 
 class ClassicOscillator : public AbstractBlitOscillator
 {
@@ -65,6 +66,7 @@ class ClassicOscillator : public AbstractBlitOscillator
     float FMmul_inv;
     float FMphase alignas(16)[BLOCK_SIZE_OS + 4];
     Surge::Oscillator::CharacterFilter<float> charFilt;
+    const Surge::Oscillator::BlitConvolution::Kernels &blit;
 };
 
 #endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_CLASSICOSCILLATOR_H
@@ -140,27 +140,31 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
 
     FeedbackDepth.newValue(abs(fb_val));
 
+    /*
+     * The modulators, the carrier phase and all the depth lags are independent of
+     * the carrier output, so run them first over the whole block. That leaves only
+     * the feedback term and the sine in the serial loop, and without feedback the
+     * sines have no dependency on one another at all. The sums are kept in double and
+     * added in the same order as the one-pass loop so the output is unchanged.
+     */
+    alignas(16) double modsum[BLOCK_SIZE_OS];
+    alignas(16) double fmadd[BLOCK_SIZE_OS];
+    alignas(16) double fbdepth[BLOCK_SIZE_OS];
+
     for (int k = 0; k < BLOCK_SIZE_OS; k++)
     {
         RM1.process();
         RM2.process();
         AM.process();
 
-        double avg = mode == 1 ? ((oldout1 + oldout2) / 2.0) : oldout1;
-        double fb_amt = (fb_val < 0) ? avg * avg * FeedbackDepth.v : avg * FeedbackDepth.v;
-
-        output[k] =
-            phase + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + AbsModDepth.v * AM.r + fb_amt;
+        modsum[k] = phase + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + AbsModDepth.v * AM.r;
+        fbdepth[k] = FeedbackDepth.v;
 
         if (FM)
         {
-            output[k] += FMdepth.v * master_osc[k];
+            fmadd[k] = FMdepth.v * master_osc[k];
         }
 
-        oldout2 = oldout1;
-        oldout1 = sin(output[k]);
-        output[k] = oldout1;
-
         phase += omega;
 
         if (phase > 2.0 * M_PI)
@@ -180,6 +184,50 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
         FeedbackDepth.process();
     }
 
+    bool hasFeedback = fb_val != 0.f;
+
+    for (int k = 0; k < BLOCK_SIZE_OS && !hasFeedback; k++)
+    {
+        hasFeedback = fbdepth[k] != 0.0;
+    }
+
+    if (hasFeedback)
+    {
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            double avg = mode == 1 ? ((oldout1 + oldout2) / 2.0) : oldout1;
+            double fb_amt = (fb_val < 0) ? avg * avg * fbdepth[k] : avg * fbdepth[k];
+
+            output[k] = modsum[k] + fb_amt;
+
+            if (FM)
+            {
+                output[k] += fmadd[k];
+            }
+
+            oldout2 = oldout1;
+            oldout1 = sin(output[k]);
+            output[k] = oldout1;
+        }
+    }
+    else
+    {
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            output[k] = modsum[k];
+
+            if (FM)
+            {
+                output[k] += fmadd[k];
+            }
+
+            output[k] = sin(output[k]);
+        }
+
+        oldout2 = output[BLOCK_SIZE_OS - 2];
+        oldout1 = output[BLOCK_SIZE_OS - 1];
+    }
+
     if (stereo)
     {
         memcpy(outputR, output, sizeof(float) * BLOCK_SIZE_OS);
@@ -131,15 +131,23 @@ void ModernOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
     sync.setRate(0.001 * BLOCK_SIZE_OS);
 
     n_unison = is_display ? 1 : oscdata->p[mo_unison_voices].val.i;
+    n_lanes = (n_unison + 1) & ~1;
 
     auto us = Surge::Oscillator::UnisonSetup<double>(n_unison);
 
-    double atten = us.attenuation();
-
-    for (int u = 0; u < n_unison; ++u)
+    for (int u = 0; u < n_lanes; ++u)
     {
-        unisonOffsets[u] = us.detune(u);
-        us.attenuatedPanLaw(u, mixL[u], mixR[u]);
+        if (u < n_unison)
+        {
+            unisonOffsets[u] = us.detune(u);
+            us.attenuatedPanLaw(u, mixL[u], mixR[u]);
+        }
+        else
+        {
+            unisonOffsets[u] = 0;
+            mixL[u] = 0;
+            mixR[u] = 0;
+        }
 
         phase[u] =
             oscdata->retrigger.val.b || is_display ? pitch_to_dphase(pitch) : storage->rand_01();
@@ -160,6 +168,94 @@ void ModernOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
     charFilt.init(storage->getPatch().character.val.i);
 }
 
+/*
+ * The three generators at a phase (in 0..1) for two unison voices at once: the saw cubic, the
+ * multitype polynomial and the saw cubic offset by the pulse width (which arrives doubled).
+ * The comparisons are masks against 1.0 (or 2.0) so the lanes never branch.
+ */
+template <ModernOscillator::mo_multitypes multitype, bool subOctave>
+inline void dpwGenerators(SIMD_M128D p01, SIMD_M128D pwidth, SIMD_M128D &saw, SIMD_M128D &tri,
+                          SIMD_M128D &sawoff)
+{
+    const auto zero = SIMD_MM(setzero_pd)(), half = SIMD_MM(set1_pd)(0.5),
+               one = SIMD_MM(set1_pd)(1.0), two = SIMD_MM(set1_pd)(2.0),
+               oneOverSix = SIMD_MM(set1_pd)(1.0 / 6.0);
+
+    // Saw component (p^3 - p) / 6
+    auto p = SIMD_MM(mul_pd)(SIMD_MM(sub_pd)(p01, half), two);
+    auto p3 = SIMD_MM(mul_pd)(SIMD_MM(mul_pd)(p, p), p);
+    saw = SIMD_MM(mul_pd)(SIMD_MM(sub_pd)(p3, p), oneOverSix);
+
+    // Remember these ifs are on template params so won't eject branches
+    if (subOctave)
+    {
+        tri = zero;
+    }
+    else
+    {
+        // 1 where p < 0, -1 elsewhere
+        auto mneg = SIMD_MM(sub_pd)(SIMD_MM(and_pd)(SIMD_MM(cmplt_pd)(p, zero), two), one);
+
+        if (multitype == ModernOscillator::momt_square)
+        {
+            auto qp = SIMD_MM(add_pd)(SIMD_MM(mul_pd)(mneg, p), one);
+            tri = SIMD_MM(mul_pd)(SIMD_MM(mul_pd)(p, qp), half);
+        }
+        if (multitype == ModernOscillator::momt_sine)
+        {
+            /*
+             * So...
+             *
+             * -(pos * (-p4 + 2 * p3 - p) + (pos - 1) * (-p4 - 2 * p3 + p)) * oo3
+             *
+             * Alright so p4 is:
+             *
+             * (pos * -p4 + (pos - 1) * -p4) == ( 1 - 2 * pos ) * p4
+             *
+             * p3 is:
+             *
+             * pos * 2 * p3 + (pos - 1) * -2 * p3
+             * pos * 2 * p3 - pos * 2 + p3 + 2 * p3
+             *       2 * p3
+             *
+             * p is:
+             *
+             * pos * -p + (pos - 1) + p
+             * -pos * p + pos * p - p
+             * or -p
+             *
+             * so our term is actually:
+             *
+             * -((1 - 2 * pos) * p4 + 2 * p3 - p) * oo3
+             *
+             * Moreover, pos is 1-signbit so (1 - 2 * pos) == (1 - 2 + 2 * signbit)
+             * or 2 * signbit - 1, which is mneg
+             */
+            auto p4 = SIMD_MM(mul_pd)(p3, p);
+            auto t = SIMD_MM(sub_pd)(
+                SIMD_MM(add_pd)(SIMD_MM(mul_pd)(mneg, p4), SIMD_MM(mul_pd)(two, p3)), p);
+            tri = SIMD_MM(mul_pd)(SIMD_MM(xor_pd)(t, SIMD_MM(set1_pd)(-0.0)),
+                                  SIMD_MM(set1_pd)(1.0 / 3.0));
+        }
+        if (multitype == ModernOscillator::momt_triangle)
+        {
+            auto tp = SIMD_MM(add_pd)(p, half);
+            tp = SIMD_MM(sub_pd)(tp, SIMD_MM(and_pd)(SIMD_MM(cmpgt_pd)(tp, one), two));
+
+            auto Q = SIMD_MM(sub_pd)(one, SIMD_MM(and_pd)(SIMD_MM(cmplt_pd)(tp, zero), two));
+            auto shape = SIMD_MM(sub_pd)(SIMD_MM(set1_pd)(3.0),
+                                         SIMD_MM(mul_pd)(SIMD_MM(mul_pd)(two, Q), tp));
+            tri = SIMD_MM(mul_pd)(
+                SIMD_MM(add_pd)(two, SIMD_MM(mul_pd)(SIMD_MM(mul_pd)(tp, tp), shape)), oneOverSix);
+        }
+    }
+
+    auto pwp = SIMD_MM(add_pd)(p, pwidth); // that's actually pw * 2, but we lag the width * 2
+    pwp = SIMD_MM(sub_pd)(pwp, SIMD_MM(and_pd)(SIMD_MM(cmpgt_pd)(pwp, one), two));
+    sawoff = SIMD_MM(mul_pd)(
+        SIMD_MM(sub_pd)(SIMD_MM(mul_pd)(SIMD_MM(mul_pd)(pwp, pwp), pwp), pwp), oneOverSix);
+}
+
 template <ModernOscillator::mo_multitypes multitype, bool subOctave, bool FM>
 void ModernOscillator::process_sblk(float pitch, float drift, bool stereo, float fmdepthV)
 {
@@ -186,13 +282,29 @@ void ModernOscillator::process_sblk(float pitch, float drift, bool stereo, float
         auto dval = driftLFO[u].next();
         auto lfodetune = drift * dval;
 
-        dpbase[u].newValue(std::min(
+        dpbaseTarget[u] = std::min(
             0.5, pitch_to_dphase_with_absolute_offset(
-                     pitchlag.v + lfodetune + ud * unisonOffsets[u], absOff * unisonOffsets[u])));
-        dspbase[u].newValue(
+                     pitchlag.v + lfodetune + ud * unisonOffsets[u], absOff * unisonOffsets[u]));
+        dspbaseTarget[u] =
             std::min(0.5, pitch_to_dphase_with_absolute_offset(pitchlag.v + lfodetune + sync.v +
                                                                    ud * unisonOffsets[u],
-                                                               absOff * unisonOffsets[u])));
+                                                               absOff * unisonOffsets[u]));
+    }
+
+    // the spare lane, if any, shadows the last voice so it stays well conditioned
+    for (int u = n_unison; u < n_lanes; ++u)
+    {
+        dpbaseTarget[u] = dpbaseTarget[n_unison - 1];
+        dspbaseTarget[u] = dspbaseTarget[n_unison - 1];
+    }
+
+    if (starting)
+    {
+        for (int u = 0; u < n_lanes; ++u)
+        {
+            dpbase[u] = dpbaseTarget[u];
+            dspbase[u] = dspbaseTarget[u];
+        }
     }
 
     auto subdt = drift * driftLFO[0].val();
@@ -219,12 +331,15 @@ void ModernOscillator::process_sblk(float pitch, float drift, bool stereo, float
 
     const double oneOverSix = 1.0 / 6.0;
     // We only use 3 of these
-    double sBuff alignas(16)[4] = {0, 0, 0, 0}, sOffBuff alignas(16)[4] = {0, 0, 0, 0},
-                 triBuff alignas(16)[4] = {0, 0, 0, 0}, phases alignas(16)[4] = {0, 0, 0, 0};
+    double triBuff alignas(16)[4] = {0, 0, 0, 0};
 
     bool subsyncskip =
         oscdata->p[mo_tri_mix].deform_type & ModernOscillator::mo_submask::mo_subskipsync;
 
+    const auto one = SIMD_MM(set1_pd)(1.0), two = SIMD_MM(set1_pd)(2.0);
+    const auto lagRate = SIMD_MM(set1_pd)(unisonLagRate),
+               lagRateInv = SIMD_MM(set1_pd)(1.0 - unisonLagRate);
+
     for (int i = 0; i < BLOCK_SIZE_OS; ++i)
     {
         double vL = 0.0, vR = 0.0;
@@ -235,165 +350,141 @@ void ModernOscillator::process_sblk(float pitch, float drift, bool stereo, float
             fmPhaseShift = FM * fmdepth.v * master_osc[i];
         }
 
-        for (int u = 0; u < n_unison; ++u)
+        const auto pw = SIMD_MM(set1_pd)(pwidth.v);
+        const auto sawm = SIMD_MM(set1_pd)(sawmix.v), trim = SIMD_MM(set1_pd)(trimix.v),
+                   sqrm = SIMD_MM(set1_pd)(sqrmix.v);
+        auto accL = SIMD_MM(setzero_pd)(), accR = SIMD_MM(setzero_pd)();
+
+        for (int u = 0; u < n_lanes; u += 2)
         {
-            auto dp = dpbase[u].v;
-            auto dsp = dspbase[u].v;
-            double pfm = sphase[u];
+            const auto dp = SIMD_MM(load_pd)(dpbase + u);
+            const auto dsp = SIMD_MM(load_pd)(dspbase + u);
+            auto pfm = SIMD_MM(load_pd)(sphase + u);
 
             // Since this is a template param compiler should not eject branch
             if (FM)
             {
-                pfm += fmPhaseShift;
+                double pfmLanes alignas(16)[2];
+                SIMD_MM(store_pd)(pfmLanes, SIMD_MM(add_pd)(pfm, SIMD_MM(set1_pd)(fmPhaseShift)));
 
                 // Have to use floor/ceil here because FM could be big
-                if (pfm > 1)
-                {
-                    pfm -= floor(pfm);
-                }
-                else if (pfm < 0)
-                {
-                    pfm += -ceil(pfm) + 1;
-                }
-            }
-
-            phases[0] = pfm;
-            phases[1] = pfm - dsp + (pfm < dsp);
-            phases[2] = pfm - 2 * dsp + (pfm < 2 * dsp);
-
-            for (int s = 0; s < 3; ++s)
-            {
-                // Saw component (p^3 - p) / 6
-                double p01 = phases[s];
-                double p = (p01 - 0.5) * 2;
-                double p3 = p * p * p;
-                double sawcub = (p3 - p) * oneOverSix;
-
-                sBuff[s] = sawcub;
-
-                /*
-                 * Remember these ifs are now on template params so won't
-                 * eject branches
-                 */
-                if (subOctave)
+                for (auto &l : pfmLanes)
                 {
-                    triBuff[s] = 0.0;
-                }
-                else
-                {
-                    if (multitype == momt_square)
-                    {
-                        // double Q = std::signbit(p) * 2 - 1;
-                        double Q = (p < 0) * 2 - 1;
-                        triBuff[s] = p * (Q * p + 1) * 0.5;
-                    }
-                    if (multitype == ModernOscillator::momt_sine)
+                    if (l > 1)
                     {
-                        // double pos = 1.0 - std::signbit(p);
-                        double modpos = 2.0 * (p < 0) - 1.0;
-                        double p4 = p3 * p;
-                        constexpr double oo3 = 1.0 / 3.0;
-
-                        /*
-                         * So...
-                         *
-                         * -(pos * (-p4 + 2 * p3 - p) + (pos - 1) * (-p4 - 2 * p3 + p)) * oo3
-                         *
-                         * Alright so p4 is:
-                         *
-                         * (pos * -p4 + (pos - 1) * -p4) == ( 1 - 2 * pos ) * p4
-                         *
-                         * p3 is:
-                         *
-                         * pos * 2 * p3 + (pos - 1) * -2 * p3
-                         * pos * 2 * p3 - pos * 2 + p3 + 2 * p3
-                         *       2 * p3
-                         *
-                         * p is:
-                         *
-                         * pos * -p + (pos - 1) + p
-                         * -pos * p + pos * p - p
-                         * or -p
-                         *
-                         * so our term is actually:
-                         *
-                         * -((1 - 2 * pos) * p4 + 2 * p3 - p) * oo3
-                         *
-                         * Moreover, pos is 1-signbit so (1 - 2 * pos) == (1 - 2 + 2 * signbit)
-                         * or 2 * signbit - 1
-                         */
-                        triBuff[s] = -(modpos * p4 + 2 * p3 - p) * oo3;
+                        l -= floor(l);
                     }
-                    if (multitype == ModernOscillator::momt_triangle)
+                    else if (l < 0)
                     {
-                        double tp = p + 0.5;
-                        tp -= (tp > 1.0) * 2;
-
-                        double Q = 1 - (tp < 0) * 2;
-                        triBuff[s] = (2.0 + tp * tp * (3.0 - 2.0 * Q * tp)) * oneOverSix;
+                        l += -ceil(l) + 1;
                     }
                 }
 
-                double pwp = p + pwidth.v; // that's actually pw * 2, but we lag the width * 2
-                pwp += (pwp > 1) * -2;     // (pwp > 1 ? -2 : (pwp < -1 ? 2 : 0));
-                sOffBuff[s] = (pwp * pwp * pwp - pwp) * oneOverSix;
+                pfm = SIMD_MM(load_pd)(pfmLanes);
             }
 
-            double denom = 0.25 / (dsp * dsp);
-            double saw = (sBuff[0] + sBuff[2] - 2.0 * sBuff[1]);
-            double sawoff = (sOffBuff[0] + sOffBuff[2] - 2.0 * sOffBuff[1]);
-            double tri = (triBuff[0] + triBuff[2] - 2.0 * triBuff[1]);
-            double sqr = sawoff - saw;
+            const auto dsp2 = SIMD_MM(mul_pd)(two, dsp);
+            const auto p1 = SIMD_MM(add_pd)(SIMD_MM(sub_pd)(pfm, dsp),
+                                            SIMD_MM(and_pd)(SIMD_MM(cmplt_pd)(pfm, dsp), one));
+            const auto p2 = SIMD_MM(add_pd)(SIMD_MM(sub_pd)(pfm, dsp2),
+                                            SIMD_MM(and_pd)(SIMD_MM(cmplt_pd)(pfm, dsp2), one));
+
+            SIMD_M128D s0, t0, o0, s1, t1, o1, s2, t2, o2;
+            dpwGenerators<multitype, subOctave>(pfm, pw, s0, t0, o0);
+            dpwGenerators<multitype, subOctave>(p1, pw, s1, t1, o1);
+            dpwGenerators<multitype, subOctave>(p2, pw, s2, t2, o2);
+
+            auto secondDifference = [two](auto a, auto b, auto c) {
+                return SIMD_MM(sub_pd)(SIMD_MM(add_pd)(a, c), SIMD_MM(mul_pd)(two, b));
+            };
+
+            const auto denom = SIMD_MM(div_pd)(SIMD_MM(set1_pd)(0.25), SIMD_MM(mul_pd)(dsp, dsp));
+            const auto saw = secondDifference(s0, s1, s2);
+            const auto sawoff = secondDifference(o0, o1, o2);
+            const auto tri = secondDifference(t0, t1, t2);
+            const auto sqr = SIMD_MM(sub_pd)(sawoff, saw);
 
             // super important - you have to mix after differentiating to avoid zipper noise
             // but I can save a multiply by putting it here
-            double res = (sawmix.v * saw + trimix.v * tri + sqrmix.v * sqr) * denom;
-            res = res * (1.0 - sTurnFrac[u]) + sTurnFrac[u] * sTurnVal[u];
-
-            vL += res * mixL[u];
-            vR += res * mixR[u];
+            auto res = SIMD_MM(mul_pd)(
+                SIMD_MM(add_pd)(SIMD_MM(add_pd)(SIMD_MM(mul_pd)(sawm, saw),
+                                                SIMD_MM(mul_pd)(trim, tri)),
+                                SIMD_MM(mul_pd)(sqrm, sqr)),
+                denom);
+            const auto turnFrac = SIMD_MM(load_pd)(sTurnFrac + u);
+            res = SIMD_MM(add_pd)(
+                SIMD_MM(mul_pd)(res, SIMD_MM(sub_pd)(one, turnFrac)),
+                SIMD_MM(mul_pd)(turnFrac, SIMD_MM(load_pd)(sTurnVal + u)));
+
+            accL = SIMD_MM(add_pd)(accL, SIMD_MM(mul_pd)(res, SIMD_MM(load_pd)(mixL + u)));
+            accR = SIMD_MM(add_pd)(accR, SIMD_MM(mul_pd)(res, SIMD_MM(load_pd)(mixR + u)));
 
             // we know phase is in 0,1 and dp is in 0,0.5
-            phase[u] += dp;
-            sphase[u] += dsp;
-            sTurnFrac[u] = 0.0;
+            const auto ph = SIMD_MM(add_pd)(SIMD_MM(load_pd)(phase + u), dp);
+            SIMD_MM(store_pd)(phase + u, ph);
+            SIMD_MM(store_pd)(sphase + u, SIMD_MM(add_pd)(SIMD_MM(load_pd)(sphase + u), dsp));
+            SIMD_MM(store_pd)(sTurnFrac + u, SIMD_MM(setzero_pd)());
 
             // If we try to unbranch this, we get the divide at every tick which is painful
-            if (phase[u] > 1)
+            if (auto turned = SIMD_MM(movemask_pd)(SIMD_MM(cmpgt_pd)(ph, one)))
             {
-                phase[u] -= 1;
+                double resLanes alignas(16)[2];
+                SIMD_MM(store_pd)(resLanes, res);
 
-                if (sReset[u])
+                for (int l = 0; l < 2; ++l)
                 {
-                    sphase[u] = phase[u] * dsp / dp;
-                    sphase[u] -= floor(sphase[u]); // just in case we have a very high sync
-
-                    /*
-                     * So the way we do sync can be a bit aliasy. Basically we move the phase
-                     * forward and then difference over the new phase. WHat we should really do is
-                     * figure out continuous generators with sync in but ugh that's super hard and
-                     * it is late in the 1.9 cycle. So instead what we do is a little compensating
-                     * turnover where we linearly itnerpolate the prior phase forward one sample
-                     * (that is sTurnVal) and then average it into the next sample. Resetting
-                     * sTurnFrac above means this only happens at the turnover sample. Only do this
-                     * if sync is on of course
-                     */
-                    if (sync.v > 1e-4)
-                        sTurnFrac[u] = 0.5; // std::min(std::max(0.1, osp-sphase[u]), 0.9);
-                    sTurnVal[u] = res + (sprior[u] - res) * dsp;
-                }
+                    if (!(turned & (1 << l)))
+                        continue;
 
-                sReset[u] = !sReset[u];
+                    auto v = u + l;
+                    phase[v] -= 1;
+
+                    if (sReset[v])
+                    {
+                        sphase[v] = phase[v] * dspbase[v] / dpbase[v];
+                        sphase[v] -= floor(sphase[v]); // just in case we have a very high sync
+
+                        /*
+                         * So the way we do sync can be a bit aliasy. Basically we move the phase
+                         * forward and then difference over the new phase. WHat we should really
+                         * do is figure out continuous generators with sync in but ugh that's
+                         * super hard and it is late in the 1.9 cycle. So instead what we do is a
+                         * little compensating turnover where we linearly itnerpolate the prior
+                         * phase forward one sample (that is sTurnVal) and then average it into
+                         * the next sample. Resetting sTurnFrac above means this only happens at
+                         * the turnover sample. Only do this if sync is on of course
+                         */
+                        if (sync.v > 1e-4)
+                            sTurnFrac[v] = 0.5; // std::min(std::max(0.1, osp-sphase[v]), 0.9);
+                        sTurnVal[v] = resLanes[l] + (sprior[v] - resLanes[l]) * dspbase[v];
+                    }
+
+                    sReset[v] = !sReset[v];
+                }
             }
 
-            sprior[u] = res;
+            SIMD_MM(store_pd)(sprior + u, res);
 
-            sphase[u] -= (sphase[u] > 1) * 1.0;
+            auto sph = SIMD_MM(load_pd)(sphase + u);
+            sph = SIMD_MM(sub_pd)(sph, SIMD_MM(and_pd)(SIMD_MM(cmpgt_pd)(sph, one), one));
+            SIMD_MM(store_pd)(sphase + u, sph);
 
-            dpbase[u].process();
-            dspbase[u].process();
+            SIMD_MM(store_pd)(dpbase + u,
+                              SIMD_MM(add_pd)(SIMD_MM(mul_pd)(dp, lagRateInv),
+                                              SIMD_MM(mul_pd)(SIMD_MM(load_pd)(dpbaseTarget + u),
+                                                              lagRate)));
+            SIMD_MM(store_pd)(dspbase + u,
+                              SIMD_MM(add_pd)(SIMD_MM(mul_pd)(dsp, lagRateInv),
+                                              SIMD_MM(mul_pd)(SIMD_MM(load_pd)(dspbaseTarget + u),
+                                                              lagRate)));
         }
 
+        double accLanes alignas(16)[2];
+        SIMD_MM(store_pd)(accLanes, accL);
+        vL = accLanes[0] + accLanes[1];
+        SIMD_MM(store_pd)(accLanes, accR);
+        vR = accLanes[0] + accLanes[1];
+
         if (subOctave)
         {
             auto dp = subdpbase.v;
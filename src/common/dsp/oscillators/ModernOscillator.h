@@ -59,7 +59,13 @@ class ModernOscillator : public Oscillator
         {
             phase[u] = 0;
             sphase[u] = 0;
+            sprior[u] = 0;
+            sTurnFrac[u] = 0;
+            sTurnVal[u] = 0;
+            dpbase[u] = dpbaseTarget[u] = 0;
+            dspbase[u] = dspbaseTarget[u] = 0;
             sReset[u] = false;
+            unisonOffsets[u] = 0;
             mixL[u] = 1.f;
             mixR[u] = 1.f;
         }
@@ -75,22 +81,32 @@ class ModernOscillator : public Oscillator
     template <mo_multitypes multitype, bool subOctave, bool FM>
     void process_sblk(float pitch, float drift = 0.f, bool stereo = false, float FMdepth = 0.f);
 
-    lag<double, true> sawmix, trimix, sqrmix, pwidth, sync, dpbase[MAX_UNISON], dspbase[MAX_UNISON],
-        subdpbase, subdpsbase, detune, pitchlag, fmdepth;
+    lag<double, true> sawmix, trimix, sqrmix, pwidth, sync, subdpbase, subdpsbase, detune, pitchlag,
+        fmdepth;
 
     // character filter
     Surge::Oscillator::CharacterFilter<double> charFilt;
     // double charfiltB0 = 0.0, charfiltB1 = 0.0, charfiltA1 = 0.0;
     double priorY_L = 0.0, priorY_R = 0.0, priorX_L = 0.0, priorX_R = 0.0;
 
-    int n_unison = 1;
+    int n_unison = 1, n_lanes = 2;
     bool starting = true;
-    double phase[MAX_UNISON], sphase[MAX_UNISON], sprior[MAX_UNISON], sTurnFrac[MAX_UNISON],
-        sTurnVal[MAX_UNISON], subphase, subsphase;
+
+    /*
+     * The unison voices are rendered two to a register, so their state is kept in lane arrays.
+     * n_lanes rounds n_unison up to whole registers; a spare lane follows the last voice and is
+     * mixed at zero. dpbase and dspbase are one pole lags, stepped like a SurgeLag.
+     */
+    double phase alignas(16)[MAX_UNISON], sphase alignas(16)[MAX_UNISON],
+        sprior alignas(16)[MAX_UNISON], sTurnFrac alignas(16)[MAX_UNISON],
+        sTurnVal alignas(16)[MAX_UNISON], subphase, subsphase;
+    double dpbase alignas(16)[MAX_UNISON], dpbaseTarget alignas(16)[MAX_UNISON],
+        dspbase alignas(16)[MAX_UNISON], dspbaseTarget alignas(16)[MAX_UNISON];
+    static constexpr double unisonLagRate = 0.004; // the SurgeLag default
     bool sReset[MAX_UNISON];
     bool subReset;
     double unisonOffsets[MAX_UNISON];
-    double mixL[MAX_UNISON], mixR[MAX_UNISON];
+    double mixL alignas(16)[MAX_UNISON], mixR alignas(16)[MAX_UNISON];
 
     Surge::Oscillator::DriftLFO driftLFO[MAX_UNISON];
 
@@ -71,6 +71,25 @@ class alignas(16) Oscillator
                         storage->dsamplerate_os_inv);
     }
 
+    // pitch_to_omega for n pitches (at most MAX_UNISON), see SurgeStorage::note_to_pitch_block
+    inline void pitch_to_omega_block(const float *x, double *omega, int n)
+    {
+        float p[MAX_UNISON];
+        storage->note_to_pitch_block(x, p, n);
+        for (int i = 0; i < n; ++i)
+            omega[i] = (2.0 * M_PI * Tunings::MIDI_0_FREQ * p[i] * storage->dsamplerate_os_inv);
+    }
+
+    inline void pitch_to_dphase_with_absolute_offset_block(const float *x, const float *off,
+                                                           double *dphase, int n)
+    {
+        float p[MAX_UNISON];
+        storage->note_to_pitch_block(x, p, n);
+        for (int i = 0; i < n; ++i)
+            dphase[i] = (double)(std::max(1.0, Tunings::MIDI_0_FREQ * p[i] + off[i]) *
+                                 storage->dsamplerate_os_inv);
+    }
+
     virtual void setGate(bool g) { gate = g; }
 
     virtual void handleStreamingMismatches(int streamingRevision, int currentSynthStreamingRevision)
@@ -103,10 +122,10 @@ class AbstractBlitOscillator : public Oscillator
     float pitchmult, pitchmult_inv;
     int bufpos;
     int n_unison;
-    float out_attenuation, out_attenuation_inv, detune_bias, detune_offset;
+    float out_attenuation, out_attenuation_inv;
+    const Surge::Oscillator::UnisonTable *unison{&Surge::Oscillator::UnisonTable::forVoices(1)};
     float oscstate[MAX_UNISON], syncstate[MAX_UNISON], rate[MAX_UNISON];
     Surge::Oscillator::DriftLFO driftLFO[MAX_UNISON];
-    float panL[MAX_UNISON], panR[MAX_UNISON];
     int state[MAX_UNISON];
 };
 
@@ -27,6 +27,9 @@
 #include "DSPUtils.h"
 #include "SurgeStorage.h"
 
+#include <algorithm>
+#include <array>
+
 namespace Surge
 {
 namespace Oscillator
@@ -37,6 +40,67 @@ template <typename valtype>
 using CharacterFilter = sst::basic_blocks::dsp::CharacterFilter<valtype, SurgeStorage>;
 
 template <typename valtype> using UnisonSetup = sst::basic_blocks::dsp::UnisonSetup<valtype>;
+
+/*
+ * The UnisonSetup spread for every voice count, worked out once for the process rather than
+ * at every oscillator init. For each voice: where it sits in the detune spread (-1 to 1, so its
+ * detune is that times the unison detune), its pan position d and its pan law gains 1 - d and
+ * 1 + d, plain and attenuated. The rows are aligned and padded to a whole number of registers,
+ * so the per-voice loops can run along them four voices at a time.
+ */
+struct UnisonTable
+{
+    static constexpr int padded = (MAX_UNISON + 3) & ~3;
+
+    int voices{1};
+    float detuneBias{1}, detuneOffset{0};
+    float attenuation{1}, attenuation_inv{1};
+
+    float detune alignas(16)[padded]{};
+    float pan alignas(16)[padded]{};
+    float panL alignas(16)[padded]{}, panR alignas(16)[padded]{};
+    float attenuatedPanL alignas(16)[padded]{}, attenuatedPanR alignas(16)[padded]{};
+
+    static const UnisonTable &forVoices(int n)
+    {
+        static const auto tables = []() {
+            std::array<UnisonTable, MAX_UNISON + 1> res;
+
+            for (int n = 1; n <= MAX_UNISON; ++n)
+            {
+                auto us = UnisonSetup<float>(n);
+                auto &t = res[n];
+
+                t.voices = n;
+                t.detuneBias = us.detuneBias();
+                t.detuneOffset = us.detuneOffset();
+                t.attenuation = us.attenuation();
+                t.attenuation_inv = us.attenuation_inv();
+
+                for (int v = 0; v < n; ++v)
+                {
+                    t.detune[v] = t.detuneBias * float(v) + t.detuneOffset;
+                    us.panLaw(v, t.panL[v], t.panR[v]);
+                    us.attenuatedPanLaw(v, t.attenuatedPanL[v], t.attenuatedPanR[v]);
+
+                    // the d of UnisonSetup::panLaw
+                    if (n > 1)
+                    {
+                        float d = fabs((float)v - us.mid) / us.mid;
+                        if ((us.odd && (v >= us.half)) != bool(v & 1))
+                            d = -d;
+                        t.pan[v] = d;
+                    }
+                }
+            }
+            res[0] = res[1];
+
+            return res;
+        }();
+
+        return tables[std::clamp(n, 1, MAX_UNISON)];
+    }
+};
 } // namespace Oscillator
 } // namespace Surge
 
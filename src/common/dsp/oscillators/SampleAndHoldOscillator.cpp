@@ -114,7 +114,7 @@ void SampleAndHoldOscillator::init(float pitch, bool is_display, bool nonzero_in
         {
             double drand = (double)storage->rand_01();
             double detune = oscdata->p[shn_unison_detune].get_extended(localcopy[id_detune].f) *
-                            (detune_bias * float(i) + detune_offset);
+                            unison->detune[i];
             double st = drand * storage->note_to_pitch_tuningctr(detune) * 0.5;
             drand = (double)storage->rand_01();
             double ot = drand * storage->note_to_pitch_tuningctr(detune);
@@ -177,7 +177,7 @@ void SampleAndHoldOscillator::convolute(int voice, bool FM, bool stereo)
     float detune = drift * driftLFO[voice].val();
     if (n_unison > 1)
         detune += oscdata->p[shn_unison_detune].get_extended(localcopy[id_detune].f) *
-                  (detune_bias * float(voice) + detune_offset);
+                  unison->detune[voice];
 
     float sub = l_sub.v;
 
@@ -266,8 +266,8 @@ void SampleAndHoldOscillator::convolute(int voice, bool FM, bool stereo)
     g *= out_attenuation;
     if (stereo)
     {
-        gR = g * panR[voice];
-        g *= panL[voice];
+        gR = g * unison->panR[voice];
+        g *= unison->panL[voice];
     }
 
     if (stereo)
@@ -84,19 +84,11 @@ SineOscillator::SineOscillator(SurgeStorage *storage, OscillatorStorage *oscdata
 
 void SineOscillator::prepare_unison(int voices)
 {
-    auto us = Surge::Oscillator::UnisonSetup<float>(voices);
+    unison = &Surge::Oscillator::UnisonTable::forVoices(voices);
 
-    out_attenuation_inv = us.attenuation_inv();
-    ;
+    out_attenuation_inv = unison->attenuation_inv;
     out_attenuation = 1.0f / out_attenuation_inv;
 
-    detune_bias = us.detuneBias();
-    detune_offset = us.detuneOffset();
-    for (int v = 0; v < voices; ++v)
-    {
-        us.panLaw(v, panL[v], panR[v]);
-    }
-
     // normalize to be sample rate independent amount of time for 50 44.1k samples
     dplaying = 1.0 / 50.0 * 44100 / storage->samplerate;
     playingramp[0] = 1;
@@ -104,6 +96,45 @@ void SineOscillator::prepare_unison(int voices)
         playingramp[i] = 0;
 }
 
+void SineOscillator::unison_notes(float pitch, float drift, bool absolute, float *notes)
+{
+    // the detune is the same for every voice, only where each sits in the spread differs
+    auto &ud = oscdata->p[sine_unison_detune];
+
+    if (n_unison > 1 && absolute && ud.absolute)
+    {
+        double spread = ud.get_extended(localcopy[id_detune].f) *
+                        storage->note_to_pitch_inv_ignoring_tuning(std::min(148.f, pitch)) * 16 /
+                        0.9443;
+
+        for (int l = 0; l < n_unison; l++)
+        {
+            double detune = drift * driftLFO[l].next();
+            detune += spread * unison->detune[l];
+            notes[l] = pitch + detune;
+        }
+    }
+    else if (n_unison > 1)
+    {
+        float spread = ud.get_extended(localcopy[id_detune].f);
+
+        for (int l = 0; l < n_unison; l++)
+        {
+            double detune = drift * driftLFO[l].next();
+            detune += spread * unison->detune[l];
+            notes[l] = pitch + detune;
+        }
+    }
+    else
+    {
+        for (int l = 0; l < n_unison; l++)
+        {
+            double detune = drift * driftLFO[l].next();
+            notes[l] = pitch + detune;
+        }
+    }
+}
+
 void SineOscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
 {
     n_unison = limit_range(oscdata->p[sine_unison_voices].val.i, 1, MAX_UNISON);
@@ -605,34 +636,36 @@ template <int mode> inline float singleValueFromSinAndCos(float sinx, float cosx
     return v;
 }
 
-template <int mode, bool stereo, bool FM>
+template <int mode, bool feedback>
+void SineOscillator::process_block_for_mode(float pitch, float drift, bool stereo, bool FM,
+                                            float fmdepth)
+{
+    if (stereo)
+    {
+        if (FM)
+            process_block_internal<mode, true, true, feedback>(pitch, drift, fmdepth);
+        else
+            process_block_internal<mode, true, false, feedback>(pitch, drift, fmdepth);
+    }
+    else
+    {
+        if (FM)
+            process_block_internal<mode, false, true, feedback>(pitch, drift, fmdepth);
+        else
+            process_block_internal<mode, false, false, feedback>(pitch, drift, fmdepth);
+    }
+}
+
+template <int mode, bool stereo, bool FM, bool feedback>
 void SineOscillator::process_block_internal(float pitch, float drift, float fmdepth)
 {
-    double detune;
     double omega[MAX_UNISON];
+    float notes[MAX_UNISON];
 
+    unison_notes(pitch, drift, true, notes);
+    pitch_to_omega_block(notes, omega, n_unison);
     for (int l = 0; l < n_unison; l++)
-    {
-        detune = drift * driftLFO[l].next();
-
-        if (n_unison > 1)
-        {
-            if (oscdata->p[sine_unison_detune].absolute)
-            {
-                detune += oscdata->p[sine_unison_detune].get_extended(
-                              localcopy[oscdata->p[sine_unison_detune].param_id_in_scene].f) *
-                          storage->note_to_pitch_inv_ignoring_tuning(std::min(148.f, pitch)) * 16 /
-                          0.9443 * (detune_bias * float(l) + detune_offset);
-            }
-            else
-            {
-                detune += oscdata->p[sine_unison_detune].get_extended(localcopy[id_detune].f) *
-                          (detune_bias * float(l) + detune_offset);
-            }
-        }
-
-        omega[l] = std::min(M_PI, pitch_to_omega(pitch + detune));
-    }
+        omega[l] = std::min(M_PI, omega[l]);
 
     float fv = 32.0 * M_PI * fmdepth * fmdepth * fmdepth;
 
@@ -698,24 +731,35 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
 
         float fmpd = FM ? FMdepth.v * master_osc[k] : 0.f;
         auto fmpds = SIMD_MM(set1_ps)(fmpd);
-        auto fbv = SIMD_MM(set1_ps)(std::fabs(FB.v));
-        auto fbnegmask = SIMD_MM(cmplt_ps)(SIMD_MM(set1_ps)(FB.v), SIMD_MM(setzero_ps)());
+        auto fbv = SIMD_MM(setzero_ps)(), fbnegmask = SIMD_MM(setzero_ps)();
+
+        if (feedback)
+        {
+            fbv = SIMD_MM(set1_ps)(std::fabs(FB.v));
+            fbnegmask = SIMD_MM(cmplt_ps)(SIMD_MM(set1_ps)(FB.v), SIMD_MM(setzero_ps)());
+        }
 
         for (int u = 0; u < n_unison; u += 4)
         {
             float fph alignas(16)[4] = {(float)phase[u], (float)phase[u + 1], (float)phase[u + 2],
                                         (float)phase[u + 3]};
             auto ph = SIMD_MM(load_ps)(&fph[0]);
-            auto lv0 = SIMD_MM(load_ps)(&lastvalue[0][u]);
             auto lv1 = SIMD_MM(load_ps)(&lastvalue[1][u]);
+            auto x = ph;
+
+            if (feedback)
+            {
+                auto lv0 = SIMD_MM(load_ps)(&lastvalue[0][u]);
+                auto lv = SIMD_MM(add_ps)(SIMD_MM(mul_ps)(lv0, fb0weight),
+                                          SIMD_MM(mul_ps)(lv1, fb1weight));
+                auto fba = SIMD_MM(mul_ps)(
+                    SIMD_MM(add_ps)(SIMD_MM(and_ps)(fbnegmask, SIMD_MM(mul_ps)(lv, lv)),
+                                    SIMD_MM(andnot_ps)(fbnegmask, lv)),
+                    fbv);
+                x = SIMD_MM(add_ps)(x, fba);
+            }
 
-            auto lv =
-                SIMD_MM(add_ps)(SIMD_MM(mul_ps)(lv0, fb0weight), SIMD_MM(mul_ps)(lv1, fb1weight));
-            auto fba =
-                SIMD_MM(mul_ps)(SIMD_MM(add_ps)(SIMD_MM(and_ps)(fbnegmask, SIMD_MM(mul_ps)(lv, lv)),
-                                                SIMD_MM(andnot_ps)(fbnegmask, lv)),
-                                fbv);
-            auto x = SIMD_MM(add_ps)(SIMD_MM(add_ps)(ph, fba), fmpds);
+            x = SIMD_MM(add_ps)(x, fmpds);
 
             x = sst::basic_blocks::dsp::clampToPiRangeSSE(x);
 
@@ -724,8 +768,8 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
 
             auto out_local = valueFromSinAndCosForMode<mode>(sxl, cxl, std::min(n_unison - u, 4));
 
-            auto pl = SIMD_MM(load_ps)(&panL[u]);
-            auto pr = SIMD_MM(load_ps)(&panR[u]);
+            auto pl = SIMD_MM(load_ps)(&unison->panL[u]);
+            auto pr = SIMD_MM(load_ps)(&unison->panR[u]);
 
             auto ui = u >> 2;
             auto ramp = playramp[ui];
@@ -794,33 +838,15 @@ template <int mode>
 void SineOscillator::process_block_legacy(float pitch, float drift, bool stereo, bool FM,
                                           float fmdepth)
 {
-    double detune;
     double omega[MAX_UNISON];
+    float notes[MAX_UNISON];
 
     if (FM)
     {
+        unison_notes(pitch, drift, true, notes);
+        pitch_to_omega_block(notes, omega, n_unison);
         for (int l = 0; l < n_unison; l++)
-        {
-            detune = drift * driftLFO[l].next();
-
-            if (n_unison > 1)
-            {
-                if (oscdata->p[sine_unison_detune].absolute)
-                {
-                    detune += oscdata->p[sine_unison_detune].get_extended(
-                                  localcopy[oscdata->p[sine_unison_detune].param_id_in_scene].f) *
-                              storage->note_to_pitch_inv_ignoring_tuning(std::min(148.f, pitch)) *
-                              16 / 0.9443 * (detune_bias * float(l) + detune_offset);
-                }
-                else
-                {
-                    detune += oscdata->p[sine_unison_detune].get_extended(localcopy[id_detune].f) *
-                              (detune_bias * float(l) + detune_offset);
-                }
-            }
-
-            omega[l] = std::min(M_PI, (double)pitch_to_omega(pitch + detune));
-        }
+            omega[l] = std::min(M_PI, omega[l]);
 
         FMdepth.newValue(fmdepth);
 
@@ -834,8 +860,8 @@ void SineOscillator::process_block_legacy(float pitch, float drift, bool stereo,
                     singleValueFromSinAndCos<mode>(sst::basic_blocks::dsp::fastsin(phase[u]),
                                                    sst::basic_blocks::dsp::fastcos(phase[u]));
 
-                outL += (panL[u] * out_local) * out_attenuation * playingramp[u];
-                outR += (panR[u] * out_local) * out_attenuation * playingramp[u];
+                outL += (unison->panL[u] * out_local) * out_attenuation * playingramp[u];
+                outR += (unison->panR[u] * out_local) * out_attenuation * playingramp[u];
 
                 if (playingramp[u] < 1)
                     playingramp[u] += dplaying;
@@ -859,15 +885,11 @@ void SineOscillator::process_block_legacy(float pitch, float drift, bool stereo,
     }
     else
     {
+        unison_notes(pitch, drift, false, notes);
+        pitch_to_omega_block(notes, omega, n_unison);
         for (int l = 0; l < n_unison; l++)
         {
-            detune = drift * driftLFO[l].next();
-
-            if (n_unison > 1)
-                detune += oscdata->p[sine_unison_detune].get_extended(localcopy[id_detune].f) *
-                          (detune_bias * float(l) + detune_offset);
-
-            omega[l] = std::min(M_PI, (double)pitch_to_omega(pitch + detune));
+            omega[l] = std::min(M_PI, omega[l]);
             sine[l].set_rate(omega[l]);
         }
 
@@ -884,8 +906,8 @@ void SineOscillator::process_block_legacy(float pitch, float drift, bool stereo,
 
                 float out_local = singleValueFromSinAndCos<mode>(sinx, cosx);
 
-                outL += (panL[u] * out_local) * out_attenuation * playingramp[u];
-                outR += (panR[u] * out_local) * out_attenuation * playingramp[u];
+                outL += (unison->panL[u] * out_local) * out_attenuation * playingramp[u];
+                outR += (unison->panR[u] * out_local) * out_attenuation * playingramp[u];
 
                 if (playingramp[u] < 1)
                     playingramp[u] += dplaying;
@@ -967,17 +989,18 @@ void SineOscillator::process_block(float pitch, float drift, bool stereo, bool F
 
     fb_val = oscdata->p[sine_feedback].get_extended(localcopy[id_fb].f);
 
+    /*
+     * Feedback is off in most patches, and once it is and the lag has settled we can skip the
+     * feedback terms in the unison loop altogether
+     */
+    bool useFB = (fb_val != 0.f || FB.v != 0.0);
+
 #define DOCASE(x)                                                                                  \
     case x:                                                                                        \
-        if (stereo)                                                                                \
-            if (FM)                                                                                \
-                process_block_internal<x, true, true>(pitch, drift, fmdepth);                      \
-            else                                                                                   \
-                process_block_internal<x, true, false>(pitch, drift, fmdepth);                     \
-        else if (FM)                                                                               \
-            process_block_internal<x, false, true>(pitch, drift, fmdepth);                         \
+        if (useFB)                                                                                 \
+            process_block_for_mode<x, true>(pitch, drift, stereo, FM, fmdepth);                    \
         else                                                                                       \
-            process_block_internal<x, false, false>(pitch, drift, fmdepth);                        \
+            process_block_for_mode<x, false>(pitch, drift, stereo, FM, fmdepth);                   \
         break;
 
     switch (mode)
@@ -49,7 +49,9 @@ class SineOscillator : public Oscillator
                       bool nonzero_init_drift = true) override;
     virtual void process_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false,
                                float FMdepth = 0.f) override;
-    template <int mode, bool stereo, bool FM>
+    template <int mode, bool feedback>
+    void process_block_for_mode(float pitch, float drift, bool stereo, bool FM, float FMdepth);
+    template <int mode, bool stereo, bool FM, bool feedback>
     void process_block_internal(float pitch, float drift, float FMdepth);
 
     template <int mode>
@@ -70,8 +72,10 @@ class SineOscillator : public Oscillator
     lag<double> FB;
     void prepare_unison(int voices);
     int n_unison;
-    float out_attenuation, out_attenuation_inv, detune_bias, detune_offset;
-    float panL alignas(16)[MAX_UNISON], panR alignas(16)[MAX_UNISON];
+    float out_attenuation, out_attenuation_inv;
+    const Surge::Oscillator::UnisonTable *unison{&Surge::Oscillator::UnisonTable::forVoices(1)};
+    // each voice's note this block, and absolute treats the unison detune in Hz if it's set
+    void unison_notes(float pitch, float drift, bool absolute, float *notes);
 
     int id_mode, id_fb, id_fmlegacy, id_detune;
     float lastvalue alignas(16)[2][MAX_UNISON];
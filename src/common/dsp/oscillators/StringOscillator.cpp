@@ -90,42 +90,65 @@ std::string stringosc_excitation_name(int i)
 
 StringOscillator::~StringOscillator()
 {
-    if (storage && !ownDelayLines)
-    {
-        if (delayLine[0])
-            storage->memoryPools->stringDelayLines.returnItem(delayLine[0]);
-        if (delayLine[1])
-            storage->memoryPools->stringDelayLines.returnItem(delayLine[1]);
-    }
-    else
-    {
-        if (delayLine[0])
-            delete delayLine[0];
-        if (delayLine[1])
-            delete delayLine[1];
-    }
-};
+    releaseDelayLines();
 
-void StringOscillator::init(float pitch, bool is_display, bool nzi)
+    if (storage)
+        storage->audio_in_clients--;
+}
+
+void StringOscillator::releaseDelayLines()
 {
+    auto release = [this](auto &lines, auto *pool) {
+        for (auto &l : lines)
+        {
+            if (!l)
+                continue;
+
+            if (pool && !ownDelayLines)
+                pool->returnItem(l);
+            else
+                delete l;
+            l = nullptr;
+        }
+    };
+
+    auto pools = storage ? storage->memoryPools.get() : nullptr;
+    release(delayLine, pools ? &pools->stringDelayLines : nullptr);
+    release(shortDelayLine, pools ? &pools->shortStringDelayLines : nullptr);
+}
+
+void StringOscillator::acquireDelayLines(bool useShort, bool is_display)
+{
+    if (delayLine[0] && !useShort && ownDelayLines == is_display)
+        return;
+    if (shortDelayLine[0] && useShort && ownDelayLines == is_display)
+        return;
+
+    releaseDelayLines();
+
+    useShortLines = useShort;
+    ownDelayLines = is_display;
+
     // fixme - alloc in is_display but for now just deal with the race
-    // delayLine[0] = std::make_unique<SSESincDelayLine<16384>>();
-    // delayLine[1] = std::make_unique<SSESincDelayLine<16384>>();
-    if (is_display)
-    {
-        ownDelayLines = true;
-        delayLine[0] = new SSESincDelayLine<16384>(storage->sinctable);
-        delayLine[1] = new SSESincDelayLine<16384>(storage->sinctable);
-    }
+    auto acquire = [this, is_display](auto &lines, auto &pool) {
+        using line_t = std::remove_pointer_t<std::decay_t<decltype(lines[0])>>;
+        for (auto &l : lines)
+        {
+            if (is_display)
+                l = new line_t(storage->sinctable);
+            else
+                l = pool.getItem(storage->sinctable);
+        }
+    };
+
+    if (useShortLines)
+        acquire(shortDelayLine, storage->memoryPools->shortStringDelayLines);
     else
-    {
-        ownDelayLines = false;
-        if (!delayLine[0])
-            delayLine[0] = storage->memoryPools->stringDelayLines.getItem(storage->sinctable);
-        if (!delayLine[1])
-            delayLine[1] = storage->memoryPools->stringDelayLines.getItem(storage->sinctable);
-    }
+        acquire(delayLine, storage->memoryPools->stringDelayLines);
+}
 
+void StringOscillator::init(float pitch, bool is_display, bool nzi)
+{
     memset((void *)dustBuffer, 0, 2 * (BLOCK_SIZE_OS) * sizeof(float));
 
     id_exciterlvl = oscdata->p[str_exciter_level].param_id_in_scene;
@@ -170,8 +193,23 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
                                            storage->note_to_pitch_inv(pitch2_t));
     }
 
-    pitchmult_inv = std::min(pitchmult_inv, (delayLine[0]->comb_size - 100) * 1.0);
-    pitchmult2_inv = std::min(pitchmult2_inv, (delayLine[0]->comb_size - 100) * 1.0);
+    /*
+     * The short lines do if this note still fits them bent down by the headroom and with
+     * the exciter oversampled. Past that the tap clamps to the line, just as the long lines
+     * always have at the bottom of the range. FM can stretch the tap by far more than any
+     * bend, so an FM scene always gets the long lines.
+     */
+    auto sc = oscdata->p[0].scene - 1;
+    bool needsLongLines =
+        (sc < 0 || sc >= n_scenes || storage->getPatch().scene[sc].fm_switch.val.i != fm_off);
+    auto lowestTap = std::max(pitchmult_inv, pitchmult2_inv) * max_oversample *
+                     std::pow(2.0, shortLineHeadroom / 12.0);
+
+    acquireDelayLines(!needsLongLines && lowestTap < shortLineSize - 100, is_display);
+
+    auto maxTap = (useShortLines ? shortLineSize : longLineSize) - 100.0;
+    pitchmult_inv = std::min(pitchmult_inv, maxTap);
+    pitchmult2_inv = std::min(pitchmult2_inv, maxTap);
 
     noiseLp.coeff_LP2B(noiseLp.calc_omega(0) * OSC_OVERSAMPLING, 0.9);
     for (int i = 0; i < 3; ++i)
@@ -186,9 +224,12 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
     // we need a big prefill to support the delay line for FM
     auto prefill = (int)floor(10 * std::max(pitchmult_inv, pitchmult2_inv) * getOversampleLevel());
 
+    withDelayLines([](auto &lines) {
+        for (auto &l : lines)
+            l->clear();
+    });
     for (int i = 0; i < 2; ++i)
     {
-        delayLine[i]->clear();
         driftLFO[i].init(nzi);
     }
 
@@ -364,16 +405,20 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
         lp.process_sample(dlv[0], dlv[1], lpt[0], lpt[1]);
         hp.process_sample(dlv[0], dlv[1], hpt[0], hpt[1]);
 
+        withDelayLines([&](auto &lines) {
+            for (int t = 0; t < 2; ++t)
+            {
+                lines[t]->write(tone.v < 0 ? lpt[t] : hpt[t]);
+            }
+        });
+    }
+
+    withDelayLines([this](auto &lines) {
         for (int t = 0; t < 2; ++t)
         {
-            delayLine[t]->write(tone.v < 0 ? lpt[t] : hpt[t]);
+            priorSample[t] = lines[t]->buffer[(lines[t]->wp - 1) & lines[t]->comb_size];
         }
-    }
-
-    for (int t = 0; t < 2; ++t)
-    {
-        priorSample[t] = delayLine[t]->buffer[(delayLine[t]->wp - 1) & delayLine[t]->comb_size];
-    }
+    });
 
     charFilt.init(storage->getPatch().character.val.i);
 }
@@ -479,22 +524,22 @@ void StringOscillator::process_block(float pitch, float drift, bool stereo, bool
         {                                                                                          \
             if (oss & StringOscillator::os_onex)                                                   \
             {                                                                                      \
-                process_block_internal<true, m, 1>(pitch, drift, stereo, fmdepthV);                \
+                process_block_internal<true, m, 1>(pitch, drift, stereo, fmdepthV, lines);         \
             }                                                                                      \
             else                                                                                   \
             {                                                                                      \
-                process_block_internal<true, m, 2>(pitch, drift, stereo, fmdepthV);                \
+                process_block_internal<true, m, 2>(pitch, drift, stereo, fmdepthV, lines);         \
             }                                                                                      \
         }                                                                                          \
         else                                                                                       \
         {                                                                                          \
             if (oss & StringOscillator::os_onex)                                                   \
             {                                                                                      \
-                process_block_internal<false, m, 1>(pitch, drift, stereo, fmdepthV);               \
+                process_block_internal<false, m, 1>(pitch, drift, stereo, fmdepthV, lines);        \
             }                                                                                      \
             else                                                                                   \
             {                                                                                      \
-                process_block_internal<false, m, 2>(pitch, drift, stereo, fmdepthV);               \
+                process_block_internal<false, m, 2>(pitch, drift, stereo, fmdepthV, lines);        \
             }                                                                                      \
         }                                                                                          \
         break;
@@ -502,32 +547,35 @@ void StringOscillator::process_block(float pitch, float drift, bool stereo, bool
     auto mode = (exciter_modes)oscdata->p[str_exciter_mode].val.i;
     auto oss = oscdata->p[str_exciter_level].deform_type & StringOscillator::os_all;
 
-    switch (mode)
-    {
-        P(burst_noise)
-        P(burst_pink_noise)
-        P(burst_sine)
-        P(burst_tri)
-        P(burst_ramp)
-        P(burst_square)
-        P(burst_sweep)
-
-        P(constant_noise)
-        P(constant_pink_noise)
-        P(constant_sine)
-        P(constant_tri)
-        P(constant_ramp)
-        P(constant_square)
-        P(constant_sweep)
-
-        P(constant_audioin)
-    }
+    withDelayLines([&](auto &lines) {
+        switch (mode)
+        {
+            P(burst_noise)
+            P(burst_pink_noise)
+            P(burst_sine)
+            P(burst_tri)
+            P(burst_ramp)
+            P(burst_square)
+            P(burst_sweep)
+
+            P(constant_noise)
+            P(constant_pink_noise)
+            P(constant_sine)
+            P(constant_tri)
+            P(constant_ramp)
+            P(constant_square)
+            P(constant_sweep)
+
+            P(constant_audioin)
+        }
+    });
 
 #undef P
 }
 
-template <bool FM, StringOscillator::exciter_modes mode, int OS>
-void StringOscillator::process_block_internal(float pitch, float drift, bool stereo, float fmdepthV)
+template <bool FM, StringOscillator::exciter_modes mode, int OS, typename DL>
+void StringOscillator::process_block_internal(float pitch, float drift, bool stereo, float fmdepthV,
+                                              DL &lines)
 {
     auto lfodetune = drift * driftLFO[0].next();
     auto pitchadj = pitchAdjustmentForStiffness();
@@ -585,8 +633,8 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
     dp1 /= OS;
     dp2 /= OS;
 
-    pitchmult_inv = std::min(pitchmult_inv, (delayLine[0]->comb_size - 100) * 1.0);
-    pitchmult2_inv = std::min(pitchmult2_inv, (delayLine[0]->comb_size - 100) * 1.0);
+    pitchmult_inv = std::min(pitchmult_inv, (lines[0]->comb_size - 100) * 1.0);
+    pitchmult2_inv = std::min(pitchmult2_inv, (lines[0]->comb_size - 100) * 1.0);
 
     tap[0].newValue(pitchmult_inv);
     tap[1].newValue(pitchmult2_inv);
@@ -708,13 +756,13 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
             switch (interp_mode)
             {
             case StringOscillator::interp_sinc:
-                val[t] = delayLine[t]->read(v);
+                val[t] = lines[t]->read(v);
                 break;
             case StringOscillator::interp_lin:
-                val[t] = delayLine[t]->readLinear(v);
+                val[t] = lines[t]->readLinear(v);
                 break;
             case StringOscillator::interp_zoh:
-                val[t] = delayLine[t]->readZOH(v);
+                val[t] = lines[t]->readZOH(v);
                 break;
             }
 
@@ -813,7 +861,7 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
 
             if (fabs(filtv) < 1e-16)
                 filtv = 0;
-            delayLine[t]->write(filtv * feedback[t].v);
+            lines[t]->write(filtv * feedback[t].v);
         }
 
         float out = val[0] + t2level.v * (val[1] - val[0]);
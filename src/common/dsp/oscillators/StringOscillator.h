@@ -89,6 +89,9 @@ class StringOscillator : public Oscillator
     StringOscillator(SurgeStorage *s, OscillatorStorage *o, pdata *p)
         : Oscillator(s, o, p), charFilt(s), lp(s), hp(s), noiseLp(s), halfband(6, true)
     {
+        // for the audio in exciter
+        if (storage)
+            storage->audio_in_clients++;
     }
 
     ~StringOscillator();
@@ -100,8 +103,8 @@ class StringOscillator : public Oscillator
     virtual void process_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false,
                                float FMdepth = 0.f) override;
 
-    template <bool FM, exciter_modes mode, int OS>
-    void process_block_internal(float pitch, float drift, bool stereo, float FMdepth);
+    template <bool FM, exciter_modes mode, int OS, typename DL>
+    void process_block_internal(float pitch, float drift, bool stereo, float FMdepth, DL &lines);
 
     float phase1 = 0, phase2 = 0;
 
@@ -109,8 +112,29 @@ class StringOscillator : public Oscillator
 
     lag<float, true> examp, tap[2], t2level, feedback[2], tone, fmdepth;
 
-    std::array<SSESincDelayLine<16384> *, 2> delayLine{nullptr, nullptr};
-    bool ownDelayLines{false};
+    /*
+     * A delay line long enough for the bottom of the keyboard is 64k apiece, but most
+     * strings play well above that, so notes which fit use the short lines instead.
+     * Exactly one of delayLine and shortDelayLine is populated.
+     */
+    static constexpr size_t longLineSize = 16384, shortLineSize = 4096;
+    // How far below the starting note a voice on the short lines can bend before clamping
+    static constexpr float shortLineHeadroom = 24.f;
+
+    template <size_t N> using delayLines_t = std::array<SSESincDelayLine<N> *, 2>;
+    delayLines_t<longLineSize> delayLine{nullptr, nullptr};
+    delayLines_t<shortLineSize> shortDelayLine{nullptr, nullptr};
+    bool ownDelayLines{false}, useShortLines{false};
+
+    template <typename F> void withDelayLines(F &&f)
+    {
+        if (useShortLines)
+            f(shortDelayLine);
+        else
+            f(delayLine);
+    }
+    void acquireDelayLines(bool useShort, bool is_display);
+    void releaseDelayLines();
     float priorSample[2] = {0, 0};
     Surge::Oscillator::DriftLFO driftLFO[2];
     Surge::Oscillator::CharacterFilter<float> charFilt;
@@ -22,6 +22,7 @@
 
 #include "TwistOscillator.h"
 #include "DebugHelpers.h"
+#include "SurgeMemoryPools.h"
 
 #define TEST
 #ifndef _MSC_VER
@@ -280,15 +281,25 @@ TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscda
                                  pdata *localcopy)
     : Oscillator(storage, oscdata, localcopy), charFilt(storage)
 {
-    lancRes = std::make_unique<resamp_t>(48000, storage->dsamplerate_os);
+}
+
+TwistOscillator::PlaitsState::PlaitsState()
+{
     voice = std::make_unique<plaits::Voice>();
-    shared_buffer = new char[16384];
-    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer, 16384);
+    sharedBuffer = std::make_unique<char[]>(16384);
+    alloc = std::make_unique<stmlib::BufferAllocator>(sharedBuffer.get(), 16384);
     patch = std::make_unique<plaits::Patch>();
     mod = std::make_unique<plaits::Modulations>();
+}
+
+TwistOscillator::PlaitsState::~PlaitsState() = default;
+
+void TwistOscillator::PlaitsState::prepare(SurgeStorage *storage)
+{
+    lancRes.emplace(48000, storage->dsamplerate_os);
 
     // FM downsampling with a linear interpolator is absolutely fine
-    fmDownSampler = std::make_unique<resamp_t>(storage->dsamplerate_os, 48000);
+    fmDownSampler.emplace(storage->dsamplerate_os, 48000);
 }
 
 float TwistOscillator::tuningAwarePitch(float pitch)
@@ -311,13 +322,35 @@ float TwistOscillator::tuningAwarePitch(float pitch)
 
 void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 {
-    voice->Init(alloc.get());
+    if (!state)
+    {
+        if (is_display)
+        {
+            ownState = true;
+            state = new PlaitsState();
+        }
+        else
+        {
+            ownState = false;
+            state = storage->memoryPools->twistStates.getItem();
+        }
+    }
+    state->prepare(storage);
+
+    voice = state->voice.get();
+    patch = state->patch.get();
+    mod = state->mod.get();
+    lancRes = &*state->lancRes;
+    fmDownSampler = &*state->fmDownSampler;
+
+    // plaits only initialises the engine this voice selects, on its first render
+    voice->Init(state->alloc.get());
 
     charFilt.init(storage->getPatch().character.val.i);
 
     float tpitch = tuningAwarePitch(pitch);
-    memset((void *)patch.get(), 0, sizeof(plaits::Patch));
-    memset((void *)mod.get(), 0, sizeof(plaits::Modulations));
+    memset((void *)patch, 0, sizeof(plaits::Patch));
+    memset((void *)mod, 0, sizeof(plaits::Modulations));
 
     driftLFO.init(nonzero_drift);
 
@@ -341,8 +374,13 @@ void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 }
 TwistOscillator::~TwistOscillator()
 {
-    if (shared_buffer)
-        delete[] shared_buffer;
+    if (!state)
+        return;
+
+    if (ownState)
+        delete state;
+    else
+        storage->memoryPools->twistStates.returnItem(state);
 }
 
 template <bool FM, bool throwaway>
@@ -20,6 +20,9 @@
  * https://github.com/surge-synthesizer/surge
  */
 
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+
 /*
  * What's our samplerate strategy
  */
@@ -27,6 +30,7 @@
 
 #include "OscillatorBase.h"
 #include <memory>
+#include <optional>
 #include "basic_dsp.h"
 #include "DSPUtils.h"
 #include "OscillatorCommonFunctions.h"
@@ -82,11 +86,37 @@ class TwistOscillator : public Oscillator
         return clamp01((localcopy[oscdata->p[ps].param_id_in_scene].f + 1) * 0.5f);
     }
 
-    std::unique_ptr<plaits::Voice> voice;
-    std::unique_ptr<plaits::Patch> patch;
-    std::unique_ptr<plaits::Modulations> mod;
-    std::unique_ptr<stmlib::BufferAllocator> alloc;
-    char *shared_buffer{nullptr};
+    using resamp_t = sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>;
+
+    /*
+     * The plaits voice, its RAM and the two resamplers come to a couple of hundred k,
+     * and used to be allocated on every note on. Playing voices now take one of these
+     * from SurgeMemoryPools and hand it back when they finish, so a recycled state is
+     * usually still warm in cache; the display oscillator owns its own.
+     */
+    struct PlaitsState
+    {
+        PlaitsState();
+        ~PlaitsState();
+
+        // Start the resamplers over at the current sample rate, as a new oscillator would
+        void prepare(SurgeStorage *storage);
+
+        std::unique_ptr<plaits::Voice> voice;
+        std::unique_ptr<plaits::Patch> patch;
+        std::unique_ptr<plaits::Modulations> mod;
+        std::unique_ptr<stmlib::BufferAllocator> alloc;
+        std::unique_ptr<char[]> sharedBuffer;
+        std::optional<resamp_t> lancRes, fmDownSampler;
+    };
+    PlaitsState *state{nullptr};
+    bool ownState{false};
+
+    // These all point into state
+    plaits::Voice *voice{nullptr};
+    plaits::Patch *patch{nullptr};
+    plaits::Modulations *mod{nullptr};
+    resamp_t *lancRes{nullptr}, *fmDownSampler{nullptr};
 
     // Keep this here for now even if using lanczos since I'm using SRC for FM still
     float fmlagbuffer[BLOCK_SIZE_OS << 1];
@@ -94,9 +124,6 @@ class TwistOscillator : public Oscillator
 
     bool useCorrectLPGBlockSize{false}; // See #6760
 
-    using resamp_t = sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>;
-    std::unique_ptr<resamp_t> lancRes, fmDownSampler;
-
     float carryover[BLOCK_SIZE_OS][2];
     int carrover_size = 0;
 
@@ -105,3 +132,5 @@ class TwistOscillator : public Oscillator
     Surge::Oscillator::DriftLFO driftLFO;
     Surge::Oscillator::CharacterFilter<float> charFilt;
 };
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
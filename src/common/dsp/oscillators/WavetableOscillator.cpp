@@ -33,7 +33,8 @@ const float hpf_cycle_loss = 0.99f;
 
 WavetableOscillator::WavetableOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
                                          pdata *localcopy, pdata *localcopyUnmod)
-    : AbstractBlitOscillator(storage, oscdata, localcopy)
+    : AbstractBlitOscillator(storage, oscdata, localcopy),
+      blit(Surge::Oscillator::BlitConvolution::kernels())
 {
     unmodulatedLocalcopy = localcopyUnmod;
 }
@@ -261,14 +262,64 @@ void WavetableOscillator::processSamplesForDisplay(float *samples, int size, boo
     // saturation
 };
 
-void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
+void WavetableOscillator::selectBlockMipmap()
 {
-    float block_pos = oscstate[voice] * BLOCK_SIZE_OS_INV * pitchmult_inv;
+    int ts = oscdata->wt.size;
+    float a = oscdata->wt.dt * pitchmult_inv;
+
+    const float wtbias = 1.8f;
+
+    blockMipmap = 0;
+
+    if ((a < 0.015625 * wtbias) && (ts >= 128))
+        blockMipmap = 6;
+    else if ((a < 0.03125 * wtbias) && (ts >= 64))
+        blockMipmap = 5;
+    else if ((a < 0.0625 * wtbias) && (ts >= 32))
+        blockMipmap = 4;
+    else if ((a < 0.125 * wtbias) && (ts >= 16))
+        blockMipmap = 3;
+    else if ((a < 0.25 * wtbias) && (ts >= 8))
+        blockMipmap = 2;
+    else if ((a < 0.5 * wtbias) && (ts >= 4))
+        blockMipmap = 1;
+
+    blockMipmap = oscdata->wt.builtMipmap(blockMipmap);
+
+    blockMipmapOfs = 0;
+    for (int i = 0; i < blockMipmap; i++)
+        blockMipmapOfs += (ts >> i);
+}
 
+void WavetableOscillator::prepareUnisonVoice(int voice)
+{
+    // the drift LFO has stepped for this block, so the voice's detune is fixed until the next
     double detune = drift * driftLFO[voice].val();
     if (n_unison > 1)
         detune += oscdata->p[wt_unison_detune].get_extended(localcopy[id_detune].f) *
-                  (detune_bias * float(voice) + detune_offset);
+                  unison->detune[voice];
+
+    // time until next statechange
+    float tempt;
+    if (oscdata->p[wt_unison_detune].absolute)
+    {
+        // See the comment in ClassicOscillator.cpp at the absolute treatment
+        tempt = storage->note_to_pitch_inv_ignoring_tuning(
+            detune * storage->note_to_pitch_inv_ignoring_tuning(pitch_t) * 16 / 0.9443);
+        if (tempt < 0.1)
+            tempt = 0.1;
+    }
+    else
+    {
+        tempt = storage->note_to_pitch_inv_tuningctr(detune);
+    }
+
+    unisonTime[voice] = tempt;
+}
+
+void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
+{
+    float block_pos = oscstate[voice] * BLOCK_SIZE_OS_INV * pitchmult_inv;
 
     const float p24 = (1 << 24);
     unsigned int ipos;
@@ -320,29 +371,8 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
             }
         }
 
-        int ts = oscdata->wt.size;
-        float a = oscdata->wt.dt * pitchmult_inv;
-
-        const float wtbias = 1.8f;
-
-        mipmap[voice] = 0;
-
-        if ((a < 0.015625 * wtbias) && (ts >= 128))
-            mipmap[voice] = 6;
-        else if ((a < 0.03125 * wtbias) && (ts >= 64))
-            mipmap[voice] = 5;
-        else if ((a < 0.0625 * wtbias) && (ts >= 32))
-            mipmap[voice] = 4;
-        else if ((a < 0.125 * wtbias) && (ts >= 16))
-            mipmap[voice] = 3;
-        else if ((a < 0.25 * wtbias) && (ts >= 8))
-            mipmap[voice] = 2;
-        else if ((a < 0.5 * wtbias) && (ts >= 4))
-            mipmap[voice] = 1;
-
-        mipmap_ofs[voice] = 0;
-        for (int i = 0; i < mipmap[voice]; i++)
-            mipmap_ofs[voice] += (ts >> i);
+        mipmap[voice] = blockMipmap;
+        mipmap_ofs[voice] = blockMipmapOfs;
     }
 
     // generate pulse
@@ -353,28 +383,14 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
 
     unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
     unsigned int lipolui16 = (ipos & 0xffff);
-    auto lipol128 = SIMD_MM(setzero_ps)();
-    lipol128 = SIMD_MM(cvtsi32_ss)(lipol128, lipolui16);
-    lipol128 = SIMD_MM(shuffle_ps)(lipol128, lipol128, SIMD_MM_SHUFFLE(0, 0, 0, 0));
+    float lipol = (float)lipolui16;
 
     float g, gR;
     int wt_inc = (1 << mipmap[voice]);
     float dt = (oscdata->wt.dt) * wt_inc;
 
     // add time until next statechange
-    float tempt;
-    if (oscdata->p[wt_unison_detune].absolute)
-    {
-        // See the comment in ClassicOscillator.cpp at the absolute treatment
-        tempt = storage->note_to_pitch_inv_ignoring_tuning(
-            detune * storage->note_to_pitch_inv_ignoring_tuning(pitch_t) * 16 / 0.9443);
-        if (tempt < 0.1)
-            tempt = 0.1;
-    }
-    else
-    {
-        tempt = storage->note_to_pitch_inv_tuningctr(detune);
-    }
+    float tempt = unisonTime[voice];
 
     float t;
     float xt = ((float)state[voice] + 0.5f) * dt;
@@ -411,50 +427,24 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
     g *= out_attenuation;
     if (stereo)
     {
-        gR = g * panR[voice];
-        g *= panL[voice];
+        gR = g * unison->panR[voice];
+        g *= unison->panL[voice];
     }
 
+    const float *sinc = &storage->sinctable[m];
+
+    // under heavy load the governor has unison give up the sub-phase interpolation
+    bool coarse = storage->reducedAntiAliasing && n_unison > 1;
+
     if (stereo)
     {
-        auto g128L = SIMD_MM(load_ss)(&g);
-        g128L = SIMD_MM(shuffle_ps)(g128L, g128L, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-        auto g128R = SIMD_MM(load_ss)(&gR);
-        g128R = SIMD_MM(shuffle_ps)(g128R, g128R, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-
-        for (int k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obfL = &oscbuffer[bufpos + k + delay];
-            float *obfR = &oscbufferR[bufpos + k + delay];
-            auto obL = SIMD_MM(loadu_ps)(obfL);
-            auto obR = SIMD_MM(loadu_ps)(obfR);
-            auto st = SIMD_MM(load_ps)(&storage->sinctable[m + k]);
-            auto so = SIMD_MM(load_ps)(&storage->sinctable[m + k + FIRipol_N]);
-            so = SIMD_MM(mul_ps)(so, lipol128);
-            st = SIMD_MM(add_ps)(st, so);
-            obL = SIMD_MM(add_ps)(obL, SIMD_MM(mul_ps)(st, g128L));
-            SIMD_MM(storeu_ps)(obfL, obL);
-            obR = SIMD_MM(add_ps)(obR, SIMD_MM(mul_ps)(st, g128R));
-            SIMD_MM(storeu_ps)(obfR, obR);
-        }
+        auto kernel = coarse ? blit.stereoCoarse : blit.stereo;
+        kernel(&oscbuffer[bufpos + delay], &oscbufferR[bufpos + delay], sinc, lipol, g, gR);
     }
     else
     {
-        auto g128 = SIMD_MM(load_ss)(&g);
-        g128 = SIMD_MM(shuffle_ps)(g128, g128, SIMD_MM_SHUFFLE(0, 0, 0, 0));
-
-        for (int k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obf = &oscbuffer[bufpos + k + delay];
-            auto ob = SIMD_MM(loadu_ps)(obf);
-            auto st = SIMD_MM(load_ps)(&storage->sinctable[m + k]);
-            auto so = SIMD_MM(load_ps)(&storage->sinctable[m + k + FIRipol_N]);
-            so = SIMD_MM(mul_ps)(so, lipol128);
-            st = SIMD_MM(add_ps)(st, so);
-            st = SIMD_MM(mul_ps)(st, g128);
-            ob = SIMD_MM(add_ps)(ob, st);
-            SIMD_MM(storeu_ps)(obf, ob);
-        }
+        auto kernel = coarse ? blit.monoCoarse : blit.mono;
+        kernel(&oscbuffer[bufpos + delay], sinc, lipol, g);
     }
 
     rate[voice] = t;
@@ -552,10 +542,9 @@ float WavetableOscillator::deformLegacy(float block_pos, int voice)
 
     // that 1 - nointerp makes sure we don't read the table off memory, keeps us bounded
     // and since it gets multiplied by lipol, in morph mode ends up being zero - no sweat!
-    return (oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid][state[voice]] *
-            (1.f - lipol)) +
-           (oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid + 1 - nointerp][state[voice]] *
-            lipol);
+    auto &wt = oscdata->wt;
+    return (wt.sampleAt(mipmap[voice], tableid, state[voice]) * (1.f - lipol)) +
+           (wt.sampleAt(mipmap[voice], tableid + 1 - nointerp, state[voice]) * lipol);
 }
 
 float WavetableOscillator::deformContinuous(float block_pos, int voice)
@@ -568,10 +557,9 @@ float WavetableOscillator::deformContinuous(float block_pos, int voice)
 
     float interpolationProc = (tblip_ipol - tempTableId) * (1 - nointerp);
 
-    return (oscdata->wt.TableF32WeakPointers[mipmap[voice]][tempTableId][state[voice]] *
-            (1.f - interpolationProc)) +
-           (oscdata->wt.TableF32WeakPointers[mipmap[voice]][targetTableId][state[voice]] *
-            interpolationProc);
+    auto &wt = oscdata->wt;
+    return (wt.sampleAt(mipmap[voice], tempTableId, state[voice]) * (1.f - interpolationProc)) +
+           (wt.sampleAt(mipmap[voice], targetTableId, state[voice]) * interpolationProc);
 }
 
 float WavetableOscillator::deformMorph(float block_pos, int voice)
@@ -584,9 +572,8 @@ float WavetableOscillator::deformMorph(float block_pos, int voice)
         float proc = frames[i] - floor(frames[i]);
 
         int d = min((int)(actualFrame + 1), (int)(oscdata->wt.n_tables - 1));
-        frames[i] = oscdata->wt.TableF32WeakPointers[mipmap[voice]][actualFrame][state[voice]] *
-                        (1.f - proc) +
-                    oscdata->wt.TableF32WeakPointers[mipmap[voice]][d][state[voice]] * (proc);
+        frames[i] = oscdata->wt.sampleAt(mipmap[voice], actualFrame, state[voice]) * (1.f - proc) +
+                    oscdata->wt.sampleAt(mipmap[voice], d, state[voice]) * (proc);
     }
 
     return frames[0] * (1.f - block_pos) + frames[1] * block_pos;
@@ -688,11 +675,14 @@ void WavetableOscillator::process_block(float pitch0, float drift, bool stereo,
         }
     }
 
+    selectBlockMipmap();
+
     if (FM)
     {
         for (int l = 0; l < n_unison; l++)
         {
             driftLFO[l].next();
+            prepareUnisonVoice(l);
         }
 
         for (int s = 0; s < BLOCK_SIZE_OS; s++)
@@ -719,6 +709,7 @@ void WavetableOscillator::process_block(float pitch0, float drift, bool stereo,
         for (int l = 0; l < n_unison; l++)
         {
             driftLFO[l].next();
+            prepareUnisonVoice(l);
             while (oscstate[l] < a)
                 convolute(l, false, stereo);
             oscstate[l] -= a;
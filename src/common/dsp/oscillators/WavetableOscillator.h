@@ -27,6 +27,7 @@
 #include "DSPUtils.h"
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
+#include "BlitConvolution.h"
 
 class WavetableOscillator : public AbstractBlitOscillator
 {
@@ -65,6 +66,8 @@ class WavetableOscillator : public AbstractBlitOscillator
 
   private:
     void convolute(int voice, bool FM, bool stereo);
+    void selectBlockMipmap();
+    void prepareUnisonVoice(int voice);
     template <bool is_init> void update_lagvals();
     inline float distort_level(float);
     void readDeformType();
@@ -80,6 +83,12 @@ class WavetableOscillator : public AbstractBlitOscillator
     float dc, dc_uni[MAX_UNISON], last_level[MAX_UNISON];
     float pitch;
     int mipmap[MAX_UNISON], mipmap_ofs[MAX_UNISON];
+    /*
+     * Things convolute needs which only change once a block: the mipmap level for the current
+     * pitch, and each unison voice's detuned impulse spacing
+     */
+    int blockMipmap{0}, blockMipmapOfs{0};
+    float unisonTime[MAX_UNISON];
     lag<float> FMdepth, hpf_coeff, integrator_mult, l_hskew, l_vskew, l_clip, l_shape;
     float formant_t, formant_last, pitch_last, pitch_t;
     float tableipol, last_tableipol;
@@ -91,6 +100,7 @@ class WavetableOscillator : public AbstractBlitOscillator
     int sampleloop;
     pdata *unmodulatedLocalcopy;
     FeatureDeform deformType;
+    const Surge::Oscillator::BlitConvolution::Kernels &blit;
 };
 
 #endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_WAVETABLEOSCILLATOR_H
@@ -69,14 +69,13 @@ void WindowOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
         NumUnison = 1;
     }
 
-    float out_attenuation_inv = sqrt((float)NumUnison);
+    unison = &Surge::Oscillator::UnisonTable::forVoices(NumUnison);
+
+    float out_attenuation_inv = unison->attenuation_inv;
     OutAttenuation = 1.0f / (out_attenuation_inv * 16777216.f);
 
     if (NumUnison == 1)
     {
-        DetuneBias = 1;
-        DetuneOffset = 0;
-
         Window.Gain[0][0] = 128;
         Window.Gain[0][1] = 128; // unity gain
 
@@ -94,21 +93,9 @@ void WindowOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
     }
     else
     {
-        DetuneBias = (float)2.f / ((float)NumUnison - 1.f);
-        DetuneOffset = -1.f;
-
-        bool odd = NumUnison & 1;
-        float mid = NumUnison * 0.5 - 0.5;
-        int half = NumUnison >> 1;
-
         for (int i = 0; i < NumUnison; i++)
         {
-            float d = fabs((float)i - mid) / mid;
-
-            if (odd && (i >= half))
-                d = -d;
-            if (i & 1)
-                d = -d;
+            float d = unison->pan[i];
 
             Window.Gain[i][0] = limit_range((int)(float)(128.f * megapanL(d)), 0, 255);
             Window.Gain[i][1] = limit_range((int)(float)(128.f * megapanR(d)), 0, 255);
@@ -285,6 +272,9 @@ template <bool FM, bool Full16> void WindowOscillator::ProcessWindowOscs(bool st
         FTable = 0.f;
     }
 
+    // Unless we're between two tables the second one doesn't contribute, so skip reading it
+    const bool Morph = FTable != 0.f;
+
     int FormantMul =
         (int)(float)(65536.f * storage->note_to_pitch_tuningctr(
                                    localcopy[oscdata->p[win_formant].param_id_in_scene].f));
@@ -333,6 +323,8 @@ template <bool FM, bool Full16> void WindowOscillator::ProcessWindowOscs(bool st
             if (_BitScanReverse(&MSBpos, 3 * RatioA))
                 MipMapA = limit_range((int)MSBpos - 17, 0, storage->WindowWT.size_po2 - 1);
 
+            MipMapB = oscdata->wt.builtMipmap(MipMapB);
+
             short *WaveAdr = oscdata->wt.TableI16WeakPointers[MipMapB][Window.Table[0][so]];
             short *WaveAdrP1 = oscdata->wt.TableI16WeakPointers[MipMapB][Window.Table[1][so]];
             short *WinAdr = storage->WindowWT.TableI16WeakPointers[MipMapA][SelWindow];
@@ -369,61 +361,48 @@ template <bool FM, bool Full16> void WindowOscillator::ProcessWindowOscs(bool st
                 SIMD_M128I Wave = SIMD_MM(madd_epi16)(
                     SIMD_MM(load_si128)(((SIMD_M128I *)storage->sinctableI16 + MSPos)),
                     SIMD_MM(loadu_si128)((SIMD_M128I *)&WaveAdr[MPos]));
-                SIMD_M128I WaveP1 = SIMD_MM(madd_epi16)(
-                    SIMD_MM(load_si128)(((SIMD_M128I *)storage->sinctableI16 + MSPos)),
-                    SIMD_MM(loadu_si128)((SIMD_M128I *)&WaveAdrP1[MPos]));
+                SIMD_M128I WaveP1 = SIMD_MM(setzero_si128)();
+
+                if (Morph)
+                {
+                    WaveP1 = SIMD_MM(madd_epi16)(
+                        SIMD_MM(load_si128)(((SIMD_M128I *)storage->sinctableI16 + MSPos)),
+                        SIMD_MM(loadu_si128)((SIMD_M128I *)&WaveAdrP1[MPos]));
+                }
 
                 SIMD_M128I Win = SIMD_MM(madd_epi16)(
                     SIMD_MM(load_si128)(((SIMD_M128I *)storage->sinctableI16 + WinSPos)),
                     SIMD_MM(loadu_si128)((SIMD_M128I *)&WinAdr[WinPos]));
 
-                // Sum
-                int iWin alignas(16)[4], iWaveP1 alignas(16)[4], iWave alignas(16)[4];
-#if MAC
-                // this should be very fast on C2D/C1D (and there are no macs with K8's)
-                iWin[0] = SIMD_MM(cvtsi128_si32)(Win);
-                iWin[1] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Win, SIMD_MM_SHUFFLE(1, 1, 1, 1)));
-                iWin[2] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Win, SIMD_MM_SHUFFLE(2, 2, 2, 2)));
-                iWin[3] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Win, SIMD_MM_SHUFFLE(3, 3, 3, 3)));
-                iWave[0] = SIMD_MM(cvtsi128_si32)(Wave);
-                iWave[1] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Wave, SIMD_MM_SHUFFLE(1, 1, 1, 1)));
-                iWave[2] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Wave, SIMD_MM_SHUFFLE(2, 2, 2, 2)));
-                iWave[3] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(Wave, SIMD_MM_SHUFFLE(3, 3, 3, 3)));
-                iWaveP1[0] = SIMD_MM(cvtsi128_si32)(WaveP1);
-                iWaveP1[1] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(WaveP1, SIMD_MM_SHUFFLE(1, 1, 1, 1)));
-                iWaveP1[2] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(WaveP1, SIMD_MM_SHUFFLE(2, 2, 2, 2)));
-                iWaveP1[3] = SIMD_MM(cvtsi128_si32)(
-                    SIMD_MM(shuffle_epi32)(WaveP1, SIMD_MM_SHUFFLE(3, 3, 3, 3)));
+                // Sum all three convolutions across their lanes at once: { Win, Wave, WaveP1, 0 }
+                auto z = SIMD_MM(setzero_si128)();
+                auto lo = SIMD_MM(add_epi32)(SIMD_MM(unpacklo_epi32)(Win, Wave),
+                                             SIMD_MM(unpackhi_epi32)(Win, Wave));
+                auto hi = SIMD_MM(add_epi32)(SIMD_MM(unpacklo_epi32)(WaveP1, z),
+                                             SIMD_MM(unpackhi_epi32)(WaveP1, z));
+                auto sums = SIMD_MM(add_epi32)(SIMD_MM(unpacklo_epi64)(lo, hi),
+                                               SIMD_MM(unpackhi_epi64)(lo, hi));
 
-#else
-                SIMD_MM(store_si128)((SIMD_M128I *)&iWin, Win);
-                SIMD_MM(store_si128)((SIMD_M128I *)&iWave, Wave);
-                SIMD_MM(store_si128)((SIMD_M128I *)&iWaveP1, WaveP1);
-#endif
+                int iSum alignas(16)[4];
+                SIMD_MM(store_si128)((SIMD_M128I *)&iSum, sums);
 
-                iWin[0] = (iWin[0] + iWin[1] + iWin[2] + iWin[3]) >> 13;
-                iWave[0] = (iWave[0] + iWave[1] + iWave[2] + iWave[3]) >> (13 + (Full16 ? 1 : 0));
-                iWaveP1[0] =
-                    (iWaveP1[0] + iWaveP1[1] + iWaveP1[2] + iWaveP1[3]) >> (13 + (Full16 ? 1 : 0));
+                int iWin = iSum[0] >> 13;
+                int iWave = iSum[1] >> (13 + (Full16 ? 1 : 0));
 
-                iWave[0] = (int)((1.f - FTable) * iWave[0] + FTable * iWaveP1[0]);
+                if (Morph)
+                {
+                    int iWaveP1 = iSum[2] >> (13 + (Full16 ? 1 : 0));
+                    iWave = (int)((1.f - FTable) * iWave + FTable * iWaveP1);
+                }
 
                 if (stereo)
                 {
-                    int Out = (iWin[0] * iWave[0]) >> 7;
+                    int Out = (iWin * iWave) >> 7;
                     IOutputL[i] += (Out * (int)Window.Gain[so][0]) >> 6;
                     IOutputR[i] += (Out * (int)Window.Gain[so][1]) >> 6;
                 }
                 else
-                    IOutputL[i] += (iWin[0] * iWave[0]) >> 6;
+                    IOutputL[i] += (iWin * iWave) >> 6;
             }
 
             Window.Pos[so] = Pos;
@@ -460,15 +439,20 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
 
     float fmstrength = 32 * M_PI * fmdepth * fmdepth * fmdepth;
 
+    float notes[MAX_UNISON], pitches[MAX_UNISON];
     for (int l = 0; l < NumUnison; l++)
     {
         Window.driftLFO[l].next();
         /*
         ** This original code uses note 57 as a center point with a frequency of 220.
         */
+        notes[l] = pitch + drift * Window.driftLFO[l].val() + Detune * unison->detune[l];
+    }
+    storage->note_to_pitch_block(notes, pitches, NumUnison);
 
-        float f = storage->note_to_pitch(pitch + drift * Window.driftLFO[l].val() +
-                                         Detune * (DetuneOffset + DetuneBias * (float)l));
+    for (int l = 0; l < NumUnison; l++)
+    {
+        float f = pitches[l];
         int Ratio = Float2Int(8.175798915f * 32768.f * f * (float)(storage->WindowWT.size) *
                               storage->samplerate_inv); // (65536.f*0.5f), 0.5 for oversampling
 
@@ -481,8 +465,6 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
             for (int i = 0; i < BLOCK_SIZE_OS; ++i)
             {
                 float fmadj = (1.0 + FMdepth[l].v * master_osc[i]);
-                float f = storage->note_to_pitch(pitch + drift * Window.driftLFO[l].val() +
-                                                 Detune * (DetuneOffset + DetuneBias * (float)l));
                 int Ratio =
                     Float2Int(8.175798915f * 32768.f * f * fmadj * (float)(storage->WindowWT.size) *
                               storage->samplerate_inv); // (65536.f*0.5f), 0.5 for oversampling
@@ -84,7 +84,7 @@ class WindowOscillator : public Oscillator
     lag<float> l_morph;
 
     float OutAttenuation;
-    float DetuneBias, DetuneOffset;
+    const Surge::Oscillator::UnisonTable *unison{&Surge::Oscillator::UnisonTable::forVoices(1)};
     int NumUnison;
 };
 
@@ -0,0 +1,194 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pffft.h"
+
+void PartitionedConvolver::AlignedFree::operator()(float *f) const { pffft_aligned_free(f); }
+
+PartitionedConvolver::buffer_t PartitionedConvolver::allocate(size_t n)
+{
+    auto *f = static_cast<float *>(pffft_aligned_malloc(std::max(n, (size_t)1) * sizeof(float)));
+    std::fill(f, f + n, 0.f);
+    return buffer_t(f);
+}
+
+PartitionedConvolver::PartitionedConvolver() = default;
+PartitionedConvolver::~PartitionedConvolver() = default;
+
+PartitionedConvolver::Stage::~Stage()
+{
+    if (setup)
+        pffft_destroy_setup(setup);
+}
+
+void PartitionedConvolver::Stage::prepare(const float *ir, int length, int p, int n)
+{
+    if (setup)
+        pffft_destroy_setup(setup);
+    setup = nullptr;
+
+    partition = p;
+    fftSize = n;
+    numPartitions = std::max(0, (length + p - 1) / p);
+    fdlPos = 0;
+
+    if (numPartitions == 0)
+        return;
+
+    setup = pffft_new_setup(fftSize, PFFFT_REAL);
+
+    frame = allocate(fftSize);
+    spectra = allocate((size_t)fftSize * numPartitions);
+    fdl = allocate((size_t)fftSize * numPartitions);
+    acc = allocate(fftSize);
+    work = allocate(fftSize);
+
+    // each partition is zero padded out to the transform size
+    for (int k = 0; k < numPartitions; ++k)
+    {
+        std::fill(acc.get(), acc.get() + fftSize, 0.f);
+        std::copy(ir + k * p, ir + std::min(length, (k + 1) * p), acc.get());
+        pffft_transform(setup, acc.get(), spectra.get() + (size_t)k * fftSize, work.get(),
+                        PFFFT_FORWARD);
+    }
+
+    reset();
+}
+
+void PartitionedConvolver::Stage::reset()
+{
+    if (numPartitions == 0)
+        return;
+
+    std::fill(frame.get(), frame.get() + fftSize, 0.f);
+    std::fill(fdl.get(), fdl.get() + (size_t)fftSize * numPartitions, 0.f);
+    std::fill(acc.get(), acc.get() + fftSize, 0.f);
+    fdlPos = 0;
+}
+
+void PartitionedConvolver::Stage::transformFrame()
+{
+    auto *x = fdl.get() + (size_t)fdlPos * fftSize;
+
+    pffft_transform(setup, frame.get(), x, work.get(), PFFFT_FORWARD);
+    pffft_zconvolve_accumulate(setup, x, spectra.get(), acc.get(), 1.f / fftSize);
+}
+
+void PartitionedConvolver::Stage::accumulate(int from, int to)
+{
+    // partition k pairs with the frame from k hops ago, which is already in the delay line
+    for (int k = from; k < to; ++k)
+    {
+        auto idx = (fdlPos - k + numPartitions) % numPartitions;
+        pffft_zconvolve_accumulate(setup, fdl.get() + (size_t)idx * fftSize,
+                                   spectra.get() + (size_t)k * fftSize, acc.get(),
+                                   1.f / fftSize);
+    }
+}
+
+void PartitionedConvolver::Stage::finishFrame(float *result)
+{
+    pffft_transform(setup, acc.get(), acc.get(), work.get(), PFFFT_BACKWARD);
+
+    // overlap-save, so only the last partition's worth of the circular result is valid
+    std::copy(acc.get() + fftSize - partition, acc.get() + fftSize, result);
+    std::fill(acc.get(), acc.get() + fftSize, 0.f);
+
+    std::memmove(frame.get(), frame.get() + partition, (fftSize - partition) * sizeof(float));
+    fdlPos = (fdlPos + 1) % numPartitions;
+}
+
+void PartitionedConvolver::prepare(const float *ir, int length)
+{
+    irLength = std::max(length, 0);
+
+    head.prepare(ir, std::min(irLength, headLength), BLOCK_SIZE, std::max(64, 2 * BLOCK_SIZE));
+
+    if (irLength > headLength)
+        tail.prepare(ir + headLength, irLength - headLength, tailPartition, 2 * tailPartition);
+    else
+        tail.prepare(nullptr, 0, tailPartition, 2 * tailPartition);
+
+    tailOut = allocate(tailPartition);
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    head.reset();
+    tail.reset();
+
+    if (tailOut)
+        std::fill(tailOut.get(), tailOut.get() + tailPartition, 0.f);
+
+    tailCursor = 0;
+}
+
+void PartitionedConvolver::process(const float *in, float *out)
+{
+    if (head.numPartitions == 0)
+    {
+        std::fill(out, out + BLOCK_SIZE, 0.f);
+        return;
+    }
+
+    // take the input before anything is written, since out may be in
+    std::copy(in, in + BLOCK_SIZE, head.frame.get() + head.fftSize - BLOCK_SIZE);
+
+    if (tail.numPartitions > 0)
+    {
+        std::copy(in, in + BLOCK_SIZE,
+                  tail.frame.get() + tail.fftSize - tailPartition + tailCursor);
+    }
+
+    head.transformFrame();
+    head.accumulate(1, head.numPartitions);
+    head.finishFrame(out);
+
+    if (tail.numPartitions == 0)
+        return;
+
+    for (int i = 0; i < BLOCK_SIZE; ++i)
+        out[i] += tailOut[tailCursor + i];
+
+    // spread the older partitions evenly over the blocks until the tail frame completes
+    constexpr int blocksPerFrame = tailPartition / BLOCK_SIZE;
+    const int older = tail.numPartitions - 1;
+    const int step = tailCursor / BLOCK_SIZE;
+
+    tail.accumulate(1 + step * older / blocksPerFrame, 1 + (step + 1) * older / blocksPerFrame);
+
+    tailCursor += BLOCK_SIZE;
+
+    if (tailCursor == tailPartition)
+    {
+        tail.transformFrame();
+        tail.finishFrame(tailOut.get());
+        tailCursor = 0;
+    }
+}
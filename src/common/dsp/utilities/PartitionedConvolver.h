@@ -0,0 +1,105 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
+
+#include "globals.h"
+
+#include <memory>
+
+struct PFFFT_Setup;
+
+/*
+ * Convolves one channel, a block at a time, with a fixed impulse response using pffft.
+ *
+ * The first headLength samples of the response run as a uniformly partitioned overlap-save
+ * convolution with BLOCK_SIZE partitions, so each block contributes to its own output and the
+ * convolution adds no latency. Anything past that runs in a second stage with tailPartition
+ * sized partitions, delayed by exactly one of its partitions so the two stages tile the
+ * response without a gap. The tail stage needs a whole partition of input before it can
+ * transform, but the multiply-accumulates against its older spectra don't depend on the
+ * newest input, so they are spread over the blocks in between rather than all landing on the
+ * block where the partition completes.
+ *
+ * prepare() allocates and transforms the response so keep it off the audio thread. process()
+ * and reset() don't allocate.
+ */
+class PartitionedConvolver
+{
+  public:
+    static constexpr int tailPartition = 1024;
+    static constexpr int headLength = tailPartition;
+
+    static_assert(tailPartition % BLOCK_SIZE == 0,
+                  "The tail partition must be a whole number of blocks");
+
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    PartitionedConvolver(const PartitionedConvolver &) = delete;
+    PartitionedConvolver &operator=(const PartitionedConvolver &) = delete;
+
+    void prepare(const float *ir, int length);
+    void reset();
+
+    // Convolve BLOCK_SIZE samples of in into out, which may alias
+    void process(const float *in, float *out);
+
+    int getLength() const { return irLength; }
+
+  private:
+    struct AlignedFree
+    {
+        void operator()(float *f) const;
+    };
+    typedef std::unique_ptr<float[], AlignedFree> buffer_t;
+
+    // One uniformly partitioned overlap-save convolution
+    struct Stage
+    {
+        ~Stage();
+
+        void prepare(const float *ir, int length, int partition, int fftSize);
+        void reset();
+
+        // Transform the current frame into the delay line and add its product with the
+        // first partition to the accumulator
+        void transformFrame();
+        void accumulate(int fromPartition, int toPartition);
+        void finishFrame(float *result);
+
+        PFFFT_Setup *setup{nullptr};
+        int partition{0}, fftSize{0}, numPartitions{0}, fdlPos{0};
+
+        buffer_t frame, spectra, fdl, acc, work;
+    } head, tail;
+
+    int irLength{0};
+    int tailCursor{0};
+    buffer_t tailOut;
+
+    static buffer_t allocate(size_t n);
+};
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
@@ -0,0 +1,515 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "WaveshaperADAA.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using sst::waveshapers::QuadWaveshaperPtr;
+using sst::waveshapers::QuadWaveshaperState;
+using sst::waveshapers::WaveshaperType;
+
+namespace
+{
+/*
+ * A shape made of evenly spaced linear segments, flat outside them, with its first two
+ * antiderivatives at the start of every segment. Each piece is a polynomial, so those are exact.
+ * The segments needn't join up. Segment 0 is the flat stretch below the first, so that it
+ * shares the lookup with everything else, and the last is the flat stretch above.
+ */
+struct PiecewiseLinearShape
+{
+    double lo{0}, h{1}, hInv{1};
+    int last{0};
+    std::vector<double> f, df, ad1, ad2;
+
+    // segment i starts at first + i * spacing with value starts[i], and moves by deltas[i]
+    PiecewiseLinearShape(double first, double spacing, const std::vector<double> &starts,
+                         const std::vector<double> &deltas)
+        : lo(first - spacing), h(spacing), hInv(1.0 / spacing), last((int)starts.size() + 1)
+    {
+        f.push_back(starts.front());
+        f.insert(f.end(), starts.begin(), starts.end());
+        f.push_back(starts.back() + deltas.back());
+
+        df.push_back(0.0);
+        df.insert(df.end(), deltas.begin(), deltas.end());
+        df.push_back(0.0);
+
+        ad1.resize(f.size());
+        ad2.resize(f.size());
+        integrate();
+    }
+
+    // the shape through knots at first, first + spacing and so on
+    static PiecewiseLinearShape joining(double first, double spacing,
+                                        const std::vector<double> &knots)
+    {
+        std::vector<double> deltas(knots.size() - 1);
+        for (size_t i = 0; i < deltas.size(); ++i)
+            deltas[i] = knots[i + 1] - knots[i];
+        return PiecewiseLinearShape(first, spacing, {knots.begin(), knots.end() - 1}, deltas);
+    }
+
+    template <typename Fn>
+    static PiecewiseLinearShape sampled(double from, double to, int knots, Fn fn)
+    {
+        std::vector<double> v(knots);
+        auto spacing = (to - from) / (knots - 1);
+        for (int i = 0; i < knots; ++i)
+            v[i] = fn(from + i * spacing);
+        return joining(from, spacing, v);
+    }
+
+    void integrate()
+    {
+        auto from = [this](double ad1Start, double ad2Start) {
+            ad1[0] = ad1Start;
+            ad2[0] = ad2Start;
+            for (int j = 0; j < last; ++j)
+            {
+                ad1[j + 1] = ad1[j] + h * (f[j] + 0.5 * df[j]);
+                ad2[j + 1] = ad2[j] + h * ad1[j] + h * h * (0.5 * f[j] + df[j] / 6.0);
+            }
+        };
+
+        // both antiderivatives vanish at zero, which keeps them small where it matters
+        from(0, 0);
+        from(-first1(0), 0);
+        from(ad1[0], -second(0));
+    }
+
+    inline void locate(double x, int &j, double &a) const
+    {
+        auto u = (x - lo) * hInv;
+        auto k = std::clamp(std::floor(u), 0.0, (double)last);
+        j = (int)k;
+        a = u - k;
+    }
+
+    double value(double x) const
+    {
+        int j;
+        double a;
+        locate(x, j, a);
+        return f[j] + df[j] * a;
+    }
+
+    double first1(double x) const
+    {
+        int j;
+        double a;
+        locate(x, j, a);
+        return ad1[j] + h * a * (f[j] + 0.5 * df[j] * a);
+    }
+
+    double second(double x) const
+    {
+        int j;
+        double a;
+        locate(x, j, a);
+        return ad2[j] + h * a * (ad1[j] + h * a * (0.5 * f[j] + df[j] * a / 6.0));
+    }
+};
+
+struct HardClip
+{
+    static double value(double x) { return std::clamp(x, -1.0, 1.0); }
+    static double first1(double x)
+    {
+        auto ax = std::fabs(x);
+        return ax < 1 ? 0.5 * x * x : ax - 0.5;
+    }
+    static double second(double x)
+    {
+        auto ax = std::fabs(x);
+        if (ax < 1)
+            return x * x * x / 6.0;
+        return std::copysign(0.5 * ax * ax - 0.5 * ax + 1.0 / 6.0, x);
+    }
+};
+
+/*
+ * DIGI_SSE2 is drive * Q(in / drive) for a staircase Q with sixteen steps to the unit, each
+ * centred between its edges. With t = 16u and n = floor(t), the integrals of floor(t) + 1/2 are
+ * polynomials in n and the fraction, which hold for negative n as well.
+ */
+struct Staircase
+{
+    static double value(double u) { return (std::floor(16 * u) + 0.5) / 16; }
+    static double first1(double u)
+    {
+        auto t = 16 * u, n = std::floor(t), fr = t - n;
+        return (0.5 * n * n + fr * (n + 0.5)) / 256;
+    }
+    static double second(double u)
+    {
+        auto t = 16 * u, n = std::floor(t), fr = t - n;
+        auto whole = (n - 1) * n * (2 * n - 1) / 12 + (n - 1) * n / 4 + n / 4;
+        return (whole + fr * n * n / 2 + fr * fr * (n + 0.5) / 2) / 4096;
+    }
+};
+
+constexpr double firstOrderTolerance = 1e-5, secondOrderTolerance = 1e-4;
+
+template <typename S> double firstOrder(const S &s, double x0, double x1)
+{
+    auto dx = x0 - x1;
+    if (std::fabs(dx) < firstOrderTolerance)
+        return s.value(0.5 * (x0 + x1));
+    return (s.first1(x0) - s.first1(x1)) / dx;
+}
+
+template <typename S> double secondOrder(const S &s, double x0, double x1, double x2)
+{
+    auto d = [&s](double a, double b) {
+        auto dx = a - b;
+        if (std::fabs(dx) < secondOrderTolerance)
+            return s.first1(0.5 * (a + b));
+        return (s.second(a) - s.second(b)) / dx;
+    };
+
+    auto dx = x0 - x2;
+    if (std::fabs(dx) < secondOrderTolerance)
+    {
+        auto xb = 0.5 * (x0 + x2), delta = xb - x1;
+        if (std::fabs(delta) < secondOrderTolerance)
+            return s.value(0.5 * (xb + x1));
+        return 2 / delta * (s.first1(xb) + (s.second(x1) - s.second(xb)) / delta);
+    }
+    return 2 * (d(x0, x1) - d(x1, x2)) / dx;
+}
+
+// how a shape reads its drive: scaling the input, or over the staircase, sizing the steps
+enum DriveMode
+{
+    dm_multiply,
+    dm_steps,
+};
+
+template <typename S, const S &shape(), int order, DriveMode dm, bool dcBlock>
+SIMD_M128 antialiased(QuadWaveshaperState *__restrict s, SIMD_M128 in, SIMD_M128 drive)
+{
+    const auto &sh = shape();
+
+    float vin alignas(16)[4], vd alignas(16)[4], x1 alignas(16)[4], x2 alignas(16)[4];
+    float out alignas(16)[4];
+    SIMD_MM(store_ps)(vin, in);
+    SIMD_MM(store_ps)(vd, drive);
+    SIMD_MM(store_ps)(x1, s->R[0]);
+    SIMD_MM(store_ps)(x2, s->R[1]);
+
+    float x0 alignas(16)[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        x0[i] = dm == dm_steps ? vin[i] / std::max(vd[i], 1e-6f) : vin[i] * vd[i];
+
+        double y = order == 1 ? firstOrder(sh, x0[i], x1[i]) : secondOrder(sh, x0[i], x1[i], x2[i]);
+        out[i] = dm == dm_steps ? (float)(y * vd[i]) : (float)y;
+    }
+
+    s->R[1] = SIMD_MM(load_ps)(x1);
+    s->R[0] = SIMD_MM(load_ps)(x0);
+
+    auto res = SIMD_MM(load_ps)(out);
+    if constexpr (dcBlock)
+        return sst::waveshapers::dcBlock<2, 3>(s, res);
+
+    return res;
+}
+
+/*
+ * The shapes, each built the first time anything asks for it
+ */
+const HardClip &hardClip()
+{
+    static HardClip s;
+    return s;
+}
+
+const Staircase &staircase()
+{
+    static Staircase s;
+    return s;
+}
+
+const PiecewiseLinearShape &rationalTanh()
+{
+    static auto s = PiecewiseLinearShape::sampled(-3, 3, 4097, [](double x) {
+        return std::clamp(x * (27 + x * x) / (27 + 9 * x * x), -1.0, 1.0);
+    });
+    return s;
+}
+
+/*
+ * WS_LUT, SINUS_SSE2 and WS_PM1_LUT round to the nearest knot and interpolate from there towards
+ * the next one, so from k - 1/2 to k + 1/2 they follow the line through knots k and k + 1, and
+ * jump at every half knot. With the table at perUnit knots to the unit and knot centre at zero,
+ * these are those lines in half knot segments between knots from and to, rounding to no further
+ * than knot lastKnot.
+ */
+PiecewiseLinearShape roundedTable(const float *table, int lastKnot, double from, double to,
+                                  double centre, double perUnit)
+{
+    std::vector<double> starts, deltas;
+    for (double u = from; u < to; u += 0.5)
+    {
+        auto e = std::clamp((int)std::floor(u + 0.75), 0, lastKnot);
+        auto slope = (double)table[e + 1] - table[e];
+        starts.push_back(table[e] + (u - e) * slope);
+        deltas.push_back(0.5 * slope);
+    }
+    return PiecewiseLinearShape((from - centre) / perUnit, 0.5 / perUnit, starts, deltas);
+}
+
+// WS_LUT<32, 512, 0x3ff>, which reaches the last knot
+const PiecewiseLinearShape &asymLUT()
+{
+    static auto s = roundedTable(
+        sst::waveshapers::globalWaveshaperTables.waveshapers[(int)WaveshaperType::wst_asym], 1022,
+        -0.5, 1022.5, 512, 32);
+    return s;
+}
+
+// SINUS_SSE2, which reads sin(pi x / 2) out to two either side
+const PiecewiseLinearShape &sineLUT()
+{
+    static auto s = roundedTable(
+        sst::waveshapers::globalWaveshaperTables.waveshapers[(int)WaveshaperType::wst_sine], 1022,
+        -0.5, 1022.5, 512, 256);
+    return s;
+}
+
+// SurgeStorage::lookup_waveshape, which interpolates properly and steps to one past the ends
+template <WaveshaperType t> const PiecewiseLinearShape &lookupTable()
+{
+    static auto s = [] {
+        const auto &table = sst::waveshapers::globalWaveshaperTables.waveshapers[(int)t];
+        auto res = PiecewiseLinearShape::joining((1 - 512) / 32.0, 1 / 32.0,
+                                                 {table + 1, table + 0x3fe + 1});
+        res.f[0] = -1;
+        res.f.back() = 1;
+        res.df[0] = 0;
+        res.integrate();
+        return res;
+    }();
+    return s;
+}
+
+/*
+ * The fuzz tables are noise, so these regenerate them just as TableEval draws its own the first
+ * time, from a fresh generator with the same seed. (The soft and hard fuzz share a generator
+ * there, so whichever is built second draws different noise; here they never do.) The fuzz is the
+ * table played through CLIP or TANH. Through CLIP that is the table as it is; through TANH it is
+ * sampled about four times finer than the table where the table is densest.
+ */
+template <typename Fn> std::vector<float> fuzzKnots(int n, Fn fn)
+{
+    std::vector<float> res(n + 1);
+    const float dx = 2.0 / n;
+    for (int i = 0; i < n + 1; ++i)
+        res[i] = fn(i * dx - 1.0f);
+    return res;
+}
+
+template <int scale> std::vector<float> fuzzTable()
+{
+    auto gen = std::minstd_rand(2112);
+    const float range = 0.1 * scale;
+    auto dist = std::uniform_real_distribution<float>(-range, range);
+
+    return fuzzKnots(1024, [&](float x) -> float { return x * (1 - range) + dist(gen); });
+}
+
+std::vector<float> fuzzCtrTable()
+{
+    auto gen = std::minstd_rand(2112);
+    const float b = 20;
+    auto dist = std::uniform_real_distribution<float>(-1.0, 1.0);
+
+    return fuzzKnots(2048, [&](float x) -> float {
+        auto g = exp(-x * x * b);
+        return x + g * dist(gen);
+    });
+}
+
+std::vector<float> fuzzEdgeTable()
+{
+    auto gen = std::minstd_rand(2112);
+    auto dist = std::uniform_real_distribution<float>(-1.0, 1.0);
+
+    return fuzzKnots(2048, [&](float x) -> float {
+        auto g = x * x * x * x;
+        return 0.85 * x + 0.15 * g * dist(gen);
+    });
+}
+
+// WS_PM1_LUT, on a table over [-1, 1]
+PiecewiseLinearShape clippedFuzz(const std::vector<float> &knots)
+{
+    auto n = (int)knots.size() - 1;
+    return roundedTable(knots.data(), n - 1, 0, n, 0.5 * n, 0.5 * n);
+}
+
+PiecewiseLinearShape softFuzz(const std::vector<float> &knots)
+{
+    auto table = clippedFuzz(knots);
+    auto n = 12 * (int)(knots.size() - 1);
+    const auto &tanh = rationalTanh();
+    return PiecewiseLinearShape::sampled(-3, 3, n + 1, [&](double x) {
+        return table.value(tanh.value(x));
+    });
+}
+
+const PiecewiseLinearShape &fuzz()
+{
+    static auto s = clippedFuzz(fuzzTable<1>());
+    return s;
+}
+
+const PiecewiseLinearShape &fuzzHeavy()
+{
+    static auto s = clippedFuzz(fuzzTable<3>());
+    return s;
+}
+
+const PiecewiseLinearShape &fuzzSoft()
+{
+    static auto s = softFuzz(fuzzTable<1>());
+    return s;
+}
+
+const PiecewiseLinearShape &fuzzCtr()
+{
+    static auto s = softFuzz(fuzzCtrTable());
+    return s;
+}
+
+const PiecewiseLinearShape &fuzzSoftEdge()
+{
+    static auto s = softFuzz(fuzzEdgeTable());
+    return s;
+}
+
+// builds the shape here, so that it isn't built in the middle of a block
+template <typename S, const S &shape(), DriveMode dm = dm_multiply, bool dcBlock = false>
+QuadWaveshaperPtr byOrder(int mode)
+{
+    shape();
+
+    switch (mode)
+    {
+    case wsaa_first_order:
+        return antialiased<S, shape, 1, dm, dcBlock>;
+    case wsaa_second_order:
+        return antialiased<S, shape, 2, dm, dcBlock>;
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+using PLS = PiecewiseLinearShape;
+} // namespace
+
+bool hasAntialiasedWaveshaper(WaveshaperType type)
+{
+    switch (type)
+    {
+    case WaveshaperType::wst_soft:
+    case WaveshaperType::wst_hard:
+    case WaveshaperType::wst_asym:
+    case WaveshaperType::wst_sine:
+    case WaveshaperType::wst_digital:
+    case WaveshaperType::wst_fuzz:
+    case WaveshaperType::wst_fuzzheavy:
+    case WaveshaperType::wst_fuzzctr:
+    case WaveshaperType::wst_fuzzsoft:
+    case WaveshaperType::wst_fuzzsoftedge:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+QuadWaveshaperPtr GetAntialiasedQuadWaveshaper(WaveshaperType type, int mode)
+{
+    if (mode == wsaa_off)
+        return nullptr;
+
+    switch (type)
+    {
+    case WaveshaperType::wst_soft:
+        return byOrder<PLS, rationalTanh>(mode);
+    case WaveshaperType::wst_hard:
+        return byOrder<HardClip, hardClip>(mode);
+    case WaveshaperType::wst_asym:
+        return byOrder<PLS, asymLUT>(mode);
+    case WaveshaperType::wst_sine:
+        return byOrder<PLS, sineLUT>(mode);
+    case WaveshaperType::wst_digital:
+        return byOrder<Staircase, staircase, dm_steps>(mode);
+    case WaveshaperType::wst_fuzz:
+        return byOrder<PLS, fuzz, dm_multiply, true>(mode);
+    case WaveshaperType::wst_fuzzheavy:
+        return byOrder<PLS, fuzzHeavy, dm_multiply, true>(mode);
+    case WaveshaperType::wst_fuzzctr:
+        return byOrder<PLS, fuzzCtr, dm_multiply, true>(mode);
+    case WaveshaperType::wst_fuzzsoft:
+        return byOrder<PLS, fuzzSoft, dm_multiply, true>(mode);
+    case WaveshaperType::wst_fuzzsoftedge:
+        return byOrder<PLS, fuzzSoftEdge, dm_multiply, true>(mode);
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+QuadWaveshaperPtr GetAntialiasedLookupWaveshaper(WaveshaperType type, int mode)
+{
+    if (mode == wsaa_off)
+        return nullptr;
+
+    switch (type)
+    {
+    case WaveshaperType::wst_soft:
+        return byOrder<PLS, lookupTable<WaveshaperType::wst_soft>>(mode);
+    case WaveshaperType::wst_hard:
+        return byOrder<PLS, lookupTable<WaveshaperType::wst_hard>>(mode);
+    case WaveshaperType::wst_asym:
+        return byOrder<PLS, lookupTable<WaveshaperType::wst_asym>>(mode);
+    default:
+        break;
+    }
+    return GetAntialiasedQuadWaveshaper(type, mode);
+}
+
+void prepareAntialiasedWaveshapers()
+{
+    for (int t = 0; t < (int)WaveshaperType::n_ws_types; ++t)
+        GetAntialiasedLookupWaveshaper((WaveshaperType)t, wsaa_first_order);
+}
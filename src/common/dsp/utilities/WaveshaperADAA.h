@@ -0,0 +1,78 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERADAA_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERADAA_H
+
+#include "globals.h"
+
+#include "sst/waveshapers.h"
+
+/*
+ * Antiderivative antialiased (ADAA) versions of the main waveshapers. Rather than shaping each
+ * sample, they output the average of the shape along the line from the previous input to this
+ * one (Parker, Zavalishin and Le Bivic), or from the two previous inputs in the second order
+ * case (Bilbao, Esqueda, Parker and Välimäki). That takes out most of the aliasing a static
+ * shape makes without running it at a higher rate. The first order adds half a sample of delay,
+ * the second order a whole one and a little more high frequency droop.
+ *
+ * They take the same arguments as the sst::waveshapers shapes and start from the same zeroed
+ * registers, which they read as silence before the first sample, so they drop in wherever those
+ * go. They ignore the init mask, since the voices raise it at every block. The work is done in
+ * double, since the antiderivatives are differenced over inputs which are often very close
+ * together.
+ *
+ * The shapes which come from a table interpolate it linearly, so they are exactly piecewise
+ * linear, if not always continuous, and their antiderivatives are exact too. Soft and the soft
+ * fuzzes go through the rational tanh, which is sampled finely enough that the difference
+ * doesn't show.
+ */
+enum WaveshaperAntialiasing
+{
+    wsaa_off = 0,
+    wsaa_first_order,
+    wsaa_second_order,
+
+    n_wsaa_modes,
+};
+
+// Soft, Hard, Asym, Sine, Digital and the five fuzzes
+bool hasAntialiasedWaveshaper(sst::waveshapers::WaveshaperType type);
+
+// nullptr for none, or for a shape without an ADAA version
+sst::waveshapers::QuadWaveshaperPtr
+GetAntialiasedQuadWaveshaper(sst::waveshapers::WaveshaperType type, int mode);
+
+/*
+ * Soft, Hard and Asym as SurgeStorage::lookup_waveshape plays them, which the distortion uses,
+ * from the tables rather than the quad shapes. Anything else is the same as the quad version.
+ */
+sst::waveshapers::QuadWaveshaperPtr
+GetAntialiasedLookupWaveshaper(sst::waveshapers::WaveshaperType type, int mode);
+
+// The tables behind the shapes take a few milliseconds to build, so SurgeStorage builds them all
+// up front rather than leave the first block which asks for one to do it
+void prepareAntialiasedWaveshapers();
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERADAA_H
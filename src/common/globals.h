@@ -58,6 +58,13 @@ const int OB_LENGTH = BLOCK_SIZE_OS << 1;
 const int OB_LENGTH_QUAD = OB_LENGTH >> 2;
 const float BLOCK_SIZE_INV = (1.f / BLOCK_SIZE);
 const float BLOCK_SIZE_OS_INV = (1.f / BLOCK_SIZE_OS);
+/*
+ * The block size is baked in at build time, since most of the DSP sizes its buffers and
+ * unrolls its SIMD loops on it. The quad and oversampled constants above and the halfband
+ * and wavetable code assume a power of two which is a whole number of SSE registers.
+ */
+static_assert(BLOCK_SIZE >= 16 && BLOCK_SIZE <= 128 && (BLOCK_SIZE & (BLOCK_SIZE - 1)) == 0,
+              "SURGE_COMPILE_BLOCK_SIZE must be one of 16, 32, 64 or 128");
 const int MAX_FB_COMB = 2048;               // must be 2^n
 const int MAX_FB_COMB_EXTENDED = 2048 * 64; // Only exposed in Combulator
 const int MAX_VOICES = 64;
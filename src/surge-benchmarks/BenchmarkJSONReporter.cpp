@@ -0,0 +1,161 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+/*
+ * A Catch2 reporter which writes every benchmark's statistics as one JSON document, so
+ * that runs can be stored and compared by a script. Select it with `--reporter json`,
+ * and send it to a file with `--reporter json::out=results.json`.
+ */
+
+#include "catch2/catch_amalgamated.hpp"
+#include "globals.h"
+#include "version.h"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string jsonString(const std::string &s)
+{
+    std::ostringstream oss;
+    oss << '"';
+    for (auto c : s)
+    {
+        switch (c)
+        {
+        case '"':
+            oss << "\\\"";
+            break;
+        case '\\':
+            oss << "\\\\";
+            break;
+        case '\n':
+            oss << "\\n";
+            break;
+        case '\t':
+            oss << "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                    << std::dec;
+            else
+                oss << c;
+        }
+    }
+    oss << '"';
+    return oss.str();
+}
+
+class BenchmarkJSONReporter final : public Catch::StreamingReporterBase
+{
+  public:
+    BenchmarkJSONReporter(Catch::ReporterConfig &&config)
+        : StreamingReporterBase(CATCH_MOVE(config))
+    {
+        m_preferences.shouldReportAllAssertions = false;
+    }
+
+    static std::string getDescription()
+    {
+        return "Reports the statistics of each benchmark as a JSON document";
+    }
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const &stats) override
+    {
+        Result r;
+        r.testCase = currentTestCaseInfo ? currentTestCaseInfo->name : "";
+        for (const auto &s : m_sectionStack)
+        {
+            if (s.name != r.testCase)
+                r.section += (r.section.empty() ? "" : "/") + s.name;
+        }
+        r.name = stats.info.name;
+        r.samples = stats.info.samples;
+        r.iterations = stats.info.iterations;
+        r.mean = stats.mean.point.count();
+        r.meanLow = stats.mean.lower_bound.count();
+        r.meanHigh = stats.mean.upper_bound.count();
+        r.stdDev = stats.standardDeviation.point.count();
+        r.outlierVariance = stats.outlierVariance;
+        results.push_back(r);
+    }
+
+    void benchmarkFailed(Catch::StringRef error) override
+    {
+        failures.push_back(std::string(error));
+    }
+
+    void testRunEnded(Catch::TestRunStats const &runStats) override
+    {
+        StreamingReporterBase::testRunEnded(runStats);
+
+        auto &o = m_stream;
+        o << std::setprecision(10);
+        o << "{\n"
+          << "  \"surge_version\": " << jsonString(Surge::Build::FullVersionStr) << ",\n"
+          << "  \"build_date\": " << jsonString(Surge::Build::BuildDate) << ",\n"
+          << "  \"block_size\": " << BLOCK_SIZE << ",\n"
+          << "  \"time_unit\": \"ns\",\n"
+          << "  \"benchmarks\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto &r = results[i];
+            o << (i ? "," : "") << "\n    {"
+              << "\"test_case\": " << jsonString(r.testCase) << ", "
+              << "\"section\": " << jsonString(r.section) << ", "
+              << "\"name\": " << jsonString(r.name) << ", "
+              << "\"samples\": " << r.samples << ", "
+              << "\"iterations\": " << r.iterations << ", "
+              << "\"mean\": " << r.mean << ", "
+              << "\"mean_lower\": " << r.meanLow << ", "
+              << "\"mean_upper\": " << r.meanHigh << ", "
+              << "\"standard_deviation\": " << r.stdDev << ", "
+              << "\"outlier_variance\": " << r.outlierVariance << "}";
+        }
+
+        o << "\n  ],\n  \"failures\": [";
+        for (size_t i = 0; i < failures.size(); ++i)
+            o << (i ? ", " : "") << jsonString(failures[i]);
+        o << "]\n}\n";
+        o.flush();
+    }
+
+  private:
+    struct Result
+    {
+        std::string testCase, section, name;
+        unsigned int samples{0};
+        int iterations{0};
+        double mean{0}, meanLow{0}, meanHigh{0}, stdDev{0}, outlierVariance{0};
+    };
+    std::vector<Result> results;
+    std::vector<std::string> failures;
+};
+} // namespace
+
+CATCH_REGISTER_REPORTER("json", BenchmarkJSONReporter)
@@ -0,0 +1,98 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "HeadlessUtils.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+/*
+ * Each filter type and subtype through the same QuadFilterChain entry point the voices use,
+ * with all four SIMD lanes active.
+ */
+TEST_CASE("Filter Chain Block", "[flt]")
+{
+    using namespace sst::filters;
+
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto Q = std::make_unique<QuadFilterChainState>();
+
+    for (int t = fut_none + 1; t < num_filter_types; ++t)
+    {
+        auto ft = (FilterType)t;
+        auto nsub = std::max(fut_subcount[t], 1);
+
+        for (int st = 0; st < nsub; ++st)
+        {
+            auto fst = (FilterSubType)st;
+
+            DYNAMIC_SECTION(filter_type_names[t] << " subtype " << st)
+            {
+                InitQuadFilterChainStateToZero(Q.get());
+
+                for (int u = 0; u < 4; ++u)
+                {
+                    FilterCoefficientMaker<SurgeStorage> cm;
+                    cm.setSampleRateAndBlockSize((float)surge->storage.dsamplerate_os,
+                                                 BLOCK_SIZE_OS);
+                    cm.MakeCoeffs(0.f, 0.5f, ft, fst, &surge->storage, false);
+                    cm.updateState(Q->FU[u]);
+
+                    for (int i = 0; i < 4; ++i)
+                        Q->FU[u].active[i] = 0xffffffff;
+                }
+
+                Q->Gain = SIMD_MM(set1_ps)(1.f);
+                Q->Drive = SIMD_MM(set1_ps)(1.f);
+                Q->OutL = Q->OutR = SIMD_MM(set1_ps)(0.5f);
+
+                for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                {
+                    Q->DL[k] = SIMD_MM(set_ps)(sin(k * 0.1f), sin(k * 0.2f), sin(k * 0.3f),
+                                               sin(k * 0.4f));
+                    Q->DR[k] = Q->DL[k];
+                }
+
+                fbq_global g;
+                g.FU1ptr = GetQFPtrFilterUnit(ft, fst);
+                g.FU2ptr = nullptr;
+                g.WSptr = nullptr;
+
+                auto chain = GetFBQPointer(fc_serial1, true, false, false);
+                REQUIRE(chain);
+
+                if (g.FU1ptr)
+                {
+                    float L alignas(16)[BLOCK_SIZE_OS]{}, R alignas(16)[BLOCK_SIZE_OS]{};
+
+                    BENCHMARK("QuadFilterChain")
+                    {
+                        chain(*Q, g, L, R);
+                        return L[0];
+                    };
+                }
+            }
+        }
+    }
+}
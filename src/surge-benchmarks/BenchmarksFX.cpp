@@ -0,0 +1,72 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "HeadlessUtils.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+#include <cmath>
+
+/*
+ * Each effect in slot A1, stand-alone, one block at a time with its default parameters.
+ */
+TEST_CASE("Effect Block", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000, true);
+    REQUIRE(surge);
+
+    auto storage = &surge->storage;
+    auto &patch = storage->getPatch();
+
+    for (int t = fxt_off + 1; t < n_fx_types; ++t)
+    {
+        DYNAMIC_SECTION(fx_type_names[t])
+        {
+            auto *fxs = &patch.fx[fxslot_ains1];
+            fxs->type.val.i = t;
+
+            std::unique_ptr<Effect> fx(spawn_effect(t, storage, fxs, patch.globaldata));
+            REQUIRE(fx);
+
+            fx->init_ctrltypes();
+            fx->init_default_values();
+            patch.update_controls(false);
+            fx->init();
+
+            float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+            int64_t phase{0};
+
+            BENCHMARK("process")
+            {
+                for (int i = 0; i < BLOCK_SIZE; ++i, ++phase)
+                {
+                    L[i] = 0.3f * std::sin(phase * 0.03f);
+                    R[i] = 0.3f * std::sin(phase * 0.05f);
+                }
+                patch.copy_globaldata(patch.globaldata);
+                fx->process(L, R);
+                return L[0];
+            };
+        }
+    }
+}
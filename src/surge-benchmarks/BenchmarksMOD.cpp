@@ -0,0 +1,101 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "HeadlessUtils.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+/*
+ * The modulation side: one LFO of each shape, and the cost of the modulation matrix inside a
+ * playing synth as routings are added.
+ */
+TEST_CASE("LFO Block", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto &patch = surge->storage.getPatch();
+    auto lfostorage = &(patch.scene[0].lfo[0]);
+
+    for (int s = 0; s < n_lfo_types; ++s)
+    {
+        DYNAMIC_SECTION(lt_names[s])
+        {
+            lfostorage->shape.val.i = s;
+            patch.copy_scenedata(patch.scenedata[0], patch.scenedataOrig[0], 0);
+
+            auto lfo = std::make_unique<LFOModulationSource>();
+            lfo->assign(&(surge->storage), lfostorage, patch.scenedata[0], nullptr,
+                        &patch.stepsequences[0][0], &patch.msegs[0][0], &patch.formulamods[0][0]);
+            lfo->attack();
+
+            BENCHMARK("process_block")
+            {
+                lfo->process_block();
+                return lfo->get_output(0);
+            };
+        }
+    }
+}
+
+TEST_CASE("Modulation Matrix Cost", "[mod]")
+{
+    for (auto routings : {0, 8, 32})
+    {
+        DYNAMIC_SECTION("routings " << routings)
+        {
+            auto surge = Surge::Headless::createSurge(48000);
+            REQUIRE(surge);
+
+            auto &patch = surge->storage.getPatch();
+            int added = 0;
+
+            for (int p = 0; p < patch.scene_size && added < routings; ++p)
+            {
+                auto par = patch.param_ptr[patch.scene_start[0] + p];
+                if (!par || par->ctrltype == ct_none)
+                    continue;
+
+                for (int src : {ms_lfo1, ms_lfo2, ms_ctrl1, ms_velocity})
+                {
+                    if (added >= routings)
+                        break;
+                    if (surge->isValidModulation(par->id, (modsources)src) &&
+                        surge->setModDepth01(par->id, (modsources)src, 0, 0, 0.1f))
+                        ++added;
+                }
+            }
+
+            for (int k = 0; k < 6; ++k)
+                surge->playNote(0, 48 + k * 5, 100, 0);
+            for (int i = 0; i < 10; ++i)
+                surge->process();
+
+            BENCHMARK("process")
+            {
+                surge->process();
+                return surge->output[0][0];
+            };
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "HeadlessUtils.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+/*
+ * Each oscillator on its own, one block at a time, at a handful of unison counts. Nothing
+ * here touches the voice or the filter chain, so a change in these numbers is the oscillator.
+ */
+TEST_CASE("Oscillator Block", "[osc]")
+{
+    auto surge = Surge::Headless::createSurge(48000, true);
+    REQUIRE(surge);
+
+    auto storage = &surge->storage;
+    auto &patch = storage->getPatch();
+    auto oscstorage = &(patch.scene[0].osc[0]);
+
+    for (int ot = 0; ot < n_osc_types; ++ot)
+    {
+        for (auto unison : {1, 4, 16})
+        {
+            DYNAMIC_SECTION(osc_type_names[ot] << " unison " << unison)
+            {
+                unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+
+                oscstorage->type.val.i = ot;
+
+                auto o = spawn_osc(ot, storage, oscstorage, patch.scenedata[0],
+                                   patch.scenedataOrig[0], oscbuffer);
+                REQUIRE(o);
+                o->init_ctrltypes();
+                o->init_default_values();
+                o->init_extra_config();
+
+                bool hasUnison = false;
+                for (int p = 0; p < n_osc_params; ++p)
+                {
+                    if (oscstorage->p[p].ctrltype == ct_osccount)
+                    {
+                        oscstorage->p[p].val.i = unison;
+                        hasUnison = true;
+                    }
+                }
+
+                patch.copy_scenedata(patch.scenedata[0], patch.scenedataOrig[0], 0);
+
+                if (hasUnison || unison == 1)
+                {
+                    o->init(60);
+
+                    BENCHMARK("process_block")
+                    {
+                        o->process_block(60, 0, true, false, 0);
+                        return o->output[0];
+                    };
+                }
+
+                o->~Oscillator();
+            }
+        }
+    }
+}
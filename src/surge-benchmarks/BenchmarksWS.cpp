@@ -0,0 +1,63 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "HeadlessUtils.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+/*
+ * Each waveshaper over one oversampled block of four voices.
+ */
+TEST_CASE("Waveshaper Block", "[ws]")
+{
+    using namespace sst::waveshapers;
+
+    for (int t = (int)WaveshaperType::wst_none + 1; t < (int)WaveshaperType::n_ws_types; ++t)
+    {
+        DYNAMIC_SECTION(wst_names[t])
+        {
+            auto ws = GetQuadWaveshaper((WaveshaperType)t);
+            REQUIRE(ws);
+
+            QuadWaveshaperState qss;
+            for (int i = 0; i < n_waveshaper_registers; ++i)
+                qss.R[i] = SIMD_MM(setzero_ps)();
+            qss.init = SIMD_MM(castsi128_ps)(SIMD_MM(set1_epi32)(0xFFFFFFFF));
+
+            SIMD_M128 in alignas(16)[BLOCK_SIZE_OS];
+            for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                in[k] = SIMD_MM(set_ps)(sin(k * 0.1f), sin(k * 0.2f), sin(k * 0.3f),
+                                        sin(k * 0.4f));
+
+            auto drive = SIMD_MM(set1_ps)(2.f);
+
+            BENCHMARK("QuadWaveshaper")
+            {
+                auto acc = SIMD_MM(setzero_ps)();
+                for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                    acc = SIMD_MM(add_ps)(acc, ws(&qss, in[k], drive));
+                return acc;
+            };
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include <cstring>
+#include <iostream>
+
+#include "catch2/catch_amalgamated.hpp"
+#include "version.h"
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--help") == 0)
+    {
+        std::cout
+            << "surge-benchmarks " << Surge::Build::FullVersionStr << "\n\n"
+            << "Times the DSP building blocks of Surge XT one at a time. Run it from the root\n"
+            << "of the Surge XT repo. To keep results for comparison, use\n\n"
+            << "   surge-benchmarks --reporter json::out=results.json\n\n"
+            << "and pick a subset with the usual test specs, e.g. \"[osc]\", \"[flt]\", \"[ws]\",\n"
+            << "\"[fx]\" or \"[mod]\". Standard catch2 arguments, below, apply.\n\n";
+    }
+
+    return Catch::Session().run(argc, argv);
+}
@@ -224,6 +224,15 @@ bool SurgefxAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) c
     bool outputValid = layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo() ||
                        layouts.getMainOutputChannelSet() == juce::AudioChannelSet::mono();
 
+    // or a wider bus, in and out the same, which we take a stereo pair at a time
+    auto wide = layouts.getMainOutputChannelSet().size();
+    if (wide > 2 && wide % 2 == 0 && wide <= 2 * maxChannelPairs &&
+        layouts.getMainInputChannelSet().size() == wide)
+    {
+        inputValid = true;
+        outputValid = true;
+    }
+
     bool sidechainValid = layouts.getChannelSet(true, 1).isDisabled() ||
                           layouts.getChannelSet(true, 1) == juce::AudioChannelSet::stereo();
 
@@ -284,10 +293,13 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     }
 
     auto mib = getBus(true, 0);
-    if (mib->isEnabled() && !(mib->getNumberOfChannels() == 1 || mib->getNumberOfChannels() == 2))
+    auto mob = getBus(false, 0);
+    auto wideBus = mob->getNumberOfChannels() > 2;
+    if (mib->isEnabled() && !(mib->getNumberOfChannels() == 1 || mib->getNumberOfChannels() == 2) &&
+        !(wideBus && mib->getNumberOfChannels() == mob->getNumberOfChannels()))
     {
         m_audioValid = false;
-        m_audioValidMessage = "Enabled Input is neither mono nor stereo";
+        m_audioValidMessage = "Enabled Input is neither mono, stereo nor the width of the output";
         return;
     }
     if (!mib->isEnabled())
@@ -296,12 +308,13 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         m_audioValidMessage = "Input is not enabled";
         return;
     }
-    auto mob = getBus(false, 0);
-    if (mob->isEnabled() && (mob->getNumberOfChannels() != 2))
+    if (mob->isEnabled() &&
+        (mob->getNumberOfChannels() < 2 || (mob->getNumberOfChannels() & 1) ||
+         mob->getNumberOfChannels() > 2 * maxChannelPairs))
     {
         m_audioValid = false;
-        m_audioValidMessage =
-            "Enabled Output is not stereo " + std::to_string(mib->getNumberOfChannels());
+        m_audioValidMessage = "Enabled Output is not stereo or stereo pairs " +
+                              std::to_string(mob->getNumberOfChannels());
         return;
     }
     if (!mob->isEnabled())
@@ -331,22 +344,49 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         resetFxType(effectNum);
     }
 
+    const int channelPairs = mainOutput.getNumChannels() / 2;
+    if (channelPairs > spawnedChannelPairs)
+    {
+        spawnExtraPairEffects(channelPairs);
+    }
+
     if (audio_thread_surge_effect.get() != surge_effect.get())
     {
         audio_thread_surge_effect = surge_effect;
     }
+    for (int i = 0; i < channelPairs - 1; ++i)
+    {
+        if (audio_thread_extra_pair_effects[i].get() != extra_pair_effects[i].get())
+            audio_thread_extra_pair_effects[i] = extra_pair_effects[i];
+    }
+
+    /*
+     * The host only moves parameters between calls to us, so every block in this buffer sees the
+     * same values and there's no need to push them into the storage block by block.
+     */
+    for (int i = 0; i < n_fx_params; ++i)
+    {
+        fxstorage->p[fx_param_remap[i]].set_value_f01(*fxParams[i]);
+        paramFeatureOntoParam(&(fxstorage->p[fx_param_remap[i]]), paramFeatures[i]);
+    }
+    copyGlobaldataSubset(storage_id_start, storage_id_end);
+
+    // a mono or stereo input feeds the one stereo output; wider buses match up channel for channel
+    auto inChan = [&](int c) {
+        if (channelPairs == 1)
+            return c == 0 ? inChanL : inChanR;
+        return c;
+    };
 
     if (nonLatentBlockMode)
     {
         auto sideChainBus = getBus(true, 1);
+        bool useSideChain = (effectNum == fxt_vocoder || effectNum == fxt_ringmod) &&
+                            sideChainBus && sideChainBus->isEnabled();
 
         for (int outPos = 0; outPos < buffer.getNumSamples() && !resettingFx; outPos += BLOCK_SIZE)
         {
-            auto outL = mainOutput.getWritePointer(0, outPos);
-            auto outR = mainOutput.getWritePointer(1, outPos);
-
-            if ((effectNum == fxt_vocoder || effectNum == fxt_ringmod) && sideChainBus &&
-                sideChainBus->isEnabled())
+            if (useSideChain)
             {
                 auto sideL = sideChainInput.getReadPointer(0, outPos);
                 auto sideR = sideChainInput.getReadPointer(1, outPos);
@@ -362,41 +402,46 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                 }
             }
 
-            for (int i = 0; i < n_fx_params; ++i)
+            for (int pair = 0; pair < channelPairs; ++pair)
             {
-                fxstorage->p[fx_param_remap[i]].set_value_f01(*fxParams[i]);
-                paramFeatureOntoParam(&(fxstorage->p[fx_param_remap[i]]), paramFeatures[i]);
-            }
-            copyGlobaldataSubset(storage_id_start, storage_id_end);
+                auto fx = audioThreadEffectForPair(pair);
+                if (!fx)
+                    continue;
 
-            auto inL = mainInput.getReadPointer(inChanL, outPos);
-            auto inR = mainInput.getReadPointer(inChanR, outPos);
+                auto outL = mainOutput.getWritePointer(2 * pair, outPos);
+                auto outR = mainOutput.getWritePointer(2 * pair + 1, outPos);
+                auto inL = mainInput.getReadPointer(inChan(2 * pair), outPos);
+                auto inR = mainInput.getReadPointer(inChan(2 * pair + 1), outPos);
 
-            if (is_aligned(outL, 16) && is_aligned(outR, 16) && inL == outL && inR == outR)
-            {
-                audio_thread_surge_effect->process_ringout(outL, outR, true);
-            }
-            else
-            {
-                float bufferL alignas(16)[BLOCK_SIZE], bufferR alignas(16)[BLOCK_SIZE];
+                if (is_aligned(outL, 16) && is_aligned(outR, 16) && inL == outL && inR == outR)
+                {
+                    fx->process_ringout(outL, outR, true);
+                }
+                else
+                {
+                    float bufferL alignas(16)[BLOCK_SIZE], bufferR alignas(16)[BLOCK_SIZE];
 
-                memcpy(bufferL, inL, BLOCK_SIZE * sizeof(float));
-                memcpy(bufferR, inR, BLOCK_SIZE * sizeof(float));
+                    memcpy(bufferL, inL, BLOCK_SIZE * sizeof(float));
+                    memcpy(bufferR, inR, BLOCK_SIZE * sizeof(float));
 
-                audio_thread_surge_effect->process_ringout(bufferL, bufferR, true);
+                    fx->process_ringout(bufferL, bufferR, true);
 
-                memcpy(outL, bufferL, BLOCK_SIZE * sizeof(float));
-                memcpy(outR, bufferR, BLOCK_SIZE * sizeof(float));
+                    memcpy(outL, bufferL, BLOCK_SIZE * sizeof(float));
+                    memcpy(outR, bufferR, BLOCK_SIZE * sizeof(float));
+                }
             }
         }
     }
     else
     {
-        auto outL = mainOutput.getWritePointer(0, 0);
-        auto outR = mainOutput.getWritePointer(1, 0);
-
-        auto inL = mainInput.getReadPointer(inChanL, 0);
-        auto inR = mainInput.getReadPointer(inChanR, 0);
+        const int nChannels = 2 * channelPairs;
+        float *outs[2 * maxChannelPairs];
+        const float *ins[2 * maxChannelPairs];
+        for (int c = 0; c < nChannels; ++c)
+        {
+            outs[c] = mainOutput.getWritePointer(c, 0);
+            ins[c] = mainInput.getReadPointer(inChan(c), 0);
+        }
 
         const float *sideL = nullptr, *sideR = nullptr;
 
@@ -410,8 +455,9 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
         for (int smp = 0; smp < buffer.getNumSamples(); smp++)
         {
-            input_buffer[0][input_position] = inL[smp];
-            input_buffer[1][input_position] = inR[smp];
+            for (int c = 0; c < nChannels; ++c)
+                input_buffer[c][input_position] = ins[c][smp];
+
             if (effectNum == fxt_vocoder && sideL && sideR)
             {
                 sidechain_buffer[0][input_position] = sideL[smp];
@@ -429,29 +475,27 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                 memcpy(storage->audio_in_nonOS[0], sidechain_buffer[0], BLOCK_SIZE * sizeof(float));
                 memcpy(storage->audio_in_nonOS[1], sidechain_buffer[1], BLOCK_SIZE * sizeof(float));
 
-                for (int i = 0; i < n_fx_params; ++i)
+                for (int pair = 0; pair < channelPairs; ++pair)
                 {
-                    fxstorage->p[fx_param_remap[i]].set_value_f01(*fxParams[i]);
-                    paramFeatureOntoParam(&(fxstorage->p[fx_param_remap[i]]), paramFeatures[i]);
+                    if (auto fx = audioThreadEffectForPair(pair))
+                        fx->process_ringout(input_buffer[2 * pair], input_buffer[2 * pair + 1],
+                                            true);
                 }
-                copyGlobaldataSubset(storage_id_start, storage_id_end);
-
-                audio_thread_surge_effect->process_ringout(input_buffer[0], input_buffer[1], true);
-                memcpy(output_buffer, input_buffer, 2 * BLOCK_SIZE * sizeof(float));
+                memcpy(output_buffer, input_buffer, nChannels * BLOCK_SIZE * sizeof(float));
                 input_position = 0;
                 output_position = 0;
             }
 
             if (output_position >= 0 && output_position < BLOCK_SIZE) // that < should never happen
             {
-                outL[smp] = output_buffer[0][output_position];
-                outR[smp] = output_buffer[1][output_position];
+                for (int c = 0; c < nChannels; ++c)
+                    outs[c][smp] = output_buffer[c][output_position];
                 output_position++;
             }
             else
             {
-                outL[smp] = 0;
-                outR[smp] = 0;
+                for (int c = 0; c < nChannels; ++c)
+                    outs[c][smp] = 0;
             }
         }
     }
@@ -460,16 +504,26 @@ void SurgefxAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     bool doHardClip{true};
     if (doHardClip)
     {
-        auto outL = mainOutput.getWritePointer(0, 0);
-        auto outR = mainOutput.getWritePointer(1, 0);
-
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        for (int c = 0; c < 2 * channelPairs; ++c)
         {
-            outL[i] = std::clamp(outL[i], -2.f, 2.f);
-            outR[i] = std::clamp(outR[i], -2.f, 2.f);
+            auto out = mainOutput.getWritePointer(c, 0);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                out[i] = std::clamp(out[i], -2.f, 2.f);
         }
     }
 
+    // an effect with lookahead delays its output on top of our own block latency
+    auto latency = nonLatentBlockMode ? 0 : BLOCK_SIZE;
+
+    if (audio_thread_surge_effect)
+        latency += audio_thread_surge_effect->get_latency_samples();
+
+    if (getLatencySamples() != latency)
+    {
+        setLatencySamples(latency);
+    }
+
     if (oscReceiving)
         processBlockOSC();
 }
@@ -734,9 +788,31 @@ void SurgefxAudioProcessor::resetFxType(int type, bool updateJuceParams)
         surge_effect->init_ctrltypes();
         surge_effect->init_default_values();
     }
+
+    for (int i = 0; i < spawnedChannelPairs - 1; ++i)
+        extra_pair_effects[i].reset();
+    spawnExtraPairEffects(spawnedChannelPairs);
+
     resetFxParams(updateJuceParams);
 }
 
+void SurgefxAudioProcessor::spawnExtraPairEffects(int channelPairs)
+{
+    // the first pair's instance owns the parameter setup, so the others only need init()
+    for (int i = 0; i < channelPairs - 1; ++i)
+    {
+        if (extra_pair_effects[i] || !surge_effect)
+            continue;
+
+        extra_pair_effects[i].reset(spawn_effect(effectNum, storage.get(),
+                                                 &(storage->getPatch().fx[0]),
+                                                 storage->getPatch().globaldata));
+        if (extra_pair_effects[i])
+            extra_pair_effects[i]->init();
+    }
+    spawnedChannelPairs = std::max(spawnedChannelPairs, channelPairs);
+}
+
 void SurgefxAudioProcessor::resetFxParams(bool updateJuceParams)
 {
     reorderSurgeParams();
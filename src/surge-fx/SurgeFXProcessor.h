@@ -47,9 +47,17 @@ class SurgefxAudioProcessor : public juce::AudioProcessor,
     SurgefxAudioProcessor();
     ~SurgefxAudioProcessor();
 
-    float input_buffer alignas(16)[2][BLOCK_SIZE];
+    /*
+     * Buses wider than stereo (multiple stereo pairs, or beds like 7.1.4) are processed a
+     * pair of channels at a time in bus order, each pair with its own instance of the effect.
+     * They all read the same parameters, which are set once a block, and only the first
+     * pair's instance talks to the UI.
+     */
+    static constexpr int maxChannelPairs = 8;
+
+    float input_buffer alignas(16)[2 * maxChannelPairs][BLOCK_SIZE];
     float sidechain_buffer alignas(16)[2][BLOCK_SIZE];
-    float output_buffer alignas(16)[2][BLOCK_SIZE];
+    float output_buffer alignas(16)[2 * maxChannelPairs][BLOCK_SIZE];
     int input_position{0};
     int output_position{-1};
 
@@ -390,6 +398,17 @@ class SurgefxAudioProcessor : public juce::AudioProcessor,
 
     std::shared_ptr<Effect> surge_effect;
     std::shared_ptr<Effect> audio_thread_surge_effect;
+
+    // the instances for the second and later channel pairs, see maxChannelPairs
+    std::array<std::shared_ptr<Effect>, maxChannelPairs - 1> extra_pair_effects,
+        audio_thread_extra_pair_effects;
+    int spawnedChannelPairs{1};
+    void spawnExtraPairEffects(int channelPairs);
+    Effect *audioThreadEffectForPair(int pair)
+    {
+        return pair == 0 ? audio_thread_surge_effect.get()
+                         : audio_thread_extra_pair_effects[pair - 1].get();
+    }
     std::atomic<bool> resettingFx;
     FxStorage *fxstorage;
     int storage_id_start, storage_id_end;
@@ -29,6 +29,8 @@
 #include "SurgeSynthesizer.h"
 #include "SurgeStorage.h"
 #include "version.h"
+#include "PatchSnapshot.h"
+#include "WAVFileWriter.h"
 #include "filesystem/import.h"
 
 namespace py = pybind11;
@@ -48,6 +50,25 @@ class PythonPluginLayerProxy : public SurgeSynthesizer::PluginLayer
 static std::unique_ptr<PythonPluginLayerProxy> spysetup_parent = nullptr;
 static std::mutex spysetup_mutex;
 
+/*
+ * Event types for the rows handed to processMultiBlockWithEvents
+ */
+enum SurgePyEventType
+{
+    ev_note_on = 0,
+    ev_note_off,
+    ev_cc,
+    ev_pitch_bend,
+    ev_param
+};
+
+struct SurgePyEvent
+{
+    int64_t offset;
+    int type, a, b;
+    double value;
+};
+
 /*
  * The way we've decided to expose to python is through some wrapper objects
  * which give us the control group / control group entry / param hierarchy.
@@ -606,6 +627,97 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
         return oss.str();
     }
 
+    /*
+     * Bulk parameter access. Values are normalized 0..1 and indexed by synth side id, so
+     * getAllParams() doubles as a snapshot which setAllParams() restores. A set lands
+     * entirely between two blocks, even if another thread is inside processMultiBlock.
+     */
+    py::array_t<float> getAllParams()
+    {
+        auto &params = storage.getPatch().param_ptr;
+        auto res = py::array_t<float>(params.size());
+        auto ptr = static_cast<float *>(res.request(true).ptr);
+
+        std::lock_guard<std::mutex> g(blockMutex);
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            ptr[i] = params[i] ? params[i]->get_value_f01() : 0.f;
+        }
+        return res;
+    }
+
+    void setParams(const py::array_t<int, py::array::c_style | py::array::forcecast> &ids,
+                   const py::array_t<float, py::array::c_style | py::array::forcecast> &values)
+    {
+        auto id_buf = ids.request();
+        auto val_buf = values.request();
+
+        if (id_buf.ndim != 1 || val_buf.ndim != 1 || id_buf.size != val_buf.size)
+        {
+            throw std::invalid_argument(
+                "setParams needs two one dimensional arrays of the same length");
+        }
+
+        auto idp = static_cast<const int *>(id_buf.ptr);
+        auto &params = storage.getPatch().param_ptr;
+
+        for (auto i = 0; i < id_buf.size; ++i)
+        {
+            if (idp[i] < 0 || idp[i] >= params.size() || !params[idp[i]])
+            {
+                std::ostringstream oss;
+                oss << "setParams given unknown parameter id " << idp[i] << " at index " << i;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+        }
+
+        applyNormalizedParams(idp, static_cast<const float *>(val_buf.ptr), id_buf.size);
+    }
+
+    void setAllParams(const py::array_t<float, py::array::c_style | py::array::forcecast> &values)
+    {
+        auto val_buf = values.request();
+        auto &params = storage.getPatch().param_ptr;
+
+        if (val_buf.ndim != 1 || val_buf.size != params.size())
+        {
+            std::ostringstream oss;
+            oss << "setAllParams needs a one dimensional array of " << params.size()
+                << " values, as returned by getAllParams";
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        std::vector<int> idv;
+        idv.reserve(params.size());
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            if (params[i])
+                idv.push_back(i);
+        }
+
+        auto vp = static_cast<const float *>(val_buf.ptr);
+        std::vector<float> vals;
+        vals.reserve(idv.size());
+        for (auto i : idv)
+            vals.push_back(vp[i]);
+
+        applyNormalizedParams(idv.data(), vals.data(), idv.size());
+    }
+
+    void applyNormalizedParams(const int *ids, const float *values, size_t n)
+    {
+        std::lock_guard<std::mutex> g(blockMutex);
+        for (size_t i = 0; i < n; ++i)
+        {
+            SurgeSynthesizer::ID id;
+            if (fromSynthSideId(ids[i], id))
+                setParameter01(id, std::clamp(values[i], 0.f, 1.f));
+        }
+    }
+
+    // Held around each rendered block and each bulk parameter update
+    std::mutex blockMutex;
+
     void setParamVal(const SurgePyNamedParam &id, float f)
     {
         auto p = storage.getPatch().param_ptr[id.getID().getSynthSideId()];
@@ -658,6 +770,20 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
 
     void savePatchPy(const std::string &s) { savePatchToPath(string_to_path(s)); }
 
+    std::unique_ptr<Surge::Storage::PatchSnapshot> capturePatchSnapshotPy()
+    {
+        auto res = std::make_unique<Surge::Storage::PatchSnapshot>();
+        std::lock_guard<std::mutex> g(blockMutex);
+        res->capture(storage.getPatch());
+        return res;
+    }
+
+    void restorePatchSnapshotPy(const Surge::Storage::PatchSnapshot &snap)
+    {
+        std::lock_guard<std::mutex> g(blockMutex);
+        restorePatchSnapshot(snap);
+    }
+
     std::string factoryDataPath() const { return storage.datapath.u8string(); }
 
     std::string userDataPath() const { return storage.userDataPath.u8string(); }
@@ -772,9 +898,18 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
 
         process_input = false;
 
+        /*
+         * The engine doesn't touch any Python objects while it renders, so let other
+         * Python threads (say, ones driving other instances) run in the meantime.
+         */
+        py::gil_scoped_release release;
+
         for (auto i = 0; i < blockIterations; ++i)
         {
-            process();
+            {
+                std::lock_guard<std::mutex> g(blockMutex);
+                process();
+            }
             time_data.ppqPos += (double)BLOCK_SIZE * time_data.tempo / (60. * storage.samplerate);
             memcpy((void *)dL, (void *)(output[0]), BLOCK_SIZE * sizeof(float));
             memcpy((void *)dR, (void *)(output[1]), BLOCK_SIZE * sizeof(float));
@@ -871,11 +1006,16 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
         float *oL = out_ptr + startBlock * BLOCK_SIZE;
         float *oR = out_ptr + out_buf.shape[1] + startBlock * BLOCK_SIZE;
 
+        py::gil_scoped_release release;
+
         for (auto i = 0; i < blockIterations; ++i)
         {
             memcpy((void *)(input[0]), (void *)iL, BLOCK_SIZE * sizeof(float));
             memcpy((void *)(input[1]), (void *)iR, BLOCK_SIZE * sizeof(float));
-            process();
+            {
+                std::lock_guard<std::mutex> g(blockMutex);
+                process();
+            }
             time_data.ppqPos += (double)BLOCK_SIZE * time_data.tempo / (60. * storage.samplerate);
             memcpy((void *)oL, (void *)(output[0]), BLOCK_SIZE * sizeof(float));
             memcpy((void *)oR, (void *)(output[1]), BLOCK_SIZE * sizeof(float));
@@ -887,6 +1027,357 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
         }
     }
 
+    /*
+     * Render like processMultiBlock, but apply a pre-sorted table of events as the render
+     * reaches them. Each row of the (n, 5) events array is
+     *     [sampleOffset, eventType, a, b, value]
+     * where sampleOffset counts from the start of startBlock and eventType is one of the
+     * surgepy.constants.ev_* values:
+     *     ev_note_on / ev_note_off: a = channel, b = key, value = velocity
+     *     ev_cc: a = channel, b = controller, value = controller value
+     *     ev_pitch_bend: a = channel, value = bend (-8192 .. 8191)
+     *     ev_param: a = synth side id, value = the parameter value, as in setParamVal
+     * Rows are read once up front with the GIL held; the render itself runs without it.
+     */
+    void processMultiBlockWithEvents(const py::array_t<float> &arr,
+                                     const py::array_t<double, py::array::c_style |
+                                                                   py::array::forcecast> &events,
+                                     int startBlock = 0, int nBlocks = -1)
+    {
+        auto buf = arr.request(true);
+        auto ev_buf = events.request();
+
+        /*
+         * Error condition checks
+         */
+        if (buf.itemsize != sizeof(float))
+        {
+            std::ostringstream oss;
+            oss << "Output numpy array must have dtype float; you provided an array with "
+                << buf.format << "/" << buf.size;
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        if (buf.ndim != 2 || buf.shape[0] != 2 || buf.shape[1] % BLOCK_SIZE != 0)
+        {
+            std::ostringstream oss;
+            oss << "Output numpy array must have dimensions (2, m*BLOCK_SIZE); you provided an "
+                   "array with "
+                << buf.ndim << " dimensions";
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        size_t maxBlockStorage = buf.shape[1] / BLOCK_SIZE;
+
+        if (startBlock >= maxBlockStorage)
+        {
+            std::ostringstream oss;
+            oss << "Start block of " << startBlock << " is beyond the end of input storage with "
+                << maxBlockStorage << " blocks";
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        int blockIterations = maxBlockStorage - startBlock;
+
+        if (nBlocks > 0)
+        {
+            blockIterations = nBlocks;
+        }
+
+        if (startBlock + blockIterations > maxBlockStorage)
+        {
+            std::ostringstream oss;
+            oss << "Start block / nBlock combo " << startBlock << " " << nBlocks
+                << " is beyond the end of input storage with " << maxBlockStorage << " blocks";
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        auto evs = eventsFromArray(ev_buf);
+
+        auto ptr = static_cast<float *>(buf.ptr);
+        float *dL = ptr + startBlock * BLOCK_SIZE;
+        float *dR = ptr + buf.shape[1] + startBlock * BLOCK_SIZE;
+
+        py::gil_scoped_release release;
+
+        size_t nextEvent = 0;
+        renderBlocksWithEvents(evs, nextEvent, 0, dL, dR, blockIterations);
+    }
+
+    /*
+     * Read an (n, 5) events array into SurgePyEvents, checking it as we go. Needs the GIL.
+     */
+    std::vector<SurgePyEvent> eventsFromArray(const py::buffer_info &ev_buf)
+    {
+        if (ev_buf.size != 0 && (ev_buf.ndim != 2 || ev_buf.shape[1] != 5))
+        {
+            std::ostringstream oss;
+            oss << "Event numpy array must have dimensions (n, 5); you provided an array with "
+                << ev_buf.ndim << " dimensions";
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        std::vector<SurgePyEvent> evs;
+        auto nEvents = ev_buf.size == 0 ? 0 : ev_buf.shape[0];
+        auto ev_ptr = static_cast<const double *>(ev_buf.ptr);
+        evs.reserve(nEvents);
+
+        for (auto i = 0; i < nEvents; ++i)
+        {
+            auto row = ev_ptr + i * 5;
+            SurgePyEvent e{(int64_t)row[0], (int)row[1], (int)row[2], (int)row[3], row[4]};
+
+            if (e.offset < 0 || (!evs.empty() && e.offset < evs.back().offset))
+            {
+                std::ostringstream oss;
+                oss << "Event " << i << " at sample " << e.offset
+                    << " is negative or out of order; events must be sorted by sample offset";
+                throw std::invalid_argument(oss.str().c_str());
+            }
+
+            if (e.type < ev_note_on || e.type > ev_param)
+            {
+                std::ostringstream oss;
+                oss << "Event " << i << " has unknown type " << e.type;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+
+            if (e.type == ev_param && (e.a < 0 || e.a >= storage.getPatch().param_ptr.size() ||
+                                       !storage.getPatch().param_ptr[e.a]))
+            {
+                std::ostringstream oss;
+                oss << "Event " << i << " refers to unknown parameter id " << e.a;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+
+            evs.push_back(e);
+        }
+
+        return evs;
+    }
+
+    /*
+     * Render nBlocks into dL / dR, applying evs as each block is reached. Event offsets count
+     * from the start of the whole render, of which dL is sample firstSample, and nextEvent
+     * carries the position in evs from one call to the next. Touches no Python objects, so
+     * it is safe to call without the GIL.
+     */
+    void renderBlocksWithEvents(const std::vector<SurgePyEvent> &evs, size_t &nextEvent,
+                                int64_t firstSample, float *dL, float *dR, int nBlocks)
+    {
+        process_input = false;
+
+        auto applyEvent = [this](const SurgePyEvent &e) {
+            switch (e.type)
+            {
+            case ev_note_on:
+                playNote(e.a, e.b, (int)e.value, 0);
+                break;
+            case ev_note_off:
+                releaseNote(e.a, e.b, (int)e.value);
+                break;
+            case ev_cc:
+                channelController(e.a, e.b, (int)e.value);
+                break;
+            case ev_pitch_bend:
+                pitchBend(e.a, (int)e.value);
+                break;
+            case ev_param:
+            {
+                SurgeSynthesizer::ID id;
+                if (fromSynthSideId(e.a, id))
+                {
+                    auto p = storage.getPatch().param_ptr[e.a];
+                    setParameter01(id, p->value_to_normalized((float)e.value));
+                }
+                break;
+            }
+            }
+        };
+
+        for (auto i = 0; i < nBlocks; ++i)
+        {
+            int64_t blockStart = firstSample + (int64_t)i * BLOCK_SIZE;
+
+            while (nextEvent < evs.size() && evs[nextEvent].offset < blockStart + BLOCK_SIZE)
+            {
+                if (sampleAccurateNoteOns)
+                {
+                    noteOnSampleOffset = (int)(evs[nextEvent].offset - blockStart);
+                }
+                applyEvent(evs[nextEvent]);
+                nextEvent++;
+            }
+            noteOnSampleOffset = 0;
+
+            {
+                std::lock_guard<std::mutex> g(blockMutex);
+                process();
+            }
+            time_data.ppqPos += (double)BLOCK_SIZE * time_data.tempo / (60. * storage.samplerate);
+            memcpy((void *)dL, (void *)(output[0]), BLOCK_SIZE * sizeof(float));
+            memcpy((void *)dR, (void *)(output[1]), BLOCK_SIZE * sizeof(float));
+
+            dL += BLOCK_SIZE;
+            dR += BLOCK_SIZE;
+        }
+    }
+
+    /*
+     * Render nBlocks straight to a WAV file, applying events as processMultiBlockWithEvents
+     * does. The engine renders a batch of blocks at a time into a small buffer and hands it to
+     * a WAVFileWriter, whose own thread encodes and writes while the next batch renders, so
+     * memory stays the same however long the render is.
+     */
+    void renderToFile(const std::string &path,
+                      const py::array_t<double, py::array::c_style | py::array::forcecast> &events,
+                      int nBlocks, const std::string &format)
+    {
+        using Surge::Storage::WAVFileWriter;
+
+        WAVFileWriter::Format fmt;
+        if (format == "float32")
+            fmt = WAVFileWriter::FLOAT32;
+        else if (format == "int24")
+            fmt = WAVFileWriter::PCM24;
+        else if (format == "int16")
+            fmt = WAVFileWriter::PCM16;
+        else
+        {
+            throw std::invalid_argument(
+                (std::string("Unknown format '") + format + "'; use float32, int24 or int16")
+                    .c_str());
+        }
+
+        if (nBlocks <= 0)
+        {
+            throw std::invalid_argument("renderToFile needs at least one block");
+        }
+
+        auto evs = eventsFromArray(events.request());
+
+        WAVFileWriter writer;
+        std::string err;
+
+        if (!writer.open(string_to_path(path), 2, (int)storage.samplerate, fmt, err))
+        {
+            throw std::runtime_error(err.c_str());
+        }
+
+        bool closed{false};
+
+        {
+            py::gil_scoped_release release;
+
+            static constexpr int batchBlocks = 64;
+            std::vector<float> bufL(batchBlocks * BLOCK_SIZE), bufR(batchBlocks * BLOCK_SIZE);
+            const float *chans[2] = {bufL.data(), bufR.data()};
+            size_t nextEvent = 0;
+
+            for (int b = 0; b < nBlocks; b += batchBlocks)
+            {
+                auto n = std::min(batchBlocks, nBlocks - b);
+                renderBlocksWithEvents(evs, nextEvent, (int64_t)b * BLOCK_SIZE, bufL.data(),
+                                       bufR.data(), n);
+                writer.write(chans, n * BLOCK_SIZE);
+            }
+
+            closed = writer.close(err);
+        }
+
+        if (!closed)
+        {
+            throw std::runtime_error(err.c_str());
+        }
+    }
+
+    py::dict getProcessProfile(int nBlocks, bool peak)
+    {
+        auto prof = peak ? processProfiler.getPeak(nBlocks) : processProfiler.getAverage(nBlocks);
+
+        auto res = py::dict();
+        for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+        {
+            res[py::str(Surge::Profiling::ProcessProfiler::stageName(i))] = prof.usec[i];
+        }
+        return res;
+    }
+
+    py::dict getLatencyHistogram()
+    {
+        using Surge::Profiling::LatencyHistogram;
+        const auto &h = processProfiler.getHistogram();
+
+        auto bounds = py::list(), counts = py::list();
+        for (int b = 0; b < LatencyHistogram::nBuckets; ++b)
+        {
+            // only the occupied buckets, or a typical run is mostly zeros
+            if (auto c = h.countInBucket(b))
+            {
+                bounds.append(LatencyHistogram::bucketUpperBound(b));
+                counts.append(c);
+            }
+        }
+
+        auto res = py::dict();
+        res["count"] = h.count();
+        res["max"] = h.max();
+        res["p50"] = h.percentile(50);
+        res["p90"] = h.percentile(90);
+        res["p99"] = h.percentile(99);
+        res["p999"] = h.percentile(99.9);
+        res["bucketUpperBounds"] = bounds;
+        res["bucketCounts"] = counts;
+        res["budget"] = BLOCK_SIZE * storage.dsamplerate_inv * 1000000;
+        return res;
+    }
+
+    py::list getWorstBlocks()
+    {
+        auto res = py::list();
+        for (const auto &w : processProfiler.getWorstBlocks())
+        {
+            auto d = py::dict();
+            d["usec"] = w.profile.usec[Surge::Profiling::ps_total];
+            d["blockIndex"] = w.blockIndex;
+            d["wallClockMS"] = w.wallClockMS;
+            d["voices"] = w.profile.voices;
+            d["noteOns"] = w.profile.noteOns;
+            d["events"] = Surge::Profiling::ProcessProfiler::blockEventNames(w.profile.events);
+
+            auto stages = py::dict();
+            for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+                stages[py::str(Surge::Profiling::ProcessProfiler::stageName(i))] =
+                    w.profile.usec[i];
+            d["stages"] = stages;
+            res.append(d);
+        }
+        return res;
+    }
+
+    void resetLatencyStats() { processProfiler.resetLatencyStats(); }
+
+    py::dict getMemoryReport()
+    {
+        auto m = memoryReport();
+
+        auto fxs = py::list();
+        for (auto f : m.fxSlots)
+            fxs.append(f);
+
+        auto res = py::dict();
+        res["voices"] = m.voices;
+        res["oscillatorBuffers"] = m.oscillatorBuffers;
+        res["filterStates"] = m.filterStates;
+        res["fxSlots"] = fxs;
+        res["wavetables"] = m.wavetables;
+        res["memoryPools"] = m.memoryPools;
+        res["lua"] = m.lua;
+        res["patchDB"] = m.patchDB;
+        res["total"] = m.total();
+        return res;
+    }
+
     py::dict getPatchAsPy()
     {
         auto pc = SurgePyPatchConverter(this);
@@ -1048,6 +1539,435 @@ SurgeSynthesizer *createSurge(float sr)
     return surge;
 }
 
+/*
+ * Just enough of the DLPack ABI (https://dmlc.github.io/dlpack) to write into a tensor handed
+ * over by torch, JAX, CuPy and friends. It is a stable C ABI, so this is all the dependency
+ * it needs.
+ */
+namespace dlpack
+{
+enum DeviceType : int32_t
+{
+    kDLCPU = 1,
+    kDLCUDAHost = 3, // pinned host memory, which is still ours to write
+    kDLROCMHost = 11,
+};
+
+enum DataTypeCode : uint8_t
+{
+    kDLFloat = 2,
+};
+
+struct DLDevice
+{
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType
+{
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor
+{
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides;
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor
+{
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(DLManagedTensor *self);
+};
+} // namespace dlpack
+
+/*
+ * A C contiguous (jobs, 2, samples) float32 array we render straight into: either anything
+ * with the buffer protocol, like a numpy array, or anything with __dlpack__, like a torch
+ * tensor in pinned memory. It holds on to the array until released, which needs the GIL.
+ */
+class SurgePyAudioTarget
+{
+  public:
+    SurgePyAudioTarget() = default;
+    SurgePyAudioTarget(const py::object &o, size_t nJobs, size_t nSamples)
+    {
+        std::vector<int64_t> shape, strides;
+        size_t itemsize{0};
+        bool isFloat{false};
+
+        if (py::isinstance<py::buffer>(o))
+        {
+            auto buf = o.cast<py::buffer>().request(true);
+            data = static_cast<float *>(buf.ptr);
+            shape.assign(buf.shape.begin(), buf.shape.end());
+            strides.assign(buf.strides.begin(), buf.strides.end());
+            itemsize = buf.itemsize;
+            isFloat = buf.format == py::format_descriptor<float>::format();
+            keepAlive = o;
+        }
+        else if (py::hasattr(o, "__dlpack__"))
+        {
+            auto capsule = o.attr("__dlpack__")().cast<py::capsule>();
+            managed = capsule.get_pointer<dlpack::DLManagedTensor>();
+            // the consumer renames the capsule, so its destructor leaves the tensor to us
+            if (PyCapsule_SetName(capsule.ptr(), "used_dltensor") != 0)
+                throw py::error_already_set();
+
+            auto &t = managed->dl_tensor;
+            if (t.device.device_type != dlpack::kDLCPU &&
+                t.device.device_type != dlpack::kDLCUDAHost &&
+                t.device.device_type != dlpack::kDLROCMHost)
+            {
+                release();
+                throw std::invalid_argument("Render targets must be in host memory, pinned or "
+                                            "not; this tensor lives on a device");
+            }
+
+            data = reinterpret_cast<float *>(static_cast<char *>(t.data) + t.byte_offset);
+            shape.assign(t.shape, t.shape + t.ndim);
+            if (t.strides)
+            {
+                for (int i = 0; i < t.ndim; ++i)
+                    strides.push_back(t.strides[i] * sizeof(float));
+            }
+            itemsize = t.dtype.bits / 8;
+            isFloat = t.dtype.code == dlpack::kDLFloat && t.dtype.lanes == 1;
+        }
+        else
+        {
+            throw std::invalid_argument(
+                "Render targets must support the buffer protocol or __dlpack__");
+        }
+
+        if (!isFloat || itemsize != sizeof(float))
+        {
+            release();
+            throw std::invalid_argument("Render targets must be float32");
+        }
+
+        if (shape != std::vector<int64_t>{(int64_t)nJobs, 2, (int64_t)nSamples})
+        {
+            std::ostringstream oss;
+            oss << "Render target must have shape (" << nJobs << ", 2, " << nSamples << ")";
+            release();
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        // no strides at all means C contiguous in DLPack
+        if (!strides.empty() &&
+            strides != std::vector<int64_t>{(int64_t)(2 * nSamples * sizeof(float)),
+                                            (int64_t)(nSamples * sizeof(float)),
+                                            (int64_t)sizeof(float)})
+        {
+            release();
+            throw std::invalid_argument("Render targets must be C contiguous");
+        }
+    }
+
+    SurgePyAudioTarget(const SurgePyAudioTarget &) = delete;
+    SurgePyAudioTarget &operator=(const SurgePyAudioTarget &) = delete;
+    SurgePyAudioTarget(SurgePyAudioTarget &&other) noexcept { *this = std::move(other); }
+    SurgePyAudioTarget &operator=(SurgePyAudioTarget &&other) noexcept
+    {
+        std::swap(data, other.data);
+        std::swap(managed, other.managed);
+        std::swap(keepAlive, other.keepAlive);
+        return *this;
+    }
+    ~SurgePyAudioTarget() { release(); }
+
+    void release()
+    {
+        if (managed && managed->deleter)
+            managed->deleter(managed);
+        managed = nullptr;
+        keepAlive = py::object();
+        data = nullptr;
+    }
+
+    float *data{nullptr};
+
+  private:
+    dlpack::DLManagedTensor *managed{nullptr};
+    py::object keepAlive;
+};
+
+/*
+ * Render a list of (patch, events, length, parameter overrides) jobs across a set of threads,
+ * each owning its own synth, into one stacked array. SurgeStorage already shares its immutable
+ * tables between every instance in the process, so a worker costs its own patch and voice
+ * state rather than a whole process.
+ */
+class SurgePyBatchRenderer
+{
+  public:
+    SurgePyBatchRenderer(float sr, int numThreads)
+    {
+        if (numThreads <= 0)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        // Synth construction reads the factory data, so do that serially up front
+        for (int i = 0; i < numThreads; ++i)
+        {
+            synths.emplace_back(
+                static_cast<SurgeSynthesizerWithPythonExtensions *>(createSurge(sr)));
+        }
+    }
+
+    void addJob(const std::string &patch,
+                const py::array_t<double, py::array::c_style | py::array::forcecast> &events,
+                int nBlocks, const py::dict &overrides)
+    {
+        if (!fs::exists(string_to_path(patch)))
+        {
+            throw std::invalid_argument((std::string("File not found: ") + patch).c_str());
+        }
+
+        if (nBlocks <= 0)
+        {
+            throw std::invalid_argument("Batch render jobs need at least one block");
+        }
+
+        Job job;
+        job.patch = patch;
+        job.nBlocks = nBlocks;
+        job.events = synths[0]->eventsFromArray(events.request());
+
+        auto &params = synths[0]->storage.getPatch().param_ptr;
+
+        for (auto &kv : overrides)
+        {
+            int id = py::isinstance<SurgePyNamedParam>(kv.first)
+                         ? kv.first.cast<SurgePyNamedParam>().getID().getSynthSideId()
+                         : kv.first.cast<int>();
+
+            if (id < 0 || id >= params.size() || !params[id])
+            {
+                std::ostringstream oss;
+                oss << "Parameter override refers to unknown parameter id " << id;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+
+            job.overrides.emplace_back(id, kv.second.cast<float>());
+        }
+
+        jobs.push_back(std::move(job));
+    }
+
+    size_t numJobs() const { return jobs.size(); }
+
+    void clearJobs() { jobs.clear(); }
+
+    ~SurgePyBatchRenderer()
+    {
+        if (inFlight.runner.joinable())
+        {
+            py::gil_scoped_release release;
+            inFlight.runner.join();
+        }
+    }
+
+    py::tuple outputShape() const
+    {
+        return py::make_tuple(jobs.size(), 2, maxBlocks(jobs) * BLOCK_SIZE);
+    }
+
+    py::array_t<float> render()
+    {
+        checkIdle();
+
+        const size_t nSamples = maxBlocks(jobs) * BLOCK_SIZE;
+        auto res = py::array_t<float>({jobs.size(), (size_t)2, nSamples});
+        auto ptr = static_cast<float *>(res.request(true).ptr);
+
+        std::vector<char> failed(jobs.size(), 0);
+
+        {
+            py::gil_scoped_release release;
+            renderAll(jobs, ptr, failed);
+        }
+
+        throwIfFailed(jobs, failed);
+        return res;
+    }
+
+    void renderInto(const py::object &out)
+    {
+        checkIdle();
+
+        SurgePyAudioTarget target(out, jobs.size(), maxBlocks(jobs) * BLOCK_SIZE);
+        std::vector<char> failed(jobs.size(), 0);
+
+        {
+            py::gil_scoped_release release;
+            renderAll(jobs, target.data, failed);
+        }
+
+        target.release();
+        throwIfFailed(jobs, failed);
+    }
+
+    /*
+     * Start rendering the queued jobs into out on the renderer's threads and return at once,
+     * so the caller can queue and then start the next batch into a second buffer while it
+     * consumes this one. wait() finishes it. The jobs are copied, so the queue is free to
+     * change meanwhile, but out must not be read until wait() returns.
+     */
+    void renderAsync(const py::object &out)
+    {
+        checkIdle();
+
+        inFlight.target = SurgePyAudioTarget(out, jobs.size(), maxBlocks(jobs) * BLOCK_SIZE);
+        inFlight.jobs = jobs;
+        inFlight.failed.assign(jobs.size(), 0);
+        inFlight.runner = std::thread([this]() {
+            renderAll(inFlight.jobs, inFlight.target.data, inFlight.failed);
+        });
+    }
+
+    void wait()
+    {
+        if (!inFlight.runner.joinable())
+            return;
+
+        {
+            py::gil_scoped_release release;
+            inFlight.runner.join();
+        }
+
+        inFlight.target.release();
+        auto finished = std::move(inFlight.jobs);
+        auto failed = std::move(inFlight.failed);
+        inFlight.jobs.clear();
+        inFlight.failed.clear();
+        throwIfFailed(finished, failed);
+    }
+
+  private:
+    struct Job
+    {
+        std::string patch;
+        std::vector<SurgePyEvent> events;
+        int nBlocks{0};
+        std::vector<std::pair<int, float>> overrides;
+    };
+
+    static bool renderJob(SurgeSynthesizerWithPythonExtensions *surge, const Job &job, float *dL,
+                          float *dR)
+    {
+        auto path = string_to_path(job.patch);
+
+        if (!surge->loadPatchByPath(job.patch.c_str(), -1, path.filename().u8string().c_str()))
+            return false;
+
+        surge->allNotesOff();
+        surge->time_data.tempo =
+            surge->storage.unstreamedTempo > -1.f ? surge->storage.unstreamedTempo : 120;
+        surge->time_data.ppqPos = 0;
+
+        for (const auto &[id, value] : job.overrides)
+        {
+            SurgeSynthesizer::ID sid;
+            if (surge->fromSynthSideId(id, sid))
+            {
+                auto p = surge->storage.getPatch().param_ptr[id];
+                surge->setParameter01(sid, p->value_to_normalized(value));
+            }
+        }
+
+        // Let the patch load finish and its fade-in settle before anything is captured
+        for (int i = 0; i < 16; ++i)
+            surge->process();
+
+        size_t nextEvent = 0;
+        surge->renderBlocksWithEvents(job.events, nextEvent, 0, dL, dR, job.nBlocks);
+        return true;
+    }
+
+    static size_t maxBlocks(const std::vector<Job> &js)
+    {
+        int res = 0;
+        for (const auto &j : js)
+            res = std::max(res, j.nBlocks);
+        return res;
+    }
+
+    void checkIdle() const
+    {
+        if (inFlight.runner.joinable())
+        {
+            throw std::runtime_error(
+                "This renderer is still running a renderAsync; wait() for it first");
+        }
+    }
+
+    static void throwIfFailed(const std::vector<Job> &js, const std::vector<char> &failed)
+    {
+        for (size_t j = 0; j < js.size(); ++j)
+        {
+            if (failed[j])
+            {
+                throw std::runtime_error(
+                    (std::string("Unable to load patch ") + js[j].patch).c_str());
+            }
+        }
+    }
+
+    // Without the GIL. Each job is rendered straight into its rows of ptr.
+    void renderAll(const std::vector<Job> &js, float *ptr, std::vector<char> &failed)
+    {
+        const size_t nSamples = maxBlocks(js) * BLOCK_SIZE;
+
+        std::atomic<size_t> nextJob{0};
+        auto worker = [&](SurgeSynthesizerWithPythonExtensions *surge) {
+            size_t j;
+            while ((j = nextJob.fetch_add(1)) < js.size())
+            {
+                auto dL = ptr + j * 2 * nSamples;
+                auto dR = dL + nSamples;
+                failed[j] = !renderJob(surge, js[j], dL, dR);
+
+                // only the padding after a shorter job needs clearing, or all of a failed one
+                size_t written = failed[j] ? 0 : js[j].nBlocks * BLOCK_SIZE;
+                memset(dL + written, 0, (nSamples - written) * sizeof(float));
+                memset(dR + written, 0, (nSamples - written) * sizeof(float));
+            }
+        };
+
+        auto nThreads = std::min(synths.size(), js.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < nThreads; ++i)
+            threads.emplace_back(worker, synths[i].get());
+
+        if (nThreads > 0)
+            worker(synths[0].get());
+
+        for (auto &t : threads)
+            t.join();
+    }
+
+    std::vector<std::unique_ptr<SurgeSynthesizerWithPythonExtensions>> synths;
+    std::vector<Job> jobs;
+
+    struct InFlight
+    {
+        std::thread runner;
+        std::vector<Job> jobs;
+        std::vector<char> failed;
+        SurgePyAudioTarget target;
+    } inFlight;
+};
+
 // Prefix _ if using shared object within a Python package built with scikit-build
 #ifdef SKBUILD
 PYBIND11_MODULE(_surgepy, m)
@@ -1059,6 +1979,49 @@ PYBIND11_MODULE(surgepy, m)
     m.def("createSurge", &createSurge, "Create a Surge XT instance", py::arg("sampleRate"));
     m.def(
         "getVersion", []() { return Surge::Build::FullVersionStr; }, "Get the version of Surge XT");
+    py::class_<Surge::Storage::PatchSnapshot>(m, "SurgePatchSnapshot")
+        .def("getName", [](const Surge::Storage::PatchSnapshot &s) { return s.name; })
+        .def("__repr__", [](const Surge::Storage::PatchSnapshot &s) {
+            return std::string("<SurgePatchSnapshot '") + s.name + "'>";
+        });
+
+    py::class_<SurgePyBatchRenderer>(m, "BatchRenderer")
+        .def(py::init<float, int>(),
+             "Create a batch renderer which renders jobs on numThreads synths of its own "
+             "(0 means one per core)",
+             py::arg("sampleRate"), py::arg("numThreads") = 0)
+        .def("addJob", &SurgePyBatchRenderer::addJob,
+             "Queue a job: load patch, apply the parameter overrides (a dict from "
+             "SurgeNamedParamId or\n"
+             "synth side id to value), then render nBlocks while applying events as in "
+             "processMultiBlockWithEvents.",
+             py::arg("patch"), py::arg("events"), py::arg("nBlocks"),
+             py::arg("overrides") = py::dict())
+        .def("numJobs", &SurgePyBatchRenderer::numJobs, "The number of queued jobs")
+        .def("clearJobs", &SurgePyBatchRenderer::clearJobs, "Remove all queued jobs")
+        .def("render", &SurgePyBatchRenderer::render,
+             "Render every queued job and return a (jobs, 2, samples) numpy array, where "
+             "shorter jobs are\n"
+             "zero padded to the longest one.")
+        .def("outputShape", &SurgePyBatchRenderer::outputShape,
+             "The (jobs, 2, samples) shape render would return for the queued jobs")
+        .def("renderInto", &SurgePyBatchRenderer::renderInto,
+             "Render like render, but straight into out: a C contiguous float32 array of "
+             "outputShape()\n"
+             "which is a numpy array, or anything with __dlpack__ in host memory, such as a "
+             "pinned torch\n"
+             "tensor, so it can go on to a GPU without another copy.",
+             py::arg("out"))
+        .def("renderAsync", &SurgePyBatchRenderer::renderAsync,
+             "Start a renderInto(out) in the background and return at once. Queue the next "
+             "batch and\n"
+             "start it into a second buffer after wait(), so rendering overlaps whatever "
+             "consumes the\n"
+             "first. The queued jobs are copied when it starts.",
+             py::arg("out"))
+        .def("wait", &SurgePyBatchRenderer::wait,
+             "Wait for the renderAsync in flight, if any, after which its buffer is ready");
+
     py::class_<SurgeSynthesizer::ID>(m, "SurgeSynthesizer_ID")
         .def(py::init<>())
         .def("getSynthSideId", &SurgeSynthesizer::ID::getSynthSideId)
@@ -1124,11 +2087,31 @@ PYBIND11_MODULE(surgepy, m)
 
         .def("setParamVal", &SurgeSynthesizerWithPythonExtensions::setParamVal,
              "Set a parameter value", py::arg("param"), py::arg("toThis"))
+        .def("getAllParams", &SurgeSynthesizerWithPythonExtensions::getAllParams,
+             "Get every parameter as a numpy array of normalized (0..1) values indexed by synth "
+             "side id.\n"
+             "The array is a full snapshot which setAllParams can restore.")
+        .def("setParams", &SurgeSynthesizerWithPythonExtensions::setParams,
+             "Set the parameters with the synth side ids in one numpy array to the normalized "
+             "values in another,\n"
+             "all between the same two blocks.",
+             py::arg("ids"), py::arg("values"))
+        .def("setAllParams", &SurgeSynthesizerWithPythonExtensions::setAllParams,
+             "Restore every parameter from an array returned by getAllParams.",
+             py::arg("values"))
 
         .def("loadPatch", &SurgeSynthesizerWithPythonExtensions::loadPatchPy,
              "Load a Surge XT .fxp patch from the file system.", py::arg("path"))
         .def("savePatch", &SurgeSynthesizerWithPythonExtensions::savePatchPy,
              "Save the current state of Surge XT to an .fxp file.", py::arg("path"))
+        .def("capturePatchSnapshot", &SurgeSynthesizerWithPythonExtensions::capturePatchSnapshotPy,
+             "Copy the current patch into an in-memory snapshot which restorePatchSnapshot can "
+             "bring back,\n"
+             "on this or any other Surge XT instance, without going through a patch file.")
+        .def("restorePatchSnapshot",
+             &SurgeSynthesizerWithPythonExtensions::restorePatchSnapshotPy,
+             "Restore the patch from a snapshot made by capturePatchSnapshot.",
+             py::arg("snapshot"))
 
         .def("loadWavetable", &SurgeSynthesizerWithPythonExtensions::loadWavetablePy,
              "Load a wavetable file directly into a scene and oscillator immediately on this "
@@ -1162,6 +2145,25 @@ PYBIND11_MODULE(surgepy, m)
              "Run Surge XT for one block and update the internal output buffer.")
         .def("getOutput", &SurgeSynthesizerWithPythonExtensions::getOutput,
              "Retrieve the internal output buffer as a 2 * BLOCK_SIZE numpy array.")
+        .def("getProcessProfile", &SurgeSynthesizerWithPythonExtensions::getProcessProfile,
+             "Get a dictionary of the time in microseconds each part of the engine took per "
+             "block,\naveraged (or the peak, if peak is true) over up to the last nBlocks "
+             "blocks processed.",
+             py::arg("nBlocks") = 128, py::arg("peak") = false)
+        .def("getLatencyHistogram", &SurgeSynthesizerWithPythonExtensions::getLatencyHistogram,
+             "Get the distribution of whole block times in microseconds since the last reset: "
+             "count,\nmax, p50, p90, p99, p999, the available budget and the occupied "
+             "histogram buckets.")
+        .def("getWorstBlocks", &SurgeSynthesizerWithPythonExtensions::getWorstBlocks,
+             "Get the slowest blocks since the last reset, slowest first, with their stage "
+             "timings,\nvoice and note on counts, a wall clock time and what the engine was "
+             "doing (patch load,\nFX spawn, wavetable load, note on burst).")
+        .def("resetLatencyStats", &SurgeSynthesizerWithPythonExtensions::resetLatencyStats,
+             "Clear the latency histogram and worst blocks before the next block is processed.")
+        .def("getMemoryReport", &SurgeSynthesizerWithPythonExtensions::getMemoryReport,
+             "Get the bytes held by each part of the engine: voices, oscillatorBuffers, "
+             "filterStates,\nfxSlots (a list, one per slot), wavetables, memoryPools, lua, "
+             "patchDB and their total.")
 
         .def("createMultiBlock", &SurgeSynthesizerWithPythonExtensions::createMultiBlock,
              "Create a numpy array suitable to hold up to b blocks of Surge XT processing in "
@@ -1180,6 +2182,25 @@ PYBIND11_MODULE(surgepy, m)
              "entire array, or starting at startBlock position in the output, populate nBlocks.",
              py::arg("inVal"), py::arg("outVal"), py::arg("startBlock") = 0,
              py::arg("nBlocks") = -1)
+        .def("renderToFile", &SurgeSynthesizerWithPythonExtensions::renderToFile,
+             "Render nBlocks to a stereo WAV file at path, applying events as "
+             "processMultiBlockWithEvents does.\n"
+             "The file is written on a background thread as the render goes, so memory use "
+             "does not grow with\n"
+             "the length. format is float32, int24 or int16.",
+             py::arg("path"), py::arg("events"), py::arg("nBlocks"),
+             py::arg("format") = "float32")
+        .def("processMultiBlockWithEvents",
+             &SurgeSynthesizerWithPythonExtensions::processMultiBlockWithEvents,
+             "Run the Surge XT engine for multiple blocks like processMultiBlock, applying an "
+             "(n, 5) array of\n"
+             "[sampleOffset, surgepy.constants.ev_*, a, b, value] rows, sorted by sample offset "
+             "from startBlock,\n"
+             "as the render reaches them. Note on/off and CC rows take (channel, key or cc, "
+             "velocity or value),\n"
+             "pitch bend rows (channel, -, bend), and parameter rows (synth side id, -, value).",
+             py::arg("val"), py::arg("events"), py::arg("startBlock") = 0,
+             py::arg("nBlocks") = -1)
 
         .def("getPatch", &SurgeSynthesizerWithPythonExtensions::getPatchAsPy,
              "Get a Python dictionary with the Surge XT parameters laid out in the logical patch "
@@ -1330,6 +2351,12 @@ PYBIND11_MODULE(surgepy, m)
     C(fxslot_global1);
     C(fxslot_global2);
 
+    C(ev_note_on);
+    C(ev_note_off);
+    C(ev_cc);
+    C(ev_pitch_bend);
+    C(ev_param);
+
     C(pm_poly);
     C(pm_mono);
     C(pm_mono_st);
@@ -21,11 +21,91 @@
  */
 #include "HeadlessUtils.h"
 #include "Player.h"
+#include "RealtimeSafety.h"
+#include "ClassicOscillator.h"
+#include "PatchFileHeaderStructs.h"
+#include "sst/basic-blocks/mechanics/endian-ops.h"
 #include "filesystem/import.h"
 #include <iostream>
 #include <sstream>
 #include <chrono>
 #include <deque>
+#include <fstream>
+#include <map>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <iomanip>
+
+/*
+ * The CPU sweep wants to know how often the audio thread allocates. Replacing the global
+ * allocator is the only way to see every allocation, so we do it here, but it just counts on
+ * the calling thread and only while the sweep has asked it to. The same hooks feed the
+ * RealtimeSafety checks when those are built in.
+ */
+namespace
+{
+std::atomic<bool> countAllocations{false};
+thread_local uint64_t allocationsOnThisThread{0};
+thread_local uint64_t bytesAllocatedOnThisThread{0};
+
+void *countedAlloc(size_t sz)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+    {
+        allocationsOnThisThread++;
+        bytesAllocatedOnThisThread += sz;
+    }
+    Surge::RealtimeSafety::noteAllocation(sz);
+    if (sz == 0)
+        sz = 1;
+    if (auto p = std::malloc(sz))
+        return p;
+    throw std::bad_alloc();
+}
+
+void countedFree(void *p)
+{
+    if (p)
+        Surge::RealtimeSafety::noteDeallocation();
+    std::free(p);
+}
+
+#if !WINDOWS
+// The aligned forms on windows use _aligned_malloc and their own free, so leave them be there
+void *countedAlignedAlloc(size_t sz, std::align_val_t al)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+    {
+        allocationsOnThisThread++;
+        bytesAllocatedOnThisThread += sz;
+    }
+    Surge::RealtimeSafety::noteAllocation(sz);
+    void *p{nullptr};
+    auto a = std::max(sizeof(void *), (size_t)al);
+    if (posix_memalign(&p, a, sz ? sz : 1) == 0)
+        return p;
+    throw std::bad_alloc();
+}
+#endif
+} // namespace
+
+void *operator new(size_t sz) { return countedAlloc(sz); }
+void *operator new[](size_t sz) { return countedAlloc(sz); }
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete[](void *p) noexcept { countedFree(p); }
+void operator delete(void *p, size_t) noexcept { countedFree(p); }
+void operator delete[](void *p, size_t) noexcept { countedFree(p); }
+
+#if !WINDOWS
+void *operator new(size_t sz, std::align_val_t al) { return countedAlignedAlloc(sz, al); }
+void *operator new[](size_t sz, std::align_val_t al) { return countedAlignedAlloc(sz, al); }
+void operator delete(void *p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { countedFree(p); }
+#endif
 
 namespace Surge
 {
@@ -146,6 +226,499 @@ void statsFromPlayingEveryPatch()
     Surge::Headless::playOnEveryPatch(surge, scale, callBack);
 }
 
+int cpuCostOfEveryPatch(const std::string &reportPath, const std::string &baselinePath,
+                        float regressionPercent)
+{
+    /*
+     * Play the same chord and arpeggio on every patch in the library, timing each block on
+     * its own. The report is tab separated, one patch per line, so it can be kept as a
+     * baseline and handed straight back to a later run for comparison.
+     */
+    struct Cost
+    {
+        double meanUS{0}, p99US{0}, maxUS{0};
+        uint64_t allocations{0};
+    };
+
+    static constexpr int sr = 48000;
+    auto surge = Surge::Headless::createSurge(sr, true);
+    auto events = Surge::Headless::makeChordAndArpeggio(0, sr);
+
+    std::ofstream report(reportPath);
+    if (!report.is_open())
+    {
+        std::cout << "Unable to open report file '" << reportPath << "'" << std::endl;
+        return 1;
+    }
+    report << "# surge-xt-testrunner cpu sweep; sr=" << sr << " block=" << BLOCK_SIZE << "\n"
+           << "category\tpatch\tmean_us\tp99_us\tmax_us\tallocations\n";
+
+    std::map<std::string, Cost> costs;
+    std::vector<double> blockTimes;
+
+    for (auto c : surge->storage.patchCategoryOrdering)
+    {
+        for (auto idx : surge->storage.patchOrdering)
+        {
+            const auto &p = surge->storage.patch_list[idx];
+            if (p.category != c)
+                continue;
+
+            const auto &pc = surge->storage.patch_category[p.category];
+            surge->loadPatch(idx);
+
+            for (int i = 0; i < 10; ++i)
+                surge->process();
+
+            int blockCount = events.back().atSample / BLOCK_SIZE + 1;
+            size_t currEvt = 0;
+            blockTimes.clear();
+            blockTimes.reserve(blockCount);
+
+            allocationsOnThisThread = 0;
+            countAllocations = true;
+
+            for (int b = 0; b < blockCount; ++b)
+            {
+                auto cs = (long)b * BLOCK_SIZE;
+                while (currEvt < events.size() && events[currEvt].atSample < cs + BLOCK_SIZE)
+                {
+                    const auto &e = events[currEvt];
+                    if (e.type == Event::NOTE_ON)
+                        surge->playNote(e.channel, e.data1, e.data2, 0);
+                    else if (e.type == Event::NOTE_OFF)
+                        surge->releaseNote(e.channel, e.data1, e.data2);
+                    currEvt++;
+                }
+
+                auto st = std::chrono::steady_clock::now();
+                surge->process();
+                auto en = std::chrono::steady_clock::now();
+                blockTimes.push_back(std::chrono::duration<double, std::micro>(en - st).count());
+            }
+
+            countAllocations = false;
+
+            surge->allNotesOff();
+            for (int i = 0; i < 10; ++i)
+                surge->process();
+
+            Cost cost;
+            cost.allocations = allocationsOnThisThread;
+            for (auto t : blockTimes)
+            {
+                cost.meanUS += t;
+                cost.maxUS = std::max(cost.maxUS, t);
+            }
+            cost.meanUS /= std::max((size_t)1, blockTimes.size());
+
+            auto p99 = blockTimes.begin() + (blockTimes.size() * 99) / 100;
+            if (p99 != blockTimes.end())
+            {
+                std::nth_element(blockTimes.begin(), p99, blockTimes.end());
+                cost.p99US = *p99;
+            }
+
+            auto key = pc.name + "\t" + p.name;
+            costs[key] = cost;
+            report << key << "\t" << cost.meanUS << "\t" << cost.p99US << "\t" << cost.maxUS
+                   << "\t" << cost.allocations << "\n";
+
+            std::cout << "cat/patch = " << pc.name << " / " << std::left << std::setw(30)
+                      << p.name << " mean=" << cost.meanUS << "us p99=" << cost.p99US
+                      << "us allocs=" << cost.allocations << std::endl;
+        }
+    }
+    report.close();
+
+    if (baselinePath.empty())
+        return 0;
+
+    std::ifstream baseline(baselinePath);
+    if (!baseline.is_open())
+    {
+        std::cout << "Unable to open baseline file '" << baselinePath << "'" << std::endl;
+        return 1;
+    }
+
+    int regressions = 0;
+    auto limit = 1.0 + regressionPercent / 100.0;
+    std::string line;
+    while (std::getline(baseline, line))
+    {
+        if (line.empty() || line[0] == '#' || line.rfind("category\t", 0) == 0)
+            continue;
+
+        // category and patch, then the four numbers
+        std::vector<std::string> cols;
+        std::istringstream iss(line);
+        std::string col;
+        while (std::getline(iss, col, '\t'))
+            cols.push_back(col);
+        if (cols.size() < 6)
+            continue;
+
+        auto key = cols[0] + "\t" + cols[1];
+        auto it = costs.find(key);
+        if (it == costs.end())
+        {
+            std::cout << "MISSING    " << cols[0] << " / " << cols[1] << std::endl;
+            continue;
+        }
+
+        Cost base;
+        base.meanUS = std::atof(cols[2].c_str());
+        base.p99US = std::atof(cols[3].c_str());
+        base.allocations = std::strtoull(cols[5].c_str(), nullptr, 10);
+
+        const auto &now = it->second;
+        bool regressed = now.meanUS > base.meanUS * limit || now.p99US > base.p99US * limit ||
+                         now.allocations > base.allocations;
+        if (regressed)
+        {
+            regressions++;
+            std::cout << "REGRESSION " << cols[0] << " / " << cols[1] << " mean " << base.meanUS
+                      << " -> " << now.meanUS << "us p99 " << base.p99US << " -> " << now.p99US
+                      << "us allocs " << base.allocations << " -> " << now.allocations
+                      << std::endl;
+        }
+    }
+
+    std::cout << "# " << regressions << " patches regressed by more than " << regressionPercent
+              << "% against " << baselinePath << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+void scalingBenchmark(const std::string &jsonPath, int maxInstances)
+{
+    /*
+     * How the engine scales with voices, with unison and with instances running side by side
+     * on their own threads. Each point is the mean time of a run of blocks after a warm up, and
+     * the whole lot goes out as one JSON document for plotting.
+     */
+    static constexpr int sr = 48000;
+    static constexpr int warmBlocks = 50, timedBlocks = 1000;
+    auto budget = BLOCK_SIZE * 1000000.0 / sr;
+
+    auto timeBlocks = [](const std::shared_ptr<SurgeSynthesizer> &surge) {
+        for (int i = 0; i < warmBlocks; ++i)
+            surge->process();
+
+        auto st = std::chrono::steady_clock::now();
+        for (int i = 0; i < timedBlocks; ++i)
+            surge->process();
+        auto en = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(en - st).count() / timedBlocks;
+    };
+
+    auto makeSurge = [](int voices) {
+        auto surge = Surge::Headless::createSurge(sr, false);
+        surge->storage.getPatch().polylimit.val.i = MAX_VOICES;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+        for (int v = 0; v < voices; ++v)
+            surge->playNote(0, 30 + v, 100, 0);
+        return surge;
+    };
+
+    std::ostringstream json;
+    json << std::setprecision(6) << "{\n  \"sample_rate\": " << sr
+         << ",\n  \"block_size\": " << BLOCK_SIZE << ",\n  \"budget_us\": " << budget;
+
+    // voices
+    json << ",\n  \"voices\": [";
+    double onlyOne = 0;
+    int prevVoices = 0;
+    double prevUS = 0;
+    for (int v = 1; v <= MAX_VOICES; v *= 2)
+    {
+        auto surge = makeSurge(v);
+        auto us = timeBlocks(surge);
+        if (v == 1)
+            onlyOne = us;
+        auto marginal = prevVoices ? (us - prevUS) / (v - prevVoices) : us;
+
+        json << (v > 1 ? "," : "") << "\n    {\"voices\": " << v
+             << ", \"active\": " << surge->storage.voiceCount << ", \"mean_us\": " << us
+             << ", \"marginal_us_per_voice\": " << marginal
+             << ", \"vs_linear\": " << us / (onlyOne * v) << "}";
+        std::cout << "voices=" << v << " mean=" << us << "us marginal=" << marginal << "us"
+                  << std::endl;
+
+        prevVoices = v;
+        prevUS = us;
+    }
+    json << "\n  ]";
+
+    // unison, one held note on a classic oscillator
+    json << ",\n  \"unison\": [";
+    for (int u = 1; u <= MAX_UNISON; u *= 2)
+    {
+        auto surge = Surge::Headless::createSurge(sr, false);
+        auto &osc = surge->storage.getPatch().scene[0].osc[0];
+        osc.type.val.i = ot_classic;
+        surge->storage.getPatch().update_controls(false, &osc);
+        osc.p[ClassicOscillator::co_unison_voices].val.i = u;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+        surge->playNote(0, 60, 100, 0);
+
+        auto us = timeBlocks(surge);
+        json << (u > 1 ? "," : "") << "\n    {\"unison\": " << u << ", \"mean_us\": " << us
+             << "}";
+        std::cout << "unison=" << u << " mean=" << us << "us" << std::endl;
+    }
+    json << "\n  ]";
+
+    // instances, each with eight voices on a thread of its own
+    if (maxInstances <= 0)
+        maxInstances = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> instanceCounts;
+    for (int n = 1; n < maxInstances; n *= 2)
+        instanceCounts.push_back(n);
+    instanceCounts.push_back(maxInstances);
+
+    json << ",\n  \"instances\": [";
+    for (auto n : instanceCounts)
+    {
+        std::vector<std::shared_ptr<SurgeSynthesizer>> synths;
+        uint64_t bytes = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            bytesAllocatedOnThisThread = 0;
+            countAllocations = true;
+            synths.push_back(makeSurge(8));
+            countAllocations = false;
+            bytes += bytesAllocatedOnThisThread;
+        }
+
+        std::vector<double> perInstance(n);
+        std::vector<std::thread> threads;
+        auto st = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i)
+            threads.emplace_back([&, i]() { perInstance[i] = timeBlocks(synths[i]); });
+        for (auto &t : threads)
+            t.join();
+        auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+
+        double worst = 0, mean = 0;
+        for (auto us : perInstance)
+        {
+            worst = std::max(worst, us);
+            mean += us / n;
+        }
+        // samples rendered per second of wall clock, across all instances
+        auto throughput = n * (warmBlocks + timedBlocks) * BLOCK_SIZE / wall;
+
+        json << (n > 1 ? "," : "") << "\n    {\"instances\": " << n << ", \"mean_us\": " << mean
+             << ", \"worst_us\": " << worst << ", \"samples_per_second\": " << throughput
+             << ", \"realtime_factor\": " << throughput / sr
+             << ", \"bytes_per_instance\": " << bytes / n << "}";
+        std::cout << "instances=" << n << " mean=" << mean << "us worst=" << worst
+                  << "us realtime x" << throughput / sr << " bytes/instance=" << bytes / n
+                  << std::endl;
+    }
+    json << "\n  ]\n}\n";
+
+    std::ofstream out(jsonPath);
+    if (!out.is_open())
+    {
+        std::cout << "Unable to open '" << jsonPath << "'; results were\n" << json.str();
+        return;
+    }
+    out << json.str();
+}
+
+void startupBenchmark(const std::string &jsonPath)
+{
+    /*
+     * How long it takes to get from nothing to a playing synth, phase by phase, and then to
+     * load each factory patch; first time (cold, as far as this process is concerned - we
+     * can't drop the OS file cache) and straight after (warm). Wavetables embedded in a patch
+     * are built once more on their own so their share of the load is reported separately.
+     * Everything is in milliseconds and goes out as one JSON document.
+     */
+    namespace mech = sst::basic_blocks::mechanics;
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::time_point st) {
+        return std::chrono::duration<double, std::milli>(clock::now() - st).count();
+    };
+    auto quote = [](const std::string &s) {
+        std::string r = "\"";
+        for (auto c : s)
+        {
+            if (c == '"' || c == '\\')
+                r += '\\';
+            if ((unsigned char)c >= 0x20)
+                r += c;
+        }
+        return r + "\"";
+    };
+
+    static constexpr int sr = 48000;
+    std::string dataPath = "resources/data";
+    if (!fs::is_directory(fs::path{dataPath} / "patches_factory"))
+    {
+        std::cout << "Run this from the repository root so '" << dataPath << "' can be found"
+                  << std::endl;
+        return;
+    }
+
+    std::ostringstream json;
+    json << std::setprecision(6) << "{\n  \"phases_ms\": {";
+
+    auto phase = [&json](const std::string &name, double t, bool first = false) {
+        json << (first ? "" : ",") << "\n    \"" << name << "\": " << t;
+        std::cout << std::setw(32) << std::left << name << t << "ms" << std::endl;
+    };
+
+    {
+        SurgeStorage::SurgeStorageConfig config;
+        config.suppliedDataPath = dataPath;
+        config.scanWavetableAndPatches = false;
+
+        auto st = clock::now();
+        auto storage = std::make_unique<SurgeStorage>(config);
+        phase("storage_construct", ms(st), true);
+
+        st = clock::now();
+        storage->refresh_wtlist();
+        phase("refresh_wtlist", ms(st));
+
+        st = clock::now();
+        storage->refresh_patchlist();
+        phase("refresh_patchlist", ms(st));
+
+        st = clock::now();
+        storage->initializePatchDb(true);
+        storage->patchDB->waitForJobsOutstandingComplete(60 * 1000);
+        phase("initialize_patch_db", ms(st));
+    }
+
+    auto st = clock::now();
+    auto surge = Surge::Headless::createSurge(sr, true);
+    phase("synthesizer_construct", ms(st));
+
+    st = clock::now();
+    surge->process();
+    phase("first_block", ms(st));
+
+    // the plugin's getStateInformation and setStateInformation, less the JUCE wrapping
+    void *state = nullptr;
+    st = clock::now();
+    surge->populateDawExtraState();
+    auto stateSize = surge->saveRaw(&state);
+    phase("get_state", ms(st));
+
+    std::vector<char> stateCopy((char *)state, (char *)state + stateSize);
+    st = clock::now();
+    surge->enqueuePatchForLoad(stateCopy.data(), stateCopy.size());
+    surge->processAudioThreadOpsWhenAudioEngineUnavailable();
+    phase("set_state", ms(st));
+
+    json << "\n  },\n  \"patches\": [";
+
+    double coldTotal = 0, warmTotal = 0, wtTotal = 0, worstCold = 0;
+    std::string worstColdName;
+    int n = 0;
+
+    for (auto c : surge->storage.patchCategoryOrdering)
+    {
+        if (c >= surge->storage.firstThirdPartyCategory)
+            continue;
+
+        for (auto idx : surge->storage.patchOrdering)
+        {
+            const auto &p = surge->storage.patch_list[idx];
+            if (p.category != c)
+                continue;
+
+            const auto &pc = surge->storage.patch_category[p.category];
+            auto path = p.path.u8string();
+
+            st = clock::now();
+            surge->loadPatchByPath(path.c_str(), p.category, p.name.c_str());
+            auto cold = ms(st);
+
+            st = clock::now();
+            surge->loadPatchByPath(path.c_str(), p.category, p.name.c_str());
+            auto warm = ms(st);
+
+            // and once more, building just the wavetables the patch carries with it
+            double wtTime = 0;
+            int wtCount = 0;
+            std::ifstream f(p.path, std::ios::binary);
+            sst::io::fxChunkSetCustom fxp;
+            if (f.read((char *)&fxp, sizeof(fxp)))
+            {
+                std::vector<char> chunk(mech::endian_read_int32BE(fxp.chunkSize));
+                sst::io::patch_header ph;
+
+                if (chunk.size() > sizeof(ph) && f.read(chunk.data(), chunk.size()))
+                {
+                    memcpy(&ph, chunk.data(), sizeof(ph));
+                    auto dr = chunk.data() + sizeof(ph) + mech::endian_read_int32LE(ph.xmlsize);
+                    auto end = chunk.data() + chunk.size();
+
+                    for (int sc = 0; sc < n_scenes; sc++)
+                    {
+                        for (int o = 0; o < n_oscs; o++)
+                        {
+                            auto wtsize = mech::endian_read_int32LE(ph.wtsize[sc][o]);
+                            if (!wtsize || dr + sizeof(wt_header) > end)
+                                continue;
+
+                            wt_header wth;
+                            memcpy(&wth, dr, sizeof(wth));
+
+                            Wavetable wt;
+                            st = clock::now();
+                            wt.BuildWT(dr + sizeof(wt_header), wth, false);
+                            wtTime += ms(st);
+                            wtCount++;
+
+                            dr += wtsize;
+                        }
+                    }
+                }
+            }
+
+            json << (n ? "," : "") << "\n    {\"category\": " << quote(pc.name)
+                 << ", \"patch\": " << quote(p.name) << ", \"cold_ms\": " << cold
+                 << ", \"warm_ms\": " << warm << ", \"wavetable_ms\": " << wtTime
+                 << ", \"wavetables\": " << wtCount << "}";
+
+            coldTotal += cold;
+            warmTotal += warm;
+            wtTotal += wtTime;
+            if (cold > worstCold)
+            {
+                worstCold = cold;
+                worstColdName = pc.name + "/" + p.name;
+            }
+            n++;
+        }
+    }
+
+    json << "\n  ],\n  \"summary\": {\"patches\": " << n << ", \"cold_total_ms\": " << coldTotal
+         << ", \"warm_total_ms\": " << warmTotal << ", \"wavetable_total_ms\": " << wtTotal
+         << ", \"worst_cold_ms\": " << worstCold << ", \"worst_cold_patch\": "
+         << quote(worstColdName) << "}\n}\n";
+
+    std::cout << n << " factory patches: cold " << coldTotal << "ms, warm " << warmTotal
+              << "ms, of which wavetables " << wtTotal << "ms; slowest " << worstColdName << " at "
+              << worstCold << "ms" << std::endl;
+
+    std::ofstream out(jsonPath);
+    if (!out.is_open())
+    {
+        std::cout << "Unable to open '" << jsonPath << "'; results were\n" << json.str();
+        return;
+    }
+    out << json.str();
+}
+
 void standardCutoffCurve(int ft, int sft, std::ostream &os)
 {
     /*
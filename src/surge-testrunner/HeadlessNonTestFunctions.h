@@ -32,6 +32,10 @@ namespace NonTest
 void initializePatchDB();
 void restreamTemplatesWithModifications();
 void statsFromPlayingEveryPatch();
+int cpuCostOfEveryPatch(const std::string &reportPath, const std::string &baselinePath,
+                        float regressionPercent);
+void scalingBenchmark(const std::string &jsonPath, int maxInstances);
+void startupBenchmark(const std::string &jsonPath);
 void filterAnalyzer(int ft, int fst, std::ostream &os);
 void generateNLFeedbackNorms();
 [[noreturn]] void performancePlay(const std::string &patchName, int mode);
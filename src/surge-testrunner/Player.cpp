@@ -20,6 +20,7 @@
  * https://github.com/surge-synthesizer/surge
  */
 #include "Player.h"
+#include <algorithm>
 
 namespace Surge
 {
@@ -87,6 +88,58 @@ playerEvents_t make120BPMCMajorQuarterNoteScale(long s0, int sr)
     return result;
 }
 
+playerEvents_t makeChordAndArpeggio(long s0, int sr)
+{
+    int samplesPerBar = 4 * 60.0 / 120.0 * sr;
+    auto chord = {48, 55, 60, 63};
+    auto arp = {60, 63, 67, 70, 72, 75, 79, 82, 84, 82, 79, 75, 72, 70, 67, 63};
+
+    playerEvents_t result;
+
+    Event e;
+    e.channel = 0;
+
+    for (auto n : chord)
+    {
+        e.type = Event::NOTE_ON;
+        e.data1 = n;
+        e.data2 = 100;
+        e.atSample = s0;
+        result.push_back(e);
+
+        e.type = Event::NOTE_OFF;
+        e.data2 = 0;
+        e.atSample = s0 + 0.95 * samplesPerBar;
+        result.push_back(e);
+    }
+
+    int samplesPerStep = samplesPerBar / 16;
+    long currSamp = s0 + samplesPerBar;
+    for (auto n : arp)
+    {
+        e.type = Event::NOTE_ON;
+        e.data1 = n;
+        e.data2 = 90;
+        e.atSample = currSamp;
+        result.push_back(e);
+
+        e.type = Event::NOTE_OFF;
+        e.data2 = 0;
+        e.atSample = currSamp + samplesPerStep / 2;
+        result.push_back(e);
+
+        currSamp += samplesPerStep;
+    }
+
+    e.type = Event::NO_EVENT;
+    e.atSample = currSamp + sr;
+    result.push_back(e);
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Event &a, const Event &b) { return a.atSample < b.atSample; });
+    return result;
+}
+
 void playAsConfigured(std::shared_ptr<SurgeSynthesizer> surge, const playerEvents_t &events,
                       float **data, int *nSamples, int *nChannels)
 {
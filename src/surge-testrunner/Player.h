@@ -72,6 +72,15 @@ playerEvents_t makeHoldNoteFor(int note, int forSamples, int withTail = 0, int m
 
 playerEvents_t make120BPMCMajorQuarterNoteScale(long sample0 = 0, int sr = 44100);
 
+/**
+ * makeChordAndArpeggio
+ *
+ * A fixed two bar script at 120 BPM: a held four note chord for a bar, then a bar of sixteenth
+ * note arpeggio over two octaves, then a one second tail. This is the standard load the CPU
+ * sweep plays on every patch, so don't change it without re-recording baselines.
+ */
+playerEvents_t makeChordAndArpeggio(long sample0 = 0, int sr = 44100);
+
 /**
  * playAsConfigured
  *
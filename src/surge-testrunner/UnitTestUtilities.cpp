@@ -23,6 +23,7 @@
 #include "SurgeSynthesizer.h"
 #include "Player.h"
 #include "catch2/catch_amalgamated.hpp"
+#include "UnitTestUtilities.h"
 #include <iostream>
 #include <cstdio>
 #include <string>
@@ -220,7 +221,7 @@ std::shared_ptr<SurgeSynthesizer> surgeOnPatch(const std::string &otp)
         return surge;
 }
 
-std::shared_ptr<SurgeSynthesizer> surgeOnTemplate(const std::string &otp, float sr = 44100)
+std::shared_ptr<SurgeSynthesizer> surgeOnTemplate(const std::string &otp, float sr)
 {
     auto surge = Surge::Headless::createSurge(sr);
 
@@ -249,7 +250,7 @@ std::shared_ptr<SurgeSynthesizer> surgeOnTemplate(const std::string &otp, float
     return surge;
 }
 
-std::shared_ptr<SurgeSynthesizer> surgeOnSine(float sr = 44100)
+std::shared_ptr<SurgeSynthesizer> surgeOnSine(float sr)
 {
     auto surge = Surge::Headless::createSurge(sr);
 
@@ -260,7 +261,7 @@ std::shared_ptr<SurgeSynthesizer> surgeOnSine(float sr = 44100)
     surge->loadPatchByPath(path_to_string(isin).c_str(), -1, "Test");
     return surge;
 }
-std::shared_ptr<SurgeSynthesizer> surgeOnSaw(float sr = 44100)
+std::shared_ptr<SurgeSynthesizer> surgeOnSaw(float sr)
 {
     auto surge = Surge::Headless::createSurge(sr);
 
@@ -314,5 +315,44 @@ void setFX(std::shared_ptr<SurgeSynthesizer> surge, int slot, fx_type type)
     for (int i = 0; i < 10; ++i)
         surge->process();
 }
+
+RenderComparison
+compareRenders(const std::function<void(std::shared_ptr<SurgeSynthesizer>)> &configureA,
+               const std::function<void(std::shared_ptr<SurgeSynthesizer>)> &configureB,
+               const Surge::Headless::playerEvents_t &events, uint32_t seed, float sr)
+{
+    auto render = [&](const std::function<void(std::shared_ptr<SurgeSynthesizer>)> &configure,
+                      int &nS, int &nC) {
+        auto surge = Surge::Headless::createSurge(sr, false);
+        surge->setDeterministicRendering(seed);
+        if (configure)
+            configure(surge);
+
+        // configuring may have drawn random numbers, and differently in each case
+        surge->setDeterministicRendering(seed);
+
+        float *data = nullptr;
+        Surge::Headless::playAsConfigured(surge, events, &data, &nS, &nC);
+        return std::unique_ptr<float[]>(data);
+    };
+
+    int nSA{0}, nCA{0}, nSB{0}, nCB{0};
+    auto a = render(configureA, nSA, nCA);
+    auto b = render(configureB, nSB, nCB);
+
+    RenderComparison res;
+    if (!a || !b || nCA != nCB)
+        return res;
+
+    res.nSamples = std::min(nSA, nSB);
+    for (int i = 0; i < res.nSamples * nCA; ++i)
+    {
+        auto d = std::fabs(a[i] - b[i]);
+        if (d > 0.f && res.firstDifferentSample < 0)
+            res.firstDifferentSample = i / nCA;
+        res.maxDifference = std::max(res.maxDifference, d);
+    }
+    return res;
+}
 } // namespace Test
 } // namespace Surge
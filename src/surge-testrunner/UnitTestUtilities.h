@@ -62,6 +62,24 @@ void makePlotPNGFromData(std::string pngFileName, std::string plotTitle, float *
 
 void setFX(std::shared_ptr<SurgeSynthesizer> surge, int slot, fx_type type);
 
+/*
+ * Render the same events through two freshly made synths, each set up by its configure
+ * function and put in deterministic mode with the same seed, and compare the output sample
+ * by sample. Use it to check an optimised path against the reference it replaces.
+ */
+struct RenderComparison
+{
+    float maxDifference{0.f};
+    int firstDifferentSample{-1}; // frame index, or -1 if they match exactly
+    int nSamples{0};
+};
+
+RenderComparison
+compareRenders(const std::function<void(std::shared_ptr<SurgeSynthesizer>)> &configureA,
+               const std::function<void(std::shared_ptr<SurgeSynthesizer>)> &configureB,
+               const Surge::Headless::playerEvents_t &events, uint32_t seed = 1,
+               float sr = 48000);
+
 std::shared_ptr<SurgeSynthesizer> surgeOnPatch(const std::string &patchName);
 std::shared_ptr<SurgeSynthesizer> surgeOnTemplate(const std::string &, float sr = 44100);
 std::shared_ptr<SurgeSynthesizer> surgeOnSine(float sr = 44100);
@@ -31,9 +31,16 @@
 
 #include "SSEComplex.h"
 #include <complex>
+#include <random>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
 
 #include "sst/plugininfra/cpufeatures.h"
+#include "TwistOscillator.h"
+#include "StringOscillator.h"
+#include "BiquadBank.h"
+#include "AliasOscillator.h"
+#include "sst/basic-blocks/dsp/ModulatedDelayLine.h"
+#include "WaveshaperADAA.h"
 
 using namespace Surge::Test;
 
@@ -393,6 +400,156 @@ TEST_CASE("Every Oscillator Plays", "[dsp]")
     }
 }
 
+TEST_CASE("High Rate Scene Decimators", "[dsp]")
+{
+    auto rmsAt = [](float sr) {
+        auto surge = Surge::Headless::createSurge(sr);
+        REQUIRE(surge->useHighRateDecimators == (sr >= 88200));
+
+        surge->storage.getPatch().scene[0].osc[0].queue_type = ot_sine;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        surge->playNote(0, 69, 127, 0);
+        double sumSq = 0;
+        int n = 0;
+        int blocks = (int)(sr / BLOCK_SIZE) / 2;
+        for (int b = 0; b < blocks; ++b)
+        {
+            surge->process();
+            if (b < blocks / 2)
+                continue;
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+            {
+                sumSq += surge->output[0][s] * surge->output[0][s];
+                n++;
+            }
+        }
+        return std::sqrt(sumSq / n);
+    };
+
+    auto lo = rmsAt(48000);
+    auto hi = rmsAt(96000);
+    REQUIRE(lo > 0.01);
+    REQUIRE(hi == Approx(lo).epsilon(0.02));
+}
+
+TEST_CASE("Wavetable Mipmaps Are Band Limited Copies", "[dsp]")
+{
+    // enough tables that the mipmaps get built on more than one thread
+    constexpr int N = 2048, T = 64;
+    std::vector<float> data(N * T);
+    for (int t = 0; t < T; ++t)
+        for (int i = 0; i < N; ++i)
+            data[t * N + i] = 0.8f * std::sin(2.0 * M_PI * (1 + (t & 15)) * i / N);
+
+    wt_header wh{};
+    memcpy(wh.tag, "vawt", 4);
+    wh.n_samples = N;
+    wh.n_tables = T;
+    wh.flags = 0;
+
+    auto wt = std::make_unique<Wavetable>();
+    REQUIRE(wt->BuildWT(data.data(), wh, false));
+
+    for (int l = 1; l <= 4; ++l)
+    {
+        int lsize = N >> l;
+        for (int t = 0; t < T; ++t)
+        {
+            INFO("level " << l << " table " << t);
+            for (int i = 0; i < lsize; ++i)
+            {
+                auto expected = 0.8f * std::sin(2.0 * M_PI * (1 + (t & 15)) * i / lsize);
+                REQUIRE(wt->TableF32WeakPointers[l][t][i] == Approx(expected).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Wavetable Mipmaps Build In The Background", "[dsp]")
+{
+    constexpr int N = 2048, T = 128;
+    std::vector<float> data(N * T);
+    for (int i = 0; i < N * T; ++i)
+        data[i] = 0.7f * std::sin(0.013 * i + 0.002 * (i / N)) * std::cos(0.0007 * i);
+
+    wt_header wh{};
+    memcpy(wh.tag, "vawt", 4);
+    wh.n_samples = N;
+    wh.n_tables = T;
+    wh.flags = 0;
+
+    // build it in place first, and let that block go so the next build can't share it
+    std::vector<float> expected;
+    {
+        auto wt = std::make_unique<Wavetable>();
+        REQUIRE(wt->BuildWT(data.data(), wh, false));
+        REQUIRE(wt->builtMipmap(6) == 6);
+        for (int l = 0; l <= 6; ++l)
+            expected.insert(expected.end(), wt->TableF32WeakPointers[l][T - 1],
+                            wt->TableF32WeakPointers[l][T - 1] + (N >> l));
+    }
+
+    WavetableMipmapBuilder builder;
+    auto wt = std::make_unique<Wavetable>();
+    wt->mipmapBuilder = &builder;
+    REQUIRE(wt->BuildWT(data.data(), wh, false));
+
+    // level 0 is there straight away, and whatever else we're told to read is finished
+    auto ready = wt->builtMipmap(6);
+    REQUIRE(ready >= 0);
+    REQUIRE(ready <= 6);
+    for (int i = 0; i < N; ++i)
+        REQUIRE(wt->TableF32WeakPointers[0][T - 1][i] == expected[i]);
+
+    builder.waitUntilIdle();
+    REQUIRE(wt->builtMipmap(6) == 6);
+    REQUIRE(wt->builtTableData()->isBuilt());
+
+    size_t idx = 0;
+    for (int l = 0; l <= 6; ++l)
+        for (int i = 0; i < (N >> l); ++i, ++idx)
+            REQUIRE(wt->TableF32WeakPointers[l][T - 1][i] == expected[idx]);
+}
+
+TEST_CASE("Compact Wavetables Match Their Float Builds", "[dsp]")
+{
+    constexpr int N = 1024, T = 8;
+    std::vector<float> data(N * T);
+    for (int i = 0; i < N * T; ++i)
+        data[i] = 0.9f * std::sin(2.0 * M_PI * (1 + (i / N)) * (i % N) / N);
+
+    wt_header wh{};
+    memcpy(wh.tag, "vawt", 4);
+    wh.n_samples = N;
+    wh.n_tables = T;
+    wh.flags = 0;
+
+    auto full = std::make_unique<Wavetable>();
+    REQUIRE(full->BuildWT(data.data(), wh, false));
+
+    std::atomic<bool> compact{true};
+    auto small = std::make_unique<Wavetable>();
+    small->buildCompact = &compact;
+    REQUIRE(small->BuildWT(data.data(), wh, false));
+
+    REQUIRE(!full->isCompact());
+    REQUIRE(small->isCompact());
+    REQUIRE(small->builtTableData()->f32 == nullptr);
+    REQUIRE(small->TableI16WeakPointers[0][0] != nullptr);
+
+    for (int l = 0; l <= 4; ++l)
+    {
+        for (int t = 0; t < T; ++t)
+        {
+            INFO("level " << l << " table " << t);
+            for (int i = 0; i < (N >> l); ++i)
+                REQUIRE(small->sampleAt(l, t, i) == Approx(full->sampleAt(l, t, i)).margin(1e-3));
+        }
+    }
+}
+
 TEST_CASE("Untuned is 2^x", "[dsp]")
 {
     auto surge = Surge::Headless::createSurge(44100);
@@ -584,6 +741,91 @@ TEST_CASE("Wavehaper Lookup Table", "[dsp]")
     }
 }
 
+TEST_CASE("Antialiased Waveshapers", "[dsp]")
+{
+    using namespace sst::waveshapers;
+
+    auto surge = Surge::Headless::createSurge(48000);
+
+    // the first lane of a sine at freq through ws, after a second of warming up
+    auto shape = [](QuadWaveshaperPtr ws, double freq, float drive, int n) {
+        QuadWaveshaperState qss{};
+        for (int i = 0; i < n_waveshaper_registers; ++i)
+            qss.R[i] = SIMD_MM(setzero_ps)();
+        qss.init = SIMD_MM(cmpeq_ps)(SIMD_MM(setzero_ps)(), SIMD_MM(setzero_ps)());
+
+        std::vector<float> res;
+        for (int i = -1024; i < n; ++i)
+        {
+            auto x = (float)(0.9 * std::sin(2.0 * M_PI * freq * i / 48000.0));
+            float out alignas(16)[4];
+            SIMD_MM(store_ps)(out, ws(&qss, SIMD_MM(set1_ps)(x), SIMD_MM(set1_ps)(drive)));
+            if (i >= 0)
+                res.push_back(out[0]);
+        }
+        return res;
+    };
+
+    SECTION("Slow Input Follows The Shape")
+    {
+        for (auto t : {WaveshaperType::wst_soft, WaveshaperType::wst_hard, WaveshaperType::wst_asym,
+                       WaveshaperType::wst_sine})
+        {
+            for (auto mode : {wsaa_first_order, wsaa_second_order})
+            {
+                INFO("Waveshaper " << wst_names[(int)t] << " mode " << mode);
+                REQUIRE(hasAntialiasedWaveshaper(t));
+
+                auto plain = shape(GetQuadWaveshaper(t), 2, 2.f, 4800);
+                auto aa = shape(GetAntialiasedQuadWaveshaper(t, mode), 2, 2.f, 4800);
+
+                for (int i = 0; i < plain.size(); ++i)
+                    REQUIRE(aa[i] == Approx(plain[i]).margin(0.005));
+            }
+        }
+    }
+
+    SECTION("Less Aliasing With Each Order")
+    {
+        // a whole number of cycles, so everything not at a harmonic bin has folded back
+        const int n = 2048, bin = 97;
+        auto aliasing = [&](const std::vector<float> &v) {
+            double harmonics = 0, aliases = 0;
+            for (int k = 1; k < n / 2; ++k)
+            {
+                std::complex<double> acc = 0;
+                for (int i = 0; i < n; ++i)
+                    acc += (double)v[i] * std::polar(1.0, -2.0 * M_PI * k * i / n);
+                (k % bin == 0 ? harmonics : aliases) += std::norm(acc);
+            }
+            return 10 * std::log10(aliases / harmonics);
+        };
+
+        for (auto t : {WaveshaperType::wst_hard, WaveshaperType::wst_fuzz})
+        {
+            INFO("Waveshaper " << wst_names[(int)t]);
+            auto freq = 48000.0 * bin / n;
+
+            auto off = aliasing(shape(GetQuadWaveshaper(t), freq, 4.f, n));
+            auto first = aliasing(
+                shape(GetAntialiasedQuadWaveshaper(t, wsaa_first_order), freq, 4.f, n));
+            auto second = aliasing(
+                shape(GetAntialiasedQuadWaveshaper(t, wsaa_second_order), freq, 4.f, n));
+
+            INFO(off << " " << first << " " << second);
+            REQUIRE(first < off - 6);
+            REQUIRE(second < first);
+        }
+    }
+
+    SECTION("Off And Unsupported Shapes Have None")
+    {
+        REQUIRE(!GetAntialiasedQuadWaveshaper(WaveshaperType::wst_hard, wsaa_off));
+        REQUIRE(!hasAntialiasedWaveshaper(WaveshaperType::wst_cheby2));
+        REQUIRE(!GetAntialiasedQuadWaveshaper(WaveshaperType::wst_cheby2, wsaa_first_order));
+    }
+}
+
 TEST_CASE("Don't Fear The Reaper", "[dsp]")
 {
     // Reaper added cool per-plugin oversampling. Will we do OK with that?
@@ -699,6 +941,299 @@ TEST_CASE("Reverb1 White Noise Blast", "[dsp]")
     }
 }
 
+TEST_CASE("Twist Reuses Pooled Voice State", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    auto storage = &surge->storage;
+    auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+
+    unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+
+    auto render = [&](int engine) {
+        auto o = spawn_osc(ot_twist, storage, oscstorage, storage->getPatch().scenedata[0],
+                           storage->getPatch().scenedataOrig[0], oscbuffer);
+        o->init_ctrltypes();
+        o->init_default_values();
+        o->init_extra_config();
+        oscstorage->retrigger.val.b = true;
+        oscstorage->p[TwistOscillator::twist_engine].val.i = engine;
+
+        o->init(60);
+
+        std::vector<float> res;
+        for (int j = 0; j < 20; ++j)
+        {
+            o->process_block(60, 0, true, false, 0);
+            for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                res.push_back(o->output[i]);
+        }
+        o->~Oscillator();
+        return res;
+    };
+
+    // The second FM run gets a recycled state whose plaits voice last ran another engine
+    auto fm = render(2);
+    auto va = render(0);
+    auto fmAgain = render(2);
+
+    REQUIRE(fm.size() == fmAgain.size());
+    float sumAbs = 0;
+    for (auto i = 0U; i < fm.size(); ++i)
+    {
+        REQUIRE(fm[i] == fmAgain[i]);
+        sumAbs += std::fabs(fm[i]);
+    }
+    REQUIRE(sumAbs > 1);
+    REQUIRE(fm != va);
+}
+
+TEST_CASE("String Short Delay Lines Match Long Ones", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    auto storage = &surge->storage;
+    auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+
+    unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+
+    auto render = [&](float pitch, int fm, bool &usedShort) {
+        storage->getPatch().scene[0].fm_switch.val.i = fm;
+
+        auto o = spawn_osc(ot_string, storage, oscstorage, storage->getPatch().scenedata[0],
+                           storage->getPatch().scenedataOrig[0], oscbuffer);
+        o->init_ctrltypes();
+        o->init_default_values();
+        o->init_extra_config();
+        oscstorage->retrigger.val.b = true;
+
+        // display mode seeds the exciter noise identically each time
+        o->init(pitch, true);
+        usedShort = static_cast<StringOscillator *>(o)->useShortLines;
+
+        std::vector<float> res;
+        for (int j = 0; j < 50; ++j)
+        {
+            o->process_block(pitch, 0, true, false, 0);
+            for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                res.push_back(o->output[i]);
+        }
+        o->~Oscillator();
+        return res;
+    };
+
+    bool shortA, shortB;
+    auto viaShort = render(72, fm_off, shortA);
+    auto viaLong = render(72, fm_2to1, shortB);
+    REQUIRE(shortA);
+    REQUIRE(!shortB);
+    REQUIRE(viaShort == viaLong);
+
+    bool shortLow;
+    render(24, fm_off, shortLow);
+    REQUIRE(!shortLow);
+
+    storage->getPatch().scene[0].fm_switch.val.i = fm_off;
+}
+
+TEST_CASE("Unison Tables Match The Unison Setup", "[dsp]")
+{
+    for (int n = 1; n <= MAX_UNISON; ++n)
+    {
+        INFO("voices " << n);
+        auto us = Surge::Oscillator::UnisonSetup<float>(n);
+        auto &t = Surge::Oscillator::UnisonTable::forVoices(n);
+
+        REQUIRE(t.voices == n);
+        REQUIRE(t.attenuation_inv == (float)us.attenuation_inv());
+
+        for (int v = 0; v < n; ++v)
+        {
+            float l, r, al, ar;
+            us.panLaw(v, l, r);
+            us.attenuatedPanLaw(v, al, ar);
+
+            REQUIRE(t.detune[v] == us.detune(v));
+            REQUIRE(t.panL[v] == l);
+            REQUIRE(t.panR[v] == r);
+            REQUIRE(t.attenuatedPanL[v] == al);
+            REQUIRE(t.attenuatedPanR[v] == ar);
+            REQUIRE(t.pan[v] == Approx(1.f - l).margin(1e-6));
+        }
+
+        // the padding is silent, so a voice loop can safely run on to the end of a register
+        for (int v = n; v < Surge::Oscillator::UnisonTable::padded; ++v)
+        {
+            REQUIRE(t.panL[v] == 0.f);
+            REQUIRE(t.attenuatedPanR[v] == 0.f);
+        }
+    }
+}
+
+TEST_CASE("Biquad Banks Match Separate BiquadFilters", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    auto storage = &surge->storage;
+
+    BiquadBank<4> bank(storage);
+    BiquadBank<8, float> floatBank(storage);
+    std::vector<BiquadFilter> filters(4, BiquadFilter(storage));
+
+    auto design = [&](int lane, float f) {
+        auto omega = filters[lane].calc_omega(f / 12.0);
+        switch (lane)
+        {
+        case 0:
+            filters[lane].coeff_HP(omega, 0.4);
+            return BiquadCoefficients::highpass(omega, 0.4);
+        case 1:
+            filters[lane].coeff_LP(omega, 0.707);
+            return BiquadCoefficients::lowpass(omega, 0.707);
+        default:
+            filters[lane].coeff_peakEQ(omega, 1, 6);
+            return BiquadCoefficients::peakEQ(omega, 1, storage->db_to_linear(6),
+                                              storage->db_to_linear(3), 1);
+        }
+    };
+
+    // a lane which isn't active passes its input through
+    bank.setActive(3, false);
+    for (int l = 4; l < 8; ++l)
+        floatBank.setActive(l, false);
+
+    float in alignas(16)[4][BLOCK_SIZE];
+    double frames alignas(16)[BLOCK_SIZE * 4];
+    float floatFrames alignas(16)[BLOCK_SIZE * 8];
+
+    for (int blk = 0; blk < 100; ++blk)
+    {
+        // move the corners half way through to check the coefficients glide alike
+        for (int l = 0; l < 4; ++l)
+        {
+            auto c = design(l, (blk < 50 ? -24 : 12) + 6 * l);
+            bank.setCoefficients(l, c);
+            floatBank.setCoefficients(l, c);
+        }
+
+        for (int k = 0; k < BLOCK_SIZE; ++k)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                float x = sin(0.03 * (l + 1) * (blk * BLOCK_SIZE + k)) + 0.1f * l;
+                in[l][k] = x;
+                frames[k * 4 + l] = x;
+                floatFrames[k * 8 + l] = x;
+                floatFrames[k * 8 + l + 4] = x;
+            }
+        }
+
+        bank.processFrames(frames);
+        floatBank.processFrames(floatFrames);
+
+        for (int l = 0; l < 4; ++l)
+        {
+            float data alignas(16)[BLOCK_SIZE];
+            std::copy(in[l], in[l] + BLOCK_SIZE, data);
+            filters[l].process_block(data);
+
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                INFO("lane " << l << " block " << blk << " sample " << k);
+                if (l == 3)
+                    REQUIRE(frames[k * 4 + l] == in[l][k]);
+                else
+                    REQUIRE(frames[k * 4 + l] == Approx(data[k]).margin(1e-5));
+                REQUIRE(floatFrames[k * 8 + l] == Approx(data[k]).margin(2e-3));
+                REQUIRE(floatFrames[k * 8 + l + 4] == in[l][k]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Alias Noise Generator Steps At Every Multiple", "[dsp]")
+{
+    // the generator counts stepCount up to the target, stepping where the count is a multiple
+    for (int every : {8, 9, 13, 64, 255})
+    {
+        AliasOscillator::UInt8RNG jump, walk;
+        jump.a = walk.a = 73;
+
+        uint8_t target = 0;
+        for (int i = 0; i < 2000; ++i)
+        {
+            target = (uint8_t)(target * 37 + 11 + i);
+
+            uint8_t r = walk.a;
+            while (walk.stepCount != target)
+            {
+                walk.stepCount++;
+                if (walk.stepCount % every == 0)
+                    r = walk.step();
+            }
+
+            INFO("every " << every << " step " << i);
+            REQUIRE(jump.stepTo(target, every) == r);
+            REQUIRE(jump.stepCount == walk.stepCount);
+            REQUIRE(jump.a == walk.a);
+        }
+    }
+}
+
+TEST_CASE("Modulated Delay Line Reads Match Scalar Taps", "[dsp]")
+{
+    namespace sdsp = sst::basic_blocks::dsp;
+    using mdi = sdsp::ModulatedDelayInterpolation;
+
+    auto surge = Surge::Headless::createSurge(44100);
+    auto storage = &surge->storage;
+
+    static constexpr int len = 1024, N = FIRipol_N;
+    static sdsp::FixedModulatedDelayLine<len> line;
+    line.clear();
+    line.sinctable1X = storage->sinctable1X;
+
+    float ring[len];
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    for (int k = 0; k < 4 * len; ++k)
+    {
+        ring[k & (len - 1)] = dist(gen);
+        line.write(ring[k & (len - 1)]);
+
+        if (k < len)
+            continue;
+
+        auto at = [&](int back) { return ring[(k + 1 - back) & (len - 1)]; };
+
+        float d alignas(16)[4], lin alignas(16)[4], sinc alignas(16)[4], herm alignas(16)[4];
+        for (int l = 0; l < 4; ++l)
+            d[l] = 2 + (len - 2 * N) * (0.5f + 0.5f * std::sin(0.003f * k + l));
+
+        SIMD_MM(store_ps)(lin, line.read4<mdi::LINEAR>(SIMD_MM(load_ps)(d)));
+        SIMD_MM(store_ps)(sinc, line.read4<mdi::SINC>(SIMD_MM(load_ps)(d)));
+        SIMD_MM(store_ps)(herm, line.read4<mdi::HERMITE>(SIMD_MM(load_ps)(d)));
+
+        for (int l = 0; l < 4; ++l)
+        {
+            int i = (int)d[l];
+            float f = d[l] - i;
+            REQUIRE(lin[l] == Approx(at(i) * (1 - f) + at(i + 1) * f).margin(1e-6));
+
+            // the chorus tap, a row per 1/FIRipol_M sample
+            int row = std::min((int)(FIRipol_M * (1 - f)), FIRipol_M - 1);
+            float s = 0;
+            for (int j = 0; j < N; ++j)
+                s += at(i + N - j) * storage->sinctable1X[row * N + j];
+            REQUIRE(sinc[l] == Approx(s).margin(1e-5));
+
+            // Catmull-Rom from the older sample to the newer one
+            float y0 = at(i + 2), y1 = at(i + 1), y2 = at(i), y3 = at(i - 1), t = 1 - f;
+            float c1 = 0.5f * (y2 - y0), c2 = y0 - 2.5f * y1 + 2.f * y2 - 0.5f * y3;
+            float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+            REQUIRE(herm[l] == Approx(((c3 * t + c2) * t + c1) * t + y1).margin(1e-5));
+        }
+    }
+}
+
 TEST_CASE("Oscillator Onset", "[dsp]") // See issue 7570
 {
     for (const auto &rt : {true, false})
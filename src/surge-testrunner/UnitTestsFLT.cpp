@@ -100,3 +100,101 @@ TEST_CASE("Run Every Waveshaper", "[flt]")
         }
     }
 }
+
+TEST_CASE("Fused Filter Chains Match The Pointer Path", "[flt]")
+{
+    using namespace sst::filters;
+
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto init = [&](QuadFilterChainState &Q, FilterType t1, FilterType t2, bool ramp) {
+        InitQuadFilterChainStateToZero(&Q);
+
+        for (int u = 0; u < 4; ++u)
+        {
+            FilterCoefficientMaker<SurgeStorage> cm;
+            cm.setSampleRateAndBlockSize((float)surge->storage.dsamplerate_os, BLOCK_SIZE_OS);
+            cm.MakeCoeffs(u & 1 ? 12.f : -6.f, 0.6f, (u & 1) ? t2 : t1, st_Standard,
+                          &surge->storage, false);
+            cm.updateState(Q.FU[u]);
+
+            for (int i = 0; i < 4; ++i)
+                Q.FU[u].active[i] = 0xffffffff;
+        }
+
+        Q.Gain = SIMD_MM(set1_ps)(0.8f);
+        Q.Mix1 = SIMD_MM(set1_ps)(0.7f);
+        Q.Mix2 = SIMD_MM(set1_ps)(0.6f);
+        Q.Drive = SIMD_MM(set1_ps)(2.f);
+        Q.FB = SIMD_MM(set1_ps)(0.3f);
+        Q.OutL = Q.OutR = Q.Out2L = Q.Out2R = SIMD_MM(set1_ps)(0.5f);
+
+        // both the ramped and the steady copies of each chain
+        if (ramp)
+        {
+            Q.dGain = SIMD_MM(set1_ps)(0.001f);
+            Q.dMix1 = SIMD_MM(set1_ps)(-0.002f);
+        }
+
+        for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+        {
+            Q.DL[k] = SIMD_MM(set_ps)(sin(k * 0.1f), sin(k * 0.2f), sin(k * 0.3f), sin(k * 0.4f));
+            Q.DR[k] = SIMD_MM(set_ps)(cos(k * 0.1f), cos(k * 0.2f), cos(k * 0.3f), cos(k * 0.4f));
+        }
+    };
+
+    for (auto config : {fc_serial1, fc_serial2, fc_dual1, fc_stereo})
+    {
+        for (auto t1 : {fut_lp12, fut_lp24})
+        {
+            for (auto ws : {false, true})
+            {
+                for (auto t2 : {fut_none, fut_lp12})
+                {
+                    INFO("config " << config << " f1 " << t1 << " ws " << ws << " f2 " << t2);
+
+                    fbq_global g;
+                    g.FU1ptr = GetQFPtrFilterUnit(t1, st_Standard);
+                    g.FU2ptr = t2 == fut_none ? nullptr : GetQFPtrFilterUnit(t2, st_Standard);
+                    g.WSptr = ws ? sst::waveshapers::GetQuadWaveshaper(
+                                       sst::waveshapers::WaveshaperType::wst_soft)
+                                 : nullptr;
+
+                    auto fused = GetFusedFBQPointer(config, g);
+                    REQUIRE(fused);
+                    auto plain = GetFBQPointer(config, true, ws, t2 != fut_none);
+                    REQUIRE(plain);
+                    REQUIRE(fused != plain);
+
+                    auto qa = std::make_unique<QuadFilterChainState>();
+                    auto qb = std::make_unique<QuadFilterChainState>();
+                    auto ramp = (config + t1 + t2) & 1;
+                    init(*qa, t1, t2 == fut_none ? fut_lp12 : t2, ramp);
+                    init(*qb, t1, t2 == fut_none ? fut_lp12 : t2, ramp);
+
+                    float la alignas(16)[BLOCK_SIZE_OS]{}, ra alignas(16)[BLOCK_SIZE_OS]{};
+                    float lb alignas(16)[BLOCK_SIZE_OS]{}, rb alignas(16)[BLOCK_SIZE_OS]{};
+
+                    for (int blk = 0; blk < 4; ++blk)
+                    {
+                        fused(*qa, g, la, ra);
+                        plain(*qb, g, lb, rb);
+                    }
+
+                    for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                    {
+                        REQUIRE(la[i] == lb[i]);
+                        REQUIRE(ra[i] == rb[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    fbq_global g;
+    g.FU1ptr = GetQFPtrFilterUnit(fut_comb_pos, st_Standard);
+    g.FU2ptr = nullptr;
+    g.WSptr = nullptr;
+    REQUIRE(!GetFusedFBQPointer(fc_serial1, g));
+}
@@ -32,6 +32,20 @@
 
 #include "UnitTestUtilities.h"
 #include "AudioInputEffect.h"
+#include "CombulatorEffect.h"
+#include "ConditionerEffect.h"
+#include "airwindows/AirWindowsEffect.h"
+#include "ConvolutionEffect.h"
+#include "NimbusEffect.h"
+#include "PartitionedConvolver.h"
+#include "SurgeMemoryPools.h"
+#include "SurgeSSTFXAdapter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <thread>
 
 using namespace Surge::Test;
 
@@ -116,6 +130,65 @@ TEST_CASE("Airwindows Loud", "[fx]")
     }
 }
 
+TEST_CASE("Airwindows Whole And Sub Block Paths", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    Surge::Test::setFX(surge, fxslot_ains1, fxt_airwindows);
+    auto &fxs = surge->storage.getPatch().fx[fxslot_ains1];
+    auto &gd = surge->storage.getPatch().globaldata;
+
+    auto *aw = dynamic_cast<AirWindowsEffect *>(surge->fx[fxslot_ains1].get());
+    REQUIRE(aw);
+
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+
+    auto run = [&](int blocks) {
+        for (int b = 0; b < blocks; ++b)
+        {
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                L[k] = dist(gen);
+                R[k] = dist(gen);
+            }
+            aw->process(L, R);
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                REQUIRE(std::isfinite(L[k]));
+                REQUIRE(std::isfinite(R[k]));
+            }
+        }
+    };
+
+    for (int idx = 0; idx < (int)AirWindowsEffect::fxreg.size(); ++idx)
+    {
+        INFO("Airwindows " << AirWindowsEffect::fxreg[idx].name);
+        fxs.p[0].val.i = idx;
+        run(200);
+        REQUIRE(aw->airwin);
+        if (aw->airwin->paramCount == 0)
+            continue;
+
+        // once the lags settle the values handed over are exactly the targets
+        for (int i = 0; i < aw->airwin->paramCount && i < n_fx_params - 1; ++i)
+        {
+            if (fxs.p[i + 1].ctrltype != ct_airwindows_param_integral)
+                REQUIRE(aw->lastSetParam[i] == clamp01(gd[fxs.p[i + 1].id].f));
+        }
+
+        // and a moving parameter goes back to sub blocks
+        auto &first = gd[fxs.p[1].id].f;
+        auto held = first;
+        first = held > 0.5f ? held - 0.2f : held + 0.2f;
+        run(4);
+        first = held;
+        run(4);
+    }
+}
+
 TEST_CASE("Move FX With Assigned Modulation", "[fx]")
 {
     auto step = [](auto surge) {
@@ -1081,3 +1154,759 @@ TEST_CASE("Audio Input Effect", "[fx]")
         }
     }
 }
+
+TEST_CASE("Idle Engine Skips Silent Processing", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        Surge::Test::setFX(surge, i, fxt_off);
+
+    // the conditioner rings out after a fixed number of blocks
+    Surge::Test::setFX(surge, 0, fxt_conditioner);
+
+    auto runUntilSilent = [&surge]() {
+        for (int i = 0; i < 10000 && !surge->outputSilent; ++i)
+            surge->process();
+        return surge->outputSilent;
+    };
+
+    REQUIRE(runUntilSilent());
+
+    surge->playNote(0, 60, 127, 0);
+    for (int i = 0; i < 50; ++i)
+    {
+        surge->process();
+        REQUIRE(!surge->outputSilent);
+    }
+
+    float peak = 0.f;
+    for (int i = 0; i < BLOCK_SIZE; ++i)
+        peak = std::max(peak, std::fabs(surge->output[0][i]));
+    REQUIRE(peak > 0.f);
+
+    surge->releaseNote(0, 60, 0);
+    REQUIRE(runUntilSilent());
+
+    for (int b = 0; b < 10; ++b)
+    {
+        surge->process();
+        REQUIRE(surge->outputSilent);
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            REQUIRE(surge->output[0][i] == 0.f);
+            REQUIRE(surge->output[1][i] == 0.f);
+        }
+    }
+
+    // and it comes back when there's something to play
+    surge->playNote(0, 64, 127, 0);
+    surge->process();
+    REQUIRE(!surge->outputSilent);
+}
+
+TEST_CASE("Tail Length Follows Envelopes And Effects", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        Surge::Test::setFX(surge, i, fxt_off);
+
+    auto &patch = surge->storage.getPatch();
+    patch.scene[0].adsr[0].r.val.f = 0.f;
+    patch.scene[1].adsr[0].r.val.f = 1.f;
+    REQUIRE(surge->getTailLengthSeconds() == Approx(2.0));
+
+    // the conditioner rings out after 100 blocks
+    Surge::Test::setFX(surge, 0, fxt_conditioner);
+    REQUIRE(surge->getTailLengthSeconds() == Approx(2.0 + 100.0 * BLOCK_SIZE / 48000.0));
+
+    // a disabled slot doesn't count
+    patch.fx_disable.val.i = 1;
+    REQUIRE(surge->getTailLengthSeconds() == Approx(2.0));
+    patch.fx_disable.val.i = 0;
+
+    // and a delay can ring forever
+    Surge::Test::setFX(surge, fxslot_send1, fxt_delay);
+    REQUIRE(surge->getTailLengthSeconds() < 0);
+}
+
+TEST_CASE("Conditioner Lookahead Latency", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        Surge::Test::setFX(surge, i, fxt_off);
+
+    auto &patch = surge->storage.getPatch();
+    auto run = [&surge]() {
+        for (int i = 0; i < 4; ++i)
+            surge->process();
+        return surge->fxLatencySamples.load();
+    };
+
+    REQUIRE(run() == 0);
+
+    // the default lookahead is 2 ms
+    Surge::Test::setFX(surge, fxslot_ains1, fxt_conditioner);
+    REQUIRE(run() == 96);
+
+    // the scene B chain runs alongside, the global chain comes after both
+    Surge::Test::setFX(surge, fxslot_bins1, fxt_conditioner);
+    patch.fx[fxslot_bins1].p[ConditionerEffect::cond_lookahead].val.f = 0.f;
+    REQUIRE(run() == 96);
+
+    Surge::Test::setFX(surge, fxslot_global1, fxt_conditioner);
+    patch.fx[fxslot_global1].p[ConditionerEffect::cond_lookahead].val.f = 0.f;
+    REQUIRE(run() == 96 + 24);
+
+    // and neither a disabled slot nor bypassed inserts count
+    patch.fx_disable.val.i = 1 << fxslot_global1;
+    REQUIRE(run() == 96);
+    patch.fx_disable.val.i = 0;
+
+    patch.fx_bypass.val.i = fxb_no_fx;
+    REQUIRE(run() == 0);
+}
+
+TEST_CASE("Multithreaded Effect Rendering", "[fx]")
+{
+    auto render = [](bool threaded) {
+        auto surge = Surge::Headless::createSurge(48000);
+        REQUIRE(surge);
+
+        auto &patch = surge->storage.getPatch();
+        patch.scenemode.val.i = sm_dual;
+
+        // inserts on both scenes, and three of the four sends
+        Surge::Test::setFX(surge, fxslot_ains1, fxt_chorus4);
+        Surge::Test::setFX(surge, fxslot_bins1, fxt_flanger);
+        Surge::Test::setFX(surge, fxslot_send1, fxt_reverb);
+        Surge::Test::setFX(surge, fxslot_send2, fxt_delay);
+        Surge::Test::setFX(surge, fxslot_send3, fxt_phaser);
+        Surge::Test::setFX(surge, fxslot_global1, fxt_eq);
+
+        for (int sc = 0; sc < n_scenes; ++sc)
+            for (int i = 0; i < n_send_slots; ++i)
+                patch.scene[sc].send_level[i].set_value_f01(0.7);
+
+        surge->setMultithreadedEffectRendering(threaded);
+        REQUIRE(surge->getMultithreadedEffectRendering() == threaded);
+
+        std::vector<float> res;
+        for (auto k : {48, 55, 60, 64})
+            surge->playNote(0, k, 110, 0);
+
+        for (int i = 0; i < 400; ++i)
+        {
+            if (i == 200)
+            {
+                for (auto k : {48, 55, 60, 64})
+                    surge->releaseNote(0, k, 0);
+            }
+            surge->process();
+            for (int j = 0; j < BLOCK_SIZE; ++j)
+            {
+                res.push_back(surge->output[0][j]);
+                res.push_back(surge->output[1][j]);
+            }
+        }
+        return res;
+    };
+
+    auto threaded = render(true);
+    auto serial = render(false);
+
+    REQUIRE(threaded.size() == serial.size());
+
+    // none of these effects draw random numbers, so the schedule can't change the result
+    float rms = 0;
+    for (size_t i = 0; i < threaded.size(); ++i)
+    {
+        REQUIRE(threaded[i] == serial[i]);
+        rms += threaded[i] * threaded[i];
+    }
+    REQUIRE(rms > 0);
+}
+
+TEST_CASE("Effect Swaps Are Built Off The Audio Thread", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    int slot = fxslot_ains1;
+    Surge::Test::setFX(surge, slot, fxt_delay);
+    REQUIRE(surge->fx[slot]);
+
+    auto *before = surge->fx[slot].get();
+
+    surge->playNote(0, 60, 127, 0);
+    for (int i = 0; i < 20; ++i)
+        surge->process();
+
+    // what the fx menu does on the UI thread
+    surge->fxsync[slot].type.val.i = fxt_reverb2;
+    surge->prepareFxSwap(slot);
+
+    auto &box = surge->prespawnedFx[slot];
+    REQUIRE(box.state == SurgeSynthesizer::PrespawnedEffect::ready);
+    auto *built = box.fx;
+    REQUIRE(built);
+
+    surge->fx_reload[slot] = true;
+    surge->load_fx_needed = true;
+    surge->process();
+
+    REQUIRE(surge->fx[slot].get() == built);
+    REQUIRE(box.state == SurgeSynthesizer::PrespawnedEffect::empty);
+    REQUIRE(!box.fx);
+    REQUIRE(surge->retiredFx[slot].load() == before);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        surge->process();
+        for (int j = 0; j < BLOCK_SIZE; ++j)
+            REQUIRE(std::isfinite(surge->output[0][j]));
+    }
+
+    surge->freeRetiredEffects();
+    REQUIRE(!surge->retiredFx[slot].load());
+
+    SECTION("A Stale Build Is Not Used")
+    {
+        surge->fxsync[slot].type.val.i = fxt_chorus4;
+        surge->prepareFxSwap(slot);
+        REQUIRE(box.state == SurgeSynthesizer::PrespawnedEffect::ready);
+
+        // and then something else changes the type before the audio thread gets there
+        surge->fxsync[slot].type.val.i = fxt_phaser;
+        surge->fx_reload[slot] = true;
+        surge->load_fx_needed = true;
+        surge->process();
+
+        REQUIRE(surge->fx[slot]);
+        REQUIRE(surge->storage.getPatch().fx[slot].type.val.i == fxt_phaser);
+        REQUIRE(box.state == SurgeSynthesizer::PrespawnedEffect::empty);
+        surge->freeRetiredEffects();
+    }
+}
+
+TEST_CASE("Effect Oversampling Quality", "[fx]")
+{
+    for (auto type : {fxt_neuron, fxt_exciter})
+    {
+        DYNAMIC_SECTION("Effect type " << type)
+        {
+            auto render = [type](SurgeStorage::EffectOversampling q) {
+                auto surge = Surge::Headless::createSurge(48000);
+                REQUIRE(surge);
+
+                surge->setEffectOversampling(q);
+                Surge::Test::setFX(surge, fxslot_ains1, (fx_type)type);
+                REQUIRE(surge->storage.effectOversampling == q);
+
+                std::vector<float> res;
+                surge->playNote(0, 48, 127, 0);
+                for (int i = 0; i < 200; ++i)
+                {
+                    surge->process();
+                    for (int j = 0; j < BLOCK_SIZE; ++j)
+                    {
+                        REQUIRE(std::isfinite(surge->output[0][j]));
+                        res.push_back(surge->output[0][j]);
+                    }
+                }
+                return res;
+            };
+
+            auto eco = render(SurgeStorage::EFFECT_OVERSAMPLING_ECO);
+            auto standard = render(SurgeStorage::EFFECT_OVERSAMPLING_STANDARD);
+            auto high = render(SurgeStorage::EFFECT_OVERSAMPLING_HIGH);
+
+            float dEco = 0, dHigh = 0, rms = 0;
+            for (size_t i = 0; i < standard.size(); ++i)
+            {
+                dEco += std::fabs(eco[i] - standard[i]);
+                dHigh += std::fabs(high[i] - standard[i]);
+                rms += standard[i] * standard[i];
+            }
+
+            REQUIRE(rms > 0);
+            REQUIRE(dEco > 0);
+            REQUIRE(dHigh > 0);
+        }
+    }
+
+    SECTION("Changing Quality Reinitialises Running Effects")
+    {
+        auto surge = Surge::Headless::createSurge(48000);
+        Surge::Test::setFX(surge, fxslot_ains1, fxt_neuron);
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_STANDARD);
+
+        surge->setEffectOversampling(SurgeStorage::EFFECT_OVERSAMPLING_HIGH);
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_STANDARD);
+
+        surge->process();
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_HIGH);
+        REQUIRE(surge->storage.effectOversamplingFactor(2) == 3);
+    }
+
+    SECTION("Offline Rendering Uses The Bounce Profile")
+    {
+        auto surge = Surge::Headless::createSurge(48000);
+        Surge::Test::setFX(surge, fxslot_ains1, fxt_neuron);
+        surge->setEffectOversampling(SurgeStorage::EFFECT_OVERSAMPLING_ECO);
+        surge->process();
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_ECO);
+        REQUIRE(!surge->storage.renderingForBounce);
+
+        surge->setOfflineRendering(true);
+        surge->process();
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_HIGH);
+        REQUIRE(surge->storage.renderingForBounce);
+
+        // back to the live choice when the bounce is done
+        surge->setOfflineRendering(false);
+        surge->process();
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_ECO);
+
+        // and an instance can opt out
+        surge->bounceQualityWhenOffline = false;
+        surge->setOfflineRendering(true);
+        surge->process();
+        REQUIRE(surge->storage.effectOversampling == SurgeStorage::EFFECT_OVERSAMPLING_ECO);
+        REQUIRE(!surge->storage.renderingForBounce);
+    }
+}
+
+TEST_CASE("Vocoder Skips Silent Bands", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    surge->process_input = true;
+    Surge::Test::setFX(surge, fxslot_ains1, fxt_vocoder);
+    surge->playNote(0, 48, 127, 0);
+
+    double phase = 0;
+    auto run = [&](int blocks, float modLevel) {
+        float rms = 0;
+        for (int i = 0; i < blocks; ++i)
+        {
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                surge->input[0][k] = modLevel * std::sin(phase);
+                surge->input[1][k] = surge->input[0][k];
+                phase += 2.0 * M_PI * 440.0 / surge->storage.samplerate;
+            }
+            surge->process();
+            rms = 0;
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                REQUIRE(std::isfinite(surge->output[0][k]));
+                rms += surge->output[0][k] * surge->output[0][k];
+            }
+        }
+        return rms;
+    };
+
+    // a voiced modulator opens the bands around it
+    REQUIRE(run(200, 0.5f) > 0);
+
+    // once every envelope and carrier has died away the band bank renders true silence
+    REQUIRE(run(3000, 0.f) == 0);
+
+    // and the culled bands pick up again as soon as the modulator returns
+    REQUIRE(run(200, 0.5f) > 0);
+}
+
+TEST_CASE("Audio Input Is Only Processed When Something Reads It", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    surge->process_input = true;
+    auto run = [&](int blocks) {
+        for (int i = 0; i < blocks; ++i)
+        {
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                surge->input[0][k] = 0.5f;
+                surge->input[1][k] = -0.5f;
+            }
+            surge->process();
+        }
+    };
+
+    REQUIRE(surge->storage.audio_in_clients == 0);
+    REQUIRE(surge->storage.audio_in_nonOS_clients == 0);
+    run(4);
+    REQUIRE(surge->storage.audio_in_nonOS[0][0] == 0.f);
+    REQUIRE(surge->storage.audio_in[0][BLOCK_SIZE_OS - 1] == 0.f);
+
+    // the vocoder reads the input at the engine rate, which doesn't wake the upsampler
+    Surge::Test::setFX(surge, fxslot_ains1, fxt_vocoder);
+    REQUIRE(surge->storage.audio_in_nonOS_clients == 1);
+    run(4);
+    REQUIRE(surge->storage.audio_in_nonOS[0][0] == 0.5f);
+    REQUIRE(surge->storage.audio_in_nonOS[1][BLOCK_SIZE - 1] == -0.5f);
+    REQUIRE(surge->storage.audio_in[0][BLOCK_SIZE_OS - 1] == 0.f);
+
+    // an audio input oscillator does
+    auto &osc = surge->storage.getPatch().scene[0].osc[0];
+    osc.type.val.i = ot_audioinput;
+    surge->storage.getPatch().update_controls(false, &osc);
+    surge->playNote(0, 60, 127, 0);
+    run(20);
+    REQUIRE(surge->storage.audio_in_clients > 0);
+    REQUIRE(surge->storage.audio_in[0][BLOCK_SIZE_OS - 1] == Approx(0.5f).margin(0.01));
+}
+
+TEST_CASE("Partitioned Convolution", "[fx]")
+{
+    // lengths either side of the block, the head and the tail partition boundaries
+    for (int len : {1, BLOCK_SIZE - 1, BLOCK_SIZE, PartitionedConvolver::headLength,
+                    PartitionedConvolver::headLength + 1, 5000, 20000})
+    {
+        DYNAMIC_SECTION("Impulse length " << len)
+        {
+            std::mt19937 gen(len);
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+            std::vector<float> ir(len);
+            for (auto &f : ir)
+                f = dist(gen);
+
+            PartitionedConvolver conv;
+            conv.prepare(ir.data(), len);
+            REQUIRE(conv.getLength() == len);
+
+            const int blocks = 1500;
+            std::vector<float> in(blocks * BLOCK_SIZE), out(blocks * BLOCK_SIZE);
+            for (auto &f : in)
+                f = dist(gen);
+
+            for (int b = 0; b < blocks; ++b)
+                conv.process(&in[b * BLOCK_SIZE], &out[b * BLOCK_SIZE]);
+
+            for (int t = 0; t < blocks * BLOCK_SIZE; t += 13)
+            {
+                double direct = 0;
+                for (int k = 0; k < len && k <= t; ++k)
+                    direct += ir[k] * in[t - k];
+
+                REQUIRE(out[t] == Approx(direct).margin(1e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("Convolution Effect Loads An Impulse Response", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    // a mono float wav which is a single tap 100 samples in
+    const int irLen = 512, tap = 100;
+    auto fn = std::string(std::tmpnam(nullptr)) + ".wav";
+    {
+        std::vector<float> ir(irLen, 0.f);
+        ir[tap] = 0.25f;
+
+        auto put32 = [](std::ofstream &o, uint32_t v) { o.write((const char *)&v, 4); };
+        auto put16 = [](std::ofstream &o, uint16_t v) { o.write((const char *)&v, 2); };
+
+        std::ofstream o(fn, std::ios::binary);
+        o.write("RIFF", 4);
+        put32(o, 36 + irLen * 4);
+        o.write("WAVEfmt ", 8);
+        put32(o, 16);
+        put16(o, 3);
+        put16(o, 1);
+        put32(o, 48000);
+        put32(o, 48000 * 4);
+        put16(o, 4);
+        put16(o, 32);
+        o.write("data", 4);
+        put32(o, irLen * 4);
+        o.write((const char *)ir.data(), irLen * 4);
+    }
+
+    Surge::Test::setFX(surge, fxslot_ains1, fxt_convolution);
+
+    auto &fxs = surge->storage.getPatch().fx[fxslot_ains1];
+    fxs.p[ConvolutionEffect::conv_mix].val.f = 1.f;
+    fxs.impulseResponsePath = fn;
+
+    for (int i = 0; i < 4; ++i)
+        surge->process();
+
+    auto *conv = dynamic_cast<ConvolutionEffect *>(surge->fx[fxslot_ains1].get());
+    REQUIRE(conv);
+
+    float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+
+    auto start = std::chrono::steady_clock::now();
+    while (conv->getImpulseLength() == 0 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        std::fill(L, L + BLOCK_SIZE, 0.f);
+        std::fill(R, R + BLOCK_SIZE, 0.f);
+        conv->process(L, R);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // trailing silence is trimmed, so the response ends at the tap
+    REQUIRE(conv->getImpulseLength() == tap + 1);
+
+    // let everything settle, then ping it
+    for (int i = 0; i < 100; ++i)
+    {
+        std::fill(L, L + BLOCK_SIZE, 0.f);
+        std::fill(R, R + BLOCK_SIZE, 0.f);
+        conv->process(L, R);
+    }
+
+    std::vector<float> res;
+    for (int i = 0; i < 8; ++i)
+    {
+        std::fill(L, L + BLOCK_SIZE, 0.f);
+        std::fill(R, R + BLOCK_SIZE, 0.f);
+        if (i == 0)
+        {
+            L[0] = 1.f;
+            R[0] = 1.f;
+        }
+        conv->process(L, R);
+        res.insert(res.end(), L, L + BLOCK_SIZE);
+    }
+
+    // normalized to unit energy, so the tap comes back at full level
+    for (int i = 0; i < (int)res.size(); ++i)
+    {
+        REQUIRE(res[i] == Approx(i == tap ? 1.f : 0.f).margin(1e-4));
+    }
+
+    std::remove(fn.c_str());
+}
+
+TEST_CASE("Delay Stops Once Its Tail Is Silent", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    Surge::Test::setFX(surge, fxslot_send1, fxt_delay);
+    for (int i = 0; i < 4; ++i)
+        surge->process();
+
+    auto *fx = surge->fx[fxslot_send1].get();
+    REQUIRE(fx);
+    REQUIRE(fx->get_ringout_decay() < 0);
+    REQUIRE(fx->get_silent_tail_window() > 0);
+
+    float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+    auto ping = [&]() {
+        std::fill(L, L + BLOCK_SIZE, 0.f);
+        std::fill(R, R + BLOCK_SIZE, 0.f);
+        L[0] = R[0] = 1.f;
+        REQUIRE(fx->process_ringout(L, R, true));
+    };
+
+    auto ringBlocks = [&]() {
+        int blocks = 0;
+        bool heard = false;
+        while (blocks < 200000)
+        {
+            std::fill(L, L + BLOCK_SIZE, 0.f);
+            std::fill(R, R + BLOCK_SIZE, 0.f);
+            if (!fx->process_ringout(L, R, false))
+                break;
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+                heard = heard || L[k] != 0.f || R[k] != 0.f;
+            blocks++;
+        }
+        REQUIRE(heard);
+        return blocks;
+    };
+
+    // an unbounded ringout now stops some while after the echoes die away
+    ping();
+    auto first = ringBlocks();
+    REQUIRE(first >= fx->get_silent_tail_window());
+    REQUIRE(first < 200000);
+
+    // and stays stopped until there is input again
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(!fx->process_ringout(L, R, false));
+
+    // and picks up again when it returns
+    ping();
+    auto second = ringBlocks();
+    REQUIRE(second >= fx->get_silent_tail_window());
+    REQUIRE(second < 200000);
+}
+
+TEST_CASE("Delay Effects Recycle Arena Memory", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto &arena = surge->storage.memoryPools->effectDelayLines;
+    auto base = arena.floatsInUse();
+
+    auto swapTo = [&](fx_type t) {
+        Surge::Test::setFX(surge, fxslot_send1, t);
+        surge->freeRetiredEffects();
+        return arena.floatsInUse() - base;
+    };
+
+    // the chorus sizes its line for the sample rate rather than the worst case
+    auto chorus = swapTo(fxt_chorus4);
+    REQUIRE(chorus >= 48000);
+    REQUIRE(chorus < max_delay_length);
+
+    // and the combulator sizes its combs for the notes they are tuned to
+    auto combulator = swapTo(fxt_combulator);
+    REQUIRE(combulator >= 6 * 1024);
+    REQUIRE(combulator < 6 * MAX_FB_COMB_EXTENDED / 8);
+
+    // swapping back and forth reuses what the last effect handed back
+    auto reserved = arena.floatsReserved();
+    for (int i = 0; i < 8; ++i)
+    {
+        REQUIRE(swapTo(fxt_chorus4) == chorus);
+        REQUIRE(swapTo(fxt_combulator) == combulator);
+    }
+    REQUIRE(arena.floatsReserved() == reserved);
+
+    REQUIRE(swapTo(fxt_off) == 0);
+}
+
+TEST_CASE("Combulator Grows Its Combs When Tuned Down", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto &arena = surge->storage.memoryPools->effectDelayLines;
+    auto base = arena.floatsInUse();
+
+    Surge::Test::setFX(surge, fxslot_send1, fxt_combulator);
+    auto tuned = arena.floatsInUse() - base;
+    REQUIRE(tuned < 6 * MAX_FB_COMB_EXTENDED / 8);
+
+    // down at the bottom of the range a period is longer than the longest comb
+    auto &freq = surge->storage.getPatch().fx[fxslot_send1].p[CombulatorEffect::combulator_freq1];
+    surge->setParameter01(surge->idForParameter(&freq), 0.f, false);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        surge->process();
+    }
+
+    REQUIRE(arena.floatsInUse() - base >= 6 * MAX_FB_COMB_EXTENDED);
+
+    for (int i = 0; i < BLOCK_SIZE; ++i)
+    {
+        REQUIRE(std::isfinite(surge->output[0][i]));
+        REQUIRE(std::isfinite(surge->output[1][i]));
+    }
+}
+
+TEST_CASE("Smoothed Parameter Bank", "[fx]")
+{
+    // an odd count so the last register is partly unused
+    constexpr int n = 7;
+    surge::sstfx::SmoothedParamBank<n> bank;
+    sst::basic_blocks::dsp::SurgeLag<float, true> ref[n];
+
+    for (int i = 0; i < n; ++i)
+    {
+        bank.setTarget(i, 0.1f * i);
+        ref[i].newValue(0.1f * i);
+        ref[i].instantize();
+    }
+    bank.instantize();
+    REQUIRE(bank.isSettled());
+
+    for (int i = 0; i < n; ++i)
+    {
+        bank.setTarget(i, 1.f - 0.3f * i);
+        ref[i].newValue(1.f - 0.3f * i);
+    }
+    REQUIRE(!bank.isSettled());
+
+    int steps = 0;
+    while (!bank.isSettled() && steps < 100000)
+    {
+        bank.process();
+        for (int i = 0; i < n; ++i)
+        {
+            ref[i].process();
+            if (!bank.isSettled())
+                REQUIRE(bank.value(i) == Approx(ref[i].v).margin(1e-6));
+        }
+        steps++;
+    }
+    REQUIRE(steps < 100000);
+
+    // once there it sits exactly on the targets and stays put
+    for (int i = 0; i < n; ++i)
+    {
+        REQUIRE(bank.value(i) == 1.f - 0.3f * i);
+        REQUIRE(ref[i].v == Approx(bank.value(i)).margin(bank.settleDistance));
+    }
+    bank.process();
+    REQUIRE(bank.isSettled());
+
+    // setting a target to what it already is doesn't wake it
+    bank.setTarget(3, bank.value(3));
+    REQUIRE(bank.isSettled());
+}
+
+TEST_CASE("Nimbus Thins Grains Under Load", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    Surge::Test::setFX(surge, fxslot_send1, fxt_nimbus);
+    auto *nb = dynamic_cast<NimbusEffect *>(surge->fx[fxslot_send1].get());
+    REQUIRE(nb);
+
+    auto &fxs = surge->storage.getPatch().fx[fxslot_send1];
+    auto &density = surge->storage.getPatch().globaldata[fxs.p[NimbusEffect::nmb_density].id].f;
+    density = 0.9f;
+
+    float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+    auto runUnderLoad = [&](float load) {
+        for (int i = 0; i < 500; ++i)
+        {
+            std::fill(L, L + BLOCK_SIZE, 0.f);
+            std::fill(R, R + BLOCK_SIZE, 0.f);
+            surge->storage.audioThreadLoad = load;
+            nb->process(L, R);
+
+            // the cap only ever applies inside the block
+            REQUIRE(density == 0.9f);
+        }
+    };
+
+    SECTION("Off by default")
+    {
+        REQUIRE(!surge->storage.adaptEffectsToLoad);
+        runUnderLoad(1.f);
+        REQUIRE(nb->densityCap == 1.f);
+    }
+
+    SECTION("Backs off and recovers when asked to adapt")
+    {
+        surge->storage.adaptEffectsToLoad = true;
+        runUnderLoad(1.f);
+        REQUIRE(nb->densityCap == Approx(NimbusEffect::minDensityCap));
+
+        runUnderLoad(NimbusEffect::loadThreshold * 0.5f);
+        REQUIRE(nb->densityCap == 1.f);
+    }
+}
@@ -21,15 +21,34 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "HeadlessUtils.h"
 #include "BiquadFilter.h"
 #include "MemoryPool.h"
+#include "LargePageAllocator.h"
+#include "ThreadPolicy.h"
+#include "ActiveVoiceList.h"
+#include "ProcessProfiler.h"
+#include "CPUGovernor.h"
+#include "ParameterChangeLog.h"
+#include "DiagnosticLog.h"
+#include "ClassicOscillator.h"
+#include "FPUState.h"
+#include "RealtimeSafety.h"
+#include "WorkerPool.h"
+#include "Player.h"
+#include "ChorusEffect.h"
+#include "Reverb1Effect.h"
 
 #include "sst/plugininfra/strnatcmp.h"
 
 #include "catch2/catch_amalgamated.hpp"
 
+#include "UnitTestUtilities.h"
+
 inline size_t align_diff(const void *ptr, std::uintptr_t alignment) noexcept
 {
     auto iptr = reinterpret_cast<std::uintptr_t>(ptr);
@@ -77,6 +96,21 @@ TEST_CASE("Biquad Is SIMD Aligned", "[infra]")
     }
 }
 
+TEST_CASE("Voices Start On Their Own Cache Lines", "[infra]")
+{
+    auto surge = Surge::Headless::createSurge(48000, false);
+    REQUIRE(surge);
+
+    for (auto &scene : surge->voices_array)
+    {
+        for (auto &v : scene)
+        {
+            REQUIRE(align_diff(&v, 64) == 0);
+            REQUIRE(align_diff(v.output, 16) == 0);
+        }
+    }
+}
+
 TEST_CASE("QuadFilterUnit Is SIMD Aligned", "[infra]")
 {
     SECTION("Single QuadFilterUnit")
@@ -130,10 +164,11 @@ template <int A> struct CountAlloc
         ct++;
     }
     ~CountAlloc() { ct--; }
-    static int ct, alloc;
+    // the pool's refill thread allocates too
+    static std::atomic<int> ct, alloc;
 };
-template <int A> int CountAlloc<A>::ct{0};
-template <int A> int CountAlloc<A>::alloc{0};
+template <int A> std::atomic<int> CountAlloc<A>::ct{0};
+template <int A> std::atomic<int> CountAlloc<A>::alloc{0};
 
 TEST_CASE("Memory Pool Works", "[infra]")
 {
@@ -154,7 +189,8 @@ TEST_CASE("Memory Pool Works", "[infra]")
                 pool->returnItem(q);
             }
         }
-        REQUIRE(CountAlloc<1>::alloc == 100);
+        // the refill thread may have topped the pool up in the meantime
+        REQUIRE(CountAlloc<1>::alloc >= 100);
         REQUIRE(CountAlloc<1>::ct == 0);
     }
 
@@ -174,12 +210,231 @@ TEST_CASE("Memory Pool Works", "[infra]")
             auto pool = std::make_unique<Surge::Memory::MemoryPool<CountAlloc<3>, 32, 4, 500>>();
             pool->setupPoolToSize(160);
             REQUIRE(CountAlloc<3>::ct == 160);
+            REQUIRE(pool->itemsAlive() == 160);
             pool->returnToPreAllocSize();
             REQUIRE(CountAlloc<3>::ct == 32);
+            REQUIRE(pool->itemsAlive() == 32);
         }
         REQUIRE(CountAlloc<3>::alloc == 160);
         REQUIRE(CountAlloc<3>::ct == 0);
     }
+
+    SECTION("Refills Off Thread")
+    {
+        auto waitFor = [](auto pred) {
+            for (int i = 0; i < 500 && !pred(); ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return pred();
+        };
+
+        {
+            auto pool = std::make_unique<Surge::Memory::MemoryPool<CountAlloc<4>, 8, 4, 500>>();
+            REQUIRE(CountAlloc<4>::alloc == 8);
+
+            // take some and the refill thread tops the spares back up to the pre-allocation
+            std::vector<CountAlloc<4> *> held;
+            for (int i = 0; i < 5; ++i)
+                held.push_back(pool->getItem());
+            REQUIRE(waitFor([]() { return CountAlloc<4>::ct == 13; }));
+
+            // ask for more and they arrive without the pool's user allocating anything
+            pool->requestPoolSize(100);
+            REQUIRE(waitFor([]() { return CountAlloc<4>::ct == 105; }));
+
+            for (int i = 0; i < 90; ++i)
+                held.push_back(pool->getItem());
+            REQUIRE(waitFor([]() { return CountAlloc<4>::ct == 95 + 100; }));
+
+            for (auto h : held)
+                pool->returnItem(h);
+            held.clear();
+
+            // and the ones it no longer needs get freed on the refill thread
+            pool->requestPoolSize(0);
+            REQUIRE(pool->position == 8);
+            REQUIRE(waitFor([]() { return CountAlloc<4>::ct == 8; }));
+        }
+        REQUIRE(CountAlloc<4>::ct == 0);
+    }
+}
+
+TEST_CASE("Large Blocks Are Zeroed And Aligned In Every Mode", "[infra]")
+{
+    using namespace Surge::Memory;
+
+    auto priorMode = getLargePageMode();
+
+    for (auto mode : {LargePageMode::Off, LargePageMode::Transparent, LargePageMode::Explicit})
+    {
+        setLargePageMode(mode);
+        INFO("mode " << (int)mode);
+
+        auto before = bytesInLargePages();
+
+        for (size_t bytes : {(size_t)100, largePageThreshold - 1, largePageThreshold,
+                             3 * largePageSize + 17})
+        {
+            LargeBlock b(bytes);
+            REQUIRE(b.size() == bytes);
+            REQUIRE(align_diff(b.data(), 64) == 0);
+            if (mode == LargePageMode::Off || bytes < largePageThreshold)
+                REQUIRE(!b.inLargePages());
+
+            auto c = static_cast<unsigned char *>(b.data());
+            REQUIRE(std::all_of(c, c + bytes, [](auto q) { return q == 0; }));
+            memset(c, 0x5A, bytes);
+
+            auto moved = std::move(b);
+            REQUIRE(!b.data());
+            REQUIRE(moved.data() == c);
+            REQUIRE(c[bytes - 1] == 0x5A);
+        }
+
+        {
+            LargeArray<CountAlloc<5>> arr(largePageSize / sizeof(CountAlloc<5>) + 1);
+            REQUIRE(CountAlloc<5>::ct == (int)arr.size());
+        }
+        REQUIRE(CountAlloc<5>::ct == 0);
+        REQUIRE(bytesInLargePages() == before);
+    }
+
+    setLargePageMode(priorMode);
+}
+
+TEST_CASE("Thread Policy Core Lists", "[infra]")
+{
+    using namespace Surge::Threading;
+
+    REQUIRE(parseCoreList("").empty());
+    REQUIRE(parseCoreList("3") == std::vector<int>{3});
+    REQUIRE(parseCoreList("2, 3,6-7") == std::vector<int>{2, 3, 6, 7});
+    REQUIRE(parseCoreList("7,1-2,2") == std::vector<int>{1, 2, 7});
+    REQUIRE(parseCoreList("x,4,-,5-,a-b,9") == std::vector<int>{4, 9});
+    REQUIRE(coreListToString({1, 2, 7}) == "1,2,7");
+    REQUIRE(parseCoreList(coreListToString({0, 5, 11})) == std::vector<int>{0, 5, 11});
+
+    // a default policy leaves threads as they were
+    auto priorPolicy = getThreadPolicy();
+    setThreadPolicy(ThreadPolicy{});
+    REQUIRE(getThreadPolicy().isDefault());
+    auto t = makeThread(ThreadRole::Loader, []() {});
+    t.join();
+    setThreadPolicy(priorPolicy);
+
+    auto cores = physicalCoreCount();
+    REQUIRE(cores >= 1);
+    REQUIRE(cores <= (int)std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST_CASE("Shared Scheduler Serves Every Submitter", "[infra]")
+{
+    using namespace Surge::Threading;
+
+    auto a = SharedScheduler::acquire();
+    auto b = SharedScheduler::acquire();
+    REQUIRE(a == b);
+    REQUIRE(a->numWorkers() >= 1);
+
+    SECTION("Instances Share The One Pool")
+    {
+        auto s1 = Surge::Headless::createSurge(44100, true);
+        auto s2 = Surge::Headless::createSurge(44100, true);
+        s1->setMultithreadedVoiceRendering(true);
+        s2->setMultithreadedEffectRendering(true);
+
+        // two more holders, and no more threads
+        REQUIRE(a.use_count() == 4);
+    }
+
+    SECTION("Concurrent Batches All Complete")
+    {
+        static constexpr int nSubmitters = 6, nTasks = 40, nRounds = 50;
+        std::atomic<int> ran[nSubmitters]{};
+        std::atomic<int> missedOrRepeated{0};
+
+        std::vector<std::thread> submitters;
+        for (int s = 0; s < nSubmitters; ++s)
+        {
+            submitters.emplace_back([&, s]() {
+                for (int r = 0; r < nRounds; ++r)
+                {
+                    int seen[nTasks]{};
+                    auto task = [&](int i) {
+                        seen[i]++;
+                        ran[s]++;
+                    };
+                    // alternate the deadlines so some batches keep being put ahead of others
+                    auto due = SharedScheduler::clock_t::now() +
+                               std::chrono::microseconds(s % 2 ? 100 : 10000);
+                    a->parallelFor(nTasks, task, due);
+
+                    // Catch can't take assertions from these threads, so count and check after
+                    for (auto v : seen)
+                        if (v != 1)
+                            missedOrRepeated++;
+                }
+            });
+        }
+        for (auto &t : submitters)
+            t.join();
+
+        REQUIRE(missedOrRepeated == 0);
+        for (auto &r : ran)
+            REQUIRE(r == nTasks * nRounds);
+    }
+}
+
+TEST_CASE("Active Voice List Works", "[infra]")
+{
+    struct V
+    {
+        int id{0};
+    };
+    std::array<V, 16> arr;
+    for (int i = 0; i < 16; ++i)
+        arr[i].id = i;
+
+    Surge::Voice::ActiveVoiceList<V, 16> voices;
+    voices.setVoiceArray(arr.data());
+
+    SECTION("Push Keeps Note Order")
+    {
+        for (auto i : {7, 2, 11, 0})
+            voices.push_back(&arr[i]);
+        REQUIRE(voices.size() == 4);
+        REQUIRE(voices.front()->id == 7);
+        REQUIRE(voices.back()->id == 0);
+
+        std::vector<int> order;
+        for (auto v : voices)
+            order.push_back(v->id);
+        REQUIRE(order == std::vector<int>{7, 2, 11, 0});
+    }
+
+    SECTION("Erase While Iterating")
+    {
+        for (int i = 0; i < 10; ++i)
+            voices.push_back(&arr[i]);
+
+        auto iter = voices.begin();
+        while (iter != voices.end())
+        {
+            if ((*iter)->id % 3 == 0)
+                iter = voices.erase(iter);
+            else
+                iter++;
+        }
+
+        std::vector<int> order;
+        for (auto v : voices)
+            order.push_back(v->id);
+        REQUIRE(order == std::vector<int>{1, 2, 4, 5, 7, 8});
+        REQUIRE(voices.indexOf(&arr[5]) == 5);
+
+        voices.clear();
+        REQUIRE(voices.empty());
+        REQUIRE(voices.begin() == voices.end());
+    }
 }
 
 TEST_CASE("strnatcmp With Spaces", "[infra]")
@@ -284,4 +539,721 @@ TEST_CASE("Template Patches are Rational", "[infra]")
         ++idx;
     }
     REQUIRE(tested);
-}
\ No newline at end of file
+}
+TEST_CASE("Process Profiler", "[infra]")
+{
+    using namespace Surge::Profiling;
+
+    SECTION("Ring Buffer Keeps The Most Recent Blocks")
+    {
+        auto prof = std::make_unique<ProcessProfiler>();
+
+        BlockProfile recent[ProcessProfiler::historySize];
+        REQUIRE(prof->getRecentBlocks(recent, 10) == 0);
+
+        for (int b = 0; b < ProcessProfiler::historySize + 20; ++b)
+        {
+            prof->beginBlock();
+            prof->add(ps_control, prof->mark());
+            prof->endBlock();
+        }
+
+        auto n = prof->getRecentBlocks(recent, ProcessProfiler::historySize);
+        REQUIRE(n > 0);
+        REQUIRE(n < ProcessProfiler::historySize);
+        REQUIRE(prof->getRecentBlocks(recent, 10) == 10);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            REQUIRE(recent[i].usec[ps_total] >= recent[i].usec[ps_control]);
+        }
+    }
+
+    SECTION("Engine Reports Its Stages")
+    {
+        auto surge = Surge::Headless::createSurge(48000);
+        REQUIRE(surge);
+
+        surge->playNote(0, 60, 127, 0);
+        for (int i = 0; i < 100; ++i)
+            surge->process();
+
+        auto avg = surge->processProfiler.getAverage(50);
+        REQUIRE(avg.usec[ps_total] > 0.f);
+        REQUIRE(avg.usec[ps_voices] > 0.f);
+        REQUIRE(avg.usec[ps_filters] >= 0.f);
+
+        float parts = 0.f;
+        for (int s = 0; s < ps_total; ++s)
+            parts += avg.usec[s];
+        REQUIRE(parts <= avg.usec[ps_total] * 1.01f);
+
+        REQUIRE(ProcessProfiler::stageName(ps_voices) == "Voices");
+        REQUIRE(ProcessProfiler::stageName(ps_fx_first) == "FX A1");
+    }
+
+    SECTION("Histogram Buckets And Percentiles")
+    {
+        for (float u : {0.5f, 1.f, 1.3f, 7.f, 100.f, 1234.f, 70000.f})
+        {
+            INFO("usec " << u);
+            auto b = LatencyHistogram::bucketFor(u);
+            REQUIRE(LatencyHistogram::bucketUpperBound(b) >= u);
+            if (b > 0)
+                REQUIRE(LatencyHistogram::bucketUpperBound(b - 1) <= u);
+            REQUIRE(LatencyHistogram::bucketUpperBound(b) <= std::max(u, 1.f) * 1.13f);
+        }
+
+        auto h = std::make_unique<LatencyHistogram>();
+        REQUIRE(h->percentile(99) == 0.f);
+        for (int i = 0; i < 990; ++i)
+            h->record(100.f);
+        for (int i = 0; i < 10; ++i)
+            h->record(5000.f);
+
+        REQUIRE(h->count() == 1000);
+        REQUIRE(h->max() == 5000.f);
+        REQUIRE(h->percentile(50) == Catch::Approx(100.f).epsilon(0.13));
+        REQUIRE(h->percentile(99) == Catch::Approx(100.f).epsilon(0.13));
+        REQUIRE(h->percentile(99.9) == 5000.f);
+    }
+
+    SECTION("Worst Blocks Carry Their Events")
+    {
+        auto prof = std::make_unique<ProcessProfiler>();
+
+        for (int b = 0; b < 100; ++b)
+        {
+            if (b == 40)
+            {
+                prof->noteEvent(be_fx_spawn);
+                for (int n = 0; n < noteOnBurstSize; ++n)
+                    prof->noteOn();
+            }
+
+            prof->beginBlock();
+            // give block 40 something to stand out with
+            if (b == 40)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            prof->endBlock(b == 40 ? 12 : 1);
+        }
+
+        auto worst = prof->getWorstBlocks();
+        REQUIRE(!worst.empty());
+        REQUIRE(worst.size() <= ProcessProfiler::nWorstBlocks);
+        REQUIRE(worst[0].blockIndex == 40);
+        REQUIRE(worst[0].profile.voices == 12);
+        REQUIRE(worst[0].profile.noteOns == noteOnBurstSize);
+        REQUIRE(worst[0].profile.events == (be_fx_spawn | be_note_on_burst));
+        REQUIRE(ProcessProfiler::blockEventNames(worst[0].profile.events) ==
+                "FX spawn, note on burst");
+        for (size_t i = 1; i < worst.size(); ++i)
+            REQUIRE(worst[i].profile.events == 0);
+        REQUIRE(prof->getHistogram().count() == 100);
+
+        prof->resetLatencyStats();
+        prof->beginBlock();
+        prof->endBlock();
+        REQUIRE(prof->getHistogram().count() == 1);
+        REQUIRE(prof->getWorstBlocks().size() <= 1);
+    }
+}
+
+TEST_CASE("CPU Governor Steps Down And Recovers With Hysteresis", "[infra]")
+{
+    namespace prof = Surge::Profiling;
+    prof::CPUGovernor gov;
+    prof::BlockProfile block;
+    block.usec[prof::ps_voices] = 500.f;
+
+    float blockSeconds = BLOCK_SIZE / 48000.f;
+    auto run = [&](float load, float seconds) {
+        for (int i = 0; i < (int)(seconds / blockSeconds); ++i)
+            gov.update(load, blockSeconds, block);
+    };
+
+    REQUIRE(gov.getLevel() == prof::gov_full_quality);
+
+    // a short spike isn't enough
+    run(1.2f, prof::CPUGovernor::stepDownSeconds * 0.5f);
+    run(0.7f, 0.01f);
+    run(1.2f, prof::CPUGovernor::stepDownSeconds * 0.5f);
+    REQUIRE(gov.getLevel() == prof::gov_full_quality);
+
+    // sustained overload takes one step at a time, in order
+    run(1.2f, prof::CPUGovernor::stepDownSeconds * 1.1f);
+    REQUIRE(gov.getLevel() == prof::gov_reduced_antialiasing);
+    run(1.2f, prof::CPUGovernor::stepDownSeconds * 1.1f);
+    REQUIRE(gov.getLevel() == prof::gov_polyphony_cap);
+    run(1.2f, 1.f);
+    REQUIRE(gov.getLevel() == prof::gov_eco_effect_oversampling);
+
+    // between the thresholds it holds where it is
+    run(0.75f, prof::CPUGovernor::stepUpSeconds * 2);
+    REQUIRE(gov.getLevel() == prof::gov_eco_effect_oversampling);
+
+    // and it only comes back up after a long comfortable stretch
+    run(0.3f, prof::CPUGovernor::stepUpSeconds * 0.5f);
+    REQUIRE(gov.getLevel() == prof::gov_eco_effect_oversampling);
+    run(0.3f, prof::CPUGovernor::stepUpSeconds * 0.6f);
+    REQUIRE(gov.getLevel() == prof::gov_polyphony_cap);
+
+    auto changes = gov.getRecentTransitions();
+    REQUIRE(changes.size() == 4);
+    REQUIRE(changes[0].from == prof::gov_eco_effect_oversampling);
+    REQUIRE(changes[0].to == prof::gov_polyphony_cap);
+    REQUIRE(changes[3].from == prof::gov_full_quality);
+    REQUIRE(changes[3].to == prof::gov_reduced_antialiasing);
+    REQUIRE(changes[3].load > prof::CPUGovernor::overloadedLoad);
+    REQUIRE(changes[3].voicesUsec == 500.f);
+
+    gov.reset();
+    REQUIRE(gov.getLevel() == prof::gov_full_quality);
+    REQUIRE(gov.getTransitionCount() == 5);
+
+    SECTION("The Synth Follows The Governor")
+    {
+        auto surge = Surge::Headless::createSurge(44100, true);
+        REQUIRE(surge);
+
+        // off, it stays at full quality whatever the load does
+        surge->degradeQualityUnderLoad = false;
+        for (int i = 0; i < 50; ++i)
+            surge->process();
+        REQUIRE(surge->cpuGovernor.getLevel() == prof::gov_full_quality);
+        REQUIRE(!surge->storage.reducedAntiAliasing);
+    }
+}
+
+TEST_CASE("Parameter Change Log Coalesces", "[infra]")
+{
+    using log_t = Surge::Threading::ParameterChangeLog<64>;
+
+    SECTION("Latest Value Once Per Drain")
+    {
+        auto log = std::make_unique<log_t>();
+        REQUIRE(log->empty());
+
+        REQUIRE(log->push(3, 0.1f));
+        REQUIRE(!log->push(3, 0.2f)); // already awake
+        REQUIRE(!log->push(7, 0.5f));
+        REQUIRE(!log->push(3, 0.3f));
+        REQUIRE(!log->push(64, 1.f)); // out of range is ignored
+        REQUIRE(!log->empty());
+
+        std::vector<std::pair<int, float>> seen;
+        REQUIRE(log->drain([&](int i, float v) { seen.emplace_back(i, v); }) == 2);
+        REQUIRE(seen.size() == 2);
+        REQUIRE(seen[0] == std::make_pair(3, 0.3f));
+        REQUIRE(seen[1] == std::make_pair(7, 0.5f));
+        REQUIRE(log->empty());
+
+        // and a drain re-arms the wake
+        REQUIRE(log->push(7, 0.6f));
+    }
+
+    SECTION("Every Last Value Arrives Across Threads")
+    {
+        auto log = std::make_unique<log_t>();
+        std::atomic<bool> done{false};
+        std::vector<float> latest(64, -1.f);
+
+        std::thread consumer([&]() {
+            while (!done)
+            {
+                log->drain([&](int i, float v) { latest[i] = v; });
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<float> pushed(64, -1.f);
+        for (int n = 0; n < 200000; ++n)
+        {
+            auto i = (n * 37) % 64;
+            pushed[i] = (float)n;
+            log->push(i, (float)n);
+        }
+
+        done = true;
+        consumer.join();
+        log->drain([&](int i, float v) { latest[i] = v; });
+
+        for (int i = 0; i < 64; ++i)
+        {
+            INFO("Index " << i);
+            REQUIRE(latest[i] == pushed[i]);
+        }
+    }
+}
+
+TEST_CASE("Diagnostic Log Takes Events From Any Thread", "[infra]")
+{
+    using namespace Surge::Debug;
+
+    SECTION("Records Format And Overflow Is Counted")
+    {
+        auto log = std::make_unique<DiagnosticLog>();
+        REQUIRE(log->push(diag_voice_gated_after_all_notes_off, 2, 60));
+        REQUIRE(log->pushText(diag_formula_error, std::string(1000, 'x')));
+
+        std::vector<std::string> seen;
+        std::vector<DiagnosticEvent> events;
+        REQUIRE(log->drain([&](const DiagnosticRecord &r) {
+            events.push_back(r.event);
+            seen.push_back(formatDiagnostic(r));
+        }) == 2);
+        REQUIRE(events[0] == diag_voice_gated_after_all_notes_off);
+        REQUIRE(seen[0].find("channel 2, key 60") != std::string::npos);
+        REQUIRE(seen[1] == std::string(DiagnosticRecord::maxText - 1, 'x'));
+        REQUIRE(diagnosticSeverity(diag_formula_error) == diag_error);
+
+        for (uint32_t i = 0; i < DiagnosticLog::capacity; ++i)
+            REQUIRE(log->push(diag_formula_missing_math));
+        REQUIRE(!log->push(diag_formula_missing_math));
+        REQUIRE(!log->push(diag_formula_missing_math));
+        REQUIRE(log->droppedCount() == 2);
+
+        // the drainer owns up to what it lost after what it kept
+        events.clear();
+        double reported = 0;
+        log->drain([&](const DiagnosticRecord &r) {
+            events.push_back(r.event);
+            reported = r.args[0];
+        });
+        REQUIRE(events.size() == DiagnosticLog::capacity + 1);
+        REQUIRE(events.back() == diag_events_dropped);
+        REQUIRE(reported == 2);
+        REQUIRE(log->drain([](const DiagnosticRecord &) {}) == 0);
+    }
+
+    SECTION("Every Producer's Events Arrive In Its Order")
+    {
+        static constexpr int producers = 4, perProducer = 20000;
+
+        auto log = std::make_unique<DiagnosticLog>();
+        std::atomic<bool> done{false};
+        std::vector<int> next(producers, 0);
+        int outOfOrder = 0, received = 0;
+
+        auto take = [&](const DiagnosticRecord &r) {
+            if (r.event == diag_events_dropped)
+                return;
+
+            auto p = (int)r.args[0], n = (int)r.args[1];
+            if (n < next[p])
+                outOfOrder++;
+            next[p] = n + 1;
+            received++;
+        };
+
+        std::thread consumer([&]() {
+            while (!done)
+            {
+                log->drain(take);
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::thread> pool;
+        for (int p = 0; p < producers; ++p)
+        {
+            pool.emplace_back([&log, p]() {
+                for (int n = 0; n < perProducer; ++n)
+                    log->push(diag_voice_gated_after_all_notes_off, p, n);
+            });
+        }
+        for (auto &t : pool)
+            t.join();
+
+        done = true;
+        consumer.join();
+        log->drain(take);
+
+        REQUIRE(outOfOrder == 0);
+        REQUIRE(received + (int)log->droppedCount() == producers * perProducer);
+    }
+
+    SECTION("Delivery Reaches Listeners Off The Pushing Thread")
+    {
+        struct Collect : DiagnosticLog::Listener
+        {
+            std::mutex m;
+            std::vector<std::string> got;
+            std::thread::id on;
+            void onDiagnostic(const DiagnosticRecord &, const std::string &s) override
+            {
+                std::lock_guard<std::mutex> g(m);
+                got.push_back(s);
+                on = std::this_thread::get_id();
+            }
+        } collect;
+
+        auto log = std::make_unique<DiagnosticLog>();
+        log->toStdout = false;
+        log->addListener(&collect);
+        log->startDelivering();
+        log->pushText(diag_formula_error, "bad formula");
+
+        for (int i = 0; i < 200; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> g(collect.m);
+                if (!collect.got.empty())
+                    break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        log->stopDelivering();
+        REQUIRE(collect.got.size() == 1);
+        REQUIRE(collect.got[0] == "bad formula");
+        REQUIRE(collect.on != std::this_thread::get_id());
+    }
+}
+
+TEST_CASE("Instances Share Their Constant Tables", "[infra]")
+{
+    auto a = Surge::Headless::createSurge(44100, false);
+    auto b = Surge::Headless::createSurge(96000, false);
+    REQUIRE(a);
+    REQUIRE(b);
+
+    auto &sa = a->storage, &sb = b->storage;
+    REQUIRE(sa.sinctable == sb.sinctable);
+    REQUIRE(sa.table_dB == sb.table_dB);
+    REQUIRE(sa.table_two_to_the == sb.table_two_to_the);
+    REQUIRE(sa.WindowWT.size > 0);
+    REQUIRE(sa.WindowWT.TableI16WeakPointers[0][0] == sb.WindowWT.TableI16WeakPointers[0][0]);
+
+    // and what depends on the sample rate or the tuning stays with the instance
+    REQUIRE(sa.table_envrate_linear[100] != sb.table_envrate_linear[100]);
+    REQUIRE(sa.table_pitch[300] == sb.table_pitch[300]);
+    sb.table_pitch[300] = 0.f;
+    REQUIRE(sa.table_pitch[300] == sa.table_pitch_ignoring_tuning[300]);
+
+    REQUIRE(sa.table_dB[384] == Catch::Approx(1.f));
+    REQUIRE(sa.note_to_pitch_ignoring_tuning(12) == Catch::Approx(2.f));
+}
+
+TEST_CASE("Preparing Again At The Same Rate Keeps State", "[infra]")
+{
+    SECTION("Rendering Runs On Uninterrupted")
+    {
+        auto make = []() {
+            auto surge = Surge::Headless::createSurge(48000, false);
+            Surge::Test::setFX(surge, 0, fxt_chorus4);
+            surge->setDeterministicRendering(77);
+            surge->playNote(0, 60, 127, 0);
+            return surge;
+        };
+        auto a = make(), b = make();
+
+        for (int i = 0; i < 200; ++i)
+        {
+            if (i == 100)
+            {
+                b->setSamplerate(48000);
+            }
+            a->process();
+            b->process();
+
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+            {
+                INFO("block " << i << " sample " << s);
+                REQUIRE(a->output[0][s] == b->output[0][s]);
+                REQUIRE(a->output[1][s] == b->output[1][s]);
+            }
+        }
+    }
+
+    SECTION("Switching Away And Back Restores The Tables")
+    {
+        auto fresh = Surge::Headless::createSurge(44100, false);
+        auto moved = Surge::Headless::createSurge(44100, false);
+        moved->setSamplerate(61234);
+        REQUIRE(moved->storage.table_envrate_lpf[200] != fresh->storage.table_envrate_lpf[200]);
+        moved->setSamplerate(44100);
+
+        auto &sf = fresh->storage, &sm = moved->storage;
+        for (int i = 0; i < SurgeStorage::tuning_table_size; ++i)
+        {
+            INFO("entry " << i);
+            REQUIRE(sm.table_note_omega[0][i] == sf.table_note_omega[0][i]);
+            REQUIRE(sm.table_note_omega[1][i] == sf.table_note_omega[1][i]);
+            REQUIRE(sm.table_envrate_linear[i] == sf.table_envrate_linear[i]);
+            REQUIRE(sm.table_envrate_lpf[i] == sf.table_envrate_lpf[i]);
+        }
+        REQUIRE(sm.nyquist_pitch == sf.nyquist_pitch);
+    }
+}
+
+TEST_CASE("Memory Report Accounts For Each Subsystem", "[infra]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    auto before = surge->memoryReport();
+    REQUIRE(before.voices > 0);
+    REQUIRE(before.oscillatorBuffers > 0);
+    REQUIRE(before.filterStates > 0);
+    REQUIRE(before.fxSlots[0] == 0);
+
+    Surge::Test::setFX(surge, 0, fxt_chorus4);
+    Surge::Test::setFX(surge, 1, fxt_reverb);
+
+    auto after = surge->memoryReport();
+
+    // the chorus counts its arena delay line as well as itself, the reverb its inline ones
+    REQUIRE(after.fxSlots[0] > sizeof(ChorusEffect<4>));
+    REQUIRE(after.fxSlots[1] == sizeof(Reverb1Effect));
+    REQUIRE(after.fxSlots[2] == 0);
+}
+
+TEST_CASE("UI Change Set Reports What The Engine Changed", "[infra]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    // a new engine has everything to show
+    REQUIRE(surge->takeUIChanges() == SurgeSynthesizer::uic_all);
+
+    auto notLevels = SurgeSynthesizer::uic_params | SurgeSynthesizer::uic_polyphony |
+                     SurgeSynthesizer::uic_midi;
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    surge->takeUIChanges();
+    surge->process();
+    REQUIRE((surge->takeUIChanges() & notLevels) == 0);
+
+    surge->playNote(0, 60, 100, 0);
+    REQUIRE(surge->takeUIChanges() & SurgeSynthesizer::uic_midi);
+
+    surge->process();
+    auto c = surge->takeUIChanges();
+    REQUIRE(c & SurgeSynthesizer::uic_polyphony);
+    REQUIRE(c & SurgeSynthesizer::uic_levels);
+
+    // with the same voice count still sounding, polyphony is not reported again
+    surge->process();
+    c = surge->takeUIChanges();
+    REQUIRE(!(c & SurgeSynthesizer::uic_polyphony));
+    REQUIRE(c & SurgeSynthesizer::uic_levels);
+
+    auto &p = surge->storage.getPatch().scene[0].osc[0].pitch;
+    surge->setParameter01(surge->idForParameter(&p), 0.7, true);
+    REQUIRE(surge->takeUIChanges() & SurgeSynthesizer::uic_params);
+}
+
+TEST_CASE("Deterministic Rendering Is Repeatable", "[infra]")
+{
+    // noise, a random modulator and drift are all in play
+    auto noisy = [](std::shared_ptr<SurgeSynthesizer> surge) {
+        auto &sc = surge->storage.getPatch().scene[0];
+        sc.osc[0].type.val.i = ot_shnoise;
+        surge->storage.getPatch().update_controls(false, &sc.osc[0]);
+        sc.osc[1].type.val.i = ot_classic;
+        surge->storage.getPatch().update_controls(false, &sc.osc[1]);
+        sc.level_o2.val.f = 1.f;
+        sc.mute_o2.val.b = false;
+        sc.osc[1].p[ClassicOscillator::co_unison_voices].val.i = 4;
+        surge->setModDepth01(sc.filterunit[0].cutoff.id, ms_random_bipolar, 0, 0, 0.5f);
+        Surge::Test::setFX(surge, 0, fxt_chorus4);
+    };
+
+    auto events = Surge::Headless::makeChordAndArpeggio(0, 48000);
+
+    SECTION("Same Seed Matches")
+    {
+        auto r = Surge::Test::compareRenders(noisy, noisy, events, 1234);
+        REQUIRE(r.nSamples > 0);
+        INFO("first difference at " << r.firstDifferentSample);
+        REQUIRE(r.maxDifference == 0.f);
+    }
+
+    SECTION("Different Seeds Differ")
+    {
+        auto render = [&](uint32_t seed) {
+            auto surge = Surge::Headless::createSurge(48000, false);
+            noisy(surge);
+            surge->setDeterministicRendering(seed);
+
+            float *data = nullptr;
+            int nS, nC;
+            Surge::Headless::playAsConfigured(surge, events, &data, &nS, &nC);
+            auto res = std::vector<float>(data, data + nS * nC);
+            delete[] data;
+            return res;
+        };
+
+        auto a = render(1), b = render(2);
+        REQUIRE(a.size() == b.size());
+        REQUIRE(a != b);
+    }
+}
+
+TEST_CASE("DSP Threads Flush Denormals", "[infra]")
+{
+    namespace fpu = Surge::FPUState;
+
+    SECTION("The Guard Sets And Restores")
+    {
+        bool before{false}, during{false}, after{true};
+        std::thread([&]() {
+            before = fpu::flushesDenormals();
+            {
+                auto g = fpu::DSPThreadGuard();
+                during = fpu::flushesDenormals();
+            }
+            after = fpu::flushesDenormals();
+        }).join();
+
+        REQUIRE(during);
+        REQUIRE(after == before);
+    }
+
+    SECTION("Worker Pool Tasks Flush")
+    {
+        auto g = fpu::DSPThreadGuard();
+        Surge::Threading::WorkerPool pool(3);
+
+        static constexpr int nTasks = 64;
+        std::atomic<int> flushed{0};
+        auto task = [&flushed](int) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            if (fpu::flushesDenormals())
+                flushed++;
+        };
+        pool.parallelFor(nTasks, task);
+
+        REQUIRE(flushed == nTasks);
+    }
+
+    SECTION("Process Flushes For Its Caller And Puts Things Back")
+    {
+        auto surge = Surge::Headless::createSurge(44100, true);
+        REQUIRE(surge);
+
+        bool before{false}, after{true};
+        std::thread([&]() {
+            before = fpu::flushesDenormals();
+            surge->playNote(0, 60, 127, 0);
+            for (int i = 0; i < 100; ++i)
+                surge->process();
+            surge->releaseNote(0, 60, 0);
+            for (int i = 0; i < 100; ++i)
+                surge->process();
+            after = fpu::flushesDenormals();
+        }).join();
+
+        REQUIRE(after == before);
+    }
+}
+
+#if SURGE_DENORMAL_AUDIT
+TEST_CASE("Denormal Audit Counts Underflowing Stages", "[infra]")
+{
+    namespace fpu = Surge::FPUState;
+
+    fpu::resetAudit();
+    {
+        auto g = fpu::DSPThreadGuard();
+        fpu::StageAudit outer(Surge::Profiling::ps_total);
+        {
+            fpu::StageAudit inner(Surge::Profiling::ps_voices);
+            volatile float tiny = 1e-30f;
+            volatile float res = tiny * tiny;
+            (void)res;
+        }
+        fpu::StageAudit quiet(Surge::Profiling::ps_filters);
+    }
+
+    auto r = fpu::auditReport();
+    INFO(r.toString());
+    REQUIRE(r.stages[Surge::Profiling::ps_voices] == 1);
+    REQUIRE(r.stages[Surge::Profiling::ps_total] == 1);
+    REQUIRE(r.stages[Surge::Profiling::ps_filters] == 0);
+
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge);
+
+    fpu::resetAudit();
+    std::thread([&]() {
+        for (int i = 0; i < 100; ++i)
+            surge->process();
+    }).join();
+
+    r = fpu::auditReport();
+    INFO(r.toString());
+    REQUIRE(r.blocks == 100);
+    REQUIRE(r.blocksWithoutFlushToZero == 0);
+}
+#endif
+
+#if SURGE_RT_SAFETY_CHECKS
+TEST_CASE("Realtime Safety Checks See The Audio Thread", "[infra]")
+{
+    namespace rt = Surge::RealtimeSafety;
+
+    rt::setAudioThread(std::this_thread::get_id());
+    rt::arm();
+    auto *p = new int(3);
+    delete p;
+    rt::noteLock("aLock");
+    std::thread([]() { rt::noteLock("fromAnotherThread"); }).join();
+    rt::disarm();
+
+    auto r = rt::report();
+    INFO(r.toString());
+    REQUIRE(r.counts[rt::rt_allocation] >= 1);
+    REQUIRE(r.counts[rt::rt_deallocation] >= 1);
+    REQUIRE(r.counts[rt::rt_lock] == 1);
+    REQUIRE(r.counts[rt::rt_blocking_call] == 0);
+}
+
+TEST_CASE("Audio Thread Is Realtime Safe", "[infra]")
+{
+    namespace rt = Surge::RealtimeSafety;
+
+    auto surge = Surge::Headless::createSurge(48000, false);
+    REQUIRE(surge);
+
+    Surge::Test::setFX(surge, 0, fxt_delay);
+    Surge::Test::setFX(surge, 1, fxt_reverb2);
+    Surge::Test::setFX(surge, 4, fxt_chorus4);
+
+    auto events = Surge::Headless::makeChordAndArpeggio(0, 48000);
+    auto play = [&]() {
+        size_t currEvt = 0;
+        int blockCount = events.back().atSample / BLOCK_SIZE + 1;
+        for (int b = 0; b < blockCount; ++b)
+        {
+            while (currEvt < events.size() && events[currEvt].atSample < (b + 1) * BLOCK_SIZE)
+            {
+                const auto &e = events[currEvt];
+                if (e.type == Surge::Headless::Event::NOTE_ON)
+                    surge->playNote(e.channel, e.data1, e.data2, 0);
+                else if (e.type == Surge::Headless::Event::NOTE_OFF)
+                    surge->releaseNote(e.channel, e.data1, e.data2);
+                currEvt++;
+            }
+            surge->process();
+        }
+    };
+
+    // the first pass spawns the FX and lets the pools fill; only the second is scripted
+    play();
+
+    rt::arm();
+    play();
+    rt::disarm();
+
+    auto r = rt::report();
+    INFO(r.toString());
+    REQUIRE(r.total() == 0);
+}
+#endif
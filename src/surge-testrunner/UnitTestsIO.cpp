@@ -23,6 +23,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cmath>
+#include <fstream>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -34,6 +36,12 @@
 #include <thread>
 
 #include "UserDefaults.h"
+#include "PatchListSnapshot.h"
+#include "PatchSnapshot.h"
+#include "PatchPreview.h"
+#include "SharedPresetLibrary.h"
+#include "WavetableCacheFile.h"
+#include "WAVFileWriter.h"
 #include <unordered_map>
 
 using namespace Surge::Test;
@@ -79,6 +87,467 @@ TEST_CASE("We Can Read Wavetables", "[io]")
     }
 }
 
+TEST_CASE("Wavetables Load Whatever The Chunk Layout", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+
+    auto dir = fs::temp_directory_path() / "surge-wavetable-layout-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    const int frames = 4, frameSize = 2048;
+
+    // a 'clm ' marked table with a junk chunk of junkBytes before the data
+    auto write = [&](const std::string &name, bool isFloat, int channels, int junkBytes) {
+        auto le = [](std::string &s, uint32_t v, int bytes) {
+            for (int i = 0; i < bytes; ++i)
+                s.push_back((char)((v >> (8 * i)) & 0xFF));
+        };
+        auto chunk = [&](std::string &s, const char *type, const std::string &body) {
+            s.append(type, 4);
+            le(s, body.size(), 4);
+            s += body;
+            if (body.size() % 2)
+                s.push_back(0);
+        };
+
+        int bits = isFloat ? 32 : 16;
+        std::string fmt;
+        le(fmt, isFloat ? 3 : 1, 2);
+        le(fmt, channels, 2);
+        le(fmt, 44100, 4);
+        le(fmt, 44100 * channels * bits / 8, 4);
+        le(fmt, channels * bits / 8, 2);
+        le(fmt, bits, 2);
+
+        std::string data;
+        for (int i = 0; i < frames * frameSize; ++i)
+        {
+            auto v = std::sin(i * 2.0 * M_PI / frameSize) * (1 + i / frameSize) / frames;
+            for (int c = 0; c < channels; ++c)
+            {
+                // the other channels are noise which mustn't show up
+                auto s = c == 0 ? v : ((i * 7919 + c) % 200) / 100.0 - 1;
+                if (isFloat)
+                {
+                    float f = s;
+                    uint32_t u;
+                    memcpy(&u, &f, 4);
+                    le(data, u, 4);
+                }
+                else
+                {
+                    le(data, (uint16_t)(int16_t)(s * 16384), 2);
+                }
+            }
+        }
+
+        std::string body = "WAVE";
+        chunk(body, "fmt ", fmt);
+        chunk(body, "junk", std::string(junkBytes, 'x'));
+        chunk(body, "clm ", "<!>2048 01000000 wavetable (surge)");
+        chunk(body, "data", data);
+
+        std::string file = "RIFF";
+        le(file, body.size(), 4);
+        file += body;
+
+        auto path = dir / name;
+        std::ofstream(path, std::ios::binary).write(file.data(), file.size());
+        return path_to_string(path);
+    };
+
+    for (auto isFloat : {false, true})
+    {
+        INFO("float " << isFloat);
+        auto mono = write("mono.wav", isFloat, 1, 4);
+
+        auto wt = &(surge->storage.getPatch().scene[0].osc[0].wt);
+        REQUIRE(surge->storage.load_wt_wav_portable(mono, wt));
+        REQUIRE(wt->size == frameSize);
+        REQUIRE(wt->n_tables == frames);
+
+        std::vector<float> expected;
+        for (int t = 0; t < frames; ++t)
+            expected.insert(expected.end(), wt->TableF32WeakPointers[0][t],
+                            wt->TableF32WeakPointers[0][t] + frameSize);
+
+        // interleaved, or with the data at another alignment, it is the same table
+        for (auto [channels, junk] : {std::pair{2, 4}, std::pair{3, 2}, std::pair{1, 2}})
+        {
+            INFO("channels " << channels << " junk " << junk);
+            auto other = write("other.wav", isFloat, channels, junk);
+            auto wtO = &(surge->storage.getPatch().scene[1].osc[0].wt);
+            REQUIRE(surge->storage.load_wt_wav_portable(other, wtO));
+            REQUIRE(wtO->size == frameSize);
+            REQUIRE(wtO->n_tables == frames);
+
+            for (int t = 0; t < frames; ++t)
+                for (int i = 0; i < frameSize; ++i)
+                    REQUIRE(wtO->TableF32WeakPointers[0][t][i] == expected[t * frameSize + i]);
+        }
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Identical Wavetables Share Their Data", "[io]")
+{
+    auto surgeA = Surge::Headless::createSurge(44100);
+    auto surgeB = Surge::Headless::createSurge(44100);
+    REQUIRE(surgeA.get());
+    REQUIRE(surgeB.get());
+
+    auto wtA = &(surgeA->storage.getPatch().scene[0].osc[0].wt);
+    auto wtB = &(surgeB->storage.getPatch().scene[1].osc[2].wt);
+
+    surgeA->storage.load_wt_wav_portable("resources/test-data/wav/05_BELL.WAV", wtA);
+    surgeB->storage.load_wt_wav_portable("resources/test-data/wav/05_BELL.WAV", wtB);
+    REQUIRE(wtA->n_tables == wtB->n_tables);
+    REQUIRE(wtA->TableF32Data == wtB->TableF32Data);
+    REQUIRE(wtA->TableI16Data == wtB->TableI16Data);
+
+    for (int l = 0; l < max_mipmap_levels; ++l)
+        for (int t = 0; t < wtA->n_tables; ++t)
+            REQUIRE(wtA->TableF32WeakPointers[l][t] == wtB->TableF32WeakPointers[l][t]);
+
+    auto copy = std::make_unique<Wavetable>();
+    copy->Copy(wtA);
+    REQUIRE(copy->TableF32Data == wtA->TableF32Data);
+
+    // rebuilding one of them leaves the others reading the original table
+    auto bell = std::vector<float>(wtA->TableF32WeakPointers[0][3],
+                                   wtA->TableF32WeakPointers[0][3] + wtA->size);
+    surgeA->storage.load_wt_wav_portable("resources/test-data/wav/pluckalgo.wav", wtA);
+    REQUIRE(wtA->n_tables == 9);
+    REQUIRE(wtA->TableF32Data != wtB->TableF32Data);
+    REQUIRE(wtB->n_tables == 33);
+    for (int i = 0; i < wtB->size; ++i)
+    {
+        REQUIRE(wtB->TableF32WeakPointers[0][3][i] == bell[i]);
+        REQUIRE(copy->TableF32WeakPointers[0][3][i] == bell[i]);
+    }
+}
+
+TEST_CASE("Built Wavetables Round Trip Through The Disk Cache", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+
+    auto dir = fs::temp_directory_path() / "surge-wavetable-cache-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    auto source = dir / "bell.wav";
+    fs::copy_file("resources/test-data/wav/05_BELL.WAV", source);
+    auto cacheDir = dir / "cache";
+
+    auto wt = &(surge->storage.getPatch().scene[0].osc[0].wt);
+    surge->storage.load_wt_wav_portable(path_to_string(source), wt);
+    surge->storage.wavetableMipmapBuilder.waitUntilIdle();
+    REQUIRE(Surge::Storage::storeCachedWavetable(cacheDir, source, wt));
+    REQUIRE(fs::exists(Surge::Storage::cachedWavetablePath(cacheDir, source)));
+
+    int levels = 0;
+    while ((1 << levels) < wt->size && levels < max_mipmap_levels)
+        levels++;
+
+    std::vector<float> f32;
+    std::vector<short> i16;
+    for (int l = 0; l < levels; ++l)
+    {
+        for (int i = 0; i < (wt->size >> l); ++i)
+        {
+            f32.push_back(wt->TableF32WeakPointers[l][5][i]);
+            i16.push_back(wt->TableI16WeakPointers[l][5][i]);
+        }
+    }
+
+    // drop the built table, so the cache has to come from disk
+    surge->storage.load_wt_wav_portable("resources/test-data/wav/pluckalgo.wav", wt);
+
+    auto fromDisk = std::make_unique<Wavetable>();
+    REQUIRE(Surge::Storage::loadCachedWavetable(cacheDir, source, fromDisk.get()));
+    REQUIRE(fromDisk->size == 2048);
+    REQUIRE(fromDisk->n_tables == 33);
+
+    size_t idx = 0;
+    for (int l = 0; l < levels; ++l)
+    {
+        for (int i = 0; i < (fromDisk->size >> l); ++i, ++idx)
+        {
+            REQUIRE(fromDisk->TableF32WeakPointers[l][5][i] == f32[idx]);
+            REQUIRE(fromDisk->TableI16WeakPointers[l][5][i] == i16[idx]);
+        }
+    }
+
+    // a second load while that one is alive shares it rather than reading it again
+    auto shared = std::make_unique<Wavetable>();
+    REQUIRE(Surge::Storage::loadCachedWavetable(cacheDir, source, shared.get()));
+    REQUIRE(shared->TableF32Data == fromDisk->TableF32Data);
+
+    // and touching the source makes the entry stale
+    fs::last_write_time(source, fs::last_write_time(source) + std::chrono::hours(1));
+    auto stale = std::make_unique<Wavetable>();
+    REQUIRE(!Surge::Storage::loadCachedWavetable(cacheDir, source, stale.get()));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Patch Previews Round Trip Through The Disk Cache", "[io]")
+{
+    using pp = Surge::Storage::PatchPreview;
+
+    auto dir = fs::temp_directory_path() / "surge-patch-preview-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    auto patch = dir / "sine.fxp";
+    {
+        std::ofstream of(patch, std::ios::binary);
+        of << "not really a patch";
+    }
+    auto cacheDir = dir / "cache";
+
+    // a render a little longer than previews keep, so the decimation has to trim it
+    int renderFrames = (int)(2.5 * pp::renderSampleRate);
+    std::vector<float> L(renderFrames), R(renderFrames);
+    for (int i = 0; i < renderFrames; ++i)
+    {
+        L[i] = 0.5f * std::sin(2.0 * M_PI * 440.0 * i / pp::renderSampleRate);
+        R[i] = 0.25f * std::sin(2.0 * M_PI * 220.0 * i / pp::renderSampleRate);
+    }
+
+    pp preview;
+    Surge::Storage::decimatePatchPreview(L.data(), R.data(), renderFrames, preview);
+    REQUIRE(preview.frames() == pp::maxFrames);
+
+    REQUIRE(Surge::Storage::storePatchPreview(cacheDir, patch, preview));
+    REQUIRE(fs::exists(Surge::Storage::patchPreviewPath(cacheDir, patch)));
+
+    pp fromDisk;
+    REQUIRE(Surge::Storage::loadPatchPreview(cacheDir, patch, fromDisk));
+    REQUIRE(fromDisk.frames() == preview.frames());
+
+    // ADPCM is lossy and takes a few samples to find the sine's step size, but from then on
+    // it should come back to within a percent
+    float maxErr = 0.f;
+    for (int i = 32; i < preview.frames(); ++i)
+    {
+        maxErr = std::max(maxErr, std::fabs(fromDisk.L[i] - preview.L[i]));
+        maxErr = std::max(maxErr, std::fabs(fromDisk.R[i] - preview.R[i]));
+    }
+    REQUIRE(maxErr < 0.02f);
+
+    // the player mixes it in at its own rate, and stopping it goes quiet
+    auto shared = std::make_shared<pp>(fromDisk);
+    Surge::Storage::PatchPreviewPlayer player;
+    float oL[BLOCK_SIZE]{}, oR[BLOCK_SIZE]{};
+    player.play(shared);
+    player.mixInto(oL, oR, BLOCK_SIZE, pp::sampleRate);
+    for (int i = 0; i < BLOCK_SIZE; ++i)
+    {
+        REQUIRE(oL[i] == fromDisk.L[i]);
+        REQUIRE(oR[i] == fromDisk.R[i]);
+    }
+
+    player.stop();
+    std::fill(oL, oL + BLOCK_SIZE, 0.f);
+    player.mixInto(oL, oR, BLOCK_SIZE, pp::sampleRate);
+    REQUIRE(std::all_of(oL, oL + BLOCK_SIZE, [](auto f) { return f == 0.f; }));
+
+    // and saving over the patch makes its preview stale
+    {
+        std::ofstream of(patch, std::ios::binary | std::ios::app);
+        of << " any more";
+    }
+    pp stale;
+    REQUIRE(!Surge::Storage::loadPatchPreview(cacheDir, patch, stale));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("User Defaults Save In The Background And Merge Across Instances", "[io]")
+{
+    using namespace Surge::Storage;
+
+    auto dir = fs::temp_directory_path() / "surge-user-defaults-test";
+    fs::remove_all(dir);
+
+    // errors can come from the writer thread, so count them rather than failing there
+    std::atomic<int> errors{0};
+    auto noErrors = [&errors](auto &, auto &) { errors++; };
+
+    {
+        UserDefaultsProvider a(dir, "Test", defaultKeyToString, noErrors);
+        UserDefaultsProvider b(dir, "Test", defaultKeyToString, noErrors);
+
+        for (int i = 0; i < 100; ++i)
+            a.updateUserDefaultValue(DefaultZoom, 100 + i);
+        b.updateUserDefaultValue(LastPatchPath, std::string("/patches"));
+
+        // the update is there to read straight away, whenever it reaches the file
+        REQUIRE(a.getUserDefaultValue(DefaultZoom, 0) == 199);
+
+        REQUIRE(b.flush());
+        REQUIRE(a.flush());
+
+        // each save kept what the other had saved
+        REQUIRE(a.getUserDefaultValue(LastPatchPath, std::string()) == "/patches");
+        REQUIRE(!a.hasUnsavedChanges());
+
+        // left alone, the writer thread gets there by itself
+        a.updateUserDefaultValue(ShowCursorWhileEditing, 1);
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (a.hasUnsavedChanges() && std::chrono::steady_clock::now() < until)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE(!a.hasUnsavedChanges());
+
+        // and whatever is left over is saved on the way out
+        b.updateUserDefaultValue(MenuLightness, 7);
+    }
+
+    UserDefaultsProvider c(dir, "Test", defaultKeyToString, noErrors);
+    REQUIRE(c.getUserDefaultValue(DefaultZoom, 0) == 199);
+    REQUIRE(c.getUserDefaultValue(LastPatchPath, std::string()) == "/patches");
+    REQUIRE(c.getUserDefaultValue(ShowCursorWhileEditing, 0) == 1);
+    REQUIRE(c.getUserDefaultValue(MenuLightness, 0) == 7);
+    REQUIRE(!fs::exists(c.getDefaultsFile().string() + ".tmp"));
+    REQUIRE(errors == 0);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Preset Libraries Are Scanned Once And Rescanned When They Move", "[io]")
+{
+    typedef Surge::Storage::SharedPresetLibrary<int> Library;
+
+    auto dir = fs::temp_directory_path() / "surge-shared-preset-library-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "one");
+
+    std::atomic<int> walks{0};
+    Library::scanner_t scanner = [dir, &walks]() {
+        walks++;
+        auto scan = std::make_shared<Library::Scan>();
+        scan->noteDirectory(dir);
+        for (auto &d : fs::directory_iterator(dir))
+        {
+            scan->noteDirectory(d.path());
+            scan->presets++;
+        }
+        return std::shared_ptr<const Library::Scan>(scan);
+    };
+    auto key = path_to_string(dir);
+
+    // the background walk is the one everyone gets
+    Library::prefetch(key, scanner);
+    auto first = Library::get(key, scanner);
+    REQUIRE(first->presets == 1);
+    REQUIRE(Library::get(key, scanner) == first);
+    REQUIRE(walks == 1);
+
+    // a directory moving means walking again
+    fs::create_directories(dir / "two");
+    fs::last_write_time(dir, fs::last_write_time(dir) + std::chrono::hours(1));
+    auto second = Library::get(key, scanner);
+    REQUIRE(second != first);
+    REQUIRE(second->presets == 2);
+    REQUIRE(walks == 2);
+    REQUIRE(Library::get(key, scanner) == second);
+
+    // and forcing does so regardless
+    REQUIRE(Library::get(key, scanner, true) != second);
+    REQUIRE(walks == 3);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Patch List Snapshots Round Trip And Go Stale", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+
+    auto dir = fs::temp_directory_path() / "surge-patch-list-snapshot-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "Leads" / "Soft");
+    for (auto f : {"Leads/one.fxp", "Leads/Soft/two.fxp", "Leads/Soft/notes.txt"})
+        std::ofstream(dir / fs::path{f}) << "x";
+
+    Surge::Storage::PatchListSnapshot snap;
+    surge->storage.refreshPatchOrWTListAddDir(
+        true, dir, "", [](auto s) { return s == ".fxp"; }, snap.items, snap.categories,
+        snap.directories);
+    REQUIRE(snap.items.size() == 2);
+    REQUIRE(snap.categories.size() == 3);
+    REQUIRE(snap.directories.size() == 3);
+    snap.firstUserCategory = 3;
+    snap.ordering = {1, 0};
+    snap.categoryOrdering = {0, 1, 2};
+    for (int i = 0; i < 2; ++i)
+        snap.items[snap.ordering[i]].order = i;
+    for (int i = 0; i < 3; ++i)
+        snap.categories[i].order = i;
+    REQUIRE(snap.isCurrent());
+
+    // not in the walked folders, or writing it would make the snapshot stale
+    auto file = fs::temp_directory_path() / "surge-patch-list-snapshot-test.cache";
+    REQUIRE(Surge::Storage::writePatchListSnapshot(file, "test", snap));
+
+    Surge::Storage::PatchListSnapshot back;
+    REQUIRE(!Surge::Storage::readPatchListSnapshot(file, "another key", back));
+    REQUIRE(Surge::Storage::readPatchListSnapshot(file, "test", back));
+    REQUIRE(back.isCurrent());
+    REQUIRE(back.items.size() == snap.items.size());
+    for (int i = 0; i < snap.items.size(); ++i)
+    {
+        REQUIRE(back.items[i].name == snap.items[i].name);
+        REQUIRE(back.items[i].path == snap.items[i].path);
+        REQUIRE(back.items[i].category == snap.items[i].category);
+    }
+    REQUIRE(back.categories.size() == snap.categories.size());
+    for (int i = 0; i < snap.categories.size(); ++i)
+    {
+        REQUIRE(back.categories[i].name == snap.categories[i].name);
+        REQUIRE(back.categories[i].children.size() == snap.categories[i].children.size());
+        REQUIRE(back.categories[i].numberOfPatchesInCategoryAndChildren ==
+                snap.categories[i].numberOfPatchesInCategoryAndChildren);
+    }
+    REQUIRE(back.ordering == snap.ordering);
+
+    // a truncated file is refused rather than half read
+    fs::resize_file(file, fs::file_size(file) - 3);
+    REQUIRE(!Surge::Storage::readPatchListSnapshot(file, "test", back));
+
+    // and any change to a directory we walked means walking again
+    auto soft = dir / "Leads" / "Soft";
+    fs::last_write_time(soft, fs::last_write_time(soft) + std::chrono::hours(1));
+    REQUIRE(!snap.isCurrent());
+
+    fs::remove(file);
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Instances Share The Patch And Wavetable Lists", "[io]")
+{
+    auto first = Surge::Headless::createSurge(44100);
+    auto second = Surge::Headless::createSurge(44100);
+    REQUIRE(first.get());
+    REQUIRE(second.get());
+
+    auto &a = first->storage, &b = second->storage;
+    REQUIRE(a.patch_list.size() == b.patch_list.size());
+    REQUIRE(a.patch_list.size() > 0);
+    REQUIRE(a.patchOrdering == b.patchOrdering);
+    REQUIRE(a.wt_list.size() == b.wt_list.size());
+    REQUIRE(a.wtOrdering == b.wtOrdering);
+    for (int i = 0; i < a.patch_list.size(); ++i)
+        REQUIRE(a.patch_list[i].path == b.patch_list[i].path);
+
+    // an explicit refresh still walks the folders, and finds the same thing
+    b.refresh_patchlist();
+    REQUIRE(a.patchOrdering == b.patchOrdering);
+}
+
 TEST_CASE("All Factory Wavetables Are Loadable", "[io]")
 {
     auto surge = Surge::Headless::createSurge(44100, true);
@@ -114,6 +583,282 @@ TEST_CASE("All Patches Are Loadable", "[io]")
     }
 }
 
+TEST_CASE("Queued Patch Loads Prefetch While Playing", "[io]")
+{
+    auto direct = Surge::Headless::createSurge(44100, true);
+    auto queued = Surge::Headless::createSurge(44100, true);
+    REQUIRE(direct.get());
+    REQUIRE(queued.get());
+
+    // find a patch with a wavetable in it, so the prefetch has something to build
+    int idx = -1;
+    for (int i = 0; i < std::min((int)direct->storage.patch_list.size(), 400) && idx < 0; ++i)
+    {
+        direct->loadPatch(i);
+        if (direct->storage.getPatch().scene[0].osc[0].type.val.i == ot_wavetable)
+            idx = i;
+    }
+    REQUIRE(idx >= 0);
+
+    for (int i = 0; i < 10; ++i)
+        queued->process();
+
+    queued->patchid_queue = idx;
+    queued->process();
+
+    // the current patch is still running while the file is read
+    REQUIRE(!queued->halt_engine);
+    REQUIRE((queued->patchPrefetchRunning || queued->patchPrefetchReady));
+
+    int blocks = 0;
+    while ((queued->patchid_queue >= 0 || queued->halt_engine || queued->fadeInAfterPatchLoad) &&
+           blocks < 20000)
+    {
+        queued->process();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        blocks++;
+    }
+
+    REQUIRE(queued->patchid == idx);
+    REQUIRE(queued->storage.getPatch().name == direct->storage.getPatch().name);
+    REQUIRE(queued->masterfade == 1.f);
+    REQUIRE(!queued->patchPrefetchReady);
+
+    auto &a = direct->storage.getPatch().scene[0].osc[0].wt;
+    auto &b = queued->storage.getPatch().scene[0].osc[0].wt;
+    REQUIRE(a.size == b.size);
+    REQUIRE(a.n_tables == b.n_tables);
+    REQUIRE(a.flags == b.flags);
+    for (int s = 0; s < a.size; ++s)
+    {
+        if (a.flags & wtf_int16)
+            REQUIRE(a.TableI16WeakPointers[0][0][s] == b.TableI16WeakPointers[0][0][s]);
+        else
+            REQUIRE(a.TableF32WeakPointers[0][0][s] == b.TableF32WeakPointers[0][0][s]);
+    }
+}
+
+TEST_CASE("Jogging Through Patches Uses The Preload", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100, true);
+    REQUIRE(surge.get());
+    REQUIRE(surge->storage.patch_list.size() > 2);
+
+    auto runUntilLoaded = [&]() {
+        int blocks = 0;
+        while ((surge->patchid_queue >= 0 || surge->halt_engine || surge->fadeInAfterPatchLoad) &&
+               blocks < 20000)
+        {
+            surge->process();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            blocks++;
+        }
+    };
+    auto preloadIdle = [&]() {
+        for (int i = 0; i < 20000; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> g(surge->patchPreloadMutex);
+                if (!surge->patchPreloadRunning)
+                    return true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return false;
+    };
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    surge->patchid_queue = surge->storage.patchOrdering[0];
+    runUntilLoaded();
+    REQUIRE(preloadIdle());
+
+    // the next patch in the category, the way jogPatch walks
+    auto &st = surge->storage;
+    auto cat = st.patch_list[surge->patchid].category;
+    std::vector<int> inCat;
+    for (auto i : st.patchOrdering)
+        if (st.patch_list[i].category == cat)
+            inCat.push_back(i);
+    REQUIRE(inCat.size() > 1);
+    auto pos = std::find(inCat.begin(), inCat.end(), surge->patchid) - inCat.begin();
+    auto next = inCat[(pos + 1) % inCat.size()];
+    auto nextPath = path_to_string(st.patch_list[next].path);
+
+    {
+        std::lock_guard<std::mutex> g(surge->patchPreloadMutex);
+        REQUIRE(std::any_of(surge->patchPreloads.begin(), surge->patchPreloads.end(),
+                            [&](auto &p) { return p->path == nextPath && p->data; }));
+    }
+
+    surge->jogPatch(true);
+    runUntilLoaded();
+    REQUIRE(surge->patchid == next);
+    REQUIRE(surge->storage.getPatch().name == st.patch_list[next].name);
+}
+
+TEST_CASE("DAW State Parameter Blocks Load Like The XML", "[io]")
+{
+    auto src = Surge::Headless::createSurge(44100);
+    REQUIRE(src);
+
+    // something with plenty of modulation and FX, plus the odd attribute set
+    REQUIRE(src->loadPatchByPath("resources/test-data/patches/Church.fxp", -1, "Test"));
+    auto &sp = src->storage.getPatch();
+    sp.scene[0].osc[0].pitch.set_extend_range(true);
+    sp.scene[0].lfo[0].rate.temposync = true;
+    sp.scene[0].osc[1].pitch.val.f = 1.2345678e-9f; // too small for the XML to keep exactly
+
+    void *withBlock = nullptr, *withoutBlock = nullptr;
+    auto withSize = sp.save_patch(&withBlock, true);
+    std::vector<char> withData((char *)withBlock, (char *)withBlock + withSize);
+    auto withoutSize = sp.save_patch(&withoutBlock, false);
+    std::vector<char> withoutData((char *)withoutBlock, (char *)withoutBlock + withoutSize);
+
+    REQUIRE(withSize > withoutSize);
+    // the first part, which older versions read, is the same either way
+    REQUIRE(memcmp(withData.data(), withoutData.data(), withoutSize) == 0);
+
+    auto fromBlock = Surge::Headless::createSurge(44100);
+    auto fromXML = Surge::Headless::createSurge(44100);
+    fromBlock->loadRaw(withData.data(), withSize, false);
+    fromXML->loadRaw(withoutData.data(), withoutSize, false);
+
+    auto &bp = fromBlock->storage.getPatch(), &xp = fromXML->storage.getPatch();
+    REQUIRE(bp.param_ptr.size() == sp.param_ptr.size());
+
+    for (int i = 0; i < sp.param_ptr.size(); ++i)
+    {
+        auto *b = bp.param_ptr[i], *x = xp.param_ptr[i];
+        INFO("Parameter " << sp.param_ptr[i]->get_storage_name());
+
+        if (sp.param_ptr[i] == &sp.scene[0].osc[1].pitch)
+        {
+            REQUIRE(b->val.f == 1.2345678e-9f);
+        }
+        else if (b->valtype == vt_float)
+        {
+            REQUIRE(b->val.f == Approx(x->val.f).margin(1e-6));
+        }
+        else
+        {
+            REQUIRE(b->val.i == x->val.i);
+        }
+
+        REQUIRE(b->temposync == x->temposync);
+        REQUIRE(b->extend_range == x->extend_range);
+        REQUIRE(b->absolute == x->absolute);
+        REQUIRE(b->deactivated == x->deactivated);
+        REQUIRE(b->deform_type == x->deform_type);
+        REQUIRE(b->porta_curve == x->porta_curve);
+    }
+
+    REQUIRE(bp.scene[0].osc[0].pitch.extend_range);
+    REQUIRE(bp.scene[0].lfo[0].rate.temposync);
+
+    auto sameRoutings = [](const auto &a, const auto &b) {
+        REQUIRE(a.size() == b.size());
+        for (int i = 0; i < a.size(); ++i)
+        {
+            REQUIRE(a[i].source_id == b[i].source_id);
+            REQUIRE(a[i].source_index == b[i].source_index);
+            REQUIRE(a[i].source_scene == b[i].source_scene);
+            REQUIRE(a[i].destination_id == b[i].destination_id);
+            REQUIRE(a[i].muted == b[i].muted);
+            REQUIRE(a[i].depth == Approx(b[i].depth).margin(1e-6));
+        }
+    };
+
+    sameRoutings(bp.modulation_global, xp.modulation_global);
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        sameRoutings(bp.scene[sc].modulation_scene, xp.scene[sc].modulation_scene);
+        sameRoutings(bp.scene[sc].modulation_voice, xp.scene[sc].modulation_voice);
+    }
+
+    REQUIRE(bp.name == xp.name);
+    REQUIRE(bp.fx[0].type.val.i == xp.fx[0].type.val.i);
+
+    // a block for some other parameter table is ignored, and the XML still loads
+    withData[withoutSize + 12] ^= 0x5a;
+    auto damaged = Surge::Headless::createSurge(44100);
+    damaged->loadRaw(withData.data(), withSize, false);
+    REQUIRE(damaged->storage.getPatch().scene[0].osc[1].pitch.val.f ==
+            Approx(xp.scene[0].osc[1].pitch.val.f));
+    REQUIRE(damaged->storage.getPatch().name == xp.name);
+}
+
+TEST_CASE("Patch Parameters Load Regardless Of Order Or Gaps", "[io]")
+{
+    auto src = Surge::Headless::createSurge(44100);
+    REQUIRE(src);
+    REQUIRE(src->loadPatchByPath("resources/test-data/patches/Church.fxp", -1, "Test"));
+    auto &sp = src->storage.getPatch();
+    sp.scene[0].osc[0].pitch.val.f = 3.25f;
+    sp.scene[1].lfo[2].rate.val.f = -1.5f;
+
+    void *data = nullptr;
+    auto size = sp.save_xml(&data);
+    TiXmlDocument doc;
+    doc.Parse(std::string((char *)data, size).c_str());
+    free(data);
+
+    auto *parameters = TINYXML_SAFE_TO_ELEMENT(doc.FirstChild("patch")->FirstChild("parameters"));
+    REQUIRE(parameters);
+
+    // reverse the parameters, and drop the first scene's amp EG attack entirely
+    std::vector<TiXmlElement> kept;
+    std::string dropped = sp.scene[0].adsr[0].a.get_storage_name();
+
+    for (auto *c = parameters->FirstChildElement(); c; c = c->NextSiblingElement())
+    {
+        if (dropped != c->Value())
+        {
+            kept.push_back(*c);
+        }
+    }
+
+    parameters->Clear();
+
+    for (auto it = kept.rbegin(); it != kept.rend(); ++it)
+    {
+        parameters->InsertEndChild(*it);
+    }
+
+    TiXmlPrinter printer;
+    doc.Accept(&printer);
+    std::string shuffled = printer.CStr();
+
+    auto dst = Surge::Headless::createSurge(44100);
+    auto &dp = dst->storage.getPatch();
+    auto defaultAttack = dp.scene[0].adsr[0].a.val.f;
+    dp.load_xml(shuffled.c_str(), shuffled.size(), false);
+
+    for (int i = 0; i < sp.param_ptr.size(); ++i)
+    {
+        INFO("Parameter " << sp.param_ptr[i]->get_storage_name());
+
+        if (sp.param_ptr[i] == &sp.scene[0].adsr[0].a)
+        {
+            REQUIRE(dp.param_ptr[i]->val.f == defaultAttack);
+        }
+        else if (sp.param_ptr[i]->valtype == vt_float)
+        {
+            REQUIRE(dp.param_ptr[i]->val.f == Approx(sp.param_ptr[i]->val.f).margin(1e-5));
+        }
+        else
+        {
+            REQUIRE(dp.param_ptr[i]->val.i == sp.param_ptr[i]->val.i);
+        }
+    }
+
+    auto idx = dp.parameterIndexFromStorageName(dp.scene[1].lfo[2].rate.get_storage_name());
+    REQUIRE(idx >= 0);
+    REQUIRE(dp.param_ptr[idx] == &dp.scene[1].lfo[2].rate);
+    REQUIRE(dp.parameterIndexFromStorageName("not_a_parameter") == -1);
+}
+
 TEST_CASE("DAW Streaming And Unstreaming", "[io][mpe][tun]")
 {
     // The basic plan of attack is, in a section, set up two surges,
@@ -135,6 +880,21 @@ TEST_CASE("DAW Streaming And Unstreaming", "[io][mpe][tun]")
         // if(d) free(d);
     };
 
+    SECTION("Offline Bounce Quality Saves")
+    {
+        auto surgeSrc = Surge::Headless::createSurge(44100);
+        auto surgeDest = Surge::Headless::createSurge(44100);
+        REQUIRE(surgeDest->bounceQualityWhenOffline);
+
+        surgeSrc->bounceQualityWhenOffline = false;
+        fromto(surgeSrc, surgeDest);
+        REQUIRE(!surgeDest->bounceQualityWhenOffline);
+
+        surgeSrc->bounceQualityWhenOffline = true;
+        fromto(surgeSrc, surgeDest);
+        REQUIRE(surgeDest->bounceQualityWhenOffline);
+    }
+
     SECTION("MPE Enabled State Saves")
     {
         auto surgeSrc = Surge::Headless::createSurge(44100);
@@ -731,6 +1491,188 @@ TEST_CASE("Mono Voice Priority Streams", "[io]")
     }
 }
 
+TEST_CASE("Streaming WAV Writer", "[io]")
+{
+    using Surge::Storage::WAVFileWriter;
+
+    auto file = fs::temp_directory_path() / "surge-wav-writer-test.wav";
+    std::string err;
+
+    // more than a ring of chunks, in pieces which don't line up with them
+    const int blockFrames = 1000, nBlocks = 200;
+    std::vector<float> L(blockFrames), R(blockFrames);
+    const float *chans[2] = {L.data(), R.data()};
+
+    auto readLE = [](const std::string &d, size_t at, int bytes) {
+        int32_t v = 0;
+        for (int i = bytes - 1; i >= 0; --i)
+            v = (v << 8) | (unsigned char)d[at + i];
+        if (bytes < 4 && (v & (1 << (bytes * 8 - 1))))
+            v -= (1 << (bytes * 8));
+        return v;
+    };
+
+    for (auto [fmt, bytes] : {std::make_pair(WAVFileWriter::FLOAT32, 4),
+                              std::make_pair(WAVFileWriter::PCM24, 3),
+                              std::make_pair(WAVFileWriter::PCM16, 2)})
+    {
+        INFO("Writing " << bytes << " bytes per sample");
+        WAVFileWriter w;
+        REQUIRE(w.open(file, 2, 48000, fmt, err));
+
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            for (int i = 0; i < blockFrames; ++i)
+            {
+                L[i] = ((b * blockFrames + i) % 200) / 200.f;
+                R[i] = -L[i];
+            }
+            w.write(chans, blockFrames);
+        }
+        REQUIRE(w.close(err));
+
+        std::ifstream in(file, std::ios::binary);
+        std::string d((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto dataBytes = (size_t)nBlocks * blockFrames * 2 * bytes;
+
+        REQUIRE(d.size() == 44 + dataBytes);
+        REQUIRE(d.substr(0, 4) == "RIFF");
+        REQUIRE(d.substr(36, 4) == "data");
+        REQUIRE(readLE(d, 4, 4) == 36 + dataBytes);
+        REQUIRE(readLE(d, 40, 4) == dataBytes);
+        REQUIRE(readLE(d, 22, 2) == 2);
+        REQUIRE(readLE(d, 34, 2) == bytes * 8);
+
+        // frame 12345 is 145 into its ramp
+        auto at = 44 + 12345 * 2 * bytes;
+        float l, r;
+        if (bytes == 4)
+        {
+            memcpy(&l, d.data() + at, 4);
+            memcpy(&r, d.data() + at + 4, 4);
+        }
+        else
+        {
+            float scale = bytes == 3 ? 8388607.f : 32767.f;
+            l = readLE(d, at, bytes) / scale;
+            r = readLE(d, at + bytes, bytes) / scale;
+        }
+        REQUIRE(l == Approx(145 / 200.f).margin(1e-4));
+        REQUIRE(r == Approx(-145 / 200.f).margin(1e-4));
+    }
+
+    fs::remove(file);
+}
+
+TEST_CASE("Patch Snapshots Restore Without XML", "[io]")
+{
+    auto src = Surge::Headless::createSurge(44100);
+    REQUIRE(src->loadPatchByPath("resources/test-data/patches/Church.fxp", -1, "Test"));
+
+    Surge::Storage::PatchSnapshot snap;
+    snap.capture(src->storage.getPatch());
+
+    auto samePatch = [](SurgePatch &a, SurgePatch &b) {
+        REQUIRE(a.name == b.name);
+        REQUIRE(a.param_ptr.size() == b.param_ptr.size());
+        for (size_t i = 0; i < a.param_ptr.size(); ++i)
+        {
+            INFO("Parameter " << a.param_ptr[i]->get_storage_name());
+            REQUIRE(a.param_ptr[i]->val.i == b.param_ptr[i]->val.i);
+            REQUIRE(a.param_ptr[i]->ctrltype == b.param_ptr[i]->ctrltype);
+            REQUIRE(a.param_ptr[i]->extend_range == b.param_ptr[i]->extend_range);
+        }
+        REQUIRE(a.modulation_global.size() == b.modulation_global.size());
+        for (int sc = 0; sc < n_scenes; ++sc)
+        {
+            REQUIRE(a.scene[sc].modulation_voice.size() == b.scene[sc].modulation_voice.size());
+            REQUIRE(a.scene[sc].modulation_scene.size() == b.scene[sc].modulation_scene.size());
+            REQUIRE(a.scene[sc].osc[0].wavetable_display_name ==
+                    b.scene[sc].osc[0].wavetable_display_name);
+        }
+    };
+
+    SECTION("Restore Into Another Synth")
+    {
+        auto dst = Surge::Headless::createSurge(44100);
+        dst->restorePatchSnapshot(snap);
+        samePatch(src->storage.getPatch(), dst->storage.getPatch());
+    }
+
+    SECTION("Restore After Edits")
+    {
+        auto ref = Surge::Headless::createSurge(44100);
+        REQUIRE(ref->loadPatchByPath("resources/test-data/patches/Church.fxp", -1, "Test"));
+
+        auto &patch = src->storage.getPatch();
+        patch.scene[0].osc[0].type.val.i = ot_sine;
+        patch.update_controls(false, &patch.scene[0].osc[0]);
+        patch.scene[0].filterunit[0].cutoff.val.f = 0.f;
+        patch.fx[0].type.val.i = fxt_off;
+        patch.scene[0].modulation_voice.clear();
+        patch.name = "Edited";
+
+        src->restorePatchSnapshot(snap);
+        for (int i = 0; i < 10; ++i)
+            src->process();
+
+        samePatch(ref->storage.getPatch(), src->storage.getPatch());
+    }
+}
+
+TEST_CASE("DAW State Is Rebuilt Only When Something Changes", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge->loadPatchByPath("resources/test-data/patches/Church.fxp", -1, "Test"));
+
+    auto save = [&surge]() {
+        void *d = nullptr;
+        surge->populateDawExtraState();
+        auto sz = surge->saveRaw(&d);
+        auto c = static_cast<const char *>(d);
+        return std::string(c, c + sz);
+    };
+    auto saveBuilds = [&surge, &save]() {
+        auto before = surge->storage.getPatch().patchptr;
+        save();
+        return surge->storage.getPatch().patchptr != before;
+    };
+
+    auto first = save();
+    REQUIRE(!saveBuilds());
+    REQUIRE(save() == first);
+
+    SECTION("Parameter Set By The Host")
+    {
+        auto &cutoff = surge->storage.getPatch().scene[0].filterunit[0].cutoff;
+        surge->setParameter01(surge->idForParameter(&cutoff), 0.2f);
+        REQUIRE(saveBuilds());
+        REQUIRE(save() != first);
+        REQUIRE(!saveBuilds());
+    }
+
+    SECTION("Modulation Routing")
+    {
+        auto &cutoff = surge->storage.getPatch().scene[0].filterunit[0].cutoff;
+        surge->setModDepth01(cutoff.id, ms_lfo1, 0, 0, 0.3f);
+        REQUIRE(saveBuilds());
+        REQUIRE(save() != first);
+    }
+
+    SECTION("Editor Edits")
+    {
+        surge->storage.getPatch().isDirty = true;
+        REQUIRE(saveBuilds());
+    }
+
+    SECTION("DAW Extra State")
+    {
+        surge->bounceQualityWhenOffline = !surge->bounceQualityWhenOffline;
+        REQUIRE(saveBuilds());
+        REQUIRE(save() != first);
+    }
+}
+
 TEST_CASE("XML Direct", "[io]")
 {
     // This is not a public API but we want to make sure it
@@ -347,6 +347,44 @@ error("I will parse but will not run")
     }
 }
 
+TEST_CASE("Check Syntax Without Running", "[lua]")
+{
+    lua_State *L = lua_open();
+    REQUIRE(L);
+    luaL_openlibs(L);
+
+    std::string err;
+    int line;
+
+    SECTION("Code That Errors At Runtime Still Passes")
+    {
+        auto fn = R"FN(
+function triple(x)
+    error("checking shouldn't run me")
+end
+triple(2)
+)FN";
+        REQUIRE(Surge::LuaSupport::checkSyntax(L, fn, err, line));
+        REQUIRE(line == -1);
+        REQUIRE(lua_gettop(L) == 0);
+    }
+
+    SECTION("Syntax Errors Report Their Line")
+    {
+        auto fn = R"FN(
+function plus_one(x)
+    return x +
+end
+)FN";
+        REQUIRE(!Surge::LuaSupport::checkSyntax(L, fn, err, line));
+        REQUIRE(line == 4);
+        REQUIRE(err.find("Lua Syntax Error: ") == 0);
+        REQUIRE(lua_gettop(L) == 0);
+    }
+
+    lua_close(L);
+}
+
 TEST_CASE("Parse Multiple Functions", "[lua]")
 {
     SECTION("A Pair")
@@ -686,6 +724,43 @@ end
             }
         }
     }
+
+    SECTION("Whole Tables Across Threads")
+    {
+        // a distinct script from the one above, so nothing is remembered from it
+        const std::string s = R"FN(
+function generate(config)
+    local res = {}
+    for i,x in ipairs(config.xs) do
+        res[i] = math.sin(2 * math.pi * x * config.n) / config.nTables
+    end
+    return res
+end
+        )FN";
+
+        const int res = 256, nfr = 64;
+
+        // preview one frame first, which generation should simply reuse
+        auto pre = Surge::WavetableScript::evaluateScriptAtFrame(nullptr, s, res, 5, nfr);
+        REQUIRE(pre.size() == res);
+
+        wt_header wh;
+        float *wd = nullptr;
+        REQUIRE(Surge::WavetableScript::constructWavetable(nullptr, s, res, nfr, wh, &wd));
+        REQUIRE(wh.n_samples == res);
+        REQUIRE(wh.n_tables == nfr);
+
+        auto dp = 1.0 / (res - 1);
+        for (int f = 0; f < nfr; ++f)
+        {
+            for (int i = 0; i < res; ++i)
+            {
+                auto r = sin(2 * M_PI * i * dp * (f + 1)) / nfr;
+                REQUIRE(wd[f * res + i] == Approx(r).margin(1e-6));
+            }
+        }
+        delete[] wd;
+    }
 }
 
 TEST_CASE("Simple Used Formula Modulator", "[formula]")
@@ -929,6 +1004,237 @@ end)FN");
     }
 }
 
+TEST_CASE("Scene Inputs Are Reset Each Block", "[formula]")
+{
+    SECTION("Overwriting A Scene Input Doesn't Stick")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    state.tempo = state.tempo * 2
+    state.output = state.tempo / 1000 + state.voice_count / 10
+    return state
+end)FN");
+        auto runIt = runFormula(&storage, &fs, 0.0321, 3);
+        REQUIRE(runIt.size() > 10);
+        for (auto c : runIt)
+        {
+            REQUIRE(c.v == Approx(0.34));
+        }
+    }
+}
+
+TEST_CASE("Native Formula Evaluation", "[formula]")
+{
+    SECTION("Only Simple Formulae Compile")
+    {
+        FormulaModulatorStorage fs;
+        Surge::Formula::createInitFormula(&fs);
+        REQUIRE(Surge::Formula::ArithmeticFormula::compile(fs.formulaString));
+
+        REQUIRE(!Surge::Formula::ArithmeticFormula::compile(R"FN(
+function process(state)
+    if state.phase > 0.5 then
+        state.output = 1
+    end
+    return state
+end)FN"));
+
+        REQUIRE(!Surge::Formula::ArithmeticFormula::compile(R"FN(
+function init(state)
+    state.depth = 2
+    return state
+end
+
+function process(state)
+    state.output = state.phase / state.depth
+    return state
+end)FN"));
+    }
+
+    SECTION("Native And Lua Agree")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    local w = 2 * math.pi * state.phase
+    local s = math.sin(w) + 0.3 * math.cos(3 * w) ^ 2
+    s = s - state.deform * (state.phase % 0.25) + math.max(0, state.intphase - 2) / 10
+    state.output = math.min(s, 0.8)
+    return state
+end)FN");
+
+        Surge::Formula::EvaluatorState native, lua;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, native, false);
+        Surge::Formula::prepareForEvaluation(&storage, &fs, lua, true);
+        REQUIRE(native.native);
+        REQUIRE(!lua.native);
+
+        native.deform = 0.4;
+        lua.deform = 0.4;
+
+        double phase = 0;
+        int iphase = 0;
+        while (iphase < 5)
+        {
+            float rn[Surge::Formula::max_formula_outputs], rl[Surge::Formula::max_formula_outputs];
+            Surge::Formula::valueAt(iphase, phase, &storage, &fs, &native, rn);
+            Surge::Formula::valueAt(iphase, phase, &storage, &fs, &lua, rl);
+            REQUIRE(rn[0] == Approx(rl[0]).margin(1e-6));
+            REQUIRE(native.activeoutputs == 1);
+
+            phase += 0.0173;
+            if (phase > 1)
+            {
+                phase -= 1;
+                iphase++;
+            }
+        }
+    }
+}
+
+TEST_CASE("Precompiled Formula Bytecode", "[formula]")
+{
+    SurgeStorage storage;
+    FormulaModulatorStorage fs;
+    fs.setFormula(R"FN(
+function init(state)
+    state.steps = { -1, 0.5, 0.25, 1 }
+    return state
+end
+
+function process(state)
+    local i = math.floor(state.phase * 4) + 1
+    state.output = state.steps[i]
+    return state
+end)FN");
+
+    Surge::Formula::precompileFormula(&storage, &fs);
+    {
+        auto &bc = storage.formulaGlobalData->bytecode;
+        REQUIRE(bc.find(fs.formulaHash) != bc.end());
+        REQUIRE(bc[fs.formulaHash].source == fs.formulaString);
+        REQUIRE(bc[fs.formulaHash].code.size() > 4);
+        REQUIRE(bc[fs.formulaHash].code[0] == '\x1b');
+    }
+
+    // the audio state loads the bytecode, the display state the source; they had better agree
+    Surge::Formula::EvaluatorState audio, disp;
+    Surge::Formula::prepareForEvaluation(&storage, &fs, audio, false);
+    Surge::Formula::prepareForEvaluation(&storage, &fs, disp, true);
+    REQUIRE(audio.isvalid);
+    REQUIRE(disp.isvalid);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        float ra[Surge::Formula::max_formula_outputs], rd[Surge::Formula::max_formula_outputs];
+        Surge::Formula::valueAt(0, i / 8.f + 0.01f, &storage, &fs, &audio, ra);
+        Surge::Formula::valueAt(0, i / 8.f + 0.01f, &storage, &fs, &disp, rd);
+        REQUIRE(ra[0] == rd[0]);
+    }
+
+    SECTION("Broken Formulae Are Left To The Audio Thread")
+    {
+        FormulaModulatorStorage bad;
+        bad.setFormula("function process(state) state.output = ");
+        Surge::Formula::precompileFormula(&storage, &bad);
+        auto &bc = storage.formulaGlobalData->bytecode;
+        REQUIRE(bc.find(bad.formulaHash) == bc.end());
+
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &bad, es, false);
+        REQUIRE(!es.isvalid);
+    }
+}
+
+TEST_CASE("Formula Budgets", "[formula]")
+{
+    SECTION("Runaway Formulae Stop And Hold Their Last Value")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    if state.phase > 0.5 then
+        while true do end
+    end
+    state.output = 0.25 + state.phase
+    return state
+end)FN");
+
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, false);
+        REQUIRE(es.isvalid);
+        REQUIRE(es.probationCallsLeft == Surge::Formula::GlobalData::probationCalls);
+
+        float r[Surge::Formula::max_formula_outputs];
+        Surge::Formula::valueAt(0, 0.25, &storage, &fs, &es, r);
+        REQUIRE(r[0] == Approx(0.5));
+        REQUIRE(!es.raisedError);
+
+        Surge::Formula::valueAt(0, 0.75, &storage, &fs, &es, r);
+        REQUIRE(es.overBudget);
+        REQUIRE(es.raisedError);
+        REQUIRE(r[0] == Approx(0.5));
+
+        Surge::Formula::valueAt(0, 0.1, &storage, &fs, &es, r);
+        REQUIRE(r[0] == Approx(0.5));
+    }
+
+    SECTION("Formulae Which Behave Leave Probation")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    local s = 0
+    for i = 1, 8 do
+        s = s + state.phase / i
+    end
+    state.output = s / 4
+    return state
+end)FN");
+
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, false);
+        float r[Surge::Formula::max_formula_outputs];
+        for (int i = 0; i < Surge::Formula::GlobalData::probationCalls + 5; ++i)
+            Surge::Formula::valueAt(0, 0.5, &storage, &fs, &es, r);
+        REQUIRE(es.probationCallsLeft == 0);
+        REQUIRE(storage.formulaGlobalData->functionsOnProbation.empty());
+        REQUIRE(!es.overBudget);
+    }
+
+    SECTION("Audio Garbage Is Collected Between Blocks")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    local t = {}
+    for i = 1, 1000 do
+        t[i] = state.phase * i
+    end
+    state.output = t[500] / 1000
+    return state
+end)FN");
+
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, false);
+        auto before = storage.formulaGlobalData->audioHeapKB;
+
+        float r[Surge::Formula::max_formula_outputs];
+        for (int i = 0; i < 500; ++i)
+        {
+            Surge::Formula::valueAt(0, 0.5, &storage, &fs, &es, r);
+            Surge::Formula::stepGarbageCollection(&storage, false);
+        }
+        REQUIRE(storage.formulaGlobalData->audioHeapKB < before + 2048);
+    }
+}
+
 TEST_CASE("Two Surge XTs", "[formula]")
 {
     // this attempts but fails to reproduce 5753 but i left it here anyway
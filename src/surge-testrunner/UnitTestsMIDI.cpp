@@ -30,6 +30,9 @@
 #include "catch2/catch_amalgamated.hpp"
 
 #include "UnitTestUtilities.h"
+#include "MIDIEventCoalescer.h"
+#include "MultitimbralEngine.h"
+#include "HeadlessPluginLayerProxy.h"
 
 using namespace Surge::Test;
 
@@ -1417,6 +1420,52 @@ TEST_CASE("Voice Stealing", "[midi]")
     }
 }
 
+TEST_CASE("Voice Stealing Modes", "[midi]")
+{
+    auto stolenKeyFor = [](PolyVoiceStealingMode mode, bool releaseOne) {
+        auto surge = surgeOnSine();
+        surge->storage.getPatch().polylimit.val.i = 4;
+        surge->storage.getPatch().scene[0].polyVoiceStealingMode = mode;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        for (auto k : {60, 50, 70, 65})
+        {
+            surge->playNote(0, k, 120, 0);
+            for (int i = 0; i < 20; ++i)
+                surge->process();
+        }
+        if (releaseOne)
+        {
+            surge->releaseNote(0, 65, 0);
+            surge->process();
+        }
+        REQUIRE(surge->voices[0].size() == 4);
+
+        surge->playNote(0, 80, 120, 0);
+        int stolen = -1, count = 0;
+        for (auto v : surge->voices[0])
+        {
+            if (v->state.uberrelease)
+            {
+                stolen = v->state.key;
+                count++;
+            }
+        }
+        REQUIRE(count == 1);
+        return stolen;
+    };
+
+    REQUIRE(stolenKeyFor(STEAL_OLDEST, false) == 60);
+    REQUIRE(stolenKeyFor(STEAL_LOWEST, false) == 50);
+    REQUIRE(stolenKeyFor(STEAL_HIGHEST, false) == 70);
+
+    // a released voice goes before any held one whatever the mode
+    REQUIRE(stolenKeyFor(STEAL_OLDEST, true) == 65);
+    REQUIRE(stolenKeyFor(STEAL_LOWEST, true) == 65);
+    REQUIRE(stolenKeyFor(STEAL_QUIETEST, true) == 65);
+}
+
 TEST_CASE("Single Key Pedal Voice Count", "[midi]") // #1459
 {
     auto playingVoiceCount = [](std::shared_ptr<SurgeSynthesizer> surge) {
@@ -1536,6 +1585,46 @@ TEST_CASE("Single Key Pedal Voice Count", "[midi]") // #1459
     }
 }
 
+TEST_CASE("Hold Buffer Stays Bounded", "[midi]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+    surge->storage.getPatch().scene[0].polymode.val.i = pm_poly;
+
+    auto step = [&surge]() {
+        for (int i = 0; i < 5; ++i)
+            surge->process();
+    };
+
+    // the same few notes struck over and over under the pedal, across the MPE channels
+    surge->channelController(0, 64, 127);
+    step();
+    for (int rep = 0; rep < 200; ++rep)
+    {
+        for (int ch = 0; ch < 15; ++ch)
+        {
+            surge->channelController(ch, 64, 127);
+            surge->playNote(ch, 60 + (rep % 4), 100, 0);
+            surge->releaseNote(ch, 60 + (rep % 4), 0);
+            surge->releaseNote(ch, 60 + (rep % 4), 0);
+        }
+        step();
+    }
+
+    REQUIRE(surge->holdbuffer[0].count <= 2 * 15 * 4);
+    REQUIRE(surge->holdbuffer[0].isWaiting(3, 61));
+    REQUIRE(!surge->holdbuffer[0].isWaiting(3, 70));
+
+    for (int ch = 0; ch < 15; ++ch)
+        surge->channelController(ch, 64, 0);
+    step();
+
+    REQUIRE(surge->holdbuffer[0].empty());
+    REQUIRE(!surge->holdbuffer[0].isWaiting(3, 61));
+    for (auto v : surge->voices[0])
+        REQUIRE(!v->state.gate);
+}
+
 TEST_CASE("Poly AT on Multiple Channels", "[midi]")
 {
     for (int ch = 0; ch < 16; ++ch)
@@ -1592,6 +1681,50 @@ TEST_CASE("MIDI Learn", "[midi]")
     REQUIRE(pd == Approx(-7).margin(.1));
 }
 
+TEST_CASE("MIDI Mappings Dispatch By Controller And Channel", "[midi]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &omni = surge->storage.getPatch().scene[0].osc[0].pitch;
+    auto &chan3 = surge->storage.getPatch().scene[0].osc[1].pitch;
+    auto &other = surge->storage.getPatch().scene[0].osc[2].pitch;
+
+    omni.midictrl = 20;
+    omni.midichan = -1;
+    chan3.midictrl = 20;
+    chan3.midichan = 3;
+    other.midictrl = 21;
+    other.midichan = -1;
+    surge->storage.midiMappingGeneration++;
+
+    auto settle = [&]() {
+        for (int i = 0; i < 300; ++i)
+            surge->process();
+    };
+
+    surge->channelController(0, 20, 127);
+    settle();
+    REQUIRE(omni.val.f == Approx(7).margin(.1));
+    REQUIRE(chan3.val.f == 0);
+    REQUIRE(other.val.f == 0);
+
+    surge->channelController(3, 20, 0);
+    settle();
+    REQUIRE(omni.val.f == Approx(-7).margin(.1));
+    REQUIRE(chan3.val.f == Approx(-7).margin(.1));
+    REQUIRE(other.val.f == 0);
+
+    // moving a mapping is picked up once the generation moves
+    other.midictrl = 20;
+    surge->storage.midiMappingGeneration++;
+    surge->channelController(5, 20, 127);
+    settle();
+    REQUIRE(omni.val.f == Approx(7).margin(.1));
+    REQUIRE(chan3.val.f == Approx(-7).margin(.1));
+    REQUIRE(other.val.f == Approx(7).margin(.1));
+}
+
 TEST_CASE("Poly Chords Blow Through Limit", "[midi]")
 {
     INFO("See Issue #6221");
@@ -1766,3 +1899,195 @@ TEST_CASE("Two On All Notes Off", "[midi]")
         REQUIRE(!g);
     }
 }
+
+TEST_CASE("MIDI Event Coalescing", "[midi]")
+{
+    auto co = std::make_unique<Surge::MIDI::MIDIEventCoalescer>();
+    std::vector<std::array<uint8_t, 3>> msgs;
+    msgs.reserve(Surge::MIDI::MIDIEventCoalescer::maxBatch);
+
+    auto add = [&](uint8_t a, uint8_t b, uint8_t c) {
+        msgs.push_back({a, b, c});
+        REQUIRE(co->add(msgs.back().data(), 3, (int)msgs.size()));
+    };
+    auto flush = [&]() {
+        std::vector<std::array<uint8_t, 3>> res;
+        co->flush([&res](const auto &e) { res.push_back({e.data[0], e.data[1], e.data[2]}); });
+        msgs.clear();
+        return res;
+    };
+
+    SECTION("Controller Bursts Keep The Last Value")
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            add(0xB0, 1, i);
+            add(0xE0, 0, i);
+            add(0xB1, 1, 100 + i);
+        }
+        auto res = flush();
+        REQUIRE(res.size() == 3);
+        REQUIRE(res[0] == std::array<uint8_t, 3>{0xB0, 1, 19});
+        REQUIRE(res[1] == std::array<uint8_t, 3>{0xE0, 0, 19});
+        REQUIRE(res[2] == std::array<uint8_t, 3>{0xB1, 1, 119});
+        REQUIRE(co->empty());
+    }
+
+    SECTION("Notes Are Barriers")
+    {
+        add(0xE0, 0, 10);
+        add(0xE0, 0, 20);
+        add(0x90, 60, 100);
+        add(0xE0, 0, 30);
+        add(0xE0, 0, 40);
+        add(0x80, 60, 0);
+        auto res = flush();
+        REQUIRE(res.size() == 4);
+        REQUIRE(res[0][2] == 20);
+        REQUIRE(res[1][0] == 0x90);
+        REQUIRE(res[2][2] == 40);
+        REQUIRE(res[3][0] == 0x80);
+    }
+
+    SECTION("Stateful Controllers Are Never Dropped")
+    {
+        add(0xB0, 101, 0);
+        add(0xB0, 100, 0);
+        add(0xB0, 6, 12);
+        add(0xB0, 6, 24);
+        add(0xB0, 64, 127);
+        add(0xB0, 64, 0);
+        REQUIRE(flush().size() == 6);
+    }
+
+    SECTION("Poly Pressure Is Per Key")
+    {
+        add(0xA0, 60, 1);
+        add(0xA0, 61, 2);
+        add(0xA0, 60, 3);
+        auto res = flush();
+        REQUIRE(res.size() == 2);
+        REQUIRE(res[0][1] == 61);
+        REQUIRE(res[1][2] == 3);
+    }
+
+    SECTION("A Full Batch Refuses More")
+    {
+        for (int i = 0; i < Surge::MIDI::MIDIEventCoalescer::maxBatch; ++i)
+            add(0xB0, 1, i & 127);
+        uint8_t extra[3]{0xB0, 1, 0};
+        REQUIRE(!co->add(extra, 3, 0));
+        REQUIRE(flush().size() == 1);
+        REQUIRE(co->add(extra, 3, 0));
+    }
+}
+
+TEST_CASE("Smoothed Parameters Recycle Interpolators", "[midi]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &patch = surge->storage.getPatch();
+    std::vector<int> ids;
+
+    for (auto *p : patch.param_ptr)
+    {
+        if (p->ctrltype == ct_percent && ids.size() < 100)
+        {
+            ids.push_back(p->id);
+        }
+    }
+    REQUIRE(ids.size() >= 32);
+
+    auto settle = [&]() {
+        for (int i = 0; i < 2000; ++i)
+        {
+            surge->process();
+        }
+    };
+
+    // more rounds than there are slots, so this only passes if finished smooths hand theirs back
+    for (int round = 0; round < 8; ++round)
+    {
+        float target = (round & 1) ? 0.2f : 0.8f;
+
+        for (auto id : ids)
+        {
+            surge->setParameterSmoothed(id, target);
+        }
+
+        // a direct set drops its interpolator part way through while the rest keep going
+        surge->process();
+        surge->setParameter01(surge->idForParameter(patch.param_ptr[ids[round]]), 0.5f);
+
+        settle();
+
+        for (auto id : ids)
+        {
+            auto expected = (id == ids[round]) ? 0.5f : target;
+            REQUIRE(patch.param_ptr[id]->get_value_f01() == Approx(expected).margin(1e-3));
+        }
+    }
+}
+
+TEST_CASE("Multitimbral Engine Routes Channels To Parts", "[midi]")
+{
+    HeadlessPluginLayerProxy parent;
+    Surge::MultitimbralEngine engine(&parent, 3, SurgeStorage::skipPatchLoadDataPathSentinel);
+    engine.setSamplerate(44100);
+
+    REQUIRE(engine.numParts() == 3);
+    REQUIRE(engine.partForChannel(2) == 2);
+    REQUIRE(engine.partForChannel(3) == -1);
+    for (int p = 1; p < 3; ++p)
+        REQUIRE(engine.part(p)->storage.patchDB == engine.part(0)->storage.patchDB);
+
+    auto voicesIn = [&](int p) { return (int)engine.part(p)->voices[0].size(); };
+
+    auto run = [&](bool parallel) {
+        engine.setParallelParts(parallel);
+        engine.allNotesOff();
+        for (int i = 0; i < 200; ++i)
+            engine.process();
+
+        engine.playNote(1, 60, 100);
+        engine.playNote(3, 64, 100);
+        for (int i = 0; i < 20; ++i)
+            engine.process();
+
+        REQUIRE(voicesIn(0) == 0);
+        REQUIRE(voicesIn(1) == 1);
+        REQUIRE(voicesIn(2) == 0);
+
+        float rms = 0;
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                float sum = 0;
+                for (int p = 0; p < 3; ++p)
+                    sum += engine.part(p)->output[c][i];
+                REQUIRE(engine.output[c][i] == Approx(sum).margin(1e-6));
+                REQUIRE(engine.part(0)->output[c][i] == 0.f);
+                rms += sum * sum;
+            }
+        }
+        REQUIRE(rms > 0);
+
+        engine.releaseNote(1, 60, 0);
+    };
+
+    SECTION("Serial") { run(false); }
+    SECTION("Parallel") { run(true); }
+
+    SECTION("Rerouted Channel")
+    {
+        engine.setPartForChannel(1, 2);
+        engine.playNote(1, 60, 100);
+        for (int i = 0; i < 20; ++i)
+            engine.process();
+
+        REQUIRE(voicesIn(1) == 0);
+        REQUIRE(voicesIn(2) == 1);
+    }
+}
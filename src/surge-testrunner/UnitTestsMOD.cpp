@@ -24,6 +24,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <set>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -478,6 +479,46 @@ TEST_CASE("ADSR Envelope Behaviour", "[mod]")
         }
     }
 
+    SECTION("Analog Envelope Follows Sample Rate Changes")
+    {
+        auto *adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+        ADSRModulationSource adsr;
+        adsr.init(&(surge->storage), adsrstorage, surge->storage.getPatch().scenedata[0], nullptr);
+
+        auto *lc = surge->storage.getPatch().scenedata[0];
+        lc[adsrstorage->a.param_id_in_scene].f = log2(0.2f);
+        lc[adsrstorage->d.param_id_in_scene].f = log2(0.2f);
+        lc[adsrstorage->s.param_id_in_scene].f = 0.5f;
+        lc[adsrstorage->r.param_id_in_scene].f = log2(0.2f);
+        lc[adsrstorage->mode.param_id_in_scene].b = true;
+
+        // the same envelope object, so whatever it keeps between blocks has to notice the change
+        auto timeToPeak = [&]() {
+            adsr.attack();
+            float prior = -1.f;
+            int blocks = 0;
+            while (blocks < 100000)
+            {
+                adsr.process_block();
+                if (adsr.get_output(0) < prior)
+                    break;
+                prior = adsr.get_output(0);
+                blocks++;
+            }
+            return blocks * BLOCK_SIZE * surge->storage.dsamplerate_inv;
+        };
+
+        auto at44 = timeToPeak();
+        surge->setSamplerate(96000);
+        auto at96 = timeToPeak();
+        surge->setSamplerate(44100);
+        auto again44 = timeToPeak();
+
+        REQUIRE(at44 > 0.01);
+        REQUIRE(at96 == Approx(at44).margin(0.01));
+        REQUIRE(again44 == Approx(at44).margin(1e-6));
+    }
+
     SECTION("Test Analog Envelope Sustain Push")
     {
         auto testSusPush = [&](float s1, float s2) {
@@ -947,6 +988,34 @@ TEST_CASE("MIDI Controller Smoothing", "[mod]")
             REQUIRE(a.get_output(0) == r);
         }
     }
+
+    SECTION("Smooth Towards Matches Set Target And Process")
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        REQUIRE(surge);
+
+        for (auto mode : {Modulator::SmoothingMode::LEGACY, Modulator::SmoothingMode::SLOW_EXP,
+                          Modulator::SmoothingMode::FAST_EXP, Modulator::SmoothingMode::FAST_LINE,
+                          Modulator::SmoothingMode::DIRECT})
+        {
+            INFO("Smoothing mode " << (int)mode);
+            ControllerModulationSource a(mode), b(mode);
+            a.set_samplerate(surge->storage.samplerate, surge->storage.samplerate_inv);
+            b.set_samplerate(surge->storage.samplerate, surge->storage.samplerate_inv);
+            a.init(0.2f);
+            b.init(0.2f);
+
+            for (int i = 0; i < 400; ++i)
+            {
+                // hold each target long enough to settle, then move
+                float t = (i / 100) * 0.25f;
+                a.set_target(t);
+                a.process_block();
+                b.smooth_towards(t);
+                REQUIRE(a.get_output(0) == b.get_output(0));
+            }
+        }
+    }
 }
 
 TEST_CASE("Keytrack Morph", "[mod]")
@@ -1432,4 +1501,290 @@ TEST_CASE("Mod LFO Is Well Behaved", "[mod]")
             }
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Modulation Routing Snapshots", "[mod]")
+{
+    auto surge = surgeOnSine();
+    REQUIRE(surge);
+
+    auto routings = [&surge]() -> auto & { return surge->storage.audioModulationRoutings(); };
+    auto pitchId = surge->storage.getPatch().scene[0].osc[0].pitch.id;
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    auto startEpoch = routings().epoch;
+    REQUIRE(routings().voice[0].empty());
+
+    SECTION("Edits Arrive At The Next Block")
+    {
+        surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.25);
+
+        // until the audio thread runs a block it keeps its current snapshot
+        REQUIRE(routings().epoch == startEpoch);
+        REQUIRE(routings().voice[0].empty());
+
+        surge->process();
+        REQUIRE(routings().epoch > startEpoch);
+        REQUIRE(routings().voice[0].size() == 1);
+        REQUIRE(routings().voice[0][0].source_id == ms_lfo1);
+        REQUIRE(routings().voice[0][0].depth ==
+                surge->storage.getPatch().scene[0].modulation_voice[0].depth);
+
+        surge->clearModulation(pitchId, ms_lfo1, 0, 0, false);
+        surge->process();
+        REQUIRE(routings().voice[0].empty());
+    }
+
+    SECTION("Only The Latest Of Several Edits Is Picked Up")
+    {
+        for (int i = 1; i <= 20; ++i)
+            surge->setModDepth01(pitchId, ms_lfo1, 0, 0, i * 0.01);
+
+        surge->process();
+        REQUIRE(routings().epoch == startEpoch + 20);
+        REQUIRE(routings().voice[0].size() == 1);
+        REQUIRE(routings().voice[0][0].depth ==
+                surge->storage.getPatch().scene[0].modulation_voice[0].depth);
+    }
+
+    SECTION("Voice Routings Are Compiled With Shared Source Slots")
+    {
+        auto cutoffId = surge->storage.getPatch().scene[0].filterunit[0].cutoff.id;
+        auto volId = surge->storage.getPatch().scene[0].osc[0].p[0].id;
+
+        surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.25);
+        surge->setModDepth01(cutoffId, ms_lfo1, 0, 0, 0.5);
+        surge->setModDepth01(volId, ms_lfo2, 0, 0, 0.5);
+        surge->process();
+
+        auto &plan = routings().voicePlan[0];
+        REQUIRE(routings().voice[0].size() == 3);
+        REQUIRE(plan.destination.size() == 3);
+        REQUIRE(plan.slotSource.size() == 2);
+        REQUIRE(plan.slot[0] == plan.slot[1]);
+        REQUIRE(plan.slot[0] != plan.slot[2]);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(plan.destination[i] == routings().voice[0][i].destination_id);
+            REQUIRE(plan.depth[i] == routings().voice[0][i].depth);
+        }
+
+        surge->muteModulation(cutoffId, ms_lfo1, 0, 0, true);
+        surge->process();
+
+        REQUIRE(routings().voice[0].size() == 3);
+        REQUIRE(routings().voicePlan[0].destination.size() == 2);
+        REQUIRE(routings().voicePlan[0].slotSource.size() == 2);
+    }
+}
+
+TEST_CASE("Unused Voice LFOs Start When First Used", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &scene = surge->storage.getPatch().scene[0];
+    auto &lf = scene.lfo[1];
+    lf.shape.val.i = lt_sine;
+    lf.trigmode.val.i = lm_keytrigger;
+    lf.rate.val.f = 4;
+
+    auto run = [&](int blocks) {
+        for (int i = 0; i < blocks; ++i)
+            surge->process();
+    };
+
+    surge->playNote(0, 60, 127, 0);
+    run(50);
+    REQUIRE(surge->voices[0].size() == 1);
+    auto *v = surge->voices[0].front();
+
+    surge->setModDepth01(scene.osc[0].pitch.id, ms_lfo2, 0, 0, 0.1);
+    run(2);
+
+    std::set<float> outputs;
+    for (int i = 0; i < 50; ++i)
+    {
+        run(1);
+        auto o = v->modsources[ms_lfo2]->get_output(0);
+        REQUIRE(std::fabs(o) <= 1.f);
+        outputs.insert(o);
+    }
+    REQUIRE(outputs.size() > 10);
+}
+
+TEST_CASE("Free Running Voice LFOs Are Shared Across Voices", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &scene = surge->storage.getPatch().scene[0];
+    auto &lf = scene.lfo[0];
+    auto pitchId = scene.osc[0].pitch.id;
+
+    lf.shape.val.i = lt_sine;
+    lf.trigmode.val.i = lm_freerun;
+    lf.delay.val.f = lf.delay.val_min.f;
+    lf.attack.val.f = lf.attack.val_min.f;
+    lf.hold.val.f = lf.hold.val_min.f;
+    lf.sustain.val.f = lf.sustain.val_max.f;
+    lf.release.val.f = lf.release.val_max.f;
+
+    auto run = [&](int blocks) {
+        for (int i = 0; i < blocks; ++i)
+            surge->process();
+    };
+
+    surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.1);
+    run(10);
+
+    surge->playNote(0, 60, 127, 0);
+    surge->playNote(0, 64, 127, 0);
+    surge->playNote(0, 67, 127, 0);
+    run(20);
+
+    REQUIRE(surge->voices[0].size() == 3);
+
+    SECTION("Voices Read The Scene Copy")
+    {
+        REQUIRE(scene.sharedVoiceLFO[0]);
+
+        for (auto *v : surge->voices[0])
+        {
+            REQUIRE(v->modsources[ms_lfo1] == scene.sharedVoiceLFO[0]);
+        }
+    }
+
+    SECTION("Shared And Per Voice Outputs Agree")
+    {
+        // a key triggered LFO started at the same time would differ, so compare a voice which
+        // is made to run its own copy against the shared one it just left
+        auto shared = scene.sharedVoiceLFO[0]->get_output(0);
+        auto rateId = lf.rate.id;
+
+        surge->setModDepth01(rateId, ms_velocity, 0, 0, 0.0001);
+        run(1);
+
+        REQUIRE(!scene.sharedVoiceLFO[0]);
+
+        std::set<ModulationSource *> own;
+        for (auto *v : surge->voices[0])
+        {
+            own.insert(v->modsources[ms_lfo1]);
+            REQUIRE(v->modsources[ms_lfo1]->get_output(0) == Approx(shared).margin(0.05));
+        }
+        REQUIRE(own.size() == 3);
+    }
+
+    SECTION("Key Triggered LFOs Are Not Shared")
+    {
+        lf.trigmode.val.i = lm_keytrigger;
+        run(1);
+
+        REQUIRE(!scene.sharedVoiceLFO[0]);
+
+        std::set<ModulationSource *> own;
+        for (auto *v : surge->voices[0])
+            own.insert(v->modsources[ms_lfo1]);
+        REQUIRE(own.size() == 3);
+    }
+
+    SECTION("An Envelope Stage Stops Sharing")
+    {
+        lf.attack.val.f = lf.attack.val_min.f + 1.f;
+        run(1);
+
+        REQUIRE(!scene.sharedVoiceLFO[0]);
+    }
+}
+
+TEST_CASE("Voice Local Copies Follow The Scene", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &scene = surge->storage.getPatch().scene[0];
+    auto cutoffId = scene.filterunit[0].cutoff.id;
+    auto panId = scene.pan.id;
+
+    surge->setModDepth01(cutoffId, ms_lfo1, 0, 0, 0.2);
+    surge->setModDepth01(panId, ms_modwheel, 0, 0, 0.3);
+    surge->playNote(0, 60, 127, 0);
+    surge->playNote(0, 67, 127, 0);
+
+    auto check = [&]() {
+        auto *sd = surge->storage.getPatch().scenedata[0];
+        auto &plan = surge->storage.audioModulationRoutings().voicePlan[0];
+
+        for (auto *v : surge->voices[0])
+        {
+            for (int i = 0; i < n_scene_params; ++i)
+            {
+                if (std::find(plan.destination.begin(), plan.destination.end(), i) ==
+                    plan.destination.end())
+                {
+                    INFO("scene param " << i);
+                    REQUIRE(v->localcopy[i].i == sd[i].i);
+                }
+            }
+        }
+    };
+
+    for (int b = 0; b < 200; ++b)
+    {
+        // move some plain parameters, a scene modulated one and the modulation itself
+        if (b % 7 == 0)
+            scene.filterunit[0].resonance.val.f = (b % 3) * 0.3f;
+        if (b % 11 == 0)
+            scene.osc[1].pitch.val.f = (b % 5) - 2.f;
+        if (b % 13 == 0)
+            surge->channelController(0, 1, b % 2 ? 100 : 0);
+        if (b == 120)
+            surge->clearModulation(cutoffId, ms_lfo1, 0, 0, false);
+
+        surge->process();
+        check();
+    }
+
+    REQUIRE(surge->voices[0].size() == 2);
+}
+
+TEST_CASE("Scene Modulators Are Held By Type In The Synth", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    using SM = SurgeSynthesizer::SceneModulators;
+
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        auto &scene = surge->storage.getPatch().scene[s];
+        auto &mods = surge->sceneModulators[s];
+
+        for (int i = 0; i < std::size(SM::controllerIds); ++i)
+            REQUIRE(scene.modsources[SM::controllerIds[i]] == &mods.controllers[i]);
+        for (int i = 0; i < std::size(SM::keyIds); ++i)
+            REQUIRE(scene.modsources[SM::keyIds[i]] == &mods.keys[i]);
+        REQUIRE(scene.modsources[ms_pitchbend] == &mods.pitchbend);
+        for (int i = 0; i < std::size(SM::randomIds); ++i)
+        {
+            REQUIRE(scene.modsources[SM::randomIds[i]] == &mods.randoms[i]);
+            REQUIRE(mods.randoms[i].bipolar == (SM::randomIds[i] == ms_random_bipolar));
+        }
+        for (int i = 0; i < n_lfos_scene; ++i)
+            REQUIRE(scene.modsources[ms_slfo1 + i] == &mods.lfos[i]);
+        for (int i = 0; i < n_customcontrollers; ++i)
+            REQUIRE(scene.modsources[ms_ctrl1 + i] == &surge->macros[i]);
+    }
+
+    // and they still get processed
+    auto panId = surge->storage.getPatch().scene[0].pan.id;
+    surge->setModDepth01(panId, ms_modwheel, 0, 0, 0.5);
+    surge->playNote(0, 60, 127, 0);
+    surge->channelController(0, 1, 127);
+    for (int i = 0; i < 200; ++i)
+        surge->process();
+    REQUIRE(surge->sceneModulators[0].controllers[0].get_output(0) == Approx(1.f).margin(1e-3));
+}
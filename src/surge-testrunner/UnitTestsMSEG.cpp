@@ -542,6 +542,90 @@ TEST_CASE("Zero Size Loops", "[mseg]")
     }
 }
 
+TEST_CASE("Cached Segment Curves", "[mseg]")
+{
+    SECTION("Cached And Recomputed Curves Agree")
+    {
+        MSEGStorage ms;
+        ms.n_activeSegments = 12;
+        ms.endpointMode = MSEGStorage::EndpointMode::LOCKED;
+        ms.loopMode = MSEGStorage::LoopMode::LOOP;
+
+        MSEGStorage::segment::Type types[] = {
+            MSEGStorage::segment::LINEAR,     MSEGStorage::segment::SCURVE,
+            MSEGStorage::segment::SINE,       MSEGStorage::segment::STAIRS,
+            MSEGStorage::segment::SQUARE,     MSEGStorage::segment::TRIANGLE,
+            MSEGStorage::segment::HOLD,       MSEGStorage::segment::SAWTOOTH,
+            MSEGStorage::segment::BUMP,       MSEGStorage::segment::SMOOTH_STAIRS,
+            MSEGStorage::segment::QUAD_BEZIER, MSEGStorage::segment::LINEAR};
+
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            ms.segments[i].duration = 0.1 + 0.05 * (i % 3);
+            ms.segments[i].type = types[i];
+            ms.segments[i].v0 = (i % 2 ? -0.7 : 0.8);
+        }
+
+        resetCP(&ms);
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            ms.segments[i].cpv = -0.9 + 0.15 * i;
+        }
+        Surge::MSEG::rebuildCache(&ms);
+
+        for (auto df : {0.f, -0.6f, 0.45f})
+        {
+            auto cached = runMSEG(&ms, 0.0123, 4, df);
+
+            auto stale = ms;
+            for (auto &c : stale.segmentCurves)
+                c.cpv = -100;
+
+            auto recomputed = runMSEG(&stale, 0.0123, 4, df);
+
+            REQUIRE(cached.size() == recomputed.size());
+            for (int i = 0; i < cached.size(); ++i)
+            {
+                REQUIRE(cached[i].v == recomputed[i].v);
+            }
+        }
+    }
+
+    SECTION("Long MSEGs Find The Same Segments")
+    {
+        MSEGStorage ms;
+        ms.n_activeSegments = max_msegs;
+
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            // include some zero length segments, which a search has to step over
+            ms.segments[i].duration = (i % 7 == 3) ? 0 : 0.01 + 0.003 * (i % 5);
+            ms.segments[i].type = MSEGStorage::segment::LINEAR;
+            ms.segments[i].v0 = 0;
+        }
+        ms.loop_start = 20;
+        ms.loop_end = 90;
+
+        resetCP(&ms);
+        Surge::MSEG::rebuildCache(&ms);
+
+        for (auto ignoreLoops : {true, false})
+        {
+            for (double t = 0; t < ms.totalDuration * 3; t += 0.00731)
+            {
+                float along = -1;
+                auto idx = Surge::MSEG::timeToSegment(&ms, t, ignoreLoops, along);
+
+                INFO("t=" << t << " ignoreLoops=" << ignoreLoops);
+                REQUIRE(idx >= 0);
+                REQUIRE(ms.segments[idx].duration > 0);
+                REQUIRE(along >= 0);
+                REQUIRE(along <= ms.segments[idx].duration + 1e-5);
+            }
+        }
+    }
+}
+
 /*
  * Tests to add
  * - loop point 0 (start = end + 1)
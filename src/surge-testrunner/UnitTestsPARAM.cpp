@@ -73,3 +73,73 @@ TEST_CASE("Param String Inversion", "[param]")
 #endif
     }
 }
+
+TEST_CASE("Parameter Display Text Follows Its Inputs", "[param]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+    auto &patch = surge->storage.getPatch();
+
+    SECTION("Value And Flags")
+    {
+        auto &p = patch.scene[0].filterunit[0].cutoff;
+
+        p.val.f = 0;
+        auto a = p.get_display();
+        REQUIRE(p.get_display() == a);
+
+        p.val.f = 12;
+        auto b = p.get_display();
+        REQUIRE(b != a);
+
+        p.val.f = 0;
+        REQUIRE(p.get_display() == a);
+
+        char txt[TXT_SIZE];
+        p.get_display(txt);
+        REQUIRE(std::string(txt) == a);
+
+        auto &rate = patch.scene[0].lfo[0].rate;
+        auto unsynced = rate.get_display();
+        rate.temposync = true;
+        REQUIRE(rate.get_display() != unsynced);
+        rate.temposync = false;
+        REQUIRE(rate.get_display() == unsynced);
+    }
+
+    SECTION("Host Values")
+    {
+        auto &p = patch.scene[0].filterunit[0].cutoff;
+
+        auto current = p.get_display();
+        auto lo = p.get_display(true, 0.25f);
+        auto hi = p.get_display(true, 0.75f);
+        REQUIRE(lo != hi);
+        REQUIRE(p.get_display(true, 0.25f) == lo);
+        REQUIRE(p.get_display() == current);
+    }
+
+    SECTION("Another Parameter's Type")
+    {
+        auto &fu = patch.scene[0].filterunit[0];
+
+        fu.type.val.i = sst::filters::fut_lp12;
+        fu.subtype.val.i = 0;
+        auto lp = fu.subtype.get_display();
+
+        fu.type.val.i = sst::filters::fut_comb_pos;
+        REQUIRE(fu.subtype.get_display() != lp);
+    }
+
+    SECTION("Copies Start Afresh")
+    {
+        auto &p = patch.scene[0].filterunit[0].cutoff;
+        p.val.f = 0;
+        auto a = p.get_display();
+
+        Parameter q = p;
+        q.val.f = 12;
+        REQUIRE(q.get_display() != a);
+        REQUIRE(p.get_display() == a);
+    }
+}
@@ -0,0 +1,241 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "HeadlessUtils.h"
+#include "Player.h"
+#include "ClassicOscillator.h"
+
+#include "catch2/catch_amalgamated.hpp"
+
+#include "UnitTestUtilities.h"
+
+/*
+ * The performance gate. A fixed handful of engine workloads are timed, each over repeated runs
+ * after a warm up, and the median of each is compared with a baseline. A workload fails if
+ * it is both more than the tolerance slower than its baseline and slower by more than the
+ * noise of the two measurements can explain.
+ *
+ * The test is hidden, so a plain run (and catch_discover_tests) skips it. Configuring with
+ * -DSURGE_PERF_GATE=ON adds it to ctest as surge-perf-gate. It reads
+ *
+ *   SURGE_PERF_BASELINE   the baseline json; workloads missing from it are reported, not gated
+ *   SURGE_PERF_RESULTS    if set, where to write this run's results, in the baseline's format
+ *   SURGE_PERF_TOLERANCE  the fraction a median may grow before it counts; default 0.1
+ *
+ * Timings only compare on the same machine, so a baseline is made by the machine which gates
+ * against it, by running with SURGE_PERF_RESULTS pointing at the baseline file.
+ */
+namespace
+{
+struct Workload
+{
+    std::string name;
+    std::function<std::shared_ptr<SurgeSynthesizer>()> setup;
+};
+
+struct Timing
+{
+    double medianUS{0}, madUS{0};
+};
+
+static constexpr int sr = 48000;
+static constexpr int warmRuns = 3, timedRuns = 15, blocksPerRun = 200;
+
+std::shared_ptr<SurgeSynthesizer> withNotes(std::shared_ptr<SurgeSynthesizer> surge, int voices)
+{
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+    for (int v = 0; v < voices; ++v)
+        surge->playNote(0, 48 + v, 100, 0);
+    return surge;
+}
+
+std::shared_ptr<SurgeSynthesizer> withOscillator(int type, int voices)
+{
+    auto surge = Surge::Headless::createSurge(sr);
+    auto &osc = surge->storage.getPatch().scene[0].osc[0];
+    osc.type.val.i = type;
+    surge->storage.getPatch().update_controls(false, &osc);
+    return withNotes(surge, voices);
+}
+
+std::vector<Workload> workloads()
+{
+    return {
+        {"init patch, 1 voice", []() { return withNotes(Surge::Headless::createSurge(sr), 1); }},
+        {"init patch, 16 voices",
+         []() { return withNotes(Surge::Headless::createSurge(sr), 16); }},
+        {"classic unison 16, 4 voices",
+         []() {
+             auto surge = Surge::Headless::createSurge(sr);
+             auto &osc = surge->storage.getPatch().scene[0].osc[0];
+             osc.type.val.i = ot_classic;
+             surge->storage.getPatch().update_controls(false, &osc);
+             osc.p[ClassicOscillator::co_unison_voices].val.i = 16;
+             return withNotes(surge, 4);
+         }},
+        {"modern, 8 voices", []() { return withOscillator(ot_modern, 8); }},
+        {"string, 8 voices", []() { return withOscillator(ot_string, 8); }},
+        {"twist, 8 voices", []() { return withOscillator(ot_twist, 8); }},
+        {"vintage ladder, 8 voices",
+         []() {
+             auto surge = Surge::Headless::createSurge(sr);
+             surge->storage.getPatch().scene[0].filterunit[0].type.val.i =
+                 sst::filters::fut_vintageladder;
+             return withNotes(surge, 8);
+         }},
+        {"reverb 2 and chorus, 4 voices",
+         []() {
+             auto surge = Surge::Headless::createSurge(sr);
+             Surge::Test::setFX(surge, 0, fxt_chorus4);
+             Surge::Test::setFX(surge, 1, fxt_reverb2);
+             return withNotes(surge, 4);
+         }},
+    };
+}
+
+Timing timeWorkload(const Workload &w)
+{
+    auto surge = w.setup();
+
+    auto run = [&surge]() {
+        auto st = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocksPerRun; ++b)
+            surge->process();
+        auto en = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(en - st).count() / blocksPerRun;
+    };
+
+    for (int i = 0; i < warmRuns; ++i)
+        run();
+
+    std::vector<double> t(timedRuns);
+    for (auto &v : t)
+        v = run();
+
+    auto median = [](std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        auto n = v.size();
+        return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+    };
+
+    Timing res;
+    res.medianUS = median(t);
+    for (auto &v : t)
+        v = std::fabs(v - res.medianUS);
+    res.madUS = median(t);
+    return res;
+}
+
+// the baseline is exactly what writeResults writes, one workload per line
+std::map<std::string, Timing> readBaseline(const std::string &path)
+{
+    std::map<std::string, Timing> res;
+    std::ifstream in(path);
+    std::string line;
+    std::regex entry(R"re(^\s*"([^"]+)"\s*:\s*\{\s*"median_us"\s*:\s*([-+.eE0-9]+)\s*,)re"
+                     R"re(\s*"mad_us"\s*:\s*([-+.eE0-9]+)\s*\})re");
+
+    while (std::getline(in, line))
+    {
+        std::smatch m;
+        if (std::regex_search(line, m, entry))
+            res[m[1]] = {std::atof(m[2].str().c_str()), std::atof(m[3].str().c_str())};
+    }
+    return res;
+}
+
+void writeResults(const std::string &path, const std::vector<std::pair<std::string, Timing>> &r)
+{
+    std::ofstream out(path);
+    out << std::setprecision(6) << "{\n";
+    for (size_t i = 0; i < r.size(); ++i)
+    {
+        out << "  \"" << r[i].first << "\": {\"median_us\": " << r[i].second.medianUS
+            << ", \"mad_us\": " << r[i].second.madUS << "}" << (i + 1 < r.size() ? "," : "")
+            << "\n";
+    }
+    out << "}\n";
+}
+} // namespace
+
+TEST_CASE("Performance Gate", "[.perf-gate]")
+{
+    auto env = [](const char *n) -> std::string {
+        auto v = getenv(n);
+        return v ? v : "";
+    };
+
+    auto baselinePath = env("SURGE_PERF_BASELINE");
+    auto resultsPath = env("SURGE_PERF_RESULTS");
+    auto tolerance = env("SURGE_PERF_TOLERANCE").empty()
+                         ? 0.1
+                         : std::atof(env("SURGE_PERF_TOLERANCE").c_str());
+
+    auto baseline = readBaseline(baselinePath);
+    if (baseline.empty())
+        WARN("No baseline read from '" << baselinePath << "'; timing without gating");
+
+    std::vector<std::pair<std::string, Timing>> results;
+    for (const auto &w : workloads())
+    {
+        auto t = timeWorkload(w);
+        results.emplace_back(w.name, t);
+
+        auto b = baseline.find(w.name);
+        if (b == baseline.end())
+        {
+            WARN(w.name << ": " << t.medianUS << "us, no baseline");
+            continue;
+        }
+
+        /*
+         * 1.4826 * MAD estimates the standard deviation of normal noise, and the medians are
+         * each of timedRuns runs, so three of those standard errors is well past chance.
+         */
+        const auto &base = b->second;
+        auto noise = 3 * 1.4826 * std::hypot(t.madUS, base.madUS) / std::sqrt(timedRuns);
+        auto slower = t.medianUS - base.medianUS;
+        bool regressed = slower > tolerance * base.medianUS && slower > noise;
+
+        UNSCOPED_INFO(w.name << ": " << t.medianUS << "us against " << base.medianUS << "us ("
+                             << std::showpos << 100.0 * slower / base.medianUS << std::noshowpos
+                             << "%)");
+        CHECK_FALSE(regressed);
+    }
+
+    if (!resultsPath.empty())
+        writeResults(resultsPath, results);
+}
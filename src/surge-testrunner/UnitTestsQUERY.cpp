@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include "PatchDB.h"
+#include "SurgeStorage.h"
 
 #include "catch2/catch_amalgamated.hpp"
 
@@ -180,4 +181,29 @@ TEST_CASE("SQL Generation", "[query]")
         REQUIRE(s ==
                 "( ( p.search_over LIKE '%in''it''%' ) AND ( p.search_over LIKE '%''''sine%' ) )");
     }
-}
\ No newline at end of file
+}
+TEST_CASE("One PatchDB Per Process", "[query]")
+{
+    auto a = std::make_unique<SurgeStorage>(SurgeStorage::skipPatchLoadDataPathSentinel);
+    auto b = std::make_unique<SurgeStorage>(SurgeStorage::skipPatchLoadDataPathSentinel);
+
+    auto db = a->patchDB;
+    REQUIRE(db);
+    REQUIRE(b->patchDB == db);
+
+    // fresh from the registry, unless an earlier test already indexed this database
+    db->claimIndexing(false);
+    REQUIRE(!db->claimIndexing(false));
+    REQUIRE(db->claimIndexing(true));
+
+    using PDB = Surge::PatchStorage::PatchDB;
+    REQUIRE(PDB::channelFor(a.get(), "search") != PDB::channelFor(b.get(), "search"));
+
+    // the database outlives the storage which made it and stays usable for the other
+    a.reset();
+    REQUIRE(b->patchDB == db);
+    REQUIRE(db->numberOfJobsOutstanding() == 0);
+
+    b.reset();
+    REQUIRE(db->numberOfJobsOutstanding() == 0);
+}
@@ -32,6 +32,7 @@
 #include "Tunings.h"
 
 #include "UnitTestUtilities.h"
+#include "RetuningCache.h"
 
 using namespace Surge::Test;
 
@@ -150,6 +151,40 @@ TEST_CASE("Notes at Appropriate Frequencies", "[tun]")
     }
 }
 
+TEST_CASE("Block Pitch Lookups Match Single Ones", "[tun]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    // odd counts exercise the scalar tail; the range runs past both ends of the tables
+    std::vector<float> notes;
+    for (float n = -300.f; n < 300.f; n += 0.37f)
+        notes.push_back(n);
+    notes.push_back(60.f);
+    std::vector<float> block(notes.size()), blockInv(notes.size());
+
+    auto check = [&]() {
+        surge->storage.note_to_pitch_block(notes.data(), block.data(), (int)notes.size());
+        surge->storage.note_to_pitch_inv_block(notes.data(), blockInv.data(), (int)notes.size());
+        for (size_t i = 0; i < notes.size(); ++i)
+        {
+            INFO("note " << notes[i]);
+            REQUIRE(block[i] == Approx(surge->storage.note_to_pitch(notes[i])).epsilon(1e-6));
+            REQUIRE(blockInv[i] ==
+                    Approx(surge->storage.note_to_pitch_inv(notes[i])).epsilon(1e-6));
+        }
+    };
+
+    SECTION("Standard Tuning") { check(); }
+
+    SECTION("Zeus 22")
+    {
+        Tunings::Scale s = Tunings::readSCLFile("resources/test-data/scl/zeus22.scl");
+        surge->storage.retuneToScale(s);
+        check();
+    }
+}
+
 TEST_CASE("KBM File Parsing", "[tun]")
 {
     SECTION("Default Keyboard is Default")
@@ -1725,4 +1760,133 @@ TEST_CASE("Portamento With Repeated Notes", "[tun]")
                     Approx(surge->storage.currentTuning.frequencyForMidiNote(31 * 3)).margin(2));
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Retuning Cache", "[tun]")
+{
+    using rc_t = Surge::Storage::RetuningCache;
+    auto cache = std::make_unique<rc_t>();
+    int calls = 0;
+    auto compute = [&calls](float v) {
+        return [&calls, v]() {
+            calls++;
+            return v;
+        };
+    };
+
+    SECTION("Repeated Lookups Hit Within A Block")
+    {
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 60, 0, compute(0.25f)) == 0.25f);
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 60, 0, compute(0.5f)) == 0.25f);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("Key, Channel and Lookup Are Distinct")
+    {
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 60, 0, compute(1.f)) == 1.f);
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 61, 0, compute(2.f)) == 2.f);
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 60, 1, compute(3.f)) == 3.f);
+        REQUIRE(cache->get(rc_t::midiOnlyKeyRemap, 60, 0, compute(4.f)) == 4.f);
+        REQUIRE(cache->get(rc_t::mtsRetuningInSemitones, 60.5f, 0, compute(5.f)) == 5.f);
+        REQUIRE(calls == 5);
+    }
+
+    SECTION("Next Block Invalidates")
+    {
+        REQUIRE(cache->get(rc_t::midiOnlyKeyRemap, 64, 2, compute(7.f)) == 7.f);
+        cache->nextBlock();
+        REQUIRE(cache->get(rc_t::midiOnlyKeyRemap, 64, 2, compute(8.f)) == 8.f);
+        REQUIRE(calls == 2);
+    }
+}
+
+TEST_CASE("MTS Retuning Table", "[tun]")
+{
+    using mt_t = Surge::Storage::MTSRetuningTable;
+    auto table = std::make_unique<mt_t>();
+    int calls = 0;
+    auto compute = [&calls](float v) {
+        return [&calls, v]() {
+            calls++;
+            return v;
+        };
+    };
+
+    SECTION("Entries Live For The Refresh Interval")
+    {
+        REQUIRE(table->get(60, 0, compute(0.25f)) == 0.25f);
+        for (uint32_t i = 1; i < mt_t::refreshBlocks; ++i)
+        {
+            table->nextBlock();
+            REQUIRE(table->get(60, 0, compute(0.5f)) == 0.25f);
+        }
+        REQUIRE(calls == 1);
+
+        table->nextBlock();
+        REQUIRE(table->get(60, 0, compute(0.5f)) == 0.5f);
+        REQUIRE(calls == 2);
+    }
+
+    SECTION("Notes And Channels Are Distinct")
+    {
+        REQUIRE(table->get(60, 0, compute(1.f)) == 1.f);
+        REQUIRE(table->get(61, 0, compute(2.f)) == 2.f);
+        REQUIRE(table->get(60, 1, compute(3.f)) == 3.f);
+        REQUIRE(table->get(60, 0, compute(4.f)) == 1.f);
+        REQUIRE(calls == 3);
+    }
+
+    SECTION("Invalidate Clears At The Next Block")
+    {
+        REQUIRE(table->get(64, 2, compute(7.f)) == 7.f);
+        table->invalidate();
+        REQUIRE(table->get(64, 2, compute(8.f)) == 7.f);
+        table->nextBlock();
+        REQUIRE(table->get(64, 2, compute(9.f)) == 9.f);
+        REQUIRE(calls == 2);
+    }
+}
+
+TEST_CASE("Retuning Swaps At The Block Start", "[tun]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+    auto &storage = surge->storage;
+    storage.tuningApplicationMode = SurgeStorage::RETUNE_ALL;
+
+    auto et12 = storage.table_pitch[256 + 61];
+    auto zeus = Tunings::readSCLFile("resources/test-data/scl/zeus22.scl");
+    auto six = Tunings::readSCLFile("resources/test-data/scl/6-exact.scl");
+
+    SECTION("Offline The Tables Change At Once")
+    {
+        storage.retuneToScale(zeus);
+        REQUIRE(storage.table_pitch[256 + 61] != et12);
+    }
+
+    SECTION("In Realtime They Wait For The Next Block")
+    {
+        storage.swapTuningAtBlockStart = true;
+
+        storage.retuneToScale(zeus);
+        REQUIRE(storage.table_pitch[256 + 61] == et12);
+        auto expectZeus = storage.currentTuning.frequencyForMidiNoteScaledByMidi0(61);
+
+        surge->process();
+        REQUIRE(storage.table_pitch[256 + 61] == Approx(expectZeus));
+
+        // two retunings within a block leave only the last to be taken
+        storage.retuneToScale(six);
+        auto expectSix = storage.currentTuning.frequencyForMidiNoteScaledByMidi0(61);
+        storage.retuneTo12TETScale();
+        storage.retuneToScale(six);
+        REQUIRE(storage.table_pitch[256 + 61] == Approx(expectZeus));
+
+        surge->process();
+        REQUIRE(storage.table_pitch[256 + 61] == Approx(expectSix));
+        for (int i = 1; i < SurgeStorage::tuning_table_size; ++i)
+            REQUIRE(storage.table_pitch_inv[i] == Approx(1.f / storage.table_pitch[i]));
+
+        surge->process();
+        REQUIRE(storage.table_pitch[256 + 61] == Approx(expectSix));
+    }
+}
@@ -327,3 +327,421 @@ TEST_CASE("Play and release Frequency and Note ID", "[voice]")
         }
     }
 }
+
+TEST_CASE("Multithreaded Scene Rendering", "[voice]")
+{
+    SECTION("Dual Scene Voices Play and Free")
+    {
+        auto s = surgeOnSine();
+        s->storage.getPatch().scenemode.val.i = sm_dual;
+        s->setMultithreadedSceneRendering(true);
+        REQUIRE(s->getMultithreadedSceneRendering());
+
+        auto proc = [&s]() {
+            float rms = 0;
+            for (int i = 0; i < 20; ++i)
+            {
+                s->process();
+                for (int j = 0; j < BLOCK_SIZE; ++j)
+                {
+                    REQUIRE(std::isfinite(s->output[0][j]));
+                    rms += s->output[0][j] * s->output[0][j];
+                }
+            }
+            return rms;
+        };
+
+        proc();
+
+        for (auto k : {60, 64, 67})
+            s->playNote(0, k, 127, 0);
+        REQUIRE(proc() > 0);
+        REQUIRE(s->voices[0].size() == 3);
+        REQUIRE(s->voices[1].size() == 3);
+
+        for (auto k : {60, 64, 67})
+            s->releaseNote(0, k, 0);
+
+        int blocks = 0;
+        while (!(s->voices[0].empty() && s->voices[1].empty()) && blocks < 10000)
+        {
+            s->process();
+            blocks++;
+        }
+        REQUIRE(s->voices[0].empty());
+        REQUIRE(s->voices[1].empty());
+
+        s->setMultithreadedSceneRendering(false);
+    }
+}
+
+namespace
+{
+// runs each batch backwards across two threads of its own, as a host's pool might
+struct TestBatchRunner : Surge::Threading::ExternalBatchRunner
+{
+    int batches{0};
+    bool runBatch(int nTasks, Surge::Threading::WorkerPool::taskFn_t fn, void *ctx) override
+    {
+        batches++;
+        std::atomic<int> next{nTasks - 1};
+        auto work = [&]() {
+            int i;
+            while ((i = next--) >= 0)
+                fn(ctx, i);
+        };
+        std::thread other(work);
+        work();
+        other.join();
+        return true;
+    }
+};
+} // namespace
+
+TEST_CASE("Multithreaded Voice Rendering", "[voice]")
+{
+    TestBatchRunner runner;
+
+    auto render = [&runner](bool threaded, bool external) {
+        auto s = surgeOnSine();
+        s->storage.getPatch().scene[0].osc[0].p[n_osc_params - 1].val.i = 7; // unison voices
+        s->setMultithreadedVoiceRendering(threaded);
+        s->externalBatchRunner = external ? &runner : nullptr;
+        s->storage.rngGen.g.seed(2112);
+
+        std::vector<float> res;
+        for (int k = 48; k < 72; k += 2)
+            s->playNote(0, k, 100, 0);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            if (i == 100)
+            {
+                for (int k = 48; k < 72; k += 4)
+                    s->releaseNote(0, k, 0);
+            }
+            s->process();
+            for (int j = 0; j < BLOCK_SIZE; ++j)
+            {
+                res.push_back(s->output[0][j]);
+                res.push_back(s->output[1][j]);
+            }
+        }
+        return res;
+    };
+
+    auto a = render(true, false);
+    auto b = render(true, false);
+    auto serial = render(false, false);
+    auto hosted = render(true, true);
+
+    REQUIRE(a.size() == b.size());
+    REQUIRE(a.size() == serial.size());
+    REQUIRE(a.size() == hosted.size());
+    REQUIRE(runner.batches > 0);
+
+    float rms = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        REQUIRE(a[i] == b[i]);
+        REQUIRE(a[i] == hosted[i]);
+        REQUIRE(a[i] == Approx(serial[i]).margin(1e-5));
+        rms += a[i] * a[i];
+    }
+    REQUIRE(rms > 0);
+}
+
+TEST_CASE("Note On Sample Offset", "[voice]")
+{
+    for (auto offset : {0, 1, 13, BLOCK_SIZE - 1})
+    {
+        DYNAMIC_SECTION("Note Starts At Sample " << offset)
+        {
+            auto s = surgeOnSine();
+            REQUIRE(s);
+
+            for (int i = 0; i < 10; ++i)
+                s->process();
+
+            s->noteOnSampleOffset = offset;
+            s->playNote(0, 60, 127, 0);
+            s->noteOnSampleOffset = 0;
+
+            s->process();
+
+            for (int i = 0; i < offset; ++i)
+            {
+                REQUIRE(s->output[0][i] == 0.f);
+                REQUIRE(s->output[1][i] == 0.f);
+            }
+
+            bool sounded = false;
+            for (int b = 0; b < 2; ++b)
+            {
+                for (int i = (b == 0 ? offset : 0); i < BLOCK_SIZE; ++i)
+                    sounded = sounded || s->output[0][i] != 0.f;
+                s->process();
+            }
+            REQUIRE(sounded);
+        }
+    }
+}
+
+TEST_CASE("Static Filters Skip Coefficient Recalculation", "[voice]")
+{
+    auto s = surgeOnSine();
+    REQUIRE(s);
+
+    auto &fu = s->storage.getPatch().scene[0].filterunit[0];
+    fu.type.val.i = sst::filters::fut_lp12;
+    fu.subtype.val.i = 0;
+    fu.envmod.val.f = 0.f;
+    fu.keytrack.val.f = 0.f;
+
+    for (int i = 0; i < 10; ++i)
+        s->process();
+
+    s->playNote(0, 60, 127, 0);
+
+    for (int i = 0; i < 200; ++i)
+        s->process();
+
+    REQUIRE(!s->voices[0].empty());
+    auto v = s->voices[0].front();
+
+    // with nothing moving the cutoff the smoother settles and stays settled
+    REQUIRE(v->filterCoefficientsSettled(0));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s->process();
+        REQUIRE(v->filterCoefficientsSettled(0));
+    }
+
+    fu.cutoff.val.f += 12.f;
+    s->process();
+    REQUIRE(!v->filterCoefficientsSettled(0));
+}
+
+TEST_CASE("Polyphonic Modulation By Note ID", "[voice]")
+{
+    auto s = surgeOnSine();
+    REQUIRE(s);
+
+    auto voiceFor = [&s](int32_t nid) -> SurgeVoice * {
+        for (auto v : s->voices[0])
+            if (v->host_note_id == nid)
+                return v;
+        return nullptr;
+    };
+
+    auto *p = &s->storage.getPatch().scene[0].filterunit[0].cutoff;
+    auto range = p->val_max.f - p->val_min.f;
+
+    s->playNote(0, 60, 127, 0, 101);
+    s->playNote(0, 64, 127, 0, 102);
+    s->process();
+    REQUIRE(voiceFor(101));
+    REQUIRE(voiceFor(102));
+
+    for (int i = 1; i <= 100; ++i)
+        s->applyParameterPolyphonicModulation(p, 102, -1, -1, 0.001f * i);
+
+    REQUIRE(voiceFor(101)->paramModulationCount == 0);
+    REQUIRE(voiceFor(102)->paramModulationCount == 1);
+    REQUIRE(voiceFor(102)->polyphonicParamModulations[0].value == Approx(0.1 * range));
+
+    // an unknown id touches nothing, and a wildcard id still matches by key
+    s->applyParameterPolyphonicModulation(p, 999, -1, -1, 0.5f);
+    REQUIRE(voiceFor(101)->paramModulationCount == 0);
+    s->applyParameterPolyphonicModulation(p, -1, 60, -1, 0.2f);
+    REQUIRE(voiceFor(101)->paramModulationCount == 1);
+    REQUIRE(voiceFor(101)->polyphonicParamModulations[0].value == Approx(0.2 * range));
+
+    // the mono modulation is backed out of the poly value
+    s->applyParameterMonophonicModulation(p, 0.05f);
+    s->applyParameterMonophonicModulation(p, 0.1f);
+    REQUIRE(s->storage.getPatch().paramModulationCount == 1);
+    s->applyParameterPolyphonicModulation(p, 102, -1, -1, 0.3f);
+    REQUIRE(voiceFor(102)->polyphonicParamModulations[0].value == Approx(0.2 * range));
+
+    // voices which are freed and replaced are found under their new ids
+    s->releaseNoteByHostNoteID(101, 0);
+    s->releaseNoteByHostNoteID(102, 0);
+    for (int i = 0; i < 10000 && !s->voices[0].empty(); ++i)
+        s->process();
+    REQUIRE(s->voices[0].empty());
+
+    s->playNote(0, 67, 127, 0, 103);
+    s->process();
+    s->applyParameterPolyphonicModulation(p, 102, -1, -1, 0.5f);
+    s->applyParameterPolyphonicModulation(p, 103, -1, -1, 0.4f);
+    REQUIRE(voiceFor(103)->paramModulationCount == 1);
+    REQUIRE(voiceFor(103)->polyphonicParamModulations[0].value == Approx(0.3 * range));
+}
+
+TEST_CASE("Note Expressions By Channel And Key", "[voice]")
+{
+    auto s = surgeOnSine();
+    REQUIRE(s);
+
+    auto voiceOn = [&s](int ch, int key) -> SurgeVoice * {
+        for (auto v : s->voices[0])
+            if (v->state.channel == ch && v->state.key == key && v->state.gate)
+                return v;
+        return nullptr;
+    };
+
+    s->playNote(0, 60, 127, 0, 201);
+    s->playNote(1, 60, 127, 0, 202);
+    s->process();
+    REQUIRE(voiceOn(0, 60));
+    REQUIRE(voiceOn(1, 60));
+
+    s->setNoteExpression(SurgeVoice::TIMBRE, -1, 60, 1, 0.7f);
+    REQUIRE(voiceOn(0, 60)->noteExpressions[SurgeVoice::TIMBRE] == 0.f);
+    REQUIRE(voiceOn(1, 60)->noteExpressions[SurgeVoice::TIMBRE] == 0.7f);
+
+    s->setNoteExpression(SurgeVoice::PRESSURE, 201, -1, -1, 0.4f);
+    REQUIRE(voiceOn(0, 60)->noteExpressions[SurgeVoice::PRESSURE] == 0.4f);
+    REQUIRE(voiceOn(1, 60)->noteExpressions[SurgeVoice::PRESSURE] == 0.f);
+
+    // releasing by channel and key only touches that voice
+    s->releaseNote(1, 60, 0);
+    s->process();
+    REQUIRE(voiceOn(0, 60));
+    REQUIRE(!voiceOn(1, 60));
+    s->releaseNote(0, 60, 0);
+    for (int i = 0; i < 10000 && !s->voices[0].empty(); ++i)
+        s->process();
+    REQUIRE(s->voices[0].empty());
+
+    // a mono legato moves the voice to a new key, and expressions follow it there
+    s->storage.getPatch().scene[0].polymode.val.i = pm_mono;
+    s->playNote(0, 60, 127, 0, -1);
+    s->process();
+    s->playNote(0, 64, 127, 0, -1);
+    s->process();
+    REQUIRE(s->voices[0].size() == 1);
+    REQUIRE(voiceOn(0, 64));
+
+    s->setNoteExpression(SurgeVoice::VOLUME, -1, 64, 0, 0.25f);
+    REQUIRE(voiceOn(0, 64)->noteExpressions[SurgeVoice::VOLUME] == 0.25f);
+}
+
+TEST_CASE("Silent Released Voices End Early", "[voice]")
+{
+    for (auto db : {0, -96})
+    {
+        DYNAMIC_SECTION("Threshold " << db)
+        {
+            auto s = surgeOnSine();
+            REQUIRE(s);
+            s->setSilentVoiceThresholdDb(db);
+
+            // a muted oscillator with an eight second release
+            s->storage.getPatch().scene[0].mute_o1.val.b = true;
+            s->storage.getPatch().scene[0].adsr[0].r.val.f = 3.f;
+
+            int quarterSecond = (int)(0.25 * s->storage.samplerate / BLOCK_SIZE);
+
+            s->playNote(0, 60, 127, 0);
+            for (int i = 0; i < quarterSecond; ++i)
+                s->process();
+            // held voices are never ended however quiet they are
+            REQUIRE(s->voices[0].size() == 1);
+
+            s->releaseNote(0, 60, 0);
+            for (int i = 0; i < quarterSecond; ++i)
+                s->process();
+            REQUIRE(s->voices[0].size() == (db < 0 ? 0 : 1));
+        }
+    }
+}
+
+TEST_CASE("Voices Share Unmodulated Filter Coefficients", "[voice]")
+{
+    auto s = surgeOnSine();
+    REQUIRE(s);
+
+    auto &fu = s->storage.getPatch().scene[0].filterunit[0];
+    fu.type.val.i = sst::filters::fut_lp24;
+    fu.subtype.val.i = 1;
+    fu.cutoff.val.f = -12.f;
+    fu.resonance.val.f = 0.6f;
+    fu.keytrack.val.f = 0.f;
+    fu.envmod.val.f = 0.f;
+
+    for (auto k : {48, 55, 60})
+        s->playNote(0, k, 100, 0);
+    for (int i = 0; i < 10; ++i)
+        s->process();
+
+    auto &shared = s->storage.getPatch().scene[0].sharedFilterCoeffs[0];
+    REQUIRE(shared.valid);
+
+    sst::filters::FilterCoefficientMaker<SurgeStorage> cm;
+    cm.setSampleRateAndBlockSize((float)s->storage.dsamplerate_os, BLOCK_SIZE_OS);
+    cm.MakeCoeffs(-12.f, 0.6f, sst::filters::fut_lp24, (sst::filters::FilterSubType)1,
+                  &s->storage, fu.cutoff.extend_range);
+    for (int i = 0; i < sst::filters::n_cm_coeffs; ++i)
+        REQUIRE(shared.C[i] == cm.C[i]);
+
+    // every key has a cutoff of its own once it tracks the keyboard
+    fu.keytrack.val.f = 1.f;
+    s->process();
+    REQUIRE(!shared.valid);
+}
+
+TEST_CASE("Frozen Hits Replay Exactly", "[voice]")
+{
+    auto makeDrum = [](int freezeMB) {
+        auto s = surgeOnSine();
+        REQUIRE(s);
+        s->setFreezeVoicesBudgetMB(freezeMB);
+
+        auto &sc = s->storage.getPatch().scene[0];
+        sc.osc[0].retrigger.val.b = true;
+        sc.adsr[0].a.val.f = sc.adsr[0].a.val_min.f;
+        sc.adsr[0].d.val.f = -4.f;
+        sc.adsr[0].s.val.f = 0.f;
+        sc.adsr[0].r.val.f = -4.f;
+        return s;
+    };
+
+    auto frozen = makeDrum(16);
+    auto live = makeDrum(0);
+    REQUIRE(frozen->frozenHits);
+
+    auto hit = [](std::shared_ptr<SurgeSynthesizer> s, std::vector<float> &out) {
+        out.clear();
+        s->playNote(0, 60, 100, 0);
+        for (int i = 0; i < 200; ++i)
+        {
+            if (i == 20)
+                s->releaseNote(0, 60, 0);
+            s->process();
+            out.insert(out.end(), s->output[0], s->output[0] + BLOCK_SIZE);
+        }
+        REQUIRE(s->voices[0].empty());
+    };
+
+    std::vector<float> f, l;
+    for (int h = 0; h < 2; ++h)
+    {
+        hit(frozen, f);
+        hit(live, l);
+        REQUIRE(f == l);
+    }
+    REQUIRE(frozen->frozenHits->recordings == 1);
+    REQUIRE(frozen->frozenHits->replays == 1);
+
+    // an oscillator change drops the recording
+    frozen->storage.getPatch().scene[0].osc[0].pitch.val.f = 7.f;
+    live->storage.getPatch().scene[0].osc[0].pitch.val.f = 7.f;
+    hit(frozen, f);
+    hit(live, l);
+    REQUIRE(f == l);
+    REQUIRE(frozen->frozenHits->recordings == 2);
+    REQUIRE(frozen->frozenHits->replays == 1);
+}
@@ -51,6 +51,34 @@ int main(int argc, char **argv)
         {
             Surge::Headless::NonTest::statsFromPlayingEveryPatch();
         }
+        if (strcmp(argv[2], "--cpu-every-patch") == 0)
+        {
+            if (argc < 4)
+            {
+                std::cout << "Usage: --cpu-every-patch report.tsv [baseline.tsv [percent]]\n";
+                return 1;
+            }
+            return Surge::Headless::NonTest::cpuCostOfEveryPatch(
+                argv[3], argc > 4 ? argv[4] : "", argc > 5 ? std::atof(argv[5]) : 10.f);
+        }
+        if (strcmp(argv[2], "--scaling-benchmark") == 0)
+        {
+            if (argc < 4)
+            {
+                std::cout << "Usage: --scaling-benchmark out.json [maxInstances]\n";
+                return 1;
+            }
+            Surge::Headless::NonTest::scalingBenchmark(argv[3], argc > 4 ? std::atoi(argv[4]) : 0);
+        }
+        if (strcmp(argv[2], "--startup-benchmark") == 0)
+        {
+            if (argc < 4)
+            {
+                std::cout << "Usage: --startup-benchmark out.json\n";
+                return 1;
+            }
+            Surge::Headless::NonTest::startupBenchmark(argv[3]);
+        }
         if (strcmp(argv[2], "--restream-templates") == 0)
         {
             Surge::Headless::NonTest::restreamTemplatesWithModifications();
@@ -87,6 +115,15 @@ int main(int argc, char **argv)
                 << "   --non-test --stats-from-every-patch    # play every patch and show RMS\n"
                 << "   --non-test --filter-analyzer ft fst    # analyze filter type/subtype for "
                    "response\n"
+                << "   --non-test --cpu-every-patch out.tsv [baseline.tsv [pct]]\n"
+                << "                                          # time every patch, flag those "
+                   "slower than baseline by pct\n"
+                << "   --non-test --scaling-benchmark out.json [n]\n"
+                << "                                          # time voices, unison and up to n "
+                   "instances\n"
+                << "   --non-test --startup-benchmark out.json\n"
+                << "                                          # time startup phases and loading "
+                   "every factory patch\n"
                 << "\n"
                 << "If you exclude the `--non-test` argument, standard catch2 arguments, below, "
                    "apply\n\n";
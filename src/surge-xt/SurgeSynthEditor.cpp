@@ -138,6 +138,8 @@ static std::mutex surgeLookAndFeelSetupMutex;
 SurgeSynthEditor::SurgeSynthEditor(SurgeSynthProcessor &p)
     : juce::AudioProcessorEditor(&p), processor(p)
 {
+    processor.editorIsOpen = true;
+
     {
         std::lock_guard<std::mutex> grd(surgeLookAndFeelSetupMutex);
         if (auto sp = surgeLookAndFeelWeakPointer.lock())
@@ -259,11 +261,24 @@ SurgeSynthEditor::SurgeSynthEditor(SurgeSynthProcessor &p)
 
     idleTimer = std::make_unique<IdleTimer>(this);
     idleTimer->startTimer(1000 / 60);
+
+#if SURGE_USE_OPENGL
+    if (juce::Desktop::getInstance().isHeadless() == false)
+    {
+        openGLContext.setComponentPaintingEnabled(true);
+        openGLContext.setContinuousRepainting(false);
+        openGLContext.attachTo(*this);
+    }
+#endif
 }
 
 SurgeSynthEditor::~SurgeSynthEditor()
 {
+    processor.editorIsOpen = false;
     idleTimer->stopTimer();
+#if SURGE_USE_OPENGL
+    openGLContext.detach();
+#endif
     sge->close();
 
     if (sge->bitmapStore)
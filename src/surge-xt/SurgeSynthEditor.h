@@ -27,6 +27,9 @@
 #include "SkinSupport.h"
 
 #include "juce_audio_utils/juce_audio_utils.h"
+#if SURGE_USE_OPENGL
+#include "juce_opengl/juce_opengl.h"
+#endif
 
 #include <forward_list>
 #include "version.h"
@@ -95,6 +98,11 @@ class SurgeSynthEditor : public juce::AudioProcessorEditor,
     void idle();
 
     std::unique_ptr<IdleTimer> idleTimer;
+
+#if SURGE_USE_OPENGL
+    // composites the whole editor, meters included, on the GPU rather than in software
+    juce::OpenGLContext openGLContext;
+#endif
     bool drawExtendedControls{false};
     int midiKeyboardOctave{5};
     float midiKeyboardVelocity{127.f / 127.f}; // see issue #6409
@@ -41,6 +41,31 @@
  */
 #include "gui/UndoManager.h"
 
+namespace
+{
+/*
+ * Runs are either a whole block, which is the usual case and which a fixed size copy does
+ * best, or the short pieces at the ends of a host buffer that isn't a multiple of BLOCK_SIZE
+ */
+inline void copyRun(float *dst, const float *src, int n)
+{
+    if (n == BLOCK_SIZE)
+        memcpy(dst, src, BLOCK_SIZE * sizeof(float));
+    else
+        memcpy(dst, src, n * sizeof(float));
+}
+
+inline bool isSilentRun(const float *d, int n)
+{
+    if (!d)
+        return true;
+    for (int i = 0; i < n; ++i)
+        if (d[i] != 0.f)
+            return false;
+    return true;
+}
+} // namespace
+
 //==============================================================================
 SurgeSynthProcessor::SurgeSynthProcessor()
     : juce::AudioProcessor(BusesProperties()
@@ -77,6 +102,9 @@ SurgeSynthProcessor::SurgeSynthProcessor()
         return;
     }
 
+    // the host's audio thread takes retunings at the top of a block, see acquireTuningTables
+    surge->storage.swapTuningAtBlockStart = true;
+
 #if BUILD_IS_DEBUG
     oss << "  - Data         : " << surge->storage.datapath.u8string() << "\n"
         << "  - User Data    : " << surge->storage.userDataPath.u8string() << std::endl;
@@ -155,10 +183,22 @@ SurgeSynthProcessor::SurgeSynthProcessor()
 
     midiKeyboardState.addListener(this);
     oscHandler.initOSC(this, surge);
+
+#if HAS_CLAP_JUCE_EXTENSIONS
+    if (is_clap)
+    {
+        sleepWakeTimer.ssp = this;
+        sleepWakeTimer.startTimer(50);
+    }
+#endif
 }
 
 SurgeSynthProcessor::~SurgeSynthProcessor()
 {
+#if HAS_CLAP_JUCE_EXTENSIONS
+    sleepWakeTimer.stopTimer();
+#endif
+
     if (!surge)
     {
         return;
@@ -182,7 +222,52 @@ bool SurgeSynthProcessor::producesMidi() const { return false; }
 
 bool SurgeSynthProcessor::isMidiEffect() const { return false; }
 
-double SurgeSynthProcessor::getTailLengthSeconds() const { return 2.0; }
+double SurgeSynthProcessor::getTailLengthSeconds() const { return tailLengthSeconds; }
+
+uint32_t SurgeSynthProcessor::voiceCount() const
+{
+    auto &patch = surge->storage.getPatch();
+    uint32_t res = 0;
+
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        if (patch.scenemode.val.i == sm_single && patch.scene_active.val.i != sc)
+            continue;
+
+        // the polyphony limit applies to each scene, and every other play mode is monophonic
+        res += (patch.scene[sc].polymode.val.i == pm_poly) ? patch.polylimit.val.i : 1;
+    }
+
+    return std::min(res, (uint32_t)(n_scenes * MAX_VOICES));
+}
+
+void SurgeSynthProcessor::updateHostEngineState()
+{
+    auto tail = surge->getTailLengthSeconds();
+    if (tail < 0)
+        tail = std::numeric_limits<double>::infinity();
+
+    // envelope and tempo changes nudge this about, so only bother the host with real changes
+    auto prior = tailLengthSeconds.load();
+    auto tailMoved = std::isinf(tail) ? !std::isinf(prior)
+                                      : (std::isinf(prior) || std::fabs(tail - prior) > 0.01);
+
+    auto voices = voiceCount();
+    auto voicesMoved = voices != reportedVoiceCount;
+
+    tailLengthSeconds = tail;
+    reportedVoiceCount = voices;
+
+#if HAS_CLAP_JUCE_EXTENSIONS
+    if (is_clap)
+    {
+        if (tailMoved)
+            tailChanged();
+        if (voicesMoved)
+            voiceInfoChanged();
+    }
+#endif
+}
 
 int SurgeSynthProcessor::getNumPrograms()
 {
@@ -534,6 +619,9 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     }
 
     priorCallWasProcessBlockNotBypassed = true;
+    surge->setHostCallbackDeadline(buffer.getNumSamples());
+
+    processBlockRenderMode();
 
     // Make sure we have a main output
     auto mb = getBus(false, 0);
@@ -623,25 +711,61 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         incR = mainInput.getReadPointer(1);
     }
 
-    auto sc = buffer.getNumSamples();
-    if (!inputIsLatent && (sc & ~(BLOCK_SIZE - 1)) != sc)
+    checkInputAlignment(incL != nullptr, buffer.getNumSamples());
+
+    float *outL = mainOutput.getWritePointer(0), *outR = mainOutput.getWritePointer(1);
+    float *sAL{nullptr}, *sAR{nullptr}, *sBL{nullptr}, *sBR{nullptr};
+
+    if (sceneAOutput.getNumChannels() == 2)
     {
-        surge->storage.reportError(
-            fmt::format("Incoming audio input block is not a multiple of {sz} samples.\n"
-                        "If audio input is used, it will be delayed by {sz} samples, in order to "
-                        "compensate.\n"
-                        "This can be avoided by setting the DAW to use fixed buffer sizes, if "
-                        "possible.",
-                        fmt::arg("sz", BLOCK_SIZE)),
-            "Audio Input Latency Activated", SurgeStorage::AUDIO_INPUT_LATENCY_WARNING, false);
-        inputIsLatent = true;
+        sAL = sceneAOutput.getWritePointer(0);
+        sAR = sceneAOutput.getWritePointer(1);
     }
 
-    for (int i = 0; i < buffer.getNumSamples(); i++)
+    if (sceneBOutput.getNumChannels() == 2)
+    {
+        sBL = sceneBOutput.getWritePointer(0);
+        sBR = sceneBOutput.getWritePointer(1);
+    }
+
+    /*
+     * Go a run at a time, each run ending at the end of the current internal block or of
+     * the host buffer, whichever comes first. When the host buffer is a multiple of BLOCK_SIZE
+     * every run is a whole block; otherwise only the first and last runs are short.
+     */
+    const int numSamples = buffer.getNumSamples();
+    int i = 0;
+
+    /*
+     * Everything applied before a block renders goes through the coalescer, so a burst of
+     * updates to one controller only lands once. With sample accurate note ons, each note keeps
+     * its offset into the block.
+     */
+    auto applyQueuedMidi = [this, &i]() {
+        midiCoalescer.flush([this, &i](const auto &e) {
+            if (surge->sampleAccurateNoteOns)
+                surge->noteOnSampleOffset = std::max(e.samplePosition - i, 0);
+
+            applyMidi(juce::MidiMessageMetadata(e.data, e.size, e.samplePosition));
+        });
+
+        surge->noteOnSampleOffset = 0;
+    };
+
+    auto queueMidi = [this, &applyQueuedMidi](const juce::MidiMessageMetadata &m) {
+        if (!midiCoalescer.add(m.data, m.numBytes, m.samplePosition))
+        {
+            applyQueuedMidi();
+            midiCoalescer.add(m.data, m.numBytes, m.samplePosition);
+        }
+    };
+
+    while (i < numSamples)
     {
-        while (i == nextMidi)
+        // anything which arrived during the last run is applied before the next block renders
+        while (nextMidi >= 0 && nextMidi <= i)
         {
-            applyMidi(*midiIt);
+            queueMidi(*midiIt);
             midiIt++;
 
             if (midiIt == midiMessages.cend())
@@ -654,8 +778,31 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
             }
         }
 
-        auto outL = mainOutput.getWritePointer(0, i);
-        auto outR = mainOutput.getWritePointer(1, i);
+        if (blockPos == 0 && surge->sampleAccurateNoteOns)
+        {
+            // bring the rest of this block's events forward, keeping their note on positions
+            while (nextMidi >= 0 && nextMidi < i + BLOCK_SIZE)
+            {
+                queueMidi(*midiIt);
+                midiIt++;
+
+                if (midiIt == midiMessages.cend())
+                {
+                    nextMidi = -1;
+                }
+                else
+                {
+                    nextMidi = (*midiIt).samplePosition;
+                }
+            }
+        }
+
+        applyQueuedMidi();
+
+        if (blockPos == 0)
+        {
+            processScheduledOSC(i);
+        }
 
         if (blockPos == 0 && incL && incR)
         {
@@ -687,43 +834,34 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                 (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
         }
 
+        auto n = std::min(BLOCK_SIZE - blockPos, numSamples - i);
+
         if (inputIsLatent && incL && incR)
         {
-            inputLatentBuffer[0][blockPos] = incL[i];
-            inputLatentBuffer[1][blockPos] = incR[i];
+            copyRun(&inputLatentBuffer[0][blockPos], incL + i, n);
+            copyRun(&inputLatentBuffer[1][blockPos], incR + i, n);
         }
 
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
+        copyRun(outL + i, &surge->output[0][blockPos], n);
+        copyRun(outR + i, &surge->output[1][blockPos], n);
 
         if (surge->activateExtraOutputs)
         {
-            if (sceneAOutput.getNumChannels() == 2)
+            if (sAL && sAR)
             {
-                auto sAL = sceneAOutput.getWritePointer(0, i);
-                auto sAR = sceneAOutput.getWritePointer(1, i);
-
-                if (sAL && sAR)
-                {
-                    *sAL = surge->sceneout[0][0][blockPos];
-                    *sAR = surge->sceneout[0][1][blockPos];
-                }
+                copyRun(sAL + i, &surge->sceneout[0][0][blockPos], n);
+                copyRun(sAR + i, &surge->sceneout[0][1][blockPos], n);
             }
 
-            if (sceneBOutput.getNumChannels() == 2)
+            if (sBL && sBR)
             {
-                auto sBL = sceneBOutput.getWritePointer(0, i);
-                auto sBR = sceneBOutput.getWritePointer(1, i);
-
-                if (sBL && sBR)
-                {
-                    *sBL = surge->sceneout[1][0][blockPos];
-                    *sBR = surge->sceneout[1][1][blockPos];
-                }
+                copyRun(sBL + i, &surge->sceneout[1][0][blockPos], n);
+                copyRun(sBR + i, &surge->sceneout[1][1][blockPos], n);
             }
         }
 
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
+        blockPos = (blockPos + n) & (BLOCK_SIZE - 1);
+        i += n;
     }
 
     // This should, in theory, never happen, but better safe than sorry
@@ -736,6 +874,14 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     processBlockPostFunction();
 }
 
+void SurgeSynthProcessor::processBlockRenderMode()
+{
+    // an offline bounce can take the time, and should sound the same every time
+    auto offline = isNonRealtime();
+    surge->storage.wavetableMipmapBuilder.buildInBackground = !offline;
+    surge->setOfflineRendering(offline);
+}
+
 void SurgeSynthProcessor::processBlockPlayhead()
 {
     auto playhead = getPlayHead();
@@ -807,240 +953,330 @@ void SurgeSynthProcessor::processBlockMidiFromGUI()
 
 void SurgeSynthProcessor::processBlockOSC()
 {
+    oscBufferStartTime = oscWallClockNow();
+
     while (true)
     {
         auto om = oscRingBuf.pop();
         if (!om.has_value())
             break; // no data waiting; return
-        switch (om->type)
+
+        // Bundles timed for later wait for their sample, see processScheduledOSC
+        if (om->dueTime > oscBufferStartTime && scheduledOSCCount < maxScheduledOSC)
         {
-        case SurgeSynthProcessor::MNOTE:
+            scheduledOSC[scheduledOSCCount++] = *om;
+            continue;
+        }
+
+        applyOSC(*om);
+    }
+}
+
+void SurgeSynthProcessor::processScheduledOSC(int bufferPos)
+{
+    if (scheduledOSCCount == 0)
+        return;
+
+    const auto sr = surge->storage.samplerate;
+    int kept = 0;
+
+    // in arrival order, so a bundle's messages keep their order when they share a time
+    for (int k = 0; k < scheduledOSCCount; ++k)
+    {
+        auto &om = scheduledOSC[k];
+        auto pos = (int64_t)((om.dueTime - oscBufferStartTime) * sr);
+
+        if (pos < bufferPos + BLOCK_SIZE)
         {
-            if (om->on)
-                surge->playNote(0, om->char0, om->char1, 0, om->noteid);
-            else
-                surge->releaseNoteByHostNoteID(om->noteid, om->char1);
+            if (surge->sampleAccurateNoteOns)
+                surge->noteOnSampleOffset = (int)std::clamp(pos - bufferPos, (int64_t)0,
+                                                            (int64_t)BLOCK_SIZE - 1);
+
+            applyOSC(om);
         }
-        break;
+        else
+        {
+            scheduledOSC[kept++] = om;
+        }
+    }
+
+    scheduledOSCCount = kept;
+    surge->noteOnSampleOffset = 0;
+}
+
+double SurgeSynthProcessor::oscWallClockNow()
+{
+    using namespace std::chrono;
+    return duration<double>(system_clock::now().time_since_epoch()).count();
+}
 
-        case SurgeSynthProcessor::FREQNOTE:
+void SurgeSynthProcessor::applyOSC(const oscToAudio &om)
+{
+    switch (om.type)
+    {
+    case SurgeSynthProcessor::MNOTE:
+    {
+        if (om.on)
+            surge->playNote(0, om.char0, om.char1, 0, om.noteid);
+        else
+            surge->releaseNoteByHostNoteID(om.noteid, om.char1);
+    }
+    break;
+
+    case SurgeSynthProcessor::FREQNOTE:
+    {
+        if (om.on)
+            surge->playNoteByFrequency(om.fval, om.char1, om.noteid);
+        else
         {
-            if (om->on)
-                surge->playNoteByFrequency(om->fval, om->char1, om->noteid);
-            else
-            {
-                surge->releaseNoteByHostNoteID(om->noteid, om->char1);
-            }
+            surge->releaseNoteByHostNoteID(om.noteid, om.char1);
         }
+    }
+    break;
+
+    case SurgeSynthProcessor::NOTEX_PITCH:
+        surge->setNoteExpression(SurgeVoice::PITCH, om.noteid, -1, -1, om.fval);
         break;
 
-        case SurgeSynthProcessor::NOTEX_PITCH:
-            surge->setNoteExpression(SurgeVoice::PITCH, om->noteid, -1, -1, om->fval);
-            break;
+    case SurgeSynthProcessor::NOTEX_VOL:
+        surge->setNoteExpression(SurgeVoice::VOLUME, om.noteid, -1, -1, om.fval);
+        break;
 
-        case SurgeSynthProcessor::NOTEX_VOL:
-            surge->setNoteExpression(SurgeVoice::VOLUME, om->noteid, -1, -1, om->fval);
-            break;
+    case SurgeSynthProcessor::NOTEX_PAN:
+        surge->setNoteExpression(SurgeVoice::PAN, om.noteid, -1, -1, om.fval);
+        break;
 
-        case SurgeSynthProcessor::NOTEX_PAN:
-            surge->setNoteExpression(SurgeVoice::PAN, om->noteid, -1, -1, om->fval);
-            break;
+    case SurgeSynthProcessor::NOTEX_PRES:
+        surge->setNoteExpression(SurgeVoice::PRESSURE, om.noteid, -1, -1, om.fval);
+        break;
 
-        case SurgeSynthProcessor::NOTEX_PRES:
-            surge->setNoteExpression(SurgeVoice::PRESSURE, om->noteid, -1, -1, om->fval);
-            break;
+    case SurgeSynthProcessor::NOTEX_TIMB:
+        surge->setNoteExpression(SurgeVoice::TIMBRE, om.noteid, -1, -1, om.fval);
+        break;
 
-        case SurgeSynthProcessor::NOTEX_TIMB:
-            surge->setNoteExpression(SurgeVoice::TIMBRE, om->noteid, -1, -1, om->fval);
-            break;
+    case SurgeSynthProcessor::PITCHBEND:
+        surge->pitchBend(om.char0, om.ival);
+        break;
 
-        case SurgeSynthProcessor::PITCHBEND:
-            surge->pitchBend(om->char0, om->ival);
-            break;
+    case SurgeSynthProcessor::CC:
+        surge->channelController(om.char0, om.char1, om.ival);
+        break;
 
-        case SurgeSynthProcessor::CC:
-            surge->channelController(om->char0, om->char1, om->ival);
-            break;
+    case SurgeSynthProcessor::CHAN_ATOUCH:
+        surge->channelAftertouch(om.char0, om.ival);
+        break;
 
-        case SurgeSynthProcessor::CHAN_ATOUCH:
-            surge->channelAftertouch(om->char0, om->ival);
-            break;
+    case SurgeSynthProcessor::POLY_ATOUCH:
+        surge->polyAftertouch(om.char0, (int)om.char1, om.ival);
+        break;
 
-        case SurgeSynthProcessor::POLY_ATOUCH:
-            surge->polyAftertouch(om->char0, (int)om->char1, om->ival);
-            break;
+    case SurgeSynthProcessor::PARAMETER:
+    {
+        float pval = om.fval;
+        if (om.param->valtype == vt_int)
+            pval = Parameter::intScaledToFloat(om.fval, om.param->val_max.i,
+                                               om.param->val_min.i);
+
+        surge->setParameter01(surge->idForParameter(om.param), pval, true);
+        surge->storage.getPatch().isDirty = true;
+
+        // Special cases: A few control types require a rebuild and
+        // SGE Value Callbacks would do it as would the VST3 param handler
+        // so put them here for now. Bit of a hack...
+        auto ct = om.param->ctrltype;
+        if (ct == ct_bool_solo || ct == ct_bool_mute || ct == ct_scenesel)
+            surge->refresh_editor = true;
+        else
+            surge->queueForRefresh(om.param->id);
+    }
+    break;
+
+    case SurgeSynthProcessor::MACRO:
+    {
+        surge->setMacroParameter01(om.ival, om.fval);
+    }
+    break;
+
+    case SurgeSynthProcessor::ALLNOTESOFF:
+    {
+        surge->allNotesOff();
+    }
+    break;
+
+    case SurgeSynthProcessor::ALLSOUNDOFF:
+    {
+        surge->allSoundOff();
+    }
+    break;
 
-        case SurgeSynthProcessor::PARAMETER:
+    case SurgeSynthProcessor::MOD:
+    {
+        surge->setModDepth01(om.param->id, (modsources)om.ival, om.scene, om.index,
+                             om.fval);
+    }
+    break;
+
+    case SurgeSynthProcessor::MOD_MUTE:
+    {
+        bool mute = om.fval > 0.0;
+        surge->muteModulation(om.param->id, (modsources)om.ival, om.scene, om.index, mute);
+    }
+    break;
+
+    case SurgeSynthProcessor::FX_DISABLE:
+    {
+        int selected_mask = om.ival;
+        int curmask = surge->storage.getPatch().fx_disable.val.i;
+        int msk = selected_mask;
+        int newDisabledMask = 0;
+        if (om.on == 0) // set selected bit to zero
         {
-            float pval = om->fval;
-            if (om->param->valtype == vt_int)
-                pval = Parameter::intScaledToFloat(om->fval, om->param->val_max.i,
-                                                   om->param->val_min.i);
+            msk = ~(msk & 0) ^ selected_mask; // all bits to 1 except selected bit
+            newDisabledMask = curmask & msk;
+        }
+        else // set selected bit to one
+            newDisabledMask = curmask | msk;
 
-            surge->setParameter01(surge->idForParameter(om->param), pval, true);
-            surge->storage.getPatch().isDirty = true;
+        surge->storage.getPatch().fx_disable.val.i = newDisabledMask;
+        surge->fx_suspend_bitmask = newDisabledMask;
+        surge->storage.getPatch().isDirty = true;
+        surge->refresh_editor = true;
+    }
+    break;
 
-            // Special cases: A few control types require a rebuild and
-            // SGE Value Callbacks would do it as would the VST3 param handler
-            // so put them here for now. Bit of a hack...
-            auto ct = om->param->ctrltype;
-            if (ct == ct_bool_solo || ct == ct_bool_mute || ct == ct_scenesel)
-                surge->refresh_editor = true;
-            else
-                surge->queueForRefresh(om->param->id);
+    case SurgeSynthProcessor::ABSOLUTE_X:
+        if (om.param->absolute != (bool)om.on)
+        {
+            om.param->absolute = om.on;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::MACRO:
+    case SurgeSynthProcessor::TEMPOSYNC_X:
+        if (om.param->temposync != (bool)om.on)
         {
-            surge->setMacroParameter01(om->ival, om->fval);
+            om.param->temposync = om.on;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::ALLNOTESOFF:
+    case SurgeSynthProcessor::ENABLE_X:
+    {
+        // This parameter is stored as 'disabled', but UI uses 'enabled',
+        //  so logic is flipped here:
+        bool disabled = !om.on;
+        if (om.param->deactivated != disabled)
         {
-            surge->allNotesOff();
+            om.param->deactivated = disabled;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
-        break;
+    }
+    break;
 
-        case SurgeSynthProcessor::ALLSOUNDOFF:
+    case SurgeSynthProcessor::EXTEND_X:
+        if (om.param->extend_range != om.on)
         {
-            surge->allSoundOff();
+            om.param->extend_range = om.on;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::MOD:
+    case SurgeSynthProcessor::DEFORM_X:
+        if (om.param->deform_type != om.ival)
         {
-            surge->setModDepth01(om->param->id, (modsources)om->ival, om->scene, om->index,
-                                 om->fval);
+            om.param->deform_type = om.ival;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::MOD_MUTE:
+    case SurgeSynthProcessor::PORTA_CONSTRATE_X:
+        if (om.param->porta_constrate != om.on)
         {
-            bool mute = om->fval > 0.0;
-            surge->muteModulation(om->param->id, (modsources)om->ival, om->scene, om->index, mute);
+            om.param->porta_constrate = om.on;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::FX_DISABLE:
+    case SurgeSynthProcessor::PORTA_GLISS_X:
+        if (om.param->porta_gliss != om.on)
         {
-            int selected_mask = om->ival;
-            int curmask = surge->storage.getPatch().fx_disable.val.i;
-            int msk = selected_mask;
-            int newDisabledMask = 0;
-            if (om->on == 0) // set selected bit to zero
-            {
-                msk = ~(msk & 0) ^ selected_mask; // all bits to 1 except selected bit
-                newDisabledMask = curmask & msk;
-            }
-            else // set selected bit to one
-                newDisabledMask = curmask | msk;
-
-            surge->storage.getPatch().fx_disable.val.i = newDisabledMask;
-            surge->fx_suspend_bitmask = newDisabledMask;
+            om.param->porta_gliss = om.on;
             surge->storage.getPatch().isDirty = true;
-            surge->refresh_editor = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::ABSOLUTE_X:
-            if (om->param->absolute != (bool)om->on)
-            {
-                om->param->absolute = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
-
-        case SurgeSynthProcessor::TEMPOSYNC_X:
-            if (om->param->temposync != (bool)om->on)
-            {
-                om->param->temposync = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
-
-        case SurgeSynthProcessor::ENABLE_X:
+    case SurgeSynthProcessor::PORTA_RETRIGGER_X:
+        if (om.param->porta_retrigger != om.on)
         {
-            // This parameter is stored as 'disabled', but UI uses 'enabled',
-            //  so logic is flipped here:
-            bool disabled = !om->on;
-            if (om->param->deactivated != disabled)
-            {
-                om->param->deactivated = disabled;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
+            om.param->porta_retrigger = om.on;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
         }
         break;
 
-        case SurgeSynthProcessor::EXTEND_X:
-            if (om->param->extend_range != om->on)
-            {
-                om->param->extend_range = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
-
-        case SurgeSynthProcessor::DEFORM_X:
-            if (om->param->deform_type != om->ival)
-            {
-                om->param->deform_type = om->ival;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
+    case SurgeSynthProcessor::PORTA_CURVE_X:
+        if (om.param->porta_curve != om.ival)
+        {
+            om.param->porta_curve = om.ival;
+            surge->storage.getPatch().isDirty = true;
+            surge->queueForRefresh(om.param->id);
+        }
+        break;
 
-        case SurgeSynthProcessor::PORTA_CONSTRATE_X:
-            if (om->param->porta_constrate != om->on)
-            {
-                om->param->porta_constrate = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
+    default:
+        break;
+    }
+}
 
-        case SurgeSynthProcessor::PORTA_GLISS_X:
-            if (om->param->porta_gliss != om->on)
-            {
-                om->param->porta_gliss = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
+void SurgeSynthProcessor::checkInputAlignment(bool hasInput, int numSamples)
+{
+    /*
+     * Input renders with no latency as long as every host buffer starts on one of our block
+     * boundaries. The first time one doesn't we have to hold a block of input back, and stay
+     * that way; the latency is reported to the host from processBlockPostFunction. Without an
+     * input connected, the output alone never needs delaying.
+     */
+    if (inputIsLatent || !hasInput)
+        return;
 
-        case SurgeSynthProcessor::PORTA_RETRIGGER_X:
-            if (om->param->porta_retrigger != om->on)
-            {
-                om->param->porta_retrigger = om->on;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
+    if ((numSamples & (BLOCK_SIZE - 1)) == 0 && blockPos == 0)
+        return;
 
-        case SurgeSynthProcessor::PORTA_CURVE_X:
-            if (om->param->porta_curve != om->ival)
-            {
-                om->param->porta_curve = om->ival;
-                surge->storage.getPatch().isDirty = true;
-                surge->queueForRefresh(om->param->id);
-            }
-            break;
+    surge->storage.reportError(
+        fmt::format("Incoming audio input block is not a multiple of {sz} samples.\n"
+                    "If audio input is used, it will be delayed by {sz} samples, in order to "
+                    "compensate.\n"
+                    "This can be avoided by setting the DAW to use fixed buffer sizes, if "
+                    "possible.",
+                    fmt::arg("sz", BLOCK_SIZE)),
+        "Audio Input Latency Activated", SurgeStorage::AUDIO_INPUT_LATENCY_WARNING, false);
 
-        default:
-            break;
-        }
-    }
+    memset(inputLatentBuffer, 0, sizeof(inputLatentBuffer));
+    inputIsLatent = true;
 }
 
 void SurgeSynthProcessor::processBlockPostFunction()
 {
+    auto latency = (inputIsLatent ? BLOCK_SIZE : 0) +
+                   surge->fxLatencySamples.load(std::memory_order_relaxed);
+
+    if (getLatencySamples() != latency)
+    {
+        setLatencySamples(latency);
+    }
+
     if (checkNamesEvery++ > 10)
     {
         checkNamesEvery = 0;
+        updateHostEngineState();
+
         if (std::atomic_exchange(&parameterNameUpdated, false))
         {
             updateHostDisplay(
@@ -1073,7 +1309,13 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
         surge->stopSound();
     }
     surge->audio_processing_active = true;
+    hostProcessSleeping = false;
+
+    hostThreadPoolRunner.ssp = this;
+    surge->externalBatchRunner = &hostThreadPoolRunner;
+    surge->setHostCallbackDeadline((int)process->frames_count);
 
+    processBlockRenderMode();
     processBlockPlayhead();
     processBlockMidiFromGUI();
     processBlockOSC();
@@ -1108,6 +1350,8 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
         if (process->audio_inputs[0].channel_count == 2)
             inR = process->audio_inputs[0].data32[1];
     }
+
+    checkInputAlignment(inL && inR, process->frames_count);
     if (process->audio_outputs_count == 3 && process->audio_outputs[1].channel_count == 2 &&
         process->audio_outputs[2].channel_count == 2)
     {
@@ -1121,7 +1365,23 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
             haveSceneOut = false;
     }
 
-    for (int s = 0; s < process->frames_count; ++s)
+    // a run at a time, as in processBlock
+    const int numFrames = process->frames_count;
+    int s = 0;
+
+    // whether any of what we hand back came from a block which actually had sound in it
+    bool renderedSound = blockPos != 0 && !surge->outputSilent;
+
+    auto applyQueuedMidi = [this, &s]() {
+        midiCoalescer.flush([this, &s](const auto &e) {
+            if (surge->sampleAccurateNoteOns)
+                surge->noteOnSampleOffset = std::max(e.samplePosition - s, 0);
+
+            applyMidi(juce::MidiMessageMetadata(e.data, e.size, e.samplePosition));
+        });
+    };
+
+    while (s < numFrames)
     {
         if (blockPos == 0)
         {
@@ -1129,7 +1389,28 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
             {
                 auto evt = ev->get(ev, currev);
 
-                process_clap_event(evt);
+                // raw MIDI is coalesced as in processBlock; anything else is a barrier
+                if (evt->space_id == CLAP_CORE_EVENT_SPACE_ID && evt->type == CLAP_EVENT_MIDI)
+                {
+                    auto mevt = reinterpret_cast<const clap_event_midi *>(evt);
+                    auto sz = juce::MidiMessage::getMessageLengthFromFirstByte(mevt->data[0]);
+                    jassert(sz <= 3 && sz > 0);
+
+                    if (!midiCoalescer.add(mevt->data, sz, (int)evt->time))
+                    {
+                        applyQueuedMidi();
+                        midiCoalescer.add(mevt->data, sz, (int)evt->time);
+                    }
+                }
+                else
+                {
+                    applyQueuedMidi();
+
+                    if (surge->sampleAccurateNoteOns)
+                        surge->noteOnSampleOffset = std::max((int)evt->time - s, 0);
+
+                    process_clap_event(evt);
+                }
 
                 currev++;
                 if (currev < evtsz)
@@ -1141,18 +1422,27 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
                     nextevtime = -1;
                 }
             }
+
+            applyQueuedMidi();
+            surge->noteOnSampleOffset = 0;
+
+            processScheduledOSC(s);
         }
 
         if (blockPos == 0)
         {
-            if (inL && inR)
+            if (inL && inR && inputIsLatent)
             {
-                memcpy(&(surge->input[0][0]), inL, BLOCK_SIZE * sizeof(float));
-                memcpy(&(surge->input[1][0]), inR, BLOCK_SIZE * sizeof(float));
-                inL += BLOCK_SIZE;
-                inR += BLOCK_SIZE;
+                memcpy(&(surge->input[0][0]), inputLatentBuffer[0], BLOCK_SIZE * sizeof(float));
+                memcpy(&(surge->input[1][0]), inputLatentBuffer[1], BLOCK_SIZE * sizeof(float));
+            }
+            else if (inL && inR)
+            {
+                memcpy(&(surge->input[0][0]), inL + s, BLOCK_SIZE * sizeof(float));
+                memcpy(&(surge->input[1][0]), inR + s, BLOCK_SIZE * sizeof(float));
             }
             surge->process();
+            renderedSound = renderedSound || !surge->outputSilent;
             surge->time_data.ppqPos +=
                 (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
 
@@ -1178,27 +1468,35 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
                 }
             }
         }
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
-        outL++;
-        outR++;
 
-        if (haveSceneOut)
+        auto n = std::min(BLOCK_SIZE - blockPos, numFrames - s);
+
+        if (inputIsLatent && inL && inR)
         {
-            *sceneAL = surge->sceneout[0][0][blockPos];
-            *sceneAR = surge->sceneout[0][1][blockPos];
-            *sceneBL = surge->sceneout[1][0][blockPos];
-            *sceneBR = surge->sceneout[1][1][blockPos];
-
-            sceneAL++;
-            sceneAR++;
-            sceneBL++;
-            sceneBR++;
+            copyRun(&inputLatentBuffer[0][blockPos], inL + s, n);
+            copyRun(&inputLatentBuffer[1][blockPos], inR + s, n);
         }
 
-        // TO DO: Scene Output
+        copyRun(outL, &surge->output[0][blockPos], n);
+        copyRun(outR, &surge->output[1][blockPos], n);
+        outL += n;
+        outR += n;
 
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
+        if (haveSceneOut)
+        {
+            copyRun(sceneAL, &surge->sceneout[0][0][blockPos], n);
+            copyRun(sceneAR, &surge->sceneout[0][1][blockPos], n);
+            copyRun(sceneBL, &surge->sceneout[1][0][blockPos], n);
+            copyRun(sceneBR, &surge->sceneout[1][1][blockPos], n);
+
+            sceneAL += n;
+            sceneAR += n;
+            sceneBL += n;
+            sceneBR += n;
+        }
+
+        blockPos = (blockPos + n) & (BLOCK_SIZE - 1);
+        s += n;
     }
 
     // just in case
@@ -1209,10 +1507,76 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
         currev++;
     }
 
+    surge->externalBatchRunner = nullptr;
+
     processBlockPostFunction();
+
+    if (renderedSound)
+        return CLAP_PROCESS_CONTINUE;
+
+    // Everything we wrote is zero, which the host can skip reading
+    process->audio_outputs[0].constant_mask = (1ULL << process->audio_outputs[0].channel_count) - 1;
+    if (haveSceneOut)
+    {
+        process->audio_outputs[1].constant_mask = 3;
+        process->audio_outputs[2].constant_mask = 3;
+    }
+
+    /*
+     * And if no voice has started since and no input is arriving, nothing will change until
+     * the host's next event, so tell it to stop calling us 'til then
+     */
+    if (surge->voices[0].empty() && surge->voices[1].empty() && isSilentRun(inL, numFrames) &&
+        isSilentRun(inR, numFrames) && !editorIsOpen && !surge->storage.oscReceiving &&
+        !hasQueuedAudioThreadWork())
+    {
+        hostProcessSleeping = true;
+        return CLAP_PROCESS_SLEEP;
+    }
+
     return CLAP_PROCESS_CONTINUE;
 }
 
+bool SurgeSynthProcessor::hasQueuedAudioThreadWork()
+{
+    return !midiFromGUI.empty() || !oscRingBuf.empty() || scheduledOSCCount > 0 || oscCheckStartup ||
+           surge->rawLoadEnqueued || surge->patchid_queue >= 0 || surge->has_patchid_file;
+}
+
+void SurgeSynthProcessor::SleepWakeTimer::timerCallback()
+{
+    if (ssp->hostProcessSleeping && (ssp->editorIsOpen || ssp->hasQueuedAudioThreadWork()))
+    {
+        ssp->hostProcessSleeping = false;
+        ssp->requestProcess();
+    }
+}
+
+bool SurgeSynthProcessor::HostThreadPoolRunner::runBatch(int nTasks,
+                                                         Surge::Threading::WorkerPool::taskFn_t f,
+                                                         void *c)
+{
+    fn = f;
+    ctx = c;
+    auto res = ssp->threadPoolRequestExec((uint32_t)nTasks);
+    fn = nullptr;
+    ctx = nullptr;
+
+    return res;
+}
+
+void SurgeSynthProcessor::threadPoolExec(uint32_t taskIndex) noexcept
+{
+    // the host's threads are not ours, so set them up the way the audio thread is
+    auto fpuguard = sst::plugininfra::cpufeatures::FPUStateGuard();
+    auto &r = hostThreadPoolRunner;
+
+    if (r.fn)
+    {
+        r.fn(r.ctx, (int)taskIndex);
+    }
+}
+
 void SurgeSynthProcessor::clap_direct_paramsFlush(const clap_input_events *in,
                                                   const clap_output_events *out) noexcept
 {
@@ -25,6 +25,7 @@
 
 #include "SurgeSynthesizer.h"
 #include "SurgeStorage.h"
+#include "MIDIEventCoalescer.h"
 #include "util/LockFreeStack.h"
 
 #include "osc/OpenSoundControl.h"
@@ -276,13 +277,17 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
     bool priorCallWasProcessBlockNotBypassed{true};
     int bypassCountdown{-1};
 
+    void processBlockRenderMode();
     void processBlockPlayhead();
     void processBlockMidiFromGUI();
     void processBlockOSC();
+    void processScheduledOSC(int bufferPos);
     void processBlockPostFunction();
 
     void applyMidi(const juce::MidiMessageMetadata &);
     void applyMidi(const juce::MidiMessage &);
+    // the host MIDI waiting to be applied before the next block, see processBlock
+    Surge::MIDI::MIDIEventCoalescer midiCoalescer;
     bool supportsMPE() const override { return true; }
 
     //==============================================================================
@@ -357,6 +362,8 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
         bool on{false};
         int32_t noteid{-1};
         int scene{0}, index{0};
+        // wall clock seconds from the time tag of the bundle this came in, 0 for right away
+        double dueTime{0};
 
         oscToAudio() {}
         // Various OSC messages use different subsets of the following fields
@@ -370,6 +377,25 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
         oscToAudio(Parameter *p, float f) : type(PARAMETER), param(p), fval(f) {}
     };
     sst::cpputils::SimpleRingBuffer<oscToAudio, 4096> oscRingBuf;
+    void applyOSC(const oscToAudio &om);
+    void pushOSCToAudio(oscToAudio om)
+    {
+        om.dueTime = oscHandler.pendingBundleDueTime();
+        oscRingBuf.push(om);
+    }
+
+    /*
+     * Messages from time tagged bundles are held here until the block their time falls in,
+     * then applied at their offset inside it when the synth takes sample accurate events.
+     * Host buffers are mapped onto the wall clock at the start of each callback, which is as
+     * close as we can get to the sender's clock without a shared timeline. If this fills up,
+     * further timed messages are just applied on arrival.
+     */
+    static constexpr int maxScheduledOSC{512};
+    std::array<oscToAudio, maxScheduledOSC> scheduledOSC;
+    int scheduledOSCCount{0};
+    double oscBufferStartTime{0};
+    static double oscWallClockNow();
 
     Surge::OSC::OpenSoundControl oscHandler;
     std::atomic<bool> oscCheckStartup{false};
@@ -469,6 +495,20 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
     bool isInputMain(int index) override { return false; }
     bool supportsDirectProcess() override { return true; }
     clap_process_status clap_direct_process(const clap_process *process) noexcept override;
+
+    // Lends the synth the host's thread pool, if the host has one, during clap_direct_process
+    struct HostThreadPoolRunner : Surge::Threading::ExternalBatchRunner
+    {
+        SurgeSynthProcessor *ssp{nullptr};
+        Surge::Threading::WorkerPool::taskFn_t fn{nullptr};
+        void *ctx{nullptr};
+
+        bool runBatch(int nTasks, Surge::Threading::WorkerPool::taskFn_t f, void *c) override;
+    } hostThreadPoolRunner;
+
+    bool supportsThreadPool() const noexcept override { return true; }
+    void threadPoolExec(uint32_t taskIndex) noexcept override;
+
     bool supportsDirectParamsFlush() override { return true; }
     void clap_direct_paramsFlush(const clap_input_events * /*in*/,
                                  const clap_output_events * /*out*/) noexcept override;
@@ -476,11 +516,25 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
     bool supportsVoiceInfo() override { return true; }
     bool voiceInfoGet(clap_voice_info *info) override
     {
-        info->voice_capacity = 128;
-        info->voice_count = 128;
+        info->voice_capacity = n_scenes * MAX_VOICES;
+        info->voice_count = voiceCount();
         info->flags = CLAP_VOICE_INFO_SUPPORTS_OVERLAPPING_NOTES;
         return true;
     }
+
+    /*
+     * clap_direct_process returns CLAP_PROCESS_SLEEP once the output has gone quiet with
+     * nothing left to ring out, so the host can stop calling us until its next event. Work
+     * queued for the audio thread from anywhere else (the UI, OSC, a patch load) has to wake
+     * the host up, which this timer checks for on the message thread.
+     */
+    std::atomic<bool> hostProcessSleeping{false};
+    struct SleepWakeTimer : juce::Timer
+    {
+        SurgeSynthProcessor *ssp{nullptr};
+        void timerCallback() override;
+    } sleepWakeTimer;
+    bool hasQueuedAudioThreadWork();
     bool supportsRemoteControls() const noexcept override { return true; }
     uint32_t remoteControlsPageCount() noexcept override;
     bool
@@ -504,14 +558,27 @@ class SurgeSynthProcessor : public juce::AudioProcessor,
 
     int checkNamesEvery = 0;
 
+    /*
+     * The tail and polyphony we report to the host depend on the running effects and the patch,
+     * so processBlockPostFunction refreshes them and tells the host when they change.
+     */
+    std::atomic<double> tailLengthSeconds{2.0};
+    uint32_t reportedVoiceCount{0};
+    uint32_t voiceCount() const;
+    void updateHostEngineState();
+
     int32_t non_clap_noteid{1};
 
     // For non-block-size uniform blocks we need to lag input
     float inputLatentBuffer alignas(16)[2][BLOCK_SIZE];
+    void checkInputAlignment(bool hasInput, int numSamples);
 
   public:
     bool inputIsLatent{false};
 
+    // set by the editor, which keeps the engine running while it is open
+    std::atomic<bool> editorIsOpen{false};
+
     std::string fatalErrorMessage{};
 
   private:
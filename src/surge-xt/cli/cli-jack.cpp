@@ -0,0 +1,325 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#include "cli-jack.h"
+
+#include <thread>
+
+namespace Surge
+{
+namespace CLI
+{
+NativeJackAudioIODevice::NativeJackAudioIODevice(const juce::String &clientName,
+                                                 const juce::StringArray &inputPorts,
+                                                 const juce::StringArray &outputPorts)
+    : juce::AudioIODevice(clientName, "JACK (native)"), inputNames(inputPorts),
+      outputNames(outputPorts)
+{
+    jack_status_t status{};
+    client = jack_client_open(clientName.toRawUTF8(), JackNoStartServer, &status);
+
+    if (!client)
+    {
+        lastError = "Unable to connect to a JACK server (status " + juce::String((int)status) +
+                    "). Is JACK or PipeWire running?";
+        return;
+    }
+
+    inputBuffers.resize(inputNames.size(), nullptr);
+    outputBuffers.resize(outputNames.size(), nullptr);
+
+    jack_set_process_callback(client, processCallback, this);
+    jack_set_buffer_size_callback(client, bufferSizeCallback, this);
+    jack_set_xrun_callback(client, xrunCallback, this);
+    jack_on_shutdown(client, shutdownCallback, this);
+}
+
+NativeJackAudioIODevice::~NativeJackAudioIODevice()
+{
+    close();
+
+    if (client)
+    {
+        jack_client_close(client);
+        client = nullptr;
+    }
+}
+
+juce::Array<double> NativeJackAudioIODevice::getAvailableSampleRates()
+{
+    juce::Array<double> res;
+
+    if (client)
+        res.add(jack_get_sample_rate(client));
+
+    return res;
+}
+
+juce::Array<int> NativeJackAudioIODevice::getAvailableBufferSizes()
+{
+    juce::Array<int> res;
+
+    if (client)
+        res.add((int)jack_get_buffer_size(client));
+
+    return res;
+}
+
+int NativeJackAudioIODevice::getCurrentBufferSizeSamples()
+{
+    return client ? (int)jack_get_buffer_size(client) : 0;
+}
+
+double NativeJackAudioIODevice::getCurrentSampleRate()
+{
+    return client ? (double)jack_get_sample_rate(client) : 0.0;
+}
+
+juce::BigInteger NativeJackAudioIODevice::getActiveOutputChannels() const
+{
+    juce::BigInteger res;
+    res.setRange(0, (int)outputPorts.size(), true);
+    return res;
+}
+
+juce::BigInteger NativeJackAudioIODevice::getActiveInputChannels() const
+{
+    juce::BigInteger res;
+    res.setRange(0, (int)inputPorts.size(), true);
+    return res;
+}
+
+int NativeJackAudioIODevice::getOutputLatencyInSamples()
+{
+    if (outputPorts.empty())
+        return 0;
+
+    jack_latency_range_t range{};
+    jack_port_get_latency_range(outputPorts[0], JackPlaybackLatency, &range);
+    return (int)range.max;
+}
+
+int NativeJackAudioIODevice::getInputLatencyInSamples()
+{
+    if (inputPorts.empty())
+        return 0;
+
+    jack_latency_range_t range{};
+    jack_port_get_latency_range(inputPorts[0], JackCaptureLatency, &range);
+    return (int)range.max;
+}
+
+juce::String NativeJackAudioIODevice::open(const juce::BigInteger &inputChannels,
+                                           const juce::BigInteger &outputChannels, double,
+                                           int)
+{
+    // The server owns the period and the rate, so the requested ones are ignored
+    if (!client)
+        return lastError;
+
+    close();
+    lastError.clear();
+
+    auto registerPorts = [this](const juce::StringArray &names, const juce::BigInteger &which,
+                                unsigned long flags, std::vector<jack_port_t *> &ports) {
+        for (int i = 0; i < names.size(); ++i)
+        {
+            if (!which[i])
+                continue;
+
+            auto *port = jack_port_register(client, names[i].toRawUTF8(), JACK_DEFAULT_AUDIO_TYPE,
+                                            flags, 0);
+
+            if (!port)
+            {
+                lastError = "Unable to register JACK port " + names[i];
+                return false;
+            }
+
+            ports.push_back(port);
+        }
+        return true;
+    };
+
+    if (!registerPorts(inputNames, inputChannels, JackPortIsInput, inputPorts) ||
+        !registerPorts(outputNames, outputChannels, JackPortIsOutput, outputPorts))
+    {
+        close();
+        return lastError;
+    }
+
+    inputBuffers.assign(inputPorts.size(), nullptr);
+    outputBuffers.assign(outputPorts.size(), nullptr);
+
+    if (jack_activate(client) != 0)
+    {
+        lastError = "Unable to activate the JACK client";
+        close();
+        return lastError;
+    }
+
+    deviceIsOpen = true;
+    return {};
+}
+
+void NativeJackAudioIODevice::close()
+{
+    stop();
+
+    if (client)
+    {
+        if (deviceIsOpen)
+            jack_deactivate(client);
+
+        for (auto *p : inputPorts)
+            jack_port_unregister(client, p);
+        for (auto *p : outputPorts)
+            jack_port_unregister(client, p);
+    }
+
+    inputPorts.clear();
+    outputPorts.clear();
+    deviceIsOpen = false;
+}
+
+void NativeJackAudioIODevice::connectToPhysicalPorts(const juce::BigInteger &outputsToConnect,
+                                                     bool connectInputs)
+{
+    if (!client)
+        return;
+
+    if (auto **playback =
+            jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                           (unsigned long)(JackPortIsPhysical | JackPortIsInput)))
+    {
+        int phys = 0;
+
+        for (int i = 0; i < (int)outputPorts.size() && playback[phys]; ++i)
+        {
+            if (outputsToConnect[i])
+                jack_connect(client, jack_port_name(outputPorts[i]), playback[phys++]);
+        }
+
+        jack_free(playback);
+    }
+
+    if (!connectInputs)
+        return;
+
+    if (auto **capture =
+            jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                           (unsigned long)(JackPortIsPhysical | JackPortIsOutput)))
+    {
+        for (int i = 0; i < (int)inputPorts.size() && capture[i]; ++i)
+            jack_connect(client, capture[i], jack_port_name(inputPorts[i]));
+
+        jack_free(capture);
+    }
+}
+
+void NativeJackAudioIODevice::start(juce::AudioIODeviceCallback *newCallback)
+{
+    if (!deviceIsOpen || !newCallback)
+        return;
+
+    newCallback->audioDeviceAboutToStart(this);
+
+    auto *old = callback.exchange(newCallback);
+
+    if (old && old != newCallback)
+        old->audioDeviceStopped();
+}
+
+void NativeJackAudioIODevice::stop()
+{
+    auto *old = callback.exchange(nullptr);
+
+    // let a period which already picked up the callback finish with it
+    while (inCallback)
+        std::this_thread::yield();
+
+    if (old)
+        old->audioDeviceStopped();
+}
+
+void NativeJackAudioIODevice::process(int numSamples)
+{
+    for (size_t i = 0; i < inputPorts.size(); ++i)
+        inputBuffers[i] = (const float *)jack_port_get_buffer(inputPorts[i], numSamples);
+
+    for (size_t i = 0; i < outputPorts.size(); ++i)
+        outputBuffers[i] = (float *)jack_port_get_buffer(outputPorts[i], numSamples);
+
+    inCallback = true;
+
+    if (auto *cb = callback.load())
+    {
+        cb->audioDeviceIOCallbackWithContext(inputBuffers.data(), (int)inputBuffers.size(),
+                                             outputBuffers.data(), (int)outputBuffers.size(),
+                                             numSamples, {});
+    }
+    else
+    {
+        for (auto *o : outputBuffers)
+            juce::FloatVectorOperations::clear(o, numSamples);
+    }
+
+    inCallback = false;
+}
+
+int NativeJackAudioIODevice::processCallback(jack_nframes_t nframes, void *arg)
+{
+    static_cast<NativeJackAudioIODevice *>(arg)->process((int)nframes);
+    return 0;
+}
+
+int NativeJackAudioIODevice::bufferSizeCallback(jack_nframes_t, void *arg)
+{
+    // the player only cares about the rate, but tell it the device restarted all the same
+    auto *dev = static_cast<NativeJackAudioIODevice *>(arg);
+
+    if (auto *cb = dev->callback.load())
+        cb->audioDeviceAboutToStart(dev);
+
+    return 0;
+}
+
+int NativeJackAudioIODevice::xrunCallback(void *arg)
+{
+    static_cast<NativeJackAudioIODevice *>(arg)->xruns++;
+    return 0;
+}
+
+void NativeJackAudioIODevice::shutdownCallback(void *arg)
+{
+    auto *dev = static_cast<NativeJackAudioIODevice *>(arg);
+
+    // the server went away and took the client with it
+    dev->client = nullptr;
+    dev->inputPorts.clear();
+    dev->outputPorts.clear();
+    dev->deviceIsOpen = false;
+    dev->lastError = "The JACK server shut down";
+}
+} // namespace CLI
+} // namespace Surge
@@ -0,0 +1,111 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+
+#ifndef SURGE_SRC_SURGE_XT_CLI_CLI_JACK_H
+#define SURGE_SRC_SURGE_XT_CLI_CLI_JACK_H
+
+#include <juce_audio_devices/juce_audio_devices.h>
+
+#include <atomic>
+#include <vector>
+
+#include <jack/jack.h>
+
+namespace Surge
+{
+namespace CLI
+{
+/*
+ * A JACK client of our own, dressed as a juce::AudioIODevice so the player drives it like
+ * any other device. Unlike juce's JACK device, which mirrors the system ports and only hands
+ * the callback the ones which happen to be connected, it registers exactly the ports we name
+ * (so scene outputs get ports of their own) and always passes all of them, and the callback
+ * runs straight in JACK's realtime process thread. Period and sample rate are whatever the
+ * server runs at. PipeWire works the same way through its JACK library.
+ */
+class NativeJackAudioIODevice : public juce::AudioIODevice
+{
+  public:
+    NativeJackAudioIODevice(const juce::String &clientName, const juce::StringArray &inputPorts,
+                            const juce::StringArray &outputPorts);
+    ~NativeJackAudioIODevice() override;
+
+    // whether we reached a server at all, getLastError says why not
+    bool isConnectedToServer() const { return client != nullptr; }
+
+    // Connect our ports to the physical ones in order, outputs where the bit is set
+    void connectToPhysicalPorts(const juce::BigInteger &outputsToConnect, bool connectInputs);
+
+    juce::StringArray getOutputChannelNames() override { return outputNames; }
+    juce::StringArray getInputChannelNames() override { return inputNames; }
+    juce::Array<double> getAvailableSampleRates() override;
+    juce::Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override { return getCurrentBufferSizeSamples(); }
+
+    juce::String open(const juce::BigInteger &inputChannels,
+                      const juce::BigInteger &outputChannels, double sampleRate,
+                      int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return deviceIsOpen; }
+    void start(juce::AudioIODeviceCallback *callback) override;
+    void stop() override;
+    bool isPlaying() override { return callback.load() != nullptr; }
+    juce::String getLastError() override { return lastError; }
+
+    int getCurrentBufferSizeSamples() override;
+    int getCurrentBitDepth() override { return 32; }
+    double getCurrentSampleRate() override;
+    juce::BigInteger getActiveOutputChannels() const override;
+    juce::BigInteger getActiveInputChannels() const override;
+    int getOutputLatencyInSamples() override;
+    int getInputLatencyInSamples() override;
+    int getXRunCount() const noexcept override { return xruns; }
+
+  private:
+    static int processCallback(jack_nframes_t nframes, void *arg);
+    static int bufferSizeCallback(jack_nframes_t nframes, void *arg);
+    static int xrunCallback(void *arg);
+    static void shutdownCallback(void *arg);
+
+    void process(int numSamples);
+
+    jack_client_t *client{nullptr};
+    juce::StringArray inputNames, outputNames;
+    std::vector<jack_port_t *> inputPorts, outputPorts;
+
+    // the port buffers for this period, gathered without allocating in process
+    std::vector<const float *> inputBuffers;
+    std::vector<float *> outputBuffers;
+
+    std::atomic<juce::AudioIODeviceCallback *> callback{nullptr};
+    std::atomic<bool> inCallback{false};
+    std::atomic<int> xruns{0};
+    bool deviceIsOpen{false};
+    juce::String lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NativeJackAudioIODevice)
+};
+} // namespace CLI
+} // namespace Surge
+
+#endif // SURGE_SRC_SURGE_XT_CLI_CLI_JACK_H
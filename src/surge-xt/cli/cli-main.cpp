@@ -23,16 +23,25 @@
 #include <juce_core/juce_core.h>
 #include <juce_events/juce_events.h>
 #include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_audio_formats/juce_audio_formats.h>
 #if defined(_M_ARM64EC)
 #include <juce_gui_extra/juce_gui_extra.h>
 #endif
 
 #include <iostream>
+#include <thread>
 #include <CLI11/CLI11.hpp>
 
 #include "version.h"
 
 #include "SurgeSynthProcessor.h"
+#include "WorkerPool.h"
+#include "ThreadPolicy.h"
+#include "PatchPreview.h"
+
+#if SURGE_CLI_NATIVE_JACK
+#include "cli-jack.h"
+#endif
 
 #if JUCE_MAC
 namespace juce
@@ -162,32 +171,64 @@ void listMidiDevices()
     juce::MessageManager::deleteInstance();
 }
 
-struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
+// Engine diagnostics come out with the rest of the log, timestamps and levels and all
+struct CLIDiagnosticLogger : Surge::Debug::DiagnosticLog::Listener
+{
+    void onDiagnostic(const Surge::Debug::DiagnosticRecord &r,
+                      const std::string &formatted) override
+    {
+        if (Surge::Debug::diagnosticSeverity(r.event) == Surge::Debug::diag_info)
+        {
+            LOG(VERBOSE, Surge::Debug::diagnosticName(r.event) << ": " << formatted);
+        }
+        else
+        {
+            LOG(BASIC, Surge::Debug::diagnosticName(r.event) << ": " << formatted);
+        }
+    }
+};
+
+void logDiagnosticsFrom(SurgeSynthesizer *surge)
+{
+    static CLIDiagnosticLogger logger;
+    surge->storage.diagnostics.toStdout = false;
+    surge->storage.diagnostics.addListener(&logger);
+}
+
+/*
+ * One synth hosted by the player. A daemon can host many in the one process, which shares
+ * the immutable tables SurgeStorage keeps process wide and the wavetable cache, and lets us
+ * render them all from one audio callback on a worker pool rather than have a process per
+ * synth contend for the cores. Each takes MIDI on its own set of channels and writes its
+ * own output pair, followed by a pair for each scene if scene outputs are on.
+ */
+struct SurgeInstance
 {
     std::unique_ptr<SurgeSynthProcessor> proc;
-    SurgePlayback()
+    uint16_t midiChannelMask{0xFFFF};
+    int firstOutputChannel{0};
+    bool sceneOutputs{false};
+
+    SurgeInstance()
     {
         juce::AudioProcessor::setTypeOfNextNewPlugin(juce::AudioProcessor::wrapperType_Standalone);
         proc = std::make_unique<SurgeSynthProcessor>();
         proc->standaloneTempo = 120;
+        logDiagnosticsFrom(proc->surge.get());
     }
 
     static constexpr int midiBufferSz{4096}, midiBufferSzMask{midiBufferSz - 1};
     std::array<juce::MidiMessage, midiBufferSz> midiBuffer;
     std::atomic<int> midiWP{0}, midiRP{0};
-    void handleIncomingMidiMessage(juce::MidiInput *source,
-                                   const juce::MidiMessage &message) override
+    void pushMidi(const juce::MidiMessage &message)
     {
         midiBuffer[midiWP] = message;
         midiWP = (midiWP + 1) & midiBufferSzMask;
     }
 
     int pos = BLOCK_SIZE;
-    void
-    audioDeviceIOCallbackWithContext(const float *const *inputChannelData, int numInputChannels,
-                                     float *const *outputChannelData, int numOutputChannels,
-                                     int numSamples,
-                                     const juce::AudioIODeviceCallbackContext &context) override
+    void render(const float *const *inputChannelData, int numInputChannels,
+                float *const *outputChannelData, int numOutputChannels, int numSamples)
     {
         proc->surge->audio_processing_active = true;
         proc->processBlockOSC();
@@ -199,6 +240,26 @@ struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
         }
 
         int inputR = numInputChannels > 1 ? 1 : 0;
+        int outL = firstOutputChannel, outR = outL + 1;
+
+        if (outR >= numOutputChannels)
+        {
+            return;
+        }
+
+        float *sceneOut[n_scenes][2]{};
+        if (sceneOutputs)
+        {
+            for (int sc = 0; sc < n_scenes; ++sc)
+            {
+                auto c = outL + 2 * (sc + 1);
+                if (c + 1 < numOutputChannels)
+                {
+                    sceneOut[sc][0] = outputChannelData[c];
+                    sceneOut[sc][1] = outputChannelData[c + 1];
+                }
+            }
+        }
 
         for (int i = 0; i < numSamples; ++i)
         {
@@ -211,6 +272,7 @@ struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
                     proc->applyMidi(midiBuffer[midiRP]);
                     midiRP = (midiRP + 1) & midiBufferSzMask;
                 }
+                proc->processScheduledOSC(i);
                 proc->surge->process();
 
                 pos = 0;
@@ -220,183 +282,598 @@ struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
                 proc->surge->input[0][pos] = inputChannelData[0][i];
                 proc->surge->input[1][pos] = inputChannelData[inputR][i];
             }
-            outputChannelData[0][i] = proc->surge->output[0][pos];
-            outputChannelData[1][i] = proc->surge->output[1][pos];
+            outputChannelData[outL][i] = proc->surge->output[0][pos];
+            outputChannelData[outR][i] = proc->surge->output[1][pos];
+            for (int sc = 0; sc < n_scenes; ++sc)
+            {
+                if (sceneOut[sc][0])
+                {
+                    sceneOut[sc][0][i] = proc->surge->sceneout[sc][0][pos];
+                    sceneOut[sc][1][i] = proc->surge->sceneout[sc][1][pos];
+                }
+            }
             pos++;
         }
     }
+};
+
+struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
+{
+    std::vector<std::unique_ptr<SurgeInstance>> instances;
+    std::unique_ptr<Surge::Threading::WorkerPool> renderPool;
+
+    // main out, then scene A and B when they're on
+    int outputChannelsPerInstance{2};
+
+    explicit SurgePlayback(int numInstances = 1, bool sceneOutputs = false)
+    {
+        outputChannelsPerInstance = sceneOutputs ? 2 * (1 + n_scenes) : 2;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto inst = std::make_unique<SurgeInstance>();
+            inst->firstOutputChannel = i * outputChannelsPerInstance;
+            inst->sceneOutputs = sceneOutputs;
+            inst->proc->surge->activateExtraOutputs = sceneOutputs;
+            instances.push_back(std::move(inst));
+        }
+
+        // the audio thread renders an instance too, so it counts as one of the workers
+        auto cores = (int)std::max(1u, std::thread::hardware_concurrency());
+        auto workers = std::min(numInstances, cores) - 1;
+
+        if (workers > 0)
+        {
+            renderPool = std::make_unique<Surge::Threading::WorkerPool>(workers);
+        }
+    }
+
+    void handleIncomingMidiMessage(juce::MidiInput *source,
+                                   const juce::MidiMessage &message) override
+    {
+        // channel-less messages (sysex, clock) go to everyone
+        auto ch = message.getChannel();
+
+        for (auto &inst : instances)
+        {
+            if (ch == 0 || (inst->midiChannelMask & (1 << (ch - 1))))
+            {
+                inst->pushMidi(message);
+            }
+        }
+    }
+
+    void
+    audioDeviceIOCallbackWithContext(const float *const *inputChannelData, int numInputChannels,
+                                     float *const *outputChannelData, int numOutputChannels,
+                                     int numSamples,
+                                     const juce::AudioIODeviceCallbackContext &context) override
+    {
+        auto renderOne = [&](int i) {
+            instances[i]->render(inputChannelData, numInputChannels, outputChannelData,
+                                 numOutputChannels, numSamples);
+        };
+
+        if (renderPool && instances.size() > 1)
+        {
+            renderPool->parallelFor((int)instances.size(), renderOne);
+        }
+        else
+        {
+            for (int i = 0; i < (int)instances.size(); ++i)
+            {
+                renderOne(i);
+            }
+        }
+    }
 
-    void audioDeviceStopped() override { proc->surge->audio_processing_active = false; }
+    void audioDeviceStopped() override
+    {
+        for (auto &inst : instances)
+        {
+            inst->proc->surge->audio_processing_active = false;
+        }
+    }
     void audioDeviceAboutToStart(juce::AudioIODevice *device) override
     {
         LOG(BASIC, "Audio Starting      : Sample Rate "
                        << (int)device->getCurrentSampleRate() << " Hz, Buffer Size "
                        << device->getCurrentBufferSizeSamples() << " samples");
-        proc->surge->setSamplerate(device->getCurrentSampleRate());
+
+        for (auto &inst : instances)
+        {
+            inst->proc->surge->setSamplerate(device->getCurrentSampleRate());
+        }
     }
 };
 
-void isQuitPressed()
+// Parses '3' or '1-8' (one based) into a channel mask, 0 if it isn't either
+uint16_t parseMidiChannelRange(const std::string &spec)
 {
-    std::string res;
+    auto dash = spec.find('-');
+    int lo{0}, hi{0};
 
-    while (!(std::cin.eof() || res == "quit"))
+    try
     {
-        std::cout << "\nSurge XT CLI is running. Type 'quit' or Ctrl+D to stop\n> ";
-        std::cin >> res;
+        lo = std::stoi(spec.substr(0, dash));
+        hi = (dash == std::string::npos) ? lo : std::stoi(spec.substr(dash + 1));
     }
-    continueLoop = false;
-    juce::MessageManager::getInstance()->stopDispatchLoop();
+    catch (...)
+    {
+        return 0;
+    }
+
+    if (lo < 1 || hi > 16 || lo > hi)
+    {
+        return 0;
+    }
+
+    uint16_t mask{0};
+    for (int c = lo; c <= hi; ++c)
+    {
+        mask |= 1 << (c - 1);
+    }
+    return mask;
 }
 
-int main(int argc, char **argv)
+/*
+ * Offline batch rendering. Every worker thread owns a SurgeSynthesizer of its own and renders
+ * whole patches through the same MIDI file, so a patch library can be previewed using every
+ * core with nothing touching an audio device or the message thread.
+ */
+struct BatchRenderPluginLayer : SurgeSynthesizer::PluginLayer
 {
-    // juce::ConsoleApplication is just such a mess.
-    CLI::App app("..:: Surge XT CLI - Command Line player for Surge XT ::..");
+    void surgeParameterUpdated(const SurgeSynthesizer::ID &, float) override {}
+    void surgeMacroUpdated(long macroNum, float) override {}
+};
 
-    app.set_version_flag("--version", Surge::Build::FullVersionStr);
+struct BatchRenderSettings
+{
+    int sampleRate{48000};
+    double tailSeconds{-1}; // negative means follow the patch, see renderTailFor
+    bool flac{false};
+    double tempo{120};
+    double midiLengthSeconds{0};
+    juce::MidiMessageSequence events;
+
+    // render the standard audition into the patch preview cache instead, see PatchPreview.h
+    bool previews{false};
+};
 
-    bool listDevices{false};
-    app.add_flag("-l,--list-devices", listDevices,
-                 "List all devices available on this system, then quit.");
+struct BatchRenderJob
+{
+    juce::File patch, output;
+};
 
-    std::string audioInterface{};
-    app.add_flag("--audio-interface", audioInterface,
-                 "Select an audio interface, using index (like '0.2') as shown in list-devices.");
+// The live player hands MIDI to SurgeSynthProcessor::applyMidi, but batch workers run without a
+// processor, so this is the subset of it a MIDI file can exercise
+void applyMidiToSynth(SurgeSynthesizer *surge, const juce::MidiMessage &m)
+{
+    const int ch = m.getChannel() - 1;
 
-    std::string audioPorts{};
-    app.add_flag(
-        "--audio-ports", audioPorts,
-        "Select the ports to address in the audio interface. '0,1' means first pair, zero based.");
+    if (m.isNoteOn())
+    {
+        if (m.getVelocity() != 0)
+            surge->playNote(ch, m.getNoteNumber(), m.getVelocity(), 0, -1);
+        else
+            surge->releaseNote(ch, m.getNoteNumber(), m.getVelocity(), -1);
+    }
+    else if (m.isNoteOff())
+    {
+        surge->releaseNote(ch, m.getNoteNumber(), m.getVelocity());
+    }
+    else if (m.isChannelPressure())
+    {
+        surge->channelAftertouch(ch, m.getChannelPressureValue());
+    }
+    else if (m.isAftertouch())
+    {
+        surge->polyAftertouch(ch, m.getNoteNumber(), m.getAfterTouchValue());
+    }
+    else if (m.isPitchWheel())
+    {
+        surge->pitchBend(ch, m.getPitchWheelValue() - 8192);
+    }
+    else if (m.isController())
+    {
+        surge->channelController(ch, m.getControllerNumber(), m.getControllerValue());
+    }
+}
 
-    std::string audioInputInterface{};
-    app.add_flag(
-        "--audio-input-interface", audioInputInterface,
-        "Select an audio input interface, using index (like '0.2') as shown in list-devices.");
+bool readRenderMidiFile(const std::string &path, BatchRenderSettings &settings)
+{
+    juce::File f(path);
+    juce::FileInputStream fis(f);
 
-    std::string audioInputPorts{};
-    app.add_flag("--audio-input-ports", audioInputPorts,
-                 "Select the ports to address in the audio interface. '0,1' means first pair, zero "
-                 "based. For a single channel just use a single number");
+    if (!fis.openedOk())
+    {
+        PRINTERR("Unable to open MIDI file " << path << "!");
+        return false;
+    }
 
-    bool allMidi{false};
-    app.add_flag("--all-midi-inputs", allMidi, "Bind all available MIDI inputs to the synth.");
+    juce::MidiFile mf;
+    if (!mf.readFrom(fis))
+    {
+        PRINTERR("Unable to parse MIDI file " << path << "!");
+        return false;
+    }
 
-    int midiInput{};
-    app.add_flag("--midi-input", midiInput,
-                 "Select a single MIDI input using the index from list-devices. Overrides "
-                 "--all-midi-inputs.")
-        ->default_val("-1"); // a value of -1 means we skip loading devices altogether.
+    mf.convertTimestampTicksToSeconds();
 
-    int oscInputPort{0};
-    app.add_flag("--osc-in-port", oscInputPort,
-                 "Port for OSC input. If not specified, OSC will not be used.");
+    for (int i = 0; i < mf.getNumTracks(); ++i)
+    {
+        settings.events.addSequence(*mf.getTrack(i), 0);
+    }
+    settings.events.updateMatchedPairs();
 
-    int oscOutputPort{0};
-    app.add_flag("--osc-out-port", oscOutputPort,
-                 "Port for OSC output. If not specified, OSC input will be used and required.");
+    // Tempo changes are already folded into the timestamps; the first tempo is what the
+    // synth uses for tempo-synced modulation
+    for (auto *e : settings.events)
+    {
+        if (e->message.isTempoMetaEvent())
+        {
+            settings.tempo = 60.0 / e->message.getTempoSecondsPerQuarterNote();
+            break;
+        }
+    }
 
-    std::string oscOutputIPAddr{"127.0.0.1"};
-    app.add_flag(
-        "--osc-out-ipaddr", oscOutputIPAddr,
-        "IP Address for OSC output. If not specified, local host will be used (127.0.0.1).");
+    settings.midiLengthSeconds = settings.events.getEndTime();
+    return true;
+}
 
-    int sampleRate{0};
-    app.add_flag("--sample-rate", sampleRate,
-                 "Sample rate for audio output. If not specified, system default will be used.");
+// Engines with infinite feedback can ring forever, so the patch-reported tail is capped
+double renderTailFor(SurgeSynthesizer *surge, const BatchRenderSettings &settings)
+{
+    static constexpr double maxAutomaticTail{10.0};
 
-    int bufferSize{0};
-    app.add_flag("--buffer-size", bufferSize,
-                 "Buffer size for audio output. If not specified, system default will be used.");
+    if (settings.tailSeconds >= 0)
+        return settings.tailSeconds;
 
-    std::string initPatch{};
-    app.add_flag("--init-patch", initPatch, "Choose this file path as the initial patch.");
+    auto tail = surge->getTailLengthSeconds();
 
-    bool noStdIn{false};
-    app.add_flag("--no-stdin", noStdIn,
-                 "Do not assume stdin and do not poll keyboard for quit or ctrl-d. Useful for "
-                 "daemon modes.");
+    if (tail < 0 || tail > maxAutomaticTail)
+        return maxAutomaticTail;
 
-    CLI11_PARSE(app, argc, argv);
+    return tail;
+}
 
-    if (listDevices)
+// the MIDI half of a preview render, which every patch gets the same
+void setUpPreviewAudition(BatchRenderSettings &settings)
+{
+    using pp = Surge::Storage::PatchPreview;
+
+    settings.events.clear();
+    settings.events.addEvent(juce::MidiMessage::noteOn(1, pp::note, (juce::uint8)pp::velocity), 0);
+    settings.events.addEvent(juce::MidiMessage::noteOff(1, pp::note), pp::noteSeconds);
+    settings.events.updateMatchedPairs();
+
+    settings.sampleRate = pp::renderSampleRate;
+    settings.tailSeconds = pp::tailSeconds;
+    settings.midiLengthSeconds = pp::noteSeconds;
+    settings.flac = false;
+}
+
+// Plays the MIDI through the patch into buffer, and returns how many samples of it were rendered
+int64_t renderPatchToBuffer(SurgeSynthesizer *surge, const BatchRenderJob &job,
+                            const BatchRenderSettings &settings, juce::AudioBuffer<float> &buffer)
+{
+    auto patchName = job.patch.getFileNameWithoutExtension().toStdString();
+
+    if (!surge->loadPatchByPath(job.patch.getFullPathName().toRawUTF8(), -1, patchName.c_str()))
     {
-        listAudioDevices();
-        listMidiDevices();
-        exit(0);
+        PRINTERR("Unable to load patch " << job.patch.getFullPathName() << "!");
+        return -1;
     }
 
-    auto *mm = juce::MessageManager::getInstance();
-    mm->setCurrentThreadAsMessageThread();
+    surge->allNotesOff();
+    surge->time_data.tempo = settings.tempo;
+    surge->time_data.ppqPos = 0;
 
-    /*
-     * This is the default runloop. Basically this main thread acts as the message queue
-     */
-    auto engine = std::make_unique<SurgePlayback>();
-    if (!initPatch.empty())
+    // Let the patch load finish and its fade-in settle before anything is captured
+    for (int i = 0; i < 16; ++i)
+        surge->process();
+
+    const double sr = settings.sampleRate;
+    const auto midiSamples = (int64_t)std::ceil(settings.midiLengthSeconds * sr);
+    const auto totalSamples = midiSamples + (int64_t)std::ceil(renderTailFor(surge, settings) * sr);
+
+    // Once the MIDI is over we stop as soon as the output has been silent for this long
+    const auto silenceToStop = (int64_t)(sr / 2);
+    static constexpr float silenceThreshold{1.5e-5f}; // -96 dB
+
+    buffer.setSize(2, (int)std::max(totalSamples, (int64_t)BLOCK_SIZE));
+    buffer.clear();
+
+    const double ppqPerBlock = BLOCK_SIZE * settings.tempo / (60.0 * sr);
+    int nextEvent = 0;
+    int64_t silentRun = 0, pos = 0;
+
+    while (pos < totalSamples)
     {
-        if (engine->proc->surge->loadPatchByPath(initPatch.c_str(), -1, "Loaded Patch"))
+        const auto blockEndSeconds = (pos + BLOCK_SIZE) / sr;
+
+        while (nextEvent < settings.events.getNumEvents() &&
+               settings.events.getEventPointer(nextEvent)->message.getTimeStamp() < blockEndSeconds)
         {
-            LOG(BASIC, "Loaded patch        : " << initPatch);
+            applyMidiToSynth(surge, settings.events.getEventPointer(nextEvent)->message);
+            nextEvent++;
         }
-        else
+
+        surge->process();
+        surge->time_data.ppqPos += ppqPerBlock;
+
+        auto n = (int)std::min((int64_t)BLOCK_SIZE, totalSamples - pos);
+        float peak = 0.f;
+
+        for (int c = 0; c < 2; ++c)
         {
-            LOG(BASIC, "Failed to load patch:" << initPatch << "!");
+            auto *dest = buffer.getWritePointer(c, (int)pos);
+
+            for (int i = 0; i < n; ++i)
+            {
+                dest[i] = surge->output[c][i];
+                peak = std::max(peak, std::fabs(dest[i]));
+            }
         }
+
+        pos += n;
+
+        silentRun = (peak < silenceThreshold) ? silentRun + n : 0;
+
+        if (pos >= midiSamples && silentRun >= silenceToStop)
+            break;
     }
 
-    auto midiDevices = juce::MidiInput::getAvailableDevices();
-    std::vector<std::unique_ptr<juce::MidiInput>> midiInputs;
+    surge->allNotesOff();
 
-    // Only try to open a MIDI device when explicitly requested.
-    if (midiInput >= 0)
+    return pos;
+}
+
+bool renderPatch(SurgeSynthesizer *surge, const BatchRenderJob &job,
+                 const BatchRenderSettings &settings)
+{
+    juce::AudioBuffer<float> buffer;
+    auto pos = renderPatchToBuffer(surge, job, settings, buffer);
+
+    if (pos < 0)
+        return false;
+
+    if (settings.previews)
     {
-        if (midiInput >= midiDevices.size())
-        {
-            PRINTERR("Invalid MIDI input device number!");
-            exit(1);
-        }
+        Surge::Storage::PatchPreview preview;
+        Surge::Storage::decimatePatchPreview(buffer.getReadPointer(0), buffer.getReadPointer(1),
+                                             (int)pos, preview);
 
-        auto vmini = midiDevices[midiInput];
-        auto inp = juce::MidiInput::openDevice(vmini.identifier, engine.get());
-        if (!inp)
+        auto patch = string_to_path(job.patch.getFullPathName().toStdString());
+        auto cacheDir =
+            string_to_path(job.output.getParentDirectory().getFullPathName().toStdString());
+
+        if (!Surge::Storage::storePatchPreview(cacheDir, patch, preview))
         {
-            PRINTERR("Unable to open MIDI device " << vmini.name << "!");
-            exit(1);
+            PRINTERR("Unable to write a preview to " << job.output.getFullPathName() << "!");
+            return false;
         }
-        midiInputs.push_back(std::move(inp));
-        LOG(BASIC, "Opened MIDI Input   : [" << vmini.name << "] ");
+
+        return true;
     }
 
-    // Warn about mixing MIDI input commands
-    if (midiInput >= 0 && allMidi)
+    const double sr = settings.sampleRate;
+
+    job.output.getParentDirectory().createDirectory();
+    job.output.deleteFile();
+
+    std::unique_ptr<juce::AudioFormat> format;
+
+    if (settings.flac)
+        format = std::make_unique<juce::FlacAudioFormat>();
+    else
+        format = std::make_unique<juce::WavAudioFormat>();
+
+    auto stream = std::make_unique<juce::FileOutputStream>(job.output);
+
+    if (!stream->openedOk())
     {
-        LOG(BASIC, "WARNING: Selecting a single MIDI device overrides --all-midi-inputs!")
+        PRINTERR("Unable to open " << job.output.getFullPathName() << " for writing!");
+        return false;
     }
 
-    // Requesting all devices always works, even if no devices are found.
-    // Explicitly requesting a single MIDI device means we skip this.
-    if (allMidi && midiInput < 0)
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        format->createWriterFor(stream.get(), sr, 2, 24, {}, 0));
+
+    if (!writer)
     {
-        LOG(BASIC, "Binding to all MIDI inputs... Found " << midiDevices.size() << " device"
-                                                          << (midiDevices.size() == 1 ? "" : "s")
-                                                          << "!");
-        for (auto &vmini : midiDevices)
+        PRINTERR("Unable to create a writer for " << job.output.getFullPathName() << "!");
+        return false;
+    }
+
+    // the writer now owns the stream
+    stream.release();
+
+    return writer->writeFromAudioSampleBuffer(buffer, 0, (int)pos);
+}
+
+int runBatchRender(const std::string &patchPath, const std::string &midiPath,
+                   const std::string &outputPath, const std::string &formatName, int threads,
+                   BatchRenderSettings &settings)
+{
+    if (settings.previews)
+        setUpPreviewAudition(settings);
+    else if (!readRenderMidiFile(midiPath, settings))
+        return 1;
+
+    if (formatName == "flac")
+    {
+        settings.flac = true;
+    }
+    else if (formatName != "wav")
+    {
+        PRINTERR("Render format must be wav or flac. You gave " << formatName << ".");
+        return 2;
+    }
+
+    auto extension = settings.flac ? juce::String(".flac") : juce::String(".wav");
+
+    std::vector<BatchRenderJob> jobs;
+    juce::File patchFile(patchPath), outputFile(outputPath);
+
+    // Constructing the synths touches shared user data and configuration, so do that up front
+    // on this thread and only run the renders in parallel
+    BatchRenderPluginLayer pluginLayer;
+    std::vector<std::unique_ptr<SurgeSynthesizer>> synths;
+
+    auto addSynth = [&]() {
+        auto s = std::make_unique<SurgeSynthesizer>(&pluginLayer);
+        s->setSamplerate(settings.sampleRate);
+        s->setOfflineRendering(true);
+        s->audio_processing_active = true;
+        logDiagnosticsFrom(s.get());
+        synths.push_back(std::move(s));
+    };
+
+    if (settings.previews)
+    {
+        // Previews live in the user data the first synth's PatchDB indexes, not on the command line
+        addSynth();
+
+        auto cacheDir = Surge::Storage::patchPreviewCacheDir(synths[0]->storage.userDataPath);
+        juce::Array<juce::File> patches;
+
+        if (patchFile.isDirectory())
+            patches = patchFile.findChildFiles(juce::File::findFiles, true, "*.fxp");
+        else if (patchFile.existsAsFile())
+            patches.add(patchFile);
+        else
         {
-            auto inp = juce::MidiInput::openDevice(vmini.identifier, engine.get());
-            if (!inp)
+            PRINTERR("Patch path " << patchPath << " does not exist!");
+            return 1;
+        }
+
+        patches.sort();
+
+        for (const auto &p : patches)
+        {
+            auto preview = Surge::Storage::patchPreviewPath(
+                cacheDir, string_to_path(p.getFullPathName().toStdString()));
+            jobs.push_back({p, juce::File(path_to_string(preview))});
+        }
+    }
+    else if (patchFile.isDirectory())
+    {
+        if (outputFile.existsAsFile())
+        {
+            PRINTERR("When rendering a directory of patches the output must be a directory!");
+            return 2;
+        }
+
+        auto patches = patchFile.findChildFiles(juce::File::findFiles, true, "*.fxp");
+        patches.sort();
+
+        for (const auto &p : patches)
+        {
+            auto rel = p.getRelativePathFrom(patchFile);
+            jobs.push_back({p, outputFile.getChildFile(rel).withFileExtension(extension)});
+        }
+    }
+    else if (patchFile.existsAsFile())
+    {
+        if (outputFile.isDirectory())
+            outputFile = outputFile.getChildFile(patchFile.getFileNameWithoutExtension() + extension);
+
+        jobs.push_back({patchFile, outputFile});
+    }
+    else
+    {
+        PRINTERR("Patch path " << patchPath << " does not exist!");
+        return 1;
+    }
+
+    if (jobs.empty())
+    {
+        PRINTERR("No patches found in " << patchPath << "!");
+        return 1;
+    }
+
+    if (threads <= 0)
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, (int)jobs.size());
+
+    LOG(BASIC, "Rendering " << jobs.size() << " patch" << (jobs.size() == 1 ? "" : "es")
+                            << " at " << settings.sampleRate << " Hz on " << threads << " thread"
+                            << (threads == 1 ? "" : "s"));
+
+    while ((int)synths.size() < threads)
+        addSynth();
+
+    auto *patchDB = synths[0]->storage.patchDB.get();
+
+    if (settings.previews)
+        patchDB->prepareForWrites();
+
+    std::atomic<size_t> nextJob{0};
+    std::atomic<int> failures{0}, done{0};
+    std::mutex logMutex;
+
+    auto worker = [&](SurgeSynthesizer *surge) {
+        size_t j;
+
+        while ((j = nextJob++) < jobs.size())
+        {
+            bool ok = renderPatch(surge, jobs[j], settings);
+            int finished = ++done;
+
+            std::lock_guard<std::mutex> g(logMutex);
+
+            if (ok)
             {
-                PRINTERR("Unable to open MIDI device " << vmini.name << "!");
-                exit(1);
+                if (settings.previews)
+                    patchDB->setPatchPreview(jobs[j].patch.getFullPathName().toStdString(),
+                                             jobs[j].output.getFullPathName().toStdString());
+
+                LOG(VERBOSE, "[" << finished << "/" << jobs.size()
+                                 << "] Rendered : " << jobs[j].output.getFullPathName());
+            }
+            else
+            {
+                failures++;
+                PRINTERR("Failed to render " << jobs[j].patch.getFullPathName());
             }
-            midiInputs.push_back(std::move(inp));
-            LOG(BASIC, "Opened MIDI Input   : [" << vmini.name << "] ");
         }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+
+    for (int i = 0; i < (int)synths.size(); ++i)
+    {
+        pool.emplace_back([&worker, s = synths[i].get(), i]() {
+            Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Realtime, i);
+            worker(s);
+        });
     }
 
-    auto manager = std::make_unique<juce::AudioDeviceManager>();
+    for (auto &t : pool)
+        t.join();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LOG(BASIC, "Rendered " << (jobs.size() - failures) << " of " << jobs.size() << " patches in "
+                           << elapsed << " seconds");
+
+    if (settings.previews)
+        patchDB->waitForJobsOutstandingComplete(60 * 1000);
+
+    return failures == 0 ? 0 : 6;
+}
+
+// Opens one of the devices juce knows about, as chosen on the command line
+std::unique_ptr<juce::AudioIODevice>
+openAudioDevice(juce::AudioDeviceManager &manager, const std::string &audioInterface,
+                const std::string &audioPorts, const std::string &audioInputInterface,
+                const std::string &audioInputPorts, int sampleRate, int bufferSize,
+                int numOutputChannels)
+{
     juce::OwnedArray<juce::AudioIODeviceType> types;
-    manager->createAudioDeviceTypes(types);
+    manager.createAudioDeviceTypes(types);
 
     int audioTypeIndex = 0;
     int audioDeviceIndex = 0;
@@ -545,7 +1022,9 @@ int main(int argc, char **argv)
         }
     }
 
-    auto outputBitset = 3; // ports 0,1
+    // ports 0,1 for one instance, a pair per instance after that
+    juce::BigInteger outputBitset;
+    outputBitset.setRange(0, numOutputChannels, true);
     if (!audioPorts.empty())
     {
         auto p = audioPorts.find(',');
@@ -597,6 +1076,392 @@ int main(int argc, char **argv)
         exit(3);
     }
 
+    return device;
+}
+
+void isQuitPressed()
+{
+    std::string res;
+
+    while (!(std::cin.eof() || res == "quit"))
+    {
+        std::cout << "\nSurge XT CLI is running. Type 'quit' or Ctrl+D to stop\n> ";
+        std::cin >> res;
+    }
+    continueLoop = false;
+    juce::MessageManager::getInstance()->stopDispatchLoop();
+}
+
+int main(int argc, char **argv)
+{
+    // juce::ConsoleApplication is just such a mess.
+    CLI::App app("..:: Surge XT CLI - Command Line player for Surge XT ::..");
+
+    app.set_version_flag("--version", Surge::Build::FullVersionStr);
+
+    bool listDevices{false};
+    app.add_flag("-l,--list-devices", listDevices,
+                 "List all devices available on this system, then quit.");
+
+    std::string audioInterface{};
+    app.add_flag("--audio-interface", audioInterface,
+                 "Select an audio interface, using index (like '0.2') as shown in list-devices.");
+
+    std::string audioPorts{};
+    app.add_flag(
+        "--audio-ports", audioPorts,
+        "Select the ports to address in the audio interface. '0,1' means first pair, zero based.");
+
+    std::string audioInputInterface{};
+    app.add_flag(
+        "--audio-input-interface", audioInputInterface,
+        "Select an audio input interface, using index (like '0.2') as shown in list-devices.");
+
+    std::string audioInputPorts{};
+    app.add_flag("--audio-input-ports", audioInputPorts,
+                 "Select the ports to address in the audio interface. '0,1' means first pair, zero "
+                 "based. For a single channel just use a single number");
+
+    bool allMidi{false};
+    app.add_flag("--all-midi-inputs", allMidi, "Bind all available MIDI inputs to the synth.");
+
+    int midiInput{};
+    app.add_flag("--midi-input", midiInput,
+                 "Select a single MIDI input using the index from list-devices. Overrides "
+                 "--all-midi-inputs.")
+        ->default_val("-1"); // a value of -1 means we skip loading devices altogether.
+
+    int oscInputPort{0};
+    app.add_flag("--osc-in-port", oscInputPort,
+                 "Port for OSC input. If not specified, OSC will not be used.");
+
+    int oscOutputPort{0};
+    app.add_flag("--osc-out-port", oscOutputPort,
+                 "Port for OSC output. If not specified, OSC input will be used and required.");
+
+    std::string oscOutputIPAddr{"127.0.0.1"};
+    app.add_flag(
+        "--osc-out-ipaddr", oscOutputIPAddr,
+        "IP Address for OSC output. If not specified, local host will be used (127.0.0.1).");
+
+    int sampleRate{0};
+    app.add_flag("--sample-rate", sampleRate,
+                 "Sample rate for audio output. If not specified, system default will be used.");
+
+    int bufferSize{0};
+    app.add_flag("--buffer-size", bufferSize,
+                 "Buffer size for audio output. If not specified, system default will be used.");
+
+    std::string initPatch{};
+    app.add_flag("--init-patch", initPatch, "Choose this file path as the initial patch.");
+
+    bool noStdIn{false};
+    app.add_flag("--no-stdin", noStdIn,
+                 "Do not assume stdin and do not poll keyboard for quit or ctrl-d. Useful for "
+                 "daemon modes.");
+
+    int numInstances{1};
+    app.add_flag("--instances", numInstances,
+                 "Host this many synths in one process, rendered in parallel. Instance N listens "
+                 "to MIDI channel N (see --instance-channels), plays out of the Nth port pair and, "
+                 "with OSC, uses the OSC ports plus N.")
+        ->default_val("1");
+
+    std::string instanceChannels{};
+    app.add_flag("--instance-channels", instanceChannels,
+                 "MIDI channels for each instance, comma separated, as a channel or range. For "
+                 "example '1-8,9-16' for two instances.");
+
+    bool sceneOutputs{false};
+    app.add_flag("--scene-outputs", sceneOutputs,
+                 "Also play scene A and B out of their own port pairs, after each instance's "
+                 "main output.");
+
+#if SURGE_CLI_NATIVE_JACK
+    bool useJack{false};
+    app.add_flag("--jack", useJack,
+                 "Run as a JACK (or PipeWire) client of our own rather than through an audio "
+                 "interface, rendering in the server's realtime thread at its period and rate. "
+                 "Registers a port for every output, including scene outputs.");
+
+    std::string jackClientName{"Surge XT"};
+    app.add_flag("--jack-client-name", jackClientName, "The JACK client name to register.");
+
+    bool jackNoConnect{false};
+    app.add_flag("--jack-no-connect", jackNoConnect,
+                 "Don't connect the main outputs and the input to the physical ports.");
+#endif
+
+    std::string renderPatchPath{};
+    app.add_flag("--render-patch", renderPatchPath,
+                 "Render this patch, or every patch in this directory, offline instead of playing "
+                 "live. Requires --render-midi and --render-output.");
+
+    std::string renderMidiPath{};
+    app.add_flag("--render-midi", renderMidiPath, "MIDI file to play through each rendered patch.");
+
+    std::string renderOutputPath{};
+    app.add_flag("--render-output", renderOutputPath,
+                 "Output file for a single patch, or output directory when rendering a directory "
+                 "of patches, mirroring its layout.");
+
+    std::string renderFormat{"wav"};
+    app.add_flag("--render-format", renderFormat, "Render to 'wav' (default) or 'flac'.");
+
+    int renderThreads{0};
+    app.add_flag("--render-threads", renderThreads,
+                 "Number of patches to render in parallel. If not specified, all cores are used.");
+
+    double renderTail{-1};
+    app.add_flag("--render-tail", renderTail,
+                 "Seconds to keep rendering after the MIDI file ends. If not specified, the "
+                 "patch's release and effect tails are used.");
+
+    bool renderPreviews{false};
+    app.add_flag("--render-previews", renderPreviews,
+                 "Render browser audition previews of the --render-patch patches into the user "
+                 "data folder and index them in the patch database, instead of rendering MIDI.");
+
+    int realtimePriority{-1};
+    app.add_flag("--realtime-priority", realtimePriority,
+                 "SCHED_FIFO priority (1-99) for the render worker threads, or 0 to leave them "
+                 "alone. Any of the thread options replaces all the saved thread settings.");
+
+    std::string realtimeCores{};
+    app.add_flag("--realtime-cores", realtimeCores,
+                 "Cores to pin the render worker threads to, like '2,3' or '4-7'. Every other "
+                 "Surge thread is kept off them.");
+
+    int loaderNice{-1};
+    app.add_flag("--loader-nice", loaderNice,
+                 "How far to nice (1-19) the patch, wavetable and impulse response loading "
+                 "threads, or 0 to leave them alone.");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (realtimePriority >= 0 || !realtimeCores.empty() || loaderNice >= 0)
+    {
+        Surge::Threading::ThreadPolicy tp;
+        tp.realtimePriority = std::max(realtimePriority, 0);
+        tp.realtimeCores = Surge::Threading::parseCoreList(realtimeCores);
+        tp.loaderNice = std::max(loaderNice, 0);
+        Surge::Threading::setThreadPolicyFromCommandLine(tp);
+    }
+
+    if (listDevices)
+    {
+        listAudioDevices();
+        listMidiDevices();
+        exit(0);
+    }
+
+    if (!renderPatchPath.empty())
+    {
+        if (!renderPreviews && (renderMidiPath.empty() || renderOutputPath.empty()))
+        {
+            PRINTERR("--render-patch requires both --render-midi and --render-output!");
+            exit(1);
+        }
+
+        BatchRenderSettings settings;
+        if (sampleRate > 0)
+            settings.sampleRate = sampleRate;
+        settings.tailSeconds = renderTail;
+        settings.previews = renderPreviews;
+
+        auto res = runBatchRender(renderPatchPath, renderMidiPath, renderOutputPath, renderFormat,
+                                  renderThreads, settings);
+        exit(res);
+    }
+
+    auto *mm = juce::MessageManager::getInstance();
+    mm->setCurrentThreadAsMessageThread();
+
+    /*
+     * This is the default runloop. Basically this main thread acts as the message queue
+     */
+    if (numInstances < 1)
+    {
+        PRINTERR("--instances must be at least 1!");
+        exit(1);
+    }
+
+    if (numInstances > 1 && !audioPorts.empty())
+    {
+        PRINTERR("--audio-ports can't be used with more than one instance!");
+        exit(1);
+    }
+
+    auto engine = std::make_unique<SurgePlayback>(numInstances, sceneOutputs);
+
+    if (numInstances > 1)
+    {
+        LOG(BASIC, "Hosting instances   : " << numInstances);
+
+        std::vector<std::string> channelSpecs;
+        std::istringstream specs(instanceChannels);
+        std::string spec;
+
+        while (std::getline(specs, spec, ','))
+        {
+            channelSpecs.push_back(spec);
+        }
+
+        if (!channelSpecs.empty() && (int)channelSpecs.size() != numInstances)
+        {
+            PRINTERR("--instance-channels must list channels for each of the " << numInstances
+                                                                            << " instances!");
+            exit(1);
+        }
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto &inst = engine->instances[i];
+
+            if (channelSpecs.empty())
+            {
+                inst->midiChannelMask = 1 << (i % 16);
+            }
+            else
+            {
+                inst->midiChannelMask = parseMidiChannelRange(channelSpecs[i]);
+
+                if (inst->midiChannelMask == 0)
+                {
+                    PRINTERR("Bad MIDI channel range '" << channelSpecs[i] << "' for instance "
+                                                        << i << "!");
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    if (!initPatch.empty())
+    {
+        for (auto &inst : engine->instances)
+        {
+            if (inst->proc->surge->loadPatchByPath(initPatch.c_str(), -1, "Loaded Patch"))
+            {
+                LOG(BASIC, "Loaded patch        : " << initPatch);
+            }
+            else
+            {
+                LOG(BASIC, "Failed to load patch:" << initPatch << "!");
+            }
+        }
+    }
+
+    auto midiDevices = juce::MidiInput::getAvailableDevices();
+    std::vector<std::unique_ptr<juce::MidiInput>> midiInputs;
+
+    // Only try to open a MIDI device when explicitly requested.
+    if (midiInput >= 0)
+    {
+        if (midiInput >= midiDevices.size())
+        {
+            PRINTERR("Invalid MIDI input device number!");
+            exit(1);
+        }
+
+        auto vmini = midiDevices[midiInput];
+        auto inp = juce::MidiInput::openDevice(vmini.identifier, engine.get());
+        if (!inp)
+        {
+            PRINTERR("Unable to open MIDI device " << vmini.name << "!");
+            exit(1);
+        }
+        midiInputs.push_back(std::move(inp));
+        LOG(BASIC, "Opened MIDI Input   : [" << vmini.name << "] ");
+    }
+
+    // Warn about mixing MIDI input commands
+    if (midiInput >= 0 && allMidi)
+    {
+        LOG(BASIC, "WARNING: Selecting a single MIDI device overrides --all-midi-inputs!")
+    }
+
+    // Requesting all devices always works, even if no devices are found.
+    // Explicitly requesting a single MIDI device means we skip this.
+    if (allMidi && midiInput < 0)
+    {
+        LOG(BASIC, "Binding to all MIDI inputs... Found " << midiDevices.size() << " device"
+                                                          << (midiDevices.size() == 1 ? "" : "s")
+                                                          << "!");
+        for (auto &vmini : midiDevices)
+        {
+            auto inp = juce::MidiInput::openDevice(vmini.identifier, engine.get());
+            if (!inp)
+            {
+                PRINTERR("Unable to open MIDI device " << vmini.name << "!");
+                exit(1);
+            }
+            midiInputs.push_back(std::move(inp));
+            LOG(BASIC, "Opened MIDI Input   : [" << vmini.name << "] ");
+        }
+    }
+
+    auto manager = std::make_unique<juce::AudioDeviceManager>();
+    std::unique_ptr<juce::AudioIODevice> device;
+
+#if SURGE_CLI_NATIVE_JACK
+    if (useJack)
+    {
+        juce::StringArray inputPorts{"in_L", "in_R"}, outputPorts;
+        juce::BigInteger mainOutputs;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto prefix = numInstances > 1 ? juce::String(i + 1) + "_" : juce::String();
+
+            mainOutputs.setBit(outputPorts.size());
+            mainOutputs.setBit(outputPorts.size() + 1);
+            outputPorts.add(prefix + "out_L");
+            outputPorts.add(prefix + "out_R");
+
+            if (sceneOutputs)
+            {
+                outputPorts.addArray({prefix + "sceneA_L", prefix + "sceneA_R",
+                                      prefix + "sceneB_L", prefix + "sceneB_R"});
+            }
+        }
+
+        auto jack = std::make_unique<Surge::CLI::NativeJackAudioIODevice>(
+            juce::String(jackClientName), inputPorts, outputPorts);
+
+        if (!jack->isConnectedToServer())
+        {
+            PRINTERR(jack->getLastError());
+            exit(3);
+        }
+
+        juce::BigInteger ins, outs;
+        ins.setRange(0, inputPorts.size(), true);
+        outs.setRange(0, outputPorts.size(), true);
+
+        auto res = jack->open(ins, outs, 0, 0);
+        if (res.isNotEmpty())
+        {
+            PRINTERR("Unable to open JACK client: " << res << "!");
+            exit(3);
+        }
+
+        if (!jackNoConnect)
+        {
+            jack->connectToPhysicalPorts(mainOutputs, true);
+        }
+
+        LOG(BASIC, "JACK client         : [" << jackClientName << "] with "
+                                             << outputPorts.size() << " output ports");
+        device = std::move(jack);
+    }
+    else
+#endif
+    {
+        device = openAudioDevice(*manager, audioInterface, audioPorts, audioInputInterface,
+                                 audioInputPorts, sampleRate, bufferSize,
+                                 numInstances * engine->outputChannelsPerInstance);
+    }
+
     device->start(engine.get());
 
     for (const auto &inp : midiInputs)
@@ -610,12 +1475,17 @@ int main(int argc, char **argv)
     if (oscInputPort > 0)
     {
         needsMessageLoop = true;
-        LOG(BASIC, "Starting OSC input on " << oscInputPort);
-        engine->proc->initOSCIn(oscInputPort);
-        if (oscOutputPort > 0)
+        for (int i = 0; i < numInstances; ++i)
         {
-            LOG(BASIC, "Starting OSC output on " << oscOutputPort);
-            engine->proc->initOSCOut(oscOutputPort, oscOutputIPAddr);
+            auto &proc = engine->instances[i]->proc;
+
+            LOG(BASIC, "Starting OSC input on " << oscInputPort + i);
+            proc->initOSCIn(oscInputPort + i);
+            if (oscOutputPort > 0)
+            {
+                LOG(BASIC, "Starting OSC output on " << oscOutputPort + i);
+                proc->initOSCOut(oscOutputPort + i, oscOutputIPAddr);
+            }
         }
     }
 
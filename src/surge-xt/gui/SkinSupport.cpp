@@ -39,6 +39,16 @@ namespace Surge
 {
 namespace GUI
 {
+namespace
+{
+// when skin.xml was last written, or -1 if we can't tell
+int64_t skinFileModTime(const std::string &path)
+{
+    std::error_code ec;
+    auto t = (int64_t)fs::last_write_time(string_to_path(path), ec).time_since_epoch().count();
+    return ec ? -1 : t;
+}
+} // namespace
 
 const std::string NoneClassName = "none";
 const std::string Skin::defaultImageIDPrefix = "DEFAULT/";
@@ -206,57 +216,72 @@ void SkinDB::rescanForSkins(SurgeStorage *storage)
         defaultSkinEntry = memSkin;
     }
 
-    // Run over the skins parsing the name
+    // Run over the skins parsing the name, unless we have since it last changed
     for (auto &e : availableSkins)
     {
         auto x = e.root + e.name + PATH_SEPARATOR + "skin.xml";
 
-        TiXmlDocument doc;
-        // Obviously fix this
-        doc.SetTabSize(4);
-
-        if (!doc.LoadFile(string_to_path(x)))
-        {
-            if (e.rootType == MEMORY)
-            {
-                // e.displayName += " (in memory)";
-            }
-            else
-            {
-                e.displayName = e.name + " (parse error)";
-                e.parseable = false;
-            }
-            continue;
-        }
-        e.parseable = true;
-        TiXmlElement *surgeskin = TINYXML_SAFE_TO_ELEMENT(doc.FirstChild("surge-skin"));
-        if (!surgeskin)
+        auto modTime = skinFileModTime(x);
+        auto hit = scannedHeaders.find(x);
+        if (modTime >= 0 && hit != scannedHeaders.end() && hit->second.modTime == modTime)
         {
-            e.displayName = e.name + " (no skin element)";
+            e.displayName = hit->second.displayName;
+            e.category = hit->second.category;
+            e.parseable = hit->second.parseable;
             continue;
         }
+        scanSkinHeader(e, x);
+        scannedHeaders[x] = {modTime, e.displayName, e.category, e.parseable};
+    }
 
-        const char *a;
-        if ((a = surgeskin->Attribute("name")))
+    std::sort(availableSkins.begin(), availableSkins.end(),
+              [](const SkinDB::Entry &a, const SkinDB::Entry &b) {
+                  return _stricmp(a.displayName.c_str(), b.displayName.c_str()) < 0;
+              });
+}
+
+void SkinDB::scanSkinHeader(Entry &e, const std::string &x)
+{
+    TiXmlDocument doc;
+    // Obviously fix this
+    doc.SetTabSize(4);
+
+    if (!doc.LoadFile(string_to_path(x)))
+    {
+        if (e.rootType == MEMORY)
         {
-            e.displayName = a;
+            // e.displayName += " (in memory)";
         }
         else
         {
-            e.displayName = e.name + " (no name att)";
+            e.displayName = e.name + " (parse error)";
+            e.parseable = false;
         }
+        return;
+    }
+    e.parseable = true;
+    TiXmlElement *surgeskin = TINYXML_SAFE_TO_ELEMENT(doc.FirstChild("surge-skin"));
+    if (!surgeskin)
+    {
+        e.displayName = e.name + " (no skin element)";
+        return;
+    }
 
-        e.category = "";
-        if ((a = surgeskin->Attribute("category")))
-        {
-            e.category = a;
-        }
+    const char *a;
+    if ((a = surgeskin->Attribute("name")))
+    {
+        e.displayName = a;
+    }
+    else
+    {
+        e.displayName = e.name + " (no name att)";
     }
 
-    std::sort(availableSkins.begin(), availableSkins.end(),
-              [](const SkinDB::Entry &a, const SkinDB::Entry &b) {
-                  return _stricmp(a.displayName.c_str(), b.displayName.c_str()) < 0;
-              });
+    e.category = "";
+    if ((a = surgeskin->Attribute("category")))
+    {
+        e.category = a;
+    }
 }
 
 // Define the inverse maps
@@ -300,12 +325,35 @@ Skin::~Skin()
 #define TINYXML_SAFE_TO_ELEMENT(expr) ((expr) ? (expr)->ToElement() : NULL)
 #endif
 
-bool Skin::reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore)
+bool Skin::reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore, bool reparse)
 {
 #ifdef INSTRUMENT_UI
     Surge::Debug::record("Skin::reloadSkin");
     Surge::Debug::TimeThisBlock _trs_("Skin::reloadSkin");
 #endif
+    /*
+     * Every editor shares this skin through the SkinDB, so the model only needs parsing
+     * once, and again when skin.xml changes. Each editor has a bitmap store of its own,
+     * which still needs the images.
+     */
+    auto modTime = useInMemorySkin ? 0 : skinFileModTime(resourceName("skin.xml"));
+
+    if (reparse || !parsed || modTime < 0 || modTime != parsedModTime)
+    {
+        parsed = false;
+        if (!parseSkinFile())
+            return false;
+
+        parsed = true;
+        parsedModTime = modTime;
+    }
+
+    loadSkinImages(bitmapStore);
+    return true;
+}
+
+bool Skin::parseSkinFile()
+{
     // std::cout << "Reloading skin " << _D(name) << std::endl;
     TiXmlDocument doc;
     if (useInMemorySkin)
@@ -499,47 +547,10 @@ bool Skin::reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore)
         componentClasses[c->name] = c;
     };
 
-    // process the images and colors
+    // the default font and colors; the images go in each editor's store in loadSkinImages
     fontManager->restoreLatoAsDefault();
     for (auto g : globals)
     {
-        if (g.first == "defaultimage")
-        {
-            const auto path = resourceName(g.second.props["directory"]);
-            try
-            {
-                fs::path source(string_to_path(path));
-                for (const fs::path &d : fs::directory_iterator(source))
-                {
-                    const auto pathStr = path_to_string(d);
-                    const auto pos = pathStr.find("bmp");
-                    if (pos != std::string::npos)
-                    {
-                        auto postbmp = pathStr.substr(pos + 3);
-                        int idx = std::atoi(pathStr.c_str() + pos + 3);
-                        // We epxpect 5 digits and a .svg or .png
-                        auto xtn = pathStr.substr(pos + 8);
-
-                        if ((xtn == ".svg" || xtn == ".png") &&
-                            (imageAllowedIds.find(idx) != imageAllowedIds.end()))
-                        {
-                            bitmapStore->loadImageByPathForID(pathStr, idx);
-                        }
-                    }
-                    else
-                    {
-                        std::string id = defaultImageIDPrefix + path_to_string(d.filename());
-                        bitmapStore->loadImageByPathForStringID(pathStr, id);
-                    }
-                }
-            }
-            catch (const fs::filesystem_error &e)
-            {
-                // This will give us a broken skin but no need to tell the users
-                FIXMEERROR << "Unable to load image directory: " << e.what();
-            }
-        }
-
         if (g.first == "default-font")
         {
             auto family = g.second.props["family"];
@@ -557,89 +568,6 @@ bool Skin::reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore)
     szy = BASE_WINDOW_SIZE_Y;
     for (auto g : globals)
     {
-        if (g.first == "image")
-        {
-            auto p = g.second.props;
-            auto id = p["id"];
-            auto res = p["resource"];
-            // FIXME = error handling
-            if (res.size() > 0)
-            {
-                if (id.size() > 0)
-                {
-                    if (imageStringToId.find(id) != imageStringToId.end())
-                        bitmapStore->loadImageByPathForID(resourceName(res), imageStringToId[id]);
-                    else
-                    {
-                        bitmapStore->loadImageByPathForStringID(resourceName(res), id);
-                    }
-                }
-                else
-                {
-                    bitmapStore->loadImageByPath(resourceName(res));
-                }
-            }
-        }
-        if (g.first == "multi-image")
-        {
-            // FIXME error checking
-            auto props = g.second.props;
-            if (props.find("id") == props.end())
-            {
-                FIXMEERROR << "multi-image must contain an id";
-            }
-            auto id = props["id"];
-
-            if (id.size() > 0)
-            {
-                bool validKids = true;
-                auto kids = g.second.children;
-                // Go find the 100 one first
-                SurgeImage *bm = nullptr;
-                for (auto k : kids)
-                {
-                    if (k.second.find("zoom-level") == k.second.end() ||
-                        k.second.find("resource") == k.second.end())
-                    {
-                        validKids = false;
-                        // for( auto kk : k.second )
-                        // std::cout << _D(kk.first) << _D(kk.second) << std::endl;
-                        FIXMEERROR
-                            << "Each subchild of a multi-image must contain a zoom-level and "
-                               "resource";
-                        break;
-                    }
-                    else if (k.second["zoom-level"] == "100")
-                    {
-                        auto res = k.second["resource"];
-                        if (imageStringToId.find(id) != imageStringToId.end())
-                            bm = bitmapStore->loadImageByPathForID(resourceName(res),
-                                                                   imageStringToId[id]);
-                        else
-                        {
-                            bm = bitmapStore->loadImageByPathForStringID(resourceName(res), id);
-                        }
-                    }
-                }
-                if (bm && validKids)
-                {
-                    for (auto k : kids)
-                    {
-                        auto zl = k.second["zoom-level"];
-                        auto zli = std::atoi(zl.c_str());
-                        auto r = k.second["resource"];
-                        if (zli != 100)
-                        {
-                            bm->addPNGForZoomLevel(resourceName(r), zli);
-                        }
-                    }
-                }
-                else
-                {
-                    FIXMEERROR << "invalid multi-image for some reason";
-                }
-            }
-        }
         if (g.first == "zoom-levels")
         {
             for (auto k : g.second.children)
@@ -838,6 +766,136 @@ bool Skin::reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore)
     return true;
 }
 
+void Skin::loadSkinImages(std::shared_ptr<SurgeImageStore> bitmapStore)
+{
+    for (auto g : globals)
+    {
+        if (g.first == "defaultimage")
+        {
+            const auto path = resourceName(g.second.props["directory"]);
+            try
+            {
+                fs::path source(string_to_path(path));
+                for (const fs::path &d : fs::directory_iterator(source))
+                {
+                    const auto pathStr = path_to_string(d);
+                    const auto pos = pathStr.find("bmp");
+                    if (pos != std::string::npos)
+                    {
+                        auto postbmp = pathStr.substr(pos + 3);
+                        int idx = std::atoi(pathStr.c_str() + pos + 3);
+                        // We epxpect 5 digits and a .svg or .png
+                        auto xtn = pathStr.substr(pos + 8);
+
+                        if ((xtn == ".svg" || xtn == ".png") &&
+                            (imageAllowedIds.find(idx) != imageAllowedIds.end()))
+                        {
+                            bitmapStore->loadImageByPathForID(pathStr, idx);
+                        }
+                    }
+                    else
+                    {
+                        std::string id = defaultImageIDPrefix + path_to_string(d.filename());
+                        bitmapStore->loadImageByPathForStringID(pathStr, id);
+                    }
+                }
+            }
+            catch (const fs::filesystem_error &e)
+            {
+                // This will give us a broken skin but no need to tell the users
+                FIXMEERROR << "Unable to load image directory: " << e.what();
+            }
+        }
+    }
+
+    for (auto g : globals)
+    {
+        if (g.first == "image")
+        {
+            auto p = g.second.props;
+            auto id = p["id"];
+            auto res = p["resource"];
+            // FIXME = error handling
+            if (res.size() > 0)
+            {
+                if (id.size() > 0)
+                {
+                    if (imageStringToId.find(id) != imageStringToId.end())
+                        bitmapStore->loadImageByPathForID(resourceName(res), imageStringToId[id]);
+                    else
+                    {
+                        bitmapStore->loadImageByPathForStringID(resourceName(res), id);
+                    }
+                }
+                else
+                {
+                    bitmapStore->loadImageByPath(resourceName(res));
+                }
+            }
+        }
+        if (g.first == "multi-image")
+        {
+            // FIXME error checking
+            auto props = g.second.props;
+            if (props.find("id") == props.end())
+            {
+                FIXMEERROR << "multi-image must contain an id";
+            }
+            auto id = props["id"];
+
+            if (id.size() > 0)
+            {
+                bool validKids = true;
+                auto kids = g.second.children;
+                // Go find the 100 one first
+                SurgeImage *bm = nullptr;
+                for (auto k : kids)
+                {
+                    if (k.second.find("zoom-level") == k.second.end() ||
+                        k.second.find("resource") == k.second.end())
+                    {
+                        validKids = false;
+                        // for( auto kk : k.second )
+                        // std::cout << _D(kk.first) << _D(kk.second) << std::endl;
+                        FIXMEERROR
+                            << "Each subchild of a multi-image must contain a zoom-level and "
+                               "resource";
+                        break;
+                    }
+                    else if (k.second["zoom-level"] == "100")
+                    {
+                        auto res = k.second["resource"];
+                        if (imageStringToId.find(id) != imageStringToId.end())
+                            bm = bitmapStore->loadImageByPathForID(resourceName(res),
+                                                                   imageStringToId[id]);
+                        else
+                        {
+                            bm = bitmapStore->loadImageByPathForStringID(resourceName(res), id);
+                        }
+                    }
+                }
+                if (bm && validKids)
+                {
+                    for (auto k : kids)
+                    {
+                        auto zl = k.second["zoom-level"];
+                        auto zli = std::atoi(zl.c_str());
+                        auto r = k.second["resource"];
+                        if (zli != 100)
+                        {
+                            bm->addPNGForZoomLevel(resourceName(r), zli);
+                        }
+                    }
+                }
+                else
+                {
+                    FIXMEERROR << "invalid multi-image for some reason";
+                }
+            }
+        }
+    }
+}
+
 bool Skin::setAllCapsProperty(const std::string &propertyValueA)
 {
     // make the property value not case sensitive
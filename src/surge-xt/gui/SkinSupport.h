@@ -109,7 +109,11 @@ class Skin
     bool useInMemorySkin{false};
 
     std::unique_ptr<FontManager> fontManager;
-    bool reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore);
+    /*
+     * Parses skin.xml, unless it is unchanged since the last time, then loads the skin's
+     * images into bitmapStore. reparse parses it regardless, for skin authors.
+     */
+    bool reloadSkin(std::shared_ptr<SurgeImageStore> bitmapStore, bool reparse = false);
 
     std::string resourceName(const std::string &relativeName)
     {
@@ -417,6 +421,11 @@ class Skin
     std::vector<int> zooms;
     bool recursiveGroupParse(ControlGroup::ptr_t parent, TiXmlElement *groupList,
                              bool topLevel = true);
+
+    bool parseSkinFile();
+    void loadSkinImages(std::shared_ptr<SurgeImageStore> bitmapStore);
+    bool parsed{false};
+    int64_t parsedModTime{-1};
 };
 
 class SkinDB : public juce::DeletedAtShutdown
@@ -488,6 +497,16 @@ class SkinDB : public juce::DeletedAtShutdown
 
     std::vector<Entry> availableSkins;
     std::unordered_map<Entry, std::shared_ptr<Skin>, Entry::hash> skins;
+
+    // what rescanForSkins read from each skin.xml, so an unchanged one isn't parsed again
+    struct ScannedHeader
+    {
+        int64_t modTime{-1};
+        std::string displayName, category;
+        bool parseable{false};
+    };
+    std::unordered_map<std::string, ScannedHeader> scannedHeaders;
+    void scanSkinHeader(Entry &e, const std::string &skinXML);
     Entry defaultSkinEntry;
     bool foundDefaultSkinEntry = false;
 
@@ -35,6 +35,7 @@
 #include "SkinColors.h"
 #include "SurgeGUIUtils.h"
 #include "DebugHelpers.h"
+#include "SurgeTrace.h"
 #include "StringOps.h"
 #include "ModulatorPresetManager.h"
 #include "ModulationSource.h"
@@ -475,11 +476,16 @@ void SurgeGUIEditor::forceLFODisplayRebuild() { lfoDisplay->repaint(); }
 
 void SurgeGUIEditor::idle()
 {
+    SURGE_TRACE_ZONE("SurgeGUIEditor::idle");
+
     if (!synth)
     {
         return;
     }
 
+    // effects the audio thread swapped out are deleted here rather than there
+    synth->freeRetiredEffects();
+
     if (noProcessingOverlay)
     {
         if (synth->processRunning == 0)
@@ -508,6 +514,9 @@ void SurgeGUIEditor::idle()
         return;
     }
 
+    // only what the engine says changed since the last idle gets looked at below
+    auto uiChanges = synth->takeUIChanges();
+
     if (slowIdleCounter++ == 600)
     {
         slowIdleCounter = 0;
@@ -556,7 +565,8 @@ void SurgeGUIEditor::idle()
         }
     }
 
-    if (getShowVirtualKeyboard() && synth->hasUpdatedMidiCC)
+    if ((uiChanges & SurgeSynthesizer::uic_midi) && getShowVirtualKeyboard() &&
+        synth->hasUpdatedMidiCC)
     {
         synth->hasUpdatedMidiCC = false;
         juceEditor->setPitchModSustainGUI(synth->pitchbendMIDIVal, synth->modwheelCC,
@@ -618,7 +628,8 @@ void SurgeGUIEditor::idle()
             }
         }
 
-        if (lastObservedMidiNoteEventCount != synth->midiNoteEvents)
+        if ((uiChanges & SurgeSynthesizer::uic_midi) &&
+            lastObservedMidiNoteEventCount != synth->midiNoteEvents)
         {
             lastObservedMidiNoteEventCount = synth->midiNoteEvents;
 
@@ -796,7 +807,7 @@ void SurgeGUIEditor::idle()
             }
         }
 
-        if (polydisp)
+        if (polydisp && (uiChanges & SurgeSynthesizer::uic_polyphony))
         {
             int prior = polydisp->getPlayingVoiceCount();
 
@@ -900,49 +911,67 @@ void SurgeGUIEditor::idle()
             refreshOverlayWithOpenClose(MODULATION_EDITOR);
         }
 
-        bool vuInvalid = false;
-
         if (vu[0])
         {
-            if (synth->vu_peak[0] != vu[0]->getValue())
-            {
-                vuInvalid = true;
-                vu[0]->setValue(synth->vu_peak[0]);
-            }
+            vu[0]->setIsAudioActive(synth->audio_processing_active);
+        }
+
+        if (uiChanges & SurgeSynthesizer::uic_levels)
+        {
+            bool vuInvalid = false;
 
-            if (synth->vu_peak[1] != vu[0]->getValueR())
+            if (vu[0])
             {
-                vu[0]->setValueR(synth->vu_peak[1]);
-                vuInvalid = true;
-            }
+                if (synth->vu_peak[0] != vu[0]->getValue())
+                {
+                    vuInvalid = true;
+                    vu[0]->setValue(synth->vu_peak[0]);
+                }
 
-            vu[0]->setIsAudioActive(synth->audio_processing_active);
+                if (synth->vu_peak[1] != vu[0]->getValueR())
+                {
+                    vu[0]->setValueR(synth->vu_peak[1]);
+                    vuInvalid = true;
+                }
 
-            if (synth->cpu_level != vu[0]->getCpuLevel())
-            {
-                vu[0]->setCpuLevel(synth->cpu_level);
-                vuInvalid = true;
+                if (synth->cpu_level != vu[0]->getCpuLevel())
+                {
+                    vu[0]->setCpuLevel(synth->cpu_level);
+                    vuInvalid = true;
+                }
+
+                if (synth->cpuGovernor.getLevel() != vu[0]->getGovernorLevel())
+                {
+                    vu[0]->setGovernorLevel(synth->cpuGovernor.getLevel());
+                    vuInvalid = true;
+                }
+
+                if (vuInvalid)
+                {
+                    vu[0]->repaint();
+                }
             }
 
-            if (vuInvalid)
+            for (int i = 0; i < n_fx_slots; i++)
             {
-                vu[0]->repaint();
-            }
-        }
+                assert(i + 1 < Effect::KNumVuSlots);
 
-        for (int i = 0; i < n_fx_slots; i++)
-        {
-            assert(i + 1 < Effect::KNumVuSlots);
+                if (vu[i + 1] && synth->fx[current_fx])
+                {
+                    auto vL = synth->fx[current_fx]->vu[(i << 1)];
+                    auto vR = synth->fx[current_fx]->vu[(i << 1) + 1];
 
-            if (vu[i + 1] && synth->fx[current_fx])
-            {
-                vu[i + 1]->setValue(synth->fx[current_fx]->vu[(i << 1)]);
-                vu[i + 1]->setValueR(synth->fx[current_fx]->vu[(i << 1) + 1]);
-                vu[i + 1]->repaint();
+                    if (vL != vu[i + 1]->getValue() || vR != vu[i + 1]->getValueR())
+                    {
+                        vu[i + 1]->setValue(vL);
+                        vu[i + 1]->setValueR(vR);
+                        vu[i + 1]->repaint();
+                    }
+                }
             }
         }
 
-        for (int i = 0; i < 8; i++)
+        for (int i = 0; i < 8 && (uiChanges & SurgeSynthesizer::uic_params); i++)
         {
             if (synth->refresh_ctrl_queue[i] >= 0)
             {
@@ -1013,28 +1042,31 @@ void SurgeGUIEditor::idle()
 
         std::vector<int> refreshIndices;
 
-        if (synth->refresh_overflow)
+        if (uiChanges & SurgeSynthesizer::uic_params)
         {
-            refreshIndices.resize(n_total_params);
-            std::iota(std::begin(refreshIndices), std::end(refreshIndices), 0);
-            frame->repaint();
-        }
-        else
-        {
-            for (int i = 0; i < 8; ++i)
+            if (synth->refresh_overflow)
+            {
+                refreshIndices.resize(n_total_params);
+                std::iota(std::begin(refreshIndices), std::end(refreshIndices), 0);
+                frame->repaint();
+            }
+            else
             {
-                if (synth->refresh_parameter_queue[i] >= 0)
+                for (int i = 0; i < 8; ++i)
                 {
-                    refreshIndices.push_back(synth->refresh_parameter_queue[i]);
+                    if (synth->refresh_parameter_queue[i] >= 0)
+                    {
+                        refreshIndices.push_back(synth->refresh_parameter_queue[i]);
+                    }
                 }
             }
-        }
 
-        synth->refresh_overflow = false;
+            synth->refresh_overflow = false;
 
-        for (int i = 0; i < 8; ++i)
-        {
-            synth->refresh_parameter_queue[i] = -1;
+            for (int i = 0; i < 8; ++i)
+            {
+                synth->refresh_parameter_queue[i] = -1;
+            }
         }
 
         for (auto j : refreshIndices)
@@ -1246,6 +1278,11 @@ void SurgeGUIEditor::idle()
             }
         }
     }
+    else
+    {
+        // hand back what we didn't get to, for the next idle which does
+        synth->markUIChanged(uiChanges);
+    }
 
     // refresh waveform display if the mute state of the currently displayed osc changes
     if (oscWaveform)
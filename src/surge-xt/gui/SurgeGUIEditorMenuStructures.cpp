@@ -1148,6 +1148,7 @@ juce::PopupMenu SurgeGUIEditor::makeValueDisplaysMenu(const juce::Point<int> &wh
                             Surge::Storage::updateUserDefaultValue(
                                 &(this->synth->storage), Surge::Storage::HighPrecisionReadouts,
                                 !precReadout);
+                            this->synth->storage.displayGeneration++;
                         });
 
     // modulation value readout shows bounds
@@ -1261,6 +1262,18 @@ juce::PopupMenu SurgeGUIEditor::makeWorkflowMenu(const juce::Point<int> &where)
                            !patchStickySearchbox);
                    });
 
+    bool patchPreviews = Surge::Storage::getUserDefaultValue(
+        &(this->synth->storage), Surge::Storage::PlayPatchPreviewsInSearch, true);
+
+    wfMenu.addItem(Surge::GUI::toOSCase("Play Rendered Previews of Patch Search Results"), true,
+                   patchPreviews, [this, patchPreviews]() {
+                       Surge::Storage::updateUserDefaultValue(
+                           &(this->synth->storage), Surge::Storage::PlayPatchPreviewsInSearch,
+                           !patchPreviews);
+                       if (patchPreviews)
+                           this->synth->patchPreviewPlayer.stop();
+                   });
+
     int patchDirtyCheck = Surge::Storage::getUserDefaultValue(
         &(this->synth->storage), Surge::Storage::PromptToLoadOverDirtyPatch, ALWAYS);
 
@@ -1710,6 +1723,16 @@ juce::PopupMenu SurgeGUIEditor::makeMidiMenu(const juce::Point<int> &where)
                             this->synth->midiSoftTakeover = !softTakeover;
                         });
 
+    bool sampleAccurate = this->synth->sampleAccurateNoteOns;
+
+    midiSubMenu.addItem(Surge::GUI::toOSCase("Sample Accurate Note Timing"), true, sampleAccurate,
+                        [this, sampleAccurate]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage), Surge::Storage::SampleAccurateNoteOns,
+                                !sampleAccurate);
+                            this->synth->sampleAccurateNoteOns = !sampleAccurate;
+                        });
+
     midiSubMenu.addSeparator();
 
     midiSubMenu.addItem(Surge::GUI::toOSCase("Save MIDI Mapping As..."), [this, where]() {
@@ -1745,6 +1768,8 @@ juce::PopupMenu SurgeGUIEditor::makeMidiMenu(const juce::Point<int> &where)
             this->synth->storage.getPatch().dawExtraState.customcontrol_map[i] = -1;
             this->synth->storage.getPatch().dawExtraState.customcontrol_chan_map[i] = -1;
         }
+
+        this->synth->storage.midiMappingGeneration++;
     });
 
     midiSubMenu.addSeparator();
@@ -1777,6 +1802,265 @@ juce::PopupMenu SurgeGUIEditor::makeMidiMenu(const juce::Point<int> &where)
     return midiSubMenu;
 }
 
+juce::PopupMenu SurgeGUIEditor::makePerformanceMenu(const juce::Point<int> &where)
+{
+    auto perfSubMenu = juce::PopupMenu();
+
+    bool mtScenes = synth->getMultithreadedSceneRendering();
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Render Scenes on Separate Threads"), true, mtScenes,
+                        [this, mtScenes]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage),
+                                Surge::Storage::MultithreadedSceneRendering, !mtScenes);
+                            this->synth->setMultithreadedSceneRendering(!mtScenes);
+                        });
+
+    bool mtVoices = synth->getMultithreadedVoiceRendering();
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Render Voices on Multiple Threads"), true, mtVoices,
+                        [this, mtVoices]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage),
+                                Surge::Storage::MultithreadedVoiceRendering, !mtVoices);
+                            this->synth->setMultithreadedVoiceRendering(!mtVoices);
+                        });
+
+    bool mtEffects = synth->getMultithreadedEffectRendering();
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Render Effects on Multiple Threads"), true, mtEffects,
+                        [this, mtEffects]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage),
+                                Surge::Storage::MultithreadedEffectRendering, !mtEffects);
+                            this->synth->setMultithreadedEffectRendering(!mtEffects);
+                        });
+
+    auto osSubMenu = juce::PopupMenu();
+    auto curOS = synth->getEffectOversampling();
+
+    for (auto [q, label] : {std::make_pair(SurgeStorage::EFFECT_OVERSAMPLING_ECO, "Eco (None)"),
+                            std::make_pair(SurgeStorage::EFFECT_OVERSAMPLING_STANDARD, "Standard"),
+                            std::make_pair(SurgeStorage::EFFECT_OVERSAMPLING_HIGH, "High")})
+    {
+        osSubMenu.addItem(Surge::GUI::toOSCase(label), true, curOS == q, [this, q = q]() {
+            Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                   Surge::Storage::EffectOversampling, (int)q);
+            this->synth->setEffectOversampling(q);
+        });
+    }
+
+    perfSubMenu.addSubMenu(Surge::GUI::toOSCase("Effect Oversampling"), osSubMenu);
+
+    // this one is per instance, and saved with the DAW session
+    bool bounceHQ = synth->bounceQualityWhenOffline;
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Use Highest Quality When Rendering Offline"), true,
+                        bounceHQ,
+                        [this, bounceHQ]() { this->synth->bounceQualityWhenOffline = !bounceHQ; });
+
+    bool adaptFx = synth->storage.adaptEffectsToLoad;
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Thin Out Nimbus Grains Under Heavy CPU Load"), true,
+                        adaptFx, [this, adaptFx]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage), Surge::Storage::AdaptEffectsToLoad,
+                                !adaptFx);
+                            this->synth->storage.adaptEffectsToLoad = !adaptFx;
+                        });
+
+    bool degrade = synth->degradeQualityUnderLoad;
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Lower Quality Under Heavy CPU Load"), true, degrade,
+                        [this, degrade]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage), Surge::Storage::DegradeQualityUnderLoad,
+                                !degrade);
+                            this->synth->degradeQualityUnderLoad = !degrade;
+                        });
+
+    bool cacheWT = synth->storage.cacheBuiltWavetables;
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Cache Built Wavetables on Disk"), true, cacheWT,
+                        [this, cacheWT]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage), Surge::Storage::CacheBuiltWavetables,
+                                !cacheWT);
+                            this->synth->storage.cacheBuiltWavetables = !cacheWT;
+                        });
+
+    bool compactWT = synth->storage.compactWavetables;
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Keep Wavetables in 16-bit (Less Memory)"), true,
+                        compactWT, [this, compactWT]() {
+                            Surge::Storage::updateUserDefaultValue(
+                                &(this->synth->storage), Surge::Storage::CompactWavetables,
+                                !compactWT);
+                            this->synth->storage.compactWavetables = !compactWT;
+                        });
+
+    auto silentSubMenu = juce::PopupMenu();
+    auto curSilent = synth->getSilentVoiceThresholdDb();
+
+    for (auto db : {0, -72, -84, -96, -108, -120})
+    {
+        auto label = db == 0 ? std::string("Off") : fmt::format("Below {} dB", db);
+        silentSubMenu.addItem(Surge::GUI::toOSCase(label), true, curSilent == db, [this, db]() {
+            Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                   Surge::Storage::SilentVoiceThreshold, db);
+            this->synth->setSilentVoiceThresholdDb(db);
+        });
+    }
+
+    perfSubMenu.addSubMenu(Surge::GUI::toOSCase("End Released Voices Early"), silentSubMenu);
+
+    auto freezeSubMenu = juce::PopupMenu();
+    auto curFreeze = synth->getFreezeVoicesBudgetMB();
+
+    for (auto mb : {0, 16, 64, 256})
+    {
+        auto label = mb == 0 ? std::string("Off") : fmt::format("Up to {} MB", mb);
+        freezeSubMenu.addItem(Surge::GUI::toOSCase(label), true, curFreeze == mb, [this, mb]() {
+            Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                   Surge::Storage::FreezeVoicesBudget, mb);
+            this->synth->setFreezeVoicesBudgetMB(mb);
+        });
+    }
+
+    perfSubMenu.addSubMenu(Surge::GUI::toOSCase("Freeze Repeated Drum Hits"), freezeSubMenu);
+
+    auto largePageSubMenu = juce::PopupMenu();
+    auto curLargePages = Surge::Memory::getLargePageMode();
+
+    // this only moves buffers made from now on, so it is really for the next instance
+    for (auto [mode, label] : {std::make_pair(Surge::Memory::LargePageMode::Off, "Off"),
+                               std::make_pair(Surge::Memory::LargePageMode::Transparent,
+                                              "Transparent Huge Pages"),
+                               std::make_pair(Surge::Memory::LargePageMode::Explicit,
+                                              "Reserved Huge Pages")})
+    {
+        largePageSubMenu.addItem(Surge::GUI::toOSCase(label), true, curLargePages == mode,
+                                 [this, mode = mode]() {
+                                     Surge::Storage::updateUserDefaultValue(
+                                         &(this->synth->storage),
+                                         Surge::Storage::LargePageAllocation, (int)mode);
+                                     Surge::Memory::setLargePageMode(mode);
+                                 });
+    }
+
+    perfSubMenu.addSubMenu(Surge::GUI::toOSCase("Place New Instances In Large Pages"),
+                           largePageSubMenu);
+
+    perfSubMenu.addSeparator();
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Show CPU Usage Breakdown..."), [this]() {
+        auto &prof = synth->processProfiler;
+        auto avg = prof.getAverage();
+        auto peak = prof.getPeak();
+        auto budget = BLOCK_SIZE * synth->storage.dsamplerate_inv * 1000000;
+
+        std::string msg = fmt::format("Time per block, of {:.0f} us available:\n\n", budget);
+
+        for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+        {
+            // leave out the FX slots which aren't doing anything
+            if (peak.usec[i] <= 0.f)
+                continue;
+
+            msg += fmt::format("{}: {:.1f} us average, {:.1f} us peak\n",
+                               Surge::Profiling::ProcessProfiler::stageName(i), avg.usec[i],
+                               peak.usec[i]);
+        }
+
+        messageBox("CPU Usage Breakdown", msg);
+    });
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Show Block Latency..."), [this]() {
+        auto &prof = synth->processProfiler;
+        const auto &h = prof.getHistogram();
+        auto budget = BLOCK_SIZE * synth->storage.dsamplerate_inv * 1000000;
+
+        std::string msg = fmt::format(
+            "{} blocks, of {:.0f} us available:\n\n"
+            "50%: {:.1f} us, 90%: {:.1f} us, 99%: {:.1f} us, 99.9%: {:.1f} us, max: {:.1f} us\n",
+            h.count(), budget, h.percentile(50), h.percentile(90), h.percentile(99),
+            h.percentile(99.9), h.max());
+
+        auto worst = prof.getWorstBlocks();
+        if (!worst.empty())
+            msg += "\nSlowest blocks:\n\n";
+
+        // a message box only has room for a handful
+        for (size_t i = 0; i < worst.size() && i < 8; ++i)
+        {
+            const auto &w = worst[i];
+            auto ev = Surge::Profiling::ProcessProfiler::blockEventNames(w.profile.events);
+            msg += fmt::format("{:.1f} us, {} voices, {} note ons{}{}\n",
+                               w.profile.usec[Surge::Profiling::ps_total], w.profile.voices,
+                               w.profile.noteOns, ev.empty() ? "" : ", ", ev);
+        }
+
+        messageBox("Block Latency", msg);
+    });
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Reset Block Latency"),
+                        [this]() { synth->processProfiler.resetLatencyStats(); });
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Show Quality Changes Under Load..."), [this]() {
+        namespace prof = Surge::Profiling;
+        auto &gov = synth->cpuGovernor;
+        auto blockSeconds = BLOCK_SIZE * synth->storage.dsamplerate_inv;
+
+        std::string msg = fmt::format("Now at: {}\n", prof::CPUGovernor::levelName(gov.getLevel()));
+
+        if (!synth->degradeQualityUnderLoad)
+            msg += "(Lower Quality Under Heavy CPU Load is off)\n";
+
+        auto changes = gov.getRecentTransitions(12);
+        if (!changes.empty())
+            msg += "\nMost recent changes:\n\n";
+
+        for (const auto &t : changes)
+        {
+            msg += fmt::format("{:.1f} s: {} to {} at {:.0f}% load, voices {:.0f} us, "
+                               "effects {:.0f} us\n",
+                               t.block * blockSeconds, prof::CPUGovernor::levelName(t.from),
+                               prof::CPUGovernor::levelName(t.to), t.load * 100.f, t.voicesUsec,
+                               t.effectsUsec);
+        }
+
+        messageBox("Quality Changes Under Load", msg);
+    });
+
+    perfSubMenu.addItem(Surge::GUI::toOSCase("Show Memory Usage..."), [this]() {
+        auto m = synth->memoryReport();
+        auto mb = [](size_t b) { return b / (1024.0 * 1024.0); };
+
+        std::string msg = fmt::format("Voices: {:.2f} MB\n"
+                                      "Oscillator buffers: {:.2f} MB\n"
+                                      "Filter states: {:.2f} MB\n",
+                                      mb(m.voices), mb(m.oscillatorBuffers), mb(m.filterStates));
+
+        for (int i = 0; i < n_fx_slots; ++i)
+        {
+            if (m.fxSlots[i])
+                msg += fmt::format("FX {}: {:.2f} MB\n", fxslot_names[i], mb(m.fxSlots[i]));
+        }
+
+        msg += fmt::format("Wavetables: {:.2f} MB\n"
+                           "Memory pools: {:.2f} MB\n"
+                           "Lua: {:.2f} MB\n"
+                           "Patch database: {:.2f} MB\n\n"
+                           "Total: {:.2f} MB",
+                           mb(m.wavetables), mb(m.memoryPools), mb(m.lua), mb(m.patchDB),
+                           mb(m.total()));
+
+        messageBox("Memory Usage", msg);
+    });
+
+    return perfSubMenu;
+}
+
 juce::PopupMenu SurgeGUIEditor::makeOSCMenu(const juce::Point<int> &where)
 {
     auto storage = &(synth->storage);
@@ -1930,6 +2214,9 @@ void SurgeGUIEditor::showSettingsMenu(const juce::Point<int> &where,
     auto tuningSubMenu = makeTuningMenu(where, false);
     settingsMenu.addSubMenu("Tuning", tuningSubMenu);
 
+    auto perfSubMenu = makePerformanceMenu(where);
+    settingsMenu.addSubMenu("Performance", perfSubMenu);
+
     settingsMenu.addSeparator();
 
 #if BUILD_IS_DEBUG
@@ -50,6 +50,7 @@
 #include "overlays/PatchStoreDialog.h"
 #include "overlays/TypeinParamEditor.h"
 #include "WavetableOscillator.h"
+#include "WaveshaperADAA.h"
 
 std::string decodeControllerID(int id)
 {
@@ -176,6 +177,7 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
                     currentSub.addItem(name, isEnabled, isChecked, [this, idx, mc, learnChan]() {
                         synth->storage.controllers[idx] = mc;
                         synth->storage.controllers_chan[idx] = learnChan;
+                        synth->storage.midiMappingGeneration++;
                     });
                     break;
                 }
@@ -201,6 +203,8 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
                                 synth->storage.getPatch().param_ptr[ptag]->midictrl = mc;
                                 synth->storage.getPatch().param_ptr[ptag]->midichan = learnChan;
                             }
+
+                            synth->storage.midiMappingGeneration++;
                         });
 
                     break;
@@ -228,6 +232,8 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
                 p->midichan = -1;
             else
                 this->synth->storage.getPatch().param_ptr[ptag]->midichan = -1;
+
+            this->synth->storage.midiMappingGeneration++;
         });
 
         for (int ch = 0; ch < 16; ch++)
@@ -240,6 +246,8 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
                                     p->midichan = ch;
                                 else
                                     this->synth->storage.getPatch().param_ptr[ptag]->midichan = ch;
+
+                                this->synth->storage.midiMappingGeneration++;
                             });
         }
 
@@ -345,6 +353,7 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
 
                 synth->storage.getPatch().dawExtraState.customcontrol_map[idx] = -1;
                 synth->storage.getPatch().dawExtraState.customcontrol_chan_map[idx] = -1;
+                synth->storage.midiMappingGeneration++;
             });
         }
 
@@ -376,6 +385,8 @@ void SurgeGUIEditor::createMIDILearnMenuEntries(juce::PopupMenu &parentMenu,
                     synth->storage.getPatch().dawExtraState.midictrl_map[ptag] = -1;
                     synth->storage.getPatch().dawExtraState.midichan_map[ptag] = -1;
                 }
+
+                synth->storage.midiMappingGeneration++;
             });
         }
 
@@ -458,7 +469,8 @@ void SurgeGUIEditor::refreshSkin()
     bitmapStore.reset(new SurgeImageStore());
     bitmapStore->setupBuiltinBitmaps();
 
-    if (!currentSkin->reloadSkin(bitmapStore))
+    // this is for skin authors, who may have changed more than skin.xml
+    if (!currentSkin->reloadSkin(bitmapStore, true))
     {
         auto db = Surge::GUI::SkinDB::get();
         std::string msg =
@@ -809,6 +821,7 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                         },
                         [this](std::unique_ptr<Surge::FxClipboard::Clipboard> &f, int cge) {
                             Surge::FxClipboard::pasteFx(&(synth->storage), &synth->fxsync[cge], *f);
+                            synth->prepareFxSwap(cge);
                             synth->fx_reload[cge] = true;
                         });
 
@@ -1877,6 +1890,31 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                                                                 true;
                                                     });
                             }
+
+                            std::vector<std::string> stealLabels = {
+                                "Oldest First", "Quietest First", "Lowest Key First",
+                                "Highest Key First"};
+                            std::vector<PolyVoiceStealingMode> stealVals = {
+                                STEAL_OLDEST, STEAL_QUIETEST, STEAL_LOWEST, STEAL_HIGHEST};
+
+                            Surge::Widgets::MenuCenteredBoldLabel::addToMenuAsSectionHeader(
+                                contextMenu, "VOICE STEALING");
+
+                            for (int i = 0; i < stealVals.size(); ++i)
+                            {
+                                bool isChecked = (stealVals[i] == synth->storage.getPatch()
+                                                                      .scene[current_scene]
+                                                                      .polyVoiceStealingMode);
+                                contextMenu.addItem(Surge::GUI::toOSCase(stealLabels[i]), true,
+                                                    isChecked, [this, isChecked, stealVals, i]() {
+                                                        synth->storage.getPatch()
+                                                            .scene[current_scene]
+                                                            .polyVoiceStealingMode = stealVals[i];
+                                                        if (!isChecked)
+                                                            synth->storage.getPatch().isDirty =
+                                                                true;
+                                                    });
+                            }
                         }
 
                         if (p->ctrltype == ct_polymode)
@@ -1926,6 +1964,44 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                                 addEnvTrigOptions(contextMenu, current_scene);
                             }
                         }
+
+                        if ((p->ctrltype == ct_wstype || p->ctrltype == ct_distortion_waveshape) &&
+                            p->has_deformoptions())
+                        {
+                            auto ws = p->ctrltype == ct_distortion_waveshape
+                                          ? FXWaveShapers[limit_range(p->val.i, 0, n_fxws - 1)]
+                                          : (sst::waveshapers::WaveshaperType)p->val.i;
+
+                            if (hasAntialiasedWaveshaper(ws))
+                            {
+                                contextMenu.addSeparator();
+
+                                // in WaveshaperAntialiasing order
+                                std::vector<std::string> aaModes = {"Off", "First Order",
+                                                                    "Second Order"};
+
+                                Surge::Widgets::MenuCenteredBoldLabel::addToMenuAsSectionHeader(
+                                    contextMenu, "ANTIALIASING");
+
+                                for (int i = 0; i < aaModes.size(); ++i)
+                                {
+                                    bool isChecked = p->deform_type == i;
+
+                                    contextMenu.addItem(
+                                        Surge::GUI::toOSCase(aaModes[i]), true, isChecked,
+                                        [this, isChecked, p, i]() {
+                                            if (p->deform_type != i)
+                                                undoManager()->pushParameterChange(p->id, p,
+                                                                                   p->val);
+                                            update_deform_type(p, i);
+                                            if (!isChecked)
+                                            {
+                                                synth->storage.getPatch().isDirty = true;
+                                            }
+                                        });
+                                }
+                            }
+                        }
                     }
 
                     if (p->can_deactivate())
@@ -2337,8 +2413,9 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
                     {
                         contextMenu.addSeparator();
 
-                        std::vector<std::string> tapeHysteresisModes = {"Normal", "Medium", "High",
-                                                                        "Very High"};
+                        // in SolverType order
+                        std::vector<std::string> tapeHysteresisModes = {
+                            "Normal", "Medium", "High", "Very High", "Adaptive"};
 
                         Surge::Widgets::MenuCenteredBoldLabel::addToMenuAsSectionHeader(
                             contextMenu, "PRECISION");
@@ -3851,6 +3928,7 @@ void SurgeGUIEditor::valueChanged(Surge::GUI::IComponentTagValue *control)
     break;
     case tag_fx_menu:
     {
+        synth->prepareFxSwap(limit_range(current_fx, 0, n_fx_slots - 1));
         synth->load_fx_needed = true;
         // queue_refresh = true;
         synth->fx_reload[limit_range(current_fx, 0, n_fx_slots - 1)] = true;
@@ -26,18 +26,84 @@
 #include "fmt/core.h"
 #include "DebugHelpers.h"
 
-SurgeImage::SurgeImage(int rid)
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace
 {
-    resourceID = rid;
-    std::string fn = fmt::format("bmp{:05d}_svg", rid);
-    int bds;
-    auto bd = SurgeXTBinary::getNamedResource(fn.c_str(), bds);
+/*
+ * Every editor builds its own image store, and before this each one parsed every skin SVG and
+ * decoded every skin PNG again. Instead we parse each source once per process and hand out
+ * copies. Copying a parsed SVG is much cheaper than parsing it, and copies of a bitmap share
+ * its pixels, so a second editor (or a reopened one) at 200% doesn't pay for the big PNGs again.
+ *
+ * Built-in resources never change and are kept for the life of the process. Skin files are
+ * keyed by path, dropped when the last image using them goes, and reloaded if the file on disk
+ * is newer than what we parsed.
+ */
+struct SharedDrawables
+{
+    struct Entry
+    {
+        std::unique_ptr<juce::Drawable> master;
+        juce::int64 modTime{0};
+        int users{0};
+        bool pinned{false};
+    };
 
-    if (bd)
+    std::mutex lock;
+    std::unordered_map<std::string, Entry> entries;
+
+    static SharedDrawables &get()
     {
-        drawable = juce::Drawable::createFromImageData(bd, bds);
-        currentDrawable = drawable.get();
+        static SharedDrawables instance;
+        return instance;
     }
+
+    std::unique_ptr<juce::Drawable> copyOf(const std::string &key,
+                                           const std::function<Entry()> &load,
+                                           juce::int64 modTime)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        auto it = entries.find(key);
+
+        if (it == entries.end() || it->second.modTime != modTime)
+        {
+            auto e = load();
+            e.modTime = modTime;
+
+            if (it != entries.end())
+            {
+                e.users = it->second.users;
+            }
+
+            it = entries.insert_or_assign(key, std::move(e)).first;
+        }
+
+        auto &e = it->second;
+        e.users++;
+
+        return e.master ? e.master->createCopy() : nullptr;
+    }
+
+    void release(const std::string &key)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        auto it = entries.find(key);
+
+        if (it != entries.end() && --it->second.users <= 0 && !it->second.pinned)
+        {
+            entries.erase(it);
+        }
+    }
+};
+} // namespace
+
+SurgeImage::SurgeImage(int rid)
+{
+    resourceID = rid;
+    binaryResourceName = fmt::format("bmp{:05d}_svg", rid);
 }
 
 SurgeImage::SurgeImage(const std::string &fname)
@@ -59,13 +125,76 @@ SurgeImage::SurgeImage(std::unique_ptr<juce::Drawable> &in)
 {
 }
 
-SurgeImage::~SurgeImage() = default;
+SurgeImage::~SurgeImage()
+{
+    if (!sharedKey.empty())
+    {
+        SharedDrawables::get().release(sharedKey);
+    }
+}
 
 void SurgeImage::forceLoadFromFile()
 {
     if (!drawable)
     {
-        drawable = juce::Drawable::createFromImageFile(juce::File(fname));
+        if (!sharedKey.empty())
+        {
+            SharedDrawables::get().release(sharedKey);
+        }
+
+        auto file = juce::File(fname);
+        auto key = "file:" + file.getFullPathName().toStdString();
+
+        drawable = SharedDrawables::get().copyOf(
+            key,
+            [&file]() {
+                auto e = SharedDrawables::Entry();
+                e.master = juce::Drawable::createFromImageFile(file);
+                return e;
+            },
+            file.getLastModificationTime().toMilliseconds());
+
+        sharedKey = key;
+        currentDrawable = drawable.get();
+    }
+}
+
+void SurgeImage::loadFromBinary()
+{
+    if (drawable || binaryResourceName.empty())
+    {
+        return;
+    }
+
+    if (!sharedKey.empty())
+    {
+        SharedDrawables::get().release(sharedKey);
+    }
+
+    auto key = "bin:" + binaryResourceName;
+    auto &name = binaryResourceName;
+
+    drawable = SharedDrawables::get().copyOf(
+        key,
+        [&name]() {
+            auto e = SharedDrawables::Entry();
+            int bds;
+            auto bd = SurgeXTBinary::getNamedResource(name.c_str(), bds);
+
+            if (bd)
+            {
+                e.master = juce::Drawable::createFromImageData(bd, bds);
+            }
+
+            e.pinned = true;
+            return e;
+        },
+        0);
+
+    sharedKey = key;
+
+    if (!currentDrawable)
+    {
         currentDrawable = drawable.get();
     }
 }
@@ -78,8 +207,11 @@ SurgeImage *SurgeImage::createFromBinaryWithPrefix(const std::string &prefix, in
 
     if (bd)
     {
-        auto q = juce::Drawable::createFromImageData(bd, bds);
-        return new SurgeImage(q);
+        // Only check it's there; it gets parsed (once per process) when first drawn
+        auto none = std::unique_ptr<juce::Drawable>();
+        auto res = new SurgeImage(none);
+        res->binaryResourceName = fn;
+        return res;
     }
 
     return nullptr;
@@ -134,9 +266,16 @@ void SurgeImage::resolvePNGForZoomLevel(int zoomLevel)
 
 juce::Drawable *SurgeImage::internalDrawableResolved()
 {
-    if (!currentDrawable && resourceID == -1)
+    if (!currentDrawable)
     {
-        forceLoadFromFile();
+        if (!binaryResourceName.empty())
+        {
+            loadFromBinary();
+        }
+        else if (resourceID == -1)
+        {
+            forceLoadFromFile();
+        }
     }
     return currentDrawable;
 }
@@ -31,6 +31,7 @@
 #include <vector>
 #include <map>
 #include <atomic>
+#include <string>
 
 class SurgeImageStore;
 
@@ -99,6 +100,15 @@ class SurgeImage
   private:
     juce::Drawable *internalDrawableResolved();
     juce::AffineTransform scaleAdjustmentTransform() const;
+    void loadFromBinary();
+
+    /*
+     * Parsed images are shared process-wide (see SurgeImage.cpp) and each SurgeImage keeps a
+     * copy of the shared one; sharedKey is the entry we hold a reference on, if any. Built-in
+     * images are only parsed once something draws them.
+     */
+    std::string sharedKey;
+    std::string binaryResourceName;
 
     static std::atomic<int> instances;
     bool adjustForScale{false};
@@ -128,30 +128,39 @@ struct UndoManagerImpl
         std::vector<UndoParam> undoParamValues;
         std::vector<UndoModulation> undoModulations;
     };
+    /*
+     * The modulator storages are big (an MSEG is well over 10kb) and a variant is as big as
+     * its biggest member, so holding them by value made every entry on the stacks, even a
+     * single parameter change, that size. So we keep the snapshots on the heap. They are never
+     * changed once taken, which also lets a copy of a record share them.
+     */
     struct UndoStep
     {
         int scene;
         int lfoid;
-        StepSequencerStorage storageCopy;
+        std::shared_ptr<const StepSequencerStorage> storageCopy;
     };
     struct UndoMSEG
     {
         int scene;
         int lfoid;
-        MSEGStorage storageCopy;
+        std::shared_ptr<const MSEGStorage> storageCopy;
     };
     struct UndoFormula
     {
         int scene;
         int lfoid;
-        FormulaModulatorStorage storageCopy;
+        std::shared_ptr<const FormulaModulatorStorage> storageCopy;
     };
     struct UndoFullLFO
     {
         int scene;
         int lfoid;
         std::vector<UndoParam> undoParamValues;
-        std::variant<bool, MSEGStorage, StepSequencerStorage, FormulaModulatorStorage> extraStorage;
+        std::variant<bool, std::shared_ptr<const MSEGStorage>,
+                     std::shared_ptr<const StepSequencerStorage>,
+                     std::shared_ptr<const FormulaModulatorStorage>>
+            extraStorage;
     };
     struct UndoRename
     {
@@ -198,13 +207,69 @@ struct UndoManagerImpl
     std::deque<UndoRecord> undoStack, redoStack;
     size_t undoStackMem{0}, redoStackMem{0};
 
+    // Approximately what a record holds on to, so the stack limits mean something
     size_t actionSize(const UndoAction &a)
     {
         auto res = sizeof(a);
 
+        auto paramsSize = [](const std::vector<UndoParam> &v) {
+            size_t r = 0;
+            for (const auto &p : v)
+                r += sizeof(p) + p.name.size() + p.formattedValue.size();
+            return r;
+        };
+        auto modsSize = [](const std::vector<UndoModulation> &v) {
+            size_t r = 0;
+            for (const auto &m : v)
+                r += sizeof(m) + m.source_name.size() + m.target_name.size();
+            return r;
+        };
+
+        if (auto pt = std::get_if<UndoParam>(&a))
+        {
+            res += pt->name.size() + pt->formattedValue.size();
+        }
+        if (auto pt = std::get_if<UndoOscillator>(&a))
+        {
+            res += paramsSize(pt->undoParamValues) + modsSize(pt->undoModulations);
+        }
+        if (auto pt = std::get_if<UndoFX>(&a))
+        {
+            res += paramsSize(pt->undoParamValues) + modsSize(pt->undoModulations);
+        }
+        if (auto pt = std::get_if<UndoWavetable>(&a))
+        {
+            // the sample data itself is shared with the live table, so just the wrapper
+            if (pt->wt)
+                res += sizeof(Wavetable);
+        }
+        if (auto pt = std::get_if<UndoStep>(&a))
+        {
+            res += sizeof(StepSequencerStorage);
+        }
+        if (auto pt = std::get_if<UndoMSEG>(&a))
+        {
+            res += sizeof(MSEGStorage);
+        }
         if (auto pt = std::get_if<UndoFormula>(&a))
         {
-            res += pt->storageCopy.formulaString.size();
+            res += sizeof(FormulaModulatorStorage) + pt->storageCopy->formulaString.size();
+        }
+        if (auto pt = std::get_if<UndoFullLFO>(&a))
+        {
+            res += paramsSize(pt->undoParamValues);
+            if (std::holds_alternative<std::shared_ptr<const MSEGStorage>>(pt->extraStorage))
+                res += sizeof(MSEGStorage);
+            if (std::holds_alternative<std::shared_ptr<const StepSequencerStorage>>(
+                    pt->extraStorage))
+                res += sizeof(StepSequencerStorage);
+            if (auto f = std::get_if<std::shared_ptr<const FormulaModulatorStorage>>(
+                    &pt->extraStorage))
+                res += sizeof(FormulaModulatorStorage) + (*f)->formulaString.size();
+        }
+        if (auto pt = std::get_if<UndoTuning>(&a))
+        {
+            res += pt->tuning.scale.rawText.size() + pt->tuning.keyboardMapping.rawText.size();
         }
         if (auto pt = std::get_if<UndoPatch>(&a))
         {
@@ -417,18 +482,18 @@ struct UndoManagerImpl
 
     void doCleanup()
     {
-        while (undoStackMem > maxUndoStackMem)
+        while (undoStackMem > maxUndoStackMem && !undoStack.empty())
         {
-            auto r = undoStack.front();
-            freeAction(r.action);
+            auto &r = undoStack.front();
             undoStackMem -= actionSize(r.action);
+            freeAction(r.action);
             undoStack.pop_front();
         }
-        while (redoStackMem > maxRedoStackMem)
+        while (redoStackMem > maxRedoStackMem && !redoStack.empty())
         {
-            auto r = redoStack.front();
-            freeAction(r.action);
+            auto &r = redoStack.front();
             redoStackMem -= actionSize(r.action);
+            freeAction(r.action);
             redoStack.pop_front();
         }
     }
@@ -655,7 +720,7 @@ struct UndoManagerImpl
         auto r = UndoStep();
         r.scene = scene;
         r.lfoid = lfoid;
-        r.storageCopy = pushValue;
+        r.storageCopy = std::make_shared<const StepSequencerStorage>(pushValue);
         if (to == UndoManager::UNDO)
             pushUndo(r);
         else
@@ -668,7 +733,7 @@ struct UndoManagerImpl
         auto r = UndoMSEG();
         r.scene = scene;
         r.lfoid = lfoid;
-        r.storageCopy = pushValue;
+        r.storageCopy = std::make_shared<const MSEGStorage>(pushValue);
         if (to == UndoManager::UNDO)
             pushUndo(r);
         else
@@ -683,15 +748,18 @@ struct UndoManagerImpl
         auto lf = &(editor->getPatch().scene[scene].lfo[lfoid]);
         if (lf->shape.val.i == lt_mseg)
         {
-            r.extraStorage = editor->getPatch().msegs[scene][lfoid];
+            r.extraStorage =
+                std::make_shared<const MSEGStorage>(editor->getPatch().msegs[scene][lfoid]);
         }
         else if (lf->shape.val.i == lt_formula)
         {
-            r.extraStorage = editor->getPatch().formulamods[scene][lfoid];
+            r.extraStorage = std::make_shared<const FormulaModulatorStorage>(
+                editor->getPatch().formulamods[scene][lfoid]);
         }
         else if (lf->shape.val.i == lt_stepseq)
         {
-            r.extraStorage = editor->getPatch().stepsequences[scene][lfoid];
+            r.extraStorage = std::make_shared<const StepSequencerStorage>(
+                editor->getPatch().stepsequences[scene][lfoid]);
         }
         else
         {
@@ -721,7 +789,7 @@ struct UndoManagerImpl
         auto r = UndoFormula();
         r.scene = scene;
         r.lfoid = lfoid;
-        r.storageCopy = pushValue;
+        r.storageCopy = std::make_shared<const FormulaModulatorStorage>(pushValue);
         if (to == UndoManager::UNDO)
             pushUndo(r);
         else
@@ -789,7 +857,7 @@ struct UndoManagerImpl
         if (doStream)
         {
             void *data{nullptr};
-            auto dsz = editor->getPatch().save_patch(&data);
+            auto dsz = editor->getPatch().save_patch(&data, true);
             // Now the pointer which is returned will be the patches 'patchptr'
             // which on the lext load will get clobbered so we need to make a copy.
             r.dataSz = dsz;
@@ -942,26 +1010,28 @@ struct UndoManagerImpl
             }
             if (lf->shape.val.i == lt_mseg)
             {
-                auto ms = std::get_if<MSEGStorage>(&p->extraStorage);
+                auto ms = std::get_if<std::shared_ptr<const MSEGStorage>>(&p->extraStorage);
                 if (ms)
                 {
-                    editor->setMSEGFromUndo(p->scene, p->lfoid, *ms);
+                    editor->setMSEGFromUndo(p->scene, p->lfoid, **ms);
                 }
             }
             else if (lf->shape.val.i == lt_formula)
             {
-                auto ms = std::get_if<FormulaModulatorStorage>(&p->extraStorage);
+                auto ms =
+                    std::get_if<std::shared_ptr<const FormulaModulatorStorage>>(&p->extraStorage);
                 if (ms)
                 {
-                    editor->setFormulaFromUndo(p->scene, p->lfoid, *ms);
+                    editor->setFormulaFromUndo(p->scene, p->lfoid, **ms);
                 }
             }
             else if (lf->shape.val.i == lt_stepseq)
             {
-                auto ms = std::get_if<StepSequencerStorage>(&p->extraStorage);
+                auto ms =
+                    std::get_if<std::shared_ptr<const StepSequencerStorage>>(&p->extraStorage);
                 if (ms)
                 {
-                    editor->setStepSequencerFromUndo(p->scene, p->lfoid, *ms);
+                    editor->setStepSequencerFromUndo(p->scene, p->lfoid, **ms);
                 }
             }
 
@@ -989,6 +1059,7 @@ struct UndoManagerImpl
                 delete t_fx;
             }
 
+            synth->prepareFxSwap(cge);
             synth->switch_toggled_queued = true;
             synth->load_fx_needed = true;
             synth->fx_reload[cge] = true;
@@ -1025,7 +1096,7 @@ struct UndoManagerImpl
             pushStepSequencer(p->scene, p->lfoid,
                               editor->getPatch().stepsequences[p->scene][p->lfoid], opposite);
             auto g = SelfPushGuard(this);
-            editor->setStepSequencerFromUndo(p->scene, p->lfoid, p->storageCopy);
+            editor->setStepSequencerFromUndo(p->scene, p->lfoid, *p->storageCopy);
             auto ann = fmt::format("{} Step Sequencer Setting, Scene {} Modulator {}", verb,
                                    (char)('A' + p->scene), p->lfoid + 1);
             editor->enqueueAccessibleAnnouncement(ann);
@@ -1036,7 +1107,7 @@ struct UndoManagerImpl
         {
             pushMSEG(p->scene, p->lfoid, editor->getPatch().msegs[p->scene][p->lfoid], opposite);
             auto g = SelfPushGuard(this);
-            editor->setMSEGFromUndo(p->scene, p->lfoid, p->storageCopy);
+            editor->setMSEGFromUndo(p->scene, p->lfoid, *p->storageCopy);
             auto ann = fmt::format("{} MSEG, Scene {} Modulator {}", verb, (char)('A' + p->scene),
                                    p->lfoid + 1);
             editor->enqueueAccessibleAnnouncement(ann);
@@ -1048,7 +1119,7 @@ struct UndoManagerImpl
             pushFormula(p->scene, p->lfoid, editor->getPatch().formulamods[p->scene][p->lfoid],
                         opposite);
             auto g = SelfPushGuard(this);
-            editor->setFormulaFromUndo(p->scene, p->lfoid, p->storageCopy);
+            editor->setFormulaFromUndo(p->scene, p->lfoid, *p->storageCopy);
             auto ann = fmt::format("{} Formula, Scene {} Modulator {}", verb,
                                    (char)('A' + p->scene), p->lfoid + 1);
             editor->enqueueAccessibleAnnouncement(ann);
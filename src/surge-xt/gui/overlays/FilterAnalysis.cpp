@@ -23,6 +23,8 @@
 #include "FilterAnalysis.h"
 #include "RuntimeFont.h"
 #include "SkinColors.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
 #include <fmt/core.h>
 #include "sst/filters/FilterPlotter.h"
 #include <thread>
@@ -59,6 +61,8 @@ struct FilterAnalysisEvaluator
     static void callRunThread(FilterAnalysisEvaluator *that) { that->runThread(); }
     void runThread()
     {
+        Surge::Threading::applyThreadRole(Surge::Threading::ThreadRole::Helper);
+        auto fpuguard = Surge::FPUState::DSPThreadGuard();
         uint64_t lastIB = 0;
         auto fp = sst::filters::FilterPlotter(15);
         while (continueWaiting)
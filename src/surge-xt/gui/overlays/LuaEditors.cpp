@@ -35,6 +35,10 @@
 #include "widgets/MenuCustomComponents.h"
 #include <fmt/core.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace Surge
 {
 namespace Overlays
@@ -60,6 +64,127 @@ struct SurgeCodeEditorComponent : public juce::CodeEditorComponent
             c = c->getParentComponent();
         }
     }
+
+    void setSyntaxError(int line, const std::string &msg)
+    {
+        if (line == syntaxErrorLine && msg == syntaxError)
+            return;
+
+        syntaxErrorLine = line;
+        syntaxError = msg;
+        repaint();
+    }
+
+    void paintOverChildren(juce::Graphics &g) override
+    {
+        if (syntaxError.empty())
+            return;
+
+        // the tint runs across the gutter too, so the line number is marked
+        auto area = getLocalBounds();
+        area.removeFromRight(getScrollbarThickness());
+        area.removeFromBottom(getScrollbarThickness());
+
+        if (syntaxErrorLine > 0 && syntaxErrorLine <= getDocument().getNumLines())
+        {
+            auto cb = getCharacterBounds({getDocument(), syntaxErrorLine - 1, 0});
+            auto lineArea = area.withY(cb.getY()).withHeight(getLineHeight());
+
+            if (lineArea.intersects(area))
+            {
+                g.setColour(errorColour.withAlpha(0.2f));
+                g.fillRect(lineArea.getIntersection(area));
+            }
+        }
+
+        auto msgArea = area.removeFromBottom(getLineHeight() + 4);
+        g.setColour(findColour(juce::CodeEditorComponent::backgroundColourId).withAlpha(0.9f));
+        g.fillRect(msgArea);
+        g.setColour(errorColour);
+        g.setFont(getFont());
+        g.drawText(syntaxError, msgArea.reduced(4, 0), juce::Justification::centredLeft, true);
+    }
+
+    int syntaxErrorLine{-1};
+    std::string syntaxError;
+    juce::Colour errorColour{juce::Colours::red};
+};
+
+/*
+ * Compiles snapshots of the code on a thread with its own Lua state, so typing into a long
+ * script never waits on the parser. Only the newest snapshot is kept; anything posted while a
+ * check is running replaces the one waiting.
+ */
+struct LuaSyntaxChecker
+{
+    using callback_t =
+        std::function<void(uint64_t generation, bool ok, const std::string &msg, int line)>;
+
+    LuaSyntaxChecker(callback_t cb) : onResult(std::move(cb))
+    {
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~LuaSyntaxChecker()
+    {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            done = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    void check(uint64_t generation, std::string code)
+    {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            pendingCode = std::move(code);
+            pendingGeneration = generation;
+            hasPending = true;
+        }
+        cv.notify_one();
+    }
+
+  private:
+    void run()
+    {
+#if HAS_LUA
+        auto L = luaL_newstate();
+#else
+        lua_State *L = nullptr;
+#endif
+        while (true)
+        {
+            std::string code;
+            uint64_t generation;
+            {
+                std::unique_lock<std::mutex> lk(mutex);
+                cv.wait(lk, [this]() { return done || hasPending; });
+                if (done)
+                    break;
+                code = std::move(pendingCode);
+                generation = pendingGeneration;
+                hasPending = false;
+            }
+
+            std::string msg;
+            int line;
+            auto ok = Surge::LuaSupport::checkSyntax(L, code, msg, line);
+            onResult(generation, ok, msg, line);
+        }
+#if HAS_LUA
+        lua_close(L);
+#endif
+    }
+
+    callback_t onResult;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string pendingCode;
+    uint64_t pendingGeneration{0};
+    bool hasPending{false}, done{false};
+    std::thread worker;
 };
 
 struct EditorColors
@@ -82,6 +207,11 @@ struct EditorColors
 
         comp->setColourScheme(cs);
 
+        if (auto sc = dynamic_cast<SurgeCodeEditorComponent *>(comp))
+        {
+            sc->errorColour = skin->getColor(Colors::FormulaEditor::Lua::Error);
+        }
+
         comp->setColour(juce::CodeEditorComponent::backgroundColourId,
                         skin->getColor(Colors::FormulaEditor::Background));
         comp->setColour(juce::CodeEditorComponent::highlightColourId,
@@ -122,6 +252,45 @@ CodeEditorContainerWithApply::CodeEditorContainerWithApply(SurgeGUIEditor *ed, S
     }
 
     applyButton->setEnabled(false);
+
+    // the pointer is made here, on the message thread, and only tested back on it
+    juce::Component::SafePointer<CodeEditorContainerWithApply> that(this);
+    syntaxChecker = std::make_unique<LuaSyntaxChecker>(
+        [that](uint64_t generation, bool ok, const std::string &msg, int line) {
+            juce::MessageManager::callAsync([that, generation, ok, msg, line]() {
+                if (that)
+                {
+                    that->showSyntaxResult(generation, ok, msg, line);
+                }
+            });
+        });
+}
+
+CodeEditorContainerWithApply::~CodeEditorContainerWithApply()
+{
+    stopTimer();
+    syntaxChecker.reset();
+}
+
+void CodeEditorContainerWithApply::timerCallback()
+{
+    stopTimer();
+    syntaxChecker->check(++syntaxGeneration, mainDocument->getAllContent().toStdString());
+}
+
+void CodeEditorContainerWithApply::showSyntaxResult(uint64_t generation, bool ok,
+                                                    const std::string &msg, int line)
+{
+    // a later edit has a check of its own on the way
+    if (generation != syntaxGeneration || isTimerRunning())
+    {
+        return;
+    }
+
+    if (auto sc = dynamic_cast<SurgeCodeEditorComponent *>(mainEditor.get()))
+    {
+        sc->setSyntaxError(ok ? -1 : line, ok ? "" : msg);
+    }
 }
 
 void CodeEditorContainerWithApply::buttonClicked(juce::Button *button)
@@ -143,12 +312,14 @@ void CodeEditorContainerWithApply::codeDocumentTextInserted(const juce::String &
 {
     applyButton->setEnabled(true);
     setApplyEnabled(true);
+    startTimer(syntaxCheckDelayMs);
 }
 
 void CodeEditorContainerWithApply::codeDocumentTextDeleted(int startIndex, int endIndex)
 {
     applyButton->setEnabled(true);
     setApplyEnabled(true);
+    startTimer(syntaxCheckDelayMs);
 }
 
 bool CodeEditorContainerWithApply::keyPressed(const juce::KeyPress &key, juce::Component *o)
@@ -236,7 +407,7 @@ struct ExpandingFormulaDebugger : public juce::Component, public Surge::GUI::Ski
 {
     bool isOpen{false};
 
-    ExpandingFormulaDebugger(FormulaModulatorEditor *ed) : editor(ed)
+    ExpandingFormulaDebugger(FormulaModulatorEditor *ed) : editor(ed), storage(ed->storage)
     {
         debugTableDataModel = std::make_unique<DebugDataModel>();
         debugTable = std::make_unique<juce::TableListBox>("Debug", debugTableDataModel.get());
@@ -248,7 +419,17 @@ struct ExpandingFormulaDebugger : public juce::Component, public Surge::GUI::Ski
         addAndMakeVisible(*debugTable);
     }
 
+    ~ExpandingFormulaDebugger()
+    {
+        if (lfoDebugger)
+        {
+            std::lock_guard<std::mutex> g(storage->formulaGlobalData->displayStateMutex);
+            lfoDebugger.reset();
+        }
+    }
+
     FormulaModulatorEditor *editor{nullptr};
+    SurgeStorage *storage{nullptr};
 
     pdata tp[n_scene_params];
 
@@ -270,25 +451,29 @@ struct ExpandingFormulaDebugger : public juce::Component, public Surge::GUI::Ski
         tp[lfodata->deform.param_id_in_scene].i = lfodata->deform.val.i;
         tp[lfodata->trigmode.param_id_in_scene].i = lm_keytrigger;
 
-        lfoDebugger = std::make_unique<LFOModulationSource>();
-        lfoDebugger->assign(editor->storage, editor->lfos, tp, 0, nullptr, nullptr,
-                            editor->formulastorage, true);
-
-        if (editor->lfo_id < n_lfos_voice)
         {
-            lfoDebugger->setIsVoice(true);
-        }
-        else
-        {
-            lfoDebugger->setIsVoice(false);
-        }
+            std::lock_guard<std::mutex> g(storage->formulaGlobalData->displayStateMutex);
 
-        if (lfoDebugger->isVoice)
-        {
-            lfoDebugger->formulastate.velocity = 100;
-        }
+            lfoDebugger = std::make_unique<LFOModulationSource>();
+            lfoDebugger->assign(editor->storage, editor->lfos, tp, 0, nullptr, nullptr,
+                                editor->formulastorage, true);
 
-        lfoDebugger->attack();
+            if (editor->lfo_id < n_lfos_voice)
+            {
+                lfoDebugger->setIsVoice(true);
+            }
+            else
+            {
+                lfoDebugger->setIsVoice(false);
+            }
+
+            if (lfoDebugger->isVoice)
+            {
+                lfoDebugger->formulastate.velocity = 100;
+            }
+
+            lfoDebugger->attack();
+        }
 
         stepLfoDebugger();
 
@@ -302,6 +487,8 @@ struct ExpandingFormulaDebugger : public juce::Component, public Surge::GUI::Ski
 
     void updateDebuggerWithOptionalStep(bool doStep)
     {
+        std::unique_lock<std::mutex> lk(storage->formulaGlobalData->displayStateMutex);
+
         if (doStep)
         {
             Surge::Formula::setupEvaluatorStateFrom(lfoDebugger->formulastate,
@@ -331,6 +518,7 @@ struct ExpandingFormulaDebugger : public juce::Component, public Surge::GUI::Ski
         }
 
         auto st = Surge::Formula::createDebugDataOfModState(lfoDebugger->formulastate);
+        lk.unlock();
 
         if (debugTableDataModel && debugTable)
         {
@@ -800,6 +988,7 @@ void FormulaModulatorEditor::applyCode()
 {
     editor->undoManager()->pushFormula(scene, lfo_id, *formulastorage);
     formulastorage->setFormula(mainDocument->getAllContent().toStdString());
+    Surge::Formula::precompileFormula(storage, formulastorage);
     storage->getPatch().isDirty = true;
     updateDebuggerIfNeeded();
     editor->repaintFrame();
@@ -42,21 +42,28 @@ namespace Surge
 namespace Overlays
 {
 
+struct LuaSyntaxChecker;
+
 /*
  * This is a base class that provides you an apply button, an editor, a document
  * a tokenizer, etc... which you need to layout with yoru other components by
  * having a superclass constructor and implementing resized; and where you have
  * to handle the apply condition with applyCode()
+ *
+ * Edits are syntax checked on a background thread once typing pauses, and any
+ * error is marked in the editor; nothing runs until you apply.
  */
 class CodeEditorContainerWithApply : public OverlayComponent,
                                      public juce::CodeDocument::Listener,
                                      public juce::Button::Listener,
                                      public juce::KeyListener,
+                                     public juce::Timer,
                                      public Surge::GUI::SkinConsumingComponent
 {
   public:
     CodeEditorContainerWithApply(SurgeGUIEditor *ed, SurgeStorage *s, Surge::GUI::Skin::ptr_t sk,
                                  bool addComponents = false);
+    ~CodeEditorContainerWithApply();
     std::unique_ptr<juce::CodeDocument> mainDocument;
     std::unique_ptr<juce::CodeEditorComponent> mainEditor;
     std::unique_ptr<juce::Button> applyButton;
@@ -68,6 +75,13 @@ class CodeEditorContainerWithApply : public OverlayComponent,
 
     virtual void setApplyEnabled(bool) {}
 
+    // debounces the syntax check, which is posted back to showSyntaxResult
+    static constexpr int syntaxCheckDelayMs{300};
+    void timerCallback() override;
+    void showSyntaxResult(uint64_t generation, bool ok, const std::string &msg, int line);
+    std::unique_ptr<LuaSyntaxChecker> syntaxChecker;
+    uint64_t syntaxGeneration{0};
+
     void paint(juce::Graphics &g) override;
     SurgeGUIEditor *editor;
     SurgeStorage *storage;
@@ -1097,6 +1097,132 @@ struct MSEGCanvas : public juce::Component, public Surge::GUI::SkinConsumingComp
         }
     }
 
+    /*
+     * The curve is sampled once per pixel column, twice (plain and deformed), which is the bulk
+     * of a repaint. Hovering doesn't change the samples and a drag usually only changes a
+     * couple of segments, so we keep the samples and only re-evaluate the columns which cover
+     * segments that differ from the ones we sampled. A duration change moves everything after
+     * it, so there we go from the first changed segment to the end. Brownian segments carry
+     * random state from column to column, so with one of those around we always redo it all.
+     */
+    struct CurveSample
+    {
+        float v, vdef;
+        int lastEval;
+    };
+    std::vector<CurveSample> curveSamples;
+    std::vector<MSEGStorage::segment> curveSegments;
+    float curveT0{0}, curveT1{0}, curveDeform{0};
+    int curveEditMode{-1};
+
+    static bool sameCurveShape(const MSEGStorage::segment &a, const MSEGStorage::segment &b)
+    {
+        return a.duration == b.duration && a.v0 == b.v0 && a.nv1 == b.nv1 &&
+               a.cpduration == b.cpduration && a.cpv == b.cpv && a.type == b.type &&
+               a.useDeform == b.useDeform && a.invertDeform == b.invertDeform;
+    }
+
+    void updateCurveSamples(const juce::Rectangle<int> &drawArea)
+    {
+        auto pxt = pxToTime();
+        int n = drawArea.getWidth() + 1;
+        int nseg = ms->n_activeSegments;
+        float t0 = pxt(drawArea.getX()), t1 = pxt(drawArea.getRight());
+        float deform = lfodata->deform.val.f;
+
+        bool hasBrownian = false;
+
+        for (int i = 0; i < nseg; ++i)
+        {
+            hasBrownian |= ms->segments[i].type == MSEGStorage::segment::Type::BROWNIAN;
+        }
+
+        double fromT = 0, toT = std::numeric_limits<double>::max();
+        int fromQ = 0;
+
+        bool sameView = (int)curveSamples.size() == n && (int)curveSegments.size() == nseg &&
+                        curveT0 == t0 && curveT1 == t1 && curveDeform == deform &&
+                        curveEditMode == (int)ms->editMode;
+
+        if (sameView && !hasBrownian)
+        {
+            int lo = -1, hi = -1;
+            bool timingChanged = false;
+
+            for (int i = 0; i < nseg; ++i)
+            {
+                if (!sameCurveShape(curveSegments[i], ms->segments[i]))
+                {
+                    if (lo < 0)
+                        lo = i;
+                    hi = i;
+                    timingChanged |= curveSegments[i].duration != ms->segments[i].duration;
+                }
+            }
+
+            if (lo < 0)
+            {
+                return;
+            }
+
+            // Segments before lo haven't moved, so this start is the same before and after
+            fromT = ms->segmentStart[std::max(lo - 1, 0)];
+
+            if (!timingChanged)
+            {
+                toT = ms->segmentEnd[std::min(hi + 1, nseg - 1)];
+            }
+
+            while (fromQ < n && pxt(fromQ + drawArea.getX()) < fromT)
+            {
+                fromQ++;
+            }
+        }
+        else
+        {
+            curveSamples.resize(n);
+        }
+
+        Surge::MSEG::EvaluatorState es, esdf;
+        // This is different from the number in LFOMS::assign in draw mode on purpose
+        es.seed(8675309);
+        esdf.seed(8675309);
+
+        if (fromQ > 0)
+        {
+            es.lastEval = esdf.lastEval = curveSamples[fromQ - 1].lastEval;
+        }
+
+        for (int q = fromQ; q < n; ++q)
+        {
+            float up = pxt(q + drawArea.getX());
+
+            if (up > toT)
+            {
+                break;
+            }
+
+            float iup = (int)up;
+            float fup = up - iup;
+            float v = Surge::MSEG::valueAt(iup, fup, 0, ms, &es, true);
+            float vdef = Surge::MSEG::valueAt(iup, fup, deform, ms, &esdf, true);
+
+            // Brownian doesn't deform and the second display is confusing since it is
+            // independently random
+            if (es.lastEval >= 0 && es.lastEval <= nseg - 1 &&
+                ms->segments[es.lastEval].type == MSEGStorage::segment::Type::BROWNIAN)
+                vdef = v;
+
+            curveSamples[q] = {v, vdef, es.lastEval};
+        }
+
+        curveSegments.assign(ms->segments.begin(), ms->segments.begin() + nseg);
+        curveT0 = t0;
+        curveT1 = t1;
+        curveDeform = deform;
+        curveEditMode = (int)ms->editMode;
+    }
+
     virtual void paint(juce::Graphics &g) override
     {
         auto uni = lfodata->unipolar.val.b;
@@ -1152,10 +1278,7 @@ struct MSEGCanvas : public juce::Component, public Surge::GUI::SkinConsumingComp
             }
         }
 
-        Surge::MSEG::EvaluatorState es, esdf;
-        // This is different from the number in LFOMS::assign in draw mode on purpose
-        es.seed(8675309);
-        esdf.seed(8675309);
+        updateCurveSamples(drawArea);
 
         auto path = juce::Path();
         auto highlightPath = juce::Path();
@@ -1189,20 +1312,12 @@ struct MSEGCanvas : public juce::Component, public Surge::GUI::SkinConsumingComp
             int i = q;
             if (!drawnLast)
             {
-                float iup = (int)up;
-                float fup = up - iup;
-                float v = Surge::MSEG::valueAt(iup, fup, 0, ms, &es, true);
-                float vdef = Surge::MSEG::valueAt(iup, fup, lfodata->deform.val.f, ms, &esdf, true);
-
-                v = valpx(v);
-                vdef = valpx(vdef);
-                // Brownian doesn't deform and the second display is confusing since it is
-                // independently random
-                if (es.lastEval >= 0 && es.lastEval <= ms->n_activeSegments - 1 &&
-                    ms->segments[es.lastEval].type == MSEGStorage::segment::Type::BROWNIAN)
-                    vdef = v;
+                const auto &cs = curveSamples[q];
+                float v = valpx(cs.v);
+                float vdef = valpx(cs.vdef);
+                int lastEval = cs.lastEval;
 
-                int compareWith = es.lastEval;
+                int compareWith = lastEval;
 
                 if (up >= ms->totalDuration)
                     compareWith = ms->n_activeSegments - 1;
@@ -1224,15 +1339,15 @@ struct MSEGCanvas : public juce::Component, public Surge::GUI::SkinConsumingComp
                         addP(highlightPath, i, valpx(ms->segments[priorEval].nv1));
                     }
 
-                    priorEval = es.lastEval;
+                    priorEval = lastEval;
                 }
 
-                if (es.lastEval == hoveredSegment)
+                if (lastEval == hoveredSegment)
                 {
                     bool skipThisAdd = false;
 
                     // edge case when you go exactly up to 1 evenly. See #3940
-                    if (up < ms->segmentStart[es.lastEval] || up > ms->segmentEnd[es.lastEval])
+                    if (up < ms->segmentStart[lastEval] || up > ms->segmentEnd[lastEval])
                         skipThisAdd = true;
 
                     if (!hlpathUsed)
@@ -26,6 +26,7 @@
 #include "SurgeGUIUtils.h"
 #include "RuntimeFont.h"
 #include <sstream>
+#include <unordered_map>
 #include "widgets/MenuCustomComponents.h"
 #include "widgets/ModulatableSlider.h"
 #include "widgets/MultiSwitch.h"
@@ -342,7 +343,7 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
 
     void paint(juce::Graphics &g) override
     {
-        if (rows.empty())
+        if (shown.empty())
         {
             g.setFont(skin->fontManager->getLatoAtSize(20));
             g.setColour(skin->getColor(Colors::ModulationListOverlay::DimText));
@@ -383,11 +384,11 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
                            public Surge::GUI::IComponentTagValue::Listener
     {
         static constexpr int height = 32;
-        Datum datum;
+        Datum &datum; // in contents->dataRows, which outlives every row
         ModulationListContents *contents{nullptr};
         int idx{0};
 
-        DataRowEditor(const Datum &d, int idxi, ModulationListContents *c)
+        DataRowEditor(Datum &d, int idxi, ModulationListContents *c)
             : datum(d), idx(idxi), contents(c)
         {
             clearButton = std::make_unique<ModListIconButton>(
@@ -440,7 +441,10 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
                                               (modsources)datum.source_id, datum.source_scene,
                                               datum.source_index, !muted);
                     muted = !muted;
-                    contents->rebuildFrom(me->synth);
+
+                    // muting moves nothing, so only this row has anything new to show
+                    contents->populateDatum(datum, me->synth);
+                    resetValuesFromDatum();
                 },
                 &c->editor->synth->storage);
             muteButton->setAccessible(true);
@@ -792,11 +796,16 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
 
     void moved() override
     {
+        materializeVisibleRows();
+
         auto yPos = getBounds().getY();
         auto cmp = getComponentAt(3, -yPos);
 
         for (auto &r : rows)
         {
+            if (!r)
+                continue;
+
             r->isTop = false;
             r->isAfterTop = false;
         }
@@ -814,6 +823,12 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
 
         for (auto &r : rows)
         {
+            if (!r)
+            {
+                prior = false;
+                continue;
+            }
+
             r->isAfterTop = prior && yPos < -4; // that's about scroll for first. #5602
             prior = r->isTop;
         }
@@ -900,11 +915,64 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
     }
 
     /*
-     * Rows is the visible UI, dataRows is the entire set of data. In the case of filtered
-     * displays, it is not the case that rows[i].datum == dataRows[i]
+     * dataRows is the entire set of data, sorted, and shown is the filtered part of it in list
+     * order. Only the shown rows in and around the viewport have a DataRowEditor, which rows
+     * holds at the same index as shown and which is null for the rest, so a patch with
+     * hundreds of routings costs the dozen or so rows on screen rather than one each.
      */
+    struct ShownRow
+    {
+        size_t dataIndex{0};
+        bool firstInSort{false}, hasFollower{false}, isLast{false};
+    };
+    std::vector<ShownRow> shown;
     std::vector<std::unique_ptr<DataRowEditor>> rows;
     std::vector<Datum> dataRows;
+    std::unordered_map<uint64_t, size_t> shownByRouting;
+
+    static uint64_t routingKeyOf(const Datum &d)
+    {
+        return ModulationEditor::routingKey(d.destination_id + d.idBase, d.source_id,
+                                            d.source_scene, d.source_index);
+    }
+
+    // rows either side of the viewport which still get an editor, so tabbing finds one
+    static constexpr int materializeMargin = 8;
+
+    void materializeVisibleRows()
+    {
+        auto top = -getY(), height = 600;
+
+        if (editor && editor->viewport && editor->viewport->getHeight() > 0)
+            height = editor->viewport->getHeight();
+
+        auto first = std::max(0, top / DataRowEditor::height - materializeMargin);
+        auto last = std::min((int)rows.size(),
+                             (top + height) / DataRowEditor::height + 1 + materializeMargin);
+
+        for (int i = 0; i < (int)rows.size(); ++i)
+        {
+            auto wanted = i >= first && i < last;
+
+            if (wanted && !rows[i])
+            {
+                const auto &s = shown[i];
+                auto l = std::make_unique<DataRowEditor>(dataRows[s.dataIndex], i, this);
+                l->firstInSort = s.firstInSort;
+                l->hasFollower = s.hasFollower;
+                l->isLast = s.isLast;
+                l->setSkin(skin, associatedBitmapStore);
+                l->setBounds(0, i * DataRowEditor::height, getWidth() - 1, DataRowEditor::height);
+                addAndMakeVisible(*l);
+                rows[i] = std::move(l);
+            }
+            else if (!wanted && rows[i] && !rows[i]->hasKeyboardFocus(true))
+            {
+                removeChildComponent(rows[i].get());
+                rows[i].reset();
+            }
+        }
+    }
 
     void populateDatum(Datum &d, const SurgeSynthesizer *synth)
     {
@@ -957,9 +1025,10 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
     void rebuildFrom(SurgeSynthesizer *synth)
     {
         removeAllChildren();
-        dataRows.clear();
         rows.clear();
-        int ypos = 0;
+        shown.clear();
+        shownByRouting.clear();
+        dataRows.clear();
         auto append = [this, synth](const std::string &type,
                                     const std::vector<ModulationRouting> &r, int idBase,
                                     int scene) {
@@ -1036,9 +1105,14 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
 
         std::string priorN = "-";
 
-        int idx = 0;
-        for (const auto &d : dataRows)
+        auto sortNameOf = [this](const ShownRow &s) -> const std::string & {
+            const auto &d = dataRows[s.dataIndex];
+            return sortOrder == BY_SOURCE ? d.sname : d.pname;
+        };
+
+        for (size_t di = 0; di < dataRows.size(); ++di)
         {
+            const auto &d = dataRows[di];
             auto included = filterOn == NONE || (filterOn == SOURCE && d.sname == filterString) ||
                             (filterOn == TARGET && d.pname == filterString) ||
                             (filterOn == TARGET_CG && d.pControlGroup == filterInt) ||
@@ -1048,42 +1122,34 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
             {
                 continue;
             }
-            auto l = std::make_unique<DataRowEditor>(d, idx++, this);
-            auto sortName = sortOrder == BY_SOURCE ? d.sname : d.pname;
 
-            l->setSkin(skin, associatedBitmapStore);
-
-            if (sortName != priorN)
-            {
-                priorN = sortName;
-                l->firstInSort = true;
-            }
+            ShownRow s;
+            s.dataIndex = di;
 
-            if (included)
+            if (sortNameOf(s) != priorN)
             {
-                l->setBounds(0, ypos, getWidth(), DataRowEditor::height);
-                ypos += DataRowEditor::height;
-                addAndMakeVisible(*l);
+                priorN = sortNameOf(s);
+                s.firstInSort = true;
             }
 
-            l->hasFollower = false;
-            rows.push_back(std::move(l));
+            shownByRouting[routingKeyOf(d)] = shown.size();
+            shown.push_back(s);
         }
 
         // this is a bit gross but i can't think of a better way
-        for (int i = 1; i < rows.size(); ++i)
+        for (int i = 1; i < shown.size(); ++i)
         {
-            auto sni = sortOrder == BY_SOURCE ? rows[i]->datum.sname : rows[i]->datum.pname;
-            auto snm = sortOrder == BY_SOURCE ? rows[i - 1]->datum.sname : rows[i - 1]->datum.pname;
-            if (sni == snm)
-                rows[i - 1]->hasFollower = true;
+            if (sortNameOf(shown[i]) == sortNameOf(shown[i - 1]))
+                shown[i - 1].hasFollower = true;
         }
 
-        if (!rows.empty())
+        if (!shown.empty())
         {
-            rows.back()->isLast = true;
+            shown.back().isLast = true;
         }
 
+        int ypos = (int)shown.size() * DataRowEditor::height;
+
         bool needVSB = true;
         int sbw = 10;
 
@@ -1100,7 +1166,7 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
             sbw = editor->viewport->getScrollBarThickness() + 2;
             editor->viewport->setScrollBarsShown(sbw, false);
 
-            if (rows.empty())
+            if (shown.empty())
             {
                 ypos = editor->viewport->getHeight();
             }
@@ -1109,30 +1175,79 @@ struct ModulationListContents : public juce::Component, public Surge::GUI::SkinC
         auto w = viewportWidth - (needVSB ? sbw : 0) - 3;
 
         setSize(w, ypos);
+        rows.resize(shown.size());
+
+        moved(); // to make the rows on screen and refresh the 'istop'
+
+        if (preferredFocusRow < 0 || preferredFocusRow >= shown.size())
+            preferredFocusRow = 0;
 
-        for (const auto &r : rows)
+        if (preferredFocusRow >= 0 && preferredFocusRow < rows.size())
         {
-            auto b = r->getBounds().withWidth(w - 1);
-            r->setBounds(b);
+            // the row to focus may be off screen, and so not made yet
+            if (!rows[preferredFocusRow] && editor && editor->viewport)
+                editor->viewport->setViewPosition(0, preferredFocusRow * DataRowEditor::height);
+
+            if (rows[preferredFocusRow])
+                rows[preferredFocusRow]->beTheFocusedRow();
         }
+    }
 
-        moved(); // to refresh the 'istop'
+    int preferredFocusRow{0};
 
-        if (preferredFocusRow < 0 || preferredFocusRow >= dataRows.size())
-            preferredFocusRow = 0;
+    /*
+     * Brings one shown row up to date with the synth. Unless forced, a row whose depth and
+     * mute still match is left alone, which makes checking every row cheap. Rows without an
+     * editor just have their datum updated for when they scroll into view.
+     */
+    bool updateShownRow(size_t i, const SurgeSynthesizer *synth, bool force)
+    {
+        auto &d = dataRows[shown[i].dataIndex];
+
+        if (!force)
+        {
+            auto ptag = d.destination_id + d.idBase;
+            auto ms = (modsources)d.source_id;
+
+            if (synth->getModDepth01(ptag, ms, d.source_scene, d.source_index) == d.moddepth01 &&
+                synth->isModulationMuted(ptag, ms, d.source_scene, d.source_index) == d.isMuted)
+            {
+                return false;
+            }
+        }
+
+        populateDatum(d, synth);
+
+        if (rows[i])
+        {
+            rows[i]->muted = d.isMuted;
+            rows[i]->resetValuesFromDatum();
+        }
+
+        return true;
+    }
 
-        if (preferredFocusRow >= 0 && preferredFocusRow < rows.size() && rows[preferredFocusRow])
-            rows[preferredFocusRow]->beTheFocusedRow();
+    void updateAllValues(const SurgeSynthesizer *synth, bool force = false)
+    {
+        for (size_t i = 0; i < shown.size(); ++i)
+            updateShownRow(i, synth, force);
     }
 
-    int preferredFocusRow{0};
+    void updateRouting(uint64_t key, const SurgeSynthesizer *synth)
+    {
+        auto it = shownByRouting.find(key);
 
-    void updateAllValues(const SurgeSynthesizer *synth)
+        if (it != shownByRouting.end())
+            updateShownRow(it->second, synth, true);
+    }
+
+    // the target's own value is in every row's display, so those all have to be redone
+    void updateTarget(int ptag, const SurgeSynthesizer *synth)
     {
-        for (const auto &r : rows)
+        for (size_t i = 0; i < shown.size(); ++i)
         {
-            populateDatum(r->datum, synth);
-            r->resetValuesFromDatum();
+            const auto &d = dataRows[shown[i].dataIndex];
+            updateShownRow(i, synth, d.destination_id + d.idBase == ptag);
         }
     }
 
@@ -1770,27 +1885,47 @@ void ModulationEditor::rebuildContents()
         modContents->rebuildFrom(synth);
 }
 /*
- * At a later date I can make this more efficient but for now if any modulation changes
- * in the main UI just rebuild the table.
+ * Adding or clearing a routing reorders the list, so rebuilds it, but that only makes the
+ * rows on screen. A changed depth or mute only redoes its own row: the listener keeps the
+ * one routing which changed since the last idle, which is all a drag ever touches, and if
+ * a second one changes before we get to it we check every row for what differs.
  */
 void ModulationEditor::idle()
 {
-    // fixme compare exchange week
-    if (needsModUpdate)
+    if (needsModUpdate.exchange(false))
     {
-        needsModUpdate = false;
+        pendingValueRouting = noRouting;
+        needsModValueOnlyUpdate = false;
         modContents->rebuildFrom(synth);
+        return;
     }
-    if (needsModValueOnlyUpdate)
-    {
-        needsModValueOnlyUpdate = false;
+
+    auto key = pendingValueRouting.exchange(noRouting);
+
+    if (needsModValueOnlyUpdate.exchange(false))
         modContents->updateAllValues(synth);
-    }
+    else if (key != noRouting)
+        modContents->updateRouting(key, synth);
 }
 
 void ModulationEditor::updateParameterById(const SurgeSynthesizer::ID &pid)
 {
-    modContents->updateAllValues(synth);
+    auto ptag = pid.getSynthSideId();
+    auto p = synth->storage.getPatch().param_ptr[ptag];
+
+    // a new LFO type renames the modulator, which shows in rows this isn't the target of
+    if (p && p->ctrltype == ct_lfotype)
+        modContents->updateAllValues(synth, true);
+    else
+        modContents->updateTarget(ptag, synth);
+}
+
+void ModulationEditor::noteValueChange(uint64_t key)
+{
+    auto prior = pendingValueRouting.exchange(key);
+
+    if (prior != noRouting && prior != key)
+        needsModValueOnlyUpdate = true;
 }
 
 void ModulationEditor::modSet(long ptag, modsources modsource, int modsourceScene, int index,
@@ -1801,14 +1936,14 @@ void ModulationEditor::modSet(long ptag, modsources modsource, int modsourceScen
         if (isNew || value == 0)
             needsModUpdate = true;
         else
-            needsModValueOnlyUpdate = true;
+            noteValueChange(routingKey(ptag, modsource, modsourceScene, index));
     }
 }
 void ModulationEditor::modMuted(long ptag, modsources modsource, int modsourceScene, int index,
                                 bool mute)
 {
     if (!selfModulation)
-        needsModValueOnlyUpdate = true;
+        noteValueChange(routingKey(ptag, modsource, modsourceScene, index));
 }
 void ModulationEditor::modCleared(long ptag, modsources modsource, int modsourceScene, int index)
 {
@@ -62,6 +62,17 @@ class ModulationEditor : public OverlayComponent,
         ModulationEditor *moded;
     };
     std::atomic<bool> selfModulation{false}, needsModUpdate{false}, needsModValueOnlyUpdate{false};
+
+    // which row a routing is, as the listener callbacks name it
+    static uint64_t routingKey(long ptag, int modsource, int modsourceScene, int index)
+    {
+        return ((uint64_t)(uint32_t)ptag << 32) | ((uint64_t)(modsource & 0xFFFF) << 16) |
+               ((uint64_t)(modsourceScene & 0xFF) << 8) | (uint64_t)(index & 0xFF);
+    }
+    static constexpr uint64_t noRouting{~0ULL};
+    std::atomic<uint64_t> pendingValueRouting{noRouting};
+    void noteValueChange(uint64_t key);
+
     void modSet(long ptag, modsources modsource, int modsourceScene, int index, float value,
                 bool isNew) override;
     void modMuted(long ptag, modsources modsource, int modsourceScene, int index,
@@ -33,6 +33,9 @@
 #include <fmt/core.h>
 #include "RuntimeFont.h"
 #include "SkinColors.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
+#include "pffft.h"
 
 #include "widgets/MenuCustomComponents.h"
 
@@ -202,7 +205,7 @@ void WaveformDisplay::paint(juce::Graphics &g)
 #endif
 }
 
-void WaveformDisplay::process(std::vector<float> data)
+void WaveformDisplay::process(const float *data, std::size_t size)
 {
     std::unique_lock l(lock_);
     if (params_.freeze)
@@ -218,8 +221,10 @@ void WaveformDisplay::process(std::vector<float> data)
     float counterSpeed = params_.counterSpeed();
     float R = 1.f - 250.f / static_cast<float>(storage_->samplerate);
 
-    for (float &f : data)
+    for (std::size_t s = 0; s < size; ++s)
     {
+        const float f = data[s];
+
         // DC filter
         dcKill = f - dcFilterTemp + R * dcKill;
         dcFilterTemp = f;
@@ -521,6 +526,28 @@ void SpectrumDisplay::updateScopeData(internal::FftScopeType::iterator begin,
     }
 }
 
+void SpectrumDisplay::mouseDown(const juce::MouseEvent &event)
+{
+    if (!event.mods.isPopupMenu() || !getOverlap || !setOverlap)
+    {
+        return;
+    }
+
+    auto contextMenu = juce::PopupMenu();
+
+    Surge::Widgets::MenuCenteredBoldLabel::addToMenuAsSectionHeader(contextMenu, "FFT OVERLAP");
+
+    int current = getOverlap();
+
+    for (int ov : {1, 2, 4, 8})
+    {
+        auto label = ov == 1 ? std::string("None") : fmt::format("{}x", ov);
+        contextMenu.addItem(label, true, ov == current, [this, ov]() { setOverlap(ov); });
+    }
+
+    contextMenu.showMenuAsync(editor_->popupMenuOptions());
+}
+
 float SpectrumDisplay::interpolate(const float y0, const float y1,
                                    std::chrono::time_point<std::chrono::steady_clock> t) const
 {
@@ -532,13 +559,52 @@ float SpectrumDisplay::interpolate(const float y0, const float y1,
 // TODO:
 // (1) Give configuration to the user to choose FFT params (namely, desired Hz resolution).
 Oscilloscope::Oscilloscope(SurgeGUIEditor *e, SurgeStorage *s)
-    : editor_(e), storage_(s), forward_fft_(internal::fftOrder),
-      window_(internal::fftSize, juce::dsp::WindowingFunction<float>::hann), pos_(0),
-      complete_(false), fft_thread_(std::bind(std::mem_fn(&Oscilloscope::pullData), this)),
-      channel_selection_(STEREO), scope_mode_(SPECTRUM), left_chan_button_("L"),
-      right_chan_button_("R"), scope_mode_button_(*this), background_(s), spectrum_(e, s),
-      spectrum_parameters_(e, s, this), waveform_(e, s), waveform_parameters_(e, s, this)
+    : editor_(e), storage_(s), fft_setup_(pffft_new_setup(internal::fftSize, PFFFT_REAL)),
+      pos_(0), samples_since_fft_(0),
+      fft_overlap_(s->getPatch().dawExtraState.editor.oscilloscopeOverlayState.spectrum_overlap),
+      complete_(false), channel_selection_(STEREO), scope_mode_(SPECTRUM),
+      left_chan_button_("L"), right_chan_button_("R"), scope_mode_button_(*this), background_(s),
+      spectrum_(e, s), spectrum_parameters_(e, s, this), waveform_(e, s),
+      waveform_parameters_(e, s, this)
 {
+    auto allocate = []() {
+        auto *f = static_cast<float *>(pffft_aligned_malloc(internal::fftSize * sizeof(float)));
+        std::fill(f, f + internal::fftSize, 0.f);
+        return fft_buffer_t(f);
+    };
+
+    fft_in_ = allocate();
+    fft_out_ = allocate();
+    fft_work_ = allocate();
+
+    // Symmetric Hann, the same table juce::dsp::WindowingFunction used to give us.
+    for (int i = 0; i < internal::fftSize; i++)
+    {
+        window_[i] = 0.5f - 0.5f * std::cos(2.f * juce::MathConstants<float>::pi * i /
+                                             (internal::fftSize - 1));
+    }
+
+    std::fill(history_.begin(), history_.end(), 0.f);
+
+    if (fft_overlap_ != 1 && fft_overlap_ != 2 && fft_overlap_ != 4 && fft_overlap_ != 8)
+    {
+        fft_overlap_ = 1;
+    }
+
+    spectrum_.getOverlap = [this]() {
+        std::lock_guard l(data_lock_);
+        return fft_overlap_;
+    };
+    spectrum_.setOverlap = [this](int ov) {
+        std::lock_guard l(data_lock_);
+        fft_overlap_ = ov;
+        storage_->getPatch().dawExtraState.editor.oscilloscopeOverlayState.spectrum_overlap = ov;
+    };
+
+    // Everything the data thread touches is ready, so it can start now.
+    fft_thread_ = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Helper,
+                                               [this]() { pullData(); });
+
     setAccessible(true);
     setOpaque(true);
 
@@ -608,8 +674,15 @@ Oscilloscope::~Oscilloscope()
     fft_thread_.join();
     // Data thread can perform subscriptions, so do a final unsubscribe after it's done.
     storage_->audioOut.unsubscribe();
+
+    if (fft_setup_)
+    {
+        pffft_destroy_setup(fft_setup_);
+    }
 }
 
+void Oscilloscope::AlignedFree::operator()(float *f) const { pffft_aligned_free(f); }
+
 void Oscilloscope::onSkinChanged()
 {
     background_.setSkin(skin, associatedBitmapStore);
@@ -1246,8 +1319,23 @@ void Oscilloscope::visibilityChanged()
 // Lock for member variables must be held by the caller.
 void Oscilloscope::calculateSpectrumData()
 {
-    window_.multiplyWithWindowingTable(fft_data_.data(), internal::fftSize);
-    forward_fft_.performFrequencyOnlyForwardTransform(fft_data_.data());
+    // Unroll the history into time order, windowing as we go.
+    float *in = fft_in_.get();
+    float *out = fft_out_.get();
+    int tail = internal::fftSize - pos_;
+
+    for (int i = 0; i < tail; i++)
+    {
+        in[i] = history_[pos_ + i] * window_[i];
+    }
+
+    for (int i = 0; i < pos_; i++)
+    {
+        in[tail + i] = history_[i] * window_[tail + i];
+    }
+
+    // Ordered output is interleaved re/im, except the first pair which packs DC and Nyquist.
+    pffft_transform_ordered(fft_setup_, in, out, fft_work_.get(), PFFFT_FORWARD);
 
     float binHz = storage_->samplerate / static_cast<float>(internal::fftSize);
     for (int i = 0; i < internal::fftSize / 2; i++)
@@ -1259,7 +1347,9 @@ void Oscilloscope::calculateSpectrumData()
         }
         else
         {
-            scope_data_[i] = fft_data_[i];
+            scope_data_[i] = i == 0 ? std::abs(out[0])
+                                    : std::sqrt(out[2 * i] * out[2 * i] +
+                                                out[2 * i + 1] * out[2 * i + 1]);
         }
     }
 }
@@ -1320,6 +1410,7 @@ juce::Rectangle<int> Oscilloscope::getScopeRect()
 
 void Oscilloscope::pullData()
 {
+    auto fpuguard = Surge::FPUState::DSPThreadGuard();
     while (!complete_.load(std::memory_order_seq_cst))
     {
         std::unique_lock l(data_lock_);
@@ -1335,53 +1426,66 @@ void Oscilloscope::pullData()
             continue;
         }
         ChannelSelect cs = channel_selection_;
+        ScopeMode mode = scope_mode_;
+        int hop = internal::fftSize / fft_overlap_;
 
-        std::pair<std::vector<float>, std::vector<float>> data = storage_->audioOut.popall();
-        std::vector<float> &dataL = data.first;
-        std::vector<float> &dataR = data.second;
-        if (dataL.empty())
+        // Drain the ring into our own buffers. The audio thread only ever does a lock-free push,
+        // so nothing here can contend with it.
+        std::size_t sz = 0;
+        while (sz < internal::drainSize)
         {
-            // Sleep for long enough to accumulate about 4096 samples, or half that in waveform
-            // mode.
-            ScopeMode mode = scope_mode_;
-            l.unlock();
-            std::this_thread::sleep_for(std::chrono::duration<float, std::chrono::seconds::period>(
-                internal::fftSize / (mode == SPECTRUM ? 2.f : 4.f) / storage_->samplerate));
+            auto frame = storage_->audioOut.pop();
+            if (!frame)
+            {
+                break;
+            }
+            drain_l_[sz] = frame->first;
+            drain_r_[sz] = frame->second;
+            sz++;
+        }
+
+        if (sz == 0)
+        {
+            // Wait long enough to accumulate about one hop's worth of samples, or a quarter of the
+            // FFT size in waveform mode. Waiting on the condition variable rather than sleeping
+            // lets the destructor and channel changes wake us straight away.
+            auto wait = std::chrono::duration<float, std::chrono::seconds::period>(
+                (mode == SPECTRUM ? std::min(hop, internal::fftSize / 2) : internal::fftSize / 4) /
+                storage_->samplerate);
+            channels_off_.wait_for(l, wait);
             continue;
         }
 
-        // We'll use "dataL" as our storage regardless of the channel choice.
+        // We'll use drain_l_ as our storage regardless of the channel choice.
         if (cs == STEREO)
         {
-            std::transform(dataL.cbegin(), dataL.cend(), dataR.cbegin(), dataL.begin(),
-                           [](float x, float y) { return (x + y) / 2.f; });
+            for (std::size_t i = 0; i < sz; i++)
+            {
+                drain_l_[i] = (drain_l_[i] + drain_r_[i]) / 2.f;
+            }
         }
         else if (cs == RIGHT)
         {
-            dataL = dataR;
+            std::copy(drain_r_.begin(), drain_r_.begin() + sz, drain_l_.begin());
         }
 
-        if (scope_mode_ == WAVEFORM)
+        if (mode == WAVEFORM)
         {
-            waveform_.process(std::move(dataL));
+            waveform_.process(drain_l_.data(), sz);
         }
         else
         {
-            int sz = dataL.size();
-            if (pos_ + sz >= internal::fftSize)
-            {
-                int mv = internal::fftSize - pos_;
-                int leftovers = sz - mv;
-                std::move(dataL.begin(), dataL.begin() + mv, fft_data_.begin() + pos_);
-                calculateSpectrumData();
-                spectrum_.updateScopeData(scope_data_.begin(), scope_data_.end());
-                std::move(dataL.begin() + mv, dataL.end(), fft_data_.begin());
-                pos_ = leftovers;
-            }
-            else
+            for (std::size_t i = 0; i < sz; i++)
             {
-                std::move(dataL.begin(), dataL.end(), fft_data_.begin() + pos_);
-                pos_ += sz;
+                history_[pos_] = drain_l_[i];
+                pos_ = (pos_ + 1) & (internal::fftSize - 1);
+
+                if (++samples_since_fft_ >= hop)
+                {
+                    samples_since_fft_ = 0;
+                    calculateSpectrumData();
+                    spectrum_.updateScopeData(scope_data_.begin(), scope_data_.end());
+                }
             }
         }
     }
@@ -26,6 +26,8 @@
 #include <array>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -43,6 +45,8 @@
 #include "juce_gui_basics/juce_gui_basics.h"
 #include "sst/cpputils.h"
 
+struct PFFFT_Setup;
+
 namespace Surge
 {
 namespace Overlays
@@ -50,11 +54,13 @@ namespace Overlays
 
 namespace internal
 {
-constexpr int fftOrder = 13;
 constexpr int fftSize = 8192;
 
 // Really wish span was available.
 using FftScopeType = std::array<float, fftSize / 2>;
+
+// How many samples the data thread drains from the audio ring at a time.
+constexpr int drainSize = 512;
 } // namespace internal
 
 // Waveform-specific display taken from s(m)exoscope GPL code and adapted to use with Surge.
@@ -102,7 +108,7 @@ class WaveformDisplay : public juce::Component, public Surge::GUI::SkinConsuming
     void mouseDown(const juce::MouseEvent &event) override;
     void paint(juce::Graphics &g) override;
     void resized() override;
-    void process(std::vector<float> data);
+    void process(const float *data, std::size_t size);
 
   private:
     SurgeGUIEditor *editor_;
@@ -179,6 +185,11 @@ class SpectrumDisplay : public juce::Component, public Surge::GUI::SkinConsuming
     void resized() override;
     void updateScopeData(internal::FftScopeType::iterator begin,
                          internal::FftScopeType::iterator end);
+    void mouseDown(const juce::MouseEvent &event) override;
+
+    // FFT overlap factor, owned by the Oscilloscope. Offered on right-click.
+    std::function<int()> getOverlap;
+    std::function<void(int)> setOverlap;
 
   private:
     float interpolate(const float y0, const float y1,
@@ -396,10 +407,26 @@ class Oscilloscope : public OverlayComponent,
 
     SurgeGUIEditor *editor_{nullptr};
     SurgeStorage *storage_{nullptr};
-    juce::dsp::FFT forward_fft_;
-    juce::dsp::WindowingFunction<float> window_;
-    std::array<float, 2 * internal::fftSize> fft_data_;
+
+    // FFT state, only touched by the data thread once constructed. The input and output buffers
+    // are SIMD-aligned for pffft; history_ is a circular buffer of the last fftSize samples.
+    struct AlignedFree
+    {
+        void operator()(float *f) const;
+    };
+    typedef std::unique_ptr<float[], AlignedFree> fft_buffer_t;
+    PFFFT_Setup *fft_setup_{nullptr};
+    fft_buffer_t fft_in_, fft_out_, fft_work_;
+    std::array<float, internal::fftSize> window_;
+    std::array<float, internal::fftSize> history_;
     int pos_;
+    int samples_since_fft_;
+    // 1, 2, 4 or 8 transforms per fftSize samples. Guarded by data_lock_.
+    int fft_overlap_;
+
+    // Preallocated drain buffers for the audio ring, so the data thread never allocates.
+    std::array<float, internal::drainSize> drain_l_, drain_r_;
+
     internal::FftScopeType scope_data_;
     ChannelSelect channel_selection_;
     ScopeMode scope_mode_;
@@ -335,9 +335,8 @@ class PatchDBSQLTableModel : public juce::TableListBoxModel
         editor->closeOverlay(SurgeGUIEditor::PATCH_BROWSER);
     }
 
-    void executeQuery(const std::string &n) { data = storage->patchDB->rawQueryForNameLike(n); }
-
     std::vector<Surge::PatchStorage::PatchDB::patchRecord> data;
+    uint64_t queryGeneration{0};
     SurgeStorage *storage;
     SurgeGUIEditor *editor;
 
@@ -353,6 +352,8 @@ PatchDBViewer::PatchDBViewer(SurgeGUIEditor *e, SurgeStorage *s)
 PatchDBViewer::~PatchDBViewer()
 {
     treeView->setRootItem(nullptr);
+    storage->patchDB->cancelAsyncQueries(
+        Surge::PatchStorage::PatchDB::channelFor(storage, "patch-db-viewer"));
     if (countdownClock)
     {
         countdownClock->stopTimer();
@@ -455,8 +456,23 @@ void PatchDBViewer::checkJobsOverlay()
 }
 void PatchDBViewer::executeQuery()
 {
-    tableModel->executeQuery(nameTypein->getText().toStdString());
-    table->updateContent();
+    // Run the search on the PatchDB reader and keep showing the old rows until it's back.
+    auto gen = ++tableModel->queryGeneration;
+    auto sp = juce::Component::SafePointer<PatchDBViewer>(this);
+
+    storage->patchDB->rawQueryForNameLikeAsync(
+        Surge::PatchStorage::PatchDB::channelFor(storage, "patch-db-viewer"),
+        nameTypein->getText().toStdString(),
+        [sp, gen](std::vector<Surge::PatchStorage::PatchDB::patchRecord> &&res) {
+            juce::MessageManager::callAsync([sp, gen, r = std::move(res)]() mutable {
+                if (sp && sp->tableModel->queryGeneration == gen)
+                {
+                    sp->tableModel->data = std::move(r);
+                    sp->table->updateContent();
+                    sp->table->repaint();
+                }
+            });
+        });
 }
 void PatchDBViewer::textEditorTextChanged(juce::TextEditor &editor) { executeQuery(); }
 
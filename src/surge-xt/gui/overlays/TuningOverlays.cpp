@@ -1511,6 +1511,10 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
         {
             rcents.push_back(t.cents + lastc);
         }
+
+        evenStepCents =
+            t.scale.count > 0 ? t.scale.tones[t.scale.count - 1].cents / t.scale.count : 0.0;
+
         intervalPainter->setSizeFromTuning();
         intervalPainter->repaint();
     }
@@ -1682,10 +1686,21 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
             auto ic = matrix->tuning.scale.count;
             int mt = ic + (mode == ROTATION ? 1 : 2);
             g.setFont(skin->fontManager->getLatoAtSize(9));
-            for (int i = 0; i < mt; ++i)
+
+            // A big scale makes for a huge matrix in the viewport, so only draw the cells we
+            // have been asked to (the visible part, or just the cells a hover change touched)
+            auto clip = g.getClipBounds();
+            int i0 = std::max(0, clip.getX() / cellW);
+            int i1 = std::min(mt, clip.getRight() / cellW + 1);
+            int j0 = std::max(0, clip.getY() / cellH);
+            int j1 = std::min(mt, clip.getBottom() / cellH + 1);
+
+            auto evenStep = matrix->evenStepCents;
+
+            for (int i = i0; i < i1; ++i)
             {
                 bool noi = i > 0 ? matrix->notesOn[i - 1] : false;
-                for (int j = 0; j < mt; ++j)
+                for (int j = j0; j < j1; ++j)
                 {
                     bool noj = j > 0 ? matrix->notesOn[j - 1] : false;
                     bool isHovered = false;
@@ -1742,9 +1757,6 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
 
                         auto cdiff = centsi - centsj;
                         auto disNote = i - j;
-                        auto lastTone =
-                            matrix->tuning.scale.tones[matrix->tuning.scale.count - 1].cents;
-                        auto evenStep = lastTone / matrix->tuning.scale.count;
                         auto desCents = disNote * evenStep;
 
                         // ToDo: Skin these endpoints
@@ -1792,9 +1804,6 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
                         auto cdiff = centsj - centsi;
 
                         auto disNote = i - 1;
-                        auto lastTone =
-                            matrix->tuning.scale.tones[matrix->tuning.scale.count - 1].cents;
-                        auto evenStep = lastTone / matrix->tuning.scale.count;
                         auto desCents = disNote * evenStep;
 
                         if (fabs(cdiff - desCents) < 0.1)
@@ -1933,8 +1942,12 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
 
         void mouseMove(const juce::MouseEvent &e) override
         {
+            int ohi = hoverI, ohj = hoverJ;
             if (setupHoverFrom(e.position))
-                repaint();
+            {
+                repaintHoverCells(ohi, ohj);
+                repaintHoverCells(hoverI, hoverJ);
+            }
             if (hoverI >= 1 && hoverI <= matrix->tuning.scale.count && hoverJ >= 1 &&
                 hoverJ <= matrix->tuning.scale.count && hoverI > hoverJ)
             {
@@ -1946,6 +1959,17 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
             }
         }
 
+        // A hover lights up its cell and the two note labels at the head of its row and column
+        void repaintHoverCells(int i, int j)
+        {
+            if (i < 0 || j < 0)
+                return;
+
+            repaint(i * cellW, j * cellH, cellW, cellH);
+            repaint(0, j * cellH, cellW, cellH);
+            repaint(i * cellW, 0, cellW, cellH);
+        }
+
         bool setupHoverFrom(const juce::Point<float> &here)
         {
             int ohi = hoverI, ohj = hoverJ;
@@ -2019,6 +2043,8 @@ struct IntervalMatrix : public juce::Component, public Surge::GUI::SkinConsuming
     std::unique_ptr<juce::Label> explLabel;
 
     Tunings::Tuning tuning;
+    // Worked out once per tuning rather than once per cell
+    double evenStepCents{0};
     TuningOverlay *overlay{nullptr};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IntervalMatrix);
@@ -25,10 +25,15 @@
 #include "SurgeImage.h"
 #include "SurgeGUIEditor.h"
 #include "SurgeGUIUtils.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
 #include "SurgeJUCEHelpers.h"
 #include "RuntimeFont.h"
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "widgets/MenuCustomComponents.h"
 #include "AccessibleHelpers.h"
 #include "overlays/TypeinParamEditor.h"
@@ -56,9 +61,603 @@ struct TimeB
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
 };
 
+/*
+ * Runs the LFO (and a second copy of it, for a deactivated rate or the ghosted full
+ * amplitude wave) through enough blocks to draw it, and builds the paths which are drawn.
+ * The modulation sources are reused from one simulation to the next.
+ */
+struct LFOAndStepDisplay::Simulator
+{
+    LFOModulationSource lfo, fullWave;
+    LFOStorage deactivateStorage;
+    pdata tp[n_scene_params], tpd[n_scene_params];
+
+    void populate(LFOModulationSource *s, const SimulationInputs &in, SurgeStorage *storage)
+    {
+        if (in.lfoid < n_lfos_voice)
+            s->setIsVoice(true);
+        else
+            s->setIsVoice(false);
+
+        if (s->isVoice)
+            s->formulastate.velocity = 100;
+
+        Surge::Formula::setupEvaluatorStateFrom(s->formulastate, storage->getPatch(), in.scene);
+    }
+
+    Simulation waveform(const SimulationKey &key, const SimulationInputs &in,
+                        SurgeStorage *storage);
+    Simulation stepSeq(const SimulationKey &key, const SimulationInputs &in,
+                       SurgeStorage *storage);
+};
+
+LFOAndStepDisplay::Simulation
+LFOAndStepDisplay::Simulator::waveform(const SimulationKey &key, const SimulationInputs &in,
+                                       SurgeStorage *storage)
+{
+    TimeB mainTimer("-- simulateWaveform");
+
+    auto *lfodata = in.lfodata;
+    auto *ss = in.ss;
+    auto *ms = in.ms;
+    auto *fs = in.fs;
+    auto modIndex = in.modIndex;
+    bool isUnipolar = lfodata->unipolar.val.b;
+
+    Simulation res;
+    res.key = key;
+
+    auto &path = res.path;
+    auto &eupath = res.eupath;
+    auto &edpath = res.edpath;
+    auto &deactPath = res.deactPath;
+
+    tp[lfodata->delay.param_id_in_scene].i = lfodata->delay.val.i;
+    tp[lfodata->attack.param_id_in_scene].i = lfodata->attack.val.i;
+    tp[lfodata->hold.param_id_in_scene].i = lfodata->hold.val.i;
+    tp[lfodata->decay.param_id_in_scene].i = lfodata->decay.val.i;
+    tp[lfodata->sustain.param_id_in_scene].i = lfodata->sustain.val.i;
+    tp[lfodata->release.param_id_in_scene].i = lfodata->release.val.i;
+
+    tp[lfodata->magnitude.param_id_in_scene].i = lfodata->magnitude.val.i;
+    tp[lfodata->rate.param_id_in_scene].i = lfodata->rate.val.i;
+    tp[lfodata->shape.param_id_in_scene].i = lfodata->shape.val.i;
+    tp[lfodata->start_phase.param_id_in_scene].i = lfodata->start_phase.val.i;
+    tp[lfodata->deform.param_id_in_scene].i = lfodata->deform.val.i;
+    tp[lfodata->trigmode.param_id_in_scene].i = lm_keytrigger;
+
+    float susTime = 0.5;
+    float lfoEnvelopeDAHDTime = pow(2.0f, lfodata->delay.val.f) + pow(2.0f, lfodata->attack.val.f) +
+                                pow(2.0f, lfodata->hold.val.f) + pow(2.0f, lfodata->decay.val.f);
+
+    if (lfodata->shape.val.i == lt_mseg)
+    {
+        // We want the sus time to get us through at least one loop
+        if (ms->loopMode == MSEGStorage::GATED_LOOP && ms->editMode == MSEGStorage::ENVELOPE &&
+            ms->loop_end >= 0)
+        {
+            float loopEndsAt = ms->segmentEnd[ms->loop_end];
+            susTime = std::max(0.5f, loopEndsAt - lfoEnvelopeDAHDTime);
+        }
+    }
+
+    float totalEnvTime = lfoEnvelopeDAHDTime + std::min(pow(2.0f, lfodata->release.val.f), 4.f) +
+                         0.5; // susTime; this is now 0.5 to keep the envelope fixed in gate mode
+
+    float rateInHz = pow(2.0, (double)lfodata->rate.val.f);
+    if (lfodata->rate.temposync)
+        rateInHz *= storage->temposyncratio;
+
+    /*
+     * What we want is no more than 50 wavelengths. So
+     *
+     * totalEnvTime * rateInHz < 50
+     *
+     * totalEnvTime < 50 / rateInHz
+     *
+     * so
+     */
+    totalEnvTime = std::min(totalEnvTime, 50.f / rateInHz);
+
+    LFOModulationSource *tlfo = &lfo;
+    LFOModulationSource *tFullWave = nullptr;
+    tlfo->assign(storage, lfodata, tp, 0, ss, ms, fs, true);
+    populate(tlfo, in, storage);
+    tlfo->attack();
+
+    if (lfodata->rate.deactivated)
+    {
+        res.hasFullWave = true;
+        deactivateStorage = *lfodata;
+        std::copy(std::begin(tp), std::end(tp), std::begin(tpd));
+
+        auto desiredRate = log2(1.f / totalEnvTime);
+        if (lfodata->shape.val.i == lt_mseg)
+        {
+            desiredRate = log2(ms->totalDuration / totalEnvTime);
+        }
+
+        deactivateStorage.rate.deactivated = false;
+        deactivateStorage.rate.val.f = desiredRate;
+        deactivateStorage.start_phase.val.f = 0;
+        tpd[lfodata->start_phase.param_id_in_scene].f = 0;
+        tpd[lfodata->rate.param_id_in_scene].f = desiredRate;
+        tFullWave = &fullWave;
+        tFullWave->assign(storage, &deactivateStorage, tpd, 0, ss, ms, fs, true);
+        populate(tFullWave, in, storage);
+        tFullWave->attack();
+    }
+    else if (lfodata->magnitude.val.f != lfodata->magnitude.val_max.f && in.ghostAmpWave)
+    {
+        res.hasFullWave = true;
+        res.waveIsAmpWave = true;
+        deactivateStorage = *lfodata;
+        std::copy(std::begin(tp), std::end(tp), std::begin(tpd));
+
+        deactivateStorage.magnitude.val.f = 1.f;
+        tpd[lfodata->magnitude.param_id_in_scene].f = 1.f;
+        tFullWave = &fullWave;
+        tFullWave->assign(storage, &deactivateStorage, tpd, 0, ss, ms, fs, true);
+        populate(tFullWave, in, storage);
+        tFullWave->attack();
+    }
+
+    if (lfodata->shape.val.i == lt_formula)
+    {
+        if (!tlfo->formulastate.useEnvelope)
+        {
+            totalEnvTime = 5.5;
+        }
+    }
+
+    res.drawEnvelope = !lfodata->delay.deactivated;
+
+    int minSamples = (1 << 0) * in.width;
+    int totalSamples =
+        std::max((int)minSamples, (int)(totalEnvTime * storage->samplerate / BLOCK_SIZE));
+    res.drawnTime = totalSamples * storage->samplerate_inv * BLOCK_SIZE;
+
+    // OK so let's assume we want about 1000 pixels worth tops in
+    int averagingWindow = (int)(totalSamples / 1000.0) + 1;
+
+    float valScale = 100.0;
+    int susCountdown = -1;
+
+    float priorval = 0.f, priorwval = 0.f;
+
+    for (int i = 0; i < totalSamples; i += averagingWindow)
+    {
+        float val = 0;
+        float wval = 0;
+        float eval = 0;
+        float minval = 1000000, minwval = 1000000;
+        float maxval = -1000000, maxwval = -1000000;
+
+        for (int s = 0; s < averagingWindow; s++)
+        {
+            tlfo->process_block();
+
+            if (tFullWave)
+            {
+                tFullWave->process_block();
+            }
+
+            if (lfodata->shape.val.i == lt_formula)
+            {
+                if (!tlfo->formulastate.isFinite ||
+                    (tFullWave && !tFullWave->formulastate.isFinite))
+                {
+                    res.warnForInvalid = true;
+                    res.invalidMessage = "Formula produced nan or inf";
+                }
+            }
+
+            if (susCountdown < 0 && tlfo->env_state == lfoeg_stuck)
+            {
+                susCountdown = susTime * storage->samplerate / BLOCK_SIZE;
+            }
+            else if (susCountdown == 0 && tlfo->env_state == lfoeg_stuck)
+            {
+                tlfo->release();
+
+                if (tFullWave)
+                {
+                    tFullWave->release();
+                }
+            }
+            else if (susCountdown > 0)
+            {
+                susCountdown--;
+            }
+
+            val += tlfo->get_output(modIndex);
+
+            if (tFullWave)
+            {
+                auto v = tFullWave->get_output(modIndex);
+
+                minwval = std::min(v, minwval);
+                maxwval = std::max(v, maxwval);
+                wval += v;
+            }
+
+            minval = std::min(tlfo->get_output(modIndex), minval);
+            maxval = std::max(tlfo->get_output(modIndex), maxval);
+            eval += tlfo->env_val * lfodata->magnitude.get_extended(lfodata->magnitude.val.f);
+        }
+
+        val = val / averagingWindow;
+        wval = wval / averagingWindow;
+        eval = eval / averagingWindow;
+        val = ((-val + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        wval = ((-wval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        minwval = ((-minwval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        maxwval = ((-maxwval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+
+        float euval = ((-eval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        float edval = ((eval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        float xc = valScale * i / totalSamples;
+
+        if (i == 0)
+        {
+            path.startNewSubPath(xc, val);
+            eupath.startNewSubPath(xc, euval);
+
+            if (!isUnipolar)
+            {
+                edpath.startNewSubPath(xc, edval);
+            }
+
+            if (tFullWave)
+            {
+                deactPath.startNewSubPath(xc, wval);
+            }
+
+            priorval = val;
+            priorwval = wval;
+        }
+        else
+        {
+            minval = ((-minval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+            maxval = ((-maxval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+            // Windows is sensitive to out-of-order line draws in a way which causes spikes.
+            // Make sure we draw one closest to prior first. See #1438
+            float firstval = minval;
+            float secondval = maxval;
+
+            if (priorval - minval < maxval - priorval)
+            {
+                firstval = maxval;
+                secondval = minval;
+            }
+
+            path.lineTo(xc - 0.1 * valScale / totalSamples, firstval);
+            path.lineTo(xc + 0.1 * valScale / totalSamples, secondval);
+
+            priorval = val;
+            eupath.lineTo(xc, euval);
+            edpath.lineTo(xc, edval);
+
+            // We can skip the ordering thing since we know we have set rate here to a low rate
+            if (tFullWave)
+            {
+                firstval = minwval;
+                secondval = maxwval;
+                if (priorwval - minwval < maxwval - priorwval)
+                {
+                    firstval = maxwval;
+                    secondval = minwval;
+                }
+                deactPath.lineTo(xc - 0.1 * valScale / totalSamples, firstval);
+                deactPath.lineTo(xc + 0.1 * valScale / totalSamples, secondval);
+                priorwval = wval;
+            }
+        }
+    }
+
+    if (lfodata->shape.val.i == lt_formula)
+    {
+        res.drawEnvelope = tlfo->formulastate.useEnvelope;
+    }
+
+    tlfo->completedModulation();
+
+    if (tFullWave)
+    {
+        tFullWave->completedModulation();
+    }
+
+    return res;
+}
+
+LFOAndStepDisplay::Simulation
+LFOAndStepDisplay::Simulator::stepSeq(const SimulationKey &key, const SimulationInputs &in,
+                                      SurgeStorage *storage)
+{
+    auto *lfodata = in.lfodata;
+    bool isUnipolar = lfodata->unipolar.val.b;
+
+    Simulation res;
+    res.key = key;
+
+    auto &path = res.path;
+    auto &eupath = res.eupath;
+    auto &edpath = res.edpath;
+
+    tp[lfodata->delay.param_id_in_scene].i = lfodata->delay.val.i;
+    tp[lfodata->attack.param_id_in_scene].i = lfodata->attack.val.i;
+    tp[lfodata->hold.param_id_in_scene].i = lfodata->hold.val.i;
+    tp[lfodata->decay.param_id_in_scene].i = lfodata->decay.val.i;
+    tp[lfodata->sustain.param_id_in_scene].i = lfodata->sustain.val.i;
+    tp[lfodata->release.param_id_in_scene].i = lfodata->release.val.i;
+
+    tp[lfodata->magnitude.param_id_in_scene].i = lfodata->magnitude.val.i;
+
+    // Min out the rate. Be careful with temposync.
+    float floorrate = -1.2; // can't be const - we mod it
+    float displayRate = lfodata->rate.val.f;
+    const float twotofloor = powf(2.0, -1.2); // so copy value here
+
+    if (lfodata->rate.temposync)
+    {
+        /*
+         * So frequency = temposyncration * 2^rate
+         * We want floor of frequency to be 2^-3.5 (that's the check below)
+         * So 2^rate = temposyncratioinb 2^-3.5;
+         * rate = log2( 2^-3.5 * tsratioinb )
+         */
+        floorrate = std::max(floorrate, log2(twotofloor * storage->temposyncratio_inv));
+    }
+
+    if (lfodata->rate.val.f < floorrate)
+    {
+        tp[lfodata->rate.param_id_in_scene].f = floorrate;
+        displayRate = floorrate;
+    }
+    else
+    {
+        tp[lfodata->rate.param_id_in_scene].i = lfodata->rate.val.i;
+    }
+
+    tp[lfodata->shape.param_id_in_scene].i = lfodata->shape.val.i;
+    tp[lfodata->start_phase.param_id_in_scene].i = lfodata->start_phase.val.i;
+    tp[lfodata->deform.param_id_in_scene].i = lfodata->deform.val.i;
+    tp[lfodata->trigmode.param_id_in_scene].i = lm_keytrigger;
+
+    /*
+    ** First big difference - the total env time is basically 16 * the time of the rate
+    */
+    float freq = pow(2.0, displayRate); // frequency in hz
+    if (lfodata->rate.temposync)
+    {
+        freq *= storage->temposyncratio;
+    }
+
+    float cyclesec = 1.0 / freq;
+    float totalSampleTime = cyclesec * n_stepseqsteps;
+    float susTime = 4.0 * cyclesec;
+
+    LFOModulationSource *tlfo = &lfo;
+    tlfo->assign(storage, lfodata, tp, 0, in.ss, in.ms, in.fs, true);
+    populate(tlfo, in, storage);
+    tlfo->attack();
+
+    int minSamples = (1 << 4) * in.width;
+    int totalSamples =
+        std::max((int)minSamples, (int)(totalSampleTime * storage->samplerate / BLOCK_SIZE));
+    float cycleSamples = cyclesec * storage->samplerate / BLOCK_SIZE;
+
+    // OK so lets assume we want about 1000 pixels worth tops in
+    int averagingWindow = (int)(totalSamples / 2000.0) + 1;
+
+    float valScale = 100.0;
+    int susCountdown = -1;
+
+    for (int i = 0; i < totalSamples; i += averagingWindow)
+    {
+        float val = 0;
+        float eval = 0;
+
+        for (int s = 0; s < averagingWindow; s++)
+        {
+            tlfo->process_block();
+
+            if (susCountdown < 0 && tlfo->env_state == lfoeg_stuck)
+            {
+                susCountdown = susTime * storage->samplerate / BLOCK_SIZE;
+            }
+            else if (susCountdown == 0 && tlfo->env_state == lfoeg_stuck)
+            {
+                tlfo->release();
+            }
+            else if (susCountdown > 0)
+            {
+                susCountdown--;
+            }
+
+            val += tlfo->get_output(0);
+            eval += tlfo->env_val * lfodata->magnitude.get_extended(lfodata->magnitude.val.f);
+        }
+
+        val = val / averagingWindow;
+        eval = eval / averagingWindow;
+
+        if (isUnipolar)
+        {
+            val = val * 2.0 - 1.0;
+        }
+
+        val = ((-val + 1.0f) * 0.5) * valScale;
+
+        float euval = ((-eval + 1.0f) * 0.5) * valScale;
+        float edval = ((eval + 1.0f) * 0.5) * valScale;
+        float xc = valScale * i / (cycleSamples * n_stepseqsteps);
+
+        if (i == 0)
+        {
+            path.startNewSubPath(xc, val);
+            eupath.startNewSubPath(xc, euval);
+
+            if (!isUnipolar)
+            {
+                edpath.startNewSubPath(xc, edval);
+            }
+        }
+        else
+        {
+            path.lineTo(xc, val);
+            eupath.lineTo(xc, euval);
+
+            if (!isUnipolar)
+            {
+                edpath.lineTo(xc, edval);
+            }
+        }
+    }
+
+    tlfo->completedModulation();
+
+    return res;
+}
+
+/*
+ * One background thread per display, which simulates whichever MSEG or formula LFO was asked
+ * for most recently and hands it back. Each request copies the LFO and its MSEG or formula, so
+ * the simulation never reads anything the UI might be editing.
+ */
+struct LFOAndStepDisplay::BackgroundSimulator
+{
+    explicit BackgroundSimulator(LFOAndStepDisplay *d) : display(d)
+    {
+        worker = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Helper,
+                                              [this]() { run(); });
+    }
+
+    ~BackgroundSimulator()
+    {
+        {
+            std::lock_guard<std::mutex> g(lock);
+            keepRunning = false;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    // from the message thread
+    void request(const SimulationKey &key, const SimulationInputs &in, SurgeStorage *storage)
+    {
+        {
+            std::lock_guard<std::mutex> g(lock);
+            pendingKey = key;
+            pendingStorage = storage;
+            pending->copyFrom(in);
+            hasPending = true;
+        }
+        cv.notify_one();
+    }
+
+    // from the message thread; true if a newer simulation than the last one taken was swapped in
+    bool take(Simulation &into)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        if (!hasFinished)
+            return false;
+
+        std::swap(into, finished);
+        hasFinished = false;
+        return true;
+    }
+
+  private:
+    struct Snapshot
+    {
+        LFOStorage lfo;
+        StepSequencerStorage ss;
+        MSEGStorage ms;
+        FormulaModulatorStorage fs;
+        SimulationInputs in;
+
+        void copyFrom(const SimulationInputs &from)
+        {
+            in = from;
+
+            lfo = *from.lfodata;
+            in.lfodata = &lfo;
+
+            if (from.ss)
+            {
+                ss = *from.ss;
+                in.ss = &ss;
+            }
+
+            if (from.ms)
+            {
+                ms = *from.ms;
+                in.ms = &ms;
+            }
+
+            if (from.fs)
+            {
+                fs = *from.fs;
+                in.fs = &fs;
+            }
+        }
+    };
+
+    void run()
+    {
+        auto fpuguard = Surge::FPUState::DSPThreadGuard();
+        std::unique_lock<std::mutex> lk(lock);
+        while (true)
+        {
+            cv.wait(lk, [this]() { return !keepRunning || hasPending; });
+            if (!keepRunning)
+                return;
+
+            auto key = pendingKey;
+            auto *storage = pendingStorage;
+            std::swap(pending, simulating);
+            hasPending = false;
+            lk.unlock();
+
+            Simulation res;
+            {
+                std::lock_guard<std::mutex> g(storage->formulaGlobalData->displayStateMutex);
+                res = simulator.waveform(key, simulating->in, storage);
+            }
+
+            lk.lock();
+            finished = std::move(res);
+            hasFinished = true;
+
+            juce::MessageManager::callAsync([safe = display]() {
+                if (safe)
+                    safe->repaint();
+            });
+        }
+    }
+
+    juce::Component::SafePointer<LFOAndStepDisplay> display;
+    Simulator simulator;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool keepRunning{true}, hasPending{false}, hasFinished{false};
+
+    SimulationKey pendingKey;
+    SurgeStorage *pendingStorage{nullptr};
+    std::unique_ptr<Snapshot> pending{std::make_unique<Snapshot>()},
+        simulating{std::make_unique<Snapshot>()};
+    Simulation finished;
+
+    std::thread worker;
+};
+
 LFOAndStepDisplay::LFOAndStepDisplay(SurgeGUIEditor *e)
     : juce::Component(), WidgetBaseMixin<LFOAndStepDisplay>(this), guiEditor(e)
 {
+    simulator = std::make_unique<Simulator>();
+
     setTitle("LFO Type And Display");
     setAccessible(true);
     setFocusContainerType(juce::Component::FocusContainerType::focusContainer);
@@ -331,6 +930,117 @@ LFOAndStepDisplay::LFOAndStepDisplay(SurgeGUIEditor *e)
     stepLayer->addChildComponent(*loopEndOverlays[1]);
 }
 
+LFOAndStepDisplay::~LFOAndStepDisplay()
+{
+    // join the background simulation before anything it might call back into goes away
+    backgroundSimulator.reset();
+
+    if (storage && storage->formulaGlobalData)
+    {
+        std::lock_guard<std::mutex> g(storage->formulaGlobalData->displayStateMutex);
+        simulator.reset();
+    }
+}
+
+LFOAndStepDisplay::SimulationInputs LFOAndStepDisplay::currentSimulationInputs(int width)
+{
+    SimulationInputs in;
+    in.lfodata = lfodata;
+    in.ss = ss;
+    in.ms = ms;
+    in.fs = fs;
+    in.lfoid = lfoid;
+    in.scene = guiEditor->current_scene;
+    in.modIndex = modIndex;
+    in.width = width;
+    in.ghostAmpWave = skin->getVersion() >= 2 &&
+                      Surge::Storage::getUserDefaultValue(
+                          storage, Surge::Storage::ShowGhostedLFOWaveReference, 1);
+    return in;
+}
+
+LFOAndStepDisplay::SimulationKey LFOAndStepDisplay::currentSimulationKey(bool forStepSeq,
+                                                                         const SimulationInputs &in)
+{
+    SimulationKey k;
+    auto add = [&k](auto v) { k.push_back((uint32_t)v); };
+    auto addf = [&k](float f) {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        k.push_back(u);
+    };
+
+    add(forStepSeq);
+    add(in.width);
+    add(in.lfoid);
+    add(in.scene);
+    add(in.modIndex);
+    add(in.ghostAmpWave);
+    addf(storage->samplerate);
+    addf(storage->temposyncratio);
+    add(lfodata->lfoExtraAmplitude);
+
+    for (auto *p = &lfodata->rate; p <= &lfodata->release; ++p)
+    {
+        add(p->val.i);
+        add(p->temposync | p->deactivated << 1 | p->extend_range << 2);
+        add(p->deform_type);
+    }
+
+    switch (lfodata->shape.val.i)
+    {
+    case lt_stepseq:
+        if (ss)
+        {
+            for (auto v : ss->steps)
+                addf(v);
+
+            add(ss->loop_start);
+            add(ss->loop_end);
+            addf(ss->shuffle);
+            add(ss->trigmask & 0xFFFFFFFF);
+            add(ss->trigmask >> 32);
+        }
+        break;
+    case lt_mseg:
+        if (ms)
+        {
+            add(ms->endpointMode);
+            add(ms->editMode);
+            add(ms->loopMode);
+            add(ms->loop_start);
+            add(ms->loop_end);
+            add(ms->n_activeSegments);
+
+            for (int i = 0; i < ms->n_activeSegments; ++i)
+            {
+                const auto &seg = ms->segments[i];
+
+                addf(seg.duration);
+                addf(seg.v0);
+                addf(seg.nv1);
+                addf(seg.cpduration);
+                addf(seg.cpv);
+                add(seg.type);
+                add(seg.useDeform | seg.invertDeform << 1 | seg.retriggerFEG << 2 |
+                    seg.retriggerAEG << 3);
+            }
+        }
+        break;
+    case lt_formula:
+        if (fs)
+        {
+            add(fs->formulaHash & 0xFFFFFFFF);
+            add((uint64_t)fs->formulaHash >> 32);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return k;
+}
+
 void LFOAndStepDisplay::resized()
 {
     outer = getLocalBounds();
@@ -385,344 +1095,86 @@ void LFOAndStepDisplay::resized()
         ssr = ssr.translated(wfw, 0);
     }
 
-    ssr = waveform_display.withWidth(wfw).withHeight(10);
-
-    for (const auto &q : stepTriggerOverlays)
-    {
-        q->setBounds(ssr);
-
-        if (lfodata && lfodata->shape.val.i == lt_stepseq)
-        {
-            q->setVisible(showtrig);
-        }
-        else
-        {
-            q->setVisible(false);
-        }
-
-        ssr = ssr.translated(wfw, 0);
-    }
-}
-
-void LFOAndStepDisplay::paint(juce::Graphics &g)
-{
-    TimeB paint("outerPaint");
-
-    if (ss && lfodata->shape.val.i == lt_stepseq)
-    {
-        paintStepSeq(g);
-    }
-    else
-    {
-        paintWaveform(g);
-    }
-
-    paintTypeSelector(g);
-}
-
-void LFOAndStepDisplay::paintWaveform(juce::Graphics &g)
-{
-    TimeB mainTimer("-- paintWaveform");
-
-    juce::Path deactPath, path, eupath, edpath;
-    bool drawBeats = isAnythingTemposynced();
-
-    pdata tp[n_scene_params], tpd[n_scene_params];
-
-    tp[lfodata->delay.param_id_in_scene].i = lfodata->delay.val.i;
-    tp[lfodata->attack.param_id_in_scene].i = lfodata->attack.val.i;
-    tp[lfodata->hold.param_id_in_scene].i = lfodata->hold.val.i;
-    tp[lfodata->decay.param_id_in_scene].i = lfodata->decay.val.i;
-    tp[lfodata->sustain.param_id_in_scene].i = lfodata->sustain.val.i;
-    tp[lfodata->release.param_id_in_scene].i = lfodata->release.val.i;
-
-    tp[lfodata->magnitude.param_id_in_scene].i = lfodata->magnitude.val.i;
-    tp[lfodata->rate.param_id_in_scene].i = lfodata->rate.val.i;
-    tp[lfodata->shape.param_id_in_scene].i = lfodata->shape.val.i;
-    tp[lfodata->start_phase.param_id_in_scene].i = lfodata->start_phase.val.i;
-    tp[lfodata->deform.param_id_in_scene].i = lfodata->deform.val.i;
-    tp[lfodata->trigmode.param_id_in_scene].i = lm_keytrigger;
-
-    float susTime = 0.5;
-    bool msegRelease = false;
-    float msegReleaseAt = 0;
-    float lfoEnvelopeDAHDTime = pow(2.0f, lfodata->delay.val.f) + pow(2.0f, lfodata->attack.val.f) +
-                                pow(2.0f, lfodata->hold.val.f) + pow(2.0f, lfodata->decay.val.f);
-
-    if (lfodata->shape.val.i == lt_mseg)
-    {
-        // We want the sus time to get us through at least one loop
-        if (ms->loopMode == MSEGStorage::GATED_LOOP && ms->editMode == MSEGStorage::ENVELOPE &&
-            ms->loop_end >= 0)
-        {
-            float loopEndsAt = ms->segmentEnd[ms->loop_end];
-            susTime = std::max(0.5f, loopEndsAt - lfoEnvelopeDAHDTime);
-            msegReleaseAt = lfoEnvelopeDAHDTime + susTime;
-            msegRelease = true;
-        }
-    }
-
-    float totalEnvTime = lfoEnvelopeDAHDTime + std::min(pow(2.0f, lfodata->release.val.f), 4.f) +
-                         0.5; // susTime; this is now 0.5 to keep the envelope fixed in gate mode
-
-    float rateInHz = pow(2.0, (double)lfodata->rate.val.f);
-    if (lfodata->rate.temposync)
-        rateInHz *= storage->temposyncratio;
-
-    /*
-     * What we want is no more than 50 wavelengths. So
-     *
-     * totalEnvTime * rateInHz < 50
-     *
-     * totalEnvTime < 50 / rateInHz
-     *
-     * so
-     */
-    // std::cout << _D(totalEnvTime);
-    totalEnvTime = std::min(totalEnvTime, 50.f / rateInHz);
-    // std::cout << _D(totalEnvTime) << std::endl;
-    // std::cout << _D(rateInHz) << _D(1.0/rateInHz) << _D(totalEnvTime*rateInHz) << std::endl;
-
-    LFOModulationSource *tlfo = new LFOModulationSource();
-    LFOModulationSource *tFullWave = nullptr;
-    tlfo->assign(storage, lfodata, tp, 0, ss, ms, fs, true);
-    populateLFOMS(tlfo);
-    tlfo->attack();
-
-    LFOStorage deactivateStorage;
-    bool hasFullWave = false, waveIsAmpWave = false;
-
-    if (lfodata->rate.deactivated)
-    {
-        hasFullWave = true;
-        deactivateStorage = *lfodata;
-        std::copy(std::begin(tp), std::end(tp), std::begin(tpd));
-
-        auto desiredRate = log2(1.f / totalEnvTime);
-        if (lfodata->shape.val.i == lt_mseg)
-        {
-            desiredRate = log2(ms->totalDuration / totalEnvTime);
-        }
-
-        deactivateStorage.rate.deactivated = false;
-        deactivateStorage.rate.val.f = desiredRate;
-        deactivateStorage.start_phase.val.f = 0;
-        tpd[lfodata->start_phase.param_id_in_scene].f = 0;
-        tpd[lfodata->rate.param_id_in_scene].f = desiredRate;
-        tFullWave = new LFOModulationSource();
-        tFullWave->assign(storage, &deactivateStorage, tpd, 0, ss, ms, fs, true);
-        populateLFOMS(tFullWave);
-        tFullWave->attack();
-    }
-    else if (lfodata->magnitude.val.f != lfodata->magnitude.val_max.f && skin->getVersion() >= 2)
-    {
-        bool useAmpWave = Surge::Storage::getUserDefaultValue(
-            storage, Surge::Storage::ShowGhostedLFOWaveReference, 1);
-        if (useAmpWave)
-        {
-            hasFullWave = true;
-            waveIsAmpWave = true;
-            deactivateStorage = *lfodata;
-            std::copy(std::begin(tp), std::end(tp), std::begin(tpd));
-
-            deactivateStorage.magnitude.val.f = 1.f;
-            tpd[lfodata->magnitude.param_id_in_scene].f = 1.f;
-            tFullWave = new LFOModulationSource();
-            tFullWave->assign(storage, &deactivateStorage, tpd, 0, ss, ms, fs, true);
-            populateLFOMS(tFullWave);
-            tFullWave->attack();
-        }
-    }
-
-    if (lfodata->shape.val.i == lt_formula)
-    {
-        if (!tlfo->formulastate.useEnvelope)
-        {
-            totalEnvTime = 5.5;
-        }
-    }
-
-    bool drawEnvelope = !lfodata->delay.deactivated;
-
-    if (skin->hasColor(Colors::LFO::Waveform::Background))
-    {
-        g.setColour(skin->getColor(Colors::LFO::Waveform::Background));
-        g.fillRect(waveform_display);
-    }
-
-    int minSamples = (1 << 0) * (int)(waveform_display.getWidth());
-    int totalSamples =
-        std::max((int)minSamples, (int)(totalEnvTime * storage->samplerate / BLOCK_SIZE));
-    float drawnTime = totalSamples * storage->samplerate_inv * BLOCK_SIZE;
-
-    // OK so let's assume we want about 1000 pixels worth tops in
-    int averagingWindow = (int)(totalSamples / 1000.0) + 1;
-
-    float valScale = 100.0;
-    int susCountdown = -1;
-
-    float priorval = 0.f, priorwval = 0.f;
-
-    bool warnForInvalid{false};
-    std::string invalidMessage;
-
-    for (int i = 0; i < totalSamples; i += averagingWindow)
-    {
-        float val = 0;
-        float wval = 0;
-        float eval = 0;
-        float minval = 1000000, minwval = 1000000;
-        float maxval = -1000000, maxwval = -1000000;
-        float firstval;
-        float lastval;
-
-        for (int s = 0; s < averagingWindow; s++)
-        {
-            tlfo->process_block();
-
-            if (tFullWave)
-            {
-                tFullWave->process_block();
-            }
-
-            if (lfodata->shape.val.i == lt_formula)
-            {
-                if (!tlfo->formulastate.isFinite ||
-                    (tFullWave && !tFullWave->formulastate.isFinite))
-                {
-                    warnForInvalid = true;
-                    invalidMessage = "Formula produced nan or inf";
-                }
-            }
-
-            if (susCountdown < 0 && tlfo->env_state == lfoeg_stuck)
-            {
-                susCountdown = susTime * storage->samplerate / BLOCK_SIZE;
-            }
-            else if (susCountdown == 0 && tlfo->env_state == lfoeg_stuck)
-            {
-                tlfo->release();
-
-                if (tFullWave)
-                {
-                    tFullWave->release();
-                }
-            }
-            else if (susCountdown > 0)
-            {
-                susCountdown--;
-            }
-
-            val += tlfo->get_output(modIndex);
-
-            if (tFullWave)
-            {
-                auto v = tFullWave->get_output(modIndex);
-
-                minwval = std::min(v, minwval);
-                maxwval = std::max(v, maxwval);
-                wval += v;
-            }
-
-            if (s == 0)
-            {
-                firstval = tlfo->get_output(modIndex);
-            }
+    ssr = waveform_display.withWidth(wfw).withHeight(10);
 
-            if (s == averagingWindow - 1)
-            {
-                lastval = tlfo->get_output(modIndex);
-            }
+    for (const auto &q : stepTriggerOverlays)
+    {
+        q->setBounds(ssr);
 
-            minval = std::min(tlfo->get_output(modIndex), minval);
-            maxval = std::max(tlfo->get_output(modIndex), maxval);
-            eval += tlfo->env_val * lfodata->magnitude.get_extended(lfodata->magnitude.val.f);
+        if (lfodata && lfodata->shape.val.i == lt_stepseq)
+        {
+            q->setVisible(showtrig);
+        }
+        else
+        {
+            q->setVisible(false);
         }
 
-        val = val / averagingWindow;
-        wval = wval / averagingWindow;
-        eval = eval / averagingWindow;
-        val = ((-val + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-        wval = ((-wval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-        minwval = ((-minwval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-        maxwval = ((-maxwval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
+        ssr = ssr.translated(wfw, 0);
+    }
+}
 
-        float euval = ((-eval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-        float edval = ((eval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-        float xc = valScale * i / totalSamples;
+void LFOAndStepDisplay::paint(juce::Graphics &g)
+{
+    TimeB paint("outerPaint");
 
-        if (i == 0)
-        {
-            path.startNewSubPath(xc, val);
-            eupath.startNewSubPath(xc, euval);
+    if (ss && lfodata->shape.val.i == lt_stepseq)
+    {
+        paintStepSeq(g);
+    }
+    else
+    {
+        paintWaveform(g);
+    }
 
-            if (!isUnipolar())
-            {
-                edpath.startNewSubPath(xc, edval);
-            }
+    paintTypeSelector(g);
+}
 
-            if (tFullWave)
-            {
-                deactPath.startNewSubPath(xc, wval);
-            }
+void LFOAndStepDisplay::paintWaveform(juce::Graphics &g)
+{
+    TimeB mainTimer("-- paintWaveform");
 
-            priorval = val;
-            priorwval = wval;
-        }
-        else
-        {
-            minval = ((-minval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-            maxval = ((-maxval + 1.0f) * 0.5 * 0.8 + 0.1) * valScale;
-            // Windows is sensitive to out-of-order line draws in a way which causes spikes.
-            // Make sure we draw one closest to prior first. See #1438
-            float firstval = minval;
-            float secondval = maxval;
+    bool drawBeats = isAnythingTemposynced();
 
-            if (priorval - minval < maxval - priorval)
-            {
-                firstval = maxval;
-                secondval = minval;
-            }
+    auto in = currentSimulationInputs(waveform_display.getWidth());
+    auto key = currentSimulationKey(false, in);
 
-            path.lineTo(xc - 0.1 * valScale / totalSamples, firstval);
-            path.lineTo(xc + 0.1 * valScale / totalSamples, secondval);
+    if (isMSEG() || isFormula())
+    {
+        if (!backgroundSimulator)
+        {
+            backgroundSimulator = std::make_unique<BackgroundSimulator>(this);
+        }
 
-            priorval = val;
-            eupath.lineTo(xc, euval);
-            edpath.lineTo(xc, edval);
+        backgroundSimulator->take(waveformSimulation);
 
-            // We can skip the ordering thing since we know we have set rate here to a low rate
-            if (tFullWave)
-            {
-                firstval = minwval;
-                secondval = maxwval;
-                if (priorwval - minwval < maxwval - priorwval)
-                {
-                    firstval = maxwval;
-                    secondval = minwval;
-                }
-                deactPath.lineTo(xc - 0.1 * valScale / totalSamples, firstval);
-                deactPath.lineTo(xc + 0.1 * valScale / totalSamples, secondval);
-                priorwval = wval;
-            }
+        if (key != requestedSimulationKey)
+        {
+            requestedSimulationKey = key;
+            backgroundSimulator->request(key, in, storage);
         }
     }
-
-    if (lfodata->shape.val.i == lt_formula)
+    else if (key != waveformSimulation.key)
     {
-        drawEnvelope = tlfo->formulastate.useEnvelope;
+        waveformSimulation = simulator->waveform(key, in, storage);
+        requestedSimulationKey = key;
     }
 
-    tlfo->completedModulation();
-
-    delete tlfo;
+    const auto &sim = waveformSimulation;
+    const auto &path = sim.path;
+    const auto &eupath = sim.eupath;
+    const auto &edpath = sim.edpath;
+    const auto &deactPath = sim.deactPath;
+    auto drawnTime = sim.drawnTime;
 
-    if (tFullWave)
+    if (skin->hasColor(Colors::LFO::Waveform::Background))
     {
-        tFullWave->completedModulation();
-        delete tFullWave;
+        g.setColour(skin->getColor(Colors::LFO::Waveform::Background));
+        g.fillRect(waveform_display);
     }
 
+    float valScale = 100.0;
+
     auto at =
         juce::AffineTransform()
             .scale(waveform_display.getWidth() / valScale, waveform_display.getHeight() / valScale)
@@ -769,7 +1221,13 @@ void LFOAndStepDisplay::paintWaveform(juce::Graphics &g)
         }
     }
 
-    if (drawEnvelope)
+    // nothing simulated yet; the background simulation will repaint us when it is done
+    if (sim.key.empty())
+    {
+        return;
+    }
+
+    if (sim.drawEnvelope)
     {
         g.setColour(skin->getColor(Colors::LFO::Waveform::Envelope));
         g.strokePath(eupath, juce::PathStrokeType(1.f), at);
@@ -853,9 +1311,9 @@ void LFOAndStepDisplay::paintWaveform(juce::Graphics &g)
         }
     }
 
-    if (hasFullWave)
+    if (sim.hasFullWave)
     {
-        if (waveIsAmpWave)
+        if (sim.waveIsAmpWave)
         {
             g.setColour(skin->getColor(Colors::LFO::Waveform::GhostedWave));
             auto dotted = juce::Path();
@@ -925,28 +1383,11 @@ void LFOAndStepDisplay::paintWaveform(juce::Graphics &g)
         g.drawLine(sp.x, sp.y, ep.x, ep.y, 1.0);
     }
 
-    /*
-     * In 1.8 I think we don't want to show the key release point in the simulated wave
-     * with the MSEG but I wrote it to debug and we may change our mind so keeping this code
-     * here
-     */
-    if (msegRelease && false)
-    {
-#if SHOW_RELEASE_TIMES
-        float xp = msegReleaseAt / drawnTime * valScale;
-        was a vstgui Point sp(xp, valScale * 0.9), ep(xp, valScale * 0.1);
-        tf.transform(sp);
-        tf.transform(ep);
-        dc->setFrameColor(juce::Colours::red);
-        dc->drawLine(sp, ep);
-#endif
-    }
-
-    if (warnForInvalid)
+    if (sim.warnForInvalid)
     {
         g.setColour(skin->getColor(Colors::LFO::Waveform::Wave));
         g.setFont(skin->fontManager->getLatoAtSize(14, juce::Font::bold));
-        g.drawText(invalidMessage, waveform_display.withTrimmedBottom(30),
+        g.drawText(sim.invalidMessage, waveform_display.withTrimmedBottom(30),
                    juce::Justification::centred);
     }
 }
@@ -1179,159 +1620,21 @@ void LFOAndStepDisplay::paintStepSeq(juce::Graphics &g)
     // code above but with very different scaling in time since we need to match the steps no
     // matter the rate
 
-    pdata tp[n_scene_params];
-    tp[lfodata->delay.param_id_in_scene].i = lfodata->delay.val.i;
-    tp[lfodata->attack.param_id_in_scene].i = lfodata->attack.val.i;
-    tp[lfodata->hold.param_id_in_scene].i = lfodata->hold.val.i;
-    tp[lfodata->decay.param_id_in_scene].i = lfodata->decay.val.i;
-    tp[lfodata->sustain.param_id_in_scene].i = lfodata->sustain.val.i;
-    tp[lfodata->release.param_id_in_scene].i = lfodata->release.val.i;
-
-    tp[lfodata->magnitude.param_id_in_scene].i = lfodata->magnitude.val.i;
-
-    // Min out the rate. Be careful with temposync.
-    float floorrate = -1.2; // can't be const - we mod it
-    float displayRate = lfodata->rate.val.f;
-    const float twotofloor = powf(2.0, -1.2); // so copy value here
-
-    if (lfodata->rate.temposync)
-    {
-        /*
-         * So frequency = temposyncration * 2^rate
-         * We want floor of frequency to be 2^-3.5 (that's the check below)
-         * So 2^rate = temposyncratioinb 2^-3.5;
-         * rate = log2( 2^-3.5 * tsratioinb )
-         */
-        floorrate = std::max(floorrate, log2(twotofloor * storage->temposyncratio_inv));
-    }
-
-    if (lfodata->rate.val.f < floorrate)
-    {
-        tp[lfodata->rate.param_id_in_scene].f = floorrate;
-        displayRate = floorrate;
-    }
-    else
-    {
-        tp[lfodata->rate.param_id_in_scene].i = lfodata->rate.val.i;
-    }
+    auto boxo = rect_steps;
 
-    tp[lfodata->shape.param_id_in_scene].i = lfodata->shape.val.i;
-    tp[lfodata->start_phase.param_id_in_scene].i = lfodata->start_phase.val.i;
-    tp[lfodata->deform.param_id_in_scene].i = lfodata->deform.val.i;
-    tp[lfodata->trigmode.param_id_in_scene].i = lm_keytrigger;
+    auto in = currentSimulationInputs((int)boxo.getWidth());
+    auto key = currentSimulationKey(true, in);
 
-    /*
-    ** First big difference - the total env time is basically 16 * the time of the rate
-    */
-    float freq = pow(2.0, displayRate); // frequency in hz
-    if (lfodata->rate.temposync)
+    if (key != stepSeqSimulation.key)
     {
-        freq *= storage->temposyncratio;
+        stepSeqSimulation = simulator->stepSeq(key, in, storage);
     }
 
-    float cyclesec = 1.0 / freq;
-    float totalSampleTime = cyclesec * n_stepseqsteps;
-    float susTime = 4.0 * cyclesec;
-
-    LFOModulationSource *tlfo = new LFOModulationSource();
-    tlfo->assign(storage, lfodata, tp, 0, ss, ms, fs, true);
-    populateLFOMS(tlfo);
-    tlfo->attack();
-    auto boxo = rect_steps;
-
-    int minSamples = (1 << 4) * boxo.getWidth();
-    int totalSamples =
-        std::max((int)minSamples, (int)(totalSampleTime * storage->samplerate / BLOCK_SIZE));
-    float cycleSamples = cyclesec * storage->samplerate / BLOCK_SIZE;
-
-    // OK so lets assume we want about 1000 pixels worth tops in
-    int averagingWindow = (int)(totalSamples / 2000.0) + 1;
+    const auto &path = stepSeqSimulation.path;
+    const auto &eupath = stepSeqSimulation.eupath;
+    const auto &edpath = stepSeqSimulation.edpath;
 
     float valScale = 100.0;
-    int susCountdown = -1;
-
-    juce::Path path, eupath, edpath;
-
-    for (int i = 0; i < totalSamples; i += averagingWindow)
-    {
-        float val = 0;
-        float eval = 0;
-        float minval = 1000000;
-        float maxval = -1000000;
-        float firstval;
-        float lastval;
-
-        for (int s = 0; s < averagingWindow; s++)
-        {
-            tlfo->process_block();
-
-            if (susCountdown < 0 && tlfo->env_state == lfoeg_stuck)
-            {
-                susCountdown = susTime * storage->samplerate / BLOCK_SIZE;
-            }
-            else if (susCountdown == 0 && tlfo->env_state == lfoeg_stuck)
-            {
-                tlfo->release();
-            }
-            else if (susCountdown > 0)
-            {
-                susCountdown--;
-            }
-
-            val += tlfo->get_output(0);
-
-            if (s == 0)
-            {
-                firstval = tlfo->get_output(0);
-            }
-
-            if (s == averagingWindow - 1)
-            {
-                lastval = tlfo->get_output(0);
-            }
-
-            minval = std::min(tlfo->get_output(0), minval);
-            maxval = std::max(tlfo->get_output(0), maxval);
-            eval += tlfo->env_val * lfodata->magnitude.get_extended(lfodata->magnitude.val.f);
-        }
-
-        val = val / averagingWindow;
-        eval = eval / averagingWindow;
-
-        if (isUnipolar())
-        {
-            val = val * 2.0 - 1.0;
-        }
-
-        val = ((-val + 1.0f) * 0.5) * valScale;
-
-        float euval = ((-eval + 1.0f) * 0.5) * valScale;
-        float edval = ((eval + 1.0f) * 0.5) * valScale;
-        float xc = valScale * i / (cycleSamples * n_stepseqsteps);
-
-        if (i == 0)
-        {
-            path.startNewSubPath(xc, val);
-            eupath.startNewSubPath(xc, euval);
-
-            if (!isUnipolar())
-            {
-                edpath.startNewSubPath(xc, edval);
-            }
-        }
-        else
-        {
-            path.lineTo(xc, val);
-            eupath.lineTo(xc, euval);
-
-            if (!isUnipolar())
-            {
-                edpath.lineTo(xc, edval);
-            }
-        }
-    }
-
-    delete tlfo;
 
     auto q = boxo;
 
@@ -2414,20 +2717,6 @@ void LFOAndStepDisplay::showLFODisplayPopupMenu(SurgeGUIEditor::OverlayTags tag)
     contextMenu.showMenuAsync(guiEditor->popupMenuOptions());
 }
 
-void LFOAndStepDisplay::populateLFOMS(LFOModulationSource *s)
-{
-    if (lfoid < n_lfos_voice)
-        s->setIsVoice(true);
-    else
-        s->setIsVoice(false);
-
-    if (s->isVoice)
-        s->formulastate.velocity = 100;
-
-    Surge::Formula::setupEvaluatorStateFrom(s->formulastate, storage->getPatch(),
-                                            guiEditor->current_scene);
-}
-
 void LFOAndStepDisplay::updateShapeTo(int i)
 {
     auto sge = firstListenerOfType<SurgeGUIEditor>();
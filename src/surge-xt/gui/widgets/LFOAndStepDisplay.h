@@ -41,6 +41,7 @@ struct LFOAndStepDisplay : public juce::Component,
                            public LongHoldMixin<LFOAndStepDisplay>
 {
     LFOAndStepDisplay(SurgeGUIEditor *e);
+    ~LFOAndStepDisplay();
     void paint(juce::Graphics &g) override;
     void paintWaveform(juce::Graphics &g);
     void paintStepSeq(juce::Graphics &g);
@@ -119,7 +120,43 @@ struct LFOAndStepDisplay : public juce::Component,
         scene = l;
     }
 
-    void populateLFOMS(LFOModulationSource *s);
+    /*
+     * Simulating the LFO to draw it takes hundreds of process_block calls (each running Lua
+     * for a formula LFO), so the result is cached and only re-simulated when something which
+     * feeds it changes. The key holds the LFO parameters, the step sequencer, MSEG or formula
+     * contents, and the display size, tempo and sample rate. MSEG and formula LFOs simulate on
+     * a background thread and the last result is drawn until the newer one arrives.
+     */
+    using SimulationKey = std::vector<uint32_t>;
+
+    struct SimulationInputs
+    {
+        LFOStorage *lfodata{nullptr};
+        StepSequencerStorage *ss{nullptr};
+        MSEGStorage *ms{nullptr};
+        FormulaModulatorStorage *fs{nullptr};
+        int lfoid{0}, scene{0}, modIndex{0}, width{0};
+        bool ghostAmpWave{false};
+    };
+    SimulationInputs currentSimulationInputs(int width);
+    SimulationKey currentSimulationKey(bool forStepSeq, const SimulationInputs &in);
+
+    struct Simulation
+    {
+        SimulationKey key;
+        juce::Path path, eupath, edpath, deactPath;
+        float drawnTime{0.f};
+        bool drawEnvelope{false}, hasFullWave{false}, waveIsAmpWave{false};
+        bool warnForInvalid{false};
+        std::string invalidMessage;
+    };
+
+    struct Simulator;
+    struct BackgroundSimulator;
+    std::unique_ptr<Simulator> simulator;
+    std::unique_ptr<BackgroundSimulator> backgroundSimulator;
+    Simulation waveformSimulation, stepSeqSimulation;
+    SimulationKey requestedSimulationKey;
 
     void setStepToDefault(const juce::MouseEvent &event);
     void setStepValue(const juce::MouseEvent &event);
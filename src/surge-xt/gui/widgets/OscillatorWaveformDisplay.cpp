@@ -22,6 +22,8 @@
 
 #include "OscillatorWaveformDisplay.h"
 #include "SurgeStorage.h"
+#include "FPUState.h"
+#include "ThreadPolicy.h"
 #include "SurgeSynthProcessor.h"
 #include "SurgeSynthEditor.h"
 #include "Oscillator.h"
@@ -36,10 +38,198 @@
 #include "UserDefaults.h"
 #include "fmt/core.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace Surge
 {
 namespace Widgets
 {
+bool OscillatorWaveformDisplay::PreviewKey::operator==(const PreviewKey &o) const
+{
+    return type == o.type && width == o.width && character == o.character && wtId == o.wtId &&
+           pitch == o.pitch && wtData == o.wtData && wtBuilt == o.wtBuilt &&
+           values == o.values && flags == o.flags;
+}
+
+/*
+ * One background thread per display, which renders whichever preview was asked for most
+ * recently and hands it back. Each request takes a copy of the oscillator's parameters and
+ * shares its wavetable, so the render never reads anything the UI might be changing.
+ */
+struct OscillatorWaveformDisplay::PreviewRenderer
+{
+    explicit PreviewRenderer(OscillatorWaveformDisplay *d) : display(d)
+    {
+        worker = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Helper,
+                                              [this]() { run(); });
+    }
+
+    ~PreviewRenderer()
+    {
+        {
+            std::lock_guard<std::mutex> g(lock);
+            keepRunning = false;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    // from the message thread
+    void request(const PreviewKey &key, SurgeStorage *storage, OscillatorStorage *oscdata)
+    {
+        {
+            std::lock_guard<std::mutex> g(lock);
+            pendingKey = key;
+            pendingStorage = storage;
+
+            auto &to = *pendingOsc;
+            to.type = oscdata->type;
+            to.pitch = oscdata->pitch;
+            to.octave = oscdata->octave;
+            std::copy(std::begin(oscdata->p), std::end(oscdata->p), std::begin(to.p));
+            to.keytrack = oscdata->keytrack;
+            to.retrigger = oscdata->retrigger;
+            to.extraConfig = oscdata->extraConfig;
+            {
+                std::lock_guard<std::mutex> wg(storage->waveTableDataMutex);
+                to.wt.Copy(&oscdata->wt);
+            }
+
+            hasPending = true;
+        }
+        cv.notify_one();
+    }
+
+    // from the message thread; true if a newer preview than the last one taken was swapped in
+    bool take(Preview &into)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        if (!hasFinished)
+            return false;
+
+        std::swap(into, finished);
+        hasFinished = false;
+        return true;
+    }
+
+  private:
+    void run()
+    {
+        auto fpuguard = Surge::FPUState::DSPThreadGuard();
+        std::unique_lock<std::mutex> lk(lock);
+        while (true)
+        {
+            cv.wait(lk, [this]() { return !keepRunning || hasPending; });
+            if (!keepRunning)
+                return;
+
+            auto key = pendingKey;
+            auto *storage = pendingStorage;
+            std::swap(pendingOsc, renderingOsc);
+            hasPending = false;
+            lk.unlock();
+
+            Preview res{key, render(key, storage, renderingOsc.get())};
+
+            lk.lock();
+            finished = std::move(res);
+            hasFinished = true;
+
+            juce::MessageManager::callAsync([safe = display]() {
+                if (safe)
+                    safe->repaint();
+            });
+        }
+    }
+
+    std::vector<float> render(const PreviewKey &key, SurgeStorage *storage,
+                              OscillatorStorage *oscdata)
+    {
+        static constexpr int averagingWindow = 4; // < and Mult of BlockSizeOS
+
+        int totalSamples = (1 << 3) * key.width;
+
+        std::vector<float> res;
+        res.reserve(totalSamples / averagingWindow + 1);
+
+        tp[oscdata->pitch.param_id_in_scene].f = 0;
+        for (int i = 0; i < n_osc_params; i++)
+            tp[oscdata->p[i].param_id_in_scene].i = oscdata->p[i].val.i;
+
+        auto osc = spawn_osc(oscdata->type.val.i, storage, oscdata, tp, tp, buffer->data);
+        if (!osc)
+            return res;
+
+        bool use_display = osc->allow_display();
+
+        if (use_display)
+        {
+            osc->init(key.pitch, true, true);
+        }
+
+        int block_pos = BLOCK_SIZE;
+
+        float oscTmp alignas(16)[2][BLOCK_SIZE_OS];
+        sst::filters::HalfRate::HalfRateFilter hr(6, true);
+        hr.load_coefficients();
+        hr.reset();
+
+        for (int i = 0; i < totalSamples; i += averagingWindow)
+        {
+            if (use_display && block_pos >= BLOCK_SIZE)
+            {
+                osc->process_block(key.pitch);
+                memcpy(oscTmp[0], osc->output, sizeof(oscTmp[0]));
+                memcpy(oscTmp[1], osc->output, sizeof(oscTmp[1]));
+                hr.process_block_D2(oscTmp[0], oscTmp[1], BLOCK_SIZE_OS);
+                block_pos = 0;
+            }
+
+            float val = 0.f;
+
+            if (use_display)
+            {
+                for (int j = 0; j < averagingWindow; ++j)
+                {
+                    val += oscTmp[0][block_pos];
+                    block_pos++;
+                }
+
+                val = val / averagingWindow;
+            }
+
+            res.push_back(val);
+        }
+
+        osc->~Oscillator();
+
+        return res;
+    }
+
+    juce::Component::SafePointer<OscillatorWaveformDisplay> display;
+
+    struct Buffer
+    {
+        unsigned char data alignas(16)[oscillator_buffer_size];
+    };
+    std::unique_ptr<Buffer> buffer{std::make_unique<Buffer>()};
+    pdata tp[n_scene_params];
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool keepRunning{true}, hasPending{false}, hasFinished{false};
+
+    PreviewKey pendingKey;
+    SurgeStorage *pendingStorage{nullptr};
+    std::unique_ptr<OscillatorStorage> pendingOsc{std::make_unique<OscillatorStorage>()},
+        renderingOsc{std::make_unique<OscillatorStorage>()};
+    Preview finished;
+
+    std::thread worker;
+};
+
 OscillatorWaveformDisplay::OscillatorWaveformDisplay()
 {
     setAccessible(true);
@@ -147,125 +337,117 @@ OscillatorWaveformDisplay::OscillatorWaveformDisplay()
     };
 
     customEditorAccOverlay = std::move(ol);
+
+    previewRenderer = std::make_unique<PreviewRenderer>(this);
 }
 
 OscillatorWaveformDisplay::~OscillatorWaveformDisplay() = default;
 
-void OscillatorWaveformDisplay::paint(juce::Graphics &g)
+OscillatorWaveformDisplay::PreviewKey OscillatorWaveformDisplay::currentPreviewKey()
 {
-    bool skipEntireOscillator{false};
+    PreviewKey res;
 
-    if (supportsCustomEditor() && customEditor)
+    res.type = oscdata->type.val.i;
+    res.width = getWidth();
+    res.character = storage->getPatch().character.val.i;
+
+    for (int i = 0; i < n_osc_params; i++)
     {
-        skipEntireOscillator = true;
+        const auto &p = oscdata->p[i];
+        res.values[i] = p.val.i;
+        res.flags[i] = (p.deform_type << 4) | (p.extend_range << 2) | (p.absolute << 1) |
+                       (int)p.deactivated;
     }
 
-    if (!supportsCustomEditor() && customEditor)
+    if (uses_wavetabledata(res.type))
     {
-        hideCustomEditor();
+        res.wtId = oscdata->wt.current_id;
+        res.wtData = oscdata->wt.builtTableData().get();
+        res.wtBuilt = oscdata->wt.builtTableData() && oscdata->wt.builtTableData()->isBuilt();
     }
 
-    bool usesWT = uses_wavetabledata(oscdata->type.val.i);
+    float disp_pitch_rs = disp_pitch + 12.0 * log2(storage->dsamplerate / 44100.0);
 
-    if (!skipEntireOscillator)
+    if (!storage->isStandardTuning)
     {
-        auto osc = setupOscillator();
+        // OK so in this case we need to find a better version of the note which gets us
+        // that pitch. Only way is to search really.
+        auto pit = storage->note_to_pitch_ignoring_tuning(disp_pitch_rs);
+        int bracket = -1;
 
-        if (!osc)
+        for (int i = 0; i < 128; ++i)
         {
-            return;
-        }
+            if (storage->note_to_pitch(i) < pit && storage->note_to_pitch(i + 1) > pit)
+            {
+                bracket = i;
 
-        int totalSamples = (1 << 3) * (int)getWidth();
-        int averagingWindow = 4; // < and Mult of BlockSizeOS
-        float disp_pitch_rs = disp_pitch + 12.0 * log2(storage->dsamplerate / 44100.0);
+                break;
+            }
+        }
 
-        if (!storage->isStandardTuning)
+        if (bracket >= 0)
         {
-            // OK so in this case we need to find a better version of the note which gets us
-            // that pitch. Only way is to search really.
-            auto pit = storage->note_to_pitch_ignoring_tuning(disp_pitch_rs);
-            int bracket = -1;
+            float f1 = storage->note_to_pitch(bracket);
+            float f2 = storage->note_to_pitch(bracket + 1);
+            float frac = (pit - f1) / (f2 - f1);
 
-            for (int i = 0; i < 128; ++i)
-            {
-                if (storage->note_to_pitch(i) < pit && storage->note_to_pitch(i + 1) > pit)
-                {
-                    bracket = i;
-
-                    break;
-                }
-            }
+            disp_pitch_rs = bracket + frac;
+        }
 
-            if (bracket >= 0)
-            {
-                float f1 = storage->note_to_pitch(bracket);
-                float f2 = storage->note_to_pitch(bracket + 1);
-                float frac = (pit - f1) / (f2 - f1);
+        // That's a strange non-monotonic tuning. Oh well.
+    }
 
-                disp_pitch_rs = bracket + frac;
-            }
+    res.pitch = disp_pitch_rs;
 
-            // That's a strange non-monotonic tuning. Oh well.
-        }
+    return res;
+}
 
-        bool use_display = osc->allow_display();
+void OscillatorWaveformDisplay::paint(juce::Graphics &g)
+{
+    bool skipEntireOscillator{false};
 
-        if (use_display)
-        {
-            osc->init(disp_pitch_rs, true, true);
-        }
+    if (supportsCustomEditor() && customEditor)
+    {
+        skipEntireOscillator = true;
+    }
 
-        int block_pos = BLOCK_SIZE;
-        juce::Path wavePath;
+    if (!supportsCustomEditor() && customEditor)
+    {
+        hideCustomEditor();
+    }
 
-        float oscTmp alignas(16)[2][BLOCK_SIZE_OS];
-        sst::filters::HalfRate::HalfRateFilter hr(6, true);
-        hr.load_coefficients();
-        hr.reset();
+    bool usesWT = uses_wavetabledata(oscdata->type.val.i);
 
-        for (int i = 0; i < totalSamples; i += averagingWindow)
-        {
-            if (use_display && block_pos >= BLOCK_SIZE)
-            {
-                // Lock it even if we aren't wavetable. It's fine.
-                storage->waveTableDataMutex.lock();
-                osc->process_block(disp_pitch_rs);
-                memcpy(oscTmp[0], osc->output, sizeof(oscTmp[0]));
-                memcpy(oscTmp[1], osc->output, sizeof(oscTmp[1]));
-                hr.process_block_D2(oscTmp[0], oscTmp[1], BLOCK_SIZE_OS);
-                block_pos = 0;
-                storage->waveTableDataMutex.unlock();
-            }
+    if (!skipEntireOscillator)
+    {
+        auto key = currentPreviewKey();
 
-            float val = 0.f;
+        previewRenderer->take(preview);
 
-            if (use_display)
-            {
-                for (int j = 0; j < averagingWindow; ++j)
-                {
-                    val += oscTmp[0][block_pos];
-                    block_pos++;
-                }
+        if (preview.key != key && requestedPreviewKey != key)
+        {
+            previewRenderer->request(key, storage, oscdata);
+            requestedPreviewKey = key;
+        }
 
-                val = val / averagingWindow;
-            }
+        // until the render catches up, the last preview stands in, if it was this oscillator's
+        juce::Path wavePath;
+        auto n = preview.key.type == key.type ? preview.values.size() : 0;
 
-            float xc = 1.f * i / totalSamples;
+        for (size_t i = 0; i < n; ++i)
+        {
+            float xc = 1.f * i / n;
 
             if (i == 0)
             {
-                wavePath.startNewSubPath(xc, val);
+                wavePath.startNewSubPath(xc, preview.values[i]);
             }
             else
             {
-                wavePath.lineTo(xc, val);
+                wavePath.lineTo(xc, preview.values[i]);
             }
         }
 
-        osc->~Oscillator();
-        osc = nullptr;
-
         auto yMargin = 2 * usesWT;
         auto h = getHeight() - usesWT * wtbheight - 2 * yMargin;
         auto xMargin = 2;
@@ -1417,8 +1599,8 @@ struct WaveTable3DEditor : public juce::Component,
                     int pos = floor((((float)i) / (float)std::max(rendered_samples - 1, 1)) *
                                     ((float)wt_size - 1.f));
 
-                    samples[i] = wt.TableF32WeakPointers[0][frameFrom][pos] * (1.f - proc) +
-                                 wt.TableF32WeakPointers[0][frameTo][pos] * proc;
+                    samples[i] = wt.sampleAt(0, frameFrom, pos) * (1.f - proc) +
+                                 wt.sampleAt(0, frameTo, pos) * proc;
                     if (useCache)
                         samplesCached[(int)frame][i + 1] = samples[i];
                 }
@@ -85,6 +85,35 @@ struct OscillatorWaveformDisplay : public juce::Component,
     ::Oscillator *setupOscillator();
     unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
 
+    /*
+     * Some oscillators take a good while to run, so rather than running one on every repaint,
+     * the preview is rendered on a background thread and kept until something which changes
+     * its shape does. This is everything which does: the type, the parameters (but not the
+     * pitch, which the preview ignores), the wavetable, the character and the display itself.
+     */
+    struct PreviewKey
+    {
+        int type{-1}, width{0}, character{0}, wtId{-1};
+        float pitch{0.f};
+        const void *wtData{nullptr};
+        bool wtBuilt{false};
+        std::array<int, n_osc_params> values{}, flags{};
+
+        bool operator==(const PreviewKey &o) const;
+        bool operator!=(const PreviewKey &o) const { return !(*this == o); }
+    };
+    PreviewKey currentPreviewKey();
+
+    struct Preview
+    {
+        PreviewKey key;
+        std::vector<float> values; // one per averaged point across the display
+    };
+    struct PreviewRenderer;
+    std::unique_ptr<PreviewRenderer> previewRenderer;
+    Preview preview; // the last one rendered, drawn until a newer one arrives
+    PreviewKey requestedPreviewKey;
+
     void paint(juce::Graphics &g) override;
     void resized() override;
 
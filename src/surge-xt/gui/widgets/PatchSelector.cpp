@@ -30,6 +30,7 @@
 #include "widgets/MenuCustomComponents.h"
 #include "overlays/PatchStoreDialog.h"
 #include "PatchDB.h"
+#include "PatchPreview.h"
 #include "fmt/core.h"
 #include "SurgeJUCEHelpers.h"
 #include "AccessibleHelpers.h"
@@ -54,14 +55,45 @@ struct PatchDBTypeAheadProvider : public TypeAheadDataProvider,
     PatchDBTypeAheadProvider(PatchSelector *s) : selector(s) {}
 
     std::vector<PatchStorage::PatchDB::patchRecord> lastSearchResult;
+    uint64_t searchGeneration{0};
+
+    /*
+     * The query runs on the PatchDB reader, so we answer with what we have and swap the new
+     * results in when they land. Anything from a search superseded by a later keystroke is
+     * dropped, both in the PatchDB and here by generation.
+     */
     std::vector<int> searchFor(const std::string &s) override
     {
-        lastSearchResult = storage->patchDB->queryFromQueryString(s);
+        auto gen = ++searchGeneration;
+        auto sp = juce::Component::SafePointer<PatchSelector>(selector);
+
+        storage->patchDB->queryFromQueryStringAsync(
+            PatchStorage::PatchDB::channelFor(storage, "patch-selector"), s,
+            [sp, gen](std::vector<PatchStorage::PatchDB::patchRecord> &&res) {
+                juce::MessageManager::callAsync([sp, gen, r = std::move(res)]() mutable {
+                    if (sp && sp->patchDbProvider->searchGeneration == gen)
+                    {
+                        sp->patchDbProvider->searchCompleted(std::move(r));
+                    }
+                });
+            });
+
+        return currentIndices();
+    }
+
+    std::vector<int> currentIndices() const
+    {
         std::vector<int> res(lastSearchResult.size());
         std::iota(res.begin(), res.end(), 0);
-        selector->searchUpdated();
         return res;
     }
+
+    void searchCompleted(std::vector<PatchStorage::PatchDB::patchRecord> &&res)
+    {
+        lastSearchResult = std::move(res);
+        selector->typeAhead->searchResultsChanged(currentIndices());
+        selector->searchUpdated();
+    }
     std::string textBoxValueForIndex(int idx) override
     {
         if (idx >= 0 && idx < lastSearchResult.size())
@@ -1275,18 +1307,22 @@ void PatchSelector::itemSelected(int providerIndex)
     toggleTypeAheadSearch(false);
     if (sge)
     {
+        sge->synth->patchPreviewPlayer.stop();
         sge->queuePatchFileLoad(sr.file);
     }
 }
 
 void PatchSelector::itemFocused(int providerIndex)
 {
-#if WINDOWS
     auto sge = firstListenerOfType<SurgeGUIEditor>();
     if (!sge)
         return;
 
     auto sr = patchDbProvider->lastSearchResult[providerIndex];
+
+    playPatchPreview(sge, sr.file);
+
+#if WINDOWS
     auto doAcc = Surge::Storage::getUserDefaultValue(
         storage, Surge::Storage::UseNarratorAnnouncementsForPatchTypeahead, true);
     if (doAcc)
@@ -1296,10 +1332,38 @@ void PatchSelector::itemFocused(int providerIndex)
 #endif
 }
 
+void PatchSelector::playPatchPreview(SurgeGUIEditor *sge, const std::string &file)
+{
+    auto &player = sge->synth->patchPreviewPlayer;
+
+    if (!storage->patchDB || !Surge::Storage::getUserDefaultValue(
+                                 storage, Surge::Storage::PlayPatchPreviewsInSearch, true))
+    {
+        player.stop();
+        return;
+    }
+
+    // the database knows where an indexer put the preview, and otherwise try the usual cache
+    auto cacheDir = Surge::Storage::patchPreviewCacheDir(storage->userDataPath);
+    auto indexed = storage->patchDB->readPatchPreview(file);
+    if (!indexed.empty())
+        cacheDir = string_to_path(indexed).parent_path();
+
+    // a missing or stale preview stays silent rather than playing some other version of the patch
+    auto p = std::make_shared<Surge::Storage::PatchPreview>();
+    if (Surge::Storage::loadPatchPreview(cacheDir, string_to_path(file), *p))
+        player.play(p);
+    else
+        player.stop();
+}
+
 void PatchSelector::idle() { wasTypeaheadCanceledSinceLastIdle = false; }
 
 void PatchSelector::typeaheadCanceled()
 {
+    if (auto sge = firstListenerOfType<SurgeGUIEditor>())
+        sge->synth->patchPreviewPlayer.stop();
+
     wasTypeaheadCanceledSinceLastIdle = true;
     toggleTypeAheadSearch(false);
 }
@@ -30,6 +30,7 @@
 #include "widgets/TypeAheadTextEditor.h"
 
 class SurgeStorage;
+class SurgeGUIEditor;
 
 namespace Surge
 {
@@ -113,6 +114,9 @@ struct PatchSelector : public juce::Component,
     void itemFocused(int providerIndex) override;
     void typeaheadCanceled() override;
 
+    // auditions the cached preview of a search result, if it has a current one
+    void playPatchPreview(SurgeGUIEditor *sge, const std::string &file);
+
     void resized() override;
     void mouseDown(const juce::MouseEvent &event) override;
     bool favoritesHover{false}, searchHover{false}, browserHover{false}, stuckHover{false};
@@ -362,6 +362,14 @@ void TypeAhead::searchAndShowLBox()
     lbox->repaint();
 }
 
+void TypeAhead::searchResultsChanged(std::vector<int> results)
+{
+    lboxmodel->search = std::move(results);
+
+    lbox->updateContent();
+    lbox->repaint();
+}
+
 void TypeAhead::showLbox()
 {
     auto p = getParentComponent();
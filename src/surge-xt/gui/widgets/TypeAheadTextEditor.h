@@ -89,6 +89,11 @@ struct TypeAhead : public juce::TextEditor, juce::TextEditor::Listener
     std::unique_ptr<TypeAheadListBoxModel> lboxmodel;
 
     void searchAndShowLBox();
+    /*
+     * For providers which search asynchronously: searchFor returns what they have now, and
+     * when the real answer arrives they hand it over here, on the message thread.
+     */
+    void searchResultsChanged(std::vector<int> results);
     void showLbox();
     void parentHierarchyChanged() override;
     void textEditorTextChanged(juce::TextEditor &editor) override;
@@ -25,6 +25,7 @@
 #include "basic_dsp.h"
 #include "SurgeImage.h"
 #include "RuntimeFont.h"
+#include "CPUGovernor.h"
 
 namespace Surge
 {
@@ -54,38 +55,24 @@ void VuMeter::mouseDown(const juce::MouseEvent &event)
     mouseDownLongHold(event);
 }
 
-void VuMeter::paint(juce::Graphics &g)
+void VuMeter::paintChrome(juce::Graphics &g, bool withBars)
 {
-    juce::Graphics::ScopedSaveState gs(g);
-    g.reduceClipRegion(getLocalBounds());
-
-    juce::Colour bgCol = skin->getColor(Colors::VuMeter::Background);
-
-    g.setColour(bgCol);
+    g.setColour(skin->getColor(Colors::VuMeter::Background));
     g.fillRoundedRectangle(getLocalBounds().toFloat(), 3);
 
     g.setColour(skin->getColor(Colors::VuMeter::Border));
     g.drawRoundedRectangle(getLocalBounds().toFloat(), 3, 1);
 
-    if (!isAudioActive)
+    if (!withBars || !hVuBars)
     {
-        g.setColour(skin->getColor(Colors::VuMeter::UnavailableText));
-        g.setFont(skin->fontManager->getLatoAtSize(8));
-        g.drawText("Audio Output Unavailable", getLocalBounds().withTrimmedBottom(1),
-                   juce::Justification::centred);
         return;
     }
 
     int offi;
-    bool stereo = false;
 
     switch (vu_type)
     {
-    case ParamConfig::vut_vu:
-        offi = 0;
-        break;
     case ParamConfig::vut_vu_stereo:
-        stereo = true;
         offi = 1;
         break;
     case ParamConfig::vut_gain_reduction:
@@ -98,11 +85,47 @@ void VuMeter::paint(juce::Graphics &g)
 
     auto t = juce::AffineTransform().translated(0, -offi * getHeight());
 
-    if (hVuBars)
+    hVuBars->draw(g, 1.0, t);
+}
+
+void VuMeter::paint(juce::Graphics &g)
+{
+    juce::Graphics::ScopedSaveState gs(g);
+    g.reduceClipRegion(getLocalBounds());
+
+    juce::Colour bgCol = skin->getColor(Colors::VuMeter::Background);
+
+    if (!isAudioActive)
     {
-        hVuBars->draw(g, 1.0, t);
+        paintChrome(g, false);
+
+        g.setColour(skin->getColor(Colors::VuMeter::UnavailableText));
+        g.setFont(skin->fontManager->getLatoAtSize(8));
+        g.drawText("Audio Output Unavailable", getLocalBounds().withTrimmedBottom(1),
+                   juce::Justification::centred);
+        return;
     }
 
+    auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (!chrome.isValid() || chromeScale != pixelScale || chromeType != vu_type)
+    {
+        auto w = std::max(1, (int)std::ceil(getWidth() * pixelScale));
+        auto h = std::max(1, (int)std::ceil(getHeight() * pixelScale));
+
+        chrome = juce::Image(juce::Image::ARGB, w, h, true);
+        chromeScale = pixelScale;
+        chromeType = vu_type;
+
+        juce::Graphics cg(chrome);
+        cg.addTransform(juce::AffineTransform::scale(pixelScale));
+        paintChrome(cg, true);
+    }
+
+    g.drawImage(chrome, getLocalBounds().toFloat());
+
+    bool stereo = vu_type == ParamConfig::vut_vu_stereo;
+
     // And now the calculation
     float w = getWidth();
     /*
@@ -182,6 +205,16 @@ void VuMeter::paint(juce::Graphics &g)
             g.setFont(skin->fontManager->getLatoAtSize(9));
             g.drawText(text, bounds, juce::Justification::right);
         }
+
+        if (governorLevel > Surge::Profiling::gov_full_quality)
+        {
+            auto bounds = getLocalBounds().withTrimmedLeft(3);
+
+            g.setColour(juce::Colour(juce::Colours::orange));
+            g.setFont(skin->fontManager->getLatoAtSize(9));
+            g.drawText(Surge::Profiling::CPUGovernor::levelShortName(governorLevel), bounds,
+                       juce::Justification::left);
+        }
     }
 }
 
@@ -189,6 +222,7 @@ void VuMeter::onSkinChanged()
 {
     hVuBars = associatedBitmapStore->getImage(IDB_VUMETER_BARS);
     jassert(hVuBars);
+    chrome = {};
 }
 } // namespace Widgets
 } // namespace Surge
\ No newline at end of file
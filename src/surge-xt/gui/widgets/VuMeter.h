@@ -51,6 +51,11 @@ struct VuMeter : public juce::Component,
     void setCpuLevel(float f) { cpuLevel = f; }
     float getCpuLevel() const { return cpuLevel; }
 
+    // the CPU governor's level, which is shown whenever it's not at full quality
+    int governorLevel{0};
+    void setGovernorLevel(int l) { governorLevel = l; }
+    int getGovernorLevel() const { return governorLevel; }
+
     SurgeStorage *storage{nullptr};
     void setStorage(SurgeStorage *s) { storage = s; }
 
@@ -71,8 +76,19 @@ struct VuMeter : public juce::Component,
     }
 
     void onSkinChanged() override;
+    void resized() override { chrome = {}; }
     SurgeImage *hVuBars;
 
+    /*
+     * The background, border and bars don't move with the meter, and the bars are a drawable
+     * which is slow to render, so they are drawn once into this at the physical pixel scale
+     * and blitted on each paint. Anything which changes them clears it.
+     */
+    juce::Image chrome;
+    float chromeScale{0.f};
+    Surge::ParamConfig::VUType chromeType{Surge::ParamConfig::vut_off};
+    void paintChrome(juce::Graphics &g, bool withBars);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VuMeter);
 };
 } // namespace Widgets
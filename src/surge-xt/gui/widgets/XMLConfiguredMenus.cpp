@@ -804,6 +804,16 @@ void FxMenu::populateForContext(bool isCalledInEffectChooser)
         menu.addSubMenu(Surge::GUI::toOSCase("Clear Chains"), initSubmenu);
     }
 
+    if (sge && fx->type.val.i == fxt_convolution)
+    {
+        menu.addItem(Surge::GUI::toOSCase("Load Impulse Response..."),
+                     [this, sge]() { loadImpulseResponse(sge); });
+
+        menu.addItem(Surge::GUI::toOSCase("Clear Impulse Response"),
+                     !fx->impulseResponsePath.empty(), false,
+                     [this]() { fx->impulseResponsePath.clear(); });
+    }
+
     menu.addSeparator();
 
     auto rsA = [this, sge]() {
@@ -871,6 +881,39 @@ void FxMenu::populateForContext(bool isCalledInEffectChooser)
 
 Surge::FxClipboard::Clipboard FxMenu::fxClipboard;
 
+void FxMenu::loadImpulseResponse(SurgeGUIEditor *sge)
+{
+    auto irPath = Surge::Storage::getUserDefaultPath(
+        storage, Surge::Storage::LastImpulseResponsePath, storage->userDataPath);
+
+    sge->fileChooser = std::make_unique<juce::FileChooser>(
+        "Select Impulse Response to Load", juce::File(path_to_string(irPath)),
+        "*.wav, *.aif, *.aiff, *.flac");
+    sge->fileChooser->launchAsync(
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, irPath](const juce::FileChooser &c) {
+            auto ress = c.getResults();
+
+            if (ress.size() != 1)
+            {
+                return;
+            }
+
+            auto res = c.getResult();
+
+            // the effect notices the new path and loads it off the audio thread
+            fx->impulseResponsePath = res.getFullPathName().toStdString();
+
+            auto dir = string_to_path(res.getParentDirectory().getFullPathName().toStdString());
+
+            if (dir != irPath)
+            {
+                Surge::Storage::updateUserDefaultPath(
+                    storage, Surge::Storage::LastImpulseResponsePath, dir);
+            }
+        });
+}
+
 void FxMenu::copyFX()
 {
     Surge::FxClipboard::copyFx(storage, fx, fxClipboard);
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <string>
 #include "UnitConversions.h"
+#include "ThreadPolicy.h"
 #include "Tunings.h"
 #include "filesystem/import.h"
 
@@ -48,6 +49,8 @@ OpenSoundControl::~OpenSoundControl()
     {
         stopListening(false);
     }
+
+    stopWriter();
 }
 
 void OpenSoundControl::initOSC(SurgeSynthProcessor *ssp,
@@ -56,6 +59,103 @@ void OpenSoundControl::initOSC(SurgeSynthProcessor *ssp,
     // Init. pointers to synth and synth processor
     synth = surge.get();
     sspPtr = ssp;
+
+    synth->storage.diagnostics.addListener(this);
+
+    buildAddressRoutes();
+}
+
+void OpenSoundControl::buildAddressRoutes()
+{
+    using R = AddressRoute;
+
+    addressRoutes.clear();
+
+    for (auto *p : synth->storage.getPatch().param_ptr)
+    {
+        addressRoutes[p->get_osc_name()] = {R::PARAMETER, p};
+    }
+
+    // these take precedence over parameter names, as they do in oscMessageReceived
+    for (int i = 0; i < n_customcontrollers; ++i)
+    {
+        addressRoutes["/param/macro/" + std::to_string(i + 1)] = {R::MACRO, nullptr, i};
+    }
+
+    addressRoutes["/fnote"] = {R::FREQ_NOTE};
+    addressRoutes["/fnote/rel"] = {R::FREQ_NOTE, nullptr, 0, true};
+    addressRoutes["/mnote"] = {R::MIDI_NOTE};
+    addressRoutes["/mnote/rel"] = {R::MIDI_NOTE, nullptr, 0, true};
+    addressRoutes["/pbend"] = {R::PITCH_BEND};
+    addressRoutes["/cc"] = {R::CC};
+    addressRoutes["/chan_at"] = {R::CHAN_ATOUCH};
+    addressRoutes["/poly_at"] = {R::POLY_ATOUCH};
+    addressRoutes["/allnotesoff"] = {R::ALL_NOTES_OFF};
+    addressRoutes["/allsoundoff"] = {R::ALL_SOUND_OFF};
+
+    for (auto ne : {"volume", "pitch", "pan", "timbre", "pressure"})
+    {
+        addressRoutes[std::string("/ne/") + ne] = {R::NOTE_EXPRESSION, nullptr, 0, false, ne};
+    }
+}
+
+void OpenSoundControl::dispatchRoute(const AddressRoute &route, const juce::OSCMessage &message)
+{
+    switch (route.kind)
+    {
+    case AddressRoute::FREQ_NOTE:
+        receiveFrequencyNote(message, route.release);
+        break;
+    case AddressRoute::MIDI_NOTE:
+        receiveMidiNote(message, route.release);
+        break;
+    case AddressRoute::PITCH_BEND:
+        receivePitchBend(message);
+        break;
+    case AddressRoute::NOTE_EXPRESSION:
+        receiveNoteExpression(message, route.expression);
+        break;
+    case AddressRoute::CC:
+        receiveCC(message);
+        break;
+    case AddressRoute::CHAN_ATOUCH:
+        receiveChannelAftertouch(message);
+        break;
+    case AddressRoute::POLY_ATOUCH:
+        receivePolyAftertouch(message);
+        break;
+    case AddressRoute::ALL_NOTES_OFF:
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLNOTESOFF,
+                                                                nullptr, 0.0, 0, 0, 0, 0, 0, 0, 0));
+        break;
+    case AddressRoute::ALL_SOUND_OFF:
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLSOUNDOFF,
+                                                                nullptr, 0.0, 0, 0, 0, 0, 0, 0, 0));
+        break;
+    case AddressRoute::PARAMETER:
+    case AddressRoute::MACRO:
+    {
+        if (message.size() < 1)
+        {
+            sendDataCountError("param", "1 or more");
+            return;
+        }
+        if (!message[0].isFloat32())
+        {
+            sendNotFloatError("param", "");
+            return;
+        }
+
+        float val = message[0].getFloat32();
+
+        if (route.kind == AddressRoute::MACRO)
+            sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+                SurgeSynthProcessor::MACRO, nullptr, val, route.index, 0, 0, 0, 0, 0, 0));
+        else
+            sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(route.param, val));
+        break;
+    }
+    }
 }
 
 void OpenSoundControl::tryOSCStartup()
@@ -182,6 +282,14 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
         return;
     }
 
+    // the common controller messages resolve with a single lookup
+    auto route = addressRoutes.find(addr);
+    if (route != addressRoutes.end())
+    {
+        dispatchRoute(route->second, message);
+        return;
+    }
+
     std::istringstream split(addr);
     // Scan past first '/'
     std::string throwaway;
@@ -214,316 +322,53 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
     if (addr_part == "fnote" && !querying)
     // Play a note at the given frequency and velocity
     {
-        int32_t noteID = 0;
         std::getline(split, addr_part, '/'); // check for '/rel'
-
-        if (message.size() < 2 || message.size() > 3)
-        {
-            sendDataCountError("fnote", "2 or 3");
-            return;
-        }
-        if (!message[0].isFloat32())
-        {
-            sendNotFloatError("fnote", "frequency");
-            return;
-        }
-        if (!message[1].isFloat32())
-        {
-            sendNotFloatError("fnote", "velocity");
-            return;
-        }
-        if (message.size() == 3)
-        {
-            noteID = getNoteID(message, 2);
-            if (noteID == -1)
-                return;
-        }
-
-        float frequency = message[0].getFloat32();
-        // Future enhancement: keep velocity as float as long as possible
-        int velocity = static_cast<int>(message[1].getFloat32() + 0.5);
-        constexpr float MAX_MIDI_FREQ = 12543.854;
-
-        bool noteon = (addr_part != "rel") && (velocity != 0);
-
-        // (if not a note off-by-noteid) ensure freq. is in MIDI note range
-        if (noteon || noteID == 0)
-        {
-            if (frequency < Tunings::MIDI_0_FREQ || frequency > MAX_MIDI_FREQ)
-            {
-                sendError("Frequency '" + std::to_string(frequency) + "' is out of range. (" +
-                          std::to_string(Tunings::MIDI_0_FREQ) + " - " +
-                          std::to_string(MAX_MIDI_FREQ) + ").");
-                return;
-            }
-        }
-
-        // check velocity range
-        if (velocity < 0 || velocity > 127)
-        {
-            sendError("Velocity '" + std::to_string(velocity) + "' is out of range (0 - 127).");
-            return;
-        }
-
-        // Make a noteID from frequency if not supplied
-        if (noteID == 0)
-            noteID = int(frequency * 10000);
-
-        // queue packet to audio thread
-        sspPtr->oscRingBuf.push(
-            SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::FREQNOTE, nullptr, frequency, 0, 0,
-                                            static_cast<char>(velocity), noteon, noteID, 0, 0));
+        receiveFrequencyNote(message, addr_part == "rel");
     }
 
     // "MIDI-style" notes
     else if (addr_part == "mnote" && !querying)
     // OSC equivalent of MIDI note
     {
-        int32_t noteID = 0;
-
-        if (message.size() < 2 || message.size() > 3)
-        {
-            sendDataCountError("mnote", "2 or 3");
-            return;
-        }
-
         std::getline(split, addr_part, '/'); // check for '/rel'
-
-        if (!message[0].isFloat32() || !message[1].isFloat32())
-        {
-            sendError("Invalid data type for OSC MIDI-style note and/or velocity (must be a "
-                      "float between 0 - 127).");
-            return;
-        }
-
-        if (message.size() == 3)
-        {
-            noteID = getNoteID(message, 2);
-            if (noteID == -1)
-                return;
-        }
-
-        int note = static_cast<int>(message[0].getFloat32());
-        int velocity = static_cast<int>(message[1].getFloat32());
-        bool noteon = (addr_part != "rel") && (velocity != 0);
-
-        // check note and velocity ranges (if not a release w/ id)
-        if (noteon || noteID == 0)
-        {
-            if (note < 0 || note > 127)
-            {
-                sendError("Note '" + std::to_string(note) + "' is out of range (0 - 127).");
-                return;
-            }
-        }
-
-        if (velocity < 0 || velocity > 127)
-        {
-            sendError("Velocity '" + std::to_string(velocity) + "' is out of range (0 - 127).");
-            return;
-        }
-
-        if (noteID == 0)
-            noteID = int(note);
-
-        // Send packet to audio thread
-        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-            SurgeSynthProcessor::MNOTE, nullptr, 0.0, 0, static_cast<char>(note),
-            static_cast<char>(velocity), noteon, noteID, 0, 0));
+        receiveMidiNote(message, addr_part == "rel");
     }
     else if (addr_part == "pbend" && !querying)
     {
-        if (message.size() != 2)
-        {
-            sendDataCountError(addr_part, "2");
-        }
-        if (!message[0].isFloat32() || !message[1].isFloat32())
-        {
-            sendNotFloatError(addr_part, "channel or value");
-            return;
-        }
-
-        int chan = static_cast<int>(message[0].getFloat32());
-        if ((chan < 0) || (chan > 15))
-        {
-            sendError("/pbend channel must be >= 0. and <= 15.");
-            return;
-        }
-
-        float bend = message[1].getFloat32();
-        if ((bend >= -1.0) && (bend <= 1.0))
-        {
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::PITCHBEND, nullptr, 0.0, static_cast<int>(bend * 8192),
-                static_cast<char>(chan), 0, 0, 0, 0, 0));
-        }
-        else
-            sendError("/pbend value must be between -1.0 and 1.0 .");
+        receivePitchBend(message);
     }
 
     // Note expressions
     else if (addr_part == "ne" && !querying)
     {
-        if (message.size() != 2)
-        {
-            sendDataCountError("note expression", "2");
-        }
-        if (!message[0].isFloat32())
-        {
-            sendNotFloatError("ne", "value");
-            return;
-        }
-        int noteID = getNoteID(message, 0);
-        if (noteID == -1)
-        {
-            sendError("Note expressions require a valid noteID.");
-            return;
-        }
-        float val = message[1].getFloat32();
-
         std::getline(split, addr_part, '/');
-        if (addr_part == "volume")
-        {
-            if (val < 0.0 || val > 4.0)
-            {
-                sendError("Note expression (volume) '" + std::to_string(val) +
-                          "' is out of range (0.0 - 4.0).");
-                return;
-            }
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::NOTEX_VOL, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
-        }
-        else if (addr_part == "pitch")
-        {
-            if (val < -120.0 || val > 120.0)
-            {
-                sendError("Note expression (pitch) '" + std::to_string(val) +
-                          "' is out of range (-120.0 - 120.0).");
-                return;
-            }
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::NOTEX_PITCH, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
-        }
-        else if (addr_part == "pan")
-        {
-            if (val < 0.0 || val > 1.0)
-            {
-                sendError("Note expression (pan) '" + std::to_string(val) +
-                          "' is out of range (0.0 - 1.0).");
-                return;
-            }
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::NOTEX_PAN, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
-        }
-        else if (addr_part == "timbre")
-        {
-            if (val < 0.0 || val > 1.0)
-            {
-                sendError("Note expression (timbre) '" + std::to_string(val) +
-                          "' is out of range (0.0 - 1.0).");
-                return;
-            }
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::NOTEX_TIMB, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
-        }
-        else if (addr_part == "pressure")
-        {
-            if (val < 0.0 || val > 1.0)
-            {
-                sendError("Note expression (pressure) '" + std::to_string(val) +
-                          "' is out of range (0.0 - 1.0).");
-                return;
-            }
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::NOTEX_PRES, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
-        }
+        receiveNoteExpression(message, addr_part);
     }
     else if (addr_part == "cc" && !querying)
     {
-        if (message.size() != 3)
-        {
-            sendDataCountError(addr_part, "3");
-        }
-        if (!(message[0].isFloat32() && message[1].isFloat32() && message[2].isFloat32()))
-        {
-            sendNotFloatError(addr_part, "channel, control number, or value");
-            return;
-        }
-        float chan = message[0].getFloat32();
-        float cnum = message[1].getFloat32();
-        float val = message[2].getFloat32();
-
-        if ((chan >= 0.0) && (chan <= 15.) && (cnum >= 0.0) && (cnum <= 127.) && (val >= 0.0) &&
-            (val <= 127.0))
-        {
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::CC, nullptr, 0.0, static_cast<int>(val),
-                static_cast<char>(chan), static_cast<char>(cnum), 0, 0, 0, 0));
-        }
-        else
-            sendMidiBoundsError(addr_part);
+        receiveCC(message);
     }
 
     else if (addr_part == "chan_at" && !querying)
     {
-        if (message.size() != 2)
-        {
-            sendDataCountError(addr_part, "2");
-        }
-        if (!(message[0].isFloat32() && message[1].isFloat32()))
-        {
-            sendNotFloatError(addr_part, "channel or value");
-            return;
-        }
-        float chan = message[0].getFloat32();
-        float val = message[1].getFloat32();
-
-        if ((chan >= 0.0) && (chan <= 15.) && (val >= 0.0) && (val <= 127.0))
-        {
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::CHAN_ATOUCH, nullptr, 0.0, static_cast<int>(val),
-                static_cast<char>(chan), 0, 0, 0, 0, 0));
-        }
-        else
-            sendMidiBoundsError(addr_part);
+        receiveChannelAftertouch(message);
     }
 
     else if (addr_part == "poly_at" && !querying)
     {
-        if (message.size() != 3)
-        {
-            sendDataCountError(addr_part, "3");
-        }
-        if (!(message[0].isFloat32() && message[1].isFloat32() && message[2].isFloat32()))
-        {
-            sendNotFloatError(addr_part, "channel, note number, or value");
-            return;
-        }
-        float chan = message[0].getFloat32();
-        float nnum = message[1].getFloat32();
-        float val = message[2].getFloat32();
-
-        if ((chan >= 0.0) && (chan <= 15.) && (nnum >= 0.0) && (nnum <= 127.) && (val >= 0.0) &&
-            (val <= 127.0))
-        {
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
-                SurgeSynthProcessor::POLY_ATOUCH, nullptr, 0.0, static_cast<int>(val),
-                static_cast<char>(chan), static_cast<char>(nnum), 0, 0, 0, 0));
-        }
-        else
-            sendMidiBoundsError(addr_part);
+        receivePolyAftertouch(message);
     }
 
     // All notes off
     else if (addr_part == "allnotesoff")
     {
-        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLNOTESOFF,
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLNOTESOFF,
                                                                 nullptr, 0.0, 0, 0, 0, 0, 0, 0, 0));
     }
 
     else if (addr_part == "allsoundoff")
     {
-        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLSOUNDOFF,
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::ALLSOUNDOFF,
                                                                 nullptr, 0.0, 0, 0, 0, 0, 0, 0, 0));
     }
 
@@ -573,7 +418,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                 OpenSoundControl::sendMacro(macnum - 1, true);
             }
             else
-                sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                     SurgeSynthProcessor::MACRO, nullptr, val, --macnum, 0, 0, 0, 0, 0, 0));
         }
 
@@ -604,7 +449,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->can_be_absolute())
                         sendError("Param " + p->oscName + " can't be absolute.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::ABSOLUTE_X, p, 0.0, 0, 0, 0,
                             static_cast<bool>(val), 0, 0, 0));
                 }
@@ -613,7 +458,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->can_deactivate())
                         sendError("Param " + p->oscName + " doesn't support enabling/disabling.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::ENABLE_X, p, 0.0, 0, 0, 0, static_cast<bool>(val),
                             0, 0, 0));
                 }
@@ -622,7 +467,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->can_temposync())
                         sendError("Param " + p->oscName + " can't tempo-sync.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::TEMPOSYNC_X, p, 0.0, 0, 0, 0,
                             static_cast<bool>(val), 0, 0, 0));
                 }
@@ -631,7 +476,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->can_extend_range())
                         sendError("Param " + p->oscName + " can't extend range.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::EXTEND_X, p, 0.0, 0, 0, 0, static_cast<bool>(val),
                             0, 0, 0));
                 }
@@ -640,7 +485,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->has_deformoptions())
                         sendError("Param " + p->oscName + " doesn't have deform options.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::DEFORM_X, p, 0.0, static_cast<int>(val), 0, 0, 0,
                             0, 0, 0));
                 }
@@ -649,7 +494,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->has_portaoptions())
                         sendError("Param " + p->oscName + " doesn't have portamento options.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::PORTA_CONSTRATE_X, p, 0.0, 0, 0, 0,
                             static_cast<bool>(val), 0, 0, 0));
                 }
@@ -658,7 +503,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->has_portaoptions())
                         sendError("Param " + p->oscName + " doesn't have portamento options.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::PORTA_GLISS_X, p, 0.0, 0, 0, 0,
                             static_cast<bool>(val), 0, 0, 0));
                 }
@@ -667,7 +512,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                     if (!p->has_portaoptions())
                         sendError("Param " + p->oscName + " doesn't have portamento options.");
                     else
-                        sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+                        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                             SurgeSynthProcessor::PORTA_RETRIGGER_X, p, 0.0, 0, 0, 0,
                             static_cast<bool>(val), 0, 0, 0));
                 }
@@ -680,7 +525,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                         int new_curve = static_cast<int>(val);
                         if ((new_curve < -1) || (new_curve > 1))
                             new_curve = 0;
-                        sspPtr->oscRingBuf.push(
+                        sspPtr->pushOSCToAudio(
                             SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::PORTA_CURVE_X, p,
                                                             0.0, new_curve, 0, 0, false, 0, 0, 0));
                     }
@@ -753,7 +598,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
                 }
 
                 // Send packet to audio thread
-                sspPtr->oscRingBuf.push(
+                sspPtr->pushOSCToAudio(
                     SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::FX_DISABLE, nullptr, 0.0,
                                                     selected_mask, 0, 0, onoff > 0, 0, 0, 0));
             }
@@ -776,7 +621,7 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
             }
             else
             {
-                sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(p, val));
+                sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(p, val));
             }
         }
     }
@@ -967,6 +812,67 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
         }
     }
 
+    // Engine profiling
+    else if (addr_part == "cpu")
+    {
+        std::getline(split, addr_part, '/');
+
+        if (addr_part == "reset" && !querying)
+        {
+            synth->processProfiler.resetLatencyStats();
+            return;
+        }
+
+        if (!querying)
+        {
+            sendError("/cpu is query only.");
+            return;
+        }
+
+        if (addr_part == "latency")
+        {
+            const auto &h = synth->processProfiler.getHistogram();
+            juce::OSCMessage om = juce::OSCMessage(juce::OSCAddressPattern("/cpu/latency"));
+            om.addInt32((int32_t)std::min(h.count(), (uint64_t)INT32_MAX));
+            for (auto pct : {50.0, 90.0, 99.0, 99.9})
+                om.addFloat32(h.percentile(pct));
+            om.addFloat32(h.max());
+
+            OpenSoundControl::send(om, true);
+            return;
+        }
+
+        if (addr_part == "worst")
+        {
+            for (const auto &w : synth->processProfiler.getWorstBlocks())
+            {
+                juce::OSCMessage om = juce::OSCMessage(juce::OSCAddressPattern("/cpu/worst"));
+                om.addFloat32(w.profile.usec[Surge::Profiling::ps_total]);
+                om.addString(std::to_string(w.wallClockMS));
+                om.addInt32(w.profile.voices);
+                om.addInt32(w.profile.noteOns);
+                om.addString(Surge::Profiling::ProcessProfiler::blockEventNames(w.profile.events));
+
+                OpenSoundControl::send(om, true);
+            }
+            return;
+        }
+
+        auto avg = synth->processProfiler.getAverage();
+        auto peak = synth->processProfiler.getPeak();
+
+        for (int i = 0; i < Surge::Profiling::n_process_stages; ++i)
+        {
+            juce::OSCMessage om = juce::OSCMessage(juce::OSCAddressPattern("/cpu"));
+            om.addString(Surge::Profiling::ProcessProfiler::stageName(i));
+            om.addFloat32(avg.usec[i]);
+            om.addFloat32(peak.usec[i]);
+
+            OpenSoundControl::send(om, true);
+        }
+        return;
+    }
+
     // Tuning switching
     else if (addr_part == "tuning")
     {
@@ -1206,10 +1112,10 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
 
         if (muteMsg)
 
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+            sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                 SurgeSynthProcessor::MOD_MUTE, p, depth, modnum, 0, 0, 0, 0, mscene, index));
         else
-            sspPtr->oscRingBuf.push(SurgeSynthProcessor::oscToAudio(
+            sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
                 SurgeSynthProcessor::MOD, p, depth, modnum, 0, 0, 0, 0, mscene, index));
     }
     if (!synth->audio_processing_active)
@@ -1226,6 +1132,304 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
     }
 }
 
+void OpenSoundControl::receiveFrequencyNote(const juce::OSCMessage &message, bool release)
+{
+    int32_t noteID = 0;
+
+    if (message.size() < 2 || message.size() > 3)
+    {
+        sendDataCountError("fnote", "2 or 3");
+        return;
+    }
+    if (!message[0].isFloat32())
+    {
+        sendNotFloatError("fnote", "frequency");
+        return;
+    }
+    if (!message[1].isFloat32())
+    {
+        sendNotFloatError("fnote", "velocity");
+        return;
+    }
+    if (message.size() == 3)
+    {
+        noteID = getNoteID(message, 2);
+        if (noteID == -1)
+            return;
+    }
+
+    float frequency = message[0].getFloat32();
+    // Future enhancement: keep velocity as float as long as possible
+    int velocity = static_cast<int>(message[1].getFloat32() + 0.5);
+    constexpr float MAX_MIDI_FREQ = 12543.854;
+
+    bool noteon = !release && (velocity != 0);
+
+    // (if not a note off-by-noteid) ensure freq. is in MIDI note range
+    if (noteon || noteID == 0)
+    {
+        if (frequency < Tunings::MIDI_0_FREQ || frequency > MAX_MIDI_FREQ)
+        {
+            sendError("Frequency '" + std::to_string(frequency) + "' is out of range. (" +
+                      std::to_string(Tunings::MIDI_0_FREQ) + " - " +
+                      std::to_string(MAX_MIDI_FREQ) + ").");
+            return;
+        }
+    }
+
+    // check velocity range
+    if (velocity < 0 || velocity > 127)
+    {
+        sendError("Velocity '" + std::to_string(velocity) + "' is out of range (0 - 127).");
+        return;
+    }
+
+    // Make a noteID from frequency if not supplied
+    if (noteID == 0)
+        noteID = int(frequency * 10000);
+
+    // queue packet to audio thread
+    sspPtr->pushOSCToAudio(
+        SurgeSynthProcessor::oscToAudio(SurgeSynthProcessor::FREQNOTE, nullptr, frequency, 0, 0,
+                                        static_cast<char>(velocity), noteon, noteID, 0, 0));
+}
+
+void OpenSoundControl::receiveMidiNote(const juce::OSCMessage &message, bool release)
+{
+    int32_t noteID = 0;
+
+    if (message.size() < 2 || message.size() > 3)
+    {
+        sendDataCountError("mnote", "2 or 3");
+        return;
+    }
+
+    if (!message[0].isFloat32() || !message[1].isFloat32())
+    {
+        sendError("Invalid data type for OSC MIDI-style note and/or velocity (must be a "
+                  "float between 0 - 127).");
+        return;
+    }
+
+    if (message.size() == 3)
+    {
+        noteID = getNoteID(message, 2);
+        if (noteID == -1)
+            return;
+    }
+
+    int note = static_cast<int>(message[0].getFloat32());
+    int velocity = static_cast<int>(message[1].getFloat32());
+    bool noteon = !release && (velocity != 0);
+
+    // check note and velocity ranges (if not a release w/ id)
+    if (noteon || noteID == 0)
+    {
+        if (note < 0 || note > 127)
+        {
+            sendError("Note '" + std::to_string(note) + "' is out of range (0 - 127).");
+            return;
+        }
+    }
+
+    if (velocity < 0 || velocity > 127)
+    {
+        sendError("Velocity '" + std::to_string(velocity) + "' is out of range (0 - 127).");
+        return;
+    }
+
+    if (noteID == 0)
+        noteID = int(note);
+
+    // Send packet to audio thread
+    sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+        SurgeSynthProcessor::MNOTE, nullptr, 0.0, 0, static_cast<char>(note),
+        static_cast<char>(velocity), noteon, noteID, 0, 0));
+}
+
+void OpenSoundControl::receivePitchBend(const juce::OSCMessage &message)
+{
+    if (message.size() != 2)
+    {
+        sendDataCountError("pbend", "2");
+    }
+    if (!message[0].isFloat32() || !message[1].isFloat32())
+    {
+        sendNotFloatError("pbend", "channel or value");
+        return;
+    }
+
+    int chan = static_cast<int>(message[0].getFloat32());
+    if ((chan < 0) || (chan > 15))
+    {
+        sendError("/pbend channel must be >= 0. and <= 15.");
+        return;
+    }
+
+    float bend = message[1].getFloat32();
+    if ((bend >= -1.0) && (bend <= 1.0))
+    {
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::PITCHBEND, nullptr, 0.0, static_cast<int>(bend * 8192),
+            static_cast<char>(chan), 0, 0, 0, 0, 0));
+    }
+    else
+        sendError("/pbend value must be between -1.0 and 1.0 .");
+}
+
+void OpenSoundControl::receiveNoteExpression(const juce::OSCMessage &message,
+                                             const std::string &expression)
+{
+    if (message.size() != 2)
+    {
+        sendDataCountError("note expression", "2");
+    }
+    if (!message[0].isFloat32())
+    {
+        sendNotFloatError("ne", "value");
+        return;
+    }
+    int noteID = getNoteID(message, 0);
+    if (noteID == -1)
+    {
+        sendError("Note expressions require a valid noteID.");
+        return;
+    }
+    float val = message[1].getFloat32();
+
+    if (expression == "volume")
+    {
+        if (val < 0.0 || val > 4.0)
+        {
+            sendError("Note expression (volume) '" + std::to_string(val) +
+                      "' is out of range (0.0 - 4.0).");
+            return;
+        }
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::NOTEX_VOL, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
+    }
+    else if (expression == "pitch")
+    {
+        if (val < -120.0 || val > 120.0)
+        {
+            sendError("Note expression (pitch) '" + std::to_string(val) +
+                      "' is out of range (-120.0 - 120.0).");
+            return;
+        }
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::NOTEX_PITCH, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
+    }
+    else if (expression == "pan")
+    {
+        if (val < 0.0 || val > 1.0)
+        {
+            sendError("Note expression (pan) '" + std::to_string(val) +
+                      "' is out of range (0.0 - 1.0).");
+            return;
+        }
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::NOTEX_PAN, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
+    }
+    else if (expression == "timbre")
+    {
+        if (val < 0.0 || val > 1.0)
+        {
+            sendError("Note expression (timbre) '" + std::to_string(val) +
+                      "' is out of range (0.0 - 1.0).");
+            return;
+        }
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::NOTEX_TIMB, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
+    }
+    else if (expression == "pressure")
+    {
+        if (val < 0.0 || val > 1.0)
+        {
+            sendError("Note expression (pressure) '" + std::to_string(val) +
+                      "' is out of range (0.0 - 1.0).");
+            return;
+        }
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::NOTEX_PRES, nullptr, val, 0, 0, 0, 0, noteID, 0, 0));
+    }
+}
+
+void OpenSoundControl::receiveCC(const juce::OSCMessage &message)
+{
+    if (message.size() != 3)
+    {
+        sendDataCountError("cc", "3");
+    }
+    if (!(message[0].isFloat32() && message[1].isFloat32() && message[2].isFloat32()))
+    {
+        sendNotFloatError("cc", "channel, control number, or value");
+        return;
+    }
+    float chan = message[0].getFloat32();
+    float cnum = message[1].getFloat32();
+    float val = message[2].getFloat32();
+
+    if ((chan >= 0.0) && (chan <= 15.) && (cnum >= 0.0) && (cnum <= 127.) && (val >= 0.0) &&
+        (val <= 127.0))
+    {
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::CC, nullptr, 0.0, static_cast<int>(val),
+            static_cast<char>(chan), static_cast<char>(cnum), 0, 0, 0, 0));
+    }
+    else
+        sendMidiBoundsError("cc");
+}
+
+void OpenSoundControl::receiveChannelAftertouch(const juce::OSCMessage &message)
+{
+    if (message.size() != 2)
+    {
+        sendDataCountError("chan_at", "2");
+    }
+    if (!(message[0].isFloat32() && message[1].isFloat32()))
+    {
+        sendNotFloatError("chan_at", "channel or value");
+        return;
+    }
+    float chan = message[0].getFloat32();
+    float val = message[1].getFloat32();
+
+    if ((chan >= 0.0) && (chan <= 15.) && (val >= 0.0) && (val <= 127.0))
+    {
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::CHAN_ATOUCH, nullptr, 0.0, static_cast<int>(val),
+            static_cast<char>(chan), 0, 0, 0, 0, 0));
+    }
+    else
+        sendMidiBoundsError("chan_at");
+}
+
+void OpenSoundControl::receivePolyAftertouch(const juce::OSCMessage &message)
+{
+    if (message.size() != 3)
+    {
+        sendDataCountError("poly_at", "3");
+    }
+    if (!(message[0].isFloat32() && message[1].isFloat32() && message[2].isFloat32()))
+    {
+        sendNotFloatError("poly_at", "channel, note number, or value");
+        return;
+    }
+    float chan = message[0].getFloat32();
+    float nnum = message[1].getFloat32();
+    float val = message[2].getFloat32();
+
+    if ((chan >= 0.0) && (chan <= 15.) && (nnum >= 0.0) && (nnum <= 127.) && (val >= 0.0) &&
+        (val <= 127.0))
+    {
+        sspPtr->pushOSCToAudio(SurgeSynthProcessor::oscToAudio(
+            SurgeSynthProcessor::POLY_ATOUCH, nullptr, 0.0, static_cast<int>(val),
+            static_cast<char>(chan), static_cast<char>(nnum), 0, 0, 0, 0));
+    }
+    else
+        sendMidiBoundsError("poly_at");
+}
+
 bool OpenSoundControl::hasEnding(std::string const &fullString, std::string const &ending)
 {
     if (fullString.length() >= ending.length())
@@ -1241,7 +1445,20 @@ bool OpenSoundControl::hasEnding(std::string const &fullString, std::string cons
 
 void OpenSoundControl::oscBundleReceived(const juce::OSCBundle &bundle)
 {
-    std::string msg;
+    // Everything queued for the audio thread from this bundle carries its time tag, and
+    // nested bundles bring their own
+    auto outerDueTime = bundleDueTime;
+    auto tag = bundle.getTimeTag();
+
+    if (!tag.isImmediately())
+    {
+        // NTP time, seconds since 1900 with a 32 bit fraction
+        static constexpr double ntpToUnixEpoch{2208988800.0};
+        auto raw = tag.getRawTimeTag();
+
+        bundleDueTime =
+            (double)(raw >> 32) - ntpToUnixEpoch + (double)(raw & 0xFFFFFFFF) / 4294967296.0;
+    }
 
     for (int i = 0; i < bundle.size(); ++i)
     {
@@ -1251,8 +1468,11 @@ void OpenSoundControl::oscBundleReceived(const juce::OSCBundle &bundle)
         else if (elem.isBundle())
             oscBundleReceived(elem.getBundle());
     }
+
+    bundleDueTime = outerDueTime;
 }
 
+
 /* ----- OSC Sending  ----- */
 
 bool OpenSoundControl::initOSCOut(int port, std::string ipaddr)
@@ -1301,9 +1521,25 @@ bool OpenSoundControl::initOSCOut(int port, std::string ipaddr)
             }
         });
 
+    // MIDI-'learned' parameter values come through the synth's change log instead, and
+    // are sent a drain at a time, however many arrive between two message thread runs
+    synth->addAudioParamLogListener("OSC_OUT", [ssp = sspPtr, s = synth]() {
+        auto *mm = juce::MessageManager::getInstanceWithoutCreating();
+        if (mm)
+        {
+            mm->callAsync([ssp, s]() {
+                s->audioThreadParamChanges.drain([ssp, s](int index, float fval) {
+                    auto *p = s->storage.getPatch().param_ptr[index];
+                    ssp->param_change_to_OSC(p->oscName, 1, fval, 0., 0., "");
+                });
+            });
+        }
+    });
+
     // Add a listener for modulation changes
     synth->addModulationAPIListener(this);
 
+    startWriter();
     sendingOSC = true;
     oportnum = port;
     outIPAddr = ipaddr;
@@ -1323,8 +1559,11 @@ void OpenSoundControl::stopSending(bool updateOSCStartInStorage)
     sendingOSC = false;
     synth->storage.oscSending = false;
 
+    stopWriter();
+
     synth->deletePatchLoadedListener("OSC_OUT");
     synth->deleteAudioParamListener("OSC_OUT");
+    synth->deleteAudioParamLogListener("OSC_OUT");
     sspPtr->deleteParamChangeListener("OSC_OUT");
 
     if (updateOSCStartInStorage)
@@ -1335,29 +1574,209 @@ void OpenSoundControl::stopSending(bool updateOSCStartInStorage)
 
 void OpenSoundControl::send(juce::OSCMessage om, bool needsMessageThread)
 {
+    // Everything leaves through the writer thread now, which makes sending safe from any
+    // thread, so needsMessageThread no longer changes anything here
     if (sendingOSC)
     {
-        if (needsMessageThread)
+        auto key = coalesceKey(om);
+
         {
-            // Runs on the juce messenger thread
-            juce::MessageManager::getInstance()->callAsync([this, om]() {
-                if (!this->juceOSCSender.send(om))
-                    sendFailed();
-            });
+            std::lock_guard<std::mutex> g(writerMutex);
+
+            auto prior = key.empty() ? coalesceIndex.end() : coalesceIndex.find(key);
+
+            if (prior != coalesceIndex.end())
+            {
+                // a newer value for something not yet sent replaces it in place
+                writerQueue[prior->second] = std::move(om);
+            }
+            else
+            {
+                if (!key.empty())
+                    coalesceIndex[key] = writerQueue.size();
+
+                writerQueue.push_back(std::move(om));
+            }
+        }
+
+        writerCV.notify_one();
+    }
+}
+
+/*
+ * Parameter and modulation messages report state, so only the latest one for each target
+ * matters. Mod addresses name the source and carry the target as their first argument.
+ * Anything else (errors, docs, query replies, /cpu rows) is never merged.
+ */
+std::string OpenSoundControl::coalesceKey(const juce::OSCMessage &om)
+{
+    auto addr = om.getAddressPattern().toString();
+
+    if (addr.startsWith("/param/"))
+        return addr.toStdString();
+
+    if (addr.startsWith("/mod/") && om.size() > 0 && om[0].isString())
+        return (addr + " " + om[0].getString()).toStdString();
+
+    return {};
+}
+
+// Size on the wire, as juce's OSCOutputStream writes it
+size_t OpenSoundControl::oscMessageBytes(const juce::OSCMessage &om)
+{
+    auto padded = [](size_t n) { return (n + 4) & ~(size_t)3; }; // with its terminating zero
+    size_t sz = padded(om.getAddressPattern().toString().getNumBytesAsUTF8());
+
+    sz += padded(1 + om.size()); // the ',' and the type tags
+
+    for (const auto &arg : om)
+    {
+        if (arg.isString())
+            sz += padded(arg.getString().getNumBytesAsUTF8());
+        else if (arg.isBlob())
+            sz += 4 + ((arg.getBlob().getSize() + 3) & ~(size_t)3);
+        else
+            sz += 4;
+    }
+
+    return sz;
+}
+
+void OpenSoundControl::startWriter()
+{
+    stopWriter();
+
+    coalesceWindowMS = std::max(0, Surge::Storage::getUserDefaultValue(
+                                       &(synth->storage), Surge::Storage::OSCOutCoalesceMS, 5));
+    maxBundleBytes = std::max(0, Surge::Storage::getUserDefaultValue(
+                                     &(synth->storage), Surge::Storage::OSCOutBundleBytes, 1400));
+    maxPacketsPerSecond =
+        std::max(0, Surge::Storage::getUserDefaultValue(
+                        &(synth->storage), Surge::Storage::OSCOutMaxPacketsPerSecond, 0));
+
+    {
+        std::lock_guard<std::mutex> g(writerMutex);
+        writerRunning = true;
+    }
+
+    writerThread = Surge::Threading::makeThread(Surge::Threading::ThreadRole::Helper,
+                                                [this]() { writerLoop(); });
+}
+
+void OpenSoundControl::stopWriter()
+{
+    {
+        std::lock_guard<std::mutex> g(writerMutex);
+        writerRunning = false;
+    }
+    writerCV.notify_one();
+
+    if (writerThread.joinable())
+        writerThread.join();
+}
+
+void OpenSoundControl::writerLoop()
+{
+    std::vector<juce::OSCMessage> batch;
+    auto nextPacketTime = std::chrono::steady_clock::now();
+
+    auto sendPacket = [this, &nextPacketTime](const auto &packet) {
+        // per client rate limit: packets are spaced out rather than dropped, and whatever
+        // changes meanwhile coalesces in the queue
+        if (maxPacketsPerSecond > 0)
+        {
+            std::this_thread::sleep_until(nextPacketTime);
+            nextPacketTime = std::max(nextPacketTime, std::chrono::steady_clock::now()) +
+                             std::chrono::microseconds(1000000 / maxPacketsPerSecond);
+        }
+
+        if (!juceOSCSender.send(packet))
+            sendFailed();
+    };
+
+    std::unique_lock<std::mutex> lk(writerMutex);
+
+    while (true)
+    {
+        writerCV.wait(lk, [this]() { return !writerRunning || !writerQueue.empty(); });
+
+        // whatever was queued before stopping still goes out
+        if (writerQueue.empty())
+            return;
+
+        // give a burst (a patch load, a knob being turned) a moment to collect
+        if (writerRunning && coalesceWindowMS > 0)
+            writerCV.wait_for(lk, std::chrono::milliseconds(coalesceWindowMS),
+                              [this]() { return !writerRunning; });
+
+        batch.swap(writerQueue);
+        coalesceIndex.clear();
+        lk.unlock();
+
+        if (maxBundleBytes <= 0)
+        {
+            for (const auto &om : batch)
+                sendPacket(om);
         }
         else
         {
-            // Send OSC directly (used when already on the messenger thread)
+            // pack as many as fit under the size limit into each bundle; a bundle is 16 bytes
+            // of header, then each element carries a 4 byte size
+            static constexpr size_t bundleHeaderBytes{16}, elementHeaderBytes{4};
+            size_t i = 0;
+
+            while (i < batch.size())
             {
-                if (!this->juceOSCSender.send(om))
-                    sendFailed();
+                size_t end = i, bytes = bundleHeaderBytes;
+
+                while (end < batch.size() &&
+                       (end == i || bytes + elementHeaderBytes + oscMessageBytes(batch[end]) <=
+                                        (size_t)maxBundleBytes))
+                {
+                    bytes += elementHeaderBytes + oscMessageBytes(batch[end]);
+                    end++;
+                }
+
+                if (end - i == 1)
+                {
+                    sendPacket(batch[i]);
+                }
+                else
+                {
+                    juce::OSCBundle bundle;
+
+                    for (auto k = i; k < end; ++k)
+                        bundle.addElement(batch[k]);
+
+                    sendPacket(bundle);
+                }
+
+                i = end;
             }
         }
+
+        batch.clear();
+        lk.lock();
     }
 }
 
 void OpenSoundControl::sendFailed() { std::cout << "Error: could not send OSC message."; }
 
+void OpenSoundControl::onDiagnostic(const Surge::Debug::DiagnosticRecord &r,
+                                    const std::string &formatted)
+{
+    static constexpr const char *severities[] = {"info", "warning", "error"};
+
+    if (!sendingOSC)
+        return;
+
+    juce::OSCMessage om = juce::OSCMessage(juce::OSCAddressPattern(juce::String("/diagnostic")));
+    om.addString(Surge::Debug::diagnosticName(r.event));
+    om.addString(severities[Surge::Debug::diagnosticSeverity(r.event)]);
+    om.addString(formatted);
+    OpenSoundControl::send(om, false);
+}
+
 void OpenSoundControl::sendError(std::string errorMsg)
 {
     if (sendingOSC)
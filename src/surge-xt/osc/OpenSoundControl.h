@@ -41,6 +41,11 @@
 #include "SurgeStorage.h"
 #include <fmt/core.h>
 #include <fmt/format.h>
+#include <unordered_map>
+#include <condition_variable>
+#include <vector>
+#include <mutex>
+#include <thread>
 
 class SurgeSynthProcessor;
 
@@ -51,6 +56,7 @@ namespace OSC
 
 class OpenSoundControl : public juce::OSCReceiver,
                          public SurgeSynthesizer::ModulationAPIListener,
+                         public Surge::Debug::DiagnosticLog::Listener,
                          juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
 {
   public:
@@ -90,6 +96,17 @@ class OpenSoundControl : public juce::OSCReceiver,
 
     void modOSCout(std::string addr, std::string oscName, float val, bool reportMute);
 
+    // engine diagnostics go out as /diagnostic name severity message, on the drainer thread
+    void onDiagnostic(const Surge::Debug::DiagnosticRecord &r,
+                      const std::string &formatted) override;
+
+    /*
+     * Incoming messages are parsed on the receiver's own socket thread and go straight to
+     * the audio thread's ring. While a time tagged bundle is being unpacked this is its time,
+     * so what it queues is scheduled for then rather than applied on arrival.
+     */
+    double pendingBundleDueTime() const { return bundleDueTime; }
+
   private:
     SurgeSynthesizer *synth{nullptr};
     SurgeSynthProcessor *sspPtr{nullptr};
@@ -116,6 +133,69 @@ class OpenSoundControl : public juce::OSCReceiver,
     void sendFailed();
     bool hasEnding(std::string const &fullString, std::string const &ending);
 
+    void receiveFrequencyNote(const juce::OSCMessage &message, bool release);
+    void receiveMidiNote(const juce::OSCMessage &message, bool release);
+    void receivePitchBend(const juce::OSCMessage &message);
+    void receiveNoteExpression(const juce::OSCMessage &message, const std::string &expression);
+    void receiveCC(const juce::OSCMessage &message);
+    void receiveChannelAftertouch(const juce::OSCMessage &message);
+    void receivePolyAftertouch(const juce::OSCMessage &message);
+
+    /*
+     * Every address whose handling doesn't depend on parsing the address itself (note,
+     * controller, parameter and macro messages) maps straight to a prebuilt route, so the
+     * high rate controller traffic skips the tokenizing dispatch chain. Parameter OSC names
+     * are fixed when the patch storage is built, and patch or FX changes only change values,
+     * so the table is built once in initOSC.
+     */
+    struct AddressRoute
+    {
+        enum Kind
+        {
+            FREQ_NOTE,
+            MIDI_NOTE,
+            PITCH_BEND,
+            NOTE_EXPRESSION,
+            CC,
+            CHAN_ATOUCH,
+            POLY_ATOUCH,
+            ALL_NOTES_OFF,
+            ALL_SOUND_OFF,
+            PARAMETER,
+            MACRO
+        } kind{PARAMETER};
+        Parameter *param{nullptr};
+        int index{0};
+        bool release{false};
+        std::string expression{};
+    };
+    std::unordered_map<std::string, AddressRoute> addressRoutes;
+    void buildAddressRoutes();
+    void dispatchRoute(const AddressRoute &route, const juce::OSCMessage &message);
+
+    double bundleDueTime{0};
+
+    /*
+     * All output goes through a writer thread of our own rather than the message thread.
+     * It waits coalesceWindowMS after the first message of a burst, so repeated changes to
+     * the same parameter or modulation collapse to their latest value. It then packs what
+     * it has into bundles of up to maxBundleBytes (0 sends plain messages) and spaces the
+     * packets out to maxPacketsPerSecond (0 is unlimited). The three come from the user
+     * defaults when output starts.
+     */
+    std::thread writerThread;
+    std::mutex writerMutex;
+    std::condition_variable writerCV;
+    std::vector<juce::OSCMessage> writerQueue;
+    std::unordered_map<std::string, size_t> coalesceIndex;
+    bool writerRunning{false};
+    int coalesceWindowMS{5}, maxBundleBytes{1400}, maxPacketsPerSecond{0};
+    void startWriter();
+    void stopWriter();
+    void writerLoop();
+    static std::string coalesceKey(const juce::OSCMessage &om);
+    static size_t oscMessageBytes(const juce::OSCMessage &om);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OpenSoundControl)
 };
 
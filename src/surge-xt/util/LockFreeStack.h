@@ -57,6 +57,7 @@ template <typename T, int qSize = 4096> class LockFreeStack
         af.finishedRead(size1 + size2);
         return ret;
     }
+    bool empty() const { return af.getNumReady() == 0; }
     juce::AbstractFifo af;
     std::array<T, qSize> dq;
 };